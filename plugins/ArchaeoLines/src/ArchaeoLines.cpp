@@ -39,6 +39,7 @@
 #include <QColor>
 #include <QSettings>
 #include <QMouseEvent>
+#include <QtNumeric>
 #include <cmath>
 
 //! This method is the one called automatically by the StelModuleMgr just
@@ -93,7 +94,9 @@ ArchaeoLines::ArchaeoLines()
 	//, customAzimuth2(0.0)
 	, flagShowCustomDeclination1(false)
 	, flagShowCustomDeclination2(false)
-	, lastJDE(0.0)
+	, declinationsYear(0)
+	, declinationsLatitude(qQNaN()) // computed in the first update
+	, declinationsAltitude(0)
 	, toolbarButton(Q_NULLPTR)
 {
 	setObjectName("ArchaeoLines");
@@ -332,24 +335,10 @@ void ArchaeoLines::update(double deltaTime)
 		return;
 
 	static SolarSystem *ssystem=GETSTELMODULE(SolarSystem);
-	static const double lunarI=5.145396; // inclination of lunar orbit
-	// compute min and max distance values for horizontal parallax.
-	// Meeus, AstrAlg 98, p342.
-	static const double meanDist=385000.56; // km earth-moon.
-	static const double addedValues=20905.355+3699.111+2955.968+569.925+48.888+3.149+246.158+152.138+170.733+
-			204.586+129.620+108.743+104.755+10.321+79.661+34.782+23.210+21.636+24.208+30.824+8.379+
-			16.675+12.831+10.445+11.650+14.403+7.003+10.056+6.322+9.884;
-	static const double minDist=meanDist-addedValues;
-	static const double maxDist=meanDist+addedValues;
-	static const double sinPiMin=6378.14/maxDist;
-	static const double sinPiMax=6378.14/minDist; // maximal parallax at min. distance!
-	static double eps;
 
-	PlanetP planet=ssystem->getSun();
 	double dec_equ, ra_equ, az, alt;
-	StelUtils::rectToSphe(&ra_equ,&dec_equ,planet->getEquinoxEquatorialPos(core));
-	currentSunLine->setDefiningAngle(dec_equ * 180.0/M_PI);
-	planet=ssystem->getMoon();
+	currentSunLine->setDefiningAngle(ssystem->getSunOfDate(core).declination * 180.0/M_PI);
+	PlanetP planet=ssystem->getMoon();
 	StelUtils::rectToSphe(&ra_equ,&dec_equ,planet->getEquinoxEquatorialPos(core));
 	currentMoonLine->setDefiningAngle(dec_equ * 180.0/M_PI);
 
@@ -363,18 +352,84 @@ void ArchaeoLines::update(double deltaTime)
 		currentPlanetLine->setDefiningAngle(dec_equ * 180.0/M_PI);
 	}
 
-	double newJDE=core->getJDE();
-	if (fabs(newJDE-lastJDE) > 10.0) // enough to compute this every 10 days?
+	int year, month, day;
+	StelUtils::getDateFromJulianDay(core->getJD(), &year, &month, &day);
+	const StelLocation& loc=core->getCurrentLocation();
+	if (year!=declinationsYear || loc.latitude!=declinationsLatitude || loc.altitude!=declinationsAltitude)
+		updateDeclinations(year, core->getJDE(), loc);
+
+	// Selected object?
+	if (objMgr->getWasSelected())
 	{
-		eps= ssystem->getEarth()->getRotObliquity(newJDE) *180.0/M_PI;
-		static const double invSqrt2=1.0/std::sqrt(2.0);
-		northernSolsticeLine->setDefiningAngle(eps);
-		southernSolsticeLine->setDefiningAngle(-eps);
-		northernCrossquarterLine->setDefiningAngle( eps*invSqrt2);
-		southernCrossquarterLine->setDefiningAngle(-eps*invSqrt2);
-		lastJDE=newJDE;
+		StelObjectP obj=objMgr->getSelectedObject().first();
+		StelUtils::rectToSphe(&ra_equ,&dec_equ,obj->getEquinoxEquatorialPos(core));
+		selectedObjectLine->setDefiningAngle(dec_equ * 180.0/M_PI);
+		selectedObjectLine->setLabel(obj->getNameI18n());
+		selectedObjectHourAngleLine->setDefiningAngle((M_PI-ra_equ) * 180.0/M_PI);
+		selectedObjectHourAngleLine->setLabel(obj->getNameI18n());
+		StelUtils::rectToSphe(&az,&alt,obj->getAltAzPosAuto(core));
+		selectedObjectAzimuthLine->setDefiningAngle((M_PI-az) * 180.0/M_PI);
+		selectedObjectAzimuthLine->setLabel(obj->getNameI18n());
 	}
-	StelLocation loc=core->getCurrentLocation();
+
+	// Updates for line brightness
+	lineFader.update((int)(deltaTime*1000));
+	equinoxLine->update(deltaTime);
+	northernSolsticeLine->update(deltaTime);
+	southernSolsticeLine->update(deltaTime);
+	northernCrossquarterLine->update(deltaTime);
+	southernCrossquarterLine->update(deltaTime);
+	northernMajorStandstillLine0->update(deltaTime);
+	northernMajorStandstillLine1->update(deltaTime);
+	northernMinorStandstillLine2->update(deltaTime);
+	northernMinorStandstillLine3->update(deltaTime);
+	southernMinorStandstillLine4->update(deltaTime);
+	southernMinorStandstillLine5->update(deltaTime);
+	southernMajorStandstillLine6->update(deltaTime);
+	southernMajorStandstillLine7->update(deltaTime);
+	zenithPassageLine->update(deltaTime);
+	nadirPassageLine->update(deltaTime);
+	selectedObjectLine->update(deltaTime);
+	selectedObjectAzimuthLine->update(deltaTime);
+	selectedObjectHourAngleLine->update(deltaTime);
+	currentSunLine->update(deltaTime);
+	currentMoonLine->update(deltaTime);
+	currentPlanetLine->update(deltaTime);
+	geographicLocation1Line->update(deltaTime);
+	geographicLocation2Line->update(deltaTime);
+	customAzimuth1Line->update(deltaTime);
+	customAzimuth2Line->update(deltaTime);
+	customDeclination1Line->update(deltaTime);
+	customDeclination2Line->update(deltaTime);
+
+	//withDecimalDegree = StelApp::getInstance().getFlagShowDecimalDegrees();;
+}
+
+void ArchaeoLines::updateDeclinations(int year, double JDE, const StelLocation& loc)
+{
+	static SolarSystem *ssystem=GETSTELMODULE(SolarSystem);
+	static const double lunarI=5.145396; // inclination of lunar orbit
+	// compute min and max distance values for horizontal parallax.
+	// Meeus, AstrAlg 98, p342.
+	static const double meanDist=385000.56; // km earth-moon.
+	static const double addedValues=20905.355+3699.111+2955.968+569.925+48.888+3.149+246.158+152.138+170.733+
+			204.586+129.620+108.743+104.755+10.321+79.661+34.782+23.210+21.636+24.208+30.824+8.379+
+			16.675+12.831+10.445+11.650+14.403+7.003+10.056+6.322+9.884;
+	static const double minDist=meanDist-addedValues;
+	static const double maxDist=meanDist+addedValues;
+	static const double sinPiMin=6378.14/maxDist;
+	static const double sinPiMax=6378.14/minDist; // maximal parallax at min. distance!
+
+	declinationsYear=year;
+	declinationsLatitude=loc.latitude;
+	declinationsAltitude=loc.altitude;
+	// The obliquity changes by less than an arcsecond per year
+	const double eps=ssystem->getEarth()->getRotObliquity(JDE) *180.0/M_PI;
+	static const double invSqrt2=1.0/std::sqrt(2.0);
+	northernSolsticeLine->setDefiningAngle(eps);
+	southernSolsticeLine->setDefiningAngle(-eps);
+	northernCrossquarterLine->setDefiningAngle( eps*invSqrt2);
+	southernCrossquarterLine->setDefiningAngle(-eps*invSqrt2);
 
 	// compute parallax correction with Meeus 40.6. First, find H from h=0, then add corrections.
 
@@ -426,52 +481,6 @@ void ArchaeoLines::update(double deltaTime)
 
 	zenithPassageLine->setDefiningAngle(loc.latitude);
 	nadirPassageLine->setDefiningAngle(-loc.latitude);
-
-	// Selected object?
-	if (objMgr->getWasSelected())
-	{
-		StelObjectP obj=objMgr->getSelectedObject().first();
-		StelUtils::rectToSphe(&ra_equ,&dec_equ,obj->getEquinoxEquatorialPos(core));
-		selectedObjectLine->setDefiningAngle(dec_equ * 180.0/M_PI);
-		selectedObjectLine->setLabel(obj->getNameI18n());
-		selectedObjectHourAngleLine->setDefiningAngle((M_PI-ra_equ) * 180.0/M_PI);
-		selectedObjectHourAngleLine->setLabel(obj->getNameI18n());
-		StelUtils::rectToSphe(&az,&alt,obj->getAltAzPosAuto(core));
-		selectedObjectAzimuthLine->setDefiningAngle((M_PI-az) * 180.0/M_PI);
-		selectedObjectAzimuthLine->setLabel(obj->getNameI18n());
-	}
-
-	// Updates for line brightness
-	lineFader.update((int)(deltaTime*1000));
-	equinoxLine->update(deltaTime);
-	northernSolsticeLine->update(deltaTime);
-	southernSolsticeLine->update(deltaTime);
-	northernCrossquarterLine->update(deltaTime);
-	southernCrossquarterLine->update(deltaTime);
-	northernMajorStandstillLine0->update(deltaTime);
-	northernMajorStandstillLine1->update(deltaTime);
-	northernMinorStandstillLine2->update(deltaTime);
-	northernMinorStandstillLine3->update(deltaTime);
-	southernMinorStandstillLine4->update(deltaTime);
-	southernMinorStandstillLine5->update(deltaTime);
-	southernMajorStandstillLine6->update(deltaTime);
-	southernMajorStandstillLine7->update(deltaTime);
-	zenithPassageLine->update(deltaTime);
-	nadirPassageLine->update(deltaTime);
-	selectedObjectLine->update(deltaTime);
-	selectedObjectAzimuthLine->update(deltaTime);
-	selectedObjectHourAngleLine->update(deltaTime);
-	currentSunLine->update(deltaTime);
-	currentMoonLine->update(deltaTime);
-	currentPlanetLine->update(deltaTime);
-	geographicLocation1Line->update(deltaTime);
-	geographicLocation2Line->update(deltaTime);
-	customAzimuth1Line->update(deltaTime);
-	customAzimuth2Line->update(deltaTime);
-	customDeclination1Line->update(deltaTime);
-	customDeclination2Line->update(deltaTime);
-
-	//withDecimalDegree = StelApp::getInstance().getFlagShowDecimalDegrees();;
 }
 
 
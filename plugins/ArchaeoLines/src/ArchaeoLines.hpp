@@ -440,6 +440,10 @@ private slots:
 	static double getAzimuthForLocation(double longObs, double latObs, double longTarget, double latTarget);
 
 private:
+	//! Compute the declinations of the solstices, crossquarters, lunar standstills and zenith and nadir passages.
+	//! They change little within a year, update() calls this when the year or the location changes.
+	void updateDeclinations(int year, double JDE, const StelLocation& loc);
+
 	QFont font;
 	bool flagShowArchaeoLines;
 	//bool withDecimalDegree;
@@ -489,7 +493,10 @@ private:
 	bool flagShowCustomAzimuth2;
 	bool flagShowCustomDeclination1;
 	bool flagShowCustomDeclination2;
-	double lastJDE; // cache last-time-computed to every 10 days or so?
+	//! The year and the location for which updateDeclinations() computed the declinations
+	int declinationsYear;
+	float declinationsLatitude;
+	int declinationsAltitude;
 
 	ArchaeoLine * equinoxLine;
 	ArchaeoLine * northernSolsticeLine;
@@ -186,6 +186,8 @@ Exoplanet::Exoplanet(const QVariantMap& map)
 		}
 	}
 
+	// The position is constant, it is used by the spatial index of the module
+	StelUtils::spheToRect(RA, DE, XYZ);
 	initialized = true;
 }
 
@@ -671,7 +673,6 @@ void Exoplanet::draw(StelCore* core, StelPainter *painter)
 	if (hasHabitableExoplanets)
 		color = habitableExoplanetMarkerColor;
 
-	StelUtils::spheToRect(RA, DE, XYZ);
 	double mag = getVMagnitudeWithExtinction(core);
 
 	painter->setBlending(true, GL_ONE, GL_ONE);
@@ -19,6 +19,7 @@
 
 #include "StelProjector.hpp"
 #include "StelPainter.hpp"
+#include "StelSkyDrawer.hpp"
 #include "StelApp.hpp"
 #include "StelCore.hpp"
 #include "StelGui.hpp"
@@ -27,7 +28,7 @@
 #include "StelModuleMgr.hpp"
 #include "StelObjectMgr.hpp"
 #include "StelTextureMgr.hpp"
-#include "StelJsonParser.hpp"
+#include "StelJsonCatalog.hpp"
 #include "StelFileMgr.hpp"
 #include "StelUtils.hpp"
 #include "StelTranslator.hpp"
@@ -222,11 +223,11 @@ void Exoplanets::draw(StelCore* core)
 	StelPainter painter(prj);
 	painter.setFont(font);
 	
-	for (const auto& eps : ep)
-	{
-		if (eps && eps->initialized)
-			eps->draw(core, &painter);
-	}
+	// The objects fainter than the limit are not drawn, except in distribution mode
+	const float maxMag = Exoplanet::distributionMode ? std::numeric_limits<float>::max() : core->getSkyDrawer()->getLimitMagnitude();
+	ep.processVisible(prj, maxMag, [&](const ExoplanetP& eps) {
+		eps->draw(core, &painter);
+	});
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
 		drawPointer(core, painter);
@@ -256,30 +257,10 @@ void Exoplanets::drawPointer(StelCore* core, StelPainter& painter)
 
 QList<StelObjectP> Exoplanets::searchAround(const Vec3d& av, double limitFov, const StelCore*) const
 {
-	QList<StelObjectP> result;
-
 	if (!flagShowExoplanets)
-		return result;
+		return QList<StelObjectP>();
 
-	Vec3d v(av);
-	v.normalize();
-	double cosLimFov = cos(limitFov * M_PI/180.);
-	Vec3d equPos;
-
-	for (const auto& eps : ep)
-	{
-		if (eps->initialized)
-		{
-			equPos = eps->XYZ;
-			equPos.normalize();
-			if (equPos[0]*v[0] + equPos[1]*v[1] + equPos[2]*v[2]>=cosLimFov)
-			{
-				result.append(qSharedPointerCast<StelObject>(eps));
-			}
-		}
-	}
-
-	return result;
+	return ep.searchAround(av, limitFov);
 }
 
 StelObjectP Exoplanets::searchByName(const QString& englishName) const
@@ -485,7 +466,24 @@ bool Exoplanets::backupJsonFile(bool deleteOriginal) const
 */
 void Exoplanets::readJsonFile(void)
 {
-	setEPMap(loadEPMap());
+	ep.clear();
+	PSCount = EPCountAll = EPCountPH = 0;
+	EPEccentricityAll.clear();
+	EPSemiAxisAll.clear();
+	EPMassAll.clear();
+	EPRadiusAll.clear();
+	EPPeriodAll.clear();
+	EPAngleDistanceAll.clear();
+	try
+	{
+		StelJsonCatalog(jsonCatalogPath, "stars").read([this](const QString& designation, QVariantMap& epsData) {
+			addEP(designation, epsData);
+		});
+	}
+	catch (std::runtime_error &e)
+	{
+		qDebug() << "[Exoplanets] File format is wrong! Error: " << e.what();
+	}
 }
 
 void Exoplanets::reloadCatalog(void)
@@ -511,109 +509,57 @@ void Exoplanets::reloadCatalog(void)
 }
 
 /*
-  Parse JSON file and load exoplanets to map
+  Add the exoplanets of one star of the catalog
 */
-QVariantMap Exoplanets::loadEPMap(QString path)
+void Exoplanets::addEP(const QString& epsKey, QVariantMap& epsData)
 {
-	if (path.isEmpty())
-	    path = jsonCatalogPath;
+	epsData["designation"] = epsKey;
 
-	QVariantMap map;
-	QFile jsonFile(path);
-	if (!jsonFile.open(QIODevice::ReadOnly))
-		qWarning() << "[Exoplanets] Cannot open " << QDir::toNativeSeparators(path);
-	else
+	PSCount++;
+
+	// Let's check existence the star (by designation) in our catalog...
+	StelObjectP star = GETSTELMODULE(StarMgr)->searchByName(epsKey.trimmed());
+	if (!star.isNull())
 	{
-		try
-		{
-			map = StelJsonParser::parse(jsonFile.readAll()).toMap();
-			jsonFile.close();
-		}
-		catch (std::runtime_error &e)
-		{
-			qDebug() << "[Exoplanets] File format is wrong! Error: " << e.what();
-			return QVariantMap();
-		}
+		// ...if exists, let's use our coordinates of star instead exoplanets.eu website data
+		double ra, dec;
+		StelUtils::rectToSphe(&ra, &dec, star->getJ2000EquatorialPos(StelApp::getInstance().getCore()));
+		epsData["RA"] = StelUtils::radToDecDegStr(ra, 6);
+		epsData["DE"] = StelUtils::radToDecDegStr(dec, 6);
 	}
-	return map;
-}
 
-/*
-  Set items for list of struct from data map
-*/
-void Exoplanets::setEPMap(const QVariantMap& map)
-{
-	StelCore* core = StelApp::getInstance().getCore();
-	StarMgr* smgr = GETSTELMODULE(StarMgr);
-	double ra, dec;
-	StelObjectP star;
-	ep.clear();
-	PSCount = EPCountAll = EPCountPH = 0;
-	EPEccentricityAll.clear();
-	EPSemiAxisAll.clear();
-	EPMassAll.clear();
-	EPRadiusAll.clear();
-	EPPeriodAll.clear();
-	EPAngleDistanceAll.clear();
-	QVariantMap epsMap = map.value("stars").toMap();
-	for (auto epsKey : epsMap.keys())
+	ExoplanetP eps(new Exoplanet(epsData));
+	if (eps->initialized)
 	{
-		QVariantMap epsData = epsMap.value(epsKey).toMap();
-		epsData["designation"] = epsKey;
-
-		PSCount++;
-
-		// Let's check existence the star (by designation) in our catalog...
-		star = smgr->searchByName(epsKey.trimmed());
-		if (!star.isNull())
-		{
-			// ...if exists, let's use our coordinates of star instead exoplanets.eu website data
-			StelUtils::rectToSphe(&ra, &dec, star->getJ2000EquatorialPos(core));
-			epsData["RA"] = StelUtils::radToDecDegStr(ra, 6);
-			epsData["DE"] = StelUtils::radToDecDegStr(dec, 6);
-		}
-
-		ExoplanetP eps(new Exoplanet(epsData));
-		if (eps->initialized)
-		{
-			ep.append(eps);
-			EPEccentricityAll.append(eps->getData(0));
-			EPSemiAxisAll.append(eps->getData(1));
-			EPMassAll.append(eps->getData(2));
-			EPRadiusAll.append(eps->getData(3));
-			EPPeriodAll.append(eps->getData(4));
-			EPAngleDistanceAll.append(eps->getData(5));
-			EPEffectiveTempHostStarAll.append(eps->getData(6));
-			EPYearDiscoveryAll.append(eps->getData(7));
-			EPMetallicityHostStarAll.append(eps->getData(8));
-			EPVMagHostStarAll.append(eps->getData(9));
-			EPRAHostStarAll.append(eps->getData(10));
-			EPDecHostStarAll.append(eps->getData(11));
-			EPDistanceHostStarAll.append(eps->getData(12));
-			EPMassHostStarAll.append(eps->getData(13));
-			EPRadiusHostStarAll.append(eps->getData(14));
-			EPCountAll += eps->getCountExoplanets();
-			EPCountPH += eps->getCountHabitableExoplanets();
-		}
-
+		// The brightest magnitude outside of distribution mode, as in Exoplanet::getVMagnitude()
+		ep.insert(eps, eps->Vmag<99 ? eps->Vmag : 6.f);
+		EPEccentricityAll.append(eps->getData(0));
+		EPSemiAxisAll.append(eps->getData(1));
+		EPMassAll.append(eps->getData(2));
+		EPRadiusAll.append(eps->getData(3));
+		EPPeriodAll.append(eps->getData(4));
+		EPAngleDistanceAll.append(eps->getData(5));
+		EPEffectiveTempHostStarAll.append(eps->getData(6));
+		EPYearDiscoveryAll.append(eps->getData(7));
+		EPMetallicityHostStarAll.append(eps->getData(8));
+		EPVMagHostStarAll.append(eps->getData(9));
+		EPRAHostStarAll.append(eps->getData(10));
+		EPDecHostStarAll.append(eps->getData(11));
+		EPDistanceHostStarAll.append(eps->getData(12));
+		EPMassHostStarAll.append(eps->getData(13));
+		EPRadiusHostStarAll.append(eps->getData(14));
+		EPCountAll += eps->getCountExoplanets();
+		EPCountPH += eps->getCountHabitableExoplanets();
 	}
 }
 
 int Exoplanets::getJsonFileFormatVersion(void) const
 {
 	int jsonVersion = -1;
-	QFile jsonEPCatalogFile(jsonCatalogPath);
-	if (!jsonEPCatalogFile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "[Exoplanets] Cannot open " << QDir::toNativeSeparators(jsonCatalogPath);
-		return jsonVersion;
-	}
-
 	QVariantMap map;
 	try
 	{
-		map = StelJsonParser::parse(&jsonEPCatalogFile).toMap();
-		jsonEPCatalogFile.close();
+		map = StelJsonCatalog(jsonCatalogPath, "stars").readHeader();
 	}
 	catch (std::runtime_error &e)
 	{
@@ -631,18 +577,9 @@ int Exoplanets::getJsonFileFormatVersion(void) const
 
 bool Exoplanets::checkJsonFileFormat() const
 {
-	QFile jsonEPCatalogFile(jsonCatalogPath);
-	if (!jsonEPCatalogFile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "[Exoplanets] Cannot open " << QDir::toNativeSeparators(jsonCatalogPath);
-		return false;
-	}
-
-	QVariantMap map;
 	try
 	{
-		map = StelJsonParser::parse(&jsonEPCatalogFile).toMap();
-		jsonEPCatalogFile.close();
+		StelJsonCatalog(jsonCatalogPath, "stars").readHeader();
 	}
 	catch (std::runtime_error& e)
 	{
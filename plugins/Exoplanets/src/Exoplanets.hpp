@@ -22,6 +22,7 @@
 #include "StelObjectModule.hpp"
 #include "StelObject.hpp"
 #include "StelFader.hpp"
+#include "StelObjectSkyIndex.hpp"
 #include "StelTextureTypes.hpp"
 #include "Exoplanet.hpp"
 #include <QFont>
@@ -389,11 +390,8 @@ private:
 	//! @return valid boolean, e.g. "true"
 	bool checkJsonFileFormat(void) const;
 
-	//! parse JSON file and load exoplanets to map
-	QVariantMap loadEPMap(QString path=QString());
-
-	//! set items for list of struct from data map
-	void setEPMap(const QVariantMap& map);
+	//! add the exoplanets of a star from its data map in the catalog
+	void addEP(const QString& designation, QVariantMap& epsData);
 
 	//! A fake method for strings marked for translation.
 	//! Use it instead of translations.h for N_() strings, except perhaps for
@@ -412,7 +410,7 @@ private:
 		      EPRAHostStarAll, EPDecHostStarAll, EPDistanceHostStarAll, EPMassHostStarAll, EPRadiusHostStarAll;
 
 	StelTextureSP texPointer;
-	QList<ExoplanetP> ep;
+	StelObjectSkyIndex<Exoplanet> ep;
 
 	// variables and functions for the updater
 	UpdateState updateState;
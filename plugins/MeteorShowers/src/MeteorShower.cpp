@@ -19,7 +19,6 @@
 
 #include <QtMath>
 
-#include "LandscapeMgr.hpp"
 #include "MeteorShower.hpp"
 #include "MeteorShowers.hpp"
 #include "SporadicMeteorMgr.hpp"
@@ -43,6 +42,7 @@ MeteorShower::MeteorShower(MeteorShowersMgr* mgr, const QVariantMap& map)
 	, m_pidx(0)
 	, m_radiantAlpha(0)
 	, m_radiantDelta(0)
+	, m_schedule(MeteorSchedule::seedFromName(map.value("showerID").toString()))
 {
 	if(!map.contains("showerID") || !map.contains("activity")
 		|| !map.contains("radiantAlpha") || !map.contains("radiantDelta"))
@@ -174,7 +174,7 @@ MeteorShower::MeteorShower(MeteorShowersMgr* mgr, const QVariantMap& map)
 			QVariantMap colorMap = ms.toMap();
 			QString color = colorMap.value("color").toString();
 			int intensity = colorMap.value("intensity").toInt();
-			m_colors.append(Meteor::ColorPair(color, intensity));
+			m_colors.append(MeteorPool::ColorPair(color, intensity));
 			totalIntensity += intensity;
 		}
 
@@ -188,7 +188,7 @@ MeteorShower::MeteorShower(MeteorShowersMgr* mgr, const QVariantMap& map)
 	}
 
 	if (m_colors.isEmpty()) {
-		m_colors.push_back(Meteor::ColorPair("white", 100));
+		m_colors.push_back(MeteorPool::ColorPair("white", 100));
 	}
 
 	m_status = UNDEFINED;
@@ -196,8 +196,6 @@ MeteorShower::MeteorShower(MeteorShowersMgr* mgr, const QVariantMap& map)
 
 MeteorShower::~MeteorShower()
 {
-	qDeleteAll(m_activeMeteors);
-	m_activeMeteors.clear();
 	m_colors.clear();
 }
 
@@ -221,7 +219,7 @@ bool MeteorShower::enabled() const
 	}
 }
 
-void MeteorShower::update(StelCore* core, double deltaTime)
+void MeteorShower::update(StelCore* core, double deltaTime, MeteorPool& meteors)
 {
 	if (m_status == INVALID)
 	{
@@ -265,55 +263,36 @@ void MeteorShower::update(StelCore* core, double deltaTime)
 		m_radiantDelta += m_driftDelta * daysToPeak;
 	}
 
-	// step through and update all active meteors
-	foreach (MeteorObj* m, m_activeMeteors)
-	{
-		if (!m->update(deltaTime))
-		{
-			//important to delete when no longer active
-			m_activeMeteors.removeOne(m);
-			delete m;
-		}
-	}
-
 	// paused | forward | backward ?
 	// don't create new meteors
 	if(!core->getRealTimeSpeed())
 	{
+		m_schedule.reset();
 		return;
 	}
 
-	// calculates a ZHR for the current date
-	int currentZHR = calculateZHR(currentJD);
-	if (currentZHR < 1)
-	{
-		return;
-	}
-
-	// average meteors per frame
-	float mpf = currentZHR * deltaTime / 3600.f;
-
-	// maximum amount of meteors for the current frame
-	int maxMpf = qRound(mpf);
-	maxMpf = maxMpf < 1 ? 1 : maxMpf;
+	// the ZHR of each hour only depends on its date, so that all instances get the same meteors
+	m_schedule.advance(currentJD, [this](double jd) {
+		bool found = false;
+		const QDate date = QDate::fromJulianDay(jd);
+		Activity a = hasConfirmedShower(date, found);
+		if (!found)
+		{
+			a = hasGenericShower(date, found);
+		}
+		return found ? calculateZHR(a, jd) : 0;
+	}, m_newEvents);
 
-	float rate = mpf / (float) maxMpf;
-	for (int i = 0; i < maxMpf; ++i)
+	for (const auto& event : m_newEvents)
 	{
-		float prob = (float) qrand() / (float) RAND_MAX;
-		if (prob < rate)
+		MeteorSchedule::Random rnd(event.seed);
+		// if speed is zero, use a random value
+		float speed = m_speed;
+		if (!speed)
 		{
-			MeteorObj *m = new MeteorObj(core, m_speed, m_radiantAlpha, m_radiantDelta,
-						     m_pidx, m_colors, m_mgr->getBolideTexture());
-			if (m->isAlive())
-			{
-				m_activeMeteors.append(m);
-			}
-			else
-			{
-				delete m;
-			}
+			speed = 11 + rnd.uniform() * 61;  // abs range 11-72 km/s
 		}
+		meteors.spawn(core, event.jd, rnd, m_radiantAlpha, m_radiantDelta, speed, m_colors, m_pidx);
 	}
 }
 
@@ -324,7 +303,6 @@ void MeteorShower::draw(StelCore* core)
 		return;
 	}
 	drawRadiant(core);
-	drawMeteors(core);
 }
 
 void MeteorShower::drawRadiant(StelCore *core)
@@ -375,27 +353,6 @@ void MeteorShower::drawRadiant(StelCore *core)
 	}
 }
 
-void MeteorShower::drawMeteors(StelCore *core)
-{
-	if (!core->getSkyDrawer()->getFlagHasAtmosphere())
-	{
-		return;
-	}
-
-	LandscapeMgr* landmgr = GETSTELMODULE(LandscapeMgr);
-	if (landmgr->getFlagAtmosphere() && landmgr->getLuminance() > 5.f)
-	{
-		return;
-	}
-
-	// step through and draw all active meteors
-	StelPainter painter(core->getProjection(StelCore::FrameAltAz));
-	for (auto* m : m_activeMeteors)
-	{
-		m->draw(core, painter);
-	}
-}
-
 MeteorShower::Activity MeteorShower::hasGenericShower(QDate date, bool &found) const
 {
 	int year = date.year();
@@ -454,11 +411,11 @@ MeteorShower::Activity MeteorShower::hasConfirmedShower(QDate date, bool& found)
 	return Activity();
 }
 
-int MeteorShower::calculateZHR(const double& currentJD)
+int MeteorShower::calculateZHR(const Activity& activity, const double& currentJD)
 {
-	double startJD = m_activity.start.toJulianDay();
-	double finishJD = m_activity.finish.toJulianDay();
-	double peakJD = m_activity.peak.toJulianDay();
+	double startJD = activity.start.toJulianDay();
+	double finishJD = activity.finish.toJulianDay();
+	double peakJD = activity.peak.toJulianDay();
 
 	float sd; //standard deviation
 	if (currentJD >= startJD && currentJD < peakJD) //left side of gaussian
@@ -470,8 +427,8 @@ int MeteorShower::calculateZHR(const double& currentJD)
 		sd = (finishJD - peakJD) / 2.f;
 	}
 
-	float maxZHR = m_activity.zhr == -1 ? m_activity.variable.at(1) : m_activity.zhr;
-	float minZHR = m_activity.zhr == -1 ? m_activity.variable.at(0) : 0;
+	float maxZHR = activity.zhr == -1 ? activity.variable.at(1) : activity.zhr;
+	float minZHR = activity.zhr == -1 ? activity.variable.at(0) : 0;
 
 	float gaussian = maxZHR * qExp( - qPow(currentJD - peakJD, 2) / (2 * sd * sd) ) + minZHR;
 
@@ -20,7 +20,7 @@
 #ifndef METEORSHOWER_HPP
 #define METEORSHOWER_HPP
 
-#include "MeteorObj.hpp"
+#include "MeteorPool.hpp"
 #include "MeteorShowersMgr.hpp"
 #include "StelFader.hpp"
 #include "StelObject.hpp"
@@ -68,9 +68,10 @@ public:
 
 	//! Update
 	//! @param deltaTime the time increment in seconds since the last call.
-	void update(StelCore *core, double deltaTime);
+	//! @param meteors the pool in which the new meteors of this shower are created
+	void update(StelCore *core, double deltaTime, MeteorPool& meteors);
 
-	//! Draw
+	//! Draw the radiant
 	void draw(StelCore *core);
 
 	//! Checks if we have generic data for a given date
@@ -142,7 +143,7 @@ private:
 	float m_driftDelta;                //! Drift of Dec. for each day from peak
 	QString m_parentObj;               //! Parent object for meteor shower
 	float m_pidx;                      //! The population index
-	QList<Meteor::ColorPair> m_colors; //! <colorName, 0-100>
+	QList<MeteorPool::ColorPair> m_colors; //! <colorName, 0-100>
 
 	//current information
 	Vec3d m_position;                  //! Cartesian equatorial position
@@ -150,17 +151,16 @@ private:
 	double m_radiantDelta;             //! Current Dec. for radiant of meteor shower
 	Activity m_activity;               //! Current activity
 
-	QList<MeteorObj*> m_activeMeteors; //! List with all the active meteors
+	MeteorSchedule m_schedule;         //! Times of the meteors
+	QVector<MeteorSchedule::Event> m_newEvents;
 
 	//! Draws the radiant
 	void drawRadiant(StelCore* core);
 
-	//! Draws all active meteors
-	void drawMeteors(StelCore* core);
-
 	//! Calculates the ZHR using normal distribution
+	//! @param activity the activity containing the date
 	//! @param current julian day
-	int calculateZHR(const double& currentJD);
+	int calculateZHR(const Activity& activity, const double& currentJD);
 
 	//! Gets the mean solar longitude for a specified date (approximate formula)
 	//! @param date QDate
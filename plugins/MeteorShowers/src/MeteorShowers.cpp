@@ -19,10 +19,12 @@
 
 #include <QtMath>
 
+#include "LandscapeMgr.hpp"
 #include "MeteorShowers.hpp"
 #include "StelApp.hpp"
 #include "StelModuleMgr.hpp"
 #include "StelObjectMgr.hpp"
+#include "StelSkyDrawer.hpp"
 #include "StelTextureMgr.hpp"
 #include "StelUtils.hpp"
 
@@ -42,8 +44,9 @@ void MeteorShowers::update(double deltaTime)
 	StelCore* core = StelApp::getInstance().getCore();
 	for (const auto& ms : m_meteorShowers)
 	{
-		ms->update(core, deltaTime);
+		ms->update(core, deltaTime, m_meteors);
 	}
+	m_meteors.update(core, deltaTime);
 }
 
 void MeteorShowers::draw(StelCore* core)
@@ -52,6 +55,7 @@ void MeteorShowers::draw(StelCore* core)
 	{
 		ms->draw(core);
 	}
+	drawMeteors(core);
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
 	{
@@ -59,6 +63,25 @@ void MeteorShowers::draw(StelCore* core)
 	}
 }
 
+void MeteorShowers::drawMeteors(StelCore* core)
+{
+	if (!core->getSkyDrawer()->getFlagHasAtmosphere())
+	{
+		return;
+	}
+
+	LandscapeMgr* landmgr = GETSTELMODULE(LandscapeMgr);
+	if (landmgr->getFlagAtmosphere() && landmgr->getLuminance() > 5.f)
+	{
+		return;
+	}
+
+	// draw all active meteors
+	StelPainter painter(core->getProjection(StelCore::FrameAltAz));
+	m_meteors.setBolideTexture(m_mgr->getBolideTexture());
+	m_meteors.draw(core, painter);
+}
+
 void MeteorShowers::drawPointer(StelCore* core)
 {
 	const QList<StelObjectP> newSelected = GETSTELMODULE(StelObjectMgr)->getSelectedObject("MeteorShower");
@@ -97,6 +120,7 @@ void MeteorShowers::drawPointer(StelCore* core)
 void MeteorShowers::loadMeteorShowers(const QVariantMap& map)
 {
 	m_meteorShowers.clear();
+	m_meteors.clear();
 	for (auto msKey : map.keys())
 	{
 		QVariantMap msData = map.value(msKey).toMap();
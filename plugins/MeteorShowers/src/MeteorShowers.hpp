@@ -85,6 +85,11 @@ public:
 private:
 	MeteorShowersMgr* m_mgr;
 	QList<MeteorShowerP> m_meteorShowers;
+	//! The meteors of all showers
+	MeteorPool m_meteors;
+
+	//! Draws all active meteors
+	void drawMeteors(StelCore* core);
 
 	//! Draw pointer
 	void drawPointer(StelCore* core);
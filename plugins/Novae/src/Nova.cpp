@@ -74,6 +74,8 @@ Nova::Nova(const QVariantMap& map)
 	Dec = StelUtils::getDecAngle(map.value("Dec").toString());	
 	distance = map.value("distance").toDouble();
 
+	// The position is constant, it is used by the spatial index of the module
+	StelUtils::spheToRect(RA, Dec, XYZ);
 	initialized = true;
 }
 
@@ -332,10 +334,10 @@ void Nova::draw(StelCore* core, StelPainter* painter)
 	float size, shift;
 	double mag;
 
-	StelUtils::spheToRect(RA, Dec, XYZ);
 	mag = getVMagnitudeWithExtinction(core);
 	sd->preDrawPointSource(painter);
-	float mlimit = sd->getLimitMagnitude();
+	// Corrected for the light pollution in the direction of the star
+	float mlimit = sd->getLimitMagnitude(getAltAzPosAuto(core));
 
 	if (mag <= mlimit)
 	{
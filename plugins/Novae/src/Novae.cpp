@@ -24,7 +24,7 @@
 #include "StelLocaleMgr.hpp"
 #include "StelModuleMgr.hpp"
 #include "StelObjectMgr.hpp"
-#include "StelJsonParser.hpp"
+#include "StelJsonCatalog.hpp"
 #include "StelFileMgr.hpp"
 #include "StelUtils.hpp"
 #include "StelPainter.hpp"
@@ -190,13 +190,10 @@ void Novae::draw(StelCore* core)
 	StelPainter painter(prj);
 	painter.setFont(font);
 	
-	for (const auto& n : nova)
-	{
-		if (n && n->initialized)
-		{
-			n->draw(core, &painter);
-		}
-	}
+	// The brightness varies with time, only the visible part of the sky is filtered
+	nova.processVisible(prj, std::numeric_limits<float>::max(), [&](const NovaP& n) {
+		n->draw(core, &painter);
+	});
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
 	{
@@ -227,27 +224,7 @@ void Novae::drawPointer(StelCore* core, StelPainter &painter)
 
 QList<StelObjectP> Novae::searchAround(const Vec3d& av, double limitFov, const StelCore*) const
 {
-	QList<StelObjectP> result;
-
-	Vec3d v(av);
-	v.normalize();
-	double cosLimFov = cos(limitFov * M_PI/180.);
-	Vec3d equPos;
-
-	for (const auto& n : nova)
-	{
-		if (n->initialized)
-		{
-			equPos = n->XYZ;
-			equPos.normalize();
-			if (equPos[0]*v[0] + equPos[1]*v[1] + equPos[2]*v[2]>=cosLimFov)
-			{
-				result.append(qSharedPointerCast<StelObject>(n));
-			}
-		}
-	}
-
-	return result;
+	return nova.searchAround(av, limitFov);
 }
 
 StelObjectP Novae::searchByName(const QString& englishName) const
@@ -404,77 +381,36 @@ bool Novae::backupJsonFile(bool deleteOriginal)
   Read the JSON file and create list of novae.
 */
 void Novae::readJsonFile(void)
-{
-	setNovaeMap(loadNovaeMap());
-}
-
-/*
-  Parse JSON file and load novae to map
-*/
-QVariantMap Novae::loadNovaeMap(QString path)
-{
-	if (path.isEmpty())
-	    path = novaeJsonPath;
-
-	QVariantMap map;
-	QFile jsonFile(path);
-	if (!jsonFile.open(QIODevice::ReadOnly))
-		qWarning() << "[Novae] cannot open" << QDir::toNativeSeparators(path);
-	else
-	{
-		try
-		{
-			map = StelJsonParser::parse(jsonFile.readAll()).toMap();
-			jsonFile.close();
-		}
-		catch (std::runtime_error &e)
-		{
-			qDebug() << "[Novae] File format is wrong! Error: " << e.what();
-			return QVariantMap();
-		}
-	}
-	return map;
-}
-
-/*
-  Set items for list of struct from data map
-*/
-void Novae::setNovaeMap(const QVariantMap& map)
 {
 	nova.clear();
 	novalist.clear();
 	NovaCnt=0;
-	QVariantMap novaeMap = map.value("nova").toMap();
-	for (auto novaeKey : novaeMap.keys())
+	try
 	{
-		QVariantMap novaeData = novaeMap.value(novaeKey).toMap();
-		novaeData["designation"] = QString("%1").arg(novaeKey);
+		StelJsonCatalog(novaeJsonPath, "nova").read([this](const QString& novaeKey, QVariantMap& novaeData) {
+			novaeData["designation"] = QString("%1").arg(novaeKey);
 
-		novalist.insert(novaeData.value("name").toString(), novaeData.value("peakJD").toDouble());
-		NovaCnt++;
-
-		NovaP n(new Nova(novaeData));
-		if (n->initialized)
-			nova.append(n);
+			novalist.insert(novaeData.value("name").toString(), novaeData.value("peakJD").toDouble());
+			NovaCnt++;
 
+			NovaP n(new Nova(novaeData));
+			if (n->initialized)
+				nova.insert(n);
+		});
+	}
+	catch (std::runtime_error &e)
+	{
+		qDebug() << "[Novae] File format is wrong! Error: " << e.what();
 	}
 }
 
 int Novae::getJsonFileVersion(void) const
 {	
 	int jsonVersion = -1;
-	QFile novaeJsonFile(novaeJsonPath);
-	if (!novaeJsonFile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "[Novae] cannot open" << QDir::toNativeSeparators(novaeJsonPath);
-		return jsonVersion;
-	}
-
 	QVariantMap map;
 	try
 	{
-		map = StelJsonParser::parse(&novaeJsonFile).toMap();
-		novaeJsonFile.close();
+		map = StelJsonCatalog(novaeJsonPath, "nova").readHeader();
 	}
 	catch (std::runtime_error &e)
 	{
@@ -491,18 +427,9 @@ int Novae::getJsonFileVersion(void) const
 
 bool Novae::checkJsonFileFormat() const
 {
-	QFile novaeJsonFile(novaeJsonPath);
-	if (!novaeJsonFile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "[Novae] cannot open" << QDir::toNativeSeparators(novaeJsonPath);
-		return false;
-	}
-
-	QVariantMap map;
 	try
 	{
-		map = StelJsonParser::parse(&novaeJsonFile).toMap();
-		novaeJsonFile.close();
+		StelJsonCatalog(novaeJsonPath, "nova").readHeader();
 	}
 	catch (std::runtime_error& e)
 	{
@@ -759,18 +686,10 @@ QString Novae::getNovaeList()
 float Novae::getLowerLimitBrightness()
 {
 	float lowerLimit = 10.f;
-	QFile novaeJsonFile(novaeJsonPath);
-	if (!novaeJsonFile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "[Novae] cannot open" << QDir::toNativeSeparators(novaeJsonPath);
-		return lowerLimit;
-	}
-
 	QVariantMap map;
 	try
 	{
-		map = StelJsonParser::parse(&novaeJsonFile).toMap();
-		novaeJsonFile.close();
+		map = StelJsonCatalog(novaeJsonPath, "nova").readHeader();
 	}
 	catch (std::runtime_error &e)
 	{
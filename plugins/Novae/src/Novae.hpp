@@ -22,6 +22,7 @@
 #include "StelObjectModule.hpp"
 #include "StelObject.hpp"
 #include "StelFader.hpp"
+#include "StelObjectSkyIndex.hpp"
 #include "Nova.hpp"
 #include "StelTextureTypes.hpp"
 #include <QFont>
@@ -216,18 +217,12 @@ private:
 	//! @return valid boolean, e.g. "true"
 	bool checkJsonFileFormat(void) const;
 
-	//! Parse JSON file and load novae to map
-	QVariantMap loadNovaeMap(QString path=QString());
-
-	//! Set items for list of struct from data map
-	void setNovaeMap(const QVariantMap& map);
-
 	QString novaeJsonPath;
 
 	int NovaCnt;
 
 	StelTextureSP texPointer;
-	QList<NovaP> nova;
+	StelObjectSkyIndex<Nova> nova;
 	QHash<QString, double> novalist;
 
 	// variables and functions for the updater
@@ -28,6 +28,7 @@
 #include "ObservabilityDialog.hpp"
 
 #include "Planet.hpp"
+#include "RiseSetSolver.hpp"
 #include "SolarSystem.hpp"
 #include "StarMgr.hpp"
 #include "StelActionMgr.hpp"
@@ -38,6 +39,7 @@
 #include "StelGui.hpp"
 #include "StelGuiItems.hpp"
 #include "StelIniParser.hpp"
+#include "StelJobMgr.hpp"
 #include "StelLocaleMgr.hpp"
 #include "StelModuleMgr.hpp"
 #include "StelMovementMgr.hpp"
@@ -88,7 +90,6 @@ Observability::Observability()
 	, nextFullMoon(0.)
 	, prevFullMoon(0.)
 	, GMTShift(0.)
-	, Jan1stJD(0.)
 	, twilightAltRad(0.)
 	, twilightAltDeg(0.)
 	, refractedHorizonAlt(0.)
@@ -105,7 +106,6 @@ Observability::Observability()
 	, lastJDMoon(0.)	
 	, ObserverLoc(0.)
 	, myPlanet(Q_NULLPTR)
-	, nDays(0)
 	, dmyFormat(false)
 	, hasRisen(false)
 	, configChanged(false)
@@ -140,29 +140,12 @@ Observability::Observability()
 	// Get pointer to the Moon/Sun:
 	PlanetP Moon = GETSTELMODULE(SolarSystem)->getMoon();
 	myMoon = Moon.data();
-
-	// I think this can be done in a more simple way...--BM
-	for (int i=0;i<366;i++) {
-//		sunRA[i] = 0.0; sunDec[i] = 0.0;
-//		objectRA[i] = 0.0; objectDec[i]=0.0;
-//		sunSidT[0][i]=0.0; sunSidT[1][i]=0.0;
-//		objectSidT[0][i]=0.0; objectSidT[1][i]=0.0;
-//		objectH0[i] = 0.0;
-		yearJD[i]=QPair<double, double>(0.0, 0.0);
-	};
-	// GZ Sure:
-	memset(sunRA,      0,   366*sizeof(double));
-	memset(sunDec,     0,   366*sizeof(double));
-	memset(objectRA,   0,   366*sizeof(double));
-	memset(objectDec,  0,   366*sizeof(double));
-	memset(sunSidT,    0, 2*366*sizeof(double));
-	memset(objectSidT, 0, 2*366*sizeof(double));
-	memset(objectH0,   0,   366*sizeof(double));
-
 }
 
 Observability::~Observability()
 {
+	cancelYearReports();
+
 	// Shouldn't this be in the deinit()? --BM
 	if (configDialog != Q_NULLPTR)
 		delete configDialog;
@@ -220,6 +203,10 @@ void Observability::updateMessageText()
 	// TRANSLATORS: The space at the end is significant - another sentence may follow.
 	msgPrevFullMoon	= q_("Previous Full Moon: %1 %2 at %3:%4. ");
 	msgNextFullMoon	= q_("Next Full Moon: %1 %2 at %3:%4. ");
+	msgComputing	= q_("Computing...");
+
+	// The lines of the report must be translated again.
+	displayedReport.clear();
 }
 
 double Observability::getCallOrder(StelModuleActionName actionName) const
@@ -307,12 +294,11 @@ void Observability::draw(StelCore* core)
 	myJD.first = currJD;
 	myJD.second = currJD + core->computeDeltaT(currJD)/86400.;
 
-// If the year changed, we must recompute the Sun's position for each new day:
+// If the year changed, the Sun's position for each new day is recomputed with the next yearly report:
 	if (auxy != curYear)
 	{
 		yearChanged = true;
 		curYear = auxy;
-		updateSunData(core);
 	}
 	else
 	{
@@ -358,11 +344,9 @@ void Observability::draw(StelCore* core)
 
 
 
-// If we have changed latitude (or year), we update the vector of Sun's hour 
-// angles at twilight, and re-compute Sun/Moon ephemeris (if selected):
+// If we have changed latitude (or year), we re-compute Sun/Moon ephemeris (if selected):
 	if (locChanged || yearChanged || configChanged) 
 	{
-		updateSunH();
 		lastJDMoon = 0.0;
 
 	};
@@ -471,6 +455,7 @@ void Observability::draw(StelCore* core)
 	{ 
 		souChanged=true;
 		configChanged=false;
+		displayedReport.clear();
 	};
 
 /////////////////////////////////////////////////////////////////
@@ -654,189 +639,22 @@ void Observability::draw(StelCore* core)
 	else if (!isMoon && show_Year)
 	{
 
-		if (!isStar && (souChanged || yearChanged)) // Object moves.
-			updatePlanetData(core); // Re-compute ephemeris.
-		else
-		{ // Object is fixed on the sky.
-			double auxH = calculateHourAngle(mylat,refractedHorizonAlt,selDec);
-			double auxSidT1 = toUnsignedRA(selRA - auxH); 
-			double auxSidT2 = toUnsignedRA(selRA + auxH); 
-			for (int i=0;i<nDays;i++) {
-				objectH0[i] = auxH;
-				objectRA[i] = selRA;
-				objectDec[i] = selDec;
-				objectSidT[0][i] = auxSidT1;
-				objectSidT[1][i] = auxSidT2;
-			};
-		};
-
-// Determine source observability (only if something changed):
-		if ((souChanged || locChanged || yearChanged))
+		// The yearly report is computed in the background and cached, so that
+		// changing the selection doesn't stall the frame.
+		const YearReportP report = getYearReport(core);
+		if (!report)
 		{
 			lineBestNight.clear();
-			lineObservableRange.clear();
-
-			// Check if the target cannot be seen.
-			if (culmAlt >= (halfpi - refractedHorizonAlt))
-			{
-				//ObsRange = q_("Source is not observable.");
-				//AcroCos = q_("No Acronychal nor Cosmical rise/set.");
-				lineObservableRange = msgSrcNotObs;
-				lineAcroCos = msgNoACRise;
-				lineHeli = msgNoHeliRise;
-			}
-			else
-			{ // Source can be seen.
-
-///////////////////////////
-// - Part 1. Determine the best observing night (i.e., opposition to the Sun):
-				if (show_Best_Night)
-				{
-					int selday = 0;
-					double deltaPhs = -1.0; // Initial dummy value
-					double tempPhs; 	
-					for (int i=0; i<nDays; i++) // Maximize the Sun-object separation.
-					{
-						tempPhs = Lambda(objectRA[i], objectDec[i],
-						                 sunRA[i], sunDec[i]);
-						if (tempPhs > deltaPhs)
-						{
-							selday = i;
-							deltaPhs = tempPhs;
-						}
-					}
-
-					if (selName=="Mercury" || selName=="Venus")
-					{
-						lineBestNight = msgGreatElong;
-					}
-					else 
-					{
-						lineBestNight = msgLargSSep;
-					}
-					
-					lineBestNight = lineBestNight
-					                .arg(formatAsDate(selday))
-					                .arg(deltaPhs*Rad2Deg, 0, 'f', 1);
-				}
-
-///////////////////////////////
-// - Part 2. Determine Acronychal and Cosmical rise and set:
-
-				if (show_AcroCos)
-				{
-					int acroRise, acroSet, cosRise, cosSet, heliRise, heliSet;
-
-					int result = calculateAcroCos(acroRise, acroSet,
-					                              cosRise, cosSet);
-					int resultHeli = calculateHeli(0,heliRise,heliSet);
-
-					QString acroRiseStr, acroSetStr;
-					QString cosRiseStr, cosSetStr;
-					QString heliRiseStr, heliSetStr;
-					// TODO: Possible error? Day 0 is 1 Jan. ==> IMV: Indeed! Corrected
-					acroRiseStr = (acroRise>=0)?formatAsDate(acroRise):msgNone;
-					acroSetStr = (acroSet>=0)?formatAsDate(acroSet):msgNone;
-					cosRiseStr = (cosRise>0)?formatAsDate(cosRise):msgNone;
-					cosSetStr = (cosSet>0)?formatAsDate(cosSet):msgNone;
-					heliRiseStr = (heliRise>=0)?formatAsDate(heliRise):msgNone;
-					heliSetStr = (heliSet>=0)?formatAsDate(heliSet):msgNone;
-
-
-					if (result==3 || result==1)
-						lineAcroCos =  msgAcroRise
-						               .arg(acroRiseStr)
-						               .arg(acroSetStr);
-					else
-						lineAcroCos =  msgNoAcroRise;
-					
-					if (result==3 || result==2)
-						lineAcroCos += msgCosmRise
-						               .arg(cosRiseStr)
-						               .arg(cosSetStr);
-					else
-						lineAcroCos += msgNoCosmRise;
-
-					if (resultHeli==1)
-						lineHeli = msgHeliRise.arg(heliRiseStr).arg(heliSetStr);
-					else
-						lineHeli = msgNoHeliRise;
-
-
-				}
-
-
-////////////////////////////
-// - Part 3. Determine range of good nights 
-// (i.e., above horizon before/after twilight):
-
-				if (show_Good_Nights)
-				{
-					int selday = 0;
-					int selday2 = 0;
-					bool bestBegun = false; // Are we inside a good time range?
-					bool atLeastOne = false;
-					QString dateRange;
-					bool poleNight, twiGood;
-
-					for (int i=0; i<nDays; i++)
-					{
-
-						poleNight = sunSidT[0][i]<0.0 && qAbs(sunDec[i]-mylat)>=halfpi; // Is it night during 24h?
-						twiGood = (poleNight && qAbs(objectDec[i]-mylat)<halfpi)?true:CheckRise(i);
-						
-						if (twiGood && bestBegun == false)
-						{
-							selday = i;
-							bestBegun = true;
-							atLeastOne = true;
-						};
-
-						if (!twiGood && bestBegun == true)
-						{
-							selday2 = i;
-							bestBegun = false;
-							if (selday2 > selday)
-							{
-								// FIXME: This kind of concatenation is bad for i18n.
-								if (!dateRange.isEmpty())
-									dateRange += ", ";
-								dateRange += QString("%1").arg(formatAsDateRange(selday, selday2));
-							};
-						};
-					};
-
-					// Check if there were good dates till the end of the year.
-					if (bestBegun)
-					{
-						// FIXME: This kind of concatenation is bad for i18n.
-						 if (!dateRange.isEmpty())
-							 dateRange += ", ";
-						dateRange += formatAsDateRange(selday, 0);
-					};
-					
-					if (dateRange.isEmpty()) 
-					{ 
-						if (atLeastOne) 
-						{
-							//ObsRange = q_("Observable during the whole year.");
-							lineObservableRange = msgWholeYear;
-						}
-						else
-						{
-							//ObsRange = q_("Not observable at dark night.");
-							lineObservableRange = msgNotObs;
-						};
-					}
-					else
-					{
-						// Nights when the target is above the horizon
-						lineObservableRange = msgAboveHoriz.arg(dateRange);
-					};
-
-				}; // Comes from show_Good_Nights==True"
-			}; // Comes from the "else" of "culmAlt>=..." 
-		};// Comes from  "souChanged || ..."
+			lineObservableRange = msgComputing;
+			lineAcroCos.clear();
+			lineHeli.clear();
+			displayedReport.clear();
+		}
+		else if (report != displayedReport)
+		{
+			formatYearReport(*report);
+			displayedReport = report;
+		}
 	}; // Comes from the "else" with "!isMoon"
 
 // Print all results:
@@ -958,10 +776,10 @@ double Observability::toUnsignedRA(double RA)
 ////////////////////////////////////
 
 
-QString Observability::formatAsDate(int dayNumber)
+QString Observability::formatAsDate(const SunTable& sun, int dayNumber)
 {
 	int day, month, year;
-	StelUtils::getDateFromJulianDay(yearJD[dayNumber].first, &year, &month, &day);
+	StelUtils::getDateFromJulianDay(sun.yearJD[dayNumber].first, &year, &month, &day);
 
 	QString formatString = (getDateFormat()) ? "%1 %2" : "%2 %1";
 	QString result = formatString.arg(day).arg(monthNames[month-1]);
@@ -970,12 +788,12 @@ QString Observability::formatAsDate(int dayNumber)
 
 ///////////////////////////////////////////////
 // Returns the day and month of year (to put it in format '25 Apr')
-QString Observability::formatAsDateRange(int startDay, int endDay)
+QString Observability::formatAsDateRange(const SunTable& sun, int startDay, int endDay)
 {
 	int sDay, sMonth, sYear, eDay, eMonth, eYear;
 	QString range;
-	StelUtils::getDateFromJulianDay(yearJD[startDay].first, &sYear, &sMonth, &sDay);
-	StelUtils::getDateFromJulianDay(yearJD[endDay].first, &eYear, &eMonth, &eDay);
+	StelUtils::getDateFromJulianDay(sun.yearJD[startDay].first, &sYear, &sMonth, &sDay);
+	StelUtils::getDateFromJulianDay(sun.yearJD[endDay].first, &eYear, &eMonth, &eDay);
 	if (endDay == 0)
 	{
 		eDay = 31;
@@ -1005,119 +823,350 @@ QString Observability::formatAsDateRange(int startDay, int endDay)
 
 	return range;
 }
-//////////////////////////////////////////////
+///////////////////////////////////////////////////////
+// YEARLY REPORTS, COMPUTED IN THE BACKGROUND
 
-// Compute planet's position for each day of the current year:
-void Observability::updatePlanetData(StelCore *core)
+/////////////////////////////////////////////////
+// Returns the yearly report of the current object, or a null pointer
+// while it is computed by a background job.
+Observability::YearReportP Observability::getYearReport(StelCore* core)
 {
-	double tempH;
-	for (int i=0; i<nDays; i++)
+	StelJobMgr& jobMgr = StelApp::getInstance().getJobMgr();
+	const SolarSystem* ssystem = GETSTELMODULE(SolarSystem);
+	const PlanetP earth = ssystem->getEarth();
+
+	// The tables of the Sun do not depend on the longitude.
+	const QString newSunKey = QString("%1|%2|%3|%4").arg(curYear).arg(mylat, 0, 'g', 12)
+	                          .arg(twilightAltRad, 0, 'g', 12).arg(refractedHorizonAlt, 0, 'g', 12);
+	if (newSunKey != sunKey)
 	{
-		getPlanetCoords(core, yearJD[i], objectRA[i], objectDec[i], false);
-		tempH = calculateHourAngle(mylat, refractedHorizonAlt, objectDec[i]);
-		objectH0[i] = tempH;
-		objectSidT[0][i] = toUnsignedRA(objectRA[i]-tempH);
-		objectSidT[1][i] = toUnsignedRA(objectRA[i]+tempH);
+		// Everything computed for another year or location is obsolete.
+		cancelYearReports();
+		reports.clear();
+		recentReports.clear();
+		sunKey = newSunKey;
+
+		SunTableP table(new SunTable);
+		double jan1stJD;
+		int day, month, sameYear;
+		StelUtils::getJDFromDate(&jan1stJD, curYear, 1, 1, 0, 0, 0);
+		StelUtils::getDateFromJulianDay(jan1stJD+365., &sameYear, &month, &day);
+		table->nDays = (curYear==sameYear) ? 366 : 365;
+		for (int i=0; i<table->nDays; i++)
+		{
+			table->yearJD[i].first = jan1stJD + (double)i;
+			table->yearJD[i].second = table->yearJD[i].first + core->computeDeltaT(table->yearJD[i].first)/86400.0;
+		}
+		const Mat4d matPrecession = getPrecessionMatrix(core);
+		const double latitude = mylat, twilightAlt = twilightAltRad, horizonAlt = refractedHorizonAlt;
+		sunTable = table;
+		sunJob = jobMgr.submit([=]()
+		{
+			computeSunTable(ssystem, earth, matPrecession, latitude, twilightAlt, horizonAlt, *table);
+		}, StelJobMgr::PrioritySelected);
+	}
+
+	QString key;
+	YearQuery query;
+	query.earth = earth;
+	query.ra = selRA;
+	query.dec = selDec;
+	query.culmAlt = qAbs(mylat-selDec);
+	query.latitude = mylat;
+	query.horizonAlt = refractedHorizonAlt;
+	if (isStar)
+	{
+		// Fixed objects, including the center of the screen, are identified by their position.
+		key = QString("%1|%2").arg(selRA, 0, 'f', 3).arg(selDec*Rad2Deg, 0, 'f', 2);
+	}
+	else
+	{
+		key = myPlanet->getEnglishName();
+		query.planet = ssystem->searchByEnglishName(key);
+		query.matJ2000ToEquinoxEqu = getPrecessionMatrix(core);
+	}
+
+	const YearReportP report = reports.value(key);
+	if (report)
+	{
+		recentReports.removeOne(key);
+		recentReports.append(key);
+		return report;
+	}
+
+	// Reports for objects which are not displayed anymore are not needed.
+	for (auto it = pendingReports.begin(); it != pendingReports.end();)
+	{
+		if (it.key() == key)
+		{
+			++it;
+			continue;
+		}
+		it.value()->cancel();
+		it = pendingReports.erase(it);
 	}
+	if (pendingReports.contains(key))
+		return YearReportP();
 
-// Return the planet to its current time:
-	getPlanetCoords(core, myJD, objectRA[0], objectDec[0], true);
+	YearReportP result(new YearReport);
+	const SunTableP table = sunTable;
+	const StelJobP job = jobMgr.submit([=]()
+	{
+		result->sun = table;
+		computeYearReport(ssystem, query, *table, *result);
+	}, StelJobMgr::PrioritySelected, QList<StelJobP>() << sunJob, [=]()
+	{
+		pendingReports.remove(key);
+		reports.insert(key, result);
+		recentReports.append(key);
+		while (recentReports.size() > maxReports)
+			reports.remove(recentReports.takeFirst());
+	});
+	pendingReports.insert(key, job);
+	return YearReportP();
 }
 
 /////////////////////////////////////////////////
-// Computes the Sun's RA and Dec (and the JD) for 
-// each day of the current year.
-void Observability::updateSunData(StelCore* core) 
+// Cancels the computation of the Sun table and of the reports.
+void Observability::cancelYearReports()
 {
-	int day, month, year, sameYear;
-// Get current date:
-	StelUtils::getDateFromJulianDay(myJD.first,&year,&month,&day);
+	for (const auto& job : pendingReports)
+		job->cancel();
+	pendingReports.clear();
+	if (sunJob)
+		sunJob->cancel();
+	sunJob.clear();
+}
 
-// Get JD for the Jan 1 of current year:
-	StelUtils::getJDFromDate(&Jan1stJD,year,1,1,0,0,0);
+/////////////////////////////////////////////////
+// Returns the rotation from J2000 to the equinox of date of the core.
+Mat4d Observability::getPrecessionMatrix(StelCore* core)
+{
+	const Vec3d x = core->j2000ToEquinoxEqu(Vec3d(1.,0.,0.), StelCore::RefractionOff);
+	const Vec3d y = core->j2000ToEquinoxEqu(Vec3d(0.,1.,0.), StelCore::RefractionOff);
+	const Vec3d z = core->j2000ToEquinoxEqu(Vec3d(0.,0.,1.), StelCore::RefractionOff);
+	return Mat4d(Vec4d(x[0],x[1],x[2],0.), Vec4d(y[0],y[1],y[2],0.), Vec4d(z[0],z[1],z[2],0.), Vec4d(0.,0.,0.,1.));
+}
 
-// Check if we are on a leap year:
-	StelUtils::getDateFromJulianDay(Jan1stJD+365., &sameYear, &month, &day);
-	nDays = (year==sameYear)?366:365;
-	
-// Compute Earth's position throughout the year:
-	Vec3d pos, sunPos;
-	for (int i=0; i<nDays; i++)
+/////////////////////////////////////////////////
+// Updates the lines of the report from the yearly report of the current object.
+void Observability::formatYearReport(const YearReport& report)
+{
+	lineBestNight.clear();
+	lineObservableRange.clear();
+	lineAcroCos.clear();
+	lineHeli.clear();
+
+	// Check if the target cannot be seen.
+	if (!report.observable)
 	{
-		yearJD[i].first = Jan1stJD + (double)i;
-		yearJD[i].second = yearJD[i].first+core->computeDeltaT(yearJD[i].first)/86400.0;
-		myEarth->computePosition(yearJD[i].second);
-		myEarth->computeTransMatrix(yearJD[i].first, yearJD[i].second);
-		pos = myEarth->getHeliocentricEclipticPos();
-		sunPos = core->j2000ToEquinoxEqu((StelCore::matVsop87ToJ2000)*(-pos), StelCore::RefractionOff);
-		EarthPos[i] = -pos;
-		toRADec(sunPos,sunRA[i],sunDec[i]);
-	};
+		lineObservableRange = msgSrcNotObs;
+		lineAcroCos = msgNoACRise;
+		lineHeli = msgNoHeliRise;
+		return;
+	}
 
-//Return the Earth to its current time:
-	myEarth->computePosition(myJD.second);
-	myEarth->computeTransMatrix(myJD.first, myJD.second);
-}
-///////////////////////////////////////////////////
+	const SunTable& sun = *report.sun;
 
+// - Part 1. The best observing night (i.e., opposition to the Sun):
+	if (show_Best_Night)
+	{
+		lineBestNight = (selName=="Mercury" || selName=="Venus") ? msgGreatElong : msgLargSSep;
+		lineBestNight = lineBestNight
+		                .arg(formatAsDate(sun, report.bestDay))
+		                .arg(report.bestSeparation*Rad2Deg, 0, 'f', 1);
+	}
 
-////////////////////////////////////////////
-// Computes Sun's Sidereal Times at twilight and culmination:
-void Observability::updateSunH()
-{
-	double tempH, tempH00;
+// - Part 2. Acronychal and Cosmical rise and set:
+	if (show_AcroCos)
+	{
+		// TODO: Possible error? Day 0 is 1 Jan. ==> IMV: Indeed! Corrected
+		QString acroRiseStr = (report.acroRise>=0)?formatAsDate(sun, report.acroRise):msgNone;
+		QString acroSetStr = (report.acroSet>=0)?formatAsDate(sun, report.acroSet):msgNone;
+		QString cosRiseStr = (report.cosRise>0)?formatAsDate(sun, report.cosRise):msgNone;
+		QString cosSetStr = (report.cosSet>0)?formatAsDate(sun, report.cosSet):msgNone;
+		QString heliRiseStr = (report.heliRise>=0)?formatAsDate(sun, report.heliRise):msgNone;
+		QString heliSetStr = (report.heliSet>=0)?formatAsDate(sun, report.heliSet):msgNone;
+
+		if (report.acroCos==3 || report.acroCos==1)
+			lineAcroCos = msgAcroRise.arg(acroRiseStr).arg(acroSetStr);
+		else
+			lineAcroCos = msgNoAcroRise;
+
+		if (report.acroCos==3 || report.acroCos==2)
+			lineAcroCos += msgCosmRise.arg(cosRiseStr).arg(cosSetStr);
+		else
+			lineAcroCos += msgNoCosmRise;
+
+		if (report.heli==1)
+			lineHeli = msgHeliRise.arg(heliRiseStr).arg(heliSetStr);
+		else
+			lineHeli = msgNoHeliRise;
+	}
 
-	for (int i=0; i<nDays; i++)
+// - Part 3. Range of good nights (i.e., above horizon before/after twilight):
+	if (show_Good_Nights)
 	{
-		tempH = calculateHourAngle(mylat, twilightAltRad, sunDec[i]);
-		tempH00 = calculateHourAngle(mylat, refractedHorizonAlt, sunDec[i]);
+		QString dateRange;
+		for (const auto& range : report.goodNights)
+		{
+			// FIXME: This kind of concatenation is bad for i18n.
+			if (!dateRange.isEmpty())
+				dateRange += ", ";
+			dateRange += formatAsDateRange(sun, range.first, range.second);
+		}
+
+		if (dateRange.isEmpty())
+			lineObservableRange = report.goodNightsFound ? msgWholeYear : msgNotObs;
+		else // Nights when the target is above the horizon
+			lineObservableRange = msgAboveHoriz.arg(dateRange);
+	}
+}
+
+/////////////////////////////////////////////////
+// Computes the Sun's RA and Dec for each day of the year of a table, and 
+// the Sun's Sid. Times at twilight and culmination. Runs in a worker thread.
+void Observability::computeSunTable(const SolarSystem* ssystem, const PlanetP& earth, const Mat4d& matJ2000ToEquinoxEqu,
+                                    double latitude, double twilightAlt, double horizonAlt, SunTable& table)
+{
+	for (int i=0; i<table.nDays; i++)
+	{
+		const Vec3d earthPos = ssystem->computeStateAt(earth, table.yearJD[i].second, PlanetP(), false).heliocentricPos;
+		const Vec3d sunPos = matJ2000ToEquinoxEqu.multiplyWithoutTranslation(StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(-earthPos));
+		toRADec(sunPos, table.sunRA[i], table.sunDec[i]);
+
+		double tempH = calculateHourAngle(latitude, twilightAlt, table.sunDec[i]);
+		double tempH00 = calculateHourAngle(latitude, horizonAlt, table.sunDec[i]);
 		if (tempH > 0.0)
 		{
-			sunSidT[0][i] = toUnsignedRA(sunRA[i]-tempH*(1.00278));
-			sunSidT[1][i] = toUnsignedRA(sunRA[i]+tempH*(1.00278));
+			table.sunSidT[0][i] = toUnsignedRA(table.sunRA[i]-tempH*(1.00278));
+			table.sunSidT[1][i] = toUnsignedRA(table.sunRA[i]+tempH*(1.00278));
 		}
 		else
 		{
-			sunSidT[0][i] = -1000.0;
-			sunSidT[1][i] = -1000.0;
+			table.sunSidT[0][i] = -1000.0;
+			table.sunSidT[1][i] = -1000.0;
 		}
 		
 		if (tempH00>0.0)
 		{
-			sunSidT[2][i] = toUnsignedRA(sunRA[i]+tempH00);
-			sunSidT[3][i] = toUnsignedRA(sunRA[i]-tempH00);
+			table.sunSidT[2][i] = toUnsignedRA(table.sunRA[i]+tempH00);
+			table.sunSidT[3][i] = toUnsignedRA(table.sunRA[i]-tempH00);
 		}
 		else
 		{
-			sunSidT[2][i] = -1000.0;
-			sunSidT[3][i] = -1000.0;
+			table.sunSidT[2][i] = -1000.0;
+			table.sunSidT[3][i] = -1000.0;
 		}
 	}
 }
-////////////////////////////////////////////
+///////////////////////////////////////////////////
+
+
+/////////////////////////////////////////////////
+// Computes the observability of an object through the year. Runs in a worker thread.
+void Observability::computeYearReport(const SolarSystem* ssystem, const YearQuery& query, const SunTable& sun, YearReport& report)
+{
+	report.observable = query.culmAlt < (halfpi - query.horizonAlt);
+	report.bestDay = 0;
+	report.bestSeparation = -1.0;
+	report.acroCos = report.acroRise = report.acroSet = report.cosRise = report.cosSet = 0;
+	report.heli = report.heliRise = report.heliSet = 0;
+	report.goodNightsFound = false;
+	if (!report.observable)
+		return;
+
+// Position of the object and sidereal times of its rising/setting for each day:
+	ObjectTable object;
+	for (int i=0; i<sun.nDays; i++)
+	{
+		if (query.planet)
+		{
+			const Vec3d planetPos = ssystem->computeStateAt(query.planet, sun.yearJD[i].second, PlanetP(), false).heliocentricPos;
+			const Vec3d earthPos = ssystem->computeStateAt(query.earth, sun.yearJD[i].second, PlanetP(), false).heliocentricPos;
+			toRADec(query.matJ2000ToEquinoxEqu.multiplyWithoutTranslation(StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(planetPos-earthPos)),
+			        object.RA[i], object.Dec[i]);
+		}
+		else
+		{
+			object.RA[i] = query.ra;
+			object.Dec[i] = query.dec;
+		}
+		object.H0[i] = calculateHourAngle(query.latitude, query.horizonAlt, object.Dec[i]);
+		object.SidT[0][i] = toUnsignedRA(object.RA[i]-object.H0[i]);
+		object.SidT[1][i] = toUnsignedRA(object.RA[i]+object.H0[i]);
+		// An object which never crosses the horizon is circumpolar if it is above it at its lower culmination.
+		object.circumpolar[i] = std::sin(query.horizonAlt) < std::sin(query.latitude)*std::sin(object.Dec[i])
+		                        - std::cos(query.latitude)*std::cos(object.Dec[i]);
+	}
+
+// - Part 1. Determine the best observing night (i.e., opposition to the Sun):
+	for (int i=0; i<sun.nDays; i++) // Maximize the Sun-object separation.
+	{
+		double tempPhs = Lambda(object.RA[i], object.Dec[i], sun.sunRA[i], sun.sunDec[i]);
+		if (tempPhs > report.bestSeparation)
+		{
+			report.bestDay = i;
+			report.bestSeparation = tempPhs;
+		}
+	}
+
+// - Part 2. Determine Acronychal and Cosmical rise and set:
+	report.acroCos = calculateAcroCos(sun, object, report.acroRise, report.acroSet, report.cosRise, report.cosSet);
+	report.heli = calculateHeli(sun, object, 0, report.heliRise, report.heliSet);
+
+// - Part 3. Determine range of good nights 
+// (i.e., above horizon before/after twilight):
+	int selday = 0;
+	bool bestBegun = false; // Are we inside a good time range?
+	for (int i=0; i<sun.nDays; i++)
+	{
+		bool poleNight = sun.sunSidT[0][i]<0.0 && qAbs(sun.sunDec[i]-query.latitude)>=halfpi; // Is it night during 24h?
+		bool twiGood = (poleNight && qAbs(object.Dec[i]-query.latitude)<halfpi)?true:CheckRise(sun, object, i);
+		
+		if (twiGood && bestBegun == false)
+		{
+			selday = i;
+			bestBegun = true;
+			report.goodNightsFound = true;
+		};
+
+		if (!twiGood && bestBegun == true)
+		{
+			bestBegun = false;
+			if (i > selday)
+				report.goodNights.append(qMakePair(selday, i));
+		};
+	};
+
+	// Check if there were good dates till the end of the year.
+	if (bestBegun)
+		report.goodNights.append(qMakePair(selday, 0));
+}
+///////////////////////////////////////////////////
 
 
 ///////////////////////////////////////////
 // Checks if a source can be observed with the Sun below the twilight altitude.
-bool Observability::CheckRise(int day)
+bool Observability::CheckRise(const SunTable& sun, const ObjectTable& object, int day)
 {
 
 	// If Sun can't reach twilight elevation, the target is not visible.
-	if (sunSidT[0][day]<0.0 || sunSidT[1][day]<0.0)
+	if (sun.sunSidT[0][day]<0.0 || sun.sunSidT[1][day]<0.0)
 		return false;
 
 	// Iterate over the whole year:
 	int nBin = 1000;
-	double auxSid1 = sunSidT[0][day];
-	auxSid1 += (sunSidT[0][day] < sunSidT[1][day]) ? 24.0 : 0.0;
-	double deltaT = (auxSid1-sunSidT[1][day]) / ((double)nBin);
+	double auxSid1 = sun.sunSidT[0][day];
+	auxSid1 += (sun.sunSidT[0][day] < sun.sunSidT[1][day]) ? 24.0 : 0.0;
+	double deltaT = (auxSid1-sun.sunSidT[1][day]) / ((double)nBin);
 
 	double hour; 
 	for (int j=0; j<nBin; j++)
 	{
-		hour = toUnsignedRA(sunSidT[1][day]+deltaT*(double)j - objectRA[day]);
+		hour = toUnsignedRA(sun.sunSidT[1][day]+deltaT*(double)j - object.RA[day]);
 		hour -= (hour>12.) ? 24.0 : 0.0;
-		if (qAbs(hour)<objectH0[day] || (objectH0[day] < 0.0 && alti>0.0))
+		if (qAbs(hour)<object.H0[day] || (object.H0[day] < 0.0 && object.circumpolar[day]))
 			return true;
 	}
 
@@ -1130,7 +1179,7 @@ bool Observability::CheckRise(int day)
 
 ///////////////////////////////////////////
 // Finds the dates of Acronichal (Rise, Set) and Cosmical (Rise2, Set2) dates.
-int Observability::calculateHeli(int imethod, int &heliRise, int &heliSet)
+int Observability::calculateHeli(const SunTable& sun, const ObjectTable& object, int imethod, int &heliRise, int &heliSet)
 {
 	Q_UNUSED(imethod)
 
@@ -1143,18 +1192,16 @@ int Observability::calculateHeli(int imethod, int &heliRise, int &heliSet)
 	double hourDiffHeliRise, hourDiffHeliSet;
 	bool success = false;
 
-	for (int i=0; i<366; i++)
+	for (int i=0; i<sun.nDays; i++)
 	{
-		if (objectH0[i]>0.0 && sunSidT[0][i]>0.0 && sunSidT[1][i]>0.0)
+		if (object.H0[i]>0.0 && sun.sunSidT[0][i]>0.0 && sun.sunSidT[1][i]>0.0)
 		{
 			success = true;
-			hourDiffHeliRise = toUnsignedRA(objectRA[i] - objectH0[i]);
-		//	hourDiffCosRise = hourDiffAcroRise-sunSidT[0][i];
-			hourDiffHeliRise -= sunSidT[0][i];
+			hourDiffHeliRise = toUnsignedRA(object.RA[i] - object.H0[i]);
+			hourDiffHeliRise -= sun.sunSidT[0][i];
 			
-			hourDiffHeliSet = toUnsignedRA(objectRA[i] + objectH0[i]);
-		//	hourCosDiffSet = hourDiffAcroSet - sunSidT[1][i];
-			hourDiffHeliSet -= sunSidT[1][i];
+			hourDiffHeliSet = toUnsignedRA(object.RA[i] + object.H0[i]);
+			hourDiffHeliSet -= sun.sunSidT[1][i];
 			
 			// Heliacal rise/set:
 			if (qAbs(hourDiffHeliRise) < bestDiffHeliRise)
@@ -1185,8 +1232,8 @@ int Observability::calculateHeli(int imethod, int &heliRise, int &heliSet)
 
 ///////////////////////////////////////////
 // Finds the dates of Acronichal (Rise, Set) and Cosmical (Rise2, Set2) dates.
-int Observability::calculateAcroCos(int &acroRise, int &acroSet,
-                                    int &cosRise, int &cosSet)
+int Observability::calculateAcroCos(const SunTable& sun, const ObjectTable& object,
+                                    int &acroRise, int &acroSet, int &cosRise, int &cosSet)
 {
 	acroRise = -1;
 	acroSet = -1;
@@ -1201,18 +1248,18 @@ int Observability::calculateAcroCos(int &acroRise, int &acroSet,
 	double hourDiffAcroRise, hourDiffAcroSet, hourDiffCosRise, hourCosDiffSet;
 	bool success = false;
 
-	for (int i=0; i<366; i++)
+	for (int i=0; i<sun.nDays; i++)
 	{
-		if (objectH0[i]>0.0 && sunSidT[2][i]>0.0 && sunSidT[3][i]>0.0)
+		if (object.H0[i]>0.0 && sun.sunSidT[2][i]>0.0 && sun.sunSidT[3][i]>0.0)
 		{
 			success = true;
-			hourDiffAcroRise = toUnsignedRA(objectRA[i] - objectH0[i]);
-			hourDiffCosRise = hourDiffAcroRise-sunSidT[3][i];
-			hourDiffAcroRise -= sunSidT[2][i];
+			hourDiffAcroRise = toUnsignedRA(object.RA[i] - object.H0[i]);
+			hourDiffCosRise = hourDiffAcroRise-sun.sunSidT[3][i];
+			hourDiffAcroRise -= sun.sunSidT[2][i];
 			
-			hourDiffAcroSet = toUnsignedRA(objectRA[i] + objectH0[i]);
-			hourCosDiffSet = hourDiffAcroSet - sunSidT[2][i];
-			hourDiffAcroSet -= sunSidT[3][i];
+			hourDiffAcroSet = toUnsignedRA(object.RA[i] + object.H0[i]);
+			hourCosDiffSet = hourDiffAcroSet - sun.sunSidT[2][i];
+			hourDiffAcroSet -= sun.sunSidT[3][i];
 			
 			// Acronychal rise/set:
 			if (qAbs(hourDiffAcroRise) < bestDiffAcroRise)
@@ -1394,19 +1441,10 @@ void Observability::getPlanetCoords(StelCore *core, QPair<double, double> JD, do
 
 
 //////////////////////////////////////////////
-// Solves Moon's, Sun's, or Planet's ephemeris by bissection.
+// Gets Moon's, Sun's, or Planet's rise/set/transit times from the RiseSetSolver of the core.
 bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 {
-
-	const int NUM_ITER = 100;
-	int i;
-	double hHoriz, ra, dec, raSun, decSun, tempH, /* tempJd, */ tempEphH, curSidT, eclLon;
-	QPair<double, double> tempJd;
-	//Vec3d Observer;
-
-	hHoriz = calculateHourAngle(mylat, refractedHorizonAlt, selDec);
-	bool raises = hHoriz > 0.0;
-
+	double ra, dec, raSun, decSun, eclLon;
 
 // Only recompute ephemeris from second to second (at least)
 // or if the source has changed (i.e., Sun <-> Moon). This saves resources:
@@ -1416,176 +1454,41 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 
 		lastType = bodyType;
 
-		myEarth->computePosition(myJD.second);
-		myEarth->computeTransMatrix(myJD.first, myJD.second);
-		Vec3d earthPos = myEarth->getHeliocentricEclipticPos();
-
-		if (bodyType == 1) // Sun position
+// Rise, set and culmination times of the current day come from the solver shared with the rest of Stellarium.
+// They are called 'Moon', but are also used for the Sun or planet:
+		const Planet* body = (bodyType==1) ? GETSTELMODULE(SolarSystem)->getSun().data() : ((bodyType==2) ? myMoon : myPlanet);
+		RiseSetSolver* solver = core->getRiseSetSolver();
+		hasRisen = alti > refractedHorizonAlt;
+		if (hasRisen)
 		{
-			Pos2 = core->j2000ToEquinoxEqu((StelCore::matVsop87ToJ2000)*(-earthPos), StelCore::RefractionOff);
+			MoonRise = solver->findPrevious(body, RiseSetSolver::Rise, myJD.first, 2, horizonAltitude);
+			MoonSet = solver->findNext(body, RiseSetSolver::Set, myJD.first, 2, horizonAltitude);
 		}
-		else if (bodyType==2) // Moon position
+		else
 		{
-			curSidT = myEarth->getSiderealTime(myJD.first, myJD.second)/Rad2Deg;
-			RotObserver = (Mat4d::zrotation(curSidT))*ObserverLoc;
-			LocTrans = (StelCore::matVsop87ToJ2000)*(Mat4d::translation(-earthPos));
-			myMoon->computePosition(myJD.second);
-			myMoon->computeTransMatrix(myJD.first, myJD.second);
-			Pos1 = myMoon->getHeliocentricEclipticPos();
-			Pos2 = (core->j2000ToEquinoxEqu(LocTrans*Pos1, StelCore::RefractionOff))-RotObserver;
+			MoonRise = solver->findNext(body, RiseSetSolver::Rise, myJD.first, 2, horizonAltitude);
+			MoonSet = solver->findPrevious(body, RiseSetSolver::Set, myJD.first, 2, horizonAltitude);
 		}
-		else // Planet position
-		{
-			myPlanet->computePosition(myJD.second);
-			myPlanet->computeTransMatrix(myJD.first, myJD.second);
-			Pos1 = myPlanet->getHeliocentricEclipticPos();
-			LocTrans = (StelCore::matVsop87ToJ2000)*(Mat4d::translation(-earthPos));
-			Pos2 = core->j2000ToEquinoxEqu(LocTrans*Pos1, StelCore::RefractionOff);
-		};
-
-		toRADec(Pos2,ra,dec);
-		Vec3d moonAltAz = core->equinoxEquToAltAz(Pos2, StelCore::RefractionOff);
-		hasRisen = moonAltAz[2] > refractedHorizonAlt;
-
-// Initial guesses of rise/set/transit times.
-// They are called 'Moon', but are also used for the Sun or planet:
-
-		double Hcurr = -calculateHourAngle(mylat,alti,selDec)*sign(LocPos[1]);
-		double SidT = toUnsignedRA(selRA + Hcurr);
-
-		MoonCulm = -Hcurr; 
-		MoonRise = (-hHoriz-Hcurr);
-		MoonSet = (hHoriz-Hcurr);
-
-		if (raises)
-		{
-			if (!hasRisen)
-			{
-				MoonRise += (MoonRise<0.0)?24.0:0.0;
-				MoonSet -= (MoonSet>0.0)?24.0:0.0;
-			}
-
-// Rise time:
-			tempEphH = MoonRise*TFrac;
-			MoonRise = myJD.first + (MoonRise/24.);
-			for (i=0; i<NUM_ITER; i++)
-			{
-	// Get modified coordinates:
-				tempJd.first = MoonRise;
-				tempJd.second=tempJd.first+core->computeDeltaT(tempJd.first)/86400.0;
-	
-				if (bodyType<3)
-				{
-					getSunMoonCoords(core, tempJd,
-					                 raSun, decSun,
-					                 ra, dec,
-					                 eclLon, false);
-				} else
-				{
-					getPlanetCoords(core, tempJd, ra, dec, false);
-				};
-
-				if (bodyType==1) {ra = raSun; dec = decSun;};
-
-	// Current hour angle at mod. coordinates:
-				Hcurr = toUnsignedRA(SidT-ra);
-				Hcurr -= (hasRisen)?0.0:24.;
-				Hcurr -= (Hcurr>12.)?24.0:0.0;
-
-	// H at horizon for mod. coordinates:
-				hHoriz = calculateHourAngle(mylat,refractedHorizonAlt,dec);
-	// Compute eph. times for mod. coordinates:
-				tempH = (-hHoriz-Hcurr)*TFrac;
-				if (hasRisen==false) tempH += (tempH<0.0)?24.0:0.0;
-			// Check convergence:
-				if (qAbs(tempH-tempEphH)<StelCore::JD_SECOND) break;
-			// Update rise-time estimate:
-				tempEphH = tempH;
-				MoonRise = myJD.first + (tempEphH/24.);
-			};
-
-// Set time:  
-			tempEphH = MoonSet;
-			MoonSet = myJD.first + (MoonSet/24.);
-			for (i=0; i<NUM_ITER; i++)
-			{
-	// Get modified coordinates:
-				tempJd.first = MoonSet;
-				tempJd.second=tempJd.first+core->computeDeltaT(tempJd.first)/86400.0;
-
-				
-				if (bodyType < 3)
-					getSunMoonCoords(core, tempJd,
-					                 raSun, decSun,
-					                 ra, dec,
-					                 eclLon, false);
-				else
-					getPlanetCoords(core, tempJd, ra, dec, false);
-				
-				if (bodyType==1) {ra = raSun; dec = decSun;};
-				
-	// Current hour angle at mod. coordinates:
-				Hcurr = toUnsignedRA(SidT-ra);
-				Hcurr -= (hasRisen)?24.:0.;
-				Hcurr += (Hcurr<-12.)?24.0:0.0;
-	// H at horizon for mod. coordinates:
-				hHoriz = calculateHourAngle(mylat, refractedHorizonAlt, dec);
-	// Compute eph. times for mod. coordinates:
-				tempH = (hHoriz-Hcurr)*TFrac;
-				if (!hasRisen)
-					tempH -= (tempH>0.0)?24.0:0.0;
-		// Check convergence:
-				if (qAbs(tempH-tempEphH)<StelCore::JD_SECOND)
-					break;
-		// Update set-time estimate:
-				tempEphH = tempH;
-				MoonSet = myJD.first + (tempEphH/24.);
-			};
-		} 
-		else // Comes from if(raises)
+		if (std::isnan(MoonRise) || std::isnan(MoonSet))
 		{
 			MoonSet = -1.0;
 			MoonRise = -1.0;
-		};
+		}
 
 // Culmination time:
-		tempEphH = MoonCulm;
-		MoonCulm = myJD.first + (MoonCulm/24.);
-
-		for (i=0; i<NUM_ITER; i++)
+		if (LocPos[1]<0.0)
+			MoonCulm = solver->findPrevious(body, RiseSetSolver::Transit, myJD.first, 1);
+		else
+			MoonCulm = solver->findNext(body, RiseSetSolver::Transit, myJD.first, 1);
+		if (std::isnan(MoonCulm))
+			MoonCulm = myJD.first;
+		else
 		{
-			// Get modified coordinates:
-			tempJd.first = MoonCulm;
-			tempJd.second=tempJd.first+core->computeDeltaT(tempJd.first)/86400.0;
-
-
-			if (bodyType<3)
-			{
-				getSunMoonCoords(core,tempJd,raSun,decSun,ra,dec,eclLon,false);
-			} else
-			{
-				getPlanetCoords(core,tempJd,ra,dec,false);
-			};
-
-
-			if (bodyType==1) {ra = raSun; dec = decSun;};
-
-
-	// Current hour angle at mod. coordinates:
-			Hcurr = toUnsignedRA(SidT-ra);
-			Hcurr += (LocPos[1]<0.0)?24.0:-24.0;
-			Hcurr -= (Hcurr>12.)?24.0:0.0;
-
-	// Compute eph. times for mod. coordinates:
-			tempH = -Hcurr*TFrac;
-	// Check convergence:
-			if (qAbs(tempH-tempEphH)<StelCore::JD_SECOND) break;
-			tempEphH = tempH;
-			MoonCulm = myJD.first + (tempEphH/24.);
-			culmAlt = qAbs(mylat-dec); // 90 - altitude at transit.
-		};
-
-
+			const RiseSetSolver::DayEvents events = solver->getDayEvents(body, MoonCulm);
+			const int culm = events.transits.indexOf(MoonCulm);
+			if (culm>=0)
+				culmAlt = halfpi - events.transitAltitudes.at(culm); // 90 - altitude at transit.
+		}
 
 	lastJDMoon = myJD.first;
 
@@ -1748,7 +1651,7 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 	};
 
 
-	return raises;
+	return MoonRise > 0.0;
 }
 
 
@@ -20,8 +20,12 @@
 
 #include "StelModule.hpp"
 #include <QFont>
+#include <QHash>
+#include <QSharedPointer>
 #include <QString>
+#include <QStringList>
 #include <QPair>
+#include <QVector>
 #include "VecMath.hpp"
 #include "SolarSystem.hpp"
 #include "Planet.hpp"
@@ -29,7 +33,9 @@
 
 class QPixmap;
 class StelButton;
+class StelJob;
 class ObservabilityDialog;
+typedef QSharedPointer<StelJob> StelJobP;
 
 /*! @defgroup observability Observability Analysis Plug-in
 @{
@@ -152,6 +158,69 @@ private slots:
 
 	
 private:
+	//! Sun ephemeris for each day of a year, shared by the yearly reports of all the objects.
+	struct SunTable
+	{
+		//! Days in the year (366 on leap years).
+		int nDays;
+		//! Julian Dates of the days of the year: .first=JD(UT), .second=JDE.
+		QPair<double, double> yearJD[366];
+		//! Sun's RA (hours) and Dec (radians).
+		double sunRA[366];
+		double sunDec[366];
+		//! Sidereal time of the Sun at twilight and rise/set through the year.
+		double sunSidT[4][366];
+	};
+	typedef QSharedPointer<SunTable> SunTableP;
+
+	//! Position of an object for each day of a year.
+	struct ObjectTable
+	{
+		double RA[366];
+		double Dec[366];
+		//! Hour angle at the horizon, negative if the object doesn't cross it.
+		double H0[366];
+		//! Sidereal time of the object's rising/setting.
+		double SidT[2][366];
+		//! Whether the object stays above the horizon.
+		bool circumpolar[366];
+	};
+
+	//! Parameters of a yearly report, copied in the main thread.
+	struct YearQuery
+	{
+		//! The planet, or a null pointer for a fixed object.
+		PlanetP planet;
+		PlanetP earth;
+		//! RA (hours) and Dec (radians) of a fixed object.
+		double ra, dec;
+		//! 90 degrees minus the altitude at transit (radians).
+		double culmAlt;
+		double latitude;
+		//! Geometric altitude at refraction-corrected horizon.
+		double horizonAlt;
+		Mat4d matJ2000ToEquinoxEqu;
+	};
+
+	//! Observability of an object through a year, computed by a background job.
+	struct YearReport
+	{
+		SunTableP sun;
+		//! False if the object never rises.
+		bool observable;
+		//! Day of the largest separation from the Sun, and the separation (radians).
+		int bestDay;
+		double bestSeparation;
+		//! Results of calculateAcroCos().
+		int acroCos, acroRise, acroSet, cosRise, cosSet;
+		//! Results of calculateHeli().
+		int heli, heliRise, heliSet;
+		//! Ranges of days when the object is above the horizon after darkness. An end of 0 is the end of the year.
+		QVector<QPair<int, int> > goodNights;
+		bool goodNightsFound;
+	};
+	typedef QSharedPointer<YearReport> YearReportP;
+
 	//! Configuration window.
 	ObservabilityDialog* configDialog;
 
@@ -163,7 +232,7 @@ private:
 	//! @param latitude latitude of the observer (in radians).
 	//! @param elevation elevation angle of the object (horizon=0) in radians.
 	//! @param declination declination of the object in radians.
-	double calculateHourAngle(double latitude, double elevation, double declination);
+	static double calculateHourAngle(double latitude, double elevation, double declination);
 
 	//! Computes the Hour Angle for a given Right Ascension and Sidereal Time.
 	//! @param RA right ascension (hours).
@@ -176,22 +245,22 @@ private:
 	//! @param[in] bodyType is 1 for Sun, 2 for Moon, 3 for Solar System object.
 	bool calculateSolarSystemEvents(StelCore* core, int bodyType);
 
-	//! Finds the acronycal and cosmical rise/set dates of the year for the currently-selected object.
+	//! Finds the acronycal and cosmical rise/set dates of the year for an object.
 	//! @param[out] acroRise day of year of the Acronycal rise.
 	//! @param[out] acroSet day of year of the Acronycal set.
 	//! @param[out] cosRise day of year of the Cosmical rise.
 	//! @param[out] cosSet day of year of the Cosmical set.
 	//! @returns 0 if no dates found, 1 if acronycal dates exist,
 	//! 2 if cosmical dates exist, and 3 if both are found.
-	int calculateAcroCos(int& acroRise, int& acroSet, int& cosRise, int& cosSet);
+	static int calculateAcroCos(const SunTable& sun, const ObjectTable& object, int& acroRise, int& acroSet, int& cosRise, int& cosSet);
 
 
-	//! Finds the Heliacal rise/set dates of the year for the currently-selected object.
+	//! Finds the Heliacal rise/set dates of the year for an object.
 	//! @param imethod Determines the algorithm to use (not yet implemented).
 	//! @param[out] heliRise day of year of the Heliacal rise.
 	//! @param[out] heliSet day of year of the Heliacal set.
 	//! @returns 0 if no dates found and 1 otherwise.
-	int calculateHeli(int imethod, int& heliRise, int& heliSet);
+	static int calculateHeli(const SunTable& sun, const ObjectTable& object, int imethod, int& heliRise, int& heliSet);
 
 
 	//! Computes the Sun or Moon coordinates at a given Julian date.
@@ -232,7 +301,7 @@ private:
 	//! @param Dec1 declination of point 1 (in radians)
 	//! @param RA2 idem for point 2
 	//! @param Dec2 idem for point 2
-	double Lambda(double RA1, double Dec1, double RA2, double Dec2);
+	static double Lambda(double RA1, double Dec1, double RA2, double Dec2);
 
 	//! Converts a time span in hours (given as double) in hh:mm:ss (integers).
 	//! @param t time span (double, in hours).
@@ -248,47 +317,50 @@ private:
 	//! @param dayNumber The ordinal number of a day of the year. (For example,
 	//! 25 April is the 115 or 116 day of the year.)
 	//! @todo Determine the exact format - leap year handling, etc.
-	QString formatAsDate(int dayNumber);
+	QString formatAsDate(const SunTable& sun, int dayNumber);
 
 	//! Get a date range string ("25 Apr - 10 May") from two ordinal dates.
 	//! @see formatAsDate()
 	//! @param startDay number of the first day in the period.
 	//! @param endDay number of the last day in the period.
-	QString formatAsDateRange(int startDay, int endDay);
+	QString formatAsDateRange(const SunTable& sun, int startDay, int endDay);
 
 	//! Just subtracts/adds 24h to a RA (or HA), to make it fall within 0-24h.
 	//! @param RA right ascension (in hours).
-	double toUnsignedRA(double RA);
-
-	//! Prepare arrays with data for the selected object for each day of the year.
-	//! Computes the RA, Dec and rise/set sidereal times of the selected planet
-	//! for each day of the current year.
-	//! @param core the current Stellarium core.
-	void updatePlanetData(StelCore* core);
-
-	//! Computes the Sun's RA and Dec for each day of a given year.
-	//! @param core current Stellarium core.
-	void updateSunData(StelCore* core);
-
-	//! Computes the Sun's Sid. Times at astronomical twilight (for each year's day)
-	void updateSunH();
+	static double toUnsignedRA(double RA);
 
 	//! Convert an equatorial position vector to RA/Dec.
-	void toRADec(Vec3d vec3d, double& ra, double& dec);
-
-	//! Table containing the Julian Dates of the days of the current year.
-	QPair<double, double> yearJD[366]; // GZ: This had to become a QPair of JD.first=JD_UT, JD.second=JDE
+	static void toRADec(Vec3d vec3d, double& ra, double& dec);
+
+	//! Get the yearly report of the current object for the current year and location.
+	//! The report and the Sun table it depends on are computed by background jobs.
+	//! @return a null pointer while the report is computed.
+	YearReportP getYearReport(StelCore* core);
+	//! Cancel the background computations of yearly reports.
+	void cancelYearReports();
+	//! Get the rotation from J2000 to the equinox of date of the core.
+	static Mat4d getPrecessionMatrix(StelCore* core);
+	//! Update the lines of the displayed report from a yearly report.
+	void formatYearReport(const YearReport& report);
+
+	//! Computes the Sun's RA and Dec, and the Sun's Sid. Times at twilight and rise/set,
+	//! for each day of a given year. Can run in a worker thread.
+	//! @param table the table with the dates of the days of the year, which receives the results.
+	static void computeSunTable(const SolarSystem* ssystem, const PlanetP& earth, const Mat4d& matJ2000ToEquinoxEqu,
+	                            double latitude, double twilightAlt, double horizonAlt, SunTable& table);
+	//! Computes the observability of an object through the year. Can run in a worker thread.
+	static void computeYearReport(const SolarSystem* ssystem, const YearQuery& query, const SunTable& sun, YearReport& report);
 
 	//! Check if a source is observable during a given date.
 	//! @param i the day of the year.
-	bool CheckRise(int day);
+	static bool CheckRise(const SunTable& sun, const ObjectTable& object, int day);
 
 	//! Some useful constants (almost self-explanatory).
 	// GZ: Made true constants out of those, and improved accuracy of some.
 	static const double Rad2Deg, Rad2Hr, UA, TFrac, halfpi, MoonT, RefFullMoon, MoonPerilune;
 
 	//! Some useful variables(almost self-explanatory).
-	double nextFullMoon, prevFullMoon, GMTShift, Jan1stJD;
+	double nextFullMoon, prevFullMoon, GMTShift;
 
 	//! User-defined angular altitude of astronomical twilight in radians.
 	//! See setTwilightAltitude() and getTwilightAltitude().
@@ -313,27 +385,9 @@ private:
 	//! Some place to keep JD and JDE. .first is JD(UT), .second is for the fitting JDE.
 	QPair<double, double> myJD;
 
-	//! Vectors to store Sun's RA, Dec, and Sid. Time at twilight and rise/set.
-	double sunRA[366];
-	double sunDec[366];
-
-	//! Sidereal time of the Sun at twilight and rise/set through the year.
-	double sunSidT[4][366];
-
-	//! Vectors to store planet's RA, Dec, and Sid. Time at rise/set.
-	double objectRA[366]; 
-	double objectDec[366];
-	double objectH0[366];
-
-	//! Table of the sidereal time of the object's rising/setting.
-	double objectSidT[2][366];
-
 	//! Rise/Set/Transit times for the Moon at current day:
 	double MoonRise, MoonSet, MoonCulm, lastJDMoon;
 
-	//! Vector of Earth position through the year.
-	Vec3d EarthPos[366];
-
 	//! Position of the observer relative to the Earth Center or other coordinates:
 	Vec3d ObserverLoc, Pos1, Pos2, RotObserver; //, Pos3;
 
@@ -347,8 +401,22 @@ private:
 
 	//! Current simulation year.
 	int curYear;
-	//! Days in the current year (366 on leap years).
-	int nDays;
+
+	//! Key of the Sun table, built from the year, the latitude and the altitudes of twilight and horizon.
+	QString sunKey;
+	//! Sun table for sunKey, which may still be computed by sunJob.
+	SunTableP sunTable;
+	StelJobP sunJob;
+	//! Yearly reports of the recently displayed objects for sunKey.
+	QHash<QString, YearReportP> reports;
+	//! Keys of reports, the most recently displayed last.
+	QStringList recentReports;
+	//! Jobs computing yearly reports, by key.
+	QHash<QString, StelJobP> pendingReports;
+	//! The report whose lines are displayed.
+	YearReportP displayedReport;
+	//! Number of yearly reports kept in the cache.
+	static const int maxReports = 32;
 
 	//! Untranslated name of the currently selected object.
 	//! Used to check if the selection has changed.
@@ -403,7 +471,7 @@ private:
 	QString msgSetsAt, msgRoseAt, msgSetAt, msgRisesAt, msgCircumpolar, msgNoRise, msgCulminatesAt, msgCulminatedAt, msgH, msgM, msgS;
 	QString msgSrcNotObs, msgNoACRise, msgGreatElong, msgLargSSep, msgNone, msgAcroRise, msgNoAcroRise, msgCosmRise, msgNoCosmRise;
         QString msgHeliRise, msgHeliSet, msgNoHeliRise;
-	QString msgWholeYear, msgNotObs, msgAboveHoriz, msgToday, msgThisYear, msgPrevFullMoon, msgNextFullMoon;
+	QString msgWholeYear, msgNotObs, msgAboveHoriz, msgToday, msgThisYear, msgPrevFullMoon, msgNextFullMoon, msgComputing;
 	//! @}
 
 };
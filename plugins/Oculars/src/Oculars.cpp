@@ -56,6 +56,7 @@
 #include <QPixmap>
 #include <QSignalMapper>
 
+#include <QtMath>
 #include <cmath>
 
 extern void qt_set_sequence_auto_mnemonic(bool b);
@@ -134,6 +135,7 @@ Oculars::Oculars()
 	, flagGuiPanelEnabled(false)
 	, flagDMSDegrees(false)
 	, flagSemiTransparency(false)
+	, flagClipSkyToOcular(true)
 	, flagHideGridsLines(false)
 	, flagGridLinesDisplayedMain(true)
 	, flagConstellationLinesMain(true)
@@ -245,6 +247,9 @@ bool Oculars::configureGui(bool show)
 
 void Oculars::deinit()
 {
+	StelApp::getInstance().getCore()->setSkyDrawRect(QRect());
+	StelApp::getInstance().getCore()->setVisibleDiskRadius(0.f);
+
 	// update the ini file.
 	settings->remove("ccd");
 	settings->remove("ocular");
@@ -315,8 +320,45 @@ void Oculars::deinit()
 }
 
 //! Draw any parts on the screen which are for our module
+void Oculars::update(double deltaTime)
+{
+	Q_UNUSED(deltaTime);
+	StelCore* core = StelApp::getInstance().getCore();
+	QRect skyRect;
+	float visibleRadius = 0.f;
+	// Only the eyepiece circle is visible through an opaque mask, the rest of the sky doesn't need to be drawn
+	if (flagClipSkyToOcular && flagShowOculars && !flagShowTelrad && !flagSemiTransparency && ready
+	    && selectedOcularIndex > -1 && selectedOcularIndex < oculars.count())
+	{
+		const StelProjector::StelProjectorParams params = core->getCurrentStelProjectorParams();
+		const double radius = getOcularMaskRadius(params);
+		const double centerX = (params.viewportXywh[0] + 0.5 * params.viewportXywh[2]) * params.devicePixelsPerPixel;
+		const double centerY = (params.viewportXywh[1] + 0.5 * params.viewportXywh[3]) * params.devicePixelsPerPixel;
+		// one pixel more for the antialiased rim of the reticle
+		skyRect.setCoords(qFloor(centerX - radius) - 1, qFloor(centerY - radius) - 1, qCeil(centerX + radius) + 1, qCeil(centerY + radius) + 1);
+		// and the modules can skip the objects outside of it
+		visibleRadius = radius / params.devicePixelsPerPixel + 1.f;
+	}
+	core->setSkyDrawRect(skyRect);
+	core->setVisibleDiskRadius(visibleRadius);
+}
+
+double Oculars::getOcularMaskRadius(const StelProjector::StelProjectorParams &params) const
+{
+	double inner = 0.5 * params.viewportFovDiameter * params.devicePixelsPerPixel;
+	// See if we need to scale the mask
+	if (flagScaleImageCircle && oculars[selectedOcularIndex]->appearentFOV() > 0.0 && !oculars[selectedOcularIndex]->isBinoculars())
+	{
+		inner = oculars[selectedOcularIndex]->appearentFOV() * inner / maxEyepieceAngle;
+	}
+	return inner;
+}
+
 void Oculars::draw(StelCore* core)
 {
+	// The mask and the texts cover the whole viewport
+	core->suspendSkyDrawRect();
+
 	if (flagShowTelrad)
 	{
 		paintTelrad();
@@ -725,6 +767,7 @@ void Oculars::init()
 		setFlagInitFovUsage(settings->value("use_initial_fov", false).toBool());
 		setFlagInitDirectionUsage(settings->value("use_initial_direction", false).toBool());
 		setFlagUseSemiTransparency(settings->value("use_semi_transparency", false).toBool());
+		setFlagClipSkyToOcular(settings->value("clip_sky_to_ocular", true).toBool());
 		setFlagHideGridsLines(settings->value("hide_grids_and_lines", true).toBool());
 		setFlagAutosetMountForCCD(settings->value("use_mount_autoset", false).toBool());
 		setFlagScalingFOVForTelrad(settings->value("use_telrad_fov_scaling", true).toBool());
@@ -1798,12 +1841,7 @@ void Oculars::paintOcularMask(const StelCore *core)
 	StelPainter painter(prj);
 	StelProjector::StelProjectorParams params = core->getCurrentStelProjectorParams();
 
-	double inner = 0.5 * params.viewportFovDiameter * params.devicePixelsPerPixel;
-	// See if we need to scale the mask
-	if (flagScaleImageCircle && oculars[selectedOcularIndex]->appearentFOV() > 0.0 && !oculars[selectedOcularIndex]->isBinoculars())
-	{
-		inner = oculars[selectedOcularIndex]->appearentFOV() * inner / maxEyepieceAngle;
-	}
+	double inner = getOcularMaskRadius(params);
 
 	painter.setBlending(true);
 
@@ -2535,6 +2573,19 @@ bool Oculars::getFlagUseSemiTransparency() const
 	return flagSemiTransparency;
 }
 
+void Oculars::setFlagClipSkyToOcular(const bool b)
+{
+	flagClipSkyToOcular = b;
+	settings->setValue("clip_sky_to_ocular", b);
+	settings->sync();
+	emit flagClipSkyToOcularChanged(b);
+}
+
+bool Oculars::getFlagClipSkyToOcular() const
+{
+	return flagClipSkyToOcular;
+}
+
 void Oculars::setFlagShowResolutionCriterions(const bool b)
 {
 	flagShowResolutionCriterions = b;
@@ -97,6 +97,7 @@ class Oculars : public StelModule
 	Q_PROPERTY(bool flagHideGridsLines     READ getFlagHideGridsLines      WRITE setFlagHideGridsLines      NOTIFY flagHideGridsLinesChanged)
 	Q_PROPERTY(bool flagScaleImageCircle   READ getFlagScaleImageCircle    WRITE setFlagScaleImageCircle    NOTIFY flagScaleImageCircleChanged)// flag scale image circle scaleImageCirclCheckBox
 	Q_PROPERTY(bool flagSemiTransparency   READ getFlagUseSemiTransparency WRITE setFlagUseSemiTransparency NOTIFY flagUseSemiTransparencyChanged) 
+	Q_PROPERTY(bool flagClipSkyToOcular    READ getFlagClipSkyToOcular     WRITE setFlagClipSkyToOcular     NOTIFY flagClipSkyToOcularChanged)
 	Q_PROPERTY(bool flagDMSDegrees         READ getFlagDMSDegrees          WRITE setFlagDMSDegrees          NOTIFY flagDMSDegreesChanged)
 	Q_PROPERTY(bool flagAutosetMountForCCD READ getFlagAutosetMountForCCD  WRITE setFlagAutosetMountForCCD  NOTIFY flagAutosetMountForCCDChanged)
 	Q_PROPERTY(bool flagScalingFOVForTelrad	READ getFlagScalingFOVForTelrad  WRITE setFlagScalingFOVForTelrad  NOTIFY flagScalingFOVForTelradChanged)
@@ -127,7 +128,7 @@ public:
 	//! while flagShowOculars or flagShowCCD == true.
 	virtual void handleKeys(class QKeyEvent* event);
 	virtual void handleMouseClicks(class QMouseEvent* event);
-	virtual void update(double) {;}
+	virtual void update(double deltaTime);
 
 	QString getDimensionsString(double fovX, double fovY) const;
 	QString getFOVString(double fov) const;
@@ -211,6 +212,10 @@ public slots:
 	void setFlagUseSemiTransparency(const bool b);
 	bool getFlagUseSemiTransparency(void) const;
 
+	//! With an opaque mask, draw the sky only in the bounds of the eyepiece circle (see StelCore::setSkyDrawRect())
+	void setFlagClipSkyToOcular(const bool b);
+	bool getFlagClipSkyToOcular(void) const;
+
 	void setFlagShowResolutionCriterions(const bool b);
 	bool getFlagShowResolutionCriterions(void) const;
 
@@ -247,6 +252,7 @@ signals:
 	void flagAutosetMountForCCDChanged(bool value);
 	void flagScalingFOVForTelradChanged(bool value);
 	void flagUseSemiTransparencyChanged(bool value);
+	void flagClipSkyToOcularChanged(bool value);
 	void flagShowResolutionCriterionsChanged(bool value);
 	void arrowButtonScaleChanged(double value);
 	void flagInitDirectionUsageChanged(bool value);
@@ -278,6 +284,8 @@ private:
 	void paintCrosshairs();
 	//! Paint the mask into the viewport.
 	void paintOcularMask(const StelCore * core);
+	//! Radius of the eyepiece circle in device pixels
+	double getOcularMaskRadius(const StelProjector::StelProjectorParams& params) const;
 	//! Renders the three Telrad circles, but only if not in ocular mode.
 	void paintTelrad();
 
@@ -366,6 +374,7 @@ private:
 	bool flagGuiPanelEnabled;        //!< Display the GUI control panel
 	bool flagDMSDegrees;             //!< Use decimal degrees in CCD frame display
 	bool flagSemiTransparency;       //!< Draw the area outside the ocular circle not black but let some stars through.
+	bool flagClipSkyToOcular;        //!< Restrict the sky drawing to the bounds of the ocular circle, if the mask is opaque.
 	bool flagHideGridsLines;         //!< Switch off all grids and lines of GridMgr while in Ocular view
 	bool flagGridLinesDisplayedMain; //!< keep track of gridline display while possibly suppressing their display.
 	bool flagConstellationLinesMain; //!< keep track of constellation display while possibly suppressing their display.
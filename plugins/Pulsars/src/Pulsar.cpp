@@ -110,6 +110,8 @@ Pulsar::Pulsar(const QVariantMap& map)
 		pderivative = getP1(period, pfrequency);
 	}
 
+	// The position is constant, it is used by the spatial index of the module
+	StelUtils::spheToRect(RA, DE, XYZ);
 	initialized = true;
 }
 
@@ -422,7 +424,6 @@ void Pulsar::draw(StelCore* core, StelPainter *painter)
 {
 	StelSkyDrawer* sd = core->getSkyDrawer();
 	float mag = getVMagnitudeWithExtinction(core);
-	StelUtils::spheToRect(RA, DE, XYZ);
 
 	Vec3d win;
 	// Check visibility of pulsar
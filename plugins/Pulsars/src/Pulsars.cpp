@@ -18,6 +18,7 @@
 
 #include "StelProjector.hpp"
 #include "StelPainter.hpp"
+#include "StelSkyDrawer.hpp"
 #include "StelApp.hpp"
 #include "StelCore.hpp"
 #include "StelGui.hpp"
@@ -26,7 +27,7 @@
 #include "StelModuleMgr.hpp"
 #include "StelObjectMgr.hpp"
 #include "StelTextureMgr.hpp"
-#include "StelJsonParser.hpp"
+#include "StelJsonCatalog.hpp"
 #include "StelFileMgr.hpp"
 #include "StelUtils.hpp"
 #include "StelTranslator.hpp"
@@ -226,11 +227,11 @@ void Pulsars::draw(StelCore* core)
 	StelPainter painter(prj);
 	painter.setFont(font);
 	
-	for (const auto& pulsar : psr)
-	{
-		if (pulsar && pulsar->initialized)
-			pulsar->draw(core, &painter);
-	}
+	// The objects fainter than the limit are not drawn, except in distribution mode
+	const float maxMag = Pulsar::distributionMode ? std::numeric_limits<float>::max() : core->getSkyDrawer()->getLimitMagnitude();
+	psr.processVisible(prj, maxMag, [&](const PulsarP& pulsar) {
+		pulsar->draw(core, &painter);
+	});
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
 		drawPointer(core, painter);
@@ -262,30 +263,10 @@ void Pulsars::drawPointer(StelCore* core, StelPainter& painter)
 
 QList<StelObjectP> Pulsars::searchAround(const Vec3d& av, double limitFov, const StelCore*) const
 {
-	QList<StelObjectP> result;
-
 	if (!flagShowPulsars)
-		return result;
-
-	Vec3d v(av);
-	v.normalize();
-	double cosLimFov = cos(limitFov * M_PI/180.);
-	Vec3d equPos;
+		return QList<StelObjectP>();
 
-	for (const auto& pulsar : psr)
-	{
-		if (pulsar->initialized)
-		{
-			equPos = pulsar->XYZ;
-			equPos.normalize();
-			if (equPos[0]*v[0] + equPos[1]*v[1] + equPos[2]*v[2]>=cosLimFov)
-			{
-				result.append(qSharedPointerCast<StelObject>(pulsar));
-			}
-		}
-	}
-
-	return result;
+	return psr.searchAround(av, limitFov);
 }
 
 StelObjectP Pulsars::searchByName(const QString& englishName) const
@@ -457,75 +438,34 @@ bool Pulsars::backupJsonFile(bool deleteOriginal)
   Read the JSON file and create list of pulsars.
 */
 void Pulsars::readJsonFile(void)
-{
-	setPSRMap(loadPSRMap());
-}
-
-/*
-  Parse JSON file and load pulsars to map
-*/
-QVariantMap Pulsars::loadPSRMap(QString path)
-{
-	if (path.isEmpty())
-	    path = jsonCatalogPath;
-
-	QVariantMap map;
-	QFile jsonFile(path);
-	if (!jsonFile.open(QIODevice::ReadOnly))
-		qWarning() << "[Pulsars] Cannot open" << QDir::toNativeSeparators(path);
-	else
-	{
-		try
-		{
-			map = StelJsonParser::parse(jsonFile.readAll()).toMap();
-			jsonFile.close();
-		}
-		catch (std::runtime_error &e)
-		{
-			qDebug() << "[Pulsars] File format is wrong! Error: " << e.what();
-			return QVariantMap();
-		}
-	}
-	return map;
-}
-
-/*
-  Set items for list of struct from data map
-*/
-void Pulsars::setPSRMap(const QVariantMap& map)
 {
 	psr.clear();
 	PsrCount = 0;
-	QVariantMap psrMap = map.value("pulsars").toMap();
-	for (auto psrKey : psrMap.keys())
+	try
 	{
-		QVariantMap psrData = psrMap.value(psrKey).toMap();
-		psrData["designation"] = psrKey;
-
-		PsrCount++;
+		StelJsonCatalog(jsonCatalogPath, "pulsars").read([this](const QString& psrKey, QVariantMap& psrData) {
+			psrData["designation"] = psrKey;
 
-		PulsarP pulsar(new Pulsar(psrData));
-		if (pulsar->initialized)
-			psr.append(pulsar);
+			PsrCount++;
 
+			PulsarP pulsar(new Pulsar(psrData));
+			if (pulsar->initialized)
+				psr.insert(pulsar, pulsar->distance + 6.f);
+		});
+	}
+	catch (std::runtime_error &e)
+	{
+		qDebug() << "[Pulsars] File format is wrong! Error: " << e.what();
 	}
 }
 
 int Pulsars::getJsonFileFormatVersion(void)
 {
 	int jsonVersion = -1;
-	QFile jsonPSRCatalogFile(jsonCatalogPath);
-	if (!jsonPSRCatalogFile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "[Pulsars] Cannot open" << QDir::toNativeSeparators(jsonCatalogPath);
-		return jsonVersion;
-	}
-
 	QVariantMap map;
 	try
 	{
-		map = StelJsonParser::parse(&jsonPSRCatalogFile).toMap();
-		jsonPSRCatalogFile.close();
+		map = StelJsonCatalog(jsonCatalogPath, "pulsars").readHeader();
 	}
 	catch (std::runtime_error &e)
 	{
@@ -542,18 +482,9 @@ int Pulsars::getJsonFileFormatVersion(void)
 
 bool Pulsars::checkJsonFileFormat()
 {
-	QFile jsonPSRCatalogFile(jsonCatalogPath);
-	if (!jsonPSRCatalogFile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "[Pulsars] Cannot open" << QDir::toNativeSeparators(jsonCatalogPath);
-		return false;
-	}
-
-	QVariantMap map;
 	try
 	{
-		map = StelJsonParser::parse(&jsonPSRCatalogFile).toMap();		
-		jsonPSRCatalogFile.close();
+		StelJsonCatalog(jsonCatalogPath, "pulsars").readHeader();
 	}
 	catch (std::runtime_error& e)
 	{
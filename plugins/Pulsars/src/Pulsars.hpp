@@ -22,6 +22,7 @@
 #include "StelObjectModule.hpp"
 #include "StelObject.hpp"
 #include "StelFader.hpp"
+#include "StelObjectSkyIndex.hpp"
 #include "StelTextureTypes.hpp"
 #include "Pulsar.hpp"
 #include <QFont>
@@ -301,16 +302,10 @@ private:
 	//! @return valid boolean, e.g. "true"
 	bool checkJsonFileFormat(void);
 
-	//! parse JSON file and load pulsars to map
-	QVariantMap loadPSRMap(QString path=QString());
-
-	//! set items for list of struct from data map
-	void setPSRMap(const QVariantMap& map);
-
 	QString jsonCatalogPath;
 
 	StelTextureSP texPointer;
-	QList<PulsarP> psr;
+	StelObjectSkyIndex<Pulsar> psr;
 
 	int PsrCount;
 
@@ -89,6 +89,8 @@ Quasar::Quasar(const QVariantMap& map)
 		f20 = -9999.f;
 	sclass = map.value("sclass").toString();
 
+	// The position is constant, it is used by the spatial index of the module
+	StelUtils::spheToRect(qRA, qDE, XYZ);
 	initialized = true;
 }
 
@@ -213,8 +215,6 @@ void Quasar::draw(StelCore* core, StelPainter& painter)
 {
 	StelSkyDrawer* sd = core->getSkyDrawer();
 
-	StelUtils::spheToRect(qRA, qDE, XYZ);
-
 	Vec3d win;
 	// Check visibility of quasar
 	if (!(painter.getProjector()->projectCheck(XYZ, win)))
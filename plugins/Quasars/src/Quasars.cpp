@@ -19,6 +19,7 @@
 
 #include "StelProjector.hpp"
 #include "StelPainter.hpp"
+#include "StelSkyDrawer.hpp"
 #include "StelApp.hpp"
 #include "StelCore.hpp"
 #include "StelGui.hpp"
@@ -27,7 +28,7 @@
 #include "StelModuleMgr.hpp"
 #include "StelObjectMgr.hpp"
 #include "StelTextureMgr.hpp"
-#include "StelJsonParser.hpp"
+#include "StelJsonCatalog.hpp"
 #include "StelFileMgr.hpp"
 #include "StelUtils.hpp"
 #include "StelTranslator.hpp"
@@ -229,11 +230,11 @@ void Quasars::draw(StelCore* core)
 	StelPainter painter(prj);
 	painter.setFont(font);
 
-	for (const auto& quasar : QSO)
-	{
-		if (quasar && quasar->initialized)
-			quasar->draw(core, painter);
-	}
+	// The objects fainter than the limit are not drawn, except in distribution mode
+	const float maxMag = Quasar::distributionMode ? std::numeric_limits<float>::max() : core->getSkyDrawer()->getLimitMagnitude();
+	QSO.processVisible(prj, maxMag, [&](const QuasarP& quasar) {
+		quasar->draw(core, painter);
+	});
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
 		drawPointer(core, painter);
@@ -265,30 +266,10 @@ void Quasars::drawPointer(StelCore* core, StelPainter& painter)
 
 QList<StelObjectP> Quasars::searchAround(const Vec3d& av, double limitFov, const StelCore*) const
 {
-	QList<StelObjectP> result;
-
 	if (!flagShowQuasars)
-		return result;
-
-	Vec3d v(av);
-	v.normalize();
-	double cosLimFov = cos(limitFov * M_PI/180.);
-	Vec3d equPos;
+		return QList<StelObjectP>();
 
-	for (const auto& quasar : QSO)
-	{
-		if (quasar->initialized)
-		{
-			equPos = quasar->XYZ;
-			equPos.normalize();
-			if (equPos[0]*v[0] + equPos[1]*v[1] + equPos[2]*v[2]>=cosLimFov)
-			{
-				result.append(qSharedPointerCast<StelObject>(quasar));
-			}
-		}
-	}
-
-	return result;
+	return QSO.searchAround(av, limitFov);
 }
 
 StelObjectP Quasars::searchByName(const QString& englishName) const
@@ -423,75 +404,35 @@ bool Quasars::backupJsonFile(bool deleteOriginal)
   Read the JSON file and create list of quasars.
 */
 void Quasars::readJsonFile(void)
-{
-	setQSOMap(loadQSOMap());
-}
-
-/*
-  Parse JSON file and load quasarss to map
-*/
-QVariantMap Quasars::loadQSOMap(QString path)
-{
-	if (path.isEmpty())
-	    path = catalogJsonPath;
-
-	QVariantMap map;
-	QFile jsonFile(path);
-	if (!jsonFile.open(QIODevice::ReadOnly))
-		qWarning() << "[Quasars] Cannot open" << QDir::toNativeSeparators(path);
-	else
-	{
-		try
-		{
-			map = StelJsonParser::parse(jsonFile.readAll()).toMap();
-			jsonFile.close();
-		}
-		catch (std::runtime_error &e)
-		{
-			qDebug() << "[Quasars] File format is wrong! Error: " << e.what();
-			return QVariantMap();
-		}
-	}
-	return map;
-}
-
-/*
-  Set items for list of struct from data map
-*/
-void Quasars::setQSOMap(const QVariantMap& map)
 {
 	QSO.clear();
 	QsrCount = 0;
-	QVariantMap qsoMap = map.value("quasars").toMap();
-	for (auto qsoKey : qsoMap.keys())
+	try
 	{
-		QVariantMap qsoData = qsoMap.value(qsoKey).toMap();
-		qsoData["designation"] = qsoKey;
-
-		QsrCount++;
+		StelJsonCatalog(catalogJsonPath, "quasars").read([this](const QString& qsoKey, QVariantMap& qsoData) {
+			qsoData["designation"] = qsoKey;
 
-		QuasarP quasar(new Quasar(qsoData));
-		if (quasar->initialized)
-			QSO.append(quasar);
+			QsrCount++;
 
+			QuasarP quasar(new Quasar(qsoData));
+			if (quasar->initialized)
+				QSO.insert(quasar, quasar->VMagnitude - qMax(0.f, quasar->shiftVisibility));
+		});
 	}
+	catch (std::runtime_error &e)
+	{
+		qDebug() << "[Quasars] File format is wrong! Error: " << e.what();
+	}
+	invalidateNameIndex();
 }
 
 int Quasars::getJsonFileFormatVersion(void)
 {
 	int jsonVersion = -1;
-	QFile catalogJsonFile(catalogJsonPath);
-	if (!catalogJsonFile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "[Quasars] Cannot open" << QDir::toNativeSeparators(catalogJsonPath);
-		return jsonVersion;
-	}
-
 	QVariantMap map;
 	try
 	{
-		map = StelJsonParser::parse(&catalogJsonFile).toMap();
-		catalogJsonFile.close();
+		map = StelJsonCatalog(catalogJsonPath, "quasars").readHeader();
 	}
 	catch (std::runtime_error &e)
 	{
@@ -508,18 +449,9 @@ int Quasars::getJsonFileFormatVersion(void)
 
 bool Quasars::checkJsonFileFormat()
 {
-	QFile catalogJsonFile(catalogJsonPath);
-	if (!catalogJsonFile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "[Quasars] Cannot open" << QDir::toNativeSeparators(catalogJsonPath);
-		return false;
-	}
-
-	QVariantMap map;
 	try
 	{
-		map = StelJsonParser::parse(&catalogJsonFile).toMap();
-		catalogJsonFile.close();
+		StelJsonCatalog(catalogJsonPath, "quasars").readHeader();
 	}
 	catch (std::runtime_error& e)
 	{
@@ -857,6 +789,8 @@ void Quasars::setFlagShowQuasars(bool b)
 	if (b!=flagShowQuasars)
 	{
 		flagShowQuasars=b;
+		// The names are listed only while the quasars are shown
+		invalidateNameIndex();
 		emit flagQuasarsVisibilityChanged(b);
 	}
 }
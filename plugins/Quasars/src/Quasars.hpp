@@ -21,6 +21,7 @@
 
 #include "StelObjectModule.hpp"
 #include "StelObject.hpp"
+#include "StelObjectSkyIndex.hpp"
 #include "StelTextureTypes.hpp"
 #include "Quasar.hpp"
 #include <QFont>
@@ -264,18 +265,12 @@ private:
 	//! @return valid boolean, e.g. "true"
 	bool checkJsonFileFormat(void);
 
-	//! parse JSON file and load quasars to map
-	QVariantMap loadQSOMap(QString path=QString());
-
-	//! set items for list of struct from data map
-	void setQSOMap(const QVariantMap& map);
-
 	QString catalogJsonPath;
 
 	int QsrCount;
 
 	StelTextureSP texPointer;
-	QList<QuasarP> QSO;
+	StelObjectSkyIndex<Quasar> QSO;
 
 	// variables and functions for the updater
 	UpdateState updateState;
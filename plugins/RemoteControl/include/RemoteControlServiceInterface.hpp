@@ -77,6 +77,15 @@ public:
 		this->responseData.append(data);
 	}
 
+	//! Returns the HTTP status, or -1 if it was not set (which means 200 OK)
+	int getStatus() const { return status; }
+	//! Returns the HTTP status text
+	const QByteArray& getStatusText() const { return statusText; }
+	//! Returns the value of a header, or an empty array if not set
+	QByteArray getHeader(const QByteArray& name) const { return headers.value(name); }
+	//! Returns the current return data
+	const QByteArray& getData() const { return responseData; }
+
 	//! Sets the HTTP status to 400, and sets the response data to the message
 	void writeRequestError(const QByteArray& msg)
 	{
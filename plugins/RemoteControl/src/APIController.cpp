@@ -19,13 +19,14 @@
 
 #include "APIController.hpp"
 #include "StelApp.hpp"
+#include <QElapsedTimer>
 #include <QJsonDocument>
 #include <QThread>
 
 int APIServiceResponse::metaTypeId = qRegisterMetaType<APIServiceResponse>();
 int APIServiceResponse::parametersMetaTypeId = qRegisterMetaType<APIParameters>();
 
-APIController::APIController(int prefixLength, QObject* parent) : HttpRequestHandler(parent), m_prefixLength(prefixLength)
+APIController::APIController(int prefixLength, QObject* parent) : HttpRequestHandler(parent), m_prefixLength(prefixLength), m_processQueued(false)
 {
 
 }
@@ -38,6 +39,9 @@ APIController::~APIController()
 
 void APIController::update(double deltaTime)
 {
+	//requests may wait longer in the event queue than for the next frame when the main thread is busy
+	processPendingCalls();
+
 	for (auto& service : m_serviceMap)
 	{
 		service->update(deltaTime);
@@ -55,16 +59,53 @@ void APIController::registerService(RemoteControlServiceInterface *service)
 	m_serviceMap.insert(key, service);
 }
 
-void APIController::performGet(RemoteControlServiceInterface *service, const QByteArray &operation, const APIParameters &parameters, APIServiceResponse *response)
+void APIController::processPendingCalls()
 {
 	Q_ASSERT(QThread::currentThread() == StelApp::getInstance().thread());
-	service->get(operation, parameters, *response);
+
+	QMutexLocker locker(&m_pendingMutex);
+	m_processQueued = false;
+	while(!m_pendingCalls.isEmpty())
+	{
+		PendingCallP call = m_pendingCalls.takeFirst();
+		locker.unlock();
+
+		if(call->isPost)
+			call->service->post(call->operation, call->parameters, call->data, call->response);
+		else
+			call->service->get(call->operation, call->parameters, call->response);
+
+		locker.relock();
+		call->done = true;
+		//wake the waiting workers right away instead of after the whole queue
+		m_pendingDone.wakeAll();
+	}
 }
 
-void APIController::performPost(RemoteControlServiceInterface *service, const QByteArray &operation, const APIParameters &parameters, const QByteArray &data, APIServiceResponse *response)
+bool APIController::runInMainThread(const PendingCallP &call)
 {
-	Q_ASSERT(QThread::currentThread() == StelApp::getInstance().thread());
-	service->post(operation, parameters, data, *response);
+	QMutexLocker locker(&m_pendingMutex);
+	m_pendingCalls.append(call);
+	if(!m_processQueued)
+	{
+		//one event for all requests which arrive until the main thread gets to it
+		m_processQueued = true;
+		QMetaObject::invokeMethod(this,"processPendingCalls",Qt::QueuedConnection);
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	while(!call->done)
+	{
+		qint64 remaining = MAIN_THREAD_TIMEOUT - timer.elapsed();
+		if(remaining <= 0 || (!m_pendingDone.wait(&m_pendingMutex, static_cast<unsigned long>(remaining)) && !call->done))
+		{
+			//drop the call if it has not been started, otherwise the main thread finishes it without a receiver
+			m_pendingCalls.removeOne(call);
+			return false;
+		}
+	}
+	return true;
 }
 
 void APIController::service(HttpRequest &request, HttpResponse &response)
@@ -101,21 +142,27 @@ void APIController::service(HttpRequest &request, HttpResponse &response)
 #ifdef FORCE_THREADED_SERVICES
 			sv->get(operation, request.getParameterMap(), apiresponse);
 #else
+			AbstractAPIService* asv = dynamic_cast<AbstractAPIService*>(sv);
 			if(sv->isThreadSafe())
 			{
 				sv->get(operation,request.getParameterMap(), apiresponse);
 			}
-			else
+			else if(!asv || !asv->getSnapshot(operation, request.getParameterMap(), apiresponse))
 			{
-				//invoke it in the main thread!
-				QMetaObject::invokeMethod(this,"performGet",Qt::BlockingQueuedConnection,
-							  Q_ARG(RemoteControlServiceInterface*, sv),
-							  Q_ARG(QByteArray, operation),
-							  Q_ARG(APIParameters, request.getParameterMap()),
-							  Q_ARG(APIServiceResponse*, &apiresponse));
+				//queue it for the main thread!
+				PendingCallP call(new PendingCall());
+				call->service = sv;
+				call->operation = operation;
+				call->parameters = request.getParameterMap();
+				if(!runInMainThread(call))
+				{
+					writeTimeout(response);
+					return;
+				}
+				apiresponse = call->response;
 			}
 #endif
-			applyAPIResponse(apiresponse,response);
+			applyAPIResponse(apiresponse,request,response);
 		}
 		else if (request.getMethod()=="POST")
 		{
@@ -128,15 +175,21 @@ void APIController::service(HttpRequest &request, HttpResponse &response)
 			}
 			else
 			{
-				QMetaObject::invokeMethod(this,"performPost",Qt::BlockingQueuedConnection,
-							  Q_ARG(RemoteControlServiceInterface*, sv),
-							  Q_ARG(QByteArray, operation),
-							  Q_ARG(APIParameters, request.getParameterMap()),
-							  Q_ARG(QByteArray, request.getBody()),
-							  Q_ARG(APIServiceResponse*, &apiresponse));
+				PendingCallP call(new PendingCall());
+				call->service = sv;
+				call->isPost = true;
+				call->operation = operation;
+				call->parameters = request.getParameterMap();
+				call->data = request.getBody();
+				if(!runInMainThread(call))
+				{
+					writeTimeout(response);
+					return;
+				}
+				apiresponse = call->response;
 			}
 #endif
-			applyAPIResponse(apiresponse,response);
+			applyAPIResponse(apiresponse,request,response);
 		}
 		else
 		{
@@ -158,7 +211,14 @@ void APIController::service(HttpRequest &request, HttpResponse &response)
 	}
 }
 
-void APIController::applyAPIResponse(const APIServiceResponse &apiresponse, HttpResponse &httpresponse)
+void APIController::writeTimeout(HttpResponse &httpresponse)
+{
+	httpresponse.setStatus(503,"Service Unavailable");
+	httpresponse.setHeader("Retry-After","1");
+	httpresponse.write("Stellarium is busy, try again later",true);
+}
+
+void APIController::applyAPIResponse(const APIServiceResponse &apiresponse, const HttpRequest &request, HttpResponse &httpresponse)
 {
 	if(apiresponse.status != -1)
 	{
@@ -168,6 +228,15 @@ void APIController::applyAPIResponse(const APIServiceResponse &apiresponse, Http
 	//apply headers
 	httpresponse.getHeaders().unite(apiresponse.headers);
 
+	//replies from a StateSnapshot carry an ETag, the client already has the data if it did not change
+	const QByteArray etag = apiresponse.headers.value("ETag");
+	if(!etag.isEmpty() && request.getHeader("If-None-Match") == etag)
+	{
+		httpresponse.setStatus(304,"Not Modified");
+		httpresponse.write(QByteArray(),true);
+		return;
+	}
+
 	//send response data, if any
 	if(apiresponse.responseData.isEmpty())
 	{
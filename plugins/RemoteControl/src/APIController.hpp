@@ -23,6 +23,10 @@
 #include "httpserver/httprequesthandler.h"
 #include "AbstractAPIService.hpp"
 
+#include <QMutex>
+#include <QSharedPointer>
+#include <QWaitCondition>
+
 //! @ingroup remoteControl
 //! This class handles the API-specific requests and dispatches them to the correct RemoteControlServiceInterface implementation.
 //! Services are registered using registerService().
@@ -38,28 +42,63 @@ public:
 	virtual ~APIController();
 
 	//! Should be called each frame from the main thread, like from StelModule::update.
-	//! Passed on to each AbstractAPIService::update method for optional processing.
+	//! Runs the requests which are still queued for the main thread, and passes the call on
+	//! to each AbstractAPIService::update method for optional processing.
 	void update(double deltaTime);
 
 	//! Handles an API-specific request. It finds out which RemoteControlServiceInterface to use
 	//! depending on the service name (first part of path until slash). An error is returned for invalid requests.
 	//! If a service was found, the request is passed on to its RemoteControlServiceInterface::get or RemoteControlServiceInterface::post
 	//! method depending on the HTTP request type.
-	//! If RemoteControlServiceInterface::isThreadSafe is false, these methods are called in the Stellarium main thread
-	//! using QMetaObject::invokeMethod, otherwise they are directly executed in the current thread (HTTP worker thread).
+	//! If RemoteControlServiceInterface::isThreadSafe is false, the request is first offered to AbstractAPIService::getSnapshot
+	//! in the current thread (HTTP worker thread). If it is not answered from the snapshot, it is queued for the Stellarium main thread,
+	//! which runs all queued requests at once, either from its event loop or at the latest in the next update().
+	//! The worker thread waits for its own request only, and replies with HTTP 503 if the main thread did not get to it
+	//! within MAIN_THREAD_TIMEOUT. Thread-safe services are directly executed in the worker thread.
+	//! Replies with an ETag header (see StateSnapshot::writeReply) are answered with HTTP 304 if the client sent the same
+	//! tag in If-None-Match.
 	virtual void service(HttpRequest& request, HttpResponse& response);
 
 	//! Registers a service with the APIController.
 	//! The RemoteControlServiceInterface::getPath() determines the request path of the service.
 	void registerService(RemoteControlServiceInterface* service);
+	//! Returns the service registered for the path, or Q_NULLPTR
+	RemoteControlServiceInterface* getService(const QByteArray& path) const { return m_serviceMap.value(path, Q_NULLPTR); }
 private slots:
-	void performGet(RemoteControlServiceInterface* service, const QByteArray& operation, const APIParameters& parameters, APIServiceResponse* response);
-	void performPost(RemoteControlServiceInterface* service, const QByteArray& operation, const APIParameters& parameters, const QByteArray& data, APIServiceResponse* response);
+	//! Runs all queued requests, must be called in the main thread
+	void processPendingCalls();
 private:
-	static void applyAPIResponse(const APIServiceResponse& apiresponse, HttpResponse& httpresponse);
+	//! A request which has to be executed in the main thread
+	struct PendingCall
+	{
+		PendingCall() : service(Q_NULLPTR), isPost(false), done(false) {}
+		RemoteControlServiceInterface* service;
+		bool isPost;
+		QByteArray operation;
+		APIParameters parameters;
+		QByteArray data;
+		APIServiceResponse response;
+		bool done;
+	};
+	typedef QSharedPointer<PendingCall> PendingCallP;
+
+	//! Queues the call for the main thread and waits until it is finished.
+	//! @return false if the main thread did not finish the call within MAIN_THREAD_TIMEOUT
+	bool runInMainThread(const PendingCallP& call);
+
+	static void applyAPIResponse(const APIServiceResponse& apiresponse, const HttpRequest& request, HttpResponse& httpresponse);
+	static void writeTimeout(HttpResponse& httpresponse);
 	int m_prefixLength;
 	typedef QMap<QByteArray,RemoteControlServiceInterface*> ServiceMap;
 	ServiceMap m_serviceMap;
+
+	QMutex m_pendingMutex;
+	QWaitCondition m_pendingDone;
+	QList<PendingCallP> m_pendingCalls;
+	bool m_processQueued;
+
+	//! Time in ms a worker thread waits for the main thread to run its request
+	static const int MAIN_THREAD_TIMEOUT = 10000;
 };
 
 #endif
@@ -52,6 +52,14 @@ void AbstractAPIService::post(const QByteArray &operation, const APIParameters &
 	response.setData(str.arg(getPath()).toLatin1());
 }
 
+bool AbstractAPIService::getSnapshot(const QByteArray &operation, const APIParameters &parameters, APIServiceResponse &response)
+{
+	Q_UNUSED(operation);
+	Q_UNUSED(parameters);
+	Q_UNUSED(response);
+	return false;
+}
+
 #ifdef FORCE_THREADED_SERVICES
 const Qt::ConnectionType AbstractAPIService::SERVICE_DEFAULT_INVOKETYPE = Qt::BlockingQueuedConnection;
 #else
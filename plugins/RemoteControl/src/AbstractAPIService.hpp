@@ -47,6 +47,13 @@ public:
 	//! Provides a default implementation which returns an error message.
 	virtual void post(const QByteArray &operation, const APIParameters &parameters, const QByteArray& data, APIServiceResponse& response) Q_DECL_OVERRIDE;
 
+	//! Called in the HTTP worker thread for GET requests of services which are not thread-safe,
+	//! before the request is queued for the main thread. Reimplement this to answer read-only operations from state
+	//! which is published in update() each frame, so that they do not have to wait for the main thread at all.
+	//! Default implementation returns false.
+	//! @return true if the response was written, false if get() should be called in the main thread
+	virtual bool getSnapshot(const QByteArray &operation, const APIParameters &parameters, APIServiceResponse& response);
+
 protected:
 	//! This defines the connection type QMetaObject::invokeMethod has to use inside a service: either Qt::DirectConnection for main thread handling, or
 	//! Qt::BlockingQueuedConnection for HTTP thread handling
@@ -0,0 +1,146 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "BatchService.hpp"
+#include "APIController.hpp"
+
+#include "StelApp.hpp"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+BatchService::BatchService(APIController *controller, QObject *parent)
+	: AbstractAPIService(parent), controller(controller)
+{
+}
+
+void BatchService::post(const QByteArray &operation, const APIParameters &parameters, const QByteArray &data, APIServiceResponse &response)
+{
+	Q_UNUSED(parameters);
+	//the whole batch runs in one main thread invocation, so no frame is drawn in between
+	Q_ASSERT(QThread::currentThread() == StelApp::getInstance().thread());
+
+	if(!operation.isEmpty())
+	{
+		response.writeRequestError("unsupported operation. POST the list of operations to /api/batch");
+		return;
+	}
+
+	QJsonParseError err;
+	QJsonDocument doc = QJsonDocument::fromJson(data, &err);
+	if(err.error != QJsonParseError::NoError)
+	{
+		response.writeRequestError("invalid JSON: " + err.errorString().toUtf8());
+		return;
+	}
+
+	QJsonArray ops;
+	bool stopOnError = false;
+	if(doc.isArray())
+		ops = doc.array();
+	else if(doc.isObject())
+	{
+		ops = doc.object().value("operations").toArray();
+		stopOnError = doc.object().value("stopOnError").toBool();
+	}
+	else
+	{
+		response.writeRequestError("expected a JSON array of operations");
+		return;
+	}
+
+	QJsonArray results;
+	for (const auto& val : ops)
+	{
+		int status = 400;
+		QJsonObject result;
+		if(val.isObject())
+			result = runOperation(val.toObject(), status);
+		else
+		{
+			result.insert("status", status);
+			result.insert("data", QStringLiteral("operation is not an object"));
+		}
+		results.append(result);
+
+		if(stopOnError && status >= 400)
+			break;
+	}
+
+	response.writeJSON(QJsonDocument(results));
+}
+
+QJsonObject BatchService::runOperation(const QJsonObject &op, int &status)
+{
+	QJsonObject result;
+	APIServiceResponse response;
+
+	const QByteArray path = op.value("path").toString().toUtf8();
+	const QString method = op.value("method").toString("POST").toUpper();
+	int slashIdx = path.indexOf('/');
+	const QByteArray serviceString = slashIdx >= 0 ? path.left(slashIdx) : path;
+	const QByteArray operation = slashIdx >= 0 ? path.mid(slashIdx + 1) : QByteArray();
+
+	APIParameters parameters;
+	const QJsonObject params = op.value("parameters").toObject();
+	for (auto it = params.constBegin(); it != params.constEnd(); ++it)
+	{
+		const QByteArray key = it.key().toUtf8();
+		const QJsonArray values = it.value().isArray() ? it.value().toArray() : QJsonArray() << it.value();
+		for (const auto& v : values)
+		{
+			//numbers and booleans are passed on like their URL representation
+			QString str = v.isString() ? v.toString() : v.isBool() ? QString(v.toBool() ? "true" : "false") : QString::number(v.toDouble(), 'g', 17);
+			parameters.insert(key, str.toUtf8());
+		}
+	}
+
+	RemoteControlServiceInterface* sv = controller->getService(serviceString);
+	if(!sv || sv == this)
+		response.writeRequestError("unknown service: " + serviceString);
+	else if(sv->isThreadSafe())
+		response.writeRequestError("service can not be used in a batch: " + serviceString);
+	else if(method == "GET")
+		sv->get(operation, parameters, response);
+	else if(method == "POST")
+		sv->post(operation, parameters, op.value("data").toString().toUtf8(), response);
+	else
+		response.writeRequestError("unsupported method: " + method.toUtf8());
+
+	status = response.getStatus() == -1 ? 200 : response.getStatus();
+	result.insert("status", status);
+	const QByteArray contentType = response.getHeader("Content-Type");
+	if(!contentType.isEmpty())
+		result.insert("contentType", QString::fromUtf8(contentType));
+
+	//embed JSON replies as they are, so the client does not have to parse them again
+	QJsonParseError err;
+	QJsonDocument dataDoc;
+	if(contentType.startsWith("application/json"))
+		dataDoc = QJsonDocument::fromJson(response.getData(), &err);
+	if(dataDoc.isArray())
+		result.insert("data", dataDoc.array());
+	else if(dataDoc.isObject())
+		result.insert("data", dataDoc.object());
+	else
+		result.insert("data", QString::fromUtf8(response.getData()));
+	return result;
+}
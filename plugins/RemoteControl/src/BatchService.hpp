@@ -0,0 +1,62 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef BATCHSERVICE_HPP
+#define BATCHSERVICE_HPP
+
+#include "AbstractAPIService.hpp"
+
+class APIController;
+class QJsonObject;
+
+//! @ingroup remoteControl
+//! Runs an ordered list of operations of other services in a single main thread invocation.
+//! All operations are applied between two frames, so no frame shows the state between them,
+//! and a cue of a show control system takes one HTTP round trip instead of one per operation.
+//!
+//! The POST data of \c /api/batch is a JSON array of operations, or an object with this array in \c operations
+//! and an optional \c stopOnError boolean. Each operation is an object with
+//!  - \c path: the service and operation, as in the URL after \c /api/, e.g. \c "stelproperty/set"
+//!  - \c method: \c "GET" or \c "POST" (default)
+//!  - \c parameters: an object of parameter names and values, values may be arrays for repeated parameters
+//!  - \c data: the optional POST data as string
+//!
+//! The reply is a JSON array with one object per executed operation, containing the HTTP \c status,
+//! the \c contentType and the \c data (parsed if it is JSON, a string otherwise).
+//! If \c stopOnError is set, the operations after the first one with an error status are not executed.
+//! Only services which run in the main thread can be used, thread-safe services like the Simbad lookup
+//! would block the main thread and are rejected.
+class BatchService : public AbstractAPIService
+{
+	Q_OBJECT
+public:
+	//! @param controller the APIController to look up the services in
+	BatchService(APIController* controller, QObject* parent = Q_NULLPTR);
+
+	virtual QLatin1String getPath() const Q_DECL_OVERRIDE { return QLatin1String("batch"); }
+	//! @brief Implements the HTTP POST method
+	virtual void post(const QByteArray &operation, const APIParameters &parameters, const QByteArray &data, APIServiceResponse &response) Q_DECL_OVERRIDE;
+private:
+	//! Runs one operation in the main thread and returns its result object
+	QJsonObject runOperation(const QJsonObject& op, int& status);
+
+	APIController* controller;
+};
+
+#endif
@@ -0,0 +1,154 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "FrameStreamer.hpp"
+#include "httpserver/httprequest.h"
+#include "httpserver/httpresponse.h"
+
+#include "StelApp.hpp"
+#include "StelFrameGrabber.hpp"
+
+#include <QBuffer>
+#include <QDateTime>
+#include <QThread>
+
+#define STREAM_BOUNDARY "stellariumframe"
+
+FrameStreamer::FrameStreamer()
+	: enabled(1)
+{
+}
+
+FrameStreamer::Options FrameStreamer::getOptions(const HttpRequest &request)
+{
+	Options options;
+	bool ok;
+	options.width = request.getParameter("width").toInt(&ok);
+	if(!ok || options.width <= 0)
+		options.width = 0;
+	options.height = request.getParameter("height").toInt(&ok);
+	if(!ok || options.height <= 0)
+		options.height = 0;
+	options.fps = request.getParameter("fps").toInt(&ok);
+	options.fps = ok ? qBound(1, options.fps, 60) : 10;
+	options.quality = request.getParameter("quality").toInt(&ok);
+	options.quality = ok ? qBound(1, options.quality, 100) : 75;
+	return options;
+}
+
+QByteArray FrameStreamer::encode(const QImage &image, const FrameStreamer::Options &options)
+{
+	QImage img = image;
+	if((options.width && img.width() > options.width) || (options.height && img.height() > options.height))
+	{
+		img = img.scaled(options.width ? options.width : img.width(), options.height ? options.height : img.height(),
+				 Qt::KeepAspectRatio, Qt::SmoothTransformation);
+	}
+
+	QByteArray data;
+	QBuffer buf(&data);
+	buf.open(QIODevice::WriteOnly);
+	//JPEG has no alpha channel
+	img.convertToFormat(QImage::Format_RGB888).save(&buf, "JPG", options.quality);
+	return data;
+}
+
+void FrameStreamer::service(HttpRequest &request, HttpResponse &response)
+{
+	const QByteArray path = request.getPath();
+	StelFrameGrabber* grabber = StelApp::getInstance().getFrameGrabber();
+	if(!enabled.load() || !grabber)
+	{
+		response.setStatus(503,"Service Unavailable");
+		response.write("HTTP 503 Frame grabbing is not available",true);
+		return;
+	}
+
+	const Options options = getOptions(request);
+	response.setHeader("Cache-Control","no-cache");
+	if(path == "/api/stream/mjpeg")
+		serveStream(options, response);
+	else if(path == "/api/stream/jpeg")
+		serveImage(options, response);
+	else
+	{
+		response.setStatus(404,"Not Found");
+		response.write("HTTP 404 Unknown stream. Use /api/stream/mjpeg or /api/stream/jpeg",true);
+	}
+}
+
+void FrameStreamer::serveImage(const FrameStreamer::Options &options, HttpResponse &response)
+{
+	StelFrameGrabber* grabber = StelApp::getInstance().getFrameGrabber();
+	//only frames grabbed after the request are accepted
+	grabber->addViewer(options.fps);
+	quint64 frameNumber = 0;
+	QImage img;
+	grabber->waitForFrame(frameNumber, img, 0);
+	bool ok = false;
+	for(int i = 0; i < 8 && !ok && enabled.load(); ++i)
+		ok = grabber->waitForFrame(frameNumber, img, WAIT_TIME);
+	grabber->removeViewer(options.fps);
+
+	if(!ok)
+	{
+		response.setStatus(503,"Service Unavailable");
+		response.write("HTTP 503 No frame was drawn",true);
+		return;
+	}
+	response.setHeader("Content-Type","image/jpeg");
+	response.write(encode(img, options),true);
+}
+
+void FrameStreamer::serveStream(const FrameStreamer::Options &options, HttpResponse &response)
+{
+	StelFrameGrabber* grabber = StelApp::getInstance().getFrameGrabber();
+	//the stream ends with the connection, so it can not be chunked or kept alive
+	response.setHeader("Connection","close");
+	response.setHeader("Content-Type","multipart/x-mixed-replace; boundary=" STREAM_BOUNDARY);
+
+	grabber->addViewer(options.fps);
+	quint64 frameNumber = 0;
+	const qint64 frameTime = 1000 / options.fps;
+	qint64 nextFrameMs = 0;
+	while(enabled.load() && response.isConnected())
+	{
+		//several streams with different rates share the grabber, which runs at the fastest one
+		const qint64 now = QDateTime::currentMSecsSinceEpoch();
+		if(now < nextFrameMs)
+			QThread::msleep(static_cast<unsigned long>(qMin(nextFrameMs - now, static_cast<qint64>(WAIT_TIME))));
+
+		QImage img;
+		if(QDateTime::currentMSecsSinceEpoch() < nextFrameMs || !grabber->waitForFrame(frameNumber, img, WAIT_TIME))
+			continue;
+		nextFrameMs = qMax(nextFrameMs + frameTime, QDateTime::currentMSecsSinceEpoch());
+
+		const QByteArray jpeg = encode(img, options);
+		QByteArray part;
+		part.reserve(jpeg.size() + 128);
+		part.append("--" STREAM_BOUNDARY "\r\nContent-Type: image/jpeg\r\nContent-Length: ");
+		part.append(QByteArray::number(jpeg.size()));
+		part.append("\r\n\r\n");
+		part.append(jpeg);
+		part.append("\r\n");
+		response.write(part);
+		response.flush();
+	}
+	grabber->removeViewer(options.fps);
+}
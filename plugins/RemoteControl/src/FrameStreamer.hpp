@@ -0,0 +1,69 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef FRAMESTREAMER_HPP
+#define FRAMESTREAMER_HPP
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QImage>
+
+class HttpRequest;
+class HttpResponse;
+
+//! @ingroup remoteControl
+//! Streams the rendered sky, as grabbed by the StelFrameGrabber of StelApp, to HTTP clients.
+//!  - @c /api/stream/mjpeg is a Motion JPEG stream (@c multipart/x-mixed-replace), which browsers show in an @c img element
+//!  - @c /api/stream/jpeg is a single JPEG image of the next frame
+//!
+//! Both take the optional parameters @c width and @c height (the maximal size, the aspect ratio is kept),
+//! @c fps (1 to 60, default 10, only for the stream) and @c quality (1 to 100, default 75).
+//! The frames are scaled and encoded in the HTTP worker thread, so the main thread only pays for the readback.
+//! Each stream keeps its connection and worker thread busy until the client disconnects.
+class FrameStreamer
+{
+public:
+	FrameStreamer();
+
+	//! Serves a request for a path starting with @c /api/stream/. Runs in an HTTP worker thread.
+	void service(HttpRequest& request, HttpResponse& response);
+	//! Streams are only served while enabled. Disabling it ends all running streams within WAIT_TIME,
+	//! which is required before the HTTP server can be stopped.
+	void setEnabled(bool val) { enabled.store(val ? 1 : 0); }
+
+private:
+	struct Options
+	{
+		int width;
+		int height;
+		int fps;
+		int quality;
+	};
+	static Options getOptions(const HttpRequest& request);
+	static QByteArray encode(const QImage& image, const Options& options);
+	void serveStream(const Options& options, HttpResponse& response);
+	void serveImage(const Options& options, HttpResponse& response);
+
+	QAtomicInt enabled;
+
+	//! Time in ms after which a waiting stream checks if it should end
+	static const unsigned long WAIT_TIME = 250;
+};
+
+#endif
@@ -51,7 +51,7 @@ void LocationService::get(const QByteArray& operation, const APIParameters &para
 		//same as in the LocationDialog list
 
 		//TODO not fully thread safe
-		QJsonArray list = QJsonArray::fromStringList(QStringList(locMgr->getAllMap().keys()));
+		QJsonArray list = QJsonArray::fromStringList(locMgr->getAllIDs());
 
 		response.writeJSON(QJsonDocument(list));
 	}
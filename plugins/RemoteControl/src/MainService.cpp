@@ -18,6 +18,7 @@
  */
 
 #include "MainService.hpp"
+#include "StateSnapshot.hpp"
 
 #include "StelApp.hpp"
 #include "StelActionMgr.hpp"
@@ -38,13 +39,19 @@
 #include <QJsonObject>
 #include <QJsonArray>
 
+#include <algorithm>
+#include <cmath>
 
-MainService::MainService(QObject *parent)
+
+MainService::MainService(StateSnapshotMgr *snapshots, QObject *parent)
 	: AbstractAPIService(parent),
 	  moveX(0),moveY(0),lastMoveUpdateTime(0),
 	  //100 should be more than enough
 	  //this only has to encompass events that occur between 2 status updates
-	  actionCache(100), propCache(100)
+	  actionCache(100), propCache(100),
+	  pushFull(true), pushSelection(true), pushLocation(true), pushedActionId(-2), pushedPropId(-2),
+	  pushedJD(0.), pushedTimeRate(0.), pushedIsTimeNow(false), pushedTimeMs(0), pushedFov(0.), pushedInfoMs(0),
+	  snapshots(snapshots)
 {
 	//this is run in the main thread
 	core = StelApp::getInstance().getCore();
@@ -58,7 +65,9 @@ MainService::MainService(QObject *parent)
 	skyCulMgr = &StelApp::getInstance().getSkyCultureMgr();
 
 	connect(actionMgr,SIGNAL(actionToggled(QString,bool)),this,SLOT(actionToggled(QString,bool)));
-	connect(propMgr,SIGNAL(stelPropertyChanged(StelProperty*,QVariant)),this,SLOT(propertyChanged(StelProperty*,QVariant)));
+	connect(propMgr,SIGNAL(stelPropertiesChanged(QVariantMap)),this,SLOT(propertiesChanged(QVariantMap)));
+	connect(objMgr,SIGNAL(selectedObjectChanged(StelModule::StelModuleSelectAction)),this,SLOT(selectionChanged()));
+	connect(core,SIGNAL(locationChanged(StelLocation)),this,SLOT(locationChanged()));
 
 	Q_ASSERT(this->thread()==objMgr->thread());
 }
@@ -95,6 +104,134 @@ void MainService::update(double deltaTime)
 		//this is required to enable maximal fps for smoothness
 		StelMainView::getInstance().thereWasAnEvent();
 	}
+
+	pushChanges();
+}
+
+void MainService::pushChanges()
+{
+	//nothing to do without WebSocket clients, the first message to a new client is a full one
+	if(receivers(SIGNAL(webSocketMessage(QByteArray)))==0)
+	{
+		pushFull = true;
+		return;
+	}
+
+	QJsonObject obj;
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+	if(pushFull || pushLocation)
+		obj.insert("location",snapshots->getLocationStatus());
+
+	//clients can extrapolate the time with the time rate, so only push it when it deviates from that,
+	//or each second while time passes to keep the displayed strings current
+	const double jd = core->getJD();
+	const double timeRate = core->getTimeRate();
+	const double predictedJD = pushedJD + pushedTimeRate * (now - pushedTimeMs) / 1000.0;
+	const double tolerance = std::max(StelCore::JD_SECOND, std::fabs(timeRate) * 0.1);
+	if(pushFull || timeRate != pushedTimeRate || core->getIsTimeNow() != pushedIsTimeNow
+	   || std::fabs(jd - predictedJD) > tolerance || (!qFuzzyIsNull(timeRate) && now - pushedTimeMs >= 1000))
+	{
+		obj.insert("time",snapshots->getTimeStatus());
+		pushedJD = jd;
+		pushedTimeRate = timeRate;
+		pushedIsTimeNow = core->getIsTimeNow();
+		pushedTimeMs = now;
+	}
+
+	//the info string of moving objects changes all the time, so it is refreshed at most each second
+	if(pushFull || pushSelection || now - pushedInfoMs >= 1000)
+	{
+		const QString infoStr = getInfoString();
+		if(pushFull || infoStr != pushedInfoString)
+			obj.insert("selectioninfo",infoStr);
+		pushedInfoString = infoStr;
+		pushedInfoMs = now;
+	}
+
+	const QJsonObject view = snapshots->getViewStatus();
+	const double fov = view.value("fov").toDouble();
+	if(pushFull || fov != pushedFov)
+	{
+		obj.insert("view",view);
+		pushedFov = fov;
+	}
+
+	//the changes use the same ids as the status operation, so clients can switch to polling
+	const QJsonObject actionChanges = getActionChangesSinceID(pushFull ? -2 : pushedActionId);
+	pushedActionId = actionChanges.value("id").toInt();
+	if(pushFull || !actionChanges.value("changes").toObject().isEmpty())
+		obj.insert("actionChanges",actionChanges);
+	const QJsonObject propChanges = getPropertyChangesSinceID(pushFull ? -2 : pushedPropId);
+	pushedPropId = propChanges.value("id").toInt();
+	if(pushFull || !propChanges.value("changes").toObject().isEmpty())
+		obj.insert("propertyChanges",propChanges);
+
+	pushFull = pushSelection = pushLocation = false;
+	if(!obj.isEmpty())
+		emit webSocketMessage(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+}
+
+bool MainService::getSnapshot(const QByteArray &operation, const APIParameters &parameters, APIServiceResponse &response)
+{
+	if(operation=="status")
+	{
+		StateSnapshotP snapshot = snapshots->getSnapshot(StateSnapshot::Status);
+		if(!snapshot)
+			return false;
+
+		QByteArray sActionId = parameters.value("actionId");
+		QByteArray sPropId = parameters.value("propId");
+		//the reply also depends on the changes, so all clients polling with the same ids share it
+		snapshot->writeReply("main/status?actionId=" + sActionId + "&propId=" + sPropId, [&]()
+		{
+			QJsonObject obj;
+			obj.insert("location",snapshot->location);
+			obj.insert("time",snapshot->time);
+			obj.insert("selectioninfo",snapshot->statusInfo);
+			obj.insert("view",snapshot->view);
+
+			//the change caches are protected by their own mutexes
+			bool actionOk;
+			int actionId = QString::fromUtf8(sActionId).toInt(&actionOk);
+			bool propOk;
+			int propId = QString::fromUtf8(sPropId).toInt(&propOk);
+			if(actionOk)
+				obj.insert("actionChanges",getActionChangesSinceID(actionId));
+			if(propOk)
+				obj.insert("propertyChanges",getPropertyChangesSinceID(propId));
+			return StateSnapshot::toJson(QJsonDocument(obj));
+		}, response);
+		return true;
+	}
+	else if(operation=="view")
+	{
+		StateSnapshotP snapshot = snapshots->getSnapshot(StateSnapshot::ViewDirection);
+		if(!snapshot)
+			return false;
+
+		QByteArray refName = parameters.value("ref");
+		QByteArray coordName = parameters.value("coord");
+		snapshot->writeReply("main/view?ref=" + refName + "&coord=" + coordName, [&]()
+		{
+			StelCore::RefractionMode refMode=StelCore::RefractionAuto;
+			if (refName=="on")
+				refMode=StelCore::RefractionOn;
+			else if (refName=="off")
+				refMode=StelCore::RefractionOff;
+
+			QJsonObject mainObj;
+			if (coordName!="jNow" && coordName!="altAz")
+				mainObj.insert("j2000", snapshot->viewJ2000.toString());
+			if (coordName!="j2000" && coordName!="altAz")
+				mainObj.insert("jNow", snapshot->viewJNow[refMode].toString());
+			if (coordName!="j2000" && coordName!="jNow")
+				mainObj.insert("altAz", snapshot->viewAltAz.toString());
+			return StateSnapshot::toJson(QJsonDocument(mainObj));
+		}, response);
+		return true;
+	}
+	return false;
 }
 
 void MainService::get(const QByteArray& operation, const APIParameters &parameters, APIServiceResponse &response)
@@ -114,45 +251,10 @@ void MainService::get(const QByteArray& operation, const APIParameters &paramete
 		QJsonObject obj;
 
 		//// Location
-		const StelLocation& loc = core->getCurrentLocation();
-		{
-			QJsonObject obj2;
-			obj2.insert("name",loc.name);
-			obj2.insert("role",QString(loc.role));
-			obj2.insert("planet",loc.planetName);
-			obj2.insert("latitude",loc.latitude);
-			obj2.insert("longitude",loc.longitude);
-			obj2.insert("altitude",loc.altitude);
-			obj2.insert("country",loc.country);
-			obj2.insert("state",loc.state);
-			obj2.insert("landscapeKey",loc.landscapeKey);
-			obj.insert("location",obj2);
-		}
+		obj.insert("location",snapshots->getLocationStatus());
 
 		//// Time related stuff
-		{
-			double jday = core->getJD();
-			double deltaT = core->getDeltaT() * StelCore::JD_SECOND;
-
-			double gmtShift = core->getUTCOffset(jday) / 24.0;
-
-			QString utcIso = StelUtils::julianDayToISO8601String(jday,true).append('Z');
-			QString localIso = StelUtils::julianDayToISO8601String(jday+gmtShift,true);
-
-			//time zone string
-			QString timeZone = localeMgr->getPrintableTimeZoneLocal(jday);
-
-			QJsonObject obj2;
-			obj2.insert("jday",jday);
-			obj2.insert("deltaT",deltaT);
-			obj2.insert("gmtShift",gmtShift);
-			obj2.insert("timeZone",timeZone);
-			obj2.insert("utc",utcIso);
-			obj2.insert("local",localIso);
-			obj2.insert("isTimeNow",core->getIsTimeNow());
-			obj2.insert("timerate",core->getTimeRate());
-			obj.insert("time",obj2);
-		}
+		obj.insert("time",snapshots->getTimeStatus());
 
 		//// Info about selected object (only primary)
 		{
@@ -163,20 +265,7 @@ void MainService::get(const QByteArray& operation, const APIParameters &paramete
 		}
 
 		//// Info about current view
-		{
-			QJsonObject obj2;
-
-			// the aim fov may lie outside the min/max bounds, so constrain it
-			double fov = mvmgr->getAimFov();
-			if(fov < mvmgr->getMinFov())
-				fov = mvmgr->getMinFov();
-			else if (fov>mvmgr->getMaxFov())
-				fov = mvmgr->getMaxFov();
-
-			obj2.insert("fov",fov);
-
-			obj.insert("view",obj2);
-		}
+		obj.insert("view",snapshots->getViewStatus());
 
 		//// Info about changed actions & props (if requested)
 		{
@@ -634,10 +723,11 @@ void MainService::actionToggled(const QString &id, bool val)
 	actionMutex.unlock();
 }
 
-void MainService::propertyChanged(StelProperty* prop, const QVariant& val)
+void MainService::propertiesChanged(const QVariantMap& changes)
 {
 	propMutex.lock();
-	propCache.append(PropertyCacheEntry(prop->getId(),val));
+	for (auto it = changes.constBegin(); it != changes.constEnd(); ++it)
+		propCache.append(PropertyCacheEntry(it.key(),it.value()));
 	if(!propCache.areIndexesValid())
 	{
 		//in theory, this can happen, but practically not so much
@@ -39,11 +39,18 @@ class StelPropertyMgr;
 class StelProperty;
 class StelScriptMgr;
 class StelSkyCultureMgr;
+class StateSnapshotMgr;
 
 //! @ingroup remoteControl
 //! Implements the main API services, including the \c status operation which can be repeatedly polled to find the current state of the main program,
 //! including time, view, location, StelAction and StelProperty state changes, movement, script status ...
 //!
+//! Instead of polling, clients can open a WebSocket on \c /api/main/push (see RequestHandler). Each message is a JSON object
+//! in the format of the \c status reply, but only contains the parts which changed since the previous message:
+//! the first message after a client connects contains the full state, later ones contain the changed actions and properties,
+//! the time when it deviates from the extrapolation with the time rate (or at least each second while time passes),
+//! the selection info when it changes, and the location and view when they change. All changes of a frame are sent in one message.
+//!
 //! @see @ref rcMainService
 class MainService : public AbstractAPIService
 {
@@ -58,7 +65,8 @@ public:
 		Mark
 	};
 
-	MainService(QObject* parent = Q_NULLPTR);
+	//! @param snapshots the shared snapshots used to answer polls without waiting for the main thread
+	MainService(StateSnapshotMgr* snapshots, QObject* parent = Q_NULLPTR);
 
 	//! Used to implement move functionality
 	virtual void update(double deltaTime) Q_DECL_OVERRIDE;
@@ -69,6 +77,17 @@ public:
 	//! @brief Implements the HTTP POST operations
 	//! @see @ref rcMainServicePOST
 	virtual void post(const QByteArray &operation, const APIParameters &parameters, const QByteArray &data, APIServiceResponse &response) Q_DECL_OVERRIDE;
+	//! Answers the \c status and \c view operations from the StateSnapshot, while they are being polled
+	virtual bool getSnapshot(const QByteArray &operation, const APIParameters &parameters, APIServiceResponse &response) Q_DECL_OVERRIDE;
+
+public slots:
+	//! The next push message will contain the full state, e.g. for a newly connected WebSocket client.
+	//! Can be called from any thread with a queued connection.
+	void requestFullPush() { pushFull = true; }
+
+signals:
+	//! Emitted in the main thread with the coalesced changes of a frame, if a WebSocket client is connected
+	void webSocketMessage(const QByteArray& message);
 
 private slots:
 	StelObjectP getSelectedObject();
@@ -86,7 +105,9 @@ private slots:
 	void setFov(double fov);
 
 	void actionToggled(const QString& id, bool val);
-	void propertyChanged(StelProperty* prop, const QVariant &val);
+	void propertiesChanged(const QVariantMap& changes);
+	void selectionChanged() { pushSelection = true; }
+	void locationChanged() { pushLocation = true; }
 
 private:
 	StelCore* core;
@@ -124,6 +145,23 @@ private:
 	QMutex propMutex;
 	QJsonObject getPropertyChangesSinceID(int changeId);
 
+	//! Emits the changes since the last push, called each frame
+	void pushChanges();
+	bool pushFull;
+	bool pushSelection;
+	bool pushLocation;
+	int pushedActionId;
+	int pushedPropId;
+	double pushedJD;
+	double pushedTimeRate;
+	bool pushedIsTimeNow;
+	qint64 pushedTimeMs;
+	double pushedFov;
+	QString pushedInfoString;
+	qint64 pushedInfoMs;
+
+	StateSnapshotMgr* snapshots;
+
 };
 
 
@@ -0,0 +1,123 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "MarkerService.hpp"
+
+#include "StelApp.hpp"
+#include "StelModuleMgr.hpp"
+#include "CustomObjectMgr.hpp"
+#include "HighlightMgr.hpp"
+#include "LabelMgr.hpp"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+
+MarkerService::MarkerService(QObject *parent) : AbstractAPIService(parent)
+{
+	//this is run in the main thread
+	customObjectMgr = GETSTELMODULE(CustomObjectMgr);
+	highlightMgr = GETSTELMODULE(HighlightMgr);
+	labelMgr = GETSTELMODULE(LabelMgr);
+}
+
+QVariantList MarkerService::parseAngles(const QByteArray& list)
+{
+	QVariantList angles;
+	for (const auto& item : QString::fromUtf8(list).split(',', QString::SkipEmptyParts))
+	{
+		bool ok;
+		const double deg = item.toDouble(&ok);
+		if (ok)
+			angles.append(deg);
+		else
+			angles.append(item.trimmed());
+	}
+	return angles;
+}
+
+QStringList MarkerService::parseLines(const QByteArray& list)
+{
+	QStringList lines = QString::fromUtf8(list).split('\n');
+	for (auto& line : lines)
+		line = line.trimmed();
+	return lines;
+}
+
+void MarkerService::post(const QByteArray& operation, const APIParameters &parameters, const QByteArray &data, APIServiceResponse &response)
+{
+	Q_UNUSED(data);
+
+	const QVariantList ra = parseAngles(parameters.value("ra"));
+	const QVariantList dec = parseAngles(parameters.value("dec"));
+	QJsonObject obj;
+	if (operation=="highlights")
+	{
+		obj.insert("count", highlightMgr->addHighlights(ra, dec, QString::fromUtf8(parameters.value("color"))));
+	}
+	else if (operation=="clearhighlights")
+	{
+		highlightMgr->cleanHighlightList();
+		response.setData("ok");
+		return;
+	}
+	else if (operation=="objects")
+	{
+		const bool visible = parameters.value("visible", "true")!="false";
+		obj.insert("count", customObjectMgr->addCustomObjects(parseLines(parameters.value("names")), ra, dec, visible));
+	}
+	else if (operation=="clearobjects")
+	{
+		customObjectMgr->removeCustomObjects();
+		response.setData("ok");
+		return;
+	}
+	else if (operation=="labels")
+	{
+		bool ok;
+		float fontSize = parameters.value("fontSize").toFloat(&ok);
+		if (!ok)
+			fontSize = 14.f;
+		double distance = parameters.value("distance").toDouble(&ok);
+		if (!ok)
+			distance = 5.;
+		QString color = QString::fromUtf8(parameters.value("color"));
+		if (color.isEmpty())
+			color = "#999999";
+		obj.insert("id", labelMgr->labelEquatorial(parseLines(parameters.value("texts")), ra, dec, true, fontSize, color, distance));
+	}
+	else if (operation=="deletelabel")
+	{
+		bool ok;
+		const int id = parameters.value("id").toInt(&ok);
+		if (!ok)
+		{
+			response.writeRequestError("invalid id");
+			return;
+		}
+		labelMgr->deleteLabel(id);
+		response.setData("ok");
+		return;
+	}
+	else
+	{
+		response.writeRequestError("unsupported operation. POST: highlights, clearhighlights, objects, clearobjects, labels, deletelabel");
+		return;
+	}
+	response.writeJSON(QJsonDocument(obj));
+}
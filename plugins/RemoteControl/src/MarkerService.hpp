@@ -0,0 +1,66 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef MARKERSERVICE_HPP
+#define MARKERSERVICE_HPP
+
+#include "AbstractAPIService.hpp"
+
+#include <QVariantList>
+
+class CustomObjectMgr;
+class HighlightMgr;
+class LabelMgr;
+
+//! @ingroup remoteControl
+//! Adds many markers, highlights and labels at once, e.g. the targets of an observing list, through the bulk
+//! functions of CustomObjectMgr, HighlightMgr and LabelMgr.
+//! The positions are J2000 equatorial coordinates, in the \c ra and \c dec parameters as comma-separated lists of
+//! angles in degrees or like "2h10m15s" and "60d01m15s". Names and texts are given one per line.
+//!
+//! POST operations:
+//! - \c highlights: adds highlights at \c ra, \c dec, with the optional HTML-like \c color, e.g. #ff0000 (URL-encoded)
+//! - \c clearhighlights: removes all highlights
+//! - \c objects: adds custom objects of the \c names at \c ra, \c dec, as visible markers unless \c visible=false
+//! - \c clearobjects: removes all custom objects
+//! - \c labels: adds labels of the \c texts at \c ra, \c dec, with the optional \c fontSize, \c color and
+//!   \c distance (in pixels), answers the ID of the labels as JSON object with the key id
+//! - \c deletelabel: deletes the labels of the \c id given by \c labels
+//! The add operations answer the number of added items as JSON object with the key count, unless stated otherwise.
+class MarkerService : public AbstractAPIService
+{
+	Q_OBJECT
+public:
+	MarkerService(QObject* parent = Q_NULLPTR);
+
+	virtual QLatin1String getPath() const Q_DECL_OVERRIDE { return QLatin1String("markers"); }
+	//! @brief Implements the HTTP POST requests
+	virtual void post(const QByteArray &operation, const APIParameters& parameters, const QByteArray &data, APIServiceResponse &response) Q_DECL_OVERRIDE;
+private:
+	//! Split a comma-separated list of angles, numbers are kept as numbers
+	static QVariantList parseAngles(const QByteArray& list);
+	//! Split a parameter of one item per line
+	static QStringList parseLines(const QByteArray& list);
+
+	CustomObjectMgr* customObjectMgr;
+	HighlightMgr* highlightMgr;
+	LabelMgr* labelMgr;
+};
+
+#endif
@@ -18,6 +18,7 @@
  */
 
 #include "ObjectService.hpp"
+#include "StateSnapshot.hpp"
 
 #include "SearchDialog.hpp"
 #include "StelApp.hpp"
@@ -27,6 +28,7 @@
 #include "StelModuleMgr.hpp"
 #include "StelObjectMgr.hpp"
 #include "LandscapeMgr.hpp"
+#include "PhenomenaFinder.hpp"
 
 #include <QEventLoop>
 #include <QJsonArray>
@@ -38,7 +40,7 @@
 #include <QRunnable>
 #include <QWaitCondition>
 
-ObjectService::ObjectService(QObject *parent) : AbstractAPIService(parent)
+ObjectService::ObjectService(StateSnapshotMgr *snapshots, QObject *parent) : AbstractAPIService(parent), snapshots(snapshots)
 {
 	//this is run in the main thread
 	core = StelApp::getInstance().getCore();
@@ -71,6 +73,29 @@ QString ObjectService::substituteGreek(const QString &text)
 	return SearchDialog::substituteGreek(text);
 }
 
+bool ObjectService::getSnapshot(const QByteArray &operation, const APIParameters &parameters, APIServiceResponse &response)
+{
+	//only the info about the current selection is published
+	if(operation != "info" || !parameters.value("name").isEmpty())
+		return false;
+	QByteArray formatStr = parameters.value("format");
+	if (formatStr == "map" || formatStr == "json")
+		return false;
+
+	StateSnapshotP snapshot = snapshots->getSnapshot(StateSnapshot::SelectionInfo);
+	if(!snapshot)
+		return false;
+
+	if(!snapshot->hasSelection)
+	{
+		response.setStatus(404,"not found");
+		response.setData("no current selection, and no name parameter given");
+		return true;
+	}
+	snapshot->writeReply("objects/info", [&]() { return snapshot->selectionInfo.toUtf8(); }, response, "text/plain");
+	return true;
+}
+
 void ObjectService::get(const QByteArray& operation, const APIParameters &parameters, APIServiceResponse &response)
 {
 	//make sure the object still "lives" in the main Stel thread, even though
@@ -219,10 +244,47 @@ void ObjectService::get(const QByteArray& operation, const APIParameters &parame
 			response.writeRequestError("missing type parameter");
 		}
 	}
+	else if(operation == "phenomena")
+	{
+		//conjunctions and oppositions of a solar system body with other objects
+		QString object1 = QString::fromUtf8(parameters.value("object1"));
+		QStringList objects2 = QString::fromUtf8(parameters.value("objects2")).split(',', QString::SkipEmptyParts);
+		for (auto& name : objects2)
+			name = name.trimmed();
+
+		bool okStart, okStop;
+		double startJD = QString::fromUtf8(parameters.value("start")).toDouble(&okStart);
+		double stopJD = QString::fromUtf8(parameters.value("stop")).toDouble(&okStop);
+		if(object1.isEmpty() || objects2.isEmpty() || !okStart || !okStop)
+		{
+			response.writeRequestError("needs object1, objects2, start and stop parameters");
+			return;
+		}
+
+		bool ok;
+		double separation = QString::fromUtf8(parameters.value("separation")).toDouble(&ok);
+		if(!ok)
+			separation = 1.0;
+		bool opposition = QString::fromUtf8(parameters.value("opposition")).toInt(&ok);
+		if(!ok)
+			opposition = false;
+
+		QVariantList list;
+		QMetaObject::invokeMethod(this,"findPhenomena",SERVICE_DEFAULT_INVOKETYPE,
+					  Q_RETURN_ARG(QVariantList,list),
+					  Q_ARG(QString,object1),
+					  Q_ARG(QStringList,objects2),
+					  Q_ARG(double,startJD),
+					  Q_ARG(double,stopJD),
+					  Q_ARG(double,separation),
+					  Q_ARG(bool,opposition));
+
+		response.writeJSON(QJsonDocument(QJsonArray::fromVariantList(list)));
+	}
 	else
 	{
 		//TODO some sort of service description?
-		response.writeRequestError("unsupported operation. GET: find,info,listobjecttypes,listobjectsbytype");
+		response.writeRequestError("unsupported operation. GET: find,info,listobjecttypes,listobjectsbytype,phenomena");
 	}
 }
 
@@ -238,3 +300,9 @@ QString ObjectService::getInfoString(const StelObjectP obj)
 {
 	return obj->getInfoString(core);
 }
+
+QVariantList ObjectService::findPhenomena(const QString& object1, const QStringList& objects2, double startJD, double stopJD,
+					  double maxSeparation, bool opposition)
+{
+	return PhenomenaFinder::findPhenomena(object1, objects2, startJD, stopJD, maxSeparation, opposition);
+}
@@ -24,9 +24,11 @@
 #include "StelObjectType.hpp"
 
 #include <QStringList>
+#include <QVariantList>
 
 class StelCore;
 class StelObjectMgr;
+class StateSnapshotMgr;
 
 //! @ingroup remoteControl
 //! Provides operations to look up objects in the Stellarium catalogs
@@ -36,12 +38,15 @@ class ObjectService : public AbstractAPIService
 {
 	Q_OBJECT
 public:
-	ObjectService(QObject* parent = Q_NULLPTR);
+	//! @param snapshots the shared snapshots used to answer polls without waiting for the main thread
+	ObjectService(StateSnapshotMgr* snapshots, QObject* parent = Q_NULLPTR);
 
 	virtual QLatin1String getPath() const Q_DECL_OVERRIDE { return QLatin1String("objects"); }
 	//! @brief Implements the HTTP GET method
 	//! @see \ref rcObjectServiceGET
 	virtual void get(const QByteArray& operation,const APIParameters& parameters, APIServiceResponse& response) Q_DECL_OVERRIDE;
+	//! Answers the HTML \c info operation for the current selection from the StateSnapshot, while it is being polled
+	virtual bool getSnapshot(const QByteArray &operation, const APIParameters &parameters, APIServiceResponse &response) Q_DECL_OVERRIDE;
 
 private slots:
 	//! Executed in Stellarium main thread to avoid multiple QMetaObject::invoke calls
@@ -54,10 +59,15 @@ private slots:
 
 	//! Wrapper around obj->getInfoString
 	QString getInfoString(const StelObjectP obj);
+
+	//! Wrapper around PhenomenaFinder::findPhenomena
+	QVariantList findPhenomena(const QString& object1, const QStringList& objects2, double startJD, double stopJD,
+				   double maxSeparation, bool opposition);
 private:
 	StelCore* core;
 	StelObjectMgr* objMgr;
 	bool useStartOfWords;
+	StateSnapshotMgr* snapshots;
 };
 
 
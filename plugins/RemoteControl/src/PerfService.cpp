@@ -0,0 +1,120 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "PerfService.hpp"
+
+#include "StelApp.hpp"
+#include "StelPerformanceMetrics.hpp"
+#include "StelTextureMgr.hpp"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace
+{
+	//! Escape a label value of the Prometheus text format
+	QByteArray escapeLabel(const QString& value)
+	{
+		QByteArray escaped = value.toUtf8();
+		escaped.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+		return escaped;
+	}
+
+	void writeMetric(QByteArray& out, const char* name, const char* help, double value)
+	{
+		out += QByteArray("# HELP ") + name + " " + help + "\n";
+		out += QByteArray("# TYPE ") + name + " gauge\n";
+		out += QByteArray(name) + " " + QByteArray::number(value, 'g', 10) + "\n";
+	}
+}
+
+PerfService::PerfService(QObject *parent) : AbstractAPIService(parent)
+{
+	//this is run in the main thread
+	metrics = StelApp::getInstance().getPerformanceMetrics();
+}
+
+void PerfService::get(const QByteArray& operation, const APIParameters &parameters, APIServiceResponse &response)
+{
+	if(operation.isEmpty())
+	{
+		QJsonObject obj;
+		obj.insert("fps", metrics->getFps());
+		obj.insert("frameTimeP50", metrics->getFrameTimeP50());
+		obj.insert("frameTimeP99", metrics->getFrameTimeP99());
+		obj.insert("moduleTimes", QJsonObject::fromVariantMap(metrics->getModuleTimes()));
+		obj.insert("textureMemory", metrics->getTextureMemory());
+		obj.insert("hipsPendingTiles", metrics->getHipsPendingTiles());
+		obj.insert("satellitesPerSecond", metrics->getSatellitesPerSecond());
+		response.writeJSON(QJsonDocument(obj));
+	}
+	else if(operation=="metrics")
+	{
+		response.setHeader("Content-Type", "text/plain; version=0.0.4; charset=utf-8");
+		response.setData(toPrometheusText());
+	}
+	else if(operation=="residency")
+	{
+		const StelTextureMgr& textureMgr = StelApp::getInstance().getTextureManager();
+		const QString owner = QString::fromUtf8(parameters.value("owner"));
+		QJsonArray resources;
+		for (const auto& entry : textureMgr.getResidency())
+		{
+			const QVariantMap map = entry.toMap();
+			if (owner.isEmpty() || map.value("owner").toString()==owner)
+				resources.append(QJsonObject::fromVariantMap(map));
+		}
+		QJsonObject obj;
+		obj.insert("textureMemory", textureMgr.getGLMemoryUsage());
+		obj.insert("bufferMemory", textureMgr.getGLBufferMemoryUsage());
+		obj.insert("resources", resources);
+		response.writeJSON(QJsonDocument(obj));
+	}
+	else
+	{
+		response.writeRequestError("unsupported operation. GET: (none), metrics, residency");
+	}
+}
+
+QByteArray PerfService::toPrometheusText() const
+{
+	QByteArray out;
+	writeMetric(out, "stellarium_fps", "Frames per second during the last second.", metrics->getFps());
+
+	out += "# HELP stellarium_frame_time_seconds Percentiles of the intervals between the last 600 frames.\n";
+	out += "# TYPE stellarium_frame_time_seconds gauge\n";
+	out += "stellarium_frame_time_seconds{quantile=\"0.5\"} " + QByteArray::number(metrics->getFrameTimeP50()/1000., 'g', 10) + "\n";
+	out += "stellarium_frame_time_seconds{quantile=\"0.99\"} " + QByteArray::number(metrics->getFrameTimeP99()/1000., 'g', 10) + "\n";
+
+	const QVariantMap moduleTimes = metrics->getModuleTimes();
+	if (!moduleTimes.isEmpty())
+	{
+		out += "# HELP stellarium_module_time_seconds Mean CPU time of the module calls per frame, while the frame profiler is enabled.\n";
+		out += "# TYPE stellarium_module_time_seconds gauge\n";
+		for (auto it = moduleTimes.constBegin(); it != moduleTimes.constEnd(); ++it)
+			out += "stellarium_module_time_seconds{call=\"" + escapeLabel(it.key()) + "\"} " + QByteArray::number(it.value().toDouble()/1000., 'g', 10) + "\n";
+	}
+
+	writeMetric(out, "stellarium_texture_memory_bytes", "Estimated GPU memory of the textures.", metrics->getTextureMemory());
+	writeMetric(out, "stellarium_hips_pending_tiles", "HiPS tiles to draw which are still loading.", metrics->getHipsPendingTiles());
+	writeMetric(out, "stellarium_satellites_propagated_per_second", "Satellite positions computed per second, while the frame profiler is enabled.", metrics->getSatellitesPerSecond());
+	return out;
+}
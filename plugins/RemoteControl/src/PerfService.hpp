@@ -0,0 +1,53 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef PERFSERVICE_HPP
+#define PERFSERVICE_HPP
+
+#include "AbstractAPIService.hpp"
+
+class StelPerformanceMetrics;
+
+//! @ingroup remoteControl
+//! Serves the live performance metrics of StelPerformanceMetrics, for monitoring.
+//!
+//! GET operations:
+//! - (none): the metrics as a JSON object with the keys fps, frameTimeP50, frameTimeP99 [ms], moduleTimes [ms],
+//!   textureMemory [bytes], hipsPendingTiles and satellitesPerSecond
+//! - \c metrics: the same metrics in the Prometheus text exposition format, with the times in seconds
+//! - \c residency: the textures and GL buffers in GPU memory, from the largest, as a JSON object with the keys
+//!   textureMemory, bufferMemory [bytes] and resources, the list of StelTextureMgr::getResidency().
+//!   The optional parameter \c owner only lists those of a module, e.g. \c owner=LandscapeMgr
+class PerfService : public AbstractAPIService
+{
+	Q_OBJECT
+public:
+	PerfService(QObject* parent = Q_NULLPTR);
+
+	virtual QLatin1String getPath() const Q_DECL_OVERRIDE { return QLatin1String("perf"); }
+	//! @brief Implements the HTTP GET requests
+	virtual void get(const QByteArray& operation,const APIParameters& parameters, APIServiceResponse& response) Q_DECL_OVERRIDE;
+private:
+	//! Write the metrics in the Prometheus text format
+	QByteArray toPrometheusText() const;
+
+	StelPerformanceMetrics* metrics;
+};
+
+#endif
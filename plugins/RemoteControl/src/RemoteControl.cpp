@@ -243,6 +243,7 @@ void RemoteControl::startServer()
 	//set request handler password settings
 	requestHandler->setPassword(password);
 	requestHandler->setUsePassword(usePassword);
+	requestHandler->setStreamingEnabled(true);
 	HttpListenerSettings settings;
 	settings.port = port;
 	settings.minThreads = minThreads;
@@ -254,6 +255,8 @@ void RemoteControl::stopServer()
 {
 	if(httpListener)
 	{
+		//the worker threads can only quit after their streams ended
+		requestHandler->setStreamingEnabled(false);
 		delete httpListener;
 		httpListener = Q_NULLPTR;
 	}
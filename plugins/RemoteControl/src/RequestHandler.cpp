@@ -22,14 +22,19 @@
 #include "templateengine/template.h"
 
 #include "APIController.hpp"
+#include "BatchService.hpp"
+#include "FrameStreamer.hpp"
 #include "LocationService.hpp"
 #include "LocationSearchService.hpp"
 #include "MainService.hpp"
+#include "MarkerService.hpp"
 #include "ObjectService.hpp"
+#include "PerfService.hpp"
 #include "ScriptService.hpp"
 #include "SimbadService.hpp"
 #include "StelActionService.hpp"
 #include "StelPropertyService.hpp"
+#include "StateSnapshot.hpp"
 #include "ViewService.hpp"
 
 #include "StelApp.hpp"
@@ -38,6 +43,7 @@
 #include "StelFileMgr.hpp"
 #include "StelModuleMgr.hpp"
 
+#include <QCryptographicHash>
 #include <QDir>
 #include <QFile>
 #include <QPluginLoader>
@@ -92,26 +98,34 @@ RequestHandler::RequestHandler(const StaticFileControllerSettings& settings, QOb
 	//register the services
 	//they "live" in the main thread in the QObject sense, but their service methods are actually
 	//executed in the HTTP handler threads
-	apiController->registerService(new MainService(apiController));
-	apiController->registerService(new ObjectService(apiController));
+	//the snapshots are published in update(), and answer the polls without waiting for the main thread
+	snapshots = new StateSnapshotMgr(this);
+	mainService = new MainService(snapshots, apiController);
+	apiController->registerService(mainService);
+	apiController->registerService(new ObjectService(snapshots, apiController));
 	apiController->registerService(new ScriptService(apiController));
 	apiController->registerService(new SimbadService(apiController));
 	apiController->registerService(new StelActionService(apiController));
-	apiController->registerService(new StelPropertyService(apiController));
+	apiController->registerService(new StelPropertyService(snapshots, apiController));
 	apiController->registerService(new LocationService(apiController));
 	apiController->registerService(new LocationSearchService(apiController));
 	apiController->registerService(new ViewService(apiController));
+	apiController->registerService(new BatchService(apiController, apiController));
+	apiController->registerService(new PerfService(apiController));
+	apiController->registerService(new MarkerService(apiController));
 
 	connect(&StelApp::getInstance().getModuleMgr(), SIGNAL(extensionsAdded(QObjectList)), this, SLOT(addExtensionServices(QObjectList)));
 	addExtensionServices(StelApp::getInstance().getModuleMgr().getExtensionList());
 
 	staticFiles = new StaticFileController(settings,this);
+	streamer = new FrameStreamer();
 	connect(&StelApp::getInstance(),SIGNAL(languageChanged()),this,SLOT(refreshTemplates()));
 	refreshTemplates();
 }
 
 RequestHandler::~RequestHandler()
 {
+	delete streamer;
 }
 
 void RequestHandler::addExtensionServices(QObjectList services)
@@ -130,6 +144,7 @@ void RequestHandler::addExtensionServices(QObjectList services)
 void RequestHandler::update(double deltaTime)
 {
 	apiController->update(deltaTime);
+	snapshots->update();
 }
 
 void RequestHandler::service(HttpRequest &request, HttpResponse &response)
@@ -138,11 +153,14 @@ void RequestHandler::service(HttpRequest &request, HttpResponse &response)
 #define SERVER_HEADER "Stellarium RemoteControl " REMOTECONTROL_PLUGIN_VERSION
 	response.setHeader("Server",SERVER_HEADER);
 
-	//try to support keep-alive connections
-	if(QString::compare(request.getHeader("Connection"),"keep-alive",Qt::CaseInsensitive)==0)
-		response.setHeader("Connection","keep-alive");
-	else
+	//connections are persistent by default in HTTP/1.1, HTTP/1.0 clients have to ask for it
+	//the tablet UIs load many small files, so reusing the connection saves a lot of round trips over Wi-Fi
+	const QByteArray connection = request.getHeader("Connection");
+	if(QString::compare(connection,"close",Qt::CaseInsensitive)==0
+	   || (request.getVersion()=="HTTP/1.0" && QString::compare(connection,"keep-alive",Qt::CaseInsensitive)!=0))
 		response.setHeader("Connection","close");
+	else
+		response.setHeader("Connection","keep-alive");
 
 	if(usePassword)
 	{
@@ -160,7 +178,25 @@ void RequestHandler::service(HttpRequest &request, HttpResponse &response)
 	QByteArray path = request.getPath();
 	//qDebug()<<"Request path:"<<rawPath<<" decoded:"<<path;
 
-	if(path.startsWith("/api/"))
+	if(path == "/api/main/push")
+	{
+		//WebSocket upgrade for the push channel of the MainService
+		QByteArray key = request.getHeader("Sec-WebSocket-Key");
+		if(!request.getHeader("Upgrade").toLower().contains("websocket") || key.isEmpty())
+		{
+			response.setStatus(400,"Bad Request");
+			response.write("HTTP 400 Expected WebSocket upgrade",true);
+			return;
+		}
+		QMetaObject::invokeMethod(mainService,"requestFullPush",Qt::QueuedConnection);
+		response.acceptWebSocket(key,mainService);
+	}
+	else if(path.startsWith("/api/stream/"))
+	{
+		//blocks this worker thread for the duration of the stream
+		streamer->service(request,response);
+	}
+	else if(path.startsWith("/api/"))
 	{
 		//this is an API request, pass it on
 		apiController->service(request,response);
@@ -182,7 +218,8 @@ void RequestHandler::service(HttpRequest &request, HttpResponse &response)
 			//to allow for immediate display of changes
 			refreshTemplates();
 #endif
-			QByteArray content = templateMap[path].toUtf8();
+			//copying is cheap, the data is shared
+			const TemplateEntry entry = templateMap.value(path);
 			templateMutex.unlock();
 
 			//get a mime type
@@ -190,8 +227,25 @@ void RequestHandler::service(HttpRequest &request, HttpResponse &response)
 			if(!mime.isEmpty())
 				response.setHeader("Content-Type",mime);
 
-			//serve the stored template
-			response.write(content,true);
+			//the content changes with the language, so the browser has to revalidate it each time
+			response.setHeader("Cache-Control","no-cache");
+			response.setHeader("ETag",entry.etag);
+			response.setHeader("Vary","Accept-Encoding");
+			if(request.getHeader("If-None-Match") == entry.etag)
+			{
+				response.setStatus(304,"Not Modified");
+				response.write(QByteArray(),true);
+			}
+			else if(!entry.gzipData.isEmpty() && request.getHeader("Accept-Encoding").contains("gzip"))
+			{
+				response.setHeader("Content-Encoding","gzip");
+				response.write(entry.gzipData,true);
+			}
+			else
+			{
+				//serve the stored template
+				response.write(entry.data,true);
+			}
 		}
 		else
 		{
@@ -207,6 +261,11 @@ void RequestHandler::setUsePassword(bool v)
 	usePassword = v;
 }
 
+void RequestHandler::setStreamingEnabled(bool v)
+{
+	streamer->setEnabled(v);
+}
+
 void RequestHandler::setPassword(const QString &pw)
 {
 	password = pw;
@@ -257,7 +316,13 @@ void RequestHandler::refreshTemplates()
 				//check if the file was correctly loaded
 				if(tmp.size()>0)
 				{
-					templateMap.insert('/'+line.toUtf8(),tmp);
+					TemplateEntry entry;
+					entry.data = tmp.toUtf8();
+					entry.gzipData = StelUtils::compressGzip(entry.data);
+					if(entry.gzipData.size() >= entry.data.size())
+						entry.gzipData.clear();
+					entry.etag = '"' + QCryptographicHash::hash(entry.data, QCryptographicHash::Md5).toHex() + '"';
+					templateMap.insert('/'+line.toUtf8(),entry);
 				}
 			}
 			else
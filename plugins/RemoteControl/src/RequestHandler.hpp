@@ -24,6 +24,9 @@
 #include "httpserver/staticfilecontroller.h"
 
 class APIController;
+class FrameStreamer;
+class MainService;
+class StateSnapshotMgr;
 class StaticFileController;
 
 //! This is the main request handler for the remote control plugin, receiving and dispatching the HTTP requests.
@@ -41,18 +44,23 @@ public:
 	//! The internal APIController, and all registered services are deleted
 	virtual ~RequestHandler();
 
-	//! Called in the main thread each frame, only passed on to APIController::update
+	//! Called in the main thread each frame, passed on to APIController::update, then publishes the StateSnapshot of the frame
 	void update(double deltaTime);
 
 	//! Receives the HttpRequest from the HttpListener.
 	//! It checks the optional HTTP authentication and sets the keep-alive header if requested
 	//! by the client.
 	//!
+	//! Connections are kept alive unless the client asks to close them, see HttpConnectionHandler for the timeout.
 	//! If the authentication is correct, the request is processed according to the following rules:
+	//!  - A WebSocket upgrade request for @c "/api/main/push" keeps the connection open, and the changes
+	//! of the main state are pushed to it by the MainService instead of having to poll its status operation.
+	//!  - Requests for @c "/api/stream/" are answered with the rendered frames by the FrameStreamer.
 	//!  - If the request path starts with the string @c "/api/", then the request is passed to
 	//! the \ref APIController without further processing.
 	//!  - If a file specified in the special \c translate_files file is requested, the cached translated version
-	//! of this file is returned. This cache is updated each time the app language changes.
+	//! of this file is returned, compressed with gzip if the client accepts it. This cache is updated each time the app language changes,
+	//! and its ETag lets browsers revalidate it with a 304 reply.
 	//!  - Otherwise, it is passed to a StaticFileController that has been set up for the \c data/webroot folder.
 	//!
 	//! @note This method runs in an HTTP worker thread, not in the Stellarium main thread, so take caution.
@@ -68,6 +76,8 @@ public slots:
 	bool getUsePassword() { return usePassword; }
 	//! @warning Make sure to only call this only when the server is offline because they are not synchronized
 	void setPassword(const QString& pw);
+	//! Disabling the frame streams ends the running ones, which is required before the server can be stopped
+	void setStreamingEnabled(bool v);
 
 private slots:
 	void refreshTemplates();
@@ -75,13 +85,24 @@ private slots:
 	void addExtensionServices(QObjectList services);
 
 private:
+	//! A translated template, serialized once for all requests
+	struct TemplateEntry
+	{
+		QByteArray data;
+		//! gzip compressed data, empty if compression does not make it smaller
+		QByteArray gzipData;
+		QByteArray etag;
+	};
 	//Contains the translated templates loaded from the file "translate_files" in the webroot folder
-	QMap<QByteArray,QString> templateMap;
+	QMap<QByteArray,TemplateEntry> templateMap;
 
 	bool usePassword;
 	QString password;
 	QByteArray passwordReply;
 	APIController* apiController;
+	MainService* mainService;
+	StateSnapshotMgr* snapshots;
+	FrameStreamer* streamer;
 	StaticFileController* staticFiles;
 	QMutex templateMutex;
 
@@ -40,9 +40,10 @@
 class SimbadLookupTask :public QRunnable
 {
 public:
-	SimbadLookupTask(const QString& url, const QString& searchTerm)
+	//! @param searchTerms one possibly truncated name, or several complete names which are looked up in one query
+	SimbadLookupTask(const QString& url, const QStringList& searchTerms)
 		: url(url)
-		, searchTerm(searchTerm)
+		, searchTerms(searchTerms)
 		, status(SimbadLookupReply::SimbadLookupQuerying)
 	{
 		parentThread = QThread::currentThread();
@@ -62,7 +63,8 @@ public:
 
 		//this MUST be created here for correct thread affinity
 		SimbadSearcher* searcher = new SimbadSearcher();
-		SimbadLookupReply* reply = searcher->lookup(url,searchTerm,3,0); //last parameter is zero to start lookup immediately
+		//last parameter is zero to start lookup immediately
+		SimbadLookupReply* reply = searchTerms.size()==1 ? searcher->lookup(url,searchTerms.first(),3,0) : searcher->lookupBatch(url,searchTerms,0);
 		//statusChanged is only called at the very end of the lookup as far as I can tell
 		//so we use it to exit the event queue
 		QObject::connect(reply,SIGNAL(statusChanged()),&loop,SLOT(quit()));
@@ -96,7 +98,7 @@ private:
 	QMutex mutex;
 	QWaitCondition finishedCondition;
 	QString url;
-	QString searchTerm;
+	QStringList searchTerms;
 	SimbadLookupReply::SimbadLookupStatus status;
 	QString statusString;
 	QString errorString;
@@ -118,10 +120,25 @@ void SimbadService::get(const QByteArray& operation, const APIParameters &parame
 		//but QNetworkManager does not provide a synchronous API
 
 		//this may contain greek or other unicode letters
-		QString str = QString::fromUtf8(parameters.value("str"));
-		str = str.trimmed().toLower();
+		QStringList terms;
+		if (parameters.contains("names"))
+		{
+			//several names, one per line, looked up in a single query
+			for (const auto& name : QString::fromUtf8(parameters.value("names")).split('\n'))
+			{
+				const QString term = name.trimmed().toLower();
+				if (!term.isEmpty() && !terms.contains(term))
+					terms.append(term);
+			}
+		}
+		else
+		{
+			const QString str = QString::fromUtf8(parameters.value("str")).trimmed().toLower();
+			if (!str.isEmpty())
+				terms.append(str);
+		}
 
-		if(str.isEmpty())
+		if(terms.isEmpty())
 		{
 			response.writeRequestError("empty search string");
 			return;
@@ -134,7 +151,7 @@ void SimbadService::get(const QByteArray& operation, const APIParameters &parame
 
 		//So we have to roll our own solution, using a mutex and a WaitCondition
 
-		SimbadLookupTask task(simbadServerUrl,str);
+		SimbadLookupTask task(simbadServerUrl,terms);
 		task.getMutex()->lock();
 
 		QThreadPool::globalInstance()->start(&task);
@@ -27,6 +27,8 @@ class StelObjectMgr;
 
 //! @ingroup remoteControl
 //! Allows SIMBAD object lookups like SearchDialog uses.
+//! The lookup operation takes the name to search in the str parameter, or several complete names, one per line,
+//! in the names parameter, which are looked up in a single query. The results of the names are by looked up name.
 //!
 //! @see \ref rcSimbadService
 //! @note This service supports threaded operation.
@@ -0,0 +1,298 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StateSnapshot.hpp"
+
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelLocaleMgr.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelMovementMgr.hpp"
+#include "StelObjectMgr.hpp"
+#include "StelPropertyMgr.hpp"
+#include "StelUtils.hpp"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QThread>
+
+StateSnapshot::StateSnapshot()
+	: frame(0), parts(0), hasSelection(false)
+{
+}
+
+StateSnapshot::StateSnapshot(const StateSnapshot &other)
+	: frame(other.frame), parts(other.parts),
+	  location(other.location), time(other.time), view(other.view), statusInfo(other.statusInfo),
+	  viewJ2000(other.viewJ2000), viewAltAz(other.viewAltAz),
+	  hasSelection(other.hasSelection), selectionInfo(other.selectionInfo),
+	  properties(other.properties)
+{
+	for(int i=0;i<3;++i)
+		viewJNow[i] = other.viewJNow[i];
+}
+
+void StateSnapshot::writeReply(const QByteArray &key, const std::function<QByteArray ()> &serialize, APIServiceResponse &response, const QByteArray &contentType) const
+{
+	Reply reply;
+	{
+		//concurrent identical requests wait for the first one instead of serializing again
+		QMutexLocker locker(&replyMutex);
+		auto it = replies.find(key);
+		if(it == replies.end())
+		{
+			Reply r;
+			r.data = serialize();
+			r.etag = '"' + QCryptographicHash::hash(r.data, QCryptographicHash::Md5).toHex() + '"';
+			it = replies.insert(key, r);
+		}
+		reply = *it;
+	}
+
+	response.setHeader("Content-Type", contentType);
+	response.setHeader("ETag", reply.etag);
+	response.setData(reply.data);
+}
+
+QByteArray StateSnapshot::toJson(const QJsonDocument &doc)
+{
+#ifdef QT_NO_DEBUG
+	return doc.toJson(QJsonDocument::Compact);
+#else
+	return doc.toJson(QJsonDocument::Indented);
+#endif
+}
+
+StateSnapshotMgr::StateSnapshotMgr(QObject *parent)
+	: QObject(parent), frame(0), locationDirty(true), statusInfoDirty(true), selectionInfoDirty(true),
+	  statusInfoMs(0), selectionInfoMs(0)
+{
+	core = StelApp::getInstance().getCore();
+	localeMgr = &StelApp::getInstance().getLocaleMgr();
+	mvmgr = GETSTELMODULE(StelMovementMgr);
+	objMgr = &StelApp::getInstance().getStelObjectMgr();
+	propMgr = StelApp::getInstance().getStelPropertyManager();
+
+	for(int i=0;i<StateSnapshot::PartCount;++i)
+		lastRequestMs[i] = 0;
+
+	connect(propMgr,SIGNAL(stelPropertiesChanged(QVariantMap)),this,SLOT(propertiesChanged(QVariantMap)));
+	connect(objMgr,SIGNAL(selectedObjectChanged(StelModule::StelModuleSelectAction)),this,SLOT(selectionChanged()));
+	connect(core,SIGNAL(locationChanged(StelLocation)),this,SLOT(locationChanged()));
+}
+
+StateSnapshotP StateSnapshotMgr::getSnapshot(StateSnapshot::Part part)
+{
+	QMutexLocker locker(&mutex);
+	lastRequestMs[part] = QDateTime::currentMSecsSinceEpoch();
+	if(current && current->has(part))
+		return current;
+	return StateSnapshotP();
+}
+
+void StateSnapshotMgr::propertiesChanged(const QVariantMap &changes)
+{
+	for (auto it = changes.constBegin(); it != changes.constEnd(); ++it)
+		dirtyProperties.insert(it.key());
+}
+
+void StateSnapshotMgr::update()
+{
+	Q_ASSERT(QThread::currentThread() == thread());
+
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	unsigned int wanted = 0;
+	{
+		QMutexLocker locker(&mutex);
+		for(int i=0;i<StateSnapshot::PartCount;++i)
+		{
+			if(now - lastRequestMs[i] <= RELEASE_TIME)
+				wanted |= 1u << i;
+		}
+		if(!wanted)
+		{
+			//nobody is polling, don't spend any time on it
+			current.clear();
+			dirtyProperties.clear();
+			return;
+		}
+	}
+
+	//only the main thread replaces current, so it can be read here without lock
+	QSharedPointer<StateSnapshot> next(current ? new StateSnapshot(*current) : new StateSnapshot());
+	const unsigned int had = next->parts;
+	next->frame = ++frame;
+	next->parts = wanted;
+
+	if(next->has(StateSnapshot::Status))
+	{
+		if(locationDirty || !(had & (1u << StateSnapshot::Status)))
+		{
+			next->location = getLocationStatus();
+			locationDirty = false;
+		}
+		next->time = getTimeStatus();
+		next->view = getViewStatus();
+		if(statusInfoDirty || !(had & (1u << StateSnapshot::Status)) || now - statusInfoMs >= INFO_REFRESH_TIME)
+		{
+			next->statusInfo = getStatusInfo();
+			statusInfoDirty = false;
+			statusInfoMs = now;
+		}
+	}
+	else
+	{
+		next->location = next->time = next->view = QJsonObject();
+		next->statusInfo.clear();
+	}
+
+	if(next->has(StateSnapshot::ViewDirection))
+	{
+		next->viewJ2000 = mvmgr->getViewDirectionJ2000();
+		next->viewJNow[StelCore::RefractionAuto] = core->j2000ToEquinoxEqu(next->viewJ2000, StelCore::RefractionAuto);
+		next->viewJNow[StelCore::RefractionOn] = core->j2000ToEquinoxEqu(next->viewJ2000, StelCore::RefractionOn);
+		next->viewJNow[StelCore::RefractionOff] = core->j2000ToEquinoxEqu(next->viewJ2000, StelCore::RefractionOff);
+		next->viewAltAz = core->j2000ToAltAz(next->viewJ2000, StelCore::RefractionAuto);
+	}
+
+	if(next->has(StateSnapshot::SelectionInfo))
+	{
+		if(selectionInfoDirty || !(had & (1u << StateSnapshot::SelectionInfo)) || now - selectionInfoMs >= INFO_REFRESH_TIME)
+		{
+			const QList<StelObjectP>& selection = objMgr->getSelectedObject();
+			next->hasSelection = !selection.isEmpty();
+			next->selectionInfo = next->hasSelection ? selection.first()->getInfoString(core) : QString();
+			selectionInfoDirty = false;
+			selectionInfoMs = now;
+		}
+	}
+	else
+	{
+		next->hasSelection = false;
+		next->selectionInfo.clear();
+	}
+
+	if(next->has(StateSnapshot::Properties))
+	{
+		const auto& map = propMgr->getPropertyMap();
+		if(!(had & (1u << StateSnapshot::Properties)) || map.size() != next->properties.size())
+		{
+			//first use, or properties were registered or removed
+			QJsonObject props;
+			for (auto it = map.constBegin(); it != map.constEnd(); ++it)
+				props.insert(it.key(), getPropertyStatus(*it));
+			next->properties = props;
+		}
+		else
+		{
+			for (const auto& id : dirtyProperties)
+			{
+				const StelProperty* prop = propMgr->getProperty(id);
+				if(prop)
+					next->properties.insert(id, getPropertyStatus(prop));
+			}
+		}
+	}
+	else
+		next->properties = QJsonObject();
+	dirtyProperties.clear();
+
+	QMutexLocker locker(&mutex);
+	current = next;
+}
+
+QJsonObject StateSnapshotMgr::getLocationStatus() const
+{
+	const StelLocation& loc = core->getCurrentLocation();
+	QJsonObject obj;
+	obj.insert("name",loc.name);
+	obj.insert("role",QString(loc.role));
+	obj.insert("planet",loc.planetName);
+	obj.insert("latitude",loc.latitude);
+	obj.insert("longitude",loc.longitude);
+	obj.insert("altitude",loc.altitude);
+	obj.insert("country",loc.country);
+	obj.insert("state",loc.state);
+	obj.insert("landscapeKey",loc.landscapeKey);
+	return obj;
+}
+
+QJsonObject StateSnapshotMgr::getTimeStatus() const
+{
+	double jday = core->getJD();
+	double deltaT = core->getDeltaT() * StelCore::JD_SECOND;
+
+	double gmtShift = core->getUTCOffset(jday) / 24.0;
+
+	QString utcIso = StelUtils::julianDayToISO8601String(jday,true).append('Z');
+	QString localIso = StelUtils::julianDayToISO8601String(jday+gmtShift,true);
+
+	//time zone string
+	QString timeZone = localeMgr->getPrintableTimeZoneLocal(jday);
+
+	QJsonObject obj;
+	obj.insert("jday",jday);
+	obj.insert("deltaT",deltaT);
+	obj.insert("gmtShift",gmtShift);
+	obj.insert("timeZone",timeZone);
+	obj.insert("utc",utcIso);
+	obj.insert("local",localIso);
+	obj.insert("isTimeNow",core->getIsTimeNow());
+	obj.insert("timerate",core->getTimeRate());
+	return obj;
+}
+
+QJsonObject StateSnapshotMgr::getViewStatus() const
+{
+	QJsonObject obj;
+
+	// the aim fov may lie outside the min/max bounds, so constrain it
+	double fov = mvmgr->getAimFov();
+	if(fov < mvmgr->getMinFov())
+		fov = mvmgr->getMinFov();
+	else if (fov>mvmgr->getMaxFov())
+		fov = mvmgr->getMaxFov();
+
+	obj.insert("fov",fov);
+	return obj;
+}
+
+QString StateSnapshotMgr::getStatusInfo() const
+{
+	const QList<StelObjectP>& selection = objMgr->getSelectedObject();
+	if(selection.isEmpty())
+		return QString();
+	return selection.first()->getInfoString(core,StelObject::AllInfo | StelObject::NoFont);
+}
+
+QJsonObject StateSnapshotMgr::getPropertyStatus(const StelProperty *prop)
+{
+	QJsonObject item;
+	QVariant val = prop->getValue();
+	QMetaProperty metaProp = prop->getMetaProp();
+	item.insert("value", QJsonValue::fromVariant(val));
+	//The actual data type the variant was converted to, may be different than typeString (for example enums/flags, or user types)
+	item.insert("variantType", val.typeName());
+	item.insert("typeString", metaProp.typeName());
+	item.insert("typeEnum", static_cast<qint64>(metaProp.type()));
+	item.insert("canNotify", metaProp.hasNotifySignal());
+	item.insert("isWritable", metaProp.isWritable());
+	return item;
+}
@@ -0,0 +1,181 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STATESNAPSHOT_HPP
+#define STATESNAPSHOT_HPP
+
+#include "RemoteControlServiceInterface.hpp"
+#include "VecMath.hpp"
+
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSet>
+#include <QSharedPointer>
+
+#include <functional>
+
+class StelCore;
+class StelLocaleMgr;
+class StelMovementMgr;
+class StelObjectMgr;
+class StelProperty;
+class StelPropertyMgr;
+
+//! @ingroup remoteControl
+//! The state of the main program at one frame, which the HTTP worker threads can read without waiting for the main thread.
+//! A snapshot is not changed anymore after it has been published by StateSnapshotMgr, except for its cache of serialized replies,
+//! so it can be shared by all concurrent requests.
+class StateSnapshot
+{
+public:
+	//! The parts of the snapshot, which are only maintained while they are requested
+	enum Part
+	{
+		Status,		//!< location, time, view and selection info as in the MainService status reply
+		ViewDirection,	//!< view direction vectors, as in the MainService view reply
+		SelectionInfo,	//!< the HTML info string of the selected object, as in the ObjectService info reply
+		Properties,	//!< all StelProperty values, as in the StelPropertyService list reply
+		PartCount
+	};
+
+	StateSnapshot();
+	//! Copies the state, but not the serialized replies
+	StateSnapshot(const StateSnapshot& other);
+
+	//! Returns true if the part is valid in this snapshot
+	bool has(Part part) const { return parts & (1u << part); }
+
+	//! Writes the reply identified by key into the response. The reply is serialized only by the first request
+	//! which needs it for this snapshot, all identical requests get the same data.
+	//! An ETag header is derived from the content, so that the APIController can answer unchanged polls with
+	//! HTTP 304 Not Modified.
+	//! @param key identifies the operation and all parameters which influence the reply
+	//! @param serialize creates the reply data from this snapshot
+	//! @param contentType the Content-Type header of the reply
+	void writeReply(const QByteArray& key, const std::function<QByteArray()>& serialize, APIServiceResponse& response,
+			const QByteArray& contentType = "application/json; charset=utf-8") const;
+	//! Serializes the document in the same format as APIServiceResponse::writeJSON
+	static QByteArray toJson(const QJsonDocument& doc);
+
+	//! Number of the frame for which this snapshot was published
+	quint64 frame;
+	//! Bit mask of the valid parts
+	unsigned int parts;
+
+	//! @name Status
+	//! @{
+	QJsonObject location;
+	QJsonObject time;
+	QJsonObject view;
+	QString statusInfo;
+	//! @}
+
+	//! @name ViewDirection
+	//! @{
+	Vec3d viewJ2000;
+	//! JNow view direction, indexed by StelCore::RefractionMode
+	Vec3d viewJNow[3];
+	Vec3d viewAltAz;
+	//! @}
+
+	//! @name SelectionInfo
+	//! @{
+	bool hasSelection;
+	QString selectionInfo;
+	//! @}
+
+	//! @name Properties
+	//! @{
+	QJsonObject properties;
+	//! @}
+
+private:
+	struct Reply
+	{
+		QByteArray data;
+		QByteArray etag;
+	};
+	mutable QMutex replyMutex;
+	mutable QHash<QByteArray, Reply> replies;
+};
+
+typedef QSharedPointer<const StateSnapshot> StateSnapshotP;
+
+//! @ingroup remoteControl
+//! Publishes a new StateSnapshot each frame from RemoteControl::update().
+//! Only the parts which were requested in the last RELEASE_TIME ms are maintained, and they are updated incrementally:
+//! the location and the StelProperty values are only refreshed when they changed, the info strings at most each
+//! INFO_REFRESH_TIME ms or when the selection changed.
+class StateSnapshotMgr : public QObject
+{
+	Q_OBJECT
+public:
+	StateSnapshotMgr(QObject* parent = Q_NULLPTR);
+
+	//! Returns the current snapshot if it contains the part, and marks the part as requested so that it is published
+	//! from the next frame on. Can be called from any thread.
+	//! @return a null pointer if the part is not published yet, the request has to be answered by the main thread then
+	StateSnapshotP getSnapshot(StateSnapshot::Part part);
+
+	//! Publishes the snapshot of the current frame. Called in the main thread.
+	void update();
+
+	//! @name Builders for the JSON objects of the MainService status reply. Called in the main thread.
+	//! @{
+	QJsonObject getLocationStatus() const;
+	QJsonObject getTimeStatus() const;
+	QJsonObject getViewStatus() const;
+	QString getStatusInfo() const;
+	//! @}
+	//! Builds the StelPropertyService list entry of a property. Called in the main thread.
+	static QJsonObject getPropertyStatus(const StelProperty* prop);
+
+private slots:
+	void propertiesChanged(const QVariantMap& changes);
+	void selectionChanged() { statusInfoDirty = selectionInfoDirty = true; }
+	void locationChanged() { locationDirty = true; }
+
+private:
+	StelCore* core;
+	StelLocaleMgr* localeMgr;
+	StelMovementMgr* mvmgr;
+	StelObjectMgr* objMgr;
+	StelPropertyMgr* propMgr;
+
+	//! protects current and lastRequestMs
+	QMutex mutex;
+	StateSnapshotP current;
+	qint64 lastRequestMs[StateSnapshot::PartCount];
+
+	quint64 frame;
+	bool locationDirty;
+	bool statusInfoDirty;
+	bool selectionInfoDirty;
+	qint64 statusInfoMs;
+	qint64 selectionInfoMs;
+	QSet<QString> dirtyProperties;
+
+	//! Time in ms after which unrequested parts are not maintained anymore
+	static const qint64 RELEASE_TIME = 3000;
+	//! Time in ms after which the info strings are rebuilt even without selection change, e.g. for moving objects
+	static const qint64 INFO_REFRESH_TIME = 250;
+};
+
+#endif
@@ -18,6 +18,7 @@
  */
 
 #include "StelPropertyService.hpp"
+#include "StateSnapshot.hpp"
 
 #include "StelApp.hpp"
 #include "StelCore.hpp"
@@ -28,12 +29,27 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 
-StelPropertyService::StelPropertyService(QObject *parent)
-	: AbstractAPIService(parent)
+StelPropertyService::StelPropertyService(StateSnapshotMgr *snapshots, QObject *parent)
+	: AbstractAPIService(parent), snapshots(snapshots)
 {
 	propMgr = StelApp::getInstance().getStelPropertyManager();
 }
 
+bool StelPropertyService::getSnapshot(const QByteArray &operation, const APIParameters &parameters, APIServiceResponse &response)
+{
+	Q_UNUSED(parameters);
+
+	if(operation!="list")
+		return false;
+
+	StateSnapshotP snapshot = snapshots->getSnapshot(StateSnapshot::Properties);
+	if(!snapshot)
+		return false;
+
+	snapshot->writeReply("stelproperty/list", [&]() { return StateSnapshot::toJson(QJsonDocument(snapshot->properties)); }, response);
+	return true;
+}
+
 void StelPropertyService::get(const QByteArray& operation, const APIParameters &parameters, APIServiceResponse &response)
 {
 	Q_UNUSED(parameters);
@@ -44,21 +60,7 @@ void StelPropertyService::get(const QByteArray& operation, const APIParameters &
 
 		const auto& map = propMgr->getPropertyMap();
 		for (auto it = map.constBegin(); it != map.constEnd(); ++it)
-		{
-			QJsonObject item;
-			const StelProperty* prop = *it;
-			QVariant val = prop->getValue();
-			QMetaProperty metaProp = prop->getMetaProp();
-			item.insert("value", QJsonValue::fromVariant(val));
-			//The actual data type the variant was converted to, may be different than typeString (for example enums/flags, or user types)
-			item.insert("variantType", val.typeName());
-			item.insert("typeString", metaProp.typeName());
-			item.insert("typeEnum", static_cast<qint64>(metaProp.type()));
-			item.insert("canNotify", metaProp.hasNotifySignal());
-			item.insert("isWritable", metaProp.isWritable());
-
-			rootObj.insert(it.key(),item);
-		}
+			rootObj.insert(it.key(),StateSnapshotMgr::getPropertyStatus(*it));
 
 		response.writeJSON(QJsonDocument(rootObj));
 	}
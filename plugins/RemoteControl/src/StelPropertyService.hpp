@@ -23,6 +23,8 @@
 #include "AbstractAPIService.hpp"
 #include "StelPropertyMgr.hpp"
 
+class StateSnapshotMgr;
+
 //! @ingroup remoteControl
 //! Provides services related to StelProperty.
 //! See also the StelProperty related operations of MainService.
@@ -33,17 +35,21 @@ class StelPropertyService : public AbstractAPIService
 {
 	Q_OBJECT
 public:
-	StelPropertyService(QObject* parent = Q_NULLPTR);
+	//! @param snapshots the shared snapshots used to answer polls without waiting for the main thread
+	StelPropertyService(StateSnapshotMgr* snapshots, QObject* parent = Q_NULLPTR);
 
 	virtual QLatin1String getPath() const Q_DECL_OVERRIDE { return QLatin1String("stelproperty"); }
 	//! @brief Implements the HTTP GET method
 	//! @see \ref rcStelPropertyServiceGET
 	virtual void get(const QByteArray& operation,const APIParameters& parameters, APIServiceResponse& response) Q_DECL_OVERRIDE;
+	//! Answers the \c list operation from the StateSnapshot, while it is being polled
+	virtual bool getSnapshot(const QByteArray &operation, const APIParameters &parameters, APIServiceResponse &response) Q_DECL_OVERRIDE;
 	//! @brief Implements the HTTP POST method
 	//! @see \ref rcStelPropertyServicePOST
 	virtual void post(const QByteArray &operation, const APIParameters &parameters, const QByteArray &data, APIServiceResponse &response) Q_DECL_OVERRIDE;
 private:
 	StelPropertyMgr* propMgr;
+	StateSnapshotMgr* snapshots;
 };
 
 #endif
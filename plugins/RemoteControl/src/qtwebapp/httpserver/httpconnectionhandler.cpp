@@ -15,6 +15,8 @@ HttpConnectionHandler::HttpConnectionHandler(const HttpConnectionHandlerSettings
     this->sslConfiguration=sslConfiguration;
     currentRequest=0;
     busy=false;
+    webSocket=false;
+    webSocketSource=0;
 
     // Create TCP or SSL socket
     createSocket();
@@ -159,6 +161,13 @@ void HttpConnectionHandler::disconnected()
 #ifndef NDEBUG
     qDebug("HttpConnectionHandler (%p): disconnected", this);
 #endif
+    if (webSocket)
+    {
+        disconnect(webSocketSource, 0, this, 0);
+        webSocket=false;
+        webSocketSource=0;
+        webSocketBuffer.clear();
+    }
     socket->close();
     readTimer.stop();
     busy = false;
@@ -166,6 +175,12 @@ void HttpConnectionHandler::disconnected()
 
 void HttpConnectionHandler::read()
 {
+    if (webSocket)
+    {
+        readWebSocket();
+        return;
+    }
+
     // The loop adds support for HTTP pipelinig
     while (socket->bytesAvailable())
     {
@@ -229,6 +244,11 @@ void HttpConnectionHandler::read()
                     closeConnection=true;
                     response.setHeader("Connection","close");
                 }
+                else
+                {
+                    // Tell the client how long an idle connection is kept open for the next request
+                    response.setHeader("Keep-Alive","timeout="+QByteArray::number(qMax(1,settings.readTimeout/1000)));
+                }
             }
 
             // Call the request mapper
@@ -241,6 +261,15 @@ void HttpConnectionHandler::read()
                 qCritical("HttpConnectionHandler (%p): An uncatched exception occured in the request handler",this);
             }
 
+            // The connection carries WebSocket frames from now on
+            if (response.getWebSocketSource())
+            {
+                delete currentRequest;
+                currentRequest=0;
+                startWebSocket(response.getWebSocketSource());
+                return;
+            }
+
             // Finalize sending the response if not already done
             if (!response.hasSentLastPart())
             {
@@ -293,3 +322,137 @@ void HttpConnectionHandler::read()
         }
     }
 }
+
+
+void HttpConnectionHandler::startWebSocket(QObject* source)
+{
+#ifndef NDEBUG
+    qDebug("HttpConnectionHandler (%p): switched to WebSocket", this);
+#endif
+    webSocket=true;
+    webSocketSource=source;
+    webSocketBuffer.clear();
+    // The messages are emitted in other threads, and queued to this one
+    connect(source, SIGNAL(webSocketMessage(QByteArray)), this, SLOT(sendWebSocketMessage(QByteArray)), Qt::QueuedConnection);
+    // Process frames which were received together with the handshake
+    if (socket->bytesAvailable())
+    {
+        readWebSocket();
+    }
+}
+
+
+void HttpConnectionHandler::readWebSocket()
+{
+    webSocketBuffer.append(socket->readAll());
+    while (webSocket && webSocketBuffer.size()>=2)
+    {
+        // Frame header, see RFC 6455 section 5.2
+        const char opcode=webSocketBuffer.at(0) & 0x0F;
+        const bool masked=(webSocketBuffer.at(1) & 0x80)!=0;
+        quint64 length=webSocketBuffer.at(1) & 0x7F;
+        int pos=2;
+        if (length==126)
+        {
+            if (webSocketBuffer.size()<4)
+                return;
+            length=(quint64(quint8(webSocketBuffer.at(2)))<<8) | quint8(webSocketBuffer.at(3));
+            pos=4;
+        }
+        else if (length==127)
+        {
+            if (webSocketBuffer.size()<10)
+                return;
+            length=0;
+            for (int i=2; i<10; ++i)
+            {
+                length=(length<<8) | quint8(webSocketBuffer.at(i));
+            }
+            pos=10;
+        }
+
+        // Client frames must be masked, and are only expected to be small
+        if (!masked || length>quint64(settings.maxRequestSize))
+        {
+            qWarning("HttpConnectionHandler (%p): invalid WebSocket frame, closing connection", this);
+            writeWebSocketFrame(0x8, QByteArray("\x03\xea", 2)); // 1002 protocol error
+            socket->flush();
+            socket->disconnectFromHost();
+            webSocketBuffer.clear();
+            return;
+        }
+        if (quint64(webSocketBuffer.size())<pos+4+length)
+            return;
+
+        const QByteArray mask=webSocketBuffer.mid(pos,4);
+        QByteArray payload=webSocketBuffer.mid(pos+4,int(length));
+        for (int i=0; i<payload.size(); ++i)
+        {
+            payload[i]=payload.at(i) ^ mask.at(i%4);
+        }
+        webSocketBuffer.remove(0,pos+4+int(length));
+
+        if (opcode==0x8)
+        {
+            // Close: echo the status code, and close the connection
+            writeWebSocketFrame(0x8, payload.left(2));
+            socket->flush();
+            socket->disconnectFromHost();
+            webSocketBuffer.clear();
+            return;
+        }
+        else if (opcode==0x9)
+        {
+            // Ping: answer with a pong with the same data
+            writeWebSocketFrame(0xA, payload);
+        }
+        // Data and pong frames from the client are ignored, commands are sent with normal HTTP requests
+    }
+}
+
+
+void HttpConnectionHandler::writeWebSocketFrame(char opcode, const QByteArray& payload)
+{
+    // Server frames are not masked, and sent in one piece (FIN bit set)
+    QByteArray frame;
+    frame.reserve(payload.size()+10);
+    frame.append(char(0x80 | opcode));
+    const quint64 length=payload.size();
+    if (length<126)
+    {
+        frame.append(char(length));
+    }
+    else if (length<65536)
+    {
+        frame.append(char(126));
+        frame.append(char(length>>8));
+        frame.append(char(length & 0xFF));
+    }
+    else
+    {
+        frame.append(char(127));
+        for (int i=7; i>=0; --i)
+        {
+            frame.append(char((length>>(8*i)) & 0xFF));
+        }
+    }
+    frame.append(payload);
+    socket->write(frame);
+}
+
+
+void HttpConnectionHandler::sendWebSocketMessage(const QByteArray& message)
+{
+    // Messages queued before the client disconnected may still arrive
+    if (!webSocket)
+        return;
+
+    // A client which cannot keep up is dropped, it gets the full state again when it reconnects
+    if (socket->bytesToWrite()>settings.maxWebSocketBacklog)
+    {
+        qWarning("HttpConnectionHandler (%p): WebSocket client does not keep up, closing connection", this);
+        socket->abort();
+        return;
+    }
+    writeWebSocketFrame(0x1, message);
+}
@@ -42,7 +42,7 @@ typedef QSslConfiguration HttpSslConfiguration;
  */
 struct HttpConnectionHandlerSettings {
 	HttpConnectionHandlerSettings()
-		: readTimeout(10000),maxRequestSize(16384),maxMultipartSize(1048576)
+		: readTimeout(10000),maxRequestSize(16384),maxMultipartSize(1048576),maxWebSocketBacklog(1048576)
 	{}
 
 	/** Defines the maximum time to wait for a complete HTTP request in msec. Default 10000. */
@@ -51,6 +51,9 @@ struct HttpConnectionHandlerSettings {
 	int maxRequestSize;
 	/** Maximum size of a multipart request in bytes. Default 1048576 (1MB) */
 	int maxMultipartSize;
+	/** Maximum number of bytes waiting to be sent to a WebSocket client, before it is disconnected
+	    because it cannot keep up. Default 1048576 (1MB) */
+	int maxWebSocketBacklog;
 };
 
 
@@ -68,6 +71,10 @@ struct HttpConnectionHandlerSettings {
   </pre></code>
   <p>
   The readTimeout value defines the maximum time to wait for a complete HTTP request.
+  <p>
+  If the request handler accepts a WebSocket upgrade with HttpResponse::acceptWebSocket(), the connection
+  stays open without timeout and only carries WebSocket frames: the messages of the source are sent to the
+  client, pings are answered, and other frames from the client are ignored.
   @see HttpRequest for description of config settings maxRequestSize and maxMultiPartSize.
 */
 class DECLSPEC HttpConnectionHandler : public QThread {
@@ -122,6 +129,24 @@ private:
     /**  Create SSL or TCP socket */
     void createSocket();
 
+    /** True if the current connection was upgraded to a WebSocket */
+    bool webSocket;
+
+    /** Received WebSocket data which does not form a complete frame yet */
+    QByteArray webSocketBuffer;
+
+    /** Source of the messages sent to the WebSocket client */
+    QObject* webSocketSource;
+
+    /** Switch the current connection to WebSocket frames */
+    void startWebSocket(QObject* source);
+
+    /** Process the received WebSocket frames */
+    void readWebSocket();
+
+    /** Send a single WebSocket frame */
+    void writeWebSocketFrame(char opcode, const QByteArray& payload);
+
 public slots:
 
     /**
@@ -141,6 +166,9 @@ private slots:
     /** Received from the socket when a connection has been closed */
     void disconnected();
 
+    /** Received from the WebSocket source, sends a text message to the client */
+    void sendWebSocketMessage(const QByteArray& message);
+
 };
 
 #endif // HTTPCONNECTIONHANDLER_H
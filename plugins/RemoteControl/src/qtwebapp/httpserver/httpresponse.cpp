@@ -4,6 +4,7 @@
 */
 
 #include "httpresponse.h"
+#include <QCryptographicHash>
 
 HttpResponse::HttpResponse(QTcpSocket* socket)
 {
@@ -13,6 +14,7 @@ HttpResponse::HttpResponse(QTcpSocket* socket)
     sentHeaders=false;
     sentLastPart=false;
     chunkedMode=false;
+    webSocketSource=Q_NULLPTR;
 }
 
 void HttpResponse::setHeader(QByteArray name, QByteArray value)
@@ -200,3 +202,27 @@ bool HttpResponse::isConnected() const
 {
     return socket->isOpen();
 }
+
+
+void HttpResponse::acceptWebSocket(const QByteArray& key, QObject* source)
+{
+    Q_ASSERT(sentHeaders==false);
+    Q_ASSERT(source);
+
+    // The accept key is defined in RFC 6455, section 4.2.2
+    static const QByteArray guid="258EAFA5-E914-47DA-95CA-C5AB0DC11B65";
+    setStatus(101,"Switching Protocols");
+    headers.insert("Upgrade","websocket");
+    headers.insert("Connection","Upgrade");
+    headers.insert("Sec-WebSocket-Accept",QCryptographicHash::hash(key+guid,QCryptographicHash::Sha1).toBase64());
+    writeHeaders();
+    socket->flush();
+    sentLastPart=true;
+    webSocketSource=source;
+}
+
+
+QObject* HttpResponse::getWebSocketSource() const
+{
+    return webSocketSource;
+}
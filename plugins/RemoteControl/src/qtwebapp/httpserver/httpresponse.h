@@ -122,6 +122,20 @@ public:
      */
     bool isConnected() const;
 
+    /**
+      Accept a WebSocket upgrade request (RFC 6455) by sending the handshake response.
+      Afterwards, the connection handler sends the messages emitted by the
+      webSocketMessage(QByteArray) signal of the source to the client as text frames.
+      The connection cannot be used for further HTTP requests.
+      Cannot be combined with write().
+      @param key Value of the Sec-WebSocket-Key header of the request
+      @param source Object with a webSocketMessage(QByteArray) signal, which must outlive the connection
+    */
+    void acceptWebSocket(const QByteArray& key, QObject* source);
+
+    /** Returns the source passed to acceptWebSocket(), or Q_NULLPTR if this is a normal response */
+    QObject* getWebSocketSource() const;
+
 private:
 
     /** Request headers */
@@ -148,6 +162,9 @@ private:
     /** Cookies */
     QMap<QByteArray,HttpCookie> cookies;
 
+    /** Source of the WebSocket messages, if the connection was upgraded */
+    QObject* webSocketSource;
+
     /** Write raw data to the socket. This method blocks until all bytes have been passed to the TCP buffer */
     bool writeToSocket(QByteArray data);
 
@@ -7,8 +7,11 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QDateTime>
+#include <QLocale>
 #include <QMimeDatabase>
 
+#include "StelUtils.hpp"
+
 StaticFileController::StaticFileController(const StaticFileControllerSettings& settings, QObject* parent)
     :HttpRequestHandler(parent)
 {
@@ -27,6 +30,7 @@ StaticFileController::StaticFileController(const StaticFileControllerSettings& s
     maxCachedFileSize=settings.maxCachedFileSize;
     cache.setMaxCost(settings.cacheSize);
     cacheTimeout=settings.cacheTime;
+    compress=settings.compress;
     qDebug("StaticFileController: cache timeout=%i, size=%i",cacheTimeout,cache.maxCost());
 }
 
@@ -34,21 +38,35 @@ StaticFileController::StaticFileController(const StaticFileControllerSettings& s
 void StaticFileController::service(HttpRequest& request, HttpResponse& response)
 {
     QByteArray path=request.getPath();
+    QByteArray acceptEncoding=request.getHeader("Accept-Encoding");
+    bool acceptBrotli=acceptEncoding.contains("br");
+    bool acceptGzip=acceptEncoding.contains("gzip");
+    // The reply depends on the accepted encodings, so they are part of the cache key
+    QString cacheKey=QString::fromUtf8(path);
+    if (acceptBrotli)
+        cacheKey+="|br";
+    if (acceptGzip)
+        cacheKey+="|gzip";
+
     // Check if we have the file in cache
     qint64 now=QDateTime::currentMSecsSinceEpoch();
     mutex.lock();
-    CacheEntry* entry=cache.object(path);
+    CacheEntry* entry=cache.object(cacheKey);
     if (entry && (cacheTimeout==0 || entry->created>now-cacheTimeout))
     {
         QByteArray document=entry->document; //copy the cached document, because other threads may destroy the cached entry immediately after mutex unlock.
         QByteArray filename=entry->filename;
+        QByteArray encoding=entry->encoding;
+        QByteArray lastModified=entry->lastModified;
         mutex.unlock();
 #ifndef NDEBUG
         qDebug("StaticFileController: Cache hit for %s",path.data());
 #endif
         setContentType(filename,response);
-        response.setHeader("Cache-Control","max-age="+QByteArray::number(maxAge));
-        response.write(document);
+        if (!writeCacheHeaders(request,response,encoding,lastModified))
+        {
+            response.write(document,true);
+        }
     }
     else
     {
@@ -70,32 +88,56 @@ void StaticFileController::service(HttpRequest& request, HttpResponse& response)
         {
             path+="/index.html";
         }
-        // Try to open the file
+        // Prefer a pre-compressed version of the file, if the client accepts it
+        QByteArray encoding;
         QFile file(docroot+path);
+        if (acceptBrotli && QFileInfo(docroot+path+".br").isFile() && file.exists())
+        {
+            file.setFileName(docroot+path+".br");
+            encoding="br";
+        }
+        else if (acceptGzip && QFileInfo(docroot+path+".gz").isFile() && file.exists())
+        {
+            file.setFileName(docroot+path+".gz");
+            encoding="gzip";
+        }
+        // Try to open the file
 #ifndef NDEBUG
         qDebug("StaticFileController: Open file %s",qPrintable(file.fileName()));
 #endif
         if (file.open(QIODevice::ReadOnly))
         {
+            QByteArray lastModified=QLocale::c().toString(QFileInfo(file).lastModified().toUTC(),"ddd, dd MMM yyyy hh:mm:ss 'GMT'").toLatin1();
             setContentType(path,response);
-            response.setHeader("Cache-Control","max-age="+QByteArray::number(maxAge));
             if (file.size()<=maxCachedFileSize)
             {
                 // Return the file content and store it also in the cache
                 entry=new CacheEntry();
-                while (!file.atEnd() && !file.error())
+                entry->document=file.readAll();
+                if (encoding.isEmpty() && acceptGzip && compress && isCompressible(path))
                 {
-                    QByteArray buffer=file.read(65536);
-                    response.write(buffer);
-                    entry->document.append(buffer);
+                    // Compress once for all following requests, but only if it is worth it
+                    QByteArray compressed=StelUtils::compressGzip(entry->document);
+                    if (!compressed.isEmpty() && compressed.size()<entry->document.size())
+                    {
+                        entry->document=compressed;
+                        encoding="gzip";
+                    }
                 }
                 entry->created=now;
                 entry->filename=path;
+                entry->encoding=encoding;
+                entry->lastModified=lastModified;
+                if (!writeCacheHeaders(request,response,encoding,lastModified))
+                {
+                    // Send it in one part, so that the Content-Length is known and no chunked mode is required
+                    response.write(entry->document,true);
+                }
                 mutex.lock();
-                cache.insert(request.getPath(),entry,entry->document.size());
+                cache.insert(cacheKey,entry,entry->document.size());
                 mutex.unlock();
             }
-            else
+            else if (!writeCacheHeaders(request,response,encoding,lastModified))
             {
                 // Return the file content, do not store in cache
                 while (!file.atEnd() && !file.error())
@@ -121,6 +163,32 @@ void StaticFileController::service(HttpRequest& request, HttpResponse& response)
     }
 }
 
+bool StaticFileController::writeCacheHeaders(const HttpRequest& request, HttpResponse& response, const QByteArray& encoding, const QByteArray& lastModified) const
+{
+    response.setHeader("Cache-Control","max-age="+QByteArray::number(maxAge));
+    response.setHeader("Last-Modified",lastModified);
+    response.setHeader("Vary","Accept-Encoding");
+    if (!encoding.isEmpty())
+    {
+        response.setHeader("Content-Encoding",encoding);
+    }
+    // Browsers send back the Last-Modified value unchanged
+    if (!lastModified.isEmpty() && request.getHeader("If-Modified-Since")==lastModified)
+    {
+        response.setStatus(304,"Not Modified");
+        response.write(QByteArray(),true);
+        return true;
+    }
+    return false;
+}
+
+bool StaticFileController::isCompressible(const QByteArray& fileName)
+{
+    return fileName.endsWith(".html") || fileName.endsWith(".htm") || fileName.endsWith(".css")
+            || fileName.endsWith(".js") || fileName.endsWith(".json") || fileName.endsWith(".svg")
+            || fileName.endsWith(".txt");
+}
+
 QByteArray StaticFileController::getContentType(QString fileName, QString encoding)
 {
 	//Directly return the most commonly used types
@@ -20,7 +20,7 @@
 struct StaticFileControllerSettings
 {
 	StaticFileControllerSettings()
-		: encoding("UTF-8"),maxAge(60),cacheTime(60000),cacheSize(1048576),maxCachedFileSize(65536)
+		: encoding("UTF-8"),maxAge(60),cacheTime(60000),cacheSize(1048576),maxCachedFileSize(65536),compress(true)
 	{}
 
 	/** The path to the document root. Default empty (= current working directory). */
@@ -35,6 +35,8 @@ struct StaticFileControllerSettings
 	int cacheSize;
 	/** Maximum size of a single file in the serverside cache. Default 65536 (64KB) */
 	int maxCachedFileSize;
+	/** Compress cacheable text files with gzip for clients which accept it, if there is no pre-compressed file. Default true */
+	bool compress;
 };
 
 
@@ -60,6 +62,12 @@ struct StaticFileControllerSettings
   The cache improves performance of small files when loaded from a network
   drive. Large files are not cached. Files are cached as long as possible,
   when cacheTime=0. The maxAge value (in msec!) controls the remote browsers cache.
+  Replies carry a Last-Modified header, and requests with a matching If-Modified-Since
+  header are answered with 304 Not Modified.
+  <p>
+  If the client accepts it, a pre-compressed file next to the requested one is sent instead,
+  with the extension .br for brotli or .gz for gzip. Otherwise, cacheable text files are compressed
+  with gzip once when they are loaded into the cache, if the compress setting is enabled.
   <p>
   Do not instantiate this class in each request, because this would make the file cache
   useless. Better create one instance during start-up and call it when the application
@@ -96,8 +104,14 @@ private:
         QByteArray document;
         qint64 created;
         QByteArray filename;
+        /** Content-Encoding of the document, empty if not compressed */
+        QByteArray encoding;
+        QByteArray lastModified;
     };
 
+    /** Compress cacheable text files on the fly */
+    bool compress;
+
     /** Timeout for each cached file */
     int cacheTimeout;
 
@@ -112,6 +126,13 @@ private:
 
     /** Set a content-type header in the response depending on the ending of the filename */
     void setContentType(QString file, HttpResponse& response) const;
+
+    /** Sets the caching headers, and answers with 304 if the client has the current version.
+        @return true if the reply was sent */
+    bool writeCacheHeaders(const HttpRequest& request, HttpResponse& response, const QByteArray& encoding, const QByteArray& lastModified) const;
+
+    /** Returns true for text files which are worth compressing */
+    static bool isCompressible(const QByteArray& fileName);
 };
 
 #endif // STATICFILECONTROLLER_H
@@ -62,6 +62,9 @@ StelPluginInfo RemoteSyncStelPluginInterface::getPluginInfo() const
 RemoteSync::RemoteSync()
 	: clientServerPort(20180)
 	, serverPort(20180)
+	, serverFrameSync(true)
+	, serverPresentationDelay(50)
+	, serverMulticastPort(20181)
 	, connectionLostBehavior(ClientBehavior::RECONNECT)
 	, quitBehavior(ClientBehavior::NONE)
 	, state(IDLE)
@@ -181,10 +184,9 @@ void RemoteSync::update(double deltaTime)
 {
 	Q_UNUSED(deltaTime);
 	if(server)
-	{
-		//pass update on to server, client does not need this
 		server->update();
-	}
+	if(client)
+		client->update();
 }
 
 double RemoteSync::getCallOrder(StelModuleActionName actionName) const
@@ -265,6 +267,8 @@ void RemoteSync::startServer()
 	if(state == IDLE)
 	{
 		server = new SyncServer(this);
+		server->setFrameSync(serverFrameSync, serverPresentationDelay);
+		server->setMulticast(serverMulticastGroup, serverMulticastPort);
 		if(server->start(serverPort))
 			setState(SERVER);
 		else
@@ -382,6 +386,10 @@ void RemoteSync::loadSettings()
 	setConnectionLostBehavior(static_cast<ClientBehavior>(conf->value("connectionLostBehavior",1).toInt()));
 	setQuitBehavior(static_cast<ClientBehavior>(conf->value("quitBehavior").toInt()));
 	reconnectTimer.setInterval(conf->value("clientReconnectInterval", 5000).toInt());
+	serverFrameSync = conf->value("serverFrameSync", true).toBool();
+	serverPresentationDelay = conf->value("serverPresentationDelay", 50).toInt();
+	serverMulticastGroup = conf->value("serverMulticastGroup").toString();
+	serverMulticastPort = conf->value("serverMulticastPort", 20181).toInt();
 	conf->endGroup();
 }
 
@@ -396,6 +404,10 @@ void RemoteSync::saveSettings()
 	conf->setValue("connectionLostBehavior", connectionLostBehavior);
 	conf->setValue("quitBehavior", quitBehavior);
 	conf->setValue("clientReconnectInterval", reconnectTimer.interval());
+	conf->setValue("serverFrameSync", serverFrameSync);
+	conf->setValue("serverPresentationDelay", serverPresentationDelay);
+	conf->setValue("serverMulticastGroup", serverMulticastGroup);
+	conf->setValue("serverMulticastPort", serverMulticastPort);
 	conf->endGroup();
 }
 
@@ -167,6 +167,12 @@ private:
 	int clientServerPort;
 	//the port used in server mode
 	int serverPort;
+	//send the time, view and fov once per frame, presented by the clients after the delay in ms
+	bool serverFrameSync;
+	int serverPresentationDelay;
+	//the UDP multicast group (e.g. 239.255.0.1) and port for the high-rate messages, multicast is off if empty
+	QString serverMulticastGroup;
+	int serverMulticastPort;
 	SyncClient::SyncOptions syncOptions;
 	QStringList stelPropFilter;
 	ClientBehavior connectionLostBehavior;
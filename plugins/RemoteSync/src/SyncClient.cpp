@@ -37,17 +37,29 @@ SyncClient::SyncClient(SyncOptions options, const QStringList &excludeProperties
 	  stelPropFilter(excludeProperties),
 	  isConnecting(false),
 	  server(Q_NULLPTR),
-	  timeoutTimerId(-1)
+	  timeoutTimerId(-1),
+	  frameHandler(Q_NULLPTR),
+	  timeHandler(Q_NULLPTR),
+	  multicastSocket(Q_NULLPTR),
+	  hasMulticastSequence(false),
+	  lastMulticastSequence(0),
+	  hasClockOffset(false),
+	  clockOffset(0.0),
+	  latency(0.0)
 {
 	handlerList.resize(MSGTYPE_SIZE);
 	handlerList[ERROR] = new ClientErrorHandler(this);
 	handlerList[SERVER_CHALLENGE] = new ClientAuthHandler(this);
 	handlerList[SERVER_CHALLENGERESPONSEVALID] = new ClientAuthHandler(this);
-	handlerList[ALIVE] = new ClientAliveHandler();
+	handlerList[ALIVE] = new ClientAliveHandler(this);
+	handlerList[MULTICAST] = new ClientMulticastHandler(this);
 
 	//these are the actual sync handlers
 	if(options.testFlag(SyncTime))
-		handlerList[TIME] = new ClientTimeHandler();
+	{
+		timeHandler = new ClientTimeHandler(this);
+		handlerList[TIME] = timeHandler;
+	}
 	if(options.testFlag(SyncLocation))
 		handlerList[LOCATION] = new ClientLocationHandler();
 	if(options.testFlag(SyncSelection))
@@ -58,12 +70,21 @@ SyncClient::SyncClient(SyncOptions options, const QStringList &excludeProperties
 		handlerList[VIEW] = new ClientViewHandler();
 	if(options.testFlag(SyncFov))
 		handlerList[FOV] = new ClientFovHandler();
+	if(options & (SyncTime | SyncView | SyncFov))
+	{
+		frameHandler = new ClientFrameHandler(this, options.testFlag(SyncTime), options.testFlag(SyncView), options.testFlag(SyncFov));
+		handlerList[FRAME] = frameHandler;
+	}
 
 	//fill unused handlers with dummies
 	for(int t = TIME;t<MSGTYPE_SIZE;++t)
 	{
 		if(!handlerList[t]) handlerList[t] = new DummyMessageHandler();
 	}
+
+	//measure the clock offset from the start of the connection
+	connect(this, SIGNAL(connected()), this, SLOT(sendClockRequest()));
+	clockSyncTimerId = startTimer(CLOCK_SYNC_INTERVAL);
 }
 
 SyncClient::~SyncClient()
@@ -82,12 +103,74 @@ SyncClient::~SyncClient()
 	qCDebug(syncClient)<<"Destroyed";
 }
 
+void SyncClient::update()
+{
+	if(timeHandler)
+		timeHandler->update();
+	if(frameHandler)
+		frameHandler->update();
+}
+
+void SyncClient::sendClockRequest()
+{
+	if(server && server->isAuthenticated())
+	{
+		Alive msg;
+		msg.originTime = QDateTime::currentMSecsSinceEpoch();
+		server->writeMessage(msg);
+	}
+}
+
+void SyncClient::addClockSample(const Alive &reply, qint64 receiveTime)
+{
+	//the NTP estimate: the offset is exact if the network delay is the same in both directions
+	ClockSample sample;
+	sample.delay = (receiveTime - reply.originTime) - (reply.transmitTime - reply.receiveTime);
+	sample.offset = ((reply.receiveTime - reply.originTime) + (reply.transmitTime - receiveTime)) / 2.0;
+	if(sample.delay < 0)
+		return;
+
+	clockSamples.append(sample);
+	if(clockSamples.size() > CLOCK_FILTER_SIZE)
+		clockSamples.remove(0);
+
+	//a sample with a larger delay was probably queued somewhere on one way, which makes its offset wrong
+	const ClockSample* best = &clockSamples.first();
+	for (const auto& s : clockSamples)
+	{
+		if(s.delay < best->delay)
+			best = &s;
+	}
+
+	if(!hasClockOffset)
+	{
+		clockOffset = best->offset;
+		hasClockOffset = true;
+		qCDebug(syncClient)<<"Server clock offset"<<clockOffset<<"ms, latency"<<best->delay / 2.0<<"ms";
+	}
+	else
+	{
+		//slew towards the new estimate, so the time does not jump
+		clockOffset += (best->offset - clockOffset) * 0.25;
+	}
+	latency = best->delay / 2.0;
+}
+
+void SyncClient::resetClock()
+{
+	clockSamples.clear();
+	hasClockOffset = false;
+	clockOffset = 0.0;
+	latency = 0.0;
+}
+
 void SyncClient::connectToServer(const QString &host, const int port)
 {
 	if(server)
 	{
 		disconnectFromServer();
 	}
+	resetClock();
 
 	QTcpSocket* sock = new QTcpSocket();
 	connect(sock, SIGNAL(connected()), this, SLOT(socketConnected()));
@@ -115,6 +198,11 @@ void SyncClient::timerEvent(QTimerEvent *evt)
 		checkTimeout();
 		evt->accept();
 	}
+	else if(evt->timerId() == clockSyncTimerId)
+	{
+		sendClockRequest();
+		evt->accept();
+	}
 }
 
 void SyncClient::checkTimeout()
@@ -128,6 +216,7 @@ void SyncClient::checkTimeout()
 void SyncClient::serverDisconnected(bool clean)
 {
 	qCDebug(syncClient)<<"Disconnected from server";
+	leaveMulticastGroup();
 	if(!clean)
 		errorStr = server->getError();
 	server->deleteLater();
@@ -135,6 +224,79 @@ void SyncClient::serverDisconnected(bool clean)
 	emit disconnected(errorStr.isEmpty());
 }
 
+bool SyncClient::joinMulticastGroup(const QString &group, quint16 port)
+{
+	leaveMulticastGroup();
+
+	QHostAddress addr(group);
+	if(!addr.isMulticast())
+	{
+		qCWarning(syncClient)<<"Server sent an invalid multicast group"<<group;
+		return false;
+	}
+
+	multicastSocket = new QUdpSocket(this);
+	const QHostAddress any = addr.protocol() == QAbstractSocket::IPv6Protocol ? QHostAddress::AnyIPv6 : QHostAddress::AnyIPv4;
+	//several clients may run on the same computer
+	if(!multicastSocket->bind(any, port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint)
+			|| !multicastSocket->joinMulticastGroup(addr))
+	{
+		qCWarning(syncClient)<<"Could not join multicast group"<<group<<"port"<<port<<":"<<multicastSocket->errorString();
+		leaveMulticastGroup();
+		return false;
+	}
+
+	multicastGroup = addr;
+	hasMulticastSequence = false;
+	connect(multicastSocket, SIGNAL(readyRead()), this, SLOT(receiveDatagrams()));
+	qCDebug(syncClient)<<"Joined multicast group"<<group<<"port"<<port;
+	return true;
+}
+
+void SyncClient::leaveMulticastGroup()
+{
+	if(multicastSocket)
+	{
+		multicastSocket->leaveMulticastGroup(multicastGroup);
+		multicastSocket->deleteLater();
+		multicastSocket = Q_NULLPTR;
+	}
+}
+
+void SyncClient::receiveDatagrams()
+{
+	QByteArray datagram;
+	while(multicastSocket && multicastSocket->hasPendingDatagrams())
+	{
+		datagram.resize(static_cast<int>(multicastSocket->pendingDatagramSize()));
+		multicastSocket->readDatagram(datagram.data(), datagram.size());
+
+		if(!server || !server->isAuthenticated())
+			continue;
+
+		QDataStream stream(datagram);
+		stream.setVersion(SYNC_DATASTREAM_VERSION);
+		quint32 sequence;
+		SyncHeader header;
+		stream>>sequence>>header;
+		if(stream.status() || datagram.size() != SYNC_DATAGRAM_HEADER_SIZE + SYNC_HEADER_SIZE + header.dataSize
+				|| header.msgType > MSGTYPE_MAX || !isMulticastMessage(SyncMessageType(header.msgType)))
+		{
+			qCWarning(syncClient)<<"Ignoring invalid multicast datagram";
+			continue;
+		}
+
+		//drop duplicated and reordered datagrams, the newer state was already received
+		if(hasMulticastSequence && static_cast<qint32>(sequence - lastMulticastSequence) <= 0)
+			continue;
+		hasMulticastSequence = true;
+		lastMulticastSequence = sequence;
+
+		if(!handlerList[header.msgType]->handleMessage(stream, header.dataSize, *server))
+			qCWarning(syncClient)<<"Multicast message of type"<<SyncMessageType(header.msgType)<<"was rejected";
+	}
+}
+
 void SyncClient::socketConnected()
 {
 	qCDebug(syncClient)<<"Socket connected";
@@ -23,11 +23,15 @@
 #include <QLoggingCategory>
 #include <QObject>
 #include <QTcpSocket>
+#include <QUdpSocket>
 
 Q_DECLARE_LOGGING_CATEGORY(syncClient)
 
 class SyncMessageHandler;
 class SyncRemotePeer;
+class ClientFrameHandler;
+class ClientTimeHandler;
+namespace SyncProtocol { class Alive; }
 
 //! A client which can connect to a SyncServer to receive state changes, and apply them
 class SyncClient : public QObject
@@ -56,6 +60,17 @@ public:
 
 	QString errorString() const { return errorStr; }
 
+	//! Presents the frames received from a server using frame sync, and applies the clock offset to the time.
+	//! This should be called in the StelModule::update function.
+	void update();
+
+	//! Converts a time of the server clock in ms since the epoch to the local clock
+	qint64 toLocalTime(qint64 serverTime) const { return serverTime - qRound64(clockOffset); }
+	//! The estimated offset of the server clock to the local clock in ms
+	double getClockOffset() const { return clockOffset; }
+	//! The estimated one-way network latency to the server in ms
+	double getLatency() const { return latency; }
+
 public slots:
 	void connectToServer(const QString& host, const int port);
 	void disconnectFromServer();
@@ -69,9 +84,19 @@ private slots:
 	void serverDisconnected(bool clean);
 	void socketConnected();
 	void emitServerError(const QString& errorStr);
+	//! Dispatches the messages in the received multicast datagrams to the handlers
+	void receiveDatagrams();
+	//! Sends an Alive message with the current time, which the server answers with its clock
+	void sendClockRequest();
 
 private:
 	void checkTimeout();
+	//! Starts to receive the multicast messages of the server, returns false if the group could not be joined
+	bool joinMulticastGroup(const QString& group, quint16 port);
+	void leaveMulticastGroup();
+	//! Updates the clock offset estimate with the answer to a clock request
+	void addClockSample(const SyncProtocol::Alive& reply, qint64 receiveTime);
+	void resetClock();
 
 	SyncOptions options;
 	QStringList stelPropFilter; // list of excluded properties
@@ -80,8 +105,32 @@ private:
 	SyncRemotePeer* server;
 	int timeoutTimerId;
 	QVector<SyncMessageHandler*> handlerList;
+	//! also contained in handlerList
+	ClientFrameHandler* frameHandler;
+	ClientTimeHandler* timeHandler;
+	QUdpSocket* multicastSocket;
+	QHostAddress multicastGroup;
+	bool hasMulticastSequence;
+	quint32 lastMulticastSequence;
+
+	struct ClockSample
+	{
+		qint64 delay;
+		double offset;
+	};
+	//! the last samples, the one with the smallest round trip delay is the most accurate
+	QVector<ClockSample> clockSamples;
+	bool hasClockOffset;
+	double clockOffset;
+	double latency;
+	int clockSyncTimerId;
+	//! interval of the clock requests in ms
+	static const int CLOCK_SYNC_INTERVAL = 1000;
+	static const int CLOCK_FILTER_SIZE = 8;
 
 	friend class ClientErrorHandler;
+	friend class ClientMulticastHandler;
+	friend class ClientAliveHandler;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(SyncClient::SyncOptions)
@@ -29,6 +29,8 @@
 #include "StelObjectMgr.hpp"
 #include "StelPropertyMgr.hpp"
 
+#include <QDateTime>
+
 using namespace SyncProtocol;
 
 ClientHandler::ClientHandler()
@@ -154,10 +156,42 @@ bool ClientAuthHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloa
 	}
 }
 
+ClientMulticastHandler::ClientMulticastHandler(SyncClient *client)
+	: ClientHandler(client)
+{
+}
+
+bool ClientMulticastHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
+{
+	Multicast msg;
+	bool ok = msg.deserialize(stream, dataSize);
+	if(!ok) return false;
+
+	msg.joined = client->joinMulticastGroup(msg.group, msg.port);
+	peer.writeMessage(msg);
+	return true;
+}
+
+ClientAliveHandler::ClientAliveHandler(SyncClient *client)
+	: ClientHandler(client)
+{
+}
+
 bool ClientAliveHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
 {
+	const qint64 receiveTime = QDateTime::currentMSecsSinceEpoch();
 	Alive p;
-	return p.deserialize(stream,dataSize);
+	if(!p.deserialize(stream,dataSize))
+		return false;
+
+	if(p.isClockReply())
+		client->addClockSample(p, receiveTime);
+	return true;
+}
+
+ClientTimeHandler::ClientTimeHandler(SyncClient *client)
+	: ClientHandler(client), hasTime(false), serverSyncTime(0), syncJD(0.0)
+{
 }
 
 bool ClientTimeHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
@@ -171,12 +205,23 @@ bool ClientTimeHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloa
 	//set time variables, time rate first because it causes a resetSync which we overwrite
 	core->setTimeRate(msg.timeRate);
 	core->setJD(msg.jDay);
-	//This is needed for compensation of network delay. Requires system clocks of client/server to be calibrated to the same values.
-	core->setMilliSecondsOfLastJDUpdate(msg.lastTimeSyncTime);
+	//This compensates the network delay, the sync time is converted to the local clock
+	core->setMilliSecondsOfLastJDUpdate(client->toLocalTime(msg.lastTimeSyncTime));
 
+	hasTime = true;
+	serverSyncTime = msg.lastTimeSyncTime;
+	syncJD = msg.jDay;
 	return true;
 }
 
+void ClientTimeHandler::update()
+{
+	//the clock offset estimate is refined continuously, so the time follows it each frame instead of jumping on the next time sync.
+	//If the time was changed locally in the meantime, leave it alone.
+	if(hasTime && core->getJDOfLastJDUpdate() == syncJD)
+		core->setMilliSecondsOfLastJDUpdate(client->toLocalTime(serverSyncTime));
+}
+
 bool ClientLocationHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
 {
 	Location msg;
@@ -233,9 +278,20 @@ bool ClientSelectionHandler::handleMessage(QDataStream &stream, SyncProtocol::tP
 	//this might cause problems if 2 objects of different types have the same name!
 	QList<StelObjectP> selection;
 
-	for (const auto& selectedObject : msg.selectedObjects)
+	for (int i = 0; i < msg.selectedObjects.size(); ++i)
 	{
-		StelObjectP obj = objMgr->searchByID(selectedObject.first, selectedObject.second);
+		const auto& selectedObject = msg.selectedObjects.at(i);
+		StelObjectP obj;
+		//the handle is only valid if the server uses the same catalogs, so check that it gives the expected object
+		const quint64 handle = msg.selectedHandles.value(i, 0);
+		if(handle)
+		{
+			obj = objMgr->searchByHandle(handle);
+			if(obj && (obj->getType() != selectedObject.first || obj->getID() != selectedObject.second))
+				obj.clear();
+		}
+		if(!obj)
+			obj = objMgr->searchByID(selectedObject.first, selectedObject.second);
 		if(obj)
 			selection.append(obj);
 		else
@@ -348,3 +404,78 @@ bool ClientFovHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayload
 	mvMgr->zoomTo(msg.fov, 0.0f);
 	return true;
 }
+
+ClientFrameHandler::ClientFrameHandler(SyncClient* client, bool syncTime, bool syncView, bool syncFov)
+	: ClientHandler(client), syncTime(syncTime), syncView(syncView), syncFov(syncFov), hasKeyFrame(false), lastFrameNumber(0),
+	  timeRate(0.0), clockWarningShown(false)
+{
+	mvMgr = core->getMovementMgr();
+}
+
+bool ClientFrameHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
+{
+	Frame msg;
+	bool ok = msg.deserialize(stream, dataSize);
+	if(!ok) return false;
+
+	if(msg.flags & Frame::KeyFrame)
+		hasKeyFrame = true;
+	else if(!hasKeyFrame)
+		return true;
+	else if(msg.frameNumber != lastFrameNumber + 1)
+		peer.peerLog(QString("Frame %1 follows frame %2").arg(msg.frameNumber).arg(lastFrameNumber));
+	lastFrameNumber = msg.frameNumber;
+
+	state = msg.apply(state);
+	if(msg.flags & Frame::HasTimeRate)
+		timeRate = msg.timeRate;
+
+	PendingFrame frame;
+	frame.presentationTime = client->toLocalTime(msg.presentationTime);
+	frame.flags = msg.flags;
+	frame.state = state;
+	frame.timeRate = timeRate;
+
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	if(frame.presentationTime - now > MAX_PRESENTATION_DELAY)
+	{
+		if(!clockWarningShown)
+		{
+			peer.peerLog("Frame presentation time is too far in the future, the presentation delay of the server is too large. Frames are presented immediately.");
+			clockWarningShown = true;
+		}
+		frame.presentationTime = now;
+	}
+	pending.enqueue(frame);
+	return true;
+}
+
+void ClientFrameHandler::update()
+{
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	if(pending.isEmpty() || pending.head().presentationTime > now)
+		return;
+
+	//only the newest due frame is shown, but the changes of the skipped frames have to be applied too
+	quint8 flags = 0;
+	PendingFrame frame;
+	while(!pending.isEmpty() && pending.head().presentationTime <= now)
+	{
+		frame = pending.dequeue();
+		flags |= frame.flags;
+	}
+
+	if(syncTime && (flags & (Frame::HasTime | Frame::HasTimeRate)))
+	{
+		//time rate first because it causes a resetSync which we overwrite
+		if(flags & Frame::HasTimeRate)
+			core->setTimeRate(frame.timeRate);
+		core->setJD(Frame::getJDay(frame.state));
+		//the time is valid at the presentation time, the core extrapolates it from there
+		core->setMilliSecondsOfLastJDUpdate(frame.presentationTime);
+	}
+	if(syncView && (flags & Frame::HasView))
+		mvMgr->setViewDirectionJ2000(core->altAzToJ2000(Frame::getViewAltAz(frame.state), StelCore::RefractionOff));
+	if(syncFov && (flags & Frame::HasFov))
+		mvMgr->zoomTo(Frame::getFov(frame.state), 0.0f);
+}
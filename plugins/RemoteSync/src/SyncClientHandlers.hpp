@@ -21,7 +21,9 @@
 #define SYNCCLIENTHANDLERS_HPP
 
 #include "SyncProtocol.hpp"
+#include "SyncMessages.hpp"
 
+#include <QQueue>
 #include <QRegularExpression>
 
 class SyncClient;
@@ -59,16 +61,35 @@ signals:
 	void authenticated();
 };
 
-class ClientAliveHandler : public SyncMessageHandler
+//! Joins the multicast group announced by the server, and answers with the result
+class ClientMulticastHandler : public ClientHandler
+{
+	Q_OBJECT
+public:
+	ClientMulticastHandler(SyncClient* client);
+	bool handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
+};
+
+//! Passes the answers to the clock requests on to the SyncClient
+class ClientAliveHandler : public ClientHandler
 {
 public:
+	ClientAliveHandler(SyncClient* client);
 	bool handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
 };
 
 class ClientTimeHandler : public ClientHandler
 {
 public:
+	ClientTimeHandler(SyncClient* client);
 	bool handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
+	//! Moves the time sync point of the core to the current estimate of the server clock offset. Called once per frame.
+	void update();
+private:
+	bool hasTime;
+	//! the time of the last time sync on the server clock
+	qint64 serverSyncTime;
+	double syncJD;
 };
 
 class ClientLocationHandler : public ClientHandler
@@ -117,4 +138,35 @@ private:
 	StelMovementMgr* mvMgr;
 };
 
+//! Buffers the received frames, and applies them when their presentation time is reached
+class ClientFrameHandler : public ClientHandler
+{
+public:
+	ClientFrameHandler(SyncClient* client, bool syncTime, bool syncView, bool syncFov);
+	bool handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
+	//! Applies the newest frame whose presentation time was reached. Called once per frame.
+	void update();
+private:
+	struct PendingFrame
+	{
+		qint64 presentationTime;
+		quint8 flags;
+		SyncProtocol::Frame::State state;
+		double timeRate;
+	};
+
+	StelMovementMgr* mvMgr;
+	bool syncTime, syncView, syncFov;
+	bool hasKeyFrame;
+	quint32 lastFrameNumber;
+	//! The absolute state of the last received frame
+	SyncProtocol::Frame::State state;
+	double timeRate;
+	QQueue<PendingFrame> pending;
+	bool clockWarningShown;
+
+	//! Frames which should be presented later than this in ms are presented immediately, the clock offset estimate is wrong then
+	static const qint64 MAX_PRESENTATION_DELAY = 1000;
+};
+
 #endif
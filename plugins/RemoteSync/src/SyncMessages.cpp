@@ -18,6 +18,9 @@
  */
 
 #include "SyncMessages.hpp"
+#include "StelUtils.hpp"
+
+#include <cmath>
 
 using namespace SyncProtocol;
 
@@ -161,12 +164,14 @@ bool Location::deserialize(QDataStream &stream, tPayloadSize dataSize)
 void Selection::serialize(QDataStream &stream) const
 {
 	stream<<selectedObjects;
+	stream<<selectedHandles;
 }
 
 bool Selection::deserialize(QDataStream &stream, tPayloadSize dataSize)
 {
 	Q_UNUSED(dataSize);
 	stream>>selectedObjects;
+	stream>>selectedHandles;
 	return !stream.status();
 }
 
@@ -213,3 +218,201 @@ bool Fov::deserialize(QDataStream &stream, tPayloadSize dataSize)
 
 	return !stream.status();
 }
+
+Alive::Alive()
+	: originTime(0), receiveTime(0), transmitTime(0)
+{
+}
+
+void Alive::serialize(QDataStream &stream) const
+{
+	stream<<originTime<<receiveTime<<transmitTime;
+}
+
+bool Alive::deserialize(QDataStream &stream, tPayloadSize dataSize)
+{
+	if(dataSize != 3 * sizeof(qint64))
+		return false;
+
+	stream>>originTime>>receiveTime>>transmitTime;
+	return !stream.status();
+}
+
+Multicast::Multicast()
+	: port(0), joined(false)
+{
+}
+
+void Multicast::serialize(QDataStream &stream) const
+{
+	writeString(stream, group);
+	stream<<port<<joined;
+}
+
+bool Multicast::deserialize(QDataStream &stream, tPayloadSize dataSize)
+{
+	Q_UNUSED(dataSize);
+	group = readString(stream);
+	stream>>port>>joined;
+	return !stream.status();
+}
+
+namespace
+{
+//! Unit of the quantised angles, a full circle maps to 2^32
+const double ANGLE_UNIT = 2.0 * M_PI / 4294967296.0;
+//! Unit of log2(fov)
+const double FOV_SCALE = 16777216.0;
+const double USEC_PER_DAY = 86400.0 * 1000000.0;
+
+//! Writes a signed value as zigzag encoded varint, small values of both signs take a single byte
+void writeVarint(QDataStream& stream, qint64 val)
+{
+	quint64 u = (static_cast<quint64>(val) << 1) ^ static_cast<quint64>(val >> 63);
+	while(u >= 0x80)
+	{
+		stream<<static_cast<quint8>(u | 0x80);
+		u >>= 7;
+	}
+	stream<<static_cast<quint8>(u);
+}
+
+//! Reads a varint written with writeVarint, and adds the number of bytes read to size
+bool readVarint(QDataStream& stream, qint64& val, tPayloadSize& size)
+{
+	quint64 u = 0;
+	for(int shift = 0; shift < 64; shift += 7)
+	{
+		quint8 b;
+		stream>>b;
+		++size;
+		if(stream.status())
+			return false;
+		u |= static_cast<quint64>(b & 0x7F) << shift;
+		if(!(b & 0x80))
+		{
+			val = static_cast<qint64>((u >> 1) ^ (~(u & 1) + 1));
+			return true;
+		}
+	}
+	return false;
+}
+}
+
+Frame::Frame()
+	: frameNumber(0), presentationTime(0), flags(0), timeRate(0.0)
+{
+}
+
+void Frame::serialize(QDataStream &stream) const
+{
+	stream<<frameNumber<<presentationTime<<flags;
+	if(flags & HasTimeRate)
+		stream<<timeRate;
+	if(flags & HasTime)
+		writeVarint(stream, values.time);
+	if(flags & HasView)
+	{
+		//wrapped azimuth differences are sent as the shorter signed difference
+		writeVarint(stream, static_cast<qint32>(values.azimuth));
+		writeVarint(stream, values.altitude);
+	}
+	if(flags & HasFov)
+		writeVarint(stream, values.logFov);
+}
+
+bool Frame::deserialize(QDataStream &stream, tPayloadSize dataSize)
+{
+	tPayloadSize size = sizeof(frameNumber) + sizeof(presentationTime) + sizeof(flags);
+	if(dataSize < size)
+		return false;
+
+	stream>>frameNumber>>presentationTime>>flags;
+	if(flags & HasTimeRate)
+	{
+		stream>>timeRate;
+		size += sizeof(timeRate);
+	}
+
+	values = State();
+	qint64 val;
+	if(flags & HasTime)
+	{
+		if(!readVarint(stream, val, size))
+			return false;
+		values.time = val;
+	}
+	if(flags & HasView)
+	{
+		if(!readVarint(stream, val, size))
+			return false;
+		values.azimuth = static_cast<quint32>(val);
+		if(!readVarint(stream, val, size))
+			return false;
+		values.altitude = static_cast<qint32>(val);
+	}
+	if(flags & HasFov)
+	{
+		if(!readVarint(stream, val, size))
+			return false;
+		values.logFov = static_cast<qint32>(val);
+	}
+
+	return size == dataSize && !stream.status();
+}
+
+Frame::State Frame::quantise(double jDay, const Vec3d &viewAltAz, double fov)
+{
+	State state;
+	state.time = qRound64(jDay * USEC_PER_DAY);
+	double az, alt;
+	StelUtils::rectToSphe(&az, &alt, viewAltAz);
+	//the conversion of the negative values to unsigned wraps them around the circle
+	state.azimuth = static_cast<quint32>(static_cast<qint64>(std::floor(az / ANGLE_UNIT + 0.5)));
+	state.altitude = qRound(alt / ANGLE_UNIT);
+	state.logFov = qRound(std::log2(qMax(fov, 1e-12)) * FOV_SCALE);
+	return state;
+}
+
+double Frame::getJDay(const State &state)
+{
+	return state.time / USEC_PER_DAY;
+}
+
+Vec3d Frame::getViewAltAz(const State &state)
+{
+	Vec3d v;
+	StelUtils::spheToRect(state.azimuth * ANGLE_UNIT, state.altitude * ANGLE_UNIT, v);
+	return v;
+}
+
+double Frame::getFov(const State &state)
+{
+	return std::exp2(state.logFov / FOV_SCALE);
+}
+
+Frame::State Frame::difference(const State &from, const State &to)
+{
+	State diff;
+	diff.time = to.time - from.time;
+	diff.azimuth = to.azimuth - from.azimuth;
+	diff.altitude = to.altitude - from.altitude;
+	diff.logFov = to.logFov - from.logFov;
+	return diff;
+}
+
+Frame::State Frame::apply(const State &previous) const
+{
+	State state = previous;
+	const bool key = flags & KeyFrame;
+	if(flags & HasTime)
+		state.time = key ? values.time : state.time + values.time;
+	if(flags & HasView)
+	{
+		state.azimuth = key ? values.azimuth : state.azimuth + values.azimuth;
+		state.altitude = key ? values.altitude : state.altitude + values.altitude;
+	}
+	if(flags & HasFov)
+		state.logFov = key ? values.logFov : state.logFov + values.logFov;
+	return state;
+}
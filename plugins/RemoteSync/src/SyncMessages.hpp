@@ -87,9 +87,8 @@ public:
 	void serialize(QDataStream &stream) const Q_DECL_OVERRIDE;
 	bool deserialize(QDataStream &stream, SyncProtocol::tPayloadSize dataSize) Q_DECL_OVERRIDE;
 
-	//TODO implement network delay compensation (also for other message types where it makes sense)
 	//TODO maybe split up so that each message is only for 1 thing?
-	qint64 lastTimeSyncTime; //corresponds to StelCore::milliSecondsOfLastJDayUpdate
+	qint64 lastTimeSyncTime; //corresponds to StelCore::milliSecondsOfLastJDayUpdate, on the server clock
 	double jDay; //current jDay, without any time zone/deltaT adjustments
 	double timeRate; //current time rate
 
@@ -125,12 +124,32 @@ public:
 
 	//list of type/ID pairs
 	QList< QPair<QString,QString> > selectedObjects;
+	//! Handles of the selected objects from StelObjectMgr::getObjectHandle(), in the same order as selectedObjects.
+	//! They allow to find objects without a unique ID, e.g. unnamed stars, when both sides use the same catalogs.
+	QList<quint64> selectedHandles;
 };
 
+//! Sent after no data was sent for some time, and used by the client to measure the clock offset to the server
+//! like NTP does: the client sends originTime, and the server answers with the same value and its receive and transmit time.
+//! All times are in ms since the epoch of the clock of the respective peer, zero if not used.
 class Alive : public SyncMessage
 {
 public:
+	Alive();
+
 	SyncProtocol::SyncMessageType getMessageType() const Q_DECL_OVERRIDE  { return SyncProtocol::ALIVE; }
+
+	void serialize(QDataStream& stream) const Q_DECL_OVERRIDE;
+	bool deserialize(QDataStream &stream, tPayloadSize dataSize) Q_DECL_OVERRIDE;
+
+	//! True if this is a clock request of a client
+	bool isClockRequest() const { return originTime && !receiveTime; }
+	//! True if this is the answer of the server to a clock request
+	bool isClockReply() const { return originTime && receiveTime; }
+
+	qint64 originTime;
+	qint64 receiveTime;
+	qint64 transmitTime;
 };
 
 class StelPropertyUpdate : public SyncMessage
@@ -172,6 +191,89 @@ public:
 	double fov;
 };
 
+//! Sent by the server after authentication if it uses UDP multicast, with the group address and port.
+//! The client answers with the same message, with joined set if it receives the datagrams of the group.
+class Multicast : public SyncMessage
+{
+public:
+	Multicast();
+
+	SyncMessageType getMessageType() const Q_DECL_OVERRIDE { return SyncProtocol::MULTICAST; }
+
+	void serialize(QDataStream& stream) const Q_DECL_OVERRIDE;
+	bool deserialize(QDataStream &stream, tPayloadSize dataSize) Q_DECL_OVERRIDE;
+
+	QDebug debugOutput(QDebug dbg) const Q_DECL_OVERRIDE
+	{
+		return dbg<<group<<port<<joined;
+	}
+
+	QString group;
+	quint16 port;
+	bool joined;
+};
+
+//! The time, view direction and field of view of one server frame, broadcast once per frame if the server uses frame sync.
+//! All values are quantised to integers, and only the changes to the previous frame are sent as variable length integers,
+//! so a frame during a smooth movement takes about 25 bytes instead of the 90 bytes of separate Time, View and Fov messages.
+//! Clients apply the frame at presentationTime, so all of them show the same state at the same moment.
+//! They convert it to their own clock with the offset measured with the Alive messages.
+class Frame : public SyncMessage
+{
+public:
+	//! The quantised state. The time is in microseconds of JD, the direction in units of 2pi/2^32,
+	//! the field of view as log2(fov) in units of 2^-24.
+	struct State
+	{
+		State() : time(0), azimuth(0), altitude(0), logFov(0) {}
+		qint64 time;
+		quint32 azimuth;
+		qint32 altitude;
+		qint32 logFov;
+	};
+
+	enum Flags
+	{
+		KeyFrame	= 0x01, //!< the values are absolute, otherwise they are the difference to the previous frame
+		HasTimeRate	= 0x02, //!< the time rate changed, it is sent as double
+		HasTime		= 0x04,
+		HasView		= 0x08,
+		HasFov		= 0x10
+	};
+
+	Frame();
+
+	SyncMessageType getMessageType() const Q_DECL_OVERRIDE { return SyncProtocol::FRAME; }
+
+	void serialize(QDataStream& stream) const Q_DECL_OVERRIDE;
+	bool deserialize(QDataStream &stream, tPayloadSize dataSize) Q_DECL_OVERRIDE;
+
+	QDebug debugOutput(QDebug dbg) const Q_DECL_OVERRIDE
+	{
+		return dbg<<frameNumber<<int(flags);
+	}
+
+	//! Quantises the values, the view direction is in alt/az coordinates without refraction
+	static State quantise(double jDay, const Vec3d& viewAltAz, double fov);
+	static double getJDay(const State& state);
+	static Vec3d getViewAltAz(const State& state);
+	static double getFov(const State& state);
+	//! Returns the difference of the states, which takes the shorter way around the azimuth
+	static State difference(const State& from, const State& to);
+	//! Applies the values of this frame to the state of the previous frame, depending on the KeyFrame flag
+	State apply(const State& previous) const;
+
+	quint32 frameNumber;
+	//! The time in ms since the epoch at which clients should show this frame
+	qint64 presentationTime;
+	quint8 flags;
+	//! Only valid with HasTimeRate
+	double timeRate;
+	//! The absolute state for key frames, the difference to the previous frame otherwise.
+	//! Only the members with their flag set are sent.
+	State values;
+};
+
 }
 
 #endif
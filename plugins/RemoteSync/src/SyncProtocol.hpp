@@ -32,7 +32,7 @@ namespace SyncProtocol
 //Important: All data should use the sized typedefs provided by Qt (i.e. qint32 instead of 4 byte int on x86)
 
 //! Should be changed with every breaking change
-const quint8 SYNC_PROTOCOL_VERSION = 2;
+const quint8 SYNC_PROTOCOL_VERSION = 6;
 const QDataStream::Version SYNC_DATASTREAM_VERSION = QDataStream::Qt_5_0;
 //! Magic value for protocol used during connection. Should NEVER change.
 const QByteArray SYNC_MAGIC_VALUE = "StellariumSyncPluginProtocol";
@@ -55,6 +55,11 @@ const qint64 SYNC_HEADER_SIZE = sizeof(quint8) + sizeof(tPayloadSize); //3 byte
 const qint64 SYNC_MAX_PAYLOAD_SIZE = (2<<15) - 1; // 65535
 const qint64 SYNC_MAX_MESSAGE_SIZE = SYNC_HEADER_SIZE + SYNC_MAX_PAYLOAD_SIZE;
 
+//! Multicast datagrams start with a quint32 sequence number, followed by one full message
+const qint64 SYNC_DATAGRAM_HEADER_SIZE = sizeof(quint32);
+//! Larger messages are sent over TCP even to multicast clients, to avoid IP fragmentation
+const qint64 SYNC_MAX_DATAGRAM_SIZE = 1400;
+
 //! Contains the possible message types. The enum value is used as an ID to identify the message type over the network.
 //! The classes handling these messages are defined in SyncMessages.hpp
 enum SyncMessageType
@@ -72,11 +77,20 @@ enum SyncMessageType
 	STELPROPERTY, //stelproperty updates
 	VIEW, //view change
 	FOV, //fov change
+	FRAME, //frame-locked time, view and fov, replaces TIME, VIEW and FOV if the server uses frame sync
+	MULTICAST, //multicast group announcement from the server, answered by the client with the join result
 
-	MSGTYPE_MAX = FOV,
+	MSGTYPE_MAX = MULTICAST,
 	MSGTYPE_SIZE = MSGTYPE_MAX+1
 };
 
+//! Returns true for the high-rate state messages, which the server sends over UDP multicast to the clients which joined the group.
+//! All of them contain absolute values, so a lost datagram is corrected by the next one.
+inline bool isMulticastMessage(SyncMessageType type)
+{
+	return type == TIME || type == VIEW || type == FOV || type == FRAME;
+}
+
 inline QDebug& operator<<(QDebug& deb, SyncMessageType msg)
 {
 	switch (msg) {
@@ -110,6 +124,12 @@ inline QDebug& operator<<(QDebug& deb, SyncMessageType msg)
 		case SyncProtocol::FOV:
 			deb<<"FOV";
 			break;
+		case SyncProtocol::FRAME:
+			deb<<"FRAME";
+			break;
+		case SyncProtocol::MULTICAST:
+			deb<<"MULTICAST";
+			break;
 		case SyncProtocol::ALIVE:
 			deb<<"ALIVE";
 			break;
@@ -185,6 +205,9 @@ public:
 	QDebug peerLog() const;
 
 	bool isAuthenticated() const { return authenticated; }
+	//! True if the client peer joined the multicast group of the server, it does not get the multicast messages over TCP then
+	bool receivesMulticast() const { return multicast; }
+	void setReceivesMulticast(bool val) { multicast = val; }
 	QUuid getID() const { return id; }
 
 	void checkTimeout();
@@ -211,6 +234,7 @@ private:
 	bool authenticated; // True if the peer ran through the HELLO process and can receive/send all message types
 	bool authResponseSent; //only for client use, tracks if the client has sent a resonse to the server challenge
 	bool waitingForBody; //True if waiting for full message body (after header was received)
+	bool multicast; //only for server use, true if the client receives the multicast messages over UDP
 	SyncProtocol::SyncHeader msgHeader; //the last message header read/currently being processed
 	qint64 lastReceiveTime; // The time the last data of this peer was received
 	qint64 lastSendTime; //The time the last data was written to this peer
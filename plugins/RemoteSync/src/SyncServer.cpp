@@ -25,6 +25,7 @@
 #include <QTcpServer>
 #include <QTcpSocket>
 #include <QTimerEvent>
+#include <QUdpSocket>
 
 
 Q_LOGGING_CATEGORY(syncServer,"stel.plugin.remoteSync.server")
@@ -32,7 +33,8 @@ Q_LOGGING_CATEGORY(syncServer,"stel.plugin.remoteSync.server")
 using namespace SyncProtocol;
 
 SyncServer::SyncServer(QObject* parent)
-	: QObject(parent), stopping(false), timeoutTimerId(-1)
+	: QObject(parent), stopping(false), frameSync(true), presentationDelay(50),
+	  multicastPort(0), multicastSocket(Q_NULLPTR), multicastSequence(0), timeoutTimerId(-1)
 {
 	qserver = new QTcpServer(this);
 	connect(qserver,SIGNAL(newConnection()), this, SLOT(handleNewConnection()));
@@ -43,6 +45,7 @@ SyncServer::SyncServer(QObject* parent)
 	handlerList[ERROR] =  new ServerErrorHandler();
 	handlerList[CLIENT_CHALLENGE_RESPONSE] = new ServerAuthHandler(this, false);
 	handlerList[ALIVE] = new ServerAliveHandler();
+	handlerList[MULTICAST] = new ServerMulticastHandler();
 }
 
 SyncServer::~SyncServer()
@@ -72,19 +75,49 @@ bool SyncServer::start(int port)
 
 		timeoutTimerId = startTimer(5000,Qt::VeryCoarseTimer);
 
+		if(!multicastGroup.isNull())
+		{
+			multicastSocket = new QUdpSocket(this);
+			multicastSequence = 0;
+			qCDebug(syncServer)<<"Using multicast group"<<multicastGroup.toString()<<"port"<<multicastPort;
+		}
+
 		//create senders
-		addSender(new TimeEventSender());
+		if(frameSync)
+			addSender(new FrameEventSender(presentationDelay));
+		else
+			addSender(new TimeEventSender());
 		addSender(new LocationEventSender());
 		addSender(new SelectionEventSender());
 		addSender(new StelPropertyEventSender());
-		addSender(new ViewEventSender());
-		addSender(new FovEventSender());
+		if(!frameSync)
+		{
+			addSender(new ViewEventSender());
+			addSender(new FovEventSender());
+		}
 	}
 	else
 		qCCritical(syncServer)<<"Error while starting:"<<qserver->errorString();
 	return ok;
 }
 
+void SyncServer::setFrameSync(bool enabled, int presentationDelay)
+{
+	frameSync = enabled;
+	this->presentationDelay = presentationDelay;
+}
+
+void SyncServer::setMulticast(const QString &group, int port)
+{
+	multicastGroup = group.isEmpty() ? QHostAddress() : QHostAddress(group);
+	if(!group.isEmpty() && !multicastGroup.isMulticast())
+	{
+		qCWarning(syncServer)<<group<<"is not a multicast address, multicast is disabled";
+		multicastGroup.clear();
+	}
+	multicastPort = static_cast<quint16>(port);
+}
+
 void SyncServer::addSender(SyncServerEventSender *snd)
 {
 	snd->server = this;
@@ -107,9 +140,25 @@ void SyncServer::broadcastMessage(const SyncMessage &msg)
 		return;
 	}
 
+	bool multicast = multicastSocket && isMulticastMessage(msg.getMessageType())
+			&& SYNC_DATAGRAM_HEADER_SIZE + size <= SYNC_MAX_DATAGRAM_SIZE;
+	if(multicast)
+	{
+		//a single datagram reaches all clients in the group, independent of their number
+		QDataStream stream(&datagramBuffer, QIODevice::WriteOnly);
+		stream.setVersion(SYNC_DATASTREAM_VERSION);
+		stream<<++multicastSequence;
+		stream.writeRawData(broadcastBuffer.constData(), static_cast<int>(size));
+		if(multicastSocket->writeDatagram(datagramBuffer.constData(), SYNC_DATAGRAM_HEADER_SIZE + size, multicastGroup, multicastPort) < 0)
+		{
+			qCWarning(syncServer)<<"Could not send multicast datagram:"<<multicastSocket->errorString();
+			multicast = false;
+		}
+	}
+
 	for (auto* client : clients)
 	{
-		if(client->isAuthenticated())
+		if(client->isAuthenticated() && !(multicast && client->receivesMulticast()))
 		{
 			client->writeData(broadcastBuffer,size);
 		}
@@ -133,6 +182,9 @@ void SyncServer::stop()
 		}
 		senderList.clear();
 
+		delete multicastSocket;
+		multicastSocket = Q_NULLPTR;
+
 		for (auto it = clients.begin(); it!=clients.end();)
 		{
 			//this may cause disconnected signal, which will remove the client
@@ -212,6 +264,15 @@ void SyncServer::handleNewConnection()
 
 void SyncServer::clientAuthenticated(SyncRemotePeer &peer)
 {
+	if(multicastSocket)
+	{
+		//the client answers if it could join, until then it gets everything over TCP
+		Multicast msg;
+		msg.group = multicastGroup.toString();
+		msg.port = multicastPort;
+		peer.writeMessage(msg);
+	}
+
 	//we have to send the client the current app state
 	for (auto* s : senderList)
 	{
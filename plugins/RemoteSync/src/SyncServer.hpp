@@ -24,10 +24,12 @@
 #include <QObject>
 #include <QAbstractSocket>
 #include <QDateTime>
+#include <QHostAddress>
 #include <QLoggingCategory>
 #include <QUuid>
 
 class QTcpServer;
+class QUdpSocket;
 class SyncServerEventSender;
 
 Q_DECLARE_LOGGING_CATEGORY(syncServer)
@@ -46,6 +48,18 @@ public:
 
 	//! Broadcasts this message to all connected and authenticated clients
 	void broadcastMessage(const SyncProtocol::SyncMessage& msg);
+
+	//! If enabled, the time, view and fov are broadcast each frame as a single SyncProtocol::Frame message,
+	//! which the clients present after presentationDelay ms. Otherwise, separate messages are sent on changes.
+	//! Takes effect on the next start().
+	void setFrameSync(bool enabled, int presentationDelay);
+	//! If a group address is set, the high-rate state messages (see SyncProtocol::isMulticastMessage) are sent
+	//! as a single UDP datagram to this multicast group instead of once per client, to all clients which could join it.
+	//! The other messages and the clients which could not join still use their TCP connection.
+	//! Takes effect on the next start().
+	void setMulticast(const QString& group, int port);
+	//! True if the server is running and sends multicast datagrams
+	bool usesMulticast() const { return multicastSocket; }
 public slots:
 	//! Starts the SyncServer on the specified port. If the server is already running, stops it first.
 	//! Returns true if successful (false usually means port was in use, use getErrorString)
@@ -78,6 +92,13 @@ private:
 	QVector<SyncServerEventSender*> senderList;
 
 	bool stopping;
+	bool frameSync;
+	int presentationDelay;
+	QHostAddress multicastGroup;
+	quint16 multicastPort;
+	QUdpSocket* multicastSocket;
+	quint32 multicastSequence;
+	QByteArray datagramBuffer;
 
 	// client list
 	typedef QVector<SyncRemotePeer*> tClientList;
@@ -27,6 +27,8 @@
 #include "StelObjectMgr.hpp"
 #include "StelPropertyMgr.hpp"
 
+#include <QDateTime>
+
 using namespace SyncProtocol;
 
 SyncServerEventSender::SyncServerEventSender()
@@ -41,6 +43,11 @@ void SyncServerEventSender::broadcastMessage(const SyncMessage &msg)
 	server->broadcastMessage(msg);
 }
 
+bool SyncServerEventSender::usesMulticast() const
+{
+	return server->usesMulticast();
+}
+
 TimeEventSender::TimeEventSender()
 {
 	//this is the only event we need to listen to
@@ -102,6 +109,7 @@ Selection SelectionEventSender::constructMessage()
 	for (const auto& obj : selObj)
 	{
 		msg.selectedObjects.append(qMakePair(obj->getType(), obj->getID()));
+		msg.selectedHandles.append(objMgr->getObjectHandle(obj));
 	}
 
 	return msg;
@@ -110,18 +118,22 @@ Selection SelectionEventSender::constructMessage()
 StelPropertyEventSender::StelPropertyEventSender()
 {
 	propMgr = StelApp::getInstance().getStelPropertyManager();
-	connect(propMgr, SIGNAL(stelPropertyChanged(StelProperty*,QVariant)), this, SLOT(sendStelPropChange(StelProperty*,QVariant)));
+	connect(propMgr, SIGNAL(stelPropertiesChanged(QVariantMap)), this, SLOT(sendStelPropChanges(QVariantMap)));
 }
 
-void StelPropertyEventSender::sendStelPropChange(StelProperty* prop, const QVariant &val)
+void StelPropertyEventSender::sendStelPropChanges(const QVariantMap &changes)
 {
-	//only send changes that can be applied on clients
-	if(prop->isSynchronizable())
+	for (auto it = changes.constBegin(); it != changes.constEnd(); ++it)
 	{
-		StelPropertyUpdate msg;
-		msg.propId = prop->getId();
-		msg.value = val;
-		broadcastMessage(msg);
+		//only send changes that can be applied on clients
+		const StelProperty* prop = propMgr->getPropertyMap().value(it.key());
+		if(prop && prop->isSynchronizable())
+		{
+			StelPropertyUpdate msg;
+			msg.propId = it.key();
+			msg.value = it.value();
+			broadcastMessage(msg);
+		}
 	}
 }
 
@@ -193,3 +205,79 @@ void FovEventSender::update()
 		broadcastMessage(constructMessage());
 	}
 }
+
+FrameEventSender::FrameEventSender(int presentationDelay)
+	: presentationDelay(presentationDelay), frameNumber(0)
+{
+	mvMgr = core->getMovementMgr();
+	lastPresentationTime = QDateTime::currentMSecsSinceEpoch() + presentationDelay;
+	lastState = currentState();
+	lastTimeRate = core->getTimeRate();
+}
+
+Frame::State FrameEventSender::currentState() const
+{
+	//the time rate is in days per second
+	double jDay = core->getJD() + core->getTimeRate() * presentationDelay / 1000.0;
+	Vec3d viewAltAz = core->j2000ToAltAz(mvMgr->getViewDirectionJ2000(), StelCore::RefractionOff);
+	return Frame::quantise(jDay, viewAltAz, mvMgr->getCurrentFov());
+}
+
+void FrameEventSender::update()
+{
+	Frame msg;
+	msg.frameNumber = ++frameNumber;
+	msg.presentationTime = QDateTime::currentMSecsSinceEpoch() + presentationDelay;
+
+	Frame::State state = currentState();
+	//do not send view updates when tracking, like the ViewEventSender
+	if(mvMgr->getFlagTracking())
+	{
+		state.azimuth = lastState.azimuth;
+		state.altitude = lastState.altitude;
+	}
+
+	if(usesMulticast())
+	{
+		//datagrams may be lost, so each frame has to be complete
+		msg.flags = Frame::KeyFrame | Frame::HasTimeRate | Frame::HasTime | Frame::HasView | Frame::HasFov;
+		msg.timeRate = core->getTimeRate();
+		msg.values = state;
+		broadcastMessage(msg);
+		lastState = state;
+		lastTimeRate = msg.timeRate;
+		lastPresentationTime = msg.presentationTime;
+		return;
+	}
+
+	msg.values = Frame::difference(lastState, state);
+	if(msg.values.time)
+		msg.flags |= Frame::HasTime;
+	if(msg.values.azimuth || msg.values.altitude)
+		msg.flags |= Frame::HasView;
+	if(msg.values.logFov)
+		msg.flags |= Frame::HasFov;
+	double timeRate = core->getTimeRate();
+	if(timeRate != lastTimeRate)
+	{
+		msg.flags |= Frame::HasTimeRate | Frame::HasTime;
+		msg.timeRate = timeRate;
+	}
+
+	//frames without changes are sent too, they keep the frame numbers and presentation times of the clients in step
+	broadcastMessage(msg);
+	lastState = state;
+	lastTimeRate = timeRate;
+	lastPresentationTime = msg.presentationTime;
+}
+
+void FrameEventSender::newClientConnected(SyncRemotePeer &client)
+{
+	Frame msg;
+	msg.frameNumber = frameNumber;
+	msg.presentationTime = lastPresentationTime;
+	msg.flags = Frame::KeyFrame | Frame::HasTimeRate | Frame::HasTime | Frame::HasView | Frame::HasFov;
+	msg.timeRate = lastTimeRate;
+	msg.values = lastState;
+	client.writeMessage(msg);
+}
@@ -55,6 +55,8 @@ protected:
 
 	//! Subclasses can call this to broadcast a message to all valid connected clients
 	void broadcastMessage(const SyncProtocol::SyncMessage& msg);
+	//! True if the multicast messages may be lost, see SyncServer::setMulticast
+	bool usesMulticast() const;
 	//! Free to use by sublasses. Recommendation: use to track if update() should broadcast a message.
 	bool isDirty;
 	//! Direct access to StelCore
@@ -138,7 +140,8 @@ public:
 protected slots:
 	//! Sends all current StelProperties to the client
 	virtual void newClientConnected(SyncRemotePeer& client) Q_DECL_OVERRIDE;
-	void sendStelPropChange(StelProperty* prop, const QVariant& val);
+	//! Sends the changes of the frame, a single message per property
+	void sendStelPropChanges(const QVariantMap& changes);
 private:
 	StelPropertyMgr* propMgr;
 };
@@ -172,4 +175,30 @@ private:
 	double lastFov;
 };
 
+//! Broadcasts the time, view and fov as a single Frame message each frame. Used instead of the
+//! Time, View and Fov senders if the server uses frame sync, so that all clients show the same frame at the same time.
+class FrameEventSender : public SyncServerEventSender
+{
+	Q_OBJECT
+public:
+	//! @param presentationDelay the time in ms between a server frame and its presentation on the clients.
+	//! It should be larger than the network latency.
+	FrameEventSender(int presentationDelay);
+protected slots:
+	//! Sends a key frame with the last broadcast state, the following frames are differences to it
+	virtual void newClientConnected(SyncRemotePeer& client) Q_DECL_OVERRIDE;
+protected:
+	void update() Q_DECL_OVERRIDE;
+private:
+	//! Quantises the current state, with the time extrapolated to the presentation time
+	SyncProtocol::Frame::State currentState() const;
+
+	StelMovementMgr* mvMgr;
+	int presentationDelay;
+	quint32 frameNumber;
+	qint64 lastPresentationTime;
+	SyncProtocol::Frame::State lastState;
+	double lastTimeRate;
+};
+
 #endif
@@ -20,6 +20,8 @@
 #include "SyncServerHandlers.hpp"
 #include "SyncServer.hpp"
 
+#include <QDateTime>
+
 using namespace SyncProtocol;
 
 ServerHandler::ServerHandler(SyncServer *server)
@@ -102,6 +104,29 @@ bool ServerAuthHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloa
 
 bool ServerAliveHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
 {
+	const qint64 receiveTime = QDateTime::currentMSecsSinceEpoch();
 	Alive p;
-	return p.deserialize(stream,dataSize);
+	if(!p.deserialize(stream,dataSize))
+		return false;
+
+	if(p.isClockRequest())
+	{
+		Alive reply;
+		reply.originTime = p.originTime;
+		reply.receiveTime = receiveTime;
+		reply.transmitTime = QDateTime::currentMSecsSinceEpoch();
+		peer.writeMessage(reply);
+	}
+	return true;
+}
+
+bool ServerMulticastHandler::handleMessage(QDataStream &stream, SyncProtocol::tPayloadSize dataSize, SyncRemotePeer &peer)
+{
+	Multicast msg;
+	bool ok = msg.deserialize(stream, dataSize);
+	if(!ok) return false;
+
+	peer.peerLog(msg.joined ? "Client receives multicast" : "Client could not join multicast group, using TCP");
+	peer.setReceivesMulticast(msg.joined);
+	return true;
 }
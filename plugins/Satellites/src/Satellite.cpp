@@ -30,6 +30,7 @@
 #include "VecMath.hpp"
 #include "StelUtils.hpp"
 #include "StelTranslator.hpp"
+#include "StelProjector.hpp"
 
 #include <QTextStream>
 #include <QRegExp>
@@ -40,11 +41,14 @@
 
 #include <QVector3D>
 #include <QMatrix4x4>
+#include <QOpenGLShaderProgram>
+#include <QDataStream>
 
 #include "gsatellite/gTime.hpp"
 #include "gsatellite/stdsat.h"
 
 #include <cmath>
+#include <cstddef>
 
 #define sqr(a) ((a)*(a))
 
@@ -60,7 +64,10 @@ int Satellite::orbitLineSegments = 90;
 int Satellite::orbitLineFadeSegments = 4;
 int Satellite::orbitLineSegmentDuration = 20;
 bool Satellite::orbitLinesFlag = true;
+bool Satellite::orbitLineBuffersFlag = true;
+QHash<QByteArray, QOpenGLShaderProgram*> Satellite::orbitPrograms;
 bool Satellite::realisticModeFlag = false;
+bool Satellite::magnitudeCurvesFlag = true;
 bool Satellite::hideInvisibleSatellitesFlag = false;
 Vec3f Satellite::invisibleSatelliteColor = Vec3f(0.2f,0.2f,0.2f);
 
@@ -92,7 +99,22 @@ Satellite::Satellite(const QString& identifier, const QVariantMap& map)
 	, phaseAngle(0.)
 	, lastEpochCompForOrbit(0.)
 	, epochTime(0.)
+	, lastPropagationJD(0.)
+	, nextPropagationJD(0.)
+	, sleeping(false)
+	, sampleError(0)
+	, magnitudeCurveStart(0)
+	, orbitCapacity(0)
+	, orbitStart(0)
+	, orbitBuffer(QOpenGLBuffer::VertexBuffer)
+	, orbitBufferDirty(false)
 {
+	currentMagnitude.visibility = gSatWrapper::UNKNOWN;
+	currentMagnitude.phaseAngle = 0.;
+	currentMagnitude.sunReflAngle = -1.;
+	currentMagnitude.flareMagnitude = 100.;
+	currentMagnitude.rangeTerm = 0.;
+
 	// return initialized if the mandatory fields are not present
 	if (identifier.isEmpty())
 		return;
@@ -238,6 +260,72 @@ QVariantMap Satellite::getMap(void)
 	return map;
 }
 
+void Satellite::writeCatalogData(QDataStream& out) const
+{
+	out << id << name << description << tleElements.first << tleElements.second;
+	out << stdMag << (qint32)status << displayed << orbitDisplayed << userDefined;
+	out << hintColor[0] << hintColor[1] << hintColor[2];
+	out << orbitColor[0] << orbitColor[1] << orbitColor[2];
+	out << (quint32)comms.size();
+	for (const auto& c : comms)
+		out << c.frequency << c.modulation << c.description;
+	out << QStringList(groups.toList()) << lastUpdated;
+}
+
+Satellite* Satellite::readCatalogData(QDataStream& in)
+{
+	QString satId, satName, satDescription;
+	QByteArray tle1, tle2;
+	double satStdMag;
+	qint32 satStatus;
+	bool satDisplayed, satOrbitDisplayed, satUserDefined;
+	Vec3f satHintColor, satOrbitColor;
+	quint32 commCount;
+	in >> satId >> satName >> satDescription >> tle1 >> tle2;
+	in >> satStdMag >> satStatus >> satDisplayed >> satOrbitDisplayed >> satUserDefined;
+	in >> satHintColor[0] >> satHintColor[1] >> satHintColor[2];
+	in >> satOrbitColor[0] >> satOrbitColor[1] >> satOrbitColor[2];
+	in >> commCount;
+	if (in.status()!=QDataStream::Ok)
+		return Q_NULLPTR;
+	QList<CommLink> satComms;
+	for (quint32 i=0; i<commCount && in.status()==QDataStream::Ok; ++i)
+	{
+		CommLink c;
+		in >> c.frequency >> c.modulation >> c.description;
+		satComms.append(c);
+	}
+	QStringList satGroups;
+	QDateTime satLastUpdated;
+	in >> satGroups >> satLastUpdated;
+	if (in.status()!=QDataStream::Ok)
+		return Q_NULLPTR;
+
+	// The constructor validates the TLE set, the other fields are copied as they are
+	QVariantMap map;
+	map["name"] = satName;
+	map["tle1"] = QString(tle1);
+	map["tle2"] = QString(tle2);
+	Satellite* sat = new Satellite(satId, map);
+	if (!sat->initialized)
+	{
+		delete sat;
+		return Q_NULLPTR;
+	}
+	sat->description = satDescription;
+	sat->stdMag = satStdMag;
+	sat->status = satStatus;
+	sat->displayed = satDisplayed;
+	sat->orbitDisplayed = satOrbitDisplayed;
+	sat->userDefined = satUserDefined;
+	sat->hintColor = satHintColor;
+	sat->orbitColor = satOrbitColor;
+	sat->comms = satComms;
+	sat->groups = GroupSet::fromList(satGroups);
+	sat->lastUpdated = satLastUpdated;
+	return sat;
+}
+
 float Satellite::getSelectPriority(const StelCore*) const
 {
 	return -10.;
@@ -534,173 +622,167 @@ float Satellite::getVMagnitude(const StelCore* core) const
 		// OK, artificial satellite has value for standard magnitude
 		if (visibility==gSatWrapper::VISIBLE)
 		{
-			// Calculation of approx. visual magnitude for artificial satellites
-			// described here: http://www.prismnet.com/~mmccants/tles/mccdesc.html
-			double fracil = calculateIlluminatedFraction();
-			if (fracil==0)
-				fracil = 0.000001;
-			if (pSatWrapper && name.startsWith("IRIDIUM"))
-			{
+			// The model was evaluated by updateVisibility()
+			sunReflAngle = currentMagnitude.sunReflAngle;
+			vmag = qMin(stdMag, currentMagnitude.flareMagnitude) + currentMagnitude.rangeTerm;
+		}
+	}
+	return vmag;
+}
+
+Satellite::MagnitudeSample Satellite::computeMagnitudeSample(const Vec3d& pos, const Vec3d& vel, double dt) const
+{
+	MagnitudeSample sample;
+	const Vec3d observerECIPos = gSatWrapper::getObserverECIPos(dt);
+	Vec3d altAz = gSatWrapper::toTopocentric(pos - observerECIPos, dt);
+	const double sampleRange = altAz.length();
+	altAz.normalize();
+	const Vec3d Sun3d = gSatWrapper::getSunECIPos();
+	sample.visibility = gSatWrapper::computeVisibility(pos, altAz);
+	sample.phaseAngle = Sun3d.angle(pos);
+	sample.sunReflAngle = -1.;
+	sample.flareMagnitude = 100.;
+	sample.rangeTerm = 0.;
+	if (stdMag==99. || sample.visibility!=gSatWrapper::VISIBLE)
+		return sample;
+
+	// Calculation of approx. visual magnitude for artificial satellites
+	// described here: http://www.prismnet.com/~mmccants/tles/mccdesc.html
+	double fracil = (1. + cos(sample.phaseAngle))*0.5;
+	if (fracil==0)
+		fracil = 0.000001;
+	if (name.startsWith("IRIDIUM"))
+	{
 #ifdef IRIDIUM_SAT_TEXT_DEBUG
-				myText = "";
+		myText = "";
 #endif
-				Vec3d Sun3d = pSatWrapper->getSunECIPos();
-				QVector3D sun(Sun3d.data()[0],Sun3d.data()[1],Sun3d.data()[2]);
-				QVector3D sunN = sun; sunN.normalize();
+		QVector3D sun(Sun3d.data()[0],Sun3d.data()[1],Sun3d.data()[2]);
+		QVector3D sunN = sun; sunN.normalize();
 
 #ifdef IRIDIUM_SAT_TEXT_DEBUG
-				myText += "Sun3d = " + QString("[%1 %2 %3]")
-						.arg(sunN.x())
-						.arg(sunN.y())
-						.arg(sunN.z())
-						+ "<br>\n";
+		myText += "Sun3d = " + QString("[%1 %2 %3]")
+				.arg(sunN.x())
+				.arg(sunN.y())
+				.arg(sunN.z())
+				+ "<br>\n";
 #endif
-				//static double sin1 = sin(40*M_PI/180);
-				//static double cos1 = cos(40*M_PI/180);
-				//static double sin2 = sin(120*M_PI/180);
-				//static double cos2 = cos(120*M_PI/180);
-				// position, velocity are known
-				QVector3D Vx(velocity.data()[0],velocity.data()[1],velocity.data()[2]); Vx.normalize();
+		// position, velocity are known
+		QVector3D Vx(vel.data()[0],vel.data()[1],vel.data()[2]); Vx.normalize();
 
 #ifdef IRIDIUM_SAT_TEXT_DEBUG
-				myText += "Vx = " + QString("[%1 %2 %3]")
-						.arg(Vx.x())
-						.arg(Vx.y())
-						.arg(Vx.z())
-						+ "<br>\n";
+		myText += "Vx = " + QString("[%1 %2 %3]")
+				.arg(Vx.x())
+				.arg(Vx.y())
+				.arg(Vx.z())
+				+ "<br>\n";
 #endif
-				//QVector3D SatPos(position.data()[0],position.data()[1],position.data()[2]);
-				Vec3d vy = (position^velocity);
-				QVector3D Vy(vy.data()[0],vy.data()[1],vy.data()[2]); Vy.normalize();
+		Vec3d vy = (pos^vel);
+		QVector3D Vy(vy.data()[0],vy.data()[1],vy.data()[2]); Vy.normalize();
 
 #ifdef IRIDIUM_SAT_TEXT_DEBUG
-				myText += "Vy = " + QString("[%1 %2 %3]")
-						.arg(Vy.x())
-						.arg(Vy.y())
-						.arg(Vy.z())
-						+ "<br>\n";
+		myText += "Vy = " + QString("[%1 %2 %3]")
+				.arg(Vy.x())
+				.arg(Vy.y())
+				.arg(Vy.z())
+				+ "<br>\n";
 #endif
-				QVector3D Vz = QVector3D::crossProduct(Vx,Vy); Vz.normalize();
+		QVector3D Vz = QVector3D::crossProduct(Vx,Vy); Vz.normalize();
 
 #ifdef IRIDIUM_SAT_TEXT_DEBUG
-				myText += "Vz = " + QString("[%1 %2 %3]")
-						.arg(Vz.x())
-						.arg(Vz.y())
-						.arg(Vz.z())
-						+ "<br>\n";
+		myText += "Vz = " + QString("[%1 %2 %3]")
+				.arg(Vz.x())
+				.arg(Vz.y())
+				.arg(Vz.z())
+				+ "<br>\n";
 #endif
 
-				// move this to constructor for optimizing
-				QMatrix4x4 m0;
-				m0.rotate(40, Vy);
-				QVector3D Vx0 = m0.mapVector(Vx);
+		// move this to constructor for optimizing
+		QMatrix4x4 m0;
+		m0.rotate(40, Vy);
+		QVector3D Vx0 = m0.mapVector(Vx);
 #ifdef IRIDIUM_SAT_TEXT_DEBUG
-				myText += "mirror0 = " + QString("[%1 %2 %3]")
-						.arg(Vx0.x())
-						.arg(Vx0.y())
-						.arg(Vx0.z())
-						+ "<br>\n";
+		myText += "mirror0 = " + QString("[%1 %2 %3]")
+				.arg(Vx0.x())
+				.arg(Vx0.y())
+				.arg(Vx0.z())
+				+ "<br>\n";
 #endif
 
-				QMatrix4x4 m[3];
-				//m[2] = m[1] = m[0];
-				m[0].rotate(0, Vz);
-				m[1].rotate(120, Vz);
-				m[2].rotate(-120, Vz);
-
-				StelLocation loc   = StelApp::getInstance().getCore()->getCurrentLocation();
-				const double  radLatitude    = loc.latitude * KDEG2RAD;
-				const double  theta          = pSatWrapper->getEpoch().toThetaLMST(loc.longitude * KDEG2RAD);
-				const double sinRadLatitude=sin(radLatitude);
-				const double cosRadLatitude=cos(radLatitude);
-				const double sinTheta=sin(theta);
-				const double cosTheta=cos(theta);
-
-				Vec3d observerECIPos;
-				Vec3d observerECIVel;
-				pSatWrapper->calcObserverECIPosition(observerECIPos, observerECIVel);
+		QMatrix4x4 m[3];
+		m[0].rotate(0, Vz);
+		m[1].rotate(120, Vz);
+		m[2].rotate(-120, Vz);
+
 #ifdef IRIDIUM_SAT_TEXT_DEBUG
-				myText += "ObsPos = " + observerECIPos.toString() + " (" + observerECIPos.toStringLonLat() + ")<br>\n";
-				myText += "ObsVel = " + observerECIVel.toString() + " (" + observerECIVel.toStringLonLat() + ")<br>\n";
+		myText += "ObsPos = " + observerECIPos.toString() + " (" + observerECIPos.toStringLonLat() + ")<br>\n";
 #endif
-				sunReflAngle = 180.;
-				QVector3D mirror;
-				for (int i = 0; i<3; i++)
-				{
-					mirror = m[i].mapVector(Vx0);
-					mirror.normalize();
+		double reflAngle = 180.;
+		QVector3D mirror;
+		for (int i = 0; i<3; i++)
+		{
+			mirror = m[i].mapVector(Vx0);
+			mirror.normalize();
 #ifdef IRIDIUM_SAT_TEXT_DEBUG
-					myText += "mirror = " + QString("[%1 %2 %3]")
-							.arg(mirror.x())
-							.arg(mirror.y())
-							.arg(mirror.z())
-							+ "<br>\n";
+			myText += "mirror = " + QString("[%1 %2 %3]")
+					.arg(mirror.x())
+					.arg(mirror.y())
+					.arg(mirror.z())
+					+ "<br>\n";
 #endif
-					// reflection R = 2*(V dot N)*N - V
-					QVector3D rsun =  2*QVector3D::dotProduct(sun,mirror)*mirror - sun;
-					rsun = -rsun;
-					Vec3d rSun(rsun.x(),rsun.y(),rsun.z());
+			// reflection R = 2*(V dot N)*N - V
+			QVector3D rsun =  2*QVector3D::dotProduct(sun,mirror)*mirror - sun;
+			rsun = -rsun;
+			Vec3d rSun(rsun.x(),rsun.y(),rsun.z());
 #ifdef IRIDIUM_SAT_TEXT_DEBUG
-					myText += "rSun = " + rSun.toString() + "<br>\n";
+			myText += "rSun = " + rSun.toString() + "<br>\n";
 #endif
-
-					//Vec3d satECIPos  = getTEMEPos();
-					Vec3d slantRange = rSun - observerECIPos;
-					Vec3d topoRSunPos;
-					//top_s
-					topoRSunPos[0] = (sinRadLatitude * cosTheta * slantRange[0]
-							+ sinRadLatitude * sinTheta * slantRange[1]
-							- cosRadLatitude * slantRange[2]);
-					//top_e
-					topoRSunPos[1] = ((-1.0) * sinTheta * slantRange[0]
-							+ cosTheta * slantRange[1]);
-
-					//top_z
-					topoRSunPos[2] = (cosRadLatitude * cosTheta * slantRange[0]
-							+ cosRadLatitude * sinTheta * slantRange[1]
-							+ sinRadLatitude * slantRange[2]);
+			const Vec3d topoRSunPos = gSatWrapper::toTopocentric(rSun - observerECIPos, dt);
 #ifdef IRIDIUM_SAT_TEXT_DEBUG
-					myText += "SunRefl = " + topoRSunPos.toString() + " (" + topoRSunPos.toStringLonLat() + ")<br>\n";
+			myText += "SunRefl = " + topoRSunPos.toString() + " (" + topoRSunPos.toStringLonLat() + ")<br>\n";
 #endif
-					sunReflAngle = qMin(elAzPosition.angle(topoRSunPos) * KRAD2DEG, sunReflAngle) ;
+			reflAngle = qMin(altAz.angle(topoRSunPos) * KRAD2DEG, reflAngle) ;
 #ifdef IRIDIUM_SAT_TEXT_DEBUG
-					myText += QString("Angle = %1").arg(QString::number(sunReflAngle, 'f', 1)) + "<br>";
+			myText += QString("Angle = %1").arg(QString::number(reflAngle, 'f', 1)) + "<br>";
 #endif
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-
-				}
-
-				// very simple flare model
-				double iridiumFlare = 100;
-				if (sunReflAngle<0.5)
-				{
-					iridiumFlare = -8.92 + sunReflAngle*6;
-				}
-				else
-				if (sunReflAngle<0.7)
-				{
-					iridiumFlare = -5.92 + (sunReflAngle-0.5)*10;
-				}
-					else
-				{
-					iridiumFlare = -3.92 + (sunReflAngle-0.7)*5;
-				}
+		}
+		sample.sunReflAngle = reflAngle;
 
+		// very simple flare model
+		if (reflAngle<0.5)
+			sample.flareMagnitude = -8.92 + reflAngle*6;
+		else if (reflAngle<0.7)
+			sample.flareMagnitude = -5.92 + (reflAngle-0.5)*10;
+		else
+			sample.flareMagnitude = -3.92 + (reflAngle-0.7)*5;
+	}
 
-				 vmag = qMin(stdMag, iridiumFlare);
-			}
-			else // not Iridium
-			{
-				sunReflAngle = -1;
-				vmag = stdMag;
-			}
+	sample.rangeTerm = -15.75 + 2.5 * std::log10(sampleRange * sampleRange / fracil);
+	return sample;
+}
 
-			vmag = vmag - 15.75 + 2.5 * std::log10(range * range / fracil);
+Satellite::MagnitudeSample Satellite::getMagnitudeSample(qint64 index, double step)
+{
+	const qint64 size = magnitudeCurve.size();
+	if (index>=magnitudeCurveStart && index<magnitudeCurveStart+size)
+		return magnitudeCurve.at(static_cast<int>(index-magnitudeCurveStart));
 
-		}
+	// The curve covers consecutive dates of the time grid
+	static const int MAX_MAGNITUDE_SAMPLES = 1024;
+	if (size==0 || index<magnitudeCurveStart-1 || index>magnitudeCurveStart+size || size>=MAX_MAGNITUDE_SAMPLES)
+	{
+		magnitudeCurve.clear();
+		magnitudeCurveStart = index;
 	}
-	return vmag;
+	const double dt = index*step - epochTime*KSEC_PER_DAY;
+	const MagnitudeSample sample = computeMagnitudeSample(position + velocity*dt, velocity, dt);
+	if (index<magnitudeCurveStart)
+	{
+		magnitudeCurve.prepend(sample);
+		magnitudeCurveStart = index;
+	}
+	else
+		magnitudeCurve.append(sample);
+	return sample;
 }
 
 // Calculate illumination fraction of artifical satellite
@@ -763,8 +845,8 @@ void Satellite::setNewTleElements(const QString& tle1, const QString& tle2)
 	tleElements.second.append(tle2);
 
 	pSatWrapper = new gSatWrapper(id, tle1, tle2);
-	orbitPoints.clear();
-	visibilityPoints.clear();
+	resetPropagationSchedule();
+	orbitCapacity = 0;
 	
 	parseInternationalDesignator(tle1);
 }
@@ -777,34 +859,133 @@ void Satellite::update(double)
 		epochTime = core->getJD(); // + timeShift; // We have "true" JD (UTC) from core, satellites don't need JDE!
 
 		pSatWrapper->setEpoch(epochTime);
-		position                 = pSatWrapper->getTEMEPos();
-		velocity                 = pSatWrapper->getTEMEVel();
-		latLongSubPointPosition  = pSatWrapper->getSubPoint();
-		height                   = latLongSubPointPosition[2]; // km
-		if (height <= 150.0)
+		if (!updatePosition())
+			return;
+		updateVisibility();
+
+		// Compute orbit points to draw orbit line.
+		if (orbitDisplayed) computeOrbitPoints();
+	}
+}
+
+void Satellite::propagate(const SphericalCap& viewportCap, bool forceExtras, const gSatNearEarthBatch* batch, int batchIndex)
+{
+	if (!pSatWrapper || !orbitValid)
+		return;
+	epochTime = gSatWrapper::getEpoch().getGmtTm();
+	if (batch)
+		pSatWrapper->setPropagatedState(batch->getPos(batchIndex), batch->getVel(batchIndex), batch->getError(batchIndex));
+	else
+		pSatWrapper->propagate();
+	lastPropagationJD = epochTime;
+	sampleTEMEPos = pSatWrapper->getTEMEPos();
+	sampleTEMEVel = pSatWrapper->getTEMEVel();
+	sampleError = pSatWrapper->getErrorCode();
+	updateState(viewportCap, forceExtras);
+}
+
+void Satellite::extrapolate(const SphericalCap& viewportCap)
+{
+	if (!pSatWrapper || !orbitValid)
+		return;
+	epochTime = gSatWrapper::getEpoch().getGmtTm();
+	const double dt = (epochTime - lastPropagationJD)*KSEC_PER_DAY; // TEME velocity is in km/s
+	pSatWrapper->setPropagatedState(sampleTEMEPos + sampleTEMEVel*dt, sampleTEMEVel, sampleError);
+	updateState(viewportCap, false);
+}
+
+void Satellite::updateState(const SphericalCap& viewportCap, bool forceExtras)
+{
+	if (!updatePosition())
+		return;
+	if (forceExtras || (elAzPosition[2]>0. && viewportCap.contains(elAzPosition)))
+		updateVisibility();
+	else if (elAzPosition[2]<=0.)
+	{
+		visibility = gSatWrapper::NOT_VISIBLE;
+		magnitudeCurve.clear(); // end of the pass
+	}
+}
+
+void Satellite::scheduleNextPropagation(bool fullRate, double reducedInterval)
+{
+	// By default, the satellite is due again at the next update
+	sleeping = false;
+	nextPropagationJD = lastPropagationJD;
+	if (!pSatWrapper || !orbitValid)
+		return;
+
+	if (elAzPosition[2]<0.)
+	{
+		static const double HORIZON_MARGIN = 2.*KDEG2RAD;
+		const double delay = gSatWrapper::getMinimumRiseDelay(*pSatWrapper->getSatrec(), gSatWrapper::getObserverECIPos(), position, HORIZON_MARGIN);
+		if (delay>0.)
 		{
-			// The orbit is no longer valid.  Causes include very out of date
-			// TLE, system date and time out of a reasonable range, and orbital
-			// degradation and re-entry of a satellite.  In any of these cases
-			// we might end up with a problem - usually a crash of Stellarium
-			// because of a div/0 or something.  To prevent this, we turn off
-			// the satellite when the computed height is 150km. (We can assume bogus at 250km or so...)
-			qWarning() << "Satellite has invalid orbit:" << name << id;
-			orbitValid = false;
-			displayed = false; // It shouldn't be displayed!
+			nextPropagationJD = lastPropagationJD + delay/KSEC_PER_DAY;
+			sleeping = true;
 			return;
 		}
+	}
+
+	if (!fullRate)
+		nextPropagationJD = lastPropagationJD + reducedInterval/KSEC_PER_DAY;
+}
 
-		elAzPosition = pSatWrapper->getAltAz();
-		elAzPosition.normalize();
+bool Satellite::updatePosition()
+{
+	position                 = pSatWrapper->getTEMEPos();
+	velocity                 = pSatWrapper->getTEMEVel();
+	latLongSubPointPosition  = pSatWrapper->getSubPoint();
+	height                   = latLongSubPointPosition[2]; // km
+	if (height <= 150.0)
+	{
+		// The orbit is no longer valid.  Causes include very out of date
+		// TLE, system date and time out of a reasonable range, and orbital
+		// degradation and re-entry of a satellite.  In any of these cases
+		// we might end up with a problem - usually a crash of Stellarium
+		// because of a div/0 or something.  To prevent this, we turn off
+		// the satellite when the computed height is 150km. (We can assume bogus at 250km or so...)
+		qWarning() << "Satellite has invalid orbit:" << name << id;
+		orbitValid = false;
+		displayed = false; // It shouldn't be displayed!
+		return false;
+	}
 
-		pSatWrapper->getSlantRange(range, rangeRate);
-		visibility = pSatWrapper->getVisibilityPredict();
-		phaseAngle = pSatWrapper->getPhaseAngle();
+	elAzPosition = pSatWrapper->getAltAz();
+	pSatWrapper->getSlantRange(range, rangeRate);
+	elAzPosition.normalize();
+	return true;
+}
 
-		// Compute orbit points to draw orbit line.
-		if (orbitDisplayed) computeOrbitPoints();
+void Satellite::updateVisibility()
+{
+	if (!magnitudeCurvesFlag)
+		currentMagnitude = computeMagnitudeSample(position, velocity, 0.);
+	else
+	{
+		// Flares of Iridium satellites last a few seconds
+		const double step = name.startsWith("IRIDIUM") ? 1. : 10.;
+		const double t = epochTime*KSEC_PER_DAY/step;
+		const qint64 index = static_cast<qint64>(std::floor(t));
+		const double f = t - index;
+		const MagnitudeSample a = getMagnitudeSample(index, step);
+		const MagnitudeSample b = getMagnitudeSample(index+1, step);
+		if (a.visibility!=b.visibility)
+		{
+			// The satellite enters or leaves the shadow of the Earth, or rises, between the samples
+			currentMagnitude = computeMagnitudeSample(position, velocity, 0.);
+		}
+		else
+		{
+			currentMagnitude.visibility = a.visibility;
+			currentMagnitude.phaseAngle = a.phaseAngle + f*(b.phaseAngle-a.phaseAngle);
+			currentMagnitude.sunReflAngle = a.sunReflAngle<0. ? -1. : a.sunReflAngle + f*(b.sunReflAngle-a.sunReflAngle);
+			currentMagnitude.flareMagnitude = a.flareMagnitude + f*(b.flareMagnitude-a.flareMagnitude);
+			currentMagnitude.rangeTerm = a.rangeTerm + f*(b.rangeTerm-a.rangeTerm);
+		}
 	}
+	visibility = currentMagnitude.visibility;
+	phaseAngle = currentMagnitude.phaseAngle;
 }
 
 double Satellite::getDoppler(double freq) const
@@ -817,8 +998,7 @@ double Satellite::getDoppler(double freq) const
 
 void Satellite::recalculateOrbitLines(void)
 {
-	orbitPoints.clear();
-	visibilityPoints.clear();
+	orbitCapacity = 0;
 }
 
 SatFlags Satellite::getFlags() const
@@ -916,14 +1096,13 @@ void Satellite::draw(StelCore* core, StelPainter& painter)
 			//StelProjectorP origP = painter.getProjector(); // Save projector state
 			//painter.setProjector(prj);
 
-			// Draw the satellite
-			sd->preDrawPointSource(&painter);
+			// Draw the satellite. Satellites::draw() brackets all satellites with
+			// preDrawPointSource() and postDrawPointSource(), to draw them at once.
 			if (mag <= sd->getLimitMagnitude())
 			{
 				sd->computeRCMag(mag, &rcMag);
 				sd->drawPointSource(&painter, Vec3f(XYZ[0],XYZ[1],XYZ[2]), rcMag, color, true);
 			}
-			sd->postDrawPointSource(&painter);
 
 			float txtMag = mag;
 			if (visibility != gSatWrapper::VISIBLE)
@@ -936,7 +1115,7 @@ void Satellite::draw(StelCore* core, StelPainter& painter)
 
 			// Draw the label of the satellite when it enabled
 			if (txtMag <= sd->getLimitMagnitude() && showLabels)
-				painter.drawText(XYZ, name, 0, 10, 10, false);
+				painter.drawText(win[0], win[1], name, 0, 10, 10, false);
 
 		}
 		else
@@ -951,12 +1130,12 @@ void Satellite::draw(StelCore* core, StelPainter& painter)
 				painter.setColor(drawColor[0], drawColor[1], drawColor[2], hintBrightness);
 
 				if (showLabels)
-					painter.drawText(XYZ, name, 0, 10, 10, false);
+					painter.drawText(win[0], win[1], name, 0, 10, 10, false);
 
 				painter.setBlending(true, GL_ONE, GL_ONE);
 
 				hintTexture->bind();
-				painter.drawSprite2dMode(XYZ, 11);
+				painter.drawSprite2dMode(win[0], win[1], 11);
 			}
 		}
 	}
@@ -968,34 +1147,164 @@ void Satellite::draw(StelCore* core, StelPainter& painter)
 
 void Satellite::drawOrbit(StelCore *core, StelPainter& painter)
 {
+	if (orbitCapacity<2)
+		return;
+	if (orbitLineBuffersFlag && drawOrbitBuffer(core, painter))
+		return;
+
 	Vec3d position, onscreen;
 	Vec3f drawColor;
-	int size = orbitPoints.size();
+	StelProjectorP prj = painter.getProjector();
 
 	QVector<Vec3d> vertexArray;
 	QVector<Vec4f> colorArray;
-	StelProjectorP prj = painter.getProjector();
-
-	vertexArray.resize(size);
-	colorArray.resize(size);
+	vertexArray.reserve(orbitCapacity);
+	colorArray.reserve(orbitCapacity);
 
 	//Rest of points
-	for (int i=1; i<size; i++)
+	for (int i=1; i<orbitCapacity; i++)
 	{
-		position = core->altAzToJ2000(orbitPoints[i].toVec3d());
+		const OrbitVertex& v = orbitVertices[orbitStart+i];
+		position = core->altAzToJ2000(v.altAz.toVec3d());
 		position.normalize();
 
 		if (prj->project(position, onscreen)) // check position on the screen
 		{
 			vertexArray.append(position);
-			drawColor = (visibilityPoints[i] == gSatWrapper::VISIBLE) ? orbitColor : invisibleSatelliteColor;
+			drawColor = (v.visible>0.f) ? orbitColor : invisibleSatelliteColor;
 			colorArray.append(Vec4f(drawColor[0], drawColor[1], drawColor[2], hintBrightness * calculateOrbitSegmentIntensity(i)));
 		}
 	}
-	painter.drawPath(vertexArray, colorArray); // (does client state switching as needed internally)
+	if (vertexArray.size()>1)
+		painter.drawPath(vertexArray, colorArray); // (does client state switching as needed internally)
 }
 
+bool Satellite::drawOrbitBuffer(StelCore* core, StelPainter& painter)
+{
+	// The samples are in the horizontal frame, with the refraction mode of altAzToJ2000()
+	const StelProjectorP prj = core->getProjection(StelCore::FrameAltAz);
+	if (prj->hasDiscontinuity())
+		return false;
+	const QByteArray projectorShader = prj->getForwardTransformShader();
+	if (projectorShader.isEmpty())
+		return false;
+	QOpenGLShaderProgram* program = getOrbitProgram(projectorShader);
+	if (!program)
+		return false;
+	// Keep the order with the hints batched by Satellites::draw()
+	StelPainter::submitBatch();
 
+	if (!orbitBuffer.isCreated())
+	{
+		if (!orbitBuffer.create())
+			return false;
+		orbitBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+		orbitBufferDirty = true;
+	}
+	orbitBuffer.bind();
+	if (orbitBufferDirty)
+	{
+		// The buffer keeps its size while the window slides, only reallocate when orbitLineSegments changed
+		const int size = orbitVertices.size()*sizeof(OrbitVertex);
+		if (orbitBuffer.size()==size)
+			orbitBuffer.write(0, orbitVertices.constData(), size);
+		else
+			orbitBuffer.allocate(orbitVertices.constData(), size);
+		orbitBufferDirty = false;
+	}
+
+	const Mat4f& m = prj->getProjectionMatrix();
+	const QMatrix4x4 qMat(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
+
+	program->bind();
+	program->setUniformValue("projectionMatrix", qMat);
+	program->setUniformValue("visibleColor", orbitColor[0], orbitColor[1], orbitColor[2]);
+	program->setUniformValue("invisibleColor", invisibleSatelliteColor[0], invisibleSatelliteColor[1], invisibleSatelliteColor[2]);
+	program->setUniformValue("brightness", hintBrightness);
+	program->setUniformValue("windowStart", (GLfloat)orbitStart);
+	program->setUniformValue("halfSegments", (GLfloat)(orbitLineSegments/2));
+	program->setUniformValue("fadeSegments", (GLfloat)orbitLineFadeSegments);
+	prj->setForwardTransformUniforms(*program);
+
+	const int vertexLoc = program->attributeLocation("vertex");
+	const int visibleLoc = program->attributeLocation("visible");
+	const int slotLoc = program->attributeLocation("slot");
+	program->setAttributeBuffer(vertexLoc, GL_FLOAT, offsetof(OrbitVertex, altAz), 3, sizeof(OrbitVertex));
+	program->setAttributeBuffer(visibleLoc, GL_FLOAT, offsetof(OrbitVertex, visible), 1, sizeof(OrbitVertex));
+	program->setAttributeBuffer(slotLoc, GL_FLOAT, offsetof(OrbitVertex, slot), 1, sizeof(OrbitVertex));
+	program->enableAttributeArray(vertexLoc);
+	program->enableAttributeArray(visibleLoc);
+	program->enableAttributeArray(slotLoc);
+	// As drawOrbit(), skip the oldest sample
+	painter.glFuncs()->glDrawArrays(GL_LINE_STRIP, orbitStart+1, orbitCapacity-1);
+	program->disableAttributeArray(vertexLoc);
+	program->disableAttributeArray(visibleLoc);
+	program->disableAttributeArray(slotLoc);
+	orbitBuffer.release();
+	program->release();
+	return true;
+}
+
+QOpenGLShaderProgram* Satellite::getOrbitProgram(const QByteArray& projectorShader)
+{
+	auto it = orbitPrograms.constFind(projectorShader);
+	if (it!=orbitPrograms.constEnd())
+		return it.value();
+
+	// The fading of the ends of the line is computed as in calculateOrbitSegmentIntensity()
+	QOpenGLShader vshader(QOpenGLShader::Vertex);
+	const QByteArray vsrc =
+		"attribute highp vec3 vertex;\n"
+		"attribute mediump float visible;\n"
+		"attribute highp float slot;\n"
+		"uniform mediump mat4 projectionMatrix;\n"
+		"uniform mediump vec3 visibleColor;\n"
+		"uniform mediump vec3 invisibleColor;\n"
+		"uniform mediump float brightness;\n"
+		"uniform highp float windowStart;\n"
+		"uniform mediump float halfSegments;\n"
+		"uniform mediump float fadeSegments;\n"
+		"varying mediump vec4 outColor;\n"
+		+ projectorShader +
+		"void main(void)\n"
+		"{\n"
+		"    gl_Position = projectionMatrix * vec4(projectToViewport(vertex).xyz, 1.);\n"
+		"    float endDist = halfSegments - abs(slot - windowStart - 1.0 - halfSegments);\n"
+		"    float intensity = endDist > fadeSegments ? 1.0 : (endDist + 1.0)/(fadeSegments + 1.0);\n"
+		"    outColor = vec4(mix(invisibleColor, visibleColor, visible), brightness*intensity);\n"
+		"}\n";
+	vshader.compileSourceCode(vsrc);
+	if (!vshader.log().isEmpty()) { qWarning() << "Satellite::getOrbitProgram(): Warnings while compiling vshader: " << vshader.log(); }
+
+	QOpenGLShader fshader(QOpenGLShader::Fragment);
+	const QByteArray fsrc =
+		"varying mediump vec4 outColor;\n"
+		"void main(void)\n"
+		"{\n"
+		"    gl_FragColor = outColor;\n"
+		"}\n";
+	fshader.compileSourceCode(fsrc);
+	if (!fshader.log().isEmpty()) { qWarning() << "Satellite::getOrbitProgram(): Warnings while compiling fshader: " << fshader.log(); }
+
+	QOpenGLShaderProgram* program = new QOpenGLShaderProgram();
+	program->addShader(&vshader);
+	program->addShader(&fshader);
+	if (!StelPainter::linkProg(program, "satelliteOrbitShader"))
+	{
+		// Do not try again for this projection, the lines are drawn by StelPainter
+		qWarning() << "[Satellites] cannot link the orbit line shader, using the CPU for this projection.";
+		delete program;
+		program = Q_NULLPTR;
+	}
+	orbitPrograms.insert(projectorShader, program);
+	return program;
+}
+
+void Satellite::deinitOrbitPrograms()
+{
+	qDeleteAll(orbitPrograms);
+	orbitPrograms.clear();
+}
 
 float Satellite::calculateOrbitSegmentIntensity(int segNum)
 {
@@ -1010,6 +1319,20 @@ float Satellite::calculateOrbitSegmentIntensity(int segNum)
 	}
 }
 
+void Satellite::setOrbitSample(int index, const gTime& epoch)
+{
+	pSatWrapper->setEpoch(epoch.getGmtTm());
+	OrbitVertex v;
+	v.altAz = pSatWrapper->getAltAz().toVec3f();
+	v.altAz.normalize();
+	v.visible = (pSatWrapper->getVisibilityPredict()==gSatWrapper::VISIBLE) ? 1.f : 0.f;
+	v.slot = index;
+	orbitVertices[index] = v;
+	v.slot = index+orbitCapacity;
+	orbitVertices[index+orbitCapacity] = v;
+	orbitBufferDirty = true;
+}
+
 void Satellite::computeOrbitPoints()
 {
 	gTimeSpan computeInterval(0, 0, 0, orbitLineSegmentDuration);
@@ -1017,20 +1340,19 @@ void Satellite::computeOrbitPoints()
 	gTime epochTm;
 	gTime epoch(epochTime);
 	gTime lastEpochComp(lastEpochCompForOrbit);
-	Vec3d elAzVector;
 	int diffSlots;
 
-
-	if (orbitPoints.isEmpty())//Setup orbitPoins
+	if (orbitCapacity!=orbitLineSegments+1)//Setup orbitPoins
 	{
+		// The storage is reused when the orbit is recomputed
+		orbitCapacity = orbitLineSegments+1;
+		orbitVertices.resize(2*orbitCapacity);
+		orbitStart = 0;
 		epochTm  = epoch - orbitSpan;
 
-		for (int i=0; i<=orbitLineSegments; i++)
+		for (int i=0; i<orbitCapacity; i++)
 		{
-			pSatWrapper->setEpoch(epochTm.getGmtTm());
-			elAzVector  = pSatWrapper->getAltAz();
-			orbitPoints.append(elAzVector);
-			visibilityPoints.append(pSatWrapper->getVisibilityPredict());
+			setOrbitSample(i, epochTm);
 			epochTm    += computeInterval;
 		}
 		lastEpochCompForOrbit = epochTime;
@@ -1047,25 +1369,22 @@ void Satellite::computeOrbitPoints()
 			{
 				diffSlots = orbitLineSegments + 1;
 				epochTm  = epoch - orbitSpan;
+				lastEpochCompForOrbit = epochTime;
 			}
 			else
 			{
 				epochTm   = lastEpochComp + orbitSpan + computeInterval;
+				// Keep the samples on the same time grid: the fraction of slot is left for the next frames
+				lastEpochCompForOrbit = (lastEpochComp + gTimeSpan(0, 0, 0, diffSlots*orbitLineSegmentDuration)).getGmtTm();
 			}
 
 			for (int i=0; i<diffSlots; i++)
 			{
-				//remove points at beginning of list and add points at end.
-				orbitPoints.removeFirst();
-				visibilityPoints.removeFirst();
-				pSatWrapper->setEpoch(epochTm.getGmtTm());
-				elAzVector  = pSatWrapper->getAltAz();
-				orbitPoints.append(elAzVector);
-				visibilityPoints.append(pSatWrapper->getVisibilityPredict());
+				//replace the oldest sample by a new one at the end of the window.
+				setOrbitSample(orbitStart, epochTm);
+				orbitStart = (orbitStart+1) % orbitCapacity;
 				epochTm    += computeInterval;
 			}
-
-			lastEpochCompForOrbit = epochTime;
 		}
 	}
 	else if (epochTime < lastEpochCompForOrbit)
@@ -1079,23 +1398,19 @@ void Satellite::computeOrbitPoints()
 			{
 				diffSlots = orbitLineSegments + 1;
 				epochTm   = epoch + orbitSpan;
+				lastEpochCompForOrbit = epochTime;
 			}
 			else
 			{
-				epochTm   = epoch - orbitSpan - computeInterval;
+				epochTm   = lastEpochComp - orbitSpan - computeInterval;
+				lastEpochCompForOrbit = (lastEpochComp - gTimeSpan(0, 0, 0, diffSlots*orbitLineSegmentDuration)).getGmtTm();
 			}
 			for (int i=0; i<diffSlots; i++)
-			{ //remove points at end of list and add points at beginning.
-				orbitPoints.removeLast();
-				visibilityPoints.removeLast();
-				pSatWrapper->setEpoch(epochTm.getGmtTm());
-				elAzVector  = pSatWrapper->getAltAz();
-				orbitPoints.push_front(elAzVector);
-				visibilityPoints.push_front(pSatWrapper->getVisibilityPredict());
+			{ //replace the newest sample by a new one at the beginning of the window.
+				orbitStart = (orbitStart+orbitCapacity-1) % orbitCapacity;
+				setOrbitSample(orbitStart, epochTm);
 				epochTm -= computeInterval;
-
 			}
-			lastEpochCompForOrbit = epochTime;
 		}
 	}
 }
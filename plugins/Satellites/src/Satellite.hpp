@@ -22,19 +22,25 @@
 
 #include <QDateTime>
 #include <QFont>
+#include <QHash>
 #include <QList>
+#include <QOpenGLBuffer>
 #include <QSharedPointer>
 #include <QString>
 #include <QStringList>
 #include <QVariant>
+#include <QVector>
 
 #include "StelObject.hpp"
 #include "StelTextureTypes.hpp"
 #include "StelSphereGeometry.hpp"
 #include "gSatWrapper.hpp"
+#include "gsatellite/gSatNearEarthBatch.hpp"
 
 
 class StelPainter;
+class QOpenGLShaderProgram;
+class QDataStream;
 class StelLocation;
 
 //! Radio communication channel properties.
@@ -93,6 +99,8 @@ class Satellite : public StelObject
 	friend class Satellites;
 	friend class SatellitesDialog;
 	friend class SatellitesListModel;
+	friend class SatellitePassPredictor;
+	friend class SatelliteDirectionIndex;
 
 	Q_ENUMS(OptStatus)
 public:
@@ -121,6 +129,13 @@ public:
 	//! create a duplicate.
 	QVariantMap getMap(void);
 
+	//! Write the data of the satellite saved by getMap() to a binary catalog.
+	//! See Satellites::saveCatalogCache().
+	void writeCatalogData(QDataStream& out) const;
+	//! Create a satellite from the data written by writeCatalogData().
+	//! @return Q_NULLPTR if the data cannot be read or the satellite is not valid.
+	static Satellite* readCatalogData(QDataStream& in);
+
 	virtual QString getType(void) const
 	{
 		return SATELLITE_TYPE;
@@ -181,6 +196,35 @@ public:
 	// calculate faders, new position
 	void update(double deltaTime);
 
+	//! Compute the position of the satellite at the epoch given to gSatWrapper::prepareEpoch(), without the orbit line.
+	//! This can run on several threads at once for different satellites.
+	//! The visibility and the phase angle are computed only for the satellites which are above the horizon
+	//! and in the viewport, or if forceExtras is true. They keep their last values otherwise.
+	//! @param viewportCap bounding cap of the viewport in the AltAz frame
+	//! @param forceExtras compute the visibility and the phase angle in any case, e.g. for the selected satellite
+	//! @param batch if not null, the TEME state is taken from this batch, which was already propagated to the epoch
+	//! @param batchIndex index of the satellite in batch
+	void propagate(const SphericalCap& viewportCap, bool forceExtras, const gSatNearEarthBatch* batch=Q_NULLPTR, int batchIndex=-1);
+	//! Same as propagate(), with the state of the last propagation extrapolated linearly to the epoch.
+	//! This is accurate enough for a few seconds, for satellites updated at a reduced rate.
+	void extrapolate(const SphericalCap& viewportCap);
+
+	//! Get whether propagate() must be called at a date, because the schedule computed by
+	//! scheduleNextPropagation() after the last propagation ended or the date went backwards.
+	bool isPropagationDue(double jd) const {return jd<lastPropagationJD || jd>=nextPropagationJD;}
+	//! Get whether the satellite is known to stay well below the horizon until the next scheduled propagation.
+	bool isSleeping() const {return sleeping;}
+	//! Compute when the satellite must be propagated again, after propagate().
+	//! A satellite well below the horizon is not due before the earliest date at which it could rise,
+	//! from a bound of the angular velocity of its orbit.
+	//! @param fullRate if false, a satellite above the horizon is due after reducedInterval only,
+	//! and it is extrapolated in between.
+	//! @param reducedInterval interval between propagations at reduced rate [s]
+	void scheduleNextPropagation(bool fullRate, double reducedInterval);
+	//! Make the satellite due for propagation at the next update, e.g. after a change of location.
+	//! This also forgets the magnitude curve of the current pass.
+	void resetPropagationSchedule() {lastPropagationJD = nextPropagationJD = 0.; sleeping = false; magnitudeCurve.clear();}
+
 	double getDoppler(double freq) const;
 	static bool showLabels;
 	static double roundToDp(float n, int dp);
@@ -211,9 +255,46 @@ public:
 	QString getOperationalStatus() const;
 
 private:
+	//! Copy the position of pSatWrapper after its propagation, and check that the orbit is still valid.
+	//! @return false if the orbit became invalid.
+	bool updatePosition();
+	//! Illumination of the satellite and terms of its magnitude model at a date.
+	struct MagnitudeSample
+	{
+		gSatWrapper::Visibility visibility;
+		double phaseAngle;
+		double sunReflAngle;	// degrees, for Iridium satellites; -1 otherwise
+		double flareMagnitude;	// magnitude of the Iridium flare, 100 if none
+		double rangeTerm;	// added to the standard magnitude, from the range and the illuminated fraction
+	};
+	//! Evaluate the visibility, the phase angle and the magnitude model for a TEME state of the satellite,
+	//! dt seconds after the epoch of the observer position of gSatWrapper.
+	//! The magnitude terms are computed only when the satellite is visible and has a standard magnitude.
+	MagnitudeSample computeMagnitudeSample(const Vec3d& pos, const Vec3d& vel, double dt) const;
+	//! Get the sample of magnitudeCurve at a multiple of the step of the curve, computing it on first use
+	//! from the current state extrapolated linearly.
+	MagnitudeSample getMagnitudeSample(qint64 index, double step);
+	//! Compute the visibility, the phase angle and the magnitude for the position copied by updatePosition().
+	//! With magnitudeCurvesFlag, they are interpolated between the samples of the magnitude curve of the pass,
+	//! and only computed exactly when the visibility changes between two samples.
+	void updateVisibility();
+	//! Update the position, and the visibility when needed as described in propagate().
+	void updateState(const SphericalCap& viewportCap, bool forceExtras);
+
 	//draw orbits methods
+	//! Advance the window of orbit samples centred on epochTime, computing only the samples
+	//! which entered the window since the last call.
 	void computeOrbitPoints();
+	//! Compute the orbit sample at the epoch, and store it in the ring buffer at @a index.
+	void setOrbitSample(int index, const gTime& epoch);
 	void drawOrbit(StelCore* core, StelPainter& painter);
+	//! Draw the orbit line from orbitBuffer, projected by the vertex shader.
+	//! @return false if the projector cannot be evaluated on the GPU, and nothing was drawn.
+	bool drawOrbitBuffer(StelCore* core, StelPainter& painter);
+	//! Get the shader program drawing orbit lines for a projector shader, compiling it on first use.
+	static QOpenGLShaderProgram* getOrbitProgram(const QByteArray& projectorShader);
+	//! Delete the shader programs of the orbit lines. Requires a valid context.
+	static void deinitOrbitPrograms();
 	//! returns 0 - 1.0 for the DRAWORBIT_FADE_NUMBER segments at
 	//! each end of an orbit, with 1 in the middle.
 	float calculateOrbitSegmentIntensity(int segNum);
@@ -273,7 +354,11 @@ private:
 	static int   orbitLineFadeSegments;
 	static int   orbitLineSegmentDuration; //measured in seconds
 	static bool  orbitLinesFlag;
+	static bool  orbitLineBuffersFlag;
+	static QHash<QByteArray, QOpenGLShaderProgram*> orbitPrograms;
 	static bool  realisticModeFlag;
+	//! Interpolate the illumination and the magnitude in the magnitude curve of each pass.
+	static bool  magnitudeCurvesFlag;
 	static bool  hideInvisibleSatellitesFlag;
 	//! Mask controlling which info display flags should be honored.
 	static StelObject::InfoStringGroupFlags flagsMask;
@@ -303,8 +388,38 @@ private:
 	Vec3f    orbitColor;
 	double    lastEpochCompForOrbit; //measured in Julian Days
 	double    epochTime;  //measured in Julian Days
-	QList<Vec3d> orbitPoints; //orbit points represented by ElAzPos vectors
-	QList<gSatWrapper::Visibility> visibilityPoints; //orbit visibility points
+
+	// Schedule of the propagation, measured in Julian Days (UTC)
+	double    lastPropagationJD;
+	double    nextPropagationJD;
+	bool      sleeping;
+	// TEME state of the last propagation, for extrapolate()
+	Vec3d     sampleTEMEPos;
+	Vec3d     sampleTEMEVel;
+	int       sampleError;
+
+	//! Illumination and magnitude model for the current state, used by getVMagnitude().
+	MagnitudeSample currentMagnitude;
+	//! Samples of the current pass on a grid of dates, from magnitudeCurveStart times the step.
+	//! Cleared when the satellite sets, and when the time grid or the initial state change.
+	QVector<MagnitudeSample> magnitudeCurve;
+	qint64    magnitudeCurveStart;
+
+	//! A sample of the orbit line, in the layout of orbitBuffer.
+	struct OrbitVertex
+	{
+		Vec3f altAz;	// unit vector of the ElAzPos of the sample
+		float visible;	// 1 if the satellite is predicted visible, 0 otherwise
+		float slot;	// index of this vertex in orbitVertices
+	};
+	//! Ring buffer of the orbitLineSegments+1 samples of the orbit line, oldest first from orbitStart.
+	//! Each sample is stored twice, at its index and orbitCapacity after it, so that the samples of
+	//! the window are always contiguous from orbitStart and can be drawn as one line strip.
+	QVector<OrbitVertex> orbitVertices;
+	int       orbitCapacity; // number of samples of the window, 0 when not computed
+	int       orbitStart;    // index of the oldest sample in orbitVertices
+	QOpenGLBuffer orbitBuffer;
+	bool      orbitBufferDirty; // orbitVertices changed since the last upload
 };
 
 typedef QSharedPointer<Satellite> SatelliteP;
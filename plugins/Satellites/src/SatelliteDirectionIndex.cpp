@@ -0,0 +1,167 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "SatelliteDirectionIndex.hpp"
+
+#include <cmath>
+
+QVector<SatelliteDirectionIndex::Cell> SatelliteDirectionIndex::cells;
+
+SatelliteDirectionIndex::SatelliteDirectionIndex()
+	: valid(false)
+	, nbSatellites(0)
+{
+	if (!cells.isEmpty())
+		return;
+
+	// The farthest points of a cell from its center are its corners, as its edges are arcs of great circles
+	cells.resize(NB_CELLS);
+	const double step = 2./CELLS_PER_EDGE;
+	for (int face=0; face<6; ++face)
+	{
+		for (int j=0; j<CELLS_PER_EDGE; ++j)
+		{
+			for (int i=0; i<CELLS_PER_EDGE; ++i)
+			{
+				const double u0 = -1. + i*step;
+				const double v0 = -1. + j*step;
+				Cell& cell = cells[(face*CELLS_PER_EDGE+j)*CELLS_PER_EDGE+i];
+				cell.center = getFacePoint(face, u0+0.5*step, v0+0.5*step);
+				double minCos = 1.;
+				for (int k=0; k<4; ++k)
+					minCos = qMin(minCos, cell.center.dot(getFacePoint(face, u0+(k&1)*step, v0+(k>>1)*step)));
+				// Small margin for the rounding of getCell() at the borders
+				cell.radius = std::acos(minCos) * 1.01;
+			}
+		}
+	}
+}
+
+Vec3d SatelliteDirectionIndex::getFacePoint(int face, double u, double v)
+{
+	Vec3d p;
+	switch (face)
+	{
+		case 0: p.set(1., u, v); break;
+		case 1: p.set(-1., u, v); break;
+		case 2: p.set(u, 1., v); break;
+		case 3: p.set(u, -1., v); break;
+		case 4: p.set(u, v, 1.); break;
+		default: p.set(u, v, -1.); break;
+	}
+	p.normalize();
+	return p;
+}
+
+int SatelliteDirectionIndex::getCell(const Vec3d& p)
+{
+	const double ax = std::fabs(p[0]);
+	const double ay = std::fabs(p[1]);
+	const double az = std::fabs(p[2]);
+	int face;
+	double m, u, v;
+	if (ax>=ay && ax>=az)
+	{
+		face = p[0]>0. ? 0 : 1;
+		m = ax; u = p[1]; v = p[2];
+	}
+	else if (ay>=az)
+	{
+		face = p[1]>0. ? 2 : 3;
+		m = ay; u = p[0]; v = p[2];
+	}
+	else
+	{
+		face = p[2]>0. ? 4 : 5;
+		m = az; u = p[0]; v = p[1];
+	}
+	if (!(m>0.)) // null vector or NaN
+		return 0;
+	const double scale = 0.5*CELLS_PER_EDGE/m;
+	const int i = qBound(0, static_cast<int>((u+m)*scale), CELLS_PER_EDGE-1);
+	const int j = qBound(0, static_cast<int>((v+m)*scale), CELLS_PER_EDGE-1);
+	return (face*CELLS_PER_EDGE+j)*CELLS_PER_EDGE+i;
+}
+
+void SatelliteDirectionIndex::clear()
+{
+	valid = false;
+	nbSatellites = 0;
+	cellStart.clear();
+	cellSatellites.clear();
+}
+
+void SatelliteDirectionIndex::update(const QList<SatelliteP>& satellites)
+{
+	// Counting sort of the satellites by cell
+	nbSatellites = satellites.size();
+	satelliteCells.resize(nbSatellites);
+	cellStart.fill(0, NB_CELLS+1);
+	for (int k=0; k<nbSatellites; ++k)
+	{
+		const Satellite* sat = satellites.at(k).data();
+		if (sat->initialized && sat->displayed)
+		{
+			const int cell = getCell(sat->XYZ);
+			satelliteCells[k] = cell;
+			cellStart[cell+1]++;
+		}
+		else
+			satelliteCells[k] = -1;
+	}
+	for (int c=0; c<NB_CELLS; ++c)
+		cellStart[c+1] += cellStart[c];
+	cellSatellites.resize(cellStart[NB_CELLS]);
+	QVector<int> next(cellStart);
+	for (int k=0; k<nbSatellites; ++k)
+	{
+		if (satelliteCells[k]>=0)
+			cellSatellites[next[satelliteCells[k]]++] = k;
+	}
+	valid = true;
+}
+
+QList<StelObjectP> SatelliteDirectionIndex::searchAround(const QList<SatelliteP>& satellites, const Vec3d& v, double limitFov) const
+{
+	QList<StelObjectP> result;
+	Q_ASSERT(valid && satellites.size()==nbSatellites);
+	const double limitRad = limitFov * M_PI/180.;
+	const double cosLimFov = std::cos(limitRad);
+	for (int c=0; c<NB_CELLS; ++c)
+	{
+		if (cellStart[c]==cellStart[c+1])
+			continue;
+		const double cosDistance = qBound(-1., v.dot(cells[c].center), 1.);
+		if (std::acos(cosDistance) > limitRad + cells[c].radius)
+			continue;
+		for (int n=cellStart[c]; n<cellStart[c+1]; ++n)
+		{
+			const SatelliteP& sat = satellites.at(cellSatellites[n]);
+			// The flags may have changed since update()
+			if (!sat->initialized || !sat->displayed)
+				continue;
+			Vec3d equPos = sat->XYZ;
+			equPos.normalize();
+			if (equPos.dot(v)>=cosLimFov)
+				result.append(qSharedPointerCast<StelObject>(sat));
+		}
+	}
+	return result;
+}
@@ -0,0 +1,82 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef SATELLITEDIRECTIONINDEX_HPP
+#define SATELLITEDIRECTIONINDEX_HPP
+
+#include "Satellite.hpp"
+#include "StelObjectType.hpp"
+#include "VecMath.hpp"
+
+#include <QList>
+#include <QVector>
+
+//! @class SatelliteDirectionIndex
+//! Coarse spatial index of the directions of the displayed satellites, answering Satellites::searchAround().
+//! The sphere is divided in cells by the faces of a cube, each face in CELLS_PER_EDGE x CELLS_PER_EDGE cells.
+//! The satellites are sorted by cell after each frame, which only takes a division per satellite, and a
+//! search checks the satellites of the cells which intersect the search circle.
+//! The index refers to the satellites by their position in the list given to update(), it must be
+//! cleared when this list changes.
+//! @ingroup satellites
+class SatelliteDirectionIndex
+{
+public:
+	SatelliteDirectionIndex();
+
+	//! Forget the indexed satellites.
+	void clear();
+	//! Get whether update() was called since the last clear().
+	bool isValid() const { return valid; }
+
+	//! Index the J2000 directions (Satellite::XYZ) of the displayed satellites. Call after they were drawn.
+	void update(const QList<SatelliteP>& satellites);
+
+	//! Find the displayed satellites within an angular distance of a direction.
+	//! @param satellites the list given to update()
+	//! @param v J2000 unit vector
+	//! @param limitFov the angular distance in degrees
+	QList<StelObjectP> searchAround(const QList<SatelliteP>& satellites, const Vec3d& v, double limitFov) const;
+
+private:
+	static const int CELLS_PER_EDGE = 16;
+	static const int NB_CELLS = 6*CELLS_PER_EDGE*CELLS_PER_EDGE;
+
+	//! Get the cell containing a direction, which need not be normalized.
+	static int getCell(const Vec3d& v);
+	//! Get the direction of the point (u, v) in [-1, 1]x[-1, 1] of a face of the cube.
+	static Vec3d getFacePoint(int face, double u, double v);
+
+	bool valid;
+	int nbSatellites;		// size of the list given to update()
+	QVector<int> cellStart;		// index in cellSatellites of the first satellite of each cell, NB_CELLS+1 values
+	QVector<int> cellSatellites;	// positions of the satellites in the list, sorted by cell
+	QVector<int> satelliteCells;	// cell of each satellite, reused by update()
+
+	//! Center and angular radius of the bounding circle of each cell, the same for all instances.
+	struct Cell
+	{
+		Vec3d center;
+		double radius;		// radians
+	};
+	static QVector<Cell> cells;
+};
+
+#endif // SATELLITEDIRECTIONINDEX_HPP
@@ -0,0 +1,372 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "SatellitePassPredictor.hpp"
+#include "gsatellite/gSatTEME.hpp"
+#include "gsatellite/gTime.hpp"
+#include "gsatellite/stdsat.h"
+
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Interval between the samples of the elevation [s]
+	const double COARSE_STEP = 60.;
+	// Precision of AOS, TCA and LOS [s]
+	const double TIME_TOLERANCE = 1.;
+	// Interval between the samples of the visibility during a pass [s]
+	const double VISIBILITY_STEP = 10.;
+	// Local maxima of the elevation less than this below the minimum elevation are checked for grazing passes
+	const double GRAZING_MARGIN = 2.*KDEG2RAD;
+	// Margin of gSatWrapper::getMinimumRiseDelay()
+	const double HORIZON_MARGIN = 2.*KDEG2RAD;
+
+	struct PassJob
+	{
+		QString id;
+		QString name;
+		QByteArray tle1, tle2;
+		SatellitePassList passes;
+	};
+
+	struct Sample
+	{
+		double jd;
+		bool valid;		// false if the SGP4 model failed, e.g. after the decay of the satellite
+		double elevation;
+		double azimuth;		// from North through East
+		double range;		// km
+		Vec3d satPos;		// TEME [km]
+		Vec3d observerPos;	// ECI [km]
+		Vec3d zenith;		// ECI unit vector
+	};
+
+	//! Low precision position of the Sun in ECI system [km], from the Astronomical Almanac (about 0.01°).
+	Vec3d computeSunECIPos(double jd)
+	{
+		const double n = jd - 2451545.0;
+		const double L = (280.460 + 0.9856474*n)*KDEG2RAD;
+		const double g = (357.528 + 0.9856003*n)*KDEG2RAD;
+		const double lambda = L + (1.915*std::sin(g) + 0.020*std::sin(2.*g))*KDEG2RAD;
+		const double epsilon = (23.439 - 0.0000004*n)*KDEG2RAD;
+		const double r = (1.00014 - 0.01671*std::cos(g) - 0.00014*std::cos(2.*g))*KAU;
+		return Vec3d(r*std::cos(lambda), r*std::cos(epsilon)*std::sin(lambda), r*std::sin(epsilon)*std::sin(lambda));
+	}
+
+	//! Finds the passes of one satellite, with its own copy of the SGP4 model.
+	class PassFinder
+	{
+	public:
+		PassFinder(const PassJob& job, const StelLocation& location, double minElevation)
+			: job(job)
+			, radLatitude(location.latitude*KDEG2RAD)
+			, radLongitude(location.longitude*KDEG2RAD)
+			, altitude(location.altitude)
+			, minElevation(minElevation)
+		{
+			// As in gSatWrapper, the TLE library modifies its input
+			QByteArray t1(job.tle1), t2(job.tle2);
+			t1.truncate(130);
+			t2.truncate(130);
+			QByteArray name = job.name.toLatin1();
+			satellite = new gSatTEME(name.data(), t1.data(), t2.data());
+		}
+		~PassFinder()
+		{
+			delete satellite;
+		}
+
+		SatellitePassList find(double startJD, double endJD);
+
+	private:
+		Sample sample(double jd);
+		gSatWrapper::Visibility getVisibility(const Sample& s) const;
+		//! Find the time at which the elevation crosses minElevation between two samples on both sides of it, in any order.
+		//! @return the sample above minElevation at the end of the bisection
+		Sample findCrossing(Sample a, Sample b);
+		//! Find the highest elevation between two dates by golden section search.
+		Sample findMaximum(double a, double b);
+		SatellitePass makePass(const Sample& aos, const Sample& los);
+
+		const PassJob& job;
+		gSatTEME* satellite;
+		double radLatitude, radLongitude, altitude;
+		double minElevation;
+	};
+
+	Sample PassFinder::sample(double jd)
+	{
+		Sample s;
+		s.jd = jd;
+		satellite->setEpoch(jd);
+		s.satPos = satellite->getPos();
+		s.valid = satellite->getErrorCode()==0 && s.satPos.length()>KEARTHRADIUS;
+
+		const double theta = gTime(jd).toThetaLMST(radLongitude);
+		Vec3d observerVel;
+		gSatWrapper::computeObserverECIPosition(radLatitude, theta, altitude, s.observerPos, observerVel);
+
+		// Same rotation to the topocentric frame as gSatWrapper::getAltAz()
+		const Vec3d slantRange = s.satPos - s.observerPos;
+		const double sinLat = std::sin(radLatitude), cosLat = std::cos(radLatitude);
+		const double sinTheta = std::sin(theta), cosTheta = std::cos(theta);
+		const double south = sinLat*cosTheta*slantRange[0] + sinLat*sinTheta*slantRange[1] - cosLat*slantRange[2];
+		const double east = -sinTheta*slantRange[0] + cosTheta*slantRange[1];
+		s.zenith.set(cosLat*cosTheta, cosLat*sinTheta, sinLat);
+		s.range = slantRange.length();
+		s.elevation = std::asin(s.zenith.dot(slantRange)/s.range);
+		s.azimuth = std::atan2(east, -south);
+		if (s.azimuth<0.)
+			s.azimuth += 2.*M_PI;
+		return s;
+	}
+
+	gSatWrapper::Visibility PassFinder::getVisibility(const Sample& s) const
+	{
+		if (s.elevation<=0.)
+			return gSatWrapper::NOT_VISIBLE;
+		const Vec3d sunPos = computeSunECIPos(s.jd);
+		if ((sunPos - s.observerPos).dot(s.zenith)>0.)
+			return gSatWrapper::RADAR_SUN;
+		// Cylindrical shadow of the Earth
+		Vec3d sunDir = sunPos;
+		sunDir.normalize();
+		const double d = s.satPos.dot(sunDir);
+		if (d>0. || (s.satPos - sunDir*d).length()>KEARTHRADIUS)
+			return gSatWrapper::VISIBLE;
+		return gSatWrapper::RADAR_NIGHT;
+	}
+
+	Sample PassFinder::findCrossing(Sample a, Sample b)
+	{
+		const bool aboveA = a.elevation>=minElevation;
+		while (std::fabs(b.jd-a.jd)*KSEC_PER_DAY>TIME_TOLERANCE)
+		{
+			const Sample m = sample(0.5*(a.jd+b.jd));
+			if ((m.elevation>=minElevation)==aboveA)
+				a = m;
+			else
+				b = m;
+		}
+		return aboveA ? a : b;
+	}
+
+	Sample PassFinder::findMaximum(double a, double b)
+	{
+		static const double invPhi = 0.5*(std::sqrt(5.)-1.);
+		double c = b - invPhi*(b-a);
+		double d = a + invPhi*(b-a);
+		Sample sc = sample(c);
+		Sample sd = sample(d);
+		while ((b-a)*KSEC_PER_DAY>TIME_TOLERANCE)
+		{
+			if (sc.elevation>sd.elevation)
+			{
+				b = d;
+				d = c;
+				sd = sc;
+				c = b - invPhi*(b-a);
+				sc = sample(c);
+			}
+			else
+			{
+				a = c;
+				c = d;
+				sc = sd;
+				d = a + invPhi*(b-a);
+				sd = sample(d);
+			}
+		}
+		return sc.elevation>sd.elevation ? sc : sd;
+	}
+
+	SatellitePass PassFinder::makePass(const Sample& aos, const Sample& los)
+	{
+		const Sample tca = los.jd>aos.jd ? findMaximum(aos.jd, los.jd) : aos;
+
+		SatellitePass pass;
+		pass.id = job.id;
+		pass.name = job.name;
+		pass.aos = aos.jd;
+		pass.tca = tca.jd;
+		pass.los = los.jd;
+		pass.aosAzimuth = aos.azimuth;
+		pass.tcaAzimuth = tca.azimuth;
+		pass.losAzimuth = los.azimuth;
+		pass.maxElevation = tca.elevation;
+		pass.tcaRange = tca.range;
+		pass.tcaVisibility = getVisibility(tca);
+		pass.visibleDuration = 0.;
+		for (double jd=aos.jd; jd<los.jd; jd+=VISIBILITY_STEP/KSEC_PER_DAY)
+		{
+			if (getVisibility(sample(jd))==gSatWrapper::VISIBLE)
+				pass.visibleDuration += qMin(VISIBILITY_STEP, (los.jd-jd)*KSEC_PER_DAY);
+		}
+		return pass;
+	}
+
+	SatellitePassList PassFinder::find(double startJD, double endJD)
+	{
+		SatellitePassList passes;
+		Sample s = sample(startJD);
+		if (!s.valid)
+			return passes;
+		bool inPass = s.elevation>=minElevation;
+		Sample aos = s;
+		// The sample before s, if it was one coarse step before
+		Sample previous = s;
+		bool hasPrevious = false;
+		while (s.jd<endJD)
+		{
+			double step = COARSE_STEP;
+			if (!inPass && minElevation>=0.)
+				step = qMax(step, gSatWrapper::getMinimumRiseDelay(satellite->getSatrec(), s.observerPos, s.satPos, HORIZON_MARGIN));
+			const double nextJD = s.jd + step/KSEC_PER_DAY;
+			const Sample next = sample(qMin(nextJD, endJD));
+			if (!next.valid)
+				break;
+
+			if (!inPass && next.elevation>=minElevation)
+			{
+				aos = findCrossing(s, next);
+				inPass = true;
+			}
+			else if (inPass && next.elevation<minElevation)
+			{
+				passes.append(makePass(aos, findCrossing(next, s)));
+				inPass = false;
+			}
+			else if (!inPass && hasPrevious && step==COARSE_STEP && s.elevation>previous.elevation
+				 && s.elevation>=next.elevation && s.elevation>minElevation-GRAZING_MARGIN)
+			{
+				// A grazing pass may have happened between the samples around this local maximum
+				const Sample top = findMaximum(previous.jd, next.jd);
+				if (top.elevation>=minElevation)
+					passes.append(makePass(findCrossing(top, previous), findCrossing(top, next)));
+			}
+
+			previous = s;
+			hasPrevious = step==COARSE_STEP && nextJD<=endJD;
+			s = next;
+		}
+		if (inPass)
+			passes.append(makePass(aos, s));
+		return passes;
+	}
+}
+
+SatellitePassList SatellitePassPredictor::predict(const QList<SatelliteP>& satellites, const StelLocation& location, double startJD,
+						  double days, double minElevation, bool parallel)
+{
+	const double endJD = startJD + days;
+	SatellitePassList result;
+	QVector<PassJob> jobs;
+	for (const auto& sat : satellites)
+	{
+		const auto entry = cache.constFind(sat->id);
+		if (entry!=cache.constEnd() && entry->tle1==sat->tleElements.first && entry->tle2==sat->tleElements.second
+		    && entry->latitude==location.latitude && entry->longitude==location.longitude && entry->altitude==location.altitude
+		    && entry->minElevation==minElevation && entry->startJD<=startJD && entry->endJD>=endJD)
+		{
+			for (const auto& pass : entry->passes)
+			{
+				if (pass.los>=startJD && pass.aos<endJD)
+					result.append(pass);
+			}
+			continue;
+		}
+		PassJob job;
+		job.id = sat->id;
+		job.name = sat->name;
+		job.tle1 = sat->tleElements.first;
+		job.tle2 = sat->tleElements.second;
+		jobs.append(job);
+	}
+
+	auto findPasses = [&location, startJD, endJD, minElevation](PassJob& job) {
+		PassFinder finder(job, location, minElevation);
+		job.passes = finder.find(startJD, endJD);
+	};
+	if (parallel && jobs.size()>1 && QThreadPool::globalInstance()->maxThreadCount()>1)
+		QtConcurrent::blockingMap(jobs, findPasses);
+	else
+		std::for_each(jobs.begin(), jobs.end(), findPasses);
+
+	for (const auto& job : jobs)
+	{
+		CacheEntry entry;
+		entry.tle1 = job.tle1;
+		entry.tle2 = job.tle2;
+		entry.latitude = location.latitude;
+		entry.longitude = location.longitude;
+		entry.altitude = location.altitude;
+		entry.minElevation = minElevation;
+		entry.startJD = startJD;
+		entry.endJD = endJD;
+		entry.passes = job.passes;
+		cache.insert(job.id, entry);
+		result.append(job.passes);
+	}
+
+	std::sort(result.begin(), result.end(), [](const SatellitePass& a, const SatellitePass& b) { return a.aos<b.aos; });
+	return result;
+}
+
+QVariantMap SatellitePassPredictor::toVariantMap(const SatellitePass& pass)
+{
+	QString visibility;
+	switch (pass.tcaVisibility)
+	{
+		case gSatWrapper::RADAR_SUN:
+			visibility = "radar_sun";
+			break;
+		case gSatWrapper::VISIBLE:
+			visibility = "visible";
+			break;
+		case gSatWrapper::RADAR_NIGHT:
+			visibility = "radar_night";
+			break;
+		case gSatWrapper::NOT_VISIBLE:
+			visibility = "not_visible";
+			break;
+		default:
+			visibility = "unknown";
+	}
+
+	QVariantMap map;
+	map.insert("id", pass.id);
+	map.insert("name", pass.name);
+	map.insert("aos", pass.aos);
+	map.insert("tca", pass.tca);
+	map.insert("los", pass.los);
+	map.insert("aosAzimuth", pass.aosAzimuth*KRAD2DEG);
+	map.insert("tcaAzimuth", pass.tcaAzimuth*KRAD2DEG);
+	map.insert("losAzimuth", pass.losAzimuth*KRAD2DEG);
+	map.insert("maxElevation", pass.maxElevation*KRAD2DEG);
+	map.insert("range", pass.tcaRange);
+	map.insert("visibility", visibility);
+	map.insert("visibleDuration", pass.visibleDuration);
+	return map;
+}
@@ -0,0 +1,97 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef SATELLITEPASSPREDICTOR_HPP
+#define SATELLITEPASSPREDICTOR_HPP
+
+#include "Satellite.hpp"
+#include "StelLocation.hpp"
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVariantMap>
+
+//! One pass of a satellite above the minimum elevation, as computed by SatellitePassPredictor.
+//! @ingroup satellites
+struct SatellitePass
+{
+	QString id;			//!< catalog number of the satellite
+	QString name;
+	double aos;			//!< Julian Day (UTC) of the acquisition of signal, when the satellite rises above the minimum elevation
+	double tca;			//!< Julian Day (UTC) of the time of closest approach, at the highest elevation
+	double los;			//!< Julian Day (UTC) of the loss of signal
+	double aosAzimuth;		//!< radians, from North through East
+	double tcaAzimuth;		//!< radians, from North through East
+	double losAzimuth;		//!< radians, from North through East
+	double maxElevation;		//!< radians
+	double tcaRange;		//!< distance to the observer at TCA [km]
+	gSatWrapper::Visibility tcaVisibility;
+	double visibleDuration;		//!< time during which the satellite is sunlit while the Sun is below the horizon [s]
+};
+
+typedef QList<SatellitePass> SatellitePassList;
+
+//! @class SatellitePassPredictor
+//! Computes the passes of many satellites over a location, on the global thread pool.
+//! Each satellite is propagated by its own copy of the SGP4 model, so that this does not interfere
+//! with the state used for drawing. Its elevation is sampled every minute, or less when it is far below
+//! the horizon (see gSatWrapper::getMinimumRiseDelay()), and AOS, TCA and LOS are refined within one second
+//! by bisection and golden section search. Grazing passes between two samples are found from the local maxima
+//! of the elevation.
+//! The passes of each satellite are cached with its TLE, the location and the minimum elevation, so that
+//! another request for a part of the same interval does not compute them again.
+//! Passes in progress at the start or at the end of the interval are truncated.
+//! @ingroup satellites
+class SatellitePassPredictor
+{
+public:
+	//! Compute the passes of satellites.
+	//! @param satellites the satellites, which must be initialized
+	//! @param location the observer location, on the Earth
+	//! @param startJD Julian Day (UTC) of the start of the interval
+	//! @param days length of the interval
+	//! @param minElevation minimum elevation for a pass [rad]
+	//! @param parallel whether to use the global thread pool
+	//! @return the passes of all satellites sorted by AOS
+	SatellitePassList predict(const QList<SatelliteP>& satellites, const StelLocation& location, double startJD,
+				  double days, double minElevation, bool parallel);
+
+	//! Clear the cached passes.
+	void clear() {cache.clear();}
+
+	//! Get a pass as a map for the scripts and the remote control, with Julian Days, degrees and km.
+	static QVariantMap toVariantMap(const SatellitePass& pass);
+
+private:
+	struct CacheEntry
+	{
+		QByteArray tle1, tle2;
+		double latitude, longitude, altitude;
+		double minElevation;
+		double startJD, endJD;
+		SatellitePassList passes;
+	};
+
+	QHash<QString, CacheEntry> cache;
+};
+
+#endif // SATELLITEPASSPREDICTOR_HPP
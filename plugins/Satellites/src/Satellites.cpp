@@ -21,6 +21,7 @@
 #include "StelPainter.hpp"
 #include "StelApp.hpp"
 #include "StelCore.hpp"
+#include "StelSkyDrawer.hpp"
 #include "StelGui.hpp"
 #include "StelGuiItems.hpp"
 #include "StelLocation.hpp"
@@ -28,11 +29,13 @@
 #include "StelModuleMgr.hpp"
 #include "StelLocaleMgr.hpp"
 #include "StelFileMgr.hpp"
+#include "StelFrameProfiler.hpp"
 #include "StelTextureMgr.hpp"
 #include "StelIniParser.hpp"
 #include "Satellites.hpp"
 #include "Satellite.hpp"
 #include "SatellitesListModel.hpp"
+#include "SatellitesRemoteControlService.hpp"
 #include "Planet.hpp"
 #include "SolarSystem.hpp"
 #include "StelJsonParser.hpp"
@@ -51,16 +54,33 @@
 #include <QFileInfo>
 #include <QFile>
 #include <QTimer>
+#include <QMutexLocker>
 #include <QVariantMap>
 #include <QVariant>
 #include <QDir>
-#include <QTemporaryFile>
+#include <QBuffer>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+// Identification of the binary catalog, see Satellites::saveCatalogCache()
+static const quint32 CATALOG_CACHE_MAGIC = 0x53415443; // "SATC"
+static const qint32 CATALOG_CACHE_VERSION = 1;
 
 StelModule* SatellitesStelPluginInterface::getStelModule() const
 {
 	return new Satellites();
 }
 
+QObjectList SatellitesStelPluginInterface::getExtensionList() const
+{
+	// Registered by the RemoteControl plugin, when it is loaded
+	return QObjectList() << new SatellitesRemoteControlService(StelApp::getInstance().getModuleMgr().getModule("Satellites"));
+}
+
 StelPluginInfo SatellitesStelPluginInterface::getPluginInfo() const
 {
 	// Allow to load the resources when used as a static plugin
@@ -91,17 +111,33 @@ Satellites::Satellites()
 	, updatesEnabled(false)
 	, autoAddEnabled(false)
 	, autoRemoveEnabled(false)
+	, catalogJsonPending(false)
 	, updateFrequencyHours(0)
 	, iridiumFlaresPredictionDepth(7)
+	, passesPredictionDepth(1)
+	, passesMinElevation(10.)
+	, flagParallelPropagation(true)
+	, flagBatchPropagation(true)
+	, flagUpdateScheduling(true)
+	, reducedUpdateInterval(2.)
+	, flagAsyncPropagation(true)
+	, searchIndexValid(false)
 {
 	setObjectName("Satellites");
+	simulationThread.setMaxThreadCount(1);
+	simulationThread.setExpiryTimeout(-1);
 	configDialog = new SatellitesDialog();
 }
 
 void Satellites::deinit()
 {
+	waitForPropagation();
 	Satellite::hintTexture.clear();
+	Satellite::deinitOrbitPrograms();
 	texPointer.clear();
+	// The last updates were saved only to the binary catalog
+	if (catalogJsonPending)
+		saveCatalog();
 }
 
 Satellites::~Satellites()
@@ -135,6 +171,7 @@ void Satellites::init()
 
 		// absolute file name for inner catalog of the satellites
 		catalogPath = dataDir.absoluteFilePath("satellites.json");
+		catalogCachePath = dataDir.absoluteFilePath("satellites.dat");
 		// absolute file name for qs.mag file
 		qsMagFilePath = dataDir.absoluteFilePath("qs.mag");
 
@@ -169,7 +206,8 @@ void Satellites::init()
 	// If the json file does not already exist, create it from the resource in the QT resource
 	if(QFileInfo(catalogPath).exists())
 	{
-		if (!checkJsonFileFormat() || readCatalogVersion() != SATELLITES_PLUGIN_VERSION)
+		// A valid binary catalog was made from a JSON file which passed these checks
+		if (!isCatalogCacheValid() && (!checkJsonFileFormat() || readCatalogVersion() != SATELLITES_PLUGIN_VERSION))
 		{
 			displayMessage(q_("The old satellites.json file is no longer compatible - using default file"), "#bb0000");
 			restoreDefaultCatalog();
@@ -210,6 +248,8 @@ void Satellites::init()
 	connect(core, SIGNAL(locationChanged(StelLocation)), this, SLOT(updateObserverLocation(StelLocation)));
 	connect(core, SIGNAL(dateChangedForMonth()), this, SLOT(updateSatellitesVisibility()));
 	connect(core, SIGNAL(dateChangedByYear()), this, SLOT(updateSatellitesVisibility()));
+	// The translated names are indexed
+	connect(&StelApp::getInstance(), SIGNAL(languageChanged()), this, SLOT(invalidateSearchIndex()));
 }
 
 void Satellites::updateSatellitesVisibility()
@@ -261,6 +301,7 @@ double Satellites::getCallOrder(StelModuleActionName actionName) const
 
 QList<StelObjectP> Satellites::searchAround(const Vec3d& av, double limitFov, const StelCore* core) const
 {
+	waitForPropagation();
 	QList<StelObjectP> result;
 	if (!hintFader)
 		return result;
@@ -273,6 +314,10 @@ QList<StelObjectP> Satellites::searchAround(const Vec3d& av, double limitFov, co
 
 	Vec3d v(av);
 	v.normalize();
+	// Only the cells of the sphere around v are checked
+	if (directionIndex.isValid())
+		return directionIndex.searchAround(satellites, v, limitFov);
+
 	double cosLimFov = cos(limitFov * M_PI/180.);
 	Vec3d equPos;
 
@@ -310,13 +355,10 @@ StelObjectP Satellites::searchByNameI18n(const QString& nameI18n) const
 	if (result)
 		return result;
 
-	for (const auto& sat : satellites)
+	for (const auto& sat : getByName(objw, false))
 	{
-		if (sat->initialized && sat->displayed)
-		{
-			if (sat->getNameI18n().toUpper() == objw)
-				return qSharedPointerCast<StelObject>(sat);
-		}
+		if (sat->displayed)
+			return qSharedPointerCast<StelObject>(sat);
 	}
 
 	return Q_NULLPTR;
@@ -341,13 +383,10 @@ StelObjectP Satellites::searchByName(const QString& englishName) const
 	if (result)
 		return result;
 	
-	for (const auto& sat : satellites)
+	for (const auto& sat : getByName(objw, true))
 	{
-		if (sat->initialized && sat->displayed)
-		{
-			if (sat->getEnglishName().toUpper() == objw)
-				return qSharedPointerCast<StelObject>(sat);
-		}
+		if (sat->displayed)
+			return qSharedPointerCast<StelObject>(sat);
 	}
 
 	return Q_NULLPTR;
@@ -355,15 +394,7 @@ StelObjectP Satellites::searchByName(const QString& englishName) const
 
 StelObjectP Satellites::searchByID(const QString &id) const
 {
-	for (const auto& sat : satellites)
-	{
-		if (sat->initialized && sat->getID() == id)
-		{
-			return qSharedPointerCast<StelObject>(sat);
-		}
-	}
-
-	return Q_NULLPTR;
+	return qSharedPointerCast<StelObject>(getById(id));
 }
 
 StelObjectP Satellites::searchByNoradNumber(const QString &noradNumber) const
@@ -385,13 +416,12 @@ StelObjectP Satellites::searchByNoradNumber(const QString &noradNumber) const
 	{
 		QString numberString = regExp.capturedTexts().at(2);
 		
-		for (const auto& sat : satellites)
+		QMutexLocker locker(&searchIndexMutex);
+		buildSearchIndex();
+		for (auto it = satellitesByNumber.constFind(numberString); it!=satellitesByNumber.constEnd() && it.key()==numberString; ++it)
 		{
-			if (sat->initialized && sat->displayed)
-			{
-				if (sat->getCatalogNumberString() == numberString)
-					return qSharedPointerCast<StelObject>(sat);
-			}
+			if (it.value()->displayed)
+				return qSharedPointerCast<StelObject>(it.value());
 		}
 	}
 	
@@ -425,26 +455,39 @@ QStringList Satellites::listMatchingObjects(const QString& objPrefix, int maxNbI
 			numberPrefix = numberString;
 	}
 
-	for (const auto& sobj : satellites)
+	// The name index of StelObjectModule lists the names of all satellites: ask for more names
+	// until enough of them belong to displayed satellites.
+	for (int limit = maxNbItem; result.size() < maxNbItem; limit *= 4)
 	{
-		if (!sobj->initialized || !sobj->displayed)
+		const QStringList names = StelObjectModule::listMatchingObjects(objPrefix, limit, useStartOfWords, inEnglish);
+		result.clear();
+		for (const auto& name : names)
 		{
-			continue;
+			for (const auto& sat : getByName(name.toUpper(), inEnglish))
+			{
+				if (sat->displayed)
+				{
+					result.append(name);
+					break;
+				}
+			}
+			if (result.size() >= maxNbItem)
+				break;
 		}
+		if (names.size() < limit)
+			break;
+	}
+	result.removeDuplicates();
 
-		QString name = inEnglish ? sobj->getEnglishName() : sobj->getNameI18n();
-		if (matchObjectName(name, objPrefix, useStartOfWords))
-		{
-			result.append(name);
-		}
-		else if (!numberPrefix.isEmpty() && sobj->getCatalogNumberString().startsWith(numberPrefix))
+	if (!numberPrefix.isEmpty() && result.size() < maxNbItem)
+	{
+		// Catalog numbers starting with the prefix are consecutive keys of satellitesByNumber
+		QMutexLocker locker(&searchIndexMutex);
+		buildSearchIndex();
+		for (auto it = satellitesByNumber.lowerBound(numberPrefix); it!=satellitesByNumber.constEnd() && it.key().startsWith(numberPrefix) && result.size() < maxNbItem; ++it)
 		{
-			result.append(QString("NORAD %1").arg(sobj->getCatalogNumberString()));
-		}
-
-		if (result.size() >= maxNbItem)
-		{
-			break;
+			if (it.value()->displayed)
+				result.append(QString("NORAD %1").arg(it.key()));
 		}
 	}
 
@@ -572,6 +615,8 @@ void Satellites::restoreDefaultCatalog()
 {
 	if (QFileInfo(catalogPath).exists())
 		backupCatalog(true);
+	QFile::remove(catalogCachePath);
+	catalogJsonPending = false;
 
 	QFile src(":/satellites/satellites.json");
 	if (!src.copy(catalogPath))
@@ -675,6 +720,13 @@ void Satellites::loadSettings()
 	autoAddEnabled = conf->value("auto_add_enabled", true).toBool();
 	autoRemoveEnabled = conf->value("auto_remove_enabled", true).toBool();
 	iridiumFlaresPredictionDepth = conf->value("flares_prediction_depth", 7).toInt();
+	passesPredictionDepth = conf->value("passes_prediction_depth", 1).toInt();
+	passesMinElevation = conf->value("passes_min_elevation", 10.).toDouble();
+	flagParallelPropagation = conf->value("flag_parallel_propagation", true).toBool();
+	flagBatchPropagation = conf->value("flag_batch_propagation", true).toBool();
+	flagUpdateScheduling = conf->value("flag_update_scheduling", true).toBool();
+	reducedUpdateInterval = conf->value("reduced_update_interval", 2.).toDouble();
+	flagAsyncPropagation = conf->value("flag_async_propagation", true).toBool();
 
 	// Get a font for labels
 	labelFont.setPixelSize(conf->value("hint_font_size", 10).toInt());
@@ -684,6 +736,8 @@ void Satellites::loadSettings()
 	Satellite::orbitLineSegments = conf->value("orbit_line_segments", 90).toInt();
 	Satellite::orbitLineFadeSegments = conf->value("orbit_fade_segments", 5).toInt();
 	Satellite::orbitLineSegmentDuration = conf->value("orbit_segment_duration", 20).toInt();
+	Satellite::orbitLineBuffersFlag = conf->value("flag_orbit_line_buffers", true).toBool();
+	Satellite::magnitudeCurvesFlag = conf->value("flag_magnitude_curves", true).toBool();
 
 	Satellite::invisibleSatelliteColor = StelUtils::strToVec3f(conf->value("invisible_satellite_color", "0.2,0.2,0.2").toString());
 
@@ -709,6 +763,8 @@ void Satellites::saveSettings()
 	conf->setValue("auto_add_enabled", autoAddEnabled);
 	conf->setValue("auto_remove_enabled", autoRemoveEnabled);
 	conf->setValue("flares_prediction_depth", iridiumFlaresPredictionDepth);
+	conf->setValue("passes_prediction_depth", passesPredictionDepth);
+	conf->setValue("passes_min_elevation", passesMinElevation);
 
 	// Get a font for labels
 	conf->setValue("hint_font_size", labelFont.pixelSize());
@@ -731,7 +787,127 @@ void Satellites::saveSettings()
 
 void Satellites::loadCatalog()
 {
-	setDataMap(loadDataMap());
+	if (loadCatalogCache())
+		return;
+
+	const QVariantMap map = loadDataMap();
+	setDataMap(map);
+	catalogJsonPending = false;
+	// Next time, the binary catalog is read instead
+	if (!map.isEmpty())
+		saveCatalogCache(false);
+}
+
+bool Satellites::saveCatalogCache(bool jsonPending)
+{
+	const QFileInfo jsonInfo(catalogPath);
+	if (!jsonInfo.exists())
+		return false;
+
+	QSaveFile file(catalogCachePath);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		qWarning() << "[Satellites] cannot open for writing:" << QDir::toNativeSeparators(catalogCachePath);
+		return false;
+	}
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_5_4);
+	out << CATALOG_CACHE_MAGIC << CATALOG_CACHE_VERSION << QString(SATELLITES_PLUGIN_VERSION);
+	out << (qint64)jsonInfo.lastModified().toMSecsSinceEpoch() << jsonPending;
+	out << defaultHintColor[0] << defaultHintColor[1] << defaultHintColor[2];
+	out << (quint32)satellites.size();
+	for (const auto& sat : satellites)
+		sat->writeCatalogData(out);
+	if (out.status()!=QDataStream::Ok || !file.commit())
+	{
+		qWarning() << "[Satellites] cannot write the binary catalog:" << QDir::toNativeSeparators(catalogCachePath);
+		return false;
+	}
+	return true;
+}
+
+namespace
+{
+	//! Read the header of the binary catalog, and check that it matches the JSON catalog.
+	bool readCatalogCacheHeader(QDataStream& in, const QString& catalogPath, bool& jsonPending)
+	{
+		in.setVersion(QDataStream::Qt_5_4);
+		quint32 magic;
+		qint32 version;
+		QString pluginVersion;
+		qint64 jsonStamp;
+		in >> magic >> version;
+		if (in.status()!=QDataStream::Ok || magic!=CATALOG_CACHE_MAGIC || version!=CATALOG_CACHE_VERSION)
+			return false;
+		in >> pluginVersion >> jsonStamp >> jsonPending;
+		if (in.status()!=QDataStream::Ok || pluginVersion!=SATELLITES_PLUGIN_VERSION)
+			return false;
+		// The JSON catalog was edited or replaced since the binary catalog was written
+		const QFileInfo jsonInfo(catalogPath);
+		return jsonInfo.exists() && jsonInfo.lastModified().toMSecsSinceEpoch()==jsonStamp;
+	}
+}
+
+bool Satellites::isCatalogCacheValid() const
+{
+	QFile file(catalogCachePath);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+	QDataStream in(&file);
+	bool jsonPending;
+	return readCatalogCacheHeader(in, catalogPath, jsonPending);
+}
+
+bool Satellites::loadCatalogCache()
+{
+	waitForPropagation();
+	QFile file(catalogCachePath);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+	QDataStream in(&file);
+	bool jsonPending;
+	if (!readCatalogCacheHeader(in, catalogPath, jsonPending))
+		return false;
+
+	Vec3f hintColor;
+	quint32 count;
+	in >> hintColor[0] >> hintColor[1] >> hintColor[2] >> count;
+	if (in.status()!=QDataStream::Ok)
+		return false;
+	QList<SatelliteP> newSatellites;
+	newSatellites.reserve(count);
+	for (quint32 i=0; i<count; ++i)
+	{
+		Satellite* sat = Satellite::readCatalogData(in);
+		if (in.status()!=QDataStream::Ok)
+		{
+			delete sat;
+			qWarning() << "[Satellites] the binary catalog is damaged, reading" << QDir::toNativeSeparators(catalogPath);
+			return false;
+		}
+		if (sat)
+			newSatellites.append(SatelliteP(sat));
+	}
+	qDebug() << "[Satellites] loaded" << newSatellites.size() << "satellites from the binary catalog";
+
+	if (satelliteListModel)
+		satelliteListModel->beginSatellitesChange();
+	defaultHintColor = hintColor;
+	satellites = newSatellites;
+	groups.clear();
+	for (const auto& sat : satellites)
+	{
+		// As in setDataMap(), when the catalog has no standard magnitude
+		if (sat->stdMag==99. && qsMagList.contains(sat->id))
+			sat->stdMag = qsMagList[sat->id];
+		groups.unite(sat->groups);
+	}
+	qSort(satellites);
+	invalidateSearchIndex();
+	if (satelliteListModel)
+		satelliteListModel->endSatellitesChange();
+	catalogJsonPending = jsonPending;
+	return true;
 }
 
 const QString Satellites::readCatalogVersion()
@@ -821,6 +997,7 @@ QVariantMap Satellites::loadDataMap(QString path)
 
 void Satellites::setDataMap(const QVariantMap& map)
 {
+	waitForPropagation();
 	int numReadOk = 0;
 	QVariantList defaultHintColorMap;
 	defaultHintColorMap << defaultHintColor[0] << defaultHintColor[1] << defaultHintColor[2];
@@ -859,6 +1036,7 @@ void Satellites::setDataMap(const QVariantMap& map)
 		}
 	}
 	qSort(satellites);
+	invalidateSearchIndex();
 	
 	if (satelliteListModel)
 		satelliteListModel->endSatellitesChange();
@@ -955,12 +1133,46 @@ SatellitesListModel* Satellites::getSatellitesListModel()
 
 SatelliteP Satellites::getById(const QString& id) const
 {
+	QMutexLocker locker(&searchIndexMutex);
+	buildSearchIndex();
+	return satellitesById.value(id);
+}
+
+QList<SatelliteP> Satellites::getByName(const QString& upperName, bool inEnglish) const
+{
+	QMutexLocker locker(&searchIndexMutex);
+	buildSearchIndex();
+	return satellitesByName[inEnglish ? 1 : 0].value(upperName);
+}
+
+void Satellites::buildSearchIndex() const
+{
+	if (searchIndexValid)
+		return;
 	for (const auto& sat : satellites)
 	{
-		if (sat->initialized && sat->id == id)
-			return sat;
+		if (!sat->initialized)
+			continue;
+		satellitesByName[0][sat->getNameI18n().toUpper()].append(sat);
+		satellitesByName[1][sat->getEnglishName().toUpper()].append(sat);
+		satellitesByNumber.insert(sat->getCatalogNumberString(), sat);
+		satellitesById.insert(sat->id, sat);
 	}
-	return SatelliteP();
+	searchIndexValid = true;
+}
+
+void Satellites::invalidateSearchIndex()
+{
+	{
+		QMutexLocker locker(&searchIndexMutex);
+		searchIndexValid = false;
+		satellitesByName[0].clear();
+		satellitesByName[1].clear();
+		satellitesByNumber.clear();
+		satellitesById.clear();
+	}
+	directionIndex.clear();
+	invalidateNameIndex();
 }
 
 QStringList Satellites::listAllIds() const
@@ -1009,6 +1221,7 @@ bool Satellites::add(const TleData& tleData)
 		qDebug() << "[Satellites] satellite added:" << tleData.id << tleData.name;
 		satellites.append(sat);
 		sat->setNew();
+		invalidateSearchIndex();
 		return true;
 	}
 	return false;
@@ -1016,6 +1229,7 @@ bool Satellites::add(const TleData& tleData)
 
 void Satellites::add(const TleDataList& newSatellites)
 {
+	waitForPropagation();
 	if (satelliteListModel)
 		satelliteListModel->beginSatellitesChange();
 	
@@ -1041,6 +1255,7 @@ void Satellites::add(const TleDataList& newSatellites)
 
 void Satellites::remove(const QStringList& idList)
 {
+	waitForPropagation();
 	if (satelliteListModel)
 		satelliteListModel->beginSatellitesChange();
 	
@@ -1062,6 +1277,8 @@ void Satellites::remove(const QStringList& idList)
 		}
 	}
 	// As the satellite list is kept sorted, no need for re-sorting.
+	if (numRemoved > 0)
+		invalidateSearchIndex();
 	
 	if (satelliteListModel)
 		satelliteListModel->endSatellitesChange();
@@ -1265,7 +1482,8 @@ void Satellites::updateFromOnlineSources()
 	for (auto url : updateUrls)
 	{
 		TleSource source;
-		source.file = 0;
+		source.reply = Q_NULLPTR;
+		source.complete = false;
 		source.addNew = false;
 		if (url.startsWith("1,"))
 		{
@@ -1280,84 +1498,87 @@ void Satellites::updateFromOnlineSources()
 		source.url.setUrl(url);
 		if (source.url.isValid())
 		{
+			// The lists are parsed while they are downloaded, except ZIP archives
+			source.tleSets.reset(new TleDataHash());
+			if (!url.contains(".zip", Qt::CaseInsensitive))
+				source.parser.reset(new TleStreamParser(*source.tleSets, source.addNew, source.url.toString(QUrl::RemoveUserInfo)));
+			source.reply = downloadMgr->get(QNetworkRequest(source.url));
+			connect(source.reply, SIGNAL(readyRead()), this, SLOT(readDownloadedData()));
 			updateSources.append(source);
-			downloadMgr->get(QNetworkRequest(source.url));
+		}
+	}
+}
+
+void Satellites::readDownloadedData()
+{
+	QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+	if (!reply)
+		return;
+	for (auto& source : updateSources)
+	{
+		if (source.reply==reply)
+		{
+			if (source.parser)
+				source.parser->addData(reply->readAll());
+			else
+				source.archive.append(reply->readAll());
+			return;
 		}
 	}
 }
 
 void Satellites::saveDownloadedUpdate(QNetworkReply* reply)
 {
-	// check the download worked, and save the data to file if this is the case.
-	if (reply->error() == QNetworkReply::NoError && reply->bytesAvailable()>0)
+	TleSource* source = Q_NULLPTR;
+	for (auto& s : updateSources)
+	{
+		if (s.reply==reply)
+		{
+			source = &s;
+			break;
+		}
+	}
+	reply->deleteLater();
+	if (!source) // Something strange just happened...
+		return;
+	source->reply = Q_NULLPTR;
+
+	// check the download worked, and parse the rest of the data if this is the case.
+	if (reply->error() == QNetworkReply::NoError)
 	{
 		// download completed successfully.
-		QString name = QString("tle%1.txt").arg(numberDownloadsComplete);
-		QString path = dataDir.absoluteFilePath(name);
-		// QFile as a child object to the plugin to ease memory management
-		QFile* tmpFile = new QFile(path, this);
-		if (tmpFile->exists())
-			tmpFile->remove();
-
-		if (tmpFile->open(QIODevice::WriteOnly | QIODevice::Text))
+		if (source->parser)
 		{
-			QByteArray fd = reply->readAll();
-			// qWarning() << "[Satellites] Processing an URL:" << reply->url().toString();
-			if (reply->url().toString().contains(".zip", Qt::CaseInsensitive))
+			source->parser->addData(reply->readAll());
+			source->parser->finish();
+		}
+		else
+		{
+			source->archive.append(reply->readAll());
+			// qWarning() << "[Satellites] Processing a ZIP archive...";
+			QBuffer buffer(&source->archive);
+			buffer.open(QIODevice::ReadOnly);
+			Stel::QZipReader reader(&buffer);
+			if (reader.status() != Stel::QZipReader::NoError)
+				qWarning() << "[Satellites] Unable to open as a ZIP archive";
+			else
 			{
-				QTemporaryFile zip;
-				if (zip.open())
+				TleStreamParser parser(*source->tleSets, source->addNew, source->url.toString(QUrl::RemoveUserInfo));
+				QList<Stel::QZipReader::FileInfo> infoList = reader.fileInfoList();
+				for (const auto& info : infoList)
 				{
-					// qWarning() << "[Satellites] Processing a ZIP archive...";
-					zip.write(fd);
-					zip.close();
-					QString archive = zip.fileName();
-					QByteArray data;
-
-					Stel::QZipReader reader(archive);
-					if (reader.status() != Stel::QZipReader::NoError)
-						qWarning() << "[Satellites] Unable to open as a ZIP archive";
-					else
+					// qWarning() << "[Satellites] Processing:" << info.filePath;
+					if (info.isFile)
 					{
-						QList<Stel::QZipReader::FileInfo> infoList = reader.fileInfoList();
-						for (const auto& info : infoList)
-						{
-							// qWarning() << "[Satellites] Processing:" << info.filePath;
-							if (info.isFile)
-								data.append(reader.fileData(info.filePath));
-						}
-						// qWarning() << "[Satellites] Extracted data:" << data;
-						fd = data;
+						parser.addData(reader.fileData(info.filePath));
+						parser.finish();
 					}
-					reader.close();
-					zip.remove();
 				}
-				else
-					qWarning() << "[Satellites] Unable to open a temporary file";
 			}
-			tmpFile->write(fd);
-			tmpFile->close();
-			
-			// The reply URL can be different form the requested one...
-			QUrl url = reply->request().url();
-			for (int i = 0; i < updateSources.count(); i++)
-			{
-				if (updateSources[i].url == url)
-				{
-					updateSources[i].file = tmpFile;
-					tmpFile = 0;
-					break;
-				}
-			}
-			if (tmpFile) // Something strange just happened...
-				delete tmpFile; // ...so we have to clean.
-		}
-		else
-		{
-			qWarning() << "[Satellites] cannot save update file:"
-			           << tmpFile->error()
-			           << tmpFile->errorString();
+			reader.close();
+			source->archive.clear();
 		}
+		source->complete = true;
 	}
 	else
 		qWarning() << "[Satellites] FAILED to download" << reply->url().toString(QUrl::RemoveUserInfo) << "Error:" << reply->errorString();
@@ -1378,19 +1599,16 @@ void Satellites::saveDownloadedUpdate(QNetworkReply* reply)
 	}
 	
 	// All files have been downloaded, finish the update
+	// The lists are merged in their order, as parseTleFile() does for several files
 	TleDataHash newData;
-	for (int i = 0; i < updateSources.count(); i++)
+	for (const auto& s : updateSources)
 	{
-		if (!updateSources[i].file)
+		if (!s.complete)
 			continue;
-		if (updateSources[i].file->open(QFile::ReadOnly|QFile::Text))
+		for (auto it = s.tleSets->constBegin(); it != s.tleSets->constEnd(); ++it)
 		{
-			parseTleFile(*updateSources[i].file,
-			             newData,
-			             updateSources[i].addNew);
-			updateSources[i].file->close();
-			delete updateSources[i].file;
-			updateSources[i].file = 0;
+			if (it.value().addThis || !newData.contains(it.key()))
+				newData.insert(it.key(), it.value());
 		}
 	}
 	updateSources.clear();	
@@ -1400,6 +1618,10 @@ void Satellites::saveDownloadedUpdate(QNetworkReply* reply)
 
 void Satellites::updateObserverLocation(StelLocation)
 {
+	waitForPropagation();
+	// The horizon moved, the satellites below it must be checked again
+	for (const auto& sat : satellites)
+		sat->resetPropagationSchedule();
 	recalculateOrbitLines();
 }
 
@@ -1430,7 +1652,16 @@ void Satellites::displayMessage(const QString& message, const QString hexColor)
 
 void Satellites::saveCatalog(QString path)
 {
-	saveDataMap(createDataMap(), path);
+	if (!path.isEmpty() && QFileInfo(path)!=QFileInfo(catalogPath))
+	{
+		saveDataMap(createDataMap(), path);
+		return;
+	}
+	if (saveDataMap(createDataMap()))
+	{
+		catalogJsonPending = false;
+		saveCatalogCache(false);
+	}
 }
 
 void Satellites::updateFromFiles(QStringList paths, bool deleteFiles)
@@ -1455,6 +1686,7 @@ void Satellites::updateFromFiles(QStringList paths, bool deleteFiles)
 
 void Satellites::updateSatellites(TleDataHash& newTleSets)
 {
+	waitForPropagation();
 	// Save the update time.
 	// One of the reasons it's here is that lastUpdate is used below.
 	markLastUpdate();
@@ -1512,8 +1744,11 @@ void Satellites::updateSatellites(TleDataHash& newTleSets)
 				sat->lastUpdated = lastUpdate;
 				updatedCount++;
 			}
-			if (qsMagList.contains(id))
+			if (qsMagList.contains(id) && sat->stdMag!=qsMagList[id])
+			{
 				sat->stdMag = qsMagList[id];
+				sat->resetPropagationSchedule(); // for the magnitude curve
+			}
 
 		}
 		else
@@ -1548,6 +1783,8 @@ void Satellites::updateSatellites(TleDataHash& newTleSets)
 	}
 	if (addedCount)
 		qSort(satellites);
+	// The names may have been updated
+	invalidateSearchIndex();
 	
 	if (autoRemoveEnabled && !toBeRemoved.isEmpty())
 	{
@@ -1558,7 +1795,12 @@ void Satellites::updateSatellites(TleDataHash& newTleSets)
 	if (updatedCount > 0 ||
 	        (autoRemoveEnabled && missingCount > 0))
 	{
-		saveDataMap(createDataMap());
+		// Writing the JSON catalog takes long with large catalogs:
+		// only the binary catalog is saved now, and the JSON catalog on exit.
+		if (saveCatalogCache(true))
+			catalogJsonPending = true;
+		else
+			saveCatalog();
 		updateState = CompleteUpdates;
 	}
 	else
@@ -1577,104 +1819,18 @@ void Satellites::updateSatellites(TleDataHash& newTleSets)
 	emit(tleUpdateComplete(updatedCount, totalCount, addedCount, missingCount));
 }
 
-void Satellites::parseTleFile(QFile& openFile,
+void Satellites::parseTleFile(QIODevice& openFile,
                               TleDataHash& tleList,
                               bool addFlagValue)
 {
 	if (!openFile.isOpen() || !openFile.isReadable())
 		return;
-	
-	// Code mostly re-used from updateFromFiles()
-	int lineNumber = 0;
-	TleData lastData;
-	lastData.addThis = addFlagValue;
-	
-	while (!openFile.atEnd())
-	{
-		QString line = QString(openFile.readLine()).trimmed();
-		if (line.length() < 65) // this is title line
-		{
-			// New entry in the list, so reset all fields
-			lastData = TleData();
-			lastData.addThis = addFlagValue;
-			
-			// The thing in square brackets after the name is actually
-			// Celestrak's "status code". Parse it!
-			QStringList codes;
-			codes << "+" << "-" << "P" << "B" << "S" << "X" << "D" << "?";
-
-			QRegExp statusRx("\\s*\\[(\\D{1})\\]\\s*$");
-			statusRx.setMinimal(true);
-			if (statusRx.indexIn(line)>-1)
-			{
-				lastData.status = Satellite::StatusUnknown;
-				switch (codes.indexOf(statusRx.capturedTexts().at(1).toUpper()))
-				{
-					case 0:
-						lastData.status = Satellite::StatusOperational;
-						break;
-					case 1:
-						lastData.status = Satellite::StatusNonoperational;
-						break;
-					case 2:
-						lastData.status = Satellite::StatusPartiallyOperational;
-						break;
-					case 3:
-						lastData.status = Satellite::StatusStandby;
-						break;
-					case 4:
-						lastData.status = Satellite::StatusSpare;
-						break;
-					case 5:
-						lastData.status = Satellite::StatusExtendedMission;
-						break;
-					case 6:
-						lastData.status = Satellite::StatusDecayed;
-						break;
-					default:
-						lastData.status = Satellite::StatusUnknown;
-				}
-			}
 
-			//TODO: We need to think of some kind of ecaping these
-			//characters in the JSON parser. --BM
-			line.replace(QRegExp("\\s*\\[([^\\]])*\\]\\s*$"),"");  // remove "status code" from name
-			lastData.name = line;
-		}
-		else
-		{
-			// TODO: Yet another place suitable for a standard TLE regex. --BM
-			if (QRegExp("^1 .*").exactMatch(line))
-				lastData.first = line;
-			else if (QRegExp("^2 .*").exactMatch(line))
-			{
-				lastData.second = line;
-				// The Satellite Catalog Number is the second number
-				// on the second line.
-				QString id = line.split(' ').at(1).trimmed();
-				if (id.isEmpty())
-					continue;
-				lastData.id = id;
-				
-				// This is the second line and there will be no more,
-				// so if everything is OK, save the elements.
-				if (!lastData.name.isEmpty() &&	!lastData.first.isEmpty())
-				{
-					// Some satellites can be listed in multiple files,
-					// and only some of those files may be marked for adding,
-					// so try to preserve the flag - if it's set,
-					// feel free to overwrite the existing value.
-					// If not, overwrite only if it's not in the list already.
-					// NOTE: Second case overwrite may need to check which TLE set is newer. 
-					if (lastData.addThis || !tleList.contains(id))
-						tleList.insert(id, lastData); // Overwrite if necessary
-				}
-				//TODO: Error warnings? --BM
-			}
-			else
-				qDebug() << "[Satellites] unprocessed line " << lineNumber <<  " in file " << QDir::toNativeSeparators(openFile.fileName());
-		}
-	}
+	QFile* file = qobject_cast<QFile*>(&openFile);
+	TleStreamParser parser(tleList, addFlagValue, file ? QDir::toNativeSeparators(file->fileName()) : QString());
+	while (!openFile.atEnd())
+		parser.addData(openFile.read(65536));
+	parser.finish();
 }
 
 void Satellites::parseQSMagFile(QString qsMagFile)
@@ -1706,6 +1862,9 @@ void Satellites::parseQSMagFile(QString qsMagFile)
 
 void Satellites::update(double deltaTime)
 {
+	// The previous propagation is normally finished by draw()
+	waitForPropagation();
+
 	// Separated because first test should be very fast.
 	if (!hintFader && hintFader.getInterstate() <= 0.)
 		return;
@@ -1720,15 +1879,143 @@ void Satellites::update(double deltaTime)
 
 	hintFader.update((int)(deltaTime*1000));
 
+	// The observer and the Sun are computed once for all satellites, which can then be propagated in parallel.
+	gSatWrapper::prepareEpoch(core->getJD());
+	const double jd = gSatWrapper::getEpoch().getGmtTm();
+	const QList<StelObjectP> selected = GETSTELMODULE(StelObjectMgr)->getSelectedObject("Satellite");
+	Satellite* selectedSat = selected.isEmpty() ? Q_NULLPTR : static_cast<Satellite*>(selected.first().data());
+
+	// Only the satellites in view need their visibility and phase angle, plus the selected one for its info.
+	// Those in the central half of the view, and the selected one, are propagated at every update.
+	const SphericalCap viewportCap = core->getProjection(StelCore::FrameAltAz, StelCore::RefractionOff)->getBoundingCap();
+	const SphericalCap centreCap(viewportCap.n, std::cos(0.5*std::acos(qBound(-1., viewportCap.d, 1.))));
+
+	enum UpdateMode { Propagate, Extrapolate, Skip };
+	struct ActiveSatellite
+	{
+		Satellite* sat;
+		int batchIndex;		// index in nearEarthBatch, -1 if it is propagated alone
+		UpdateMode mode;
+	};
+	QVector<ActiveSatellite> active;
+	active.reserve(satellites.size());
+	QVector<const Satellite*> batchable;
+	QVector<unsigned int> serials;
 	for (const auto& sat : satellites)
 	{
-		if (sat->initialized && sat->displayed)
-			sat->update(deltaTime);
+		if (!sat->initialized || !sat->displayed || !sat->orbitValid || !sat->pSatWrapper)
+			continue;
+		if (sat->orbitDisplayed)
+			pendingOrbits.append(sat.data());
+		const elsetrec* satrec = sat->pSatWrapper->getSatrec();
+		const bool inBatch = flagBatchPropagation && satrec && gSatNearEarthBatch::isSupported(*satrec);
+		if (inBatch)
+		{
+			batchable.append(sat.data());
+			serials.append(sat->pSatWrapper->getSerial());
+		}
+		if (sat.data()==selectedSat)
+		{
+			// Other modules read the selected satellite before draw(), e.g. to track it: it is updated now,
+			// alone, and it stays in the batch so that selecting it does not rebuild the batch.
+			selectedSat->propagate(viewportCap, true);
+			if (flagUpdateScheduling)
+				selectedSat->scheduleNextPropagation(true, reducedUpdateInterval);
+			continue;
+		}
+		ActiveSatellite entry = {sat.data(), inBatch ? batchable.size()-1 : -1, Propagate};
+		if (flagUpdateScheduling && !sat->isPropagationDue(jd))
+			entry.mode = sat->isSleeping() ? Skip : Extrapolate;
+		active.append(entry);
+	}
+
+	// The coefficients are copied again only when the set of satellites or their TLE change
+	if (batchable!=batchSatellites || serials!=batchSerials)
+	{
+		QVector<const elsetrec*> satrecs;
+		satrecs.reserve(batchable.size());
+		for (const auto* sat : batchable)
+			satrecs.append(sat->pSatWrapper->getSatrec());
+		nearEarthBatch.build(satrecs);
+		batchSatellites = batchable;
+		batchSerials = serials;
+	}
+
+	// The blocks of the batch with satellites to propagate are processed first
+	QVector<bool> blockDue((nearEarthBatch.size()+gSatNearEarthBatch::LANES-1)/gSatNearEarthBatch::LANES, false);
+	int propagated = 0;
+	for (const auto& entry : active)
+	{
+		if (entry.mode!=Propagate)
+			continue;
+		++propagated;
+		if (entry.batchIndex>=0)
+			blockDue[entry.batchIndex/gSatNearEarthBatch::LANES] = true;
+	}
+	StelFrameProfiler::count(StelFrameProfiler::SatellitesPropagated, propagated);
+	QVector<int> blocks;
+	for (int b=0; b<blockDue.size(); ++b)
+	{
+		if (blockDue.at(b))
+			blocks.append(b*gSatNearEarthBatch::LANES);
+	}
+
+	// Below this number, the overhead of the thread pool is not worth it
+	static const int MIN_PARALLEL_SATELLITES = 256;
+	const bool parallel = flagParallelPropagation && QThreadPool::globalInstance()->maxThreadCount()>1;
+	gSatNearEarthBatch* batch = &nearEarthBatch;
+	const bool scheduling = flagUpdateScheduling;
+	const double interval = reducedUpdateInterval;
+
+	// Only the state of each satellite, the batch and the epoch prepared above are used from here,
+	// so that this can run on simulationThread until waitForPropagation().
+	auto simulate = [active, blocks, viewportCap, centreCap, batch, jd, parallel, scheduling, interval]() mutable {
+		auto propagateBlock = [batch, jd](int begin) { batch->propagate(jd, begin, begin+gSatNearEarthBatch::LANES); };
+		if (parallel && blocks.size()*gSatNearEarthBatch::LANES>=MIN_PARALLEL_SATELLITES)
+			QtConcurrent::blockingMap(blocks, propagateBlock);
+		else
+			std::for_each(blocks.begin(), blocks.end(), propagateBlock);
+
+		auto updateSatellite = [&viewportCap, &centreCap, batch, scheduling, interval](const ActiveSatellite& entry) {
+			Satellite* sat = entry.sat;
+			if (entry.mode==Extrapolate)
+				sat->extrapolate(viewportCap);
+			else if (entry.mode==Propagate)
+			{
+				sat->propagate(viewportCap, false, entry.batchIndex<0 ? Q_NULLPTR : batch, entry.batchIndex);
+				if (scheduling)
+					sat->scheduleNextPropagation(centreCap.contains(sat->elAzPosition), interval);
+			}
+		};
+		if (parallel && active.size()>=MIN_PARALLEL_SATELLITES)
+			QtConcurrent::blockingMap(active, updateSatellite);
+		else
+			std::for_each(active.begin(), active.end(), updateSatellite);
+	};
+
+	if (flagAsyncPropagation)
+		propagation = QtConcurrent::run(&simulationThread, simulate);
+	else
+	{
+		simulate();
+		waitForPropagation();
 	}
 }
 
+void Satellites::waitForPropagation() const
+{
+	propagation.waitForFinished();
+	// The orbit lines change the epoch of the shared state, so they are computed after all positions
+	for (auto* sat : pendingOrbits)
+		sat->computeOrbitPoints();
+	pendingOrbits.clear();
+}
+
 void Satellites::draw(StelCore* core)
 {
+	// Finish the propagation started by update()
+	waitForPropagation();
+
 	// Separated because first test should be very fast.
 	if (!hintFader && hintFader.getInterstate() <= 0.)
 		return;
@@ -1747,11 +2034,22 @@ void Satellites::draw(StelCore* core)
 	painter.setBlending(true);
 	Satellite::hintTexture->bind();
 	Satellite::viewportHalfspace = painter.getProjector()->getBoundingCap();
+	// The hints of all satellites are merged in a few draw calls, and the labels are drawn by the text atlas
+	painter.setBatching(true);
+	StelSkyDrawer* skyDrawer = core->getSkyDrawer();
+	if (Satellite::realisticModeFlag)
+		skyDrawer->preDrawPointSource(&painter);
 	for (const auto& sat : satellites)
 	{
 		if (sat && sat->initialized && sat->displayed)
 			sat->draw(core, painter);
 	}
+	if (Satellite::realisticModeFlag)
+	{
+		StelPainter::submitBatch();
+		skyDrawer->postDrawPointSource(&painter);
+	}
+	directionIndex.update(satellites);
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
 		drawPointer(core, painter);
@@ -1827,9 +2125,51 @@ bool Satellites::isValidRangeDates(const StelCore *core) const
 		return true;
 }
 
+SatellitePassList Satellites::computePasses(int days, double minElevation, bool visibleOnly)
+{
+	waitForPropagation();
+	StelCore* core = StelApp::getInstance().getCore();
+	if (core->getCurrentPlanet()!=earth)
+		return SatellitePassList();
+
+	QList<SatelliteP> displayed;
+	for (const auto& sat : satellites)
+	{
+		if (sat->initialized && sat->displayed)
+			displayed.append(sat);
+	}
+	SatellitePassList passes = passPredictor.predict(displayed, core->getCurrentLocation(), core->getJD(), days,
+							 minElevation*M_PI/180., flagParallelPropagation);
+	if (visibleOnly)
+	{
+		SatellitePassList visible;
+		for (const auto& pass : passes)
+		{
+			if (pass.visibleDuration>0.)
+				visible.append(pass);
+		}
+		return visible;
+	}
+	return passes;
+}
+
+SatellitePassList Satellites::getPassesPrediction(bool visibleOnly)
+{
+	return computePasses(passesPredictionDepth, passesMinElevation, visibleOnly);
+}
+
+QVariantList Satellites::predictPasses(int days, double minElevation, bool visibleOnly)
+{
+	QVariantList result;
+	for (const auto& pass : computePasses(days, minElevation, visibleOnly))
+		result.append(SatellitePassPredictor::toVariantMap(pass));
+	return result;
+}
+
 #ifdef _OLD_IRIDIUM_PREDICTIONS
 IridiumFlaresPredictionList Satellites::getIridiumFlaresPrediction()
 {
+	waitForPropagation();
 	StelCore* pcore = StelApp::getInstance().getCore();
 	double currentJD = pcore->getJD(); // save current JD
 	bool isTimeNow = pcore->getIsTimeNow();
@@ -1910,6 +2250,7 @@ struct SatDataStruct {
 
 IridiumFlaresPredictionList Satellites::getIridiumFlaresPrediction()
 {
+	waitForPropagation();
 	StelCore* pcore = StelApp::getInstance().getCore();
 	SolarSystem* ssystem = (SolarSystem*)StelApp::getInstance().getModuleMgr().getModule("SolarSystem");
 
@@ -22,6 +22,9 @@
 
 #include "StelObjectModule.hpp"
 #include "Satellite.hpp"
+#include "SatellitePassPredictor.hpp"
+#include "SatelliteDirectionIndex.hpp"
+#include "TleStreamParser.hpp"
 #include "StelFader.hpp"
 #include "StelGui.hpp"
 #include "StelDialog.hpp"
@@ -30,6 +33,11 @@
 #include <QDateTime>
 #include <QFile>
 #include <QDir>
+#include <QFuture>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QThreadPool>
 #include <QUrl>
 #include <QVariantMap>
 
@@ -87,36 +95,23 @@ file.
 @}
 */
 
-//! Data structure containing unvalidated TLE set as read from a TLE list file.
-//! @ingroup satellites
-struct TleData
-{
-	//! NORAD catalog number, as extracted from the TLE set.
-	QString id;
-	//! Human readable name, as extracted from the TLE title line.
-	QString name;
-	QString first;
-	QString second;
-	int status;
-	//! Flag indicating whether this satellite should be added.
-	//! See Satellites::autoAddEnabled.
-	bool addThis;
-};
-
-//! @ingroup satellites
-typedef QList<TleData> TleDataList;
-//! @ingroup satellites
-typedef QHash<QString, TleData> TleDataHash ;
-
 //! TLE update source, used only internally for now.
 //! @ingroup satellites
 struct TleSource
 {
 	//! URL from where the source list should be downloaded.
 	QUrl url;
-	//! The downloaded file, location set after finishing download.
-	//! In the future may be a QTemporaryFile object.
-	QFile* file;
+	//! The download of the list, Q_NULLPTR once it is finished.
+	QNetworkReply* reply;
+	//! The TLE sets parsed from the list while it is downloaded.
+	//! A list which was not downloaded completely is not used.
+	QSharedPointer<TleDataHash> tleSets;
+	//! The parser of the downloaded data, Q_NULLPTR for ZIP archives.
+	QSharedPointer<TleStreamParser> parser;
+	//! The data of a ZIP archive, which can be parsed only when complete.
+	QByteArray archive;
+	//! Set when the list was downloaded and parsed without error.
+	bool complete;
 	//! Flag indicating whether new satellites in this list should be added.
 	//! See Satellites::autoAddEnabled.
 	bool addNew;
@@ -346,12 +341,11 @@ public:
 	//! Reads a TLE list from a file to the supplied hash.
 	//! If an entry with the same ID exists in the given hash, its contents
 	//! are overwritten with the new values.
-	//! \param openFile a reference to an \b open file.
+	//! See TleStreamParser to parse the data as it arrives.
+	//! \param openFile a reference to an \b open file or other device.
 	//! @param[in,out] tleList a hash with satellite IDs as keys.
 	//! @param[in] addFlagValue value to be set to TleData::addThis for all.
-	//! @todo If this can accept a QIODevice, it will be able to read directly
-	//! QNetworkReply-s... --BM
-	static void parseTleFile(QFile& openFile,
+	static void parseTleFile(QIODevice& openFile,
 	                         TleDataHash& tleList,
 				 bool addFlagValue = false);
 
@@ -378,6 +372,17 @@ public:
 
 	IridiumFlaresPredictionList getIridiumFlaresPrediction();
 
+	//! Get depth of prediction for satellite passes, in days
+	int getPassesPredictionDepth(void) const { return passesPredictionDepth; }
+	//! Get the minimum elevation of the predicted passes, in degrees
+	double getPassesMinElevation(void) const { return passesMinElevation; }
+
+	//! Predict the passes of the displayed satellites over the current location, from the current date
+	//! and for getPassesPredictionDepth() days. The passes are cached, see SatellitePassPredictor.
+	//! @param visibleOnly keep only the passes during which the satellite is sunlit while the Sun is below the horizon
+	//! @return the passes sorted by AOS
+	SatellitePassList getPassesPrediction(bool visibleOnly=false);
+
 signals:
 	void hintsVisibleChanged(bool b);
 	void labelsVisibleChanged(bool b);
@@ -473,9 +478,26 @@ public slots:
 	//! @param depth in days
 	void setIridiumFlaresPredictionDepth(int depth) { iridiumFlaresPredictionDepth=depth; }
 
+	//! Set depth of prediction for satellite passes
+	//! @param depth in days
+	void setPassesPredictionDepth(int depth) { passesPredictionDepth=depth; }
+	//! Set the minimum elevation of the predicted passes
+	//! @param elevation in degrees
+	void setPassesMinElevation(double elevation) { passesMinElevation=elevation; }
+
+	//! Predict the passes of the displayed satellites over the current location, from the current date.
+	//! This is the variant of getPassesPrediction() for scripts and the remote control.
+	//! @param days depth of the prediction
+	//! @param minElevation minimum elevation in degrees
+	//! @param visibleOnly keep only the passes during which the satellite is sunlit while the Sun is below the horizon
+	//! @return a list of maps sorted by AOS, see SatellitePassPredictor::toVariantMap() for their keys
+	QVariantList predictPasses(int days=1, double minElevation=10., bool visibleOnly=true);
+
 private slots:
 	//! Update satellites visibility on wide range of dates changes - by month or year
 	void updateSatellitesVisibility();
+	//! Clear the indices used by the search functions, when the list of satellites or their names change.
+	void invalidateSearchIndex();
 
 private:
 	//! Add to the current collection the satellite described by the data.
@@ -518,6 +540,18 @@ private:
 	//! Make a satellite catalog structure from current satellite data.
 	//! @return a representation of a JSON file.
 	QVariantMap createDataMap();
+
+	//! Save the satellites to the binary catalog (catalogCachePath).
+	//! The binary catalog records the modification time of the JSON catalog it matches,
+	//! and it is used by loadCatalog() only while the JSON catalog keeps this time.
+	//! @param jsonPending true if the satellites have changes not saved to the JSON catalog yet
+	bool saveCatalogCache(bool jsonPending);
+	//! Load the satellites from the binary catalog, if it matches the JSON catalog.
+	//! Removes existing satellites first if the binary catalog can be used.
+	//! @return false if the JSON catalog must be read
+	bool loadCatalogCache();
+	//! Check whether the binary catalog matches the current JSON catalog, without loading it.
+	bool isCatalogCacheValid() const;
 	
 	//! Sets lastUpdate to the current date/time and saves it to the settings.
 	void markLastUpdate();
@@ -536,10 +570,12 @@ private:
 	QString qsMagFilePath;
 	//! Path to the satellite catalog file.
 	QString catalogPath;
+	//! Path to the binary copy of the catalog, see saveCatalogCache().
+	QString catalogCachePath;
 	//! Plug-in data directory.
 	//! Intialized by init(). Contains the catalog file (satellites.json),
-	//! temporary TLE lists downloaded during an online update, or whatever
-	//! other modifiable files the plug-in needs.
+	//! its binary copy (satellites.dat), or whatever other modifiable files
+	//! the plug-in needs.
 	QDir dataDir;
 	
 	QList<SatelliteP> satellites;
@@ -555,6 +591,32 @@ private:
 	
 	LinearFader hintFader;
 	StelTextureSP texPointer;
+	//! Propagate the satellites on the global thread pool (Satellites/flag_parallel_propagation).
+	bool flagParallelPropagation;
+	//! Propagate the near-earth satellites together with gSatNearEarthBatch (Satellites/flag_batch_propagation).
+	bool flagBatchPropagation;
+	gSatNearEarthBatch nearEarthBatch;
+	//! The satellites in nearEarthBatch, and the serial of their gSatWrapper when it was built.
+	QVector<const Satellite*> batchSatellites;
+	QVector<unsigned int> batchSerials;
+	//! Skip the satellites well below the horizon until they can rise, and propagate those far from
+	//! the centre of the view at a reduced rate (Satellites/flag_update_scheduling).
+	bool flagUpdateScheduling;
+	//! Interval between the propagations at reduced rate, in seconds of simulation time
+	//! (Satellites/reduced_update_interval). The positions are extrapolated in between.
+	double reducedUpdateInterval;
+	//! Propagate the satellites on simulationThread while the other modules are updated and drawn,
+	//! from update() to draw() (Satellites/flag_async_propagation).
+	bool flagAsyncPropagation;
+	//! A dedicated thread running the propagation started by update(). It dispatches the blocks of
+	//! satellites to the global thread pool when flagParallelPropagation is set.
+	QThreadPool simulationThread;
+	mutable QFuture<void> propagation;
+	//! Satellites whose orbit line must be updated after the propagation, on the main thread.
+	mutable QVector<Satellite*> pendingOrbits;
+	//! Wait for the end of the propagation started by update(), and update the orbit lines.
+	//! Must be called before reading or changing the state of the satellites on the main thread.
+	void waitForPropagation() const;
 	
 	//! @name Bottom toolbar button
 	//@{
@@ -595,6 +657,9 @@ private:
 	bool autoAddEnabled;
 	//! Flag enabling the automatic removal of missing satellites on update.
 	bool autoRemoveEnabled;
+	//! Set when the updates are saved only to the binary catalog, see saveCatalogCache().
+	//! The JSON catalog is then written by deinit().
+	bool catalogJsonPending;
 	QDateTime lastUpdate;
 	int updateFrequencyHours;
 	//@}
@@ -605,6 +670,29 @@ private:
 	//@}
 
 	int iridiumFlaresPredictionDepth;
+	int passesPredictionDepth;
+	double passesMinElevation;
+	SatellitePassPredictor passPredictor;
+
+	//! @name Search indices
+	//! Lookup tables of the initialized satellites, built on the first search after invalidateSearchIndex().
+	//! The search dialog queries them from a worker thread, hence searchIndexMutex.
+	//@{
+	//! Build the lookup tables if needed. searchIndexMutex must be locked.
+	void buildSearchIndex() const;
+	//! Get the satellites with a name, translated (false) or English (true), in upper case.
+	QList<SatelliteP> getByName(const QString& upperName, bool inEnglish) const;
+	mutable QMutex searchIndexMutex;
+	mutable bool searchIndexValid;
+	mutable QHash<QString, QList<SatelliteP> > satellitesByName[2];
+	mutable QMultiMap<QString, SatelliteP> satellitesByNumber;
+	mutable QHash<QString, SatelliteP> satellitesById;
+	//! Directions of the satellites drawn in the last frame, for searchAround().
+	SatelliteDirectionIndex directionIndex;
+	//@}
+	//! Predict the passes of the displayed satellites from the current date.
+	//! @param minElevation in degrees
+	SatellitePassList computePasses(int days, double minElevation, bool visibleOnly);
 
 	// GUI
 	SatellitesDialog* configDialog;
@@ -614,14 +702,12 @@ private slots:
 	//! if the last update was longer than updateFrequencyHours ago then the update is
 	//! done.
 	void checkForUpdate(void);
-	//! Save the downloaded file and finish the update if it's the last one.
+	//! Parse the data received for a TLE list with its TleStreamParser.
+	void readDownloadedData();
+	//! Finish the parsing of a downloaded list, and finish the update if it's the last one.
 	//! Calls updateSatellites() and indirectly emits updateStateChanged()
 	//! and updateFinished().
 	//! Ends the update process started with updateFromOnlineSources().
-	//! @todo I've kept the previous behaviour, which was to save the update to
-	//! temporary files and then read them. If we give up on the idea to
-	//! re-use them later when adding manually satellites, parseTleFile()
-	//! can be modified to read directly form QNetworkReply-s. --BM
 	void saveDownloadedUpdate(QNetworkReply* reply);
 	void updateObserverLocation(StelLocation loc);
 };
@@ -640,7 +726,7 @@ class SatellitesStelPluginInterface : public QObject, public StelPluginInterface
 public:
 	virtual StelModule* getStelModule() const;
 	virtual StelPluginInfo getPluginInfo() const;
-	virtual QObjectList getExtensionList() const { return QObjectList(); }
+	virtual QObjectList getExtensionList() const;
 };
 
 #endif /* SATELLITES_HPP */
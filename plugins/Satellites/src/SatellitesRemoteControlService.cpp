@@ -0,0 +1,63 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "SatellitesRemoteControlService.hpp"
+#include "Satellites.hpp"
+#include "StelApp.hpp"
+#include "StelModuleMgr.hpp"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+
+void SatellitesRemoteControlService::get(const QByteArray& operation, const APIParameters& parameters, APIServiceResponse& response)
+{
+	Satellites* satellites = GETSTELMODULE(Satellites);
+	if (operation=="passes" && satellites)
+	{
+		bool ok = true;
+		int days = satellites->getPassesPredictionDepth();
+		if (parameters.contains("days"))
+			days = parameters.value("days").toInt(&ok);
+		if (!ok || days<=0)
+		{
+			response.writeRequestError("invalid 'days' parameter");
+			return;
+		}
+		double minElevation = satellites->getPassesMinElevation();
+		if (parameters.contains("minElevation"))
+			minElevation = parameters.value("minElevation").toDouble(&ok);
+		if (!ok)
+		{
+			response.writeRequestError("invalid 'minElevation' parameter");
+			return;
+		}
+		const bool visibleOnly = parameters.value("visibleOnly", "true")!="false";
+
+		const QVariantList passes = satellites->predictPasses(days, minElevation, visibleOnly);
+		response.writeJSON(QJsonDocument(QJsonArray::fromVariantList(passes)));
+	}
+	else
+		response.writeRequestError("unsupported operation. GET: passes");
+}
+
+void SatellitesRemoteControlService::post(const QByteArray&, const APIParameters&, const QByteArray&, APIServiceResponse& response)
+{
+	response.writeRequestError("unsupported operation. GET: passes");
+}
@@ -0,0 +1,49 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef SATELLITESREMOTECONTROLSERVICE_HPP
+#define SATELLITESREMOTECONTROLSERVICE_HPP
+
+#include "RemoteControlServiceInterface.hpp"
+
+//! @class SatellitesRemoteControlService
+//! Extension of the RemoteControl plugin giving access to the pass predictions of the Satellites plugin.
+//! It is mapped to /api/satellites/, and supports one GET operation:
+//! - passes: the passes of the displayed satellites over the current location from the current date,
+//!   as a JSON array of the maps of SatellitePassPredictor::toVariantMap(). The optional parameters are
+//!   days (default: the depth set in the plugin), minElevation in degrees (default: the one set in the plugin)
+//!   and visibleOnly (default: true).
+//! @ingroup satellites
+class SatellitesRemoteControlService : public QObject, public RemoteControlServiceInterface
+{
+	Q_OBJECT
+	Q_INTERFACES(RemoteControlServiceInterface)
+public:
+	SatellitesRemoteControlService(QObject* parent = Q_NULLPTR) : QObject(parent) {}
+
+	virtual QLatin1String getPath() const Q_DECL_OVERRIDE { return QLatin1String("satellites"); }
+	//! The predictions use the satellites of the plugin, so they run in the main thread.
+	virtual bool isThreadSafe() const Q_DECL_OVERRIDE { return false; }
+	virtual void get(const QByteArray& operation, const APIParameters& parameters, APIServiceResponse& response) Q_DECL_OVERRIDE;
+	virtual void post(const QByteArray& operation, const APIParameters& parameters, const QByteArray& data, APIServiceResponse& response) Q_DECL_OVERRIDE;
+	virtual void update(double) Q_DECL_OVERRIDE {}
+};
+
+#endif // SATELLITESREMOTECONTROLSERVICE_HPP
@@ -0,0 +1,153 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "TleStreamParser.hpp"
+#include "Satellite.hpp"
+
+#include <QDebug>
+
+TleStreamParser::TleStreamParser(TleDataHash& tleList, bool addFlagValue, const QString& sourceName)
+	: tleList(tleList)
+	, addFlagValue(addFlagValue)
+	, sourceName(sourceName)
+	, lastData()
+	, lineNumber(0)
+	, count(0)
+{
+	lastData.addThis = addFlagValue;
+}
+
+void TleStreamParser::addData(const QByteArray& data)
+{
+	int start = 0;
+	int end;
+	while ((end = data.indexOf('\n', start)) >= 0)
+	{
+		if (pendingLine.isEmpty())
+			parseLine(QByteArray::fromRawData(data.constData()+start, end-start));
+		else
+		{
+			pendingLine.append(data.constData()+start, end-start);
+			parseLine(pendingLine);
+			pendingLine.clear();
+		}
+		start = end+1;
+	}
+	pendingLine.append(data.constData()+start, data.size()-start);
+}
+
+void TleStreamParser::finish()
+{
+	if (!pendingLine.isEmpty())
+		parseLine(pendingLine);
+	pendingLine.clear();
+}
+
+void TleStreamParser::parseLine(const QByteArray& rawLine)
+{
+	lineNumber++;
+	const QString line = QString::fromUtf8(rawLine.constData(), rawLine.size()).trimmed();
+	if (line.length() < 65) // this is title line
+	{
+		parseTitleLine(line);
+		return;
+	}
+
+	// TODO: Yet another place suitable for a standard TLE regex. --BM
+	if (line.startsWith("1 "))
+		lastData.first = line;
+	else if (line.startsWith("2 "))
+	{
+		lastData.second = line;
+		// The Satellite Catalog Number is the second number
+		// on the second line.
+		QString id = line.section(' ', 1, 1).trimmed();
+		if (id.isEmpty())
+			return;
+		lastData.id = id;
+
+		// This is the second line and there will be no more,
+		// so if everything is OK, save the elements.
+		if (!lastData.name.isEmpty() && !lastData.first.isEmpty())
+		{
+			// Some satellites can be listed in multiple files,
+			// and only some of those files may be marked for adding,
+			// so try to preserve the flag - if it's set,
+			// feel free to overwrite the existing value.
+			// If not, overwrite only if it's not in the list already.
+			// NOTE: Second case overwrite may need to check which TLE set is newer.
+			if (lastData.addThis || !tleList.contains(id))
+				tleList.insert(id, lastData); // Overwrite if necessary
+			count++;
+		}
+		//TODO: Error warnings? --BM
+	}
+	else
+		qDebug() << "[Satellites] unprocessed line" << lineNumber << "in" << sourceName;
+}
+
+void TleStreamParser::parseTitleLine(const QString& line)
+{
+	// New entry in the list, so reset all fields
+	lastData = TleData();
+	lastData.addThis = addFlagValue;
+	lastData.status = Satellite::StatusUnknown;
+	lastData.name = line;
+
+	// The thing in square brackets after the name is actually
+	// Celestrak's "status code". Parse it!
+	const int open = line.lastIndexOf('[');
+	if (open<0 || line.indexOf(']', open)!=line.length()-1)
+		return;
+
+	if (line.length()-open==3 && !line.at(open+1).isDigit())
+	{
+		switch (line.at(open+1).toUpper().toLatin1())
+		{
+			case '+':
+				lastData.status = Satellite::StatusOperational;
+				break;
+			case '-':
+				lastData.status = Satellite::StatusNonoperational;
+				break;
+			case 'P':
+				lastData.status = Satellite::StatusPartiallyOperational;
+				break;
+			case 'B':
+				lastData.status = Satellite::StatusStandby;
+				break;
+			case 'S':
+				lastData.status = Satellite::StatusSpare;
+				break;
+			case 'X':
+				lastData.status = Satellite::StatusExtendedMission;
+				break;
+			case 'D':
+				lastData.status = Satellite::StatusDecayed;
+				break;
+			default:
+				lastData.status = Satellite::StatusUnknown;
+		}
+	}
+
+	//TODO: We need to think of some kind of ecaping these
+	//characters in the JSON parser. --BM
+	lastData.name = line.left(open).trimmed();  // remove "status code" from name
+}
@@ -0,0 +1,87 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef TLESTREAMPARSER_HPP
+#define TLESTREAMPARSER_HPP
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+//! Data structure containing unvalidated TLE set as read from a TLE list file.
+//! @ingroup satellites
+struct TleData
+{
+	//! NORAD catalog number, as extracted from the TLE set.
+	QString id;
+	//! Human readable name, as extracted from the TLE title line.
+	QString name;
+	QString first;
+	QString second;
+	int status;
+	//! Flag indicating whether this satellite should be added.
+	//! See Satellites::autoAddEnabled.
+	bool addThis;
+};
+
+//! @ingroup satellites
+typedef QList<TleData> TleDataList;
+//! @ingroup satellites
+typedef QHash<QString, TleData> TleDataHash ;
+
+//! @class TleStreamParser
+//! Incremental parser of TLE lists in the three-line format (title line and the two lines of elements).
+//! The data can be given in chunks of any size, e.g. as they arrive from a QNetworkReply, so that a list
+//! is parsed while it is downloaded instead of being saved to a file and read again.
+//! The title line may end with the Celestrak status code in square brackets, e.g. "ISS (ZARYA) [+]".
+//! @ingroup satellites
+class TleStreamParser
+{
+public:
+	//! @param tleList the parsed TLE sets are added to this hash, indexed by catalog number
+	//! @param addFlagValue value to be set to TleData::addThis for all.
+	//! @param sourceName name of the source for the warnings, e.g. a file name or an URL
+	TleStreamParser(TleDataHash& tleList, bool addFlagValue, const QString& sourceName=QString());
+
+	//! Parse the complete lines of a chunk of data.
+	//! The incomplete last line of the chunk is kept until the next call, or finish().
+	void addData(const QByteArray& data);
+	//! Parse the last line if the data did not end with a line break.
+	void finish();
+
+	//! Get the number of TLE sets parsed so far.
+	int getCount() const { return count; }
+
+private:
+	void parseLine(const QByteArray& rawLine);
+	//! Read the name and the status code of a title line.
+	void parseTitleLine(const QString& line);
+
+	TleDataHash& tleList;
+	bool addFlagValue;
+	QString sourceName;
+	QByteArray pendingLine;
+	TleData lastData;
+	int lineNumber;
+	int count;
+};
+
+#endif // TLESTREAMPARSER_HPP
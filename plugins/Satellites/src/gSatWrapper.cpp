@@ -44,6 +44,7 @@
 
 
 gSatWrapper::gSatWrapper(QString designation, QString tle1,QString tle2)
+	: serial(++serialCounter)
 {
 	// The TLE library actually modifies the TLE strings, which is annoying (because
 	// when we get updates, we want to check if there has been a change by using ==
@@ -120,6 +121,28 @@ void gSatWrapper::setEpoch(double ai_julianDaysEpoch)
 		pSatellite->setEpoch(epoch);
 }
 
+void gSatWrapper::prepareEpoch(double ai_julianDaysEpoch)
+{
+	epoch = ai_julianDaysEpoch;
+	// Always update: the location may have changed since the last computation for this epoch
+	lastCalcObserverECIPosition = 0.0;
+	calcObserverECIPosition(observerECIPos, observerECIVel);
+	updateSunECIPos();
+	lastSunECIepoch = epoch;
+}
+
+void gSatWrapper::propagate()
+{
+	if (pSatellite)
+		pSatellite->setEpoch(epoch);
+}
+
+void gSatWrapper::setPropagatedState(const Vec3d& temePos, const Vec3d& temeVel, int error)
+{
+	if (pSatellite)
+		pSatellite->setState(epoch, temePos, temeVel, error);
+}
+
 
 void gSatWrapper::calcObserverECIPosition(Vec3d& ao_position, Vec3d& ao_velocity)
 {
@@ -130,42 +153,78 @@ void gSatWrapper::calcObserverECIPosition(Vec3d& ao_position, Vec3d& ao_velocity
 
 		double radLatitude = loc.latitude * KDEG2RAD;
 		double theta       = epoch.toThetaLMST(loc.longitude * KDEG2RAD);
-		double r;
-		double c,sq;
-
-		/* Reference:  Explanatory supplement to the Astronomical Almanac 1992, page 209-210. */
-		/* Elipsoid earth model*/
-		/* c = Nlat/a */
-		c = 1/std::sqrt(1 + __f*(__f - 2)*Sqr(sin(radLatitude)));
-		sq = Sqr(1 - __f)*c;
-
-		r = (KEARTHRADIUS*c + (loc.altitude/1000))*cos(radLatitude);
-		ao_position[0] = r * cos(theta);/*kilometers*/
-		ao_position[1] = r * sin(theta);
-		ao_position[2] = (KEARTHRADIUS*sq + (loc.altitude/1000))*sin(radLatitude);
-		ao_velocity[0] = -KMFACTOR*ao_position[1];/*kilometers/second*/
-		ao_velocity[1] =  KMFACTOR*ao_position[0];
-		ao_velocity[2] =  0;
+		computeObserverECIPosition(radLatitude, theta, loc.altitude, ao_position, ao_velocity);
 
+		sinRadLatitude = sin(radLatitude);
+		cosRadLatitude = cos(radLatitude);
+		sinTheta = sin(theta);
+		cosTheta = cos(theta);
 		lastCalcObserverECIPosition=epoch;
 	}
 }
 
+void gSatWrapper::computeObserverECIPosition(double radLatitude, double theta, double altitude, Vec3d& ao_position, Vec3d& ao_velocity)
+{
+	double r;
+	double c,sq;
+
+	/* Reference:  Explanatory supplement to the Astronomical Almanac 1992, page 209-210. */
+	/* Elipsoid earth model*/
+	/* c = Nlat/a */
+	c = 1/std::sqrt(1 + __f*(__f - 2)*Sqr(sin(radLatitude)));
+	sq = Sqr(1 - __f)*c;
+
+	r = (KEARTHRADIUS*c + (altitude/1000))*cos(radLatitude);
+	ao_position[0] = r * cos(theta);/*kilometers*/
+	ao_position[1] = r * sin(theta);
+	ao_position[2] = (KEARTHRADIUS*sq + (altitude/1000))*sin(radLatitude);
+	ao_velocity[0] = -KMFACTOR*ao_position[1];/*kilometers/second*/
+	ao_velocity[1] =  KMFACTOR*ao_position[0];
+	ao_velocity[2] =  0;
+}
+
+double gSatWrapper::getMinimumRiseDelay(const elsetrec& satrec, const Vec3d& observerECIPos, const Vec3d& satTEMEPos, double margin)
+{
+	// The satellite can only be above the horizon when the angle at the centre of the Earth between the
+	// observer and the satellite is below the sum of the angles of the horizons of both, for the apogee.
+	const double e = satrec.ecco;
+	const double apogee = satrec.a*(1.+e); // Earth radii
+	const double psiHorizon = std::acos(qMin(1., 1./apogee)) + std::acos(qMin(1., KEARTHRADIUS/observerECIPos.length()));
+	const double psi = observerECIPos.angle(satTEMEPos);
+	if (psi<=psiHorizon+margin)
+		return 0.;
+	// The angle changes at most by the angular velocity of the satellite at perigee plus the rotation of the Earth
+	const double rate = satrec.no/KSEC_PER_MIN*(1.+e)*(1.+e)/std::pow(1.-e*e, 1.5) + KMFACTOR; // rad/s
+	return (psi-psiHorizon-margin)/rate;
+}
 
 
+Vec3d gSatWrapper::getObserverECIPos(double dt)
+{
+	const double sinRot = sin(KMFACTOR*dt);
+	const double cosRot = cos(KMFACTOR*dt);
+	return Vec3d(cosRot*observerECIPos[0] - sinRot*observerECIPos[1],
+		     sinRot*observerECIPos[0] + cosRot*observerECIPos[1],
+		     observerECIPos[2]);
+}
+
+Vec3d gSatWrapper::toTopocentric(const Vec3d& v, double dt)
+{
+	// Same rotation as getAltAz(), for the sidereal angle advanced by the rotation of the Earth
+	const double sinRot = sin(KMFACTOR*dt);
+	const double cosRot = cos(KMFACTOR*dt);
+	const double sinT = sinTheta*cosRot + cosTheta*sinRot;
+	const double cosT = cosTheta*cosRot - sinTheta*sinRot;
+	return Vec3d(sinRadLatitude*cosT*v[0] + sinRadLatitude*sinT*v[1] - cosRadLatitude*v[2],
+		     -sinT*v[0] + cosT*v[1],
+		     cosRadLatitude*cosT*v[0] + cosRadLatitude*sinT*v[1] + sinRadLatitude*v[2]);
+}
+
 Vec3d gSatWrapper::getAltAz() const
 {
-	StelLocation loc   = StelApp::getInstance().getCore()->getCurrentLocation();
 	Vec3d topoSatPos;
 
-	const double  radLatitude    = loc.latitude * KDEG2RAD;
-	const double  theta          = epoch.toThetaLMST(loc.longitude * KDEG2RAD);
-	const double sinRadLatitude=sin(radLatitude);
-	const double cosRadLatitude=cos(radLatitude);
-	const double sinTheta=sin(theta);
-	const double cosTheta=cos(theta);
-
-	// This now only updates if required.
+	// This now only updates if required, together with the rotation to the topocentric frame.
 	calcObserverECIPosition(observerECIPos, observerECIVel);
 
 	Vec3d satECIPos  = getTEMEPos();
@@ -218,6 +277,7 @@ void gSatWrapper::updateSunECIPos()
 	sunECIPos.set(sunEquinoxEqPos[0]*AU, sunEquinoxEqPos[1]*AU, sunEquinoxEqPos[2]*AU);
 	sunECIPos = sunECIPos + observerECIPos; //Change ref system centre
 
+	sunAboveHorizon = solsystem->getSun()->getAltAzPosGeometric(StelApp::getInstance().getCore())[2] > 0.0;
 
 
 }
@@ -236,16 +296,22 @@ Vec3d gSatWrapper::getSunECIPos()
 // @brief This operation predicts the satellite visibility conditions.
 gSatWrapper::Visibility gSatWrapper::getVisibilityPredict() const
 {
-	Vec3d satAltAzPos = getAltAz();
+	return getVisibilityPredict(getAltAz());
+}
 
+gSatWrapper::Visibility gSatWrapper::getVisibilityPredict(const Vec3d& satAltAzPos) const
+{
+	return computeVisibility(getTEMEPos(), satAltAzPos);
+}
+
+gSatWrapper::Visibility gSatWrapper::computeVisibility(const Vec3d& satECIPos, const Vec3d& satAltAzPos)
+{
 	if (satAltAzPos[2] > 0)
 	{
-		Vec3d satECIPos = getTEMEPos();
-		static const SolarSystem *solsystem = (SolarSystem*)StelApp::getInstance().getModuleMgr().getModule("SolarSystem");
-		Vec3d sunAltAzPos = solsystem->getSun()->getAltAzPosGeometric(StelApp::getInstance().getCore());
+		// This also updates sunAboveHorizon if required
 		Vec3d sunECIPos = getSunECIPos();
 
-		if (sunAltAzPos[2] > 0.0)
+		if (sunAboveHorizon)
 		{
 			return RADAR_SUN;
 		}
@@ -274,6 +340,7 @@ double gSatWrapper::getPhaseAngle() const
 	return sunECIPos.angle(getTEMEPos());
 }
 
+unsigned int gSatWrapper::serialCounter = 0;
 gTime gSatWrapper::epoch;
 gTime gSatWrapper::lastSunECIepoch=0.0; // store last time of computation to avoid all-1 computations.
 gTime gSatWrapper::lastCalcObserverECIPosition;
@@ -281,3 +348,8 @@ gTime gSatWrapper::lastCalcObserverECIPosition;
 Vec3d gSatWrapper::sunECIPos; // enough to have this once.
 Vec3d gSatWrapper::observerECIPos;
 Vec3d gSatWrapper::observerECIVel;
+double gSatWrapper::sinRadLatitude = 0.;
+double gSatWrapper::cosRadLatitude = 1.;
+double gSatWrapper::sinTheta = 0.;
+double gSatWrapper::cosTheta = 1.;
+bool gSatWrapper::sunAboveHorizon = false;
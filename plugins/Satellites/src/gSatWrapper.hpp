@@ -59,6 +59,24 @@ public:
 	//! from Stellarium Julian Date.
 	void setEpoch(double ai_julianDaysEpoch);
 
+	//! Set the epoch of all satellites and compute the observer and Sun positions shared by them.
+	//! Call it on the main thread once per frame. After it, propagate() and the getters can run
+	//! for different satellites on several threads at once, until the next call to setEpoch() of any satellite.
+	static void prepareEpoch(double ai_julianDaysEpoch);
+
+	//! Propagate the satellite to the epoch given to prepareEpoch(), without changing the shared state.
+	void propagate();
+	//! Same as propagate(), with a state already propagated to the epoch given to prepareEpoch(),
+	//! e.g. by gSatNearEarthBatch.
+	void setPropagatedState(const Vec3d& temePos, const Vec3d& temeVel, int error);
+
+	//! Get the coefficients of the SGP4 model of the satellite.
+	const elsetrec* getSatrec() const { return pSatellite ? &pSatellite->getSatrec() : Q_NULLPTR; }
+	//! Get the error code of the last propagation, 0 if none.
+	int getErrorCode() const { return pSatellite ? pSatellite->getErrorCode() : 0; }
+	//! Get a number unique to this object, to detect that the TLE of a satellite was replaced.
+	unsigned int getSerial() const { return serial; }
+
 	// Operation getTEMEPos
 	//! @brief This operation isolate gSatTEME getPos operation.
 	//! @return Vec3d with TEME position. Units measured in Km.
@@ -69,6 +87,15 @@ public:
 	//! @return Vec3d with ECI position.
 	static Vec3d getSunECIPos();
 
+	//! Get the observer position in ECI system computed by prepareEpoch() [km].
+	static Vec3d getObserverECIPos() { return observerECIPos; }
+	//! Get the observer position in ECI system dt seconds after the last computation of getObserverECIPos(),
+	//! rotated with the Earth [km]. Valid for some minutes.
+	static Vec3d getObserverECIPos(double dt);
+	//! Rotate a vector from the ECI system to the topocentric frame of getAltAz() (South, East, Zenith),
+	//! dt seconds after the last computation of getObserverECIPos(). Valid for some minutes.
+	static Vec3d toTopocentric(const Vec3d& eciVector, double dt);
+
 	// Operation getTEMEVel
 	//! @brief This operation isolate gSatTEME getVel operation.
 	//! @return Vec3d with TEME speed. Units measured in Km/s.
@@ -116,6 +143,13 @@ public:
         //!   Fundamentals of Astrodynamis and Applications (Third Edition) pg 898
         //!   David A. Vallado
 	Visibility getVisibilityPredict() const;
+	//! Same as getVisibilityPredict(), for a position from getAltAz() which was already computed.
+	//! @param satAltAzPos the result of getAltAz(), possibly normalized.
+	Visibility getVisibilityPredict(const Vec3d& satAltAzPos) const;
+	//! Same as getVisibilityPredict(), for any position of a satellite near the epoch.
+	//! @param satECIPos the position of the satellite in TEME system [km]
+	//! @param satAltAzPos its position in the topocentric frame, possibly normalized.
+	static Visibility computeVisibility(const Vec3d& satECIPos, const Vec3d& satAltAzPos);
 
 	double getPhaseAngle() const;
 	static gTime getEpoch() { return epoch; }
@@ -136,12 +170,31 @@ public:
         //! @param[out] ao_vel Observer ECI velocity vector measured in Km/s
 	static void calcObserverECIPosition(Vec3d& ao_position, Vec3d& ao_vel) ;
 
+	//! Compute the observer ECI coordinates for any location, as calcObserverECIPosition() does for the current one.
+	//! @param radLatitude geographic latitude of the observer in radians
+	//! @param theta local mean sidereal angle in radians, see gTime::toThetaLMST()
+	//! @param altitude altitude of the observer in meters
+	//! @param[out] ao_position Observer ECI position vector measured in Km
+	//! @param[out] ao_vel Observer ECI velocity vector measured in Km/s
+	static void computeObserverECIPosition(double radLatitude, double theta, double altitude, Vec3d& ao_position, Vec3d& ao_vel);
+
+	//! Get a lower bound of the time before a satellite can rise above the horizon of an observer.
+	//! @param satrec the SGP4 model of the satellite
+	//! @param observerECIPos the observer position in ECI system [km]
+	//! @param satTEMEPos the satellite position in TEME system at the same epoch [km]
+	//! @param margin angle below the horizon from which the satellite counts as risen, covering refraction and
+	//! the flattening of the Earth [rad]
+	//! @return the delay in seconds, 0 if the satellite is above the horizon or close to rise.
+	static double getMinimumRiseDelay(const elsetrec& satrec, const Vec3d& observerECIPos, const Vec3d& satTEMEPos, double margin);
+
 
 private:
 	//! do the actual work to compute a cached value.
 	static void updateSunECIPos();
 
 	gSatTEME *pSatellite;
+	unsigned int serial;
+	static unsigned int serialCounter;
 	static gTime	 epoch;
 
 	// GZ We can avoid many computations (solar and observer positions for every satellite) by computing them only once for all objects.
@@ -150,6 +203,9 @@ private:
 	static Vec3d observerECIPos;
 	static Vec3d observerECIVel;
 	static gTime lastCalcObserverECIPosition;
+	// Rotation from ECI to the topocentric frame of the observer, computed with observerECIPos.
+	static double sinRadLatitude, cosRadLatitude, sinTheta, cosTheta;
+	static bool sunAboveHorizon; // computed with sunECIPos
 
 };
 
@@ -0,0 +1,262 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "gSatNearEarthBatch.hpp"
+#include "gTime.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	//! Same as std::fmod(x, 2 pi), written so that it can be vectorized.
+	inline double fmodTwoPi(double x)
+	{
+		const double twopi = 2.0*M_PI;
+		return x - twopi*std::trunc(x/twopi);
+	}
+}
+
+gSatNearEarthBatch::gSatNearEarthBatch()
+	: count(0)
+	, capacity(0)
+	, radiusearthkm(0.)
+	, xke(0.)
+	, j2(0.)
+{
+	double tumin, mu, j3, j4, j3oj2;
+	// The constants of gSatTEME
+	getgravconst(wgs72, tumin, mu, radiusearthkm, xke, j2, j3, j4, j3oj2);
+}
+
+void gSatNearEarthBatch::build(const QVector<const elsetrec*>& satrecs)
+{
+	count = satrecs.size();
+	capacity = (count+LANES-1)/LANES*LANES;
+	coefficients.resize(FIELD_COUNT*capacity);
+	state.fill(0., 6*capacity);
+	errors.fill(0, capacity);
+	for (int i=0; i<capacity; ++i)
+	{
+		const elsetrec& s = *satrecs.at(qMin(i, count-1));
+		Q_ASSERT(isSupported(s));
+		const double values[FIELD_COUNT] = {
+			s.jdsatepoch, s.mo, s.mdot, s.argpo, s.argpdot, s.nodeo, s.nodedot, s.nodecf,
+			s.cc1, s.cc4, s.cc5, s.bstar, s.t2cof, s.t3cof, s.t4cof, s.t5cof,
+			s.isimp==1 ? 1. : 0., s.omgcof, s.xmcof, s.eta, s.delmo, s.d2, s.d3, s.d4, s.sinmao,
+			s.no, std::pow(xke/s.no, 2.0/3.0), s.ecco, s.inclo, std::sin(s.inclo), std::cos(s.inclo),
+			s.aycof, s.xlcof, s.con41, s.x1mth2, s.x7thm1
+		};
+		for (int f=0; f<FIELD_COUNT; ++f)
+			coefficients[f*capacity+i] = values[f];
+	}
+}
+
+void gSatNearEarthBatch::propagate(double jd, int begin, int end)
+{
+	Q_ASSERT(begin%LANES==0);
+	end = qMin(end, count);
+	for (int b=begin; b<end; b+=LANES)
+		propagateBlock(jd, b);
+}
+
+// This follows sgp4() in sgp4unit.cpp for method 'n', see there for the references.
+void gSatNearEarthBatch::propagateBlock(double jd, int b)
+{
+	const double vkmpersec = radiusearthkm*xke/60.0;
+
+	const double* jdsatepoch = field(JDSATEPOCH, b);
+	const double* mo = field(MO, b);
+	const double* mdot = field(MDOT, b);
+	const double* argpo = field(ARGPO, b);
+	const double* argpdot = field(ARGPDOT, b);
+	const double* nodeo = field(NODEO, b);
+	const double* nodedot = field(NODEDOT, b);
+	const double* nodecf = field(NODECF, b);
+	const double* cc1 = field(CC1, b);
+	const double* cc4 = field(CC4, b);
+	const double* cc5 = field(CC5, b);
+	const double* bstar = field(BSTAR, b);
+	const double* t2cof = field(T2COF, b);
+	const double* t3cof = field(T3COF, b);
+	const double* t4cof = field(T4COF, b);
+	const double* t5cof = field(T5COF, b);
+	const double* simple = field(SIMPLE, b);
+	const double* omgcof = field(OMGCOF, b);
+	const double* xmcof = field(XMCOF, b);
+	const double* eta = field(ETA, b);
+	const double* delmo = field(DELMO, b);
+	const double* d2 = field(D2, b);
+	const double* d3 = field(D3, b);
+	const double* d4 = field(D4, b);
+	const double* sinmao = field(SINMAO, b);
+	const double* no = field(NO, b);
+	const double* aFactor = field(AFACTOR, b);
+	const double* ecco = field(ECCO, b);
+	const double* inclo = field(INCLO, b);
+	const double* sinio = field(SINIO, b);
+	const double* cosio = field(COSIO, b);
+	const double* aycof = field(AYCOF, b);
+	const double* xlcof = field(XLCOF, b);
+	const double* con41 = field(CON41, b);
+	const double* x1mth2 = field(X1MTH2, b);
+	const double* x7thm1 = field(X7THM1, b);
+
+	double am[LANES], nm[LANES], nodem[LANES], axnl[LANES], aynl[LANES], u[LANES];
+	int error[LANES];
+
+	// Secular gravity and atmospheric drag, long period periodics
+	for (int k=0; k<LANES; ++k)
+	{
+		const double t = (jd - jdsatepoch[k])*KSEC_PER_DAY/KSEC_PER_MIN;
+		const double xmdf = mo[k] + mdot[k]*t;
+		const double argpdf = argpo[k] + argpdot[k]*t;
+		const double nodedf = nodeo[k] + nodedot[k]*t;
+		const double t2 = t*t;
+		const double t3 = t2*t;
+		const double t4 = t3*t;
+		double node = nodedf + nodecf[k]*t2;
+
+		const double c = 1.0 + eta[k]*std::cos(xmdf);
+		const double temp = omgcof[k]*t + xmcof[k]*(c*c*c - delmo[k]);
+		const bool simp = simple[k]!=0.;
+		double mm = simp ? xmdf : xmdf + temp;
+		double argpm = simp ? argpdf : argpdf - temp;
+		double tempa = 1.0 - cc1[k]*t;
+		double tempe = bstar[k]*cc4[k]*t;
+		double templ = t2cof[k]*t2;
+		tempa = simp ? tempa : tempa - d2[k]*t2 - d3[k]*t3 - d4[k]*t4;
+		tempe = simp ? tempe : tempe + bstar[k]*cc5[k]*(std::sin(mm) - sinmao[k]);
+		templ = simp ? templ : templ + t3cof[k]*t3 + t4*(t4cof[k] + t*t5cof[k]);
+
+		const double a = aFactor[k]*tempa*tempa;
+		double em = ecco[k] - tempe;
+		error[k] = no[k]<=0.0 ? 2 : ((em>=1.0 || em<-0.001) ? 1 : 0);
+		em = std::max(em, 1.0e-6);
+		mm = mm + no[k]*templ;
+		double xlm = mm + argpm + node;
+		node = fmodTwoPi(node);
+		argpm = fmodTwoPi(argpm);
+		xlm = fmodTwoPi(xlm);
+		mm = fmodTwoPi(xlm - argpm - node);
+
+		const double tmp = 1.0/(a*(1.0 - em*em));
+		am[k] = a;
+		nm[k] = xke/(a*std::sqrt(a));
+		nodem[k] = node;
+		axnl[k] = em*std::cos(argpm);
+		aynl[k] = em*std::sin(argpm) + tmp*aycof[k];
+		const double xl = mm + argpm + node + tmp*xlcof[k]*axnl[k];
+		u[k] = fmodTwoPi(xl - node);
+	}
+
+	// Kepler's equation, with the same corrections and stop criterion as sgp4()
+	double eo1[LANES], sineo1[LANES], coseo1[LANES];
+	bool active[LANES];
+	for (int k=0; k<LANES; ++k)
+	{
+		eo1[k] = u[k];
+		sineo1[k] = 0.;
+		coseo1[k] = 0.;
+		active[k] = true;
+	}
+	for (int iteration=0; iteration<10; ++iteration)
+	{
+		bool any = false;
+		for (int k=0; k<LANES; ++k)
+		{
+			const double s = std::sin(eo1[k]);
+			const double c = std::cos(eo1[k]);
+			double tem5 = (u[k] - aynl[k]*c + axnl[k]*s - eo1[k])/(1.0 - c*axnl[k] - s*aynl[k]);
+			tem5 = std::min(std::max(tem5, -0.95), 0.95);
+			sineo1[k] = active[k] ? s : sineo1[k];
+			coseo1[k] = active[k] ? c : coseo1[k];
+			eo1[k] = active[k] ? eo1[k] + tem5 : eo1[k];
+			active[k] = active[k] && std::fabs(tem5)>=1.0e-12;
+			any = any || active[k];
+		}
+		if (!any)
+			break;
+	}
+
+	// Short period periodics, position and velocity
+	double* x = state.data()+b;
+	double* y = x+capacity;
+	double* z = y+capacity;
+	double* vx = z+capacity;
+	double* vy = vx+capacity;
+	double* vz = vy+capacity;
+	for (int k=0; k<LANES; ++k)
+	{
+		const double ecose = axnl[k]*coseo1[k] + aynl[k]*sineo1[k];
+		const double esine = axnl[k]*sineo1[k] - aynl[k]*coseo1[k];
+		const double el2 = axnl[k]*axnl[k] + aynl[k]*aynl[k];
+		const double pl = am[k]*(1.0 - el2);
+		error[k] = (error[k]==0 && pl<0.0) ? 4 : error[k];
+
+		const double rl = am[k]*(1.0 - ecose);
+		const double rdotl = std::sqrt(am[k])*esine/rl;
+		const double rvdotl = std::sqrt(pl)/rl;
+		const double betal = std::sqrt(1.0 - el2);
+		double temp = esine/(1.0 + betal);
+		const double sinu = am[k]/rl*(sineo1[k] - aynl[k] - axnl[k]*temp);
+		const double cosu = am[k]/rl*(coseo1[k] - axnl[k] + aynl[k]*temp);
+		double su = std::atan2(sinu, cosu);
+		const double sin2u = (cosu + cosu)*sinu;
+		const double cos2u = 1.0 - 2.0*sinu*sinu;
+		temp = 1.0/pl;
+		const double temp1 = 0.5*j2*temp;
+		const double temp2 = temp1*temp;
+
+		const double mrt = rl*(1.0 - 1.5*temp2*betal*con41[k]) + 0.5*temp1*x1mth2[k]*cos2u;
+		su = su - 0.25*temp2*x7thm1[k]*sin2u;
+		const double xnode = nodem[k] + 1.5*temp2*cosio[k]*sin2u;
+		const double xinc = inclo[k] + 1.5*temp2*cosio[k]*sinio[k]*cos2u;
+		const double mvt = rdotl - nm[k]*temp1*x1mth2[k]*sin2u/xke;
+		const double rvdot = rvdotl + nm[k]*temp1*(x1mth2[k]*cos2u + 1.5*con41[k])/xke;
+
+		const double sinsu = std::sin(su);
+		const double cossu = std::cos(su);
+		const double snod = std::sin(xnode);
+		const double cnod = std::cos(xnode);
+		const double sini = std::sin(xinc);
+		const double cosi = std::cos(xinc);
+		const double xmx = -snod*cosi;
+		const double xmy = cnod*cosi;
+		const double ux = xmx*sinsu + cnod*cossu;
+		const double uy = xmy*sinsu + snod*cossu;
+		const double uz = sini*sinsu;
+		const double wx = xmx*cossu - cnod*sinsu;
+		const double wy = xmy*cossu - snod*sinsu;
+		const double wz = sini*cossu;
+
+		// sgp4() returns before computing the state for these errors, and gSatTEME keeps zeros
+		const bool valid = error[k]==0;
+		x[k] = valid ? (mrt*ux)*radiusearthkm : 0.0;
+		y[k] = valid ? (mrt*uy)*radiusearthkm : 0.0;
+		z[k] = valid ? (mrt*uz)*radiusearthkm : 0.0;
+		vx[k] = valid ? (mvt*ux + rvdot*wx)*vkmpersec : 0.0;
+		vy[k] = valid ? (mvt*uy + rvdot*wy)*vkmpersec : 0.0;
+		vz[k] = valid ? (mvt*uz + rvdot*wz)*vkmpersec : 0.0;
+		// Decay: the state is computed, but flagged
+		error[k] = (error[k]==0 && mrt<1.0) ? 6 : error[k];
+	}
+	std::copy(error, error+LANES, errors.data()+b);
+}
@@ -0,0 +1,90 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef GSATNEAREARTHBATCH_HPP
+#define GSATNEAREARTHBATCH_HPP
+
+#include "VecMath.hpp"
+#include "sgp4unit.h"
+
+#include <QVector>
+
+//! @class gSatNearEarthBatch
+//! @brief SGP4 propagation of many near-earth satellites at once.
+//! @details
+//! The coefficients computed by sgp4init() for the near-earth model (period below 225 minutes),
+//! which most satellites use, are copied into a structure of arrays. The propagation processes
+//! them by blocks of LANES satellites, with the branches of sgp4() turned into selections so that
+//! the compiler can vectorize the loops over the lanes of a block. The results are those of sgp4(),
+//! up to rounding, including the error codes. Deep-space satellites are not supported.
+//! @ingroup satellites
+class gSatNearEarthBatch
+{
+public:
+	//! Number of satellites propagated together. The ranges given to propagate() start at a multiple of it.
+	static const int LANES = 8;
+
+	gSatNearEarthBatch();
+
+	//! Get whether a satellite uses the near-earth model and can be propagated by a batch.
+	static bool isSupported(const elsetrec& satrec) {return satrec.method=='n';}
+
+	//! Copy the coefficients of satellites. All must be supported.
+	void build(const QVector<const elsetrec*>& satrecs);
+	void clear() {build(QVector<const elsetrec*>());}
+	int size() const {return count;}
+
+	//! Propagate the satellites [begin, end[ to a date, with the WGS72 constants as gSatTEME.
+	//! Different ranges can be propagated on different threads at once.
+	//! @param jd Julian Day (UTC)
+	//! @param begin first satellite, multiple of LANES.
+	void propagate(double jd, int begin, int end);
+
+	//! Get the TEME position of a satellite after propagate() [km].
+	//! It is zero when sgp4() would not have computed it because of an error.
+	Vec3d getPos(int i) const {return Vec3d(state.at(i), state.at(capacity+i), state.at(2*capacity+i));}
+	//! Get the TEME velocity of a satellite after propagate() [km/s].
+	Vec3d getVel(int i) const {return Vec3d(state.at(3*capacity+i), state.at(4*capacity+i), state.at(5*capacity+i));}
+	//! Get the error code of sgp4() for a satellite after propagate(), 0 if none.
+	int getError(int i) const {return errors.at(i);}
+
+private:
+	//! Coefficients of the near-earth model, stored field after field.
+	enum Field
+	{
+		JDSATEPOCH, MO, MDOT, ARGPO, ARGPDOT, NODEO, NODEDOT, NODECF,
+		CC1, CC4, CC5, BSTAR, T2COF, T3COF, T4COF, T5COF,
+		SIMPLE, OMGCOF, XMCOF, ETA, DELMO, D2, D3, D4, SINMAO,
+		NO, AFACTOR, ECCO, INCLO, SINIO, COSIO, AYCOF, XLCOF, CON41, X1MTH2, X7THM1,
+		FIELD_COUNT
+	};
+	const double* field(Field f, int i) const {return coefficients.constData()+f*capacity+i;}
+
+	void propagateBlock(double jd, int b);
+
+	int count;
+	int capacity;		// count rounded up to LANES, the last satellite is repeated in the padding
+	double radiusearthkm, xke, j2;
+	QVector<double> coefficients;
+	QVector<double> state;	// x, y, z, vx, vy, vz, each of capacity values
+	QVector<int> errors;
+};
+
+#endif // GSATNEAREARTHBATCH_HPP
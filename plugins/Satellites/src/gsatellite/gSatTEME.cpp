@@ -102,6 +102,14 @@ void gSatTEME::setEpoch(gTime ai_time)
 	m_SubPoint    = computeSubPoint( ai_time);
 }
 
+void gSatTEME::setState(gTime ai_time, const Vec3d& ai_position, const Vec3d& ai_vel, int ai_error)
+{
+	satrec.error  = ai_error;
+	m_Position    = ai_position;
+	m_Vel         = ai_vel;
+	m_SubPoint    = computeSubPoint( ai_time);
+}
+
 void gSatTEME::setMinSinceKepEpoch(double ai_minSinceKepEpoch)
 {
 
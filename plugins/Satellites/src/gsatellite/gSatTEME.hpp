@@ -129,6 +129,19 @@ public:
 		return satrec.error;
 	}
 
+	//! Get the coefficients computed by sgp4init() from the TLE.
+	const elsetrec& getSatrec() const
+	{
+		return satrec;
+	}
+
+	//! Set a state propagated outside of this object, e.g. by gSatNearEarthBatch, as setEpoch() would.
+	//! @param[in] ai_time epoch of the state
+	//! @param[in] ai_position TEME position measured in Km
+	//! @param[in] ai_vel TEME velocity measured in Km/s
+	//! @param[in] ai_error error code of sgp4()
+	void setState(gTime ai_time, const Vec3d& ai_position, const Vec3d& ai_vel, int ai_error);
+
 private:
 	// Operation:  computeSubPoint
 	//! @brief Compute the Geographic satellite subpoint Vector
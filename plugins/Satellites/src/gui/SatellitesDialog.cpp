@@ -30,6 +30,8 @@
 #include <QAction>
 #include <QColorDialog>
 
+#include <cmath>
+
 #include "StelApp.hpp"
 #include "StelCore.hpp"
 #include "ui_satellitesDialog.h"
@@ -90,6 +92,7 @@ void SatellitesDialog::retranslate()
 		populateAboutPage();
 		populateFilterMenu();
 		initListIridiumFlares();
+		initListPasses();
 	}
 }
 
@@ -252,6 +255,15 @@ void SatellitesDialog::createDialogContent()
 	connect(ui->predictedIridiumFlaresSaveButton, SIGNAL(clicked()), this, SLOT(savePredictedIridiumFlares()));
 	connect(ui->iridiumFlaresTreeWidget, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(selectCurrentIridiumFlare(QModelIndex)));
 
+	initListPasses();
+	ui->passesPredictionDepthSpinBox->setValue(plugin->getPassesPredictionDepth());
+	ui->passesMinElevationSpinBox->setValue(plugin->getPassesMinElevation());
+	connect(ui->passesPredictionDepthSpinBox, SIGNAL(valueChanged(int)), plugin, SLOT(setPassesPredictionDepth(int)));
+	connect(ui->passesMinElevationSpinBox, SIGNAL(valueChanged(double)), plugin, SLOT(setPassesMinElevation(double)));
+	connect(ui->predictPassesPushButton, SIGNAL(clicked()), this, SLOT(predictPasses()));
+	connect(ui->predictedPassesSaveButton, SIGNAL(clicked()), this, SLOT(savePredictedPasses()));
+	connect(ui->passesTreeWidget, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(selectCurrentPass(QModelIndex)));
+
 	ui->satColorPickerButton->setFixedSize(QSize(18, 18));
 }
 
@@ -324,41 +336,51 @@ void SatellitesDialog::searchSatellitesClear()
 }
 
 void SatellitesDialog::savePredictedIridiumFlares()
+{
+	savePredictions(ui->iridiumFlaresTreeWidget, iridiumFlaresHeader, q_("Save predicted Iridium flares as..."), "iridium_flares.csv");
+}
+
+void SatellitesDialog::savePredictedPasses()
+{
+	savePredictions(ui->passesTreeWidget, passesHeader, q_("Save predicted passes as..."), "satellite_passes.csv");
+}
+
+void SatellitesDialog::savePredictions(QTreeWidget* treeWidget, const QStringList& header, const QString& title, const QString& fileName)
 {
 	QString filter = q_("CSV (Comma delimited)");
 	filter.append(" (*.csv)");
 	QString filePath = QFileDialog::getSaveFileName(Q_NULLPTR,
-							q_("Save predicted Iridium flares as..."),
-							QDir::homePath() + "/iridium_flares.csv",
+							title,
+							QDir::homePath() + "/" + fileName,
 							filter);
-	QFile predictedIridiumFlares(filePath);
-	if (!predictedIridiumFlares.open(QFile::WriteOnly | QFile::Truncate))
+	QFile predictions(filePath);
+	if (!predictions.open(QFile::WriteOnly | QFile::Truncate))
 	{
 		qWarning() << "[Satellites]: Unable to open file"
 			   << QDir::toNativeSeparators(filePath);
 		return;
 	}
 
-	QTextStream predictedIridiumFlaresList(&predictedIridiumFlares);
-	predictedIridiumFlaresList.setCodec("UTF-8");
+	QTextStream predictionsList(&predictions);
+	predictionsList.setCodec("UTF-8");
 
-	int count = ui->iridiumFlaresTreeWidget->topLevelItemCount();
+	int count = treeWidget->topLevelItemCount();
 
-	predictedIridiumFlaresList << iridiumFlaresHeader.join(delimiter) << acEndl;
+	predictionsList << header.join(delimiter) << acEndl;
 	for (int i = 0; i < count; i++)
 	{
-		int columns = iridiumFlaresHeader.size();
+		int columns = header.size();
 		for (int j=0; j<columns; j++)
 		{
-			predictedIridiumFlaresList << ui->iridiumFlaresTreeWidget->topLevelItem(i)->text(j);
+			predictionsList << treeWidget->topLevelItem(i)->text(j);
 			if (j<columns-1)
-				predictedIridiumFlaresList << delimiter;
+				predictionsList << delimiter;
 			else
-				predictedIridiumFlaresList << acEndl;
+				predictionsList << acEndl;
 		}
 	}
 
-	predictedIridiumFlares.close();
+	predictions.close();
 }
 
 void SatellitesDialog::filterListByGroup(int index)
@@ -1231,3 +1253,108 @@ void SatellitesDialog::selectCurrentIridiumFlare(const QModelIndex &modelIndex)
 		}
 	}
 }
+
+void SatellitesDialog::setPassesHeaderNames()
+{
+	passesHeader.clear();
+
+	passesHeader << q_("Satellite");
+	// TRANSLATORS: acquisition of signal, when a satellite rises
+	passesHeader << q_("AOS");
+	// TRANSLATORS: time of closest approach, when a satellite is the highest
+	passesHeader << q_("TCA");
+	// TRANSLATORS: loss of signal, when a satellite sets
+	passesHeader << q_("LOS");
+	passesHeader << q_("Max. elevation");
+	passesHeader << q_("AOS azimuth");
+	passesHeader << q_("LOS azimuth");
+	passesHeader << q_("Visible");
+
+	ui->passesTreeWidget->setHeaderLabels(passesHeader);
+
+	// adjust the column width
+	for(int i = 0; i < PassesCount; ++i)
+	{
+	    ui->passesTreeWidget->resizeColumnToContents(i);
+	}
+
+	// sort-by-date
+	ui->passesTreeWidget->sortItems(PassesAOS, Qt::AscendingOrder);
+}
+
+void SatellitesDialog::initListPasses()
+{
+	ui->passesTreeWidget->clear();
+	ui->passesTreeWidget->setColumnCount(PassesCount);
+	setPassesHeaderNames();
+	ui->passesTreeWidget->header()->setSectionsMovable(false);
+}
+
+void SatellitesDialog::predictPasses()
+{
+	StelCore* core = StelApp::getInstance().getCore();
+	const SatellitePassList passes = GETSTELMODULE(Satellites)->getPassesPrediction(ui->passesVisibleOnlyCheckBox->isChecked());
+	const bool useSouthAzimuth = StelApp::getInstance().getFlagSouthAzimuthUsage();
+	auto dateString = [core](double JD) {
+		const QString dt = StelUtils::julianDayToISO8601String(JD + core->getUTCOffset(JD)/24.);
+		return QString("%1 %2").arg(dt.left(10)).arg(dt.right(8));
+	};
+	auto azimuthString = [useSouthAzimuth](double azimuth) {
+		if (useSouthAzimuth)
+			azimuth = std::fmod(azimuth + M_PI, 2.*M_PI);
+		return StelUtils::radToDmsStr(azimuth);
+	};
+
+	ui->passesTreeWidget->clear();
+	for (const auto& pass : passes)
+	{
+		SatPassesTreeWidgetItem *treeItem = new SatPassesTreeWidgetItem(ui->passesTreeWidget);
+		treeItem->setText(PassesSatellite, pass.name);
+		treeItem->setText(PassesAOS, dateString(pass.aos));
+		treeItem->setData(PassesAOS, Qt::UserRole, pass.aos);
+		treeItem->setText(PassesTCA, dateString(pass.tca));
+		treeItem->setData(PassesTCA, Qt::UserRole, pass.tca);
+		treeItem->setText(PassesLOS, dateString(pass.los));
+		treeItem->setData(PassesLOS, Qt::UserRole, pass.los);
+		treeItem->setText(PassesMaxElevation, StelUtils::radToDmsStr(pass.maxElevation));
+		treeItem->setData(PassesMaxElevation, Qt::UserRole, pass.maxElevation);
+		treeItem->setTextAlignment(PassesMaxElevation, Qt::AlignRight);
+		treeItem->setText(PassesAOSAzimuth, azimuthString(pass.aosAzimuth));
+		treeItem->setData(PassesAOSAzimuth, Qt::UserRole, pass.aosAzimuth);
+		treeItem->setTextAlignment(PassesAOSAzimuth, Qt::AlignRight);
+		treeItem->setText(PassesLOSAzimuth, azimuthString(pass.losAzimuth));
+		treeItem->setData(PassesLOSAzimuth, Qt::UserRole, pass.losAzimuth);
+		treeItem->setTextAlignment(PassesLOSAzimuth, Qt::AlignRight);
+		// TRANSLATORS: duration in minutes
+		treeItem->setText(PassesVisible, pass.visibleDuration>0. ? q_("%1 min").arg(pass.visibleDuration/60., 0, 'f', 1) : QString("-"));
+		treeItem->setData(PassesVisible, Qt::UserRole, pass.visibleDuration);
+		treeItem->setTextAlignment(PassesVisible, Qt::AlignRight);
+	}
+
+	for(int i = 0; i < PassesCount; ++i)
+	{
+	    ui->passesTreeWidget->resizeColumnToContents(i);
+	}
+}
+
+void SatellitesDialog::selectCurrentPass(const QModelIndex &modelIndex)
+{
+	StelCore* core = StelApp::getInstance().getCore();
+	// Find the object
+	QString name = modelIndex.sibling(modelIndex.row(), PassesSatellite).data().toString();
+	double JD = modelIndex.sibling(modelIndex.row(), PassesAOS).data(Qt::UserRole).toDouble();
+	JD -= core->JD_SECOND*30; // Set start point on 30 seconds before the rise
+
+	StelObjectMgr* objectMgr = GETSTELMODULE(StelObjectMgr);
+	if (objectMgr->findAndSelectI18n(name) || objectMgr->findAndSelect(name))
+	{
+		core->setJD(JD);
+		const QList<StelObjectP> newSelected = objectMgr->getSelectedObject();
+		if (!newSelected.empty())
+		{
+			StelMovementMgr* mvmgr = GETSTELMODULE(StelMovementMgr);
+			mvmgr->moveToObject(newSelected[0], mvmgr->getAutoMoveDuration());
+			mvmgr->setFlagTracking(true);
+		}
+	}
+}
@@ -58,6 +58,20 @@ public:
 		IridiumFlaresCount	//! total number of columns
 	};
 
+	//! Defines the number and the order of the columns in the passes table
+	//! @enum PassesColumns
+	enum PassesColumns {
+		PassesSatellite,	//! satellite name
+		PassesAOS,		//! date and time of the rise above the minimum elevation
+		PassesTCA,		//! date and time of the highest elevation
+		PassesLOS,		//! date and time of the set below the minimum elevation
+		PassesMaxElevation,	//! highest elevation
+		PassesAOSAzimuth,	//! azimuth at AOS
+		PassesLOSAzimuth,	//! azimuth at LOS
+		PassesVisible,		//! time during which the satellite can be seen
+		PassesCount		//! total number of columns
+	};
+
 	SatellitesDialog();
 	~SatellitesDialog();
 
@@ -113,6 +127,10 @@ private slots:
 	void selectCurrentIridiumFlare(const QModelIndex &modelIndex);
 	void savePredictedIridiumFlares();
 
+	void predictPasses();
+	void selectCurrentPass(const QModelIndex &modelIndex);
+	void savePredictedPasses();
+
 	void setFlagRealisticMode(bool state);
 
 	void searchSatellitesClear();
@@ -150,6 +168,15 @@ private:
 
 	//! Init header and list of Iridium flares
 	void initListIridiumFlares();
+
+	//! Update header names for the passes table
+	void setPassesHeaderNames();
+
+	//! Init header and list of passes
+	void initListPasses();
+
+	//! Save a table of predictions as CSV.
+	void savePredictions(QTreeWidget* treeWidget, const QStringList& header, const QString& title, const QString& fileName);
 	
 	Ui_satellitesDialog* ui;
 	bool satelliteModified;
@@ -165,6 +192,7 @@ private:
 
 	QString delimiter, acEndl;
 	QStringList iridiumFlaresHeader;
+	QStringList passesHeader;
 
 	// colorpickerbutton's color
 	QColor buttonColor;
@@ -195,4 +223,25 @@ private:
 	}
 };
 
+// Sorts the passes by the value stored in Qt::UserRole, if any
+class SatPassesTreeWidgetItem : public QTreeWidgetItem
+{
+public:
+	SatPassesTreeWidgetItem(QTreeWidget* parent)
+		: QTreeWidgetItem(parent)
+	{
+	}
+
+private:
+	bool operator < (const QTreeWidgetItem &other) const
+	{
+		int column = treeWidget()->sortColumn();
+		const QVariant value = data(column, Qt::UserRole);
+		if (value.isValid())
+			return value.toDouble() < other.data(column, Qt::UserRole).toDouble();
+		else
+			return text(column).toLower() < other.text(column).toLower();
+	}
+};
+
 #endif // _SATELLITESDIALOG_HPP
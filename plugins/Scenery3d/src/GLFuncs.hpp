@@ -33,10 +33,13 @@ class GLExtFuncs : public QOpenGLFunctions_1_0
 public:
 	//! Since 3.2
 	PFNGLFRAMEBUFFERTEXTUREPROC glFramebufferTexture;
+	//! Since 3.1
+	PFNGLDRAWELEMENTSINSTANCEDPROC glDrawElementsInstanced;
 
 	void init(QOpenGLContext* ctx)
 	{
 		glFramebufferTexture = (PFNGLFRAMEBUFFERTEXTUREPROC)ctx->getProcAddress("glFramebufferTexture");
+		glDrawElementsInstanced = (PFNGLDRAWELEMENTSINSTANCEDPROC)ctx->getProcAddress("glDrawElementsInstanced");
 
 		if(!ctx->isOpenGLES())
 			initializeOpenGLFunctions();
@@ -19,17 +19,22 @@
  */
 
 #include <limits>
+#include <cmath>
 
 #include "Heightmap.hpp"
 #include "VecMath.hpp"
 #include "GeomMath.hpp"
 
 #include <QElapsedTimer>
+#include <QtConcurrent>
 
 #define INF (std::numeric_limits<float>::max())
 #define NO_HEIGHT (-INF)
 
-Heightmap::Heightmap() : rootNode(Q_NULLPTR), grid(Q_NULLPTR), nullHeight(0.0)
+const float Heightmap::RASTER_RESOLUTION = 0.1f;
+const float Heightmap::RASTER_MAX_STEP = 0.2f;
+
+Heightmap::Heightmap() : rootNode(Q_NULLPTR), grid(Q_NULLPTR), nullHeight(0.0), rasterWidth(0), rasterHeight(0), rasterStep(0.0f)
 {
 }
 
@@ -72,6 +77,9 @@ void Heightmap::setMeshData(const IdxList &indexList, const PosList &posList, co
 	timer.start();
 	this->initGrid();
 	qDebug()<<"initGrid\t\t"<<qSetFieldWidth(12)<<right<<timer.nsecsElapsed();
+	timer.start();
+	this->initRaster();
+	qDebug()<<"initRaster\t\t"<<qSetFieldWidth(12)<<right<<timer.nsecsElapsed()<<qSetFieldWidth(0)<<rasterWidth<<"x"<<rasterHeight<<"step"<<rasterStep;
 }
 
 /**
@@ -80,6 +88,37 @@ void Heightmap::setMeshData(const IdxList &indexList, const PosList &posList, co
  * coordinates.
  */
 float Heightmap::getHeight(const float x, const float y) const
+{
+	if(rasterWidth < 2 || rasterHeight < 2)
+		return getExactHeight(x, y);
+
+	const float fx = (x - min[0]) / rasterStep;
+	const float fy = (y - min[1]) / rasterStep;
+	if(!(fx >= 0.0f && fy >= 0.0f && fx <= rasterWidth-1 && fy <= rasterHeight-1))
+	{
+		//outside the ground, this also catches NaN
+		return nullHeight;
+	}
+
+	const int ix = std::min(static_cast<int>(fx), rasterWidth-2);
+	const int iy = std::min(static_cast<int>(fy), rasterHeight-2);
+	const float* row = raster.constData() + iy*rasterWidth + ix;
+	const float h00 = row[0], h10 = row[1];
+	const float h01 = row[rasterWidth], h11 = row[rasterWidth+1];
+
+	//bilinear interpolation would smooth out holes, walls and steps, these need the exact triangles.
+	//NO_HEIGHT is the lowest float, so it also ends up here
+	const float hMin = std::min(std::min(h00,h10),std::min(h01,h11));
+	const float hMax = std::max(std::max(h00,h10),std::max(h01,h11));
+	if(hMin == NO_HEIGHT || hMax - hMin > RASTER_MAX_STEP)
+		return getExactHeight(x, y);
+
+	const float tx = fx - ix;
+	const float ty = fy - iy;
+	return (h00 * (1.0f-tx) + h10 * tx) * (1.0f-ty) + (h01 * (1.0f-tx) + h11 * tx) * ty;
+}
+
+float Heightmap::getExactHeight(const float x, const float y) const
 {
 	/*QElapsedTimer timer;
 	timer.start();
@@ -89,28 +128,28 @@ float Heightmap::getHeight(const float x, const float y) const
 	qint64 qtTime = timer.nsecsElapsed();
 	timer.start();*/
 
-	Heightmap::GridSpace* space = getSpace(x, y);
-	if (space == Q_NULLPTR)
+	float h = getGridHeight(x, y);
+	//qint64 gridTime = timer.nsecsElapsed();
+	//qDebug()<<"qt"<<qtTime<<"grid"<<gridTime;
+	//Q_ASSERT(height == h);
+	if (h == NO_HEIGHT)
 	{
 		return nullHeight;
 	}
 	else
 	{
-		float h = space->getHeight(posList, x, y);
-		//qint64 gridTime = timer.nsecsElapsed();
-		//qDebug()<<"qt"<<qtTime<<"grid"<<gridTime;
-		//Q_ASSERT(height == h);
-		if (h == NO_HEIGHT)
-		{
-			return nullHeight;
-		}
-		else
-		{
-			return h;
-		}
+		return h;
 	}
 }
 
+float Heightmap::getGridHeight(const float x, const float y) const
+{
+	Heightmap::GridSpace* space = getSpace(x, y);
+	if (space == Q_NULLPTR)
+		return NO_HEIGHT;
+	return space->getHeight(posList, x, y);
+}
+
 /**
  * Height query within a single grid space. The list of faces to check
  * for intersection with the observer coords is limited to faces
@@ -207,6 +246,42 @@ void Heightmap::initGrid()
 	}
 }
 
+/**
+ * Samples the exact heights on a regular raster, so that getHeight
+ * does not have to intersect triangles for each query.
+ */
+void Heightmap::initRaster()
+{
+	raster.clear();
+	rasterWidth = rasterHeight = 0;
+	rasterStep = RASTER_RESOLUTION;
+
+	if(indexList.isEmpty() || !(range[0] > 0.0f) || !(range[1] > 0.0f))
+		return;
+
+	//reduce resolution if the scene is too large
+	const float area = range[0] * range[1];
+	if(area / (rasterStep * rasterStep) > RASTER_MAX_SAMPLES)
+		rasterStep = std::sqrt(area / RASTER_MAX_SAMPLES);
+
+	rasterWidth = static_cast<int>(std::ceil(range[0] / rasterStep)) + 1;
+	rasterHeight = static_cast<int>(std::ceil(range[1] / rasterStep)) + 1;
+	raster.resize(rasterWidth * rasterHeight);
+
+	//each row is independent
+	QVector<int> rows(rasterHeight);
+	for(int y = 0; y<rasterHeight; ++y)
+		rows[y] = y;
+	float* data = raster.data();
+	QtConcurrent::blockingMap(rows, [this, data](const int& y)
+	{
+		float* row = data + y*rasterWidth;
+		const float py = min[1] + y * rasterStep;
+		for(int x = 0; x<rasterWidth; ++x)
+			row[x] = getGridHeight(min[0] + x * rasterStep, py);
+	});
+}
+
 /**
  * Returns the GridSpace which covers the area around x/y.
  */
@@ -42,11 +42,17 @@ public:
 
         //! Get z Value at (x,y) coordinates.
         //! In case of ambiguities always returns the maximum height.
+        //! This interpolates bilinearly on a raster of heights precomputed in setMeshData,
+        //! and only falls back to getExactHeight near holes and steps of the ground.
         //! @param x x-value
         //! @param y y-value
         //! @return z-Value at position given by x and y
         float getHeight(const float x, const float y) const;
 
+        //! Get z Value at (x,y) coordinates by intersecting the triangles of the ground mesh.
+        //! In case of ambiguities always returns the maximum height.
+        float getExactHeight(const float x, const float y) const;
+
         //! set/retrieve default height
         void setNullHeight(float h){nullHeight=h;}
         float getNullHeight() const {return nullHeight;}
@@ -56,6 +62,9 @@ private:
 	PosList posList;
 
         static const int GRID_LENGTH = 60; // # of grid spaces is GRID_LENGTH^2
+	static const float RASTER_RESOLUTION; // desired distance of the height raster samples in model units (m)
+	static const int RASTER_MAX_SAMPLES = 4*1024*1024; // the resolution is reduced for larger scenes
+	static const float RASTER_MAX_STEP; // if the samples around a point differ more than this, the exact height is used
 
 	typedef QVector<const unsigned int*> FaceVector; //points to first index in Index list for a face
 
@@ -114,9 +123,18 @@ private:
 	Vec2f min, max, range;
         float nullHeight; // return value for areas outside grid
 
+	//! Heights sampled at min + (i,j)*rasterStep, NO_HEIGHT where there is no ground
+	QVector<float> raster;
+	int rasterWidth, rasterHeight;
+	float rasterStep;
+
 	void initQuadtree();
         void initGrid();
+	//! Samples the grid into the height raster
+	void initRaster();
         GridSpace* getSpace(const float x, const float y) const ;
+	//! Returns the maximum height of the faces at x/y, or NO_HEIGHT
+	float getGridHeight(const float x, const float y) const;
 	static bool triangle_intersects_bbox(const Vec2f &t1, const Vec2f &t2, const Vec2f &t3, const Vec2f &rMin, const Vec2f &rMax);
 	//! Check whether points p and q lie on the same side of line ab, helper for line_intersects_triangle
 	inline static bool sameSide(const Vec2f& p, const Vec2f& q, const Vec2f& a, const Vec2f& b);
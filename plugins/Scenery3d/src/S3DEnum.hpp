@@ -39,7 +39,10 @@ public:
 		//! Uses a single GL_TEXTURE_CUBEMAP, seems to work a bit better on "modern" GPUs
 		CM_CUBEMAP,
 		//! Uses a single GL_TEXTURE_CUBEMAP and a geometry shader to render all 6 sides in one pass.
-		CM_CUBEMAP_GSACCEL
+		CM_CUBEMAP_GSACCEL,
+		//! Uses a single GL_TEXTURE_CUBEMAP and instanced rendering to render all 6 sides in one pass without a geometry shader.
+		//! The vertex shader selects the side through gl_Layer, which requires GL_ARB_shader_viewport_layer_array or GL_AMD_vertex_shader_layer.
+		CM_CUBEMAP_LAYERED
 	};
 
 	//! Contains different shadow filter settings
@@ -40,6 +40,8 @@
 #include <QSettings>
 #include <stdexcept>
 #include <cmath>
+#include <algorithm>
+#include <functional>
 #include <QOpenGLShaderProgram>
 #include <QLoggingCategory>
 
@@ -69,21 +71,21 @@ S3DRenderer::S3DRenderer(QObject *parent)
       QObject(parent),
       sun(Q_NULLPTR), moon(Q_NULLPTR), venus(Q_NULLPTR),
       currentScene(Q_NULLPTR),
-      supportsGSCubemapping(false), supportsShadows(false), supportsShadowFiltering(false), isANGLE(false), maximumFramebufferSize(0),
+      supportsGSCubemapping(false), supportsLayeredCubemapping(false), supportsShadows(false), supportsShadowFiltering(false), isANGLE(false), maximumFramebufferSize(0),
       defaultFBO(-1),
-      torchBrightness(0.5f), torchRange(5.0f), textEnabled(false), debugEnabled(false), fixShadowData(false),
+      torchBrightness(0.5f), torchRange(5.0f), textEnabled(false), debugEnabled(false), frustumCulling(true), lodEnabled(true), lodPixelError(1.0f), lodPixelScale(1.0f), fixShadowData(false),
       simpleShadows(false), fullCubemapShadows(false), cubemappingMode(S3DEnum::CM_TEXTURES), //set it to 6 textures as a safe default (Cubemap should work on ANGLE, but does not...)
       reinitCubemapping(true), reinitShadowmapping(true),
       cubemapSize(1024),shadowmapSize(1024),wasMovedInLastDrawCall(false),
       core(Q_NULLPTR), landscapeMgr(Q_NULLPTR),
-      backfaceCullState(true), blendEnabled(false), lastMaterial(Q_NULLPTR), curShader(Q_NULLPTR),
-      drawnTriangles(0), drawnModels(0), materialSwitches(0), shaderSwitches(0),
+      backfaceCullState(true), blendEnabled(false), lastMaterial(Q_NULLPTR), curShader(Q_NULLPTR), transparentSortValid(false),
+      drawnTriangles(0), drawnModels(0), materialSwitches(0), shaderSwitches(0), culledGroups(0), renderedShadowSplits(0), simplifiedDraws(0), cullVolumeCount(1), cullingActive(false), lastFaceMask(0),
       requiresCubemap(false), cubemappingUsedLastFrame(false),
       lazyDrawing(false), updateOnlyDominantOnMoving(true), updateSecondDominantOnMoving(true), needsMovementEndUpdate(false),
       needsCubemapUpdate(true), needsMovementUpdate(false), lazyInterval(2.0), lastCubemapUpdate(0.0), lastCubemapUpdateRealTime(0), lastMovementEndRealTime(0),
       cubeMapCubeTex(0), cubeMapCubeDepth(0), cubeMapTex(), cubeRB(0), dominantFace(0), secondDominantFace(1), cubeFBO(0), cubeSideFBO(), cubeMappingCreated(false),
       cubeVertexBuffer(QOpenGLBuffer::VertexBuffer), transformedCubeVertexBuffer(QOpenGLBuffer::VertexBuffer), cubeIndexBuffer(QOpenGLBuffer::IndexBuffer), cubeIndexCount(0),
-      lightOrthoNear(0.1f), lightOrthoFar(1000.0f), parallaxScale(0.015f)
+      lightOrthoNear(0.1f), lightOrthoFar(1000.0f), shadowCaching(true), shadowCacheAngle(0.1f), shadowCacheNextSplit(0), parallaxScale(0.015f)
 {
 	#ifndef NDEBUG
 	qCDebug(s3drenderer)<<"Scenery3d constructor...";
@@ -100,6 +102,7 @@ S3DRenderer::S3DRenderer(QObject *parent)
 	shaderParameters.shadowFilterQuality = S3DEnum::SFQ_LOW;
 	shaderParameters.pcss = false;
 	shaderParameters.geometryShader = false;
+	shaderParameters.vertexLayer = false;
 	shaderParameters.torchLight = false;
 	shaderParameters.frustumSplits = 0;
 	shaderParameters.hwShadowSamplers = false;
@@ -273,14 +276,79 @@ void S3DRenderer::setupMaterialUniforms(QOpenGLShaderProgram* shader, const S3DS
 	}
 }
 
-//depth sort helper
-Vec3f zSortValue;
-bool zSortFunction(const StelOBJ::MaterialGroup* const & mLeft, const StelOBJ::MaterialGroup* const & mRight)
+int S3DRenderer::visibleVolumes(const AABBox &box, int volumes, bool *inside) const
 {
-	//we can avoid taking the sqrt here
-	float dist1 = (mLeft->centroid - zSortValue).lengthSquared();
-	float dist2 = (mRight->centroid - zSortValue).lengthSquared();
-	return dist1>dist2;
+	bool allInside = true;
+	int visible = 0;
+	for(int v=0; v<cullVolumeCount; ++v)
+	{
+		if(!(volumes & (1<<v)))
+			continue;
+
+		bool isVisible = true;
+		bool isInside = true;
+		for(const auto& plane : cullPlanes[v])
+		{
+			//the corner furthest along the plane normal, and the one opposite to it
+			const float pMax = plane.x() * (plane.x()>0 ? box.max[0] : box.min[0])
+					 + plane.y() * (plane.y()>0 ? box.max[1] : box.min[1])
+					 + plane.z() * (plane.z()>0 ? box.max[2] : box.min[2]) + plane.w();
+			if(pMax < 0.0f)
+			{
+				isVisible = false;
+				break;
+			}
+			const float pMin = plane.x() * (plane.x()>0 ? box.min[0] : box.max[0])
+					 + plane.y() * (plane.y()>0 ? box.min[1] : box.max[1])
+					 + plane.z() * (plane.z()>0 ? box.min[2] : box.max[2]) + plane.w();
+			if(pMin < 0.0f)
+				isInside = false;
+		}
+		if(isVisible)
+		{
+			visible |= (1<<v);
+			allInside = allInside && isInside;
+		}
+	}
+	if(inside)
+		*inside = allInside;
+	return visible;
+}
+
+void S3DRenderer::addOpaqueDraw(OpaqueDraw &draw, const Vec3f &eye)
+{
+	//distance to the nearest point of the bounding box
+	draw.distanceSquared = 0.0f;
+	for(int k=0; k<3; ++k)
+	{
+		const float d = std::max(std::max(draw.batch.boundingbox.min[k] - eye[k], eye[k] - draw.batch.boundingbox.max[k]), 0.0f);
+		draw.distanceSquared += d*d;
+	}
+	opaqueDraws.append(draw);
+}
+
+int S3DRenderer::levelOfDetail(const AABBox &box, const Vec3f &eye, bool farthest) const
+{
+	if(!lodEnabled)
+		return 0;
+	const QVector<float>& cellSizes = currentScene->getLevelOfDetailCellSizes();
+	if(cellSizes.isEmpty())
+		return 0;
+
+	float distSquared = 0.0f;
+	for(int k=0; k<3; ++k)
+	{
+		const float d = farthest ? std::max(std::abs(box.min[k] - eye[k]), std::abs(box.max[k] - eye[k]))
+					 : std::max(std::max(box.min[k] - eye[k], eye[k] - box.max[k]), 0.0f);
+		distSquared += d*d;
+	}
+
+	//the projected size of a cell is about cellSize / distance * lodPixelScale
+	const float maxCellSize = lodPixelError * std::sqrt(distSquared) / lodPixelScale;
+	int level = 0;
+	while(level < cellSizes.size() && cellSizes.at(level) <= maxCellSize)
+		++level;
+	return level;
 }
 
 bool S3DRenderer::drawArrays(bool shading, bool blendAlphaAdditive)
@@ -310,57 +378,173 @@ bool S3DRenderer::drawArrays(bool shading, bool blendAlphaAdditive)
 	lastMaterial = Q_NULLPTR;
 	curShader = Q_NULLPTR;
 	initializedShaders.clear();
-	transparentGroups.clear();
+	opaqueDraws.clear();
+	transparentBatches.clear();
 	bool success = true;
 
-	//TODO optimize: clump models with same material together when first loading to minimize state changes
+	const S3DScene::DrawBatchList& materialBatches = currentScene->getMaterialBatches();
+	const S3DScene::DrawBatchList& groupBatches = currentScene->getGroupBatches();
+	const Vec3f eye = currentScene->getEyePosition().toVec3f();
 
-	const S3DScene::ObjectList& objectList = currentScene->getObjects();
-	for(int i=0; i<objectList.size(); ++i)
+	//extract the view volume of this pass from the MVP matrix (Gribb/Hartmann), this works for perspective and ortho passes alike.
+	//When drawing all cubemap faces with instancing, each face has its own volume, and each batch is only drawn into the faces it is visible in.
+	//When the geometry shader draws all cubemap faces at once, there is nothing to cull against.
+	cullVolumeCount = renderShaderParameters.vertexLayer ? 6 : 1;
+	const int allVolumes = (1<<cullVolumeCount) - 1;
+	cullingActive = frustumCulling && !renderShaderParameters.geometryShader;
+	if(cullingActive)
 	{
-		const StelOBJ::Object& obj = objectList.at(i);
-		const StelOBJ::MaterialGroupList& matGroups = obj.groups;
-
-		for(int j = 0; j < matGroups.size();++j)
+		for(int v=0; v<cullVolumeCount; ++v)
 		{
-			const StelOBJ::MaterialGroup& matGroup = matGroups.at(j);
-			const S3DScene::Material* pMaterial = &currentScene->getMaterial(matGroup.materialIndex);
-			Q_ASSERT(pMaterial);
+			const QMatrix4x4 mvp = renderShaderParameters.vertexLayer ? cubeMVP[v] : projectionMatrix * modelViewMatrix;
+			const QVector4D row3 = mvp.row(3);
+			for(int i=0; i<3; ++i)
+			{
+				cullPlanes[v][2*i] = row3 + mvp.row(i);
+				cullPlanes[v][2*i+1] = row3 - mvp.row(i);
+			}
+		}
+	}
+
+	//the faces of each material are a single batch, see S3DScene::buildDrawBatches
+	for(int i=0; i<materialBatches.size(); ++i)
+	{
+		const S3DScene::DrawBatch& batch = materialBatches.at(i);
+		const S3DScene::Material* pMaterial = &currentScene->getMaterial(batch.materialIndex);
 
-			if(pMaterial->traits.isFullyTransparent)
-				continue; //dont render fully invisible objects
+		if(pMaterial->traits.isFullyTransparent)
+			continue; //dont render fully invisible objects
 
-			if(shading)
+		if(shading)
+		{
+			if(pMaterial->traits.hasTransparency || pMaterial->traits.isFading)
 			{
-				if(pMaterial->traits.hasTransparency || pMaterial->traits.isFading)
-				{
-					//process transparent objects later, with Z sorting
-					transparentGroups.append(&matGroup);
-					continue;
-				}
+				//process transparent objects later, with Z sorting
+				transparentBatches.append(i);
+				continue;
 			}
-			else
+		}
+		else
+		{
+			//objects start casting shadows with at least 0.2 opacity
+			if(pMaterial->d * pMaterial->vis_fadeValue < 0.2)
+				continue;
+		}
+
+		OpaqueDraw draw;
+		draw.shader = shaderManager.getShader(renderShaderParameters,pMaterial);
+		draw.backface = pMaterial->bBackface;
+
+		//test the whole material first, and only test its groups if it is partially visible
+		bool inside = true;
+		draw.faceMask = allVolumes;
+		if(cullingActive)
+		{
+			draw.faceMask = visibleVolumes(batch.boundingbox, allVolumes, &inside);
+			if(!draw.faceMask)
 			{
-				//objects start casting shadows with at least 0.2 opacity
-				if(pMaterial->d * pMaterial->vis_fadeValue < 0.2)
-					continue;
+				culledGroups += batch.groupCount;
+				continue;
 			}
+		}
+		//the whole material can be drawn at once if all its groups use the same level of detail
+		const int level = levelOfDetail(batch.boundingbox, eye);
+		if(inside && level == levelOfDetail(batch.boundingbox, eye, true))
+		{
+			draw.batch = batch.atLevelOfDetail(level);
+			if(level>0)
+				++simplifiedDraws;
+			if(draw.batch.indexCount>0)
+				addOpaqueDraw(draw, eye);
+			continue;
+		}
 
-			success = drawMaterialGroup(matGroup,shading,blendAlphaAdditive);
-			if(!success)
-				break;
+		//the groups of a material follow each other in the index list (also in each level of detail),
+		//so runs of groups visible in the same faces with the same level of detail are still drawn at once
+		const int materialMask = draw.faceMask;
+		const int endGroup = batch.firstGroup + batch.groupCount;
+		int group = batch.firstGroup;
+		while(group<endGroup)
+		{
+			draw.faceMask = inside ? materialMask : visibleVolumes(groupBatches.at(group).boundingbox, materialMask);
+			if(!draw.faceMask)
+			{
+				++culledGroups;
+				++group;
+				continue;
+			}
+			const int groupLevel = levelOfDetail(groupBatches.at(group).boundingbox, eye);
+			draw.batch = groupBatches.at(group++).atLevelOfDetail(groupLevel);
+			while(group<endGroup && (inside || visibleVolumes(groupBatches.at(group).boundingbox, materialMask) == draw.faceMask)
+			      && levelOfDetail(groupBatches.at(group).boundingbox, eye) == groupLevel)
+			{
+				const S3DScene::DrawBatch next = groupBatches.at(group++).atLevelOfDetail(groupLevel);
+				draw.batch.indexCount += next.indexCount;
+				draw.batch.boundingbox.expand(next.boundingbox);
+			}
+			if(groupLevel>0)
+				++simplifiedDraws;
+			if(draw.batch.indexCount>0)
+				addOpaqueDraw(draw, eye);
 		}
 	}
 
+	//sort opaque batches by shader and culling state to minimize state changes,
+	//and front-to-back for the same state to make the most of early depth tests
+	std::sort(opaqueDraws.begin(), opaqueDraws.end(), [](const OpaqueDraw& a, const OpaqueDraw& b)
+	{
+		if(a.shader!=b.shader)
+			return std::less<QOpenGLShaderProgram*>()(a.shader, b.shader);
+		if(a.backface!=b.backface)
+			return b.backface;
+		return a.distanceSquared < b.distanceSquared;
+	});
+
+	for(const auto& draw : opaqueDraws)
+	{
+		success = drawBatch(draw.batch,draw.shader,shading,blendAlphaAdditive,draw.faceMask);
+		if(!success)
+			break;
+	}
+
 	//sort and render transparent objects
-	if(transparentGroups.size()>0)
+	if(success && transparentBatches.size()>0)
 	{
-		zSortValue = currentScene->getEyePosition().toVec3f();
-		std::sort(transparentGroups.begin(),transparentGroups.end(),zSortFunction);
+		//the order only depends on the eye position and the transparent materials
+		if(!transparentSortValid || eye!=transparentSortEye || transparentBatches!=transparentSortBatches)
+		{
+			transparentGroups.clear();
+			for(int i : transparentBatches)
+			{
+				const S3DScene::DrawBatch& batch = materialBatches.at(i);
+				for(int j=batch.firstGroup; j<batch.firstGroup+batch.groupCount; ++j)
+					transparentGroups.append(&groupBatches.at(j));
+			}
+			std::sort(transparentGroups.begin(),transparentGroups.end(), [&eye](const S3DScene::DrawBatch* a, const S3DScene::DrawBatch* b)
+			{
+				//we can avoid taking the sqrt here
+				return (a->centroid - eye).lengthSquared() > (b->centroid - eye).lengthSquared();
+			});
+			transparentSortEye = eye;
+			transparentSortBatches = transparentBatches;
+			transparentSortValid = true;
+		}
 
 		for(int i = 0; i<transparentGroups.size();++i)
 		{
-			success = drawMaterialGroup(*transparentGroups[i],shading,blendAlphaAdditive);
+			const int faceMask = cullingActive ? visibleVolumes(transparentGroups[i]->boundingbox, allVolumes) : allVolumes;
+			if(!faceMask)
+			{
+				++culledGroups;
+				continue;
+			}
+			const int level = levelOfDetail(transparentGroups[i]->boundingbox, eye);
+			if(level>0)
+				++simplifiedDraws;
+			const S3DScene::DrawBatch transparentBatch = transparentGroups[i]->atLevelOfDetail(level);
+			if(transparentBatch.indexCount==0)
+				continue;
+			success = drawBatch(transparentBatch,Q_NULLPTR,shading,blendAlphaAdditive,faceMask);
 			if(!success)
 				break;
 		}
@@ -382,9 +566,9 @@ bool S3DRenderer::drawArrays(bool shading, bool blendAlphaAdditive)
 	return success;
 }
 
-bool S3DRenderer::drawMaterialGroup(const StelOBJ::MaterialGroup &matGroup, bool shading, bool blendAlphaAdditive)
+bool S3DRenderer::drawBatch(const S3DScene::DrawBatch &batch, QOpenGLShaderProgram *shader, bool shading, bool blendAlphaAdditive, int faceMask)
 {
-	const S3DScene::Material* pMaterial = &currentScene->getMaterial(matGroup.materialIndex);
+	const S3DScene::Material* pMaterial = &currentScene->getMaterial(batch.materialIndex);
 
 	if(lastMaterial!=pMaterial)
 	{
@@ -392,7 +576,7 @@ bool S3DRenderer::drawMaterialGroup(const StelOBJ::MaterialGroup &matGroup, bool
 		lastMaterial = pMaterial;
 
 		//get a shader from shadermgr that fits the current state + material combo
-		QOpenGLShaderProgram* newShader = shaderManager.getShader(renderShaderParameters,pMaterial);
+		QOpenGLShaderProgram* newShader = shader ? shader : shaderManager.getShader(renderShaderParameters,pMaterial);
 		if(!newShader)
 		{
 			//shader invalid, can't draw
@@ -403,6 +587,7 @@ bool S3DRenderer::drawMaterialGroup(const StelOBJ::MaterialGroup &matGroup, bool
 		{
 			curShader = newShader;
 			curShader->bind();
+			lastFaceMask = 0;
 			if(!initializedShaders.contains(curShader))
 			{
 				++shaderSwitches;
@@ -470,9 +655,30 @@ bool S3DRenderer::drawMaterialGroup(const StelOBJ::MaterialGroup &matGroup, bool
 	}
 
 
-	currentScene->glDraw(matGroup.startIndex,matGroup.indexCount);
+	if(renderShaderParameters.vertexLayer)
+	{
+		//each instance draws into one of the faces the batch is visible in
+		GLint faces[6];
+		int faceCount = 0;
+		for(int i=0; i<6; ++i)
+			if(faceMask & (1<<i))
+				faces[faceCount++] = i;
+		if(faceMask!=lastFaceMask)
+		{
+			GLint loc = shaderManager.uniformLocation(curShader,ShaderMgr::UNIFORM_INT_CUBEFACES);
+			if(loc>=0)
+				curShader->setUniformValueArray(loc,faces,faceCount);
+			lastFaceMask = faceMask;
+		}
+		currentScene->glDrawInstanced(batch.startIndex,batch.indexCount,faceCount);
+		drawnModels+=faceCount;
+		drawnTriangles+=faceCount*batch.indexCount/3;
+		return true;
+	}
+
+	currentScene->glDraw(batch.startIndex,batch.indexCount);
 	++drawnModels;
-	drawnTriangles+=matGroup.indexCount/3;
+	drawnTriangles+=batch.indexCount/3;
 	return true;
 }
 
@@ -752,9 +958,46 @@ bool S3DRenderer::renderShadowMaps()
 
 	bool success = true;
 
+	//Find out which splits have to be re-rendered. A split whose frustum or shadow caster changed is always updated.
+	//If only the light direction drifted past the threshold, the update is spread over several frames, one split per frame,
+	//because the cached CPM of each split still matches its cached depth map.
+	//A large jump of the light (e.g. a time jump) updates everything at once.
+	QVector<bool> renderSplit(shaderParameters.frustumSplits, true);
+	if(shadowCaching && shadowCache.size() == shaderParameters.frustumSplits)
+	{
+		const float cosThreshold = std::cos(shadowCacheAngle * static_cast<float>(M_PI/180.0));
+		const float cosJump = std::cos(std::min(10.0f * shadowCacheAngle, 90.0f) * static_cast<float>(M_PI/180.0));
+		int driftedSplit = -1;
+		for(int n=0; n<shaderParameters.frustumSplits; n++)
+		{
+			//start searching at the round-robin position
+			const int i = (shadowCacheNextSplit + n) % shaderParameters.frustumSplits;
+			const ShadowCacheEntry& entry = shadowCache.at(i);
+			if(!entry.valid || entry.caster != lightInfo.shadowCaster || entry.corners != frustumArray.at(i).corners)
+				continue;
+			const float cosAngle = entry.lightDirection.dot(lightInfo.lightDirectionV3f);
+			if(cosAngle >= cosThreshold || lightInfo.shadowCaster == LightParameters::SC_None)
+				renderSplit[i] = false;
+			else if(cosAngle >= cosJump)
+			{
+				//only drifted, update the first of these
+				if(driftedSplit >= 0)
+					renderSplit[i] = false;
+				else
+					driftedSplit = i;
+			}
+		}
+		if(driftedSplit >= 0)
+			shadowCacheNextSplit = (driftedSplit + 1) % shaderParameters.frustumSplits;
+	}
+
 	//For each split
 	for(int i=0; i<shaderParameters.frustumSplits; i++)
 	{
+		if(!renderSplit.at(i))
+			continue;
+		++renderedShadowSplits;
+
 		//Find the convex body that encompasses all shadow receivers and casters for this split
 		focusBodies[i].clear();
 		computePolyhedron(focusBodies[i],frustumArray[i],lightInfo.lightDirectionV3f);
@@ -785,8 +1028,20 @@ bool S3DRenderer::renderShadowMaps()
 				break;
 			}
 		}
+
+		if(i < shadowCache.size())
+		{
+			ShadowCacheEntry& entry = shadowCache[i];
+			entry.valid = true;
+			entry.caster = lightInfo.shadowCaster;
+			entry.lightDirection = lightInfo.lightDirectionV3f;
+			entry.corners = frustumArray.at(i).corners;
+		}
 	}
 
+	if(!success)
+		invalidateShadowCache();
+
 
 	//Unbind
 	glBindFramebuffer(GL_FRAMEBUFFER, defaultFBO);
@@ -1063,6 +1318,24 @@ void S3DRenderer::renderIntoCubemapGeometryShader()
 	shaderParameters.geometryShader = false;
 }
 
+void S3DRenderer::renderIntoCubemapLayered()
+{
+	//single FBO like in the GS mode, but each draw call is instanced once per visible face instead
+	glBindFramebuffer(GL_FRAMEBUFFER,cubeFBO);
+
+	//same hack as in renderIntoCubemapGeometryShader, the lighting only needs the position
+	modelViewMatrix.setToIdentity();
+	Vec3d negEyePos = -currentScene->getEyePosition();
+	modelViewMatrix.translate(negEyePos.v[0], negEyePos.v[1], negEyePos.v[2]);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	shaderParameters.vertexLayer = true;
+	//the face matrices are also used for culling each batch against each face
+	calcCubeMVP(negEyePos);
+	drawArrays(true,true);
+	shaderParameters.vertexLayer = false;
+}
+
 void S3DRenderer::renderShadowMapsForFace(int face)
 {
 	//extract view dir from the MV matrix
@@ -1159,6 +1432,10 @@ void S3DRenderer::generateCubeMap()
 	//recalculate lighting info
 	calculateLighting();
 
+	//the layered mode falls back to single faces when only the dominant faces are updated during movement
+	const bool dominantOnly = needsMovementUpdate && updateOnlyDominantOnMoving;
+	const bool singlePass = cubemappingMode == S3DEnum::CM_CUBEMAP_GSACCEL || (cubemappingMode == S3DEnum::CM_CUBEMAP_LAYERED && !dominantOnly);
+
 	//do shadow pass
 	//only calculate shadows if enabled
 	if(shaderParameters.shadows)
@@ -1166,8 +1443,8 @@ void S3DRenderer::generateCubeMap()
 		//shadow caster info only needs to be calculated once
 		calculateShadowCaster();
 
-		//GS mode only supports the perspective shadows
-		if(!fullCubemapShadows || cubemappingMode == S3DEnum::CM_CUBEMAP_GSACCEL)
+		//single-pass modes only support the perspective shadows
+		if(!fullCubemapShadows || singlePass)
 		{
 			//in this mode, shadow frusta are calculated the same as in perspective mode
 			float fov = altAzProjector->getFov();
@@ -1199,6 +1476,11 @@ void S3DRenderer::generateCubeMap()
 		//In this mode, only the "perspective" shadow mode can be used (otherwise it would need up to 6*4 shadowmaps at once)
 		renderIntoCubemapGeometryShader();
 	}
+	else if(singlePass)
+	{
+		//same restriction for shadows as above
+		renderIntoCubemapLayered();
+	}
 	else
 	{
 		renderIntoCubemapSixPasses();
@@ -1583,6 +1865,15 @@ void S3DRenderer::drawDebug()
 	str = QString("%1 tris, %2 mdls").arg(drawnTriangles).arg(drawnModels);
 	painter.drawText(screen_x, screen_y, str);
 	screen_y -= 15.0f;
+	str = QString("%1 groups culled").arg(culledGroups);
+	painter.drawText(screen_x, screen_y, str);
+	screen_y -= 15.0f;
+	str = QString("%1 shadow splits rendered").arg(renderedShadowSplits);
+	painter.drawText(screen_x, screen_y, str);
+	screen_y -= 15.0f;
+	str = QString("%1 simplified draws").arg(simplifiedDraws);
+	painter.drawText(screen_x, screen_y, str);
+	screen_y -= 15.0f;
 	str = QString("%1 mats, %2 shaders").arg(materialSwitches).arg(shaderSwitches);
 	painter.drawText(screen_x, screen_y, str);
 	screen_y -= 15.0f;
@@ -1662,6 +1953,18 @@ void S3DRenderer::determineFeatureSupport()
 	else
 		qCWarning(s3drenderer)<<"Geometry shader not supported on this hardware";
 
+#ifndef QT_OPENGL_ES_2
+	//check if the vertex shader can select the cubemap face, and instancing is available to draw all faces at once
+	if(supportsGSCubemapping && !ctx->isOpenGLES() && glExtFuncs->glDrawElementsInstanced &&
+			(ctx->hasExtension("GL_ARB_shader_viewport_layer_array") || ctx->hasExtension("GL_AMD_vertex_shader_layer")))
+	{
+		this->supportsLayeredCubemapping = true;
+		qCDebug(s3drenderer)<<"Layered cubemapping supported";
+	}
+	else
+		qCDebug(s3drenderer)<<"Layered cubemapping not supported on this hardware";
+#endif
+
 	//Query how many texture units we have at disposal in a fragment shader
 	//we currently need 8 in the worst case: diffuse, emissive, bump, height + 4x shadowmap
 	GLint texUnits,combUnits;
@@ -1818,6 +2121,12 @@ bool S3DRenderer::initCubemapping()
 	cubeMappingCreated = true;
 
 	//last compatibility check before possible crash
+	if( !isLayeredCubemapSupported() && cubemappingMode == S3DEnum::CM_CUBEMAP_LAYERED)
+	{
+		rendererMessage(q_("Layered cubemapping is not supported. Falling back to 'Geometry shader' mode."));
+		qCWarning(s3drenderer)<<"Layered cubemapping not supported, fallback to 'Geometry shader'";
+		cubemappingMode = S3DEnum::CM_CUBEMAP_GSACCEL;
+	}
 	if( !isGeometryShaderCubemapSupported() && cubemappingMode == S3DEnum::CM_CUBEMAP_GSACCEL)
 	{
 		rendererMessage(q_("Geometry shader is not supported. Falling back to '6 Textures' mode."));
@@ -1850,7 +2159,7 @@ bool S3DRenderer::initCubemapping()
 
 	glActiveTexture(GL_TEXTURE0);
 
-	if(cubemappingMode >= S3DEnum::CM_CUBEMAP) //CUBEMAP or CUBEMAP_GSACCEL
+	if(cubemappingMode >= S3DEnum::CM_CUBEMAP) //CUBEMAP, CUBEMAP_GSACCEL or CUBEMAP_LAYERED
 	{
 		//gen cube tex
 		glGenTextures(1,&cubeMapCubeTex);
@@ -1900,7 +2209,7 @@ bool S3DRenderer::initCubemapping()
 	}
 
 	//create depth texture/RB
-	if(cubemappingMode == S3DEnum::CM_CUBEMAP_GSACCEL)
+	if(cubemappingMode >= S3DEnum::CM_CUBEMAP_GSACCEL)
 	{
 		//a single cubemap depth texture
 		glGenTextures(1,&cubeMapCubeDepth);
@@ -1956,7 +2265,7 @@ bool S3DRenderer::initCubemapping()
 	}
 
 	//generate FBO/FBOs
-	if(cubemappingMode == S3DEnum::CM_CUBEMAP_GSACCEL)
+	if(cubemappingMode >= S3DEnum::CM_CUBEMAP_GSACCEL)
 	{
 		//only 1 FBO used
 		//create fbo
@@ -1981,6 +2290,30 @@ bool S3DRenderer::initCubemapping()
 		}
 		else
 			ret = true;
+
+		if(ret && cubemappingMode == S3DEnum::CM_CUBEMAP_LAYERED)
+		{
+			//additionally, 1 FBO per face for updating only the dominant faces
+			glGenFramebuffers(6,cubeSideFBO);
+
+			GET_GLERROR()
+
+			for(int i=0;i<6;++i)
+			{
+				glBindFramebuffer(GL_FRAMEBUFFER, cubeSideFBO[i]);
+				glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,cubeMapCubeTex,0);
+				glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,cubeMapCubeDepth,0);
+
+				GET_GLERROR()
+
+				if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+				{
+					qCWarning(s3drenderer) << "glCheckFramebufferStatus failed for a single cube face, probably can't use cube map";
+					ret = false;
+					break;
+				}
+			}
+		}
 	}
 	else
 	{
@@ -2198,6 +2531,12 @@ bool S3DRenderer::initCubemapping()
 	return ret;
 }
 
+void S3DRenderer::invalidateShadowCache()
+{
+	for(int i=0; i<shadowCache.size(); i++)
+		shadowCache[i].valid = false;
+}
+
 void S3DRenderer::deleteShadowmapping()
 {
 	if(shadowFBOs.size()>0) //kinda hack that finds out if shadowmap related objects have been created
@@ -2212,6 +2551,7 @@ void S3DRenderer::deleteShadowmapping()
 		shadowFrustumSize.clear();
 		frustumArray.clear();
 		focusBodies.clear();
+		shadowCache.clear();
 
 		qCDebug(s3drenderer)<<"Shadowmapping objects cleaned up";
 	}
@@ -2248,6 +2588,7 @@ bool S3DRenderer::initShadowmapping()
 		shadowFrustumSize.resize(shaderParameters.frustumSplits);
 		frustumArray.resize(shaderParameters.frustumSplits);
 		focusBodies.resize(shaderParameters.frustumSplits);
+		shadowCache.fill(ShadowCacheEntry(), shaderParameters.frustumSplits);
 
 		//For shadowmapping, we use create 1 SM FBO for each frustum split - this seems to be the optimal solution on modern GPUs,
 		//see http://www.reddit.com/r/opengl/comments/1rsnhy/most_efficient_fbo_usage_in_multipass_pipeline/
@@ -2366,18 +2707,29 @@ void S3DRenderer::draw(StelCore* core, S3DScene &scene)
 	{
 		scene.glLoad();
 		invalidateCubemap();
+		//the sorted transparent groups belong to the previous scene
+		transparentSortValid = false;
+		transparentGroups.clear();
+		//the cached shadow maps show the previous scene
+		invalidateShadowCache();
+		queueShaderPrecompilation(scene);
 	}
 
 	//find out the default FBO
 	defaultFBO = StelApp::getInstance().getDefaultFBO();
 	currentScene = &scene;
 
+	//the shadow and cubemap passes must not be clipped to the sky rectangle of StelCore
+	StelOpenGL::ScissorSuspender noScissor;
+
 	//reset render statistic
-	drawnTriangles = drawnModels = materialSwitches = shaderSwitches = 0;
+	drawnTriangles = drawnModels = materialSwitches = shaderSwitches = culledGroups = renderedShadowSplits = simplifiedDraws = 0;
 
 	requiresCubemap = core->getCurrentProjectionType() != StelCore::ProjectionPerspective;
 	//update projector from core
 	altAzProjector = core->getProjection(StelCore::FrameAltAz, StelCore::RefractionOff);
+	//a 90 degree cubemap face has cubemapSize/2 pixels per radian at its center
+	lodPixelScale = requiresCubemap ? cubemapSize * 0.5f : altAzProjector->getPixelPerRadAtCenter();
 
 	if(requiresCubemap)
 	{
@@ -2512,6 +2864,42 @@ void S3DRenderer::draw(StelCore* core, S3DScene &scene)
 	lastDrawnPosition = currentScene->getEyePosition();
 	cubemappingUsedLastFrame = requiresCubemap;
 	currentScene = Q_NULLPTR;
+
+	//spend a bit of each frame on shaders which may be needed after the next setting change
+	shaderManager.precompileQueued(2);
+}
+
+void S3DRenderer::queueShaderPrecompilation(const S3DScene &scene)
+{
+	const S3DScene::MaterialList& materials = scene.getMaterialList();
+
+	//the current settings come first, then with shadows, bump mapping and the torch toggled
+	GlobalShaderParameters params = shaderParameters;
+	params.shadowTransform = false;
+	params.geometryShader = false;
+	params.vertexLayer = false;
+	if(params.frustumSplits == 0)
+		params.frustumSplits = simpleShadows ? 1 : 4;
+	for(int i = 0; i<8; ++i)
+	{
+		GlobalShaderParameters variant = params;
+		if(i & 1) variant.shadows = !variant.shadows && supportsShadows;
+		if(i & 2) variant.bump = !variant.bump;
+		if(i & 4) variant.torchLight = !variant.torchLight;
+		shaderManager.queuePrecompilation(variant, materials);
+	}
+
+	//the shadow pass, and the single-pass cubemap mode if used
+	GlobalShaderParameters shadowPass = params;
+	shadowPass.shadowTransform = true;
+	shaderManager.queuePrecompilation(shadowPass, materials);
+	if(cubemappingMode == S3DEnum::CM_CUBEMAP_GSACCEL || cubemappingMode == S3DEnum::CM_CUBEMAP_LAYERED)
+	{
+		GlobalShaderParameters cube = params;
+		cube.geometryShader = cubemappingMode == S3DEnum::CM_CUBEMAP_GSACCEL;
+		cube.vertexLayer = cubemappingMode == S3DEnum::CM_CUBEMAP_LAYERED;
+		shaderManager.queuePrecompilation(cube, materials);
+	}
 }
 
 void S3DRenderer::rendererMessage(const QString &msg) const
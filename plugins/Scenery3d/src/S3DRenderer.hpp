@@ -77,6 +77,26 @@ public:
 	bool getLocationInfoEnabled(void) const { return textEnabled; }
 	void setLocationInfoEnabled(bool locationinfoenabled) { this->textEnabled = locationinfoenabled; }
 
+	//! If enabled, material groups outside of the view volume of each pass (main view, cubemap faces, shadow cascades) are not drawn
+	bool getFrustumCullingEnabled() const { return frustumCulling; }
+	void setFrustumCullingEnabled(bool val) { frustumCulling = val; invalidateCubemap(); }
+
+	//! If enabled, the shadow map of a split is only re-rendered when its frustum or the shadow caster changes,
+	//! or when the light direction has moved more than the angle set with setShadowCacheAngle
+	bool getShadowCacheEnabled() const { return shadowCaching; }
+	void setShadowCacheEnabled(bool val) { shadowCaching = val; invalidateShadowCache(); invalidateCubemap(); }
+	//! The angle in degrees the light direction can move before cached shadow maps are re-rendered
+	float getShadowCacheAngle() const { return shadowCacheAngle; }
+	void setShadowCacheAngle(float degrees) { shadowCacheAngle = degrees; invalidateShadowCache(); }
+
+	//! If enabled, distant material groups are drawn with the simplified faces of the scene's levels of detail.
+	//! This also decides if levels of detail are built when a scene is loaded.
+	bool getLevelOfDetailEnabled() const { return lodEnabled; }
+	void setLevelOfDetailEnabled(bool val) { lodEnabled = val; invalidateShadowCache(); invalidateCubemap(); }
+	//! The simplification error in pixels (the projected size of a level's cluster cell) up to which a level of detail is used
+	float getLevelOfDetailPixelError() const { return lodPixelError; }
+	void setLevelOfDetailPixelError(float pixels) { lodPixelError = pixels; invalidateShadowCache(); invalidateCubemap(); }
+
 	bool getLazyCubemapEnabled() const { return lazyDrawing; }
 	void setLazyCubemapEnabled(bool val) { lazyDrawing = val; }
 	double getLazyCubemapInterval() const { return lazyInterval; }
@@ -94,6 +114,11 @@ public:
 	//! This may not set the actual mode to the parameter, call getCubemappingMode to find out what was set.
 	void setCubemappingMode(S3DEnum::CubemappingMode mode)
 	{
+		if(mode == S3DEnum::CM_CUBEMAP_LAYERED && !isLayeredCubemapSupported())
+		{
+			//fallback to the other single-pass mode
+			mode = S3DEnum::CM_CUBEMAP_GSACCEL;
+		}
 		if(mode == S3DEnum::CM_CUBEMAP_GSACCEL && !isGeometryShaderCubemapSupported())
 		{
 			//fallback to 6 Textures mode
@@ -130,6 +155,7 @@ public:
 	//these are some properties that determine the features supported in the current GL context
 	//available after init() is called
 	bool isGeometryShaderCubemapSupported() const { return supportsGSCubemapping; }
+	bool isLayeredCubemapSupported() const { return supportsLayeredCubemapping; }
 	bool areShadowsSupported() const { return supportsShadows; }
 	bool isShadowFilteringSupported() const { return supportsShadowFiltering; }
 	bool isANGLEContext() const { return isANGLE; }
@@ -144,6 +170,7 @@ private:
 	S3DScene* currentScene;
 
 	bool supportsGSCubemapping; //if the GL context supports geometry shader cubemapping
+	bool supportsLayeredCubemapping; //if the GL context supports instanced cubemapping with gl_Layer written by the vertex shader
 	bool supportsShadows; //if shadows are supported
 	bool supportsShadowFiltering; //if shadow filtering is supported
 	bool isANGLE; //true if running on ANGLE
@@ -155,6 +182,11 @@ private:
 
 	bool textEnabled;           // switchable value: display coordinates on screen. THIS IS NOT FOR DEBUGGING, BUT A PROGRAM FEATURE!
 	bool debugEnabled;          // switchable value: display debug graphics and debug texts on screen
+	bool frustumCulling;
+	bool lodEnabled;
+	float lodPixelError;
+	//! Pixels per radian at the center of the current view (or of a cubemap face), to find the projected size of the level of detail cells
+	float lodPixelScale;
 	bool fixShadowData; //for debugging, fixes all shadow mapping related data (shadowmap contents, matrices, frustums, focus bodies...) at their current values
 	bool simpleShadows;
 	bool fullCubemapShadows;
@@ -178,11 +210,52 @@ private:
 	const S3DScene::Material* lastMaterial;
 	QOpenGLShaderProgram* curShader;
 	QSet<QOpenGLShaderProgram*> initializedShaders;
-	QVector<const StelOBJ::MaterialGroup*> transparentGroups;
+	//! An opaque batch to draw, with the keys it is sorted by.
+	//! This may be only a part of a material batch, if some of its groups are culled.
+	struct OpaqueDraw
+	{
+		S3DScene::DrawBatch batch;
+		QOpenGLShaderProgram* shader;
+		bool backface;
+		float distanceSquared;
+		//! Bit i is set if the batch is visible on cubemap face i (layered cubemapping), or bit 0 if it is visible at all
+		int faceMask;
+	};
+	QVector<OpaqueDraw> opaqueDraws;
+	//! Indices in S3DScene::getMaterialBatches() of the transparent batches of the current pass
+	QVector<int> transparentBatches;
+	//! The material groups of the transparent batches, sorted back-to-front for transparentSortEye
+	QVector<const S3DScene::DrawBatch*> transparentGroups;
+	//! The eye position and transparent batches for which transparentGroups has been sorted.
+	//! The order can be reused as long as these do not change, e.g. for all faces of a cubemap or the next frame.
+	Vec3f transparentSortEye;
+	QVector<int> transparentSortBatches;
+	bool transparentSortValid;
 
 	// debug info
 	int drawnTriangles,drawnModels;
 	int materialSwitches, shaderSwitches;
+	int culledGroups;
+	int renderedShadowSplits;
+	int simplifiedDraws;
+
+	//! The planes of the view volumes of the current pass, in model space. The normals point inwards.
+	//! There is one view volume per cubemap face when all faces are drawn with instancing, one otherwise.
+	QVector4D cullPlanes[6][6];
+	int cullVolumeCount;
+	//! True if cullPlanes is valid for the current pass. Culling is not possible for cubemaps drawn by the geometry shader.
+	bool cullingActive;
+	//! The faceMask for which u_iCubeFaces was last set on curShader
+	int lastFaceMask;
+	//! Returns the subset of the view volumes in @p volumes (bit i for cullPlanes[i]) which the box at least partially intersects.
+	//! If @p inside is given, it is set to true if the box is completely inside all of the returned volumes.
+	int visibleVolumes(const AABBox& box, int volumes, bool* inside = Q_NULLPTR) const;
+	//! Sets the distance of the draw to the eye, and queues it for drawArrays()
+	void addOpaqueDraw(OpaqueDraw& draw, const Vec3f& eye);
+	//! Returns the coarsest level of detail of the current scene whose cells appear no larger than lodPixelError,
+	//! seen from @p eye at the nearest (or, if @p farthest is true, the farthest) point of the box. 0 means full detail.
+	//! The eye position is the same for all passes of a frame, so shadow casters match their receivers.
+	int levelOfDetail(const AABBox& box, const Vec3f& eye, bool farthest = false) const;
 
 	/// ---- Cubemapping variables ----
 	bool requiresCubemap; //true if cubemapping is required (if projection is anything else than Perspective)
@@ -198,14 +271,15 @@ private:
 	qint64 lastCubemapUpdateRealTime; //when the last lazy draw happened (real system time, QDateTime::currentMSecsSinceEpoch)
 	qint64 lastMovementEndRealTime; //the timepoint when the last movement was stopped
 	GLuint cubeMapCubeTex; //GL_TEXTURE_CUBE_MAP, used in CUBEMAP or CUBEMAP_GSACCEL modes
-	GLuint cubeMapCubeDepth; //this is a depth-cubemap, only used in CUBEMAP_GSACCEL mode
+	GLuint cubeMapCubeDepth; //this is a depth-cubemap, only used in CUBEMAP_GSACCEL and CUBEMAP_LAYERED modes
 	GLuint cubeMapTex[6]; //GL_TEXTURE_2D, for "legacy" TEXTURES mode
 	GLuint cubeRB; //renderbuffer for depth of a single face in TEXTURES and CUBEMAP modes (attached to multiple FBOs)
 	int dominantFace,secondDominantFace;
 
 	//because of use that deviates very much from QOpenGLFramebufferObject typical usage, we manage the FBOs ourselves
-	GLuint cubeFBO; //used in CUBEMAP_GSACCEL mode - only a single FBO exists, with a cubemap for color and one for depth
+	GLuint cubeFBO; //used in CUBEMAP_GSACCEL and CUBEMAP_LAYERED mode - only a single FBO exists, with a cubemap for color and one for depth
 	GLuint cubeSideFBO[6]; //used in TEXTURES and CUBEMAP mode, 6 textures/cube faces for color and a shared depth renderbuffer (we don't require the depth after rendering)
+			       //in CUBEMAP_LAYERED mode, these hold the single faces of the color and depth cubemaps for updates of the dominant faces
 
 	bool cubeMappingCreated; //true if any cubemapping objects have been initialized and need to be cleaned up eventually
 
@@ -274,6 +348,24 @@ private:
 	//Vector holding the convex split bodies for focused shadow mapping
 	QVector<Polyhedron> focusBodies;
 
+	//! The state for which the shadow map of a split was last rendered
+	struct ShadowCacheEntry
+	{
+		ShadowCacheEntry() : valid(false), caster(LightParameters::SC_None) {}
+		bool valid;
+		LightParameters::ShadowCaster caster;
+		Vec3f lightDirection;
+		std::vector<Vec3f> corners;
+	};
+	//! One entry per split, the cached CPM and frustum size are kept in shadowCPM and shadowFrustumSize
+	QVector<ShadowCacheEntry> shadowCache;
+	bool shadowCaching;
+	float shadowCacheAngle;
+	//! Round-robin counter, so that only one split is updated per frame when only the light direction moved
+	int shadowCacheNextSplit;
+	//! Forces all shadow maps to be re-rendered in the next shadow pass
+	void invalidateShadowCache();
+
 	float parallaxScale;
 
 	QFont debugTextFont;
@@ -306,16 +398,22 @@ private:
 	void generateCubeMap();
 	//! Uses a geometry shader to render 6 faces in 1 pass
 	void renderIntoCubemapGeometryShader();
+	//! Uses instancing, with the face selected in the vertex shader, to render 6 faces in 1 pass
+	void renderIntoCubemapLayered();
 	//! Uses 6 traditional rendering passes to render into a cubemap or 6 textures.
 	void renderIntoCubemapSixPasses();
 	//! Uses the StelPainter to draw a warped cube textured with our cubemap
 	void drawFromCubeMap();
 	//! This is the method that performs the actual drawing.
-	//! If shading is true, a suitable shader for each material is selected and initialized. Submits 1 draw call for each StelModel.
+	//! If shading is true, a suitable shader for each material is selected and initialized.
+	//! Opaque materials are drawn with 1 draw call each, sorted by shader and render state, and front-to-back for the same state.
+	//! Transparent materials are drawn with 1 draw call for each material group, sorted back-to-front.
 	//! @return false on shader errors
 	bool drawArrays(bool shading=true, bool blendAlphaAdditive=false);
-	//! Draws a single material group, to be use from within drawArrays
-	bool drawMaterialGroup(const StelOBJ::MaterialGroup& matGroup, bool shading, bool blendAlphaAdditive);
+	//! Draws a single batch, to be use from within drawArrays
+	//! @param shader the shader for the material of the batch, or Q_NULLPTR to find it
+	//! @param faceMask the cubemap faces to draw the batch into, only used for layered cubemapping
+	bool drawBatch(const S3DScene::DrawBatch& batch, QOpenGLShaderProgram* shader, bool shading, bool blendAlphaAdditive, int faceMask = 1);
 
 	//! Draw observer grid coordinates as text.
 	void drawCoordinatesText();
@@ -333,6 +431,9 @@ private:
 	void setupFrameUniforms(QOpenGLShaderProgram *shader);
 	//! Sets up shader uniforms specific to one material
 	void setupMaterialUniforms(QOpenGLShaderProgram *shader, const S3DScene::Material& mat);
+	//! Queues the shaders of the scene's materials for the current settings, and the ones likely needed after toggling
+	//! shadows, bump mapping or the torch, so that ShaderMgr can load them in the background of the next frames
+	void queueShaderPrecompilation(const S3DScene& scene);
 
 	//! Adjust the frustum to the loaded scene bounding box according to Zhang et al.
 	void adjustShadowFrustum(const Vec3d &viewPos, const Vec3d &viewDir, const Vec3d &viewUp, const float fov, const float aspect);
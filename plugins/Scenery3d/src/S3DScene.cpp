@@ -19,6 +19,7 @@
  */
 
 #include "S3DScene.hpp"
+#include "GLFuncs.hpp"
 
 #include "StelApp.hpp"
 #include "StelCore.hpp"
@@ -28,6 +29,8 @@
 
 #include <QVector3D>
 
+#include <algorithm>
+
 Q_LOGGING_CATEGORY(s3dscene, "stel.plugin.scenery3d.s3dscene")
 
 void S3DScene::Material::loadTexturesAsync()
@@ -212,6 +215,8 @@ void S3DScene::setModel(const StelOBJ &model)
 	modelData = model;
 	//transform the model
 	modelData.transform(zRot2Grid);
+	//make the faces of each material contiguous, to draw them with as few state changes as possible
+	modelData.sortByMaterial();
 	sceneAABB = modelData.getAABBox();
 
 	//copy materials
@@ -226,6 +231,7 @@ void S3DScene::setModel(const StelOBJ &model)
 
 	//copy objects
 	objects = modelData.getObjectList();
+	buildDrawBatches();
 
 	if(info.hasLocation())
 	{
@@ -272,10 +278,74 @@ void S3DScene::setModel(const StelOBJ &model)
 	}
 }
 
+void S3DScene::buildDrawBatches()
+{
+	lodCellSizes = modelData.getLevelOfDetailCellSizes().mid(0, MAX_LEVELS_OF_DETAIL);
+
+	//collect the groups of each material, they are contiguous after StelOBJ::sortByMaterial
+	QVector<DrawBatchList> batchesByMaterial(materials.size());
+	for(const auto& obj : objects)
+	{
+		for(const auto& grp : obj.groups)
+		{
+			DrawBatch batch;
+			batch.materialIndex = grp.materialIndex;
+			batch.startIndex = grp.startIndex;
+			batch.indexCount = grp.indexCount;
+			batch.groupCount = 1;
+			batch.centroid = grp.centroid;
+			batch.boundingbox = grp.boundingbox;
+			for(int l=0;l<lodCellSizes.size();++l)
+				batch.levelsOfDetail[l] = grp.levelsOfDetail.at(l);
+			batchesByMaterial[grp.materialIndex].append(batch);
+		}
+	}
+
+	materialBatches.clear();
+	groupBatches.clear();
+	for(int i=0;i<batchesByMaterial.size();++i)
+	{
+		DrawBatchList& list = batchesByMaterial[i];
+		if(list.isEmpty())
+			continue;
+
+		//the groups of different objects are in file order in the index list
+		std::sort(list.begin(), list.end(), [](const DrawBatch& a, const DrawBatch& b) { return a.startIndex < b.startIndex; });
+
+		DrawBatch batch;
+		batch.materialIndex = i;
+		batch.startIndex = list.first().startIndex;
+		batch.firstGroup = groupBatches.size();
+		batch.groupCount = list.size();
+		for(int l=0;l<lodCellSizes.size();++l)
+			batch.levelsOfDetail[l].startIndex = list.first().levelsOfDetail[l].startIndex;
+		Vec3d centroid(0.);
+		for(const auto& grp : list)
+		{
+			Q_ASSERT(grp.startIndex == batch.startIndex + batch.indexCount);
+			batch.indexCount += grp.indexCount;
+			//the simplified faces of each level are in the same order
+			for(int l=0;l<lodCellSizes.size();++l)
+			{
+				Q_ASSERT(grp.levelsOfDetail[l].startIndex == batch.levelsOfDetail[l].startIndex + batch.levelsOfDetail[l].indexCount);
+				batch.levelsOfDetail[l].indexCount += grp.levelsOfDetail[l].indexCount;
+			}
+			batch.boundingbox.expand(grp.boundingbox);
+			centroid += grp.centroid.toVec3d() * grp.indexCount;
+		}
+		batch.centroid = (centroid / batch.indexCount).toVec3f();
+		materialBatches.append(batch);
+		groupBatches += list;
+	}
+	qCDebug(s3dscene)<<"Scene uses"<<materialBatches.size()<<"draw batches for"<<groupBatches.size()<<"material groups";
+}
+
 void S3DScene::setGround(const StelOBJ &ground)
 {
 	//we only need to retain the position data for the ground
 	StelOBJ groundTmp = ground;
+	//the collision mesh always uses the full-detail faces
+	groundTmp.clearLevelsOfDetail();
 	groundTmp.transform(zRot2Grid,true);
 	StelOBJ::V3Vec groundPositionList;
 	groundTmp.splitVertexData(&groundPositionList);
@@ -349,6 +419,17 @@ bool S3DScene::glLoad()
 	return ok;
 }
 
+void S3DScene::glDrawInstanced(int offset, int count, int instanceCount) const
+{
+#ifndef QT_OPENGL_ES_2
+	glExtFuncs->glDrawElementsInstanced(GL_TRIANGLES, count, glArray.getIndexBufferType(),
+					    reinterpret_cast<const GLvoid*>(offset * glArray.getIndexBufferTypeSize()), instanceCount);
+#else
+	Q_UNUSED(offset); Q_UNUSED(count); Q_UNUSED(instanceCount);
+	Q_ASSERT_X(false, "S3DScene::glDrawInstanced", "instancing is not available on OpenGL ES 2");
+#endif
+}
+
 void S3DScene::moveViewer(const Vec3d &moveView)
 {
 	//get the azimuth angle of the current view vector
@@ -105,6 +105,40 @@ public:
 	};
 
 	typedef QVector<Material> MaterialList;
+
+	//! The maximum number of levels of detail used besides the full-detail faces
+	static const int MAX_LEVELS_OF_DETAIL = 4;
+
+	//! A range of the index buffer drawn with a single material, in a single draw call
+	struct DrawBatch
+	{
+		DrawBatch() : materialIndex(-1), startIndex(0), indexCount(0), firstGroup(0), groupCount(0), centroid(0.f) {}
+
+		//! Returns this batch with the faces of the given level of detail, 0 being the full-detail faces
+		DrawBatch atLevelOfDetail(int level) const
+		{
+			DrawBatch b = *this;
+			if(level > 0)
+			{
+				b.startIndex = levelsOfDetail[level-1].startIndex;
+				b.indexCount = levelsOfDetail[level-1].indexCount;
+			}
+			return b;
+		}
+
+		int materialIndex;
+		int startIndex;
+		int indexCount;
+		//! For the batches of getMaterialBatches(), the range of the batches in getGroupBatches()
+		//! that make up this batch, e.g. for depth sorting of transparent materials.
+		int firstGroup;
+		int groupCount;
+		Vec3f centroid;
+		AABBox boundingbox;
+		//! The simplified faces of this batch for each level of detail, see getLevelOfDetailCellSizes()
+		StelOBJ::IndexRange levelsOfDetail[MAX_LEVELS_OF_DETAIL];
+	};
+	typedef QVector<DrawBatch> DrawBatchList;
 	//for now, this does not use custom extensions...
 	typedef StelOBJ::ObjectList ObjectList;
 
@@ -116,8 +150,17 @@ public:
 	const SceneInfo& getSceneInfo() const { return info; }
 
 	MaterialList& getMaterialList() { return materials; }
+	const MaterialList& getMaterialList() const { return materials; }
 	const Material& getMaterial(int index) const { return materials.at(index); }
 	const ObjectList& getObjects() const { return objects; }
+	//! Returns one batch for each material used by the model, covering all the faces using this material.
+	//! The faces of the model are sorted by material on loading, so that this is possible.
+	const DrawBatchList& getMaterialBatches() const { return materialBatches; }
+	//! Returns one batch for each material group of each object, grouped by material
+	const DrawBatchList& getGroupBatches() const { return groupBatches; }
+	//! Returns the cluster cell size of each level of detail of the batches, from the finest to the coarsest.
+	//! The simplification error of a level is about its cell size. Empty if the model has no levels of detail.
+	const QVector<float>& getLevelOfDetailCellSizes() const { return lodCellSizes; }
 
 	//! Moves the viewer according to the given move vector
 	//!  (which is specified relative to the view direction and current position)
@@ -153,11 +196,16 @@ public:
 	inline void glBind() { glArray.bind(); }
 	inline void glRelease() { glArray.release(); }
 	inline void glDraw(int offset, int count) const { glArray.draw(offset,count); }
+	//! Draws the \p count indices starting at \p offset \p instanceCount times. Requires OpenGL 3.1.
+	void glDrawInstanced(int offset, int count, int instanceCount) const;
 
 private:
 	inline void recalcEyePos() { eyePosition = position; eyePosition[2]+=eye_height; }
 	MaterialList materials;
 	ObjectList objects;
+	DrawBatchList materialBatches;
+	DrawBatchList groupBatches;
+	QVector<float> lodCellSizes;
 
 
 	bool glReady;
@@ -182,6 +230,8 @@ private:
 	StelOpenGLArray glArray;
 
 	static void finalizeTexture(StelTextureSP& tex);
+	//! Builds the draw batches from the material groups of the objects
+	void buildDrawBatches();
 };
 
 #endif // S3DSCENE_HPP
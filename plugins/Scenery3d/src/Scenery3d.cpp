@@ -18,6 +18,7 @@
  * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
  */
 
+#include <QCryptographicHash>
 #include <QDebug>
 #include <QSettings>
 #include <QString>
@@ -56,6 +57,7 @@ Q_LOGGING_CATEGORY(scenery3d,"stel.plugin.scenery3d")
 Scenery3d::Scenery3d() :
 	renderer(Q_NULLPTR),
 	flagEnabled(false),
+	flagSceneCache(true),
 	cleanedUp(false),
 	movementKeyInput(0.0,0.0,0.0),
 	oldProjectionType(StelCore::ProjectionPerspective),
@@ -310,12 +312,18 @@ void Scenery3d::loadConfig()
 	renderer->setLazyCubemapInterval(conf->value("cubemap_lazy_interval",1.0).toDouble());
 	renderer->setPixelLightingEnabled(conf->value("flag_pixel_lighting", false).toBool());
 	renderer->setLocationInfoEnabled(conf->value("flag_location_info", false).toBool());
+	renderer->setFrustumCullingEnabled(conf->value("flag_frustum_culling", true).toBool());
+	renderer->setShadowCacheEnabled(conf->value("flag_shadow_cache", true).toBool());
+	renderer->setShadowCacheAngle(conf->value("shadow_cache_angle", 0.1f).toFloat());
+	renderer->setLevelOfDetailEnabled(conf->value("flag_lod", true).toBool());
+	renderer->setLevelOfDetailPixelError(conf->value("lod_pixel_error", 1.0f).toFloat());
 
 	bool v1 = conf->value("flag_lazy_dominantface",false).toBool();
 	bool v2 = conf->value("flag_lazy_seconddominantface",true).toBool();
 	renderer->setLazyCubemapUpdateOnlyDominantFaceOnMoving(v1,v2);
 
 	defaultScenery3dID = conf->value("default_location_id","").toString();
+	flagSceneCache = conf->value("flag_scene_cache", true).toBool();
 
 	conf->endGroup();
 }
@@ -459,7 +467,7 @@ S3DScene* Scenery3d::loadSceneBackground(const SceneInfo& scene) const
 	StelOBJ modelOBJ;
 	QString modelFile = StelFileMgr::findFile( scene.fullPath+ "/" + scene.modelScenery);
 	qCDebug(scenery3d)<<"Loading scene from "<<modelFile;
-	if(!modelOBJ.load(modelFile, scene.vertexOrderEnum))
+	if(!loadSceneOBJ(modelOBJ, modelFile, scene.vertexOrderEnum, renderer->getLevelOfDetailEnabled()))
 	{
 	    qCCritical(scenery3d)<<"Failed to load OBJ file"<<modelFile;
 	    return Q_NULLPTR;
@@ -486,7 +494,7 @@ S3DScene* Scenery3d::loadSceneBackground(const SceneInfo& scene) const
 		StelOBJ groundOBJ;
 		modelFile = StelFileMgr::findFile(scene.fullPath + "/" + scene.modelGround);
 		qCDebug(scenery3d)<<"Loading ground from"<<modelFile;
-		if(!groundOBJ.load(modelFile, scene.vertexOrderEnum))
+		if(!loadSceneOBJ(groundOBJ, modelFile, scene.vertexOrderEnum))
 		{
 			qCCritical(scenery3d)<<"Failed to load ground model"<<modelFile;
 			return Q_NULLPTR;
@@ -508,6 +516,50 @@ S3DScene* Scenery3d::loadSceneBackground(const SceneInfo& scene) const
 	return newScene.take();
 }
 
+bool Scenery3d::loadSceneOBJ(StelOBJ &obj, const QString &modelFile, StelOBJ::VertexOrder vertexOrder, bool levelsOfDetail) const
+{
+	QString cacheFile;
+	if(flagSceneCache)
+	{
+		// the same file may be used with different vertex orders by different scenes
+		const QByteArray key = QFileInfo(modelFile).absoluteFilePath().toUtf8() + "/" + QByteArray::number(vertexOrder);
+		cacheFile = StelFileMgr::getCacheDir() + "/scenery3d/"
+				+ QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex()) + ".s3dobj";
+		if(QFileInfo(cacheFile).exists() && obj.loadCompiled(cacheFile, modelFile, vertexOrder)
+		   && (!levelsOfDetail || obj.getLevelOfDetailCount()>0))
+		{
+			qCDebug(scenery3d)<<"Loaded compiled scene from"<<cacheFile;
+			return true;
+		}
+	}
+
+	if(!obj.isLoaded() && !obj.load(modelFile, vertexOrder))
+		return false;
+
+	//each level clusters 4 times coarser, the last one only keeps the rough shape of buildings for the far distance
+	const float sceneSize = (obj.getAABBox().max - obj.getAABBox().min).length();
+	if(levelsOfDetail && obj.getLevelOfDetailCount()==0 && sceneSize>0.0f)
+	{
+		QVector<float> cellSizes;
+		cellSizes<<sceneSize/1024.0f<<sceneSize/256.0f<<sceneSize/64.0f;
+		obj.buildLevelsOfDetail(cellSizes);
+	}
+
+	if(!cacheFile.isEmpty())
+	{
+		try
+		{
+			StelFileMgr::makeSureDirExistsAndIsWritable(QFileInfo(cacheFile).absolutePath());
+			obj.saveCompiled(cacheFile);
+		}
+		catch (std::runtime_error& e)
+		{
+			qCWarning(scenery3d)<<"Cannot create scene cache directory:"<<e.what();
+		}
+	}
+	return true;
+}
+
 void Scenery3d::loadSceneCompleted()
 {
 	S3DScene* result = currentLoadFuture.result();
@@ -1003,6 +1055,11 @@ bool Scenery3d::getIsGeometryShaderSupported() const
 	return renderer->isGeometryShaderCubemapSupported();
 }
 
+bool Scenery3d::getIsLayeredCubemapSupported() const
+{
+	return renderer->isLayeredCubemapSupported();
+}
+
 bool Scenery3d::getAreShadowsSupported() const
 {
 	return renderer->areShadowsSupported();
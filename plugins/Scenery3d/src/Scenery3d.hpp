@@ -99,6 +99,7 @@ class Scenery3d : public StelModule
 
 	//these properties are only valid after init() has been called
 	Q_PROPERTY(bool isGeometryShaderSupported READ getIsGeometryShaderSupported)
+	Q_PROPERTY(bool isLayeredCubemapSupported READ getIsLayeredCubemapSupported)
 	Q_PROPERTY(bool areShadowsSupported READ getAreShadowsSupported)
 	Q_PROPERTY(bool isShadowFilteringSupported READ getIsShadowFilteringSupported)
 	Q_PROPERTY(bool isANGLE READ getIsANGLE)
@@ -259,6 +260,7 @@ public slots:
 
     //these properties are only valid after init() has been called
     bool getIsGeometryShaderSupported() const;
+    bool getIsLayeredCubemapSupported() const;
     bool getAreShadowsSupported() const;
     bool getIsShadowFilteringSupported() const;
     bool getIsANGLE() const;
@@ -312,6 +314,10 @@ private:
 
     //! This is run asynchronously in a background thread, performing the actual scene loading
     S3DScene *loadSceneBackground(const SceneInfo &scene) const;
+    //! Loads an OBJ file of a scene, using the compiled copy in the scene cache if it is still valid.
+    //! Otherwise, the .obj is parsed, and compiled into the cache for the next time.
+    //! If \p levelsOfDetail is true, simplified faces for distant geometry are built before compiling.
+    bool loadSceneOBJ(StelOBJ& obj, const QString& modelFile, StelOBJ::VertexOrder vertexOrder, bool levelsOfDetail = false) const;
 
     // the other "main" objects
     S3DRenderer* renderer;
@@ -321,6 +327,8 @@ private:
     QSettings* conf;
     QString defaultScenery3dID;
     bool flagEnabled;
+    //! Keep compiled copies of the OBJ files of scenes in the cache directory
+    bool flagSceneCache;
     bool cleanedUp;
 
     Vec3d movementKeyInput;
@@ -21,11 +21,13 @@
 #include "StelOpenGL.hpp"
 #include "ShaderManager.hpp"
 #include "StelFileMgr.hpp"
+#include "StelProgramCache.hpp"
 
 #include <QDir>
 #include <QOpenGLShaderProgram>
 #include <QCryptographicHash>
 #include <QDebug>
+#include <QElapsedTimer>
 
 Q_LOGGING_CATEGORY(shaderMgr, "stel.plugin.scenery3d.shadermgr")
 
@@ -48,6 +50,9 @@ ShaderMgr::ShaderMgr()
 		uniformStrings["u_mCubeMVP"] = UNIFORM_MAT_CUBEMVP;
 		uniformStrings["u_mCubeMVP[]"] = UNIFORM_MAT_CUBEMVP;
 		uniformStrings["u_mCubeMVP[0]"] = UNIFORM_MAT_CUBEMVP;
+		uniformStrings["u_iCubeFaces"] = UNIFORM_INT_CUBEFACES;
+		uniformStrings["u_iCubeFaces[]"] = UNIFORM_INT_CUBEFACES;
+		uniformStrings["u_iCubeFaces[0]"] = UNIFORM_INT_CUBEFACES;
 
 		//textures
 		uniformStrings["u_texDiffuse"] = UNIFORM_TEX_DIFFUSE;
@@ -105,6 +110,7 @@ ShaderMgr::ShaderMgr()
 		featureFlagsStrings["SINGLE_SHADOW_FRUSTUM"] = SINGLE_SHADOW_FRUSTUM;
 		featureFlagsStrings["OGL_ES2"] = OGL_ES2;
 		featureFlagsStrings["HW_SHADOW_SAMPLERS"] = HW_SHADOW_SAMPLERS;
+		featureFlagsStrings["VERTEX_LAYER"] = VERTEX_LAYER;
 	}
 }
 
@@ -130,6 +136,36 @@ void ShaderMgr::clearCache()
 	m_shaderContentCache.clear();
 }
 
+void ShaderMgr::queuePrecompilation(const GlobalShaderParameters &globals, const S3DScene::MaterialList &materials)
+{
+	for(const auto& mat : materials)
+	{
+		const uint flags = getFlags(globals,&mat);
+		if(!m_shaderCache.contains(flags) && !m_precompileQueue.contains(flags))
+			m_precompileQueue.append(flags);
+	}
+}
+
+bool ShaderMgr::precompileQueued(qint64 budgetMs)
+{
+	QElapsedTimer timer;
+	timer.start();
+	int loaded = 0;
+	while(!m_precompileQueue.isEmpty())
+	{
+		const uint flags = m_precompileQueue.takeFirst();
+		if(m_shaderCache.contains(flags))
+			continue; //was needed for drawing in the meantime
+		findOrLoadShader(flags);
+		++loaded;
+		if(timer.elapsed() >= budgetMs)
+			break;
+	}
+	if(loaded)
+		qCDebug(shaderMgr)<<"Precompiled"<<loaded<<"shaders in"<<timer.elapsed()<<"ms,"<<m_precompileQueue.size()<<"remaining";
+	return !m_precompileQueue.isEmpty();
+}
+
 QOpenGLShaderProgram* ShaderMgr::findOrLoadShader(uint flags)
 {
 	auto it = m_shaderCache.find(flags);
@@ -351,6 +387,14 @@ bool ShaderMgr::loadShader(QOpenGLShaderProgram& program, const QByteArray& vSha
 	//clear old shader data, if exists
 	program.removeAllShaders();
 
+	//the attribute bindings below are part of the linked binary
+	const QByteArray cacheKey = vShader + '\0' + gShader + '\0' + fShader + "\0a_vertex,a_normal,a_texcoord,a_tangent,a_bitangent";
+	if(StelProgramCache::loadProgram(program, cacheKey))
+	{
+		buildUniformCache(program);
+		return true;
+	}
+
 	if(!vShader.isEmpty())
 	{
 		if(!program.addShaderFromSourceCode(QOpenGLShader::Vertex,vShader))
@@ -424,12 +468,14 @@ bool ShaderMgr::loadShader(QOpenGLShaderProgram& program, const QByteArray& vSha
 
 
 	//link program
+	StelProgramCache::prepareProgram(program);
 	if(!program.link())
 	{
 		qCCritical(shaderMgr)<<"[ShaderMgr] unable to link shader";
 		qCCritical(shaderMgr)<<program.log();
 		return false;
 	}
+	StelProgramCache::saveProgram(program, cacheKey);
 
 	buildUniformCache(program);
 	return true;
@@ -42,6 +42,8 @@ struct GlobalShaderParameters
 	S3DEnum::ShadowFilterQuality shadowFilterQuality;
 	bool pcss;
 	bool geometryShader;
+	//true if all cubemap faces are drawn with instancing, the vertex shader selects the face through gl_Layer
+	bool vertexLayer;
 	bool torchLight;
 	//for now, only 1 or 4 really supported
 	int frustumSplits;
@@ -74,6 +76,8 @@ public:
 		UNIFORM_MAT_SHADOW3,
 		//! The first cube MVP (array mat4, total 6)
 		UNIFORM_MAT_CUBEMVP,
+		//! The cubemap face drawn by each instance (array int, total 6), used with VERTEX_LAYER
+		UNIFORM_INT_CUBEFACES,
 
 		//! Defines the Diffuse texture slot
 		UNIFORM_TEX_DIFFUSE,
@@ -139,6 +143,13 @@ public:
 	//! Clears the shaders that have been created by this manager. Must be called within a GL context.
 	void clearCache();
 
+	//! Queues the shaders for all given materials with these parameters, to be loaded by precompileQueued()
+	//! before they are first needed for drawing.
+	void queuePrecompilation(const GlobalShaderParameters& globals, const S3DScene::MaterialList& materials);
+	//! Loads queued shaders until @p budgetMs milliseconds are used up, but at least one. Must be called within a GL context.
+	//! @return true if shaders remain queued
+	bool precompileQueued(qint64 budgetMs);
+
 private:
 	typedef QMap<QString,UNIFORM> t_UniformStrings;
 	static t_UniformStrings uniformStrings;
@@ -189,12 +200,16 @@ private:
 		//set if opengl es2
 		OGL_ES2		= (1<<19),
 		//true if shadow samplers (shadow2d) should be used for shadow maps instead of normal samplers (texture2d)
-		HW_SHADOW_SAMPLERS = (1<<20)
+		HW_SHADOW_SAMPLERS = (1<<20),
+		//all cubemap faces are drawn with instancing, the vertex shader writes gl_Layer from u_iCubeFaces[gl_InstanceID]
+		VERTEX_LAYER	= (1<<21)
 	};
 
 	typedef QMap<QString,FeatureFlags> t_FeatureFlagStrings;
 	static t_FeatureFlagStrings featureFlagsStrings;
 
+	//! Returns the feature flags of the shader for the specified operations
+	static inline uint getFlags(const GlobalShaderParameters &globals, const S3DScene::Material *mat);
 	static QString getVShaderName(uint flags);
 	static QString getGShaderName(uint flags);
 	static QString getFShaderName(uint flags);
@@ -214,9 +229,17 @@ private:
 	typedef QHash<UNIFORM,GLuint> t_UniformCacheEntry;
 	typedef QHash<const QOpenGLShaderProgram*, t_UniformCacheEntry> t_UniformCache;
 	t_UniformCache m_uniformCache;
+
+	//flags of the shaders still to be loaded by precompileQueued, in order
+	QVector<uint> m_precompileQueue;
 };
 
 QOpenGLShaderProgram* ShaderMgr::getShader(const GlobalShaderParameters& globals,const S3DScene::Material* mat)
+{
+	return findOrLoadShader(getFlags(globals,mat));
+}
+
+uint ShaderMgr::getFlags(const GlobalShaderParameters& globals,const S3DScene::Material* mat)
 {
 	//Build bitflags from bools. Some stuff requires pixelLighting to be enabled, so check it too.
 
@@ -232,6 +255,7 @@ QOpenGLShaderProgram* ShaderMgr::getShader(const GlobalShaderParameters& globals
 		if(globals.pixelLighting && globals.shadows && !globals.hwShadowSamplers && (globals.shadowFilterQuality == S3DEnum::SFQ_LOW || globals.shadowFilterQuality == S3DEnum::SFQ_HIGH) && globals.pcss) flags|= PCSS;
 		if(globals.hwShadowSamplers) flags|=HW_SHADOW_SAMPLERS;
 		if(globals.geometryShader) flags|= GEOMETRY_SHADER;
+		if(globals.vertexLayer) flags|= VERTEX_LAYER;
 		if(globals.torchLight) flags|= TORCH;
 		if(globals.frustumSplits == 1) flags|= SINGLE_SHADOW_FRUSTUM;
 	}
@@ -258,7 +282,7 @@ QOpenGLShaderProgram* ShaderMgr::getShader(const GlobalShaderParameters& globals
 			flags|= HEIGHT;
 	}
 
-	return findOrLoadShader(flags);
+	return flags;
 }
 
 QOpenGLShaderProgram* ShaderMgr::getDebugShader()
@@ -254,15 +254,16 @@ void Scenery3dDialog::updateToolTipStrings()
 			.arg(q_("Approximate calculation of shadow penumbras (sharper shadows near contact points, blurred shadows further away)."))
 			.arg(q_("Requires <b>LOW</b> or <b>HIGH</b> shadow filtering (without <b>Hardware</b>)."))
 			.arg(q_("Causes a performance hit."));
-	QString toolTipCubemapMode = QString("<html><head/><body><p>%1</p><p>%2</p><p>%3</p><p>%4</p></body></html>")
+	QString toolTipCubemapMode = QString("<html><head/><body><p>%1</p><p>%2</p><p>%3</p><p>%4</p><p>%5</p></body></html>")
 			.arg(q_("This determines the way the scene is rendered when Stellarium uses a projection other than &quot;Perspective&quot;. The scene is always rendered onto a cube, and this cube is then warped according to the real projection. The cube is described using an image called &quot;cubemap&quot;."))
 			.arg(q_("<b>6 Textures</b> uses 6 single textures, one for each cube side. This is the most compatible method, but may be slower than the others."))
 			.arg(q_("<b>Cubemap</b> uses a single GL_TEXTURE_CUBEMAP. Recommended for most users."))
-			.arg(q_("<b>Geometry shader</b> uses a modern GPU feature to render all 6 sides of the cube at once. It may be the fastest method depending on the scene and your GPU hardware. If not supported, this cannot be selected."));
+			.arg(q_("<b>Geometry shader</b> uses a modern GPU feature to render all 6 sides of the cube at once. It may be the fastest method depending on the scene and your GPU hardware. If not supported, this cannot be selected."))
+			.arg(q_("<b>Layered instancing</b> also renders all 6 sides at once, but without a geometry shader. Each object is only drawn into the sides where it is visible. If not supported, this cannot be selected."));
 	QString toolTipCubemapShadows = QString("<html><head/><body><p>%1</p><p>%2</p><p>%3</p></body></html>")
 			.arg(q_("Calculates shadows for each cubemap face separately."))
 			.arg(q_("If disabled, the shadowed area is calculated using a perspective projection, which may cause missing shadows with high FOV values, but is quite a bit faster!"))
-			.arg(q_("This does not work when using the <b>Geometry shader</b> cubemapping mode!"));
+			.arg(q_("This does not work when using the <b>Geometry shader</b> or <b>Layered instancing</b> cubemapping modes!"));
 	QString toolTipEnableLazyDrawing = QString("<html><head/><body><p>%1<br/>%2</p><p><b>%3</b></p></body></html>")
 			.arg(q_("When checked, the cubemap is only recreated in specific time intervals, instead of each frame."))
 			.arg(q_("Saves energy and may increase subjective application performance."))
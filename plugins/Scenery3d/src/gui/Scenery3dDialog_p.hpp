@@ -55,7 +55,12 @@ public:
 		{
 			return 2;
 		}
-		return 3;
+		//layered cubemapping is only supported where the geometry shader is
+		if(!mgr->getIsLayeredCubemapSupported())
+		{
+			return 3;
+		}
+		return 4;
 	}
 
 	QVariant data(const QModelIndex &index, int role) const
@@ -70,6 +75,8 @@ public:
 					return QVariant(QString(q_("Cubemap")));
 				case S3DEnum::CM_CUBEMAP_GSACCEL:
 					return QVariant(QString(q_("Geometry shader")));
+				case S3DEnum::CM_CUBEMAP_LAYERED:
+					return QVariant(QString(q_("Layered instancing")));
 			}
 		}
 		return QVariant();
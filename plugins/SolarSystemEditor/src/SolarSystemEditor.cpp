@@ -26,6 +26,7 @@
 #include "StelGui.hpp"
 #include "StelGuiItems.hpp"
 #include "StelFileMgr.hpp"
+#include "StelIniCache.hpp"
 #include "StelIniParser.hpp"
 #include "StelLocaleMgr.hpp"
 #include "StelModuleMgr.hpp"
@@ -36,10 +37,14 @@
 #include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QSet>
 #include <QSettings>
 #include <QString>
+#include <QtConcurrent>
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <stdexcept>
 
 
@@ -617,75 +622,160 @@ SsoElements SolarSystemEditor::readMpcOneLineCometElements(QString oneLineElemen
 	return result;
 }
 
-SsoElements SolarSystemEditor::readMpcOneLineMinorPlanetElements(QString oneLineElements) const
+SsoImportFilter::OrbitClass SsoImportFilter::getOrbitClass(double semiMajorAxis, double eccentricity)
 {
-	SsoElements result;
+	const double perihelion = (1. - eccentricity) * semiMajorAxis;
+	if (perihelion < 1.3)
+		return NearEarthOrbit;
+	if (semiMajorAxis >= 2.0 && semiMajorAxis < 3.3)
+		return MainBeltOrbit;
+	if (semiMajorAxis >= 5.05 && semiMajorAxis < 5.35)
+		return JupiterTrojanOrbit;
+	if (semiMajorAxis >= 30.1)
+		return TransNeptunianOrbit;
+	return OtherOrbit;
+}
 
-	//This time I'll try splitting the line to columns, instead of
-	//using a regular expression.
-	//Using QString::mid() allows parsing it in a random sequence.
+namespace
+{
+	//! Assumed albedo of the minor planets, see SolarSystemEditor::toSsoElements()
+	const double MINOR_PLANET_ALBEDO = 0.15;
+
+	//! Finds the non-blank characters of a column.
+	//! \returns false if the column is blank or beyond the end of the line
+	bool trimColumn(const char* line, int length, int start, int width, int& from, int& to)
+	{
+		from = start;
+		to = qMin(start + width, length);
+		while (from < to && line[from] == ' ')
+			from++;
+		while (to > from && line[to - 1] == ' ')
+			to--;
+		return from < to;
+	}
+
+	//! Reads a column with a number in fixed-point notation, as in MPC's one-line formats,
+	//! without building a string. Unlike strtod(), it does not depend on the locale.
+	bool readDoubleColumn(const char* line, int length, int start, int width, double& value)
+	{
+		static const double powersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+						     1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18};
+		int from, to;
+		if (!trimColumn(line, length, start, width, from, to))
+			return false;
+		bool negative = false;
+		if (line[from] == '-' || line[from] == '+')
+		{
+			negative = (line[from] == '-');
+			from++;
+		}
+		qint64 mantissa = 0;
+		int digits = 0;
+		int decimals = 0;
+		bool point = false;
+		for (int i = from; i < to; i++)
+		{
+			const char c = line[i];
+			if (c == '.' && !point)
+			{
+				point = true;
+				continue;
+			}
+			if (c < '0' || c > '9' || digits >= 18)
+				return false;
+			mantissa = mantissa * 10 + (c - '0');
+			digits++;
+			if (point)
+				decimals++;
+		}
+		if (digits == 0)
+			return false;
+		value = mantissa / powersOfTen[decimals];
+		if (negative)
+			value = -value;
+		return true;
+	}
 
-	//Length validation
-	if (oneLineElements.isEmpty() ||
-	    oneLineElements.length() > 202 ||
-	    oneLineElements.length() < 152) //The column ends at 160, but is left-aligned
+	bool isDigit(char c) { return c >= '0' && c <= '9'; }
+	bool isUpper(char c) { return c >= 'A' && c <= 'Z'; }
+	bool isLower(char c) { return c >= 'a' && c <= 'z'; }
+	int twoDigits(const char* s) { return (s[0] - '0') * 10 + (s[1] - '0'); }
+
+	QString formatValue(double value)
 	{
-		return result;
+		return QString::number(value, 'g', 12);
 	}
+}
 
-	QString column;
-	QString objectType = "asteroid";
-	bool ok = false;
-	//bool isLongForm = (oneLineElements.length() > 160) ? true : false;
+bool SolarSystemEditor::parseMpcOneLineMinorPlanetElements(const char* line, int length, const SsoImportFilter& filter, MinorPlanetElements& elements)
+{
+	//Split the line to columns, instead of using a regular expression,
+	//and read them without building strings: this is used for files
+	//of hundreds of thousands of lines.
+	//Length validation
+	if (length > 202 || length < 152) //The column ends at 160, but is left-aligned
+		return false;
+
+	//Magnitude, and the elements used by the filter first
+	if (!readDoubleColumn(line, length, 8, 5, elements.absoluteMagnitude) ||
+	    !readDoubleColumn(line, length, 70, 9, elements.eccentricity) ||
+	    !readDoubleColumn(line, length, 92, 11, elements.semiMajorAxis))
+		return false;
+	if (!filter.accepts(elements.absoluteMagnitude, elements.semiMajorAxis, elements.eccentricity))
+		return false;
 
 	//Minor planet number or provisional designation
-	column = oneLineElements.mid(0, 7).trimmed();
-	if (column.isEmpty())
-	{
-		return result;
-	}
+	int from, to;
+	if (!trimColumn(line, length, 0, 7, from, to))
+		return false;
+	const char* column = line + from;
+	const int columnLength = to - from;
 	int minorPlanetNumber = 0;
 	QString provisionalDesignation;
-	QString name;
-	if (column.toInt(&ok) || ok)
+	if (std::all_of(column, column + columnLength, isDigit))
 	{
-		minorPlanetNumber = column.toInt();
+		for (int i = 0; i < columnLength; i++)
+			minorPlanetNumber = minorPlanetNumber * 10 + (column[i] - '0');
 	}
-	else
+	else if (columnLength > 1 && (isUpper(column[0]) || isLower(column[0])) && std::all_of(column + 1, column + columnLength, isDigit))
 	{
-		//See if it is a number, but packed
+		//A number, but packed
 		//I hope the format is right (I've seen prefixes only between A and P)
-		QRegExp packedMinorPlanetNumber("^([A-Za-z])(\\d+)$");
-		if (packedMinorPlanetNumber.indexIn(column) == 0)
-		{
-			minorPlanetNumber = packedMinorPlanetNumber.cap(2).toInt(&ok);
-			//TODO: Validation
-			QChar prefix = packedMinorPlanetNumber.cap(1).at(0);
-			if (prefix.isUpper())
-			{
-				minorPlanetNumber += ((10 + prefix.toLatin1() - 'A') * 10000);
-			}
-			else
-			{
-				minorPlanetNumber += ((10 + prefix.toLatin1() - 'a' + 26) * 10000);
-			}
-		}
+		for (int i = 1; i < columnLength; i++)
+			minorPlanetNumber = minorPlanetNumber * 10 + (column[i] - '0');
+		if (isUpper(column[0]))
+			minorPlanetNumber += ((10 + column[0] - 'A') * 10000);
 		else
-		{
-			provisionalDesignation = unpackMinorPlanetProvisionalDesignation(column);
-		}
+			minorPlanetNumber += ((10 + column[0] - 'a' + 26) * 10000);
+	}
+	else if (columnLength == 7 && (column[0] == 'I' || column[0] == 'J' || column[0] == 'K') &&
+		 isDigit(column[1]) && isDigit(column[2]) && isUpper(column[3]) &&
+		 (isDigit(column[4]) || isUpper(column[4]) || isLower(column[4])) &&
+		 isDigit(column[5]) && isUpper(column[6]))
+	{
+		//The usual packed provisional designation, as in unpackMinorPlanetProvisionalDesignation()
+		const int year = unpackYearNumber(QLatin1Char(column[0]), twoDigits(column + 1));
+		const int cycleCount = unpackAlphanumericNumber(QLatin1Char(column[4]), column[5] - '0');
+		provisionalDesignation = QString("%1 %2%3").arg(year).arg(QLatin1Char(column[3])).arg(QLatin1Char(column[6]));
+		if (cycleCount != 0)
+			provisionalDesignation.append(QString::number(cycleCount));
+	}
+	else
+	{
+		provisionalDesignation = unpackMinorPlanetProvisionalDesignation(QString::fromLatin1(column, columnLength));
 	}
 
+	QString name;
 	if (minorPlanetNumber)
 	{
 		name = QString::number(minorPlanetNumber);
 	}
-	else if(provisionalDesignation.isEmpty())
+	else if (provisionalDesignation.isEmpty())
 	{
 		qDebug() << "readMpcOneLineMinorPlanetElements():"
-		         << column
-		         << "is not a valid number or packed provisional designation";
-		return SsoElements();
+			 << QString::fromLatin1(column, columnLength)
+			 << "is not a valid number or packed provisional designation";
+		return false;
 	}
 	else
 	{
@@ -693,175 +783,230 @@ SsoElements SolarSystemEditor::readMpcOneLineMinorPlanetElements(QString oneLine
 	}
 
 	//In case the longer format is used, extract the human-readable name
-	column = oneLineElements.mid(166, 28).trimmed();
-	if (!column.isEmpty())
-	{
-		if (minorPlanetNumber)
+	elements.minorPlanetNumber = 0;
+	if (minorPlanetNumber && trimColumn(line, length, 166, 28, from, to))
+	{
+		//"(number) name"
+		int i = from + 1;
+		while (i < to && isDigit(line[i]))
+			i++;
+		int nameStart = i + 1;
+		while (nameStart < to && (line[nameStart] == ' ' || line[nameStart] == '\t'))
+			nameStart++;
+		if (line[from] == '(' && i > from + 1 && i < to && line[i] == ')' &&
+		    nameStart > i + 1 && to - nameStart >= 2)
 		{
-			QRegExp asteroidName("^\\((\\d+)\\)\\s+(\\S.+)$");
-			if (asteroidName.indexIn(column) == 0)
-			{
-				name = asteroidName.cap(2);
-				result.insert("minor_planet_number", minorPlanetNumber);
-			}
-			else
-			{
-				//Use the whole string, just in case
-				name = column;
-			}
+			name = QString::fromLatin1(line + nameStart, to - nameStart);
+			elements.minorPlanetNumber = minorPlanetNumber;
+		}
+		else
+		{
+			//Use the whole string, just in case
+			name = QString::fromLatin1(line + from, to - from);
 		}
-		//In the other case, the name is already the provisional designation
-	}
-	if (name.isEmpty())
-	{
-		return SsoElements();
 	}
-	result.insert("name", name);
+	//In the other case, the name is already the provisional designation
+	elements.name = name;
 
 	//Section name
-	QString sectionName = convertToGroupName(name, minorPlanetNumber);
-	if (sectionName.isEmpty())
-	{
-		return SsoElements();
-	}
-	result.insert("section_name", sectionName);
-
-	//After a name has been determined, insert the essential keys
-	//result.insert("parent", "Sun");	 // 0.16: omit obvious default.
-	//"comet_orbit" is used for all cases:
-	//"ell_orbit" interprets distances as kilometers, not AUs
-	result.insert("coord_func","comet_orbit");
-
-	//result.insert("color", "1.0, 1.0, 1.0"); // 0.16: omit obvious default.
-	//result.insert("tex_map", "nomap.png");   // 0.16: omit obvious default.
-
-	//Magnitude and slope parameter
-	column = oneLineElements.mid(8,5).trimmed();
-	double absoluteMagnitude = column.toDouble(&ok);
-	if (!ok)
-		return SsoElements();
-	column = oneLineElements.mid(14,5).trimmed();
-	double slopeParameter = column.toDouble(&ok);
-	if (!ok)
-		return SsoElements();
-	result.insert("absolute_magnitude", absoluteMagnitude);
-	result.insert("slope_parameter", slopeParameter);
-
-	//Orbital parameters
-	column = oneLineElements.mid(37, 9).trimmed();
-	double argumentOfPerihelion = column.toDouble(&ok);//J2000.0, degrees
-	if (!ok)
-		return SsoElements();
-	result.insert("orbit_ArgOfPericenter", argumentOfPerihelion);
-
-	column = oneLineElements.mid(48, 9).trimmed();
-	double longitudeOfTheAscendingNode = column.toDouble(&ok);//J2000.0, degrees
-	if (!ok)
-		return SsoElements();
-	result.insert("orbit_AscendingNode", longitudeOfTheAscendingNode);
-
-	column = oneLineElements.mid(59, 9).trimmed();
-	double inclination = column.toDouble(&ok);//J2000.0, degrees
-	if (!ok)
-		return SsoElements();
-	result.insert("orbit_Inclination", inclination);
-
-	column = oneLineElements.mid(70, 9).trimmed();
-	double eccentricity = column.toDouble(&ok);//degrees
-	if (!ok)
-		return SsoElements();
-	result.insert("orbit_Eccentricity", eccentricity);
-
-	column = oneLineElements.mid(80, 11).trimmed();
-	double meanDailyMotion = column.toDouble(&ok);//degrees per day
-	if (!ok)
-		return SsoElements();
-	result.insert("orbit_MeanMotion", meanDailyMotion);
+	elements.sectionName = convertToGroupName(name, minorPlanetNumber);
+	if (elements.sectionName.isEmpty())
+		return false;
 
-	column = oneLineElements.mid(92, 11).trimmed();
-	double semiMajorAxis = column.toDouble(&ok);
-	if (!ok)
-		return SsoElements();
-	result.insert("orbit_SemiMajorAxis", semiMajorAxis);
+	//Slope parameter and orbital parameters
+	if (!readDoubleColumn(line, length, 14, 5, elements.slopeParameter) ||
+	    !readDoubleColumn(line, length, 37, 9, elements.argumentOfPerihelion) ||
+	    !readDoubleColumn(line, length, 48, 9, elements.ascendingNode) ||
+	    !readDoubleColumn(line, length, 59, 9, elements.inclination) ||
+	    !readDoubleColumn(line, length, 80, 11, elements.meanMotion) ||
+	    !readDoubleColumn(line, length, 26, 9, elements.meanAnomaly))
+		return false;
 
-	column = oneLineElements.mid(20, 5).trimmed();//Epoch, in packed form
-	QRegExp packedDateFormat("^([IJK])(\\d\\d)([1-9A-C])([1-9A-V])$");
-	if (packedDateFormat.indexIn(column) != 0)
+	//Epoch, in packed form
+	if (!trimColumn(line, length, 20, 5, from, to) || to - from != 4 ||
+	    (line[from] != 'I' && line[from] != 'J' && line[from] != 'K') ||
+	    !isDigit(line[from + 1]) || !isDigit(line[from + 2]))
 	{
 		qWarning() << "readMpcOneLineMinorPlanetElements():"
-		         << column << "is not a date in packed format";
-		return SsoElements();
-	}
-	int year = packedDateFormat.cap(2).toInt();
-	switch (packedDateFormat.cap(1).at(0).toLatin1())
-	{
-		case 'I':
-			year += 1800;
-			break;
-		case 'J':
-			year += 1900;
-			break;
-		case 'K':
-		default:
-			year += 2000;
+			   << QString::fromLatin1(line + 20, qMin(5, length - 20)).trimmed() << "is not a date in packed format";
+		return false;
 	}
-	int month = unpackDayOrMonthNumber(packedDateFormat.cap(3).at(0));
-	int day   = unpackDayOrMonthNumber(packedDateFormat.cap(4).at(0));
-	//qDebug() << column << year << month << day;
-	QDate epochDate(year, month, day);
-	if (!epochDate.isValid())
+	const int year = unpackYearNumber(QLatin1Char(line[from]), twoDigits(line + from + 1));
+	const int month = unpackDayOrMonthNumber(QLatin1Char(line[from + 3]));
+	const int day   = unpackDayOrMonthNumber(QLatin1Char(line[from + 4]));
+	if (month < 1 || month > 12 || !QDate(year, month, day).isValid())
 	{
 		qWarning() << "readMpcOneLineMinorPlanetElements():"
-		         << column << "unpacks to"
-		         << QString("%1-%2-%3").arg(year).arg(month).arg(day)
-				 << "This is not a valid date for an Epoch.";
-		return SsoElements();
+			   << QString::fromLatin1(line + from, 4) << "unpacks to"
+			   << QString("%1-%2-%3").arg(year).arg(month).arg(day)
+			   << "This is not a valid date for an Epoch.";
+		return false;
 	}
 	//Epoch is at .0 TT, i.e. midnight
-	double epochJD;
-	StelUtils::getJDFromDate(&epochJD, year, month, day, 0, 0, 0);
-	result.insert("orbit_Epoch", epochJD);
-
-	column = oneLineElements.mid(26, 9).trimmed();
-	double meanAnomalyAtEpoch = column.toDouble(&ok);//degrees
-	if (!ok)
-		return SsoElements();
-	result.insert("orbit_MeanAnomaly", meanAnomalyAtEpoch);
-
-	// add period for visualization of orbit
-	if (semiMajorAxis>0)
-		result.insert("orbit_visualization_period", StelUtils::calculateSiderealPeriod(semiMajorAxis));
+	StelUtils::getJDFromDate(&elements.epoch, year, month, day, 0, 0, 0);
 
+	const double semiMajorAxis = elements.semiMajorAxis;
+	elements.type = "asteroid";
 	// 2:3 resonance to Neptune [https://en.wikipedia.org/wiki/Plutino]
 	if ((int)semiMajorAxis == 39)
-		objectType = "plutino";
+		elements.type = "plutino";
 
 	// Classical Kuiper belt objects [https://en.wikipedia.org/wiki/Classical_Kuiper_belt_object]
 	if (semiMajorAxis>=40 && semiMajorAxis<=50)
-		objectType = "cubewano";
+		elements.type = "cubewano";
 
 	// Calculate perihelion
-	float r = (1 - eccentricity)*semiMajorAxis;
+	float r = (1 - elements.eccentricity)*semiMajorAxis;
 
 	// Scattered disc objects
 	if (r > 35)
-		objectType = "scattered disc object";
+		elements.type = "scattered disc object";
 
 	// Sednoids [https://en.wikipedia.org/wiki/Planet_Nine]
 	if (r > 30 && semiMajorAxis > 250)
-		objectType = "sednoid";
+		elements.type = "sednoid";
+
+	return true;
+}
+
+SsoElements SolarSystemEditor::toSsoElements(const MinorPlanetElements& elements)
+{
+	SsoElements result;
+	if (elements.minorPlanetNumber)
+		result.insert("minor_planet_number", elements.minorPlanetNumber);
+	result.insert("name", elements.name);
+	result.insert("section_name", elements.sectionName);
+
+	//After a name has been determined, insert the essential keys
+	//result.insert("parent", "Sun");	 // 0.16: omit obvious default.
+	//"comet_orbit" is used for all cases:
+	//"ell_orbit" interprets distances as kilometers, not AUs
+	result.insert("coord_func","comet_orbit");
+
+	//result.insert("color", "1.0, 1.0, 1.0"); // 0.16: omit obvious default.
+	//result.insert("tex_map", "nomap.png");   // 0.16: omit obvious default.
+
+	result.insert("absolute_magnitude", elements.absoluteMagnitude);
+	result.insert("slope_parameter", elements.slopeParameter);
+	result.insert("orbit_ArgOfPericenter", elements.argumentOfPerihelion);
+	result.insert("orbit_AscendingNode", elements.ascendingNode);
+	result.insert("orbit_Inclination", elements.inclination);
+	result.insert("orbit_Eccentricity", elements.eccentricity);
+	result.insert("orbit_MeanMotion", elements.meanMotion);
+	result.insert("orbit_SemiMajorAxis", elements.semiMajorAxis);
+	result.insert("orbit_Epoch", elements.epoch);
+	result.insert("orbit_MeanAnomaly", elements.meanAnomaly);
+
+	// add period for visualization of orbit
+	if (elements.semiMajorAxis>0)
+		result.insert("orbit_visualization_period", StelUtils::calculateSiderealPeriod(elements.semiMajorAxis));
 
 	//Radius and albedo
 	//Assume albedo of 0.15 and calculate a radius based on the absolute magnitude
 	//as described here: http://www.physics.sfasu.edu/astro/asteroids/sizemagnitude.html
-	double albedo = 0.15; //Assumed
-	double radius = std::ceil((1329 / std::sqrt(albedo)) * std::pow(10, -0.2 * absoluteMagnitude));
-	result.insert("albedo", albedo);
+	double radius = std::ceil((1329 / std::sqrt(MINOR_PLANET_ALBEDO)) * std::pow(10, -0.2 * elements.absoluteMagnitude));
+	result.insert("albedo", MINOR_PLANET_ALBEDO);
 	result.insert("radius", radius);
-	result.insert("type", objectType);
+	result.insert("type", elements.type);
 
 	return result;
 }
+
+void SolarSystemEditor::appendIniSection(const MinorPlanetElements& elements, MpcChunk& chunk)
+{
+	// The same keys as toSsoElements()
+	QVector<QPair<QString, QString> > section;
+	section.reserve(18);
+	if (elements.minorPlanetNumber)
+		section.append(qMakePair(QString("minor_planet_number"), QString::number(elements.minorPlanetNumber)));
+	section.append(qMakePair(QString("name"), elements.name));
+	section.append(qMakePair(QString("coord_func"), QString("comet_orbit")));
+	section.append(qMakePair(QString("absolute_magnitude"), formatValue(elements.absoluteMagnitude)));
+	section.append(qMakePair(QString("slope_parameter"), formatValue(elements.slopeParameter)));
+	section.append(qMakePair(QString("orbit_ArgOfPericenter"), formatValue(elements.argumentOfPerihelion)));
+	section.append(qMakePair(QString("orbit_AscendingNode"), formatValue(elements.ascendingNode)));
+	section.append(qMakePair(QString("orbit_Inclination"), formatValue(elements.inclination)));
+	section.append(qMakePair(QString("orbit_Eccentricity"), formatValue(elements.eccentricity)));
+	section.append(qMakePair(QString("orbit_MeanMotion"), formatValue(elements.meanMotion)));
+	section.append(qMakePair(QString("orbit_SemiMajorAxis"), formatValue(elements.semiMajorAxis)));
+	section.append(qMakePair(QString("orbit_Epoch"), formatValue(elements.epoch)));
+	section.append(qMakePair(QString("orbit_MeanAnomaly"), formatValue(elements.meanAnomaly)));
+	if (elements.semiMajorAxis>0)
+		section.append(qMakePair(QString("orbit_visualization_period"), formatValue(StelUtils::calculateSiderealPeriod(elements.semiMajorAxis))));
+	const double radius = std::ceil((1329 / std::sqrt(MINOR_PLANET_ALBEDO)) * std::pow(10, -0.2 * elements.absoluteMagnitude));
+	section.append(qMakePair(QString("albedo"), formatValue(MINOR_PLANET_ALBEDO)));
+	section.append(qMakePair(QString("radius"), formatValue(radius)));
+	section.append(qMakePair(QString("type"), elements.type));
+
+	chunk.text.append("\n[").append(elements.sectionName.toUtf8()).append("]\n");
+	for (const auto& keyValue : section)
+	{
+		chunk.text.append(keyValue.first.toLatin1()).append(" = ").append(keyValue.second.toUtf8()).append('\n');
+		chunk.values.append(qMakePair(elements.sectionName + "/" + keyValue.first, keyValue.second));
+	}
+	chunk.identifiers.append(qMakePair(elements.name, elements.sectionName));
+}
+
+QVector<SolarSystemEditor::MpcChunk> SolarSystemEditor::parseMpcOneLineMinorPlanetElementsChunks(const char* data, qint64 size, const SsoImportFilter& filter, bool toIni)
+{
+	//Chunks of about 1 MB, about 5000 lines, which end at the end of a line
+	const qint64 chunkSize = 1 << 20;
+	QVector<MpcChunk> chunks;
+	const char* const end = data + size;
+	const char* begin = data;
+	while (begin < end)
+	{
+		const char* chunkEnd = begin + qMin(chunkSize, static_cast<qint64>(end - begin));
+		if (chunkEnd < end)
+		{
+			const char* endOfLine = static_cast<const char*>(std::memchr(chunkEnd, '\n', end - chunkEnd));
+			chunkEnd = endOfLine ? endOfLine + 1 : end;
+		}
+		MpcChunk chunk;
+		chunk.begin = begin;
+		chunk.end = chunkEnd;
+		chunk.lineCount = 0;
+		chunks.append(chunk);
+		begin = chunkEnd;
+	}
+
+	QtConcurrent::blockingMap(chunks, [&filter, toIni](MpcChunk& chunk) {
+		const char* line = chunk.begin;
+		while (line < chunk.end)
+		{
+			const char* endOfLine = static_cast<const char*>(std::memchr(line, '\n', chunk.end - line));
+			if (!endOfLine)
+				endOfLine = chunk.end;
+			int length = static_cast<int>(endOfLine - line);
+			if (length > 0 && line[length - 1] == '\r')
+				length--;
+			if (length > 0)
+			{
+				chunk.lineCount++;
+				MinorPlanetElements elements;
+				if (parseMpcOneLineMinorPlanetElements(line, length, filter, elements))
+				{
+					if (toIni)
+						appendIniSection(elements, chunk);
+					else
+						chunk.objects.append(elements);
+				}
+			}
+			line = endOfLine + 1;
+		}
+	});
+	return chunks;
+}
+
+SsoElements SolarSystemEditor::readMpcOneLineMinorPlanetElements(QString oneLineElements) const
+{
+	const QByteArray line = oneLineElements.toLatin1();
+	MinorPlanetElements elements;
+	if (oneLineElements.isEmpty() || !parseMpcOneLineMinorPlanetElements(line.constData(), line.size(), SsoImportFilter(), elements))
+		return SsoElements();
+	return toSsoElements(elements);
+}
+
 /* DEAD CODE. MAYBE REACTIVATE FOR SCRIPTING ACCESS
 SsoElements SolarSystemEditor::readXEphemOneLineElements(QString oneLineElements)
 {
@@ -1174,7 +1319,7 @@ QList<SsoElements> SolarSystemEditor::readMpcOneLineCometElementsFromFile(QStrin
 	return objectList;
 }
 
-QList<SsoElements> SolarSystemEditor::readMpcOneLineMinorPlanetElementsFromFile(QString filePath) const
+QList<SsoElements> SolarSystemEditor::readMpcOneLineMinorPlanetElementsFromFile(QString filePath, const SsoImportFilter& filter) const
 {
 	QList<SsoElements> objectList;
 
@@ -1185,47 +1330,144 @@ QList<SsoElements> SolarSystemEditor::readMpcOneLineMinorPlanetElementsFromFile(
 	}
 
 	QFile mpcElementsFile(filePath);
-	if (mpcElementsFile.open(QFile::ReadOnly | QFile::Text ))//| QFile::Unbuffered
+	if (!mpcElementsFile.open(QFile::ReadOnly))
 	{
-		int candidatesCount = 0;
-		int lineCount = 0;
+		qDebug() << "Unable to open for reading" << QDir::toNativeSeparators(filePath);
+		qDebug() << "File error:" << mpcElementsFile.errorString();
+		return objectList;
+	}
 
-		while(!mpcElementsFile.atEnd())
-		{
-			QString oneLineElements = QString(mpcElementsFile.readLine(202 + 2));//Allow for end-of-line characters
-			if(oneLineElements.endsWith('\n'))
-			{
-				oneLineElements.chop(1);
-			}
-			if (oneLineElements.isEmpty())
-			{
-				qDebug() << "Empty line skipped.";
-				continue;
-			}
-			lineCount++;
+	//Files which can't be mapped are read in memory
+	const qint64 size = mpcElementsFile.size();
+	QByteArray buffer;
+	const char* data = size > 0 ? reinterpret_cast<const char*>(mpcElementsFile.map(0, size)) : Q_NULLPTR;
+	if (!data)
+	{
+		buffer = mpcElementsFile.readAll();
+		data = buffer.constData();
+	}
+	const QVector<MpcChunk> chunks = parseMpcOneLineMinorPlanetElementsChunks(data, buffer.isEmpty() ? size : buffer.size(), filter, false);
+	mpcElementsFile.close();
 
-			SsoElements ssObject = readMpcOneLineMinorPlanetElements(oneLineElements);
-			if(!ssObject.isEmpty() && !ssObject.value("section_name").toString().isEmpty())
-			{
-				objectList << ssObject;
-				candidatesCount++;
-			}
-		}
-		mpcElementsFile.close();
-		qDebug() << "Done reading minor planet orbital elements."
-		         << "Recognized" << candidatesCount << "candidate objects"
-		         << "out of" << lineCount << "lines.";
+	int lineCount = 0;
+	for (const auto& chunk : chunks)
+	{
+		lineCount += chunk.lineCount;
+		for (const auto& elements : chunk.objects)
+			objectList << toSsoElements(elements);
+	}
+	qDebug() << "Done reading minor planet orbital elements."
+		 << "Recognized" << objectList.size() << "candidate objects"
+		 << "out of" << lineCount << "lines.";
 
-		return objectList;
+	return objectList;
+}
+
+int SolarSystemEditor::importMpcOneLineMinorPlanetElementsFile(QString filePath, const SsoImportFilter& filter)
+{
+	if (!QFile::exists(customSolarSystemFilePath))
+	{
+		qDebug() << "Can't import minor planets to ssystem_minor.ini: Unable to find" << QDir::toNativeSeparators(customSolarSystemFilePath);
+		return -1;
 	}
-	else
+
+	QFile mpcElementsFile(filePath);
+	if (!mpcElementsFile.open(QFile::ReadOnly))
 	{
 		qDebug() << "Unable to open for reading" << QDir::toNativeSeparators(filePath);
 		qDebug() << "File error:" << mpcElementsFile.errorString();
-		return objectList;
+		return -1;
+	}
+	//Files which can't be mapped are read in memory
+	const qint64 size = mpcElementsFile.size();
+	QByteArray buffer;
+	const char* data = size > 0 ? reinterpret_cast<const char*>(mpcElementsFile.map(0, size)) : Q_NULLPTR;
+	if (!data)
+	{
+		buffer = mpcElementsFile.readAll();
+		data = buffer.constData();
+	}
+	QVector<MpcChunk> chunks = parseMpcOneLineMinorPlanetElementsChunks(data, buffer.isEmpty() ? size : buffer.size(), filter, true);
+	mpcElementsFile.close();
+	buffer.clear();
+
+	int lineCount = 0;
+	int objectCount = 0;
+	int textSize = 0;
+	int valueCount = 0;
+	for (const auto& chunk : chunks)
+	{
+		lineCount += chunk.lineCount;
+		objectCount += chunk.identifiers.size();
+		textSize += chunk.text.size();
+		valueCount += chunk.values.size();
+	}
+	qDebug() << "Done reading minor planet orbital elements."
+		 << "Recognized" << objectCount << "candidate objects"
+		 << "out of" << lineCount << "lines.";
+	if (objectCount == 0)
+		return 0;
+
+	//Remove duplicates (identified by name or section name).
+	//The current sections come from the cache, the file is rewritten only if there are duplicates.
+	QStringList duplicates;
+	{
+		const StelIniCache current(customSolarSystemFilePath);
+		if (!current.isValid())
+		{
+			qDebug() << "Error opening ssystem_minor.ini:" << QDir::toNativeSeparators(customSolarSystemFilePath);
+			return -1;
+		}
+		QHash<QString, QString> loadedObjects;
+		const QSet<QString> groups = current.childGroups().toSet();
+		for (const auto& group : current.childGroups())
+		{
+			const QString name = current.value(group + "/name").toString();
+			if (!name.isEmpty())
+				loadedObjects.insert(name, group);
+		}
+		for (const auto& chunk : chunks)
+		{
+			for (const auto& identifier : chunk.identifiers)
+			{
+				if (loadedObjects.contains(identifier.first))
+					duplicates << loadedObjects.value(identifier.first);
+				else if (groups.contains(identifier.second))
+					duplicates << identifier.second;
+			}
+		}
+	}
+	if (!duplicates.isEmpty())
+	{
+		QSettings solarSystemSettings(customSolarSystemFilePath, StelIniFormat);
+		for (const auto& group : duplicates)
+			solarSystemSettings.remove(group);
+		solarSystemSettings.sync();
+		if (solarSystemSettings.status() != QSettings::NoError)
+		{
+			qDebug() << "Error writing ssystem_minor.ini:" << QDir::toNativeSeparators(customSolarSystemFilePath);
+			return -1;
+		}
+		qDebug() << "Replacing" << duplicates.size() << "objects in ssystem_minor.ini";
 	}
 
-	return objectList;
+	QByteArray text;
+	text.reserve(textSize);
+	QVector<QPair<QString, QString> > values;
+	values.reserve(valueCount);
+	for (auto& chunk : chunks)
+	{
+		text.append(chunk.text);
+		values << chunk.values;
+		chunk = MpcChunk();
+	}
+	if (!StelIniCache::appendToFile(customSolarSystemFilePath, text, values))
+	{
+		qDebug() << "Unable to open for writing" << QDir::toNativeSeparators(customSolarSystemFilePath);
+		return -1;
+	}
+	qDebug() << "Imported" << objectCount << "minor planets to" << QDir::toNativeSeparators(customSolarSystemFilePath);
+	return objectCount;
 }
 
 /*
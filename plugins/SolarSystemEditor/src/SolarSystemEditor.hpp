@@ -27,9 +27,12 @@
 //#include "CAIMainWindow.hpp"
 
 #include <QHash>
+#include <QByteArray>
 #include <QList>
+#include <QPair>
 #include <QString>
 #include <QVariant>
+#include <QVector>
 
 class SolarSystemManagerWindow;
 class SolarSystem;
@@ -48,6 +51,38 @@ class QSettings;
 //! \todo Better name.
 typedef QHash<QString, QVariant> SsoElements;
 
+//! Criteria of the minor planets which are kept when reading a file of orbital elements.
+//! See SolarSystemEditor::readMpcOneLineMinorPlanetElementsFromFile() and
+//! SolarSystemEditor::importMpcOneLineMinorPlanetElementsFile().
+struct SsoImportFilter
+{
+	//! Classes of orbits, from the perihelion distance q and the semi-major axis a (in AU).
+	enum OrbitClass
+	{
+		NearEarthOrbit		= 0x01, //!< q < 1.3
+		MainBeltOrbit		= 0x02, //!< 2.0 <= a < 3.3, except near-Earth orbits
+		JupiterTrojanOrbit	= 0x04, //!< 5.05 <= a < 5.35
+		TransNeptunianOrbit	= 0x08, //!< a >= 30.1
+		OtherOrbit		= 0x10, //!< all other orbits, e.g. Mars-crossers, Hildas and Centaurs
+		AllOrbits		= 0x1f
+	};
+
+	SsoImportFilter() : maxAbsoluteMagnitude(99.), orbitClasses(AllOrbits) {}
+
+	//! Get the class of an orbit.
+	static OrbitClass getOrbitClass(double semiMajorAxis, double eccentricity);
+	//! Get whether an object is kept.
+	bool accepts(double absoluteMagnitude, double semiMajorAxis, double eccentricity) const
+	{
+		return absoluteMagnitude <= maxAbsoluteMagnitude && (orbitClasses & getOrbitClass(semiMajorAxis, eccentricity));
+	}
+
+	//! Objects with a larger absolute magnitude H (i.e. smaller ones) are skipped.
+	double maxAbsoluteMagnitude;
+	//! The OrbitClass values of the objects which are kept, OR-ed together.
+	int orbitClasses;
+};
+
 /*!
  \class SolarSystemEditor
  \brief Main class of the Solar System Editor plug-in which allows editing (add, delete, update) of the minor bodies.
@@ -133,8 +168,22 @@ public:
 	//! a list of hashes in Stellarium's ssystem.ini format.
 	//! Example source file is the list of bright asteroids on the MPC's site:
 	//! http://www.minorplanetcenter.org/iau/Ephemerides/Bright/2010/Soft00Bright.txt
-	//! readMpcOneLineMinorPlanetElements() is used internally to parse each line.
-	QList<SsoElements> readMpcOneLineMinorPlanetElementsFromFile(QString filePath) const;
+	//! The file is memory-mapped, and its lines are parsed by columns in parallel chunks.
+	//! Only the objects accepted by the filter are returned.
+	QList<SsoElements> readMpcOneLineMinorPlanetElementsFromFile(QString filePath, const SsoImportFilter& filter = SsoImportFilter()) const;
+
+	//! Imports the minor planets of a file in MPC's one-line format, such as
+	//! the whole MPCORB.DAT, into the user solar system configuration file.
+	//! Unlike readMpcOneLineMinorPlanetElementsFromFile() followed by
+	//! appendToSolarSystemConfigurationFile(), no hash is built for each object:
+	//! the chunks of the memory-mapped file are parsed in parallel directly
+	//! into sections of ssystem_minor.ini, which are appended to the file and
+	//! stored in its binary cache (see StelIniCache), so that the next load of
+	//! the Solar System does not parse the file again.
+	//! Objects already in the file, identified by name or section name, are replaced.
+	//! The Solar System is not reloaded.
+	//! \returns the number of imported objects, or -1 if the files can't be read or written.
+	int importMpcOneLineMinorPlanetElementsFile(QString filePath, const SsoImportFilter& filter = SsoImportFilter());
 
 	/*
 	 * GZ identified as DEAD CODE as of 0.16pre. Maybe reactivate as public slot for scripting use?
@@ -242,6 +291,51 @@ private slots:
 	void updateI18n();
 
 private:
+	//! The orbital elements of a minor planet in MPC's one-line format.
+	struct MinorPlanetElements
+	{
+		QString name;
+		QString sectionName;
+		//! Only set when the name comes from the long form, as "minor_planet_number"
+		int minorPlanetNumber;
+		double absoluteMagnitude;
+		double slopeParameter;
+		double epoch;			//!< JDE
+		double meanAnomaly;		//!< degrees
+		double argumentOfPerihelion;	//!< J2000.0, degrees
+		double ascendingNode;		//!< J2000.0, degrees
+		double inclination;		//!< J2000.0, degrees
+		double eccentricity;
+		double meanMotion;		//!< degrees per day
+		double semiMajorAxis;		//!< AU
+		QString type;
+	};
+
+	//! A part of a memory-mapped file of orbital elements, parsed by one job.
+	struct MpcChunk
+	{
+		const char* begin;
+		const char* end;
+		int lineCount;
+		//! The objects, when they are read as hashes
+		QVector<MinorPlanetElements> objects;
+		//! The objects, when they are imported: the sections of ssystem_minor.ini, their keys and values,
+		//! and the names and section names of the objects
+		QByteArray text;
+		QVector<QPair<QString, QString> > values;
+		QVector<QPair<QString, QString> > identifiers;
+	};
+
+	//! Parses a minor planet line in MPC's one-line format (without end-of-line characters) by its columns.
+	//! \returns false if the line is not valid or the object is rejected by the filter.
+	static bool parseMpcOneLineMinorPlanetElements(const char* line, int length, const SsoImportFilter& filter, MinorPlanetElements& elements);
+	//! Parses the lines of a memory-mapped file in parallel chunks.
+	//! \param toIni fill the sections of the chunks instead of their objects
+	static QVector<MpcChunk> parseMpcOneLineMinorPlanetElementsChunks(const char* data, qint64 size, const SsoImportFilter& filter, bool toIni);
+	static SsoElements toSsoElements(const MinorPlanetElements& elements);
+	//! Appends the section of an object to a chunk.
+	static void appendIniSection(const MinorPlanetElements& elements, MpcChunk& chunk);
+
 	bool isInitialized;
 
 	//! Main window of the module's GUI
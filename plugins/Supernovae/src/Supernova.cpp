@@ -269,7 +269,8 @@ void Supernova::draw(StelCore* core, StelPainter& painter)
 	StelUtils::spheToRect(snra, snde, XYZ);
 	mag = getVMagnitudeWithExtinction(core);
 	sd->preDrawPointSource(&painter);
-	float mlimit = sd->getLimitMagnitude();
+	// Corrected for the light pollution in the direction of the star
+	float mlimit = sd->getLimitMagnitude(getAltAzPosAuto(core));
 	
 	if (mag <= mlimit)
 	{
@@ -26,7 +26,7 @@
 #include "StelModuleMgr.hpp"
 #include "StelObjectMgr.hpp"
 #include "StelTextureMgr.hpp"
-#include "StelJsonParser.hpp"
+#include "StelJsonCatalog.hpp"
 #include "StelFileMgr.hpp"
 #include "StelUtils.hpp"
 #include "StelTranslator.hpp"
@@ -364,77 +364,37 @@ bool Supernovae::backupJsonFile(bool deleteOriginal)
   Read the JSON file and create list of supernovaes.
 */
 void Supernovae::readJsonFile(void)
-{
-	setSNeMap(loadSNeMap());
-}
-
-/*
-  Parse JSON file and load supernovaes to map
-*/
-QVariantMap Supernovae::loadSNeMap(QString path)
-{
-	if (path.isEmpty())
-	    path = sneJsonPath;
-
-	QVariantMap map;
-	QFile jsonFile(path);
-	if (!jsonFile.open(QIODevice::ReadOnly))
-		qWarning() << "[Supernovae] cannot open" << QDir::toNativeSeparators(path);
-	else
-	{
-		try
-		{
-			map = StelJsonParser::parse(jsonFile.readAll()).toMap();
-			jsonFile.close();
-		}
-		catch (std::runtime_error &e)
-		{
-			qDebug() << "[Supernovae] File format is wrong! Error: " << e.what();
-			return QVariantMap();
-		}
-	}
-	return map;
-}
-
-/*
-  Set items for list of struct from data map
-*/
-void Supernovae::setSNeMap(const QVariantMap& map)
 {
 	snstar.clear();
 	snlist.clear();
 	SNCount = 0;
-	QVariantMap sneMap = map.value("supernova").toMap();
-	for (auto sneKey : sneMap.keys())
+	try
 	{
-		QVariantMap sneData = sneMap.value(sneKey).toMap();
-		sneData["designation"] = QString("SN %1").arg(sneKey);
-
-		snlist.insert(sneData.value("designation").toString(), sneData.value("peakJD").toDouble());
-		SNCount++;
+		StelJsonCatalog(sneJsonPath, "supernova").read([this](const QString& sneKey, QVariantMap& sneData) {
+			sneData["designation"] = QString("SN %1").arg(sneKey);
 
-		SupernovaP sn(new Supernova(sneData));
-		if (sn->initialized)
-			snstar.append(sn);
+			snlist.insert(sneData.value("designation").toString(), sneData.value("peakJD").toDouble());
+			SNCount++;
 
+			SupernovaP sn(new Supernova(sneData));
+			if (sn->initialized)
+				snstar.append(sn);
+		});
+	}
+	catch (std::runtime_error &e)
+	{
+		qDebug() << "[Supernovae] File format is wrong! Error: " << e.what();
 	}
+	invalidateNameIndex();
 }
 
 int Supernovae::getJsonFileVersion(void) const
 {	
 	int jsonVersion = -1;
-	QFile sneJsonFile(sneJsonPath);
-	if (!sneJsonFile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "[Supernovae] cannot open" << QDir::toNativeSeparators(sneJsonPath);
-		return jsonVersion;
-	}
-
 	QVariantMap map;
 	try
 	{
-		map = StelJsonParser::parse(&sneJsonFile).toMap();
-		sneJsonFile.close();
+		map = StelJsonCatalog(sneJsonPath, "supernova").readHeader();
 	}
 	catch (std::runtime_error &e)
 	{
@@ -452,18 +412,9 @@ int Supernovae::getJsonFileVersion(void) const
 
 bool Supernovae::checkJsonFileFormat() const
 {
-	QFile sneJsonFile(sneJsonPath);
-	if (!sneJsonFile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "[Supernovae] cannot open " << QDir::toNativeSeparators(sneJsonPath);
-		return false;
-	}
-
-	QVariantMap map;
 	try
 	{
-		map = StelJsonParser::parse(&sneJsonFile).toMap();
-		sneJsonFile.close();
+		StelJsonCatalog(sneJsonPath, "supernova").readHeader();
 	}
 	catch (std::runtime_error& e)
 	{
@@ -477,18 +428,10 @@ bool Supernovae::checkJsonFileFormat() const
 float Supernovae::getLowerLimitBrightness() const
 {
 	float lowerLimit = 10.f;
-	QFile sneJsonFile(sneJsonPath);
-	if (!sneJsonFile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "[Supernovae] cannot open" << QDir::toNativeSeparators(sneJsonPath);
-		return lowerLimit;
-	}
-
 	QVariantMap map;
 	try
 	{
-		map = StelJsonParser::parse(&sneJsonFile).toMap();
-		sneJsonFile.close();
+		map = StelJsonCatalog(sneJsonPath, "supernova").readHeader();
 	}
 	catch (std::runtime_error &e)
 	{
@@ -213,12 +213,6 @@ private:
 	//! @return valid boolean, e.g. "true"
 	bool checkJsonFileFormat(void) const;
 
-	//! Parse JSON file and load supernovaes to map
-	QVariantMap loadSNeMap(QString path=QString());
-
-	//! Set items for list of struct from data map
-	void setSNeMap(const QVariantMap& map);
-
 	QString sneJsonPath;
 
 	int SNCount;
@@ -81,6 +81,28 @@ const QStringList INDIConnection::devices() const
 	return mDevices;
 }
 
+void INDIConnection::park()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (!mTelescope || !mTelescope->isConnected())
+		return;
+
+	ISwitchVectorProperty *switchVector = mTelescope->getSwitch("TELESCOPE_PARK");
+	if (!switchVector)
+	{
+		qDebug() << "Error: unable to find Telescope or TELESCOPE_PARK switch...";
+		return;
+	}
+
+	ISwitch *parkSwitch = IUFindSwitch(switchVector, "PARK");
+	if (!parkSwitch)
+		return;
+
+	IUResetSwitch(switchVector);
+	parkSwitch->s = ISS_ON;
+	sendNewSwitch(switchVector);
+}
+
 void INDIConnection::moveNorth(int speed)
 {
 	std::lock_guard<std::mutex> lock(mMutex);
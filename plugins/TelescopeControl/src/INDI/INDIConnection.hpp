@@ -51,6 +51,7 @@ public:
 	void moveEast(int speed);
 	void moveSouth(int speed);
 	void moveWest(int speed);
+	void park();
 
 signals:
 	void newDeviceReceived(QString name);
@@ -113,6 +113,11 @@ int TelescopeClientINDI::toINDISpeed(double speed) const
 		return INDI::Telescope::SLEW_MAX;
 }
 
+void TelescopeClientINDI::park()
+{
+	mConnection.park();
+}
+
 void TelescopeClientINDI::move(double angle, double speed)
 {
 	if (angle < 0.0 || angle >= 360.0)
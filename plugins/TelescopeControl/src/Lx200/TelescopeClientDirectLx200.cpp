@@ -139,10 +139,17 @@ void TelescopeClientDirectLx200::gotoReceived(unsigned int ra_int, int dec_int)
 
 //! estimates where the telescope is by interpolation in the stored
 //! telescope positions:
-Vec3d TelescopeClientDirectLx200::getJ2000EquatorialPos(const StelCore*) const
+Vec3d TelescopeClientDirectLx200::getJ2000EquatorialPos(const StelCore* core) const
 {
 	const qint64 now = getNow() - time_delay;
-	return interpolatedPosition.get(now);
+	const Vec3d position = interpolatedPosition.get(now);
+	if (equinox == EquinoxJNow)
+	{
+		if (!core)
+			core = StelApp::getInstance().getCore();
+		return core->equinoxEquToJ2000(position, StelCore::RefractionOff);
+	}
+	return position;
 }
 
 bool TelescopeClientDirectLx200::prepareCommunication()
@@ -215,7 +222,7 @@ void TelescopeClientDirectLx200::step(long long int timeout_micros)
 		lx200->sendCommand(new Lx200CommandGetRa(*this));
 		lx200->sendCommand(new Lx200CommandGetDec(*this));
 		queue_get_position = false;
-		next_pos_time = now + 500000;// 500000;
+		next_pos_time = now + 200000;// 5 Hz, the reticle is extrapolated in between
 	}
 	Server::step(timeout_micros);
 }
@@ -239,11 +246,6 @@ void TelescopeClientDirectLx200::sendPosition(unsigned int ra_int, int dec_int,
 	const double dec = dec_int * (M_PI/(unsigned int)0x80000000);
 	const double cdec = cos(dec);
 	Vec3d position(cos(ra)*cdec, sin(ra)*cdec, sin(dec));
-	Vec3d j2000Position = position;
-	if (equinox == EquinoxJNow)
-	{
-		const StelCore* core = StelApp::getInstance().getCore();
-		j2000Position = core->equinoxEquToJ2000(position, StelCore::RefractionOff);
-	}
-	interpolatedPosition.add(j2000Position, getNow(), server_micros, status);
+	//stored in the equinox of the telescope, getJ2000EquatorialPos() converts it in the main thread
+	interpolatedPosition.add(position, getNow(), server_micros, status);
 }
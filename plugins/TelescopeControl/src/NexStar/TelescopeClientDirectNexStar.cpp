@@ -135,10 +135,17 @@ void TelescopeClientDirectNexStar::gotoReceived(unsigned int ra_int, int dec_int
 
 //! estimates where the telescope is by interpolation in the stored
 //! telescope positions:
-Vec3d TelescopeClientDirectNexStar::getJ2000EquatorialPos(const StelCore*) const
+Vec3d TelescopeClientDirectNexStar::getJ2000EquatorialPos(const StelCore* core) const
 {
 	const qint64 now = getNow() - time_delay;
-	return interpolatedPosition.get(now);
+	const Vec3d position = interpolatedPosition.get(now);
+	if (equinox == EquinoxJNow)
+	{
+		if (!core)
+			core = StelApp::getInstance().getCore();
+		return core->equinoxEquToJ2000(position, StelCore::RefractionOff);
+	}
+	return position;
 }
 
 bool TelescopeClientDirectNexStar::prepareCommunication()
@@ -190,7 +197,7 @@ void TelescopeClientDirectNexStar::step(long long int timeout_micros)
 	{
 		nexstar->sendCommand(new NexStarCommandGetRaDec(*this));
 		queue_get_position = false;
-		next_pos_time = now + 500000;
+		next_pos_time = now + 200000;// 5 Hz, the reticle is extrapolated in between
 	}
 	Server::step(timeout_micros);
 }
@@ -214,11 +221,6 @@ void TelescopeClientDirectNexStar::sendPosition(unsigned int ra_int, int dec_int
 	const double dec = dec_int * (M_PI/(unsigned int)0x80000000);
 	const double cdec = cos(dec);
 	Vec3d position(cos(ra)*cdec, sin(ra)*cdec, sin(dec));
-	Vec3d j2000Position = position;
-	if (equinox == EquinoxJNow)
-	{
-		const StelCore* core = StelApp::getInstance().getCore();
-		j2000Position = core->equinoxEquToJ2000(position, StelCore::RefractionOff);
-	}
-	interpolatedPosition.add(j2000Position, getNow(), server_micros, status);
+	//stored in the equinox of the telescope, getJ2000EquatorialPos() converts it in the main thread
+	interpolatedPosition.add(position, getNow(), server_micros, status);
 }
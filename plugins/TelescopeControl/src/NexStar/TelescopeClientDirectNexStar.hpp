@@ -68,6 +68,7 @@ private:
 	Vec3d getJ2000EquatorialPos(const StelCore* core=Q_NULLPTR) const;
 	bool prepareCommunication();
 	void performCommunication();
+	bool usesCommunicationThread() const {return true;}
 	void telescopeGoto(const Vec3d &j2000Pos, StelObjectP selectObject);
 	bool isInitialized(void) const;
 	
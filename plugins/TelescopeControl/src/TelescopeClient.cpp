@@ -153,6 +153,24 @@ void TelescopeClient::move(double angle, double speed)
 	qDebug() << "TelescopeClient::move not implemented";
 }
 
+void TelescopeClient::park()
+{
+	qDebug() << "TelescopeClient::park not implemented";
+}
+
+void TelescopeClient::communicate()
+{
+	QMutexLocker locker(&communicationMutex);
+	if (prepareCommunication())
+		performCommunication();
+}
+
+void TelescopeClient::requestGoto(const Vec3d &j2000Pos, StelObjectP selectObject)
+{
+	QMutexLocker locker(&communicationMutex);
+	telescopeGoto(j2000Pos, selectObject);
+}
+
 //! returns the current system time in microseconds since the Epoch
 //! Prior to revision 6308, it was necessary to put put this method in an
 //! #ifdef block, as duplicate function definition caused errors during static
@@ -180,7 +198,7 @@ qint64 getNow(void)
 TelescopeTCP::TelescopeTCP(const QString &name, const QString &params, Equinox eq)
 	: TelescopeClient(name)
 	, port(0)
-	, tcpSocket(new QTcpSocket())
+	, tcpSocket(new QTcpSocket(this))
 	, end_of_timeout(0)
 	, time_delay(0)
 	, equinox(eq)
@@ -448,13 +466,8 @@ void TelescopeTCP::performReading(void)
 					const double dec = dec_int * (M_PI/(unsigned int)0x80000000);
 					const double cdec = cos(dec);
 					Vec3d position(cos(ra)*cdec, sin(ra)*cdec, sin(dec));
-					Vec3d j2000Position = position;
-					if (equinox == EquinoxJNow)
-					{
-						const StelCore* core = StelApp::getInstance().getCore();
-						j2000Position = core->equinoxEquToJ2000(position, StelCore::RefractionOff);
-					}
-					interpolatedPosition.add(j2000Position, getNow(), server_micros, status);
+					//stored in the equinox of the telescope, getJ2000EquatorialPos() converts it in the main thread
+					interpolatedPosition.add(position, getNow(), server_micros, status);
 				}
 				break;
 				default:
@@ -479,10 +492,17 @@ void TelescopeTCP::performReading(void)
 
 //! estimates where the telescope is by interpolation in the stored
 //! telescope positions:
-Vec3d TelescopeTCP::getJ2000EquatorialPos(const StelCore*) const
+Vec3d TelescopeTCP::getJ2000EquatorialPos(const StelCore* core) const
 {
 	const qint64 now = getNow() - time_delay;
-	return interpolatedPosition.get(now);
+	const Vec3d position = interpolatedPosition.get(now);
+	if (equinox == EquinoxJNow)
+	{
+		if (!core)
+			core = StelApp::getInstance().getCore();
+		return core->equinoxEquToJ2000(position, StelCore::RefractionOff);
+	}
+	return position;
 }
 
 //! checks if the socket is connected, tries to connect if it is not
@@ -29,6 +29,7 @@
 #include <QHostAddress>
 #include <QHostInfo>
 #include <QList>
+#include <QMutex>
 #include <QString>
 #include <QTcpSocket>
 #include <QObject>
@@ -87,6 +88,8 @@ public:
 	//! \param speed [0,1]
 	//!
 	virtual void move(double angle, double speed);
+	//! Parks the telescope, if the connection supports it
+	virtual void park();
 	virtual bool isConnected(void) const = 0;
 	virtual bool hasKnownPosition(void) const = 0;
 	void addOcular(double fov) {if (fov>=0.0) oculars.push_back(fov);}
@@ -94,12 +97,23 @@ public:
 	
 	virtual bool prepareCommunication() {return false;}
 	virtual void performCommunication() {}
+	//! True if prepareCommunication() and performCommunication() do blocking or socket I/O.
+	//! The client object is then moved to the communication thread of TelescopeControl, which polls it,
+	//! otherwise they are called in the main thread each frame.
+	virtual bool usesCommunicationThread() const {return false;}
+	//! Runs prepareCommunication() and performCommunication() once, excluding a concurrent requestGoto()
+	void communicate();
+	//! Calls telescopeGoto() from the main thread, after the communication step which may be in progress.
+	//! Use this instead of telescopeGoto() for clients which are polled in the communication thread.
+	void requestGoto(const Vec3d &j2000Pos, StelObjectP selectObject);
 
 	virtual QWidget* createControlWidget(QSharedPointer<TelescopeClient> telescope, QWidget* parent = nullptr) const { return nullptr; }
 
 protected:
 	TelescopeClient(const QString &name);
 	QString nameI18n;
+	//! Locked during communicate() and requestGoto()
+	QMutex communicationMutex;
 	const QString name;
 
 	virtual QString getTelescopeInfoString(const StelCore* core, const InfoStringGroup& flags) const
@@ -188,6 +202,7 @@ private:
 	Vec3d getJ2000EquatorialPos(const StelCore* core=Q_NULLPTR) const;
 	bool prepareCommunication();
 	void performCommunication();
+	bool usesCommunicationThread() const {return true;}
 	void telescopeGoto(const Vec3d &j2000Pos, StelObjectP selectObject);
 	bool isInitialized(void) const
 	{
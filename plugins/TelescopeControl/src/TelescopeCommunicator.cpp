@@ -0,0 +1,117 @@
+/*
+ * Stellarium Telescope Control Plug-in
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "TelescopeCommunicator.hpp"
+#include "TelescopeClient.hpp"
+#include "common/LogFile.hpp"
+
+#include <QTextStream>
+#include <QTimer>
+
+Q_DECLARE_METATYPE(QTextStream*)
+
+TelescopeCommunicator::TelescopeCommunicator()
+	: timer(new QTimer(this))
+{
+	qRegisterMetaType<TelescopeClient*>();
+	qRegisterMetaType<QTextStream*>();
+	thread.setObjectName("TelescopeCommunicator");
+	timer->setInterval(COMMUNICATION_INTERVAL);
+	connect(timer, SIGNAL(timeout()), this, SLOT(communicate()));
+	connect(&thread, SIGNAL(started()), this, SLOT(startTimer()));
+	// the timer is a child, so it moves along
+	moveToThread(&thread);
+}
+
+TelescopeCommunicator::~TelescopeCommunicator()
+{
+	stop();
+}
+
+void TelescopeCommunicator::start()
+{
+	if (!thread.isRunning())
+		thread.start();
+}
+
+void TelescopeCommunicator::stop()
+{
+	if (!thread.isRunning())
+		return;
+
+	// timers can only be stopped in their thread
+	QMetaObject::invokeMethod(timer, "stop", Qt::BlockingQueuedConnection);
+	thread.quit();
+	thread.wait();
+}
+
+void TelescopeCommunicator::addClient(TelescopeClient *client, QTextStream *log)
+{
+	Q_ASSERT(thread.isRunning());
+	// can only be pushed from the thread the client lives in
+	client->moveToThread(&thread);
+	QMetaObject::invokeMethod(this, "addPolledClient", Qt::QueuedConnection,
+				  Q_ARG(TelescopeClient*, client), Q_ARG(QTextStream*, log));
+}
+
+void TelescopeCommunicator::removeClient(TelescopeClient *client)
+{
+	if (client->thread() != &thread)
+		return;
+	// the client is moved back by the communication thread, queued calls to
+	// addPolledClient() are run first
+	QMetaObject::invokeMethod(this, "removePolledClient", Qt::BlockingQueuedConnection,
+				  Q_ARG(TelescopeClient*, client), Q_ARG(QThread*, QThread::currentThread()));
+}
+
+void TelescopeCommunicator::startTimer()
+{
+	timer->start();
+}
+
+void TelescopeCommunicator::addPolledClient(TelescopeClient *client, QTextStream *log)
+{
+	PolledClient polled;
+	polled.client = client;
+	polled.log = log;
+	clients.append(polled);
+}
+
+void TelescopeCommunicator::removePolledClient(TelescopeClient *client, QThread *target)
+{
+	for (int i = 0; i < clients.size(); ++i)
+	{
+		if (clients.at(i).client == client)
+		{
+			clients.removeAt(i);
+			break;
+		}
+	}
+	client->moveToThread(target);
+}
+
+void TelescopeCommunicator::communicate()
+{
+	for (const auto& polled : clients)
+	{
+		if (polled.log)
+			log_file = polled.log;
+		polled.client->communicate();
+	}
+}
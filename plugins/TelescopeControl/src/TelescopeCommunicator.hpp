@@ -0,0 +1,77 @@
+/*
+ * Stellarium Telescope Control Plug-in
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef TELESCOPECOMMUNICATOR_HPP
+#define TELESCOPECOMMUNICATOR_HPP
+
+#include <QList>
+#include <QObject>
+#include <QThread>
+
+class QTextStream;
+class QTimer;
+class TelescopeClient;
+
+//! Polls the telescope clients which do blocking or socket I/O (TCP, direct Lx200 and NexStar connections)
+//! in a dedicated thread, so that a slow serial port or a network timeout does not stall the frames.
+//! The clients publish the received positions into their InterpolatedPosition buffers,
+//! from which the main thread reads when drawing.
+//! The client objects live in the communication thread while they are added.
+class TelescopeCommunicator : public QObject
+{
+	Q_OBJECT
+public:
+	TelescopeCommunicator();
+	~TelescopeCommunicator();
+
+	//! Starts the communication thread
+	void start();
+	//! Stops the communication thread. All clients must have been removed.
+	void stop();
+
+	//! Moves the client to the communication thread and polls it from now on.
+	//! TelescopeControl keeps the ownership and must remove it before deleting it.
+	//! @param log the log stream which is set as log_file while the client is polled, may be Q_NULLPTR
+	void addClient(TelescopeClient* client, QTextStream* log);
+	//! Stops polling the client and moves it back to the main thread. Waits for the communication step in progress.
+	void removeClient(TelescopeClient* client);
+
+private slots:
+	void startTimer();
+	void addPolledClient(TelescopeClient* client, QTextStream* log);
+	void removePolledClient(TelescopeClient* client, QThread* target);
+	void communicate();
+
+private:
+	struct PolledClient
+	{
+		TelescopeClient* client;
+		QTextStream* log;
+	};
+
+	QThread thread;
+	QTimer* timer;
+	//! only used in the communication thread
+	QList<PolledClient> clients;
+
+	//! Time between two polls in ms
+	static const int COMMUNICATION_INTERVAL = 10;
+};
+
+#endif // TELESCOPECOMMUNICATOR_HPP
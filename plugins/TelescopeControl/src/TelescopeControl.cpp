@@ -28,6 +28,7 @@
 #include "StelUtils.hpp"
 #include "TelescopeControl.hpp"
 #include "TelescopeClient.hpp"
+#include "TelescopeCommunicator.hpp"
 #include "gui/TelescopeDialog.hpp"
 #include "gui/SlewDialog.hpp"
 #include "common/LogFile.hpp"
@@ -90,6 +91,7 @@ StelPluginInfo TelescopeControlStelPluginInterface::getPluginInfo() const
 // Constructor and destructor
 TelescopeControl::TelescopeControl()
 	: toolbarButton(Q_NULLPTR)
+	, communicator(Q_NULLPTR)
 	, useTelescopeServerLogs(false)
 	, useServerExecutables(false)
 	, telescopeDialog(Q_NULLPTR)
@@ -110,6 +112,7 @@ TelescopeControl::TelescopeControl()
 
 TelescopeControl::~TelescopeControl()
 {
+	delete communicator;
 }
 
 
@@ -118,6 +121,10 @@ TelescopeControl::~TelescopeControl()
 // init(), update(), draw(),  getCallOrder()
 void TelescopeControl::init()
 {
+	//Needed by the clients created while loading the telescopes
+	communicator = new TelescopeCommunicator();
+	communicator->start();
+
 	//TODO: I think I've overdone the try/catch...
 	try
 	{
@@ -162,7 +169,7 @@ void TelescopeControl::init()
 		/* StelAction-s with these key bindings existed in Stellarium prior to
 			revision 6311. Any future backports should account for that. */
 		QString section = N_("Telescope Control");
-		for (int i = MIN_SLOT_NUMBER; i <= MAX_SLOT_NUMBER; i++)
+		for (int i = MIN_SLOT_NUMBER; i <= MAX_SHORTCUT_SLOT_NUMBER; i++)
 		{
 			// "Slew to object" commands
 			QString name = moveToSelectedActionId.arg(i);
@@ -215,7 +222,7 @@ void TelescopeControl::translateActionDescriptions()
 {
 	StelActionMgr* actionMgr = StelApp::getInstance().getStelActionManager();
 	
-	for (int i = MIN_SLOT_NUMBER; i <= MAX_SLOT_NUMBER; i++)
+	for (int i = MIN_SLOT_NUMBER; i <= MAX_SHORTCUT_SLOT_NUMBER; i++)
 	{
 		QString name;
 		QString description;
@@ -235,6 +242,7 @@ void TelescopeControl::deinit()
 {
 	//Destroy all clients first in order to avoid displaying a TCP error
 	deleteAllTelescopes();
+	communicator->stop();
 
 	for (auto iterator = telescopeServerProcess.constBegin(); iterator != telescopeServerProcess.constEnd();
 		 ++iterator)
@@ -260,8 +268,25 @@ void TelescopeControl::update(double deltaTime)
 	labelFader.update((int)(deltaTime*1000));
 	reticleFader.update((int)(deltaTime*1000));
 	circleFader.update((int)(deltaTime*1000));
-	// communicate with the telescopes:
+	// communicate with the telescopes which are not polled by the communication thread:
 	communicate();
+
+	// collect the state of all telescopes once per frame, for drawing and scripts
+	const StelCore* core = StelApp::getInstance().getCore();
+	telescopeStates.resize(0);
+	for (auto telescope = telescopeClients.constBegin(); telescope != telescopeClients.constEnd(); ++telescope)
+	{
+		TelescopeState state;
+		state.slot = telescope.key();
+		state.nameI18n = telescope.value()->getNameI18n();
+		state.oculars = telescope.value()->getOculars();
+		state.connected = telescope.value()->isConnected();
+		state.knownPosition = state.connected && telescope.value()->hasKnownPosition();
+		if (state.knownPosition)
+			state.j2000Pos = telescope.value()->getJ2000EquatorialPos(core);
+		state.visible = false;
+		telescopeStates.append(state);
+	}
 }
 
 void TelescopeControl::draw(StelCore* core)
@@ -269,40 +294,75 @@ void TelescopeControl::draw(StelCore* core)
 	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
 	StelPainter sPainter(prj);
 	sPainter.setFont(labelFont);
-	reticleTexture->bind();
-	for (const auto& telescope : telescopeClients)
+
+	// Project all telescopes first, then draw each kind of item for all of them,
+	// so that the GL state is not switched for each telescope of a large fleet.
+	int visibleCount = 0;
+	for (auto& state : telescopeStates)
+	{
+		state.visible = state.knownPosition && prj->projectCheck(state.j2000Pos, state.screenPos);
+		if (state.visible)
+			visibleCount++;
+	}
+
+	if (visibleCount > 0)
 	{
-		if (telescope->isConnected() && telescope->hasKnownPosition())
+		//Telescope circles appear synchronously with markers
+		if (circleFader.getInterstate() > 0)
 		{
-			Vec3d XY;
-			if (prj->projectCheck(telescope->getJ2000EquatorialPos(core), XY))
+			sPainter.setColor(circleColor[0], circleColor[1], circleColor[2], circleFader.getInterstate());
+			for (const auto& state : telescopeStates)
 			{
-				//Telescope circles appear synchronously with markers
-				if (circleFader.getInterstate() >= 0)
-				{
-					sPainter.setColor(circleColor[0], circleColor[1], circleColor[2], circleFader.getInterstate());
-					for (auto circle : telescope->getOculars())
-					{
-						sPainter.drawCircle(XY[0], XY[1], 0.5 * prj->getPixelPerRadAtCenter() * (M_PI/180) * (circle));
-					}
-				}
-				if (reticleFader.getInterstate() >= 0)
+				if (!state.visible)
+					continue;
+				for (auto circle : state.oculars)
 				{
-					sPainter.setBlending(true, GL_SRC_ALPHA, GL_ONE);
-					sPainter.setColor(reticleColor[0], reticleColor[1], reticleColor[2], reticleFader.getInterstate());
-					sPainter.drawSprite2dMode(XY[0],XY[1],15.f);
+					sPainter.drawCircle(state.screenPos[0], state.screenPos[1], 0.5 * prj->getPixelPerRadAtCenter() * (M_PI/180) * (circle));
 				}
-				if (labelFader.getInterstate() >= 0)
+			}
+		}
+		if (reticleFader.getInterstate() > 0)
+		{
+			// all reticles in one draw call, two triangles each
+			static const float texCoords[] = {0.f,0.f, 1.f,0.f, 0.f,1.f, 1.f,0.f, 1.f,1.f, 0.f,1.f};
+			static const float corners[] = {-1.f,-1.f, 1.f,-1.f, -1.f,1.f, 1.f,-1.f, 1.f,1.f, -1.f,1.f};
+			// Takes into account device pixel density and global scale ratio, as in StelPainter::drawSprite2dMode
+			const float radius = 15.f * prj->getDevicePixelsPerPixel() * StelApp::getInstance().getGlobalScalingRatio();
+			reticleVertices.resize(0);
+			reticleTexCoords.resize(0);
+			for (const auto& state : telescopeStates)
+			{
+				if (!state.visible)
+					continue;
+				for (int i = 0; i < 6; ++i)
 				{
-					sPainter.setColor(labelColor[0], labelColor[1], labelColor[2], labelFader.getInterstate());
-					//TODO: Different position of the label if circles are shown?
-					//TODO: Remove magic number (text spacing)
-					sPainter.drawText(XY[0], XY[1], telescope->getNameI18n(), 0, 6 + 10, -4, false);
-					//Same position as the other objects: doesn't work, telescope label overlaps object label
-					//sPainter.drawText(XY[0], XY[1], scope->getNameI18n(), 0, 10, 10, false);
-					reticleTexture->bind();
+					reticleVertices << static_cast<float>(state.screenPos[0]) + radius * corners[2*i]
+							<< static_cast<float>(state.screenPos[1]) + radius * corners[2*i+1];
+					reticleTexCoords << texCoords[2*i] << texCoords[2*i+1];
 				}
 			}
+			reticleTexture->bind();
+			sPainter.setBlending(true, GL_SRC_ALPHA, GL_ONE);
+			sPainter.setColor(reticleColor[0], reticleColor[1], reticleColor[2], reticleFader.getInterstate());
+			sPainter.enableClientStates(true, true);
+			sPainter.setVertexPointer(2, GL_FLOAT, reticleVertices.constData());
+			sPainter.setTexCoordPointer(2, GL_FLOAT, reticleTexCoords.constData());
+			sPainter.drawFromArray(StelPainter::Triangles, visibleCount * 6, 0, false);
+			sPainter.enableClientStates(false);
+		}
+		if (labelFader.getInterstate() > 0)
+		{
+			sPainter.setColor(labelColor[0], labelColor[1], labelColor[2], labelFader.getInterstate());
+			for (const auto& state : telescopeStates)
+			{
+				if (!state.visible)
+					continue;
+				//TODO: Different position of the label if circles are shown?
+				//TODO: Remove magic number (text spacing)
+				sPainter.drawText(state.screenPos[0], state.screenPos[1], state.nameI18n, 0, 6 + 10, -4, false);
+				//Same position as the other objects: doesn't work, telescope label overlaps object label
+				//sPainter.drawText(XY[0], XY[1], scope->getNameI18n(), 0, 10, 10, false);
+			}
 		}
 	}
 
@@ -407,6 +467,68 @@ void TelescopeControl::slewTelescopeToViewDirection(const int idx)
 	telescopeGoto(idx, centerPosition);
 }
 
+void TelescopeControl::slewTelescopesTo(const QVariantMap &targets)
+{
+	for (auto target = targets.constBegin(); target != targets.constEnd(); ++target)
+	{
+		bool ok;
+		const int slot = target.key().toInt(&ok);
+		const QVariantList coordinates = target.value().toList();
+		if (!ok || coordinates.size() != 2)
+		{
+			qWarning() << "[TelescopeControl] slewTelescopesTo(): invalid target for slot" << target.key();
+			continue;
+		}
+		Vec3d position;
+		StelUtils::spheToRect(coordinates.at(0).toDouble() * M_PI/180., coordinates.at(1).toDouble() * M_PI/180., position);
+		telescopeGoto(slot, position);
+	}
+}
+
+void TelescopeControl::slewAllTelescopesToSelectedObject()
+{
+	StelObjectMgr* omgr = GETSTELMODULE(StelObjectMgr);
+	if (omgr->getSelectedObject().isEmpty())
+		return;
+
+	StelObjectP selectObject = omgr->getSelectedObject().at(0);
+	const Vec3d objectPosition = selectObject->getJ2000EquatorialPos(StelApp::getInstance().getCore());
+	for (const auto& telescope : telescopeClients)
+	{
+		if (telescope->isConnected())
+			telescope->requestGoto(objectPosition, selectObject);
+	}
+}
+
+void TelescopeControl::parkAllTelescopes()
+{
+	for (const auto& telescope : telescopeClients)
+	{
+		if (telescope->isConnected())
+			telescope->park();
+	}
+}
+
+QVariantMap TelescopeControl::getTelescopeStates() const
+{
+	QVariantMap result;
+	for (const auto& state : telescopeStates)
+	{
+		QVariantMap map;
+		map.insert("name", state.nameI18n);
+		map.insert("connected", state.connected);
+		if (state.knownPosition)
+		{
+			double ra, dec;
+			StelUtils::rectToSphe(&ra, &dec, state.j2000Pos);
+			map.insert("ra", StelUtils::fmodpos(ra * 180./M_PI, 360.));
+			map.insert("dec", dec * 180./M_PI);
+		}
+		result.insert(QString::number(state.slot), map);
+	}
+	return result;
+}
+
 void TelescopeControl::drawPointer(const StelProjectorP& prj, const StelCore* core, StelPainter& sPainter)
 {
 #ifndef COMPATIBILITY_001002
@@ -436,7 +558,7 @@ void TelescopeControl::telescopeGoto(int slotNumber, const Vec3d &j2000Pos, Stel
 {
 	//TODO: See the original code. I think that something is wrong here...
 	if(telescopeClients.contains(slotNumber))
-		telescopeClients.value(slotNumber)->telescopeGoto(j2000Pos, selectObject);
+		telescopeClients.value(slotNumber)->requestGoto(j2000Pos, selectObject);
 }
 
 QSharedPointer<TelescopeClient> TelescopeControl::telescopeClient(int index) const
@@ -453,11 +575,10 @@ void TelescopeControl::communicate(void)
 	{
 		for (auto telescope = telescopeClients.constBegin(); telescope != telescopeClients.constEnd(); ++telescope)
 		{
+			if(telescope.value()->usesCommunicationThread())
+				continue;
 			logAtSlot(telescope.key());//If there's no log, it will be ignored
-			if(telescope.value()->prepareCommunication())
-			{
-				telescope.value()->performCommunication();
-			}
+			telescope.value()->communicate();
 		}
 	}
 }
@@ -471,6 +592,8 @@ void TelescopeControl::deleteAllTelescopes()
 	//TODO: I really hope that this won't cause a memory leak...
 	//for (auto* telescope : telescopeClients)
 	//	delete telescope;
+	for (const auto& telescope : telescopeClients)
+		communicator->removeClient(telescope.data());
 	telescopeClients.clear();
 }
 
@@ -1344,6 +1467,8 @@ bool TelescopeControl::startClientAtSlot(int slotNumber, ConnectionType connecti
 				newTelescope->addOcular(circles[i]);
 
 		telescopeClients.insert(slotNumber, TelescopeClientP(newTelescope));
+		if(newTelescope->usesCommunicationThread())
+			communicator->addClient(newTelescope, telescopeServerLogStreams.value(slotNumber, Q_NULLPTR));
 		return true;
 	}
 
@@ -1368,6 +1493,7 @@ bool TelescopeControl::stopClientAtSlot(int slotNumber)
 	{
 		GETSTELMODULE(StelObjectMgr)->unSelect();
 	}
+	communicator->removeClient(telescopeClients.value(slotNumber).data());
 	telescopeClients.remove(slotNumber);
 
 	//This is not needed by every client
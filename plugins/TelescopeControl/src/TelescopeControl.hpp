@@ -47,11 +47,13 @@
 #include <QStringList>
 #include <QTextStream>
 #include <QVariant>
+#include <QVector>
 
 class StelObject;
 class StelPainter;
 class StelProjector;
 class TelescopeClient;
+class TelescopeCommunicator;
 class TelescopeDialog;
 class SlewDialog;
 
@@ -275,6 +277,37 @@ public slots:
 	//! TelescopeControl.slewTelescopeToViewDirection(1);
 	//! @endcode
 	void slewTelescopeToViewDirection(const int idx);
+
+	//! slews several telescopes at once, e.g. the mounts of a robotic site.
+	//! @param targets a map from slot numbers to lists of the J2000 right ascension and declination in degrees
+	//! @code
+	//! // example of usage in scripts
+	//! TelescopeControl.slewTelescopesTo({"1": [83.82, -5.39], "2": [10.68, 41.27]});
+	//! @endcode
+	void slewTelescopesTo(const QVariantMap& targets);
+
+	//! slews all connected telescopes to the selected object.
+	//! @code
+	//! // example of usage in scripts
+	//! TelescopeControl.slewAllTelescopesToSelectedObject();
+	//! @endcode
+	void slewAllTelescopesToSelectedObject();
+
+	//! parks all connected telescopes which support it (INDI mounts).
+	//! @code
+	//! // example of usage in scripts
+	//! TelescopeControl.parkAllTelescopes();
+	//! @endcode
+	void parkAllTelescopes();
+
+	//! Get the state of all telescopes in the current frame.
+	//! @return a map from slot numbers to maps with the keys \c name and \c connected,
+	//! and \c ra and \c dec (J2000, in degrees) if the position is known
+	//! @code
+	//! // example of usage in scripts
+	//! var states = TelescopeControl.getTelescopeStates();
+	//! @endcode
+	QVariantMap getTelescopeStates() const;
 	
 	//! Used in the GUI
 	void setFlagUseTelescopeServerLogs (bool b) {useTelescopeServerLogs = b;}
@@ -299,7 +332,7 @@ private:
 	//! Draw a nice animated pointer around the object if it's selected
 	void drawPointer(const StelProjectorP& prj, const StelCore* core, StelPainter& sPainter);
 
-	//! Perform the communication with the telescope servers
+	//! Perform the communication with the telescope clients which don't use the communication thread
 	void communicate(void);
 	
 	LinearFader labelFader;
@@ -325,6 +358,27 @@ private:
 	
 	//! Contains the initialized telescope client objects representing the telescopes that Stellarium is connected to or attempting to connect to.
 	QMap<int, TelescopeClientP> telescopeClients;
+
+	//! The state of a telescope in the current frame
+	struct TelescopeState
+	{
+		int slot;
+		QString nameI18n;
+		QList<double> oculars;
+		bool connected;
+		bool knownPosition;
+		Vec3d j2000Pos;
+		//! set by draw()
+		bool visible;
+		Vec3d screenPos;
+	};
+	//! Collected from the clients by update(), so that drawing a large fleet does not query each client
+	QVector<TelescopeState> telescopeStates;
+	//! Buffers for drawing all reticles at once
+	QVector<float> reticleVertices;
+	QVector<float> reticleTexCoords;
+	//! Polls the clients with blocking or socket I/O in its own thread
+	TelescopeCommunicator* communicator;
 	//! Contains QProcess objects of the currently running telescope server processes that have been launched by Stellarium.
 	QHash<int, QProcess*> telescopeServerProcess;
 	QStringList telescopeServers;
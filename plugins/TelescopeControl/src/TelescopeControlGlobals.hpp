@@ -26,9 +26,11 @@
 
 namespace TelescopeControlGlobals {
 	const int MIN_SLOT_NUMBER = 1;
-	const int SLOT_COUNT = 9;
+	const int SLOT_COUNT = 64;
 	const int SLOT_NUMBER_LIMIT = MIN_SLOT_NUMBER + SLOT_COUNT;
 	const int MAX_SLOT_NUMBER = SLOT_NUMBER_LIMIT - 1;
+	//! Only the first slots get the Ctrl/Alt+number slew shortcuts
+	const int MAX_SHORTCUT_SLOT_NUMBER = 9;
 
 	const int BASE_TCP_PORT = 10000;
 	#define DEFAULT_TCP_PORT_FOR_SLOT(X) (BASE_TCP_PORT + X)
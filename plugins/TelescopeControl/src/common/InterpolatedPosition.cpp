@@ -38,6 +38,7 @@ InterpolatedPosition::~InterpolatedPosition()
 
 void InterpolatedPosition::reset()
 {
+	QMutexLocker locker(&mutex);
 	for (position_pointer = positions; position_pointer < end_position; position_pointer++)
 	{
 		position_pointer->server_micros = INT64_MAX;
@@ -48,10 +49,13 @@ void InterpolatedPosition::reset()
 		position_pointer->status = 0;
 	}
 	position_pointer = positions;
+	clock_offset = 0;
+	use_server_time = false;
 }
 
 void InterpolatedPosition::add(Vec3d &position, qint64 clientTime, qint64 serverTime, int status)
 {
+	QMutexLocker locker(&mutex);
 	// remember the time and received position so that later we
 	// will know where the telescope is pointing to:
 	position_pointer++;
@@ -62,27 +66,76 @@ void InterpolatedPosition::add(Vec3d &position, qint64 clientTime, qint64 server
 	position_pointer->server_micros = serverTime;
 	position_pointer->client_micros = clientTime;
 	position_pointer->status = status;
+
+	updateClockOffset();
+}
+
+bool InterpolatedPosition::isKnown() const
+{
+	QMutexLocker locker(&mutex);
+	return (position_pointer->client_micros != INT64_MAX);
+}
+
+const Position *InterpolatedPosition::previous(const Position *p) const
+{
+	if (p == positions)
+		p = end_position;
+	p--;
+	if (p == position_pointer || p->client_micros == INT64_MAX)
+		return Q_NULLPTR;
+	return p;
+}
+
+void InterpolatedPosition::updateClockOffset()
+{
+	// The arrival times jitter with the network and serial latency, the server times of the
+	// measurements don't. The smallest difference in the ring is the clock offset plus the
+	// minimal latency, so the server times shifted by it are the best estimate of when
+	// the positions were measured, on the client clock.
+	// Servers which don't send consistent times fall back to the arrival times.
+	const Position *p = position_pointer;
+	qint64 offset = p->client_micros - p->server_micros;
+	for (const Position *pp = previous(p); pp; p = pp, pp = previous(pp))
+	{
+		const qint64 serverDelta = p->server_micros - pp->server_micros;
+		const qint64 clientDelta = p->client_micros - pp->client_micros;
+		if (serverDelta <= 0 || qAbs(serverDelta - clientDelta) > MAX_LATENCY_JITTER)
+		{
+			use_server_time = false;
+			return;
+		}
+		offset = qMin(offset, pp->client_micros - pp->server_micros);
+	}
+	clock_offset = offset;
+	use_server_time = true;
+}
+
+qint64 InterpolatedPosition::sampleTime(const Position &p) const
+{
+	return use_server_time ? p.server_micros + clock_offset : p.client_micros;
 }
 
 Vec3d InterpolatedPosition::get(qint64 now) const
 {
+	QMutexLocker locker(&mutex);
 	if (position_pointer->client_micros == INT64_MAX)
 	{
 		return Vec3d(0,0,0);
 	}
 
 	const Position *p = position_pointer;
-	do
+	if (now >= sampleTime(*p))
+		return extrapolate(now);
+
+	for (const Position *pp = previous(p); pp; p = pp, pp = previous(pp))
 	{
-		const Position *pp = p;
-		if (pp == positions) pp = end_position;
-		pp--;
-		if (pp->client_micros == INT64_MAX) break;
-		if (pp->client_micros <= now && now <= p->client_micros)
+		const qint64 ppTime = sampleTime(*pp);
+		if (ppTime <= now)
 		{
-			if (pp->client_micros != p->client_micros)
+			const qint64 pTime = sampleTime(*p);
+			if (ppTime != pTime)
 			{
-				Vec3d rval = p->pos * (now - pp->client_micros) + pp->pos * (p->client_micros - now);
+				Vec3d rval = p->pos * static_cast<double>(now - ppTime) + pp->pos * static_cast<double>(pTime - now);
 				double f = rval.lengthSquared();
 				if (f > 0.0)
 				{
@@ -91,9 +144,36 @@ Vec3d InterpolatedPosition::get(qint64 now) const
 			}
 			break;
 		}
-		p = pp;
 	}
-	while (p != position_pointer);
 
 	return Vec3d(p->pos);
 }
+
+Vec3d InterpolatedPosition::extrapolate(qint64 now) const
+{
+	const Position *newest = position_pointer;
+	// the velocity over several reports is less affected by their jitter
+	const Position *oldest = newest;
+	for (int i = 0; i < VELOCITY_SAMPLES; ++i)
+	{
+		const Position *pp = previous(oldest);
+		if (!pp)
+			break;
+		oldest = pp;
+	}
+
+	const qint64 newestTime = sampleTime(*newest);
+	const qint64 span = newestTime - sampleTime(*oldest);
+	if (oldest == newest || span <= 0 || span > MAX_VELOCITY_SPAN)
+		return Vec3d(newest->pos);
+
+	// a mount which stopped reporting is not moved further than that
+	const qint64 ahead = qMin(now - newestTime, MAX_EXTRAPOLATION);
+	Vec3d rval = newest->pos + (newest->pos - oldest->pos) * (static_cast<double>(ahead) / span);
+	double f = rval.lengthSquared();
+	if (f > 0.0)
+	{
+		return (1.0/std::sqrt(f))*rval;
+	}
+	return Vec3d(newest->pos);
+}
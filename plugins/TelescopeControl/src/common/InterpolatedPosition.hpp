@@ -33,6 +33,8 @@
 
 #include "VecMath.hpp"
 
+#include <QMutex>
+
 //! A telescope's position at a given time.
 //! This structure used to be defined inline in TelescopeTCP.
 struct Position
@@ -43,22 +45,48 @@ struct Position
 	int status;
 };
 
+//! The positions received from a telescope, interpolated for the current time.
+//! The positions are added by the communication thread of TelescopeControl and read by the main thread,
+//! all methods are thread-safe.
+//! Positions received from a telescope after the requested time are extrapolated with the
+//! velocity of the last reports, so that a tracking or slewing telescope moves smoothly at the
+//! display rate while it reports its position only a few times per second.
 class InterpolatedPosition {
 public:
 	InterpolatedPosition();
 	~InterpolatedPosition();
 	
 	void add(Vec3d& position, qint64 clientTime, qint64 serverTime, int status = 0);
-	//! returns the current interpolated position
+	//! returns the position interpolated for the time, or extrapolated if no newer position is known
 	Vec3d get(qint64 time) const;
 	//! resets/initializes the array of positions kept for position interpolation
 	void reset();
-	bool isKnown() const {return (position_pointer->client_micros != INT64_MAX);}
+	bool isKnown() const;
 	
 private:
+	//! returns the position received before p, or Q_NULLPTR if it is unknown
+	const Position *previous(const Position *p) const;
+	//! estimates the offset between the server and the client clock after a new position
+	void updateClockOffset();
+	//! returns the estimated time of the measurement of the position, on the client clock
+	qint64 sampleTime(const Position &p) const;
+	Vec3d extrapolate(qint64 now) const;
+
+	//! Number of report intervals used for the velocity
+	static const int VELOCITY_SAMPLES = 3;
+	//! Maximal time in microseconds for which the position is extrapolated beyond the last report
+	static const qint64 MAX_EXTRAPOLATION = 500000;
+	//! Reports further apart than this (in microseconds) are not used for the velocity
+	static const qint64 MAX_VELOCITY_SPAN = 3000000;
+	//! Maximal difference of the server and client intervals (in microseconds) for using the server times
+	static const qint64 MAX_LATENCY_JITTER = 1000000;
+
+	mutable QMutex mutex;
 	Position positions[16];
 	Position *position_pointer;
 	Position *const end_position;
+	qint64 clock_offset;
+	bool use_server_time;
 };
  
  #endif // INTEPOLATEDPOSITION_HPP
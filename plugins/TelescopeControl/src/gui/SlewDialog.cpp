@@ -220,7 +220,7 @@ void SlewDialog::slew()
 		return;
 
 	StelObjectP selectObject = nullptr;
-	telescope->telescopeGoto(targetPosition, selectObject);
+	telescope->requestGoto(targetPosition, selectObject);
 }
 
 void SlewDialog::getCurrentObjectInfo()
@@ -77,6 +77,10 @@ void CLIProcessor::parseCLIArgsPreConfig(const QStringList& argList)
 			  << "--spout (or -S) <sky|all> : Act as SPOUT sender (Sky only/including GUI)\n"
 			  << "--spout-name <name>     : Set particular name for SPOUT sender.\n"
 			#endif
+			#endif
+			#ifdef ENABLE_DMABUF
+			  << "--dmabuf-name <name>    : Share the sky frames as DMA-BUF with other programs,\n"
+			  << "                          through the local socket of this name\n"
 			#endif
 			  << "--screenshot-dir        : Specify directory to save screenshots\n"
 			  << "--startup-script        : Specify name of startup script\n"
@@ -93,7 +97,21 @@ void CLIProcessor::parseCLIArgsPreConfig(const QStringList& argList)
 		          << "--projection-type       : Specify projection type, e.g. stereographic\n"
 		          << "--restore-defaults      : Delete existing config.ini and use defaults\n"
 		          << "--multires-image        : With filename / URL argument, specify a\n"
-		          << "                          multi-resolution image to load\n";
+		          << "                          multi-resolution image to load\n"
+		          << "--batch                 : With filename argument, run the queries of a job\n"
+		          << "                          file without GUI and exit\n"
+		          << "--batch-output          : Specify directory to save the output of --batch\n"
+		          << "--benchmark             : With filename argument, draw the scenes of a\n"
+		          << "                          benchmark file, write their frame times and exit\n"
+		          << "--benchmark-output      : Specify the JSON file of the --benchmark results\n"
+		          << "--record-session        : With filename argument, record the inputs of each\n"
+		          << "                          frame (time, view, location, properties, selection)\n"
+		          << "--replay-session        : With filename argument, draw the frames of a session\n"
+		          << "                          recorded with --record-session, write their profile\n"
+		          << "                          and exit\n"
+		          << "--replay-output         : Specify the trace file of --replay-session\n"
+		          << "--startup-trace[=file]  : Write a trace of the startup steps, by default\n"
+		          << "                          to startup_trace-<date>.json in the user directory\n";
 		exit(0);
 	}
 
@@ -151,6 +169,54 @@ void CLIProcessor::parseCLIArgsPreConfig(const QStringList& argList)
 		exit(0);
 	}
 
+	try
+	{
+		const QString batchFile = argsGetOptionWithArg(argList, "", "--batch", "").toString();
+		if (!batchFile.isEmpty())
+		{
+			qApp->setProperty("batch_file", batchFile);
+			qApp->setProperty("batch_output", argsGetOptionWithArg(argList, "", "--batch-output", "").toString());
+		}
+	}
+	catch (std::runtime_error& e)
+	{
+		qCritical() << "ERROR: while processing --batch option: " << e.what();
+		exit(1);
+	}
+
+	try
+	{
+		const QString benchmarkFile = argsGetOptionWithArg(argList, "", "--benchmark", "").toString();
+		if (!benchmarkFile.isEmpty())
+		{
+			qApp->setProperty("benchmark_file", benchmarkFile);
+			qApp->setProperty("benchmark_output", argsGetOptionWithArg(argList, "", "--benchmark-output", "").toString());
+		}
+	}
+	catch (std::runtime_error& e)
+	{
+		qCritical() << "ERROR: while processing --benchmark option: " << e.what();
+		exit(1);
+	}
+
+	try
+	{
+		const QString recordFile = argsGetOptionWithArg(argList, "", "--record-session", "").toString();
+		if (!recordFile.isEmpty())
+			qApp->setProperty("record_session_file", recordFile);
+		const QString replayFile = argsGetOptionWithArg(argList, "", "--replay-session", "").toString();
+		if (!replayFile.isEmpty())
+		{
+			qApp->setProperty("replay_session_file", replayFile);
+			qApp->setProperty("replay_output", argsGetOptionWithArg(argList, "", "--replay-output", "").toString());
+		}
+	}
+	catch (std::runtime_error& e)
+	{
+		qCritical() << "ERROR: while processing --record-session or --replay-session option: " << e.what();
+		exit(1);
+	}
+
 	try
 	{
 		QString newUserDir;
@@ -175,6 +241,9 @@ void CLIProcessor::parseCLIArgsPostConfig(const QStringList& argList, QSettings*
 	QString projectionType, screenshotDir, multiresImage, startupScript;
 #ifdef ENABLE_SPOUT
 	QString spoutStr, spoutName;
+#endif
+#ifdef ENABLE_DMABUF
+	QString dmaBufName;
 #endif
 	try
 	{
@@ -198,6 +267,9 @@ void CLIProcessor::parseCLIArgsPostConfig(const QStringList& argList, QSettings*
 		// Unfortunately, this still throws an exception when no optarg string is given.
 		spoutStr  = argsGetOptionWithArg(argList, "-S", "--spout", "").toString();
 		spoutName = argsGetOptionWithArg(argList, "", "--spout-name", "").toString();
+#endif
+#ifdef ENABLE_DMABUF
+		dmaBufName = argsGetOptionWithArg(argList, "", "--dmabuf-name", "").toString();
 #endif
 	}
 	catch (std::runtime_error& e)
@@ -310,6 +382,10 @@ void CLIProcessor::parseCLIArgsPostConfig(const QStringList& argList, QSettings*
 	if (!spoutName.isEmpty())
 		qApp->setProperty("spoutName", spoutName);
 #endif
+#ifdef ENABLE_DMABUF
+	if (!dmaBufName.isEmpty())
+		qApp->setProperty("dmabufName", dmaBufName);
+#endif
 
 }
 
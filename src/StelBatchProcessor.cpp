@@ -0,0 +1,494 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelBatchProcessor.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelIniParser.hpp"
+#include "StelJobMgr.hpp"
+#include "StelObjectMgr.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelUtils.hpp"
+#include "SolarSystem.hpp"
+#include "Planet.hpp"
+#include "EphemerisGenerator.hpp"
+#include "ObserverEphemeris.hpp"
+#include "PhenomenaFinder.hpp"
+#include "RiseSetSolver.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPair>
+#include <QSettings>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+
+StelBatchProcessor::StelBatchProcessor(const QString& jobFile, const QString& outputDir)
+	: jobFile(jobFile)
+	, outputDir(outputDir.isEmpty() ? QDir::currentPath() : outputDir)
+{
+}
+
+int StelBatchProcessor::exec(QSettings* conf)
+{
+	if (!readQueries())
+		return 1;
+
+	StelApp::initStatic();
+	StelApp* app = new StelApp(Q_NULLPTR);
+	app->initHeadless(conf);
+	qDebug() << "Batch mode: running" << queries.size() << "queries from" << QDir::toNativeSeparators(jobFile);
+
+	QList<Query> ephemerisQueries, separationQueries;
+	for (const auto& query : queries)
+	{
+		if (query.type=="ephemeris")
+			ephemerisQueries.append(query);
+		else if (query.type=="separation")
+			separationQueries.append(query);
+	}
+
+	bool ok = true;
+	// The background jobs are queued first, so that they run while the main thread computes the events
+	ok &= runEphemeris(ephemerisQueries);
+	ok &= runSeparations(separationQueries);
+	for (const auto& query : queries)
+	{
+		if (query.type=="events")
+			ok &= runEvents(query);
+		else if (query.type=="phenomena")
+			ok &= runPhenomena(query);
+	}
+
+	delete app;
+	StelApp::deinitStatic();
+	return ok ? 0 : 1;
+}
+
+bool StelBatchProcessor::readQueries()
+{
+	if (!QFileInfo(jobFile).isReadable())
+	{
+		qWarning() << "ERROR: batch job file" << QDir::toNativeSeparators(jobFile) << "can't be read";
+		return false;
+	}
+
+	QSettings jobs(jobFile, StelIniFormat);
+	bool ok = true;
+	for (const auto& group : jobs.childGroups())
+	{
+		jobs.beginGroup(group);
+		Query query;
+		query.name = group;
+		query.type = jobs.value("type").toString().toLower();
+		// The ini parser keeps the list as one string
+		const QVariant objects = jobs.value("objects");
+		query.objects = objects.type()==QVariant::StringList ? objects.toStringList() : objects.toString().split(',', QString::SkipEmptyParts);
+		for (auto& name : query.objects)
+			name = name.trimmed();
+		query.object1 = jobs.value("object1").toString().trimmed();
+		query.horizontal = jobs.value("frame", "equatorial").toString().toLower()=="horizontal";
+		query.horizon = jobs.value("horizon", 0.).toDouble();
+		query.maxSeparation = jobs.value("max_separation", 1.).toDouble();
+		query.opposition = jobs.value("opposition", false).toBool();
+		query.outputFile = jobs.value("output", group + ".csv").toString();
+
+		bool valid = parseDate(jobs.value("start").toString(), &query.startJD)
+			  && parseDate(jobs.value("stop").toString(), &query.stopJD)
+			  && parseStep(jobs.value("step", "1").toString(), &query.step)
+			  && query.stopJD>=query.startJD;
+		if (!valid)
+			qWarning() << "ERROR: batch query" << group << "has an invalid range of dates";
+		if (query.objects.isEmpty())
+		{
+			qWarning() << "ERROR: batch query" << group << "has no objects";
+			valid = false;
+		}
+		if ((query.type=="separation" || query.type=="phenomena") && query.object1.isEmpty())
+		{
+			qWarning() << "ERROR: batch query" << group << "has no object1";
+			valid = false;
+		}
+		if (query.type!="ephemeris" && query.type!="events" && query.type!="separation" && query.type!="phenomena")
+		{
+			qWarning() << "ERROR: batch query" << group << "has an unknown type" << query.type;
+			valid = false;
+		}
+		jobs.endGroup();
+
+		if (valid)
+			queries.append(query);
+		ok &= valid;
+	}
+	if (queries.isEmpty())
+	{
+		qWarning() << "ERROR: no valid query in batch job file" << QDir::toNativeSeparators(jobFile);
+		return false;
+	}
+	return ok;
+}
+
+QVector<double> StelBatchProcessor::getDates(const Query& query)
+{
+	QVector<double> dates;
+	const int count = static_cast<int>(std::floor((query.stopJD - query.startJD)/query.step + 1e-9)) + 1;
+	dates.reserve(count);
+	for (int i=0; i<count; ++i)
+		dates.append(query.startJD + i*query.step);
+	return dates;
+}
+
+bool StelBatchProcessor::parseDate(const QString& text, double* JD)
+{
+	bool ok;
+	*JD = text.toDouble(&ok);
+	if (!ok)
+		*JD = StelUtils::getJulianDayFromISO8601String(text.trimmed(), &ok);
+	return ok;
+}
+
+bool StelBatchProcessor::parseStep(const QString& text, double* step)
+{
+	QString value = text.trimmed().toLower();
+	double unit = 1.;
+	if (value.endsWith('d'))
+		value.chop(1);
+	else if (value.endsWith('h'))
+	{
+		value.chop(1);
+		unit = StelCore::JD_HOUR;
+	}
+	else if (value.endsWith('m'))
+	{
+		value.chop(1);
+		unit = StelCore::JD_MINUTE;
+	}
+	else if (value.endsWith('s'))
+	{
+		value.chop(1);
+		unit = StelCore::JD_SECOND;
+	}
+	bool ok;
+	*step = value.toDouble(&ok) * unit;
+	return ok && *step>0.;
+}
+
+bool StelBatchProcessor::runEphemeris(const QList<Query>& queries)
+{
+	StelCore* core = StelApp::getInstance().getCore();
+	const SolarSystem* ssystem = GETSTELMODULE(SolarSystem);
+	bool ok = true;
+
+	// One job per object, all queued before waiting for the first one
+	typedef QPair<QString, EphemerisGenerator*> NamedGenerator;
+	QList<QList<NamedGenerator> > generators;
+	for (const auto& query : queries)
+	{
+		const QVector<double> dates = getDates(query);
+		QList<NamedGenerator> queryGenerators;
+		for (const auto& name : query.objects)
+		{
+			const PlanetP planet = ssystem->searchByEnglishName(name);
+			if (!planet)
+			{
+				qWarning() << "ERROR: batch query" << query.name << ": ephemeris need a solar system body, not" << name;
+				ok = false;
+				continue;
+			}
+			EphemerisGenerator* generator = new EphemerisGenerator(core, planet, dates, query.horizontal);
+			generator->start();
+			queryGenerators.append(NamedGenerator(name, generator));
+		}
+		generators.append(queryGenerators);
+	}
+
+	for (int i=0; i<queries.size(); ++i)
+	{
+		const Query& query = queries.at(i);
+		QFile file(QDir(outputDir).filePath(query.outputFile));
+		const bool opened = file.open(QIODevice::WriteOnly | QIODevice::Text);
+		if (!opened)
+		{
+			qWarning() << "ERROR: batch query" << query.name << ": can't write" << QDir::toNativeSeparators(file.fileName());
+			ok = false;
+		}
+		QTextStream out(&file);
+		out.setCodec("UTF-8");
+		if (query.horizontal)
+			writeRow(out, QStringList() << "object" << "jd" << "date_utc" << "azimuth_deg" << "altitude_deg" << "distance_au"
+				 << "magnitude" << "phase" << "elongation_deg");
+		else
+			writeRow(out, QStringList() << "object" << "jd" << "date_utc" << "ra_j2000_deg" << "dec_j2000_deg" << "distance_au"
+				 << "magnitude" << "phase" << "elongation_deg");
+
+		for (const auto& named : generators.at(i))
+		{
+			EphemerisGenerator* generator = named.second;
+			generator->waitForFinished();
+			for (const auto& row : generator->takeRows())
+			{
+				double longitude, latitude;
+				StelUtils::rectToSphere(&longitude, &latitude, row.pos);
+				if (query.horizontal)
+				{
+					// Azimuth from the north, increasing to the east
+					longitude = 3.*M_PI - longitude;
+					if (longitude > 2.*M_PI)
+						longitude -= 2.*M_PI;
+				}
+				else if (longitude < 0.)
+					longitude += 2.*M_PI;
+				if (opened)
+					writeRow(out, QStringList() << named.first << formatNumber(row.JD, 6) << StelUtils::julianDayToISO8601String(row.JD)
+						 << formatNumber(longitude*180./M_PI, 6) << formatNumber(latitude*180./M_PI, 6)
+						 << formatNumber(row.distance, 9) << formatNumber(row.magnitude, 2)
+						 << formatNumber(row.phase, 4) << formatNumber(row.elongation*180./M_PI, 6));
+			}
+			delete generator;
+		}
+	}
+	return ok;
+}
+
+bool StelBatchProcessor::runSeparations(const QList<Query>& queries)
+{
+	StelCore* core = StelApp::getInstance().getCore();
+	const SolarSystem* ssystem = GETSTELMODULE(SolarSystem);
+	const StelObjectMgr& objectMgr = StelApp::getInstance().getStelObjectMgr();
+	bool ok = true;
+
+	// An object is a solar system body, or a fixed J2000 direction
+	struct Target
+	{
+		QString name;
+		PlanetP planet;
+		Vec3d fixedPos;
+	};
+	auto findTarget = [&](const QString& name, Target* target) -> bool
+	{
+		target->name = name;
+		target->planet = ssystem->searchByEnglishName(name);
+		if (target->planet)
+			return true;
+		const StelObjectP obj = objectMgr.searchByName(name);
+		if (!obj)
+			return false;
+		target->fixedPos = obj->getJ2000EquatorialPos(core);
+		target->fixedPos.normalize();
+		return true;
+	};
+
+	struct Pair
+	{
+		Target target1, target2;
+		QVector<double> separations;
+		StelJobP job;
+	};
+	struct Computation
+	{
+		QSharedPointer<ObserverEphemeris> ephemeris;
+		QVector<double> dates;
+		QList<QSharedPointer<Pair> > pairs;
+	};
+
+	QList<Computation> computations;
+	for (const auto& query : queries)
+	{
+		Computation computation;
+		computation.dates = getDates(query);
+		computation.ephemeris.reset(new ObserverEphemeris(core, query.startJD, query.stopJD));
+		Target target1;
+		if (!findTarget(query.object1, &target1))
+		{
+			qWarning() << "ERROR: batch query" << query.name << ": unknown object" << query.object1;
+			ok = false;
+		}
+		else
+		{
+			for (const auto& name : query.objects)
+			{
+				QSharedPointer<Pair> pair(new Pair());
+				pair->target1 = target1;
+				if (!findTarget(name, &pair->target2))
+				{
+					qWarning() << "ERROR: batch query" << query.name << ": unknown object" << name;
+					ok = false;
+					continue;
+				}
+				const QSharedPointer<ObserverEphemeris> ephemeris = computation.ephemeris;
+				const QVector<double> dates = computation.dates;
+				pair->job = StelApp::getInstance().getJobMgr().submit([pair, ephemeris, dates]()
+				{
+					auto direction = [&](const Target& target, const ObserverEphemeris::Frame& frame)
+					{
+						if (!target.planet)
+							return target.fixedPos;
+						Vec3d pos = ephemeris->computeJ2000Pos(target.planet, frame);
+						pos.normalize();
+						return pos;
+					};
+					pair->separations.reserve(dates.size());
+					for (auto JD : dates)
+					{
+						const ObserverEphemeris::Frame frame = ephemeris->computeFrame(JD);
+						pair->separations.append(direction(pair->target1, frame).angle(direction(pair->target2, frame)));
+					}
+				});
+				computation.pairs.append(pair);
+			}
+		}
+		computations.append(computation);
+	}
+
+	for (int i=0; i<queries.size(); ++i)
+	{
+		const Query& query = queries.at(i);
+		const Computation& computation = computations.at(i);
+		QFile file(QDir(outputDir).filePath(query.outputFile));
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+		{
+			qWarning() << "ERROR: batch query" << query.name << ": can't write" << QDir::toNativeSeparators(file.fileName());
+			ok = false;
+			continue;
+		}
+		QTextStream out(&file);
+		out.setCodec("UTF-8");
+		writeRow(out, QStringList() << "object1" << "object2" << "jd" << "date_utc" << "separation_deg");
+		for (const auto& pair : computation.pairs)
+		{
+			pair->job->waitForFinished();
+			for (int j=0; j<pair->separations.size(); ++j)
+			{
+				const double JD = computation.dates.at(j);
+				writeRow(out, QStringList() << pair->target1.name << pair->target2.name << formatNumber(JD, 6)
+					 << StelUtils::julianDayToISO8601String(JD) << formatNumber(pair->separations.at(j)*180./M_PI, 6));
+			}
+		}
+	}
+	return ok;
+}
+
+bool StelBatchProcessor::runEvents(const Query& query)
+{
+	StelCore* core = StelApp::getInstance().getCore();
+	RiseSetSolver* solver = core->getRiseSetSolver();
+	const StelObjectMgr& objectMgr = StelApp::getInstance().getStelObjectMgr();
+	bool ok = true;
+
+	QFile file(QDir(outputDir).filePath(query.outputFile));
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+	{
+		qWarning() << "ERROR: batch query" << query.name << ": can't write" << QDir::toNativeSeparators(file.fileName());
+		return false;
+	}
+	QTextStream out(&file);
+	out.setCodec("UTF-8");
+	writeRow(out, QStringList() << "object" << "event" << "jd" << "date_utc" << "altitude_deg");
+
+	struct Event
+	{
+		double JD;
+		const char* type;
+		double altitude;	// NaN if not a transit
+	};
+	for (const auto& name : query.objects)
+	{
+		const StelObjectP obj = objectMgr.searchByName(name);
+		if (!obj || !solver->canSolve(obj.data()))
+		{
+			qWarning() << "ERROR: batch query" << query.name << ": can't compute the events of" << name;
+			ok = false;
+			continue;
+		}
+
+		// The days of the solver are local days, the events outside of the range are dropped
+		double dayStart = solver->getDayStart(query.startJD);
+		while (dayStart < query.stopJD)
+		{
+			const RiseSetSolver::DayEvents day = solver->getDayEvents(obj.data(), dayStart + 0.5, query.horizon*M_PI/180.);
+			QVector<Event> events;
+			for (auto JD : day.rises)
+				events.append({JD, "rise", NAN});
+			for (int i=0; i<day.transits.size(); ++i)
+				events.append({day.transits.at(i), "transit", day.transitAltitudes.at(i)});
+			for (auto JD : day.sets)
+				events.append({JD, "set", NAN});
+			std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.JD < b.JD; });
+			for (const auto& event : events)
+			{
+				if (event.JD < query.startJD || event.JD > query.stopJD)
+					continue;
+				writeRow(out, QStringList() << name << event.type << formatNumber(event.JD, 6)
+					 << StelUtils::julianDayToISO8601String(event.JD) << formatNumber(event.altitude*180./M_PI, 6));
+			}
+			// Noon of the next day, as days are not always 24 hours long
+			dayStart = solver->getDayStart(day.startJD + 1.5);
+		}
+	}
+	return ok;
+}
+
+bool StelBatchProcessor::runPhenomena(const Query& query)
+{
+	const QVariantList phenomena = PhenomenaFinder::findPhenomena(query.object1, query.objects, query.startJD, query.stopJD,
+								      query.maxSeparation, query.opposition);
+
+	QFile file(QDir(outputDir).filePath(query.outputFile));
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+	{
+		qWarning() << "ERROR: batch query" << query.name << ": can't write" << QDir::toNativeSeparators(file.fileName());
+		return false;
+	}
+	QTextStream out(&file);
+	out.setCodec("UTF-8");
+	writeRow(out, QStringList() << "object1" << "object2" << "type" << "jd" << "date_utc" << "separation_deg");
+	for (const auto& phenomenon : phenomena)
+	{
+		const QVariantMap map = phenomenon.toMap();
+		const double JD = map.value("jd").toDouble();
+		writeRow(out, QStringList() << map.value("object1").toString() << map.value("object2").toString()
+			 << map.value("type").toString() << formatNumber(JD, 6) << StelUtils::julianDayToISO8601String(JD)
+			 << formatNumber(map.value("separation").toDouble(), 6));
+	}
+	return true;
+}
+
+void StelBatchProcessor::writeRow(QTextStream& out, const QStringList& fields)
+{
+	QStringList quoted;
+	for (const auto& field : fields)
+	{
+		if (field.contains(',') || field.contains('"'))
+			quoted << "\"" + QString(field).replace("\"", "\"\"") + "\"";
+		else
+			quoted << field;
+	}
+	out << quoted.join(',') << '\n';
+}
+
+QString StelBatchProcessor::formatNumber(double value, int precision)
+{
+	// Missing values are empty fields
+	return std::isnan(value) ? QString() : QString::number(value, 'f', precision);
+}
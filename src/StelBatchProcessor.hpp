@@ -0,0 +1,106 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef STELBATCHPROCESSOR_HPP
+#define STELBATCHPROCESSOR_HPP
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QSettings;
+class QTextStream;
+
+//! @class StelBatchProcessor
+//! Runs the queries of a job file without OpenGL context and GUI, for the --batch option of the command line.
+//! Only StelCore, SolarSystem, StarMgr and NebulaMgr are initialized (see StelApp::initHeadless()), with the
+//! location and settings of the configuration file and the command line.
+//! The job file is an ini file with one group per query. Each query writes a CSV file named after the group
+//! (or the output key) in the output directory. Keys of a query:
+//! - type: ephemeris, events, separation or phenomena
+//! - objects: comma separated English names of the objects
+//! - object1: the reference object of separation and phenomena queries
+//! - start, stop: the range of dates, as JD or ISO 8601 dates (UTC)
+//! - step: the interval of ephemeris and separation queries, in days or with a suffix d, h, m or s (default 1d)
+//! - frame: equatorial (J2000, default) or horizontal, for ephemeris queries
+//! - horizon: the altitude of the horizon for events queries [degrees] (default 0)
+//! - max_separation: the maximum separation of phenomena queries [degrees] (default 1)
+//! - opposition: true to also find oppositions in phenomena queries (default false)
+//! - output: the name of the CSV file
+//! Ephemeris queries are computed for solar system bodies only. Ephemeris and separation queries run in
+//! parallel in StelJobMgr, phenomena queries use the thread pool of PhenomenaFinder, and events queries
+//! run on the main thread with the cache of RiseSetSolver.
+class StelBatchProcessor
+{
+public:
+	//! @param jobFile the path of the job file
+	//! @param outputDir the directory of the CSV files, the current directory if empty
+	StelBatchProcessor(const QString& jobFile, const QString& outputDir);
+
+	//! Initialize StelApp without OpenGL context and run all the queries.
+	//! @param conf the configuration, with the options of the command line applied
+	//! @return the exit status of the program: 0 if all the queries succeeded
+	int exec(QSettings* conf);
+
+private:
+	struct Query
+	{
+		QString name;
+		QString type;
+		QStringList objects;
+		QString object1;
+		double startJD;
+		double stopJD;
+		double step;		// [days]
+		bool horizontal;
+		double horizon;		// [degrees]
+		double maxSeparation;	// [degrees]
+		bool opposition;
+		QString outputFile;
+	};
+
+	//! Read the queries from the job file.
+	//! @return false if the file can't be read or a query is invalid
+	bool readQueries();
+	//! Get the dates of an ephemeris or separation query.
+	static QVector<double> getDates(const Query& query);
+	//! Parse a date as JD or ISO 8601 string (UTC).
+	static bool parseDate(const QString& text, double* JD);
+	//! Parse an interval in days, or with a suffix d, h, m or s.
+	static bool parseStep(const QString& text, double* step);
+
+	//! Compute the ephemeris queries in parallel and write their output.
+	bool runEphemeris(const QList<Query>& queries);
+	//! Compute the separation queries in parallel and write their output.
+	bool runSeparations(const QList<Query>& queries);
+	bool runEvents(const Query& query);
+	bool runPhenomena(const Query& query);
+
+	//! Write a line of CSV, quoting the fields which need it.
+	static void writeRow(QTextStream& out, const QStringList& fields);
+	static QString formatNumber(double value, int precision);
+
+	QString jobFile;
+	QString outputDir;
+	QList<Query> queries;
+};
+
+#endif // STELBATCHPROCESSOR_HPP
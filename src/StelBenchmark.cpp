@@ -0,0 +1,450 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelBenchmark.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelFrameProfiler.hpp"
+#include "StelIniParser.hpp"
+#include "StelLocationMgr.hpp"
+#include "StelMainView.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelMovementMgr.hpp"
+#include "StelPropertyMgr.hpp"
+#include "StelUtils.hpp"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QSettings>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	//! The frames kept by StelFrameProfiler
+	const int MAX_MEASURED_FRAMES = 600;
+
+	QStringList splitList(const QVariant& value, QChar separator)
+	{
+		// The ini parser keeps the list as one string
+		QStringList items = value.type()==QVariant::StringList ? value.toStringList() : value.toString().split(separator, QString::SkipEmptyParts);
+		for (auto& item : items)
+			item = item.trimmed();
+		items.removeAll(QString());
+		return items;
+	}
+}
+
+StelBenchmark::StelBenchmark(const QString& sceneFile, const QString& outputFile)
+	: sceneFile(sceneFile)
+	, outputFile(outputFile.isEmpty() ? QDir::current().filePath("benchmark.json") : outputFile)
+	, width(1280)
+	, height(720)
+	, warmupFrames(120)
+	, readyTimeout(60.)
+	, sceneIndex(0)
+	, phase(Setup)
+	, frameCount(0)
+	, sceneReady(false)
+	, ok(true)
+{
+	setObjectName("StelBenchmark");
+}
+
+bool StelBenchmark::configure(const QString& sceneFile, QSettings* conf)
+{
+	if (!QFileInfo(sceneFile).isReadable())
+	{
+		qWarning() << "ERROR: benchmark scene file" << QDir::toNativeSeparators(sceneFile) << "can't be read";
+		return false;
+	}
+	QSettings file(sceneFile, StelIniFormat);
+	const QStringList groups = file.childGroups();
+	if (groups.isEmpty())
+	{
+		qWarning() << "ERROR: benchmark scene file" << QDir::toNativeSeparators(sceneFile) << "has no scene";
+		return false;
+	}
+
+	conf->setValue("video/fullscreen", false);
+	conf->setValue("video/screen_w", file.value("width", 1280).toInt());
+	conf->setValue("video/screen_h", file.value("height", 720).toInt());
+	conf->setValue("video/screen_x", 0);
+	conf->setValue("video/screen_y", 0);
+	conf->setValue("video/vsync", false);
+	conf->setValue("video/minimum_fps", 10000);
+	conf->setValue("video/maximum_fps", 10000);
+	// The IDs of core modules are ignored there
+	for (const auto& group : groups)
+	{
+		for (const auto& id : splitList(file.value(group + "/modules"), ','))
+			conf->setValue("plugins_load_at_startup/" + id, true);
+	}
+	return true;
+}
+
+void StelBenchmark::init()
+{
+	if (!readScenes() || scenes.isEmpty())
+	{
+		ok = false;
+		finish();
+		return;
+	}
+	StelFrameProfiler* profiler = StelApp::getInstance().getFrameProfiler();
+	profiler->setOverlayVisible(false);
+	profiler->setEnabled(false);
+	qDebug() << "Benchmark: drawing" << scenes.size() << "scenes from" << QDir::toNativeSeparators(sceneFile);
+}
+
+double StelBenchmark::getCallOrder(StelModuleActionName actionName) const
+{
+	// The changes of the scene are used by the other modules in the same frame
+	if (actionName==StelModule::ActionUpdate)
+		return -1000.;
+	return 0.;
+}
+
+bool StelBenchmark::readScenes()
+{
+	QSettings file(sceneFile, StelIniFormat);
+	width = file.value("width", 1280).toInt();
+	height = file.value("height", 720).toInt();
+	warmupFrames = qMax(0, file.value("warmup_frames", 120).toInt());
+	readyTimeout = file.value("ready_timeout", 60.).toDouble();
+	const int defaultFrames = file.value("frames", 300).toInt();
+
+	bool valid = true;
+	for (const auto& group : file.childGroups())
+	{
+		file.beginGroup(group);
+		Scene scene;
+		scene.name = group;
+		scene.modules = splitList(file.value("modules"), ',');
+		scene.location = file.value("location").toString().trimmed();
+		scene.azimuth = file.value("azimuth", 180.).toDouble();
+		scene.altitude = file.value("altitude", 45.).toDouble();
+		scene.fov = file.value("fov", 60.).toDouble();
+		scene.fovEnd = file.value("fov_end", 0.).toDouble();
+		scene.projection = file.value("projection").toString().trimmed();
+		scene.properties = splitPairs(splitList(file.value("properties"), ';'), '=');
+		scene.calls = splitPairs(splitList(file.value("invoke"), ';'), ':');
+		scene.hips = file.value("hips").toString().trimmed();
+		scene.readyProperty = file.value("ready").toString().trimmed();
+		scene.frames = qBound(2, file.value("frames", defaultFrames).toInt(), MAX_MEASURED_FRAMES);
+
+		const QString date = file.value("date").toString().trimmed();
+		bool dateOk = false;
+		scene.JD = date.toDouble(&dateOk);
+		if (!dateOk)
+			scene.JD = StelUtils::getJulianDayFromISO8601String(date, &dateOk);
+		if (!dateOk)
+		{
+			qWarning() << "ERROR: benchmark scene" << group << "has an invalid date" << date;
+			valid = false;
+		}
+		file.endGroup();
+		scenes.append(scene);
+	}
+	return valid;
+}
+
+QList<QPair<QString, QString> > StelBenchmark::splitPairs(const QStringList& items, QChar separator)
+{
+	QList<QPair<QString, QString> > pairs;
+	for (const auto& item : items)
+	{
+		const int pos = item.indexOf(separator);
+		if (pos<0)
+			pairs.append(qMakePair(item.trimmed(), QString()));
+		else
+			pairs.append(qMakePair(item.left(pos).trimmed(), item.mid(pos+1).trimmed()));
+	}
+	return pairs;
+}
+
+void StelBenchmark::update(double deltaTime)
+{
+	Q_UNUSED(deltaTime)
+	if (sceneIndex>=scenes.size())
+		return;
+	const Scene& scene = scenes.at(sceneIndex);
+	StelFrameProfiler* profiler = StelApp::getInstance().getFrameProfiler();
+
+	switch (phase)
+	{
+		case Setup:
+			if (setupScene(scene))
+			{
+				qDebug() << "Benchmark: scene" << scene.name;
+				phase = WaitReady;
+				waitTimer.start();
+			}
+			break;
+		case WaitReady:
+			sceneReady = isReady(scene);
+			if (!sceneReady && waitTimer.elapsed() < readyTimeout*1000.)
+				break;
+			if (!sceneReady)
+				qWarning() << "Benchmark: scene" << scene.name << "is still not ready after" << readyTimeout << "s";
+			phase = Warmup;
+			frameCount = 0;
+			break;
+		case Warmup:
+			if (++frameCount < warmupFrames)
+				break;
+			// Drop the frames recorded so far, the frame which is drawn now is not recorded either.
+			profiler->setEnabled(false);
+			profiler->setEnabled(true);
+			phase = Measure;
+			frameCount = 0;
+			break;
+		case Measure:
+			if (frameCount < scene.frames)
+			{
+				if (scene.fovEnd>0.)
+				{
+					// The same zoom speed at all scales
+					const double t = static_cast<double>(frameCount)/(scene.frames-1);
+					setView(scene, scene.fov*std::pow(scene.fovEnd/scene.fov, t));
+				}
+				++frameCount;
+				break;
+			}
+			finishScene(scene);
+			break;
+	}
+}
+
+bool StelBenchmark::setupScene(const Scene& scene)
+{
+	StelApp& app = StelApp::getInstance();
+	for (const auto& id : scene.modules)
+	{
+		if (!app.getModuleMgr().getModule(id, true))
+		{
+			skipScene(scene, QString("module %1 is not loaded").arg(id));
+			return false;
+		}
+	}
+
+	StelCore* core = app.getCore();
+	core->setTimeRate(0.);
+	core->setJD(scene.JD);
+	if (!scene.location.isEmpty())
+	{
+		const StelLocation location = app.getLocationMgr().locationForString(scene.location);
+		if (!location.isValid())
+		{
+			skipScene(scene, QString("unknown location %1").arg(scene.location));
+			return false;
+		}
+		core->moveObserverTo(location, 0., 0.);
+	}
+	if (!scene.projection.isEmpty())
+		core->setCurrentProjectionTypeKey(scene.projection);
+
+	StelPropertyMgr* propMgr = app.getStelPropertyManager();
+	savedProperties.clear();
+	for (const auto& property : scene.properties)
+	{
+		const QVariant previous = propMgr->getStelPropertyValue(property.first);
+		if (!previous.isValid() || !propMgr->setStelPropertyValue(property.first, property.second))
+		{
+			qWarning() << "ERROR: benchmark scene" << scene.name << "can't set the property" << property.first;
+			ok = false;
+			continue;
+		}
+		savedProperties.append(qMakePair(property.first, previous));
+	}
+
+	for (const auto& call : scene.calls)
+	{
+		const int pos = call.first.lastIndexOf('.');
+		StelModule* module = app.getModuleMgr().getModule(call.first.left(pos), true);
+		if (pos<0 || !module || !QMetaObject::invokeMethod(module, call.first.mid(pos+1).toLatin1().constData(), Qt::DirectConnection, Q_ARG(QString, call.second)))
+		{
+			qWarning() << "ERROR: benchmark scene" << scene.name << "can't call" << call.first;
+			ok = false;
+		}
+	}
+
+	setView(scene, scene.fov);
+	return true;
+}
+
+bool StelBenchmark::isReady(const Scene& scene)
+{
+	StelApp& app = StelApp::getInstance();
+	if (!scene.hips.isEmpty() && !hipsSurvey)
+	{
+		StelModule* hipsMgr = app.getModuleMgr().getModule("HipsMgr", true);
+		if (!hipsMgr || !hipsMgr->property("loaded").toBool())
+			return false;
+		QMetaObject::invokeMethod(hipsMgr, "getSurveyByUrl", Qt::DirectConnection,
+					  Q_RETURN_ARG(HipsSurveyP, hipsSurvey), Q_ARG(QString, scene.hips));
+		if (!hipsSurvey)
+		{
+			qWarning() << "ERROR: benchmark scene" << scene.name << "has an unknown HiPS survey" << scene.hips;
+			ok = false;
+			return true;
+		}
+		savedProperties.append(qMakePair(QString("HipsMgr.flagShow"), hipsMgr->property("flagShow")));
+		hipsMgr->setProperty("flagShow", true);
+		hipsSurvey->setProperty("visible", true);
+	}
+	if (scene.readyProperty.isEmpty())
+		return true;
+	return app.getStelPropertyManager()->getStelPropertyValue(scene.readyProperty).toBool();
+}
+
+void StelBenchmark::setView(const Scene& scene, double fov) const
+{
+	StelCore* core = StelApp::getInstance().getCore();
+	StelMovementMgr* mvmgr = core->getMovementMgr();
+	mvmgr->setFlagTracking(false);
+	// The azimuth of StelCore is counted from the south
+	Vec3d direction;
+	StelUtils::spheToRect((180.-scene.azimuth)*M_PI/180., scene.altitude*M_PI/180., direction);
+	mvmgr->setViewDirectionJ2000(core->altAzToJ2000(direction, StelCore::RefractionOff));
+	mvmgr->zoomTo(fov, 0.f);
+}
+
+QJsonObject StelBenchmark::statistics(QVector<qint64> values)
+{
+	QJsonObject result;
+	if (values.isEmpty())
+		return result;
+	std::sort(values.begin(), values.end());
+	double sum = 0.;
+	for (auto value : values)
+		sum += value;
+	// Nearest rank
+	auto percentile = [&values](double p) {
+		const int rank = qBound(1, static_cast<int>(std::ceil(p/100.*values.size())), values.size());
+		return values.at(rank-1)/1e6;
+	};
+	result["mean"] = sum/values.size()/1e6;
+	result["p50"] = percentile(50.);
+	result["p90"] = percentile(90.);
+	result["p95"] = percentile(95.);
+	result["p99"] = percentile(99.);
+	result["max"] = values.last()/1e6;
+	return result;
+}
+
+void StelBenchmark::finishScene(const Scene& scene)
+{
+	StelFrameProfiler* profiler = StelApp::getInstance().getFrameProfiler();
+	const QVector<StelFrameProfiler::FrameTimes> frames = profiler->getRecordedFrames();
+	profiler->setEnabled(false);
+
+	QVector<qint64> intervals, cpu, gpu;
+	qint64 counters[StelFrameProfiler::CounterCount] = {};
+	for (const auto& frame : frames)
+	{
+		// The first frame has no interval
+		if (frame.interval>0)
+			intervals.append(frame.interval);
+		cpu.append(frame.cpu);
+		if (frame.gpu>=0)
+			gpu.append(frame.gpu);
+		for (int i=0; i<StelFrameProfiler::CounterCount; ++i)
+			counters[i] += frame.counters[i];
+	}
+
+	QJsonObject result;
+	result["name"] = scene.name;
+	result["frames"] = frames.size();
+	result["ready"] = sceneReady;
+	result["frame_ms"] = statistics(intervals);
+	result["cpu_ms"] = statistics(cpu);
+	if (!gpu.isEmpty())
+		result["gpu_ms"] = statistics(gpu);
+	QJsonObject counterMeans;
+	for (int i=0; i<StelFrameProfiler::CounterCount; ++i)
+	{
+		const StelFrameProfiler::Counter counter = static_cast<StelFrameProfiler::Counter>(i);
+		counterMeans[StelFrameProfiler::getCounterName(counter)] = frames.isEmpty() ? 0. : static_cast<double>(counters[i])/frames.size();
+	}
+	result["counters"] = counterMeans;
+	results.append(result);
+
+	restoreSettings();
+	++sceneIndex;
+	phase = Setup;
+	if (sceneIndex>=scenes.size())
+		finish();
+}
+
+void StelBenchmark::skipScene(const Scene& scene, const QString& reason)
+{
+	qWarning() << "Benchmark: scene" << scene.name << "skipped," << qPrintable(reason);
+	QJsonObject result;
+	result["name"] = scene.name;
+	result["skipped"] = reason;
+	results.append(result);
+
+	restoreSettings();
+	++sceneIndex;
+	phase = Setup;
+	if (sceneIndex>=scenes.size())
+		finish();
+}
+
+void StelBenchmark::restoreSettings()
+{
+	StelPropertyMgr* propMgr = StelApp::getInstance().getStelPropertyManager();
+	for (const auto& property : savedProperties)
+		propMgr->setStelPropertyValue(property.first, property.second);
+	savedProperties.clear();
+	if (hipsSurvey)
+	{
+		hipsSurvey->setProperty("visible", false);
+		hipsSurvey.clear();
+	}
+}
+
+void StelBenchmark::finish()
+{
+	QJsonObject root;
+	root["version"] = StelUtils::getApplicationVersion();
+	const StelMainView::GLInfo glInfo = StelMainView::getInstance().getGLInformation();
+	root["vendor"] = glInfo.vendor;
+	root["renderer"] = glInfo.renderer;
+	root["width"] = width;
+	root["height"] = height;
+	root["scenes"] = results;
+
+	QSaveFile file(outputFile);
+	if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(root).toJson())<0 || !file.commit())
+	{
+		qWarning() << "ERROR: benchmark results can't be written to" << QDir::toNativeSeparators(outputFile);
+		ok = false;
+	}
+	else
+		qDebug() << "Benchmark: results written to" << QDir::toNativeSeparators(outputFile);
+	QCoreApplication::exit(ok ? 0 : 1);
+}
@@ -0,0 +1,151 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef STELBENCHMARK_HPP
+#define STELBENCHMARK_HPP
+
+#include "StelModule.hpp"
+#include "StelHips.hpp"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+class QSettings;
+
+//! @class StelBenchmark
+//! Draws a list of scenes at a fixed window size and simulation time, for the --benchmark option of the command line,
+//! and writes the percentiles of the frame times and the counters of StelFrameProfiler of each scene to a JSON file.
+//! The application quits after the last scene.
+//! The scene file is an ini file. The keys outside of any group apply to all scenes:
+//! - width, height: the size of the window (default 1280x720)
+//! - warmup_frames: the frames drawn before the measure, e.g. to load the textures (default 120)
+//! - frames: the measured frames, at most 600 (default 300)
+//! - ready_timeout: the longest wait for the ready property of a scene [s] (default 60)
+//! Each group is a scene, with the keys:
+//! - modules: comma separated IDs of the modules used, which are loaded at startup; the scene is skipped without them
+//! - location: a location ID or coordinates, see StelLocationMgr::locationForString()
+//! - date: the date and time, as JD or ISO 8601 date (UTC); the time does not flow during the scene
+//! - azimuth, altitude: the view direction [degrees], the azimuth from the north to the east
+//! - fov: the field of view [degrees]
+//! - fov_end: if set, the field of view changes smoothly from fov to fov_end during the measured frames
+//! - projection: a projection key, e.g. ProjectionFisheye
+//! - properties: semicolon separated StelProperty settings, e.g. StarMgr.flagLabelsDisplayed=false; LandscapeMgr.fogDisplayed=false
+//! - invoke: semicolon separated calls of slots of modules with one string argument, e.g. Scenery3d.loadScenery3dByID:Sterngarten
+//! - hips: the URL of a HiPS survey to show, once HipsMgr loaded its sources
+//! - ready: a StelProperty which must become true (or a non empty string) before the warmup, e.g. Scenery3d.currentSceneID
+//! The measure of a scene starts after its warmup frames, so that the frames draw the same sky in every run.
+//! The properties and the HiPS survey of a scene are restored after it, the effects of its calls are not.
+//! Tiles of HiPS surveys are still loaded in the background; mount an offline pack for reproducible results.
+class StelBenchmark : public StelModule
+{
+	Q_OBJECT
+public:
+	//! @param sceneFile the path of the scene file
+	//! @param outputFile the JSON file, benchmark.json in the current directory if empty
+	StelBenchmark(const QString& sceneFile, const QString& outputFile);
+
+	//! Read the scene file, and set the configuration for the benchmark: window size, no full screen,
+	//! no limit of the frame rate and no vsync, and the modules of the scenes loaded at startup.
+	//! This changes the configuration file, use a separate user directory for the benchmark.
+	//! @return false if the scene file can't be read or has no scene
+	static bool configure(const QString& sceneFile, QSettings* conf);
+
+	virtual void init() Q_DECL_OVERRIDE;
+	virtual void update(double deltaTime) Q_DECL_OVERRIDE;
+	virtual double getCallOrder(StelModuleActionName actionName) const Q_DECL_OVERRIDE;
+	//! Only updated, the scene is set before the other modules update
+	virtual bool isActive(StelModuleActionName actionName) const Q_DECL_OVERRIDE {return actionName==ActionUpdate;}
+
+private:
+	struct Scene
+	{
+		QString name;
+		QStringList modules;
+		QString location;
+		double JD;
+		double azimuth;		// [degrees]
+		double altitude;	// [degrees]
+		double fov;		// [degrees]
+		double fovEnd;		// [degrees], 0 for a fixed field of view
+		QString projection;
+		QList<QPair<QString, QString> > properties;
+		QList<QPair<QString, QString> > calls;
+		QString hips;
+		QString readyProperty;
+		int frames;
+	};
+
+	enum Phase
+	{
+		Setup,		// the scene is applied in the next update
+		WaitReady,	// waiting for the ready property
+		Warmup,
+		Measure
+	};
+
+	bool readScenes();
+	//! Apply the settings of the current scene.
+	//! @return false if the scene is skipped
+	bool setupScene(const Scene& scene);
+	//! Show the HiPS survey once the sources are loaded, and check the ready property.
+	bool isReady(const Scene& scene);
+	//! Set the view direction and field of view of the scene.
+	void setView(const Scene& scene, double fov) const;
+	//! Add the statistics of the recorded frames to the results, restore the settings and go to the next scene.
+	void finishScene(const Scene& scene);
+	void skipScene(const Scene& scene, const QString& reason);
+	void restoreSettings();
+	//! Write the results and quit the application.
+	void finish();
+
+	//! Get the mean and percentiles of a list of durations in ns, in ms.
+	static QJsonObject statistics(QVector<qint64> values);
+
+	//! Split the items at the first separator, e.g. "StarMgr.flagStarsDisplayed=true"
+	static QList<QPair<QString, QString> > splitPairs(const QStringList& items, QChar separator);
+
+	QString sceneFile;
+	QString outputFile;
+	QList<Scene> scenes;
+	int width;
+	int height;
+	int warmupFrames;
+	double readyTimeout;	// [s]
+
+	int sceneIndex;
+	Phase phase;
+	int frameCount;
+	QElapsedTimer waitTimer;
+	bool sceneReady;
+	//! The values of the properties before the scene
+	QList<QPair<QString, QVariant> > savedProperties;
+	HipsSurveyP hipsSurvey;
+	QJsonArray results;
+	bool ok;
+};
+
+#endif // STELBENCHMARK_HPP
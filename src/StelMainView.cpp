@@ -33,6 +33,11 @@
 #include "StelOpenGLArray.hpp"
 #include "StelProjector.hpp"
 #include "StelMovementMgr.hpp"
+#include "StelStartupTrace.hpp"
+#include "StelFramePacer.hpp"
+#include "StelScreenshotWriter.hpp"
+#include "StelViewportWindow.hpp"
+#include "StelPropertyMgr.hpp"
 
 #include <QDebug>
 #include <QDir>
@@ -319,7 +324,8 @@ public:
 	StelRootItem(StelMainView* mainView, QGraphicsItem* parent = Q_NULLPTR)
 		: QGraphicsObject(parent),
 		  mainView(mainView),
-		  skyBackgroundColor(0.f,0.f,0.f)
+		  skyBackgroundColor(0.f,0.f,0.f),
+		  redrawOnly(false)
 	{
 		setFlag(QGraphicsItem::ItemClipsToShape);
 		setFlag(QGraphicsItem::ItemClipsChildrenToShape);
@@ -347,6 +353,9 @@ public:
 	//! Get the sky background color. Everything else than black creates a work of art!
 	Vec3f getSkyBackgroundColor() const { return skyBackgroundColor; }
 
+	//! Draw the sky without updating it, to draw the last frame again in an offscreen framebuffer.
+	void setRedrawOnly(bool b) { redrawOnly=b; }
+
 
 protected:
 	virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) Q_DECL_OVERRIDE
@@ -360,7 +369,8 @@ protected:
 		const double now = StelApp::getTotalRunTime();
 		double dt = now - previousPaintTime;
 		//qDebug()<<"dt"<<dt;
-		previousPaintTime = now;
+		if (!redrawOnly)
+			previousPaintTime = now;
 
 		//important to call this, or Qt may have invalid state after we have drawn (wrong textures, etc...)
 		painter->beginNativePainting();
@@ -372,8 +382,19 @@ protected:
 
 		//update and draw
 		StelApp& app = StelApp::getInstance();
-		app.update(dt); // may also issue GL calls
-		app.draw();
+		if (redrawOnly)
+			app.draw();
+		else
+		{
+			StelFramePacer* pacer = mainView->framePacer;
+			pacer->beginUpdate();
+			app.update(dt); // may also issue GL calls
+			pacer->beginDraw();
+			app.draw();
+			pacer->endDraw();
+			// Save the screenshots read in the previous frames
+			mainView->screenshotWriter->processPending();
+		}
 		painter->endNativePainting();
 
 		mainView->drawEnded();
@@ -528,6 +549,7 @@ private:
 	double previousPaintTime;
 	StelMainView* mainView;
 	Vec3f skyBackgroundColor;           //! color which is used to initialize the frame. Should be black, but for some applications e.g. dark blue may be preferred.
+	bool redrawOnly;
 };
 
 //! Initialize and render Stellarium gui.
@@ -569,6 +591,15 @@ StelMainView::StelMainView(QSettings* settings)
 #endif
 	  screenShotPrefix("stellarium-"),
 	  screenShotDir(""),
+	  screenshotWriter(Q_NULLPTR),
+	  frameSequenceActive(false),
+	  frameSequencePipe(false),
+	  frameSequenceWidth(0),
+	  frameSequenceHeight(0),
+	  frameSequenceIndex(0),
+#ifndef USE_OLD_QGLWIDGET
+	  frameSequenceFbo(Q_NULLPTR),
+#endif
 	  flagCursorTimeout(false),
 	  lastEventTimeSec(0.0),
 	  minfps(1.f),
@@ -587,6 +618,13 @@ StelMainView::StelMainView(QSettings* settings)
 	fpsTimer->setInterval(1000/minfps);
 	connect(fpsTimer,SIGNAL(timeout()),this,SLOT(fpsTimerUpdate()));
 
+	framePacer = new StelFramePacer();
+	framePacer->setParent(this);
+	pacingTimer = new QTimer(this);
+	pacingTimer->setTimerType(Qt::PreciseTimer);
+	pacingTimer->setSingleShot(true);
+	connect(pacingTimer,SIGNAL(timeout()),this,SLOT(fpsTimerUpdate()));
+
 	cursorTimeoutTimer = new QTimer(this);
 	cursorTimeoutTimer->setSingleShot(true);
 	connect(cursorTimeoutTimer, SIGNAL(timeout()), this, SLOT(hideCursor()));
@@ -631,10 +669,12 @@ StelMainView::StelMainView(QSettings* settings)
 	// Qt: https://bugreports.qt.io/browse/QTBUG-53273
 	vsdef = false; // use vsync=false by default on macOS
 	#endif
-	if (configuration->value("video/vsync", vsdef).toBool())
+	const bool vsync = configuration->value("video/vsync", vsdef).toBool();
+	if (vsync)
 		glFormat.setSwapInterval(1);
 	else
 		glFormat.setSwapInterval(0);
+	framePacer->init(configuration, vsync);
 
 	qDebug()<<"Desired surface format: "<<glFormat;
 
@@ -650,6 +690,9 @@ StelMainView::StelMainView(QSettings* settings)
 	//QGLWidget should set the format in constructor to prevent creating an unnecessary temporary context
 	glWidget = new StelGLWidget(glFormat, this);
 	setViewport(glWidget);
+#ifndef USE_OLD_QGLWIDGET
+	connect(glWidget, SIGNAL(frameSwapped()), this, SLOT(frameSwapped()));
+#endif
 
 	stelScene = new StelGraphicsScene(this);
 	setScene(stelScene);
@@ -780,6 +823,7 @@ void StelMainView::init()
 #endif
 
 	qDebug()<<"StelMainView::init";
+	StelStartupTrace::Scope trace("startup", "StelMainView::init");
 
 	glInfo.mainContext = QOpenGLContext::currentContext();
 	glInfo.functions = glInfo.mainContext->functions();
@@ -801,6 +845,12 @@ void StelMainView::init()
 	stelApp = new StelApp(this);
 	stelApp->setGui(gui);
 	stelApp->init(conf);
+	stelApp->getStelPropertyManager()->registerObject(framePacer);
+	screenshotWriter = new StelScreenshotWriter();
+#ifndef USE_OLD_QGLWIDGET
+	// Drawn after each swap of the main view, see frameSwapped()
+	viewportWindows = StelViewportWindow::createFromSettings(conf, glContext()->format());
+#endif
 	//setup StelOpenGLArray global state
 	StelOpenGLArray::initGL();
 	//this makes sure the app knows how large the window is
@@ -813,7 +863,9 @@ void StelMainView::init()
 	actionMgr->addAction("actionReload_Shaders", N_("Miscellaneous"), N_("Reload shaders (for development)"), this, "reloadShaders()", "Ctrl+R, P");
 	actionMgr->addAction("actionSet_Full_Screen_Global", N_("Display Options"), N_("Full-screen mode"), this, "fullScreen", "F11");
 	
+	StelStartupTrace::Scope shadersStep("startup", "StelPainter::initGLShaders");
 	StelPainter::initGLShaders();
+	shadersStep.end();
 
 	guiItem = new StelGuiItem(rootItem);
 	scene()->addItem(rootItem);
@@ -873,10 +925,14 @@ void StelMainView::init()
 
 	// XXX: This should be done in StelApp::init(), unfortunately for the moment we need to init the gui before the
 	// plugins, because the gui creates the QActions needed by some plugins.
+	StelStartupTrace::Scope pluginsStep("startup", "StelApp::initPlugIns");
 	stelApp->initPlugIns();
+	pluginsStep.end();
 
 	// The script manager can only be fully initialized after the plugins have loaded.
+	StelStartupTrace::Scope scriptStep("startup", "StelApp::initScriptMgr");
 	stelApp->initScriptMgr();
+	scriptStep.end();
 
 	// Set the global stylesheet, this is only useful for the tooltips.
 	StelGui* gui = dynamic_cast<StelGui*>(stelApp->getGui());
@@ -897,6 +953,7 @@ void StelMainView::init()
 		StelApp::getInstance().dumpModuleActionPriorities(StelModule::ActionHandleKeys);
 	}
 #endif
+	emit initialized();
 }
 
 void StelMainView::updateNightModeProperty(bool b)
@@ -1317,6 +1374,15 @@ void StelMainView::drawEnded()
 {
 	updateQueued = false;
 
+	if (framePacer->isPacing() && needsMaxFPS())
+	{
+		// The next frame is started by frameSwapped(), or two periods later if this frame is not swapped
+		fpsTimer->stop();
+		pacingTimer->start(qRound(2*framePacer->getRefreshPeriod()));
+		return;
+	}
+	pacingTimer->stop();
+
 	int requiredFpsInterval = needsMaxFPS()?1000/maxfps:1000/minfps;
 
 	if(fpsTimer->interval() != requiredFpsInterval)
@@ -1342,6 +1408,24 @@ void StelMainView::hideCursor()
 	QGuiApplication::setOverrideCursor(Qt::BlankCursor);
 }
 
+void StelMainView::frameSwapped()
+{
+	const QWindow* window = windowHandle();
+	if (window && window->screen())
+		framePacer->setRefreshRate(window->screen()->refreshRate());
+	framePacer->frameSwapped();
+	if (pacingTimer->isActive())
+		pacingTimer->start(framePacer->getNextFrameDelay());
+	if (frameSequenceActive)
+		captureSequenceFrame();
+	if (!viewportWindows.isEmpty())
+	{
+		for (auto* window : viewportWindows)
+			window->draw(glContext());
+		glWidget->makeCurrent();
+	}
+}
+
 void StelMainView::fpsTimerUpdate()
 {
 	if(!updateQueued)
@@ -1366,6 +1450,7 @@ void StelMainView::contextDestroyed()
 void StelMainView::thereWasAnEvent()
 {
 	lastEventTimeSec = StelApp::getTotalRunTime();
+	framePacer->markInput();
 }
 
 bool StelMainView::needsMaxFPS() const
@@ -1376,8 +1461,9 @@ bool StelMainView::needsMaxFPS() const
 	// The current policy is that after an event, the FPS is maximum for 2.5 seconds
 	// after that, it switches back to the default minfps value to save power.
 	// The fps is also kept to max if the timerate is higher than normal speed.
+	// Frame sequences are saved as fast as possible as well.
 	const float timeRate = stelApp->getCore()->getTimeRate();
-	return (now - lastEventTimeSec < 2.5) || fabs(timeRate) > StelCore::JD_SECOND;
+	return (now - lastEventTimeSec < 2.5) || fabs(timeRate) > StelCore::JD_SECOND || frameSequenceActive;
 }
 
 void StelMainView::moveEvent(QMoveEvent * event)
@@ -1404,6 +1490,12 @@ void StelMainView::deinitGL()
 	StelOpenGL::clearGLErrors();
 #endif
 
+	// Save the pending screenshots, which needs the job manager of StelApp
+	stopFrameSequence();
+	delete screenshotWriter;
+	screenshotWriter = Q_NULLPTR;
+	qDeleteAll(viewportWindows);
+	viewportWindows.clear();
 	stelApp->deinit();
 	delete gui;
 	gui = Q_NULLPTR;
@@ -1420,8 +1512,63 @@ void StelMainView::saveScreenShot(const QString& filePrefix, const QString& save
 void StelMainView::doScreenshot(void)
 {
 	QFileInfo shotDir;
+	if (StelFileMgr::getScreenshotDir().isEmpty())
+	{
+		qWarning() << "Oops, the directory for screenshots is not set! Let's try create and set it...";
+		// Create a directory for screenshots if main/screenshot_dir option is unset and user do screenshot at the moment!
+		QString screenshotDirSuffix = "/Stellarium";
+		QString screenshotDir;
+		if (!QStandardPaths::standardLocations(QStandardPaths::PicturesLocation).isEmpty())
+			screenshotDir = QStandardPaths::standardLocations(QStandardPaths::PicturesLocation)[0].append(screenshotDirSuffix);
+		else
+			screenshotDir = StelFileMgr::getUserDir().append(screenshotDirSuffix);
+
+		try
+		{
+			StelFileMgr::setScreenshotDir(screenshotDir);
+			StelApp::getInstance().getSettings()->setValue("main/screenshot_dir", screenshotDir);
+		}
+		catch (std::runtime_error &e)
+		{
+			qDebug("Error: cannot create screenshot directory: %s", e.what());
+		}
+	}
+
+	if (screenShotDir == "")
+		shotDir = QFileInfo(StelFileMgr::getScreenshotDir());
+	else
+		shotDir = QFileInfo(screenShotDir);
+
+	if (!shotDir.isDir())
+	{
+		qWarning() << "ERROR requested screenshot directory is not a directory: " << QDir::toNativeSeparators(shotDir.filePath());
+		return;
+	}
+	else if (!shotDir.isWritable())
+	{
+		qWarning() << "ERROR requested screenshot directory is not writable: " << QDir::toNativeSeparators(shotDir.filePath());
+		return;
+	}
+
+	QFileInfo shotPath;
+	if (flagOverwriteScreenshots)
+	{
+		shotPath = QFileInfo(shotDir.filePath() + "/" + screenShotPrefix + ".png");
+	}
+	else
+	{
+		for (int j=0; j<100000; ++j)
+		{
+			shotPath = QFileInfo(shotDir.filePath() + "/" + screenShotPrefix + QString("%1").arg(j, 3, 10, QLatin1Char('0')) + ".png");
+			// The previous screenshots may still be written in the background
+			if (!shotPath.exists() && !screenshotWriter->isWriting(shotPath.filePath()))
+				break;
+		}
+	}
+	qDebug() << "INFO Saving screenshot in file: " << QDir::toNativeSeparators(shotPath.filePath());
+
 #ifdef USE_OLD_QGLWIDGET
-	QImage im = glWidget->grabFrameBuffer();
+	screenshotWriter->saveImage(glWidget->grabFrameBuffer(), shotPath.filePath(), flagInvertScreenShotColors);
 #else
 	// Make a screenshot which may be larger than the current window. This is harder than you would think:
 	// fbObj the framebuffer governs size of the target image, that's the easy part, but it also has its limits.
@@ -1434,52 +1581,65 @@ void StelMainView::doScreenshot(void)
 	int imgHeight=stelScene->height();
 	if (flagUseCustomScreenshotSize)
 	{
-		// Borrowed from Scenery3d renderer: determine maximum framebuffer size as minimum of texture, viewport and renderbuffer size
-		QOpenGLContext *context = QOpenGLContext::currentContext();
-		if (context)
-		{
-			context->functions()->initializeOpenGLFunctions();
-			//qDebug() << "initializeOpenGLFunctions()...";
-			// TODO: Investigate this further when GL memory issues should appear.
-			// Make sure we have enough free GPU memory!
+		// TODO: Investigate this further when GL memory issues should appear.
+		// Make sure we have enough free GPU memory!
 #ifndef NDEBUG
 #ifdef GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX
-			GLint freeGLmemory;
-			context->functions()->glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &freeGLmemory);
-			qCDebug(mainview)<<"Free GPU memory:" << freeGLmemory << "kB -- we ask for " << customScreenshotWidth*customScreenshotHeight*8 / 1024 <<"kB";
+		GLint freeGLmemory;
+		QOpenGLContext::currentContext()->functions()->glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &freeGLmemory);
+		qCDebug(mainview)<<"Free GPU memory:" << freeGLmemory << "kB -- we ask for " << customScreenshotWidth*customScreenshotHeight*8 / 1024 <<"kB";
 #endif
 #ifdef GL_RENDERBUFFER_FREE_MEMORY_ATI
-			GLint freeGLmemoryAMD[4];
-			context->functions()->glGetIntegerv(GL_RENDERBUFFER_FREE_MEMORY_ATI, freeGLmemoryAMD);
-			qCDebug(mainview)<<"Free GPU memory (AMD version):" << (uint)freeGLmemoryAMD[1]/1024 << "+" << (uint)freeGLmemoryAMD[3]/1024 << " of " << (uint)freeGLmemoryAMD[0]/1024 << "+" << (uint)freeGLmemoryAMD[2]/1024 << "kB -- we ask for " << customScreenshotWidth*customScreenshotHeight*8 / 1024 <<"kB";
+		GLint freeGLmemoryAMD[4];
+		QOpenGLContext::currentContext()->functions()->glGetIntegerv(GL_RENDERBUFFER_FREE_MEMORY_ATI, freeGLmemoryAMD);
+		qCDebug(mainview)<<"Free GPU memory (AMD version):" << (uint)freeGLmemoryAMD[1]/1024 << "+" << (uint)freeGLmemoryAMD[3]/1024 << " of " << (uint)freeGLmemoryAMD[0]/1024 << "+" << (uint)freeGLmemoryAMD[2]/1024 << "kB -- we ask for " << customScreenshotWidth*customScreenshotHeight*8 / 1024 <<"kB";
 #endif
 #endif
-			GLint texSize,viewportSize[2],rbSize;
-			context->functions()->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &texSize);
-			context->functions()->glGetIntegerv(GL_MAX_VIEWPORT_DIMS, viewportSize);
-			context->functions()->glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &rbSize);
-			qCDebug(mainview)<<"Maximum texture size:"<<texSize;
-			qCDebug(mainview)<<"Maximum viewport dims:"<<viewportSize[0]<<viewportSize[1];
-			qCDebug(mainview)<<"Maximum renderbuffer size:"<<rbSize;
-			int maximumFramebufferSize = qMin(texSize,qMin(rbSize,qMin(viewportSize[0],viewportSize[1])));
-			qCDebug(mainview)<<"Maximum framebuffer size:"<<maximumFramebufferSize;
-
-			imgWidth =qMin(maximumFramebufferSize, customScreenshotWidth);
-			imgHeight=qMin(maximumFramebufferSize, customScreenshotHeight);
-		}
-		else
-		{
-			qCWarning(mainview) << "No GL context for screenshot! Aborting.";
-			return;
-		}
+		const int maximumFramebufferSize = getMaximumFramebufferSize();
+		imgWidth =qMin(maximumFramebufferSize, customScreenshotWidth);
+		imgHeight=qMin(maximumFramebufferSize, customScreenshotHeight);
 	}
-	// The texture format depends on used GL version. RGB is fine on OpenGL. on GLES, we must use RGBA and circumvent problems with a few more steps.
+
+	QOpenGLFramebufferObject* fbObj = createOffscreenFramebuffer(imgWidth * pixelRatio, imgHeight * pixelRatio);
+	renderOffscreen(fbObj, imgWidth, imgHeight, pixelRatio);
+	// The pixels are read asynchronously, the framebuffer can be deleted right away
+	fbObj->bind();
+	screenshotWriter->readToFile(fbObj->width(), fbObj->height(), shotPath.filePath(), flagInvertScreenShotColors);
+	fbObj->release();
+	delete fbObj;
+#endif
+}
+
+#ifndef USE_OLD_QGLWIDGET
+int StelMainView::getMaximumFramebufferSize() const
+{
+	// Borrowed from Scenery3d renderer: determine maximum framebuffer size as minimum of texture, viewport and renderbuffer size
+	QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+	GLint texSize,viewportSize[2],rbSize;
+	gl->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &texSize);
+	gl->glGetIntegerv(GL_MAX_VIEWPORT_DIMS, viewportSize);
+	gl->glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &rbSize);
+	qCDebug(mainview)<<"Maximum texture size:"<<texSize;
+	qCDebug(mainview)<<"Maximum viewport dims:"<<viewportSize[0]<<viewportSize[1];
+	qCDebug(mainview)<<"Maximum renderbuffer size:"<<rbSize;
+	int maximumFramebufferSize = qMin(texSize,qMin(rbSize,qMin(viewportSize[0],viewportSize[1])));
+	qCDebug(mainview)<<"Maximum framebuffer size:"<<maximumFramebufferSize;
+	return maximumFramebufferSize;
+}
+
+QOpenGLFramebufferObject* StelMainView::createOffscreenFramebuffer(int width, int height) const
+{
+	// The texture format depends on used GL version. RGB is fine on OpenGL. on GLES, we must use RGBA, whose alpha is ignored by StelScreenshotWriter.
 	bool isGLES=(QOpenGLContext::currentContext()->format().renderableType() == QSurfaceFormat::OpenGLES);
 
 	QOpenGLFramebufferObjectFormat fbFormat;
 	fbFormat.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
 	fbFormat.setInternalTextureFormat(isGLES ? GL_RGBA : GL_RGB); // try to avoid transparent background!
-	QOpenGLFramebufferObject * fbObj = new QOpenGLFramebufferObject(imgWidth * pixelRatio, imgHeight * pixelRatio, fbFormat);
+	return new QOpenGLFramebufferObject(width, height, fbFormat);
+}
+
+void StelMainView::renderOffscreen(QOpenGLFramebufferObject* fbObj, int imgWidth, int imgHeight, float pixelRatio)
+{
 	fbObj->bind();
 	// Now the painter has to be convinced to paint to the potentially larger image frame.
 	QOpenGLPaintDevice fbObjPaintDev(imgWidth, imgHeight);
@@ -1512,21 +1672,8 @@ void StelMainView::doScreenshot(void)
 
 	stelScene->render(&painter, QRectF(), QRectF(0,0,imgWidth,imgHeight) , Qt::KeepAspectRatio);
 	painter.end();
-
-	QImage im;
-	if (isGLES)
-	{
-		// We have RGBA texture with possibly empty spots when atmosphere was off.
-		// See toImage() help entry why to create wrapper here.
-		QImage fboImage(fbObj->toImage());
-		//qDebug() << "FBOimage format:" << fboImage.format(); // returns Format_RGBA8888_Premultiplied
-		QImage im2(fboImage.constBits(), fboImage.width(), fboImage.height(), QImage::Format_RGBX8888);
-		im=im2.copy();
-	}
-	else
-		im=fbObj->toImage();
 	fbObj->release();
-	delete fbObj;
+
 	// reset viewport and GUI
 	StelApp::getInstance().getCore()->setCurrentStelProjectorParams(pParams);
 	customScreenshotMagnification=1.0f;
@@ -1534,67 +1681,115 @@ void StelMainView::doScreenshot(void)
 	rootItem->setSize(QSize(pParams.viewportXywh[2], pParams.viewportXywh[3]));
 	dynamic_cast<StelGui*>(gui)->getSkyGui()->setGeometry(0, 0, pParams.viewportXywh[2], pParams.viewportXywh[3]);
 	dynamic_cast<StelGui*>(gui)->forceRefreshGui();
+}
 #endif
 
-	if (flagInvertScreenShotColors)
-		im.invertPixels();
-
-	if (StelFileMgr::getScreenshotDir().isEmpty())
+void StelMainView::startFrameSequence(const QString& saveDir, const QString& filePrefix, int width, int height, double fps)
+{
+	QString dir = saveDir.isEmpty() ? StelFileMgr::getScreenshotDir() : saveDir;
+	const QFileInfo dirInfo(dir);
+	if (!dirInfo.isDir() || !dirInfo.isWritable())
 	{
-		qWarning() << "Oops, the directory for screenshots is not set! Let's try create and set it...";
-		// Create a directory for screenshots if main/screenshot_dir option is unset and user do screenshot at the moment!
-		QString screenshotDirSuffix = "/Stellarium";
-		QString screenshotDir;
-		if (!QStandardPaths::standardLocations(QStandardPaths::PicturesLocation).isEmpty())
-			screenshotDir = QStandardPaths::standardLocations(QStandardPaths::PicturesLocation)[0].append(screenshotDirSuffix);
-		else
-			screenshotDir = StelFileMgr::getUserDir().append(screenshotDirSuffix);
-
-		try
-		{
-			StelFileMgr::setScreenshotDir(screenshotDir);
-			StelApp::getInstance().getSettings()->setValue("main/screenshot_dir", screenshotDir);
-		}
-		catch (std::runtime_error &e)
-		{
-			qDebug("Error: cannot create screenshot directory: %s", e.what());
-		}
+		qWarning() << "ERROR the directory of the frame sequence is not a writable directory: " << QDir::toNativeSeparators(dir);
+		return;
 	}
+	if (!beginFrameSequence(width, height, fps))
+		return;
+	frameSequencePipe = false;
+	frameSequencePath = dirInfo.filePath() + "/" + filePrefix;
+	qDebug() << "INFO Saving the frames in: " << QDir::toNativeSeparators(frameSequencePath) + "000000.png";
+}
 
-	if (screenShotDir == "")
-		shotDir = QFileInfo(StelFileMgr::getScreenshotDir());
-	else
-		shotDir = QFileInfo(screenShotDir);
-
-	if (!shotDir.isDir())
-	{
-		qWarning() << "ERROR requested screenshot directory is not a directory: " << QDir::toNativeSeparators(shotDir.filePath());
+void StelMainView::startFrameSequencePipe(const QString& command, int width, int height, double fps)
+{
+	if (!beginFrameSequence(width, height, fps))
 		return;
-	}
-	else if (!shotDir.isWritable())
+	QString cmd = command;
+	cmd.replace("{width}", QString::number(frameSequenceWidth));
+	cmd.replace("{height}", QString::number(frameSequenceHeight));
+	cmd.replace("{fps}", QString::number(fps > 0. ? fps : 30.));
+	glWidget->makeCurrent();
+	if (!screenshotWriter->startPipe(cmd, frameSequenceWidth, frameSequenceHeight))
 	{
-		qWarning() << "ERROR requested screenshot directory is not writable: " << QDir::toNativeSeparators(shotDir.filePath());
+		stopFrameSequence();
 		return;
 	}
+	frameSequencePipe = true;
+}
 
-	QFileInfo shotPath;
-	if (flagOverwriteScreenshots)
+bool StelMainView::beginFrameSequence(int width, int height, double fps)
+{
+#ifdef USE_OLD_QGLWIDGET
+	Q_UNUSED(width);
+	Q_UNUSED(height);
+	Q_UNUSED(fps);
+	qWarning() << "ERROR frame sequences are not available with QGLWidget";
+	return false;
+#else
+	stopFrameSequence();
+	glWidget->makeCurrent();
+	const float pixelRatio = QOpenGLContext::currentContext()->screen()->devicePixelRatio();
+	const int maximumFramebufferSize = getMaximumFramebufferSize();
+	frameSequenceWidth = qMin(maximumFramebufferSize, width > 0 ? width : qRound(glWidget->width() * pixelRatio));
+	frameSequenceHeight = qMin(maximumFramebufferSize, height > 0 ? height : qRound(glWidget->height() * pixelRatio));
+	frameSequenceIndex = 0;
+	frameSequenceActive = true;
+	if (fps > 0.)
+		stelApp->setDeltaTimeOverride(1. / fps);
+	thereWasAnEvent();
+	return true;
+#endif
+}
+
+void StelMainView::stopFrameSequence()
+{
+	if (!frameSequenceActive)
+		return;
+	frameSequenceActive = false;
+	stelApp->setDeltaTimeOverride(-1.);
+	glWidget->makeCurrent();
+	if (frameSequencePipe)
+		screenshotWriter->stopPipe();
+	screenshotWriter->flush();
+#ifndef USE_OLD_QGLWIDGET
+	delete frameSequenceFbo;
+	frameSequenceFbo = Q_NULLPTR;
+#endif
+	qDebug() << "INFO Saved" << frameSequenceIndex << "frames";
+}
+
+void StelMainView::captureSequenceFrame()
+{
+#ifndef USE_OLD_QGLWIDGET
+	glWidget->makeCurrent();
+	const float pixelRatio = QOpenGLContext::currentContext()->screen()->devicePixelRatio();
+	const int width = frameSequenceWidth;
+	const int height = frameSequenceHeight;
+	if (width == qRound(glWidget->width() * pixelRatio) && height == qRound(glWidget->height() * pixelRatio))
 	{
-		shotPath = QFileInfo(shotDir.filePath() + "/" + screenShotPrefix + ".png");
+		// The framebuffer of the widget still has the frame which was just swapped
+		QOpenGLContext::currentContext()->functions()->glBindFramebuffer(GL_FRAMEBUFFER, glWidget->defaultFramebufferObject());
 	}
 	else
 	{
-		for (int j=0; j<100000; ++j)
+		// Draw the frame again at the size of the sequence, without advancing the simulation
+		if (!frameSequenceFbo || frameSequenceFbo->size() != QSize(width, height))
 		{
-			shotPath = QFileInfo(shotDir.filePath() + "/" + screenShotPrefix + QString("%1").arg(j, 3, 10, QLatin1Char('0')) + ".png");
-			if (!shotPath.exists())
-				break;
+			delete frameSequenceFbo;
+			frameSequenceFbo = createOffscreenFramebuffer(width, height);
 		}
+		rootItem->setRedrawOnly(true);
+		renderOffscreen(frameSequenceFbo, width, height, 1.f);
+		rootItem->setRedrawOnly(false);
+		frameSequenceFbo->bind();
 	}
-	qDebug() << "INFO Saving screenshot in file: " << QDir::toNativeSeparators(shotPath.filePath());
-	if (!im.save(shotPath.filePath())) {
-		qWarning() << "WARNING failed to write screenshot to: " << QDir::toNativeSeparators(shotPath.filePath());
-	}
+	if (frameSequencePipe)
+		screenshotWriter->readToPipe(width, height, flagInvertScreenShotColors);
+	else
+		screenshotWriter->readToFile(width, height, frameSequencePath + QString("%1.png").arg(frameSequenceIndex, 6, 10, QLatin1Char('0')), flagInvertScreenShotColors);
+	QOpenGLContext::currentContext()->functions()->glBindFramebuffer(GL_FRAMEBUFFER, glWidget->defaultFramebufferObject());
+	++frameSequenceIndex;
+#endif
 }
 
 QPoint StelMainView::getMousePos() const
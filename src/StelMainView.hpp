@@ -32,6 +32,10 @@
 
 class StelGLWidget;
 class StelGraphicsScene;
+class StelFramePacer;
+class StelScreenshotWriter;
+class StelViewportWindow;
+class QOpenGLFramebufferObject;
 class QMoveEvent;
 class QResizeEvent;
 class StelGuiBase;
@@ -106,6 +110,12 @@ public:
 
 	//! Returns the information about the GL context, this does not require the context to be active.
 	GLInfo getGLInformation() const { return glInfo; }
+
+	//! Get whether a frame sequence is being saved, see startFrameSequence()
+	bool isFrameSequenceActive() const { return frameSequenceActive; }
+
+	//! Get the measures of the frame pacing and the adaptive scheduler of the frames.
+	StelFramePacer* getFramePacer() const { return framePacer; }
 public slots:
 
 	//! Set whether fullscreen is activated or not
@@ -125,6 +135,22 @@ public slots:
 	//! @arg overwrite if true, @arg filePrefix is used as filename, and existing file will be overwritten.
 	void saveScreenShot(const QString& filePrefix="stellarium-", const QString& saveDir="", const bool overwrite=false);
 
+	//! Save each drawn frame from now on in a numbered image file, e.g. for a video assembled later.
+	//! The frames are read and encoded in the background by StelScreenshotWriter, and have the GUI like screenshots.
+	//! @arg saveDir the directory of the files. If saveDir is "" then StelFileMgr::getScreenshotDir() will be used
+	//! @arg filePrefix the files are named filePrefix000000.png, filePrefix000001.png etc. Existing files are overwritten.
+	//! @arg width, height the size of the frames in pixels, by default the size of the window.
+	//! Other sizes are drawn again in an offscreen framebuffer, which may be larger than the window.
+	//! @arg fps if positive, the simulation advances by 1/fps seconds per frame, whatever the time it takes to draw and save them.
+	void startFrameSequence(const QString& saveDir="", const QString& filePrefix="frame-", int width=0, int height=0, double fps=0.);
+	//! Send each drawn frame from now on to the standard input of an external encoder, as raw RGB frames with 8 bits per
+	//! channel, e.g. "ffmpeg -f rawvideo -pix_fmt rgb24 -s {width}x{height} -r {fps} -i - stellarium.mp4".
+	//! @arg command the encoder, in which {width}, {height} and {fps} are replaced by the values of the frames (fps 30 if not positive)
+	//! @arg width, height, fps as for startFrameSequence()
+	void startFrameSequencePipe(const QString& command, int width=0, int height=0, double fps=30.);
+	//! Stop the frame sequence, and wait until its frames are written.
+	void stopFrameSequence();
+
 	//! Get whether colors are inverted when saving screenshot
 	bool getFlagInvertScreenShotColors() const {return flagInvertScreenShotColors;}
 	//! Set whether colors should be inverted when saving screenshot
@@ -207,6 +233,8 @@ signals:
 	//!
 	//! @remark FS: is threaded access here even a possibility anymore, or a remnant of older code?
 	void screenshotRequested(void);
+	//! Emitted at the end of init(), once StelApp, the GUI and the plugins are initialized.
+	void initialized();
 	void fullScreenChanged(bool b);
 	//! Emitted when the "Reload shaders" action is perfomed
 	//! Interested objects should subscribe to this signal and reload their shaders
@@ -228,6 +256,9 @@ private slots:
 	// Do the actual screenshot generation in the main thread with this method.
 	void doScreenshot(void);
 	void fpsTimerUpdate();
+	//! Report the swap to the frame pacer, and schedule the next frame when it paces them.
+	//! Then save the frame of the frame sequence, and draw the additional viewports.
+	void frameSwapped();
 	void hideCursor();
 
 #ifdef OPENGL_DEBUG_LOGGING
@@ -250,6 +281,19 @@ private:
 	//! Startup diagnostics, providing test for various circumstances of bad OS/OpenGL driver combinations
 	//! to provide feedback to the user about bad OpenGL drivers.
 	void processOpenGLdiagnosticsAndWarnings(QSettings *conf, QOpenGLContext* context) const;
+#ifndef USE_OLD_QGLWIDGET
+	//! Get the largest side of a framebuffer, the GL context must be current.
+	int getMaximumFramebufferSize() const;
+	//! Create a framebuffer for the screenshots, the GL context must be current.
+	QOpenGLFramebufferObject* createOffscreenFramebuffer(int width, int height) const;
+	//! Draw the scene and the GUI in fbObj for a screenshot, for an image of imgWidth x imgHeight device independent pixels.
+	void renderOffscreen(QOpenGLFramebufferObject* fbObj, int imgWidth, int imgHeight, float pixelRatio);
+#endif
+	//! Stop the current frame sequence and set the size and time step of a new one.
+	//! @return false if frame sequences are not available
+	bool beginFrameSequence(int width, int height, double fps);
+	//! Read the frame which was just swapped for the frame sequence.
+	void captureSequenceFrame();
 
 	//! The StelMainView singleton
 	static StelMainView* singleton;
@@ -282,6 +326,19 @@ private:
 #endif
 	QString screenShotPrefix;
 	QString screenShotDir;
+	//! Reads and saves the screenshots and the frame sequences in the background
+	StelScreenshotWriter* screenshotWriter;
+
+	bool frameSequenceActive;
+	bool frameSequencePipe;	//! if true, the frames are sent to the encoder of screenshotWriter, else saved as images
+	QString frameSequencePath;	//! directory and prefix of the files
+	int frameSequenceWidth;	//! in pixels
+	int frameSequenceHeight;
+	int frameSequenceIndex;
+#ifndef USE_OLD_QGLWIDGET
+	//! For the frames whose size differs from the window
+	QOpenGLFramebufferObject* frameSequenceFbo;
+#endif
 
 	bool flagCursorTimeout;
 	//! Timer that triggers with the cursor timeout.
@@ -294,6 +351,11 @@ private:
 	//! The maximum desired frame rate in frame per second.
 	float maxfps;
 	QTimer* fpsTimer;
+	StelFramePacer* framePacer;
+	//! Starts the frames while framePacer paces them, instead of fpsTimer
+	QTimer* pacingTimer;
+	//! The additional viewports of the configuration file, drawn after the main view
+	QList<StelViewportWindow*> viewportWindows;
 
 #ifdef OPENGL_DEBUG_LOGGING
 	QOpenGLDebugLogger* glLogger;
@@ -0,0 +1,329 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelSessionRecorder.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelFrameProfiler.hpp"
+#include "StelLocation.hpp"
+#include "StelMainView.hpp"
+#include "StelMovementMgr.hpp"
+#include "StelObjectMgr.hpp"
+#include "StelPropertyMgr.hpp"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QSettings>
+
+namespace
+{
+	//! "STLS"
+	const quint32 MAGIC = 0x53544c53;
+	const quint32 VERSION = 1;
+}
+
+StelSessionRecorder::StelSessionRecorder(Mode mode, const QString& fileName, const QString& outputFile)
+	: mode(mode)
+	, fileName(fileName)
+	, outputFile(outputFile)
+	, file(fileName)
+	, pendingFlags(0)
+	, frameIndex(0)
+	, ok(true)
+{
+	setObjectName("StelSessionRecorder");
+}
+
+StelSessionRecorder::~StelSessionRecorder()
+{
+	if (mode==Record && file.isOpen())
+	{
+		file.close();
+		if (stream.status()!=QDataStream::Ok || file.error()!=QFileDevice::NoError)
+			qWarning() << "ERROR: the session log" << QDir::toNativeSeparators(fileName) << "can't be written";
+		else
+			qDebug() << "Session: recorded" << frameIndex << "frames to" << QDir::toNativeSeparators(fileName);
+	}
+}
+
+bool StelSessionRecorder::readHeader(QDataStream& in, int* width, int* height)
+{
+	quint32 magic, version;
+	qint32 w, h;
+	in >> magic >> version >> w >> h;
+	if (in.status()!=QDataStream::Ok || magic!=MAGIC || version!=VERSION)
+		return false;
+	*width = w;
+	*height = h;
+	return true;
+}
+
+bool StelSessionRecorder::configureReplay(const QString& fileName, QSettings* conf)
+{
+	QFile logFile(fileName);
+	int width, height;
+	if (!logFile.open(QIODevice::ReadOnly))
+	{
+		qWarning() << "ERROR: session log" << QDir::toNativeSeparators(fileName) << "can't be read";
+		return false;
+	}
+	QDataStream in(&logFile);
+	in.setVersion(QDataStream::Qt_5_4);
+	if (!readHeader(in, &width, &height))
+	{
+		qWarning() << "ERROR:" << QDir::toNativeSeparators(fileName) << "is not a session log of this version";
+		return false;
+	}
+
+	conf->setValue("video/fullscreen", false);
+	conf->setValue("video/screen_w", width);
+	conf->setValue("video/screen_h", height);
+	conf->setValue("video/screen_x", 0);
+	conf->setValue("video/screen_y", 0);
+	conf->setValue("video/vsync", false);
+	conf->setValue("video/minimum_fps", 10000);
+	conf->setValue("video/maximum_fps", 10000);
+	// Both would change the frames with the speed of the machine
+	conf->setValue("video/flag_quality_governor", false);
+	conf->setValue("video/flag_pipelined_update", false);
+	return true;
+}
+
+void StelSessionRecorder::writeFrame(QDataStream& out, const Frame& frame)
+{
+	out << frame.flags << frame.deltaTime << frame.JD << frame.timeRate
+	    << frame.viewDirection[0] << frame.viewDirection[1] << frame.viewDirection[2] << frame.fov;
+	if (frame.flags & HasLocation)
+		out << frame.location;
+	if (frame.flags & HasProperties)
+		out << frame.properties;
+	if (frame.flags & HasSelection)
+		out << frame.selection;
+}
+
+void StelSessionRecorder::readFrame(QDataStream& in, Frame& frame)
+{
+	in >> frame.flags >> frame.deltaTime >> frame.JD >> frame.timeRate
+	   >> frame.viewDirection[0] >> frame.viewDirection[1] >> frame.viewDirection[2] >> frame.fov;
+	if (frame.flags & HasLocation)
+		in >> frame.location;
+	if (frame.flags & HasProperties)
+		in >> frame.properties;
+	if (frame.flags & HasSelection)
+		in >> frame.selection;
+}
+
+void StelSessionRecorder::init()
+{
+	StelApp& app = StelApp::getInstance();
+	if (mode==Record)
+	{
+		if (!file.open(QIODevice::WriteOnly))
+		{
+			qWarning() << "ERROR: session log" << QDir::toNativeSeparators(fileName) << "can't be written";
+			return;
+		}
+		stream.setDevice(&file);
+		stream.setVersion(QDataStream::Qt_5_4);
+		const QSize size = StelMainView::getInstance().size();
+		stream << MAGIC << VERSION << static_cast<qint32>(size.width()) << static_cast<qint32>(size.height());
+
+		// The first frame has the complete state
+		StelPropertyMgr* propMgr = app.getStelPropertyManager();
+		for (const auto* prop : propMgr->getAllProperties())
+		{
+			if (prop->isSynchronizable())
+				pendingProperties.insert(prop->getId(), prop->getValue());
+		}
+		pendingFlags = HasLocation | HasProperties | HasSelection;
+		connect(propMgr, &StelPropertyMgr::stelPropertyChanged, this, &StelSessionRecorder::onPropertyChanged);
+		connect(&app.getStelObjectMgr(), &StelObjectMgr::selectedObjectChanged, this, &StelSessionRecorder::onSelectionChanged);
+		connect(app.getCore(), &StelCore::targetLocationChanged, this, &StelSessionRecorder::onLocationChanged);
+		qDebug() << "Session: recording to" << QDir::toNativeSeparators(fileName);
+		return;
+	}
+
+	int width, height;
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		qWarning() << "ERROR: session log" << QDir::toNativeSeparators(fileName) << "can't be read";
+		ok = false;
+		finishReplay();
+		return;
+	}
+	stream.setDevice(&file);
+	stream.setVersion(QDataStream::Qt_5_4);
+	if (!readHeader(stream, &width, &height))
+	{
+		qWarning() << "ERROR:" << QDir::toNativeSeparators(fileName) << "is not a session log of this version";
+		ok = false;
+		finishReplay();
+		return;
+	}
+	while (!stream.atEnd())
+	{
+		Frame frame;
+		readFrame(stream, frame);
+		if (stream.status()!=QDataStream::Ok)
+		{
+			// A session which was not closed properly ends with a partial frame
+			qWarning() << "Session: the log is truncated after" << frames.size() << "frames";
+			break;
+		}
+		frames.append(frame);
+	}
+	file.close();
+	if (frames.isEmpty())
+	{
+		qWarning() << "ERROR: session log" << QDir::toNativeSeparators(fileName) << "has no frame";
+		ok = false;
+		finishReplay();
+		return;
+	}
+
+	StelFrameProfiler* profiler = app.getFrameProfiler();
+	profiler->setOverlayVisible(false);
+	profiler->setEnabled(true);
+	app.setDeltaTimeOverride(frames.first().deltaTime);
+	qDebug() << "Session: replaying" << frames.size() << "frames from" << QDir::toNativeSeparators(fileName);
+}
+
+double StelSessionRecorder::getCallOrder(StelModuleActionName actionName) const
+{
+	if (actionName==StelModule::ActionUpdate)
+		return mode==Record ? 100000. : -1000.;
+	return 0.;
+}
+
+void StelSessionRecorder::update(double deltaTime)
+{
+	if (mode==Record)
+	{
+		if (file.isOpen())
+			recordFrame(deltaTime);
+		return;
+	}
+	if (frameIndex>=frames.size())
+		return;
+	replayFrame(frames.at(frameIndex));
+	++frameIndex;
+	if (frameIndex<frames.size())
+		StelApp::getInstance().setDeltaTimeOverride(frames.at(frameIndex).deltaTime);
+	else
+		finishReplay();
+}
+
+void StelSessionRecorder::onPropertyChanged(StelProperty* prop, const QVariant& value)
+{
+	if (!prop->isSynchronizable())
+		return;
+	pendingProperties.insert(prop->getId(), value);
+	pendingFlags |= HasProperties;
+}
+
+void StelSessionRecorder::onSelectionChanged()
+{
+	pendingFlags |= HasSelection;
+}
+
+void StelSessionRecorder::onLocationChanged()
+{
+	pendingFlags |= HasLocation;
+}
+
+void StelSessionRecorder::recordFrame(double deltaTime)
+{
+	StelApp& app = StelApp::getInstance();
+	StelCore* core = app.getCore();
+	const StelMovementMgr* mvmgr = core->getMovementMgr();
+
+	Frame frame;
+	frame.flags = pendingFlags;
+	frame.deltaTime = deltaTime;
+	frame.JD = core->getJD();
+	frame.timeRate = core->getTimeRate();
+	frame.viewDirection = mvmgr->getViewDirectionJ2000();
+	frame.fov = mvmgr->getCurrentFov();
+	if (pendingFlags & HasLocation)
+		frame.location = core->getCurrentLocation().serializeToLine();
+	if (pendingFlags & HasProperties)
+		frame.properties = pendingProperties;
+	if (pendingFlags & HasSelection)
+	{
+		for (const auto& obj : app.getStelObjectMgr().getSelectedObject())
+			frame.selection.append(qMakePair(obj->getType(), obj->getID()));
+	}
+	writeFrame(stream, frame);
+	pendingFlags = 0;
+	pendingProperties.clear();
+	++frameIndex;
+}
+
+void StelSessionRecorder::replayFrame(const Frame& frame)
+{
+	StelApp& app = StelApp::getInstance();
+	StelCore* core = app.getCore();
+	if (frame.flags & HasLocation)
+		core->moveObserverTo(StelLocation::createFromLine(frame.location), 0., 0.);
+	if (frame.flags & HasProperties)
+	{
+		StelPropertyMgr* propMgr = app.getStelPropertyManager();
+		for (auto it = frame.properties.constBegin(); it != frame.properties.constEnd(); ++it)
+			propMgr->setStelPropertyValue(it.key(), it.value());
+	}
+	if (frame.flags & HasSelection)
+	{
+		StelObjectMgr& objMgr = app.getStelObjectMgr();
+		QList<StelObjectP> objects;
+		for (const auto& id : frame.selection)
+		{
+			StelObjectP obj = objMgr.searchByID(id.first, id.second);
+			if (obj)
+				objects.append(obj);
+		}
+		if (objects.isEmpty())
+			objMgr.unSelect();
+		else
+			objMgr.setSelectedObject(objects);
+	}
+
+	core->setTimeRate(frame.timeRate);
+	core->setJD(frame.JD);
+	StelMovementMgr* mvmgr = core->getMovementMgr();
+	mvmgr->setFlagTracking(false);
+	mvmgr->setViewDirectionJ2000(frame.viewDirection);
+	mvmgr->zoomTo(frame.fov, 0.f);
+}
+
+void StelSessionRecorder::finishReplay()
+{
+	StelApp& app = StelApp::getInstance();
+	app.setDeltaTimeOverride(-1.);
+	if (!frames.isEmpty())
+	{
+		StelFrameProfiler* profiler = app.getFrameProfiler();
+		if (!profiler->exportChromeTrace(outputFile))
+			ok = false;
+		profiler->setEnabled(false);
+		qDebug() << "Session: replayed" << frames.size() << "frames";
+	}
+	QCoreApplication::exit(ok ? 0 : 1);
+}
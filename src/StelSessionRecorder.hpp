@@ -0,0 +1,136 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef STELSESSIONRECORDER_HPP
+#define STELSESSIONRECORDER_HPP
+
+#include "StelModule.hpp"
+#include "VecMath.hpp"
+
+#include <QDataStream>
+#include <QFile>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVariantMap>
+#include <QVector>
+
+class QSettings;
+class StelProperty;
+
+//! @class StelSessionRecorder
+//! Records the inputs of each frame of a session in a compact binary log, for the --record-session option of the
+//! command line, and replays them for --replay-session, so that the frames of a show which stutters at some cue
+//! can be drawn again on another machine with StelFrameProfiler enabled.
+//! The inputs are recorded at the end of the updates of each frame, from the same sources as the RemoteSync plugin:
+//! - the duration of the frame, the simulation time (JD) and the time rate
+//! - the view direction (J2000) and the field of view
+//! - the location, when it changes
+//! - the changes of the synchronizable StelProperty values, see StelProperty::isSynchronizable()
+//! - the selected objects, when they change
+//! The first frame has the location, the values of all synchronizable properties and the selection.
+//! The replay draws one recorded frame per drawn frame in a window of the recorded size, as fast as possible and
+//! without vsync, with the recorded frame durations passed to the modules (see StelApp::setDeltaTimeOverride()).
+//! After the last frame, it writes the last 600 frames of StelFrameProfiler in a Chrome trace and quits.
+//! Inputs which are not recorded can still change the frames, e.g. HiPS tiles or satellite elements which are
+//! downloaded, or the actions of scripts which do not change properties.
+class StelSessionRecorder : public StelModule
+{
+	Q_OBJECT
+public:
+	enum Mode
+	{
+		Record,
+		Replay
+	};
+
+	//! @param fileName the session log
+	//! @param outputFile for Replay, the trace, by default frame_profile-<date>.json in the screenshot directory
+	StelSessionRecorder(Mode mode, const QString& fileName, const QString& outputFile=QString());
+	virtual ~StelSessionRecorder() Q_DECL_OVERRIDE;
+
+	//! Read the header of a session log, and set the configuration for its replay: window size, no full screen,
+	//! no limit of the frame rate, no vsync, no quality governor and no pipelined update.
+	//! This changes the configuration file, use a separate user directory for the replay.
+	//! @return false if the file is not a session log
+	static bool configureReplay(const QString& fileName, QSettings* conf);
+
+	virtual void init() Q_DECL_OVERRIDE;
+	virtual void update(double deltaTime) Q_DECL_OVERRIDE;
+	virtual double getCallOrder(StelModuleActionName actionName) const Q_DECL_OVERRIDE;
+	//! Only updated: the replayed inputs are set before the other modules update, the recorded ones after them.
+	virtual bool isActive(StelModuleActionName actionName) const Q_DECL_OVERRIDE {return actionName==ActionUpdate;}
+
+private slots:
+	void onPropertyChanged(StelProperty* prop, const QVariant& value);
+	void onSelectionChanged();
+	void onLocationChanged();
+
+private:
+	//! Flags of the optional parts of a frame
+	enum FrameFlags
+	{
+		HasLocation = 1,
+		HasProperties = 2,
+		HasSelection = 4
+	};
+
+	struct Frame
+	{
+		Frame() : flags(0), deltaTime(0.), JD(0.), timeRate(0.), fov(0.) {}
+		quint8 flags;
+		double deltaTime;	// [s]
+		double JD;
+		double timeRate;	// [days/s]
+		Vec3d viewDirection;	// J2000
+		double fov;		// [degrees]
+		QString location;	// see StelLocation::serializeToLine()
+		QVariantMap properties;
+		//! Type and ID of each selected object
+		QList<QPair<QString, QString> > selection;
+	};
+
+	//! Read the magic and version of a log, and the window size.
+	static bool readHeader(QDataStream& in, int* width, int* height);
+	static void writeFrame(QDataStream& out, const Frame& frame);
+	static void readFrame(QDataStream& in, Frame& frame);
+
+	void recordFrame(double deltaTime);
+	void replayFrame(const Frame& frame);
+	//! Write the trace of the replay and quit the application.
+	void finishReplay();
+
+	Mode mode;
+	QString fileName;
+	QString outputFile;
+	QFile file;
+	QDataStream stream;
+
+	//! Record: the inputs which changed since the last recorded frame
+	quint8 pendingFlags;
+	QVariantMap pendingProperties;
+
+	//! Replay: the frames of the log and the next one to draw
+	QVector<Frame> frames;
+	int frameIndex;
+	bool ok;
+};
+
+#endif // STELSESSIONRECORDER_HPP
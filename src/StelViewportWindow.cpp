@@ -0,0 +1,180 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelViewportWindow.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelOpenGL.hpp"
+#include "StelPainter.hpp"
+#include "StelProjector.hpp"
+
+#include <QDebug>
+#include <QGuiApplication>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QScreen>
+#include <QSettings>
+
+QList<StelViewportWindow*> StelViewportWindow::createFromSettings(QSettings* conf, const QSurfaceFormat& format)
+{
+	QList<StelViewportWindow*> windows;
+	const QList<QScreen*> screens = QGuiApplication::screens();
+	const int size = conf->beginReadArray("viewports");
+	for (int i = 0; i < size; ++i)
+	{
+		conf->setArrayIndex(i);
+		StelViewportWindow* window = new StelViewportWindow(format);
+		window->setTitle(QString("Stellarium viewport %1").arg(i+1));
+		const double yaw = conf->value("yaw", 0.).toDouble() * M_PI/180.;
+		const double pitch = conf->value("pitch", 0.).toDouble() * M_PI/180.;
+		const double roll = conf->value("roll", 0.).toDouble() * M_PI/180.;
+		// Turn to the right, then up, then around the new direction
+		window->viewRotation = Mat4d::zrotation(roll) * Mat4d::xrotation(-pitch) * Mat4d::yrotation(yaw);
+		window->fov = conf->value("fov", 0.f).toFloat();
+		window->flipHorz = conf->value("flip_horz", false).toBool();
+		window->flipVert = conf->value("flip_vert", false).toBool();
+		const QString warpMesh = conf->value("warp_mesh").toString();
+		if (!warpMesh.isEmpty() && window->warpMesh.load(warpMesh))
+		{
+			for (float intensity : window->warpMesh.intensities)
+				window->warpColors.append(Vec4f(intensity, intensity, intensity, 1.f));
+		}
+
+		const int screen = conf->value("screen", -1).toInt();
+		if (screen >= 0 && screen < screens.size())
+		{
+			window->setScreen(screens.at(screen));
+			window->setGeometry(screens.at(screen)->geometry());
+			window->setCursor(Qt::BlankCursor);
+			window->showFullScreen();
+		}
+		else
+		{
+			if (screen >= 0)
+				qWarning() << "StelViewportWindow: there is no screen" << screen << "for viewport" << i+1;
+			window->setGeometry(conf->value("x", 0).toInt(), conf->value("y", 0).toInt(),
+					    conf->value("width", 800).toInt(), conf->value("height", 600).toInt());
+			window->show();
+		}
+		windows.append(window);
+	}
+	conf->endArray();
+	if (!windows.isEmpty())
+		qDebug() << "StelViewportWindow: drawing" << windows.size() << "additional viewports";
+	return windows;
+}
+
+StelViewportWindow::StelViewportWindow(const QSurfaceFormat& format)
+	: fov(0.f)
+	, flipHorz(false)
+	, flipVert(false)
+	, renderBuffer(Q_NULLPTR)
+{
+	viewRotation = Mat4d::identity();
+	setSurfaceType(QWindow::OpenGLSurface);
+	QSurfaceFormat windowFormat = format;
+	// The main view waits for vsync already, waiting for each viewport as well would divide the frame rate.
+	windowFormat.setSwapInterval(0);
+	setFormat(windowFormat);
+	create();
+}
+
+StelViewportWindow::~StelViewportWindow()
+{
+	delete renderBuffer;
+}
+
+void StelViewportWindow::draw(QOpenGLContext* context)
+{
+	if (!isExposed() || !context->makeCurrent(this))
+		return;
+
+	StelApp& app = StelApp::getInstance();
+	StelCore* core = app.getCore();
+	const StelProjector::StelProjectorParams mainParams = core->getCurrentStelProjectorParams();
+	StelProjector::StelProjectorParams params = mainParams;
+	const int w = width();
+	const int h = height();
+	const float pixelRatio = devicePixelRatio();
+	params.viewportXywh.set(0, 0, w, h);
+	params.viewportCenter.set((0.5f+params.viewportCenterOffset[0])*w, (0.5f+params.viewportCenterOffset[1])*h);
+	params.viewportFovDiameter = qMin(w, h);
+	params.devicePixelsPerPixel = pixelRatio;
+	params.flipHorz = flipHorz;
+	params.flipVert = flipVert;
+	if (fov > 0.f)
+		params.fov = fov;
+	core->setCurrentStelProjectorParams(params);
+	core->setViewRotation(viewRotation);
+
+	QOpenGLFunctions* gl = context->functions();
+	if (!warpMesh.isEmpty())
+	{
+		const QSize bufferSize(qRound(w*pixelRatio), qRound(h*pixelRatio));
+		if (!renderBuffer || renderBuffer->size()!=bufferSize)
+		{
+			delete renderBuffer;
+			renderBuffer = new QOpenGLFramebufferObject(bufferSize, QOpenGLFramebufferObject::CombinedDepthStencil);
+		}
+		renderBuffer->bind();
+		app.drawAdditionalView();
+		GL(gl->glBindFramebuffer(GL_FRAMEBUFFER, context->defaultFramebufferObject()));
+		paintWarpMesh();
+	}
+	else
+	{
+		GL(gl->glBindFramebuffer(GL_FRAMEBUFFER, context->defaultFramebufferObject()));
+		app.drawAdditionalView();
+	}
+	context->swapBuffers(this);
+
+	core->setViewRotation(Mat4d::identity());
+	core->setCurrentStelProjectorParams(mainParams);
+}
+
+void StelViewportWindow::paintWarpMesh()
+{
+	if (warpVerticesSize!=size())
+	{
+		// The x positions of the mesh are in units of the height, centered like y
+		warpVerticesSize = size();
+		const float w = warpVerticesSize.width();
+		const float h = warpVerticesSize.height();
+		const QVector<Vec2f>& positions = warpMesh.positions;
+		warpVertices.resize(positions.size());
+		for (int i = 0; i < positions.size(); ++i)
+			warpVertices[i].set(0.5f*w + 0.5f*h*positions[i][0], 0.5f*h*(positions[i][1]+1.f));
+	}
+
+	StelPainter sPainter(StelApp::getInstance().getCore()->getProjection2d());
+	QOpenGLFunctions* gl = sPainter.glFuncs();
+	GL(gl->glClearColor(0.f, 0.f, 0.f, 0.f));
+	GL(gl->glClear(GL_COLOR_BUFFER_BIT));
+	GL(gl->glBindTexture(GL_TEXTURE_2D, renderBuffer->texture()));
+	GL(gl->glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GL(gl->glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	sPainter.setBlending(false);
+
+	sPainter.enableClientStates(true, true, true);
+	sPainter.setColorPointer(4, GL_FLOAT, warpColors.constData());
+	sPainter.setVertexPointer(2, GL_FLOAT, warpVertices.constData());
+	sPainter.setTexCoordPointer(2, GL_FLOAT, warpMesh.texCoords.constData());
+	sPainter.drawFromArray(StelPainter::Triangles, warpVertices.size(), 0, false);
+	sPainter.enableClientStates(false);
+}
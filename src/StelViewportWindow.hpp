@@ -0,0 +1,84 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STELVIEWPORTWINDOW_HPP
+#define STELVIEWPORTWINDOW_HPP
+
+#include "StelViewportEffect.hpp"
+#include "VecMath.hpp"
+
+#include <QList>
+#include <QSize>
+#include <QVector>
+#include <QWindow>
+
+class QOpenGLContext;
+class QOpenGLFramebufferObject;
+class QSettings;
+
+//! @class StelViewportWindow
+//! An additional window which shows the sky of the main view in another direction, e.g. one projector of a
+//! multi-channel dome, so that all channels are drawn by one process with a single simulation state instead of
+//! one Stellarium instance per channel synchronized by RemoteSync.
+//! After each frame of the main view, the modules draw again in each window (see StelApp::drawAdditionalView())
+//! with the projector parameters of the window, without being updated again. The GL context of the main view is
+//! made current on the windows, so that its textures and vertex arrays are used as they are.
+//! The windows are described by the array "viewports" of the configuration file, whose entries have the keys:
+//! - screen: the index of the screen on which the window is full screen, or -1 for a window of x, y, width, height
+//! - yaw, pitch, roll: the direction of the window relative to the main view [degrees], yaw is positive to the right
+//! - fov: the field of view of the window [degrees], 0 for the one of the main view
+//! - flip_horz, flip_vert: mirror the window
+//! - warp_mesh: a warp mesh in the format of Paul Bourke (type 2), applied to the drawn window, e.g. for a projector
+//!   which is not in the center of the dome (see StelWarpMesh)
+//! The GUI and the viewport effect of the main view are not drawn in the windows.
+class StelViewportWindow : public QWindow
+{
+	Q_OBJECT
+public:
+	//! Create and show the windows of the configuration file.
+	//! @param format the format of the GL context of the main view
+	static QList<StelViewportWindow*> createFromSettings(QSettings* conf, const QSurfaceFormat& format);
+
+	StelViewportWindow(const QSurfaceFormat& format);
+	//! Releases the framebuffer of the warp mesh. Requires the GL context to be current.
+	~StelViewportWindow();
+
+	//! Draw the current frame of the main view in this window.
+	//! @param context the GL context of the main view, which is made current on this window
+	void draw(QOpenGLContext* context);
+
+private:
+	//! Draw renderBuffer through the warp mesh in the bound framebuffer.
+	void paintWarpMesh();
+
+	Mat4d viewRotation;
+	float fov;
+	bool flipHorz;
+	bool flipVert;
+
+	StelWarpMesh warpMesh;
+	QVector<Vec4f> warpColors;
+	//! The positions in window pixels, for warpVerticesSize
+	QVector<Vec2f> warpVertices;
+	QSize warpVerticesSize;
+	//! The sky is drawn here before it is warped
+	QOpenGLFramebufferObject* renderBuffer;
+};
+
+#endif // STELVIEWPORTWINDOW_HPP
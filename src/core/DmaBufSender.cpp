@@ -0,0 +1,267 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "DmaBufSender.hpp"
+
+#include <QLocalServer>
+#include <QLocalSocket>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+Q_LOGGING_CATEGORY(dmabuf,"stel.dmabuf")
+
+DmaBufSender::DmaBufSender(const QString &senderName)
+	: valid(false), name(senderName), width(800), height(600), bufferDirty(true), frameCounter(0)
+	, eglDisplay(Q_NULLPTR), eglContext(Q_NULLPTR)
+	, createImage(Q_NULLPTR), destroyImage(Q_NULLPTR), exportQuery(Q_NULLPTR), exportImage(Q_NULLPTR)
+	, texture(0), image(Q_NULLPTR), fd(-1), server(Q_NULLPTR)
+{
+	initializeOpenGLFunctions();
+	std::memset(&buffer, 0, sizeof(buffer));
+
+	eglDisplay = eglGetCurrentDisplay();
+	eglContext = eglGetCurrentContext();
+	if (eglDisplay==EGL_NO_DISPLAY || eglContext==EGL_NO_CONTEXT)
+	{
+		qCCritical(dmabuf) << "The GL context is not an EGL context";
+		qCCritical(dmabuf) << "Run on Wayland, or set QT_XCB_GL_INTEGRATION=xcb_egl on X11.";
+		return;
+	}
+	const QByteArray extensions(eglQueryString(eglDisplay, EGL_EXTENSIONS));
+	for (const char* ext : {"EGL_KHR_gl_texture_2D_image", "EGL_MESA_image_dma_buf_export"})
+	{
+		if (!extensions.split(' ').contains(ext))
+		{
+			qCCritical(dmabuf) << "The EGL display does not support" << ext;
+			return;
+		}
+	}
+	createImage = reinterpret_cast<PFNCreateImage>(eglGetProcAddress("eglCreateImageKHR"));
+	destroyImage = reinterpret_cast<PFNDestroyImage>(eglGetProcAddress("eglDestroyImageKHR"));
+	exportQuery = reinterpret_cast<PFNExportQuery>(eglGetProcAddress("eglExportDMABUFImageQueryMESA"));
+	exportImage = reinterpret_cast<PFNExport>(eglGetProcAddress("eglExportDMABUFImageMESA"));
+	if (!createImage || !destroyImage || !exportQuery || !exportImage)
+	{
+		qCCritical(dmabuf) << "Could not resolve the EGL image functions";
+		return;
+	}
+
+	server = new QLocalServer(this);
+	QLocalServer::removeServer(name);
+	if (!server->listen(name))
+	{
+		qCCritical(dmabuf) << "Could not listen on" << name << ":" << server->errorString();
+		return;
+	}
+	connect(server, SIGNAL(newConnection()), this, SLOT(addReceiver()));
+	valid = true;
+	qCDebug(dmabuf) << "Sender is listening on" << server->fullServerName();
+}
+
+DmaBufSender::~DmaBufSender()
+{
+	for (const auto& receiver : receivers)
+		receiver.socket->disconnect(this);
+	receivers.clear();
+	if (server)
+		server->close();
+	releaseBuffer();
+	qCDebug(dmabuf)<<"Sender"<<name<<"released";
+}
+
+bool DmaBufSender::createBuffer()
+{
+	releaseBuffer();
+	bufferDirty = false;
+
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, Q_NULLPTR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	const EGLint attribs[] = {EGL_GL_TEXTURE_LEVEL_KHR, 0, EGL_NONE};
+	image = createImage(eglDisplay, eglContext, EGL_GL_TEXTURE_2D_KHR,
+			    reinterpret_cast<EGLClientBuffer>(static_cast<quintptr>(texture)), attribs);
+	if (image==EGL_NO_IMAGE_KHR)
+	{
+		qCWarning(dmabuf) << "Could not create the EGL image of" << width << "x" << height << "pixels";
+		releaseBuffer();
+		return false;
+	}
+	int fourcc = 0, numPlanes = 0;
+	quint64 modifier = 0;
+	if (!exportQuery(eglDisplay, image, &fourcc, &numPlanes, &modifier) || numPlanes!=1)
+	{
+		// The formats of several planes are YUV ones, which a GL_RGBA texture is not expected to get
+		qCWarning(dmabuf) << "Could not export the EGL image as a single plane DMA-BUF";
+		releaseBuffer();
+		return false;
+	}
+	EGLint stride = 0, offset = 0;
+	if (!exportImage(eglDisplay, image, &fd, &stride, &offset) || fd<0)
+	{
+		qCWarning(dmabuf) << "Could not export the EGL image";
+		fd = -1;
+		releaseBuffer();
+		return false;
+	}
+
+	buffer.magic = MAGIC;
+	buffer.width = width;
+	buffer.height = height;
+	buffer.fourcc = static_cast<quint32>(fourcc);
+	buffer.stride = static_cast<quint32>(stride);
+	buffer.offset = static_cast<quint32>(offset);
+	buffer.modifier = modifier;
+	for (auto& receiver : receivers)
+		receiver.hasBuffer = false;
+	qCDebug(dmabuf) << "Exported a buffer of" << width << "x" << height << "pixels, fourcc" << QByteArray(reinterpret_cast<const char*>(&fourcc), 4) << "modifier" << modifier;
+	return true;
+}
+
+void DmaBufSender::releaseBuffer()
+{
+	if (fd>=0)
+		::close(fd);
+	fd = -1;
+	if (image)
+		destroyImage(eglDisplay, image);
+	image = Q_NULLPTR;
+	if (texture)
+		glDeleteTextures(1, &texture);
+	texture = 0;
+}
+
+void DmaBufSender::captureAndSendFrame()
+{
+	// Nobody would see the copy
+	if (!valid || receivers.isEmpty())
+		return;
+	if (bufferDirty && !createBuffer())
+		return;
+	if (!texture)
+		return;
+
+	// The GPU copies from the bound framebuffer, the pixels never come back to the CPU
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	// The receivers wait for the copy through the implicit synchronization of the DMA-BUF, once it is submitted
+	glFlush();
+	++frameCounter;
+
+	QList<QLocalSocket*> broken;
+	for (auto& receiver : receivers)
+	{
+		bool ok = true;
+		if (!receiver.hasBuffer)
+			receiver.hasBuffer = send(receiver, MessageBuffer, fd, &ok);
+		if (receiver.hasBuffer)
+			send(receiver, MessageFrame, -1, &ok);
+		if (!ok)
+			broken.append(receiver.socket);
+	}
+	// Aborting removes the receivers
+	for (auto* socket : broken)
+		socket->abort();
+}
+
+void DmaBufSender::resize(uint width, uint height)
+{
+	if (width==this->width && height==this->height)
+		return;
+	this->width = width;
+	this->height = height;
+	bufferDirty = true;
+}
+
+void DmaBufSender::addReceiver()
+{
+	while (QLocalSocket* socket = server->nextPendingConnection())
+	{
+		connect(socket, SIGNAL(disconnected()), this, SLOT(removeReceiver()));
+		Receiver receiver;
+		receiver.socket = socket;
+		receiver.hasBuffer = false;
+		receivers.append(receiver);
+		qCDebug(dmabuf) << "Receiver connected," << receivers.size() << "connected";
+	}
+}
+
+void DmaBufSender::removeReceiver()
+{
+	QLocalSocket* socket = qobject_cast<QLocalSocket*>(sender());
+	for (int i=0; i<receivers.size(); ++i)
+	{
+		if (receivers.at(i).socket==socket)
+		{
+			receivers.removeAt(i);
+			break;
+		}
+	}
+	socket->deleteLater();
+	qCDebug(dmabuf) << "Receiver disconnected," << receivers.size() << "connected";
+}
+
+bool DmaBufSender::send(const Receiver& receiver, MessageType type, int fd, bool* ok)
+{
+	Message message = buffer;
+	message.type = type;
+	message.frame = frameCounter;
+
+	// QLocalSocket can't pass file descriptors, the messages are sent directly on its socket
+	iovec iov;
+	iov.iov_base = &message;
+	iov.iov_len = sizeof(message);
+	msghdr msg;
+	std::memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	char control[CMSG_SPACE(sizeof(int))];
+	if (fd>=0)
+	{
+		std::memset(control, 0, sizeof(control));
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+		cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+		cmsg->cmsg_level = SOL_SOCKET;
+		cmsg->cmsg_type = SCM_RIGHTS;
+		cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+		std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+	}
+	const ssize_t sent = ::sendmsg(static_cast<int>(receiver.socket->socketDescriptor()), &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+	if (sent==static_cast<ssize_t>(sizeof(message)))
+		return true;
+	// A partial message would shift all the following ones
+	if (sent>=0)
+		*ok = false;
+	else if (errno!=EAGAIN && errno!=EWOULDBLOCK)
+		qCWarning(dmabuf) << "Could not send to a receiver:" << std::strerror(errno);
+	return false;
+}
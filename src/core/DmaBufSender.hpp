@@ -0,0 +1,140 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef DMABUFSENDER_HPP
+#define DMABUFSENDER_HPP
+
+#include <QList>
+#include <QLoggingCategory>
+#include <QObject>
+#include <QOpenGLFunctions>
+#include <QString>
+
+Q_DECLARE_LOGGING_CATEGORY(dmabuf)
+
+class QLocalServer;
+class QLocalSocket;
+
+//! Helper class to share rendered frames with other programs on Linux, e.g. video mixers, without reading them back
+//! to the main memory: the frames are copied by the GPU into a texture, which is exported as a DMA-BUF with
+//! EGL_MESA_image_dma_buf_export, so that the other programs import it into their own GL or Vulkan context.
+//! This is the Linux counterpart of SpoutSender, and requires an EGL context: running on Wayland, or on X11 with
+//! QT_XCB_GL_INTEGRATION=xcb_egl.
+//!
+//! The receivers connect to a local socket (QLocalServer) of the name of the sender, i.e. $XDG_RUNTIME_DIR/<name>
+//! or /tmp/<name>, and get fixed size Message structs in the native byte order:
+//! - a Buffer message on connection and after each change of the size, with the file descriptor of the DMA-BUF as
+//!   SCM_RIGHTS ancillary data, to pass to eglCreateImageKHR(EGL_LINUX_DMA_BUF_EXT) with the fourcc, stride,
+//!   offset and modifier of the message
+//! - a Frame message after each frame copied into the buffer.
+//! The frames are copied only while receivers are connected. A receiver which does not read its messages fast enough
+//! misses some Frame messages, but no Buffer message.
+class DmaBufSender : public QObject, protected QOpenGLFunctions
+{
+	Q_OBJECT
+public:
+	enum MessageType
+	{
+		MessageBuffer = 1,
+		MessageFrame = 2
+	};
+
+	struct Message
+	{
+		quint32 magic;		//!< MAGIC
+		quint32 type;		//!< MessageType
+		quint32 width;
+		quint32 height;
+		quint32 fourcc;		//!< DRM_FORMAT_* of the buffer
+		quint32 stride;		//!< bytes per row
+		quint32 offset;		//!< bytes before the first row
+		quint32 reserved;
+		quint64 modifier;	//!< DRM_FORMAT_MOD_* of the buffer
+		quint64 frame;		//!< number of the frame in the buffer, 0 before the first one
+	};
+	//! "STDB"
+	static const quint32 MAGIC = 0x53544442;
+
+	//! Initializes the exports and starts listening on the local socket of this name.
+	//! Requires a valid GL context.
+	DmaBufSender(const QString& senderName);
+	//! Releases all held resources, requires the GL context.
+	virtual ~DmaBufSender() Q_DECL_OVERRIDE;
+
+	//! True if the sender has been successfully created
+	bool isValid() const { return valid; }
+
+public slots:
+	//! Copies the currently bound framebuffer into the shared buffer, and tells the receivers.
+	//! Requires a valid GL context.
+	void captureAndSendFrame();
+	//! Informs the sender about changed buffer dimensions, in device pixels.
+	//! Does not need a GL context.
+	void resize(uint width, uint height);
+
+private slots:
+	void addReceiver();
+	void removeReceiver();
+
+private:
+	struct Receiver
+	{
+		QLocalSocket* socket;
+		//! Whether the receiver has the current buffer
+		bool hasBuffer;
+	};
+
+	//! Create the texture of the current size, and export it.
+	bool createBuffer();
+	void releaseBuffer();
+	//! Send a message to a receiver, without blocking.
+	//! @param fd the file descriptor to pass with the message, or -1
+	//! @param ok set to false if the connection is broken and must be closed
+	//! @return false if the message could not be sent now
+	bool send(const Receiver& receiver, MessageType type, int fd, bool* ok);
+
+	typedef void* (*PFNCreateImage)(void* dpy, void* ctx, unsigned int target, void* buffer, const qint32* attribs);
+	typedef unsigned int (*PFNDestroyImage)(void* dpy, void* image);
+	typedef unsigned int (*PFNExportQuery)(void* dpy, void* image, int* fourcc, int* numPlanes, quint64* modifiers);
+	typedef unsigned int (*PFNExport)(void* dpy, void* image, int* fds, qint32* strides, qint32* offsets);
+
+	bool valid;
+	QString name;
+	uint width;
+	uint height;
+	bool bufferDirty;
+	quint64 frameCounter;
+
+	void* eglDisplay;
+	void* eglContext;
+	PFNCreateImage createImage;
+	PFNDestroyImage destroyImage;
+	PFNExportQuery exportQuery;
+	PFNExport exportImage;
+
+	GLuint texture;
+	void* image;
+	int fd;
+	Message buffer;
+
+	QLocalServer* server;
+	QList<Receiver> receivers;
+};
+
+#endif // DMABUFSENDER_HPP
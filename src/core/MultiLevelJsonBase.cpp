@@ -23,17 +23,19 @@
 #include "StelProjector.hpp"
 #include "StelCore.hpp"
 #include "StelUtils.hpp"
+#include "StelJobMgr.hpp"
+#include "StelFileCache.hpp"
 
+#include <QDataStream>
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
 #include <QUrl>
-#include <QDir>
 #include <QBuffer>
-#include <QThread>
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
+#include <QSettings>
 #include <stdexcept>
 #include <stdio.h>
 
@@ -41,6 +43,27 @@
 
 // Init statics
 QNetworkAccessManager* MultiLevelJsonBase::networkAccessManager = Q_NULLPTR;
+QSharedPointer<StelFileCache> MultiLevelJsonBase::descriptionCache;
+bool MultiLevelJsonBase::descriptionCacheInitialized = false;
+const float MultiLevelJsonBase::priorityScheduledForDeletion = -1.f;
+
+namespace
+{
+	const quint32 descriptionMagic = 0x534a534e; // "SJSN"
+	const quint32 descriptionVersion = 1;
+}
+
+QSharedPointer<StelFileCache> MultiLevelJsonBase::getDescriptionCache()
+{
+	if (!descriptionCacheInitialized)
+	{
+		descriptionCacheInitialized = true;
+		const int cacheSizeMB = StelApp::getInstance().getSettings()->value("main/json_cache_size_mb", 64).toInt();
+		if (cacheSizeMB > 0)
+			descriptionCache.reset(new StelFileCache(StelFileMgr::getCacheDir() + "/json", ".sjsn", static_cast<qint64>(cacheSizeMB)*1024*1024, true));
+	}
+	return descriptionCache;
+}
 
 QNetworkAccessManager& MultiLevelJsonBase::getNetworkAccessManager()
 {
@@ -59,42 +82,21 @@ QNetworkAccessManager& MultiLevelJsonBase::getNetworkAccessManager()
 }
 
 /*************************************************************************
-  Class used to load a JSON file in a thread
+  Result of the job parsing a JSON file. It is shared with the job so that
+  the tile can be deleted while the job is running.
  *************************************************************************/
-class JsonLoadThread : public QThread
+struct JsonLoadResult
 {
-	public:
-		JsonLoadThread(MultiLevelJsonBase* atile, QByteArray content, bool aqZcompressed=false, bool agzCompressed=false) : QThread((QObject*)atile),
-			tile(atile), data(content), qZcompressed(aqZcompressed), gzCompressed(agzCompressed){;}
-		virtual void run();
-	private:
-		MultiLevelJsonBase* tile;
-		QByteArray data;
-		const bool qZcompressed;
-		const bool gzCompressed;
+	JsonLoadResult() : errorOccured(false) {}
+	QVariantMap map;
+	bool errorOccured;
 };
 
-void JsonLoadThread::run()
-{
-	try
-	{
-		QBuffer buf(&data);
-		buf.open(QIODevice::ReadOnly);
-		tile->temporaryResultMap = MultiLevelJsonBase::loadFromJSON(buf, qZcompressed, gzCompressed);
-	}
-	catch (std::runtime_error e)
-	{
-		qWarning() << "WARNING : Can't parse loaded JSON description: " << e.what();
-		tile->errorOccured = true;
-	}
-}
-
 MultiLevelJsonBase::MultiLevelJsonBase(MultiLevelJsonBase* parent) : StelSkyLayer(parent)
 	, errorOccured(false)
 	, downloading(false)
 	, httpReply(Q_NULLPTR)
 	, deletionDelay(2.)
-	, loadThread(Q_NULLPTR)
 	, timeWhenDeletionScheduled(-1.) // Avoid tiles to be deleted just after constructed
 	, loadingState(false)
 	, lastPercent(0)
@@ -131,24 +133,15 @@ void MultiLevelJsonBase::initFromUrl(const QString& url)
 		}
 		QFileInfo finf(fileName);
 		baseUrl = finf.absolutePath()+'/';
-		QFile f(fileName);
-		if(f.open(QIODevice::ReadOnly))
-		{
-			const bool compressed = fileName.endsWith(".qZ");
-			const bool gzCompressed = fileName.endsWith(".gz");
-			try
-			{
-				loadFromQVariantMap(loadFromJSON(f, compressed, gzCompressed));
-			}
-			catch (std::runtime_error e)
-			{
-				qWarning() << "WARNING : Can't parse JSON description: " << QDir::toNativeSeparators(fileName) << ": " << e.what();
-				errorOccured = true;
-				f.close();
-				return;
-			}
-			f.close();
-		}
+		const bool compressed = fileName.endsWith(".qZ");
+		const bool gzCompressed = fileName.endsWith(".gz");
+		const QString key = StelFileCache::getKey(fileName);
+		const auto read = [fileName]() {
+			QFile f(fileName);
+			return f.open(QIODevice::ReadOnly) ? f.readAll() : QByteArray();
+		};
+		// Also the root, so that adding a large image set does not stall the draws
+		startLoadJob(key, read, compressed, gzCompressed);
 	}
 	else
 	{
@@ -165,6 +158,18 @@ void MultiLevelJsonBase::initFromUrl(const QString& url)
 			Q_ASSERT(parent->getBaseUrl().startsWith("http", Qt::CaseInsensitive));
 			qurl.setUrl(parent->getBaseUrl()+url);
 		}
+		QString turl = qurl.toString();
+		baseUrl = turl.left(turl.lastIndexOf('/')+1);
+
+		// Descriptions parsed in a previous session are not downloaded again
+		const QSharedPointer<StelFileCache> cache = getDescriptionCache();
+		if (cache && cache->contains(turl))
+		{
+			const QString path = qurl.path();
+			startLoadJob(turl, []() { return QByteArray(); }, path.endsWith(".qZ"), path.endsWith(".gz"));
+			return;
+		}
+
 		Q_ASSERT(httpReply==Q_NULLPTR);
 		QNetworkRequest req(qurl);
 		req.setRawHeader("User-Agent", StelUtils::getUserAgentString().toLatin1());
@@ -176,8 +181,6 @@ void MultiLevelJsonBase::initFromUrl(const QString& url)
 		//connect(httpReply, SIGNAL(error(QNetworkReply::NetworkError)), this, SLOT(downloadError(QNetworkReply::NetworkError)));
 		//connect(httpReply, SIGNAL(destroyed()), this, SLOT(replyDestroyed()));
 		downloading = true;
-		QString turl = qurl.toString();
-		baseUrl = turl.left(turl.lastIndexOf('/')+1);
 	}
 }
 
@@ -208,25 +211,17 @@ MultiLevelJsonBase::~MultiLevelJsonBase()
 {
 	if (httpReply)
 	{
-		//qDebug() << "Abort: " << httpReply->request().url().path();
-		//httpReply->abort();
-
-		// TODO: This line should not be commented, but I have to keep it because of a Qt bug.
-		// It should be fixed with Qt 4.5.1
-		// It causes a nasty memory leak, but prevents an even more nasty
-		//httpReply->deleteLater();
+		// The reply would call downloadFinished() on this deleted tile when aborted
+		httpReply->disconnect(this);
+		httpReply->abort();
+		httpReply->deleteLater();
 		httpReply = Q_NULLPTR;
 	}
-	if (loadThread && loadThread->isRunning())
+	if (loadJob)
 	{
-		//qDebug() << "--> Abort thread " << contructorUrl;
-		disconnect(loadThread, SIGNAL(finished()), this, SLOT(jsonLoadFinished()));
-		// The thread is currently running, it needs to be properly stopped
-		if (loadThread->wait(1)==false)
-		{
-			loadThread->terminate();
-			//loadThread->wait(2000);
-		}
+		// A running job only writes into its own result, it can safely finish after the tile is gone.
+		loadJob->cancel();
+		loadJob.clear();
 	}
 	for (auto* tile : subTiles)
 	{
@@ -241,13 +236,24 @@ void MultiLevelJsonBase::scheduleChildsDeletion()
 	for (auto* tile : subTiles)
 	{
 		if (tile->timeWhenDeletionScheduled<0)
+		{
 			tile->timeWhenDeletionScheduled = StelApp::getInstance().getTotalRunTime();
+			tile->setLoadPriority(true);
+		}
 	}
 }
 
+void MultiLevelJsonBase::setLoadPriority(bool scheduledForDeletion)
+{
+	if (loadJob)
+		loadJob->setPriority(scheduledForDeletion ? priorityScheduledForDeletion : 0.f);
+}
+
 // If a deletion was scheduled, cancel it.
 void MultiLevelJsonBase::cancelDeletion()
 {
+	if (timeWhenDeletionScheduled>0.)
+		setLoadPriority(false);
 	timeWhenDeletionScheduled=-1.;
 	for (auto* tile : subTiles)
 	{
@@ -315,21 +321,81 @@ void MultiLevelJsonBase::downloadFinished()
 
 	const bool qZcompressed = httpReply->request().url().path().endsWith(".qZ");
 	const bool gzCompressed = httpReply->request().url().path().endsWith(".gz");
+	const QString key = httpReply->request().url().toString();
 	httpReply->deleteLater();
 	httpReply=Q_NULLPTR;
 
-	Q_ASSERT(loadThread==Q_NULLPTR);
-	loadThread = new JsonLoadThread(this, content, qZcompressed, gzCompressed);
-	connect(loadThread, SIGNAL(finished()), this, SLOT(jsonLoadFinished()));
-	loadThread->start(QThread::LowestPriority);
+	startLoadJob(key, [content]() { return content; }, qZcompressed, gzCompressed);
+}
+
+void MultiLevelJsonBase::startLoadJob(const QString& key, const std::function<QByteArray()>& read, bool qZcompressed, bool gzCompressed)
+{
+	Q_ASSERT(loadJob.isNull());
+	downloading = true;
+	const QSharedPointer<JsonLoadResult> result(new JsonLoadResult());
+	const QSharedPointer<StelFileCache> cache = getDescriptionCache();
+	loadJob = StelApp::getInstance().getJobMgr().submit([=]()
+	{
+		try
+		{
+			result->map = loadDescription(cache, key, read, qZcompressed, gzCompressed);
+		}
+		catch (std::runtime_error e)
+		{
+			qWarning() << "WARNING : Can't parse loaded JSON description: " << key << ": " << e.what();
+			result->errorOccured = true;
+		}
+	}, isDeletionScheduled() ? priorityScheduledForDeletion : 0.f, QList<StelJobP>(), [this, result]()
+	{
+		temporaryResultMap = result->map;
+		errorOccured = errorOccured || result->errorOccured;
+		jsonLoadFinished();
+	});
+}
+
+QVariantMap MultiLevelJsonBase::loadDescription(const QSharedPointer<StelFileCache>& cache, const QString& key,
+						const std::function<QByteArray()>& read, bool qZcompressed, bool gzCompressed)
+{
+	const bool cacheable = cache && !key.isEmpty();
+	if (cacheable)
+	{
+		QByteArray stored = cache->read(key);
+		if (!stored.isEmpty())
+		{
+			QDataStream in(&stored, QIODevice::ReadOnly);
+			in.setVersion(QDataStream::Qt_5_2);
+			quint32 magic, version;
+			QString storedKey;
+			QVariantMap map;
+			in >> magic >> version;
+			if (magic==descriptionMagic && version==descriptionVersion)
+				in >> storedKey >> map;
+			if (in.status()==QDataStream::Ok && storedKey==key && !map.isEmpty())
+				return map;
+			qWarning() << "Invalid cached JSON description for" << key;
+			cache->remove(key);
+		}
+	}
+
+	QByteArray data = read();
+	QBuffer buf(&data);
+	buf.open(QIODevice::ReadOnly);
+	const QVariantMap map = loadFromJSON(buf, qZcompressed, gzCompressed);
+	if (cacheable)
+	{
+		QByteArray stored;
+		QDataStream out(&stored, QIODevice::WriteOnly);
+		out.setVersion(QDataStream::Qt_5_2);
+		out << descriptionMagic << descriptionVersion << key << map;
+		cache->write(key, stored);
+	}
+	return map;
 }
 
 // Called when the element is fully loaded from the JSON file
 void MultiLevelJsonBase::jsonLoadFinished()
 {
-	loadThread->wait();
-	delete loadThread;
-	loadThread = Q_NULLPTR;
+	loadJob.clear();
 	downloading = false;
 	if (errorOccured)
 		return;
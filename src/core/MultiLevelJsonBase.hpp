@@ -20,23 +20,29 @@
 #define MULTILEVELJSONBASE_HPP
 
 #include "StelSkyLayer.hpp"
+#include "StelJobMgr.hpp"
 
 #include <QList>
 #include <QString>
 #include <QVariantMap>
 #include <QNetworkReply>
 
+#include <functional>
+
 class QIODevice;
 class StelCore;
+class StelFileCache;
 
 //! Abstract base class for managing multi-level tree objects stored in JSON format.
-//! The JSON files can be stored on disk or remotely and are loaded into threads.
+//! The JSON files can be stored on disk or remotely and are parsed by background jobs of StelJobMgr,
+//! also the one of the root: a tree is not drawn until it is loaded. Parsed descriptions are kept in a binary disk cache,
+//! so that the files are neither downloaded nor parsed again in later sessions.
+//! The load jobs of the tiles scheduled for deletion are deprioritised, and their downloads and
+//! jobs are cancelled when the tiles are deleted.
 class MultiLevelJsonBase : public StelSkyLayer
 {
 	Q_OBJECT
 
-	friend class JsonLoadThread;
-
 public:
 	//! Default constructor.
 	MultiLevelJsonBase(MultiLevelJsonBase* parent=Q_NULLPTR);
@@ -112,22 +118,42 @@ protected:
 	//! Load the element information from a JSON file
 	static QVariantMap loadFromJSON(QIODevice& input, bool qZcompressed=false, bool gzCompressed=false);
 
+	//! Set the priority of the loads of the tile, lowered when the deletion of the tile is scheduled.
+	//! The default implementation sets the priority of the load job of the description.
+	virtual void setLoadPriority(bool scheduledForDeletion);
+
+	//! The priority of the loads of the tiles scheduled for deletion, see StelJobMgr
+	static const float priorityScheduledForDeletion;
+
 private:
 	//! Return the base URL prefixed to relative URL
 	QString getBaseUrl() const {return baseUrl;}
 
+	//! Get a description from the cache of parsed descriptions, or parse it and store it in the cache.
+	//! This is thread safe, it is called by the load jobs.
+	//! @param cache the cache of parsed descriptions, may be null
+	//! @param key the key of the description in the cache, empty if it can not be cached
+	//! @param read the function reading the JSON file if it is not cached
+	//! @exception std::runtime_error if the file can not be parsed
+	static QVariantMap loadDescription(const QSharedPointer<StelFileCache>& cache, const QString& key,
+					   const std::function<QByteArray()>& read, bool qZcompressed, bool gzCompressed);
+
+	//! Start the job loading the description, loadFromQVariantMap() is called when it finished.
+	void startLoadJob(const QString& key, const std::function<QByteArray()>& read, bool qZcompressed, bool gzCompressed);
+
 	// Used to download remote JSON files if needed
 	class QNetworkReply* httpReply;
 
 	// The delay after which a scheduled deletion will occur
 	float deletionDelay;
 
-	class JsonLoadThread* loadThread;
+	// The job parsing the downloaded JSON file
+	StelJobP loadJob;
 
 	// Time at which deletion was first scheduled
 	double timeWhenDeletionScheduled;
 
-	// The temporary map filled in a thread
+	// The temporary map filled by loadJob
 	QVariantMap temporaryResultMap;
 
 	bool loadingState;
@@ -137,6 +163,11 @@ private:
 	static class QNetworkAccessManager* networkAccessManager;
 
 	static QNetworkAccessManager& getNetworkAccessManager();
+
+	//! The cache of parsed descriptions, null if disabled
+	static QSharedPointer<StelFileCache> descriptionCache;
+	static bool descriptionCacheInitialized;
+	static QSharedPointer<StelFileCache> getDescriptionCache();
 };
 
 #endif // MULTILEVELJSONBASE_HPP
@@ -23,6 +23,7 @@
 #include "glues.h"
 
 #include <QFile>
+#include <QtConcurrent>
 
 const Vec3d OctahedronPolygon::sideDirections[] = {	Vec3d(1,1,1), Vec3d(1,1,-1),Vec3d(-1,1,1),Vec3d(-1,1,-1),
 	Vec3d(1,-1,1),Vec3d(1,-1,-1),Vec3d(-1,-1,1),Vec3d(-1,-1,-1)};
@@ -122,14 +123,39 @@ OctahedronPolygon::OctahedronPolygon(const SubContour& initContour)
 OctahedronPolygon::OctahedronPolygon(const QList<OctahedronPolygon>& octs) : fillCachedVertexArray(StelVertexArray::Triangles), outlineCachedVertexArray(StelVertexArray::Lines)
 {
 	sides.resize(8);
-	for (const auto& oct : octs)
+	// Unite the polygons by pairs, then the results by pairs, so that the contours of each polygon are tesselated
+	// about log2(n) times instead of n times. The pairs of a level are independent, and are united in parallel.
+	QVector<OctahedronPolygon> polys = octs.toVector();
+	while (polys.size()>1)
 	{
-		for (int i=0;i<8;++i)
+		QVector<OctahedronPolygon> united((polys.size()+1)/2);
+		OctahedronPolygon* out = united.data();
+		const OctahedronPolygon* in = polys.constData();
+		const int nbPolys = polys.size();
+		const auto unitePair = [out, in, nbPolys](int i)
 		{
-			Q_ASSERT(oct.sides.size()==8);
-			sides[i] += oct.sides[i];
+			out[i] = in[2*i];
+			if (2*i+1<nbPolys)
+				out[i].uniteSides(in[2*i+1]);
+		};
+		if (united.size()>=4)
+		{
+			QVector<int> pairs(united.size());
+			for (int i=0;i<pairs.size();++i)
+				pairs[i] = i;
+			QtConcurrent::blockingMap(pairs, unitePair);
 		}
-		tesselate(WindingPositive);
+		else
+		{
+			for (int i=0;i<united.size();++i)
+				unitePair(i);
+		}
+		polys = united;
+	}
+	if (!polys.isEmpty())
+	{
+		Q_ASSERT(polys.first().sides.size()==8);
+		sides = polys.first().sides;
 	}
 	updateVertexArray();
 }
@@ -549,7 +575,7 @@ void endLineLoopCallback(OctTessLineLoopCallbackData* data)
 	data->result.clear();
 }
 
-void OctahedronPolygon::tesselate(TessWindingRule windingRule)
+void OctahedronPolygon::tesselate(TessWindingRule windingRule, int sideMask)
 {
 	Q_ASSERT(sides.size()==8);
 	// Use GLUES tesselation functions to transform the polygon into a list of triangles
@@ -567,7 +593,7 @@ void OctahedronPolygon::tesselate(TessWindingRule windingRule)
 	// Call the tesselator on each side
 	for (int i=0;i<8;++i)
 	{
-		if (sides[i].isEmpty())
+		if (sides[i].isEmpty() || !(sideMask & (1<<i)))
 			continue;
 		sides[i] = tesselateOneSideLineLoop(tess, i);
 	}
@@ -591,10 +617,29 @@ QString OctahedronPolygon::toJson() const
 	return res;
 }
 
+void OctahedronPolygon::uniteSides(const OctahedronPolygon& other)
+{
+	Q_ASSERT(sides.size()==8 && other.sides.size()==8);
+	int sideMask = 0;
+	for (int i=0;i<8;++i)
+	{
+		if (other.sides[i].isEmpty())
+			continue;
+		if (!sides[i].isEmpty())
+			sideMask |= 1<<i;
+		sides[i] += other.sides[i];
+	}
+	if (sideMask)
+		tesselate(WindingPositive, sideMask);
+}
+
 void OctahedronPolygon::inPlaceIntersection(const OctahedronPolygon& mpoly)
 {
 	if (!intersectsBoundingCap(capN, capD, mpoly.capN, mpoly.capD))
+	{
+		*this = getEmptyOctahedronPolygon();
 		return;
+	}
 	append(mpoly);
 	tesselate(WindingAbsGeqTwo);
 	//tesselate(WindingPositive);
@@ -603,10 +648,10 @@ void OctahedronPolygon::inPlaceIntersection(const OctahedronPolygon& mpoly)
 
 void OctahedronPolygon::inPlaceUnion(const OctahedronPolygon& mpoly)
 {
-	const bool intersect = intersectsBoundingCap(capN, capD, mpoly.capN, mpoly.capD);
-	append(mpoly);
-	if (intersect)
-		tesselate(WindingPositive);
+	if (intersectsBoundingCap(capN, capD, mpoly.capN, mpoly.capD))
+		uniteSides(mpoly);
+	else
+		append(mpoly);
 	updateVertexArray();
 }
 
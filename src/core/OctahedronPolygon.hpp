@@ -134,7 +134,13 @@ private:
 	bool sideContains2D(const Vec3d& p, int sideNb) const;
 
 	//! Tesselate the contours per side, producing (in @var sides) a list of triangles subcontours according to the given rule.
-	void tesselate(TessWindingRule rule);
+	//! @param sideMask the sides to tesselate, bit i for side i
+	void tesselate(TessWindingRule rule, int sideMask=0xff);
+
+	//! Append the contours of another polygon and tesselate them with the positive winding rule, without updating the
+	//! vertex arrays. Only the sides which have contours from both polygons are tesselated again, as the contours of
+	//! a single polygon are already tesselated.
+	void uniteSides(const OctahedronPolygon& other);
 
 	QVector<SubContour> tesselateOneSideLineLoop(struct GLUEStesselator* tess, int sidenb) const;
 	QVector<Vec3d> tesselateOneSideTriangles(struct GLUEStesselator* tess, int sidenb) const;
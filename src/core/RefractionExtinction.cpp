@@ -23,6 +23,13 @@
 #include "StelApp.hpp"
 #include "RefractionExtinction.hpp"
 
+#include <cmath>
+
+// Number of entries of the airmass and refraction tables, and sines of altitude below which they are not used.
+static const int AIRMASS_TABLE_SIZE=4096;
+static const float AIRMASS_TABLE_MIN_COSZ=-0.035f;
+static const int REFRACTION_TABLE_SIZE=4096;
+
 Extinction::Extinction() : ext_coeff(50), undergroundExtinctionMode(UndergroundExtinctionMirror)
 {
 }
@@ -49,12 +56,50 @@ float Extinction::airmass(float cosZ, const bool apparent_z) const
 		return 1.0f/(cosZ+0.025f*std::exp(-11.f*cosZ));
 	}
 	else
+		return youngAirmass(cosZ);
+}
+
+float Extinction::youngAirmass(float cosZ)
+{
+	//Young 1994
+	const float nom=(1.002432f*cosZ+0.148386f)*cosZ+0.0096467f;
+	const float denum=((cosZ+0.149864f)*cosZ+0.0102963f)*cosZ+0.000303978f;
+	return nom/denum;
+}
+
+float Extinction::geometricAirmass(float cosZ) const
+{
+	// Young's formula does not depend on the atmospheric conditions: the table is shared by all instances.
+	static const QVector<float> table = []()
+	{
+		QVector<float> t(AIRMASS_TABLE_SIZE);
+		for (int i=0; i<AIRMASS_TABLE_SIZE; ++i)
+			t[i]=youngAirmass(AIRMASS_TABLE_MIN_COSZ + (1.f-AIRMASS_TABLE_MIN_COSZ)*i/(AIRMASS_TABLE_SIZE-1));
+		return t;
+	}();
+
+	if (cosZ<AIRMASS_TABLE_MIN_COSZ)
 	{
-		//Young 1994
-		const float nom=(1.002432f*cosZ+0.148386f)*cosZ+0.0096467f;
-		const float denum=((cosZ+0.149864f)*cosZ+0.0102963f)*cosZ+0.000303978f;
-		return nom/denum;
+		switch (undergroundExtinctionMode)
+		{
+			case UndergroundExtinctionZero:
+				return 0.f;
+			case UndergroundExtinctionMax:
+				return 42.f;
+			case UndergroundExtinctionMirror:
+				cosZ = std::min(1.f, -0.035f - (cosZ+0.035f));
+		}
 	}
+	const float t=(std::min(cosZ, 1.f)-AIRMASS_TABLE_MIN_COSZ)*((AIRMASS_TABLE_SIZE-1)/(1.f-AIRMASS_TABLE_MIN_COSZ));
+	const int i=std::min(static_cast<int>(t), AIRMASS_TABLE_SIZE-2);
+	const float f=t-i;
+	return table.at(i)+(table.at(i+1)-table.at(i))*f;
+}
+
+void Extinction::forward(const Vec3f* altAzPos, float* mag, int n) const
+{
+	for (int i=0; i<n; ++i)
+		mag[i] += geometricAirmass(altAzPos[i][2]) * ext_coeff;
 }
 
 /* ***************************************************************************************************** */
@@ -72,6 +117,11 @@ static const float MIN_APP_ALTITUDE_DEG=-3.21783f;
 // this must be positive. Transition zone goes that far below the values just specified.
 static const float TRANSITION_WIDTH_GEO_DEG=1.46f;
 static const float TRANSITION_WIDTH_APP_DEG=1.78217f;
+// Lowest apparent altitude for which Bennett's formula is used.
+static const float BENNETT_MIN_APP_ALTITUDE_DEG=0.22879f;
+// Below these sines of altitude, both refraction directions leave the vectors unchanged.
+static const float REFRACTION_TABLE_MIN_SIN_GEO=std::sin((MIN_GEO_ALTITUDE_DEG-TRANSITION_WIDTH_GEO_DEG)*M_PI/180.);
+static const float REFRACTION_TABLE_MIN_SIN_APP=std::sin((MIN_APP_ALTITUDE_DEG-TRANSITION_WIDTH_APP_DEG)*M_PI/180.);
 
 Refraction::Refraction() : pressure(1013.f), temperature(10.f),
 	preTransfoMat(Mat4d::identity()), invertPreTransfoMat(Mat4d::identity()), preTransfoMatf(Mat4f::identity()), invertPreTransfoMatf(Mat4f::identity()),
@@ -105,6 +155,70 @@ void Refraction::setPostTransfoMat(const Mat4d& m)
 void Refraction::updatePrecomputed()
 {
 	press_temp_corr=pressure/1010.f * 283.f/(273.f+temperature) / 60.f;
+
+	// Tabulate the exact double precision computations for the single precision versions.
+	// Each table covers one formula, so that no interpolation is done across the joints of the formulae.
+	auto makeTable = [this](double minAltDeg, double maxAltDeg, int size, void (Refraction::*refract)(Vec3d&) const)
+	{
+		RefractionTable table;
+		table.minSin=std::sin(minAltDeg*M_PI/180.);
+		table.maxSin=std::sin(maxAltDeg*M_PI/180.);
+		table.scale=(size-1)/(table.maxSin-table.minSin);
+		table.entries.resize(size);
+		for (int i=0; i<size; ++i)
+		{
+			const double sinAlt=table.minSin + (table.maxSin-table.minSin)*i/(size-1);
+			const double cosAlt=std::sqrt(std::max(0., 1.-sinAlt*sinAlt));
+			Vec3d v(cosAlt, 0., sinAlt);
+			(this->*refract)(v);
+			table.entries[i].set(v[2], cosAlt>0. ? v[0]/cosAlt : 1.);
+		}
+		return table;
+	};
+	forwardTables.clear();
+	forwardTables << makeTable(MIN_GEO_ALTITUDE_DEG, 90., REFRACTION_TABLE_SIZE, &Refraction::innerRefractionForward);
+	backwardTables.clear();
+	backwardTables << makeTable(BENNETT_MIN_APP_ALTITUDE_DEG, 90., REFRACTION_TABLE_SIZE, &Refraction::innerRefractionBackward);
+	backwardTables << makeTable(MIN_APP_ALTITUDE_DEG, BENNETT_MIN_APP_ALTITUDE_DEG, REFRACTION_TABLE_SIZE/4, &Refraction::innerRefractionBackward);
+}
+
+void Refraction::tableRefraction(Vec3f& altAzPos, const QVector<RefractionTable>& tables, float minSin, void (Refraction::*refract)(Vec3d&) const) const
+{
+	const float length = altAzPos.length();
+	if (length==0.f)
+		return;
+	const float sinAlt = std::min(altAzPos[2]/length, 1.f);
+	if (sinAlt<=minSin)
+		return;
+	for (const auto& table : tables)
+	{
+		if (sinAlt<table.minSin || sinAlt>table.maxSin)
+			continue;
+		const float t=(sinAlt-table.minSin)*table.scale;
+		const int i=std::min(static_cast<int>(t), table.entries.size()-2);
+		const float f=t-i;
+		const Vec2f& a=table.entries.at(i);
+		const Vec2f& b=table.entries.at(i+1);
+		const float xyFactor=a[1]+(b[1]-a[1])*f;
+		altAzPos[0]*=xyFactor;
+		altAzPos[1]*=xyFactor;
+		altAzPos[2]=(a[0]+(b[0]-a[0])*f)*length;
+		return;
+	}
+	// The narrow transition zones below the tables are computed exactly
+	Vec3d v(altAzPos[0], altAzPos[1], altAzPos[2]);
+	(this->*refract)(v);
+	altAzPos.set(v[0], v[1], v[2]);
+}
+
+void Refraction::tableRefractionForward(Vec3f& altAzPos) const
+{
+	tableRefraction(altAzPos, forwardTables, REFRACTION_TABLE_MIN_SIN_GEO, &Refraction::innerRefractionForward);
+}
+
+void Refraction::tableRefractionBackward(Vec3f& altAzPos) const
+{
+	tableRefraction(altAzPos, backwardTables, REFRACTION_TABLE_MIN_SIN_APP, &Refraction::innerRefractionBackward);
 }
 
 void Refraction::innerRefractionForward(Vec3d& altAzPos) const
@@ -165,7 +279,7 @@ void Refraction::innerRefractionBackward(Vec3d& altAzPos) const
 	const double sinObs = altAzPos[2]/length;
 	Q_ASSERT(fabs(sinObs)<=1.0);
 	float obs_alt_deg=180./M_PI*std::asin(sinObs);
-	if (obs_alt_deg > 0.22879f)
+	if (obs_alt_deg > BENNETT_MIN_APP_ALTITUDE_DEG)
 	{
 		// refraction from Bennett, in Meeus, Astr.Alg.
 		float r=press_temp_corr * (1.f / std::tan((obs_alt_deg+7.31f/(obs_alt_deg+4.4f))*M_PI/180.f) + 0.0013515f);
@@ -216,24 +330,38 @@ void Refraction::backward(Vec3d& altAzPos) const
 	altAzPos.transfo4d(invertPreTransfoMat);
 }
 
+// The pretransform matrix is applied in double precision: it may contain large translations, e.g. from heliocentric frames.
 void Refraction::forward(Vec3f& altAzPos) const
 {
 	Vec3d vf(altAzPos[0], altAzPos[1], altAzPos[2]);
 	vf.transfo4d(preTransfoMat);
-	innerRefractionForward(vf);
-	vf.transfo4d(postTransfoMat);
 	altAzPos.set(vf[0], vf[1], vf[2]);
+	tableRefractionForward(altAzPos);
+	altAzPos.transfo4d(postTransfoMatf);
 }
 
 void Refraction::backward(Vec3f& altAzPos) const
 {
 	altAzPos.transfo4d(invertPostTransfoMatf);
-	Vec3d vf(altAzPos[0], altAzPos[1], altAzPos[2]);
-	innerRefractionBackward(vf);
-	altAzPos.set(vf[0], vf[1], vf[2]);
+	tableRefractionBackward(altAzPos);
 	altAzPos.transfo4d(invertPreTransfoMatf);
 }
 
+void Refraction::forwardBatch(Vec3f* v, int n) const
+{
+	// Separate passes, so that each loop stays simple enough to be vectorized
+	for (int i=0; i<n; ++i)
+	{
+		Vec3d vf(v[i][0], v[i][1], v[i][2]);
+		vf.transfo4d(preTransfoMat);
+		v[i].set(vf[0], vf[1], vf[2]);
+	}
+	for (int i=0; i<n; ++i)
+		tableRefractionForward(v[i]);
+	for (int i=0; i<n; ++i)
+		v[i].transfo4d(postTransfoMatf);
+}
+
 void Refraction::setPressure(float p)
 {
 	pressure=p;
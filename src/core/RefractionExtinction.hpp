@@ -31,6 +31,8 @@
 #include "VecMath.hpp"
 #include "StelProjector.hpp"
 
+#include <QVector>
+
 //! @class Extinction
 //! This class performs extinction computations, following literature from atmospheric optics and astronomy.
 //! Airmass computations are limited to meaningful altitudes.
@@ -61,27 +63,32 @@ public:
 	void forward(const Vec3d& altAzPos, float* mag) const
 	{
 		Q_ASSERT(std::fabs(altAzPos.length()-1.f)<0.001f);
-		*mag += airmass(altAzPos[2], false) * ext_coeff;
+		*mag += geometricAirmass(altAzPos[2]) * ext_coeff;
 	}
 	
 	void forward(const Vec3f& altAzPos, float* mag) const
 	{
 		Q_ASSERT(std::fabs(altAzPos.length()-1.f)<0.001f);
-		*mag += airmass(altAzPos[2], false) * ext_coeff;
+		*mag += geometricAirmass(altAzPos[2]) * ext_coeff;
 	}
 
 	//! Compute inverse extinction effect for given position vector and magnitude.
 	//! @param altAzPos is the NORMALIZED (!!) (geometrical) star position vector, and its z component is therefore sin(geometric_altitude).
 	//! This call must therefore be done after application of Refraction effects if atmospheric effects are on.
 	//! Note that forward/backward are no absolute reverse operations!
+	//! Add extinction effect to the magnitudes of n objects.
+	//! @param altAzPos the n normalized positions in horizontal coordinates (actually only Z coordinate is needed).
+	//! @param mag the n magnitudes, which are increased by the extinction.
+	void forward(const Vec3f* altAzPos, float* mag, int n) const;
+
 	void backward(const Vec3d& altAzPos, float* mag) const
 	{
-		*mag -= airmass(altAzPos[2], false) * ext_coeff;
+		*mag -= geometricAirmass(altAzPos[2]) * ext_coeff;
 	}
 	
 	void backward(const Vec3f& altAzPos, float* mag) const
 	{
-		*mag -= airmass(altAzPos[2], false) * ext_coeff;
+		*mag -= geometricAirmass(altAzPos[2]) * ext_coeff;
 	}
 
 	//! Set visual extinction coefficient (mag/airmass), influences extinction computation.
@@ -101,7 +108,13 @@ public:
 	//! Rozenberg is infinite at Z=92.17 deg, Young at Z=93.6 deg, so this function RETURNS SUBHORIZONTAL_AIRMASS BELOW -2 DEGREES!
 	float airmass(float cosZ, const bool apparent_z=true) const;
 
+	//! Same as airmass(cosZ, false), interpolated in a table computed once.
+	float geometricAirmass(float cosZ) const;
+
 private:
+	//! Airmass for a geometrical altitude, following Young (1994).
+	static float youngAirmass(float cosZ);
+
 	//! k, magnitudes/airmass, in [0.00, ... 1.00], (default 0.20).
 	float ext_coeff;
 
@@ -137,13 +150,18 @@ public:
 	//! Apply refraction.
 	//! @param altAzPos is the geometrical star position vector, to be transformed into apparent position.
 	//! Note that forward/backward are no absolute reverse operations!
+	//! This single precision version interpolates the refraction in tables computed for the current pressure and temperature.
 	void forward(Vec3f& altAzPos) const;
 
 	//! Remove refraction from position ("reduce").
 	//! @param altAzPos is the apparent star position vector, to be transformed into geometrical position.
 	//! Note that forward/backward are no absolute reverse operations!
+	//! This single precision version interpolates the refraction in tables computed for the current pressure and temperature.
 	void backward(Vec3f& altAzPos) const;
 
+	//! Apply forward() in place to an array of n vectors.
+	void forwardBatch(Vec3f* v, int n) const;
+
 	void combine(const Mat4d& m)
 	{
 		setPreTransfoMat(preTransfoMat*m);
@@ -151,7 +169,7 @@ public:
 
 	Mat4d getApproximateLinearTransfo() const {return postTransfoMat*preTransfoMat;}
 
-	StelProjector::ModelViewTranformP clone() const {Refraction* refr = new Refraction(); *refr=*this; return StelProjector::ModelViewTranformP(refr);}
+	StelProjector::ModelViewTranformP clone() const {return StelProjector::ModelViewTranformP(new Refraction(*this));}
 
 	//! Set surface air pressure (mbars), influences refraction computation.
 	void setPressure(float p_mbar);
@@ -166,11 +184,25 @@ public:
 	void setPostTransfoMat(const Mat4d& m);
 
 private:
+	//! Table of refraction interpolated linearly in the sine of the altitude.
+	//! Each entry contains the sine of the corrected altitude, and the factor to apply to the X and Y components.
+	struct RefractionTable
+	{
+		float minSin;
+		float maxSin;
+		float scale;	// number of entries per unit of sine
+		QVector<Vec2f> entries;
+	};
+
 	//! Update precomputed variables.
 	void updatePrecomputed();
 
 	void innerRefractionForward(Vec3d& altAzPos) const;
 	void innerRefractionBackward(Vec3d& altAzPos) const;
+	//! Same as innerRefractionForward() and innerRefractionBackward(), interpolated in the tables.
+	void tableRefractionForward(Vec3f& altAzPos) const;
+	void tableRefractionBackward(Vec3f& altAzPos) const;
+	void tableRefraction(Vec3f& altAzPos, const QVector<RefractionTable>& tables, float minSin, void (Refraction::*refract)(Vec3d&) const) const;
 	
 	//! These 3 Atmosphere parameters can be controlled by GUI.
 	//! Pressure[mbar] (1013)
@@ -180,6 +212,10 @@ private:
 	//! Correction factor for refraction formula, to be cached for speed.
 	float press_temp_corr;
 
+	//! Refraction tables for the current pressure and temperature, one for each formula used above the transition zones.
+	QVector<RefractionTable> forwardTables;
+	QVector<RefractionTable> backwardTables;
+
 	//! Used to pretransform coordinates into AltAz frame.
 	Mat4d preTransfoMat;
 	Mat4d invertPreTransfoMat;
@@ -16,19 +16,27 @@
  * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
  */
 
+
 #include "SimbadSearcher.hpp"
 
+#include "StelApp.hpp"
+#include "StelFileCache.hpp"
+#include "StelFileMgr.hpp"
 #include "StelUtils.hpp"
 #include "StelTranslator.hpp"
+#include <QBuffer>
 #include <QNetworkReply>
 #include <QNetworkAccessManager>
 #include <QDebug>
+#include <QScopedPointer>
+#include <QSettings>
 #include <QTimer>
 
-SimbadLookupReply::SimbadLookupReply(const QString& aurl, QNetworkAccessManager* anetMgr, int delayMs)
+SimbadLookupReply::SimbadLookupReply(const QString& aurl, SimbadSearcher* asearcher, int delayMs, const QStringList& abatchNames)
 	: url(aurl)
+	, batchNames(abatchNames)
 	, reply(Q_NULLPTR)
-	, netMgr(anetMgr)
+	, searcher(asearcher)
 	, currentStatus(SimbadLookupQuerying)
 {
 	if(delayMs <= 0)
@@ -50,6 +58,8 @@ SimbadLookupReply::~SimbadLookupReply()
 		reply->deleteLater();
 		reply = Q_NULLPTR;
 	}
+	if (searcher && searcher->pendingReplies.value(url)==this)
+		searcher->pendingReplies.remove(url);
 }
 
 //This is provided for the correct deletion of the reply in the RemoteControl plugin
@@ -66,83 +76,181 @@ void SimbadLookupReply::deleteNetworkReply()
 
 void SimbadLookupReply::delayTimerCompleted()
 {
-	reply = netMgr->get(QNetworkRequest(url));
+	if (!searcher)
+	{
+		// The searcher was deleted during the delay
+		errorString = q_("Network error");
+		finish(SimbadLookupErrorOccured);
+		return;
+	}
+
+	StelFileCache* cache = SimbadSearcher::getCache();
+	if (cache && cache->contains(url))
+	{
+		// The status must change after the caller got the reply
+		QTimer::singleShot(0, this, SLOT(cachedQueryFinished()));
+		return;
+	}
+
+	SimbadLookupReply* pending = searcher->pendingReplies.value(url);
+	if (pending && pending!=this)
+	{
+		leader = pending;
+		connect(pending, SIGNAL(statusChanged()), this, SLOT(leaderFinished()));
+		connect(pending, SIGNAL(destroyed()), this, SLOT(leaderDestroyed()));
+		return;
+	}
+	startQuery();
+}
+
+void SimbadLookupReply::startQuery()
+{
+	leader = Q_NULLPTR;
+	if (!searcher)
+	{
+		errorString = q_("Network error");
+		finish(SimbadLookupErrorOccured);
+		return;
+	}
+	searcher->pendingReplies.insert(url, this);
+	reply = searcher->networkMgr->get(QNetworkRequest(url));
 	connect(reply, SIGNAL(finished()), this, SLOT(httpQueryFinished()));
 }
 
+void SimbadLookupReply::finish(SimbadLookupStatus status)
+{
+	if (searcher && searcher->pendingReplies.value(url)==this)
+		searcher->pendingReplies.remove(url);
+	currentStatus = status;
+	emit statusChanged();
+}
+
 void SimbadLookupReply::httpQueryFinished()
 {
 	if (reply->error()!=QNetworkReply::NoError || reply->bytesAvailable()==0)
 	{
-		currentStatus = SimbadLookupErrorOccured;
 		errorString = QString("%1: %2").arg(q_("Network error")).arg(reply->errorString());
-		emit statusChanged();
+		finish(SimbadLookupErrorOccured);
 		return;
 	}
 
 	// No error, try to parse the Simbad result
-	QByteArray line;
-	bool found = false;
-	//qDebug() << reply->readAll();
 	if (!reply->isSequential())
 		reply->reset();
-	while (!reply->atEnd())
+	const QByteArray data = reply->readAll();
+	if (!parseResponse(data))
+	{
+		finish(SimbadLookupErrorOccured);
+		return;
+	}
+	StelFileCache* cache = SimbadSearcher::getCache();
+	if (cache)
+		cache->write(url, data);
+	finish(SimbadLookupFinished);
+}
+
+void SimbadLookupReply::cachedQueryFinished()
+{
+	StelFileCache* cache = SimbadSearcher::getCache();
+	const QByteArray data = cache->read(url);
+	if (data.isEmpty())
 	{
-		line = reply->readLine();
+		// Removed from the cache meanwhile
+		delayTimerCompleted();
+		return;
+	}
+	finish(parseResponse(data) ? SimbadLookupFinished : SimbadLookupErrorOccured);
+}
+
+void SimbadLookupReply::leaderFinished()
+{
+	if (leader)
+	{
+		resultPositions = leader->resultPositions;
+		errorString = leader->errorString;
+		finish(leader->currentStatus);
+		leader = Q_NULLPTR;
+	}
+	else
+		finish(SimbadLookupErrorOccured);
+}
+
+void SimbadLookupReply::leaderDestroyed()
+{
+	if (currentStatus==SimbadLookupQuerying && !reply)
+		startQuery();
+}
+
+bool SimbadLookupReply::parseResponse(const QByteArray& data)
+{
+	QBuffer buffer;
+	buffer.setData(data);
+	buffer.open(QIODevice::ReadOnly);
+
+	QByteArray line;
+	bool found = false;
+	while (!buffer.atEnd())
+	{
+		line = buffer.readLine();
 		if (line.startsWith("::data"))
 		{
 			found = true;
-			line = reply->readLine();	// Discard first header line
+			line = buffer.readLine();	// Discard first header line
 			break;
 		}
 	}
-	if (found)
+	if (!found)
+		return true;
+
+	// The index in batchNames of the name whose results follow, see SimbadSearcher::lookupBatch()
+	int batchIndex = -1;
+	while (!buffer.atEnd())
 	{
-		line = reply->readLine();
+		line = buffer.readLine();
 		line.chop(1); // Remove a line break at the end
-		while (!line.isEmpty())
+		if (line.isEmpty())
+		{
+			// The queries of a batch are separated by empty lines
+			if (batchNames.isEmpty())
+				break;
+			continue;
+		}
+		if (line.startsWith("::"))
+			break;
+		if (line.startsWith("@@"))
+		{
+			batchIndex = line.mid(2).toInt();
+			continue;
+		}
+		if (line=="No Coord.")
+		{
+			buffer.readLine();
+			continue;
+		}
+		QList<QByteArray> l = line.split(' ');
+		bool ok1 = false, ok2 = false;
+		double ra = 0., dec = 0.;
+		if (l.size()==2)
+		{
+			ra = l[0].toDouble(&ok1)*M_PI/180.;
+			dec = l[1].toDouble(&ok2)*M_PI/180.;
+		}
+		if (ok1==false || ok2==false)
 		{
-			if (line=="No Coord.")
-			{
-				reply->readLine();
-				line = reply->readLine();
-				line.chop(1); // Remove a line break at the end
-				continue;
-			}
-			QList<QByteArray> l = line.split(' ');
-			if (l.size()!=2)
-			{
-				currentStatus = SimbadLookupErrorOccured;
-				errorString = q_("Error parsing position");
-				emit statusChanged();
-				return;
-			}
-			else
-			{
-				bool ok1, ok2;
-				const double ra = l[0].toDouble(&ok1)*M_PI/180.;
-				const double dec = l[1].toDouble(&ok2)*M_PI/180.;
-				if (ok1==false || ok2==false)
-				{
-					currentStatus = SimbadLookupErrorOccured;
-					errorString = q_("Error parsing position");
-					emit statusChanged();
-					return;
-				}
-				Vec3d v;
-				StelUtils::spheToRect(ra, dec, v);
-				line = reply->readLine();
-				line.chop(1); // Remove a line break at the end
-				line.replace("NAME " ,"");				
-				resultPositions[line.simplified()]=v; // Remove an extra spaces
-			}
-			line = reply->readLine();
-			line.chop(1); // Remove a line break at the end
+			errorString = q_("Error parsing position");
+			return false;
 		}
+		Vec3d v;
+		StelUtils::spheToRect(ra, dec, v);
+		line = buffer.readLine();
+		line.chop(1); // Remove a line break at the end
+		line.replace("NAME " ,"");
+		if (batchNames.isEmpty())
+			resultPositions[line.simplified()]=v; // Remove an extra spaces
+		else if (batchIndex>=0 && batchIndex<batchNames.size())
+			resultPositions[batchNames.at(batchIndex)]=v;
 	}
-
-	currentStatus = SimbadLookupFinished;
-	emit statusChanged();
+	return true;
 }
 
 // Get a I18n string describing the current status.
@@ -163,6 +271,24 @@ QString SimbadLookupReply::getCurrentStatusString() const
 SimbadSearcher::SimbadSearcher(QObject* parent) : QObject(parent)
 {
 	networkMgr = new QNetworkAccessManager(this);
+	// Open the cache from the thread of the first searcher, usually the main one
+	getCache();
+}
+
+StelFileCache* SimbadSearcher::getCache()
+{
+	struct CacheHolder
+	{
+		CacheHolder()
+		{
+			const int cacheSizeMB = StelApp::getInstance().getSettings()->value("search/simbad_cache_size_mb", 4).toInt();
+			if (cacheSizeMB > 0)
+				cache.reset(new StelFileCache(StelFileMgr::getCacheDir() + "/simbad", ".txt", static_cast<qint64>(cacheSizeMB)*1024*1024, true));
+		}
+		QScopedPointer<StelFileCache> cache;
+	};
+	static CacheHolder holder;
+	return holder.cache.data();
 }
 
 // Lookup in Simbad for the passed object name.
@@ -177,5 +303,20 @@ SimbadLookupReply* SimbadSearcher::lookup(const QString& serverUrl, const QStrin
 
 	url += "simbad/sim-script?script=";
 	url += ba.constData();
-	return new SimbadLookupReply(url, networkMgr, delayMs);
+	return new SimbadLookupReply(url, this, delayMs);
+}
+
+SimbadLookupReply* SimbadSearcher::lookupBatch(const QString& serverUrl, const QStringList& objectNames, int delayMs)
+{
+	// One query per name, each preceded by its index in the data of the response
+	QString url(serverUrl);
+	QString query = "format object \"%COO(d;A D)\\n%IDLIST(1)\"\n";
+	query += "set epoch J2000\nset limit 1\n";
+	for (int i=0;i<objectNames.size();++i)
+		query += QString("echodata @@%1\nquery id %2\n").arg(i).arg(objectNames.at(i));
+	QByteArray ba = QUrl::toPercentEncoding(query, "", "");
+
+	url += "simbad/sim-script?script=";
+	url += ba.constData();
+	return new SimbadLookupReply(url, this, delayMs, objectNames);
 }
@@ -20,11 +20,16 @@
 #define SIMBADSEARCHER_HPP
 
 #include "VecMath.hpp"
+#include <QHash>
 #include <QObject>
 #include <QMap>
+#include <QPointer>
+#include <QStringList>
 
 class QNetworkReply;
 class QNetworkAccessManager;
+class SimbadSearcher;
+class StelFileCache;
 
 //! @class SimbadLookupReply
 //! Contains all the information about a current simbad lookup query.
@@ -48,6 +53,7 @@ public:
 	~SimbadLookupReply();
 
 	//! Get the result list of matching objectName/position.
+	//! For SimbadSearcher::lookupBatch(), the names are the looked up names which were found.
 	QMap<QString, Vec3d> getResults() const {return resultPositions;}
 
 	//! Get the current status.
@@ -69,16 +75,34 @@ signals:
 private slots:
 	void httpQueryFinished();
 	void delayTimerCompleted();
+	//! Parse the cached response of the query.
+	void cachedQueryFinished();
+	//! Take the results of the identical query which this reply waits for.
+	void leaderFinished();
+	//! The identical query was deleted before it finished, send this one.
+	void leaderDestroyed();
 
 private:
 	//! Private constructor can be called by SimbadSearcher only.
-	SimbadLookupReply(const QString& url, QNetworkAccessManager* mgr, int delayMs=500);
+	//! @param batchNames the names of a batch query, see SimbadSearcher::lookupBatch()
+	SimbadLookupReply(const QString& url, SimbadSearcher* searcher, int delayMs=500, const QStringList& batchNames=QStringList());
+
+	//! Send the query to the server.
+	void startQuery();
+	//! Parse a response of SIMBAD into resultPositions.
+	//! @return false if the response can't be parsed, with errorString set
+	bool parseResponse(const QByteArray& data);
+	//! Set the final status and emit statusChanged().
+	void finish(SimbadLookupStatus status);
 
 	QString url;
+	QStringList batchNames;
 
 	//! The reply used internally.
 	QNetworkReply* reply;
-	QNetworkAccessManager* netMgr;
+	QPointer<SimbadSearcher> searcher;
+	//! The identical query whose results are taken, see SimbadSearcher::pendingReplies
+	QPointer<SimbadLookupReply> leader;
 
 	//! The list of resulting objectNames/Position in ICRS.
 	QMap<QString, Vec3d> resultPositions;
@@ -94,10 +118,15 @@ private:
 //! @class SimbadSearcher
 //! Provides lookup features into the online Simbad service from CDS.
 //! See http://simbad.u-strasbg.fr for more info.
+//! The responses are kept in a disk cache shared by all searchers, bounded by search/simbad_cache_size_mb
+//! (default 4 MB, 0 disables it), so that repeated lookups do not query the server again, even in the
+//! next sessions. The lookups which send the same query as an unfinished lookup of the same searcher wait
+//! for its response instead of sending their own.
 class SimbadSearcher : public QObject
 {
 	Q_OBJECT
 
+	friend class SimbadLookupReply;
 public:
 	SimbadSearcher(QObject* parent = Q_NULLPTR);
 
@@ -110,9 +139,22 @@ public:
 	//! @return a new SimbadLookupReply which is owned by the caller.
 	SimbadLookupReply* lookup(const QString& serverUrl, const QString& objectName, int maxNbResult=1, int delayMs=500);
 
+	//! Lookup the positions of several objects in a single query of Simbad.
+	//! @param serverUrl URL of the SIMBAD mirror server.
+	//! @param objectNames the complete object names.
+	//! @param delayMs a delay in ms to wait for before actually triggering the lookup.
+	//! @return a new SimbadLookupReply which is owned by the caller. Its results are the position of
+	//! each name which was found, by name.
+	SimbadLookupReply* lookupBatch(const QString& serverUrl, const QStringList& objectNames, int delayMs=0);
+
 private:
+	//! Get the cache of the responses shared by the searchers, or Q_NULLPTR if it is disabled.
+	static StelFileCache* getCache();
+
 	//! The network manager used query simbad
 	QNetworkAccessManager* networkMgr;
+	//! The replies waiting for a response of the server, by URL
+	QHash<QString, SimbadLookupReply*> pendingReplies;
 };
 
 #endif /*SIMBADSEARCHER_HPP*/
@@ -20,6 +20,7 @@
 #include "StelActionMgr.hpp"
 #include "StelTranslator.hpp"
 #include "StelApp.hpp"
+#include "StelModuleMgr.hpp"
 
 #include <QVariant>
 #include <QDebug>
@@ -211,7 +212,11 @@ StelAction* StelActionMgr::addAction(const QString& id, const QString& groupId,
 
 StelAction* StelActionMgr::findAction(const QString& id)
 {
-	return findChild<StelAction*>(id);
+	StelAction* action = findChild<StelAction*>(id);
+	// The actions of the plugins loaded on demand are placeholders until the plugin is initialized
+	if (action && StelApp::getInstance().getModuleMgr().activatePluginOfAction(action))
+		action = findChild<StelAction*>(id);
+	return action;
 }
 
 bool StelActionMgr::pushKey(int key, bool global)
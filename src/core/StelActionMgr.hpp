@@ -70,7 +70,11 @@ public:
 	QString getGroup() const {return group;}
 	const QKeySequence getShortcut() const {return keySequence;}
 	const QKeySequence getAltShortcut() const {return altKeySequence;}
+	const QKeySequence getDefaultShortcut() const {return defaultKeySequence;}
+	const QKeySequence getDefaultAltShortcut() const {return defaultAltKeySequence;}
 	QString getText() const;
+	//! The text before translation
+	QString getUntranslatedText() const {return text;}
 	void setText(const QString& value) {text = value; emit changed();}
 signals:
 	//! Emitted when the boolean state of this StelAction changes.
@@ -23,6 +23,7 @@
 #include "StelMainView.hpp"
 #include "StelUtils.hpp"
 #include "StelTextureMgr.hpp"
+#include "StelJobMgr.hpp"
 #include "StelObjectMgr.hpp"
 #include "ConstellationMgr.hpp"
 #include "AsterismMgr.hpp"
@@ -55,6 +56,12 @@
 #include "StelAudioMgr.hpp"
 #include "StelVideoMgr.hpp"
 #include "StelViewportEffect.hpp"
+#include "StelQualityGovernor.hpp"
+#include "StelFrameGrabber.hpp"
+#include "StelCubeMapRenderer.hpp"
+#include "StelFrameProfiler.hpp"
+#include "StelPerformanceMetrics.hpp"
+#include "StelStartupTrace.hpp"
 #include "StelGuiBase.hpp"
 #include "StelPainter.hpp"
 #ifndef DISABLE_SCRIPTING
@@ -85,10 +92,18 @@
 #include <QGuiApplication>
 #include <QScreen>
 #include <QDateTime>
+#include <QtConcurrent>
 #ifdef ENABLE_SPOUT
 #include <QMessageBox>
 #include "SpoutSender.hpp"
 #endif
+#ifdef ENABLE_DMABUF
+#include "DmaBufSender.hpp"
+#endif
+
+#ifndef GL_RGBA16F
+#define GL_RGBA16F 0x881A
+#endif
 
 #ifdef USE_STATIC_PLUGIN_HELLOSTELMODULE
 Q_IMPORT_PLUGIN(HelloStelModuleStelPluginInterface)
@@ -218,6 +233,7 @@ StelApp::StelApp(StelMainView *parent)
 	, actionMgr(Q_NULLPTR)
 	, propMgr(Q_NULLPTR)
 	, textureMgr(Q_NULLPTR)
+	, jobMgr(Q_NULLPTR)
 	, stelObjectMgr(Q_NULLPTR)
 	, planetLocationMgr(Q_NULLPTR)
 	, networkAccessManager(Q_NULLPTR)
@@ -237,6 +253,7 @@ StelApp::StelApp(StelMainView *parent)
 	, flagNightVision(false)
 	, confSettings(Q_NULLPTR)
 	, initialized(false)
+	, headless(false)
 	, saveProjW(-1)
 	, saveProjH(-1)
 	, nbDownloadedFiles(0)
@@ -246,14 +263,27 @@ StelApp::StelApp(StelMainView *parent)
 	, screenFontSize(13)
 	, renderBuffer(Q_NULLPTR)
 	, viewportEffect(Q_NULLPTR)
+	, renderScale(1.f)
+	, qualityGovernor(Q_NULLPTR)
+	, frameGrabber(Q_NULLPTR)
+	, cubeMapRenderer(Q_NULLPTR)
+	, flagCubeMapFisheye(false)
+	, frameProfiler(Q_NULLPTR)
+	, performanceMetrics(Q_NULLPTR)
 	, gl(Q_NULLPTR)
 	, flagShowDecimalDegrees(false)
 	, flagUseAzimuthFromSouth(false)
 	, flagUseFormattingOutput(false)
 	, flagUseCCSDesignation(false)
+	, flagPipelinedUpdate(false)
+	, lastDeltaTime(0.)
+	, deltaTimeOverride(-1.)
 	#ifdef ENABLE_SPOUT
 	, spoutSender(Q_NULLPTR)
 	#endif
+	#ifdef ENABLE_DMABUF
+	, dmaBufSender(Q_NULLPTR)
+	#endif
 	, currentFbo(0)
 {
 	setObjectName("StelApp");
@@ -292,12 +322,14 @@ StelApp::~StelApp()
 	delete localeMgr; localeMgr=Q_NULLPTR;
 	delete audioMgr; audioMgr=Q_NULLPTR;
 	delete videoMgr; videoMgr=Q_NULLPTR;
+	delete qualityGovernor; qualityGovernor=Q_NULLPTR;
 	delete stelObjectMgr; stelObjectMgr=Q_NULLPTR; // Delete the module by hand afterward
 	delete textureMgr; textureMgr=Q_NULLPTR;
 	delete planetLocationMgr; planetLocationMgr=Q_NULLPTR;
 	delete moduleMgr; moduleMgr=Q_NULLPTR; // Delete the secondary instance
 	delete actionMgr; actionMgr = Q_NULLPTR;
 	delete propMgr; propMgr = Q_NULLPTR;
+	delete jobMgr; jobMgr = Q_NULLPTR; // Waits for the jobs still running
 
 	Q_ASSERT(singleton);
 	singleton = Q_NULLPTR;
@@ -405,6 +437,7 @@ QStringList StelApp::getCommandlineArguments()
 
 void StelApp::init(QSettings* conf)
 {
+	StelStartupTrace::Scope trace("startup", "StelApp::init");
 	gl = QOpenGLContext::currentContext()->functions();
 	confSettings = conf;
 
@@ -420,6 +453,7 @@ void StelApp::init(QSettings* conf)
 		core->windowHasBeenResized(0, 0, saveProjW, saveProjH);
 
 	// Initialize AFTER creation of openGL context
+	jobMgr = new StelJobMgr();
 	textureMgr = new StelTextureMgr();
 
 	networkAccessManager = new QNetworkAccessManager(this);
@@ -449,59 +483,65 @@ void StelApp::init(QSettings* conf)
 	// register non-modules for StelProperty tracking
 	propMgr->registerObject(this);
 	propMgr->registerObject(mainWin);
+	propMgr->loadRateLimits(confSettings);
+
+	// Draw the first frames with the bright stars while the deeper catalogs are loaded in the background
+	getModuleMgr().setFlagProgressiveInit(confSettings->value("main/flag_progressive_init", false).toBool());
+	getModuleMgr().loadTimeBudgets(confSettings);
 
 	// Stel Object Data Base manager
 	stelObjectMgr = new StelObjectMgr();
-	stelObjectMgr->init();
+	getModuleMgr().initModule(stelObjectMgr);
 	getModuleMgr().registerModule(stelObjectMgr);	
 
 	localeMgr->init();
 
 	// Hips surveys
 	HipsMgr* hipsMgr = new HipsMgr();
-	hipsMgr->init();
+	getModuleMgr().initModule(hipsMgr);
 	getModuleMgr().registerModule(hipsMgr);
 
 	// Init the solar system first
 	SolarSystem* ssystem = new SolarSystem();
-	ssystem->init();
+	getModuleMgr().initModule(ssystem);
 	getModuleMgr().registerModule(ssystem);
 
-	// Init the nomenclature for Solar system bodies
+	// Parse the nomenclature for Solar system bodies in the background while the next modules are initialized
 	NomenclatureMgr* nomenclature = new NomenclatureMgr();
-	nomenclature->init();
-	getModuleMgr().registerModule(nomenclature);
+	getModuleMgr().startInit(nomenclature);
 
 	// Load hipparcos stars & names
 	StarMgr* hip_stars = new StarMgr();
-	hip_stars->init();
+	getModuleMgr().initModule(hip_stars);
 	getModuleMgr().registerModule(hip_stars);
 
+	StelStartupTrace::Scope coreStep("startup", "StelCore::init");
 	core->init();
+	coreStep.end();
 
 	// Init nebulas
 	NebulaMgr* nebulas = new NebulaMgr();
-	nebulas->init();
+	getModuleMgr().initModule(nebulas);
 	getModuleMgr().registerModule(nebulas);
 
 	// Init milky way
 	MilkyWay* milky_way = new MilkyWay();
-	milky_way->init();
+	getModuleMgr().initModule(milky_way);
 	getModuleMgr().registerModule(milky_way);
 
 	// Init zodiacal light
 	ZodiacalLight* zodiacal_light = new ZodiacalLight();
-	zodiacal_light->init();
+	getModuleMgr().initModule(zodiacal_light);
 	getModuleMgr().registerModule(zodiacal_light);
 
 	// Init sky image manager
 	skyImageMgr = new StelSkyLayerMgr();
-	skyImageMgr->init();
+	getModuleMgr().initModule(skyImageMgr);
 	getModuleMgr().registerModule(skyImageMgr);
 
 	// Toast surveys
 	ToastMgr* toasts = new ToastMgr();
-	toasts->init();
+	getModuleMgr().initModule(toasts);
 	getModuleMgr().registerModule(toasts);
 
 	// Init audio manager
@@ -509,48 +549,53 @@ void StelApp::init(QSettings* conf)
 
 	// Init video manager
 	videoMgr = new StelVideoMgr();
-	videoMgr->init();
+	getModuleMgr().initModule(videoMgr);
 	getModuleMgr().registerModule(videoMgr);
 
 	// Constellations
 	ConstellationMgr* constellations = new ConstellationMgr(hip_stars);
-	constellations->init();
+	getModuleMgr().initModule(constellations);
 	getModuleMgr().registerModule(constellations);
 
 	// Asterisms
 	AsterismMgr* asterisms = new AsterismMgr(hip_stars);
-	asterisms->init();
+	getModuleMgr().initModule(asterisms);
 	getModuleMgr().registerModule(asterisms);
 
 	// Landscape, atmosphere & cardinal points section
 	LandscapeMgr* landscape = new LandscapeMgr();
-	landscape->init();
+	getModuleMgr().initModule(landscape);
 	getModuleMgr().registerModule(landscape);
 
 	GridLinesMgr* gridLines = new GridLinesMgr();
-	gridLines->init();
+	getModuleMgr().initModule(gridLines);
 	getModuleMgr().registerModule(gridLines);
 
+	getModuleMgr().initModule(nomenclature);
+	getModuleMgr().registerModule(nomenclature);
+
 	// Sporadic Meteors
 	SporadicMeteorMgr* meteors = new SporadicMeteorMgr(10, 72);
-	meteors->init();
+	getModuleMgr().initModule(meteors);
 	getModuleMgr().registerModule(meteors);
 
 	// User labels
 	LabelMgr* skyLabels = new LabelMgr();
-	skyLabels->init();
+	getModuleMgr().initModule(skyLabels);
 	getModuleMgr().registerModule(skyLabels);
 
+	StelStartupTrace::Scope skyCultureStep("startup", "StelSkyCultureMgr::init");
 	skyCultureMgr->init();
+	skyCultureStep.end();
 
 	// Init custom objects
 	CustomObjectMgr* custObj = new CustomObjectMgr();
-	custObj->init();
+	getModuleMgr().initModule(custObj);
 	getModuleMgr().registerModule(custObj);
 
 	// Init hightlights
 	HighlightMgr* hlMgr = new HighlightMgr();
-	hlMgr->init();
+	getModuleMgr().initModule(hlMgr);
 	getModuleMgr().registerModule(hlMgr);
 
 	//Create the script manager here, maybe some modules/plugins may want to connect to it
@@ -566,6 +611,17 @@ void StelApp::init(QSettings* conf)
 
 	// Enable viewport effect at startup if he set
 	setViewportEffect(confSettings->value("video/viewport_effect", "none").toString());
+	setRenderScale(confSettings->value("video/render_scale", 1.).toFloat());
+	qualityGovernor = new StelQualityGovernor();
+	qualityGovernor->init(confSettings);
+	frameGrabber = new StelFrameGrabber();
+	frameProfiler = new StelFrameProfiler();
+	frameProfiler->init(confSettings);
+	propMgr->registerObject(frameProfiler);
+	performanceMetrics = new StelPerformanceMetrics();
+	propMgr->registerObject(performanceMetrics);
+	setFlagPipelinedUpdate(confSettings->value("video/flag_pipelined_update", false).toBool());
+	setFlagCubeMapFisheye(confSettings->value("video/flag_cube_map_fisheye", false).toBool());
 
 	// Proxy Initialisation
 	setupNetworkProxy();
@@ -573,6 +629,8 @@ void StelApp::init(QSettings* conf)
 
 	// Init actions.
 	actionMgr->addAction("actionShow_Night_Mode", N_("Display Options"), N_("Night mode"), this, "nightMode", "Ctrl+N");
+	actionMgr->addAction("actionShow_Frame_Profiler", N_("Miscellaneous"), N_("Frame profiler (for development)"), frameProfiler, "overlayVisible", "Ctrl+Alt+F");
+	actionMgr->addAction("actionSave_Frame_Profile", N_("Miscellaneous"), N_("Save the frame profile (for development)"), frameProfiler, "exportChromeTrace()");
 
 	setFlagShowDecimalDegrees(confSettings->value("gui/flag_show_decimal_degrees", false).toBool());
 	setFlagSouthAzimuthUsage(confSettings->value("gui/flag_use_azimuth_from_south", false).toBool());
@@ -618,6 +676,76 @@ void StelApp::init(QSettings* conf)
 		qApp->setProperty("spout", "");
 	}
 #endif
+#ifdef ENABLE_DMABUF
+	const QString dmaBufName = qApp->property("dmabufName").toString();
+	if (!dmaBufName.isEmpty())
+	{
+		dmaBufSender = new DmaBufSender(dmaBufName);
+		if (dmaBufSender->isValid())
+		{
+			const StelProjector::StelProjectorParams& params = core->getCurrentStelProjectorParams();
+			dmaBufSender->resize(qRound(params.viewportXywh[2]*params.devicePixelsPerPixel), qRound(params.viewportXywh[3]*params.devicePixelsPerPixel));
+		}
+		else
+		{
+			qWarning() << "Cannot share the frames as DMA-BUF, see the log for details";
+			delete dmaBufSender;
+			dmaBufSender = Q_NULLPTR;
+		}
+	}
+#endif
+
+	initialized = true;
+}
+
+void StelApp::initHeadless(QSettings* conf)
+{
+	headless = true;
+	confSettings = conf;
+
+	core = new StelCore();
+	jobMgr = new StelJobMgr();
+	// Only used as cache of the file names, textures are never loaded without OpenGL context
+	textureMgr = new StelTextureMgr();
+
+	// Needed for the location from IP address at first start
+	networkAccessManager = new QNetworkAccessManager(this);
+	connect(networkAccessManager, SIGNAL(finished(QNetworkReply*)), this, SLOT(reportFileDownloadFinished(QNetworkReply*)));
+
+	propMgr = new StelPropertyMgr();
+	localeMgr = new StelLocaleMgr();
+	skyCultureMgr = new StelSkyCultureMgr();
+	propMgr->registerObject(skyCultureMgr);
+	planetLocationMgr = new StelLocationMgr();
+	actionMgr = new StelActionMgr();
+	propMgr->registerObject(this);
+	propMgr->loadRateLimits(confSettings);
+
+	stelObjectMgr = new StelObjectMgr();
+	getModuleMgr().initModule(stelObjectMgr);
+	getModuleMgr().registerModule(stelObjectMgr);
+
+	localeMgr->init();
+
+	SolarSystem* ssystem = new SolarSystem();
+	getModuleMgr().initModule(ssystem);
+	getModuleMgr().registerModule(ssystem);
+
+	StarMgr* hip_stars = new StarMgr();
+	getModuleMgr().initModule(hip_stars);
+	getModuleMgr().registerModule(hip_stars);
+
+	core->init();
+
+	NebulaMgr* nebulas = new NebulaMgr();
+	getModuleMgr().initModule(nebulas);
+	getModuleMgr().registerModule(nebulas);
+
+	skyCultureMgr->init();
+	updateI18n();
+
+	setFlagShowDecimalDegrees(confSettings->value("gui/flag_show_decimal_degrees", false).toBool());
+	setFlagSouthAzimuthUsage(confSettings->value("gui/flag_use_azimuth_from_south", false).toBool());
 
 	initialized = true;
 }
@@ -627,18 +755,29 @@ void StelApp::initPlugIns()
 {
 	// Load dynamically all the modules found in the modules/ directories
 	// which are configured to be loaded at startup
+	QList<QPair<QString, StelModule*> > plugins;
 	for (const auto& i : moduleMgr->getPluginsList())
 	{
 		if (i.loadAtStartup==false)
 			continue;
 		StelModule* m = moduleMgr->loadPlugin(i.info.id);
 		if (m!=Q_NULLPTR)
-		{
-			moduleMgr->registerModule(m, true);
-			//load extensions after the module is registered
-			moduleMgr->loadExtensions(i.info.id);
-			m->init();
-		}
+			plugins.append(qMakePair(i.info.id, m));
+	}
+	// Let the plugins load their data in parallel, then initialize them in the usual order.
+	// The plugins loaded on demand are only initialized on first use.
+	for (const auto& p : plugins)
+	{
+		if (!moduleMgr->deferPluginInit(p.first))
+			moduleMgr->startInit(p.second);
+	}
+	for (const auto& p : plugins)
+	{
+		moduleMgr->registerModule(p.second, true);
+		//load extensions after the module is registered
+		moduleMgr->loadExtensions(p.first);
+		if (!moduleMgr->isPluginPending(p.first))
+			moduleMgr->initPlugin(p.first);
 	}
 }
 
@@ -648,6 +787,10 @@ void StelApp::deinit()
 	delete spoutSender;
 	spoutSender = Q_NULLPTR;
 #endif
+#ifdef ENABLE_DMABUF
+	delete dmaBufSender;
+	dmaBufSender = Q_NULLPTR;
+#endif
 #ifndef DISABLE_SCRIPTING
 	if (scriptMgr->scriptIsRunning())
 		scriptMgr->stopScript();
@@ -655,6 +798,16 @@ void StelApp::deinit()
 	QCoreApplication::processEvents();
 	getModuleMgr().unloadAllPlugins();
 	QCoreApplication::processEvents();
+	// After the plugins, which may have viewers of it
+	delete frameGrabber;
+	frameGrabber = Q_NULLPTR;
+	delete cubeMapRenderer;
+	cubeMapRenderer = Q_NULLPTR;
+	// Its GPU queries are released while the GL context is current
+	delete frameProfiler;
+	frameProfiler = Q_NULLPTR;
+	delete performanceMetrics;
+	performanceMetrics = Q_NULLPTR;
 	StelPainter::deinitGLShaders();
 }
 
@@ -680,6 +833,7 @@ void StelApp::update(double deltaTime)
 	if (!initialized)
 		return;
 
+	frameProfiler->beginFrame();
 	++frame;
 	frameTimeAccum+=deltaTime;
 	if (frameTimeAccum > 1.)
@@ -689,18 +843,37 @@ void StelApp::update(double deltaTime)
 		frame = 0;
 		frameTimeAccum=0.;
 	}
-		
+
+	performanceMetrics->update(deltaTime);
+	if (deltaTimeOverride>=0.)
+		deltaTime = deltaTimeOverride;
+	lastDeltaTime = deltaTime;
+	textureMgr->update();
+	if (qualityGovernor)
+	{
+		qualityGovernor->setMemoryPressure(textureMgr->isOverMemoryBudget());
+		// Frames limited to the minimal frame rate on purpose do not measure the rendering time.
+		const StelMainView& view = StelMainView::getInstance();
+		qualityGovernor->update(deltaTime, !view.needsMaxFPS() && view.getMinFps() < qualityGovernor->getTargetFps());
+	}
+#ifndef DISABLE_SCRIPTING
+	// Cues of scripted shows take effect in this frame
+	scriptMgr->update(deltaTime);
+#endif
 	core->update(deltaTime);
 
 	moduleMgr->update();
 
-	// Send the event to every StelModule
-	for (auto* i : moduleMgr->getCallOrders(StelModule::ActionUpdate))
+	// Send the event to every StelModule which is not idle
+	moduleMgr->callActiveModules(StelModule::ActionUpdate, [deltaTime](StelModule* module)
 	{
-		i->update(deltaTime);
-	}
+		module->update(deltaTime);
+	});
 
 	stelObjectMgr->update(deltaTime);
+
+	// Report the property changes of this frame at once
+	propMgr->update();
 }
 
 void StelApp::prepareRenderBuffer()
@@ -709,9 +882,12 @@ void StelApp::prepareRenderBuffer()
 	if (!renderBuffer)
 	{
 		StelProjector::StelProjectorParams params = core->getCurrentStelProjectorParams();
-		int w = params.viewportXywh[2];
-		int h = params.viewportXywh[3];
-		renderBuffer = new QOpenGLFramebufferObject(w, h, QOpenGLFramebufferObject::Depth); // we only need depth here
+		int w = qRound(params.viewportXywh[2]*params.devicePixelsPerPixel);
+		int h = qRound(params.viewportXywh[3]*params.devicePixelsPerPixel);
+		if (viewportEffect->needsFloatBuffer())
+			renderBuffer = new QOpenGLFramebufferObject(w, h, QOpenGLFramebufferObject::Depth, GL_TEXTURE_2D, GL_RGBA16F);
+		else
+			renderBuffer = new QOpenGLFramebufferObject(w, h, QOpenGLFramebufferObject::Depth); // we only need depth here
 	}
 	renderBuffer->bind();
 }
@@ -739,21 +915,114 @@ void StelApp::draw()
 
 	core->preDraw();
 
-	const QList<StelModule*> modules = moduleMgr->getCallOrders(StelModule::ActionDraw);
-	for (auto* module : modules)
-	{
-		module->draw(core);
-	}
+	if (flagPipelinedUpdate)
+		startNextFramePreparation();
+
+	if (flagCubeMapFisheye && core->getCurrentProjectionType()==StelCore::ProjectionFisheye)
+		drawCubeMapFaces();
+	else
+		drawModules();
 	core->postDraw();
+	frameProfiler->endFrame();
+	frameProfiler->drawOverlay(core);
+	if (StelStartupTrace::isEnabled())
+		StelStartupTrace::frameDrawn(jobMgr->getPendingJobs()==0 && !moduleMgr->isLoadingDeferredData());
+	// Modules can be changed by events before the next frame.
+	nextFramePreparation.waitForFinished();
 #ifdef ENABLE_SPOUT
 	// At this point, the sky scene has been drawn, but no GUI panels.
 	if(spoutSender)
 		spoutSender->captureAndSendFrame(drawFbo);
 #endif
+#ifdef ENABLE_DMABUF
+	// Same point as Spout, from the framebuffer where the sky has been drawn
+	if (dmaBufSender)
+		dmaBufSender->captureAndSendFrame();
+#endif
+	if (frameGrabber->isActive())
+	{
+		GL(gl->glBindFramebuffer(GL_FRAMEBUFFER, currentFbo));
+		if (renderBuffer)
+			frameGrabber->capture(renderBuffer->width(), renderBuffer->height());
+		else
+		{
+			const StelProjector::StelProjectorParams params = core->getCurrentStelProjectorParams();
+			frameGrabber->capture(qRound(params.viewportXywh[2]*params.devicePixelsPerPixel), qRound(params.viewportXywh[3]*params.devicePixelsPerPixel));
+		}
+	}
 	applyRenderBuffer(drawFbo);
 
 }
 
+void StelApp::drawModules()
+{
+	moduleMgr->callActiveModules(StelModule::ActionDraw, [this](StelModule* module)
+	{
+		module->draw(core);
+		// Issue the draws batched and the labels queued by the module before the next one draws over them.
+		StelPainter::submitBatch();
+		StelPainter::submitText();
+	});
+}
+
+void StelApp::drawCubeMapFaces()
+{
+	if (!cubeMapRenderer)
+	{
+		cubeMapRenderer = new StelCubeMapRenderer();
+		cubeMapRenderer->setFaceSize(confSettings->value("video/cube_map_face_size", 0).toInt());
+	}
+	// The faces have the depth of the buffer of the viewport effect, e.g. half floats for the tone mapping
+	const GLenum textureFormat = renderBuffer ? renderBuffer->format().internalTextureFormat() : QOpenGLFramebufferObjectFormat().internalTextureFormat();
+	const quint32 targetFbo = currentFbo;
+	const int faceCount = cubeMapRenderer->beginFaces(core, textureFormat);
+	if (faceCount==0)
+	{
+		// The resampling shader is not available
+		cubeMapRenderer->endFaces(core);
+		drawModules();
+		return;
+	}
+	for (int i = 0; i < faceCount; ++i)
+	{
+		// Modules which draw in their own framebuffers bind the face again
+		currentFbo = cubeMapRenderer->beginFace(core, i);
+		core->preDraw();
+		// The sky draw rect is in the pixels of the viewport
+		core->suspendSkyDrawRect();
+		drawModules();
+	}
+	currentFbo = targetFbo;
+	GL(gl->glBindFramebuffer(GL_FRAMEBUFFER, currentFbo));
+	cubeMapRenderer->endFaces(core);
+}
+
+void StelApp::drawAdditionalView()
+{
+	if (!initialized)
+		return;
+	// Modules which draw in their own framebuffers bind this one again
+	GLint drawFbo;
+	GL(gl->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &drawFbo));
+	currentFbo = drawFbo;
+	core->preDraw();
+	drawModules();
+	core->postDraw();
+}
+
+void StelApp::startNextFramePreparation()
+{
+	// The next update() is expected one frame duration after this one.
+	const qint64 nextFrameMSecs = QDateTime::currentMSecsSinceEpoch() + qRound64(lastDeltaTime*1000.);
+	const double nextJDE = core->setNextFrameTime(nextFrameMSecs);
+	const QList<StelModule*> modules = moduleMgr->getCallOrders(StelModule::ActionUpdate);
+	nextFramePreparation = QtConcurrent::run([modules, nextJDE]()
+	{
+		for (auto* module : modules)
+			module->prepareNextFrame(nextJDE);
+	});
+}
+
 /*************************************************************************
  Call this when the size of the GL window has changed
 *************************************************************************/
@@ -777,6 +1046,10 @@ void StelApp::glWindowHasBeenResized(const QRectF& rect)
 	if (spoutSender)
 		spoutSender->resize(rect.width(),rect.height());
 #endif
+#ifdef ENABLE_DMABUF
+	if (dmaBufSender)
+		dmaBufSender->resize(qRound(rect.width()*devicePixelsPerPixel), qRound(rect.height()*devicePixelsPerPixel));
+#endif
 }
 
 // Handle mouse clics
@@ -1006,6 +1279,26 @@ void StelApp::setViewportEffect(const QString& name)
 	{
 		viewportEffect = new StelViewportDistorterFisheyeToSphericMirror(w, h);
 	}
+	else if (name == "renderScale")
+	{
+		viewportEffect = new StelViewportScaler(renderScale);
+	}
+	else if (name == "hdrToneMapping")
+	{
+		ensureGLContextCurrent();
+		if (StelViewportToneMapper::isSupported())
+			viewportEffect = new StelViewportToneMapper();
+		else
+			qWarning() << "StelApp: no floating point render targets, HDR tone mapping disabled";
+	}
+	else if (name == "warpBlend")
+	{
+		ensureGLContextCurrent();
+		if (StelViewportWarpBlender::isSupported())
+			viewportEffect = new StelViewportWarpBlender();
+		else
+			qWarning() << "StelApp: no floating point textures, the warp and blend of the viewport are disabled";
+	}
 	else
 	{
 		qDebug() << "unknown viewport effect name:" << name;
@@ -1013,6 +1306,21 @@ void StelApp::setViewportEffect(const QString& name)
 	}
 }
 
+void StelApp::setRenderScale(float scale)
+{
+	scale = qBound(0.25f, scale, 1.f);
+	if (qFuzzyCompare(scale, renderScale))
+		return;
+	renderScale = scale;
+	// Another viewport effect chosen by the user is kept.
+	const QString effect = getViewportEffect();
+	if (effect != "none" && effect != "renderScale")
+		return;
+	setViewportEffect("none");
+	if (renderScale < 1.f)
+		setViewportEffect("renderScale");
+}
+
 QString StelApp::getViewportEffect() const
 {
 	if (viewportEffect)
@@ -22,17 +22,24 @@
 
 #include <QString>
 #include <QObject>
+#include <QFuture>
 #include "StelModule.hpp"
 
 // Predeclaration of some classes
 class StelCore;
 class StelTextureMgr;
+class StelJobMgr;
 class StelObjectMgr;
 class StelLocaleMgr;
 class StelModuleMgr;
 class StelMainView;
 class StelSkyCultureMgr;
 class StelViewportEffect;
+class StelQualityGovernor;
+class StelFrameGrabber;
+class StelCubeMapRenderer;
+class StelFrameProfiler;
+class StelPerformanceMetrics;
 class QOpenGLFramebufferObject;
 class QOpenGLFunctions;
 class QSettings;
@@ -53,6 +60,9 @@ class StelProgressController;
 #ifdef 	ENABLE_SPOUT
 class SpoutSender;
 #endif
+#ifdef 	ENABLE_DMABUF
+class DmaBufSender;
+#endif
 
 //! @class StelApp
 //! Singleton main Stellarium application class.
@@ -92,6 +102,12 @@ public:
 
 	//! Initialize core and all the modules.
 	void init(QSettings* conf);
+	//! Initialize only the modules needed for astrometry, without OpenGL context and GUI:
+	//! StelCore, StelObjectMgr, SolarSystem, StarMgr and NebulaMgr. Textures are not loaded.
+	//! This is used for the batch mode of the command line.
+	void initHeadless(QSettings* conf);
+	//! Get whether the application was initialized by initHeadless().
+	bool isHeadless() const {return headless;}
 	//! Deinitialize core and all the modules.
 	void deinit();
 
@@ -131,6 +147,9 @@ public:
 	//! @return the texture manager to use for loading textures.
 	StelTextureMgr& getTextureManager() const {return *textureMgr;}
 
+	//! Get the manager of background jobs, used for loading textures, models and sky layers.
+	StelJobMgr& getJobMgr() const {return *jobMgr;}
+
 	//! Get the Location manager to use for managing stored locations
 	//! @return the Location manager to use for managing stored locations
 	StelLocationMgr& getLocationMgr() const {return *planetLocationMgr;}
@@ -177,6 +196,10 @@ public:
 	// 2014-11: OLD COMMENT? What does a void return?
 	// @return the max squared distance in pixels that any object has travelled since the last update.
 	void draw();
+	//! Draw the modules again in the bound framebuffer with the current projector parameters of the core, for
+	//! another viewport of the frame drawn by draw() (see StelViewportWindow). The modules are not updated again,
+	//! and the viewport effect, the frame profiler and the frame grabber are left out.
+	void drawAdditionalView();
 
 	//! Get the ratio between real device pixel and "Device Independent Pixel".
 	//! Usually this value is 1, but for a mac with retina screen this will be value 2.
@@ -221,7 +244,10 @@ public:
 	void removeProgressBar(StelProgressController* p);
 
 	//! Define the type of viewport effect to use
-	//! @param effectName must be one of 'none', 'framebufferOnly', 'sphericMirrorDistorter'
+	//! @param effectName must be one of 'none', 'framebufferOnly', 'sphericMirrorDistorter', 'renderScale', 'hdrToneMapping', 'warpBlend'.
+	//! 'renderScale' draws the sky at the resolution given by setRenderScale().
+	//! 'hdrToneMapping' draws the sky into a half float buffer and compresses its highlights instead of clipping them.
+	//! 'warpBlend' applies the warp map and the blend mask of a projector calibration, see StelViewportWarpBlender.
 	void setViewportEffect(const QString& effectName);
 	//! Get the type of viewport effect currently used
 	QString getViewportEffect() const;
@@ -260,6 +286,45 @@ public slots:
 	//! Get flag for using designations for celestial coordinate systems
 	bool getFlagUseCCSDesignation() const {return flagUseCCSDesignation;}
 
+	//! Set whether the modules prepare the next frame while the current one is drawn.
+	//! The simulation time of a frame is then fixed when the previous frame starts drawing, one frame
+	//! duration ahead, so that StelModule::prepareNextFrame() knows it. Disabled by default.
+	void setFlagPipelinedUpdate(bool b) { flagPipelinedUpdate=b; }
+	//! Get whether the modules prepare the next frame while the current one is drawn.
+	bool getFlagPipelinedUpdate() const { return flagPipelinedUpdate; }
+
+	//! Set whether the fisheye projection is drawn from the faces of a cube with StelCubeMapRenderer, for domes.
+	//! Other projections are drawn directly. Disabled by default.
+	void setFlagCubeMapFisheye(bool b) { flagCubeMapFisheye=b; }
+	//! Get whether the fisheye projection is drawn from the faces of a cube.
+	bool getFlagCubeMapFisheye() const { return flagCubeMapFisheye; }
+
+	//! Pass a fixed frame duration to the updates of the modules instead of the measured one, e.g. to replay
+	//! recorded frames with StelSessionRecorder. The FPS and the performance metrics still use the measured duration.
+	//! @param dt the duration of the next frames [s], or a negative value to use the measured duration again
+	void setDeltaTimeOverride(double dt) { deltaTimeOverride=dt; }
+
+	//! Set the ratio between the resolution at which the view is drawn and the resolution of the screen.
+	//! Values below 1 draw the sky to a smaller buffer which is stretched to the screen, which is faster
+	//! for fill-rate limited hardware. This uses the 'renderScale' viewport effect, so it has no effect
+	//! while another viewport effect is used.
+	//! @param scale between 0.25 and 1 (default).
+	void setRenderScale(float scale);
+	//! Get the ratio between the resolution at which the view is drawn and the resolution of the screen.
+	float getRenderScale() const { return renderScale; }
+
+	//! Get the governor lowering the rendering quality when the target frame rate is not held.
+	StelQualityGovernor* getQualityGovernor() const { return qualityGovernor; }
+
+	//! Get the grabber which copies the drawn sky to main memory for viewers like a video stream.
+	StelFrameGrabber* getFrameGrabber() const { return frameGrabber; }
+
+	//! Get the profiler measuring the time of the modules in each frame.
+	StelFrameProfiler* getFrameProfiler() const { return frameProfiler; }
+
+	//! Get the live performance metrics, published as StelProperties.
+	StelPerformanceMetrics* getPerformanceMetrics() const { return performanceMetrics; }
+
 	//! Get the current number of frame per second.
 	//! @return the FPS averaged on the last second
 	float getFps() const {return fps;}
@@ -328,6 +393,10 @@ private:
 	//! Used internally to set the viewport effects.
 	//! @param drawFbo the OpenGL fbo we need to render into.
 	void applyRenderBuffer(quint32 drawFbo=0);
+	//! Call the draw of the active modules, between StelCore::preDraw() and StelCore::postDraw().
+	void drawModules();
+	//! Draw the modules in the faces of cubeMapRenderer, and resample them into the current framebuffer.
+	void drawCubeMapFaces();
 
 	// The StelApp singleton
 	static StelApp* singleton;
@@ -356,6 +425,9 @@ private:
 	// Textures manager for the application
 	StelTextureMgr* textureMgr;
 
+	// Background jobs manager for the application
+	StelJobMgr* jobMgr;
+
 	// Manager for all the StelObjects of the program
 	StelObjectMgr* stelObjectMgr;
 
@@ -412,6 +484,8 @@ private:
 
 	// Define whether the StelApp instance has completed initialization
 	bool initialized;
+	// Define whether the StelApp instance runs without OpenGL context and GUI
+	bool headless;
 
 	static qint64 startMSecs;
 	static float animationScale;
@@ -438,15 +512,32 @@ private:
 	// Framebuffer object used for viewport effects.
 	QOpenGLFramebufferObject* renderBuffer;
 	StelViewportEffect* viewportEffect;
+	float renderScale;
+	StelQualityGovernor* qualityGovernor;
+	StelFrameGrabber* frameGrabber;
+	StelCubeMapRenderer* cubeMapRenderer;
+	bool flagCubeMapFisheye;
+	StelFrameProfiler* frameProfiler;
+	StelPerformanceMetrics* performanceMetrics;
 	QOpenGLFunctions* gl;
 	
 	bool flagShowDecimalDegrees;  // Format infotext with decimal degrees, not minutes/seconds
 	bool flagUseAzimuthFromSouth; // Display calculate azimuth from south towards west (as in some astronomical literature)
 	bool flagUseFormattingOutput; // Use tabular coordinate format for infotext
 	bool flagUseCCSDesignation;   // Use symbols like alpha (RA), delta (declination) for coordinate system labels
+
+	//! Start StelModule::prepareNextFrame() of all modules on a worker thread.
+	void startNextFramePreparation();
+	bool flagPipelinedUpdate;     // Prepare the next frame while drawing the current one
+	double lastDeltaTime;         // Duration of the last frame [s]
+	double deltaTimeOverride;     // See setDeltaTimeOverride(), negative if unused [s]
+	QFuture<void> nextFramePreparation;
 #ifdef 	ENABLE_SPOUT
 	SpoutSender* spoutSender;
 #endif
+#ifdef 	ENABLE_DMABUF
+	DmaBufSender* dmaBufSender;
+#endif
 
 	// The current main FBO/render target handle, without requiring GL queries. Valid through a draw() call
 	quint32 currentFbo;
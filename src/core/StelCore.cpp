@@ -34,6 +34,7 @@
 #include "StelObjectMgr.hpp"
 #include "Planet.hpp"
 #include "SolarSystem.hpp"
+#include "RiseSetSolver.hpp"
 #include "LandscapeMgr.hpp"
 #include "StelTranslator.hpp"
 #include "StelActionMgr.hpp"
@@ -74,8 +75,11 @@ const double StelCore::TZ_ERA_BEGINNING = 2395996.5;		// December 1, 1847
 StelCore::StelCore()
 	: skyDrawer(Q_NULLPTR)
 	, movementMgr(Q_NULLPTR)
+	, riseSetSolver(Q_NULLPTR)
 	, geodesicGrid(Q_NULLPTR)
+	, visibleZonesCapsValid(false)
 	, currentProjectionType(ProjectionStereographic)
+	, drawProjectionType(static_cast<ProjectionType>(1000))
 	, currentDeltaTAlgorithm(EspenakMeeus)
 	, position(Q_NULLPTR)
 	, flagUseNutation(true)
@@ -85,6 +89,7 @@ StelCore::StelCore()
 	, presetSkyTime(0.)
 	, milliSecondsOfLastJDUpdate(0)
 	, jdOfLastJDUpdate(0.)
+	, nextFrameMSecs(-1)
 	, flagUseDST(true)
 	, flagUseCTZ(false)
 	, deltaTCustomNDot(-26.0)
@@ -101,6 +106,7 @@ StelCore::StelCore()
 {
 	setObjectName("StelCore");
 	registerMathMetaTypes();
+	viewRotation = Mat4d::identity();
 
 	toneReproducer = new StelToneReproducer();
 	milliSecondsOfLastJDUpdate = QDateTime::currentMSecsSinceEpoch();
@@ -247,6 +253,8 @@ void StelCore::init()
 	propMgr->registerObject(skyDrawer);
 	propMgr->registerObject(this);
 
+	riseSetSolver = new RiseSetSolver(this);
+
 
 	setCurrentProjectionTypeKey(getDefaultProjectionTypeKey());
 	updateMaximumFov();
@@ -343,6 +351,22 @@ const StelGeodesicGrid* StelCore::getGeodesicGrid(int maxLevel) const
 	return geodesicGrid;
 }
 
+const QVector<SphericalCap>& StelCore::getVisibleSkyCaps() const
+{
+	if (!visibleZonesCapsValid)
+	{
+		visibleZonesCaps = getProjection(FrameJ2000)->getViewportConvexPolygon()->getBoundingSphericalCaps();
+		visibleZonesCaps.append(getVisibleSkyArea());
+		visibleZonesCapsValid = true;
+	}
+	return visibleZonesCaps;
+}
+
+const GeodesicSearchResult* StelCore::getVisibleGeodesicZones(int maxSearchLevel) const
+{
+	return getGeodesicGrid(maxSearchLevel)->search(getVisibleSkyCaps(), maxSearchLevel);
+}
+
 StelProjectorP StelCore::getProjection2d() const
 {
 	StelProjectorP prj(new StelProjector2d());
@@ -353,7 +377,7 @@ StelProjectorP StelCore::getProjection2d() const
 StelProjectorP StelCore::getProjection(StelProjector::ModelViewTranformP modelViewTransform, ProjectionType projType) const
 {
 	if (projType==1000)
-		projType = currentProjectionType;
+		projType = drawProjectionType!=1000 ? drawProjectionType : currentProjectionType;
 
 	StelProjectorP prj;
 	switch (projType)
@@ -517,6 +541,8 @@ void StelCore::preDraw()
 	// Init openGL viewing with fov, screen size and clip planes
 	currentProjectorParams.zNear = 0.000001;
 	currentProjectorParams.zFar = 500.;
+	// The view may have changed since the last frame.
+	visibleZonesCapsValid = false;
 
 	// Clear the render buffer.
 	// Here we can set a sky background color if really wanted (art
@@ -526,15 +552,30 @@ void StelCore::preDraw()
 	gl->glClearColor(backColor[0], backColor[1], backColor[2], 0.f);
 	gl->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
+	if (!skyDrawRect.isEmpty())
+	{
+		gl->glScissor(skyDrawRect.x(), skyDrawRect.y(), skyDrawRect.width(), skyDrawRect.height());
+		gl->glEnable(GL_SCISSOR_TEST);
+	}
+
 	skyDrawer->preDraw();
 }
 
+void StelCore::suspendSkyDrawRect()
+{
+	if (!skyDrawRect.isEmpty())
+		QOpenGLContext::currentContext()->functions()->glDisable(GL_SCISSOR_TEST);
+}
+
 
 /*************************************************************************
  Update core state after drawing modules
 *************************************************************************/
 void StelCore::postDraw()
 {
+	StelPainter::submitBatch();
+	StelPainter::submitText();
+	suspendSkyDrawRect();
 	StelPainter sPainter(getProjection(StelCore::FrameJ2000));
 	sPainter.drawViewportShape();
 }
@@ -736,10 +777,18 @@ void StelCore::lookAtJ2000(const Vec3d& pos, const Vec3d& aup)
 	s.normalize();
 	Vec3d u(s^f);	// Up vector in AltAz coordinates
 	u.normalize();
-	matAltAzModelView.set(s[0],u[0],-f[0],0.,
-			      s[1],u[1],-f[1],0.,
-			      s[2],u[2],-f[2],0.,
-			      0.,0.,0.,1.);
+	matAltAzViewDirection.set(s[0],u[0],-f[0],0.,
+				  s[1],u[1],-f[1],0.,
+				  s[2],u[2],-f[2],0.,
+				  0.,0.,0.,1.);
+	matAltAzModelView = viewRotation*matAltAzViewDirection;
+	invertMatAltAzModelView = matAltAzModelView.inverse();
+}
+
+void StelCore::setViewRotation(const Mat4d& rotation)
+{
+	viewRotation = rotation;
+	matAltAzModelView = viewRotation*matAltAzViewDirection;
 	invertMatAltAzModelView = matAltAzModelView.inverse();
 }
 
@@ -1101,7 +1150,7 @@ qint64 StelCore::getMilliSecondsOfLastJDUpdate() const
 void StelCore::setJD(double newJD)
 {
 	JD.first=newJD;
-	JD.second=computeDeltaT(newJD);	
+	JD.second=getCachedDeltaT(newJD);
 	resetSync();
 }
 
@@ -1113,7 +1162,7 @@ double StelCore::getJD() const
 void StelCore::setJDE(double newJDE)
 {
 	// nitpickerish this is not exact, but as good as it gets...
-	JD.second=computeDeltaT(newJDE);
+	JD.second=getCachedDeltaT(newJDE);
 	JD.first=newJDE-JD.second/86400.0;
 	resetSync();
 }
@@ -1828,19 +1877,14 @@ bool StelCore::getRealTimeSpeed() const
 // Increment time
 void StelCore::updateTime(double deltaTime)
 {
-	if (getRealTimeSpeed())
+	qint64 now = QDateTime::currentMSecsSinceEpoch();
+	if (nextFrameMSecs>=0)
 	{
-		JD.first = jdOfLastJDUpdate + (QDateTime::currentMSecsSinceEpoch() - milliSecondsOfLastJDUpdate) / 1000.0 * JD_SECOND;
+		now = qMax(nextFrameMSecs, milliSecondsOfLastJDUpdate);
+		nextFrameMSecs = -1;
 	}
-	else
-	{
-		JD.first = jdOfLastJDUpdate + (QDateTime::currentMSecsSinceEpoch() - milliSecondsOfLastJDUpdate) / 1000.0 * timeSpeed;
-	}
-
-	// Fix time limits to -100000 to +100000 to prevent bugs
-	if (JD.first>38245309.499988) JD.first = 38245309.499988;
-	if (JD.first<-34803211.500012) JD.first = -34803211.500012;
-	JD.second=computeDeltaT(JD.first);
+	JD.first = computeJD(now);
+	JD.second=getCachedDeltaT(JD.first);
 
 	if (position->isObserverLifeOver())
 	{
@@ -1862,7 +1906,34 @@ void StelCore::updateTime(double deltaTime)
 	// GZ maybe setting this static can speedup a bit?
 	static SolarSystem* solsystem = (SolarSystem*)StelApp::getInstance().getModuleMgr().getModule("SolarSystem");
 	// Likely the most important location where we need JDE:
-	solsystem->computePositions(getJDE(), position->getHomePlanet());
+	// Forced updates (deltaTime==0, e.g. from AstroCalc) need exact positions of all bodies.
+	solsystem->computePositions(getJDE(), position->getHomePlanet(), deltaTime>0.);
+}
+
+double StelCore::computeJD(qint64 msecs) const
+{
+	double jd;
+	if (getRealTimeSpeed())
+	{
+		jd = jdOfLastJDUpdate + (msecs - milliSecondsOfLastJDUpdate) / 1000.0 * JD_SECOND;
+	}
+	else
+	{
+		jd = jdOfLastJDUpdate + (msecs - milliSecondsOfLastJDUpdate) / 1000.0 * timeSpeed;
+	}
+
+	// Fix time limits to -100000 to +100000 to prevent bugs
+	if (jd>38245309.499988) jd = 38245309.499988;
+	if (jd<-34803211.500012) jd = -34803211.500012;
+	return jd;
+}
+
+double StelCore::setNextFrameTime(qint64 msecs)
+{
+	nextFrameMSecs = qMax(msecs, milliSecondsOfLastJDUpdate);
+	const double jd = computeJD(nextFrameMSecs);
+	// Same as getJDE() after updateTime()
+	return jd+getCachedDeltaT(jd)/86400.0;
 }
 
 void StelCore::resetSync()
@@ -1957,10 +2028,16 @@ double StelCore::computeDeltaT(const double JD)
 	return DeltaT;
 }
 
+double StelCore::getCachedDeltaT(double JD)
+{
+	return deltaTCache.getDeltaT(JD, [this](double jd) { return computeDeltaT(jd); });
+}
+
 // set a function pointer here. This should make the actual computation simpler by just calling the function.
 void StelCore::setCurrentDeltaTAlgorithm(DeltaTAlgorithm algorithm)
 {
 	currentDeltaTAlgorithm=algorithm;
+	deltaTCache.clear();
 	deltaTdontUseMoon = false; // most algorithms will use it!
 	switch (currentDeltaTAlgorithm)
 	{
@@ -2496,11 +2573,13 @@ bool StelCore::de431IsActive()
 void StelCore::setDe430Active(bool status)
 {
 	de430Active = de430Available && status;
+	deltaTCache.clear();
 }
 
 void StelCore::setDe431Active(bool status)
 {
 	de431Active = de431Available && status;
+	deltaTCache.clear();
 }
 
 void StelCore::initEphemeridesFunctions()
@@ -2540,6 +2619,8 @@ void StelCore::initEphemeridesFunctions()
 		EphemWrapper::init_de431(de431FilePath.toStdString().c_str());
 	}
 	setDe431Active(de431Available && conf->value("astro/flag_use_de431", false).toBool());
+
+	EphemWrapper::set_chebyshev_cache_enabled(conf->value("astro/flag_ephemeris_chebyshev_cache", true).toBool());
 }
 
 // Methods for finding constellation from J2000 position.
@@ -25,16 +25,20 @@
 #include "StelProjectorType.hpp"
 #include "StelLocation.hpp"
 #include "StelSkyDrawer.hpp"
+#include "StelDeltaTCache.hpp"
 #include <QString>
 #include <QStringList>
 #include <QTime>
 #include <QPair>
+#include <QRect>
 
 class StelToneReproducer;
 class StelSkyDrawer;
 class StelGeodesicGrid;
+class GeodesicSearchResult;
 class StelMovementMgr;
 class StelObserver;
+class RiseSetSolver;
 
 //! @class StelCore
 //! Main class for Stellarium core processing.
@@ -166,6 +170,26 @@ public:
 	//! Update core state after drawing modules.
 	void postDraw();
 
+	//! Restrict the drawing of the sky modules to a rectangle of the viewport, e.g. the bounds of the
+	//! eyepiece circle of the Oculars plugin. From the next frame on, preDraw() enables the scissor test
+	//! for it after clearing the buffer, so no fragments are computed for the hidden part of the sky.
+	//! Offscreen passes must suspend it with StelOpenGL::ScissorSuspender.
+	//! @param rect the rectangle in device pixels of the framebuffer, from its lower left corner.
+	//! An empty rectangle draws the whole viewport (default).
+	void setSkyDrawRect(const QRect& rect) {skyDrawRect = rect;}
+	//! Get the rectangle set with setSkyDrawRect()
+	const QRect& getSkyDrawRect() const {return skyDrawRect;}
+	//! Draw over the whole viewport for the rest of the frame, e.g. the mask around the restricted rectangle.
+	void suspendSkyDrawRect();
+
+	//! Set the radius of the disk around the center of the viewport through which the sky is visible, e.g. the
+	//! eyepiece circle of the Oculars plugin. The projections made from the next frame on narrow their bounding cap,
+	//! viewport polygon and the visible geodesic zones to this disk, so the modules don't draw the hidden objects.
+	//! @param radius in pixels (not device pixels), 0 for the whole viewport (default)
+	void setVisibleDiskRadius(float radius) {currentProjectorParams.visibleDiskRadius = radius;}
+	//! Get the radius set with setVisibleDiskRadius()
+	float getVisibleDiskRadius() const {return currentProjectorParams.visibleDiskRadius;}
+
 	//! Get a new instance of a simple 2d projection. This projection cannot be used to project or unproject but
 	//! only for 2d painting
 	StelProjectorP getProjection2d() const;
@@ -188,9 +212,21 @@ public:
 	//! Get the current StelSkyDrawer used in the core.
 	const StelSkyDrawer* getSkyDrawer() const;
 
+	//! Get the solver of rise, transit and set times for the current location.
+	RiseSetSolver* getRiseSetSolver() const {return riseSetSolver;}
+
 	//! Get an instance of StelGeodesicGrid which is garanteed to allow for at least maxLevel levels
 	const StelGeodesicGrid* getGeodesicGrid(int maxLevel) const;
 
+	//! Get the caps bounding the area visible in the viewport of the J2000 frame,
+	//! and above the horizon if it is drawn (see getVisibleSkyArea()). They are computed once per frame.
+	const QVector<SphericalCap>& getVisibleSkyCaps() const;
+
+	//! Get the zones of the geodesic grid in the area of getVisibleSkyCaps().
+	//! Modules searching the visible area in the same frame share the same result.
+	//! @param maxSearchLevel the deepest level of the grid to search
+	const GeodesicSearchResult* getVisibleGeodesicZones(int maxSearchLevel) const;
+
 	//! Get the instance of movement manager.
 	StelMovementMgr* getMovementMgr();
 	//! Get the const instance of movement manager.
@@ -214,12 +250,21 @@ public:
 
 	//! Set vision direction
 	void lookAtJ2000(const Vec3d& pos, const Vec3d& up);
+	//! Rotate the view of the next draws relative to the vision direction, for another viewport of the same frame,
+	//! e.g. a projector of a dome (see StelViewportWindow). The rotation is in eye coordinates.
+	//! Reset it to the identity before the next update.
+	void setViewRotation(const Mat4d& rotation);
+	//! Draw with another projection than the current one, without changing the current projection type, its maximum
+	//! field of view or emitting signals, e.g. for the faces of StelCubeMapRenderer.
+	//! @param type the projection of the next draws, or (ProjectionType)1000 to draw with the current one again
+	void setDrawProjectionType(ProjectionType type) { drawProjectionType=type; }
 
 	Vec3d altAzToEquinoxEqu(const Vec3d& v, RefractionMode refMode=RefractionAuto) const;
 	Vec3d equinoxEquToAltAz(const Vec3d& v, RefractionMode refMode=RefractionAuto) const;
 	Vec3d altAzToJ2000(const Vec3d& v, RefractionMode refMode=RefractionAuto) const;
 	Vec3d j2000ToAltAz(const Vec3d& v, RefractionMode refMode=RefractionAuto) const;
 	void j2000ToAltAzInPlaceNoRefraction(Vec3f* v) const {v->transfo4d(matJ2000ToAltAz);}
+	void j2000ToAltAzInPlaceNoRefraction(Vec3d* v) const {v->transfo4d(matJ2000ToAltAz);}
 	Vec3d galacticToJ2000(const Vec3d& v) const;
 	Vec3d supergalacticToJ2000(const Vec3d& v) const;
 	//! Transform position vector v from equatorial coordinates of date (which may also include atmospheric refraction) to those of J2000.
@@ -460,6 +505,12 @@ public slots:
 	//! It is still frequently used in the literature.
 	double getJDE() const;
 
+	//! Fix the system time for which the next update() computes the time, instead of the time of the call.
+	//! This lets StelApp prepare the next frame for a known time in its pipelined mode.
+	//! @param msecs a time like QDateTime::currentMSecsSinceEpoch()
+	//! @return the JDE which the next update() will set, unless the time or the time rate is changed before.
+	double setNextFrameTime(qint64 msecs);
+
 	//! Get solution of equation of time
 	//! Source: J. Meeus "Astronomical Algorithms" (2nd ed., with corrections as of August 10, 2009) p.183-187.
 	//! @param JDE JD in Dynamical Time (previously called Ephemeris Time)
@@ -690,13 +741,13 @@ public slots:
 
 	//! Set central year for custom equation for calculation of DeltaT
 	//! @param y the year, e.g. 1820
-	void setDeltaTCustomYear(float y) { deltaTCustomYear=y; }
+	void setDeltaTCustomYear(float y) { deltaTCustomYear=y; deltaTCache.clear(); }
 	//! Set n-dot for custom equation for calculation of DeltaT
 	//! @param v the n-dot value, e.g. -26.0
-	void setDeltaTCustomNDot(float v) { deltaTCustomNDot=v; }
+	void setDeltaTCustomNDot(float v) { deltaTCustomNDot=v; deltaTCache.clear(); }
 	//! Set coefficients for custom equation for calculation of DeltaT
 	//! @param c the coefficients, e.g. -20,0,32
-	void setDeltaTCustomEquationCoefficients(Vec3f c) { deltaTCustomEquationCoeff=c; }
+	void setDeltaTCustomEquationCoefficients(Vec3f c) { deltaTCustomEquationCoeff=c; deltaTCache.clear(); }
 
 	//! Get central year for custom equation for calculation of DeltaT
 	float getDeltaTCustomYear() const { return deltaTCustomYear; }
@@ -764,12 +815,19 @@ private:
 	StelToneReproducer* toneReproducer;		// Tones conversion between stellarium world and display device
 	StelSkyDrawer* skyDrawer;
 	StelMovementMgr* movementMgr;		// Manage vision movements
+	RiseSetSolver* riseSetSolver;		// Rise, transit and set times shared by the GUI and plugins
 
 	// Manage geodesic grid
 	mutable StelGeodesicGrid* geodesicGrid;
+	// Caps of the area searched by getVisibleGeodesicZones(), valid for the current frame
+	mutable QVector<SphericalCap> visibleZonesCaps;
+	mutable bool visibleZonesCapsValid;
+	// The part of the viewport the sky is drawn in, or empty for all
+	QRect skyDrawRect;
 
 	// The currently used projection type
 	ProjectionType currentProjectionType;
+	ProjectionType drawProjectionType; // See setDrawProjectionType(), 1000 to use currentProjectionType
 
 	// The currentrly used time correction (DeltaT)
 	DeltaTAlgorithm currentDeltaTAlgorithm;
@@ -781,6 +839,11 @@ private:
 	void updateTime(double deltaTime);
 	void updateMaximumFov();
 	void resetSync();
+	//! Get DeltaT for the simulation date from the interpolation table, for sweeps in small time steps.
+	//! Results are within the tolerance of deltaTCache from computeDeltaT().
+	double getCachedDeltaT(double JD);
+	//! Get the JD at a given system time in milliseconds, for the current time rate.
+	double computeJD(qint64 msecs) const;
 
 	void registerMathMetaTypes();
 
@@ -800,6 +863,8 @@ private:
 
 	Mat4d matAltAzModelView;           // Modelview matrix for observer-centric altazimuthal drawing
 	Mat4d invertMatAltAzModelView;     // Inverted modelview matrix for observer-centric altazimuthal drawing
+	Mat4d matAltAzViewDirection;       // matAltAzModelView without viewRotation
+	Mat4d viewRotation;                // See setViewRotation()
 
 	// Position variables
 	StelObserver* position;
@@ -821,6 +886,7 @@ private:
 	QString startupTimeMode;
 	qint64 milliSecondsOfLastJDUpdate;    // Time in milliseconds when the time rate or time last changed
 	double jdOfLastJDUpdate;         // JD when the time rate or time last changed
+	qint64 nextFrameMSecs;           // Time in milliseconds used by the next updateTime(), or -1 for the current time
 
 	QString currentTimeZone;	
 	bool flagUseDST;
@@ -835,6 +901,7 @@ private:
 	double (*deltaTfunc)(const double JD); // This is a function pointer which must be set to a function which computes DeltaT(JD).
 	int deltaTstart;   // begin year of validity range for the selected DeltaT algorithm. (SET INT_MIN to mark infinite)
 	int deltaTfinish;  // end   year of validity range for the selected DeltaT algorithm. (Set INT_MAX to mark infinite)
+	StelDeltaTCache deltaTCache; // interpolation table for the simulation date, cleared when the DeltaT model changes.
 
 	// Variables for DE430/431 ephem calculation
 	bool de430Available; // ephem file found
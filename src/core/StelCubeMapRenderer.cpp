@@ -0,0 +1,249 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelCubeMapRenderer.hpp"
+#include "StelCore.hpp"
+#include "StelPainter.hpp"
+#include "StelOpenGL.hpp"
+
+#include <QDebug>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLShaderProgram>
+
+#include <cmath>
+
+StelCubeMapRenderer::StelCubeMapRenderer()
+	: faceSize(0)
+	, bufferSize(0)
+	, bufferFormat(0)
+	, program(Q_NULLPTR)
+{
+	initializeOpenGLFunctions();
+	for (auto*& face : faces)
+		face = Q_NULLPTR;
+
+	QOpenGLShader vshader(QOpenGLShader::Vertex);
+	const char* vsrc =
+		"attribute mediump vec2 vertex;\n"
+		"void main(void)\n"
+		"{\n"
+		"    gl_Position = vec4(vertex, 0., 1.);\n"
+		"}\n";
+	vshader.compileSourceCode(vsrc);
+	if (!vshader.log().isEmpty()) { qWarning() << "StelCubeMapRenderer: Warnings while compiling vshader: " << vshader.log(); }
+
+	// The inverse of StelProjectorFisheye, then the face of the largest coordinate of the direction.
+	// The coordinates of each face are those of its view, see getFaceRotation().
+	QOpenGLShader fshader(QOpenGLShader::Fragment);
+	const char* fsrc =
+		"uniform highp vec2 center;\n"
+		"uniform highp vec2 scale;\n"
+		"uniform sampler2D front;\n"
+		"uniform sampler2D right;\n"
+		"uniform sampler2D left;\n"
+		"uniform sampler2D up;\n"
+		"uniform sampler2D down;\n"
+		"uniform sampler2D back;\n"
+		"void main(void)\n"
+		"{\n"
+		"    highp vec2 q = (gl_FragCoord.xy - center)*scale;\n"
+		"    highp float a = length(q);\n"
+		"    if (a > 3.14159265)\n"
+		"    {\n"
+		"        gl_FragColor = vec4(0.);\n"
+		"        return;\n"
+		"    }\n"
+		"    highp vec3 d = a > 0. ? vec3(q*(sin(a)/a), -cos(a)) : vec3(0., 0., -1.);\n"
+		"    highp vec3 m = abs(d);\n"
+		"    if (-d.z >= m.x && -d.z >= m.y)\n"
+		"        gl_FragColor = texture2D(front, d.xy/(-d.z)*0.5 + 0.5);\n"
+		"    else if (d.z >= m.x && d.z >= m.y)\n"
+		"        gl_FragColor = texture2D(back, vec2(-d.x, d.y)/d.z*0.5 + 0.5);\n"
+		"    else if (m.x >= m.y)\n"
+		"    {\n"
+		"        if (d.x > 0.)\n"
+		"            gl_FragColor = texture2D(right, d.zy/d.x*0.5 + 0.5);\n"
+		"        else\n"
+		"            gl_FragColor = texture2D(left, vec2(-d.z, d.y)/(-d.x)*0.5 + 0.5);\n"
+		"    }\n"
+		"    else if (d.y > 0.)\n"
+		"        gl_FragColor = texture2D(up, d.xz/d.y*0.5 + 0.5);\n"
+		"    else\n"
+		"        gl_FragColor = texture2D(down, vec2(d.x, -d.z)/(-d.y)*0.5 + 0.5);\n"
+		"}\n";
+	fshader.compileSourceCode(fsrc);
+	if (!fshader.log().isEmpty()) { qWarning() << "StelCubeMapRenderer: Warnings while compiling fshader: " << fshader.log(); }
+
+	program = new QOpenGLShaderProgram();
+	program->addShader(&vshader);
+	program->addShader(&fshader);
+	if (!StelPainter::linkProg(program, "cubeMapFisheyeShader"))
+	{
+		delete program;
+		program = Q_NULLPTR;
+	}
+}
+
+StelCubeMapRenderer::~StelCubeMapRenderer()
+{
+	delete program;
+	for (auto* face : faces)
+		delete face;
+}
+
+Mat4d StelCubeMapRenderer::getFaceRotation(Face face)
+{
+	// The eye looks towards -z, with y up
+	switch (face)
+	{
+		case FaceRight:
+			return Mat4d::yrotation(M_PI_2);
+		case FaceLeft:
+			return Mat4d::yrotation(-M_PI_2);
+		case FaceUp:
+			return Mat4d::xrotation(-M_PI_2);
+		case FaceDown:
+			return Mat4d::xrotation(M_PI_2);
+		case FaceBack:
+			return Mat4d::yrotation(M_PI);
+		default:
+			return Mat4d::identity();
+	}
+}
+
+int StelCubeMapRenderer::beginFaces(StelCore* core, GLenum textureFormat)
+{
+	mainParams = core->getCurrentStelProjectorParams();
+	if (!program)
+		return 0;
+
+	// Radians from the center of the fisheye to the farthest corner of the viewport
+	const double pixelPerRad = mainParams.viewportFovDiameter/(mainParams.fov*M_PI/180.);
+	const Vector4<int>& xywh = mainParams.viewportXywh;
+	double maxAngle = 0.;
+	for (int x : {xywh[0], xywh[0]+xywh[2]})
+	{
+		for (int y : {xywh[1], xywh[1]+xywh[3]})
+		{
+			const double dx = (x-mainParams.viewportCenter[0])/mainParams.widthStretch;
+			const double dy = y-mainParams.viewportCenter[1];
+			maxAngle = qMax(maxAngle, std::sqrt(dx*dx+dy*dy)/pixelPerRad);
+		}
+	}
+	visibleFaces.clear();
+	visibleFaces << FaceFront;
+	if (maxAngle > M_PI_4)
+		visibleFaces << FaceRight << FaceLeft << FaceUp << FaceDown;
+	// Where the direction of the diagonal of the side faces leaves them: 180 - atan(sqrt(2)) degrees
+	if (maxAngle > M_PI - std::atan(M_SQRT2))
+		visibleFaces << FaceBack;
+
+	// At the center of a face of size s, a pixel is 2/s radians wide
+	int size = faceSize;
+	if (size<=0)
+		size = qRound(2.*pixelPerRad*mainParams.devicePixelsPerPixel);
+	GLint maxTextureSize = 0;
+	GL(glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize));
+	size = qBound(16, size, static_cast<int>(maxTextureSize));
+	if (size!=bufferSize || textureFormat!=bufferFormat)
+	{
+		for (auto*& face : faces)
+		{
+			delete face;
+			face = Q_NULLPTR;
+		}
+		bufferSize = size;
+		bufferFormat = textureFormat;
+		qDebug() << "StelCubeMapRenderer: faces of" << size << "x" << size << "pixels";
+	}
+	for (auto face : visibleFaces)
+	{
+		if (!faces[face])
+		{
+			faces[face] = new QOpenGLFramebufferObject(bufferSize, bufferSize, QOpenGLFramebufferObject::CombinedDepthStencil, GL_TEXTURE_2D, bufferFormat);
+			GL(glBindTexture(GL_TEXTURE_2D, faces[face]->texture()));
+			GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+			GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+			GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+			GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+		}
+	}
+	GL(glBindTexture(GL_TEXTURE_2D, 0));
+	return visibleFaces.size();
+}
+
+GLuint StelCubeMapRenderer::beginFace(StelCore* core, int i)
+{
+	const Face face = visibleFaces.at(i);
+	// The projectors work in the pixels of the screen
+	const int size = qMax(1, qRound(bufferSize/mainParams.devicePixelsPerPixel));
+	StelProjector::StelProjectorParams params = mainParams;
+	params.viewportXywh.set(0, 0, size, size);
+	params.fov = 90.f;
+	params.maskType = StelProjector::MaskNone;
+	params.viewportCenter.set(0.5f*size, 0.5f*size);
+	params.viewportCenterOffset.set(0.f, 0.f);
+	params.viewportFovDiameter = size;
+	params.flipHorz = false;
+	params.flipVert = false;
+	params.widthStretch = 1.f;
+	params.visibleDiskRadius = 0.f;
+	core->setCurrentStelProjectorParams(params);
+	core->setDrawProjectionType(StelCore::ProjectionPerspective);
+	core->setViewRotation(getFaceRotation(face));
+	faces[face]->bind();
+	return faces[face]->handle();
+}
+
+void StelCubeMapRenderer::endFaces(StelCore* core)
+{
+	core->setViewRotation(Mat4d::identity());
+	core->setDrawProjectionType(static_cast<StelCore::ProjectionType>(1000));
+	core->setCurrentStelProjectorParams(mainParams);
+	if (!program)
+		return;
+
+	StelPainter sPainter(core->getProjection2d());
+	sPainter.setBlending(false);
+	static const char* samplerNames[FaceCount] = {"front", "right", "left", "up", "down", "back"};
+	program->bind();
+	for (int face = 0; face < FaceCount; ++face)
+	{
+		// The faces which are not visible are not sampled, but must be bound to a texture
+		const QOpenGLFramebufferObject* buf = faces[face] ? faces[face] : faces[FaceFront];
+		GL(glActiveTexture(GL_TEXTURE0+face));
+		GL(glBindTexture(GL_TEXTURE_2D, buf->texture()));
+		program->setUniformValue(samplerNames[face], face);
+	}
+	GL(glActiveTexture(GL_TEXTURE0));
+
+	const float dppp = mainParams.devicePixelsPerPixel;
+	const float radPerPixel = mainParams.fov*static_cast<float>(M_PI/180.)/(mainParams.viewportFovDiameter*dppp);
+	program->setUniformValue("center", mainParams.viewportCenter[0]*dppp, mainParams.viewportCenter[1]*dppp);
+	program->setUniformValue("scale", (mainParams.flipHorz ? -radPerPixel : radPerPixel)/mainParams.widthStretch,
+				 mainParams.flipVert ? -radPerPixel : radPerPixel);
+	static const GLfloat vertices[] = {-1.f, -1.f, 1.f, -1.f, -1.f, 1.f, 1.f, 1.f};
+	const int vertexLoc = program->attributeLocation("vertex");
+	program->setAttributeArray(vertexLoc, vertices, 2);
+	program->enableAttributeArray(vertexLoc);
+	GL(glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
+	program->disableAttributeArray(vertexLoc);
+	program->release();
+}
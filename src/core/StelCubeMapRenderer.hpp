@@ -0,0 +1,91 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STELCUBEMAPRENDERER_HPP
+#define STELCUBEMAPRENDERER_HPP
+
+#include "StelProjector.hpp"
+
+#include <QOpenGLFunctions>
+#include <QVector>
+
+class QOpenGLFramebufferObject;
+class QOpenGLShaderProgram;
+class StelCore;
+
+//! @class StelCubeMapRenderer
+//! Draws the fisheye projection of domes from the faces of a cube: the modules draw each visible face with a
+//! perspective projection of 90 degrees, whose great circles are straight lines and need little tessellation,
+//! and a single fullscreen pass resamples the faces into the equidistant fisheye of the current projector.
+//! The front face is always drawn, the four side faces when the viewport shows more than 45 degrees from its
+//! center, and the back face beyond 125 degrees. By default the faces have the resolution of the center of the
+//! fisheye, see setFaceSize().
+//! The modules draw once per face: the cost in the CPU grows with the number of faces, while the tessellation of
+//! the lines and of the large polygons of the wide fisheye goes away. What modules draw in the pixels of the
+//! viewport (e.g. with StelCore::getProjection2d()) is resampled as well, and shows in the wrong place.
+//! This is used by StelApp::setFlagCubeMapFisheye().
+class StelCubeMapRenderer : protected QOpenGLFunctions
+{
+public:
+	//! The GL context must be current.
+	StelCubeMapRenderer();
+	//! Releases the faces, the GL context must be current.
+	~StelCubeMapRenderer();
+
+	//! Set the size of the faces in pixels, or 0 to match the resolution of the center of the fisheye.
+	void setFaceSize(int size) { faceSize=size; }
+	int getFaceSize() const { return faceSize; }
+
+	//! Prepare the faces of the current projector parameters of the core.
+	//! @param textureFormat the internal format of the textures of the faces
+	//! @return the number of faces to draw with beginFace(), 0 if the resampling shader is not available
+	int beginFaces(StelCore* core, GLenum textureFormat);
+	//! Bind the framebuffer of a face, and set the projection, parameters and rotation of its view in the core.
+	//! @param i the face, from 0 to the result of beginFaces() excluded
+	//! @return the handle of the framebuffer
+	GLuint beginFace(StelCore* core, int i);
+	//! Restore the projection of the core, and resample the faces into the currently bound framebuffer.
+	void endFaces(StelCore* core);
+
+private:
+	enum Face
+	{
+		FaceFront,
+		FaceRight,
+		FaceLeft,
+		FaceUp,
+		FaceDown,
+		FaceBack,
+		FaceCount
+	};
+
+	//! The rotation of the view of a face, in eye coordinates
+	static Mat4d getFaceRotation(Face face);
+
+	int faceSize;
+	//! The face size and texture format of the framebuffers
+	int bufferSize;
+	GLenum bufferFormat;
+	QOpenGLFramebufferObject* faces[FaceCount];
+	QVector<Face> visibleFaces;
+	StelProjector::StelProjectorParams mainParams;
+	QOpenGLShaderProgram* program;
+};
+
+#endif // STELCUBEMAPRENDERER_HPP
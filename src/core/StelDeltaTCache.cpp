@@ -0,0 +1,73 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelDeltaTCache.hpp"
+
+#include <cmath>
+#include <cstdlib>
+
+StelDeltaTCache::StelDeltaTCache(double segmentLength, double tolerance)
+	: segmentLength(segmentLength)
+	, tolerance(tolerance)
+	, lastIndex(0)
+{
+}
+
+double StelDeltaTCache::getDeltaT(double JD, const std::function<double(double)>& evaluator)
+{
+	const double pos = JD/segmentLength;
+	const double start = std::floor(pos);
+	const long long index = static_cast<long long>(start);
+	Segment& segment = segments[((index % nSegments) + nSegments) % nSegments];
+
+	if (!segment.valid || segment.index != index)
+	{
+		// Dates far from the previous one are not part of a sweep:
+		// filling a segment would cost three evaluations for nothing.
+		const bool isSweep = std::llabs(index-lastIndex) <= 2;
+		lastIndex = index;
+		if (!isSweep)
+			return evaluator(JD);
+
+		const double a = evaluator(start*segmentLength);
+		const double m = evaluator((start+0.5)*segmentLength);
+		const double b = evaluator((start+1.)*segmentLength);
+		segment.index = index;
+		segment.valid = true;
+		// A step of DeltaT anywhere in the segment moves the middle value by half the step away
+		// from the mean of the ends, and the interpolation error is at most the step.
+		segment.smooth = std::fabs(m-0.5*(a+b)) <= 0.5*tolerance;
+		segment.c0 = a;
+		segment.c1 = -3.*a + 4.*m - b;
+		segment.c2 = 2.*a - 4.*m + 2.*b;
+	}
+	lastIndex = index;
+
+	if (!segment.smooth)
+		return evaluator(JD);
+	const double t = pos-start;
+	return segment.c0 + t*(segment.c1 + t*segment.c2);
+}
+
+void StelDeltaTCache::clear()
+{
+	for (auto& segment : segments)
+		segment.valid = false;
+}
@@ -0,0 +1,67 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef STELDELTATCACHE_HPP
+#define STELDELTATCACHE_HPP
+
+#include <functional>
+
+//! @class StelDeltaTCache
+//! Piecewise-quadratic interpolation table of DeltaT for loops which change the date in small steps.
+//! The time axis is divided in segments of fixed length. When a date is requested in a segment for
+//! the first time, DeltaT is evaluated at the start, middle and end of the segment, and later
+//! lookups in the segment interpolate between these values. Segments where DeltaT is not smooth
+//! (e.g. at the limits of the parts of a piecewise DeltaT model, or at the limits of the DE43x ranges)
+//! are detected because the middle value departs from the mean of the ends, and are always evaluated exactly.
+//! The cache is not thread-safe, it has to be used from a single thread.
+class StelDeltaTCache
+{
+public:
+	//! @param segmentLength length of the segments [days]
+	//! @param tolerance largest error of the interpolated values [seconds]
+	StelDeltaTCache(double segmentLength=8., double tolerance=1e-3);
+
+	//! Get DeltaT for a date.
+	//! @param JD the date
+	//! @param evaluator function computing DeltaT [seconds] for a date
+	double getDeltaT(double JD, const std::function<double(double)>& evaluator);
+
+	//! Forget all the cached values. Call this when the model used by the evaluator changes.
+	void clear();
+
+private:
+	struct Segment
+	{
+		Segment() : index(0), valid(false), smooth(false), c0(0.), c1(0.), c2(0.) {}
+		long long index;
+		bool valid;
+		bool smooth;
+		// DeltaT(t) = c0 + c1*t + c2*t*t, where t is the position of the date in the segment (0..1)
+		double c0, c1, c2;
+	};
+	static const int nSegments = 16;
+
+	double segmentLength;
+	double tolerance;
+	long long lastIndex;
+	Segment segments[nSegments];
+};
+
+#endif // STELDELTATCACHE_HPP
@@ -0,0 +1,181 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelFileCache.hpp"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QPair>
+#include <QSaveFile>
+#include <QVector>
+
+#include <algorithm>
+
+StelFileCache::StelFileCache(const QString& adir, const QString& asuffix, qint64 amaxSize, bool atouchFiles)
+	: dir(adir), suffix(asuffix), maxSize(amaxSize), touchFiles(atouchFiles), totalSize(0)
+{
+	QDir().mkpath(dir);
+	const QFileInfoList files = QDir(dir).entryInfoList(QStringList("*" + suffix), QDir::Files);
+	QMutexLocker locker(&mutex);
+	for (const auto& info : files)
+	{
+		Entry e;
+		e.size = info.size();
+		e.lastUsed = info.lastModified().toMSecsSinceEpoch();
+		entries.insert(info.fileName(), e);
+		totalSize += e.size;
+	}
+	evict();
+	qDebug() << "File cache" << dir << ":" << entries.size() << "files," << totalSize/(1024*1024) << "of" << maxSize/(1024*1024) << "MB used";
+}
+
+QString StelFileCache::getKey(const QString& path)
+{
+	if (path.startsWith("http", Qt::CaseInsensitive) || path.startsWith("file://", Qt::CaseInsensitive))
+		return path;
+	const QFileInfo info(path);
+	if (!info.isFile())
+		return QString();
+	return QString("%1|%2|%3").arg(path).arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch());
+}
+
+QString StelFileCache::getFileName(const QString& key) const
+{
+	return QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex() + suffix;
+}
+
+QString StelFileCache::getFilePath(const QString& key) const
+{
+	return dir + "/" + getFileName(key);
+}
+
+bool StelFileCache::contains(const QString& key) const
+{
+	const QString fileName = getFileName(key);
+	QMutexLocker locker(&mutex);
+	return entries.contains(fileName);
+}
+
+void StelFileCache::touch(const QString& key)
+{
+	const QString fileName = getFileName(key);
+	{
+		QMutexLocker locker(&mutex);
+		auto it = entries.find(fileName);
+		if (it==entries.end())
+			return;
+		it->lastUsed = QDateTime::currentMSecsSinceEpoch();
+	}
+#if QT_VERSION >= 0x050A00
+	if (touchFiles)
+	{
+		QFile file(dir + "/" + fileName);
+		if (file.open(QIODevice::ReadWrite))
+			file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+	}
+#endif
+}
+
+QByteArray StelFileCache::read(const QString& key)
+{
+	if (!contains(key))
+		return QByteArray();
+	QFile file(getFilePath(key));
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		remove(key);
+		return QByteArray();
+	}
+	const QByteArray data = file.readAll();
+	file.close();
+	touch(key);
+	return data;
+}
+
+bool StelFileCache::write(const QString& key, const QByteArray& data)
+{
+	if (data.isEmpty() || data.size() > maxSize/4)
+		return false;
+	const QString fileName = getFileName(key);
+	QSaveFile file(dir + "/" + fileName);
+	if (!file.open(QIODevice::WriteOnly) || file.write(data)!=data.size() || !file.commit())
+	{
+		qWarning() << "Cannot write cache file" << file.fileName() << file.errorString();
+		return false;
+	}
+
+	Entry e;
+	e.size = data.size();
+	e.lastUsed = QDateTime::currentMSecsSinceEpoch();
+	QMutexLocker locker(&mutex);
+	auto it = entries.find(fileName);
+	if (it!=entries.end())
+		totalSize -= it->size;
+	entries.insert(fileName, e);
+	totalSize += e.size;
+	evict();
+	return true;
+}
+
+void StelFileCache::remove(const QString& key)
+{
+	QMutexLocker locker(&mutex);
+	removeFile(getFileName(key));
+}
+
+qint64 StelFileCache::getTotalSize() const
+{
+	QMutexLocker locker(&mutex);
+	return totalSize;
+}
+
+void StelFileCache::removeFile(const QString& fileName)
+{
+	auto it = entries.find(fileName);
+	if (it==entries.end())
+		return;
+	totalSize -= it->size;
+	entries.erase(it);
+	QFile::remove(dir + "/" + fileName);
+}
+
+void StelFileCache::evict()
+{
+	if (totalSize <= maxSize)
+		return;
+	// Remove a bit more than needed, so that this does not happen for each new file
+	const qint64 target = maxSize - maxSize/10;
+	QVector<QPair<qint64, QString>> byAge;
+	byAge.reserve(entries.size());
+	for (auto it = entries.constBegin(); it != entries.constEnd(); ++it)
+		byAge.append(qMakePair(it->lastUsed, it.key()));
+	std::sort(byAge.begin(), byAge.end());
+	for (const auto& entry : byAge)
+	{
+		if (totalSize <= target)
+			break;
+		removeFile(entry.second);
+	}
+}
@@ -0,0 +1,98 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef STELFILECACHE_HPP
+#define STELFILECACHE_HPP
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+//! @class StelFileCache
+//! A directory of files identified by string keys, e.g. URLs, with a size budget.
+//! The least recently used files are removed when the total size of the files exceeds the budget.
+//! The order of use is read from the modification times of the files when the cache is opened.
+//! All methods are thread safe.
+class StelFileCache
+{
+public:
+	//! Open the cache and index the files already stored in it.
+	//! @param dir the directory where files are stored, created if needed
+	//! @param suffix the suffix of the files, e.g. ".stex"
+	//! @param maxSize the budget of the cache in bytes
+	//! @param touchFiles whether the modification time of files is updated when they are used, so
+	//! that the order of use is kept for the next sessions. Disable it when the files are identified
+	//! by their modification time elsewhere, e.g. when they are read as local files by StelTexture.
+	StelFileCache(const QString& dir, const QString& suffix, qint64 maxSize, bool touchFiles);
+
+	//! Get the key of a file which is read from a local path or a URL.
+	//! Local files are identified by their path, size and modification time, so that modified files are not read from the cache.
+	//! @return an empty string if the local file does not exist
+	static QString getKey(const QString& path);
+
+	//! Get the path of the file of a key, whether it exists or not.
+	QString getFilePath(const QString& key) const;
+
+	//! Whether a file is stored for a key.
+	bool contains(const QString& key) const;
+
+	//! Mark the file of a key as used now.
+	void touch(const QString& key);
+
+	//! Read the file of a key and mark it as used.
+	//! @return an empty array if there is no file for the key
+	QByteArray read(const QString& key);
+
+	//! Store the file of a key, evicting the least recently used ones if needed.
+	//! Files larger than a quarter of the budget are not stored.
+	//! @return false if the file could not be written
+	bool write(const QString& key, const QByteArray& data);
+
+	//! Remove the file of a key.
+	void remove(const QString& key);
+
+	//! Get the total size of the files in bytes.
+	qint64 getTotalSize() const;
+
+private:
+	struct Entry
+	{
+		qint64 size;
+		qint64 lastUsed;	// msecs since epoch
+	};
+
+	QString getFileName(const QString& key) const;
+	//! Remove a file from the index and the disk. Requires a locked mutex.
+	void removeFile(const QString& fileName);
+	//! Remove the least recently used files until the budget is met. Requires a locked mutex.
+	void evict();
+
+	QString dir;
+	QString suffix;
+	qint64 maxSize;
+	bool touchFiles;
+	qint64 totalSize;
+	mutable QMutex mutex;
+	//! The entries by file name
+	QHash<QString, Entry> entries;
+};
+
+#endif // STELFILECACHE_HPP
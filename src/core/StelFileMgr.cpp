@@ -25,6 +25,7 @@
 #include <QDir>
 #include <QString>
 #include <QDebug>
+#include <QMutexLocker>
 #include <QStandardPaths>
 
 #include <stdio.h>
@@ -39,11 +40,27 @@
 
 #include "StelFileMgr.hpp"
 
+namespace
+{
+	//! The key of a name in the index of the search directories
+	inline QString indexKey(const QString& name)
+	{
+#if defined(Q_OS_WIN) || defined(Q_OS_MAC)
+		// These file systems ignore the case by default
+		return name.toLower();
+#else
+		return name;
+#endif
+	}
+}
+
 // Initialize static members.
 QStringList StelFileMgr::fileLocations;
 QString StelFileMgr::userDir;
 QString StelFileMgr::screenshotDir;
 QString StelFileMgr::installDir;
+QHash<QString, StelFileMgr::IndexedDirectory> StelFileMgr::directoryIndex;
+QMutex StelFileMgr::indexMutex;
 
 void StelFileMgr::init()
 {
@@ -199,8 +216,7 @@ QString StelFileMgr::findFile(const QString& path, Flags flags)
 	
 	for (const auto& i : fileLocations)
 	{
-		const QFileInfo finfo(i + "/" + path);
-		if (fileFlagsCheck(finfo, flags))
+		if (locationFlagsCheck(i, path, flags))
 			return i + "/" + path;
 	}
 
@@ -241,8 +257,7 @@ QStringList StelFileMgr::findFileInAllPaths(const QString &path, const Flags &fl
 
 	for (const auto& locationPath : fileLocations)
 	{
-		const QFileInfo finfo(locationPath + "/" + path);
-		if (fileFlagsCheck(finfo, flags))
+		if (locationFlagsCheck(locationPath, path, flags))
 			filePaths.append(locationPath + "/" + path);
 	}
 
@@ -271,10 +286,29 @@ QSet<QString> StelFileMgr::listContents(const QString& path, const StelFileMgr::
 
 	// If path is "complete" (a full path), we just look in there, else
 	// we append relative paths to the search paths maintained by this class.
-	QStringList listPaths = QFileInfo(path).isAbsolute() ? QStringList("/") : fileLocations;
+	const bool absolute = QFileInfo(path).isAbsolute();
+	QStringList listPaths = absolute ? QStringList("/") : fileLocations;
 
 	for (const auto& li : listPaths)
 	{
+		if (!absolute && !(flags & (Writable|New)))
+		{
+			const EntryType type = getIndexedType(li, path);
+			if (type==EntryDirectory)
+			{
+				QMutexLocker locker(&indexMutex);
+				for (const auto& entry : getIndexedDirectory(QDir::cleanPath(li + "/" + path)).entries)
+				{
+					if ((flags & Directory) && !entry.isDir)
+						continue;
+					if ((flags & File) && entry.isDir)
+						continue;
+					result.insert(entry.name);
+				}
+			}
+			if (type!=EntryUnknown)
+				continue;
+		}
 		QFileInfo thisPath(QDir(li).filePath(path));
 		if (!thisPath.isDir())
 			continue;
@@ -296,6 +330,91 @@ QSet<QString> StelFileMgr::listContents(const QString& path, const StelFileMgr::
 void StelFileMgr::setSearchPaths(const QStringList& paths)
 {
 	fileLocations = paths;
+	invalidateIndex();
+}
+
+void StelFileMgr::invalidateIndex()
+{
+	QMutexLocker locker(&indexMutex);
+	directoryIndex.clear();
+}
+
+const StelFileMgr::IndexedDirectory& StelFileMgr::getIndexedDirectory(const QString& dirPath)
+{
+	auto it = directoryIndex.find(dirPath);
+	if (it==directoryIndex.end())
+	{
+		IndexedDirectory dir;
+		const QDir qdir(dirPath);
+		dir.exists = qdir.exists();
+		if (dir.exists)
+		{
+			for (const auto& info : qdir.entryInfoList(QDir::AllEntries|QDir::Hidden|QDir::NoDotAndDotDot))
+			{
+				IndexedEntry entry;
+				entry.name = info.fileName();
+				entry.isDir = info.isDir();
+				dir.entries.insert(indexKey(entry.name), entry);
+			}
+		}
+		it = directoryIndex.insert(dirPath, dir);
+	}
+	return *it;
+}
+
+StelFileMgr::EntryType StelFileMgr::getIndexedType(const QString& location, const QString& path)
+{
+	if (!isIndexed(location))
+		return EntryUnknown;
+	QString relative = QDir::cleanPath(path);
+	if (relative==".")
+		relative.clear();
+	if (relative.startsWith("..") || QDir::isAbsolutePath(relative))
+		return EntryUnknown;
+
+	QMutexLocker locker(&indexMutex);
+	QString dirPath = QDir::cleanPath(location);
+	if (!getIndexedDirectory(dirPath).exists)
+		return EntryMissing;
+	if (relative.isEmpty())
+		return EntryDirectory;
+	const QStringList parts = relative.split('/');
+	for (int i=0;i<parts.size();++i)
+	{
+		const IndexedDirectory& dir = getIndexedDirectory(dirPath);
+		const auto it = dir.entries.constFind(indexKey(parts.at(i)));
+		if (it==dir.entries.constEnd())
+			return EntryMissing;
+		if (i==parts.size()-1)
+			return it->isDir ? EntryDirectory : EntryFile;
+		if (!it->isDir)
+			return EntryMissing;
+		dirPath += "/" + it->name;
+	}
+	return EntryUnknown;
+}
+
+bool StelFileMgr::locationFlagsCheck(const QString& location, const QString& path, const Flags& flags)
+{
+	if (!(flags & (Writable|New)))
+	{
+		const EntryType type = getIndexedType(location, path);
+		if (type!=EntryUnknown)
+		{
+			if (type==EntryMissing)
+				return false;
+			if ((flags & Directory) && type!=EntryDirectory)
+				return false;
+			if ((flags & File) && type!=EntryFile)
+				return false;
+			return true;
+		}
+	}
+	const bool result = fileFlagsCheck(QFileInfo(location + "/" + path), flags);
+	// The caller is about to create the file
+	if (result && (flags & New) && isIndexed(location))
+		invalidateIndex();
+	return result;
 }
 
 bool StelFileMgr::exists(const QString& path)
@@ -330,6 +449,7 @@ qint64 StelFileMgr::size(const QString& path)
 
 bool StelFileMgr::mkDir(const QString& path)
 {
+	invalidateIndex();
 	return QDir("/").mkpath(path);
 }
 
@@ -408,6 +528,7 @@ void StelFileMgr::setUserDir(const QString& newDir)
 	QFileInfo userDirFI(newDir);
 	userDir = userDirFI.filePath();
 	fileLocations.replace(0, userDir);
+	invalidateIndex();
 }
 
 QString StelFileMgr::getInstallationDir()
@@ -469,6 +590,7 @@ void StelFileMgr::makeSureDirExistsAndIsWritable(const QString& dirFullPath)
 	{
 		// The modules directory doesn't exist, lets create it.
 		qDebug() << "Creating directory " << QDir::toNativeSeparators(uDir.filePath());
+		invalidateIndex();
 		if (!QDir("/").mkpath(uDir.filePath()))
 		{
 			throw std::runtime_error(QString("Could not create directory: " +uDir.filePath()).toStdString());
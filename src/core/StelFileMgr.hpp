@@ -23,6 +23,8 @@
 #define CHECK_FILE "data/ssystem_major.ini"
 
 #include <stdexcept>
+#include <QHash>
+#include <QMutex>
 #include <QSet>
 #include <QString>
 #include <QStringList>
@@ -36,6 +38,12 @@ class QFileInfo;
 //! directory (on platforms which support it).
 //! The concept is that the StelFileMgr will be asked for a named path, and it
 //! will try to locate that path within each of the search directories.
+//! The search directories other than the user directory are not expected to change while
+//! Stellarium runs: the entries of their sub-directories are listed once, on the first lookup
+//! which reaches them, and the following lookups of findFile(), findFileInAllPaths() and
+//! listContents() in these directories do not access the file system. The lookups with the
+//! Writable or New flags still check the permissions on disk. The user directory, which the
+//! modules write in, is always checked on disk.
 //! @author Lippo Huhtala <lippo.huhtala@meridea.com>
 //! @author Matthew Gates <matthewg42@gmail.com>
 //! @sa @ref fileStructure description.
@@ -99,6 +107,10 @@ public:
 	//! @param paths is a vector of strings which will become the new search paths
 	static void setSearchPaths(const QStringList& paths);
 
+	//! Forget the listed entries of the search directories, after files were added to or removed
+	//! from them other than through StelFileMgr. mkDir() and makeSureDirExistsAndIsWritable() call it.
+	static void invalidateIndex();
+
 	//! Make sure the passed directory path exist and is writable.
 	//! If it doesn't exist creates it. If it's not possible throws an error.
 	static void makeSureDirExistsAndIsWritable(const QString& dirFullPath);
@@ -206,8 +218,42 @@ private:
 	//! @exception misc
 	static bool fileFlagsCheck(const QFileInfo& thePath, const Flags& flags=(Flags)0);
 
+	//! The type of a path found in the index of the search directories
+	enum EntryType {
+		EntryUnknown,	//!< The path is not in the index, and must be checked on disk
+		EntryMissing,
+		EntryFile,
+		EntryDirectory
+	};
+
+	//! An entry of a listed directory
+	struct IndexedEntry
+	{
+		QString name;
+		bool isDir;
+	};
+	//! A listed directory. The entries are by name, in lower case on the file systems which ignore the case.
+	struct IndexedDirectory
+	{
+		bool exists;
+		QHash<QString, IndexedEntry> entries;
+	};
+
+	//! Get whether the entries of a search directory are listed in the index.
+	static bool isIndexed(const QString& location) {return location!=userDir;}
+	//! Get the entries of a directory, listed on the first use. indexMutex must be locked.
+	static const IndexedDirectory& getIndexedDirectory(const QString& dirPath);
+	//! Get the type of a relative path in a search directory from the index.
+	static EntryType getIndexedType(const QString& location, const QString& path);
+	//! Check if a relative path in a search directory matches a set of flags, using the index when possible.
+	static bool locationFlagsCheck(const QString& location, const QString& path, const Flags& flags);
+
 	static QStringList fileLocations;
 
+	//! The entries of the listed directories of the search paths, by directory path
+	static QHash<QString, IndexedDirectory> directoryIndex;
+	static QMutex indexMutex;
+
 	//! Used to store the user data directory
 	static QString userDir;
 
@@ -0,0 +1,196 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelFrameGrabber.hpp"
+#include "StelOpenGL.hpp"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QOpenGLContext>
+
+// Not defined in the OpenGL ES 2 headers
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_MAP_READ_BIT
+#define GL_MAP_READ_BIT 0x0001
+#endif
+
+StelFrameGrabber::StelFrameGrabber()
+	: glInitialized(false)
+	, mapBufferRange(Q_NULLPTR)
+	, unmapBuffer(Q_NULLPTR)
+	, nextBuffer(0)
+	, lastCaptureMs(0)
+	, viewerCount(0)
+	, maxFps(0)
+	, frameNumber(0)
+{
+}
+
+StelFrameGrabber::~StelFrameGrabber()
+{
+	if (glInitialized && mapBufferRange)
+	{
+		for (auto& buf : buffers)
+		{
+			if (buf.id)
+				glDeleteBuffers(1, &buf.id);
+		}
+	}
+}
+
+void StelFrameGrabber::addViewer(int fps)
+{
+	QMutexLocker locker(&mutex);
+	viewerFps.append(fps);
+	maxFps = qMax(maxFps, fps);
+	viewerCount.fetchAndAddOrdered(1);
+}
+
+void StelFrameGrabber::removeViewer(int fps)
+{
+	QMutexLocker locker(&mutex);
+	if (!viewerFps.removeOne(fps))
+		return;
+	maxFps = 0;
+	for (int f : viewerFps)
+		maxFps = qMax(maxFps, f);
+	viewerCount.fetchAndAddOrdered(-1);
+}
+
+bool StelFrameGrabber::waitForFrame(quint64 &lastFrameNumber, QImage &image, unsigned long timeout)
+{
+	QImage img;
+	{
+		QMutexLocker locker(&mutex);
+		if (frameNumber == lastFrameNumber)
+			frameReady.wait(&mutex, timeout);
+		if (frameNumber == lastFrameNumber)
+			return false;
+		lastFrameNumber = frameNumber;
+		img = frame;
+	}
+	// Flip in the viewer thread, not in the main thread
+	image = img.mirrored();
+	return true;
+}
+
+void StelFrameGrabber::initGL()
+{
+	initializeOpenGLFunctions();
+	glInitialized = true;
+
+	QOpenGLContext* ctx = QOpenGLContext::currentContext();
+	if (ctx->format().majorVersion() >= 3)
+	{
+		mapBufferRange = reinterpret_cast<PFNMapBufferRange>(ctx->getProcAddress("glMapBufferRange"));
+		unmapBuffer = reinterpret_cast<PFNUnmapBuffer>(ctx->getProcAddress("glUnmapBuffer"));
+	}
+	if (!mapBufferRange || !unmapBuffer)
+	{
+		mapBufferRange = Q_NULLPTR;
+		qDebug() << "StelFrameGrabber: pixel buffer objects are not available, frames are read synchronously";
+		return;
+	}
+	for (auto& buf : buffers)
+		glGenBuffers(1, &buf.id);
+}
+
+void StelFrameGrabber::capture(int width, int height)
+{
+	if (!isActive() || width <= 0 || height <= 0)
+		return;
+	if (!glInitialized)
+		initGL();
+
+	if (mapBufferRange)
+	{
+		// Read back the frames issued in earlier draws, the GPU has finished them by now.
+		for (auto& buf : buffers)
+		{
+			if (buf.pending)
+				readPixelBuffer(buf);
+		}
+	}
+
+	int fps;
+	{
+		QMutexLocker locker(&mutex);
+		fps = maxFps;
+	}
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	if (fps <= 0 || now - lastCaptureMs < 1000 / fps)
+		return;
+	lastCaptureMs = now;
+
+	if (!mapBufferRange)
+	{
+		// Blocks until the frame is drawn
+		QImage image(width, height, QImage::Format_RGBA8888);
+		GL(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, image.bits()));
+		publish(image);
+		return;
+	}
+
+	PixelBuffer& buf = buffers[nextBuffer];
+	nextBuffer = (nextBuffer + 1) % BUFFER_COUNT;
+	if (buf.pending)
+		return; // can't happen, it was read above
+
+	GL(glBindBuffer(GL_PIXEL_PACK_BUFFER, buf.id));
+	const int size = width * height * 4;
+	if (size != buf.size)
+	{
+		GL(glBufferData(GL_PIXEL_PACK_BUFFER, size, Q_NULLPTR, GL_STREAM_READ));
+		buf.size = size;
+	}
+	buf.width = width;
+	buf.height = height;
+	// Returns immediately, the copy is done by the GPU after the draw calls
+	GL(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, Q_NULLPTR));
+	GL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+	buf.pending = true;
+}
+
+void StelFrameGrabber::readPixelBuffer(PixelBuffer &buf)
+{
+	buf.pending = false;
+	GL(glBindBuffer(GL_PIXEL_PACK_BUFFER, buf.id));
+	const void* data = mapBufferRange(GL_PIXEL_PACK_BUFFER, 0, buf.size, GL_MAP_READ_BIT);
+	if (data)
+	{
+		QImage image(buf.width, buf.height, QImage::Format_RGBA8888);
+		memcpy(image.bits(), data, static_cast<size_t>(buf.size));
+		unmapBuffer(GL_PIXEL_PACK_BUFFER);
+		publish(image);
+	}
+	GL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+}
+
+void StelFrameGrabber::publish(const QImage &image)
+{
+	QMutexLocker locker(&mutex);
+	frame = image;
+	++frameNumber;
+	frameReady.wakeAll();
+}
@@ -0,0 +1,99 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STELFRAMEGRABBER_HPP
+#define STELFRAMEGRABBER_HPP
+
+#include <QAtomicInt>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QOpenGLFunctions>
+#include <QWaitCondition>
+
+//! @class StelFrameGrabber
+//! Copies the drawn sky (without GUI) to main memory for viewers in other threads, e.g. a video stream of the RemoteControl plugin.
+//! Nothing is done while there is no viewer. Where pixel buffer objects are available (OpenGL 3 or OpenGL ES 3),
+//! the pixels are read asynchronously into them and mapped one frame later, so the draw does not wait for the GPU.
+//! Otherwise glReadPixels is used directly.
+class StelFrameGrabber : protected QOpenGLFunctions
+{
+public:
+	StelFrameGrabber();
+	//! Releases the buffers. Requires the GL context to be current.
+	~StelFrameGrabber();
+
+	//! Register a viewer which wants at most fps frames per second. The frames are grabbed from now on.
+	//! Can be called from any thread.
+	void addViewer(int fps);
+	//! Unregister a viewer added with the same fps. Can be called from any thread.
+	void removeViewer(int fps);
+	//! True if a viewer is registered
+	bool isActive() const { return viewerCount.load() > 0; }
+
+	//! Wait for a frame newer than frameNumber. Can be called from any thread.
+	//! @param frameNumber the number of the last frame the caller has got, updated to the returned one
+	//! @param image the frame, with the top row first
+	//! @param timeout in ms
+	//! @return false if no new frame was grabbed before the timeout
+	bool waitForFrame(quint64& frameNumber, QImage& image, unsigned long timeout);
+
+	//! Grab the currently bound framebuffer, if a viewer needs a frame. Called by StelApp::draw() after the sky is drawn.
+	//! @param width, height the size of the framebuffer in pixels
+	void capture(int width, int height);
+
+private:
+	struct PixelBuffer
+	{
+		PixelBuffer() : id(0), size(0), width(0), height(0), pending(false) {}
+		GLuint id;
+		int size;
+		int width;
+		int height;
+		bool pending;
+	};
+
+	void initGL();
+	//! Copies the pixels of a pending buffer into a new frame
+	void readPixelBuffer(PixelBuffer& buf);
+	void publish(const QImage& image);
+
+	typedef void* (QOPENGLF_APIENTRYP PFNMapBufferRange)(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+	typedef GLboolean (QOPENGLF_APIENTRYP PFNUnmapBuffer)(GLenum target);
+
+	bool glInitialized;
+	PFNMapBufferRange mapBufferRange;
+	PFNUnmapBuffer unmapBuffer;
+	static const int BUFFER_COUNT = 2;
+	PixelBuffer buffers[BUFFER_COUNT];
+	int nextBuffer;
+	qint64 lastCaptureMs;
+
+	QAtomicInt viewerCount;
+	//! protects viewerFps, maxFps, frame and frameNumber
+	QMutex mutex;
+	QWaitCondition frameReady;
+	QList<int> viewerFps;
+	int maxFps;
+	//! the last frame, bottom row first as read from OpenGL
+	QImage frame;
+	quint64 frameNumber;
+};
+
+#endif // STELFRAMEGRABBER_HPP
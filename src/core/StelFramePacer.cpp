@@ -0,0 +1,191 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelFramePacer.hpp"
+
+#include <QSettings>
+
+#include <algorithm>
+
+namespace
+{
+	//! Frames of the latency percentiles
+	const int LATENCY_WINDOW = 600;
+	//! Frames of the prediction of the frame cost, 1 s at 60 fps
+	const int COST_WINDOW = 60;
+}
+
+StelFramePacer::StelFramePacer()
+	: adaptive(false)
+	, vsync(false)
+	, margin(2.)
+	, refreshPeriod(0.)
+	, inputTime(-1)
+	, updateStart(-1)
+	, drawStart(-1)
+	, drawEnd(-1)
+	, lastSwap(-1)
+	, frameCosts(COST_WINDOW, 0)
+	, nextCost(0)
+	, penalty(0)
+	, latencies(LATENCY_WINDOW, 0.f)
+	, nextLatency(0)
+	, recordedLatencies(0)
+	, lastPublication(0)
+	, updateSum(0)
+	, drawSum(0)
+	, swapSum(0)
+	, frames(0)
+	, missed(0)
+	, inputLatencyP50(0.)
+	, inputLatencyP99(0.)
+	, updateTime(0.)
+	, drawTime(0.)
+	, swapTime(0.)
+	, missedVsyncs(0)
+{
+	setObjectName("StelFramePacer");
+	clock.start();
+}
+
+void StelFramePacer::init(QSettings* conf, bool vsync)
+{
+	this->vsync = vsync;
+	margin = qMax(0., conf->value("video/pacing_margin", 2.).toDouble());
+	setAdaptive(conf->value("video/flag_adaptive_pacing", false).toBool());
+}
+
+void StelFramePacer::setAdaptive(bool b)
+{
+	if (b==adaptive)
+		return;
+	adaptive = b;
+	emit adaptiveChanged(b);
+}
+
+void StelFramePacer::setRefreshRate(double rate)
+{
+	refreshPeriod = rate>0. ? 1000./rate : 0.;
+}
+
+void StelFramePacer::markInput()
+{
+	if (inputTime<0)
+		inputTime = clock.nsecsElapsed();
+}
+
+void StelFramePacer::beginUpdate()
+{
+	updateStart = clock.nsecsElapsed();
+	drawStart = drawEnd = -1;
+}
+
+void StelFramePacer::beginDraw()
+{
+	drawStart = clock.nsecsElapsed();
+}
+
+void StelFramePacer::endDraw()
+{
+	drawEnd = clock.nsecsElapsed();
+	if (updateStart>=0)
+	{
+		frameCosts[nextCost] = drawEnd-updateStart;
+		nextCost = (nextCost+1) % COST_WINDOW;
+	}
+}
+
+void StelFramePacer::frameSwapped()
+{
+	const qint64 now = clock.nsecsElapsed();
+	// The swap of a frame drawn by something else than StelApp, e.g. a dialog
+	if (drawEnd<0 || updateStart<0)
+	{
+		lastSwap = now;
+		return;
+	}
+
+	if (inputTime>=0 && inputTime<=drawEnd)
+	{
+		latencies[nextLatency] = static_cast<float>((now-inputTime)*1e-6);
+		nextLatency = (nextLatency+1) % LATENCY_WINDOW;
+		recordedLatencies = qMin(recordedLatencies+1, LATENCY_WINDOW);
+		inputTime = -1;
+	}
+
+	// A frame requested within a period after the previous swap should be shown one period after it.
+	// Frames started later, e.g. throttled by the minimum fps, miss no vsync.
+	if (vsync && refreshPeriod>0. && lastSwap>=0)
+	{
+		const double period = refreshPeriod*1e6;
+		if (updateStart-lastSwap < period)
+		{
+			const int late = qRound((now-lastSwap)/period)-1;
+			if (late>0)
+			{
+				missed += late;
+				penalty = qMin(static_cast<qint64>(period/2), penalty + static_cast<qint64>(period/8));
+			}
+			else
+				penalty = qMax(Q_INT64_C(0), penalty - static_cast<qint64>(period/200));
+		}
+	}
+
+	updateSum += drawStart-updateStart;
+	drawSum += drawEnd-drawStart;
+	swapSum += now-drawEnd;
+	++frames;
+	lastSwap = now;
+	updateStart = drawStart = drawEnd = -1;
+
+	if (now-lastPublication >= 1000000000LL)
+		publish(now);
+}
+
+int StelFramePacer::getNextFrameDelay() const
+{
+	if (!isPacing() || lastSwap<0)
+		return 0;
+	// The slowest frame of the last second, so that occasional slower frames do not miss the vsync
+	const qint64 cost = *std::max_element(frameCosts.constBegin(), frameCosts.constEnd()) + penalty;
+	const double start = lastSwap*1e-6 + refreshPeriod - cost*1e-6 - margin;
+	const double delay = start - clock.nsecsElapsed()*1e-6;
+	return qBound(0, static_cast<int>(delay), static_cast<int>(refreshPeriod));
+}
+
+void StelFramePacer::publish(qint64 now)
+{
+	if (recordedLatencies>0)
+	{
+		QVector<float> sorted = latencies.mid(0, recordedLatencies);
+		std::sort(sorted.begin(), sorted.end());
+		inputLatencyP50 = sorted.at((sorted.size()-1)/2);
+		inputLatencyP99 = sorted.at(qMin(sorted.size()-1, static_cast<int>(0.99*sorted.size())));
+	}
+	updateTime = frames>0 ? updateSum*1e-6/frames : 0.;
+	drawTime = frames>0 ? drawSum*1e-6/frames : 0.;
+	swapTime = frames>0 ? swapSum*1e-6/frames : 0.;
+	missedVsyncs = missed;
+
+	lastPublication = now;
+	updateSum = drawSum = swapSum = 0;
+	frames = 0;
+	missed = 0;
+	emit updated();
+}
@@ -0,0 +1,147 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STELFRAMEPACER_HPP
+#define STELFRAMEPACER_HPP
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QVector>
+
+class QSettings;
+
+//! @class StelFramePacer
+//! Measures the pacing of the frames drawn by StelMainView, and can schedule their start on the vertical
+//! synchronisation to reduce the latency of the interaction.
+//! StelMainView reports the first input event handled since the previous frame, the start of StelApp::update(),
+//! the start and the end of StelApp::draw() and the buffer swap (QOpenGLWidget::frameSwapped(), not available
+//! with the old QGLWidget). From these, the pacer publishes as read-only StelProperties, once per second:
+//! - the input latency, from the first input of a frame to the swap of that frame;
+//! - the mean times of the update, the draw and from the end of the draw to the swap;
+//! - the frames which missed a vertical synchronisation during the last second.
+//! With vsync, a frame which starts right after a swap is shown a refresh period later plus its own time at best,
+//! and the inputs handled during its wait are shown one period later still. When the adaptive pacing is
+//! enabled (setting video/flag_adaptive_pacing) and vsync is on, StelMainView starts each frame of the interaction
+//! at getNextFrameDelay() after the swap instead: as late as possible so that its update and draw, predicted
+//! from the slowest of the last frames, end a margin before the next vsync (setting video/pacing_margin [ms]).
+//! Frames which miss the vsync make the prediction more careful for the next ones.
+class StelFramePacer : public QObject
+{
+	Q_OBJECT
+	Q_PROPERTY(bool adaptive READ isAdaptive WRITE setAdaptive NOTIFY adaptiveChanged)
+	Q_PROPERTY(double refreshPeriod READ getRefreshPeriod NOTIFY updated)
+	Q_PROPERTY(double inputLatencyP50 READ getInputLatencyP50 NOTIFY updated)
+	Q_PROPERTY(double inputLatencyP99 READ getInputLatencyP99 NOTIFY updated)
+	Q_PROPERTY(double updateTime READ getUpdateTime NOTIFY updated)
+	Q_PROPERTY(double drawTime READ getDrawTime NOTIFY updated)
+	Q_PROPERTY(double swapTime READ getSwapTime NOTIFY updated)
+	Q_PROPERTY(int missedVsyncs READ getMissedVsyncs NOTIFY updated)
+
+public:
+	StelFramePacer();
+
+	//! Read the settings video/flag_adaptive_pacing and video/pacing_margin.
+	//! @param vsync whether the buffer swaps wait for the vertical synchronisation
+	void init(QSettings* conf, bool vsync);
+
+	//! Set the refresh rate of the screen of the window [Hz], 0 if unknown.
+	void setRefreshRate(double rate);
+
+	//! Report an input event handled by the application. Only the first one since the previous frame counts.
+	void markInput();
+	//! Report the start of StelApp::update().
+	void beginUpdate();
+	//! Report the start of StelApp::draw().
+	void beginDraw();
+	//! Report the end of StelApp::draw(), when its GL commands are submitted.
+	void endDraw();
+	//! Report the buffer swap of the last drawn frame.
+	void frameSwapped();
+
+	//! Whether the frames are scheduled by getNextFrameDelay(): adaptive pacing with vsync and a known refresh rate.
+	bool isPacing() const { return adaptive && vsync && refreshPeriod>0.; }
+	//! Get the time to wait from now before starting the next frame, to be called after the swap [ms].
+	int getNextFrameDelay() const;
+
+	bool isAdaptive() const { return adaptive; }
+	//! Refresh period of the screen [ms], 0 if unknown
+	double getRefreshPeriod() const { return refreshPeriod; }
+	//! Median latency from the first input of a frame to its swap, during the last 600 frames with inputs [ms]
+	double getInputLatencyP50() const { return inputLatencyP50; }
+	//! 99th percentile of the input latency [ms]
+	double getInputLatencyP99() const { return inputLatencyP99; }
+	//! Mean duration of StelApp::update() during the last second [ms]
+	double getUpdateTime() const { return updateTime; }
+	//! Mean duration of StelApp::draw() during the last second [ms]
+	double getDrawTime() const { return drawTime; }
+	//! Mean time from the end of the draw to the swap during the last second, which includes the wait for vsync [ms]
+	double getSwapTime() const { return swapTime; }
+	//! Vertical synchronisations missed by the frames during the last second.
+	int getMissedVsyncs() const { return missedVsyncs; }
+
+public slots:
+	void setAdaptive(bool b);
+
+signals:
+	void adaptiveChanged(bool b);
+	//! Emitted once per second, when the measures are published.
+	void updated();
+
+private:
+	void publish(qint64 now);
+
+	QElapsedTimer clock;
+	bool adaptive;
+	bool vsync;
+	double margin;		// [ms]
+	double refreshPeriod;	// [ms]
+
+	//! Times of the current frame [ns], -1 when not reached yet
+	qint64 inputTime;
+	qint64 updateStart;
+	qint64 drawStart;
+	qint64 drawEnd;
+	qint64 lastSwap;
+
+	//! Durations from the start of the update to the end of the draw of the last frames, in a ring buffer [ns]
+	QVector<qint64> frameCosts;
+	int nextCost;
+	//! Extra time added to the prediction after missed vsyncs, decreasing while the frames are on time [ns]
+	qint64 penalty;
+
+	//! Input latencies of the last frames with inputs, in a ring buffer [ms]
+	QVector<float> latencies;
+	int nextLatency;
+	int recordedLatencies;
+
+	//! Sums since the last publication [ns]
+	qint64 lastPublication;
+	qint64 updateSum, drawSum, swapSum;
+	int frames;
+	int missed;
+
+	double inputLatencyP50;
+	double inputLatencyP99;
+	double updateTime;
+	double drawTime;
+	double swapTime;
+	int missedVsyncs;
+};
+
+#endif // STELFRAMEPACER_HPP
@@ -0,0 +1,523 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelFrameProfiler.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelFileMgr.hpp"
+#include "StelPainter.hpp"
+#include "StelProjector.hpp"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFont>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QSaveFile>
+#include <QSettings>
+#ifndef QT_OPENGL_ES_2
+#include <QOpenGLTimerQuery>
+#endif
+
+#include <algorithm>
+
+namespace
+{
+	//! Recorded frames, about 10 s at 60 fps
+	const int MAX_FRAMES = 600;
+	//! Frames whose GPU queries can be pending at once
+	const int QUERY_SETS = 4;
+	//! Frames averaged by the overlay
+	const int OVERLAY_FRAMES = 30;
+	//! Module calls listed by the overlay
+	const int OVERLAY_LINES = 12;
+}
+
+bool StelFrameProfiler::enabled = false;
+std::atomic<qint64> StelFrameProfiler::counters[StelFrameProfiler::CounterCount];
+
+StelFrameProfiler::StelFrameProfiler()
+	: overlayVisible(false)
+	, currentFrame(-1)
+	, recordedFrames(0)
+	, frameOpen(false)
+	, gpuTimersAvailable(-1)
+	, activeQuery(Q_NULLPTR)
+	, callStart(0)
+	, lastCompleteFrame(-1)
+{
+	setObjectName("StelFrameProfiler");
+	querySets.resize(QUERY_SETS);
+	clock.start();
+}
+
+StelFrameProfiler::~StelFrameProfiler()
+{
+	enabled = false;
+	releaseQueries();
+}
+
+void StelFrameProfiler::init(QSettings* conf)
+{
+	setEnabled(conf->value("devel/flag_frame_profiler", false).toBool());
+	setOverlayVisible(conf->value("devel/flag_frame_profiler_overlay", false).toBool());
+}
+
+void StelFrameProfiler::setEnabled(bool b)
+{
+	if (b==enabled)
+		return;
+	enabled = b;
+	frameOpen = false;
+	currentFrame = -1;
+	recordedFrames = 0;
+	lastCompleteFrame = -1;
+	// The pending queries are only reused, they are deleted with the profiler while the GL context is current.
+	for (auto& set : querySets)
+	{
+		set.used = 0;
+		set.frame = -1;
+	}
+	if (b)
+		frames.resize(MAX_FRAMES);
+	else
+		frames.clear();
+	for (auto& c : counters)
+		c.store(0, std::memory_order_relaxed);
+	qDebug() << "Frame profiler" << (b ? "enabled" : "disabled");
+	emit enabledChanged(b);
+	if (!b)
+		setOverlayVisible(false);
+}
+
+void StelFrameProfiler::setOverlayVisible(bool b)
+{
+	if (b==overlayVisible)
+		return;
+	overlayVisible = b;
+	if (b)
+		setEnabled(true);
+	emit overlayVisibleChanged(b);
+}
+
+void StelFrameProfiler::beginFrame()
+{
+	if (!enabled)
+		return;
+	if (frameOpen)
+		endFrame();
+	currentFrame = (currentFrame+1) % MAX_FRAMES;
+	if (currentFrame==lastCompleteFrame)
+		lastCompleteFrame = -1;
+	Frame& f = frames[currentFrame];
+	// A frame recorded so long ago has no pending query, QUERY_SETS is much lower than MAX_FRAMES
+	f.start = clock.nsecsElapsed();
+	f.duration = 0;
+	f.events.clear();
+	f.querySet = -1;
+	for (auto& c : counters)
+		c.store(0, std::memory_order_relaxed);
+	recordedFrames = qMin(recordedFrames+1, MAX_FRAMES);
+	frameOpen = true;
+}
+
+void StelFrameProfiler::endFrame()
+{
+	if (!frameOpen)
+		return;
+	frameOpen = false;
+	Frame& f = frames[currentFrame];
+	f.duration = clock.nsecsElapsed() - f.start;
+	for (int i=0; i<CounterCount; ++i)
+		f.counters[i] = counters[i].exchange(0, std::memory_order_relaxed);
+	if (f.querySet<0)
+		lastCompleteFrame = currentFrame;
+	for (int i=0; i<QUERY_SETS; ++i)
+	{
+		if (querySets[i].frame>=0 && querySets[i].frame!=currentFrame)
+			readQuerySet(i, false);
+	}
+}
+
+void StelFrameProfiler::beginCall(bool draw)
+{
+	if (!frameOpen)
+		return;
+	callStart = clock.nsecsElapsed();
+#ifndef QT_OPENGL_ES_2
+	if (draw)
+	{
+		activeQuery = nextQuery();
+		if (activeQuery)
+			activeQuery->begin();
+	}
+#else
+	Q_UNUSED(draw)
+#endif
+}
+
+void StelFrameProfiler::endCall(const QString& moduleName, bool draw)
+{
+	const qint64 end = clock.nsecsElapsed();
+	int query = -1;
+#ifndef QT_OPENGL_ES_2
+	if (activeQuery)
+	{
+		activeQuery->end();
+		activeQuery = Q_NULLPTR;
+		// The module may have disabled the profiler during its call
+		if (frameOpen)
+			query = querySets[frames[currentFrame].querySet].used-1;
+	}
+#endif
+	if (!frameOpen)
+		return;
+	Event e;
+	e.name = moduleName;
+	e.draw = draw;
+	e.start = callStart;
+	e.duration = end - callStart;
+	e.gpuDuration = -1;
+	e.query = query;
+	frames[currentFrame].events.append(e);
+}
+
+QOpenGLTimerQuery* StelFrameProfiler::nextQuery()
+{
+#ifndef QT_OPENGL_ES_2
+	if (gpuTimersAvailable==0)
+		return Q_NULLPTR;
+	Frame& f = frames[currentFrame];
+	if (f.querySet<0)
+	{
+		const int set = currentFrame % QUERY_SETS;
+		// Only when the GPU is more than QUERY_SETS frames late
+		if (querySets[set].frame>=0)
+			readQuerySet(set, true);
+		querySets[set].used = 0;
+		querySets[set].frame = currentFrame;
+		f.querySet = set;
+	}
+	QuerySet& qs = querySets[f.querySet];
+	if (qs.used==qs.queries.size())
+	{
+		QOpenGLTimerQuery* query = new QOpenGLTimerQuery();
+		if (!query->create())
+		{
+			delete query;
+			qWarning() << "Frame profiler: GPU timer queries are not supported, only the CPU times are measured";
+			gpuTimersAvailable = 0;
+			return Q_NULLPTR;
+		}
+		gpuTimersAvailable = 1;
+		qs.queries.append(query);
+	}
+	return qs.queries[qs.used++];
+#else
+	return Q_NULLPTR;
+#endif
+}
+
+void StelFrameProfiler::readQuerySet(int set, bool wait)
+{
+#ifndef QT_OPENGL_ES_2
+	QuerySet& qs = querySets[set];
+	if (qs.frame<0)
+		return;
+	// The queries end in order, the last one is the last available.
+	if (!wait && qs.used>0 && !qs.queries[qs.used-1]->isResultAvailable())
+		return;
+	Frame& f = frames[qs.frame];
+	for (auto& e : f.events)
+	{
+		if (e.query>=0 && e.query<qs.used)
+			e.gpuDuration = static_cast<qint64>(qs.queries[e.query]->waitForResult());
+	}
+	f.querySet = -1;
+	// The sets are not read in the order of their frames
+	if (lastCompleteFrame<0 || (currentFrame-qs.frame+MAX_FRAMES)%MAX_FRAMES < (currentFrame-lastCompleteFrame+MAX_FRAMES)%MAX_FRAMES)
+		lastCompleteFrame = qs.frame;
+	qs.frame = -1;
+	qs.used = 0;
+#else
+	Q_UNUSED(set)
+	Q_UNUSED(wait)
+#endif
+}
+
+void StelFrameProfiler::releaseQueries()
+{
+#ifndef QT_OPENGL_ES_2
+	for (auto& set : querySets)
+	{
+		qDeleteAll(set.queries);
+		set.queries.clear();
+		set.used = 0;
+		set.frame = -1;
+	}
+#endif
+}
+
+const char* StelFrameProfiler::getCounterName(Counter counter)
+{
+	switch (counter)
+	{
+		case DrawCalls: return "draw calls";
+		case Vertices: return "vertices";
+		case TextureUploads: return "texture uploads";
+		case StarsDrawn: return "stars";
+		case DSOsDrawn: return "DSOs";
+		case SatellitesPropagated: return "satellites propagated";
+		default: return "";
+	}
+}
+
+void StelFrameProfiler::drawOverlay(StelCore* core)
+{
+	if (!overlayVisible || lastCompleteFrame<0)
+		return;
+
+	// Averages of the last complete frames, a single frame flickers too much to be read.
+	struct Sum
+	{
+		Sum() : cpu(0), gpu(0), gpuCount(0) {}
+		qint64 cpu;
+		qint64 gpu;
+		int gpuCount;
+	};
+	QMap<QString, Sum> sums;
+	qint64 frameSum = 0;
+	qint64 counterSums[CounterCount] = {};
+	int n = 0;
+	for (int i=0; i<qMin(OVERLAY_FRAMES, recordedFrames-1); ++i)
+	{
+		const Frame& f = frames[(lastCompleteFrame - i + MAX_FRAMES) % MAX_FRAMES];
+		if (f.querySet>=0)
+			break;
+		for (const auto& e : f.events)
+		{
+			Sum& s = sums[e.name + (e.draw ? " draw" : " update")];
+			s.cpu += e.duration;
+			if (e.gpuDuration>=0)
+			{
+				s.gpu += e.gpuDuration;
+				++s.gpuCount;
+			}
+		}
+		frameSum += f.duration;
+		for (int c=0; c<CounterCount; ++c)
+			counterSums[c] += f.counters[c];
+		++n;
+	}
+	if (n==0)
+		return;
+
+	QVector<QPair<qint64, QString> > lines;
+	for (auto it=sums.constBegin(); it!=sums.constEnd(); ++it)
+	{
+		const Sum& s = it.value();
+		QString line = QString("%1  %2 ms").arg(it.key(), -28).arg(s.cpu/1e6/n, 6, 'f', 2);
+		if (s.gpuCount>0)
+			line += QString("  GPU %1 ms").arg(s.gpu/1e6/s.gpuCount, 6, 'f', 2);
+		lines.append(qMakePair(qMax(s.cpu/n, s.gpuCount>0 ? s.gpu/s.gpuCount : 0), line));
+	}
+	std::sort(lines.begin(), lines.end(), [](const QPair<qint64, QString>& a, const QPair<qint64, QString>& b)
+	{
+		return a.first>b.first;
+	});
+
+	StelPainter painter(core->getProjection2d());
+	QFont font("DejaVu Sans Mono");
+	font.setPixelSize(12);
+	painter.setFont(font);
+	painter.setColor(1.f, 1.f, 0.6f, 0.9f);
+	const float lineHeight = 15.f;
+	float y = painter.getProjector()->getViewportHeight() - 2.f*lineHeight;
+	painter.drawText(10.f, y, QString("Frame %1 ms (CPU, average of %2 frames)").arg(frameSum/1e6/n, 0, 'f', 2).arg(n));
+	y -= lineHeight;
+	QStringList counterTexts;
+	for (int c=0; c<CounterCount; ++c)
+		counterTexts << QString("%1 %2").arg(counterSums[c]/n).arg(getCounterName(static_cast<Counter>(c)));
+	painter.drawText(10.f, y, counterTexts.join(", "));
+	for (int i=0; i<qMin(OVERLAY_LINES, lines.size()); ++i)
+	{
+		y -= lineHeight;
+		painter.drawText(10.f, y, lines.at(i).second);
+	}
+	StelPainter::submitText();
+}
+
+QVector<StelFrameProfiler::FrameTimes> StelFrameProfiler::getRecordedFrames() const
+{
+	QVector<FrameTimes> result;
+	result.reserve(recordedFrames);
+	qint64 previousStart = -1;
+	const int first = (currentFrame - recordedFrames + 1 + MAX_FRAMES) % MAX_FRAMES;
+	for (int i=0; i<recordedFrames; ++i)
+	{
+		const Frame& f = frames[(first+i) % MAX_FRAMES];
+		if (f.duration==0)
+			continue;	// the current frame
+		FrameTimes t;
+		t.interval = previousStart<0 ? 0 : f.start - previousStart;
+		t.cpu = f.duration;
+		t.gpu = -1;
+		if (f.querySet<0)
+		{
+			for (const auto& e : f.events)
+			{
+				if (e.gpuDuration>=0)
+					t.gpu = qMax(t.gpu, 0LL) + e.gpuDuration;
+			}
+		}
+		std::copy(f.counters, f.counters+CounterCount, t.counters);
+		result.append(t);
+		previousStart = f.start;
+	}
+	return result;
+}
+
+QMap<QString, double> StelFrameProfiler::getModuleTimes(int frameCount) const
+{
+	QMap<QString, double> times;
+	int n = 0;
+	for (int i=0; i<recordedFrames && n<frameCount; ++i)
+	{
+		const Frame& f = frames[(currentFrame - i + MAX_FRAMES) % MAX_FRAMES];
+		if (f.duration==0)
+			continue;	// the current frame
+		for (const auto& e : f.events)
+			times[e.name + (e.draw ? " draw" : " update")] += e.duration;
+		++n;
+	}
+	for (auto& t : times)
+		t /= 1e6*n;
+	return times;
+}
+
+bool StelFrameProfiler::exportChromeTrace(const QString& fileName)
+{
+	if (recordedFrames==0)
+	{
+		qWarning() << "Frame profiler: no recorded frame to export, enable the profiler first";
+		return false;
+	}
+	QString path = fileName;
+	if (path.isEmpty())
+	{
+		try
+		{
+			path = StelFileMgr::getScreenshotDir() + "/frame_profile-" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + ".json";
+		}
+		catch (std::runtime_error& e)
+		{
+			qWarning() << "Frame profiler: no directory for the trace:" << e.what();
+			return false;
+		}
+	}
+
+	// The trace event times are in microseconds. TIME_ELAPSED queries give no timestamp, so the GPU
+	// events of a frame are placed one after the other from the start of its first draw.
+	QJsonArray events;
+	QJsonObject cpuThread;
+	cpuThread["name"] = "thread_name";
+	cpuThread["ph"] = "M";
+	cpuThread["pid"] = 1;
+	cpuThread["tid"] = 1;
+	cpuThread["args"] = QJsonObject{{"name", "CPU"}};
+	events.append(cpuThread);
+	QJsonObject gpuThread = cpuThread;
+	gpuThread["tid"] = 2;
+	gpuThread["args"] = QJsonObject{{"name", "GPU (durations only)"}};
+	events.append(gpuThread);
+
+	const int first = (currentFrame - recordedFrames + 1 + MAX_FRAMES) % MAX_FRAMES;
+	for (int i=0; i<recordedFrames; ++i)
+	{
+		const Frame& f = frames[(first+i) % MAX_FRAMES];
+		if (f.duration==0)
+			continue;	// the current frame
+		QJsonObject frame;
+		frame["name"] = "Frame";
+		frame["cat"] = "frame";
+		frame["ph"] = "X";
+		frame["pid"] = 1;
+		frame["tid"] = 1;
+		frame["ts"] = f.start/1000.;
+		frame["dur"] = f.duration/1000.;
+		events.append(frame);
+
+		qint64 gpuTime = -1;
+		for (const auto& e : f.events)
+		{
+			QJsonObject call;
+			call["name"] = e.name;
+			call["cat"] = e.draw ? "draw" : "update";
+			call["ph"] = "X";
+			call["pid"] = 1;
+			call["tid"] = 1;
+			call["ts"] = e.start/1000.;
+			call["dur"] = e.duration/1000.;
+			events.append(call);
+			if (e.gpuDuration>=0)
+			{
+				gpuTime = qMax(gpuTime, e.start);
+				call["tid"] = 2;
+				call["cat"] = "gpu";
+				call["ts"] = gpuTime/1000.;
+				call["dur"] = e.gpuDuration/1000.;
+				events.append(call);
+				gpuTime += e.gpuDuration;
+			}
+		}
+
+		QJsonObject args;
+		for (int c=0; c<CounterCount; ++c)
+			args[getCounterName(static_cast<Counter>(c))] = f.counters[c];
+		QJsonObject counterEvent;
+		counterEvent["name"] = "Counters";
+		counterEvent["ph"] = "C";
+		counterEvent["pid"] = 1;
+		counterEvent["ts"] = f.start/1000.;
+		counterEvent["args"] = args;
+		events.append(counterEvent);
+	}
+
+	QSaveFile file(path);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		qWarning() << "Frame profiler: cannot write" << QDir::toNativeSeparators(path);
+		return false;
+	}
+	QJsonObject root;
+	root["traceEvents"] = events;
+	root["displayTimeUnit"] = "ms";
+	file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+	if (!file.commit())
+	{
+		qWarning() << "Frame profiler: cannot write" << QDir::toNativeSeparators(path);
+		return false;
+	}
+	qDebug() << "Frame profiler: trace of" << recordedFrames << "frames saved to" << QDir::toNativeSeparators(path);
+	return true;
+}
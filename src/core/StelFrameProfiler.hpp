@@ -0,0 +1,192 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STELFRAMEPROFILER_HPP
+#define STELFRAMEPROFILER_HPP
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+
+class QOpenGLTimerQuery;
+class QSettings;
+class StelCore;
+
+//! @class StelFrameProfiler
+//! Measures the CPU time of the update and draw of each module, the GPU time of the draws, and counts
+//! draw calls, vertices, texture uploads, stars, DSOs and satellites of each frame.
+//! The last frames are kept, for an on-screen overlay (see drawOverlay()) and for exportChromeTrace(), which
+//! writes them in the JSON trace format of chrome://tracing and Perfetto.
+//! The GPU time is measured with GL_TIME_ELAPSED queries, which are read a few frames later so that the frames
+//! do not wait for the GPU. It is not available with OpenGL ES, nor without ARB_timer_query.
+//! While the profiler is disabled, which is the default, the instrumented code only tests a static flag.
+class StelFrameProfiler : public QObject
+{
+	Q_OBJECT
+	Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+	Q_PROPERTY(bool overlayVisible READ isOverlayVisible WRITE setOverlayVisible NOTIFY overlayVisibleChanged)
+
+public:
+	enum Counter
+	{
+		DrawCalls,
+		Vertices,
+		TextureUploads,
+		StarsDrawn,
+		DSOsDrawn,
+		SatellitesPropagated,
+		CounterCount
+	};
+
+	StelFrameProfiler();
+	//! Releases the GPU queries, the GL context must be current.
+	~StelFrameProfiler();
+
+	//! Read the settings devel/flag_frame_profiler and devel/flag_frame_profiler_overlay.
+	void init(QSettings* conf);
+
+	static bool isEnabled() { return enabled; }
+	bool isOverlayVisible() const { return overlayVisible; }
+
+	//! Add to a counter of the current frame. Nothing is done while the profiler is disabled.
+	//! Can be called from any thread.
+	static void count(Counter counter, qint64 n=1)
+	{
+		if (enabled)
+			counters[counter].fetch_add(n, std::memory_order_relaxed);
+	}
+
+	//! Start a frame, before the updates of the modules.
+	void beginFrame();
+	//! End the frame, after the draws of the modules. The GL context must be current.
+	void endFrame();
+
+	//! Start measuring a module call, in the main thread.
+	//! @param draw true for a draw, whose GPU time is measured as well
+	void beginCall(bool draw);
+	//! End the measure of the call started by beginCall().
+	void endCall(const QString& moduleName, bool draw);
+
+	//! Draw the times of the costliest modules and the counters of the last measured frame.
+	void drawOverlay(StelCore* core);
+
+	//! The times of a recorded frame, see getRecordedFrames()
+	struct FrameTimes
+	{
+		//! Since the start of the previous frame, which includes the waits for the GPU and vsync, 0 for the first frame [ns]
+		qint64 interval;
+		//! From beginFrame() to endFrame() [ns]
+		qint64 cpu;
+		//! Sum of the GPU times of the draws, -1 while unknown or unavailable [ns]
+		qint64 gpu;
+		qint64 counters[CounterCount];
+	};
+	//! Get the recorded frames which ended, from the oldest. The last 600 frames are kept.
+	QVector<FrameTimes> getRecordedFrames() const;
+
+	//! Get the mean CPU time of each module call in the last recorded frames, e.g. "StarMgr draw".
+	//! @param frameCount the number of frames, from the last one which ended
+	//! @return the times in ms, empty while the profiler is disabled
+	QMap<QString, double> getModuleTimes(int frameCount) const;
+
+	//! Get the name of a counter, as shown by the overlay and written in the traces.
+	static const char* getCounterName(Counter counter);
+
+public slots:
+	//! Enable or disable the measures. The recorded frames are dropped when disabled.
+	void setEnabled(bool b);
+	//! Show or hide the overlay, showing it enables the profiler.
+	void setOverlayVisible(bool b);
+
+	//! Write the recorded frames in the Chrome trace event format.
+	//! @param fileName the file, by default frame_profile-<date>.json in the screenshot directory
+	//! @return false if there is no recorded frame, or the file can not be written
+	bool exportChromeTrace(const QString& fileName=QString());
+
+signals:
+	void enabledChanged(bool b);
+	void overlayVisibleChanged(bool b);
+
+private:
+	//! A module call
+	struct Event
+	{
+		QString name;
+		bool draw;
+		//! Since the start of the profiler, in ns
+		qint64 start;
+		qint64 duration;
+		//! -1 while unknown or unavailable
+		qint64 gpuDuration;
+		//! Index in the queries of the frame, -1 for none
+		int query;
+	};
+
+	struct Frame
+	{
+		Frame() : start(0), duration(0), querySet(-1) {}
+		qint64 start;
+		qint64 duration;
+		QVector<Event> events;
+		qint64 counters[CounterCount];
+		//! Index of the queries of the frame in querySets, -1 when they were read
+		int querySet;
+	};
+
+	//! The GPU queries of a frame, reused a few frames later
+	struct QuerySet
+	{
+		QuerySet() : used(0), frame(-1) {}
+		QVector<QOpenGLTimerQuery*> queries;
+		int used;
+		//! The frame whose results are not read yet, or -1
+		int frame;
+	};
+
+	//! Return the next free GPU query of the current frame, creating it if needed, or Q_NULLPTR if unavailable.
+	QOpenGLTimerQuery* nextQuery();
+	//! Read the results of the queries of a set into the events of its frame, if they are available.
+	//! @param wait wait for the results, else leave the set pending if they are not available yet
+	void readQuerySet(int set, bool wait);
+	void releaseQueries();
+
+	static bool enabled;
+	static std::atomic<qint64> counters[CounterCount];
+
+	bool overlayVisible;
+	QElapsedTimer clock;
+	//! The recorded frames, the current one is at currentFrame
+	QVector<Frame> frames;
+	int currentFrame;
+	int recordedFrames;
+	bool frameOpen;
+	QVector<QuerySet> querySets;
+	//! Whether timer queries are available; -1 before the first try
+	int gpuTimersAvailable;
+	QOpenGLTimerQuery* activeQuery;
+	qint64 callStart;
+	//! The last frame whose GPU times are all known, for the overlay
+	int lastCompleteFrame;
+};
+
+#endif // STELFRAMEPROFILER_HPP
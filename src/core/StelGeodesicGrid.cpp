@@ -88,7 +88,7 @@ static const TopLevelTriangle icosahedron_triangles[20] =
         {{ 8, 9, 5}}  //  8
     };
 
-StelGeodesicGrid::StelGeodesicGrid(const int lev) : maxLevel(lev<0?0:lev), lastMaxSearchlevel(-1)
+StelGeodesicGrid::StelGeodesicGrid(const int lev) : maxLevel(lev<0?0:lev)
 {
 	if (maxLevel > 0)
 	{
@@ -112,7 +112,6 @@ StelGeodesicGrid::StelGeodesicGrid(const int lev) : maxLevel(lev<0?0:lev), lastM
 	{
 		triangles = 0;
 	}
-	cacheSearchResult = new GeodesicSearchResult(*this);
 }
 
 StelGeodesicGrid::~StelGeodesicGrid(void)
@@ -122,8 +121,9 @@ StelGeodesicGrid::~StelGeodesicGrid(void)
 		for (int i=maxLevel-1;i>=0;i--) delete[] triangles[i];
 		delete[] triangles;
 	}
-	delete cacheSearchResult;
-	cacheSearchResult = Q_NULLPTR;
+	for (const auto& cached : searchCache)
+		delete cached.result;
+	searchCache.clear();
 }
 
 void StelGeodesicGrid::getTriangleCorners(int lev,int index,
@@ -317,6 +317,34 @@ void StelGeodesicGrid::searchZones(const QVector<SphericalCap>& convex,
 {
 	if (maxSearchLevel < 0) maxSearchLevel = 0;
 	else if (maxSearchLevel > maxLevel) maxSearchLevel = maxLevel;
+
+	// Usual searches have a few caps: test them as bit masks, without virtual calls nor allocations.
+	if (convex.size()<=SearchPlanes::maxSize)
+	{
+		SearchPlanes planes;
+		planes.size = convex.size();
+		for (int h=0;h<planes.size;h++)
+		{
+			const SphericalCap& half_space(convex.at(h));
+			planes.nx[h] = half_space.n[0];
+			planes.ny[h] = half_space.n[1];
+			planes.nz[h] = half_space.n[2];
+			planes.d[h] = half_space.d;
+		}
+		const quint64 allCaps = planes.size==SearchPlanes::maxSize ? ~quint64(0) : (quint64(1)<<planes.size)-1;
+		quint64 corner_inside[12];
+		for (int i=0;i<12;i++)
+			corner_inside[i] = planes.containsMask(icosahedron_corners[i]);
+		for (int i=0;i<20;i++)
+		{
+			const int *const corners = icosahedron_triangles[i].corners;
+			searchZones(0,i,planes,allCaps,
+				    corner_inside[corners[0]],corner_inside[corners[1]],corner_inside[corners[2]],
+				    inside_list,border_list,maxSearchLevel);
+		}
+		return;
+	}
+
 #if defined __STRICT_ANSI__ || !defined __GNUC__
 	int *halfs_used = new int[convex.size()];
 #else
@@ -450,21 +478,75 @@ end:
 	return;
 }
 
+void StelGeodesicGrid::searchZones(int lev,int index,
+				   const SearchPlanes& planes,
+				   quint64 usedCaps,
+				   quint64 corner0Inside,
+				   quint64 corner1Inside,
+				   quint64 corner2Inside,
+				   int **inside_list,int **border_list,
+				   const int maxSearchLevel) const
+{
+	// totally outside a SphericalCap
+	if (usedCaps & ~(corner0Inside|corner1Inside|corner2Inside))
+		return;
+	// on the border of these SphericalCaps
+	const quint64 borderCaps = usedCaps & ~(corner0Inside&corner1Inside&corner2Inside);
+	if (borderCaps == 0)
+	{
+		// this triangle(lev,index) lies inside all halfspaces
+		**inside_list = index;
+		(*inside_list)++;
+		return;
+	}
+	(*border_list)--;
+	**border_list = index;
+	if (lev < maxSearchLevel)
+	{
+		const Triangle &t(triangles[lev][index]);
+		lev++;
+		index <<= 2;
+		inside_list++;
+		border_list++;
+		const quint64 edge0Inside = planes.containsMask(t.e0);
+		const quint64 edge1Inside = planes.containsMask(t.e1);
+		const quint64 edge2Inside = planes.containsMask(t.e2);
+		searchZones(lev,index+0,planes,borderCaps,corner0Inside,edge2Inside,edge1Inside,inside_list,border_list,maxSearchLevel);
+		searchZones(lev,index+1,planes,borderCaps,edge2Inside,corner1Inside,edge0Inside,inside_list,border_list,maxSearchLevel);
+		searchZones(lev,index+2,planes,borderCaps,edge1Inside,edge0Inside,corner2Inside,inside_list,border_list,maxSearchLevel);
+		searchZones(lev,index+3,planes,borderCaps,edge0Inside,edge1Inside,edge2Inside,inside_list,border_list,maxSearchLevel);
+	}
+}
+
 /*************************************************************************
  Return a search result matching the given spatial region
 *************************************************************************/
 const GeodesicSearchResult* StelGeodesicGrid::search(const QVector<SphericalCap>& convex, int maxSearchLevel) const
 {
-	// Try to use the cached version
-	if (maxSearchLevel==lastMaxSearchlevel && convex==lastSearchRegion)
+	// Try to use a cached version
+	for (int i=0;i<searchCache.size();i++)
+	{
+		if (searchCache.at(i).maxSearchLevel==maxSearchLevel && searchCache.at(i).region==convex)
+		{
+			if (i>0)
+				searchCache.move(i, 0);
+			return searchCache.first().result;
+		}
+	}
+	// Else recompute it in the least recently used entry
+	if (searchCache.size()<searchCacheSize)
 	{
-		return cacheSearchResult;
+		CachedSearch cached;
+		cached.result = new GeodesicSearchResult(*this);
+		searchCache.prepend(cached);
 	}
-	// Else recompute it and update cache parameters
-	lastMaxSearchlevel = maxSearchLevel;
-	lastSearchRegion = convex;
-	cacheSearchResult->search(convex, maxSearchLevel);
-	return cacheSearchResult;
+	else
+		searchCache.move(searchCache.size()-1, 0);
+	CachedSearch& cached = searchCache.first();
+	cached.maxSearchLevel = maxSearchLevel;
+	cached.region = convex;
+	cached.result->search(convex, maxSearchLevel);
+	return cached.result;
 }
 
 
@@ -77,7 +77,9 @@ public:
 	int getPartnerTriangle(int lev, int index) const;
 	
 	//! Return a search result matching the given spatial region
-	//! The result is cached, meaning that it is very fast to search the same region consecutively
+	//! The results of the last searches are cached, meaning that it is very fast to search again one
+	//! of the regions searched recently, also when searches of other regions are done in between.
+	//! A result stays valid until searchCacheSize searches for other regions have been done.
 	//! @return a GeodesicSearchResult instance which must be used with GeodesicSearchBorderIterator and GeodesicSearchInsideIterator
 	const GeodesicSearchResult* search(const QVector<SphericalCap>& convex, int maxSearchLevel) const;
 
@@ -102,6 +104,33 @@ private:
 	void searchZones(const QVector<SphericalCap>& convex,
 					 int **inside,int **border,int maxSearchLevel) const;
 	
+	//! The caps of a search, flattened so that a point is tested against all of them in one loop.
+	//! Bit h of the masks used with it is set when a point is inside cap h.
+	struct SearchPlanes
+	{
+		//! Maximal number of caps, the number of bits of the masks.
+		static const int maxSize = 64;
+		int size;
+		double nx[maxSize], ny[maxSize], nz[maxSize], d[maxSize];
+		//! Return the mask of the caps containing v, same as SphericalCap::contains().
+		quint64 containsMask(const Vec3f& v) const
+		{
+			quint64 mask = 0;
+			for (int h=0;h<size;h++)
+				mask |= quint64(v[0]*nx[h]+v[1]*ny[h]+v[2]*nz[h]>=d[h]) << h;
+			return mask;
+		}
+	};
+	//! Same as the recursive searchZones() below, with the caps given as SearchPlanes, and
+	//! the caps used and the caps containing each corner as bit masks.
+	void searchZones(int lev,int index,
+			 const SearchPlanes& planes,
+			 quint64 usedCaps,
+			 quint64 corner0Inside,
+			 quint64 corner1Inside,
+			 quint64 corner2Inside,
+			 int **inside,int **border,int maxSearchLevel) const;
+
 	const Vec3f& getTriangleCorner(int lev, int index, int cornerNumber) const;
 	void initTriangle(int lev,int index,
 					  const Vec3f &c0,
@@ -133,9 +162,16 @@ private:
 	// 2+10*4^n corners
 	
 	//! A cached search result used to avoid doing twice the same search
-	mutable GeodesicSearchResult* cacheSearchResult;
-	mutable int lastMaxSearchlevel;
-	mutable QVector<SphericalCap> lastSearchRegion;
+	struct CachedSearch
+	{
+		GeodesicSearchResult* result;
+		int maxSearchLevel;
+		QVector<SphericalCap> region;
+	};
+	//! Number of cached search results.
+	static const int searchCacheSize = 4;
+	//! Cached search results, the most recently used first
+	mutable QVector<CachedSearch> searchCache;
 };
 
 class GeodesicSearchResult
@@ -24,6 +24,9 @@
 #include "StelTextureMgr.hpp"
 #include "StelUtils.hpp"
 #include "StelProgressController.hpp"
+#include "StelMovementMgr.hpp"
+#include "StelFileCache.hpp"
+#include "StelHipsPack.hpp"
 
 #include <QNetworkReply>
 #include <QTimeLine>
@@ -43,10 +46,16 @@ public:
 	StelTextureSP texture = StelTextureSP(NULL);
 	StelTextureSP allsky = StelTextureSP(NULL); // allsky low res version of the texture.
 
+	// Vertices of the tile split in a grid of gridSize x gridSize quads, see HipsSurvey::getTileVertices().
+	QVector<Vec3d> verts;
+	int gridSize = 0;
+
 	// Used for smooth fade in
 	QTimeLine texFader;
 };
 
+QSharedPointer<StelFileCache> HipsSurvey::diskCache;
+
 static QString getExt(const QString& format)
 {
 	for (auto ext : format.split(' '))
@@ -75,36 +84,66 @@ HipsSurvey::HipsSurvey(const QString& url_, double releaseDate_):
 	nbLoadedTiles(0)
 {
 	// Immediatly download the properties.
-	QNetworkRequest req = QNetworkRequest(getUrlFor("properties"));
+	const QUrl propertiesUrl = getUrlFor("properties");
+	QNetworkRequest req = QNetworkRequest(propertiesUrl);
 	req.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
 	req.setRawHeader("User-Agent", StelUtils::getUserAgentString().toLatin1());
 	QNetworkReply* networkReply = StelApp::getInstance().getNetworkAccessManager()->get(req);
-	connect(networkReply, &QNetworkReply::finished, [&, networkReply] {
+	connect(networkReply, &QNetworkReply::finished, [&, networkReply, propertiesUrl] {
 		QByteArray data = networkReply->readAll();
-		for (QString line : data.split('\n'))
-		{
-			if (line.startsWith("#")) continue;
-			QString key = line.section("=", 0, 0).trimmed();
-			if (key.isEmpty()) continue;
-			QString value = line.section("=", 1, -1).trimmed();
-			properties[key] = value;
-		}
-		if (properties.contains("hips_release_date"))
+		const QString key = propertiesUrl.url();
+		// When offline, use the properties of the last session.
+		if (networkReply->error() == QNetworkReply::NoError && !data.isEmpty())
 		{
-			// XXX: StelUtils::getJulianDayFromISO8601String does not work
-			// without the seconds!
-			QDateTime date = QDateTime::fromString(properties["hips_release_date"].toString(), Qt::ISODate);
-			releaseDate = StelUtils::qDateTimeToJd(date);
+			if (diskCache && propertiesUrl.scheme() != "file")
+				diskCache->write(key, data);
 		}
-		if (properties.contains("hips_frame"))
-			hipsFrame = properties["hips_frame"].toString();
-
+		else if (diskCache)
+			data = diskCache->read(key);
+		if (!data.isEmpty())
+			parseProperties(data);
 		emit propertiesChanged();
 		emit statusChanged();
 		networkReply->deleteLater();
 	});
 }
 
+void HipsSurvey::parseProperties(const QByteArray& data)
+{
+	propertiesData = data;
+	for (QString line : data.split('\n'))
+	{
+		if (line.startsWith("#")) continue;
+		QString key = line.section("=", 0, 0).trimmed();
+		if (key.isEmpty()) continue;
+		QString value = line.section("=", 1, -1).trimmed();
+		properties[key] = value;
+	}
+	if (properties.contains("hips_release_date"))
+	{
+		// XXX: StelUtils::getJulianDayFromISO8601String does not work
+		// without the seconds!
+		QDateTime date = QDateTime::fromString(properties["hips_release_date"].toString(), Qt::ISODate);
+		releaseDate = StelUtils::qDateTimeToJd(date);
+	}
+	if (properties.contains("hips_frame"))
+		hipsFrame = properties["hips_frame"].toString();
+}
+
+void HipsSurvey::setPack(const QSharedPointer<HipsPack>& apack)
+{
+	pack = apack;
+	// Tiles already created are not read from the pack.
+	tiles.clear();
+	prefetchedTiles.clear();
+	if (pack && properties.isEmpty())
+	{
+		parseProperties(pack->getProperties());
+		emit propertiesChanged();
+		emit statusChanged();
+	}
+}
+
 HipsSurvey::~HipsSurvey()
 {
 
@@ -150,10 +189,27 @@ bool HipsSurvey::getAllsky()
 {
 	if (!allsky.isNull() || noAllsky) return true;
 	if (properties.isEmpty()) return false;
+	QString ext = getExt(properties["hips_tile_format"].toString());
+	QUrl path = getUrlFor(QString("Norder%1/Allsky.%2").arg(getPropertyInt("hips_order_min", 3)).arg(ext));
 	if (!networkReply)
 	{
-		QString ext = getExt(properties["hips_tile_format"].toString());
-		QUrl path = getUrlFor(QString("Norder%1/Allsky.%2").arg(getPropertyInt("hips_order_min", 3)).arg(ext));
+		// Use the allsky image of the pack or of the disk cache if there is one.
+		QByteArray data;
+		if (pack)
+			data = pack->getAllsky();
+		if (data.isEmpty() && diskCache)
+			data = diskCache->read(path.url());
+		if (!data.isEmpty())
+		{
+			allsky = QImage::fromData(data);
+			if (!allsky.isNull())
+			{
+				allskyData = data;
+				emit statusChanged();
+				return true;
+			}
+		}
+
 		qDebug() << "Load allsky" << path;
 		QNetworkRequest req = QNetworkRequest(path);
 		req.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
@@ -172,6 +228,12 @@ bool HipsSurvey::getAllsky()
 		qDebug() << "got allsky";
 		QByteArray data = networkReply->readAll();
 		allsky = QImage::fromData(data);
+		if (!allsky.isNull())
+		{
+			allskyData = data;
+			if (diskCache && path.scheme() != "file")
+				diskCache->write(path.url(), data);
+		}
 		delete networkReply;
 		networkReply = NULL;
 		emit statusChanged();
@@ -198,7 +260,9 @@ void HipsSurvey::draw(StelPainter* sPainter, double angle, HipsSurvey::DrawCallb
 	// Set the projection.
 	StelCore* core = StelApp::getInstance().getCore();
 	StelCore::FrameType frame = StelCore::FrameUninitialized;
-	if (hipsFrame == "galactic")
+	if (drawnInPainterFrame)
+		frame = StelCore::FrameUninitialized;
+	else if (hipsFrame == "galactic")
 		frame = StelCore::FrameGalactic;
 	else if (hipsFrame == "equatorial")
 		frame = StelCore::FrameJ2000;
@@ -216,19 +280,47 @@ void HipsSurvey::draw(StelPainter* sPainter, double angle, HipsSurvey::DrawCallb
 	int drawOrder = ceil(log2(px / (4.0 * sqrt(2.0) * tileWidth)));
 	drawOrder = qBound(orderMin, drawOrder, order);
 	int splitOrder = qMax(drawOrder, 4);
+	SphericalCap visibleRegion = sPainter->getProjector()->getBoundingCap();
+	if (!outside)
+	{
+		// The order of the tiles of planetary surveys is chosen for each tile from its size on screen,
+		// and only the tiles facing the observer are drawn.
+		drawOrder = order;
+		splitOrder = 4;
+		visibleRegion = getFacingCap(sPainter->getProjector());
+	}
 
 	nbVisibleTiles = 0;
 	nbLoadedTiles = 0;
 
 	// Draw the 12 root tiles and their children.
-	const SphericalCap& viewportRegion = sPainter->getProjector()->getBoundingCap();
 	for (int i = 0; i < 12; i++)
 	{
-		drawTile(0, i, drawOrder, splitOrder, outside, viewportRegion, sPainter, callback);
+		drawTile(0, i, drawOrder, splitOrder, outside, visibleRegion, sPainter, callback);
 	}
 
 	updateProgressBar(nbLoadedTiles, nbVisibleTiles);
 
+	// Planetary surveys are drawn with the view of their planet, which is not the aim of the movement.
+	if (outside && frame)
+		prefetchTiles(px, tileWidth, orderMin, order);
+
+}
+
+SphericalCap HipsSurvey::getFacingCap(const StelProjectorP& prj)
+{
+	// The position of the observer relative to the unit sphere of the tiles. The model view transform
+	// of planets also scales the sphere to the spheroid of the planet: as this transform is affine,
+	// the points of the unit sphere seen from there are the points of the spheroid seen by the observer.
+	Vec3d eye(0.);
+	prj->getModelViewTransform()->backward(eye);
+	const double dist = eye.length();
+	if (dist <= 1.)
+		return SphericalCap(Vec3d(1., 0., 0.), -1.);
+	eye /= dist;
+	// A point p is seen if p.eye > 1/dist. The margin keeps the tiles whose flat triangles
+	// are still visible over the horizon.
+	return SphericalCap(eye, 1. / dist - 0.01);
 }
 
 void HipsSurvey::updateProgressBar(int nb, int total)
@@ -248,6 +340,169 @@ void HipsSurvey::updateProgressBar(int nb, int total)
 	progressBar->setValue(100 * nb / total);
 }
 
+QString HipsSurvey::getTileUrl(int order, int pix)
+{
+	QString ext = getExt(properties["hips_tile_format"].toString());
+	QUrl path = getUrlFor(QString("Norder%1/Dir%2/Npix%3.%4").arg(order).arg((pix / 10000) * 10000).arg(pix).arg(ext));
+	return path.url();
+}
+
+void HipsSurvey::collectTiles(int order, int pix, int maxOrder, int orderMin, const SphericalCap& cap, QVector<QPair<int, int>>& result) const
+{
+	SphericalCap boundingCap;
+	healpix_pix2vec(1 << order, pix, boundingCap.n.v);
+	boundingCap.d = cos(M_PI / 2.0 / (1 << order));
+	if (!cap.intersects(boundingCap))
+		return;
+	// Like in drawTile(), all the orders from orderMin are loaded on the way to maxOrder.
+	if (order >= orderMin)
+		result.append(qMakePair(order, pix));
+	if (order < maxOrder)
+	{
+		for (int i = 0; i < 4; i++)
+			collectTiles(order + 1, pix * 4 + i, maxOrder, orderMin, cap, result);
+	}
+}
+
+void HipsSurvey::prefetchTiles(double px, int tileWidth, int orderMin, int order)
+{
+	StelCore* core = StelApp::getInstance().getCore();
+	const StelMovementMgr* mvmgr = core->getMovementMgr();
+	if (!mvmgr->isAutoMoving())
+	{
+		// The tiles drawn at the end of the movement hold their own reference to the textures by now.
+		prefetchedTiles.clear();
+		return;
+	}
+
+	const Vec3d aim = mvmgr->getAimViewDirectionJ2000();
+	const double aimFov = mvmgr->getAimFov();
+	// The aim only changes with a new movement, or slightly when following a moving object.
+	if (aimFov == prefetchFov && aim.angle(prefetchAim) < 1e-4)
+		return;
+	prefetchAim = aim;
+	prefetchFov = aimFov;
+
+	const double currentFov = mvmgr->getCurrentFov();
+	Vec3d start = mvmgr->getViewDirectionJ2000();
+	start.normalize();
+	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
+	const double aspect = static_cast<double>(prj->getViewportWidth()) / qMax(1, prj->getViewportHeight());
+
+	// The destination view first, then the intermediate views along the path.
+	const int nbSteps = 8;
+	QVector<QPair<int, int>> needed;
+	for (int step = nbSteps; step > 0; --step)
+	{
+		const double t = static_cast<double>(step) / nbSteps;
+		Vec3d dir = start * (1. - t) + aim * t;
+		if (dir.length() < 1e-6)
+			dir = aim;
+		dir.normalize();
+		if (hipsFrame == "galactic")
+			dir = core->j2000ToGalactic(dir);
+		const double fov = currentFov + (aimFov - currentFov) * t;
+		const int stepOrder = qBound(orderMin, static_cast<int>(ceil(log2(px * currentFov / fov / (4.0 * sqrt(2.0) * tileWidth)))), order);
+		const double radius = qMin(M_PI, 0.5 * fov * M_PI / 180. * sqrt(1. + aspect * aspect));
+		const SphericalCap cap(dir, cos(radius));
+		for (int i = 0; i < 12; i++)
+			collectTiles(0, i, stepOrder, orderMin, cap, needed);
+	}
+
+	// Do not fill the cache of tiles with tiles which would be evicted before being drawn.
+	const int maxPrefetchedTiles = tiles.maxCost() / 4;
+	StelTextureMgr& texMgr = StelApp::getInstance().getTextureManager();
+	QHash<long int, StelTextureSP> newTiles;
+	for (const auto& p : needed)
+	{
+		if (newTiles.size() >= maxPrefetchedTiles)
+			break;
+		const int nside = 1 << p.first;
+		const long int uid = p.second + 4L * nside * nside;
+		if (newTiles.contains(uid) || tiles.contains(uid))
+			continue;
+		StelTextureSP tex = prefetchedTiles.value(uid);
+		if (!tex)
+		{
+			// Tiles of the pack are read from the disk anyway.
+			if (pack && pack->contains(p.first, p.second))
+				continue;
+			tex = createTileTexture(p.first, p.second, true);
+			if (!tex)
+				continue;
+			// Below the tiles of the current view, which are loaded with the default priority 0.
+			tex->setLoadPriority(-1.f);
+			tex->startLoading();
+		}
+		newTiles.insert(uid, tex);
+	}
+	// Releasing the textures of the previous plan aborts their downloads.
+	prefetchedTiles = newTiles;
+}
+
+StelTextureSP HipsSurvey::createTileTexture(int order, int pix, bool lazyLoading)
+{
+	StelTextureMgr& texMgr = StelApp::getInstance().getTextureManager();
+	const StelTexture::StelTextureParams params(true);
+	if (pack && pack->contains(order, pix))
+	{
+		const QSharedPointer<HipsPack> tilePack = pack;
+		return texMgr.createTextureThread([tilePack, order, pix]() { return QImage::fromData(tilePack->readTile(order, pix)); }, params);
+	}
+
+	const QString tileUrl = getTileUrl(order, pix);
+	const QSharedPointer<StelFileCache> cache = diskCache;
+	if (!cache || tileUrl.startsWith("file:", Qt::CaseInsensitive))
+		return texMgr.createTextureThread(tileUrl, params, lazyLoading);
+
+	// The tile files are kept instead of the decoded textures, which use about ten times more space.
+	StelTextureSP tex;
+	if (cache->contains(tileUrl))
+	{
+		cache->touch(tileUrl);
+		tex = texMgr.createTextureThread(cache->getFilePath(tileUrl), params, lazyLoading);
+	}
+	else
+	{
+		tex = texMgr.createTextureThread(tileUrl, params, lazyLoading);
+		if (tex)
+			tex->setDownloadHandler([cache, tileUrl](const QByteArray& data) { cache->write(tileUrl, data); });
+	}
+	if (tex)
+		tex->setDiskCacheEnabled(false);
+	return tex;
+}
+
+HipsPackBuilder* HipsSurvey::createPack(const QString& fileName, const Vec3d& center, double radius, int minOrder, int maxOrder)
+{
+	if (properties.isEmpty())
+		return Q_NULLPTR;
+	const int orderMin = qMax(minOrder, getPropertyInt("hips_order_min", 3));
+	const int orderMax = qMin(maxOrder, getPropertyInt("hips_order"));
+	QVector<QPair<int, int>> region;
+	const SphericalCap cap(center, cos(radius));
+	for (int i = 0; i < 12; i++)
+		collectTiles(0, i, orderMax, orderMin, cap, region);
+
+	QVector<HipsPackBuilder::Tile> packTiles;
+	packTiles.reserve(region.size());
+	for (const auto& p : region)
+	{
+		HipsPackBuilder::Tile tile;
+		tile.order = p.first;
+		tile.pix = p.second;
+		tile.url = getTileUrl(p.first, p.second);
+		packTiles.append(tile);
+	}
+	HipsPackBuilder* builder = new HipsPackBuilder(fileName, url, propertiesData, allskyData, packTiles, getTitle());
+	if (!builder->start())
+	{
+		delete builder;
+		return Q_NULLPTR;
+	}
+	return builder;
+}
+
 HipsTile* HipsSurvey::getTile(int order, int pix)
 {
 	int nside = 1 << order;
@@ -260,9 +515,10 @@ HipsTile* HipsSurvey::getTile(int order, int pix)
 		tile = new HipsTile();
 		tile->order = order;
 		tile->pix = pix;
-		QString ext = getExt(properties["hips_tile_format"].toString());
-		QUrl path = getUrlFor(QString("Norder%1/Dir%2/Npix%3.%4").arg(order).arg((pix / 10000) * 10000).arg(pix).arg(ext));
-		tile->texture = texMgr.createTextureThread(path.url(), StelTexture::StelTextureParams(true), false);
+		// Use the texture started by prefetchTiles() if there is one.
+		tile->texture = prefetchedTiles.value(uid);
+		if (!tile->texture)
+			tile->texture = createTileTexture(order, pix, false);
 		tiles.insert(uid, tile);
 
 		// Use the allsky image until we load the full texture.
@@ -272,8 +528,10 @@ HipsTile* HipsSurvey::getTile(int order, int pix)
 			int x = (pix % nbw) * allsky.width() / nbw;
 			int y = (pix / nbw) * allsky.width() / nbw;
 			int s = allsky.width() / nbw;
-			QImage image = allsky.copy(x, y, s, s);
-			tile->allsky = texMgr.createTexture(image, StelTexture::StelTextureParams(true));
+			// The copy of the allsky image shares its data, the tile is cut in a loader job.
+			const QImage allskyImage = allsky;
+			tile->allsky = texMgr.createTextureThread([allskyImage, x, y, s]() { return allskyImage.copy(x, y, s, s); },
+								  StelTexture::StelTextureParams(true));
 		}
 	}
 	return tile;
@@ -306,32 +564,28 @@ static bool isClipped(int n, double (*pos)[4])
 
 
 void HipsSurvey::drawTile(int order, int pix, int drawOrder, int splitOrder, bool outside,
-						  const SphericalCap& viewportShape, StelPainter* sPainter, DrawCallback callback)
+						  const SphericalCap& visibleRegion, StelPainter* sPainter, DrawCallback callback)
 {
 	Vec3d pos;
 	Mat3d mat3;
 	Vec2f uv[4] = {Vec2f(0, 0), Vec2f(0, 1), Vec2f(1, 0), Vec2f(1, 1)};
 	HipsTile *tile;
 	int orderMin = getPropertyInt("hips_order_min", 3);
-	QVector<Vec3d> vertsArray;
-	QVector<Vec2f> texArray;
-	QVector<uint16_t> indicesArray;
-	int nb;
 	Vec4f color = sPainter->getColor();
 	float alpha;
+	// Whether the children of the tile are drawn.
+	bool refine = true;
+	SphericalCap boundingCap;
 
 	healpix_pix2vec(1 << order, pix, pos.v);
 
 	// Check if the tile is visible.  For outside survey (fullsky), we
-	// use bounding cap, otherwise we use proper tile clipping test.
-	if (outside)
-	{
-		SphericalCap boundingCap;
-		boundingCap.n = pos;
-		boundingCap.d = cos(M_PI / 2.0 / (1 << order));
-		if (!viewportShape.intersects(boundingCap)) return;
-	}
-	else
+	// use the bounding cap of the viewport.  For planetary surveys, the
+	// tile must face the observer and pass the proper tile clipping test.
+	boundingCap.n = pos;
+	boundingCap.d = cos(M_PI / 2.0 / (1 << order));
+	if (!visibleRegion.intersects(boundingCap)) return;
+	if (!outside)
 	{
 		double clip_pos[4][4];
 		healpix_get_mat3(1 << order, pix, (double(*)[3])mat3.r);
@@ -350,16 +604,22 @@ void HipsSurvey::drawTile(int order, int pix, int drawOrder, int splitOrder, boo
 		}
 		if (isClipped(4, clip_pos)) return;
 
-		// Also check the culling.
-		if (order > 0)
+		// Refine the tile while it is larger on screen than its texture.
+		// The corners of the tiles below orderMin are too far apart to be meaningful.
+		if (order >= orderMin)
 		{
-			Vec2d u(clip_pos[1][0] - clip_pos[0][0], clip_pos[1][1] - clip_pos[0][1]);
-			Vec2d v(clip_pos[2][0] - clip_pos[0][0], clip_pos[2][1] - clip_pos[0][1]);
-			u.normalize();
-			v.normalize();
-			// XXX: the error (0.5) depends on the order: the higher the order
-			// the lower the error should be.
-			if (u[0] * v[1] - u[1] * v[0] > 0.5) return;
+			const int EDGES[4][2] = {{0, 1}, {0, 2}, {1, 3}, {2, 3}};
+			const double halfWidth = proj->getViewportWidth() * 0.5;
+			const double halfHeight = proj->getViewportHeight() * 0.5;
+			double size = 0.;
+			for (const auto& e : EDGES)
+			{
+				const double dx = (clip_pos[e[0]][0] - clip_pos[e[1]][0]) * halfWidth;
+				const double dy = (clip_pos[e[0]][1] - clip_pos[e[1]][1]) * halfHeight;
+				size = qMax(size, dx * dx + dy * dy);
+			}
+			const int tileWidth = getPropertyInt("hips_tile_width");
+			refine = size > static_cast<double>(tileWidth) * tileWidth;
 		}
 	}
 
@@ -394,55 +654,50 @@ void HipsSurvey::drawTile(int order, int pix, int drawOrder, int splitOrder, boo
 		sPainter->setColor(1, 1, 1, 1);
 	}
 	sPainter->setCullFace(true);
-	nb = fillArrays(order, pix, drawOrder, splitOrder, outside, sPainter,
-					vertsArray, texArray, indicesArray);
-	if (!callback) {
-		sPainter->setArrays(vertsArray.constData(), texArray.constData());
-		sPainter->drawFromArray(StelPainter::Triangles, nb, 0, true, indicesArray.constData());
-	} else {
-		callback(vertsArray, texArray, indicesArray);
+	{
+		// Planetary tiles are split according to their own order, as they are not all drawn at drawOrder.
+		const int gridSize = 1 << qMax(0, splitOrder - (outside ? drawOrder : order));
+		const GridGeometry& grid = getGridGeometry(gridSize, outside);
+		const QVector<Vec3d>& verts = getTileVertices(tile, gridSize);
+		if (!callback) {
+			sPainter->setArrays(verts.constData(), grid.tex.constData());
+			sPainter->drawFromArray(StelPainter::Triangles, grid.indices.size(), 0, true, grid.indices.constData());
+		} else {
+			callback(verts, grid.tex, grid.indices);
+		}
 	}
 
 skip_render:
 	// Draw the children.
-	if (order < drawOrder)
+	if (order < drawOrder && refine)
 	{
 		for (int i = 0; i < 4; i++)
 		{
 			drawTile(order + 1, pix * 4 + i, drawOrder, splitOrder, outside,
-					 viewportShape, sPainter, callback);
+					 visibleRegion, sPainter, callback);
 		}
 	}
 	// Restore the painter color.
 	sPainter->setColor(color[0], color[1], color[2], color[3]);
 }
 
-int HipsSurvey::fillArrays(int order, int pix, int drawOrder, int splitOrder,
-						   bool outside, StelPainter* sPainter,
-						   QVector<Vec3d>& verts, QVector<Vec2f>& tex, QVector<uint16_t>& indices)
+const HipsSurvey::GridGeometry& HipsSurvey::getGridGeometry(int gridSize, bool outside)
 {
-	Mat3d mat3;
-	Vec3d pos;
-	Vec2f texPos;
-	int gridSize = 1 << (splitOrder - drawOrder);
+	const int key = gridSize * 2 + (outside ? 1 : 0);
+	auto it = gridGeometries.find(key);
+	if (it != gridGeometries.end())
+		return *it;
+
+	GridGeometry& grid = gridGeometries[key];
 	int n = gridSize + 1;
 	const int INDICES[2][6][2] = {
 		{{0, 0}, {0, 1}, {1, 0}, {1, 1}, {1, 0}, {0, 1}},
 		{{0, 0}, {1, 0}, {1, 1}, {1, 1}, {0, 1}, {0, 0}},
 	};
-
-	healpix_get_mat3(1 << order, pix, (double(*)[3])mat3.r);
-
 	for (int i = 0; i < n; i++)
 	{
 		for (int j = 0; j < n; j++)
-		{
-			texPos = Vec2f((double)i / gridSize, (double)j / gridSize);
-			pos = mat3 * Vec3d(1.0 - (double)j / gridSize, (double)i / gridSize, 1.0);
-			healpix_xy2vec(pos.v, pos.v);
-			verts << pos;
-			tex << texPos;
-		}
+			grid.tex << Vec2f((double)i / gridSize, (double)j / gridSize);
 	}
 	for (int i = 0; i < gridSize; i++)
 	{
@@ -450,12 +705,36 @@ int HipsSurvey::fillArrays(int order, int pix, int drawOrder, int splitOrder,
 		{
 			for (int k = 0; k < 6; k++)
 			{
-				indices << (INDICES[outside ? 1 : 0][k][1] + i) * n +
+				grid.indices << (INDICES[outside ? 1 : 0][k][1] + i) * n +
 					        INDICES[outside ? 1 : 0][k][0] + j;
 			}
 		}
 	}
-	return gridSize * gridSize * 6;
+	return grid;
+}
+
+const QVector<Vec3d>& HipsSurvey::getTileVertices(HipsTile* tile, int gridSize)
+{
+	if (tile->gridSize == gridSize)
+		return tile->verts;
+
+	Mat3d mat3;
+	Vec3d pos;
+	int n = gridSize + 1;
+	healpix_get_mat3(1 << tile->order, tile->pix, (double(*)[3])mat3.r);
+	tile->verts.clear();
+	tile->verts.reserve(n * n);
+	for (int i = 0; i < n; i++)
+	{
+		for (int j = 0; j < n; j++)
+		{
+			pos = mat3 * Vec3d(1.0 - (double)j / gridSize, (double)i / gridSize, 1.0);
+			healpix_xy2vec(pos.v, pos.v);
+			tile->verts << pos;
+		}
+	}
+	tile->gridSize = gridSize;
+	return tile->verts;
 }
 
 //! Parse a hipslist file into a list of surveys.
@@ -24,6 +24,7 @@
 
 #include <QObject>
 #include <QCache>
+#include <QHash>
 #include <QImage>
 #include <QJsonObject>
 #include <QUrl>
@@ -32,6 +33,7 @@
 #include "StelTexture.hpp"
 #include "VecMath.hpp"
 #include "StelFader.hpp"
+#include "StelProjectorType.hpp"
 
 class StelPainter;
 class HipsTile;
@@ -39,6 +41,9 @@ class QNetworkReply;
 class SphericalCap;
 class HipsSurvey;
 class StelProgressController;
+class StelFileCache;
+class HipsPack;
+class HipsPackBuilder;
 
 typedef QSharedPointer<HipsSurvey> HipsSurveyP;
 Q_DECLARE_METATYPE(HipsSurveyP)
@@ -70,6 +75,12 @@ public:
 	//! Define whether the survey should be visible.
 	void setVisible(bool value);
 	float getInterstate() const {return fader.getInterstate();}
+	//! Update the fader. Surveys drawn by HipsMgr are updated by it.
+	void update(double deltaTime) {fader.update((int)(deltaTime*1000));}
+
+	//! Define whether the survey is drawn in the frame of the projector of the painter whatever its hips_frame,
+	//! e.g. when it describes a landscape.
+	void setDrawnInPainterFrame(bool value) {drawnInPainterFrame = value;}
 
 	//! Render the survey.
 	//! @param sPainter the painter to use.
@@ -103,6 +114,7 @@ private:
 	QString url;
 	QString hipsFrame;
 	QString planet;
+	bool drawnInPainterFrame = false;
 	double releaseDate; // As UTC Julian day.
 	QCache<long int, HipsTile> tiles;
 	// reply to the initial download of the properties file and to the
@@ -111,9 +123,23 @@ private:
 
 	QImage allsky = QImage();
 	bool noAllsky = false;
+	// Content of the allsky image file, used to create packs.
+	QByteArray allskyData;
+
+	// The offline pack holding tiles of this survey, if one was mounted by HipsMgr.
+	QSharedPointer<HipsPack> pack;
+	// Cache of the files downloaded by all surveys, set by HipsMgr. Null if disabled.
+	static QSharedPointer<StelFileCache> diskCache;
+
+	// Textures of the tiles needed along the current automatic movement, see prefetchTiles().
+	QHash<long int, StelTextureSP> prefetchedTiles;
+	Vec3d prefetchAim = Vec3d(0.);
+	double prefetchFov = 0.;
 
 	// Values from the property file.
 	QJsonObject properties;
+	// Content of the property file, used to create packs.
+	QByteArray propertiesData;
 
 	// Used to show the loading progress.
 	StelProgressController* progressBar = Q_NULLPTR;
@@ -123,16 +149,47 @@ private:
 
 	QString getTitle(void) const;
 	QUrl getUrlFor(const QString& path) const;
+	//! Read the values of the property file.
+	void parseProperties(const QByteArray& data);
+	//! Set the offline pack of the survey. Its properties are used until the survey properties are downloaded.
+	void setPack(const QSharedPointer<HipsPack>& pack);
+	//! Create a builder writing the tiles of a region of the survey to a pack file. Requires the properties.
+	//! @param center the center of the region in the frame of the survey
+	//! @param radius the radius of the region in radians
+	//! @return Q_NULLPTR if the pack file can not be created, else the started builder
+	HipsPackBuilder* createPack(const QString& fileName, const Vec3d& center, double radius, int minOrder, int maxOrder);
+	//! Create the texture of a tile, read from the pack, from the disk cache, or downloaded and then stored in the disk cache.
+	StelTextureSP createTileTexture(int order, int pix, bool lazyLoading);
 	int getPropertyInt(const QString& key, int fallback = 0);
 	bool getAllsky();
 	HipsTile* getTile(int order, int pix);
+	QString getTileUrl(int order, int pix);
+	//! Start loading with a low priority the tiles which will be drawn along the current automatic movement
+	//! of StelMovementMgr, and at its end. Loads which are not needed anymore when the movement changes are cancelled.
+	//! @param px the value used to compute the draw order in draw()
+	void prefetchTiles(double px, int tileWidth, int orderMin, int order);
+	//! Add the tiles down to maxOrder which intersect a cap, from a tile and its children.
+	void collectTiles(int order, int pix, int maxOrder, int orderMin, const SphericalCap& cap, QVector<QPair<int, int>>& result) const;
+	//! Draw a tile and its children.
+	//! @param visibleRegion the region of the survey which can be visible: the viewport for sky surveys,
+	//! the part of the planet facing the observer for planetary surveys, see getFacingCap().
+	//! Planetary tiles are refined while they are larger on screen than their texture, down to drawOrder.
 	void drawTile(int order, int pix, int drawOrder, int splitOrder, bool outside,
-				  const SphericalCap& viewportShape, StelPainter* sPainter, DrawCallback callback);
-
-	// Fill the array for a given tile.
-	int fillArrays(int order, int pix, int drawOrder, int splitOrder,
-				   bool outside, StelPainter* sPainter,
-				   QVector<Vec3d>& verts, QVector<Vec2f>& tex, QVector<uint16_t>& indices);
+				  const SphericalCap& visibleRegion, StelPainter* sPainter, DrawCallback callback);
+
+	//! Get the region of the unit sphere of a planetary survey facing the observer.
+	static SphericalCap getFacingCap(const StelProjectorP& prj);
+
+	//! Texture coordinates and indices of a tile split in a grid, shared by all the tiles.
+	struct GridGeometry
+	{
+		QVector<Vec2f> tex;
+		QVector<uint16_t> indices;
+	};
+	QHash<int, GridGeometry> gridGeometries;
+	const GridGeometry& getGridGeometry(int gridSize, bool outside);
+	//! Get the vertices of a tile split in a grid, computed once per tile.
+	const QVector<Vec3d>& getTileVertices(HipsTile* tile, int gridSize);
 
 	void updateProgressBar(int nb, int total);
 };
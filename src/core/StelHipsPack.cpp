@@ -0,0 +1,276 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelHipsPack.hpp"
+#include "StelApp.hpp"
+#include "StelProgressController.hpp"
+#include "StelUtils.hpp"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QMutexLocker>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+
+const quint32 HipsPack::packMagic = 0x53485050; // "SHPP"
+const quint32 HipsPack::packVersion = 1;
+
+namespace
+{
+	// Size of the trailer of pack files: offset of the index and magic number.
+	const qint64 trailerSize = 12;
+	// Number of tiles downloaded at the same time by HipsPackBuilder.
+	const int maxParallelDownloads = 4;
+}
+
+HipsPack::HipsPack() : file(Q_NULLPTR), mapped(Q_NULLPTR)
+{
+}
+
+HipsPack::~HipsPack()
+{
+	delete file;
+}
+
+bool HipsPack::open(const QString& afileName)
+{
+	fileName = afileName;
+	file = new QFile(fileName);
+	if (!file->open(QIODevice::ReadOnly))
+	{
+		qWarning() << "Cannot open HiPS pack" << fileName << file->errorString();
+		return false;
+	}
+	const qint64 fileSize = file->size();
+	QDataStream in(file);
+	in.setVersion(QDataStream::Qt_5_2);
+	quint32 magic, version;
+	in >> magic >> version;
+	if (in.status()!=QDataStream::Ok || magic!=packMagic || version!=packVersion)
+	{
+		qWarning() << "Invalid HiPS pack" << fileName;
+		return false;
+	}
+	in >> surveyUrl >> properties >> allsky;
+
+	qint64 indexOffset;
+	quint32 trailerMagic;
+	if (fileSize < trailerSize || !file->seek(fileSize - trailerSize))
+	{
+		qWarning() << "Truncated HiPS pack" << fileName;
+		return false;
+	}
+	in >> indexOffset >> trailerMagic;
+	if (in.status()!=QDataStream::Ok || trailerMagic!=packMagic || indexOffset<0 || indexOffset>fileSize - trailerSize || !file->seek(indexOffset))
+	{
+		qWarning() << "Truncated HiPS pack" << fileName;
+		return false;
+	}
+	quint32 count;
+	in >> count;
+	for (quint32 i = 0; i < count && in.status()==QDataStream::Ok; ++i)
+	{
+		qint64 uid, offset;
+		quint32 size;
+		in >> uid >> offset >> size;
+		if (offset < 0 || offset + size > indexOffset)
+		{
+			in.setStatus(QDataStream::ReadCorruptData);
+			break;
+		}
+		index.insert(uid, qMakePair(offset, size));
+	}
+	if (in.status()!=QDataStream::Ok || surveyUrl.isEmpty() || properties.isEmpty())
+	{
+		qWarning() << "Invalid HiPS pack" << fileName;
+		index.clear();
+		return false;
+	}
+
+	mapped = file->map(0, fileSize);
+	qDebug() << "Opened HiPS pack" << fileName << "for" << surveyUrl << "with" << index.size() << "tiles";
+	return true;
+}
+
+QByteArray HipsPack::readTile(int order, int pix) const
+{
+	const auto it = index.constFind(getTileUid(order, pix));
+	if (it==index.constEnd())
+		return QByteArray();
+	if (mapped)
+		return QByteArray(reinterpret_cast<const char*>(mapped + it->first), static_cast<int>(it->second));
+	QMutexLocker locker(&mutex);
+	if (!file->seek(it->first))
+		return QByteArray();
+	return file->read(it->second);
+}
+
+bool HipsPackWriter::open(const QString& fileName, const QString& surveyUrl, const QByteArray& properties, const QByteArray& allsky)
+{
+	index.clear();
+	file.setFileName(fileName);
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_5_2);
+	out << HipsPack::packMagic << HipsPack::packVersion << surveyUrl << properties << allsky;
+	return out.status()==QDataStream::Ok;
+}
+
+bool HipsPackWriter::addTile(int order, int pix, const QByteArray& data)
+{
+	IndexEntry e;
+	e.uid = HipsPack::getTileUid(order, pix);
+	e.offset = file.pos();
+	e.size = static_cast<quint32>(data.size());
+	if (file.write(data)!=data.size())
+		return false;
+	index.append(e);
+	return true;
+}
+
+bool HipsPackWriter::close()
+{
+	const qint64 indexOffset = file.pos();
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_5_2);
+	out << static_cast<quint32>(index.size());
+	for (const auto& e : index)
+		out << e.uid << e.offset << e.size;
+	out << indexOffset << HipsPack::packMagic;
+	if (out.status()!=QDataStream::Ok)
+	{
+		cancel();
+		return false;
+	}
+	return file.commit();
+}
+
+void HipsPackWriter::cancel()
+{
+	file.cancelWriting();
+	file.commit();
+}
+
+HipsPackBuilder::HipsPackBuilder(const QString& afileName, const QString& asurveyUrl, const QByteArray& aproperties,
+				 const QByteArray& aallsky, const QVector<Tile>& atiles, const QString& atitle)
+	: fileName(afileName)
+	, surveyUrl(asurveyUrl)
+	, properties(aproperties)
+	, allsky(aallsky)
+	, tiles(atiles)
+	, title(atitle)
+	, nextTile(0)
+	, nbRunning(0)
+	, nbDone(0)
+	, nbFailed(0)
+	, writeError(false)
+	, progressBar(Q_NULLPTR)
+{
+}
+
+HipsPackBuilder::~HipsPackBuilder()
+{
+	if (progressBar)
+		StelApp::getInstance().removeProgressBar(progressBar);
+}
+
+bool HipsPackBuilder::start()
+{
+	if (!writer.open(fileName, surveyUrl, properties, allsky))
+	{
+		qWarning() << "Cannot create HiPS pack" << fileName << writer.errorString();
+		return false;
+	}
+	qDebug() << "Creating HiPS pack" << fileName << "with" << tiles.size() << "tiles of" << surveyUrl;
+	progressBar = StelApp::getInstance().addProgressBar();
+	progressBar->setFormat(QString("%1: %p%").arg(title));
+	progressBar->setRange(0, qMax(1, tiles.size()));
+	progressBar->setValue(0);
+	if (tiles.isEmpty())
+		finish(true);
+	else
+		downloadNext();
+	return true;
+}
+
+void HipsPackBuilder::downloadNext()
+{
+	while (nbRunning < maxParallelDownloads && nextTile < tiles.size())
+	{
+		QNetworkRequest req = QNetworkRequest(QUrl(tiles[nextTile].url));
+		req.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
+		req.setRawHeader("User-Agent", StelUtils::getUserAgentString().toLatin1());
+		QNetworkReply* reply = StelApp::getInstance().getNetworkAccessManager()->get(req);
+		reply->setProperty("tileIndex", nextTile);
+		connect(reply, SIGNAL(finished()), this, SLOT(onTileDownloaded()));
+		++nextTile;
+		++nbRunning;
+	}
+}
+
+void HipsPackBuilder::onTileDownloaded()
+{
+	QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+	Q_ASSERT(reply);
+	--nbRunning;
+	++nbDone;
+	const Tile& tile = tiles[reply->property("tileIndex").toInt()];
+	const QByteArray data = reply->readAll();
+	// Surveys do not always cover the whole sky, missing tiles are skipped.
+	if (reply->error()!=QNetworkReply::NoError || data.isEmpty())
+		++nbFailed;
+	else if (!writeError && !writer.addTile(tile.order, tile.pix, data))
+	{
+		qWarning() << "Cannot write HiPS pack" << fileName << writer.errorString();
+		writeError = true;
+	}
+	reply->deleteLater();
+
+	progressBar->setValue(nbDone);
+	if (writeError)
+	{
+		// Wait for the running requests before deleting the builder.
+		if (nbRunning == 0)
+			finish(false);
+		return;
+	}
+	if (nbDone == tiles.size())
+		finish(nbFailed < tiles.size());
+	else
+		downloadNext();
+}
+
+void HipsPackBuilder::finish(bool ok)
+{
+	if (nbFailed > 0)
+		qDebug() << "HiPS pack" << fileName << ":" << nbFailed << "of" << tiles.size() << "tiles could not be downloaded";
+	if (ok && !writer.close())
+	{
+		qWarning() << "Cannot write HiPS pack" << fileName << writer.errorString();
+		ok = false;
+	}
+	else if (!ok)
+		writer.cancel();
+	emit finished(fileName, ok);
+	deleteLater();
+}
@@ -0,0 +1,167 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+// Offline packs of HiPS surveys.
+
+#ifndef STELHIPSPACK_HPP
+#define STELHIPSPACK_HPP
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+#include <QSaveFile>
+#include <QString>
+#include <QVector>
+
+class QFile;
+class QNetworkReply;
+class StelProgressController;
+
+//! @class HipsPack
+//! A read only archive holding a region of a HiPS survey, so that it can be drawn without network access.
+//! A pack is a single file containing the properties file of the survey, its allsky image and the
+//! tiles of a range of orders, followed by an index of the tiles.
+//! Packs are created with HipsPackBuilder, and mounted by HipsMgr::mountPack().
+//! readTile() is thread safe, it is called by the loader jobs of the tile textures.
+class HipsPack
+{
+public:
+	HipsPack();
+	~HipsPack();
+
+	//! Open a pack file and read its index.
+	//! @return false if the file is not a valid pack
+	bool open(const QString& fileName);
+
+	const QString& getFileName() const {return fileName;}
+	//! Get the URL of the survey of the pack.
+	const QString& getSurveyUrl() const {return surveyUrl;}
+	//! Get the content of the properties file of the survey.
+	const QByteArray& getProperties() const {return properties;}
+	//! Get the content of the allsky image of the survey, empty if the survey has none.
+	const QByteArray& getAllsky() const {return allsky;}
+
+	//! Get whether the pack holds a tile.
+	bool contains(int order, int pix) const {return index.contains(getTileUid(order, pix));}
+	//! Get the content of the image file of a tile, empty if the pack does not hold it.
+	QByteArray readTile(int order, int pix) const;
+	//! Get the number of tiles in the pack.
+	int getTileCount() const {return index.size();}
+
+	//! Get the unique identifier of a tile, as used by HipsSurvey.
+	static qint64 getTileUid(int order, int pix) {return pix + 4LL * (1 << order) * (1 << order);}
+
+private:
+	friend class HipsPackWriter;
+	static const quint32 packMagic;
+	static const quint32 packVersion;
+
+	QString fileName;
+	QString surveyUrl;
+	QByteArray properties;
+	QByteArray allsky;
+	//! The offset and size of the tiles in the file by uid
+	QHash<qint64, QPair<qint64, quint32>> index;
+	QFile* file;
+	//! The content of the file if it could be mapped in memory, else tiles are read with the mutex locked
+	const uchar* mapped;
+	mutable QMutex mutex;
+};
+
+//! @class HipsPackWriter
+//! Write a HipsPack file. The file is only replaced when close() succeeds.
+class HipsPackWriter
+{
+public:
+	//! Start writing a pack.
+	//! @return false if the file can not be created
+	bool open(const QString& fileName, const QString& surveyUrl, const QByteArray& properties, const QByteArray& allsky);
+	//! Append the content of the image file of a tile.
+	bool addTile(int order, int pix, const QByteArray& data);
+	//! Write the index and replace the pack file.
+	bool close();
+	//! Stop writing and keep the previous pack file if any.
+	void cancel();
+	QString errorString() const {return file.errorString();}
+
+private:
+	struct IndexEntry
+	{
+		qint64 uid;
+		qint64 offset;
+		quint32 size;
+	};
+	QSaveFile file;
+	QVector<IndexEntry> index;
+};
+
+//! @class HipsPackBuilder
+//! Download the tiles of a region of a survey and write them in a HipsPack file.
+//! The progress is shown in a progress bar. The builder deletes itself once finished.
+class HipsPackBuilder : public QObject
+{
+	Q_OBJECT
+
+public:
+	struct Tile
+	{
+		int order;
+		int pix;
+		QString url;
+	};
+
+	HipsPackBuilder(const QString& fileName, const QString& surveyUrl, const QByteArray& properties,
+			const QByteArray& allsky, const QVector<Tile>& tiles, const QString& title);
+	virtual ~HipsPackBuilder();
+
+	//! Start the downloads.
+	//! @return false if the pack file can not be created, the builder must then be deleted by the caller
+	bool start();
+
+signals:
+	//! Emitted when the pack is written, or when it failed.
+	void finished(const QString& fileName, bool ok);
+
+private slots:
+	void onTileDownloaded();
+
+private:
+	//! Start the next downloads up to the maximum number of parallel requests.
+	void downloadNext();
+	void finish(bool ok);
+
+	QString fileName;
+	QString surveyUrl;
+	QByteArray properties;
+	QByteArray allsky;
+	QVector<Tile> tiles;
+	QString title;
+	HipsPackWriter writer;
+	int nextTile;
+	int nbRunning;
+	int nbDone;
+	int nbFailed;
+	bool writeError;
+	StelProgressController* progressBar;
+};
+
+#endif // STELHIPSPACK_HPP
@@ -0,0 +1,188 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelIniCache.hpp"
+#include "StelIniParser.hpp"
+#include "StelFileMgr.hpp"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <stdexcept>
+
+namespace
+{
+	static const quint32 INI_CACHE_MAGIC = 0x53494331; // "SIC1"
+}
+
+StelIniCache::StelIniCache(const QString& filePath)
+	: valid(false)
+{
+	QFile file(filePath);
+	if (!file.open(QIODevice::ReadOnly))
+		return;
+	const QByteArray data = file.readAll();
+	file.close();
+	const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+
+	const QString cacheFile = getCacheFilePath(filePath);
+	if (readCache(cacheFile, hash))
+	{
+		qDebug() << "Loaded" << QDir::toNativeSeparators(filePath) << "from cache" << QDir::toNativeSeparators(cacheFile);
+		valid = true;
+		return;
+	}
+
+	QSettings::SettingsMap map;
+	file.setFileName(filePath);
+	if (!file.open(QIODevice::ReadOnly) || !readStelIniFile(file, map))
+		return;
+	values.reserve(map.size());
+	// The map is sorted, so all keys of a section are consecutive.
+	for (auto it=map.constBegin(); it!=map.constEnd(); ++it)
+	{
+		values.insert(it.key(), it.value().toString());
+		const int slash = it.key().indexOf('/');
+		if (slash>0)
+		{
+			const QString section = it.key().left(slash);
+			if (groups.isEmpty() || groups.last()!=section)
+				groups.append(section);
+		}
+	}
+	// Same order as the group names from QSettings
+	groups.sort();
+	valid = true;
+
+	try
+	{
+		StelFileMgr::makeSureDirExistsAndIsWritable(QFileInfo(cacheFile).absolutePath());
+		if (!writeCache(cacheFile, hash))
+			qWarning() << "Cannot write cache" << QDir::toNativeSeparators(cacheFile);
+	}
+	catch (std::runtime_error& e)
+	{
+		qWarning() << "Cannot create ini cache directory:" << e.what();
+	}
+}
+
+QVariant StelIniCache::value(const QString& key, const QVariant& defaultValue) const
+{
+	auto it = values.constFind(key);
+	if (it==values.constEnd())
+		return defaultValue;
+	return QVariant(it.value());
+}
+
+bool StelIniCache::appendToFile(const QString& filePath, const QByteArray& text, const QVector<QPair<QString, QString> >& newValues)
+{
+	// The current content, from the cache if it is up to date
+	StelIniCache cache(filePath);
+
+	QFile file(filePath);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+		return false;
+	const bool written = file.write(text)==text.size();
+	file.close();
+	if (!written || !cache.isValid())
+		return written;
+
+	// Like readStelIniFile(): comments are removed, keys and values are trimmed, empty values are ignored.
+	for (const auto& keyValue : newValues)
+	{
+		QString value = keyValue.second;
+		const int comment = value.indexOf('#');
+		if (comment>=0)
+			value.truncate(comment);
+		value = value.trimmed();
+		if (value.isEmpty())
+			continue;
+		const QString key = keyValue.first.trimmed();
+		cache.values.insert(key, value);
+		const int slash = key.indexOf('/');
+		if (slash>0)
+			cache.groups.append(key.left(slash));
+	}
+	cache.groups.sort();
+	cache.groups.removeDuplicates();
+
+	if (!file.open(QIODevice::ReadOnly))
+		return true;
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(&file);
+	file.close();
+	const QString cacheFile = getCacheFilePath(filePath);
+	if (!cache.writeCache(cacheFile, hash.result()))
+		qWarning() << "Cannot write cache" << QDir::toNativeSeparators(cacheFile);
+	return true;
+}
+
+QString StelIniCache::getCacheFilePath(const QString& filePath)
+{
+	// Files with the same name in different directories must not share their cache.
+	const QFileInfo info(filePath);
+	const QByteArray pathHash = QCryptographicHash::hash(info.absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex().left(8);
+	return StelFileMgr::getCacheDir() + "/ini/" + info.fileName() + "." + QString::fromLatin1(pathHash) + ".cache";
+}
+
+bool StelIniCache::readCache(const QString& cacheFile, const QByteArray& hash)
+{
+	QFile file(cacheFile);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+	QDataStream in(&file);
+	in.setVersion(QDataStream::Qt_5_2);
+	quint32 magic;
+	QByteArray cacheHash;
+	in >> magic >> cacheHash;
+	if (in.status()!=QDataStream::Ok || magic!=INI_CACHE_MAGIC || cacheHash!=hash)
+		return false;
+	in >> groups >> values;
+	if (in.status()!=QDataStream::Ok)
+	{
+		groups.clear();
+		values.clear();
+		return false;
+	}
+	return true;
+}
+
+bool StelIniCache::writeCache(const QString& cacheFile, const QByteArray& hash) const
+{
+	QFile file(cacheFile + ".tmp");
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_5_2);
+	out << INI_CACHE_MAGIC << hash << groups << values;
+	bool ok = out.status()==QDataStream::Ok;
+	file.close();
+	if (ok)
+	{
+		QFile::remove(cacheFile);
+		ok = file.rename(cacheFile);
+	}
+	if (!ok)
+		file.remove();
+	return ok;
+}
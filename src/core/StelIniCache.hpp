@@ -0,0 +1,67 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STELINICACHE_HPP
+#define STELINICACHE_HPP
+
+#include <QByteArray>
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+//! @class StelIniCache
+//! Read-only content of a file in StelIniFormat, for large files which are read at each startup.
+//! The parsed keys and values are stored in a binary cache in the cache directory. As long as
+//! the SHA-1 hash of the file matches the one of the cache, the file is not parsed again.
+//! This can replace a QSettings object which is only used with childGroups() and value().
+class StelIniCache
+{
+public:
+	//! Load the content of an ini file, from the cache if it is up to date.
+	explicit StelIniCache(const QString& filePath);
+
+	//! Get whether the file could be read.
+	bool isValid() const {return valid;}
+	//! Get the sorted list of sections of the file, like QSettings::childGroups().
+	const QStringList& childGroups() const {return groups;}
+	//! Get the value of a key "section/name", like QSettings::value().
+	QVariant value(const QString& key, const QVariant& defaultValue=QVariant()) const;
+
+	//! Append sections to an ini file and add them to its cache, so that large imports do not make the next load
+	//! parse the whole file again. The sections must not be in the file yet.
+	//! @param text the new sections in StelIniFormat, appended as they are
+	//! @param newValues the keys "section/name" and values of text, which are cleaned like the parser does
+	//! @return false if the file could not be written. A cache which can't be updated is rebuilt at the next load.
+	static bool appendToFile(const QString& filePath, const QByteArray& text, const QVector<QPair<QString, QString> >& newValues);
+
+private:
+	//! Get the path of the cache file for an ini file.
+	static QString getCacheFilePath(const QString& filePath);
+	bool readCache(const QString& cacheFile, const QByteArray& hash);
+	bool writeCache(const QString& cacheFile, const QByteArray& hash) const;
+
+	QHash<QString, QString> values;
+	QStringList groups;
+	bool valid;
+};
+
+#endif // STELINICACHE_HPP
@@ -0,0 +1,241 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelJobMgr.hpp"
+
+#include <algorithm>
+
+#include <QDebug>
+#include <QMetaType>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+constexpr float StelJobMgr::PrioritySelected;
+
+//! Worker task started once per ready job. It runs whichever job has the highest priority
+//! when a thread becomes available, which need not be the job it was started for.
+class StelJobRunner : public QRunnable
+{
+public:
+	StelJobRunner(StelJobMgr* mgr) : mgr(mgr) {}
+	void run() Q_DECL_OVERRIDE { mgr->runNext(); }
+private:
+	StelJobMgr* mgr;
+};
+
+StelJob::StelJob(StelJobMgr* mgr, const std::function<void()>& func, const std::function<void()>& onFinished, float priority)
+	: mgr(mgr)
+	, func(func)
+	, onFinished(onFinished)
+	, state(Waiting)
+	, cancelRequested(false)
+	, priority(priority)
+	, pendingDependencies(0)
+{
+}
+
+StelJob::State StelJob::getState() const
+{
+	QMutexLocker locker(&mgr->mutex);
+	return state;
+}
+
+bool StelJob::isFinished() const
+{
+	QMutexLocker locker(&mgr->mutex);
+	return state==Finished || state==Cancelled;
+}
+
+bool StelJob::isCancelled() const
+{
+	QMutexLocker locker(&mgr->mutex);
+	return cancelRequested;
+}
+
+void StelJob::cancel()
+{
+	QMutexLocker locker(&mgr->mutex);
+	mgr->cancelLocked(this);
+}
+
+void StelJob::setPriority(float p)
+{
+	QMutexLocker locker(&mgr->mutex);
+	priority = p;
+}
+
+float StelJob::getPriority() const
+{
+	QMutexLocker locker(&mgr->mutex);
+	return priority;
+}
+
+void StelJob::waitForFinished()
+{
+	QMutexLocker locker(&mgr->mutex);
+	if (state==Ready)
+	{
+		StelJobP job = mgr->takeReady(this);
+		job->state = Running;
+		mgr->runningJobs++;
+		locker.unlock();
+		mgr->run(job);
+		return;
+	}
+	while (state!=Finished && state!=Cancelled)
+		mgr->jobDone.wait(&mgr->mutex);
+}
+
+StelJobMgr::StelJobMgr(QObject* parent)
+	: QObject(parent)
+	, runningJobs(0)
+{
+	qRegisterMetaType<StelJobP>("StelJobP");
+	connect(this, SIGNAL(jobFinished(StelJobP)), this, SLOT(callOnFinished(StelJobP)), Qt::QueuedConnection);
+
+	threadPool = new QThreadPool(this);
+#ifdef Q_PROCESSOR_X86_64
+	//allow up to 4 jobs to run in parallel on 64 bit
+	threadPool->setMaxThreadCount(std::min(4,QThread::idealThreadCount()));
+#else
+	//on other archs, for now ensure that just 1 job runs at once in background
+	//otherwise, for large textures loaded in parallel (some scenery3d scenes), the risk of an out-of-memory error is greater on 32bit systems
+	threadPool->setMaxThreadCount(1);
+#endif
+}
+
+StelJobMgr::~StelJobMgr()
+{
+	mutex.lock();
+	while (!readyJobs.isEmpty())
+		cancelLocked(readyJobs.first().data());
+	mutex.unlock();
+	threadPool->waitForDone();
+}
+
+StelJobP StelJobMgr::submit(const std::function<void()>& func, float priority, const QList<StelJobP>& dependencies, const std::function<void()>& onFinished)
+{
+	StelJobP job(new StelJob(this, func, onFinished, priority));
+	QMutexLocker locker(&mutex);
+	for (const auto& dep : dependencies)
+	{
+		if (dep->state==StelJob::Cancelled)
+		{
+			job->state = StelJob::Cancelled;
+			job->cancelRequested = true;
+			return job;
+		}
+		if (dep->state!=StelJob::Finished)
+		{
+			dep->dependents.append(job);
+			job->pendingDependencies++;
+		}
+	}
+	if (job->pendingDependencies==0)
+		makeReady(job);
+	return job;
+}
+
+int StelJobMgr::getPendingJobs() const
+{
+	QMutexLocker locker(&mutex);
+	return readyJobs.size() + runningJobs;
+}
+
+void StelJobMgr::makeReady(const StelJobP& job)
+{
+	job->state = StelJob::Ready;
+	readyJobs.append(job);
+	threadPool->start(new StelJobRunner(this));
+}
+
+StelJobP StelJobMgr::takeReady(StelJob* job)
+{
+	for (int i=0; i<readyJobs.size(); ++i)
+	{
+		if (readyJobs.at(i).data()==job)
+			return readyJobs.takeAt(i);
+	}
+	Q_ASSERT(false);
+	return StelJobP();
+}
+
+void StelJobMgr::cancelLocked(StelJob* job)
+{
+	job->cancelRequested = true;
+	if (job->state==StelJob::Running || job->state==StelJob::Finished || job->state==StelJob::Cancelled)
+		return;
+	if (job->state==StelJob::Ready)
+		takeReady(job);
+	job->state = StelJob::Cancelled;
+	const QList<StelJobP> dependents = job->dependents;
+	job->dependents.clear();
+	for (const auto& dep : dependents)
+		cancelLocked(dep.data());
+	jobDone.wakeAll();
+}
+
+void StelJobMgr::runNext()
+{
+	QMutexLocker locker(&mutex);
+	if (readyJobs.isEmpty())
+		return; // already run by StelJob::waitForFinished(), or cancelled
+	int best = 0;
+	for (int i=1; i<readyJobs.size(); ++i)
+	{
+		if (readyJobs.at(i)->priority > readyJobs.at(best)->priority)
+			best = i;
+	}
+	StelJobP job = readyJobs.takeAt(best);
+	job->state = StelJob::Running;
+	runningJobs++;
+	locker.unlock();
+	run(job);
+}
+
+void StelJobMgr::run(const StelJobP& job)
+{
+	job->func();
+	// Release what the function captured as soon as possible.
+	job->func = std::function<void()>();
+
+	QMutexLocker locker(&mutex);
+	runningJobs--;
+	job->state = StelJob::Finished;
+	const QList<StelJobP> dependents = job->dependents;
+	job->dependents.clear();
+	for (const auto& dep : dependents)
+	{
+		if (dep->state==StelJob::Waiting && --dep->pendingDependencies==0)
+			makeReady(dep);
+	}
+	const bool callback = job->onFinished && !job->cancelRequested;
+	jobDone.wakeAll();
+	locker.unlock();
+	if (callback)
+		emit jobFinished(job);
+}
+
+void StelJobMgr::callOnFinished(StelJobP job)
+{
+	if (!job->isCancelled())
+		job->onFinished();
+	job->onFinished = std::function<void()>();
+}
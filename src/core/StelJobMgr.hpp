@@ -0,0 +1,139 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STELJOBMGR_HPP
+#define STELJOBMGR_HPP
+
+#include <functional>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QSharedPointer>
+#include <QWaitCondition>
+
+class QThreadPool;
+class StelJobMgr;
+
+//! @class StelJob
+//! A background job created by StelJobMgr::submit().
+//! All methods can be called from any thread.
+class StelJob
+{
+public:
+	enum State
+	{
+		Waiting,	//!< some dependencies have not finished yet
+		Ready,		//!< queued, waiting for a worker thread
+		Running,
+		Finished,
+		Cancelled	//!< cancelled before it started, or one of its dependencies was cancelled
+	};
+
+	State getState() const;
+	//! Get whether the job finished or will never run.
+	bool isFinished() const;
+	//! Get whether cancel() was called. A running job can poll this to stop early.
+	bool isCancelled() const;
+
+	//! Cancel the job. A job which did not start yet will not run, nor will the jobs depending on it.
+	//! A running job is not interrupted. Its main thread callback is not called in any case.
+	void cancel();
+
+	//! Change the priority. Among the jobs ready to run, the one with the highest priority starts first.
+	void setPriority(float priority);
+	float getPriority() const;
+
+	//! Block until the job finished or was cancelled.
+	//! A job which is queued is run on the calling thread, so that waiting for a low priority job doesn't stall.
+	void waitForFinished();
+
+private:
+	friend class StelJobMgr;
+	StelJob(StelJobMgr* mgr, const std::function<void()>& func, const std::function<void()>& onFinished, float priority);
+
+	StelJobMgr* mgr;
+	std::function<void()> func;
+	std::function<void()> onFinished;
+	// The members below are protected by the mutex of mgr.
+	State state;
+	bool cancelRequested;
+	float priority;
+	int pendingDependencies;
+	QList<QSharedPointer<StelJob> > dependents;
+};
+
+typedef QSharedPointer<StelJob> StelJobP;
+
+//! @class StelJobMgr
+//! Prioritised queue of background jobs, shared by the loaders of textures, models and sky layers.
+//! Unlike QThreadPool, the priority of a queued job can be changed until it starts, so that loads
+//! which became stale (e.g. for an object which is no longer selected) don't delay the others.
+//! Jobs can depend on other jobs, and run only once all of them have finished.
+class StelJobMgr : public QObject
+{
+	Q_OBJECT
+public:
+	//! Priority of the loads for the selected object. Other loads use priorities in [0, 1].
+	static constexpr float PrioritySelected = 2.f;
+
+	StelJobMgr(QObject* parent = Q_NULLPTR);
+	~StelJobMgr();
+
+	//! Queue a job.
+	//! @note This method is safe to be called from threads other than the main thread.
+	//! @param func the function to run on a worker thread
+	//! @param priority the initial priority of the job
+	//! @param dependencies jobs which must have finished before this one starts
+	//! @param onFinished optional function called on the main thread after func, unless the job was cancelled
+	StelJobP submit(const std::function<void()>& func, float priority = 0.f,
+			const QList<StelJobP>& dependencies = QList<StelJobP>(),
+			const std::function<void()>& onFinished = std::function<void()>());
+
+	//! Get the number of jobs which are queued or running.
+	int getPendingJobs() const;
+
+signals:
+	void jobFinished(StelJobP job);
+
+private slots:
+	void callOnFinished(StelJobP job);
+
+private:
+	friend class StelJob;
+	friend class StelJobRunner;
+
+	//! Run the queued job of highest priority, called by the worker threads.
+	void runNext();
+	//! Run a job which was taken from the queue, and release its dependents.
+	void run(const StelJobP& job);
+	//! Queue a job whose dependencies have finished. The mutex must be locked.
+	void makeReady(const StelJobP& job);
+	//! Cancel a job which did not start yet, and its dependents. The mutex must be locked.
+	void cancelLocked(StelJob* job);
+	//! Get the shared pointer of a job from the ready queue. The mutex must be locked.
+	StelJobP takeReady(StelJob* job);
+
+	mutable QMutex mutex;
+	QWaitCondition jobDone;
+	QList<StelJobP> readyJobs;
+	int runningJobs;
+	QThreadPool* threadPool;
+};
+
+#endif // STELJOBMGR_HPP
@@ -0,0 +1,209 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelJsonCatalog.hpp"
+#include "StelFileMgr.hpp"
+#include "StelJsonParser.hpp"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QSaveFile>
+
+#include <stdexcept>
+
+namespace
+{
+	const quint32 CACHE_MAGIC = 0x534a4343; // "SJCC"
+	//! Increment when the layout of the cache changes
+	const quint32 CACHE_FORMAT_VERSION = 1;
+
+	//! The part of the JSON text of a value
+	struct Span
+	{
+		Span() : begin(0), end(0) {}
+		int begin;
+		int end;
+	};
+
+	QVariantMap parseItem(const QByteArray& json, const Span& span)
+	{
+		const QByteArray itemJson = QByteArray::fromRawData(json.constData() + span.begin, span.end - span.begin);
+		StelJsonStreamReader reader(itemJson);
+		reader.readNext();
+		return reader.readCurrentValue().toMap();
+	}
+
+	//! Scan the catalog, parse the header values and find the items.
+	//! The items are sorted by key, a repeated key replaces the earlier item like in a QVariantMap.
+	void scan(const QByteArray& json, const QString& itemsKey, QVariantMap& header, QMap<QString, Span>& items)
+	{
+		StelJsonStreamReader reader(json);
+		if (reader.readNext()!=StelJsonStreamReader::StartObject)
+			throw std::runtime_error("the catalog is not a JSON object");
+		while (reader.readNext()==StelJsonStreamReader::Name)
+		{
+			const QString key = reader.name();
+			if (key==itemsKey && reader.readNext()==StelJsonStreamReader::StartObject)
+			{
+				while (reader.readNext()==StelJsonStreamReader::Name)
+				{
+					const QString itemKey = reader.name();
+					reader.readNext();
+					Span span;
+					span.begin = reader.tokenOffset();
+					reader.skipCurrentValue();
+					span.end = reader.offset();
+					items.insert(itemKey, span);
+				}
+			}
+			else
+				header.insert(key, reader.readCurrentValue());
+		}
+		// throws if there is more after the catalog object
+		reader.readNext();
+	}
+}
+
+StelJsonCatalog::StelJsonCatalog(const QString &jsonPath, const QString &itemsKey)
+	: jsonPath(jsonPath)
+	, itemsKey(itemsKey)
+	, jsonSize(-1)
+	, jsonModified(0)
+{
+	const QFileInfo info(jsonPath);
+	cachePath = StelFileMgr::getCacheDir() + "/catalogs/" + info.completeBaseName() + ".cat";
+	if (info.exists())
+	{
+		jsonSize = info.size();
+		jsonModified = info.lastModified().toMSecsSinceEpoch();
+	}
+}
+
+QVariantMap StelJsonCatalog::readHeader() const
+{
+	QVariantMap header;
+	if (readCache(header, Q_NULLPTR))
+		return header;
+	return readJson(Q_NULLPTR);
+}
+
+QVariantMap StelJsonCatalog::read(const ItemHandler &handler) const
+{
+	QVariantMap header;
+	if (readCache(header, &handler))
+		return header;
+	return readJson(&handler);
+}
+
+QVariantMap StelJsonCatalog::parse(const QByteArray &json, const QString &itemsKey, const ItemHandler &handler)
+{
+	QVariantMap header;
+	QMap<QString, Span> items;
+	scan(json, itemsKey, header, items);
+	if (handler)
+	{
+		for (auto it = items.constBegin(); it != items.constEnd(); ++it)
+		{
+			QVariantMap item = parseItem(json, it.value());
+			handler(it.key(), item);
+		}
+	}
+	return header;
+}
+
+bool StelJsonCatalog::readCache(QVariantMap &header, const ItemHandler *handler) const
+{
+	QFile file(cachePath);
+	if (jsonSize<0 || !file.open(QIODevice::ReadOnly))
+		return false;
+
+	QDataStream in(&file);
+	in.setVersion(QDataStream::Qt_5_4);
+	quint32 magic, format, count;
+	qint64 size, modified;
+	in >> magic >> format >> size >> modified;
+	if (in.status()!=QDataStream::Ok || magic!=CACHE_MAGIC || format!=CACHE_FORMAT_VERSION || size!=jsonSize || modified!=jsonModified)
+		return false;
+	in >> header >> count;
+	if (in.status()!=QDataStream::Ok)
+		return false;
+	if (!handler)
+		return true;
+
+	for (quint32 i=0; i<count; ++i)
+	{
+		QString key;
+		QVariantMap item;
+		in >> key >> item;
+		if (in.status()!=QDataStream::Ok)
+		{
+			qWarning() << "StelJsonCatalog: the cache" << QDir::toNativeSeparators(cachePath) << "is truncated, it will be rebuilt at the next start";
+			file.close();
+			QFile::remove(cachePath);
+			break;
+		}
+		(*handler)(key, item);
+	}
+	return true;
+}
+
+QVariantMap StelJsonCatalog::readJson(const ItemHandler *handler) const
+{
+	QFile file(jsonPath);
+	if (!file.open(QIODevice::ReadOnly))
+		throw std::runtime_error(QString("cannot open %1").arg(QDir::toNativeSeparators(jsonPath)).toStdString());
+	const QByteArray json = file.readAll();
+	file.close();
+
+	QVariantMap header;
+	QMap<QString, Span> items;
+	scan(json, itemsKey, header, items);
+	if (!handler)
+		return header;
+
+	// The cache is only committed if all items could be parsed
+	QSaveFile cache(cachePath);
+	QDataStream out;
+	const bool writeCache = QDir().mkpath(QFileInfo(cachePath).absolutePath()) && cache.open(QIODevice::WriteOnly);
+	if (writeCache)
+	{
+		out.setDevice(&cache);
+		out.setVersion(QDataStream::Qt_5_4);
+		out << CACHE_MAGIC << CACHE_FORMAT_VERSION << jsonSize << jsonModified << header << static_cast<quint32>(items.size());
+	}
+	else
+		qWarning() << "StelJsonCatalog: cannot write the cache" << QDir::toNativeSeparators(cachePath);
+
+	for (auto it = items.constBegin(); it != items.constEnd(); ++it)
+	{
+		QVariantMap item = parseItem(json, it.value());
+		if (writeCache)
+			out << it.key() << item;
+		(*handler)(it.key(), item);
+	}
+
+	if (writeCache && (out.status()!=QDataStream::Ok || !cache.commit()))
+		qWarning() << "StelJsonCatalog: cannot write the cache" << QDir::toNativeSeparators(cachePath);
+	return header;
+}
@@ -0,0 +1,85 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STELJSONCATALOG_HPP
+#define STELJSONCATALOG_HPP
+
+#include <QByteArray>
+#include <QString>
+#include <QVariantMap>
+
+#include <functional>
+
+//! @class StelJsonCatalog
+//! Reader for the JSON catalogs of the object plugins (Exoplanets, Pulsars, Quasars, Novae, Supernovae).
+//! These catalogs are an object with a few header values like the format "version", and one object with all items
+//! by their designation, e.g.
+//! @code
+//! {"version": 1, "shortName": "A catalogue of exoplanets", "stars": {"HD 1234": {...}, "HD 5678": {...}}}
+//! @endcode
+//! The catalog is never converted into one QVariant tree. The items are passed one by one to a handler, as a small
+//! QVariantMap each, in the order of their keys (the same as iterating the QVariantMap returned by StelJsonParser).
+//!
+//! After the catalog was read from JSON, it is stored in a binary cache in the cache directory
+//! (QDataStream serialization of the header and each item). Later reads use the cache as long as the JSON file
+//! has the same size and modification time, so the JSON text is only parsed again after an update of the catalog.
+class StelJsonCatalog
+{
+public:
+	//! Called for each item of the catalog. The item may be modified by the handler.
+	typedef std::function<void(const QString& key, QVariantMap& item)> ItemHandler;
+
+	//! @param jsonPath the path of the JSON catalog
+	//! @param itemsKey the key of the object containing the items, e.g. "stars"
+	StelJsonCatalog(const QString& jsonPath, const QString& itemsKey);
+
+	//! Read the header values, i.e. all top-level values except the items, from the cache if it is valid.
+	//! Otherwise the JSON file is scanned, without parsing the items.
+	//! @exception std::runtime_error if the JSON file can't be opened or its structure is wrong
+	QVariantMap readHeader() const;
+
+	//! Read the catalog from the cache if it is valid, else from the JSON file which also rebuilds the cache.
+	//! @return the header values
+	//! @exception std::runtime_error if the JSON file can't be opened or parsed
+	QVariantMap read(const ItemHandler& handler) const;
+
+	//! The parsing used by read(), with a StelJsonStreamReader. It scans the top-level object and parses the header values,
+	//! then parses and passes the items to the handler one by one.
+	//! @param json the whole JSON text
+	//! @param itemsKey the key of the object containing the items
+	//! @param handler may be empty to only read the header, the items are only tokenized then
+	//! @return the header values
+	//! @exception std::runtime_error if the JSON text is not valid
+	static QVariantMap parse(const QByteArray& json, const QString& itemsKey, const ItemHandler& handler);
+
+private:
+	//! Read and check the cache header. Reads the items too if handler is not Q_NULLPTR.
+	//! @return false if there is no valid cache
+	bool readCache(QVariantMap& header, const ItemHandler* handler) const;
+	//! Read the JSON file. If handler is not Q_NULLPTR, the items are parsed and the cache is written.
+	QVariantMap readJson(const ItemHandler* handler) const;
+
+	QString jsonPath;
+	QString itemsKey;
+	QString cachePath;
+	qint64 jsonSize;
+	qint64 jsonModified;
+};
+
+#endif // STELJSONCATALOG_HPP
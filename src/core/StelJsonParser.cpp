@@ -19,6 +19,9 @@
 #include "StelJsonParser.hpp"
 #include <QDebug>
 #include <QJsonDocument>
+#include <QVariantList>
+#include <QVariantMap>
+#include <cstring>
 #include <stdexcept>
 
 void StelJsonParser::write(const QVariant& v, QIODevice* output, int indentLevel)
@@ -49,3 +52,243 @@ QVariant StelJsonParser::parse(const QByteArray& aar)
 	}
 	return doc.toVariant();
 }
+
+StelJsonStreamReader::StelJsonStreamReader(const QByteArray& json)
+	: data(json.constData())
+	, size(json.size())
+	, pos(0)
+	, tokenStart(0)
+	, token(NoToken)
+	, expectMemberValue(false)
+	, number(0.)
+{
+}
+
+void StelJsonStreamReader::error(const char* msg) const
+{
+	throw std::runtime_error(QString("%1 at offset %2").arg(msg).arg(pos).toStdString());
+}
+
+void StelJsonStreamReader::skipSpace()
+{
+	while (pos<size && (data[pos]==' ' || data[pos]=='\n' || data[pos]=='\r' || data[pos]=='\t'))
+		++pos;
+}
+
+StelJsonStreamReader::TokenType StelJsonStreamReader::readNext()
+{
+	skipSpace();
+	tokenStart = pos;
+	if (stack.isEmpty())
+	{
+		if (token==NoToken)
+			return token = readValueToken();
+		// The document value was read
+		if (pos<size)
+			error("unexpected data after the document");
+		return token = EndDocument;
+	}
+	if (expectMemberValue)
+	{
+		expectMemberValue = false;
+		return token = readValueToken();
+	}
+
+	Container& top = stack.last();
+	if (pos<size && data[pos]==(top.isObject ? '}' : ']'))
+	{
+		++pos;
+		const bool isObject = top.isObject;
+		stack.removeLast();
+		return token = isObject ? EndObject : EndArray;
+	}
+	if (!top.isEmpty)
+	{
+		if (pos>=size || data[pos]!=',')
+			error(top.isObject ? "',' or '}' expected" : "',' or ']' expected");
+		++pos;
+		skipSpace();
+		tokenStart = pos;
+	}
+	top.isEmpty = false;
+	if (!top.isObject)
+		return token = readValueToken();
+
+	if (pos>=size || data[pos]!='"')
+		error("member name expected");
+	readString();
+	skipSpace();
+	if (pos>=size || data[pos]!=':')
+		error("':' expected");
+	++pos;
+	expectMemberValue = true;
+	return token = Name;
+}
+
+StelJsonStreamReader::TokenType StelJsonStreamReader::readValueToken()
+{
+	if (pos>=size)
+		error("unexpected end of document");
+	switch (data[pos])
+	{
+		case '{':
+		case '[':
+		{
+			Container c;
+			c.isObject = data[pos]=='{';
+			c.isEmpty = true;
+			stack.append(c);
+			++pos;
+			return c.isObject ? StartObject : StartArray;
+		}
+		case '"':
+			readString();
+			return String;
+		case 't':
+			readLiteral("true", 1.);
+			return Bool;
+		case 'f':
+			readLiteral("false", 0.);
+			return Bool;
+		case 'n':
+			readLiteral("null", 0.);
+			return Null;
+		default:
+			readNumber();
+			return Number;
+	}
+}
+
+void StelJsonStreamReader::readString()
+{
+	++pos;
+	str.clear();
+	int start = pos;
+	while (true)
+	{
+		if (pos>=size)
+			error("unterminated string");
+		const char c = data[pos];
+		if (c=='"')
+			break;
+		if (c!='\\')
+		{
+			++pos;
+			continue;
+		}
+		str += QString::fromUtf8(data+start, pos-start);
+		if (pos+1>=size)
+			error("unterminated string");
+		const char e = data[pos+1];
+		pos += 2;
+		switch (e)
+		{
+			case '"':
+			case '\\':
+			case '/':
+				str += QLatin1Char(e);
+				break;
+			case 'b':
+				str += QLatin1Char('\b');
+				break;
+			case 'f':
+				str += QLatin1Char('\f');
+				break;
+			case 'n':
+				str += QLatin1Char('\n');
+				break;
+			case 'r':
+				str += QLatin1Char('\r');
+				break;
+			case 't':
+				str += QLatin1Char('\t');
+				break;
+			case 'u':
+			{
+				bool ok = pos+4<=size;
+				// surrogate pairs are two escapes, which give the two UTF-16 code units
+				const ushort code = ok ? QByteArray(data+pos, 4).toUShort(&ok, 16) : 0;
+				if (!ok)
+					error("invalid unicode escape");
+				str += QChar(code);
+				pos += 4;
+				break;
+			}
+			default:
+				error("invalid escape sequence");
+		}
+		start = pos;
+	}
+	str += QString::fromUtf8(data+start, pos-start);
+	++pos;
+}
+
+void StelJsonStreamReader::readNumber()
+{
+	const int start = pos;
+	while (pos<size && std::strchr("0123456789+-.eE", data[pos]) && data[pos]!='\0')
+		++pos;
+	bool ok = pos>start;
+	if (ok)
+		number = QByteArray(data+start, pos-start).toDouble(&ok);
+	if (!ok)
+	{
+		pos = start;
+		error("value expected");
+	}
+}
+
+void StelJsonStreamReader::readLiteral(const char* literal, double value)
+{
+	const int len = static_cast<int>(std::strlen(literal));
+	if (pos+len>size || std::strncmp(data+pos, literal, len)!=0)
+		error("value expected");
+	pos += len;
+	number = value;
+}
+
+void StelJsonStreamReader::skipCurrentValue()
+{
+	if (token==Name)
+		readNext();
+	if (token!=StartObject && token!=StartArray)
+		return;
+	const int d = stack.size();
+	while (stack.size()>=d)
+		readNext();
+}
+
+QVariant StelJsonStreamReader::readCurrentValue()
+{
+	if (token==Name)
+		readNext();
+	switch (token)
+	{
+		case StartObject:
+		{
+			QVariantMap map;
+			while (readNext()==Name)
+			{
+				const QString key = str;
+				readNext();
+				map.insert(key, readCurrentValue());
+			}
+			return map;
+		}
+		case StartArray:
+		{
+			QVariantList list;
+			while (readNext()!=EndArray)
+				list.append(readCurrentValue());
+			return list;
+		}
+		case String:
+			return str;
+		case Number:
+			return number;
+		case Bool:
+			return boolValue();
+		default:
+			return QVariant();
+	}
+}
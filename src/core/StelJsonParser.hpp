@@ -22,6 +22,7 @@
 #include <QIODevice>
 #include <QVariant>
 #include <QByteArray>
+#include <QVector>
 
 
 //! @class StelJsonParser
@@ -54,4 +55,102 @@ public:
 	// static void registerSerializerForType(int t, void (*func)(const QVariant&, QIODevice*, int)) {otherSerializer.insert(t, func);}
 };
 
+//! @class StelJsonStreamReader
+//! Pull parser for JSON, in the style of QXmlStreamReader. Each call to readNext() reads one token, so large
+//! documents like catalogs can be consumed record by record without building a QVariant tree of the whole document.
+//! Parts of the document can still be read as QVariant with readCurrentValue(), with the same types as StelJsonParser.
+//! Usage example, reading an array of records:
+//! @code
+//! StelJsonStreamReader reader(data);
+//! if (reader.readNext() != StelJsonStreamReader::StartArray) ...
+//! while (reader.readNext() == StelJsonStreamReader::StartObject)
+//! {
+//! 	while (reader.readNext() == StelJsonStreamReader::Name)
+//! 	{
+//! 		const QString name = reader.name();
+//! 		reader.readNext();
+//! 		if (name == "ra")
+//! 			ra = reader.numberValue();
+//! 		else
+//! 			reader.skipCurrentValue();
+//! 	}
+//! }
+//! @endcode
+//! Syntax errors throw a std::runtime_error, like StelJsonParser::parse().
+class StelJsonStreamReader
+{
+public:
+	enum TokenType
+	{
+		NoToken,	//!< nothing was read yet
+		StartObject,
+		EndObject,
+		StartArray,
+		EndArray,
+		Name,		//!< the name of an object member, see name(). The next token is its value.
+		String,
+		Number,
+		Bool,
+		Null,
+		EndDocument	//!< the document was read, readNext() returns it again
+	};
+
+	//! @param data the JSON document, which must stay valid while it is read
+	StelJsonStreamReader(const QByteArray& data);
+
+	//! Read the next token
+	//! @exception std::runtime_error if the document is not valid JSON
+	TokenType readNext();
+	//! Get the last token read
+	TokenType tokenType() const {return token;}
+	//! Get the offset in bytes of the first character of the last token
+	int tokenOffset() const {return tokenStart;}
+	//! Get the offset in bytes after the last token
+	int offset() const {return pos;}
+	//! Get the depth of nested objects and arrays, 0 at document level
+	int depth() const {return stack.size();}
+
+	//! The member name for Name tokens
+	const QString& name() const {return str;}
+	//! The value for String tokens
+	const QString& stringValue() const {return str;}
+	//! The value for Number tokens
+	double numberValue() const {return number;}
+	//! The value for Bool tokens
+	bool boolValue() const {return number!=0.;}
+
+	//! Skip the current value: if the last token is StartObject or StartArray, read until the matching end token,
+	//! if it is a Name, skip its value. Nothing is done for other tokens.
+	void skipCurrentValue();
+	//! Read the current value as QVariant: read the whole object or array if the last token is StartObject or
+	//! StartArray, the value of the member for a Name.
+	//! Objects give a QVariantMap, arrays a QVariantList and all numbers a double, like StelJsonParser::parse().
+	QVariant readCurrentValue();
+
+private:
+	struct Container
+	{
+		bool isObject;
+		bool isEmpty;
+	};
+
+	TokenType readValueToken();
+	void readString();
+	void readNumber();
+	void readLiteral(const char* literal, double value);
+	void skipSpace();
+	void error(const char* msg) const;
+
+	const char* data;
+	int size;
+	int pos;
+	int tokenStart;
+	TokenType token;
+	//! true after a Name, when the next token is its value
+	bool expectMemberValue;
+	QVector<Container> stack;
+	QString str;
+	double number;
+};
+
 #endif // STELJSONPARSER_HPP
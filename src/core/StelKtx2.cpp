@@ -0,0 +1,265 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelKtx2.hpp"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QOpenGLContext>
+#include <QSet>
+#include <QtEndian>
+
+#include <cstring>
+#include <limits>
+
+namespace
+{
+	//! A block compression format which can be read from KTX2 files.
+	struct BlockFormat
+	{
+		quint32 vkFormat;	// VkFormat value stored in the file
+		GLint glFormat;		// OpenGL internal format
+		int blockWidth;
+		int blockHeight;
+		int blockBytes;
+		bool alpha;
+		const char* extension;	// OpenGL extensions providing the format
+		const char* extension2;
+		int minGLVersion;	// desktop OpenGL version with the format in core, as major*10+minor, 0 if none
+		int minGLESVersion;	// same for OpenGL ES
+	};
+
+	// The sRGB variants are uploaded as linear formats like the images loaded through QImage,
+	// i.e. the shaders keep getting the sRGB encoded values.
+	const BlockFormat blockFormats[] =
+	{
+		// BC1-BC5 (S3TC and RGTC)
+		{131, 0x83F0, 4, 4,  8, false, "GL_EXT_texture_compression_s3tc", "GL_EXT_texture_compression_dxt1", 0, 0},
+		{132, 0x83F0, 4, 4,  8, false, "GL_EXT_texture_compression_s3tc", "GL_EXT_texture_compression_dxt1", 0, 0},
+		{133, 0x83F1, 4, 4,  8, true,  "GL_EXT_texture_compression_s3tc", "GL_EXT_texture_compression_dxt1", 0, 0},
+		{134, 0x83F1, 4, 4,  8, true,  "GL_EXT_texture_compression_s3tc", "GL_EXT_texture_compression_dxt1", 0, 0},
+		{135, 0x83F2, 4, 4, 16, true,  "GL_EXT_texture_compression_s3tc", Q_NULLPTR, 0, 0},
+		{136, 0x83F2, 4, 4, 16, true,  "GL_EXT_texture_compression_s3tc", Q_NULLPTR, 0, 0},
+		{137, 0x83F3, 4, 4, 16, true,  "GL_EXT_texture_compression_s3tc", Q_NULLPTR, 0, 0},
+		{138, 0x83F3, 4, 4, 16, true,  "GL_EXT_texture_compression_s3tc", Q_NULLPTR, 0, 0},
+		{139, 0x8DBB, 4, 4,  8, false, "GL_ARB_texture_compression_rgtc", "GL_EXT_texture_compression_rgtc", 30, 0},
+		{141, 0x8DBD, 4, 4, 16, false, "GL_ARB_texture_compression_rgtc", "GL_EXT_texture_compression_rgtc", 30, 0},
+		// BC7 (BPTC)
+		{145, 0x8E8C, 4, 4, 16, true,  "GL_ARB_texture_compression_bptc", "GL_EXT_texture_compression_bptc", 42, 0},
+		{146, 0x8E8C, 4, 4, 16, true,  "GL_ARB_texture_compression_bptc", "GL_EXT_texture_compression_bptc", 42, 0},
+		// ETC2 and EAC
+		{147, 0x9274, 4, 4,  8, false, "GL_ARB_ES3_compatibility", Q_NULLPTR, 43, 30},
+		{148, 0x9274, 4, 4,  8, false, "GL_ARB_ES3_compatibility", Q_NULLPTR, 43, 30},
+		{149, 0x9276, 4, 4,  8, true,  "GL_ARB_ES3_compatibility", Q_NULLPTR, 43, 30},
+		{150, 0x9276, 4, 4,  8, true,  "GL_ARB_ES3_compatibility", Q_NULLPTR, 43, 30},
+		{151, 0x9278, 4, 4, 16, true,  "GL_ARB_ES3_compatibility", Q_NULLPTR, 43, 30},
+		{152, 0x9278, 4, 4, 16, true,  "GL_ARB_ES3_compatibility", Q_NULLPTR, 43, 30},
+		{153, 0x9270, 4, 4,  8, false, "GL_ARB_ES3_compatibility", Q_NULLPTR, 43, 30},
+		{155, 0x9272, 4, 4, 16, false, "GL_ARB_ES3_compatibility", Q_NULLPTR, 43, 30},
+		// ASTC LDR, all block sizes use 16 bytes
+		{157, 0x93B0,  4,  4, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{158, 0x93B0,  4,  4, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{159, 0x93B1,  5,  4, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{160, 0x93B1,  5,  4, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{161, 0x93B2,  5,  5, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{162, 0x93B2,  5,  5, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{163, 0x93B3,  6,  5, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{164, 0x93B3,  6,  5, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{165, 0x93B4,  6,  6, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{166, 0x93B4,  6,  6, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{167, 0x93B5,  8,  5, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{168, 0x93B5,  8,  5, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{169, 0x93B6,  8,  6, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{170, 0x93B6,  8,  6, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{171, 0x93B7,  8,  8, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{172, 0x93B7,  8,  8, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{173, 0x93B8, 10,  5, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{174, 0x93B8, 10,  5, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{175, 0x93B9, 10,  6, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{176, 0x93B9, 10,  6, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{177, 0x93BA, 10,  8, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{178, 0x93BA, 10,  8, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{179, 0x93BB, 10, 10, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{180, 0x93BB, 10, 10, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{181, 0x93BC, 12, 10, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{182, 0x93BC, 12, 10, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{183, 0x93BD, 12, 12, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+		{184, 0x93BD, 12, 12, 16, true, "GL_KHR_texture_compression_astc_ldr", Q_NULLPTR, 0, 32},
+	};
+
+	const BlockFormat* findBlockFormat(quint32 vkFormat)
+	{
+		for (const auto& f : blockFormats)
+		{
+			if (f.vkFormat==vkFormat)
+				return &f;
+		}
+		return Q_NULLPTR;
+	}
+
+	const char ktx2Identifier[12] = {'\xAB', 'K', 'T', 'X', ' ', '2', '0', '\xBB', '\r', '\n', '\x1A', '\n'};
+	const int ktx2HeaderSize = 80;
+	const int ktx2LevelIndexEntrySize = 24;
+	const quint32 supercompressionNone = 0;
+	const quint32 supercompressionZlib = 3;
+
+	quint32 readU32(const char* p) { return qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(p)); }
+	quint64 readU64(const char* p) { return qFromLittleEndian<quint64>(reinterpret_cast<const uchar*>(p)); }
+}
+
+QVector<GLint> StelKtx2::getSupportedFormats(QOpenGLContext* context)
+{
+	QOpenGLFunctions* gl = context->functions();
+	QSet<GLint> listed;
+	GLint count = 0;
+	gl->glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+	if (count>0)
+	{
+		QVector<GLint> formats(count);
+		gl->glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+		for (auto f : formats)
+			listed.insert(f);
+	}
+
+	const int version = context->format().majorVersion()*10 + context->format().minorVersion();
+	QVector<GLint> result;
+	for (const auto& f : blockFormats)
+	{
+		if (result.contains(f.glFormat))
+			continue;
+		const int minVersion = context->isOpenGLES() ? f.minGLESVersion : f.minGLVersion;
+		if (listed.contains(f.glFormat) || (minVersion>0 && version>=minVersion)
+		    || context->hasExtension(f.extension) || (f.extension2 && context->hasExtension(f.extension2)))
+			result.append(f.glFormat);
+	}
+	return result;
+}
+
+QString StelKtx2::getSiblingPath(const QString& imagePath)
+{
+	const QFileInfo info(imagePath);
+	const QString suffix = info.suffix();
+	if (suffix.isEmpty() || suffix.compare("ktx2", Qt::CaseInsensitive)==0)
+		return QString();
+	return imagePath.left(imagePath.size()-suffix.size()) + "ktx2";
+}
+
+bool StelKtx2::read(const QString& path, const QVector<GLint>& supportedFormats)
+{
+	levels.clear();
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly))
+		return setError(QString("cannot open %1: %2").arg(path, file.errorString()));
+
+	const QByteArray header = file.read(ktx2HeaderSize);
+	if (header.size()!=ktx2HeaderSize || memcmp(header.constData(), ktx2Identifier, sizeof(ktx2Identifier))!=0)
+		return setError(QString("%1 is not a KTX2 file").arg(path));
+	const char* h = header.constData();
+	const quint32 vkFormat = readU32(h+12);
+	const quint32 pixelWidth = readU32(h+20);
+	const quint32 pixelHeight = readU32(h+24);
+	const quint32 pixelDepth = readU32(h+28);
+	const quint32 layerCount = readU32(h+32);
+	const quint32 faceCount = readU32(h+36);
+	const quint32 levelCount = qMax(readU32(h+40), 1u);
+	const quint32 supercompression = readU32(h+44);
+	const quint32 kvdOffset = readU32(h+56);
+	const quint32 kvdLength = readU32(h+60);
+
+	const BlockFormat* f = findBlockFormat(vkFormat);
+	if (f==Q_NULLPTR)
+		return setError(QString("%1: unsupported format %2").arg(path).arg(vkFormat));
+	if (!supportedFormats.contains(f->glFormat))
+		return setError(QString("%1: format %2 is not supported by the graphics driver").arg(path).arg(vkFormat));
+	if (pixelWidth==0 || pixelHeight==0 || pixelDepth>0 || layerCount>1 || faceCount!=1)
+		return setError(QString("%1: only 2D textures are supported").arg(path));
+	if (pixelWidth>65536 || pixelHeight>65536 || levelCount>17)
+		return setError(QString("%1: invalid texture size").arg(path));
+	if (supercompression!=supercompressionNone && supercompression!=supercompressionZlib)
+		return setError(QString("%1: unsupported supercompression scheme %2").arg(path).arg(supercompression));
+
+	// The KTXorientation key defaults to "rd", i.e. the first row is the top of the image.
+	QByteArray orientation("rd");
+	if (kvdLength>0 && kvdLength<(1<<20))
+	{
+		file.seek(kvdOffset);
+		const QByteArray kvd = file.read(kvdLength);
+		int pos = 0;
+		while (pos+4<=kvd.size())
+		{
+			const int length = static_cast<int>(readU32(kvd.constData()+pos));
+			if (length<=0 || pos+4+length>kvd.size())
+				break;
+			const QByteArray entry = kvd.mid(pos+4, length);
+			const int sep = entry.indexOf('\0');
+			if (sep>0 && entry.left(sep)=="KTXorientation")
+				orientation = entry.mid(sep+1).split('\0').first();
+			pos += 4 + ((length+3) & ~3);
+		}
+	}
+	if (orientation.size()<2 || orientation.at(1)!='u')
+		return setError(QString("%1: the KTXorientation must be \"ru\" (bottom row first)").arg(path));
+
+	file.seek(ktx2HeaderSize);
+	const QByteArray levelIndex = file.read(ktx2LevelIndexEntrySize*levelCount);
+	if (levelIndex.size()!=static_cast<int>(ktx2LevelIndexEntrySize*levelCount))
+		return setError(QString("%1: truncated file").arg(path));
+
+	int levelWidth = static_cast<int>(pixelWidth);
+	int levelHeight = static_cast<int>(pixelHeight);
+	for (quint32 i=0; i<levelCount; ++i)
+	{
+		const char* entry = levelIndex.constData() + i*ktx2LevelIndexEntrySize;
+		const quint64 offset = readU64(entry);
+		const quint64 length = readU64(entry+8);
+		const quint64 uncompressedLength = readU64(entry+16);
+		const quint64 expectedLength = static_cast<quint64>((levelWidth+f->blockWidth-1)/f->blockWidth)
+					      * static_cast<quint64>((levelHeight+f->blockHeight-1)/f->blockHeight) * f->blockBytes;
+		const quint64 dataLength = supercompression==supercompressionNone ? length : uncompressedLength;
+		if (dataLength!=expectedLength || length>static_cast<quint64>(std::numeric_limits<int>::max()-4))
+			return setError(QString("%1: invalid size of level %2").arg(path).arg(i));
+		if (!file.seek(static_cast<qint64>(offset)))
+			return setError(QString("%1: truncated file").arg(path));
+		QByteArray data = file.read(static_cast<qint64>(length));
+		if (data.size()!=static_cast<int>(length))
+			return setError(QString("%1: truncated file").arg(path));
+		if (supercompression==supercompressionZlib)
+		{
+			// qUncompress() expects the uncompressed size as a big endian prefix
+			uchar size[4];
+			qToBigEndian<quint32>(static_cast<quint32>(uncompressedLength), size);
+			data.prepend(reinterpret_cast<const char*>(size), 4);
+			data = qUncompress(data);
+			if (data.size()!=static_cast<int>(uncompressedLength))
+				return setError(QString("%1: cannot decompress level %2").arg(path).arg(i));
+		}
+		levels.append(data);
+		levelWidth = qMax(1, levelWidth/2);
+		levelHeight = qMax(1, levelHeight/2);
+	}
+
+	format = f->glFormat;
+	width = static_cast<int>(pixelWidth);
+	height = static_cast<int>(pixelHeight);
+	alpha = f->alpha;
+	errorString.clear();
+	return true;
+}
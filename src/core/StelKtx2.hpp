@@ -0,0 +1,79 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef STELKTX2_HPP
+#define STELKTX2_HPP
+
+#include "StelOpenGL.hpp"
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+class QOpenGLContext;
+
+//! @class StelKtx2
+//! Reader for precompressed textures in the KTX2 container format of the Khronos Group.
+//! Only 2D textures with a single layer and face in a GPU block compression format (BCn, ETC2/EAC or ASTC LDR),
+//! without supercompression or with zlib supercompression, are supported. Files must be stored with the
+//! "ru" KTXorientation, i.e. their first row is the bottom of the image like for textures created from a QImage.
+//! StelTexture loads a KTX2 file instead of an image when a sibling file with the .ktx2 suffix exists,
+//! see getSiblingPath(). Such files can be created with the ktx2ForTextures tool in the util directory.
+class StelKtx2
+{
+public:
+	//! Get the formats readable from KTX2 files which the OpenGL context can use. Requires a valid context.
+	//! @return the OpenGL internal formats
+	static QVector<GLint> getSupportedFormats(QOpenGLContext* context);
+
+	//! Get the path of the KTX2 file which can replace an image, i.e. the same path with the .ktx2 suffix.
+	static QString getSiblingPath(const QString& imagePath);
+
+	//! Read a KTX2 file. This does not require an OpenGL context.
+	//! @param supportedFormats the formats from getSupportedFormats(), files in other formats are rejected
+	//! @return false if the file could not be read, see getErrorString()
+	bool read(const QString& path, const QVector<GLint>& supportedFormats);
+
+	//! Get the OpenGL internal format of the file, to be passed to glCompressedTexImage2D().
+	GLint getFormat() const {return format;}
+	//! Get the width of the first level in pixels.
+	int getWidth() const {return width;}
+	//! Get the height of the first level in pixels.
+	int getHeight() const {return height;}
+	//! Get whether the format can store an alpha channel.
+	bool hasAlphaChannel() const {return alpha;}
+	//! Get the data of the mipmap levels, from the largest to the smallest.
+	const QList<QByteArray>& getLevels() const {return levels;}
+	//! Get the error message when read() failed.
+	const QString& getErrorString() const {return errorString;}
+
+private:
+	bool setError(const QString& error) {errorString = error; return false;}
+
+	GLint format = 0;
+	int width = 0;
+	int height = 0;
+	bool alpha = false;
+	QList<QByteArray> levels;
+	QString errorString;
+};
+
+#endif // STELKTX2_HPP
@@ -62,9 +62,11 @@ StelLocaleMgr::StelLocaleMgr()
 
 StelLocaleMgr::~StelLocaleMgr()
 {
-	delete skyTranslator;
+	qDeleteAll(skyTranslators);
+	skyTranslators.clear();
 	skyTranslator = Q_NULLPTR;
-	delete planetaryFeaturesTranslator;
+	qDeleteAll(planetaryFeaturesTranslators);
+	planetaryFeaturesTranslators.clear();
 	planetaryFeaturesTranslator = Q_NULLPTR;
 }
 
@@ -151,14 +153,21 @@ bool StelLocaleMgr::isAppRTL() const
 *************************************************************************/
 void StelLocaleMgr::setSkyLanguage(const QString& newSkyLanguageName, bool refreshAll)
 {
-	delete skyTranslator;
-	// Update the translator with new locale name
-	skyTranslator = new StelTranslator("stellarium-skycultures", newSkyLanguageName);
+	// Update the translator with new locale name, reusing the one of a language used before
+	skyTranslator = skyTranslators.value(newSkyLanguageName, Q_NULLPTR);
+	if (!skyTranslator)
+	{
+		skyTranslator = new StelTranslator("stellarium-skycultures", newSkyLanguageName);
+		skyTranslators.insert(newSkyLanguageName, skyTranslator);
+	}
 	qDebug() << "Sky language is " << skyTranslator->getTrueLocaleName();
 
-	delete planetaryFeaturesTranslator;
-	// Update the translator with new locale name
-	planetaryFeaturesTranslator = new StelTranslator("stellarium-planetary-features", newSkyLanguageName);
+	planetaryFeaturesTranslator = planetaryFeaturesTranslators.value(newSkyLanguageName, Q_NULLPTR);
+	if (!planetaryFeaturesTranslator)
+	{
+		planetaryFeaturesTranslator = new StelTranslator("stellarium-planetary-features", newSkyLanguageName);
+		planetaryFeaturesTranslators.insert(newSkyLanguageName, planetaryFeaturesTranslator);
+	}
 	qDebug() << "Planetary features language is " << planetaryFeaturesTranslator->getTrueLocaleName();
 
 	if (refreshAll)
@@ -154,6 +154,10 @@ private:
 	// The translator used for astronomical object naming
 	StelTranslator* skyTranslator;
 	StelTranslator* planetaryFeaturesTranslator;
+	// The translators of the sky languages used so far. They keep their translations, so that switching
+	// back to a language does not look up the names in the translation files again.
+	QHash<QString, StelTranslator*> skyTranslators;
+	QHash<QString, StelTranslator*> planetaryFeaturesTranslators;
 	StelCore* core;
 	
 	// Date and time variables
@@ -0,0 +1,429 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelLocationDB.hpp"
+#include "StelUtils.hpp"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+#include <QHash>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	static const quint32 LOCATION_DB_MAGIC = 0x534c4442; // "SLDB"
+	static const quint32 LOCATION_DB_VERSION = 1;
+
+	//! The grid index has cells of 1x1 degree
+	static const int GRID_LAT = 180;
+	static const int GRID_LON = 360;
+	static const int GRID_CELLS = GRID_LAT*GRID_LON;
+
+	int cellLatitude(double latitude)
+	{
+		return qBound(0, static_cast<int>(std::floor(latitude + 90.)), GRID_LAT-1);
+	}
+
+	int cellLongitude(double longitude)
+	{
+		const int lon = static_cast<int>(std::floor(longitude + 180.)) % GRID_LON;
+		return lon < 0 ? lon + GRID_LON : lon;
+	}
+}
+
+//! The file starts with the header, followed by the records, the time zone names, the start of each grid cell
+//! in the cell items, the cell items, the country index and the strings. All offsets into the strings are in
+//! bytes, all other indices refer to records.
+struct StelLocationDB::Header
+{
+	quint32 magic;
+	quint32 version;
+	qint64 sourceSize;
+	qint64 sourceTime;
+	quint32 count;
+	quint32 timeZoneCount;
+	quint32 stringsSize;
+	quint32 gridCells;
+};
+
+struct StelLocationDB::Record
+{
+	//! @name Offsets of UTF-8 strings, identical strings are stored once
+	//! @{
+	quint32 id;
+	quint32 name;
+	quint32 state;
+	quint32 country;
+	quint32 planetName;
+	quint32 landscapeKey;
+	//! @}
+	float longitude;
+	float latitude;
+	qint32 altitude;
+	qint32 bortleScaleIndex;
+	qint32 population;
+	quint16 role;
+	//! Index in the time zone names
+	quint16 timeZone;
+};
+
+StelLocationDB::StelLocationDB()
+	: data(Q_NULLPTR)
+	, header(Q_NULLPTR)
+	, records(Q_NULLPTR)
+	, cellStart(Q_NULLPTR)
+	, cellItems(Q_NULLPTR)
+	, countryOrder(Q_NULLPTR)
+	, strings(Q_NULLPTR)
+{
+}
+
+StelLocationDB::~StelLocationDB()
+{
+	close();
+}
+
+bool StelLocationDB::write(const QString& filePath, const QMap<QString, StelLocation>& locations, const QFileInfo& source)
+{
+	QByteArray stringData;
+	QHash<QString, quint32> stringOffsets;
+	auto addString = [&](const QString& s) -> quint32
+	{
+		auto it = stringOffsets.constFind(s);
+		if (it!=stringOffsets.constEnd())
+			return it.value();
+		const quint32 offset = static_cast<quint32>(stringData.size());
+		stringData.append(s.toUtf8());
+		stringData.append('\0');
+		stringOffsets.insert(s, offset);
+		return offset;
+	};
+
+	QVector<quint32> timeZoneOffsets;
+	QHash<QString, int> timeZoneIndices;
+	QVector<Record> recordData;
+	QVector<QString> countries;
+	recordData.reserve(locations.size());
+	countries.reserve(locations.size());
+	// The map is sorted by ID
+	for (auto it=locations.constBegin(); it!=locations.constEnd(); ++it)
+	{
+		const StelLocation& loc = it.value();
+		Record r;
+		r.id = addString(it.key());
+		r.name = addString(loc.name);
+		r.state = addString(loc.state);
+		r.country = addString(loc.country);
+		r.planetName = addString(loc.planetName);
+		r.landscapeKey = addString(loc.landscapeKey);
+		r.longitude = loc.longitude;
+		r.latitude = loc.latitude;
+		r.altitude = loc.altitude;
+		r.bortleScaleIndex = loc.bortleScaleIndex;
+		r.population = loc.population;
+		r.role = loc.role.unicode();
+		if (!timeZoneIndices.contains(loc.ianaTimeZone))
+		{
+			if (timeZoneOffsets.size()>0xffff)
+				return false;
+			timeZoneIndices.insert(loc.ianaTimeZone, timeZoneOffsets.size());
+			timeZoneOffsets.append(addString(loc.ianaTimeZone));
+		}
+		r.timeZone = static_cast<quint16>(timeZoneIndices.value(loc.ianaTimeZone));
+		recordData.append(r);
+		countries.append(loc.country);
+	}
+	const quint32 count = static_cast<quint32>(recordData.size());
+
+	// Grid index, sorted by cell with a counting sort
+	QVector<quint32> cellStartData(GRID_CELLS+1, 0);
+	QVector<int> recordCells(recordData.size());
+	for (int i=0; i<recordData.size(); ++i)
+	{
+		recordCells[i] = cellLatitude(recordData[i].latitude)*GRID_LON + cellLongitude(recordData[i].longitude);
+		++cellStartData[recordCells[i]+1];
+	}
+	for (int c=0; c<GRID_CELLS; ++c)
+		cellStartData[c+1] += cellStartData[c];
+	QVector<quint32> cellItemData(recordData.size());
+	QVector<quint32> cellFill = cellStartData;
+	for (int i=0; i<recordData.size(); ++i)
+		cellItemData[cellFill[recordCells[i]]++] = static_cast<quint32>(i);
+
+	// Country index, the locations of a country stay in ID order
+	QVector<quint32> countryOrderData(recordData.size());
+	for (int i=0; i<recordData.size(); ++i)
+		countryOrderData[i] = static_cast<quint32>(i);
+	std::stable_sort(countryOrderData.begin(), countryOrderData.end(),
+			 [&countries](quint32 a, quint32 b) { return countries[a] < countries[b]; });
+
+	// Keep the sections aligned to 4 bytes
+	while (stringData.size()%4)
+		stringData.append('\0');
+
+	Header h;
+	h.magic = LOCATION_DB_MAGIC;
+	h.version = LOCATION_DB_VERSION;
+	h.sourceSize = source.size();
+	h.sourceTime = source.lastModified().toMSecsSinceEpoch();
+	h.count = count;
+	h.timeZoneCount = static_cast<quint32>(timeZoneOffsets.size());
+	h.stringsSize = static_cast<quint32>(stringData.size());
+	h.gridCells = GRID_CELLS;
+
+	QFile out(filePath + ".tmp");
+	if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+	bool ok = out.write(reinterpret_cast<const char*>(&h), sizeof(Header))==sizeof(Header);
+	auto writeVector = [&out, &ok](const char* p, qint64 size)
+	{
+		if (ok && size>0)
+			ok = out.write(p, size)==size;
+	};
+	writeVector(reinterpret_cast<const char*>(recordData.constData()), recordData.size()*static_cast<qint64>(sizeof(Record)));
+	writeVector(reinterpret_cast<const char*>(timeZoneOffsets.constData()), timeZoneOffsets.size()*4LL);
+	writeVector(reinterpret_cast<const char*>(cellStartData.constData()), cellStartData.size()*4LL);
+	writeVector(reinterpret_cast<const char*>(cellItemData.constData()), cellItemData.size()*4LL);
+	writeVector(reinterpret_cast<const char*>(countryOrderData.constData()), countryOrderData.size()*4LL);
+	writeVector(stringData.constData(), stringData.size());
+	out.close();
+	if (ok)
+	{
+		QFile::remove(filePath);
+		ok = out.rename(filePath);
+	}
+	if (!ok)
+		out.remove();
+	return ok;
+}
+
+bool StelLocationDB::open(const QString& filePath, const QFileInfo& source)
+{
+	close();
+	file.setFileName(filePath);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+	const qint64 size = file.size();
+	if (size<static_cast<qint64>(sizeof(Header)) || (data = file.map(0, size))==Q_NULLPTR)
+	{
+		close();
+		return false;
+	}
+
+	const Header* h = reinterpret_cast<const Header*>(data);
+	if (h->magic!=LOCATION_DB_MAGIC || h->version!=LOCATION_DB_VERSION || h->gridCells!=static_cast<quint32>(GRID_CELLS)
+	    || h->sourceSize!=source.size() || h->sourceTime!=source.lastModified().toMSecsSinceEpoch())
+	{
+		close();
+		return false;
+	}
+	const qint64 expectedSize = static_cast<qint64>(sizeof(Header)) + h->count*static_cast<qint64>(sizeof(Record))
+				    + 4LL*(h->timeZoneCount + GRID_CELLS + 1 + 2LL*h->count) + h->stringsSize;
+	if (size!=expectedSize || (h->stringsSize>0 && data[size-1]!='\0'))
+	{
+		qWarning() << "Invalid location database" << filePath;
+		close();
+		return false;
+	}
+
+	const uchar* p = data + sizeof(Header);
+	records = reinterpret_cast<const Record*>(p);
+	p += h->count*sizeof(Record);
+	const quint32* timeZoneOffsets = reinterpret_cast<const quint32*>(p);
+	p += 4*h->timeZoneCount;
+	cellStart = reinterpret_cast<const quint32*>(p);
+	p += 4*(GRID_CELLS+1);
+	cellItems = reinterpret_cast<const quint32*>(p);
+	p += 4*h->count;
+	countryOrder = reinterpret_cast<const quint32*>(p);
+	p += 4*h->count;
+	strings = reinterpret_cast<const char*>(p);
+	header = h;
+
+	for (quint32 i=0; i<h->timeZoneCount; ++i)
+		timeZoneNames.append(string(timeZoneOffsets[i]));
+	return true;
+}
+
+void StelLocationDB::close()
+{
+	if (data)
+		file.unmap(const_cast<uchar*>(data));
+	file.close();
+	data = Q_NULLPTR;
+	header = Q_NULLPTR;
+	records = Q_NULLPTR;
+	cellStart = Q_NULLPTR;
+	cellItems = Q_NULLPTR;
+	countryOrder = Q_NULLPTR;
+	strings = Q_NULLPTR;
+	timeZoneNames.clear();
+}
+
+int StelLocationDB::count() const
+{
+	return header ? static_cast<int>(header->count) : 0;
+}
+
+const StelLocationDB::Record& StelLocationDB::record(int index) const
+{
+	Q_ASSERT(index>=0 && index<count());
+	return records[index];
+}
+
+QString StelLocationDB::string(quint32 offset) const
+{
+	if (offset>=header->stringsSize)
+		return QString();
+	return QString::fromUtf8(strings + offset);
+}
+
+int StelLocationDB::find(const QString& id) const
+{
+	// Same order as the keys of QMap<QString, ...>
+	int lo = 0;
+	int hi = count();
+	while (lo<hi)
+	{
+		const int mid = lo + (hi-lo)/2;
+		if (string(records[mid].id) < id)
+			lo = mid+1;
+		else
+			hi = mid;
+	}
+	return (lo<count() && string(records[lo].id)==id) ? lo : -1;
+}
+
+QString StelLocationDB::getID(int index) const
+{
+	return string(record(index).id);
+}
+
+StelLocation StelLocationDB::getLocation(int index) const
+{
+	const Record& r = record(index);
+	StelLocation loc;
+	loc.name = string(r.name);
+	loc.state = string(r.state);
+	loc.country = string(r.country);
+	loc.planetName = string(r.planetName);
+	loc.landscapeKey = string(r.landscapeKey);
+	loc.longitude = r.longitude;
+	loc.latitude = r.latitude;
+	loc.altitude = r.altitude;
+	loc.bortleScaleIndex = r.bortleScaleIndex;
+	loc.population = r.population;
+	loc.role = QChar(r.role);
+	loc.ianaTimeZone = timeZoneNames.value(r.timeZone);
+	loc.isUserLocation = false;
+	return loc;
+}
+
+QStringList StelLocationDB::getIDs(const QVector<int>& indices) const
+{
+	QStringList ids;
+	ids.reserve(indices.size());
+	for (const int i : indices)
+		ids.append(getID(i));
+	return ids;
+}
+
+QStringList StelLocationDB::getAllIDs() const
+{
+	QStringList ids;
+	const int n = count();
+	ids.reserve(n);
+	for (int i=0; i<n; ++i)
+		ids.append(string(records[i].id));
+	return ids;
+}
+
+QVector<int> StelLocationDB::findNearby(const QString& planetName, float longitude, float latitude, float radiusDegrees) const
+{
+	QVector<int> result;
+	if (!isOpen())
+		return result;
+
+	// Identical strings share their offset, so the planet name is only compared once
+	qint64 planetOffset = -1;
+	auto test = [&](int i)
+	{
+		const Record& r = records[i];
+		if (r.planetName!=planetOffset)
+		{
+			if (planetOffset>=0 || string(r.planetName)!=planetName)
+				return;
+			planetOffset = r.planetName;
+		}
+		if (StelLocation::distanceDegrees(longitude, latitude, r.longitude, r.latitude) <= radiusDegrees)
+			result.append(i);
+	};
+
+	const double margin = 1e-3;
+	if (radiusDegrees>=90.f || std::fabs(latitude)+radiusDegrees>=90.f-margin)
+	{
+		// A pole is inside the circle: all longitudes of the latitude band
+		const int lat0 = radiusDegrees>=90.f ? 0 : cellLatitude(latitude - radiusDegrees - margin);
+		const int lat1 = radiusDegrees>=90.f ? GRID_LAT-1 : cellLatitude(latitude + radiusDegrees + margin);
+		for (quint32 k=cellStart[lat0*GRID_LON]; k<cellStart[(lat1+1)*GRID_LON]; ++k)
+			test(static_cast<int>(cellItems[k]));
+	}
+	else
+	{
+		// Largest difference of longitude on the circle
+		const double dLon = std::asin(std::sin(radiusDegrees*M_PI/180.)/std::cos(latitude*M_PI/180.))*180./M_PI + margin;
+		const int lat0 = cellLatitude(latitude - radiusDegrees - margin);
+		const int lat1 = cellLatitude(latitude + radiusDegrees + margin);
+		const int lon0 = static_cast<int>(std::floor(longitude - dLon + 180.));
+		const int lon1 = qMin(static_cast<int>(std::floor(longitude + dLon + 180.)), lon0 + GRID_LON - 1);
+		for (int lat=lat0; lat<=lat1; ++lat)
+		{
+			for (int lon=lon0; lon<=lon1; ++lon)
+			{
+				const int c = lat*GRID_LON + cellLongitude(lon - 180.);
+				for (quint32 k=cellStart[c]; k<cellStart[c+1]; ++k)
+					test(static_cast<int>(cellItems[k]));
+			}
+		}
+	}
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+QVector<int> StelLocationDB::findInCountry(const QString& country) const
+{
+	QVector<int> result;
+	const quint32* begin = countryOrder;
+	const quint32* end = countryOrder + count();
+	const quint32* first = std::lower_bound(begin, end, country,
+						[this](quint32 i, const QString& c) { return string(records[i].country) < c; });
+	for (const quint32* it=first; it!=end && string(records[*it].country)==country; ++it)
+		result.append(static_cast<int>(*it));
+	return result;
+}
+
+void StelLocationDB::setTimeZoneNames(const QStringList& names)
+{
+	Q_ASSERT(names.size()==timeZoneNames.size());
+	if (names.size()==timeZoneNames.size())
+		timeZoneNames = names;
+}
@@ -0,0 +1,96 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STELLOCATIONDB_HPP
+#define STELLOCATIONDB_HPP
+
+#include "StelLocation.hpp"
+
+#include <QFile>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QFileInfo;
+
+//! @class StelLocationDB
+//! Read-only list of locations in a memory-mapped binary file, e.g. the base locations of StelLocationMgr.
+//! The locations are sorted by ID, so that they are found by binary search, and indexed by country and on a
+//! grid of 1x1 degrees of latitude and longitude, so that nearby locations are found without computing the
+//! distance to each location. Nothing but the time zone names is copied to the heap.
+//! The file is written by write() in native byte order, and is only used on the machine which created it.
+class StelLocationDB
+{
+public:
+	StelLocationDB();
+	~StelLocationDB();
+
+	//! Write a database file.
+	//! @param source the file from which the locations were read, open() refuses the database once it changed
+	static bool write(const QString& filePath, const QMap<QString, StelLocation>& locations, const QFileInfo& source);
+
+	//! Map a database file.
+	//! @return false if the file is missing or invalid, or was not written from the current version of the source file
+	bool open(const QString& filePath, const QFileInfo& source);
+	void close();
+	bool isOpen() const {return header!=Q_NULLPTR;}
+
+	//! Number of locations
+	int count() const;
+	//! Get the index of a location from its ID, or -1 if there is none.
+	int find(const QString& id) const;
+	//! Get the ID of the location with the index.
+	QString getID(int index) const;
+	//! Get the location with the index.
+	StelLocation getLocation(int index) const;
+	//! Get the IDs of the locations with the indices.
+	QStringList getIDs(const QVector<int>& indices) const;
+	//! Get the sorted IDs of all locations.
+	QStringList getAllIDs() const;
+
+	//! Get the indices of the locations within a radius, in the order of their IDs.
+	QVector<int> findNearby(const QString& planetName, float longitude, float latitude, float radiusDegrees) const;
+	//! Get the indices of the locations of a country, in the order of their IDs.
+	QVector<int> findInCountry(const QString& country) const;
+
+	//! Get the distinct time zone names of the locations.
+	const QStringList& getTimeZoneNames() const {return timeZoneNames;}
+	//! Replace the time zone names, e.g. by names known to Qt. The list must have the same size.
+	void setTimeZoneNames(const QStringList& names);
+
+private:
+	struct Header;
+	struct Record;
+
+	const Record& record(int index) const;
+	QString string(quint32 offset) const;
+
+	QFile file;
+	const uchar* data;
+	const Header* header;
+	const Record* records;
+	const quint32* cellStart;
+	const quint32* cellItems;
+	const quint32* countryOrder;
+	const char* strings;
+	QStringList timeZoneNames;
+};
+
+#endif // STELLOCATIONDB_HPP
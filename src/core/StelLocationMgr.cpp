@@ -30,6 +30,7 @@
 #include <QDebug>
 #include <QFile>
 #include <QDir>
+#include <QFileInfo>
 #include <QNetworkInterface>
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
@@ -41,6 +42,9 @@
 #include <QTimer>
 #include <QApplication>
 
+#include <algorithm>
+#include <stdexcept>
+
 TimezoneNameMap StelLocationMgr::locationDBToIANAtranslations;
 
 #ifdef ENABLE_GPS
@@ -444,7 +448,8 @@ StelLocationMgr::StelLocationMgr()
 	if (conf->value("devel/convert_locations_list", false).toBool())
 		generateBinaryLocationFile("data/base_locations.txt", false, "data/base_locations.bin");
 
-	locations = loadCitiesBin("data/base_locations.bin.gz");
+	if (!openBaseLocations("data/base_locations.bin.gz", locations))
+		qWarning() << "The locations are not indexed, using the location list in memory";
 	locations.unite(loadCities("data/user_locations.txt", true));
 	
 	// Init to Paris France because it's the center of the world.
@@ -475,6 +480,35 @@ StelLocationMgr::StelLocationMgr(const LocationList &locations)
 	lastResortLocation = locationForString(conf->value("init_location/last_location", "Paris, France").toString());
 }
 
+LocationList StelLocationMgr::getAll() const
+{
+	LocationList res = locations.values();
+	const int count = baseLocations.count();
+	res.reserve(res.size() + count);
+	for (int i=0; i<count; ++i)
+		res.append(baseLocations.getLocation(i));
+	return res;
+}
+
+LocationMap StelLocationMgr::getAllMap() const
+{
+	LocationMap res = locations;
+	const int count = baseLocations.count();
+	for (int i=0; i<count; ++i)
+		res.insert(baseLocations.getID(i), baseLocations.getLocation(i));
+	return res;
+}
+
+QStringList StelLocationMgr::getAllIDs() const
+{
+	// Both lists are sorted
+	QStringList ids = baseLocations.getAllIDs();
+	const int count = ids.size();
+	ids.append(locations.keys());
+	std::inplace_merge(ids.begin(), ids.begin()+count, ids.end());
+	return ids;
+}
+
 void StelLocationMgr::setLocations(const LocationList &locations)
 {
 	for (const auto& loc : locations)
@@ -533,21 +567,30 @@ LocationMap StelLocationMgr::loadCitiesBin(const QString& fileName)
 	QStringList unknownTZlist;
 	for (auto& loc : res)
 	{
-		if ((loc.ianaTimeZone!="LMST") &&  (loc.ianaTimeZone!="LTST") && ( ! availableTimeZoneList.contains(loc.ianaTimeZone.toUtf8())) )
-		{
-			// TZ name which is currently unknown to Qt detected. See if we can translate it, if not: complain to qDebug().
-			QString fixTZname=sanitizeTimezoneStringFromLocationDB(loc.ianaTimeZone);
-			if (availableTimeZoneList.contains(fixTZname.toUtf8()))
-			{
-				loc.ianaTimeZone=fixTZname;
-			}
-			else
-			{
-				qDebug() << "StelLocationMgr::loadCitiesBin(): TimeZone for " << loc.name <<  " not found: " << loc.ianaTimeZone;
-				unknownTZlist.append(loc.ianaTimeZone);
-			}
-		}
+		const int unknownCount = unknownTZlist.size();
+		loc.ianaTimeZone = checkTimeZone(loc.ianaTimeZone, availableTimeZoneList, unknownTZlist);
+		if (unknownTZlist.size()>unknownCount)
+			qDebug() << "StelLocationMgr::loadCitiesBin(): TimeZone for " << loc.name <<  " not found: " << loc.ianaTimeZone;
 	}
+	reportUnknownTimeZones(unknownTZlist);
+
+	return res;
+}
+
+QString StelLocationMgr::checkTimeZone(const QString& tz, const QList<QByteArray>& availableTimeZoneList, QStringList& unknownTZlist)
+{
+	if ((tz=="LMST") || (tz=="LTST") || availableTimeZoneList.contains(tz.toUtf8()))
+		return tz;
+	// TZ name which is currently unknown to Qt detected. See if we can translate it, if not: complain to qDebug().
+	const QString fixTZname=sanitizeTimezoneStringFromLocationDB(tz);
+	if (availableTimeZoneList.contains(fixTZname.toUtf8()))
+		return fixTZname;
+	unknownTZlist.append(tz);
+	return tz;
+}
+
+void StelLocationMgr::reportUnknownTimeZones(QStringList& unknownTZlist)
+{
 	if (unknownTZlist.length()>0)
 	{
 		unknownTZlist.removeDuplicates();
@@ -559,8 +602,49 @@ LocationMap StelLocationMgr::loadCitiesBin(const QString& fileName)
 		qDebug() << "Please report these timezone names (this logfile) to the Stellarium developers.";
 		// Note to developers: Fill those names and replacements to the map above.
 	}
+}
 
-	return res;
+bool StelLocationMgr::openBaseLocations(const QString& fileName, LocationMap& fallback)
+{
+	const QString cityDataPath = StelFileMgr::findFile(fileName);
+	if (cityDataPath.isEmpty())
+		return false;
+	const QFileInfo source(cityDataPath);
+	const QString dbPath = StelFileMgr::getCacheDir() + "/locations/base_locations.db";
+	if (baseLocations.open(dbPath, source))
+	{
+		// Qt may know other time zones than when the database was written
+		const QList<QByteArray> availableTimeZoneList=QTimeZone::availableTimeZoneIds();
+		QStringList unknownTZlist;
+		QStringList timeZones = baseLocations.getTimeZoneNames();
+		for (auto& tz : timeZones)
+			tz = checkTimeZone(tz, availableTimeZoneList, unknownTZlist);
+		reportUnknownTimeZones(unknownTZlist);
+		baseLocations.setTimeZoneNames(timeZones);
+		return true;
+	}
+
+	// The time zones are checked while loading
+	fallback = loadCitiesBin(fileName);
+	if (fallback.isEmpty())
+		return false;
+	try
+	{
+		StelFileMgr::makeSureDirExistsAndIsWritable(QFileInfo(dbPath).absolutePath());
+	}
+	catch (std::runtime_error& e)
+	{
+		qWarning() << "Cannot create location database directory:" << e.what();
+		return false;
+	}
+	if (!StelLocationDB::write(dbPath, fallback, source) || !baseLocations.open(dbPath, source))
+	{
+		qWarning() << "Cannot write location database" << QDir::toNativeSeparators(dbPath);
+		return false;
+	}
+	qDebug() << "Created location database" << QDir::toNativeSeparators(dbPath);
+	fallback.clear();
+	return true;
 }
 
 // Done in the following: TZ name sanitizing also for text file!
@@ -649,6 +733,9 @@ const StelLocation StelLocationMgr::locationForString(const QString& s) const
 	{
 		return iter.value();
 	}
+	const int index = baseLocations.find(s);
+	if (index>=0)
+		return baseLocations.getLocation(index);
 	StelLocation ret;
 	// Maybe it is a coordinate set with elevation?
 	QRegExp csreg("(.+),\\s*(.+),\\s*(.+)");
@@ -705,7 +792,7 @@ const StelLocation StelLocationMgr::locationFromCLI() const
 // Get whether a location can be permanently added to the list of user locations
 bool StelLocationMgr::canSaveUserLocation(const StelLocation& loc) const
 {
-	return loc.isValid() && locations.find(loc.getID())==locations.end();
+	return loc.isValid() && locations.find(loc.getID())==locations.end() && baseLocations.find(loc.getID())<0;
 }
 
 // Add permanently a location to the list of user locations
@@ -1022,6 +1109,8 @@ LocationMap StelLocationMgr::pickLocationsNearby(const QString planetName, const
 			results.insert(iter.key(), iter.value());
 		}
 	}
+	for (const int i : baseLocations.findNearby(planetName, longitude, latitude, radiusDegrees))
+		results.insert(baseLocations.getID(i), baseLocations.getLocation(i));
 	return results;
 }
 
@@ -1038,9 +1127,38 @@ LocationMap StelLocationMgr::pickLocationsInCountry(const QString country)
 			results.insert(iter.key(), iter.value());
 		}
 	}
+	for (const int i : baseLocations.findInCountry(country))
+		results.insert(baseLocations.getID(i), baseLocations.getLocation(i));
 	return results;
 }
 
+QStringList StelLocationMgr::pickLocationIDsNearby(const QString& planetName, float longitude, float latitude, float radiusDegrees) const
+{
+	QStringList ids = baseLocations.getIDs(baseLocations.findNearby(planetName, longitude, latitude, radiusDegrees));
+	const int count = ids.size();
+	for (auto iter=locations.constBegin(); iter!=locations.constEnd(); ++iter)
+	{
+		if ( (iter.value().planetName == planetName) &&
+				(StelLocation::distanceDegrees(longitude, latitude, iter.value().longitude, iter.value().latitude) <= radiusDegrees) )
+			ids.append(iter.key());
+	}
+	std::inplace_merge(ids.begin(), ids.begin()+count, ids.end());
+	return ids;
+}
+
+QStringList StelLocationMgr::pickLocationIDsInCountry(const QString& country) const
+{
+	QStringList ids = baseLocations.getIDs(baseLocations.findInCountry(country));
+	const int count = ids.size();
+	for (auto iter=locations.constBegin(); iter!=locations.constEnd(); ++iter)
+	{
+		if (iter.value().country == country)
+			ids.append(iter.key());
+	}
+	std::inplace_merge(ids.begin(), ids.begin()+count, ids.end());
+	return ids;
+}
+
 // Check timezone string and return either the same or the corresponding string that we use in the Stellarium location database.
 // If timezone name starts with "UTC", always return unchanged.
 // This is required to store timezone names exactly as we know them, and not mix ours and corrent-iana spelling flavour.
@@ -1085,6 +1203,8 @@ QStringList StelLocationMgr::getAllTimezoneNames() const
 		if (!ret.contains(tz))
 			ret.append(tz);
 	}
+	ret.append(baseLocations.getTimeZoneNames());
+	ret.removeDuplicates();
 	ret.sort();
 	return ret;
 }
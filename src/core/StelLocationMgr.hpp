@@ -20,6 +20,7 @@
 #define STELLOCATIONMGR_HPP
 
 #include "StelLocation.hpp"
+#include "StelLocationDB.hpp"
 #include <QString>
 #include <QObject>
 #include <QMetaType>
@@ -49,10 +50,15 @@ public:
 	void setLocations(const LocationList& locations);
 
 	//! Return the list of all loaded locations
-	LocationList getAll() const {return locations.values();}
+	//! @note This copies all base locations, prefer getAllIDs() and locationForString() where possible.
+	LocationList getAll() const;
 
 	//! Returns a map of all loaded locations. The key is the location ID, suitable for a list view.
-	LocationMap getAllMap() const { return locations; }
+	//! @note This copies all base locations, use getAllIDs() if only the IDs are needed.
+	LocationMap getAllMap() const;
+
+	//! Returns the sorted IDs of all loaded locations, suitable for a list view.
+	QStringList getAllIDs() const;
 
 	//! Return the StelLocation from a CLI
 	const StelLocation locationFromCLI() const;
@@ -82,6 +88,10 @@ public:
 	LocationMap pickLocationsNearby(const QString planetName, const float longitude, const float latitude, const float radiusDegrees);
 	//! Find list of locations in a particular country only.
 	LocationMap pickLocationsInCountry(const QString country);
+	//! Like pickLocationsNearby(), but only returns the sorted IDs of the locations.
+	QStringList pickLocationIDsNearby(const QString& planetName, float longitude, float latitude, float radiusDegrees) const;
+	//! Like pickLocationsInCountry(), but only returns the sorted IDs of the locations.
+	QStringList pickLocationIDsInCountry(const QString& country) const;
 
 public slots:
 	//! Return the StelLocation for a given string
@@ -139,8 +149,16 @@ private:
 	//! Load cities from a file
 	static LocationMap loadCities(const QString& fileName, bool isUserLocation);
 	static LocationMap loadCitiesBin(const QString& fileName);
-
-	//! The list of all loaded locations
+	//! Open the database of the base locations in the cache directory, creating it from the binary location file if needed.
+	//! @param fallback receives the base locations if they were read but the database cannot be written
+	bool openBaseLocations(const QString& fileName, LocationMap& fallback);
+	//! Get the name of a time zone which is known to Qt, or add it to the unknown ones.
+	static QString checkTimeZone(const QString& tz, const QList<QByteArray>& availableTimeZoneList, QStringList& unknownTZlist);
+	static void reportUnknownTimeZones(QStringList& unknownTZlist);
+
+	//! The base locations, memory-mapped from the location database
+	StelLocationDB baseLocations;
+	//! The user locations, and the base locations if the location database cannot be used
 	LocationMap locations;
 	//! A Map which has to be used to replace, system- and Qt-version dependent,
 	//! timezone names from our location database to the code names currently used by Qt.
@@ -21,6 +21,7 @@
 #define STELMODULE_HPP
 
 #include <QString>
+#include <QStringList>
 #include <QObject>
 
 // Predeclaration
@@ -63,6 +64,25 @@ public:
 	//! If the initialization takes significant time, the progress should be displayed on the loading bar.
 	virtual void init() = 0;
 
+	//! Load the data of the module which do not need the main thread, e.g. parse catalog files.
+	//! StelModuleMgr::startInit() runs it in a worker thread, so it must not create QObjects owned by the
+	//! main thread, textures or GUI elements, nor read the QSettings of other threads. init() is called after it.
+	//! The default implementation does nothing, everything is done in init().
+	virtual void loadData() {;}
+
+	//! Return the QObject names of the modules which must be initialized before loadData() can run.
+	virtual QStringList getInitDependencies() const {return QStringList();}
+
+	//! Load the data which the module can work without, e.g. the faint levels of a catalog.
+	//! With progressive initialization (see StelModuleMgr::setFlagProgressiveInit()) it runs in a worker thread
+	//! after init(), while the module is already drawn, otherwise it is called right after init().
+	//! The same restrictions as for loadData() apply, and the data must not be visible to the module before
+	//! finishDeferredData() is called.
+	virtual void loadDeferredData() {;}
+
+	//! Publish the data loaded by loadDeferredData(). Called in the main thread.
+	virtual void finishDeferredData() {;}
+
 	//! Called before the module will be delete, and before the openGL context is suppressed.
 	//! Deinitialize all openGL texture in this method.
 	virtual void deinit() {;}
@@ -75,6 +95,14 @@ public:
 	//! @param deltaTime the time increment in second since last call.
 	virtual void update(double deltaTime) = 0;
 
+	//! Prepare data for the next frame while the current frame is drawn (see StelApp::setFlagPipelinedUpdate()).
+	//! This is called from a worker thread after the update() of all modules, concurrently with their draw().
+	//! All data written by update() is frame-immutable until the end of the frame: it may be read here, but this
+	//! method must only write to data which no other method uses before the next update(), which can take it over.
+	//! StelApp waits for this method to return before the end of the frame.
+	//! @param nextJDE the JDE which the next update() will use, unless the time is changed in the meantime.
+	virtual void prepareNextFrame(double nextJDE) {Q_UNUSED(nextJDE);}
+
 	//! Get the version of the module, default is stellarium main version
 	virtual QString getModuleVersion() const;
 
@@ -136,6 +164,12 @@ public:
 	//! @return the value defining the order. The closer to 0 the earlier the module's action will be called
 	virtual double getCallOrder(StelModuleActionName actionName) const {Q_UNUSED(actionName); return 0;}
 
+	//! Return false if calling the action in this frame would have no effect, e.g. draw() while the module is
+	//! hidden and faded out, so that StelApp skips the call. This is called for ActionDraw and ActionUpdate
+	//! once per frame, just before the call, so it must be cheap.
+	//! @note a module which is not updated must still react to changes of its flags, e.g. to start fading in.
+	virtual bool isActive(StelModuleActionName actionName) const {Q_UNUSED(actionName); return true;}
+
 	//! Detect or show the configuration GUI elements for the module.  This is to be used with
 	//! plugins to display a configuration dialog from the plugin list window.
 	//! @param show if true, make the configuration GUI visible.  If false, hide the config GUI if there is one.
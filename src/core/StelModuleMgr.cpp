@@ -21,18 +21,23 @@
 #include <QPluginLoader>
 #include <QSettings>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QtConcurrent>
 
 #include "StelModuleMgr.hpp"
+#include "StelActionMgr.hpp"
 #include "StelApp.hpp"
 #include "StelModule.hpp"
 #include "StelFileMgr.hpp"
+#include "StelObjectModule.hpp"
 #include "StelPluginInterface.hpp"
 #include "StelPropertyMgr.hpp"
 #include "StelIniParser.hpp"
+#include "StelStartupTrace.hpp"
 
 
 
-StelModuleMgr::StelModuleMgr() : callingListsToRegenerate(true), pluginDescriptorListLoaded(false)
+StelModuleMgr::StelModuleMgr() : callingListsToRegenerate(true), pluginDescriptorListLoaded(false), flagProgressiveInit(false), currentModule(Q_NULLPTR)
 {
 	qRegisterMetaType<StelModule::StelModuleSelectAction>("StelModule::StelModuleSelectAction");
 	// Initialize empty call lists for each possible actions
@@ -45,6 +50,134 @@ StelModuleMgr::StelModuleMgr() : callingListsToRegenerate(true), pluginDescripto
 
 StelModuleMgr::~StelModuleMgr()
 {
+	// Don't delete modules while their data are still loading
+	for (auto& task : initTasks)
+	{
+		if (task.started)
+			task.future.waitForFinished();
+	}
+	for (auto* watcher : deferredTasks)
+		watcher->waitForFinished();
+}
+
+bool StelModuleMgr::dependenciesInitialized(const StelModule* m) const
+{
+	for (const auto& dep : m->getInitDependencies())
+	{
+		if (!initializedModules.contains(dep))
+			return false;
+	}
+	return true;
+}
+
+void StelModuleMgr::runLoadData(StelModule* m)
+{
+	InitTask& task = initTasks[m];
+	task.started = true;
+	task.future = QtConcurrent::run([m]() -> qint64 {
+		StelStartupTrace::Scope trace("module", m->objectName() + " loadData");
+		QElapsedTimer timer;
+		timer.start();
+		try
+		{
+			m->loadData();
+		}
+		catch (std::exception& e)
+		{
+			qWarning() << "ERROR while loading data of module" << m->objectName() << ":" << e.what();
+		}
+		return timer.elapsed();
+	});
+}
+
+void StelModuleMgr::startInit(StelModule* m)
+{
+	if (initTasks.contains(m) || initializedModules.contains(m->objectName()))
+		return;
+	if (dependenciesInitialized(m))
+		runLoadData(m);
+	else
+		initTasks.insert(m, InitTask());
+}
+
+void StelModuleMgr::initModule(StelModule* m)
+{
+	// Modules may initialize other modules
+	StelModule* previousModule = currentModule;
+	currentModule = m;
+	QElapsedTimer timer;
+	timer.start();
+	qint64 loadTime;
+	if (initTasks.contains(m) && initTasks[m].started)
+	{
+		StelStartupTrace::Scope trace("module", m->objectName() + " wait for loadData");
+		loadTime = initTasks[m].future.result();
+	}
+	else
+	{
+		if (!dependenciesInitialized(m))
+			qWarning() << "Module" << m->objectName() << "is initialized before its dependencies" << m->getInitDependencies();
+		StelStartupTrace::Scope trace("module", m->objectName() + " loadData");
+		m->loadData();
+		loadTime = timer.elapsed();
+	}
+	initTasks.remove(m);
+	const qint64 waitTime = timer.elapsed();
+	StelStartupTrace::Scope initStep("module", m->objectName() + " init");
+	m->init();
+	initStep.end();
+	currentModule = previousModule;
+	qDebug() << "Initialized" << m->objectName() << "in" << timer.elapsed() << "ms (init:" << timer.elapsed() - waitTime
+		 << "ms, data loading:" << loadTime << "ms)";
+	initializedModules.insert(m->objectName());
+
+	// Start the modules which were waiting for this one
+	for (auto it = initTasks.begin(); it != initTasks.end(); ++it)
+	{
+		if (!it->started && dependenciesInitialized(it.key()))
+			runLoadData(it.key());
+	}
+
+	if (flagProgressiveInit)
+	{
+		QFutureWatcher<void>* watcher = new QFutureWatcher<void>(this);
+		connect(watcher, &QFutureWatcher<void>::finished, this, [this, m]() {finishDeferredData(m);});
+		deferredTasks.insert(m, watcher);
+		watcher->setFuture(QtConcurrent::run([m]() {
+			StelStartupTrace::Scope trace("module", m->objectName() + " loadDeferredData");
+			try
+			{
+				m->loadDeferredData();
+			}
+			catch (std::exception& e)
+			{
+				qWarning() << "ERROR while loading deferred data of module" << m->objectName() << ":" << e.what();
+			}
+		}));
+	}
+	else
+	{
+		currentModule = m;
+		m->loadDeferredData();
+		m->finishDeferredData();
+		currentModule = previousModule;
+	}
+}
+
+void StelModuleMgr::finishDeferredData(StelModule* m)
+{
+	// Only publishes once, whether called by the watcher or by waitUntilReady()
+	QFutureWatcher<void>* watcher = deferredTasks.take(m);
+	if (watcher==Q_NULLPTR)
+		return;
+	watcher->waitForFinished();
+	watcher->deleteLater();
+	StelModule* previousModule = currentModule;
+	currentModule = m;
+	m->finishDeferredData();
+	currentModule = previousModule;
+	qDebug() << "Module" << m->objectName() << "is ready";
+	emit moduleReady(m->objectName());
 }
 
 // Regenerate calling lists if necessary
@@ -87,12 +220,26 @@ void StelModuleMgr::unloadModule(const QString& moduleID, bool alsoDelete)
 		qWarning() << "Module" << moduleID << "is not loaded.";
 		return;
 	}
+	waitUntilReady(m);
 	modules.remove(moduleID);
 	m->setParent(Q_NULLPTR);
 	callingListsToRegenerate = true;
+	// A plugin which was never used was not initialized
+	const bool initialized = !pendingPlugins.remove(moduleID);
+	for (auto it = placeholderActions.begin(); it != placeholderActions.end();)
+	{
+		if (it.value()==moduleID)
+		{
+			delete it.key();
+			it = placeholderActions.erase(it);
+		}
+		else
+			++it;
+	}
 	if (alsoDelete)
 	{
-		m->deinit();
+		if (initialized)
+			m->deinit();
 		delete m;
 	}
 }
@@ -122,6 +269,7 @@ StelModule* StelModuleMgr::loadPlugin(const QString& moduleID)
 		if (desc.info.id==moduleID)
 		{
 			Q_ASSERT(desc.pluginInterface);
+			StelStartupTrace::Scope trace("plugin", moduleID + " getStelModule");
 			StelModule* sMod = desc.pluginInterface->getStelModule();
 			qDebug() << "Loaded plugin" << moduleID;
 			pluginDescriptorList[moduleID].loaded=true;
@@ -192,6 +340,163 @@ void StelModuleMgr::setPluginLoadAtStartup(const QString& key, bool b)
 	}
 }
 
+void StelModuleMgr::setPluginLoadOnDemand(const QString& key, bool b)
+{
+	QSettings* conf = StelApp::getInstance().getSettings();
+	conf->setValue("plugins_load_on_demand/"+key, b);
+	if (pluginDescriptorList.contains(key))
+	{
+		pluginDescriptorList[key].loadOnDemand=b;
+	}
+}
+
+QString StelModuleMgr::getPluginActionsFilePath()
+{
+	return StelFileMgr::getCacheDir() + "/plugin_actions.ini";
+}
+
+bool StelModuleMgr::deferPluginInit(const QString& moduleID)
+{
+	if (!pluginDescriptorList.value(moduleID).loadOnDemand)
+		return false;
+
+	// The actions are only known once the plugin has been initialized in a previous session
+	QSettings actions(getPluginActionsFilePath(), QSettings::IniFormat);
+	if (!actions.childGroups().contains(moduleID))
+		return false;
+
+	StelActionMgr* actionMgr = StelApp::getInstance().getStelActionManager();
+	actions.beginGroup(moduleID);
+	const int size = actions.beginReadArray("actions");
+	for (int i=0; i<size; ++i)
+	{
+		actions.setArrayIndex(i);
+		StelAction* action = actionMgr->addAction(actions.value("id").toString(), actions.value("group").toString(),
+							  actions.value("text").toString(), this, "triggerPlaceholderAction()",
+							  actions.value("shortcut").toString(), actions.value("alt_shortcut").toString(),
+							  actions.value("global", false).toBool());
+		placeholderActions.insert(action, moduleID);
+	}
+	actions.endArray();
+	actions.endGroup();
+
+	pendingPlugins.insert(moduleID);
+	callingListsToRegenerate = true;
+	qDebug() << "Plugin" << moduleID << "will be initialized on first use";
+	return true;
+}
+
+void StelModuleMgr::initPlugin(const QString& moduleID)
+{
+	StelModule* m = getModule(moduleID);
+	if (!m)
+		return;
+
+	StelActionMgr* actionMgr = StelApp::getInstance().getStelActionManager();
+	const QList<StelAction*> actionsBefore = actionMgr->getActionList();
+	initModule(m);
+
+	// Record the new actions, for deferPluginInit() in the next sessions
+	QList<StelAction*> newActions;
+	for (auto* action : actionMgr->getActionList())
+	{
+		if (!actionsBefore.contains(action))
+			newActions.append(action);
+	}
+	QSettings actions(getPluginActionsFilePath(), QSettings::IniFormat);
+	actions.beginGroup(moduleID);
+	bool changed = actions.beginReadArray("actions")!=newActions.size();
+	for (int i=0; i<newActions.size() && !changed; ++i)
+	{
+		actions.setArrayIndex(i);
+		changed = actions.value("id").toString()!=newActions.at(i)->getId()
+			  || actions.value("shortcut").toString()!=newActions.at(i)->getDefaultShortcut().toString()
+			  || actions.value("text").toString()!=newActions.at(i)->getUntranslatedText();
+	}
+	actions.endArray();
+	if (changed)
+	{
+		actions.remove("");
+		actions.beginWriteArray("actions", newActions.size());
+		for (int i=0; i<newActions.size(); ++i)
+		{
+			const StelAction* action = newActions.at(i);
+			actions.setArrayIndex(i);
+			actions.setValue("id", action->getId());
+			actions.setValue("group", action->getGroup());
+			actions.setValue("text", action->getUntranslatedText());
+			actions.setValue("shortcut", action->getDefaultShortcut().toString());
+			actions.setValue("alt_shortcut", action->getDefaultAltShortcut().toString());
+			actions.setValue("global", action->isGlobal());
+		}
+		actions.endArray();
+	}
+	actions.endGroup();
+}
+
+bool StelModuleMgr::activatePlugin(const QString& moduleID)
+{
+	if (!pendingPlugins.remove(moduleID))
+		return false;
+
+	// The plugin creates the real actions in its init()
+	for (auto it = placeholderActions.begin(); it != placeholderActions.end();)
+	{
+		if (it.value()==moduleID)
+		{
+			it.key()->setParent(Q_NULLPTR);
+			it.key()->deleteLater();
+			it = placeholderActions.erase(it);
+		}
+		else
+			++it;
+	}
+
+	qDebug() << "Initializing plugin" << moduleID << "on first use";
+	initPlugin(moduleID);
+	// Not now, the calling lists may be in use
+	callingListsToRegenerate = true;
+	return true;
+}
+
+bool StelModuleMgr::activatePluginOfAction(StelAction* action)
+{
+	const QString moduleID = placeholderActions.value(action);
+	return !moduleID.isEmpty() && activatePlugin(moduleID);
+}
+
+void StelModuleMgr::triggerPlaceholderAction()
+{
+	StelAction* placeholder = qobject_cast<StelAction*>(sender());
+	if (!placeholder)
+		return;
+	const QString actionId = placeholder->getId();
+	// Trigger the real action
+	StelAction* action = StelApp::getInstance().getStelActionManager()->findAction(actionId);
+	if (action && action!=placeholder)
+		action->trigger();
+}
+
+bool StelModuleMgr::activateObjectPlugins()
+{
+	bool activated = false;
+	for (const auto& moduleID : pendingPlugins.toList())
+	{
+		if (qobject_cast<StelObjectModule*>(getModule(moduleID, true)))
+			activated = activatePlugin(moduleID) || activated;
+	}
+	return activated;
+}
+
+void StelModuleMgr::activatePluginsUsedBy(const QString& text)
+{
+	for (const auto& moduleID : pendingPlugins.toList())
+	{
+		if (text.contains(moduleID))
+			activatePlugin(moduleID);
+	}
+}
+
 /*************************************************************************
  Generate properly sorted calling lists for each action (e,g, draw, update)
  according to modules orders dependencies
@@ -206,10 +511,101 @@ void StelModuleMgr::generateCallingLists()
 		// and init them with modules in creation order
 		for (auto* m : getAllModules())
 		{
-			mc.value().push_back(m);
+			// The plugins waiting for their first use are not initialized
+			if (!pendingPlugins.contains(m->objectName()))
+				mc.value().push_back(m);
 		}
 		qSort(mc.value().begin(), mc.value().end(), StelModuleOrderComparator(mc.key()));
 	}
+
+	// The tables used every frame by callActiveModules()
+	for (auto action : {StelModule::ActionDraw, StelModule::ActionUpdate})
+	{
+		QVector<DispatchEntry>& table = dispatchTables[action];
+		table.clear();
+		for (auto* m : callOrders.value(action))
+		{
+			DispatchEntry entry;
+			entry.module = m;
+			entry.timing = getTiming(m->objectName(), action);
+			table.append(entry);
+		}
+	}
+}
+
+QSharedPointer<StelModuleMgr::ModuleTiming> StelModuleMgr::getTiming(const QString& moduleID, StelModule::StelModuleActionName action)
+{
+	QSharedPointer<ModuleTiming>& timing = timings[qMakePair(moduleID, static_cast<int>(action))];
+	if (!timing)
+		timing = QSharedPointer<ModuleTiming>::create();
+	return timing;
+}
+
+void StelModuleMgr::addCallTime(const DispatchEntry& entry, StelModule::StelModuleActionName action, qint64 nsecs)
+{
+	ModuleTiming& timing = *entry.timing;
+	timing.time += (nsecs/1.e6 - timing.time) * 0.05;
+	if (timing.budget<=0.)
+		return;
+	if (!timing.overBudget && timing.time>timing.budget)
+	{
+		timing.overBudget = true;
+		qWarning() << "Module" << entry.module->objectName() << (action==StelModule::ActionDraw ? "draw" : "update")
+			   << "takes" << timing.time << "ms, over its budget of" << timing.budget << "ms";
+		emit moduleOverBudget(entry.module->objectName(), action, timing.time);
+	}
+	else if (timing.overBudget && timing.time<timing.budget*0.9)
+		timing.overBudget = false;
+}
+
+void StelModuleMgr::beginProfiledCall(StelModule::StelModuleActionName action)
+{
+	StelFrameProfiler* profiler = StelApp::getInstance().getFrameProfiler();
+	if (profiler)
+		profiler->beginCall(action==StelModule::ActionDraw);
+}
+
+void StelModuleMgr::endProfiledCall(const DispatchEntry& entry, StelModule::StelModuleActionName action)
+{
+	StelFrameProfiler* profiler = StelApp::getInstance().getFrameProfiler();
+	if (profiler)
+		profiler->endCall(entry.module->objectName(), action==StelModule::ActionDraw);
+}
+
+void StelModuleMgr::setModuleTimeBudget(const QString& moduleID, StelModule::StelModuleActionName action, double ms)
+{
+	QSharedPointer<ModuleTiming> timing = getTiming(moduleID, action);
+	timing->budget = ms;
+	timing->overBudget = false;
+}
+
+double StelModuleMgr::getModuleTimeBudget(const QString& moduleID, StelModule::StelModuleActionName action) const
+{
+	const QSharedPointer<ModuleTiming> timing = timings.value(qMakePair(moduleID, static_cast<int>(action)));
+	return timing ? timing->budget : 0.;
+}
+
+double StelModuleMgr::getModuleTime(const QString& moduleID, StelModule::StelModuleActionName action) const
+{
+	const QSharedPointer<ModuleTiming> timing = timings.value(qMakePair(moduleID, static_cast<int>(action)));
+	return timing ? timing->time : 0.;
+}
+
+void StelModuleMgr::loadTimeBudgets(QSettings* conf)
+{
+	conf->beginGroup("module_time_budgets");
+	for (const auto& key : conf->childKeys())
+	{
+		const QString moduleID = key.section('.', 0, -2);
+		const QString actionName = key.section('.', -1);
+		bool ok;
+		const double ms = conf->value(key).toDouble(&ok);
+		if (ok && !moduleID.isEmpty() && (actionName=="draw" || actionName=="update"))
+			setModuleTimeBudget(moduleID, actionName=="draw" ? StelModule::ActionDraw : StelModule::ActionUpdate, ms);
+		else
+			qWarning() << "Invalid module time budget" << key << ":" << conf->value(key).toString();
+	}
+	conf->endGroup();
 }
 
 /*************************************************************************
@@ -256,6 +652,7 @@ QList<StelModuleMgr::PluginDescriptor> StelModuleMgr::getPluginsList()
 		if (moduleFullPath.isEmpty())
 			continue;
 
+		StelStartupTrace::Scope trace("plugin", dir + " library");
 		QPluginLoader loader(moduleFullPath);
 		if (!loader.load())
 		{
@@ -294,6 +691,10 @@ QList<StelModuleMgr::PluginDescriptor> StelModuleMgr::getPluginsList()
 		conf->setValue(iter.key(), iter->loadAtStartup);
 	}
 	conf->endGroup();
+	conf->beginGroup("plugins_load_on_demand");
+	for (auto iter = pluginDescriptorList.begin(); iter != pluginDescriptorList.end(); ++iter)
+		iter->loadOnDemand = conf->value(iter.key(), false).toBool();
+	conf->endGroup();
 
 	pluginDescriptorListLoaded = true;
 	return pluginDescriptorList.values();
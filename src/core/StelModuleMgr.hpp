@@ -23,8 +23,19 @@
 #include <QObject>
 #include <QMap>
 #include <QList>
+#include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QSharedPointer>
+#include <QVector>
 #include "StelModule.hpp"
 #include "StelPluginInterface.hpp"
+#include "StelFrameProfiler.hpp"
+
+class StelAction;
+class QSettings;
 
 //! @def GETSTELMODULE(m)
 //! Return a pointer on a StelModule from its QMetaObject name @a m
@@ -48,6 +59,33 @@ public:
 	//! The module is later referenced by its QObject name.
 	void registerModule(StelModule* m, bool generateCallingLists=false);
 
+	//! Start loading the data of a module in a worker thread, see StelModule::loadData().
+	//! If some modules listed in StelModule::getInitDependencies() are not initialized yet, loading starts
+	//! as soon as initModule() has been called for all of them.
+	void startInit(StelModule* m);
+
+	//! Initialize a module in the main thread: wait for its data loaded by startInit(), or load it now if it was
+	//! not started, then call StelModule::init(). The time spent is logged.
+	//! The module still needs to be registered with registerModule().
+	void initModule(StelModule* m);
+
+	//! Set whether initModule() loads the deferred data of the modules in the background, so that the first
+	//! frame is drawn before all catalogs are loaded. See StelModule::loadDeferredData().
+	void setFlagProgressiveInit(bool b) {flagProgressiveInit=b;}
+	bool getFlagProgressiveInit() const {return flagProgressiveInit;}
+
+	//! Returns false while the deferred data of the module are still loaded in the background.
+	bool isModuleReady(StelModule* m) const {return !deferredTasks.contains(m);}
+	//! Returns true while the deferred data of some modules are loaded in the background.
+	bool isLoadingDeferredData() const {return !deferredTasks.isEmpty();}
+	//! Wait until the deferred data of the module are loaded and published, e.g. before searching an object.
+	//! Must be called in the main thread.
+	void waitUntilReady(StelModule* m) {if (deferredTasks.contains(m)) finishDeferredData(m);}
+
+	//! Get the module whose init, update or draw is running in the main thread, or Q_NULLPTR.
+	//! This is recorded as the owner of the GL resources created during the call, see StelTextureMgr::getResidency().
+	StelModule* getCurrentModule() const {return currentModule;}
+
 	//! Unregister and delete a StelModule. The program will hang if other modules depend on the removed one
 	//! @param moduleID the unique ID of the module, by convention equal to the class name
 	//! @param alsoDelete if true also delete the StelModule instance, otherwise it has to be deleted by external code.
@@ -61,6 +99,35 @@ public:
 
 	QObjectList loadExtensions(const QString& moduleID);
 
+	//! Defer the initialization of a plugin loaded by loadPlugin() until its first use, if it is loaded on demand.
+	//! Its actions are replaced by placeholders, with the IDs, texts and shortcuts recorded by initPlugin() in a
+	//! previous session, and the plugin is initialized by activatePlugin() when one of them is triggered or found
+	//! with StelActionMgr::findAction(), when an object is not found, or when a script uses it.
+	//! Until then, the plugin is registered, but not drawn or updated.
+	//! @return false if the plugin must be initialized now, with initPlugin()
+	bool deferPluginInit(const QString& moduleID);
+
+	//! Initialize a registered plugin like initModule(), and record its actions for deferPluginInit().
+	void initPlugin(const QString& moduleID);
+
+	//! Initialize a plugin whose initialization was deferred by deferPluginInit().
+	//! @return false if the plugin was not waiting for its initialization
+	bool activatePlugin(const QString& moduleID);
+
+	//! Initialize the plugin of a placeholder action created by deferPluginInit(). The action is deleted.
+	//! @return false if the action is not a placeholder
+	bool activatePluginOfAction(StelAction* action);
+
+	//! Initialize the deferred plugins which provide objects, e.g. when StelObjectMgr does not find an object.
+	//! @return true if some plugins were initialized
+	bool activateObjectPlugins();
+
+	//! Initialize the deferred plugins whose module name appears in the text, e.g. in the source of a script.
+	void activatePluginsUsedBy(const QString& text);
+
+	//! Returns true while the initialization of the plugin is deferred until its first use.
+	bool isPluginPending(const QString& moduleID) const {return pendingPlugins.contains(moduleID);}
+
 	//! Unload all plugins
 	void unloadAllPlugins();
 
@@ -69,6 +136,11 @@ public:
 	//! @param b the value to set.
 	void setPluginLoadAtStartup(const QString& key, bool b);
 
+	//! Define whether a plugin loaded at startup is initialized on first use, see deferPluginInit().
+	//! @param key the key of the plugin as in the PluginDescriptor class.
+	//! @param b the value to set.
+	void setPluginLoadOnDemand(const QString& key, bool b);
+
 	//! Get the corresponding module or Q_NULLPTR if can't find it.
 	//! @param moduleID the QObject name of the module instance, by convention it is equal to the class name.
 	//! @param noWarning if true, don't display any warning if the module is not found.
@@ -83,14 +155,58 @@ public:
 		return callOrders[action];
 	}
 
+	//! Call a function for the modules which are active in this frame (see StelModule::isActive()), in the
+	//! calling order of the action, and measure the time of each call for the time budgets and the
+	//! StelFrameProfiler. Only for ActionDraw and ActionUpdate.
+	//! @param call the function, which takes the StelModule* and calls the action
+	template <typename Func>
+	void callActiveModules(StelModule::StelModuleActionName action, Func call)
+	{
+		// A copy, modules may be registered during the calls
+		const QVector<DispatchEntry> table = dispatchTables.value(action);
+		const bool profiling = StelFrameProfiler::isEnabled();
+		QElapsedTimer timer;
+		for (const auto& entry : table)
+		{
+			if (!entry.module->isActive(action))
+				continue;
+			if (profiling)
+				beginProfiledCall(action);
+			timer.start();
+			currentModule = entry.module;
+			call(entry.module);
+			currentModule = Q_NULLPTR;
+			addCallTime(entry, action, timer.nsecsElapsed());
+			if (profiling)
+				endProfiledCall(entry, action);
+		}
+	}
+
+	//! Set the time budget of the draw or update action of a module. When the average time of the calls
+	//! exceeds it, a warning is logged and moduleOverBudget() is emitted, once until it is below again.
+	//! The time of a draw includes the submission of the draw calls to OpenGL, but not the GPU time.
+	//! @param moduleID the module, which may not be loaded yet
+	//! @param ms the budget in milliseconds, 0 for none
+	void setModuleTimeBudget(const QString& moduleID, StelModule::StelModuleActionName action, double ms);
+	double getModuleTimeBudget(const QString& moduleID, StelModule::StelModuleActionName action) const;
+	//! Get the average time of the draw or update calls of a module over about the last 20 frames in which it
+	//! was active, in milliseconds.
+	double getModuleTime(const QString& moduleID, StelModule::StelModuleActionName action) const;
+	//! Set the time budgets from the [module_time_budgets] section of the configuration, which has keys like
+	//! StarMgr.draw or SolarSystem.update and budgets in milliseconds as values.
+	void loadTimeBudgets(QSettings* conf);
+
 	//! Contains the information read from the module.ini file
 	struct PluginDescriptor
 	{
-		PluginDescriptor() : loadAtStartup(false), loaded(false), pluginInterface(Q_NULLPTR) {;}
+		PluginDescriptor() : loadAtStartup(false), loadOnDemand(false), loaded(false), pluginInterface(Q_NULLPTR) {;}
 		//! The static info for the plugin.
 		StelPluginInfo info;
 		//! If true, the module is automatically loaded at startup
 		bool loadAtStartup;
+		//! If true, the module loaded at startup is initialized on first use, see deferPluginInit().
+		//! The toolbar buttons and the other GUI elements created by the plugin appear once it is initialized.
+		bool loadOnDemand;
 		//! True if the plugin is currently loaded.
 		bool loaded;
 
@@ -110,11 +226,55 @@ signals:
 	//! Called whenever new plugin extensions are added
 	void extensionsAdded(QObjectList newExtensions);
 
+	//! Emitted when the deferred data of a module were published
+	void moduleReady(const QString& moduleID);
+
+	//! Emitted when the average time of an action of a module exceeds its budget, see setModuleTimeBudget().
+	void moduleOverBudget(const QString& moduleID, StelModule::StelModuleActionName action, double ms);
+
+private slots:
+	//! The slot of the placeholder actions
+	void triggerPlaceholderAction();
+
 private:
+	//! Get the path of the file where initPlugin() records the actions of the plugins
+	static QString getPluginActionsFilePath();
+
+	//! The plugins whose initialization is deferred until their first use
+	QSet<QString> pendingPlugins;
+	//! The placeholder actions of the pending plugins, with the plugin ID
+	QHash<StelAction*, QString> placeholderActions;
+
 	//! Generate properly sorted calling lists for each action (e,g, draw, update)
 	//! according to modules orders dependencies
 	void generateCallingLists();
 
+	//! Returns true if all the dependencies of the module are initialized
+	bool dependenciesInitialized(const StelModule* m) const;
+	//! Run loadData() of the module in a worker thread
+	void runLoadData(StelModule* m);
+
+	//! A module for which startInit() was called, but not yet initModule()
+	struct InitTask
+	{
+		InitTask() : started(false) {}
+		//! Time spent in loadData() in ms
+		QFuture<qint64> future;
+		//! false while waiting for dependencies
+		bool started;
+	};
+	QHash<StelModule*, InitTask> initTasks;
+	//! The QObject names of the modules initialized with initModule()
+	QSet<QString> initializedModules;
+
+	//! Wait for the deferred data of the module and publish them
+	void finishDeferredData(StelModule* m);
+	//! The modules whose deferred data are loading
+	QHash<StelModule*, QFutureWatcher<void>*> deferredTasks;
+	bool flagProgressiveInit;
+	//! See getCurrentModule()
+	StelModule* currentModule;
+
 	//! The main module list associating name:pointer
 	QMap<QString, StelModule*> modules;
 
@@ -124,6 +284,32 @@ private:
 	//! The list of all module in the correct order for each action
 	QMap<StelModule::StelModuleActionName, QList<StelModule*> > callOrders;
 
+	//! Time of the calls of an action of a module
+	struct ModuleTiming
+	{
+		ModuleTiming() : time(0.), budget(0.), overBudget(false) {}
+		//! Exponential moving average, in ms
+		double time;
+		//! In ms, 0 for none
+		double budget;
+		bool overBudget;
+	};
+	//! Get the timing of an action of a module, created on first use
+	QSharedPointer<ModuleTiming> getTiming(const QString& moduleID, StelModule::StelModuleActionName action);
+	//! By module and action
+	QHash<QPair<QString, int>, QSharedPointer<ModuleTiming> > timings;
+
+	struct DispatchEntry
+	{
+		StelModule* module;
+		QSharedPointer<ModuleTiming> timing;
+	};
+	void addCallTime(const DispatchEntry& entry, StelModule::StelModuleActionName action, qint64 nsecs);
+	void beginProfiledCall(StelModule::StelModuleActionName action);
+	void endProfiledCall(const DispatchEntry& entry, StelModule::StelModuleActionName action);
+	//! The modules of callOrders with their timing, for ActionDraw and ActionUpdate
+	QMap<StelModule::StelModuleActionName, QVector<DispatchEntry> > dispatchTables;
+
 	//! True if modules were removed, and therefore the calling list need to be regenerated
 	bool callingListsToRegenerate;
 
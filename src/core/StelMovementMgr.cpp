@@ -1516,6 +1516,18 @@ void StelMovementMgr::changeFov(double deltaFov)
 		setFov(currentFov + deltaFov);
 }
 
+Vec3d StelMovementMgr::getAimViewDirectionJ2000(void) const
+{
+	if (!flagAutoMove)
+		return viewDirectionJ2000;
+	Vec3d aim = move.aim;
+	aim.normalize();
+	// AltAz movements keep their aim in AltAz coordinates, see moveToAltAzi()
+	if (move.mountMode==MountAltAzimuthal)
+		aim = core->altAzToJ2000(aim, StelCore::RefractionOff);
+	return aim;
+}
+
 double StelMovementMgr::getAimFov(void) const
 {
 	return (flagAutoZoom ? zoomMove.aimFov : currentFov);
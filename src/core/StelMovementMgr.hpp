@@ -262,6 +262,13 @@ public slots:
 	//! If currently zooming, return the target FOV, otherwise return current FOV in degree.
 	double getAimFov(void) const;
 
+	//! Get whether an automatic movement or zoom is running, e.g. after moveToJ2000() or zoomTo().
+	bool isAutoMoving(void) const {return flagAutoMove || flagAutoZoom;}
+
+	//! If currently moving automatically, return the view direction at the end of the movement,
+	//! otherwise return the current view direction, in J2000 frame.
+	Vec3d getAimViewDirectionJ2000(void) const;
+
 	//! Viewing direction function : true move, false stop.
 	void turnRight(bool);
 	void turnLeft(bool);
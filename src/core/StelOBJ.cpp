@@ -24,17 +24,24 @@
 #include "StelUtils.hpp"
 
 #include <QBuffer>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
 #include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
-#include <QRegularExpression>
 #include <QTextStream>
+#include <QThreadPool>
+#include <QVarLengthArray>
+#include <QtConcurrent>
+
+#include <numeric>
 
 Q_LOGGING_CATEGORY(stelOBJ,"stel.OBJ")
 
 StelOBJ::StelOBJ()
-	: m_isLoaded(false)
+	: m_isLoaded(false),
+	  m_vertexOrder(VertexOrder::XYZ)
 {
 
 }
@@ -89,11 +96,16 @@ bool StelOBJ::load(const QString& filename, const VertexOrder vertexOrder)
 		buf.open(QIODevice::ReadOnly);
 
 		//perform actual load
-		return load(buf,fi.canonicalPath(),vertexOrder);
+		if(!load(buf,fi.canonicalPath(),vertexOrder))
+			return false;
 	}
-
 	//perform actual load
-	return load(file,fi.canonicalPath(),vertexOrder);
+	else if(!load(file,fi.canonicalPath(),vertexOrder))
+		return false;
+
+	//the .mtl files have been recorded while parsing
+	m_sourceFiles.prepend(fi.absoluteFilePath());
+	return true;
 }
 
 //macro to test out different ways of comparison and their performance
@@ -103,6 +115,137 @@ bool StelOBJ::load(const QString& filename, const VertexOrder vertexOrder)
 //used instead of append() to avoid memory copies
 #define INC_LIST(a) (a.resize(a.size()+1), a.last())
 
+//! A vertex of a face statement, with the 1-based indices of its position, texture coordinate and normal.
+//! Relative indices are resolved against the start of the chunk while parsing, and then against the start of the file when merging.
+struct StelOBJ::FaceVertex
+{
+	enum RelativeFlag { RelativePosition = 1, RelativeTexCoord = 2, RelativeNormal = 4 };
+
+	int position;
+	int texCoord;
+	int normal;
+	//combination of RelativeFlag
+	int relative;
+};
+
+//! A statement which can only be handled in file order, after all chunks have been parsed (usemtl, o, g etc.)
+struct StelOBJ::ParsedStatement
+{
+	//the number of faces of the chunk before this statement
+	int faceIndex;
+	//the line number in the chunk
+	int lineNr;
+	QString cmd;
+	QString line;
+};
+
+//! The result of parsing a range of complete lines of an .obj file with parseChunk()
+struct StelOBJ::ParsedChunk
+{
+	ParsedChunk()
+		: lineCount(0), lineOffset(0),
+		  posOffset(0), normalOffset(0), texOffset(0),
+		  errorLine(0), vertexWLine(0), textureWLine(0)
+	{
+	}
+
+	QStringRef text;
+	int lineCount;
+	//the number of lines, positions, normals and texture coordinates of all chunks before this one
+	int lineOffset;
+	int posOffset;
+	int normalOffset;
+	int texOffset;
+
+	V3Vec posList;
+	V3Vec normalList;
+	V2Vec texList;
+	QVector<FaceVertex> faceVertices;
+	//the number of vertices of each face
+	QVector<int> faceSizes;
+	QVector<ParsedStatement> statements;
+
+	//the line number in the chunk of the first critical error, or 0
+	int errorLine;
+	QString errorText;
+	//the line numbers in the chunk of the first unsupported w coordinate, or 0
+	int vertexWLine;
+	int textureWLine;
+};
+
+namespace
+{
+	//! Lines are only parsed in parallel for files with at least this many characters per chunk
+	const int OBJ_CHUNK_SIZE = 1 << 20;
+	//! Vertices and triangles are processed in parallel in blocks of this size
+	const int OBJ_BLOCK_SIZE = 1 << 16;
+
+	//! Calls f(begin, end) for consecutive blocks of [0, count), in parallel if there is more than one block
+	template<typename F>
+	void parallelBlocks(int count, const F& f)
+	{
+		if(count <= OBJ_BLOCK_SIZE)
+		{
+			f(0, count);
+			return;
+		}
+		QVector<QPair<int,int> > blocks;
+		for(int i=0; i<count; i+=OBJ_BLOCK_SIZE)
+			blocks.append(qMakePair(i, qMin(count, i+OBJ_BLOCK_SIZE)));
+		QtConcurrent::blockingMap(blocks, [&f](const QPair<int,int>& block)
+		{
+			f(block.first, block.second);
+		});
+	}
+
+	//! Splits a line on whitespace, skipping empty parts. Faster than QString::splitRef with a QRegularExpression.
+	inline void splitWhitespace(const QStringRef& line, QVector<QStringRef>& out)
+	{
+		out.resize(0);
+		const int size = line.size();
+		int i = 0;
+		while(i<size)
+		{
+			while(i<size && line.at(i).isSpace())
+				++i;
+			const int start = i;
+			while(i<size && !line.at(i).isSpace())
+				++i;
+			if(i>start)
+				out.append(line.mid(start, i-start));
+		}
+	}
+
+	inline void applyVertexOrder(Vec3f& target, const StelOBJ::VertexOrder vertexOrder)
+	{
+		switch(vertexOrder)
+		{
+			case StelOBJ::XYZ:
+				//no change
+				break;
+			case StelOBJ::XZY:
+				target.set(target[0],-target[2],target[1]);
+				break;
+			case StelOBJ::YXZ:
+				target.set(target[1],target[0],target[2]);
+				break;
+			case StelOBJ::YZX:
+				target.set(target[1],target[2],target[0]);
+				break;
+			case StelOBJ::ZXY:
+				target.set(target[2],target[0],target[1]);
+				break;
+			case StelOBJ::ZYX:
+				target.set(target[2],target[1],target[0]);
+				break;
+			default:
+				Q_ASSERT_X(0,"StelOBJ::load","invalid vertex order found");
+				qCWarning(stelOBJ) << "Vertex order"<<vertexOrder<<"not implemented, assuming XYZ";
+				break;
+		}
+	}
+}
+
 bool StelOBJ::parseBool(const ParseParams &params, bool &out, int paramsStart)
 {
 	if(params.size()-paramsStart<1)
@@ -280,9 +423,7 @@ int StelOBJ::getCurrentMaterialIndex(CurrentParserState &state)
 	return 0;
 }
 
-bool StelOBJ::parseFace(const ParseParams& params, const V3Vec& posList, const V3Vec& normList, const V2Vec& texList,
-			CurrentParserState& state,
-			VertexCache& vertCache)
+bool StelOBJ::parseFace(const ParseParams& params, ParsedChunk& chunk)
 {
 	//The face definition can have 4 different variants
 	//Mode 1: Only position:		f v1 v2 v3
@@ -292,8 +433,6 @@ bool StelOBJ::parseFace(const ParseParams& params, const V3Vec& posList, const V
 
 	// Zero is actually invalid in the face definition, so we use it for default values
 	int posIdx=0, texIdx=0, normIdx=0;
-	// Contains the vertex indices
-	QVarLengthArray<unsigned int,16> vIdx;
 
 	if(params.size()<4)
 	{
@@ -311,13 +450,14 @@ bool StelOBJ::parseFace(const ParseParams& params, const V3Vec& posList, const V
 	//a macro for checking number pasing
 	#define CHK_OK(a) do{ a; if(!ok) { qCCritical(stelOBJ)<<"Could not parse number in face statement"<<params; return false; } } while(0)
 	//negative indices indicate relative data, i.e. -1 would mean the last position/texture/normal that was parsed
-	//this macro fixes it up so that it always uses absolute numbers
+	//this macro makes them relative to the start of the chunk, the start of the chunk in the file is added when merging
 	//note: the indices start with 1, this is fixed up later
-	#define FIX_REL(a, list) if(a<0) {a += list.size()+1; }
+	#define FIX_REL(a, list, flag) if(a<0) {a += list.size()+1; fv.relative |= flag; }
 
 	//loop to parse each section seperately
 	for(int i =0; i<vtxAmount;++i)
 	{
+		FaceVertex fv = FaceVertex();
 		//split on slash
 		QVector<QStringRef> split = params.at(i+1).split('/');
 		switch(split.size())
@@ -325,33 +465,33 @@ bool StelOBJ::parseFace(const ParseParams& params, const V3Vec& posList, const V
 			case 1: //no slash, only position
 				CHK_MODE(1);
 				CHK_OK(posIdx = split.at(0).toInt(&ok));
-				FIX_REL(posIdx, posList);
+				FIX_REL(posIdx, chunk.posList, FaceVertex::RelativePosition);
 				break;
 			case 2: //single slash, vert/tex
 				CHK_MODE(2);
 				CHK_OK(posIdx = split.at(0).toInt(&ok));
-				FIX_REL(posIdx, posList);
+				FIX_REL(posIdx, chunk.posList, FaceVertex::RelativePosition);
 				CHK_OK(texIdx = split.at(1).toInt(&ok));
-				FIX_REL(texIdx, texList);
+				FIX_REL(texIdx, chunk.texList, FaceVertex::RelativeTexCoord);
 				break;
 			case 3: //2 slashes, either v/t/n or v//n
 				if(!split.at(1).isEmpty())
 				{
 					CHK_MODE(3);
 					CHK_OK(posIdx = split.at(0).toInt(&ok));
-					FIX_REL(posIdx, posList);
+					FIX_REL(posIdx, chunk.posList, FaceVertex::RelativePosition);
 					CHK_OK(texIdx = split.at(1).toInt(&ok));
-					FIX_REL(texIdx, texList);
+					FIX_REL(texIdx, chunk.texList, FaceVertex::RelativeTexCoord);
 					CHK_OK(normIdx = split.at(2).toInt(&ok));
-					FIX_REL(normIdx, normList);
+					FIX_REL(normIdx, chunk.normalList, FaceVertex::RelativeNormal);
 				}
 				else
 				{
 					CHK_MODE(4);
 					CHK_OK(posIdx = split.at(0).toInt(&ok));
-					FIX_REL(posIdx, posList);
+					FIX_REL(posIdx, chunk.posList, FaceVertex::RelativePosition);
 					CHK_OK(normIdx = split.at(2).toInt(&ok));
-					FIX_REL(normIdx, normList);
+					FIX_REL(normIdx, chunk.normalList, FaceVertex::RelativeNormal);
 				}
 				break;
 			default: //invalid line
@@ -359,22 +499,49 @@ bool StelOBJ::parseFace(const ParseParams& params, const V3Vec& posList, const V
 				return false;
 		}
 
+		fv.position = posIdx;
+		fv.texCoord = texIdx;
+		fv.normal = normIdx;
+		chunk.faceVertices.append(fv);
+	}
+
+	chunk.faceSizes.append(vtxAmount);
+	return true;
+}
+
+bool StelOBJ::addFace(const FaceVertex* vertices, int vtxAmount, const V3Vec& posList, const V3Vec& normList, const V2Vec& texList,
+		      CurrentParserState& state,
+		      VertexCache& vertCache)
+{
+	// Contains the vertex indices
+	QVarLengthArray<unsigned int,16> vIdx;
+
+	for(int i =0; i<vtxAmount;++i)
+	{
+		const FaceVertex& fv = vertices[i];
+		if(fv.position<0 || fv.position>posList.size() || fv.texCoord<0 || fv.texCoord>texList.size()
+		   || fv.normal<0 || fv.normal>normList.size())
+		{
+			qCCritical(stelOBJ)<<"Face statement references undefined vertex data:"<<fv.position<<fv.texCoord<<fv.normal;
+			return false;
+		}
+
 		//create a temporary Vertex by copying the info from the lists
 		//zero initialize!
 		Vertex v = Vertex();
-		if(posIdx)
+		if(fv.position)
 		{
-			const float* data = posList.at(posIdx-1).v;
+			const float* data = posList.at(fv.position-1).v;
 			std::copy(data, data+3, v.position);
 		}
-		if(texIdx)
+		if(fv.texCoord)
 		{
-			const float* data = texList.at(texIdx-1).v;
+			const float* data = texList.at(fv.texCoord-1).v;
 			std::copy(data, data+2, v.texCoord);
 		}
-		if(normIdx)
+		if(fv.normal)
 		{
-			const float* data = normList.at(normIdx-1).v;
+			const float* data = normList.at(fv.normal-1).v;
 			std::copy(data, data+3, v.normal);
 		}
 
@@ -702,241 +869,321 @@ void StelOBJ::addObject(const QString &name, CurrentParserState &state)
 	state.currentMaterialGroup = Q_NULLPTR;
 }
 
+void StelOBJ::parseChunk(ParsedChunk& chunk, const VertexOrder vertexOrder)
+{
+	ParseParams splits;
+	const QStringRef& text = chunk.text;
+	int pos = 0;
+
+	//read chunk line by line
+	while(pos<text.size())
+	{
+		int end = text.indexOf(QLatin1Char('\n'), pos);
+		if(end<0)
+			end = text.size();
+		++chunk.lineCount;
+		//ignore front/back whitespace
+		const QStringRef line = text.mid(pos, end-pos).trimmed();
+		pos = end+1;
+
+		//split line by whitespace
+		splitWhitespace(line, splits);
+		if(splits.isEmpty())
+			continue;
+
+		const QStringRef& cmd = splits.at(0);
+		bool ok = true;
+
+		if(CMD_CMP("f"))
+		{
+			ok = parseFace(splits, chunk);
+		}
+		else if(CMD_CMP("v"))
+		{
+			//we have to handle the vertex order
+			Vec3f& target = INC_LIST(chunk.posList);
+			ok = parseVec3(splits,target);
+			//check the optional w coord if we have a vec4, must be 1
+			if(splits.size()>4)
+			{
+				float w;
+				parseFloat(splits,w,4);
+				if((!qFuzzyCompare(w,1.0f)) && (!chunk.vertexWLine))
+					chunk.vertexWLine = chunk.lineCount;
+			}
+			applyVertexOrder(target, vertexOrder);
+		}
+		else if(CMD_CMP("vt"))
+		{
+			ok = parseVec2(splits,INC_LIST(chunk.texList));
+			//check the optional w coord if we have a vec3, must be 0
+			if(splits.size()>3)
+			{
+				float w;
+				parseFloat(splits,w,3);
+				if( (!qFuzzyIsNull(w)) && (!chunk.textureWLine))
+					chunk.textureWLine = chunk.lineCount;
+			}
+		}
+		else if(CMD_CMP("vn"))
+		{
+			//we have to handle the vertex order
+			Vec3f& target = INC_LIST(chunk.normalList);
+			ok = parseVec3(splits,target);
+			applyVertexOrder(target, vertexOrder);
+			//normalize is usually not needed so we skip it
+			//target.normalize();
+		}
+		else if(!cmd.startsWith('#'))
+		{
+			//all other statements depend on the state of the parser, and are handled when the chunks are merged
+			ParsedStatement& statement = INC_LIST(chunk.statements);
+			statement.faceIndex = chunk.faceSizes.size();
+			statement.lineNr = chunk.lineCount;
+			statement.cmd = cmd.toString();
+			statement.line = line.toString();
+		}
+
+		if(!ok)
+		{
+			chunk.errorLine = chunk.lineCount;
+			chunk.errorText = line.toString();
+			return;
+		}
+	}
+}
+
+bool StelOBJ::parseStatement(const ParsedStatement& statement, const QDir& baseDir, CurrentParserState& state, bool& smoothGroupWarned)
+{
+	const QString& cmd = statement.cmd;
+	const QString& line = statement.line;
+	bool ok = true;
+
+	if(CMD_CMP("usemtl"))
+	{
+		//use the rest of the string
+		QString mtl = getRestOfString(QStringLiteral("usemtl"),line);
+		ok = !mtl.isEmpty();
+		if(ok)
+		{
+			if(m_materialMap.contains(mtl))
+			{
+				//set material as active
+				state.currentMaterialIdx = m_materialMap.value(mtl);
+			}
+			else
+			{
+				ok = false;
+				qCCritical(stelOBJ)<<"Unknown material"<<mtl<<"has been referenced";
+			}
+		}
+		else
+			qCCritical(stelOBJ)<<"No material name given";
+	}
+	else if(CMD_CMP("mtllib"))
+	{
+		//use the rest of the string
+		QString fileName = getRestOfString(QStringLiteral("mtllib"),line);
+		ok = !fileName.isEmpty();
+		if(ok)
+		{
+			//load external material file
+			const QString mtlPath = baseDir.absoluteFilePath(fileName);
+			MaterialList newMaterials = Material::loadFromFile(mtlPath);
+			m_sourceFiles.append(mtlPath);
+			for (const auto& m : newMaterials)
+			{
+				m_materials.append(m);
+				//the map has the index of the material
+				//because pointers may change during parsing
+				//because of list resizeing
+				m_materialMap.insert(m.name,m_materials.size()-1);
+			}
+			qCDebug(stelOBJ)<<newMaterials.size()<<"materials loaded from MTL file"<<fileName;
+		}
+		else
+			qCCritical(stelOBJ)<<"No material file name given";
+	}
+	else if(CMD_CMP("o"))
+	{
+		//use the rest of the string
+		QString objName = getRestOfString(QStringLiteral("o"),line);
+		ok = !objName.isEmpty();
+		if(ok)
+		{
+			addObject(objName, state);
+		}
+		else
+			qCCritical(stelOBJ)<<"Object name is required";
+	}
+	else if(CMD_CMP("g"))
+	{
+		//use the rest of the string
+		QString objName = getRestOfString(QStringLiteral("g"),line);
+		ok = !objName.isEmpty();
+		if(ok)
+		{
+			addObject(objName, state);
+		}
+		else
+			qCCritical(stelOBJ)<<"Group name is required";
+	}
+	else if(CMD_CMP("s"))
+	{
+		if(!smoothGroupWarned)
+		{
+			qCWarning(stelOBJ)<<"Smoothing groups are not supported, consider re-exporting your model from blender";
+			smoothGroupWarned = true;
+		}
+	}
+	else
+	{
+		//unknown command, warn
+		qCWarning(stelOBJ)<<"Unknown OBJ statement:"<<line;
+	}
+
+	return ok;
+}
+
 bool StelOBJ::load(QIODevice& device, const QString &basePath, const VertexOrder vertexOrder)
 {
 	clear();
+	m_vertexOrder = vertexOrder;
 
 	QDir baseDir(basePath);
 
 	QElapsedTimer timer;
 	timer.start();
-	QTextStream stream(&device);
 
-	bool smoothGroupWarned = false;
-	bool vertexWWarned = false;
-	bool textureWWarned = false;
+	const QString text = QString::fromUtf8(device.readAll());
+	device.close();
+	qCDebug(stelOBJ)<<"Read OBJ data in"<<timer.restart()<<"ms";
+
+	//split the text into chunks of complete lines, which are parsed in parallel
+	const int chunkCount = qBound(1, text.size() / OBJ_CHUNK_SIZE, QThreadPool::globalInstance()->maxThreadCount());
+	QVector<ParsedChunk> chunks(chunkCount);
+	int chunkStart = 0;
+	for(int i=0; i<chunkCount; ++i)
+	{
+		int chunkEnd = text.size();
+		if(i<chunkCount-1)
+		{
+			const int from = qMax(chunkStart, static_cast<int>(static_cast<qint64>(text.size()) * (i+1) / chunkCount));
+			chunkEnd = text.indexOf(QLatin1Char('\n'), from);
+			chunkEnd = chunkEnd<0 ? text.size() : chunkEnd+1;
+		}
+		chunks[i].text = text.midRef(chunkStart, chunkEnd-chunkStart);
+		chunkStart = chunkEnd;
+	}
 
+	if(chunkCount>1)
+	{
+		QtConcurrent::blockingMap(chunks, [vertexOrder](ParsedChunk& chunk)
+		{
+			parseChunk(chunk, vertexOrder);
+		});
+	}
+	else
+		parseChunk(chunks[0], vertexOrder);
+
+	//merge the vertex data of all chunks
+	int lineCount = 0;
 	//contains the parsed vertex positions
 	V3Vec posList;
 	//contains the parsed normals
 	V3Vec normalList;
 	//contains the parsed texture coords
 	V2Vec texList;
-
-	VertexCache vertCache;
-	CurrentParserState state = CurrentParserState();
-	const QRegularExpression separator("\\s");
-	separator.optimize();
-
-	int lineNr=0;
-
-	//read file line by line
-	while(!stream.atEnd())
+	for(auto& chunk : chunks)
 	{
-		++lineNr;
-		//ignore front/back whitespace
-		QString line = stream.readLine().trimmed();
+		chunk.lineOffset = lineCount;
+		chunk.posOffset = posList.size();
+		chunk.normalOffset = normalList.size();
+		chunk.texOffset = texList.size();
+		lineCount += chunk.lineCount;
 
-		//split line by whitespace
-		QVector<QStringRef> splits = line.splitRef(separator,QString::SkipEmptyParts);
-		if(!splits.isEmpty())
+		if(chunk.errorLine)
 		{
-			const QStringRef& cmd = splits.at(0);
+			qCCritical(stelOBJ)<<"Critical error on OBJ line"<<chunk.lineOffset+chunk.errorLine<<", cannot load OBJ data: "<<chunk.errorText;
+			return false;
+		}
 
-			bool ok = true;
+		posList += chunk.posList;
+		normalList += chunk.normalList;
+		texList += chunk.texList;
+		chunk.posList.clear();
+		chunk.normalList.clear();
+		chunk.texList.clear();
+	}
+	for(const auto& chunk : chunks)
+	{
+		if(chunk.vertexWLine)
+		{
+			qCWarning(stelOBJ)<<"Vertex w coordinates different from 1.0 are not supported, changed to 1.0, starting on line"<<chunk.lineOffset+chunk.vertexWLine;
+			break;
+		}
+	}
+	for(const auto& chunk : chunks)
+	{
+		if(chunk.textureWLine)
+		{
+			qCWarning(stelOBJ)<<"Texture w coordinates are not supported, starting on line"<<chunk.lineOffset+chunk.textureWLine;
+			break;
+		}
+	}
+	qCDebug(stelOBJ)<<"Parsed"<<lineCount<<"lines in"<<chunkCount<<"chunks in"<<timer.restart()<<"ms";
 
-			if(CMD_CMP("f"))
-			{
-				ok = parseFace(splits,posList,normalList,texList,state,vertCache);
-			}
-			else if(CMD_CMP("v"))
-			{
-				//we have to handle the vertex order
-				Vec3f& target = INC_LIST(posList);
-				ok = parseVec3(splits,target);
-				//check the optional w coord if we have a vec4, must be 1
-				if(splits.size()>4)
-				{
-					float w;
-					parseFloat(splits,w,4);
-					if((!qFuzzyCompare(w,1.0f)) && (!vertexWWarned))
-					{
-						qWarning(stelOBJ)<<"Vertex w coordinates different from 1.0 are not supported, changed to 1.0, starting on line"<<lineNr;
-						vertexWWarned=true;
-					}
-				}
-				switch(vertexOrder)
-				{
-					case XYZ:
-						//no change
-						break;
-					case XZY:
-						target.set(target[0],-target[2],target[1]);
-						break;
-					case YXZ:
-						target.set(target[1],target[0],target[2]);
-						break;
-					case YZX:
-						target.set(target[1],target[2],target[0]);
-						break;
-					case ZXY:
-						target.set(target[2],target[0],target[1]);
-						break;
-					case ZYX:
-						target.set(target[2],target[1],target[0]);
-						break;
-					default:
-						Q_ASSERT_X(0,"StelOBJ::load","invalid vertex order found");
-						qCWarning(stelOBJ) << "Vertex order"<<vertexOrder<<"not implemented, assuming XYZ";
-						break;
-				}
-			}
-			else if(CMD_CMP("vt"))
-			{
-				ok = parseVec2(splits,INC_LIST(texList));
-				//check the optional w coord if we have a vec3, must be 0
-				if(splits.size()>3)
-				{
-					float w;
-					parseFloat(splits,w,3);
-					if( (!qFuzzyIsNull(w)) && (!textureWWarned))
-					{
-						qWarning(stelOBJ)<<"Texture w coordinates are not supported, starting on line"<<lineNr;
-						textureWWarned=true;
-					}
-				}
-			}
-			else if(CMD_CMP("vn"))
-			{
-				//we have to handle the vertex order
-				Vec3f& target = INC_LIST(normalList);
-				ok = parseVec3(splits,target);
-				switch(vertexOrder)
-				{
-					case XYZ:
-						//no change
-						break;
-					case XZY:
-						target.set(target[0],-target[2],target[1]);
-						break;
-					case YXZ:
-						target.set(target[1],target[0],target[2]);
-						break;
-					case YZX:
-						target.set(target[1],target[2],target[0]);
-						break;
-					case ZXY:
-						target.set(target[2],target[0],target[1]);
-						break;
-					case ZYX:
-						target.set(target[2],target[1],target[0]);
-						break;
-					default:
-						Q_ASSERT_X(0,"StelOBJ::load","invalid vertex order found");
-						qCWarning(stelOBJ) << "Vertex order"<<vertexOrder<<"not implemented, assuming XYZ";
-						break;
-				}
-				//normalize is usually not needed so we skip it
-				//target.normalize();
-			}
-			else if(CMD_CMP("usemtl"))
-			{
-				//use the rest of the string
-				QString mtl = getRestOfString(QStringLiteral("usemtl"),line);
-				ok = !mtl.isEmpty();
-				if(ok)
-				{
-					if(m_materialMap.contains(mtl))
-					{
-						//set material as active
-						state.currentMaterialIdx = m_materialMap.value(mtl);
-					}
-					else
-					{
-						ok = false;
-						qCCritical(stelOBJ)<<"Unknown material"<<mtl<<"has been referenced";
-					}
-				}
-				else
-					qCCritical(stelOBJ)<<"No material name given";
-			}
-			else if(CMD_CMP("mtllib"))
-			{
-				//use the rest of the string
-				QString fileName = getRestOfString(QStringLiteral("mtllib"),line);
-				ok = !fileName.isEmpty();
-				if(ok)
-				{
-					//load external material file
-					MaterialList newMaterials = Material::loadFromFile(baseDir.absoluteFilePath(fileName));
-					for (const auto& m : newMaterials)
-					{
-						m_materials.append(m);
-						//the map has the index of the material
-						//because pointers may change during parsing
-						//because of list resizeing
-						m_materialMap.insert(m.name,m_materials.size()-1);
-					}
-					qCDebug(stelOBJ)<<newMaterials.size()<<"materials loaded from MTL file"<<fileName;
-				}
-				else
-					qCCritical(stelOBJ)<<"No material file name given";
-			}
-			else if(CMD_CMP("o"))
-			{
-				//use the rest of the string
-				QString objName = getRestOfString(QStringLiteral("o"),line);
-				ok = !objName.isEmpty();
-				if(ok)
-				{
-					addObject(objName, state);
-				}
-				else
-					qCCritical(stelOBJ)<<"Object name is required";
-			}
-			else if(CMD_CMP("g"))
-			{
-				//use the rest of the string
-				QString objName = getRestOfString(QStringLiteral("g"),line);
-				ok = !objName.isEmpty();
-				if(ok)
-				{
-					addObject(objName, state);
-				}
-				else
-					qCCritical(stelOBJ)<<"Group name is required";
-			}
-			else if(CMD_CMP("s"))
+	//create the vertices, objects and material groups in file order
+	VertexCache vertCache;
+	CurrentParserState state = CurrentParserState();
+	bool smoothGroupWarned = false;
+	QVarLengthArray<FaceVertex,16> faceVertices;
+	for(const auto& chunk : chunks)
+	{
+		const int faceCount = chunk.faceSizes.size();
+		int face = 0, faceVertex = 0, statement = 0;
+		while(face<faceCount || statement<chunk.statements.size())
+		{
+			if(statement<chunk.statements.size() && chunk.statements.at(statement).faceIndex==face)
 			{
-				if(!smoothGroupWarned)
+				const ParsedStatement& stmt = chunk.statements.at(statement++);
+				if(!parseStatement(stmt, baseDir, state, smoothGroupWarned))
 				{
-					qCWarning(stelOBJ)<<"Smoothing groups are not supported, consider re-exporting your model from blender";
-					smoothGroupWarned = true;
+					qCCritical(stelOBJ)<<"Critical error on OBJ line"<<chunk.lineOffset+stmt.lineNr<<", cannot load OBJ data: "<<stmt.line;
+					return false;
 				}
+				continue;
 			}
-			else if(!cmd.startsWith('#'))
+
+			//resolve the relative indices of the face
+			const int vtxAmount = chunk.faceSizes.at(face++);
+			faceVertices.resize(vtxAmount);
+			for(int i=0; i<vtxAmount; ++i)
 			{
-				//unknown command, warn
-				qCWarning(stelOBJ)<<"Unknown OBJ statement:"<<line;
+				FaceVertex& fv = faceVertices[i];
+				fv = chunk.faceVertices.at(faceVertex++);
+				if(fv.relative & FaceVertex::RelativePosition)
+					fv.position += chunk.posOffset;
+				if(fv.relative & FaceVertex::RelativeTexCoord)
+					fv.texCoord += chunk.texOffset;
+				if(fv.relative & FaceVertex::RelativeNormal)
+					fv.normal += chunk.normalOffset;
 			}
-
-			if(!ok)
+			if(!addFace(faceVertices.constData(), vtxAmount, posList, normalList, texList, state, vertCache))
 			{
-				qCCritical(stelOBJ)<<"Critical error on OBJ line"<<lineNr<<", cannot load OBJ data: "<<line;
+				qCCritical(stelOBJ)<<"Critical error in face"<<face<<"of OBJ lines"<<chunk.lineOffset+1<<"to"<<chunk.lineOffset+chunk.lineCount<<", cannot load OBJ data";
 				return false;
 			}
 		}
 	}
 
-	device.close();
-
 	//finished loading, squeeze the arrays to save some memory
 	m_vertices.squeeze();
 	m_indices.squeeze();
 
 	Q_ASSERT(m_indices.size() % 3 == 0);
 
-	qCDebug(stelOBJ)<<"Loaded OBJ in"<<timer.elapsed()<<"ms";
+	qCDebug(stelOBJ)<<"Created OBJ data in"<<timer.elapsed()<<"ms";
 	qCDebug(stelOBJ, "Parsed %d positions, %d normals, %d texture coordinates, %d materials",
 		posList.size(), normalList.size(), texList.size(), m_materials.size());
 	qCDebug(stelOBJ, "Created %d vertices, %d faces, %d objects", m_vertices.size(), getFaceCount(), m_objects.size());
@@ -984,270 +1231,274 @@ void StelOBJ::Object::postprocess(const StelOBJ &obj, Vec3d &centroid)
 	this->centroid = centroid.toVec3f();
 }
 
-void StelOBJ::generateNormals()
+void StelOBJ::buildVertexTriangles(QVector<int>& vertexTriangleStart, QVector<int>& vertexTriangles) const
 {
-	//Code adapted from old OBJ loader (Andrei Borza)
+	const int totalVertices = m_vertices.size();
+	const int totalIndices = m_indices.size();
 
-	const unsigned int *pTriangle = Q_NULLPTR;
-	Vertex *pVertex0 = Q_NULLPTR;
-	Vertex *pVertex1 = Q_NULLPTR;
-	Vertex *pVertex2 = Q_NULLPTR;
-	float edge1[3] = {0.0f, 0.0f, 0.0f};
-	float edge2[3] = {0.0f, 0.0f, 0.0f};
-	float normal[3] = {0.0f, 0.0f, 0.0f};
-	float invlength = 0.0f;
-	int totalVertices = m_vertices.size();
-	int totalTriangles = m_indices.size() / 3;
-
-	// Initialize all the vertex normals.
+	//count the triangles of each vertex, then sort the triangles by vertex
+	vertexTriangleStart.fill(0, totalVertices+1);
+	for (int i=0; i<totalIndices; ++i)
+		++vertexTriangleStart[m_indices.at(i)+1];
 	for (int i=0; i<totalVertices; ++i)
-	{
-		pVertex0 = &m_vertices[i];
-		pVertex0->normal[0] = 0.0f;
-		pVertex0->normal[1] = 0.0f;
-		pVertex0->normal[2] = 0.0f;
-	}
+		vertexTriangleStart[i+1] += vertexTriangleStart[i];
 
-	// Calculate the vertex normals.
-	for (int i=0; i<totalTriangles; ++i)
-	{
-		pTriangle = &m_indices.at(i*3);
-
-		pVertex0 = &m_vertices[pTriangle[0]];
-		pVertex1 = &m_vertices[pTriangle[1]];
-		pVertex2 = &m_vertices[pTriangle[2]];
+	QVector<int> cursor(vertexTriangleStart);
+	vertexTriangles.resize(totalIndices);
+	for (int i=0; i<totalIndices; ++i)
+		vertexTriangles[cursor[m_indices.at(i)]++] = i/3;
+}
 
-		// Calculate triangle face normal.
-		edge1[0] = static_cast<float>(pVertex1->position[0] - pVertex0->position[0]);
-		edge1[1] = static_cast<float>(pVertex1->position[1] - pVertex0->position[1]);
-		edge1[2] = static_cast<float>(pVertex1->position[2] - pVertex0->position[2]);
+void StelOBJ::generateNormals(const QVector<int>& vertexTriangleStart, const QVector<int>& vertexTriangles)
+{
+	//Code adapted from old OBJ loader (Andrei Borza)
+	//The face normals are calculated first, and then accumulated for each vertex in the order of the triangles,
+	//so that both loops can run in parallel, with the same results as a sequential accumulation.
 
-		edge2[0] = static_cast<float>(pVertex2->position[0] - pVertex0->position[0]);
-		edge2[1] = static_cast<float>(pVertex2->position[1] - pVertex0->position[1]);
-		edge2[2] = static_cast<float>(pVertex2->position[2] - pVertex0->position[2]);
+	const int totalVertices = m_vertices.size();
+	const int totalTriangles = m_indices.size() / 3;
+	QVector<Vec3f> faceNormals(totalTriangles);
+	Vec3f* pFaceNormals = faceNormals.data();
+	Vertex* pVertices = m_vertices.data();
+	const unsigned int* pIndices = m_indices.constData();
 
-		normal[0] = (edge1[1]*edge2[2]) - (edge1[2]*edge2[1]);
-		normal[1] = (edge1[2]*edge2[0]) - (edge1[0]*edge2[2]);
-		normal[2] = (edge1[0]*edge2[1]) - (edge1[1]*edge2[0]);
+	// Calculate the triangle face normals.
+	parallelBlocks(totalTriangles, [&](int begin, int end)
+	{
+		float edge1[3] = {0.0f, 0.0f, 0.0f};
+		float edge2[3] = {0.0f, 0.0f, 0.0f};
+		for (int i=begin; i<end; ++i)
+		{
+			const unsigned int *pTriangle = &pIndices[i*3];
 
-		// Accumulate the normals.
+			const Vertex *pVertex0 = &pVertices[pTriangle[0]];
+			const Vertex *pVertex1 = &pVertices[pTriangle[1]];
+			const Vertex *pVertex2 = &pVertices[pTriangle[2]];
 
-		pVertex0->normal[0] += normal[0];
-		pVertex0->normal[1] += normal[1];
-		pVertex0->normal[2] += normal[2];
+			edge1[0] = static_cast<float>(pVertex1->position[0] - pVertex0->position[0]);
+			edge1[1] = static_cast<float>(pVertex1->position[1] - pVertex0->position[1]);
+			edge1[2] = static_cast<float>(pVertex1->position[2] - pVertex0->position[2]);
 
-		pVertex1->normal[0] += normal[0];
-		pVertex1->normal[1] += normal[1];
-		pVertex1->normal[2] += normal[2];
+			edge2[0] = static_cast<float>(pVertex2->position[0] - pVertex0->position[0]);
+			edge2[1] = static_cast<float>(pVertex2->position[1] - pVertex0->position[1]);
+			edge2[2] = static_cast<float>(pVertex2->position[2] - pVertex0->position[2]);
 
-		pVertex2->normal[0] += normal[0];
-		pVertex2->normal[1] += normal[1];
-		pVertex2->normal[2] += normal[2];
-	}
+			float *normal = pFaceNormals[i].v;
+			normal[0] = (edge1[1]*edge2[2]) - (edge1[2]*edge2[1]);
+			normal[1] = (edge1[2]*edge2[0]) - (edge1[0]*edge2[2]);
+			normal[2] = (edge1[0]*edge2[1]) - (edge1[1]*edge2[0]);
+		}
+	});
 
-	// Normalize the vertex normals.
-	for (int i=0; i<totalVertices; ++i)
+	// Accumulate and normalize the vertex normals.
+	parallelBlocks(totalVertices, [&](int begin, int end)
 	{
-		pVertex0 = &m_vertices[i];
+		for (int i=begin; i<end; ++i)
+		{
+			float normal[3] = {0.0f, 0.0f, 0.0f};
+			for (int t=vertexTriangleStart.at(i); t<vertexTriangleStart.at(i+1); ++t)
+			{
+				const float *faceNormal = pFaceNormals[vertexTriangles.at(t)].v;
+				normal[0] += faceNormal[0];
+				normal[1] += faceNormal[1];
+				normal[2] += faceNormal[2];
+			}
 
-		invlength = 1.0f / std::sqrt(pVertex0->normal[0]*pVertex0->normal[0] +
-				pVertex0->normal[1]*pVertex0->normal[1] +
-				pVertex0->normal[2]*pVertex0->normal[2]);
+			const float invlength = 1.0f / std::sqrt(normal[0]*normal[0] +
+					normal[1]*normal[1] +
+					normal[2]*normal[2]);
 
-		pVertex0->normal[0] *= invlength;
-		pVertex0->normal[1] *= invlength;
-		pVertex0->normal[2] *= invlength;
-	}
+			Vertex *pVertex0 = &pVertices[i];
+			pVertex0->normal[0] = normal[0] * invlength;
+			pVertex0->normal[1] = normal[1] * invlength;
+			pVertex0->normal[2] = normal[2] * invlength;
+		}
+	});
 }
 
-void StelOBJ::generateTangents()
+void StelOBJ::generateTangents(const QVector<int>& vertexTriangleStart, const QVector<int>& vertexTriangles)
 {
 	//Code adapted from old OBJ loader (Andrei Borza)
+	//Like in generateNormals(), the face tangents are calculated first, and then accumulated for each vertex.
 
-	const unsigned int *pTriangle = Q_NULLPTR;
-	Vertex *pVertex0 = Q_NULLPTR;
-	Vertex *pVertex1 = Q_NULLPTR;
-	Vertex *pVertex2 = Q_NULLPTR;
-	float edge1[3] = {0.0f, 0.0f, 0.0f};
-	float edge2[3] = {0.0f, 0.0f, 0.0f};
-	float texEdge1[2] = {0.0f, 0.0f};
-	float texEdge2[2] = {0.0f, 0.0f};
-	float tangent[3] = {0.0f, 0.0f, 0.0f};
-	float bitangent[3] = {0.0f, 0.0f, 0.0f};
-	float det = 0.0f;
-	float nDotT = 0.0f;
-	float bDotB = 0.0f;
-	float invlength = 0.0f;
 	const int totalVertices = m_vertices.size();
 	const int totalTriangles = m_indices.size() / 3;
-
-	// Initialize all the vertex tangents and bitangents.
-	for (int i=0; i<totalVertices; ++i)
-	{
-		pVertex0 = &m_vertices[i];
-
-		pVertex0->tangent[0] = 0.0f;
-		pVertex0->tangent[1] = 0.0f;
-		pVertex0->tangent[2] = 0.0f;
-		pVertex0->tangent[3] = 0.0f;
-
-		pVertex0->bitangent[0] = 0.0f;
-		pVertex0->bitangent[1] = 0.0f;
-		pVertex0->bitangent[2] = 0.0f;
-	}
-
-	// Calculate the vertex tangents and bitangents.
-	for (int i=0; i<totalTriangles; ++i)
+	QVector<Vec3f> faceTangents(totalTriangles);
+	QVector<Vec3f> faceBitangents(totalTriangles);
+	Vec3f* pFaceTangents = faceTangents.data();
+	Vec3f* pFaceBitangents = faceBitangents.data();
+	Vertex* pVertices = m_vertices.data();
+	const unsigned int* pIndices = m_indices.constData();
+
+	// Calculate the triangle face tangents and bitangents.
+	parallelBlocks(totalTriangles, [&](int begin, int end)
 	{
-		pTriangle = &m_indices.at(i*3);
+		float edge1[3] = {0.0f, 0.0f, 0.0f};
+		float edge2[3] = {0.0f, 0.0f, 0.0f};
+		float texEdge1[2] = {0.0f, 0.0f};
+		float texEdge2[2] = {0.0f, 0.0f};
+		float det = 0.0f;
+		for (int i=begin; i<end; ++i)
+		{
+			const unsigned int *pTriangle = &pIndices[i*3];
 
-		pVertex0 = &m_vertices[pTriangle[0]];
-		pVertex1 = &m_vertices[pTriangle[1]];
-		pVertex2 = &m_vertices[pTriangle[2]];
+			const Vertex *pVertex0 = &pVertices[pTriangle[0]];
+			const Vertex *pVertex1 = &pVertices[pTriangle[1]];
+			const Vertex *pVertex2 = &pVertices[pTriangle[2]];
 
-		// Calculate the triangle face tangent and bitangent.
+			float *tangent = pFaceTangents[i].v;
+			float *bitangent = pFaceBitangents[i].v;
 
-		edge1[0] = static_cast<float>(pVertex1->position[0] - pVertex0->position[0]);
-		edge1[1] = static_cast<float>(pVertex1->position[1] - pVertex0->position[1]);
-		edge1[2] = static_cast<float>(pVertex1->position[2] - pVertex0->position[2]);
+			edge1[0] = static_cast<float>(pVertex1->position[0] - pVertex0->position[0]);
+			edge1[1] = static_cast<float>(pVertex1->position[1] - pVertex0->position[1]);
+			edge1[2] = static_cast<float>(pVertex1->position[2] - pVertex0->position[2]);
 
-		edge2[0] = static_cast<float>(pVertex2->position[0] - pVertex0->position[0]);
-		edge2[1] = static_cast<float>(pVertex2->position[1] - pVertex0->position[1]);
-		edge2[2] = static_cast<float>(pVertex2->position[2] - pVertex0->position[2]);
+			edge2[0] = static_cast<float>(pVertex2->position[0] - pVertex0->position[0]);
+			edge2[1] = static_cast<float>(pVertex2->position[1] - pVertex0->position[1]);
+			edge2[2] = static_cast<float>(pVertex2->position[2] - pVertex0->position[2]);
 
-		texEdge1[0] = pVertex1->texCoord[0] - pVertex0->texCoord[0];
-		texEdge1[1] = pVertex1->texCoord[1] - pVertex0->texCoord[1];
+			texEdge1[0] = pVertex1->texCoord[0] - pVertex0->texCoord[0];
+			texEdge1[1] = pVertex1->texCoord[1] - pVertex0->texCoord[1];
 
-		texEdge2[0] = pVertex2->texCoord[0] - pVertex0->texCoord[0];
-		texEdge2[1] = pVertex2->texCoord[1] - pVertex0->texCoord[1];
+			texEdge2[0] = pVertex2->texCoord[0] - pVertex0->texCoord[0];
+			texEdge2[1] = pVertex2->texCoord[1] - pVertex0->texCoord[1];
 
-		det = texEdge1[0]*texEdge2[1] - texEdge2[0]*texEdge1[1];
+			det = texEdge1[0]*texEdge2[1] - texEdge2[0]*texEdge1[1];
 
-		if (fabs(det) < 1e-6f)
-		{
-			tangent[0] = 1.0f;
-			tangent[1] = 0.0f;
-			tangent[2] = 0.0f;
+			if (fabs(det) < 1e-6f)
+			{
+				tangent[0] = 1.0f;
+				tangent[1] = 0.0f;
+				tangent[2] = 0.0f;
 
-			bitangent[0] = 0.0f;
-			bitangent[1] = 1.0f;
-			bitangent[2] = 0.0f;
-		}
-		else
-		{
-			det = 1.0f / det;
+				bitangent[0] = 0.0f;
+				bitangent[1] = 1.0f;
+				bitangent[2] = 0.0f;
+			}
+			else
+			{
+				det = 1.0f / det;
 
-			tangent[0] = (texEdge2[1]*edge1[0] - texEdge1[1]*edge2[0])*det;
-			tangent[1] = (texEdge2[1]*edge1[1] - texEdge1[1]*edge2[1])*det;
-			tangent[2] = (texEdge2[1]*edge1[2] - texEdge1[1]*edge2[2])*det;
+				tangent[0] = (texEdge2[1]*edge1[0] - texEdge1[1]*edge2[0])*det;
+				tangent[1] = (texEdge2[1]*edge1[1] - texEdge1[1]*edge2[1])*det;
+				tangent[2] = (texEdge2[1]*edge1[2] - texEdge1[1]*edge2[2])*det;
 
-			bitangent[0] = (-texEdge2[0]*edge1[0] + texEdge1[0]*edge2[0])*det;
-			bitangent[1] = (-texEdge2[0]*edge1[1] + texEdge1[0]*edge2[1])*det;
-			bitangent[2] = (-texEdge2[0]*edge1[2] + texEdge1[0]*edge2[2])*det;
+				bitangent[0] = (-texEdge2[0]*edge1[0] + texEdge1[0]*edge2[0])*det;
+				bitangent[1] = (-texEdge2[0]*edge1[1] + texEdge1[0]*edge2[1])*det;
+				bitangent[2] = (-texEdge2[0]*edge1[2] + texEdge1[0]*edge2[2])*det;
+			}
 		}
+	});
 
-		// Accumulate the tangents and bitangents.
+	// Accumulate, orthogonalize and normalize the vertex tangents.
+	parallelBlocks(totalVertices, [&](int begin, int end)
+	{
+		float bitangent[3] = {0.0f, 0.0f, 0.0f};
+		float nDotT = 0.0f;
+		float bDotB = 0.0f;
+		float invlength = 0.0f;
+		for (int i=begin; i<end; ++i)
+		{
+			Vertex *pVertex0 = &pVertices[i];
 
-		pVertex0->tangent[0] += tangent[0];
-		pVertex0->tangent[1] += tangent[1];
-		pVertex0->tangent[2] += tangent[2];
-		pVertex0->bitangent[0] += bitangent[0];
-		pVertex0->bitangent[1] += bitangent[1];
-		pVertex0->bitangent[2] += bitangent[2];
+			pVertex0->tangent[0] = 0.0f;
+			pVertex0->tangent[1] = 0.0f;
+			pVertex0->tangent[2] = 0.0f;
+			pVertex0->tangent[3] = 0.0f;
 
-		pVertex1->tangent[0] += tangent[0];
-		pVertex1->tangent[1] += tangent[1];
-		pVertex1->tangent[2] += tangent[2];
-		pVertex1->bitangent[0] += bitangent[0];
-		pVertex1->bitangent[1] += bitangent[1];
-		pVertex1->bitangent[2] += bitangent[2];
+			pVertex0->bitangent[0] = 0.0f;
+			pVertex0->bitangent[1] = 0.0f;
+			pVertex0->bitangent[2] = 0.0f;
 
-		pVertex2->tangent[0] += tangent[0];
-		pVertex2->tangent[1] += tangent[1];
-		pVertex2->tangent[2] += tangent[2];
-		pVertex2->bitangent[0] += bitangent[0];
-		pVertex2->bitangent[1] += bitangent[1];
-		pVertex2->bitangent[2] += bitangent[2];
-	}
+			for (int t=vertexTriangleStart.at(i); t<vertexTriangleStart.at(i+1); ++t)
+			{
+				const float *faceTangent = pFaceTangents[vertexTriangles.at(t)].v;
+				const float *faceBitangent = pFaceBitangents[vertexTriangles.at(t)].v;
+				pVertex0->tangent[0] += faceTangent[0];
+				pVertex0->tangent[1] += faceTangent[1];
+				pVertex0->tangent[2] += faceTangent[2];
+				pVertex0->bitangent[0] += faceBitangent[0];
+				pVertex0->bitangent[1] += faceBitangent[1];
+				pVertex0->bitangent[2] += faceBitangent[2];
+			}
 
-	// Orthogonalize and normalize the vertex tangents.
-	for (int i=0; i<totalVertices; ++i)
-	{
-		pVertex0 = &m_vertices[i];
-
-		// Gram-Schmidt orthogonalize tangent with normal.
-
-		nDotT = pVertex0->normal[0]*pVertex0->tangent[0] +
-			pVertex0->normal[1]*pVertex0->tangent[1] +
-			pVertex0->normal[2]*pVertex0->tangent[2];
-
-		pVertex0->tangent[0] -= pVertex0->normal[0]*nDotT;
-		pVertex0->tangent[1] -= pVertex0->normal[1]*nDotT;
-		pVertex0->tangent[2] -= pVertex0->normal[2]*nDotT;
-
-		// Normalize the tangent.
-
-		invlength = 1.0f / sqrtf(pVertex0->tangent[0]*pVertex0->tangent[0] +
-				      pVertex0->tangent[1]*pVertex0->tangent[1] +
-				      pVertex0->tangent[2]*pVertex0->tangent[2]);
-
-		pVertex0->tangent[0] *= invlength;
-		pVertex0->tangent[1] *= invlength;
-		pVertex0->tangent[2] *= invlength;
-
-		// Calculate the handedness of the local tangent space.
-		// The bitangent vector is the cross product between the triangle face
-		// normal vector and the calculated tangent vector. The resulting
-		// bitangent vector should be the same as the bitangent vector
-		// calculated from the set of linear equations above. If they point in
-		// different directions then we need to invert the cross product
-		// calculated bitangent vector. We store this scalar multiplier in the
-		// tangent vector's 'w' component so that the correct bitangent vector
-		// can be generated in the normal mapping shader's vertex shader.
-		//
-		// Normal maps have a left handed coordinate system with the origin
-		// located at the top left of the normal map texture. The x coordinates
-		// run horizontally from left to right. The y coordinates run
-		// vertically from top to bottom. The z coordinates run out of the
-		// normal map texture towards the viewer. Our handedness calculations
-		// must take this fact into account as well so that the normal mapping
-		// shader's vertex shader will generate the correct bitangent vectors.
-		// Some normal map authoring tools such as Crazybump
-		// (http://www.crazybump.com/) includes options to allow you to control
-		// the orientation of the normal map normal's y-axis.
-
-		bitangent[0] = (pVertex0->normal[1]*pVertex0->tangent[2]) -
-			       (pVertex0->normal[2]*pVertex0->tangent[1]);
-		bitangent[1] = (pVertex0->normal[2]*pVertex0->tangent[0]) -
-			       (pVertex0->normal[0]*pVertex0->tangent[2]);
-		bitangent[2] = (pVertex0->normal[0]*pVertex0->tangent[1]) -
-			       (pVertex0->normal[1]*pVertex0->tangent[0]);
-
-		bDotB = bitangent[0]*pVertex0->bitangent[0] +
-			bitangent[1]*pVertex0->bitangent[1] +
-			bitangent[2]*pVertex0->bitangent[2];
-
-		pVertex0->tangent[3] = (bDotB < 0.0f) ? 1.0f : -1.0f;
-
-		pVertex0->bitangent[0] = bitangent[0];
-		pVertex0->bitangent[1] = bitangent[1];
-		pVertex0->bitangent[2] = bitangent[2];
-	}
+			// Gram-Schmidt orthogonalize tangent with normal.
+
+			nDotT = pVertex0->normal[0]*pVertex0->tangent[0] +
+				pVertex0->normal[1]*pVertex0->tangent[1] +
+				pVertex0->normal[2]*pVertex0->tangent[2];
+
+			pVertex0->tangent[0] -= pVertex0->normal[0]*nDotT;
+			pVertex0->tangent[1] -= pVertex0->normal[1]*nDotT;
+			pVertex0->tangent[2] -= pVertex0->normal[2]*nDotT;
+
+			// Normalize the tangent.
+
+			invlength = 1.0f / sqrtf(pVertex0->tangent[0]*pVertex0->tangent[0] +
+					      pVertex0->tangent[1]*pVertex0->tangent[1] +
+					      pVertex0->tangent[2]*pVertex0->tangent[2]);
+
+			pVertex0->tangent[0] *= invlength;
+			pVertex0->tangent[1] *= invlength;
+			pVertex0->tangent[2] *= invlength;
+
+			// Calculate the handedness of the local tangent space.
+			// The bitangent vector is the cross product between the triangle face
+			// normal vector and the calculated tangent vector. The resulting
+			// bitangent vector should be the same as the bitangent vector
+			// calculated from the set of linear equations above. If they point in
+			// different directions then we need to invert the cross product
+			// calculated bitangent vector. We store this scalar multiplier in the
+			// tangent vector's 'w' component so that the correct bitangent vector
+			// can be generated in the normal mapping shader's vertex shader.
+			//
+			// Normal maps have a left handed coordinate system with the origin
+			// located at the top left of the normal map texture. The x coordinates
+			// run horizontally from left to right. The y coordinates run
+			// vertically from top to bottom. The z coordinates run out of the
+			// normal map texture towards the viewer. Our handedness calculations
+			// must take this fact into account as well so that the normal mapping
+			// shader's vertex shader will generate the correct bitangent vectors.
+			// Some normal map authoring tools such as Crazybump
+			// (http://www.crazybump.com/) includes options to allow you to control
+			// the orientation of the normal map normal's y-axis.
+			bitangent[0] = (pVertex0->normal[1]*pVertex0->tangent[2]) -
+				       (pVertex0->normal[2]*pVertex0->tangent[1]);
+			bitangent[1] = (pVertex0->normal[2]*pVertex0->tangent[0]) -
+				       (pVertex0->normal[0]*pVertex0->tangent[2]);
+			bitangent[2] = (pVertex0->normal[0]*pVertex0->tangent[1]) -
+				       (pVertex0->normal[1]*pVertex0->tangent[0]);
+
+			bDotB = bitangent[0]*pVertex0->bitangent[0] +
+				bitangent[1]*pVertex0->bitangent[1] +
+				bitangent[2]*pVertex0->bitangent[2];
+
+			pVertex0->tangent[3] = (bDotB < 0.0f) ? 1.0f : -1.0f;
+
+			pVertex0->bitangent[0] = bitangent[0];
+			pVertex0->bitangent[1] = bitangent[1];
+			pVertex0->bitangent[2] = bitangent[2];
+		}
+	});
 }
 
 void StelOBJ::generateAABB()
 {
-	//calculate AABB and centroid for each object
+	//calculate AABB and centroid for each object, in parallel
+	QVector<Vec3d> centroids(m_objects.size(), Vec3d(0.));
+	Vec3d* pCentroids = centroids.data();
+	const Object* pObjects = m_objects.data();
+	QtConcurrent::blockingMap(m_objects, [&](Object& o)
+	{
+		o.postprocess(*this, pCentroids[&o - pObjects]);
+	});
+
 	Vec3d accCentroid(0.);
 	m_bbox.reset();
 	for(int i =0;i<m_objects.size();++i)
 	{
-		Vec3d centr(0.);
-		Object& o = m_objects[i];
-
-		o.postprocess(*this,centr);
-		m_bbox.expand(o.boundingbox);
-		accCentroid+=centr;
+		m_bbox.expand(m_objects.at(i).boundingbox);
+		accCentroid+=centroids.at(i);
 	}
 
 	m_centroid = (accCentroid / m_objects.size()).toVec3f();
@@ -1258,15 +1509,20 @@ void StelOBJ::performPostProcessing(bool genNormals)
 	QElapsedTimer timer;
 	timer.start();
 
+	//the triangles of each vertex, used to accumulate normals and tangents in parallel
+	QVector<int> vertexTriangleStart, vertexTriangles;
+	buildVertexTriangles(vertexTriangleStart, vertexTriangles);
+	qCDebug(stelOBJ)<<"Vertex triangles sorted in"<<timer.restart()<<"ms";
+
 	//if no normals have been read at all, generate them (we do not support smoothing groups at the time, so this is quite simple)
 	if(genNormals)
 	{
-		generateNormals();
+		generateNormals(vertexTriangleStart, vertexTriangles);
 		qCDebug(stelOBJ)<<"Normals calculated in"<<timer.restart()<<"ms";
 	}
 
 	//generate tangent data
-	generateTangents();
+	generateTangents(vertexTriangleStart, vertexTriangles);
 	qCDebug(stelOBJ())<<"Tangents calculated in"<<timer.restart()<<"ms";
 
 	generateAABB();
@@ -1309,6 +1565,10 @@ void StelOBJ::scale(double factor)
 		dat[2] *= factor;
 	}
 
+	//the levels of detail were clustered in model units
+	for(int i = 0;i<m_lodCellSizes.size();++i)
+		m_lodCellSizes[i] *= factor;
+
 	//AABBs must be recalculated
 	generateAABB();
 	qCDebug(stelOBJ)<<"Scaling done in"<<timer.elapsed()<<"ms";
@@ -1350,6 +1610,274 @@ void StelOBJ::transform(const QMatrix4x4 &mat, bool onlyPosition)
 	generateAABB();
 }
 
+void StelOBJ::sortByMaterial()
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	//the groups of each material, in file order
+	QVector<QVector<QPair<int,int> > > materialGroups(m_materials.size());
+	for(int i=0;i<m_objects.size();++i)
+	{
+		const MaterialGroupList& groups = m_objects.at(i).groups;
+		for(int j=0;j<groups.size();++j)
+		{
+			Q_ASSERT(groups.at(j).materialIndex>=0 && groups.at(j).materialIndex<m_materials.size());
+			materialGroups[groups.at(j).materialIndex].append(qMakePair(i,j));
+		}
+	}
+
+	//nothing to do if the faces are already sorted, e.g. for compiled files
+	bool sorted = true;
+	int expectedStart = 0;
+	for(int m=0;m<materialGroups.size() && sorted;++m)
+	{
+		for(const auto& entry : materialGroups.at(m))
+		{
+			const MaterialGroup& grp = m_objects.at(entry.first).groups.at(entry.second);
+			if(grp.startIndex != expectedStart)
+			{
+				sorted = false;
+				break;
+			}
+			expectedStart += grp.indexCount;
+		}
+	}
+	if(sorted)
+		return;
+
+	//the levels of detail are rebuilt for the new face order
+	const QVector<float> lodCellSizes = m_lodCellSizes;
+	clearLevelsOfDetail();
+
+	IndexList newIndices;
+	newIndices.reserve(m_indices.size());
+	QVector<MaterialGroupList> newGroups(m_objects.size());
+	for(int m=0;m<materialGroups.size();++m)
+	{
+		for(const auto& entry : materialGroups.at(m))
+		{
+			const MaterialGroup& grp = m_objects.at(entry.first).groups.at(entry.second);
+			MaterialGroupList& objGroups = newGroups[entry.first];
+
+			//the groups of an object are visited after each other, so only the last one may be merged
+			if(objGroups.isEmpty() || objGroups.last().materialIndex != m)
+			{
+				MaterialGroup& newGrp = INC_LIST(objGroups);
+				newGrp = grp;
+				newGrp.startIndex = newIndices.size();
+			}
+			else
+			{
+				MaterialGroup& newGrp = objGroups.last();
+				const float w = static_cast<float>(grp.indexCount) / (newGrp.indexCount + grp.indexCount);
+				newGrp.centroid = newGrp.centroid * (1.0f - w) + grp.centroid * w;
+				newGrp.boundingbox.expand(grp.boundingbox);
+				newGrp.indexCount += grp.indexCount;
+			}
+
+			const int start = newIndices.size();
+			newIndices.resize(start + grp.indexCount);
+			std::copy(m_indices.constBegin() + grp.startIndex, m_indices.constBegin() + grp.startIndex + grp.indexCount,
+				  newIndices.begin() + start);
+		}
+	}
+
+	Q_ASSERT(newIndices.size() == m_indices.size());
+	m_indices = newIndices;
+	for(int i=0;i<m_objects.size();++i)
+		m_objects[i].groups = newGroups.at(i);
+
+	qCDebug(stelOBJ)<<"Sorted faces by material in"<<timer.elapsed()<<"ms";
+
+	if(!lodCellSizes.isEmpty())
+		buildLevelsOfDetail(lodCellSizes);
+}
+
+namespace
+{
+	//! Clusters the vertices of a range of faces in a grid with the given cell size,
+	//! and returns the faces connecting 3 different clusters, using the vertex nearest to the mean of each cluster.
+	StelOBJ::IndexList clusterFaces(const StelOBJ::VertexList& vertices, const StelOBJ::IndexList& indices,
+					int start, int count, float cellSize)
+	{
+		struct Cluster
+		{
+			Vec3d sum;
+			int count;
+			int vertex;
+			double distance;
+		};
+
+		QVector<Cluster> clusters;
+		QHash<quint64, int> cellMap;
+		QHash<unsigned int, int> vertexCluster;
+		vertexCluster.reserve(count);
+		for(int i=start;i<start+count;++i)
+		{
+			const unsigned int idx = indices.at(i);
+			if(vertexCluster.contains(idx))
+				continue;
+
+			//21 bits per axis, cells wrap around only 2 million cells apart
+			const GLfloat* pos = vertices.at(static_cast<int>(idx)).position;
+			quint64 key = 0;
+			for(int j=0;j<3;++j)
+				key = (key<<21) | (static_cast<quint64>(static_cast<qint64>(std::floor(pos[j] / cellSize))) & 0x1FFFFF);
+
+			QHash<quint64, int>::iterator it = cellMap.find(key);
+			if(it == cellMap.end())
+			{
+				it = cellMap.insert(key, clusters.size());
+				const Cluster c = { Vec3d(0.), 0, -1, 0. };
+				clusters.append(c);
+			}
+			Cluster& c = clusters[it.value()];
+			c.sum += Vec3d(static_cast<double>(pos[0]), static_cast<double>(pos[1]), static_cast<double>(pos[2]));
+			++c.count;
+			vertexCluster.insert(idx, it.value());
+		}
+
+		for(auto it = vertexCluster.constBegin(); it != vertexCluster.constEnd(); ++it)
+		{
+			Cluster& c = clusters[it.value()];
+			const GLfloat* pos = vertices.at(static_cast<int>(it.key())).position;
+			const Vec3d d = Vec3d(static_cast<double>(pos[0]), static_cast<double>(pos[1]), static_cast<double>(pos[2])) - c.sum / c.count;
+			const double dist = d.lengthSquared();
+			if(c.vertex < 0 || dist < c.distance)
+			{
+				c.vertex = static_cast<int>(it.key());
+				c.distance = dist;
+			}
+		}
+
+		StelOBJ::IndexList result;
+		for(int i=start;i<start+count;i+=3)
+		{
+			const int c0 = vertexCluster.value(indices.at(i));
+			const int c1 = vertexCluster.value(indices.at(i+1));
+			const int c2 = vertexCluster.value(indices.at(i+2));
+			if(c0 == c1 || c1 == c2 || c0 == c2)
+				continue;
+			result<<static_cast<unsigned int>(clusters.at(c0).vertex)
+			      <<static_cast<unsigned int>(clusters.at(c1).vertex)
+			      <<static_cast<unsigned int>(clusters.at(c2).vertex);
+		}
+		return result;
+	}
+}
+
+void StelOBJ::buildLevelsOfDetail(const QVector<float> &cellSizes)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	clearLevelsOfDetail();
+	sortByMaterial();
+
+	//the groups in the order of their faces
+	QVector<MaterialGroup*> groups;
+	for(int i=0;i<m_objects.size();++i)
+	{
+		MaterialGroupList& objGroups = m_objects[i].groups;
+		for(int j=0;j<objGroups.size();++j)
+			groups.append(&objGroups[j]);
+	}
+	std::sort(groups.begin(), groups.end(), [](const MaterialGroup* a, const MaterialGroup* b) { return a->startIndex < b->startIndex; });
+
+	QVector<int> groupIndices(groups.size());
+	std::iota(groupIndices.begin(), groupIndices.end(), 0);
+	const int detailFaces = static_cast<int>(getFaceCount());
+	for(int l=0;l<cellSizes.size();++l)
+	{
+		const float cellSize = cellSizes.at(l);
+		Q_ASSERT(cellSize > 0.0f);
+
+		//the groups are simplified in parallel, and appended in order afterwards
+		QVector<IndexList> simplified(groups.size());
+		QtConcurrent::blockingMap(groupIndices, [&](const int& i)
+		{
+			const MaterialGroup* grp = groups.at(i);
+			simplified[i] = clusterFaces(m_vertices, m_indices, grp->startIndex, grp->indexCount, cellSize);
+		});
+
+		const int levelStart = m_indices.size();
+		for(int i=0;i<groups.size();++i)
+		{
+			groups[i]->levelsOfDetail.append(IndexRange(m_indices.size(), simplified.at(i).size()));
+			m_indices += simplified.at(i);
+		}
+		qCDebug(stelOBJ).nospace()<<"Level of detail "<<l+1<<" (cell size "<<cellSize<<"): "
+					  <<(m_indices.size()-levelStart)/3<<" of "<<detailFaces<<" faces";
+	}
+	m_lodCellSizes = cellSizes;
+
+	qCDebug(stelOBJ)<<"Built"<<cellSizes.size()<<"levels of detail in"<<timer.elapsed()<<"ms";
+}
+
+void StelOBJ::replaceByLevelOfDetail(int level)
+{
+	Q_ASSERT(level>=0 && level<m_lodCellSizes.size());
+
+	//keep the faces in the order of the full-detail faces, so they remain sorted by material
+	QVector<MaterialGroup*> groups;
+	for(int i=0;i<m_objects.size();++i)
+	{
+		MaterialGroupList& objGroups = m_objects[i].groups;
+		for(int j=0;j<objGroups.size();++j)
+			groups.append(&objGroups[j]);
+	}
+	std::sort(groups.begin(), groups.end(), [](const MaterialGroup* a, const MaterialGroup* b) { return a->startIndex < b->startIndex; });
+
+	VertexList newVertices;
+	IndexList newIndices;
+	QVector<int> vertexMap(m_vertices.size(), -1);
+	for(MaterialGroup* grp : groups)
+	{
+		const IndexRange range = grp->levelsOfDetail.at(level);
+		grp->startIndex = newIndices.size();
+		grp->indexCount = range.indexCount;
+		grp->levelsOfDetail.clear();
+		for(int i=range.startIndex;i<range.startIndex+range.indexCount;++i)
+		{
+			const int idx = static_cast<int>(m_indices.at(i));
+			if(vertexMap.at(idx)<0)
+			{
+				vertexMap[idx] = newVertices.size();
+				newVertices.append(m_vertices.at(idx));
+			}
+			newIndices.append(static_cast<unsigned int>(vertexMap.at(idx)));
+		}
+	}
+
+	qCDebug(stelOBJ)<<"Keeping"<<newIndices.size()/3<<"faces of level of detail"<<level+1
+			<<"with"<<newVertices.size()<<"of"<<m_vertices.size()<<"vertices";
+	m_vertices = newVertices;
+	m_indices = newIndices;
+	m_lodCellSizes.clear();
+	generateAABB();
+}
+
+void StelOBJ::clearLevelsOfDetail()
+{
+	if(m_lodCellSizes.isEmpty())
+		return;
+
+	//the full-detail faces are sorted by material, and use the start of the index list
+	int detailCount = 0;
+	for(int i=0;i<m_objects.size();++i)
+	{
+		MaterialGroupList& groups = m_objects[i].groups;
+		for(int j=0;j<groups.size();++j)
+		{
+			detailCount += groups.at(j).indexCount;
+			groups[j].levelsOfDetail.clear();
+		}
+	}
+	m_indices.resize(detailCount);
+	m_lodCellSizes.clear();
+}
+
 void StelOBJ::splitVertexData(V3Vec *position,
 			      V2Vec *texCoord,
 			      V3Vec *normal,
@@ -1394,3 +1922,244 @@ void StelOBJ::clearVertexData()
 {
 	m_vertices.clear();
 }
+
+namespace
+{
+	const quint32 COMPILED_MAGIC = 0x534f424a; // "SOBJ"
+	const quint32 COMPILED_VERSION = 2;
+	//written in the byte order of the machine, to detect compiled files from other architectures
+	const quint32 COMPILED_BYTE_ORDER = 0x01020304;
+	//the raw vertex and index data start at a multiple of this offset
+	const qint64 COMPILED_ALIGNMENT = 16;
+
+	inline qint64 alignedOffset(qint64 pos)
+	{
+		return (pos + COMPILED_ALIGNMENT - 1) / COMPILED_ALIGNMENT * COMPILED_ALIGNMENT;
+	}
+
+	inline QDataStream& operator<<(QDataStream& out, const AABBox& box)
+	{
+		return out << box.min << box.max;
+	}
+
+	inline QDataStream& operator>>(QDataStream& in, AABBox& box)
+	{
+		return in >> box.min >> box.max;
+	}
+}
+
+bool StelOBJ::saveCompiled(const QString &filename) const
+{
+	if(!m_isLoaded || m_sourceFiles.isEmpty())
+	{
+		qCWarning(stelOBJ)<<"Only data loaded from an .obj file can be compiled";
+		return false;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	QFile file(filename + ".tmp");
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		qCWarning(stelOBJ)<<"Could not write compiled OBJ"<<filename<<file.errorString();
+		return false;
+	}
+
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_5_4);
+	out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+	out<<COMPILED_MAGIC<<COMPILED_VERSION;
+	//the raw data below is the memory of the machine
+	out.writeRawData(reinterpret_cast<const char*>(&COMPILED_BYTE_ORDER), sizeof(COMPILED_BYTE_ORDER));
+	out<<static_cast<quint32>(sizeof(Vertex))<<static_cast<qint32>(m_vertexOrder);
+
+	out<<static_cast<qint32>(m_sourceFiles.size());
+	for (const auto& src : m_sourceFiles)
+	{
+		const QFileInfo fi(src);
+		out<<src<<fi.size()<<fi.lastModified().toMSecsSinceEpoch();
+	}
+
+	out<<static_cast<qint32>(m_materials.size());
+	for (const auto& m : m_materials)
+	{
+		out<<m.name<<static_cast<qint32>(m.illum)<<m.Ka<<m.Kd<<m.Ks<<m.Ke<<m.Ns<<m.d
+		   <<m.map_Ka<<m.map_Kd<<m.map_Ks<<m.map_Ke<<m.map_bump<<m.map_height<<m.additionalParams;
+	}
+
+	out<<static_cast<qint32>(m_objects.size());
+	for (const auto& o : m_objects)
+	{
+		out<<o.isDefaultObject<<o.name<<o.centroid<<o.boundingbox;
+		out<<static_cast<qint32>(o.groups.size());
+		for (const auto& g : o.groups)
+		{
+			out<<static_cast<qint32>(g.startIndex)<<static_cast<qint32>(g.indexCount)
+			   <<static_cast<qint32>(g.objectIndex)<<static_cast<qint32>(g.materialIndex)
+			   <<g.centroid<<g.boundingbox;
+			out<<static_cast<qint32>(g.levelsOfDetail.size());
+			for (const auto& r : g.levelsOfDetail)
+				out<<static_cast<qint32>(r.startIndex)<<static_cast<qint32>(r.indexCount);
+		}
+	}
+
+	out<<m_lodCellSizes;
+	out<<m_bbox<<m_centroid;
+	out<<static_cast<qint32>(m_vertices.size())<<static_cast<qint32>(m_indices.size());
+
+	//pad, so that the vertex data can be used in place from a mapped file
+	static const char padding[COMPILED_ALIGNMENT] = {};
+	out.writeRawData(padding, static_cast<int>(alignedOffset(file.pos()) - file.pos()));
+	out.writeRawData(reinterpret_cast<const char*>(m_vertices.constData()), m_vertices.size() * static_cast<int>(sizeof(Vertex)));
+	out.writeRawData(reinterpret_cast<const char*>(m_indices.constData()), m_indices.size() * static_cast<int>(sizeof(unsigned int)));
+
+	bool ok = out.status()==QDataStream::Ok;
+	file.close();
+	if(ok)
+	{
+		QFile::remove(filename);
+		ok = file.rename(filename);
+	}
+	if(!ok)
+	{
+		qCWarning(stelOBJ)<<"Could not write compiled OBJ"<<filename;
+		file.remove();
+		return false;
+	}
+
+	qCDebug(stelOBJ)<<"Wrote compiled OBJ"<<filename<<"in"<<timer.elapsed()<<"ms";
+	return true;
+}
+
+bool StelOBJ::loadCompiled(const QString &filename, const QString &sourceFile, const VertexOrder vertexOrder)
+{
+	clear();
+
+	QElapsedTimer timer;
+	timer.start();
+
+	QFile file(filename);
+	if(!file.open(QIODevice::ReadOnly))
+		return false;
+
+	//map the file if possible, the data is accessed through a QByteArray in both cases
+	const qint64 fileSize = file.size();
+	QByteArray data;
+	const uchar* mapped = file.map(0, fileSize);
+	if(mapped)
+		data = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), static_cast<int>(fileSize));
+	else
+		data = file.readAll();
+
+	QDataStream in(data);
+	in.setVersion(QDataStream::Qt_5_4);
+	in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+	quint32 magic, version, byteOrder, vertexSize;
+	qint32 order;
+	in>>magic>>version;
+	if(in.status()!=QDataStream::Ok || magic!=COMPILED_MAGIC || version!=COMPILED_VERSION)
+	{
+		qCDebug(stelOBJ)<<"Unknown format of compiled OBJ"<<filename;
+		return false;
+	}
+	in.readRawData(reinterpret_cast<char*>(&byteOrder), sizeof(byteOrder));
+	in>>vertexSize>>order;
+	if(byteOrder!=COMPILED_BYTE_ORDER || vertexSize!=sizeof(Vertex) || order!=static_cast<qint32>(vertexOrder))
+	{
+		qCDebug(stelOBJ)<<"Compiled OBJ"<<filename<<"does not match this machine or vertex order";
+		return false;
+	}
+
+	//all source files must be unchanged
+	qint32 count;
+	in>>count;
+	if(in.status()!=QDataStream::Ok || count<1)
+		return false;
+	QStringList sources;
+	for(int i=0; i<count; ++i)
+	{
+		QString src;
+		qint64 size, mtime;
+		in>>src>>size>>mtime;
+		const QFileInfo fi(src);
+		if(in.status()!=QDataStream::Ok || (i==0 && src!=QFileInfo(sourceFile).absoluteFilePath())
+		   || !fi.exists() || fi.size()!=size || fi.lastModified().toMSecsSinceEpoch()!=mtime)
+		{
+			qCDebug(stelOBJ)<<"Compiled OBJ"<<filename<<"is outdated";
+			return false;
+		}
+		sources.append(src);
+	}
+
+	in>>count;
+	m_materials.reserve(qMax(0, count));
+	for(int i=0; i<count && in.status()==QDataStream::Ok; ++i)
+	{
+		Material m;
+		qint32 illum;
+		in>>m.name>>illum>>m.Ka>>m.Kd>>m.Ks>>m.Ke>>m.Ns>>m.d
+		  >>m.map_Ka>>m.map_Kd>>m.map_Ks>>m.map_Ke>>m.map_bump>>m.map_height>>m.additionalParams;
+		m.illum = static_cast<Material::Illum>(illum);
+		m_materials.append(m);
+		m_materialMap.insert(m.name, m_materials.size()-1);
+	}
+
+	in>>count;
+	m_objects.reserve(qMax(0, count));
+	for(int i=0; i<count && in.status()==QDataStream::Ok; ++i)
+	{
+		Object o;
+		qint32 groupCount;
+		in>>o.isDefaultObject>>o.name>>o.centroid>>o.boundingbox>>groupCount;
+		for(int j=0; j<groupCount && in.status()==QDataStream::Ok; ++j)
+		{
+			MaterialGroup g;
+			qint32 startIndex, indexCount, objectIndex, materialIndex;
+			in>>startIndex>>indexCount>>objectIndex>>materialIndex>>g.centroid>>g.boundingbox;
+			g.startIndex = startIndex;
+			g.indexCount = indexCount;
+			g.objectIndex = objectIndex;
+			g.materialIndex = materialIndex;
+			qint32 lodCount;
+			in>>lodCount;
+			for(int k=0; k<lodCount && in.status()==QDataStream::Ok; ++k)
+			{
+				in>>startIndex>>indexCount;
+				g.levelsOfDetail.append(IndexRange(startIndex, indexCount));
+			}
+			o.groups.append(g);
+		}
+		m_objects.append(o);
+		m_objectMap.insert(o.name, m_objects.size()-1);
+	}
+
+	qint32 vertexCount, indexCount;
+	in>>m_lodCellSizes>>m_bbox>>m_centroid>>vertexCount>>indexCount;
+
+	const qint64 vertexOffset = alignedOffset(in.device()->pos());
+	const qint64 vertexBytes = static_cast<qint64>(vertexCount) * static_cast<qint64>(sizeof(Vertex));
+	const qint64 indexBytes = static_cast<qint64>(indexCount) * static_cast<qint64>(sizeof(unsigned int));
+	if(in.status()!=QDataStream::Ok || vertexCount<0 || indexCount<0 || indexCount%3
+	   || vertexOffset + vertexBytes + indexBytes > data.size())
+	{
+		qCWarning(stelOBJ)<<"Compiled OBJ"<<filename<<"is corrupted";
+		clear();
+		return false;
+	}
+
+	m_vertices.resize(vertexCount);
+	memcpy(m_vertices.data(), data.constData() + vertexOffset, static_cast<size_t>(vertexBytes));
+	m_indices.resize(indexCount);
+	memcpy(m_indices.data(), data.constData() + vertexOffset + vertexBytes, static_cast<size_t>(indexBytes));
+
+	m_sourceFiles = sources;
+	m_vertexOrder = vertexOrder;
+	m_isLoaded = true;
+
+	qCDebug(stelOBJ)<<"Loaded compiled OBJ"<<filename<<"in"<<timer.elapsed()<<"ms";
+	qCDebug(stelOBJ, "%d vertices, %d faces, %d objects, %d materials", m_vertices.size(), getFaceCount(), m_objects.size(), m_materials.size());
+	return true;
+}
@@ -26,10 +26,13 @@
 #include <qopengl.h>
 #include <QLoggingCategory>
 #include <QString>
+#include <QStringList>
 #include <QIODevice>
 #include <QVector>
 #include <QHash>
 
+class QDir;
+
 Q_DECLARE_LOGGING_CATEGORY(stelOBJ)
 
 //! Representation of a custom subset of a [Wavefront .obj file](https://en.wikipedia.org/wiki/Wavefront_.obj_file),
@@ -137,6 +140,16 @@ public:
 	};
 
 
+	//! A range of the index list
+	struct IndexRange
+	{
+		IndexRange() : startIndex(0), indexCount(0) {}
+		IndexRange(int start, int count) : startIndex(start), indexCount(count) {}
+
+		int startIndex;
+		int indexCount;
+	};
+
 	//! Represents a bunch of faces following after each other
 	//! that use the same material
 	struct MaterialGroup{
@@ -166,6 +179,10 @@ public:
 		Vec3f centroid;
 		//! The AABB of this group at load time
 		AABBox boundingbox;
+
+		//! The simplified faces of this group for each level of detail, see buildLevelsOfDetail().
+		//! Empty if no levels of detail were built.
+		QVector<IndexRange> levelsOfDetail;
 	};
 
 	typedef QVector<MaterialGroup> MaterialGroupList;
@@ -255,6 +272,23 @@ public:
 	//! Returns true if this object contains valid data from a load() method
 	bool isLoaded() const { return m_isLoaded; }
 
+	//! Returns the files the data was parsed from: the .obj file first, followed by its
+	//! .mtl files. Empty if the data was loaded from a device.
+	inline const QStringList& getSourceFiles() const { return m_sourceFiles; }
+
+	//! Writes the loaded data to a compiled binary file, which can be read back much faster than
+	//! the .obj with loadCompiled(). The file contains the finished vertex data (including normals and tangents),
+	//! the index list, materials, objects with their material groups, bounding boxes and levels of detail, and the size and modification
+	//! time of all source files. The vertex data is stored in the byte order of the machine.
+	//! @return true if the file was written successfully
+	bool saveCompiled(const QString& filename) const;
+	//! Loads a file written by saveCompiled(). The file is memory-mapped if possible.
+	//! Fails if the file was not compiled from \p sourceFile with the same \p vertexOrder, if one of
+	//! the source files has changed since, or if it was written on a machine with a different vertex layout.
+	//! In this case, the caller should use load() and saveCompiled() again.
+	//! @return true if load was successful
+	bool loadCompiled(const QString& filename, const QString& sourceFile, const VertexOrder vertexOrder = VertexOrder::XYZ);
+
 	//! Rebuilds vertex normals as the average of face normals.
 	void rebuildNormals();
 
@@ -280,6 +314,33 @@ public:
 	//! @param onlyPosition If true, only the position information is transformed, the normals/tangents are skipped
 	void transform(const QMatrix4x4& mat, bool onlyPosition = false);
 
+	//! Reorders the index list so that all faces using the same material follow each other, in the order of
+	//! the material list. The material groups of each object are rebuilt to match, and groups of an object using
+	//! the same material are merged. Afterwards, the faces of each material are a single range of the index list,
+	//! which can be drawn with a single call. Does nothing if the faces are already sorted,
+	//! otherwise existing levels of detail are rebuilt.
+	void sortByMaterial();
+
+	//! Builds simplified versions of all material groups, to draw distant geometry with fewer faces.
+	//! For each level, the vertices of each group are clustered in a grid with the given cell size (in model units),
+	//! each cluster is replaced by its vertex nearest to the cluster mean, and collapsed faces are dropped.
+	//! The simplified faces only reference existing vertices, and are appended to the index list, with the faces of
+	//! all groups of a level in the order of their full-detail faces. The faces are sorted by material first,
+	//! so the simplified faces of each material in a level are again a single range of the index list.
+	//! Existing levels of detail are replaced.
+	//! @param cellSizes the cluster cell size of each level, from the finest to the coarsest
+	void buildLevelsOfDetail(const QVector<float>& cellSizes);
+	//! Removes the levels of detail built by buildLevelsOfDetail(), leaving only the full-detail faces in the index list
+	void clearLevelsOfDetail();
+	//! Replaces the full-detail faces by the faces of a level built by buildLevelsOfDetail(), and removes the vertices
+	//! no longer used, e.g. to keep only a reduced version of a model in memory. Afterwards, there are no levels of detail.
+	//! @param level the level, starting with 0 for the finest level of buildLevelsOfDetail()
+	void replaceByLevelOfDetail(int level);
+	//! Returns the number of levels of detail besides the full-detail faces
+	inline int getLevelOfDetailCount() const { return m_lodCellSizes.size(); }
+	//! Returns the cluster cell size of each level of detail, in model units
+	inline const QVector<float>& getLevelOfDetailCellSizes() const { return m_lodCellSizes; }
+
 	//! Splits the vertex data into separate arrays.
 	//! If a given parameter vector is null, it is not filled.
 	void splitVertexData(V3Vec* position,
@@ -307,11 +368,20 @@ private:
 		Object* currentObject;
 	};
 
+	struct FaceVertex;
+	struct ParsedStatement;
+	struct ParsedChunk;
+
 	bool m_isLoaded;
+	VertexOrder m_vertexOrder;
+	//the .obj file and its .mtl files, used to validate compiled files
+	QStringList m_sourceFiles;
 	//all vertex data is contained in this list
 	VertexList m_vertices;
 	//all index data is contained in this list
 	IndexList m_indices;
+	//the cell sizes of the levels of detail, whose faces follow the full-detail faces in the index list
+	QVector<float> m_lodCellSizes;
 	//all material data is contained in this list
 	MaterialList m_materials;
 	MaterialMap m_materialMap;
@@ -348,18 +418,30 @@ private:
 	//! Only requirement is that operator[] is defined.
 	template<typename T>
 	inline static bool parseVec2(const ParseParams& params, T& out, int paramsStart=1);
-	inline bool parseFace(const ParseParams& params, const V3Vec& posList, const V3Vec& normList, const V2Vec& texList,
-			      CurrentParserState &state, VertexCache& vertCache);
+	//! Parse the vertex indices of a face statement into the chunk
+	static bool parseFace(const ParseParams& params, ParsedChunk& chunk);
+	//! Parses the vertex data and faces of a chunk of the file. This does not depend on the parser state,
+	//! and can run in parallel for different chunks. Other statements are recorded for parseStatement().
+	static void parseChunk(ParsedChunk& chunk, const VertexOrder vertexOrder);
+	//! Handle a statement that changes the parser state (materials, objects etc.)
+	bool parseStatement(const ParsedStatement& statement, const QDir& baseDir, CurrentParserState& state, bool& smoothGroupWarned);
+	//! Add the vertices and triangles of a face, with indices resolved against the whole file
+	inline bool addFace(const FaceVertex* vertices, int vtxAmount, const V3Vec& posList, const V3Vec& normList, const V2Vec& texList,
+			    CurrentParserState &state, VertexCache& vertCache);
 
 	inline void addObject(const QString& name, CurrentParserState& state);
 
-	//! Regenerate all normals in the vertex list
-	void generateNormals();
+	//! Sorts the triangles by vertex: the triangles of vertex i are
+	//! vertexTriangles[vertexTriangleStart[i]] to vertexTriangles[vertexTriangleStart[i+1]-1], in ascending order
+	void buildVertexTriangles(QVector<int>& vertexTriangleStart, QVector<int>& vertexTriangles) const;
+
+	//! Regenerate all normals in the vertex list, in parallel
+	void generateNormals(const QVector<int>& vertexTriangleStart, const QVector<int>& vertexTriangles);
 
-	//! Calculates tangents and bitangents
-	void generateTangents();
+	//! Calculates tangents and bitangents, in parallel
+	void generateTangents(const QVector<int>& vertexTriangleStart, const QVector<int>& vertexTriangles);
 
-	//! Calculates AABBs of objects (and also centroids)
+	//! Calculates AABBs of objects (and also centroids), in parallel for the objects
 	void generateAABB();
 
 	//! Performs post-processing steps, like finding centroids and bounding boxes
@@ -25,9 +25,12 @@
 #include "StelUtils.hpp"
 #include "StelTranslator.hpp"
 #include "StelSkyDrawer.hpp"
+#include "StelLocaleMgr.hpp"
+#include "StelSkyCultureMgr.hpp"
 #include "RefractionExtinction.hpp"
 #include "StelLocation.hpp"
 #include "SolarSystem.hpp"
+#include "RiseSetSolver.hpp"
 #include "StelModuleMgr.hpp"
 #include "LandscapeMgr.hpp"
 #include "planetsephems/sidereal_time.h"
@@ -134,6 +137,9 @@ float StelObject::getVMagnitude(const StelCore* core) const
 
 Vec3f StelObject::getRTSTime(StelCore *core) const
 {
+	RiseSetSolver* solver = core->getRiseSetSolver();
+	if (solver && solver->canSolve(this))
+		return solver->getRTSTime(this, core->getJD());
 	return computeRTSTime(core);
 }
 
@@ -611,10 +617,13 @@ QString StelObject::getCommonInfoString(const StelCore *core, const InfoStringGr
 			sunrise = rts[0];
 		}
 
-		if (withTables)
-			res += QString("<tr><td>%1:</td><td style='text-align:right;'>%2</td></tr>").arg(sTransit, StelUtils::hoursToHmsStr(rts[1], true));
-		else
-			res += QString("%1: %2").arg(sTransit, StelUtils::hoursToHmsStr(rts[1], true)) + "<br />";
+		if (rts[1]>=0.f)
+		{
+			if (withTables)
+				res += QString("<tr><td>%1:</td><td style='text-align:right;'>%2</td></tr>").arg(sTransit, StelUtils::hoursToHmsStr(rts[1], true));
+			else
+				res += QString("%1: %2").arg(sTransit, StelUtils::hoursToHmsStr(rts[1], true)) + "<br />";
+		}
 
 		if (rts[2]>-99.f && rts[2]<100.f)
 		{
@@ -669,6 +678,24 @@ QString StelObject::getCommonInfoString(const StelCore *core, const InfoStringGr
 }
 
 // Apply post processing on the info string
+QString StelObject::getStaticInfoString(int section, const InfoStringGroup& flags, quint64 context, const std::function<QString()>& build) const
+{
+	StelApp& app = StelApp::getInstance();
+	const QString locale = app.getLocaleMgr().getAppLanguage() + '|' + app.getLocaleMgr().getSkyLanguage() + '|' + app.getSkyCultureMgr().getCurrentSkyCultureID();
+	if (section >= staticInfoStrings.size())
+		staticInfoStrings.resize(section+1);
+	StaticInfoString& cached = staticInfoStrings[section];
+	if (!cached.valid || cached.flags!=flags || cached.context!=context || cached.locale!=locale)
+	{
+		cached.text = build();
+		cached.flags = flags;
+		cached.context = context;
+		cached.locale = locale;
+		cached.valid = true;
+	}
+	return cached.text;
+}
+
 void StelObject::postProcessInfoString(QString& str, const InfoStringGroup& flags) const
 {
 	// hack for avoiding an empty line before table
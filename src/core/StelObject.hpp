@@ -26,6 +26,9 @@
 
 #include <QFlags>
 #include <QString>
+#include <QVector>
+
+#include <functional>
 
 class StelCore;
 
@@ -216,8 +219,9 @@ public:
 	bool isAboveRealHorizon(const StelCore* core) const;
 
 	//! Get today's time of rise, transit and set for celestial object for current location.
+	//! The times come from the RiseSetSolver of the core when it can handle the object.
 	//! @return Vec3f - time of rise, transit and set; decimal hours
-	//! @note The value -1.f is used as undefined value
+	//! @note See RiseSetSolver::getRTSTime() for the values used for undefined events
 	Vec3f getRTSTime(StelCore *core) const;
 
 	//! Return object's apparent V magnitude as seen from observer, without including extinction.
@@ -260,7 +264,29 @@ protected:
 
 	//! Apply post processing on the info string
 	void postProcessInfoString(QString& str, const InfoStringGroup& flags) const;
+
+	//! Get a part of the info string which does not change with time, e.g. names and catalog data.
+	//! It is built by build() the first time, then kept in the object until the flags, the languages,
+	//! the sky culture or the context change, so that refreshing the info panel of a selected object
+	//! formats only its time-dependent fields again.
+	//! @param section index of the part of the info string, counted from 0 in each class
+	//! @param flags the flags passed to getInfoString()
+	//! @param context the other settings the text depends on, combined in a single value
+	//! @param build builds the text
+	QString getStaticInfoString(int section, const InfoStringGroup& flags, quint64 context, const std::function<QString()>& build) const;
+
 private:
+	struct StaticInfoString
+	{
+		StaticInfoString() : valid(false), context(0) {}
+		bool valid;
+		InfoStringGroup flags;
+		quint64 context;
+		QString locale;
+		QString text;
+	};
+	mutable QVector<StaticInfoString> staticInfoStrings;
+
 	//! Compute time of rise, transit and set for celestial object for current location.
 	//! @return Vec3f - time of rise, transit and set; decimal hours
 	//! @note The value -1.f is used as undefined value
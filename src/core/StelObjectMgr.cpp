@@ -50,9 +50,24 @@ void StelObjectMgr::registerStelObjectMgr(StelObjectModule* m)
 {
 	objectsModule.push_back(m);
 	typeToModuleMap.insert(m->getStelObjectType(),m);
+	// The translated names change with the language.
+	connect(&StelApp::getInstance(), SIGNAL(languageChanged()), m, SLOT(invalidateNameIndex()));
 
 	objModulesMap.insert(m->objectName(), m->getName());
 
+	// The id of a module in object handles must not depend on the order of registration.
+	const QByteArray moduleName = m->objectName().toLatin1();
+	quint16 handleId = qChecksum(moduleName.constData(), static_cast<uint>(moduleName.size()));
+	if (handleId==0)
+		handleId = 1;
+	if (handleIdToModule.contains(handleId))
+		qWarning() << "Object handles of" << m->objectName() << "clash with" << handleIdToModule.value(handleId)->objectName() << "and are disabled";
+	else
+	{
+		handleIdToModule.insert(handleId, m);
+		moduleToHandleId.insert(m, handleId);
+	}
+
 	//TODO: there should probably be a better way to specify the sub-types
 	// instead of hardcoding them here
 
@@ -253,12 +268,18 @@ void StelObjectMgr::registerStelObjectMgr(StelObjectModule* m)
 StelObjectP StelObjectMgr::searchByNameI18n(const QString &name) const
 {
 	StelObjectP rval;
-	for (const auto* m : objectsModule)
+	StelModuleMgr& moduleMgr = StelApp::getInstance().getModuleMgr();
+	for (auto* m : objectsModule)
 	{
+		// Objects of a catalog which is still loading may be missing
+		moduleMgr.waitUntilReady(m);
 		rval = m->searchByNameI18n(name);
 		if (rval)
 			return rval;
 	}
+	// The plugins initialized on first use have no objects yet
+	if (moduleMgr.activateObjectPlugins())
+		return searchByNameI18n(name);
 	return rval;
 }
 
@@ -266,12 +287,16 @@ StelObjectP StelObjectMgr::searchByNameI18n(const QString &name) const
 StelObjectP StelObjectMgr::searchByName(const QString &name) const
 {
 	StelObjectP rval;
-	for (const auto* m : objectsModule)
+	StelModuleMgr& moduleMgr = StelApp::getInstance().getModuleMgr();
+	for (auto* m : objectsModule)
 	{
+		moduleMgr.waitUntilReady(m);
 		rval = m->searchByName(name);
 		if (rval)
 			return rval;
 	}
+	if (moduleMgr.activateObjectPlugins())
+		return searchByName(name);
 	return rval;
 }
 
@@ -280,12 +305,36 @@ StelObjectP StelObjectMgr::searchByID(const QString &type, const QString &id) co
 	auto it = typeToModuleMap.constFind(type);
 	if(it!=typeToModuleMap.constEnd())
 	{
+		StelApp::getInstance().getModuleMgr().waitUntilReady(*it);
 		return (*it)->searchByID(id);;
 	}
+	if (StelApp::getInstance().getModuleMgr().activateObjectPlugins())
+		return searchByID(type, id);
 	qWarning()<<"StelObject type"<<type<<"unknown";
 	return Q_NULLPTR;
 }
 
+quint64 StelObjectMgr::getObjectHandle(const StelObjectP& obj) const
+{
+	if (obj.isNull())
+		return 0;
+	const StelObjectModule* m = typeToModuleMap.value(obj->getType(), Q_NULLPTR);
+	if (m==Q_NULLPTR || !moduleToHandleId.contains(m))
+		return 0;
+	const quint64 index = m->getObjectIndex(obj.data());
+	if (index>=(Q_UINT64_C(1)<<48))
+		return 0;
+	return (static_cast<quint64>(moduleToHandleId.value(m)) << 48) | index;
+}
+
+StelObjectP StelObjectMgr::searchByHandle(quint64 handle) const
+{
+	const StelObjectModule* m = handleIdToModule.value(static_cast<quint16>(handle >> 48), Q_NULLPTR);
+	if (m==Q_NULLPTR)
+		return StelObjectP();
+	return m->searchByObjectIndex(handle & ((Q_UINT64_C(1)<<48)-1));
+}
+
 //! Find and select an object from its translated name
 //! @param nameI18n the case sensitive object translated name
 //! @return true if an object was found with the passed name
@@ -336,12 +385,36 @@ StelObjectP StelObjectMgr::cleverFind(const StelCore* core, const Vec3d& v) cons
 	// Field of view for a searchRadiusPixel pixel diameter circle on screen
 	float fov_around = core->getMovementMgr()->getCurrentFov()/qMin(prj->getViewportWidth(), prj->getViewportHeight()) * searchRadiusPixel;
 
-	// Collect the objects inside the range
-	for (const auto* m : objectsModule)
-		candidates += m->searchAround(v, fov_around, core);
-
 	// GZ 2014-08-17: This should be exactly the sky's limit magnitude (or even more, but not less!), else visible stars cannot be clicked.
 	float limitMag = core->getSkyDrawer()->getLimitMagnitude(); // -2.f;
+
+	Vec3d winpos;
+	prj->project(v, winpos);
+	float xpos = winpos[0];
+	float ypos = winpos[1];
+
+	// Collect the objects inside the range. The modules which filled the pick buffer for the current
+	// view are searched in it, without creating a StelObject for each candidate.
+	float best_object_value = 100000.f;
+	const StelObjectModule* bestPickedModule = Q_NULLPTR;
+	quint64 bestPickedId = 0;
+	for (const auto* m : objectsModule)
+	{
+		const StelPickBuffer::Layer* layer = pickBuffer.getLayer(m, prj);
+		if (layer)
+		{
+			quint64 id;
+			float value;
+			if (layer->find(xpos, ypos, searchRadiusPixel, distanceWeight, limitMag, id, value) && value < best_object_value)
+			{
+				best_object_value = value;
+				bestPickedModule = m;
+				bestPickedId = id;
+			}
+		}
+		else
+			candidates += m->searchAround(v, fov_around, core);
+	}
 	QList<StelObjectP> tmp;
 	for (const auto& obj : candidates)
 	{
@@ -352,13 +425,6 @@ StelObjectP StelObjectMgr::cleverFind(const StelCore* core, const Vec3d& v) cons
 	candidates = tmp;
 	
 	// Now select the object minimizing the function y = distance(in pixel) + magnitude
-	Vec3d winpos;
-	prj->project(v, winpos);
-	float xpos = winpos[0];
-	float ypos = winpos[1];
-
-	float best_object_value;
-	best_object_value = 100000.f;
 	for (const auto& obj : candidates)
 	{
 		prj->project(obj->getJ2000EquatorialPos(core), winpos);
@@ -372,6 +438,8 @@ StelObjectP StelObjectMgr::cleverFind(const StelCore* core, const Vec3d& v) cons
 		}
 	}
 
+	if (!sobj && bestPickedModule)
+		sobj = bestPickedModule->getPickedObject(bestPickedId);
 	return sobj;
 }
 
@@ -464,6 +532,9 @@ QStringList StelObjectMgr::listMatchingObjects(const QString& objPrefix, unsigne
 		return result;
 	}
 
+	// The search starts with the objects of the plugins initialized on first use
+	StelApp::getInstance().getModuleMgr().activateObjectPlugins();
+
 	// For all StelObjectmodules..
 	for (const auto* m : objectsModule)
 	{
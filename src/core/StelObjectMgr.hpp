@@ -24,7 +24,9 @@
 #include "VecMath.hpp"
 #include "StelModule.hpp"
 #include "StelObject.hpp"
+#include "StelPickBuffer.hpp"
 
+#include <QHash>
 #include <QList>
 #include <QString>
 
@@ -134,6 +136,18 @@ public:
 	//! so StelObject::getID() of the returned object may not be the same as the query parameter \p id.
 	StelObjectP searchByID(const QString& type, const QString& id) const;
 
+	//! Get a compact handle of an object, e.g. to store a selection or send it over the network.
+	//! The upper 16 bits identify the module of the object and are derived from its name, so that they are
+	//! the same in all instances of the program. The lower 48 bits are given by StelObjectModule::getObjectIndex().
+	//! A handle is only valid as long as the catalogs of the module are the same: when it is
+	//! exchanged between programs, compare the type and ID of the resolved object with the expected ones.
+	//! @return the handle, or 0 if the module of the object does not support handles
+	quint64 getObjectHandle(const StelObjectP& obj) const;
+
+	//! Find an object from a handle returned by getObjectHandle().
+	//! @return a null pointer if the handle is unknown.
+	StelObjectP searchByHandle(quint64 handle) const;
+
 	//! Set the radius in pixel in which objects will be searched when clicking on a point in sky.
 	void setObjectSearchRadius(float radius) {searchRadiusPixel=radius;}
 
@@ -141,6 +155,10 @@ public:
 	//! Default to 1.
 	void setDistanceWeight(float newDistanceWeight) {distanceWeight=newDistanceWeight;}
 
+	//! Get the screen positions of the objects drawn in the last frame, which modules fill while drawing
+	//! so that clicking on the sky does not need to call their searchAround().
+	StelPickBuffer& getPickBuffer() {return pickBuffer;}
+
 	//! Return a QMap of data about the object (calls obj->getInfoMap()).
 	//! If obj is valid, add an element ["found", true].
 	//! If obj is Q_NULLPTR, returns a 1-element map [["found", false]]
@@ -156,6 +174,9 @@ private:
 	QList<StelObjectModule*> objectsModule;
 	QMap<QString, StelObjectModule*> typeToModuleMap;
 	QMap<QString, QString> objModulesMap;
+	// The modules by the id used in object handles
+	QHash<quint16, StelObjectModule*> handleIdToModule;
+	QHash<const StelObjectModule*, quint16> moduleToHandleId;
 
 	// The last selected object in stellarium
 	QList<StelObjectP> lastSelectedObjects;
@@ -173,6 +194,8 @@ private:
 
 	// Weight of the distance factor when choosing the best object to select.
 	float distanceWeight;
+
+	StelPickBuffer pickBuffer;
 };
 
 #endif // _SELECTIONMGR_HPP
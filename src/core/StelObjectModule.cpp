@@ -20,9 +20,12 @@
 
 #include "StelObjectModule.hpp"
 
+#include <QMutexLocker>
+
 StelObjectModule::StelObjectModule()
  : StelModule()
 {
+	nameIndexValid[0] = nameIndexValid[1] = false;
 }
 
 StelObjectModule::~StelObjectModule()
@@ -49,25 +52,34 @@ QStringList StelObjectModule::listMatchingObjects(const QString &objPrefix, int
 		return result;
 	}
 
-	QStringList names = listAllObjects(inEnglish);
-	for (const auto& name : names)
+	// The search dialog calls this from a worker thread: build the index under the lock, and search
+	// an implicitly shared copy so that an invalidation does not wait for the query.
+	StelObjectNameIndex index;
 	{
-		if (!matchObjectName(name, objPrefix, useStartOfWords))
-		{
-			continue;
-		}
-
-		result.append(name);
-		if (result.size() >= maxNbItem)
+		QMutexLocker locker(&nameIndexMutex);
+		const int i = inEnglish ? 1 : 0;
+		if (!nameIndexValid[i])
 		{
-			break;
+			nameIndex[i].clear();
+			nameIndex[i].insert(listAllObjects(inEnglish));
+			nameIndex[i].build();
+			nameIndexValid[i] = true;
 		}
+		index = nameIndex[i];
 	}
-
+	result = index.listMatching(objPrefix, maxNbItem, useStartOfWords);
 	result.sort();
 	return result;
 }
 
+void StelObjectModule::invalidateNameIndex()
+{
+	QMutexLocker locker(&nameIndexMutex);
+	nameIndexValid[0] = nameIndexValid[1] = false;
+	nameIndex[0].clear();
+	nameIndex[1].clear();
+}
+
 QStringList StelObjectModule::listAllObjectsByType(const QString &objType, bool inEnglish) const
 {
 	Q_UNUSED(objType);
@@ -23,8 +23,10 @@
 
 #include "StelModule.hpp"
 #include "StelObjectType.hpp"
+#include "StelObjectNameIndex.hpp"
 #include "VecMath.hpp"
 
+#include <QMutex>
 #include <QList>
 #include <QString>
 #include <QStringList>
@@ -62,7 +64,9 @@ public:
 	//! @param name the english object name
 	virtual StelObjectP searchByID(const QString& id) const = 0;
 
-	//! Find and return the list of at most maxNbItem objects auto-completing passed object name
+	//! Find and return the list of at most maxNbItem objects auto-completing passed object name.
+	//! The default implementation searches the names returned by listAllObjects(), which are indexed
+	//! on first use. Modules using it must call invalidateNameIndex() when their list of names changes.
 	//! @param objPrefix the first letters of the searched object
 	//! @param maxNbItem the maximum number of returned object names
 	//! @param useStartOfWords decide if start of word is searched
@@ -70,6 +74,21 @@ public:
 	//! @return a list of matching object name by order of relevance, or an empty list if nothing matches
 	virtual QStringList listMatchingObjects(const QString& objPrefix, int maxNbItem=5, bool useStartOfWords=false, bool inEnglish=false) const;
 
+	//! Create the object added with the given id to the layer of this module in StelObjectMgr::getPickBuffer().
+	//! Modules filling a layer must reimplement it. The default implementation returns a null pointer.
+	virtual StelObjectP getPickedObject(quint64 id) const {Q_UNUSED(id); return StelObjectP();}
+
+	//! Returned by getObjectIndex() for objects which have no index.
+	static const quint64 InvalidObjectIndex = Q_UINT64_C(0xffffffffffffffff);
+
+	//! Get the index of an object of this module, used in the handles of StelObjectMgr::getObjectHandle().
+	//! The index must be below 2^48 and remain valid as long as the catalogs of the module are not reloaded.
+	//! The default implementation returns InvalidObjectIndex, i.e. the module does not support handles.
+	virtual quint64 getObjectIndex(const StelObject* obj) const {Q_UNUSED(obj); return InvalidObjectIndex;}
+
+	//! Return the object with an index returned by getObjectIndex(), or a null pointer if there is none.
+	virtual StelObjectP searchByObjectIndex(quint64 index) const {Q_UNUSED(index); return StelObjectP();}
+
 	//! List all StelObjects.
 	//! @param inEnglish list names in English (true) or translated (false)
 	//! @return a list of matching object name by order of relevance, or an empty list if nothing matches
@@ -92,6 +111,18 @@ public:
 	//! @param useStartOfWords decide if start of word is searched
 	//! @return true if it matches
 	bool matchObjectName(const QString& objName, const QString& objPrefix, bool useStartOfWords) const;
+
+public slots:
+	//! Mark the names returned by listAllObjects() as changed, so that the index searched by the default
+	//! listMatchingObjects() is rebuilt. Called by StelObjectMgr when the language changes.
+	void invalidateNameIndex();
+
+private:
+	//! Indices of the translated (0) and English (1) names, built on first use.
+	mutable StelObjectNameIndex nameIndex[2];
+	mutable bool nameIndexValid[2];
+	//! Protects nameIndex and nameIndexValid, which may be used by a search running in a worker thread.
+	mutable QMutex nameIndexMutex;
 };
 
 #endif // STELOBJECTMODULE_HPP
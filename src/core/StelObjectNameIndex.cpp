@@ -0,0 +1,120 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelObjectNameIndex.hpp"
+
+#include <algorithm>
+
+StelObjectNameIndex::StelObjectNameIndex()
+	: dirty(false)
+{
+}
+
+void StelObjectNameIndex::clear()
+{
+	entries.clear();
+	trigrams.clear();
+	dirty = false;
+}
+
+void StelObjectNameIndex::insert(const QString& name)
+{
+	if (name.isEmpty())
+		return;
+	entries.append(Entry(name));
+	dirty = true;
+}
+
+void StelObjectNameIndex::insert(const QStringList& names)
+{
+	entries.reserve(entries.size()+names.size());
+	for (const auto& name : names)
+		insert(name);
+}
+
+void StelObjectNameIndex::build() const
+{
+	std::stable_sort(entries.begin(), entries.end());
+	trigrams.clear();
+	for (int i=0; i<entries.size(); ++i)
+	{
+		const QString& key = entries.at(i).key;
+		for (int j=0; j+3<=key.size(); ++j)
+		{
+			QVector<int>& list = trigrams[trigram(key.constData()+j)];
+			// A sequence repeated in the name is listed once.
+			if (list.isEmpty() || list.last()!=i)
+				list.append(i);
+		}
+	}
+	dirty = false;
+}
+
+QStringList StelObjectNameIndex::listMatching(const QString& text, int maxNbItem, bool useStartOfWords) const
+{
+	QStringList result;
+	if (maxNbItem<=0 || text.isEmpty())
+		return result;
+	if (dirty)
+		build();
+
+	const QString key = text.toCaseFolded();
+	if (useStartOfWords)
+	{
+		auto it = std::lower_bound(entries.constBegin(), entries.constEnd(), Entry(text));
+		for (; it!=entries.constEnd() && result.size()<maxNbItem && it->key.startsWith(key); ++it)
+			result.append(it->name);
+	}
+	else if (key.size()<3)
+	{
+		for (const auto& entry : entries)
+		{
+			if (entry.key.contains(key))
+			{
+				result.append(entry.name);
+				if (result.size()>=maxNbItem)
+					break;
+			}
+		}
+	}
+	else
+	{
+		// Check only the names containing the least frequent sequence of 3 characters of the text.
+		const QVector<int>* candidates = Q_NULLPTR;
+		for (int j=0; j+3<=key.size(); ++j)
+		{
+			auto it = trigrams.constFind(trigram(key.constData()+j));
+			if (it==trigrams.constEnd())
+				return result;
+			if (!candidates || it->size()<candidates->size())
+				candidates = &(*it);
+		}
+		for (int i : *candidates)
+		{
+			if (entries.at(i).key.contains(key))
+			{
+				result.append(entries.at(i).name);
+				if (result.size()>=maxNbItem)
+					break;
+			}
+		}
+	}
+	return result;
+}
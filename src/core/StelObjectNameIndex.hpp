@@ -0,0 +1,80 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef STELOBJECTNAMEINDEX_HPP
+#define STELOBJECTNAMEINDEX_HPP
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+//! @class StelObjectNameIndex
+//! Index of object names answering the auto-completion queries of StelObjectModule::listMatchingObjects().
+//! Names are compared case-insensitively. The names are kept sorted, so that the names starting with a prefix
+//! are found by a binary search, and each sequence of 3 characters of a name is indexed, so that the names
+//! containing a text are found among those containing its least frequent sequence of 3 characters.
+//! Names can be inserted at any time, the index is rebuilt on the next query.
+class StelObjectNameIndex
+{
+public:
+	StelObjectNameIndex();
+
+	//! Remove all the names.
+	void clear();
+	//! Add a name to the index.
+	void insert(const QString& name);
+	void insert(const QStringList& names);
+
+	bool isEmpty() const {return entries.isEmpty();}
+
+	//! Sort the entries and index their sequences of 3 characters. This is done by listMatching() when names
+	//! were added; call it before copying the index to another thread, so that the copies share the built data.
+	void build() const;
+
+	//! Find the names matching a text.
+	//! @param text the text to search for
+	//! @param maxNbItem the maximum number of returned names
+	//! @param useStartOfWords if true, return the names starting with text, otherwise the names containing text
+	//! @return at most maxNbItem matching names, in alphabetical order
+	QStringList listMatching(const QString& text, int maxNbItem, bool useStartOfWords) const;
+
+private:
+	struct Entry
+	{
+		Entry() {}
+		Entry(const QString& aname) : key(aname.toCaseFolded()), name(aname) {}
+		bool operator<(const Entry& other) const {return key<other.key;}
+		QString key;
+		QString name;
+	};
+
+	static quint64 trigram(const QChar* c)
+	{
+		return (static_cast<quint64>(c[0].unicode()) << 32) | (static_cast<quint64>(c[1].unicode()) << 16) | c[2].unicode();
+	}
+
+	mutable QVector<Entry> entries;
+	//! Indices in entries of the names containing each sequence of 3 characters, in increasing order.
+	mutable QHash<quint64, QVector<int> > trigrams;
+	mutable bool dirty;
+};
+
+#endif // STELOBJECTNAMEINDEX_HPP
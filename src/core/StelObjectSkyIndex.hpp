@@ -0,0 +1,137 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STELOBJECTSKYINDEX_HPP
+#define STELOBJECTSKYINDEX_HPP
+
+#include "StelObject.hpp"
+#include "StelProjector.hpp"
+#include "StelSphericalIndex.hpp"
+
+#include <QList>
+#include <QSharedPointer>
+
+#include <cmath>
+#include <limits>
+
+//! @class StelObjectSkyIndex
+//! Container for the objects of a StelObjectModule, e.g. the catalog of a plugin, with a StelSphericalIndex of their
+//! J2000 positions. Drawing and StelObjectModule::searchAround() only visit the index cells touching the viewport or
+//! the search circle, instead of testing every object.
+//! Each object is inserted with a sort key, typically the brightest magnitude it can be drawn with. The objects of each
+//! cell are sorted by this key, so the processing of a cell stops at the first object fainter than the limit.
+//! The positions and keys are read on insert(): clear and refill the container when they change.
+//! @tparam T the object class, derived from StelObject
+template<class T>
+class StelObjectSkyIndex
+{
+public:
+	typedef QSharedPointer<T> ObjectP;
+
+	StelObjectSkyIndex(int maxObjectsPerNode = 50, int maxLevel = 7) : index(maxObjectsPerNode, maxLevel) {}
+
+	//! Remove all objects
+	void clear()
+	{
+		objects.clear();
+		index.clear();
+	}
+
+	//! Add an object at its current J2000 position.
+	//! @param sortKey the key to filter with in processInRegion(), e.g. the brightest magnitude of the object
+	void insert(const ObjectP& obj, float sortKey = 0.f)
+	{
+		Vec3d pos = obj->getJ2000EquatorialPos(Q_NULLPTR);
+		pos.normalize();
+		index.insert(StelRegionObjectP(new Entry(objects.size(), pos, sortKey)));
+		objects.append(obj);
+	}
+
+	//! All objects, in insertion order
+	const QList<ObjectP>& getObjects() const {return objects;}
+	int size() const {return objects.size();}
+	bool isEmpty() const {return objects.isEmpty();}
+	typename QList<ObjectP>::const_iterator begin() const {return objects.constBegin();}
+	typename QList<ObjectP>::const_iterator end() const {return objects.constEnd();}
+
+	//! Call func(const ObjectP&) for each object with its position in the region and a sort key not larger than maxSortKey.
+	template<class Func> void processInRegion(const SphericalRegion* region, float maxSortKey, Func func) const
+	{
+		FilterFunc<Func> filter(objects, maxSortKey, func);
+		index.processFilteredPointInRegions(region, filter);
+	}
+
+	//! Call func(const ObjectP&) for each object in the viewport of a J2000 projection with a sort key not larger than maxSortKey.
+	//! @param margin an extra margin around the viewport in pixel, e.g. for the labels
+	template<class Func> void processVisible(const StelProjectorP& prj, float maxSortKey, Func func, float margin = 0.f) const
+	{
+		const SphericalRegionP region = prj->getViewportConvexPolygon(margin, margin);
+		processInRegion(region.data(), maxSortKey, func);
+	}
+
+	//! The objects within limitFov degrees of the J2000 position v, as needed by StelObjectModule::searchAround().
+	QList<StelObjectP> searchAround(const Vec3d& v, double limitFov) const
+	{
+		QList<StelObjectP> result;
+		Vec3d n(v);
+		n.normalize();
+		const SphericalCap cap(n, std::cos(limitFov * M_PI/180.));
+		processInRegion(&cap, std::numeric_limits<float>::max(), [&result](const ObjectP& obj) {
+			result.append(qSharedPointerCast<StelObject>(obj));
+		});
+		return result;
+	}
+
+private:
+	//! The element stored in the index, referring to the object by its position in objects
+	class Entry : public StelRegionObject
+	{
+	public:
+		Entry(int aobjectIndex, const Vec3d& apos, float asortKey) : objectIndex(aobjectIndex), pos(apos), sortKey(asortKey) {}
+		virtual SphericalRegionP getRegion() const Q_DECL_OVERRIDE {return SphericalRegionP(new SphericalPoint(pos));}
+		virtual Vec3d getPointInRegion() const Q_DECL_OVERRIDE {return pos;}
+		virtual float getIndexSortKey() const Q_DECL_OVERRIDE {return sortKey;}
+		const int objectIndex;
+		const Vec3d pos;
+		const float sortKey;
+	};
+
+	template<class Func> struct FilterFunc
+	{
+		FilterFunc(const QList<ObjectP>& aobjects, float amaxSortKey, Func& afunc) : objects(aobjects), maxSortKey(amaxSortKey), func(afunc) {}
+		bool enterNode(quint64, quint64) const {return true;}
+		bool operator()(StelRegionObject* obj)
+		{
+			const Entry* entry = static_cast<const Entry*>(obj);
+			// The entries of a node are sorted by key, the remaining ones are fainter
+			if (entry->sortKey > maxSortKey)
+				return false;
+			func(objects.at(entry->objectIndex));
+			return true;
+		}
+		const QList<ObjectP>& objects;
+		const float maxSortKey;
+		Func& func;
+	};
+
+	QList<ObjectP> objects;
+	StelSphericalIndex index;
+};
+
+#endif // STELOBJECTSKYINDEX_HPP
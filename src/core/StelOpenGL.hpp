@@ -21,6 +21,7 @@
 #ifndef STELOPENGL_HPP
 #define STELOPENGL_HPP
 
+#include <QOpenGLContext>
 #include <QOpenGLFunctions>
 
 #ifndef QT_NO_DEBUG
@@ -46,6 +47,30 @@ namespace StelOpenGL
 	int checkGLErrors(const char *file, int line);
 	//! Clears all queued-up OpenGL errors without handling them
 	void clearGLErrors();
+
+	//! Disables the scissor test during its lifetime and enables it again afterwards, if it was enabled.
+	//! Used around offscreen passes like shadow maps, which must not be clipped to the sky rectangle set
+	//! with StelCore::setSkyDrawRect().
+	class ScissorSuspender
+	{
+	public:
+		ScissorSuspender()
+			: gl(QOpenGLContext::currentContext()->functions())
+			, enabled(gl->glIsEnabled(GL_SCISSOR_TEST))
+		{
+			if (enabled)
+				gl->glDisable(GL_SCISSOR_TEST);
+		}
+		~ScissorSuspender()
+		{
+			if (enabled)
+				gl->glEnable(GL_SCISSOR_TEST);
+		}
+	private:
+		Q_DISABLE_COPY(ScissorSuspender)
+		QOpenGLFunctions* gl;
+		bool enabled;
+	};
 }
 
 // This is still needed for the ARM platform (armhf)
@@ -19,6 +19,8 @@
 
 #include "StelOpenGLArray.hpp"
 #include "StelOBJ.hpp"
+#include "StelApp.hpp"
+#include "StelTextureMgr.hpp"
 
 #include <QElapsedTimer>
 #include <QOpenGLFunctions>
@@ -99,6 +101,8 @@ StelOpenGLArray::StelOpenGLArray()
 StelOpenGLArray::~StelOpenGLArray()
 {
 	//release is done by the Qt class destructors automatically
+	if (m_memoryUsage > 0)
+		StelApp::getInstance().getTextureManager().unregisterGLBuffer(this);
 }
 
 void StelOpenGLArray::clear()
@@ -109,6 +113,8 @@ void StelOpenGLArray::clear()
 		m_vao.destroy();
 	m_vertexBuffer.destroy();
 	m_indexBuffer.destroy();
+	if (m_memoryUsage > 0)
+		StelApp::getInstance().getTextureManager().unregisterGLBuffer(this);
 
 	m_indexBufferType = GL_UNSIGNED_INT;
 	m_indexBufferTypeSize = sizeof(GLuint);
@@ -263,6 +269,7 @@ bool StelOpenGLArray::load(const StelOBJ* obj, bool useTangents)
 		releaseBuffers();
 	}
 
+	StelApp::getInstance().getTextureManager().registerGLBuffer(this, QString("StelOpenGLArray with %1 indices").arg(m_indexCount), static_cast<qint64>(m_memoryUsage));
 	qCDebug(stelOpenGLArray)<<"Loaded StelOBJ data into OpenGL in"<<timer.elapsed()<<"ms ("<<(m_memoryUsage / 1024.0f)<<"kb GL memory)";
 	return true;
 }
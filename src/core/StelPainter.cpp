@@ -18,11 +18,16 @@
  */
 
 #include "StelPainter.hpp"
+#include "StelPainterBatch.hpp"
+#include "StelPainterRecorder.hpp"
+#include "StelTextAtlas.hpp"
 
 #include "StelApp.hpp"
+#include "StelFrameProfiler.hpp"
 #include "StelLocaleMgr.hpp"
 #include "StelProjector.hpp"
 #include "StelProjectorClasses.hpp"
+#include "StelProgramCache.hpp"
 #include "StelUtils.hpp"
 #include "Dithering.hpp"
 #include "SaturationShader.hpp"
@@ -30,9 +35,8 @@
 #include <QDebug>
 #include <QString>
 #include <QSettings>
-#include <QLinkedList>
 #include <QPainter>
-#include <QMutex>
+#include <QThread>
 #include <QVarLengthArray>
 #include <QPaintEngine>
 #include <QCache>
@@ -43,19 +47,15 @@
 
 static const int TEX_CACHE_LIMIT = 7000000;
 
-#ifndef NDEBUG
-QMutex* StelPainter::globalMutex = new QMutex();
-#endif
 
 QCache<QByteArray, StringTexture> StelPainter::texCache(TEX_CACHE_LIMIT);
-QOpenGLShaderProgram* StelPainter::texturesShaderProgram=Q_NULLPTR;
-QOpenGLShaderProgram* StelPainter::basicShaderProgram=Q_NULLPTR;
-QOpenGLShaderProgram* StelPainter::colorShaderProgram=Q_NULLPTR;
-QOpenGLShaderProgram* StelPainter::texturesColorShaderProgram=Q_NULLPTR;
-StelPainter::BasicShaderVars StelPainter::basicShaderVars;
-StelPainter::TexturesShaderVars StelPainter::texturesShaderVars;
-StelPainter::BasicShaderVars StelPainter::colorShaderVars;
-StelPainter::TexturesColorShaderVars StelPainter::texturesColorShaderVars;
+StelPainter::ShaderPrograms StelPainter::cpuPrograms;
+QHash<QByteArray, StelPainter::ShaderPrograms*> StelPainter::gpuPrograms;
+bool StelPainter::flagGpuProjection=true;
+StelPainterBatch* StelPainter::batch=Q_NULLPTR;
+StelTextAtlas* StelPainter::textAtlas=Q_NULLPTR;
+StelPainter* StelPainter::activePainter=Q_NULLPTR;
+bool StelPainter::flagBatching=true;
 
 StelPainter::GLState::GLState(QOpenGLFunctions* gl)
 	: blend(false),
@@ -95,6 +95,7 @@ void StelPainter::GLState::apply()
 			gl->glDisable(GL_LINE_SMOOTH);
 	}
 #endif
+	gl->glLineWidth(lineWidth);
 }
 
 void StelPainter::GLState::reset()
@@ -112,6 +113,27 @@ bool StelPainter::linkProg(QOpenGLShaderProgram* prog, const QString& name)
 	return ret;
 }
 
+bool StelPainter::buildProg(QOpenGLShaderProgram* prog, const QString& vsrc, const QString& fsrc, const QString& name)
+{
+	const QByteArray key = vsrc.toUtf8() + '\0' + fsrc.toUtf8();
+	if (StelProgramCache::loadProgram(*prog, key))
+		return true;
+
+	QOpenGLShader vshader(QOpenGLShader::Vertex);
+	vshader.compileSourceCode(vsrc);
+	if (!vshader.log().isEmpty()) { qWarning() << QString("StelPainter: Warnings while compiling vertex shader of %1:").arg(name) << vshader.log(); }
+	QOpenGLShader fshader(QOpenGLShader::Fragment);
+	fshader.compileSourceCode(fsrc);
+	if (!fshader.log().isEmpty()) { qWarning() << QString("StelPainter: Warnings while compiling fragment shader of %1:").arg(name) << fshader.log(); }
+	prog->addShader(&vshader);
+	prog->addShader(&fshader);
+	StelProgramCache::prepareProgram(*prog);
+	const bool ret = linkProg(prog, name);
+	if (ret)
+		StelProgramCache::saveProgram(*prog, key);
+	return ret;
+}
+
 StelPainter::DitheringMode StelPainter::parseDitheringMode(QString const& str)
 {
 	const auto s=str.trimmed().toLower();
@@ -128,20 +150,15 @@ StelPainter::StelPainter(const StelProjectorP& proj) : QOpenGLFunctions(QOpenGLC
 	Q_ASSERT(proj);
 
 #ifndef NDEBUG
-	Q_ASSERT(globalMutex);
-	
+	// Only the thread of the OpenGL context can paint. Geometry can be prepared on other threads with StelPainterRecorder.
+	Q_ASSERT(QOpenGLContext::currentContext() && QThread::currentThread()==QOpenGLContext::currentContext()->thread());
+
 	GLenum er = glGetError();
 	if (er!=GL_NO_ERROR)
 	{
 		if (er==GL_INVALID_OPERATION)
 			qFatal("Invalid openGL operation. It is likely that you used openGL calls without having a valid instance of StelPainter");
 	}
-
-	// Lock the global mutex ensuring that no other instances of StelPainter are currently being used
-	if (globalMutex->tryLock()==false)
-	{
-		qFatal("There can be only 1 instance of StelPainter at a given time");
-	}
 #endif
 
 	//TODO: is this still required, and is there some Qt way to fix it? 0x11111111 is a bit peculiar, how was it chosen?
@@ -152,11 +169,13 @@ StelPainter::StelPainter(const StelProjectorP& proj) : QOpenGLFunctions(QOpenGLC
 
 	QSettings*const conf = StelApp::getInstance().getSettings();
 	ditheringMode = parseDitheringMode(conf->value("video/dithering_mode").toString());
+	activePainter = this;
 }
 
 void StelPainter::setProjector(const StelProjectorP& p)
 {
 	prj=p;
+	gpuProgramsChecked=false;
 	// Init GL viewport to current projector values
 	glViewport(prj->viewportXywh[0], prj->viewportXywh[1], prj->viewportXywh[2], prj->viewportXywh[3]);
 	glFrontFace(prj->needGlFrontFaceCW()?GL_CW:GL_CCW);
@@ -168,6 +187,8 @@ StelPainter::~StelPainter()
 		glDeleteTextures(1, &bayerPatternTex);
 	//reset opengl state
 	glState.reset();
+	if (activePainter==this)
+		activePainter = Q_NULLPTR;
 
 #ifndef NDEBUG
 	GLenum er = glGetError();
@@ -177,8 +198,6 @@ StelPainter::~StelPainter()
 			qFatal("Invalid openGL operation detected in ~StelPainter()");
 	}
 
-	// We are done with this StelPainter
-	globalMutex->unlock();
 #endif
 }
 
@@ -649,6 +668,9 @@ StringTexture* StelPainter::getTexTexture(const QString& str, int pixelSize) con
 	//painter.setRenderHints(QPainter::TextAntialiasing);
 	painter.setPen(Qt::white);
 	painter.drawText(-strRect.x(), -strRect.y(), str);
+	// Inserting may delete textures which batched draws still use.
+	if (texCache.totalCost()+3*w*h > texCache.maxCost())
+		submitBatch();
 	StringTexture* newTex = new StringTexture(new QOpenGLTexture(strImage.toImage()), QSize(w, h));
 	texCache.insert(hash, newTex, 3*w*h);
 	// simply returning newTex is dangerous as the object is owned by the cache now. (Coverity Scan barks.)
@@ -717,8 +739,28 @@ void StelPainter::drawText(float x, float y, const QString& str, float angleDeg,
 		tex->texture->release();
 		delete[] texCoords;
 	}
+	else if (textAtlas && textAtlas->isAvailable())
+	{
+		QFont tmpFont = currentFont;
+		tmpFont.setPixelSize(currentFont.pixelSize()*prj->getDevicePixelsPerPixel()*StelApp::getInstance().getGlobalScalingRatio());
+		const float scaleRatio = StelApp::getInstance().getGlobalScalingRatio();
+		if (!noGravity)
+			angleDeg += prj->defaultAngleForGravityText;
+		// Same placement as with QPainter below: the shift is rotated with the text
+		const float cosr = std::cos(angleDeg * M_PI/180.);
+		const float sinr = std::sin(angleDeg * M_PI/180.);
+		const float x0 = x + (xshift*cosr - yshift*sinr)*scaleRatio;
+		const float y0 = y + (xshift*sinr + yshift*cosr)*scaleRatio;
+		if (textAtlas->addText(tmpFont, str, x0, y0, angleDeg, currentColor, prj->getProjectionMatrix(), prj->viewportXywh))
+		{
+			glState.apply();
+			setProjector(prj);
+		}
+	}
 	else
 	{
+		// QPainter draws immediately, so the batched draws which should be below the text have to be issued first.
+		submitBatch();
 		QOpenGLPaintDevice device;
 		device.setSize(QSize(prj->getViewportWidth(), prj->getViewportHeight()));
 		// This doesn't seem to work correctly, so implement the hack below instead.
@@ -770,16 +812,17 @@ void StelPainter::drawText(float x, float y, const QString& str, float angleDeg,
 	}
 }
 
-// Recursive method cutting a small circle in small segments
-inline void fIter(const StelProjectorP& prj, const Vec3d& p1, const Vec3d& p2, Vec3d& win1, Vec3d& win2, QLinkedList<Vec3d>& vertexList, const QLinkedList<Vec3d>::iterator& iter, double radius, const Vec3d& center, int nbI=0, bool checkCrossDiscontinuity=true)
+// Recursive method cutting a small circle in small segments.
+// The points strictly between win1 and win2 are appended to vertexList, in order.
+static void fIter(const StelProjectorP& prj, const Vec3d& p1, const Vec3d& p2, Vec3d& win1, Vec3d& win2, QVector<Vec3d>& vertexList, double radius, const Vec3d& center, int maxDepth, int nbI=0, bool checkCrossDiscontinuity=true)
 {
 	const bool crossDiscontinuity = checkCrossDiscontinuity && prj->intersectViewportDiscontinuity(p1+center, p2+center);
-	if (crossDiscontinuity && nbI>=10)
+	if (crossDiscontinuity && nbI>=maxDepth)
 	{
 		win1[2]=-2.;
 		win2[2]=-2.;
-		vertexList.insert(iter, win1);
-		vertexList.insert(iter, win2);
+		vertexList.append(win1);
+		vertexList.append(win2);
 		return;
 	}
 
@@ -796,18 +839,24 @@ inline void fIter(const StelProjectorP& prj, const Vec3d& p1, const Vec3d& p2, V
 
 	const float dist = std::sqrt((v10*v10+v11*v11)*(v20*v20+v21*v21));
 	const float cosAngle = (v10*v20+v11*v21)/dist;
-	if ((cosAngle>-0.999f || dist>50*50 || crossDiscontinuity) && nbI<10)
+	if ((cosAngle>-0.999f || dist>50*50 || crossDiscontinuity) && nbI<maxDepth)
 	{
 		// Use the 3rd component of the vector to store whether the vertex is valid
 		win3[2]= isValidVertex ? 1.0 : -1.;
-		fIter(prj, p1, newVertex, win1, win3, vertexList, vertexList.insert(iter, win3), radius, center, nbI+1, crossDiscontinuity || dist>50*50);
-		fIter(prj, newVertex, p2, win3, win2, vertexList, iter, radius, center, nbI+1, crossDiscontinuity || dist>50*50 );
+		// The first half may flag win3 as a discontinuity, but the middle point itself is stored as it is now.
+		const Vec3d middle(win3);
+		fIter(prj, p1, newVertex, win1, win3, vertexList, radius, center, maxDepth, nbI+1, crossDiscontinuity || dist>50*50);
+		vertexList.append(middle);
+		fIter(prj, newVertex, p2, win3, win2, vertexList, radius, center, maxDepth, nbI+1, crossDiscontinuity || dist>50*50 );
 	}
 }
 
 // Used by the method below
 QVector<Vec2f> StelPainter::smallCircleVertexArray;
 QVector<Vec4f> StelPainter::smallCircleColorArray;
+QVector<Vec3d> StelPainter::smallCircleTessArc;
+QVector<int> StelPainter::smallCircleStripEnds;
+int StelPainter::tessellationDepth=10;
 
 void StelPainter::drawSmallCircleVertexArray()
 {
@@ -843,49 +892,59 @@ void StelPainter::drawGreatCircleArc(const Vec3d& start, const Vec3d& stop, cons
 	drawSmallCircleArc(start, stop, Vec3d(0.), viewportEdgeIntersectCallback, userData);
  }
 
-/*************************************************************************
- Draw a small circle arc in the current frame
-*************************************************************************/
-void StelPainter::drawSmallCircleArc(const Vec3d& start, const Vec3d& stop, const Vec3d& rotCenter, void (*viewportEdgeIntersectCallback)(const Vec3d& screenPos, const Vec3d& direction, void* userData), void* userData)
+void StelPainter::tessellateSmallCircleArc(const StelProjectorP& prj, const Vec3d& start, const Vec3d& stop, const Vec3d& rotCenter,
+					   QVector<Vec3d>& tessArc, QVector<Vec2f>& vertices, QVector<int>& stripEnds,
+					   void (*viewportEdgeIntersectCallback)(const Vec3d& screenPos, const Vec3d& direction, void* userData), void* userData)
 {
-	Q_ASSERT(smallCircleVertexArray.empty());
+	tessArc.resize(0);
+	vertices.resize(0);
+	stripEnds.resize(0);
+	// Close the current strip, if it has a segment
+	auto endStrip = [&]() {
+		const int begin = stripEnds.isEmpty() ? 0 : stripEnds.last();
+		if (vertices.size()-begin>1)
+			stripEnds.append(vertices.size());
+		else
+			vertices.resize(begin);
+	};
 
-	QLinkedList<Vec3d> tessArc;	// Contains the list of projected points from the tesselated arc
+	// tessArc contains the list of projected points from the tesselated arc
 	Vec3d win1, win2;
 	win1[2] = prj->project(start, win1) ? 1.0 : -1.;
 	win2[2] = prj->project(stop, win2) ? 1.0 : -1.;
+	const Vec3d last(win2);
 	tessArc.append(win1);
 
-
 	if (rotCenter.lengthSquared()<1e-11)
 	{
 		// Great circle
 		// Perform the tesselation of the arc in small segments in a way so that the lines look smooth
-		fIter(prj, start, stop, win1, win2, tessArc, tessArc.insert(tessArc.end(), win2), 1, rotCenter);
+		fIter(prj, start, stop, win1, win2, tessArc, 1, rotCenter, tessellationDepth);
 	}
 	else
 	{
 		Vec3d tmp = (rotCenter^start)/rotCenter.length();
 		const double radius = fabs(tmp.length());
 		// Perform the tesselation of the arc in small segments in a way so that the lines look smooth
-		fIter(prj, start-rotCenter, stop-rotCenter, win1, win2, tessArc, tessArc.insert(tessArc.end(), win2), radius, rotCenter);
+		fIter(prj, start-rotCenter, stop-rotCenter, win1, win2, tessArc, radius, rotCenter, tessellationDepth);
 	}
+	tessArc.append(last);
 
-	// And draw.
-	QLinkedList<Vec3d>::ConstIterator i = tessArc.constBegin();
-	while (i+1 != tessArc.constEnd())
+	// And split in visible strips.
+	const int n = tessArc.size();
+	for (int i = 1; i < n; ++i)
 	{
-		const Vec3d& p1 = *i;
-		const Vec3d& p2 = *(++i);
+		const Vec3d& p1 = tessArc.at(i-1);
+		const Vec3d& p2 = tessArc.at(i);
 		const bool p1InViewport = prj->checkInViewport(p1);
 		const bool p2InViewport = prj->checkInViewport(p2);
 		if ((p1[2]>0 && p1InViewport) || (p2[2]>0 && p2InViewport))
 		{
-			smallCircleVertexArray.append(Vec2f(p1[0], p1[1]));
-			if (i+1==tessArc.constEnd())
+			vertices.append(Vec2f(p1[0], p1[1]));
+			if (i+1==n)
 			{
-				smallCircleVertexArray.append(Vec2f(p2[0], p2[1]));
-				drawSmallCircleVertexArray();
+				vertices.append(Vec2f(p2[0], p2[1]));
+				endStrip();
 			}
 			if (viewportEdgeIntersectCallback && p1InViewport!=p2InViewport)
 			{
@@ -898,13 +957,38 @@ void StelPainter::drawSmallCircleArc(const Vec3d& start, const Vec3d& stop, cons
 		}
 		else
 		{
-			// Break the line, draw the stored vertex and flush the list
-			if (!smallCircleVertexArray.isEmpty())
-				smallCircleVertexArray.append(Vec2f(p1[0], p1[1]));
-			drawSmallCircleVertexArray();
+			// Break the line
+			const int begin = stripEnds.isEmpty() ? 0 : stripEnds.last();
+			if (vertices.size()>begin)
+				vertices.append(Vec2f(p1[0], p1[1]));
+			endStrip();
 		}
 	}
-	Q_ASSERT(smallCircleVertexArray.isEmpty());
+}
+
+/*************************************************************************
+ Draw a small circle arc in the current frame
+*************************************************************************/
+void StelPainter::drawSmallCircleArc(const Vec3d& start, const Vec3d& stop, const Vec3d& rotCenter, void (*viewportEdgeIntersectCallback)(const Vec3d& screenPos, const Vec3d& direction, void* userData), void* userData)
+{
+	tessellateSmallCircleArc(prj, start, stop, rotCenter, smallCircleTessArc, smallCircleVertexArray, smallCircleStripEnds,
+				 viewportEdgeIntersectCallback, userData);
+	if (!smallCircleStripEnds.isEmpty())
+	{
+		enableClientStates(true);
+		setVertexPointer(2, GL_FLOAT, smallCircleVertexArray.constData());
+		int begin = 0;
+		for (int end : smallCircleStripEnds)
+		{
+			drawFromArray(LineStrip, end-begin, begin, false);
+			begin = end;
+		}
+		enableClientStates(false);
+	}
+	// Keep the capacity for the next arc
+	smallCircleTessArc.resize(0);
+	smallCircleVertexArray.resize(0);
+	smallCircleStripEnds.resize(0);
 }
 
 void StelPainter::drawPath(const QVector<Vec3d> &points, const QVector<Vec4f> &colors)
@@ -1593,6 +1677,50 @@ void StelPainter::drawSphericalTriangles(const StelVertexArray& va, bool texture
 	}
 }
 
+bool StelPainter::drawSubdividedRegion(const SphericalRegion* poly, SphericalPolygonDrawMode drawMode, double maxSqDistortion)
+{
+	// Only polygons reset their cached subdivisions when they change
+	if (poly->getType()!=SphericalRegion::Polygon && poly->getType()!=SphericalRegion::ConvexPolygon)
+		return false;
+	// The triangles are drawn without checks, all their vertices must be validly projected
+	const SphericalCap& cap = poly->getBoundingCap();
+	if (!prj->getBoundingCap().contains(cap) || prj->intersectViewportDiscontinuity(cap))
+		return false;
+
+	// The middle of a side of length L of a triangle is projected at about ppr*L^2/8 pixels from the middle of
+	// the projected side for a curvature of 1. Allow a curvature of 2, and find the subdivision level for which
+	// the sides are short enough to match maxSqDistortion. projectSphericalTriangle() stops at 5 levels as well.
+	const double maxSideLength = std::sqrt(4.*std::sqrt(maxSqDistortion)/prj->getPixelPerRadAtCenter());
+	double sideLength = poly->getFillMaxSideLength();
+	int level = 0;
+	while (sideLength>maxSideLength && level<5)
+	{
+		sideLength *= 0.5;
+		++level;
+	}
+	if (sideLength>maxSideLength)
+		return false;
+
+	const StelVertexArray* arr;
+	StelVertexArray fill;
+	if (level==0)
+	{
+		fill = poly->getFillVertexArray();
+		arr = &fill;
+	}
+	else
+	{
+		arr = poly->getSubdividedFillVertexArray(level, 100000);
+		if (!arr)
+			return false;
+	}
+	// Keep the texturing and color modulation of drawSphericalTriangles()
+	if (arr->isTextured()!=(drawMode>=SphericalPolygonDrawModeTextureFill) || arr->isColored()!=(drawMode==SphericalPolygonDrawModeTextureFillColormodulated))
+		return false;
+	drawStelVertexArray(*arr, false);
+	return true;
+}
+
 // Draw the given SphericalPolygon.
 void StelPainter::drawSphericalRegion(const SphericalRegion* poly, SphericalPolygonDrawMode drawMode, const SphericalCap* clippingCap, const bool doSubDivise, const double maxSqDistortion)
 {
@@ -1614,6 +1742,12 @@ void StelPainter::drawSphericalRegion(const SphericalRegion* poly, SphericalPoly
 		case SphericalPolygonDrawModeTextureFillColormodulated:
 			setCullFace(true);
 			// The polygon is already tesselated as triangles
+			// Static regions reuse their cached subdivision when they don't need clipping
+			if (doSubDivise && !clippingCap && drawSubdividedRegion(poly, drawMode, maxSqDistortion))
+			{
+				setCullFace(oldCullFace);
+				break;
+			}
 			if (doSubDivise || prj->intersectViewportDiscontinuity(poly->getBoundingCap()))
 				// flag for color-modulated textured mode (e.g. for Milky Way/extincted)
 				drawSphericalTriangles(poly->getFillVertexArray(), drawMode>=SphericalPolygonDrawModeTextureFill, drawMode==SphericalPolygonDrawModeTextureFillColormodulated, clippingCap, doSubDivise, maxSqDistortion);
@@ -1964,86 +2098,81 @@ void StelPainter::sCylinder(float radius, float height, int slices, int orientIn
 void StelPainter::initGLShaders()
 {
 	qDebug() << "Initializing basic GL shaders... ";
+	// The vertices of cpuPrograms are already projected in viewport coordinates.
+	createShaderPrograms(QByteArray(
+		"vec4 projectVertex(vec3 v)\n"
+		"{\n"
+		"    return vec4(v, 1.);\n"
+		"}\n"), cpuPrograms);
+	batch = new StelPainterBatch();
+	textAtlas = new StelTextAtlas();
+	textAtlas->init();
+	QSettings* conf = StelApp::getInstance().getSettings();
+	flagBatching = conf->value("video/flag_batch_draws", true).toBool();
+	flagGpuProjection = conf->value("video/flag_gpu_projection", true).toBool();
+	setTessellationDepth(conf->value("video/arc_tessellation_depth", 10).toInt());
+	smallCircleTessArc.reserve((1<<tessellationDepth) + 2);
+}
+
+bool StelPainter::createShaderPrograms(const QByteArray& projection, ShaderPrograms& programs)
+{
+	bool ok = true;
 	// Basic shader: just vertex filled with plain color
-	QOpenGLShader vshader3(QOpenGLShader::Vertex);
-	const char *vsrc3 =
+	const QByteArray vsrc3 = projection +
 		"attribute mediump vec3 vertex;\n"
 		"uniform mediump mat4 projectionMatrix;\n"
 		"void main(void)\n"
 		"{\n"
-		"    gl_Position = projectionMatrix*vec4(vertex, 1.);\n"
+		"    gl_Position = projectionMatrix*projectVertex(vertex);\n"
 		"}\n";
-	vshader3.compileSourceCode(vsrc3);
-	if (!vshader3.log().isEmpty()) { qWarning() << "StelPainter: Warnings while compiling vshader3: " << vshader3.log(); }
-	QOpenGLShader fshader3(QOpenGLShader::Fragment);
 	const char *fsrc3 =
 		"uniform mediump vec4 color;\n"
 		"void main(void)\n"
 		"{\n"
 		"    gl_FragColor = color;\n"
 		"}\n";
-	fshader3.compileSourceCode(fsrc3);
-	if (!fshader3.log().isEmpty()) { qWarning() << "StelPainter: Warnings while compiling fshader3: " << fshader3.log(); }
-	basicShaderProgram = new QOpenGLShaderProgram(QOpenGLContext::currentContext());
-	basicShaderProgram->addShader(&vshader3);
-	basicShaderProgram->addShader(&fshader3);
-	linkProg(basicShaderProgram, "basicShaderProgram");
-	basicShaderVars.projectionMatrix = basicShaderProgram->uniformLocation("projectionMatrix");
-	basicShaderVars.color = basicShaderProgram->uniformLocation("color");
-	basicShaderVars.vertex = basicShaderProgram->attributeLocation("vertex");
+	programs.basic = new QOpenGLShaderProgram(QOpenGLContext::currentContext());
+	ok = buildProg(programs.basic, vsrc3, fsrc3, "basicShaderProgram") && ok;
+	programs.basicVars.projectionMatrix = programs.basic->uniformLocation("projectionMatrix");
+	programs.basicVars.color = programs.basic->uniformLocation("color");
+	programs.basicVars.vertex = programs.basic->attributeLocation("vertex");
 	
 
 	// Basic shader: vertex filled with interpolated color
-	QOpenGLShader vshaderInterpolatedColor(QOpenGLShader::Vertex);
-	const char *vshaderInterpolatedColorSrc =
+	const QByteArray vshaderInterpolatedColorSrc = projection +
 		"attribute mediump vec3 vertex;\n"
 		"attribute mediump vec4 color;\n"
 		"uniform mediump mat4 projectionMatrix;\n"
 		"varying mediump vec4 fragcolor;\n"
 		"void main(void)\n"
 		"{\n"
-		"    gl_Position = projectionMatrix*vec4(vertex, 1.);\n"
+		"    gl_Position = projectionMatrix*projectVertex(vertex);\n"
 		"    fragcolor = color;\n"
 		"}\n";
-	vshaderInterpolatedColor.compileSourceCode(vshaderInterpolatedColorSrc);
-	if (!vshaderInterpolatedColor.log().isEmpty()) {
-	  qWarning() << "StelPainter: Warnings while compiling vshaderInterpolatedColor: " << vshaderInterpolatedColor.log();
-	}
-	QOpenGLShader fshaderInterpolatedColor(QOpenGLShader::Fragment);
 	const char *fshaderInterpolatedColorSrc =
 		"varying mediump vec4 fragcolor;\n"
 		"void main(void)\n"
 		"{\n"
 		"    gl_FragColor = fragcolor;\n"
 		"}\n";
-	fshaderInterpolatedColor.compileSourceCode(fshaderInterpolatedColorSrc);
-	if (!fshaderInterpolatedColor.log().isEmpty()) {
-	  qWarning() << "StelPainter: Warnings while compiling fshaderInterpolatedColor: " << fshaderInterpolatedColor.log();
-	}
-	colorShaderProgram = new QOpenGLShaderProgram(QOpenGLContext::currentContext());
-	colorShaderProgram->addShader(&vshaderInterpolatedColor);
-	colorShaderProgram->addShader(&fshaderInterpolatedColor);
-	linkProg(colorShaderProgram, "colorShaderProgram");
-	colorShaderVars.projectionMatrix = colorShaderProgram->uniformLocation("projectionMatrix");
-	colorShaderVars.color = colorShaderProgram->attributeLocation("color");
-	colorShaderVars.vertex = colorShaderProgram->attributeLocation("vertex");
+	programs.color = new QOpenGLShaderProgram(QOpenGLContext::currentContext());
+	ok = buildProg(programs.color, vshaderInterpolatedColorSrc, fshaderInterpolatedColorSrc, "colorShaderProgram") && ok;
+	programs.colorVars.projectionMatrix = programs.color->uniformLocation("projectionMatrix");
+	programs.colorVars.color = programs.color->attributeLocation("color");
+	programs.colorVars.vertex = programs.color->attributeLocation("vertex");
 	
 	// Basic texture shader program
-	QOpenGLShader vshader2(QOpenGLShader::Vertex);
-	const char *vsrc2 =
+	const QByteArray vsrc2 = projection +
 		"attribute highp vec3 vertex;\n"
 		"attribute mediump vec2 texCoord;\n"
 		"uniform mediump mat4 projectionMatrix;\n"
 		"varying mediump vec2 texc;\n"
 		"void main(void)\n"
 		"{\n"
-		"    gl_Position = projectionMatrix * vec4(vertex, 1.);\n"
+		"    gl_Position = projectionMatrix * projectVertex(vertex);\n"
 		"    texc = texCoord;\n"
 		"}\n";
-	vshader2.compileSourceCode(vsrc2);
-	if (!vshader2.log().isEmpty()) { qWarning() << "StelPainter: Warnings while compiling vshader2: " << vshader2.log(); }
 
-	QOpenGLShader fshader2(QOpenGLShader::Fragment);
 	const auto fsrc2 =
 		makeDitheringShader()+
 		"varying mediump vec2 texc;\n"
@@ -2053,24 +2182,19 @@ void StelPainter::initGLShaders()
 		"{\n"
 		"    gl_FragColor = dither(texture2D(tex, texc)*texColor);\n"
 		"}\n";
-	fshader2.compileSourceCode(fsrc2);
-	if (!fshader2.log().isEmpty()) { qWarning() << "StelPainter: Warnings while compiling fshader2: " << fshader2.log(); }
-
-	texturesShaderProgram = new QOpenGLShaderProgram(QOpenGLContext::currentContext());
-	texturesShaderProgram->addShader(&vshader2);
-	texturesShaderProgram->addShader(&fshader2);
-	linkProg(texturesShaderProgram, "texturesShaderProgram");
-	texturesShaderVars.projectionMatrix = texturesShaderProgram->uniformLocation("projectionMatrix");
-	texturesShaderVars.texCoord = texturesShaderProgram->attributeLocation("texCoord");
-	texturesShaderVars.vertex = texturesShaderProgram->attributeLocation("vertex");
-	texturesShaderVars.texColor = texturesShaderProgram->uniformLocation("texColor");
-	texturesShaderVars.texture = texturesShaderProgram->uniformLocation("tex");
-	texturesShaderVars.bayerPattern = texturesShaderProgram->uniformLocation("bayerPattern");
-	texturesShaderVars.rgbMaxValue = texturesShaderProgram->uniformLocation("rgbMaxValue");
+
+	programs.textures = new QOpenGLShaderProgram(QOpenGLContext::currentContext());
+	ok = buildProg(programs.textures, vsrc2, fsrc2, "texturesShaderProgram") && ok;
+	programs.texturesVars.projectionMatrix = programs.textures->uniformLocation("projectionMatrix");
+	programs.texturesVars.texCoord = programs.textures->attributeLocation("texCoord");
+	programs.texturesVars.vertex = programs.textures->attributeLocation("vertex");
+	programs.texturesVars.texColor = programs.textures->uniformLocation("texColor");
+	programs.texturesVars.texture = programs.textures->uniformLocation("tex");
+	programs.texturesVars.bayerPattern = programs.textures->uniformLocation("bayerPattern");
+	programs.texturesVars.rgbMaxValue = programs.textures->uniformLocation("rgbMaxValue");
 
 	// Texture shader program + interpolated color per vertex
-	QOpenGLShader vshader4(QOpenGLShader::Vertex);
-	const char *vsrc4 =
+	const QByteArray vsrc4 = projection +
 		"attribute highp vec3 vertex;\n"
 		"attribute mediump vec2 texCoord;\n"
 		"attribute mediump vec4 color;\n"
@@ -2079,14 +2203,11 @@ void StelPainter::initGLShaders()
 		"varying mediump vec4 outColor;\n"
 		"void main(void)\n"
 		"{\n"
-		"    gl_Position = projectionMatrix * vec4(vertex, 1.);\n"
+		"    gl_Position = projectionMatrix * projectVertex(vertex);\n"
 		"    texc = texCoord;\n"
 		"    outColor = color;\n"
 		"}\n";
-	vshader4.compileSourceCode(vsrc4);
-	if (!vshader4.log().isEmpty()) { qWarning() << "StelPainter: Warnings while compiling vshader4: " << vshader4.log(); }
 
-	QOpenGLShader fshader4(QOpenGLShader::Fragment);
 	const auto fsrc4 =
 		makeDitheringShader()+
 		makeSaturationShader()+
@@ -2100,34 +2221,88 @@ void StelPainter::initGLShaders()
 		"    if (saturation != 1.0)\n"
 		"        gl_FragColor.rgb = saturate(gl_FragColor.rgb, saturation);\n"
 		"}\n";
-	fshader4.compileSourceCode(fsrc4);
-	if (!fshader4.log().isEmpty()) { qWarning() << "StelPainter: Warnings while compiling fshader4: " << fshader4.log(); }
 
-	texturesColorShaderProgram = new QOpenGLShaderProgram(QOpenGLContext::currentContext());
-	texturesColorShaderProgram->addShader(&vshader4);
-	texturesColorShaderProgram->addShader(&fshader4);
-	linkProg(texturesColorShaderProgram, "texturesColorShaderProgram");
-	texturesColorShaderVars.projectionMatrix = texturesColorShaderProgram->uniformLocation("projectionMatrix");
-	texturesColorShaderVars.texCoord = texturesColorShaderProgram->attributeLocation("texCoord");
-	texturesColorShaderVars.vertex = texturesColorShaderProgram->attributeLocation("vertex");
-	texturesColorShaderVars.color = texturesColorShaderProgram->attributeLocation("color");
-	texturesColorShaderVars.texture = texturesColorShaderProgram->uniformLocation("tex");
-	texturesColorShaderVars.bayerPattern = texturesColorShaderProgram->uniformLocation("bayerPattern");
-	texturesColorShaderVars.rgbMaxValue = texturesColorShaderProgram->uniformLocation("rgbMaxValue");
-	texturesColorShaderVars.saturation = texturesColorShaderProgram->uniformLocation("saturation");
+	programs.texturesColor = new QOpenGLShaderProgram(QOpenGLContext::currentContext());
+	ok = buildProg(programs.texturesColor, vsrc4, fsrc4, "texturesColorShaderProgram") && ok;
+	programs.texturesColorVars.projectionMatrix = programs.texturesColor->uniformLocation("projectionMatrix");
+	programs.texturesColorVars.texCoord = programs.texturesColor->attributeLocation("texCoord");
+	programs.texturesColorVars.vertex = programs.texturesColor->attributeLocation("vertex");
+	programs.texturesColorVars.color = programs.texturesColor->attributeLocation("color");
+	programs.texturesColorVars.texture = programs.texturesColor->uniformLocation("tex");
+	programs.texturesColorVars.bayerPattern = programs.texturesColor->uniformLocation("bayerPattern");
+	programs.texturesColorVars.rgbMaxValue = programs.texturesColor->uniformLocation("rgbMaxValue");
+	programs.texturesColorVars.saturation = programs.texturesColor->uniformLocation("saturation");
+
+	return ok;
 }
 
+const StelPainter::ShaderPrograms* StelPainter::getGpuPrograms()
+{
+	if (gpuProgramsChecked)
+		return currentGpuPrograms;
+	gpuProgramsChecked = true;
+	currentGpuPrograms = Q_NULLPTR;
+	if (!flagGpuProjection)
+		return Q_NULLPTR;
+	// Vertices are converted to float for the GPU: only rotations keep their precision,
+	// large translations (e.g. of heliocentric frames) are projected on the CPU.
+	const Mat4d m = prj->getModelViewTransform()->getApproximateLinearTransfo();
+	if (m[12]!=0. || m[13]!=0. || m[14]!=0.)
+		return Q_NULLPTR;
+	const QByteArray projectorShader = prj->getForwardTransformShader();
+	if (projectorShader.isEmpty())
+		return Q_NULLPTR;
+
+	auto it = gpuPrograms.constFind(projectorShader);
+	if (it==gpuPrograms.constEnd())
+	{
+		ShaderPrograms* programs = new ShaderPrograms();
+		const QByteArray projection = projectorShader +
+			"vec4 projectVertex(vec3 v)\n"
+			"{\n"
+			"    return vec4(projectToViewport(v).xyz, 1.);\n"
+			"}\n";
+		if (!createShaderPrograms(projection, *programs))
+		{
+			qWarning() << "StelPainter: cannot project on the GPU, using the CPU for this projection.";
+			deleteShaderPrograms(*programs);
+			delete programs;
+			programs = Q_NULLPTR;
+		}
+		it = gpuPrograms.insert(projectorShader, programs);
+	}
+	currentGpuPrograms = it.value();
+	return currentGpuPrograms;
+}
+
+void StelPainter::deleteShaderPrograms(ShaderPrograms& programs)
+{
+	delete programs.basic;
+	programs.basic = Q_NULLPTR;
+	delete programs.color;
+	programs.color = Q_NULLPTR;
+	delete programs.textures;
+	programs.textures = Q_NULLPTR;
+	delete programs.texturesColor;
+	programs.texturesColor = Q_NULLPTR;
+}
 
 void StelPainter::deinitGLShaders()
 {
-	delete basicShaderProgram;
-	basicShaderProgram = Q_NULLPTR;
-	delete colorShaderProgram;
-	colorShaderProgram = Q_NULLPTR;
-	delete texturesShaderProgram;
-	texturesShaderProgram = Q_NULLPTR;
-	delete texturesColorShaderProgram;
-	texturesColorShaderProgram = Q_NULLPTR;
+	deleteShaderPrograms(cpuPrograms);
+	for (auto* programs : gpuPrograms)
+	{
+		if (programs)
+		{
+			deleteShaderPrograms(*programs);
+			delete programs;
+		}
+	}
+	gpuPrograms.clear();
+	delete batch;
+	batch = Q_NULLPTR;
+	delete textAtlas;
+	textAtlas = Q_NULLPTR;
 	texCache.clear();
 }
 
@@ -2161,7 +2336,20 @@ void StelPainter::enableClientStates(bool vertex, bool texture, bool color, bool
 void StelPainter::drawFromArray(DrawingMode mode, int count, int offset, bool doProj, const unsigned short* indices)
 {
 	ArrayDesc projectedVertexArray = vertexArray;
-	if (doProj)
+	const ShaderPrograms* programs = &cpuPrograms;
+	const ShaderPrograms* gpu = Q_NULLPTR;
+	if (doProj && !(batch && batching && flagBatching) && vertexArray.size==3 && vertexArray.type==GL_DOUBLE)
+		gpu = getGpuPrograms();
+	if (gpu)
+	{
+		// The vertex shader applies the projection, only convert the vertices to float
+		programs = gpu;
+		if (indices)
+			projectedVertexArray = toFloatArray(vertexArray, 0, count, indices + offset);
+		else
+			projectedVertexArray = toFloatArray(vertexArray, offset, count, Q_NULLPTR);
+	}
+	else if (doProj)
 	{
 		// Project the vertex array using current projection
 		if (indices)
@@ -2170,6 +2358,14 @@ void StelPainter::drawFromArray(DrawingMode mode, int count, int offset, bool do
 			projectedVertexArray = projectArray(vertexArray, offset, count, Q_NULLPTR);
 	}
 
+	if (batch)
+	{
+		if (batching && flagBatching && recordBatch(mode, count, offset, projectedVertexArray, indices))
+			return;
+		// Keep the order with the batched draws.
+		submitBatch();
+	}
+
 	QOpenGLShaderProgram* pr=Q_NULLPTR;
 
 	const Mat4f& m = getProjector()->getProjectionMatrix();
@@ -2178,60 +2374,60 @@ void StelPainter::drawFromArray(DrawingMode mode, int count, int offset, bool do
 	const auto rgbMaxValue=calcRGBMaxValue(ditheringMode);
 	if (!texCoordArray.enabled && !colorArray.enabled && !normalArray.enabled)
 	{
-		pr = basicShaderProgram;
+		pr = programs->basic;
 		pr->bind();
-		pr->setAttributeArray(basicShaderVars.vertex, projectedVertexArray.type, projectedVertexArray.pointer, projectedVertexArray.size);
-		pr->enableAttributeArray(basicShaderVars.vertex);
-		pr->setUniformValue(basicShaderVars.projectionMatrix, qMat);
-		pr->setUniformValue(basicShaderVars.color, currentColor[0], currentColor[1], currentColor[2], currentColor[3]);
+		pr->setAttributeArray(programs->basicVars.vertex, projectedVertexArray.type, projectedVertexArray.pointer, projectedVertexArray.size);
+		pr->enableAttributeArray(programs->basicVars.vertex);
+		pr->setUniformValue(programs->basicVars.projectionMatrix, qMat);
+		pr->setUniformValue(programs->basicVars.color, currentColor[0], currentColor[1], currentColor[2], currentColor[3]);
 	}
 	else if (texCoordArray.enabled && !colorArray.enabled && !normalArray.enabled)
 	{
-		pr = texturesShaderProgram;
+		pr = programs->textures;
 		pr->bind();
-		pr->setAttributeArray(texturesShaderVars.vertex, projectedVertexArray.type, projectedVertexArray.pointer, projectedVertexArray.size);
-		pr->enableAttributeArray(texturesShaderVars.vertex);
-		pr->setUniformValue(texturesShaderVars.projectionMatrix, qMat);
-		pr->setUniformValue(texturesShaderVars.texColor, currentColor[0], currentColor[1], currentColor[2], currentColor[3]);
-		pr->setAttributeArray(texturesShaderVars.texCoord, texCoordArray.type, texCoordArray.pointer, texCoordArray.size);
-		pr->enableAttributeArray(texturesShaderVars.texCoord);
-		//pr->setUniformValue(texturesShaderVars.texture, 0);    // use texture unit 0
+		pr->setAttributeArray(programs->texturesVars.vertex, projectedVertexArray.type, projectedVertexArray.pointer, projectedVertexArray.size);
+		pr->enableAttributeArray(programs->texturesVars.vertex);
+		pr->setUniformValue(programs->texturesVars.projectionMatrix, qMat);
+		pr->setUniformValue(programs->texturesVars.texColor, currentColor[0], currentColor[1], currentColor[2], currentColor[3]);
+		pr->setAttributeArray(programs->texturesVars.texCoord, texCoordArray.type, texCoordArray.pointer, texCoordArray.size);
+		pr->enableAttributeArray(programs->texturesVars.texCoord);
+		//pr->setUniformValue(programs->texturesVars.texture, 0);    // use texture unit 0
 		glActiveTexture(GL_TEXTURE1);
 		if(!bayerPatternTex)
 			bayerPatternTex=makeBayerPatternTexture(*this);
 		glBindTexture(GL_TEXTURE_2D, bayerPatternTex);
-		pr->setUniformValue(texturesShaderVars.bayerPattern, 1);
-		pr->setUniformValue(texturesShaderVars.rgbMaxValue, rgbMaxValue[0], rgbMaxValue[1], rgbMaxValue[2]);
+		pr->setUniformValue(programs->texturesVars.bayerPattern, 1);
+		pr->setUniformValue(programs->texturesVars.rgbMaxValue, rgbMaxValue[0], rgbMaxValue[1], rgbMaxValue[2]);
 	}
 	else if (texCoordArray.enabled && colorArray.enabled && !normalArray.enabled)
 	{
-		pr = texturesColorShaderProgram;
+		pr = programs->texturesColor;
 		pr->bind();
-		pr->setAttributeArray(texturesColorShaderVars.vertex, projectedVertexArray.type, projectedVertexArray.pointer, projectedVertexArray.size);
-		pr->enableAttributeArray(texturesColorShaderVars.vertex);
-		pr->setUniformValue(texturesColorShaderVars.projectionMatrix, qMat);
-		pr->setAttributeArray(texturesColorShaderVars.texCoord, texCoordArray.type, texCoordArray.pointer, texCoordArray.size);
-		pr->enableAttributeArray(texturesColorShaderVars.texCoord);
-		pr->setAttributeArray(texturesColorShaderVars.color, colorArray.type, colorArray.pointer, colorArray.size);
-		pr->enableAttributeArray(texturesColorShaderVars.color);
-		//pr->setUniformValue(texturesShaderVars.texture, 0);    // use texture unit 0
+		pr->setAttributeArray(programs->texturesColorVars.vertex, projectedVertexArray.type, projectedVertexArray.pointer, projectedVertexArray.size);
+		pr->enableAttributeArray(programs->texturesColorVars.vertex);
+		pr->setUniformValue(programs->texturesColorVars.projectionMatrix, qMat);
+		pr->setAttributeArray(programs->texturesColorVars.texCoord, texCoordArray.type, texCoordArray.pointer, texCoordArray.size);
+		pr->enableAttributeArray(programs->texturesColorVars.texCoord);
+		pr->setAttributeArray(programs->texturesColorVars.color, colorArray.type, colorArray.pointer, colorArray.size);
+		pr->enableAttributeArray(programs->texturesColorVars.color);
+		//pr->setUniformValue(programs->texturesVars.texture, 0);    // use texture unit 0
 		glActiveTexture(GL_TEXTURE1);
 		if(!bayerPatternTex)
 			bayerPatternTex=makeBayerPatternTexture(*this);
 		glBindTexture(GL_TEXTURE_2D, bayerPatternTex);
-		pr->setUniformValue(texturesColorShaderVars.bayerPattern, 1);
-		pr->setUniformValue(texturesColorShaderVars.rgbMaxValue, rgbMaxValue[0], rgbMaxValue[1], rgbMaxValue[2]);
-		pr->setUniformValue(texturesColorShaderVars.saturation, saturation);
+		pr->setUniformValue(programs->texturesColorVars.bayerPattern, 1);
+		pr->setUniformValue(programs->texturesColorVars.rgbMaxValue, rgbMaxValue[0], rgbMaxValue[1], rgbMaxValue[2]);
+		pr->setUniformValue(programs->texturesColorVars.saturation, saturation);
 	}
 	else if (!texCoordArray.enabled && colorArray.enabled && !normalArray.enabled)
 	{
-		pr = colorShaderProgram;
+		pr = programs->color;
 		pr->bind();
-		pr->setAttributeArray(colorShaderVars.vertex, projectedVertexArray.type, projectedVertexArray.pointer, projectedVertexArray.size);
-		pr->enableAttributeArray(colorShaderVars.vertex);
-		pr->setUniformValue(colorShaderVars.projectionMatrix, qMat);
-		pr->setAttributeArray(colorShaderVars.color, colorArray.type, colorArray.pointer, colorArray.size);
-		pr->enableAttributeArray(colorShaderVars.color);
+		pr->setAttributeArray(programs->colorVars.vertex, projectedVertexArray.type, projectedVertexArray.pointer, projectedVertexArray.size);
+		pr->enableAttributeArray(programs->colorVars.vertex);
+		pr->setUniformValue(programs->colorVars.projectionMatrix, qMat);
+		pr->setAttributeArray(programs->colorVars.color, colorArray.type, colorArray.pointer, colorArray.size);
+		pr->enableAttributeArray(programs->colorVars.color);
 	}
 	else
 	{
@@ -2239,37 +2435,161 @@ void StelPainter::drawFromArray(DrawingMode mode, int count, int offset, bool do
 		Q_ASSERT(0);
 		return;
 	}
-	
+	if (gpu)
+		prj->setForwardTransformUniforms(*pr);
+
 	if (indices)
 		glDrawElements(mode, count, GL_UNSIGNED_SHORT, indices + offset);
 	else
 		glDrawArrays(mode, offset, count);
+	StelFrameProfiler::count(StelFrameProfiler::DrawCalls);
+	StelFrameProfiler::count(StelFrameProfiler::Vertices, count);
 
-	if (pr==texturesColorShaderProgram)
+	if (pr==programs->texturesColor)
 	{
-		pr->disableAttributeArray(texturesColorShaderVars.texCoord);
-		pr->disableAttributeArray(texturesColorShaderVars.vertex);
-		pr->disableAttributeArray(texturesColorShaderVars.color);
+		pr->disableAttributeArray(programs->texturesColorVars.texCoord);
+		pr->disableAttributeArray(programs->texturesColorVars.vertex);
+		pr->disableAttributeArray(programs->texturesColorVars.color);
 	}
-	else if (pr==texturesShaderProgram)
+	else if (pr==programs->textures)
 	{
-		pr->disableAttributeArray(texturesShaderVars.texCoord);
-		pr->disableAttributeArray(texturesShaderVars.vertex);
+		pr->disableAttributeArray(programs->texturesVars.texCoord);
+		pr->disableAttributeArray(programs->texturesVars.vertex);
 	}
-	else if (pr == basicShaderProgram)
+	else if (pr == programs->basic)
 	{
-		pr->disableAttributeArray(basicShaderVars.vertex);
+		pr->disableAttributeArray(programs->basicVars.vertex);
 	}
-	else if (pr == colorShaderProgram)
+	else if (pr == programs->color)
 	{
-		pr->disableAttributeArray(colorShaderVars.vertex);
-		pr->disableAttributeArray(colorShaderVars.color);
+		pr->disableAttributeArray(programs->colorVars.vertex);
+		pr->disableAttributeArray(programs->colorVars.color);
 	}
 	if (pr)
 		pr->release();
 }
 
 
+bool StelPainter::recordBatch(DrawingMode mode, int count, int offset, const ArrayDesc& projectedVertexArray, const unsigned short* indices)
+{
+	auto isFloatArray = [](const ArrayDesc& array, int minSize, int maxSize) {
+		return (array.type==GL_FLOAT || array.type==GL_DOUBLE) && array.size>=minSize && array.size<=maxSize;
+	};
+	if (normalArray.enabled || !isFloatArray(projectedVertexArray, 2, 3)
+	    || (colorArray.enabled && !isFloatArray(colorArray, 3, 4))
+	    || (texCoordArray.enabled && !isFloatArray(texCoordArray, 2, 2)))
+		return false;
+	if (count<=0)
+		return true;
+
+	StelPainterBatch::State state;
+	state.primitive = StelPainterBatch::getPrimitive(mode);
+	state.textured = texCoordArray.enabled;
+	state.texture = 0;
+	if (state.textured)
+	{
+		GLint unit, texture;
+		glGetIntegerv(GL_ACTIVE_TEXTURE, &unit);
+		if (unit!=GL_TEXTURE0)
+			glActiveTexture(GL_TEXTURE0);
+		glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+		if (unit!=GL_TEXTURE0)
+			glActiveTexture(unit);
+		state.texture = texture;
+	}
+	state.blend = glState.blend;
+	state.blendSrc = glState.blend ? glState.blendSrc : GL_ONE;
+	state.blendDst = glState.blend ? glState.blendDst : GL_ZERO;
+	state.depthTest = glState.depthTest;
+	state.depthMask = glState.depthMask;
+	// Only keep the states which matter for the primitive, so that more draws share a batch.
+	const bool triangles = state.primitive==GL_TRIANGLES;
+	const bool lines = state.primitive==GL_LINES;
+	state.cullFace = triangles && glState.cullFace;
+	state.frontFaceCW = state.cullFace && prj->needGlFrontFaceCW();
+	state.lineSmooth = lines && glState.lineSmooth;
+	state.lineWidth = lines ? glState.lineWidth : 1.f;
+	// The textures shader without vertex colors does not apply saturation.
+	state.saturation = (state.textured && colorArray.enabled) ? saturation : 1.f;
+	state.rgbMaxValue = state.textured ? calcRGBMaxValue(ditheringMode) : Vec3f(0.f);
+	state.viewport = prj->viewportXywh;
+	state.projectionMatrix = prj->getProjectionMatrix();
+
+	auto readElement = [](const ArrayDesc& array, int i) {
+		Vec4f r(0.f, 0.f, 0.f, 1.f);
+		if (array.type==GL_DOUBLE)
+		{
+			const double* p = static_cast<const double*>(array.pointer) + i*array.size;
+			for (int k=0; k<array.size; ++k)
+				r[k] = p[k];
+		}
+		else
+		{
+			const float* p = static_cast<const float*>(array.pointer) + i*array.size;
+			for (int k=0; k<array.size; ++k)
+				r[k] = p[k];
+		}
+		return r;
+	};
+
+	batch->append(state, mode, count, [&](int i) {
+		const int index = indices ? indices[offset+i] : offset+i;
+		StelPainterBatch::Vertex v;
+		const Vec4f pos = readElement(projectedVertexArray, index);
+		v.pos.set(pos[0], pos[1], pos[2]);
+		v.color = colorArray.enabled ? readElement(colorArray, index) : currentColor;
+		if (texCoordArray.enabled)
+		{
+			const Vec4f texCoord = readElement(texCoordArray, index);
+			v.texCoord.set(texCoord[0], texCoord[1]);
+		}
+		else
+			v.texCoord.set(0.f, 0.f);
+		return v;
+	});
+	return true;
+}
+
+void StelPainter::submitBatch()
+{
+	if (!batch || batch->isEmpty())
+		return;
+	QOpenGLFunctions* gl = activePainter ? activePainter->glFuncs() : QOpenGLContext::currentContext()->functions();
+	batch->submit(gl);
+	// Restore the OpenGL state expected by the current painter, or the default state.
+	if (activePainter)
+	{
+		activePainter->glState.apply();
+		activePainter->setProjector(activePainter->prj);
+	}
+	else
+		GLState(gl).apply();
+}
+
+void StelPainter::submitRecorded(StelPainterRecorder& recorder)
+{
+	Q_ASSERT(QOpenGLContext::currentContext() && QThread::currentThread()==QOpenGLContext::currentContext()->thread());
+	if (!batch || recorder.isEmpty())
+		return;
+	batch->takeBatches(recorder.batch);
+}
+
+void StelPainter::submitText()
+{
+	if (!textAtlas || textAtlas->isEmpty())
+		return;
+	// Labels go above the batched draws of the module
+	submitBatch();
+	textAtlas->submit();
+	if (activePainter)
+	{
+		activePainter->glState.apply();
+		activePainter->setProjector(activePainter->prj);
+	}
+	else
+		GLState(QOpenGLContext::currentContext()->functions()).apply();
+}
+
 StelPainter::ArrayDesc StelPainter::projectArray(const StelPainter::ArrayDesc& array, int offset, int count, const unsigned short* indices)
 {
 	// XXX: we should use a more generic way to test whether or not to do the projection.
@@ -2309,3 +2629,30 @@ StelPainter::ArrayDesc StelPainter::projectArray(const StelPainter::ArrayDesc& a
 	return ret;
 }
 
+StelPainter::ArrayDesc StelPainter::toFloatArray(const StelPainter::ArrayDesc& array, int offset, int count, const unsigned short* indices)
+{
+	Q_ASSERT(array.size == 3);
+	Q_ASSERT(array.type == GL_DOUBLE);
+	const Vec3d* vecArray = static_cast<const Vec3d*>(array.pointer);
+
+	// Same cases as projectArray()
+	int n = offset + count;
+	if (indices)
+	{
+		unsigned short max = 0;
+		for (int i = offset; i < offset + count; ++i)
+			max = std::max(max, indices[i]);
+		n = max + 1;
+	}
+	polygonVertexArray.resize(n);
+	for (int i = (indices ? 0 : offset); i < n; ++i)
+		polygonVertexArray[i].set(static_cast<float>(vecArray[i][0]), static_cast<float>(vecArray[i][1]), static_cast<float>(vecArray[i][2]));
+
+	ArrayDesc ret;
+	ret.size = 3;
+	ret.type = GL_FLOAT;
+	ret.pointer = polygonVertexArray.constData();
+	ret.enabled = array.enabled;
+	return ret;
+}
+
@@ -26,10 +26,15 @@
 #include "StelProjectorType.hpp"
 #include "StelProjector.hpp"
 #include <QString>
+#include <QHash>
+#include <QByteArray>
 #include <QVarLengthArray>
 #include <QFontMetrics>
 
 class QOpenGLShaderProgram;
+class StelPainterBatch;
+class StelPainterRecorder;
+class StelTextAtlas;
 
 //! @class StelPainter
 //! Provides functions for performing openGL drawing operations.
@@ -123,6 +128,16 @@ public:
 	//! If rotCenter is equal to 0,0,0, the method draws a great circle.
 	void drawSmallCircleArc(const Vec3d& start, const Vec3d& stop, const Vec3d& rotCenter, void (*viewportEdgeIntersectCallback)(const Vec3d& screenPos, const Vec3d& direction, void* userData)=Q_NULLPTR, void* userData=Q_NULLPTR);
 
+	//! Tessellate a small circle arc like drawSmallCircleArc(), without drawing it.
+	//! This uses no OpenGL nor static data, so it can be called from worker threads with their own buffers.
+	//! @param tessArc buffer for the projected points of the tessellated arc
+	//! @param vertices the window coordinates of the visible strips of the arc
+	//! @param stripEnds the index in vertices after the last vertex of each strip
+	static void tessellateSmallCircleArc(const StelProjectorP& prj, const Vec3d& start, const Vec3d& stop, const Vec3d& rotCenter,
+					     QVector<Vec3d>& tessArc, QVector<Vec2f>& vertices, QVector<int>& stripEnds,
+					     void (*viewportEdgeIntersectCallback)(const Vec3d& screenPos, const Vec3d& direction, void* userData)=Q_NULLPTR,
+					     void* userData=Q_NULLPTR);
+
 	//! Draw a great circle arc between points start and stop.
 	//! The angle between start and stop must be < 180 deg.
 	//! The algorithm ensures that the line will look smooth, even for non linear distortion.
@@ -310,6 +325,30 @@ public:
 	//! enabled arrays.
 	void drawFromArray(DrawingMode mode, int count, int offset=0, bool doProj=true, const unsigned short *indices=Q_NULLPTR);
 
+	//! Enable batching of the draws of this painter in the frame-level command buffer (see StelPainterBatch).
+	//! drawFromArray() then merges the draws with the others having the same state, and the draw calls
+	//! are issued later, at the latest after the draw() of the current module. By default, batching is disabled.
+	void setBatching(bool enable) { batching = enable; }
+	bool getBatching() const { return batching; }
+
+	//! Issue the draw calls of the batched draws.
+	//! StelPainter does this when needed, call it only before drawing with OpenGL directly after batched draws.
+	static void submitBatch();
+
+	//! Move the draws of a recorder to the frame batch, they are drawn with the batched draws of the current module.
+	//! This is the only part of StelPainterRecorder which must run on the thread of the OpenGL context.
+	static void submitRecorded(StelPainterRecorder& recorder);
+
+	//! Draw the labels queued by drawText() in the text atlas (see StelTextAtlas).
+	//! This is done after the draw() of each module, so that the labels are above the rest of the module.
+	static void submitText();
+
+	//! Set the maximum number of recursive subdivisions of the arcs drawn by drawSmallCircleArc() and drawGreatCircleArc().
+	//! Arcs have up to 2^depth segments. Lower values draw faster, with more visible corners at strong distortions.
+	//! @param depth value clamped to [4, 14], default 10 (video/arc_tessellation_depth).
+	static void setTessellationDepth(int depth) { tessellationDepth = qBound(4, depth, 14); }
+	static int getTessellationDepth() { return tessellationDepth; }
+
 	//! Draws the primitives defined in the StelVertexArray.
 	//! @param checkDiscontinuity will check and suppress discontinuities if necessary.
 	void drawStelVertexArray(const StelVertexArray& arr, bool checkDiscontinuity=true);
@@ -317,6 +356,10 @@ public:
 	//! Link an opengl program and show a message in case of error or warnings.
 	//! @return true if the link was successful.
 	static bool linkProg(class QOpenGLShaderProgram* prog, const QString& name);
+	//! Compile and link an opengl program from vertex and fragment shader sources, or load it from the program binary cache.
+	//! Warnings are shown like in linkProg().
+	//! @return true if the program can be used.
+	static bool buildProg(class QOpenGLShaderProgram* prog, const QString& vsrc, const QString& fsrc, const QString& name);
 
 	DitheringMode getDitheringMode() const { return ditheringMode; }
 
@@ -324,6 +367,7 @@ private:
 
 	friend class StelTextureMgr;
 	friend class StelTexture;
+	friend class StelPainterBatch;
 
 	//! Helper struct to track the GL state and restore it to canonical values on StelPainter creation/destruction
 	struct GLState
@@ -361,9 +405,16 @@ private:
 		bool enabled;			// Define whether the array is enabled or not.
 	} ArrayDesc;
 
+	//! Append a draw to the batch of its state.
+	//! @return false if the draw cannot be batched, e.g. because of the array types.
+	bool recordBatch(DrawingMode mode, int count, int offset, const ArrayDesc& projectedVertexArray, const unsigned short* indices);
+
 	//! Project an array using the current projection.
 	//! @return a descriptor of the new array
 	ArrayDesc projectArray(const ArrayDesc& array, int offset, int count, const unsigned short *indices=Q_NULLPTR);
+	//! Convert an array of double vertices to float, for projection in the vertex shader.
+	//! @return a descriptor of the new array
+	ArrayDesc toFloatArray(const ArrayDesc& array, int offset, int count, const unsigned short *indices=Q_NULLPTR);
 
 	//! Project the passed triangle on the screen ensuring that it will look smooth, even for non linear distortion
 	//! by splitting it into subtriangles. The resulting vertex arrays are appended to the passed out* ones.
@@ -385,14 +436,19 @@ private:
 	static QVector<Vec4f> smallCircleColorArray;
 	void drawSmallCircleVertexArray();
 
+	//! Draw the fill of a region from the triangles cached by SphericalRegion::getSubdividedFillVertexArray(),
+	//! with the subdivision level matching maxSqDistortion for the current projector.
+	//! @return false if it must be drawn with projectSphericalTriangle() instead, nothing has been drawn then.
+	bool drawSubdividedRegion(const SphericalRegion* poly, SphericalPolygonDrawMode drawMode, double maxSqDistortion);
+	//! Projected points of the tessellated arc in drawSmallCircleArc(), reused to avoid allocations.
+	static QVector<Vec3d> smallCircleTessArc;
+	//! End of each visible strip of smallCircleVertexArray in drawSmallCircleArc().
+	static QVector<int> smallCircleStripEnds;
+	static int tessellationDepth;
+
 	//! The associated instance of projector
 	StelProjectorP prj;
 
-#ifndef NDEBUG
-	//! Mutex allowing thread safety
-	static class QMutex* globalMutex;
-#endif
-
 	//! The used for text drawing
 	QFont currentFont;
 
@@ -400,18 +456,11 @@ private:
 	//! Saturation effect adjustment.
 	float saturation = 1.f;
 
-	static QOpenGLShaderProgram* basicShaderProgram;
 	struct BasicShaderVars {
 		int projectionMatrix;
 		int color;
 		int vertex;
 	};
-	static BasicShaderVars basicShaderVars;
-
-	static QOpenGLShaderProgram* colorShaderProgram;
-	static BasicShaderVars colorShaderVars;
-
-	static QOpenGLShaderProgram* texturesShaderProgram;
 	struct TexturesShaderVars {
 		int projectionMatrix;
 		int texCoord;
@@ -421,8 +470,6 @@ private:
 		int bayerPattern;
 		int rgbMaxValue;
 	};
-	static TexturesShaderVars texturesShaderVars;
-	static QOpenGLShaderProgram* texturesColorShaderProgram;
 	struct TexturesColorShaderVars {
 		int projectionMatrix;
 		int texCoord;
@@ -433,12 +480,47 @@ private:
 		int rgbMaxValue;
 		int saturation;
 	};
-	static TexturesColorShaderVars texturesColorShaderVars;
+	//! The shader programs used by drawFromArray(), all sharing the same vertex projection.
+	struct ShaderPrograms {
+		QOpenGLShaderProgram* basic = Q_NULLPTR;
+		BasicShaderVars basicVars;
+		QOpenGLShaderProgram* color = Q_NULLPTR;
+		BasicShaderVars colorVars;
+		QOpenGLShaderProgram* textures = Q_NULLPTR;
+		TexturesShaderVars texturesVars;
+		QOpenGLShaderProgram* texturesColor = Q_NULLPTR;
+		TexturesColorShaderVars texturesColorVars;
+	};
+	//! Programs for vertices already projected on the CPU.
+	static ShaderPrograms cpuPrograms;
+	//! Programs projecting the vertices in their vertex shader, by projector shader source.
+	//! A null value means that the programs could not be compiled for this projection.
+	static QHash<QByteArray, ShaderPrograms*> gpuPrograms;
+	//! Whether vertices may be projected on the GPU (video/flag_gpu_projection).
+	static bool flagGpuProjection;
+	//! Compile and link a set of programs. @param projection GLSL defining vec4 projectVertex(vec3 v).
+	//! @return false if one of the programs could not be linked.
+	static bool createShaderPrograms(const QByteArray& projection, ShaderPrograms& programs);
+	static void deleteShaderPrograms(ShaderPrograms& programs);
+	//! Get the programs projecting vertices with the current projector on the GPU.
+	//! @return Q_NULLPTR if it has to be done on the CPU.
+	const ShaderPrograms* getGpuPrograms();
+	const ShaderPrograms* currentGpuPrograms = Q_NULLPTR;
+	bool gpuProgramsChecked = false;
 
 	GLuint bayerPatternTex=0;
 	DitheringMode ditheringMode;
 	static DitheringMode parseDitheringMode(QString const& s);
 
+	//! Draws waiting to be issued, and the painter whose OpenGL state is restored after issuing them.
+	static StelPainterBatch* batch;
+	//! Glyph atlas used by drawText() when available.
+	static StelTextAtlas* textAtlas;
+	static StelPainter* activePainter;
+	//! Whether batching is allowed at all (video/flag_batch_draws).
+	static bool flagBatching;
+	bool batching=false;
+
 	//! The descriptor for the current opengl vertex array
 	ArrayDesc vertexArray;
 	//! The descriptor for the current opengl texture coordinate array
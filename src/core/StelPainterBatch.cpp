@@ -0,0 +1,243 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelPainterBatch.hpp"
+#include "StelPainter.hpp"
+#include "StelFrameProfiler.hpp"
+#include "Dithering.hpp"
+
+#include <QMatrix4x4>
+#include <QOpenGLContext>
+#include <QOpenGLShaderProgram>
+#include <cstring>
+
+static_assert(sizeof(StelPainterBatch::Vertex)==9*sizeof(float), "StelPainterBatch::Vertex must be packed for the vertex buffer");
+
+bool StelPainterBatch::State::operator==(const State& other) const
+{
+	return primitive==other.primitive && textured==other.textured && (!textured || texture==other.texture)
+		&& blend==other.blend && blendSrc==other.blendSrc && blendDst==other.blendDst
+		&& depthTest==other.depthTest && depthMask==other.depthMask
+		&& cullFace==other.cullFace && frontFaceCW==other.frontFaceCW
+		&& lineSmooth==other.lineSmooth && lineWidth==other.lineWidth
+		&& saturation==other.saturation && rgbMaxValue==other.rgbMaxValue
+		&& viewport==other.viewport
+		&& std::memcmp(projectionMatrix.r, other.projectionMatrix.r, sizeof(projectionMatrix.r))==0;
+}
+
+StelPainterBatch::StelPainterBatch()
+	: nBatches(0)
+	, lastBatch(-1)
+	, vertexBuffer(QOpenGLBuffer::VertexBuffer)
+	, vertexBufferSize(0)
+	, bayerPatternTex(0)
+{
+}
+
+StelPainterBatch::~StelPainterBatch()
+{
+	if (bayerPatternTex)
+		QOpenGLContext::currentContext()->functions()->glDeleteTextures(1, &bayerPatternTex);
+	if (vertexBuffer.isCreated())
+		vertexBuffer.destroy();
+}
+
+GLenum StelPainterBatch::getPrimitive(int mode)
+{
+	switch (mode)
+	{
+		case GL_POINTS:
+			return GL_POINTS;
+		case GL_LINES:
+		case GL_LINE_LOOP:
+		case GL_LINE_STRIP:
+			return GL_LINES;
+		default:
+			return GL_TRIANGLES;
+	}
+}
+
+QVector<StelPainterBatch::Vertex>& StelPainterBatch::getVertices(const State& state)
+{
+	// Consecutive draws mostly share their state.
+	if (lastBatch>=0 && batches[lastBatch].state==state)
+		return batches[lastBatch].vertices;
+	for (int i=0; i<nBatches; ++i)
+	{
+		if (batches[i].state==state)
+		{
+			lastBatch = i;
+			return batches[i].vertices;
+		}
+	}
+	if (nBatches==batches.size())
+		batches.append(Batch());
+	Batch& batch = batches[nBatches];
+	batch.state = state;
+	batch.vertices.resize(0);
+	lastBatch = nBatches++;
+	return batch.vertices;
+}
+
+void StelPainterBatch::takeBatches(StelPainterBatch& other)
+{
+	for (int i=0; i<other.nBatches; ++i)
+	{
+		Batch& b = other.batches[i];
+		QVector<Vertex>& vertices = getVertices(b.state);
+		if (vertices.isEmpty())
+			vertices.swap(b.vertices);
+		else
+			vertices += b.vertices;
+		b.vertices.resize(0);
+	}
+	other.nBatches = 0;
+	other.lastBatch = -1;
+}
+
+void StelPainterBatch::submit(QOpenGLFunctions* gl)
+{
+	if (nBatches==0)
+		return;
+
+	int nVertices = 0;
+	for (int i=0; i<nBatches; ++i)
+		nVertices += batches[i].vertices.size();
+
+	if (!vertexBuffer.isCreated())
+	{
+		vertexBuffer.create();
+		vertexBuffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+	}
+	vertexBuffer.bind();
+	// Reallocating also orphans the storage used by the previous frame.
+	vertexBufferSize = qMax(vertexBufferSize, nVertices);
+	vertexBuffer.allocate(vertexBufferSize*static_cast<int>(sizeof(Vertex)));
+	int first = 0;
+	for (int i=0; i<nBatches; ++i)
+	{
+		const QVector<Vertex>& vertices = batches[i].vertices;
+		vertexBuffer.write(first*static_cast<int>(sizeof(Vertex)), vertices.constData(), vertices.size()*static_cast<int>(sizeof(Vertex)));
+		first += vertices.size();
+	}
+
+	const int stride = sizeof(Vertex);
+	const int posOffset = 0;
+	const int colorOffset = 3*sizeof(float);
+	const int texCoordOffset = 7*sizeof(float);
+
+	first = 0;
+	for (int i=0; i<nBatches; ++i)
+	{
+		const State& s = batches[i].state;
+		const int count = batches[i].vertices.size();
+
+		gl->glViewport(s.viewport[0], s.viewport[1], s.viewport[2], s.viewport[3]);
+		gl->glFrontFace(s.frontFaceCW ? GL_CW : GL_CCW);
+		if (s.blend)
+		{
+			gl->glEnable(GL_BLEND);
+			gl->glBlendFunc(s.blendSrc, s.blendDst);
+		}
+		else
+			gl->glDisable(GL_BLEND);
+		if (s.depthTest)
+			gl->glEnable(GL_DEPTH_TEST);
+		else
+			gl->glDisable(GL_DEPTH_TEST);
+		gl->glDepthMask(s.depthMask ? GL_TRUE : GL_FALSE);
+		if (s.cullFace)
+			gl->glEnable(GL_CULL_FACE);
+		else
+			gl->glDisable(GL_CULL_FACE);
+#ifdef GL_LINE_SMOOTH
+		if (!QOpenGLContext::currentContext()->isOpenGLES())
+		{
+			if (s.lineSmooth)
+				gl->glEnable(GL_LINE_SMOOTH);
+			else
+				gl->glDisable(GL_LINE_SMOOTH);
+		}
+#endif
+		gl->glLineWidth(s.lineWidth);
+
+		const Mat4f& m = s.projectionMatrix;
+		const QMatrix4x4 qMat(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
+
+		QOpenGLShaderProgram* pr;
+		int vertexLocation, colorLocation, texCoordLocation=-1;
+		if (s.textured)
+		{
+			pr = StelPainter::cpuPrograms.texturesColor;
+			const StelPainter::TexturesColorShaderVars& vars = StelPainter::cpuPrograms.texturesColorVars;
+			pr->bind();
+			vertexLocation = vars.vertex;
+			colorLocation = vars.color;
+			texCoordLocation = vars.texCoord;
+			pr->setUniformValue(vars.projectionMatrix, qMat);
+			gl->glActiveTexture(GL_TEXTURE1);
+			if (!bayerPatternTex)
+				bayerPatternTex = makeBayerPatternTexture(*gl);
+			gl->glBindTexture(GL_TEXTURE_2D, bayerPatternTex);
+			pr->setUniformValue(vars.bayerPattern, 1);
+			pr->setUniformValue(vars.rgbMaxValue, s.rgbMaxValue[0], s.rgbMaxValue[1], s.rgbMaxValue[2]);
+			pr->setUniformValue(vars.saturation, s.saturation);
+			gl->glActiveTexture(GL_TEXTURE0);
+			gl->glBindTexture(GL_TEXTURE_2D, s.texture);
+		}
+		else
+		{
+			pr = StelPainter::cpuPrograms.color;
+			const StelPainter::BasicShaderVars& vars = StelPainter::cpuPrograms.colorVars;
+			pr->bind();
+			vertexLocation = vars.vertex;
+			colorLocation = vars.color;
+			pr->setUniformValue(vars.projectionMatrix, qMat);
+		}
+
+		pr->setAttributeBuffer(vertexLocation, GL_FLOAT, first*stride+posOffset, 3, stride);
+		pr->enableAttributeArray(vertexLocation);
+		pr->setAttributeBuffer(colorLocation, GL_FLOAT, first*stride+colorOffset, 4, stride);
+		pr->enableAttributeArray(colorLocation);
+		if (s.textured)
+		{
+			pr->setAttributeBuffer(texCoordLocation, GL_FLOAT, first*stride+texCoordOffset, 2, stride);
+			pr->enableAttributeArray(texCoordLocation);
+		}
+
+		gl->glDrawArrays(s.primitive, 0, count);
+		StelFrameProfiler::count(StelFrameProfiler::DrawCalls);
+		StelFrameProfiler::count(StelFrameProfiler::Vertices, count);
+
+		pr->disableAttributeArray(vertexLocation);
+		pr->disableAttributeArray(colorLocation);
+		if (s.textured)
+			pr->disableAttributeArray(texCoordLocation);
+		pr->release();
+
+		first += count;
+	}
+	vertexBuffer.release();
+
+	for (int i=0; i<nBatches; ++i)
+		batches[i].vertices.resize(0);
+	nBatches = 0;
+	lastBatch = -1;
+}
@@ -0,0 +1,178 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef STELPAINTERBATCH_HPP
+#define STELPAINTERBATCH_HPP
+
+#include "StelOpenGL.hpp"
+#include "VecMath.hpp"
+
+#include <QOpenGLBuffer>
+#include <QVector>
+
+//! @class StelPainterBatch
+//! Frame-level command buffer for the draws of StelPainter.
+//! When batching is enabled on a StelPainter (see StelPainter::setBatching()), StelPainter::drawFromArray()
+//! does not issue a draw call but converts the primitives to independent points, lines or triangles,
+//! and appends them to the batch of their state (shader, texture, blending, depth, culling, line and projection
+//! parameters). Uniform colors become vertex colors, so draws in different colors are merged.
+//! submit() uploads the vertices of all the batches to one persistent vertex buffer and issues one draw call per batch.
+//! StelPainter submits the batches before any draw which is not batched, after the draw() of each module
+//! and in StelCore::postDraw(), so that the layering of the modules is kept.
+//! Within a module, batches are drawn in the order in which their state first appeared: modules
+//! should only enable batching when the order between draws with different states does not matter.
+class StelPainterBatch
+{
+public:
+	//! The state of the draws which can be merged in one draw call.
+	struct State
+	{
+		GLenum primitive;		// GL_POINTS, GL_LINES or GL_TRIANGLES
+		bool textured;
+		GLuint texture;			// texture bound on unit 0, if textured
+		bool blend;
+		GLenum blendSrc, blendDst;
+		bool depthTest;
+		bool depthMask;
+		bool cullFace;
+		bool frontFaceCW;
+		bool lineSmooth;
+		float lineWidth;
+		float saturation;
+		Vec3f rgbMaxValue;		// dithering parameter for textured draws
+		Vec4i viewport;
+		Mat4f projectionMatrix;
+
+		bool operator==(const State& other) const;
+	};
+
+	//! One vertex of the buffer.
+	struct Vertex
+	{
+		Vec3f pos;
+		Vec4f color;
+		Vec2f texCoord;
+	};
+
+	StelPainterBatch();
+	//! Requires a valid OpenGL context.
+	~StelPainterBatch();
+
+	//! Return true if no draw is waiting for submit().
+	bool isEmpty() const { return nBatches==0; }
+
+	//! Get the vertex array to which to append the vertices of a draw with the given state.
+	QVector<Vertex>& getVertices(const State& state);
+
+	//! Append a draw to the batch of its state, converted to independent primitives.
+	//! @param mode a StelPainter::DrawingMode. state.primitive must be getPrimitive(mode).
+	//! @param count number of vertices of the draw
+	//! @param vertexAt function returning the Vertex of index i of the draw
+	template<class VertexAt>
+	void append(const State& state, int mode, int count, VertexAt vertexAt);
+
+	//! Move the draws of another batch to the batches of their state in this one.
+	//! The other batch is empty afterwards. This does not need an OpenGL context.
+	void takeBatches(StelPainterBatch& other);
+
+	//! Return the independent primitive to which the draws of a StelPainter::DrawingMode are converted.
+	static GLenum getPrimitive(int mode);
+
+	//! Issue the draw calls of all the batches and empty them.
+	//! This changes the OpenGL state, which the caller has to restore.
+	void submit(QOpenGLFunctions* gl);
+
+private:
+	struct Batch
+	{
+		State state;
+		QVector<Vertex> vertices;
+	};
+
+	//! Batches of the current frame, the first nBatches are used. The others are kept to reuse their memory.
+	QVector<Batch> batches;
+	int nBatches;
+	int lastBatch;
+
+	QOpenGLBuffer vertexBuffer;
+	int vertexBufferSize;
+	GLuint bayerPatternTex;
+};
+
+template<class VertexAt>
+void StelPainterBatch::append(const State& state, int mode, int count, VertexAt vertexAt)
+{
+	Q_ASSERT(state.primitive==getPrimitive(mode));
+	QVector<Vertex>& vertices = getVertices(state);
+	switch (mode)
+	{
+		case GL_POINTS:
+			for (int i=0; i<count; ++i)
+				vertices.append(vertexAt(i));
+			break;
+		case GL_LINES:
+			for (int i=0; i+1<count; i+=2)
+			{
+				vertices.append(vertexAt(i));
+				vertices.append(vertexAt(i+1));
+			}
+			break;
+		case GL_LINE_STRIP:
+		case GL_LINE_LOOP:
+			for (int i=0; i+1<count; ++i)
+			{
+				vertices.append(vertexAt(i));
+				vertices.append(vertexAt(i+1));
+			}
+			if (mode==GL_LINE_LOOP && count>2)
+			{
+				vertices.append(vertexAt(count-1));
+				vertices.append(vertexAt(0));
+			}
+			break;
+		case GL_TRIANGLES:
+			for (int i=0; i+2<count; i+=3)
+			{
+				vertices.append(vertexAt(i));
+				vertices.append(vertexAt(i+1));
+				vertices.append(vertexAt(i+2));
+			}
+			break;
+		case GL_TRIANGLE_STRIP:
+			for (int i=0; i+2<count; ++i)
+			{
+				// Keep the winding of the odd triangles of the strip.
+				vertices.append(vertexAt((i%2) ? i+1 : i));
+				vertices.append(vertexAt((i%2) ? i : i+1));
+				vertices.append(vertexAt(i+2));
+			}
+			break;
+		case GL_TRIANGLE_FAN:
+			for (int i=1; i+1<count; ++i)
+			{
+				vertices.append(vertexAt(0));
+				vertices.append(vertexAt(i));
+				vertices.append(vertexAt(i+1));
+			}
+			break;
+	}
+}
+
+#endif // STELPAINTERBATCH_HPP
@@ -0,0 +1,95 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelPainterRecorder.hpp"
+#include "StelProjector.hpp"
+
+StelPainterRecorder::StelPainterRecorder(const StelProjectorP& proj)
+	: prj(proj)
+	, currentColor(1.f, 1.f, 1.f, 1.f)
+{
+	Q_ASSERT(prj);
+	state.primitive = GL_LINES;
+	state.textured = false;
+	state.texture = 0;
+	state.blend = false;
+	state.blendSrc = GL_ONE;
+	state.blendDst = GL_ZERO;
+	state.depthTest = false;
+	state.depthMask = false;
+	state.cullFace = false;
+	state.frontFaceCW = false;
+	state.lineSmooth = false;
+	state.lineWidth = 1.f;
+	state.saturation = 1.f;
+	state.rgbMaxValue = Vec3f(0.f);
+	state.viewport = prj->getViewport();
+	state.projectionMatrix = prj->getProjectionMatrix();
+}
+
+void StelPainterRecorder::setBlending(bool enableBlending, GLenum blendSrc, GLenum blendDst)
+{
+	state.blend = enableBlending;
+	state.blendSrc = enableBlending ? blendSrc : GL_ONE;
+	state.blendDst = enableBlending ? blendDst : GL_ZERO;
+}
+
+void StelPainterRecorder::drawSmallCircleArc(const Vec3d& start, const Vec3d& stop, const Vec3d& rotCenter,
+					     void (*viewportEdgeIntersectCallback)(const Vec3d& screenPos, const Vec3d& direction, void* userData),
+					     void* userData)
+{
+	StelPainter::tessellateSmallCircleArc(prj, start, stop, rotCenter, tessArc, arcVertices, arcStripEnds,
+					      viewportEdgeIntersectCallback, userData);
+	if (arcStripEnds.isEmpty())
+		return;
+	state.primitive = StelPainterBatch::getPrimitive(StelPainter::LineStrip);
+	const Vec4f color = currentColor;
+	int begin = 0;
+	for (int end : arcStripEnds)
+	{
+		const Vec2f* strip = arcVertices.constData()+begin;
+		batch.append(state, StelPainter::LineStrip, end-begin, [strip, &color](int i) {
+			StelPainterBatch::Vertex v;
+			v.pos.set(strip[i][0], strip[i][1], 0.f);
+			v.color = color;
+			v.texCoord.set(0.f, 0.f);
+			return v;
+		});
+		begin = end;
+	}
+}
+
+void StelPainterRecorder::drawFromArray(StelPainter::DrawingMode mode, int count, const Vec3d* vertices, const Vec4f* colors, bool doProj)
+{
+	if (count<=0)
+		return;
+	state.primitive = StelPainterBatch::getPrimitive(mode);
+	const Vec4f color = currentColor;
+	batch.append(state, mode, count, [&](int i) {
+		StelPainterBatch::Vertex v;
+		Vec3d win = vertices[i];
+		if (doProj)
+			prj->project(vertices[i], win);
+		v.pos.set(win[0], win[1], win[2]);
+		v.color = colors ? colors[i] : color;
+		v.texCoord.set(0.f, 0.f);
+		return v;
+	});
+}
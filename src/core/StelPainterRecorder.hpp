@@ -0,0 +1,92 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef STELPAINTERRECORDER_HPP
+#define STELPAINTERRECORDER_HPP
+
+#include "StelPainter.hpp"
+#include "StelPainterBatch.hpp"
+
+//! @class StelPainterRecorder
+//! Records draws in a StelPainterBatch without calling OpenGL, so that geometry can be prepared on worker threads.
+//! A recorder is used by only one thread at a time, and different recorders can be used in parallel.
+//! The recorded draws are then given to the frame batch with StelPainter::submitRecorded() on the thread of the
+//! OpenGL context, and drawn with the batched draws of the current module.
+//! Only untextured draws without depth test are supported. Like for the batches of StelPainter, the order
+//! between recorded draws with different states is not kept.
+class StelPainterRecorder
+{
+public:
+	//! @param proj the projector used to project the vertices. The viewport and projection matrix
+	//! of the draws are the ones of proj.
+	explicit StelPainterRecorder(const StelProjectorP& proj);
+
+	const StelProjectorP& getProjector() const { return prj; }
+
+	//! Set the color of the next draws.
+	void setColor(float r, float g, float b, float a=1.f) { currentColor.set(r, g, b, a); }
+	void setColor(const Vec4f& rgba) { currentColor = rgba; }
+	Vec4f getColor() const { return currentColor; }
+
+	//! Set the blending of the next draws, disabled by default.
+	void setBlending(bool enableBlending, GLenum blendSrc=GL_SRC_ALPHA, GLenum blendDst=GL_ONE_MINUS_SRC_ALPHA);
+	//! Set the width of the next lines, 1 by default.
+	void setLineWidth(float width) { state.lineWidth = width; }
+	//! Set whether the next lines are antialiased, disabled by default.
+	void setLineSmooth(bool enable) { state.lineSmooth = enable; }
+
+	//! Record a small circle arc, see StelPainter::drawSmallCircleArc().
+	void drawSmallCircleArc(const Vec3d& start, const Vec3d& stop, const Vec3d& rotCenter,
+				void (*viewportEdgeIntersectCallback)(const Vec3d& screenPos, const Vec3d& direction, void* userData)=Q_NULLPTR,
+				void* userData=Q_NULLPTR);
+	//! Record a great circle arc, see StelPainter::drawGreatCircleArc(). No clipping cap is supported.
+	void drawGreatCircleArc(const Vec3d& start, const Vec3d& stop,
+				void (*viewportEdgeIntersectCallback)(const Vec3d& screenPos, const Vec3d& direction, void* userData)=Q_NULLPTR,
+				void* userData=Q_NULLPTR)
+	{
+		drawSmallCircleArc(start, stop, Vec3d(0.), viewportEdgeIntersectCallback, userData);
+	}
+
+	//! Record a draw of vertices in the current color, or in the given vertex colors.
+	//! @param mode the type of primitives
+	//! @param count the number of vertices
+	//! @param vertices points on the sphere if doProj is true, else window coordinates
+	//! @param colors Q_NULLPTR, or the RGBA colors of the vertices
+	//! @param doProj whether the vertices are projected with the projector of the recorder
+	void drawFromArray(StelPainter::DrawingMode mode, int count, const Vec3d* vertices, const Vec4f* colors=Q_NULLPTR, bool doProj=true);
+
+	//! Return true if nothing was recorded since the last StelPainter::submitRecorded().
+	bool isEmpty() const { return batch.isEmpty(); }
+
+private:
+	friend class StelPainter;
+
+	StelProjectorP prj;
+	Vec4f currentColor;
+	StelPainterBatch::State state;
+	StelPainterBatch batch;
+
+	// Buffers of the arc tessellation, kept to avoid allocations.
+	QVector<Vec3d> tessArc;
+	QVector<Vec2f> arcVertices;
+	QVector<int> arcStripEnds;
+};
+
+#endif // STELPAINTERRECORDER_HPP
@@ -0,0 +1,97 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelPerformanceMetrics.hpp"
+#include "StelApp.hpp"
+#include "StelFrameProfiler.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelTextureMgr.hpp"
+#include "HipsMgr.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	//! Frames of the percentiles, 10 s at 60 fps
+	const int FRAME_WINDOW = 600;
+}
+
+StelPerformanceMetrics::StelPerformanceMetrics()
+	: frameTimes(FRAME_WINDOW, 0.f)
+	, nextFrame(0)
+	, recordedFrames(0)
+	, elapsed(0.)
+	, frames(0)
+	, fps(0.)
+	, frameTimeP50(0.)
+	, frameTimeP99(0.)
+	, textureMemory(0)
+	, hipsPendingTiles(0)
+	, satellitesPerSecond(0.)
+{
+	setObjectName("StelPerformanceMetrics");
+}
+
+void StelPerformanceMetrics::update(double frameTime)
+{
+	frameTimes[nextFrame] = static_cast<float>(frameTime);
+	nextFrame = (nextFrame+1) % FRAME_WINDOW;
+	recordedFrames = qMin(recordedFrames+1, FRAME_WINDOW);
+	elapsed += frameTime;
+	++frames;
+	if (elapsed>=1.)
+		publish();
+}
+
+void StelPerformanceMetrics::publish()
+{
+	fps = frames/elapsed;
+
+	QVector<float> sorted = frameTimes.mid(0, recordedFrames);
+	std::sort(sorted.begin(), sorted.end());
+	frameTimeP50 = 1000.*sorted.at((sorted.size()-1)/2);
+	frameTimeP99 = 1000.*sorted.at(qMin(sorted.size()-1, static_cast<int>(0.99*sorted.size())));
+
+	StelApp& app = StelApp::getInstance();
+	const StelFrameProfiler* profiler = app.getFrameProfiler();
+	moduleTimes.clear();
+	const QMap<QString, double> times = profiler->getModuleTimes(frames);
+	for (auto it = times.constBegin(); it != times.constEnd(); ++it)
+		moduleTimes.insert(it.key(), it.value());
+
+	// The satellites of the recorded frames of the last second
+	qint64 propagated = 0;
+	qint64 interval = 0;
+	const QVector<StelFrameProfiler::FrameTimes> recorded = profiler->getRecordedFrames();
+	for (int i=recorded.size()-1; i>=0 && interval<1000000000LL; --i)
+	{
+		propagated += recorded.at(i).counters[StelFrameProfiler::SatellitesPropagated];
+		interval += recorded.at(i).interval;
+	}
+	satellitesPerSecond = interval>0 ? propagated*1e9/interval : 0.;
+
+	textureMemory = app.getTextureManager().getGLMemoryUsage();
+	const HipsMgr* hips = GETSTELMODULE(HipsMgr);
+	hipsPendingTiles = hips ? hips->getPendingTiles() : 0;
+
+	elapsed = 0.;
+	frames = 0;
+	emit updated();
+}
@@ -0,0 +1,91 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STELPERFORMANCEMETRICS_HPP
+#define STELPERFORMANCEMETRICS_HPP
+
+#include <QObject>
+#include <QVariantMap>
+#include <QVector>
+
+//! @class StelPerformanceMetrics
+//! Publishes the live performance of the application as read-only StelProperties, e.g. for the monitoring of
+//! planetarium nodes through the RemoteControl plugin. The values are updated once per second.
+//! The frame times are the intervals between the frames, their percentiles cover the last 600 frames.
+//! The times of the modules and the satellites propagated are measured by StelFrameProfiler: they are only
+//! available while it is enabled (property StelFrameProfiler.enabled, setting devel/flag_frame_profiler).
+class StelPerformanceMetrics : public QObject
+{
+	Q_OBJECT
+	Q_PROPERTY(double fps READ getFps NOTIFY updated)
+	Q_PROPERTY(double frameTimeP50 READ getFrameTimeP50 NOTIFY updated)
+	Q_PROPERTY(double frameTimeP99 READ getFrameTimeP99 NOTIFY updated)
+	Q_PROPERTY(QVariantMap moduleTimes READ getModuleTimes NOTIFY updated)
+	Q_PROPERTY(qint64 textureMemory READ getTextureMemory NOTIFY updated)
+	Q_PROPERTY(int hipsPendingTiles READ getHipsPendingTiles NOTIFY updated)
+	Q_PROPERTY(double satellitesPerSecond READ getSatellitesPerSecond NOTIFY updated)
+
+public:
+	StelPerformanceMetrics();
+
+	//! Record a frame, and publish the metrics when a second has passed since the last time.
+	//! @param frameTime the time since the previous frame [s]
+	void update(double frameTime);
+
+	//! Frames per second during the last second.
+	double getFps() const {return fps;}
+	//! Median frame time [ms]
+	double getFrameTimeP50() const {return frameTimeP50;}
+	//! 99th percentile of the frame times [ms]
+	double getFrameTimeP99() const {return frameTimeP99;}
+	//! Mean CPU time of the update and draw of each module per frame during the last second, e.g. "StarMgr draw" [ms].
+	//! Empty while StelFrameProfiler is disabled.
+	QVariantMap getModuleTimes() const {return moduleTimes;}
+	//! Estimated GPU memory of the textures [bytes], see StelTextureMgr::getGLMemoryUsage()
+	qint64 getTextureMemory() const {return textureMemory;}
+	//! HiPS tiles to draw which are still loading, see HipsMgr::getPendingTiles()
+	int getHipsPendingTiles() const {return hipsPendingTiles;}
+	//! Satellite positions computed per second, 0 while StelFrameProfiler is disabled.
+	double getSatellitesPerSecond() const {return satellitesPerSecond;}
+
+signals:
+	//! Emitted once per second, when the metrics are published.
+	void updated();
+
+private:
+	void publish();
+
+	//! The last frame times, in a ring buffer [s]
+	QVector<float> frameTimes;
+	int nextFrame;
+	int recordedFrames;
+	//! Since the last publication
+	double elapsed;		// [s]
+	int frames;
+
+	double fps;
+	double frameTimeP50;
+	double frameTimeP99;
+	QVariantMap moduleTimes;
+	qint64 textureMemory;
+	int hipsPendingTiles;
+	double satellitesPerSecond;
+};
+
+#endif // STELPERFORMANCEMETRICS_HPP
@@ -0,0 +1,139 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelPickBuffer.hpp"
+#include "StelProjector.hpp"
+
+#include <cmath>
+
+StelPickBuffer::~StelPickBuffer()
+{
+	qDeleteAll(layers);
+}
+
+QVector<Vec3d> StelPickBuffer::computeSignature(const StelProjectorP& prj)
+{
+	static const Vec3d directions[4] = {Vec3d(1.,0.,0.), Vec3d(0.,1.,0.), Vec3d(0.,0.,1.), Vec3d(-0.57735,-0.57735,-0.57735)};
+	QVector<Vec3d> result;
+	for (const auto& v : directions)
+	{
+		Vec3d win;
+		const bool ok = prj->project(v, win);
+		result.append(Vec3d(win[0], win[1], ok ? 1. : 0.));
+	}
+	return result;
+}
+
+StelPickBuffer::Layer* StelPickBuffer::beginLayer(const StelObjectModule* module, const StelProjectorP& prj)
+{
+	Layer*& layer = layers[module];
+	if (!layer)
+		layer = new Layer();
+	// Keep the memory of the previous frame
+	layer->entries.resize(0);
+	layer->gridValid = false;
+	layer->complete = false;
+	layer->signature = computeSignature(prj);
+	layer->viewport = prj->getViewport();
+	return layer;
+}
+
+void StelPickBuffer::setLayerComplete(const StelObjectModule* module)
+{
+	Layer* layer = layers.value(module);
+	if (layer)
+		layer->complete = true;
+}
+
+const StelPickBuffer::Layer* StelPickBuffer::getLayer(const StelObjectModule* module, const StelProjectorP& prj) const
+{
+	const Layer* layer = layers.value(module);
+	if (!layer || !layer->complete || layer->viewport!=prj->getViewport())
+		return Q_NULLPTR;
+	const QVector<Vec3d> signature = computeSignature(prj);
+	for (int i=0; i<signature.size(); ++i)
+	{
+		const Vec3d d = signature.at(i) - layer->signature.at(i);
+		if (d.lengthSquared() > 1e-6)
+			return Q_NULLPTR;
+	}
+	return layer;
+}
+
+void StelPickBuffer::Layer::buildGrid() const
+{
+	nx = qMax(1, viewport[2]/CellSize + 1);
+	ny = qMax(1, viewport[3]/CellSize + 1);
+	cellStart.fill(0, nx*ny+1);
+
+	// Counting sort of the entries by cell
+	QVector<int> cells(entries.size());
+	for (int i=0; i<entries.size(); ++i)
+	{
+		const Entry& e = entries.at(i);
+		const int ix = qBound(0, static_cast<int>(std::floor((e.x-viewport[0])/CellSize)), nx-1);
+		const int iy = qBound(0, static_cast<int>(std::floor((e.y-viewport[1])/CellSize)), ny-1);
+		cells[i] = iy*nx+ix;
+		++cellStart[cells[i]+1];
+	}
+	for (int c=0; c<nx*ny; ++c)
+		cellStart[c+1] += cellStart[c];
+	cellEntries.resize(entries.size());
+	QVector<int> fill(cellStart);
+	for (int i=0; i<entries.size(); ++i)
+		cellEntries[fill[cells[i]]++] = entries.at(i);
+	gridValid = true;
+}
+
+bool StelPickBuffer::Layer::find(float x, float y, float radius, float distanceWeight, float maxPriority, quint64& id, float& value) const
+{
+	if (!gridValid)
+		buildGrid();
+
+	const int ix0 = qBound(0, static_cast<int>(std::floor((x-radius-viewport[0])/CellSize)), nx-1);
+	const int ix1 = qBound(0, static_cast<int>(std::floor((x+radius-viewport[0])/CellSize)), nx-1);
+	const int iy0 = qBound(0, static_cast<int>(std::floor((y-radius-viewport[1])/CellSize)), ny-1);
+	const int iy1 = qBound(0, static_cast<int>(std::floor((y+radius-viewport[1])/CellSize)), ny-1);
+	bool found = false;
+	for (int iy=iy0; iy<=iy1; ++iy)
+	{
+		for (int ix=ix0; ix<=ix1; ++ix)
+		{
+			const int c = iy*nx+ix;
+			for (int i=cellStart.at(c); i<cellStart.at(c+1); ++i)
+			{
+				const Entry& e = cellEntries.at(i);
+				if (e.priority > maxPriority)
+					continue;
+				const float distance = std::sqrt((e.x-x)*(e.x-x) + (e.y-y)*(e.y-y));
+				if (distance > radius)
+					continue;
+				const float v = distance*distanceWeight + e.priority;
+				if (!found || v < value)
+				{
+					found = true;
+					value = v;
+					id = e.id;
+				}
+			}
+		}
+	}
+	return found;
+}
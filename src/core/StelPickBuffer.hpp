@@ -0,0 +1,111 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef STELPICKBUFFER_HPP
+#define STELPICKBUFFER_HPP
+
+#include "StelProjectorType.hpp"
+#include "VecMath.hpp"
+
+#include <QHash>
+#include <QVector>
+
+class StelObjectModule;
+
+//! @class StelPickBuffer
+//! Screen positions of the objects drawn in the last frame, used by StelObjectMgr to find the object
+//! under the mouse without calling StelObjectModule::searchAround().
+//! Each module fills its own layer while drawing: the layer only stores a module-defined 64 bit id
+//! per drawn object, so drawing does not allocate StelObjects. The object is only created with
+//! StelObjectModule::getPickedObject() for the selected id.
+//! A layer is only used when the view did not change since it was filled.
+class StelPickBuffer
+{
+public:
+	class Layer
+	{
+	public:
+		Layer() : complete(false), gridValid(false), nx(0), ny(0) {}
+
+		//! Add an object drawn at the screen position (x, y) of the projector passed to beginLayer().
+		//! @param priority the selection priority, as returned by StelObject::getSelectPriority()
+		void add(float x, float y, float priority, quint64 id)
+		{
+			entries.append({x, y, priority, id});
+			gridValid = false;
+		}
+
+		//! Find the object minimizing distance*distanceWeight+priority inside a circle.
+		//! @param x, y the center of the circle in screen coordinates
+		//! @param radius the radius of the circle in pixels
+		//! @param distanceWeight the weight of the distance in the selection, see StelObjectMgr::setDistanceWeight()
+		//! @param maxPriority objects with a higher priority value are ignored
+		//! @param id set to the id of the found object
+		//! @param value set to the distance*distanceWeight+priority of the found object
+		//! @return false if no object was found
+		bool find(float x, float y, float radius, float distanceWeight, float maxPriority, quint64& id, float& value) const;
+
+	private:
+		friend class StelPickBuffer;
+		struct Entry
+		{
+			float x, y;
+			float priority;
+			quint64 id;
+		};
+
+		//! Sort the entries by grid cell.
+		void buildGrid() const;
+
+		//! Screen positions of reference directions, which change with the view.
+		QVector<Vec3d> signature;
+		Vec4i viewport;
+		bool complete;
+		QVector<Entry> entries;
+
+		//! Entries sorted by cell, and index of the first entry of each cell.
+		mutable QVector<Entry> cellEntries;
+		mutable QVector<int> cellStart;
+		mutable bool gridValid;
+		mutable int nx, ny;
+	};
+
+	StelPickBuffer() {}
+	~StelPickBuffer();
+
+	//! Start to fill the layer of a module for a new frame. The previous content of the layer is discarded.
+	//! @param prj the projector for which the screen positions of the objects will be given
+	//! @return the layer to fill. It is used for picking only after setLayerComplete() was called.
+	Layer* beginLayer(const StelObjectModule* module, const StelProjectorP& prj);
+	//! Mark a layer as containing all the objects the module would return from searchAround().
+	void setLayerComplete(const StelObjectModule* module);
+	//! Get the complete layer of a module filled for the same view as prj, or Q_NULLPTR.
+	const Layer* getLayer(const StelObjectModule* module, const StelProjectorP& prj) const;
+
+	//! Size of the cells of the grid, in pixels.
+	static const int CellSize = 32;
+
+private:
+	static QVector<Vec3d> computeSignature(const StelProjectorP& prj);
+
+	QHash<const StelObjectModule*, Layer*> layers;
+};
+
+#endif // STELPICKBUFFER_HPP
@@ -0,0 +1,222 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelProgramCache.hpp"
+#include "StelApp.hpp"
+#include "StelFileMgr.hpp"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QSettings>
+#include <stdexcept>
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+
+namespace
+{
+	typedef void (QOPENGLF_APIENTRYP GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+	typedef void (QOPENGLF_APIENTRYP ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+	typedef void (QOPENGLF_APIENTRYP ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+
+	const quint32 CACHE_MAGIC = 0x53504243; // "SPBC"
+
+	//! The entry points for the current context, resolved on first use
+	struct ProgramBinaryFuncs
+	{
+		QOpenGLContext* context;
+		bool available;
+		GetProgramBinaryProc getProgramBinary;
+		ProgramBinaryProc programBinary;
+		ProgramParameteriProc programParameteri;
+		QByteArray driverKey;
+	};
+
+	ProgramBinaryFuncs& getFuncs()
+	{
+		static ProgramBinaryFuncs funcs = { Q_NULLPTR, false, Q_NULLPTR, Q_NULLPTR, Q_NULLPTR, QByteArray() };
+		QOpenGLContext* ctx = QOpenGLContext::currentContext();
+		if(funcs.context == ctx)
+			return funcs;
+
+		funcs.context = ctx;
+		funcs.available = false;
+		funcs.getProgramBinary = Q_NULLPTR;
+		funcs.programBinary = Q_NULLPTR;
+		funcs.programParameteri = Q_NULLPTR;
+		if(!ctx)
+			return funcs;
+
+		QSettings* conf = StelApp::getInstance().getSettings();
+		if(conf && !conf->value("video/flag_program_binary_cache", true).toBool())
+			return funcs;
+
+		const QSurfaceFormat format = ctx->format();
+		const bool core41 = format.version() >= qMakePair(ctx->isOpenGLES() ? 3 : 4, ctx->isOpenGLES() ? 0 : 1);
+		if(core41 || ctx->hasExtension("GL_ARB_get_program_binary"))
+		{
+			funcs.getProgramBinary = reinterpret_cast<GetProgramBinaryProc>(ctx->getProcAddress("glGetProgramBinary"));
+			funcs.programBinary = reinterpret_cast<ProgramBinaryProc>(ctx->getProcAddress("glProgramBinary"));
+			funcs.programParameteri = reinterpret_cast<ProgramParameteriProc>(ctx->getProcAddress("glProgramParameteri"));
+		}
+		else if(ctx->hasExtension("GL_OES_get_program_binary"))
+		{
+			funcs.getProgramBinary = reinterpret_cast<GetProgramBinaryProc>(ctx->getProcAddress("glGetProgramBinaryOES"));
+			funcs.programBinary = reinterpret_cast<ProgramBinaryProc>(ctx->getProcAddress("glProgramBinaryOES"));
+		}
+
+		if(funcs.getProgramBinary && funcs.programBinary)
+		{
+			//some drivers expose the functions, but do not support any format
+			GLint formatCount = 0;
+			ctx->functions()->glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+			funcs.available = formatCount > 0;
+		}
+
+		if(funcs.available)
+		{
+			QOpenGLFunctions* gl = ctx->functions();
+			funcs.driverKey = QByteArray(reinterpret_cast<const char*>(gl->glGetString(GL_VENDOR))) + '\n'
+					+ QByteArray(reinterpret_cast<const char*>(gl->glGetString(GL_RENDERER))) + '\n'
+					+ QByteArray(reinterpret_cast<const char*>(gl->glGetString(GL_VERSION))) + '\n';
+		}
+		qDebug() << "OpenGL program binary cache" << (funcs.available ? "enabled" : "not available");
+		return funcs;
+	}
+}
+
+bool StelProgramCache::isAvailable()
+{
+	return getFuncs().available;
+}
+
+QString StelProgramCache::getCacheFile(const QByteArray &key)
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(getFuncs().driverKey);
+	hash.addData(key);
+	return QDir(StelFileMgr::getCacheDir()).filePath("programs/" + QString::fromLatin1(hash.result().toHex()) + ".bin");
+}
+
+bool StelProgramCache::loadProgram(QOpenGLShaderProgram &program, const QByteArray &key)
+{
+	ProgramBinaryFuncs& funcs = getFuncs();
+	if(!funcs.available)
+		return false;
+
+	const QString fileName = getCacheFile(key);
+	QFile file(fileName);
+	if(!file.open(QIODevice::ReadOnly))
+		return false;
+
+	QDataStream in(&file);
+	in.setVersion(QDataStream::Qt_5_4);
+	quint32 magic, format;
+	QByteArray binary;
+	in >> magic >> format >> binary;
+	file.close();
+	if(in.status() != QDataStream::Ok || magic != CACHE_MAGIC || binary.isEmpty())
+	{
+		QFile::remove(fileName);
+		return false;
+	}
+
+	if(!program.create())
+		return false;
+	funcs.programBinary(program.programId(), format, binary.constData(), binary.size());
+	//without attached shaders, QOpenGLShaderProgram::link() only checks the link status of the binary
+	if(!program.link())
+	{
+		//the driver rejected it, e.g. after an update with an unchanged version string
+		qDebug() << "Cached program binary was rejected by the driver, recompiling";
+		QFile::remove(fileName);
+		return false;
+	}
+	return true;
+}
+
+void StelProgramCache::prepareProgram(QOpenGLShaderProgram &program)
+{
+	ProgramBinaryFuncs& funcs = getFuncs();
+	if(funcs.available && funcs.programParameteri && program.create())
+		funcs.programParameteri(program.programId(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void StelProgramCache::saveProgram(QOpenGLShaderProgram &program, const QByteArray &key)
+{
+	ProgramBinaryFuncs& funcs = getFuncs();
+	if(!funcs.available || !program.isLinked())
+		return;
+
+	GLint length = 0;
+	QOpenGLContext::currentContext()->functions()->glGetProgramiv(program.programId(), GL_PROGRAM_BINARY_LENGTH, &length);
+	if(length <= 0)
+		return;
+
+	QByteArray binary(length, Qt::Uninitialized);
+	GLenum format = 0;
+	GLsizei written = 0;
+	funcs.getProgramBinary(program.programId(), length, &written, &format, binary.data());
+	if(written <= 0)
+		return;
+	binary.resize(written);
+
+	const QString fileName = getCacheFile(key);
+	try
+	{
+		StelFileMgr::makeSureDirExistsAndIsWritable(QFileInfo(fileName).absolutePath());
+	}
+	catch (std::runtime_error& e)
+	{
+		qWarning() << "Cannot create program binary cache directory:" << e.what();
+		return;
+	}
+
+	//write to a temporary file first, so that an interrupted write never leaves a broken entry
+	const QString tmpName = fileName + ".tmp";
+	QFile file(tmpName);
+	if(!file.open(QIODevice::WriteOnly))
+		return;
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_5_4);
+	out << CACHE_MAGIC << static_cast<quint32>(format) << binary;
+	file.close();
+	if(out.status() != QDataStream::Ok)
+	{
+		QFile::remove(tmpName);
+		return;
+	}
+	QFile::remove(fileName);
+	QFile::rename(tmpName, fileName);
+}
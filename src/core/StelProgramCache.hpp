@@ -0,0 +1,58 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef STELPROGRAMCACHE_HPP
+#define STELPROGRAMCACHE_HPP
+
+#include <QByteArray>
+
+class QOpenGLShaderProgram;
+
+//! @class StelProgramCache
+//! A persistent cache of linked OpenGL program binaries (glGetProgramBinary), stored in the cache directory.
+//! Entries are keyed by the GL vendor, renderer and version strings together with a hash of all sources,
+//! so a driver update simply results in cache misses. If the driver rejects a binary, it is removed
+//! and the caller compiles from source as usual.
+//! The cache can be disabled with the setting video/flag_program_binary_cache.
+//! All methods require a valid current OpenGL context.
+class StelProgramCache
+{
+public:
+	//! Returns true if the current context supports program binaries and the cache is enabled.
+	static bool isAvailable();
+
+	//! Tries to load a linked program from the cache.
+	//! @param program a program without shaders, which is linked from the binary on success
+	//! @param key all sources of the program and anything else influencing the link, e.g. attribute bindings
+	//! @return true if program is linked and can be used, false if it must be compiled from source
+	static bool loadProgram(QOpenGLShaderProgram& program, const QByteArray& key);
+
+	//! Requests that the driver keeps the binary of the program retrievable. Call this before linking.
+	static void prepareProgram(QOpenGLShaderProgram& program);
+
+	//! Stores the binary of a linked program in the cache.
+	//! @param key the same key as used for loadProgram
+	static void saveProgram(QOpenGLShaderProgram& program, const QByteArray& key);
+
+private:
+	static QString getCacheFile(const QByteArray& key);
+};
+
+#endif // STELPROGRAMCACHE_HPP
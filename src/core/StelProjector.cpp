@@ -24,8 +24,12 @@
 #include "StelProjectorClasses.hpp"
 
 #include <QDebug>
+#include <QMatrix4x4>
+#include <QOpenGLShaderProgram>
 #include <QString>
 
+#include <cmath>
+
 StelProjector::Mat4dTransform::Mat4dTransform(const Mat4d& m)
     : transfoMat(m),
       transfoMatf(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8], m[9], m[10], m[11], m[12], m[13], m[14], m[15])
@@ -55,6 +59,20 @@ void StelProjector::Mat4dTransform::forward(Vec3f& v) const
 	v.transfo4d(transfoMatf);
 }
 
+void StelProjector::Mat4dTransform::forwardBatch(Vec3f* v, int n) const
+{
+	const float* m = transfoMatf.r;
+	for (int i = 0; i < n; ++i)
+	{
+		const float x = v[i][0];
+		const float y = v[i][1];
+		const float z = v[i][2];
+		v[i][0] = m[0]*x + m[4]*y + m[8]*z + m[12];
+		v[i][1] = m[1]*x + m[5]*y + m[9]*z + m[13];
+		v[i][2] = m[2]*x + m[6]*y + m[10]*z + m[14];
+	}
+}
+
 void StelProjector::Mat4dTransform::backward(Vec3f& v) const
 {
 	// We need no matrix inversion because we always work with orthogonal matrices (where the transposed is the inverse).
@@ -123,6 +141,7 @@ void StelProjector::init(const StelProjectorParams& params)
 	viewportFovDiameter = params.viewportFovDiameter * devicePixelsPerPixel;
 	pixelPerRad = 0.5f * viewportFovDiameter / fovToViewScalingFactor(params.fov*(M_PI/360.f));
 	widthStretch = params.widthStretch;
+	visibleDiskRadius = params.visibleDiskRadius * devicePixelsPerPixel;
 	computeBoundingCap();
 }
 
@@ -199,6 +218,14 @@ int StelProjector::getViewportHeight() const
 *************************************************************************/
 SphericalRegionP StelProjector::getViewportConvexPolygon(float marginX, float marginY) const
 {
+	if (visibleDiskRadius > 0.f)
+	{
+		// Only the disk is visible, its cap is smaller than the polygon of the viewport
+		SphericalCap cap;
+		if (computeVisibleDiskCap(visibleDiskRadius + qMax(marginX, marginY), cap))
+			return SphericalRegionP(new SphericalCap(cap));
+	}
+
 	Vec3d e0, e1, e2, e3;
 	const Vec4i& vp = viewportXywh;
 	bool ok = unProject(vp[0]-marginX,vp[1]-marginY,e0);
@@ -245,6 +272,42 @@ const SphericalCap& StelProjector::getBoundingCap() const
 	return boundingCap;
 }
 
+bool StelProjector::checkInVisibleDisk(const Vec3d& pos, float margin) const
+{
+	if (visibleDiskRadius <= 0.f)
+		return true;
+	const double dx = pos[0] - (viewportXywh[0] + 0.5 * viewportXywh[2]);
+	const double dy = pos[1] - (viewportXywh[1] + 0.5 * viewportXywh[3]);
+	const double r = visibleDiskRadius + margin;
+	return dx*dx + dy*dy <= r*r;
+}
+
+bool StelProjector::computeVisibleDiskCap(float radius, SphericalCap& cap) const
+{
+	const Vec4i& vp = viewportXywh;
+	if (2.f*radius >= qMin(vp[2], vp[3]))
+		return false;
+	const float cx = vp[0]+0.5f*vp[2];
+	const float cy = vp[1]+0.5f*vp[3];
+	if (!unProject(cx, cy, cap.n))
+		return false;
+	cap.n.normalize();
+	// The projections are radially symmetric around their center, so a few points of the rim are enough
+	// (the center of the viewport is only offset from it in cylindrical projections, which don't need to be exact here)
+	cap.d = 1.;
+	static const int RIM_POINTS = 8;
+	for (int i=0; i<RIM_POINTS; ++i)
+	{
+		const float a = 2.f*M_PI*i/RIM_POINTS;
+		Vec3d e;
+		if (!unProject(cx + radius*std::cos(a), cy + radius*std::sin(a), e))
+			return false;
+		e.normalize();
+		cap.d = qMin(cap.d, cap.n*e);
+	}
+	return true;
+}
+
 float StelProjector::getPixelPerRadAtCenter() const
 {
 	return pixelPerRad;
@@ -333,6 +396,15 @@ void StelProjector::project(int n, const Vec3f* in, Vec3f* out)
 	}
 }
 
+void StelProjector::projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const
+{
+	for (int i = 0; i < n; ++i)
+	{
+		out[i] = in[i];
+		mask[i] = projectInPlace(out[i]);
+	}
+}
+
 bool StelProjector::projectInPlace(Vec3d& vd) const
 {
 	modelViewTransform->forward(vd);
@@ -440,6 +512,13 @@ void StelProjector::computeBoundingCap()
 	if (boundingCap.d > h)
 		boundingCap.d=h;
 
+	if (visibleDiskRadius > 0.f)
+	{
+		// Both caps contain the visible region and have the same center, use the smaller one
+		SphericalCap diskCap;
+		if (computeVisibleDiskCap(visibleDiskRadius, diskCap) && diskCap.d > boundingCap.d)
+			boundingCap.d = diskCap.d;
+	}
 }
 
 /*************************************************************************
@@ -478,6 +557,63 @@ Mat4f StelProjector::getProjectionMatrix() const
 	return Mat4f(2.f/viewportXywh[2], 0, 0, 0, 0, 2.f/viewportXywh[3], 0, 0, 0, 0, -1., 0., -(2.f*viewportXywh[0] + viewportXywh[2])/viewportXywh[2], -(2.f*viewportXywh[1] + viewportXywh[3])/viewportXywh[3], 0, 1);
 }
 
+QByteArray StelProjector::getForwardTransformShader() const
+{
+	// Only linear model view transformations can be evaluated as a matrix on the GPU
+	if (!dynamic_cast<const Mat4dTransform*>(modelViewTransform.data()))
+		return QByteArray();
+	const QByteArray forwardFunction = getForwardShaderFunction();
+	if (forwardFunction.isEmpty())
+		return QByteArray();
+
+	return QByteArray(
+		"uniform highp mat4 PROJECTOR_modelView;\n"
+		"uniform highp vec2 PROJECTOR_viewportCenter;\n"
+		"uniform highp vec2 PROJECTOR_scale;\n"
+		"uniform highp vec2 PROJECTOR_depth;\n"
+		"uniform highp float PROJECTOR_widthStretch;\n")
+		+ forwardFunction +
+		"vec4 projectToViewport(vec3 v)\n"
+		"{\n"
+		"    vec4 p = projectorForward((PROJECTOR_modelView*vec4(v, 1.0)).xyz);\n"
+		"    return vec4(PROJECTOR_viewportCenter + PROJECTOR_scale*p.xy, (p.z - PROJECTOR_depth.x)*PROJECTOR_depth.y, p.w);\n"
+		"}\n";
+}
+
+QByteArray StelProjector::getBackwardTransformShader() const
+{
+	if (!dynamic_cast<const Mat4dTransform*>(modelViewTransform.data()))
+		return QByteArray();
+	const QByteArray backwardFunction = getBackwardShaderFunction();
+	if (backwardFunction.isEmpty())
+		return QByteArray();
+
+	return QByteArray(
+		"uniform highp mat4 PROJECTOR_modelView;\n"
+		"uniform highp vec2 PROJECTOR_viewportCenter;\n"
+		"uniform highp vec2 PROJECTOR_scale;\n"
+		"uniform highp vec2 PROJECTOR_depth;\n"
+		"uniform highp float PROJECTOR_widthStretch;\n")
+		+ backwardFunction +
+		"vec3 unprojectFromViewport(vec2 win)\n"
+		"{\n"
+		"    vec3 v = projectorBackward((win - PROJECTOR_viewportCenter)/PROJECTOR_scale) - PROJECTOR_modelView[3].xyz;\n"
+		"    // The model view matrix is orthogonal: multiply by its transpose\n"
+		"    return v*mat3(PROJECTOR_modelView[0].xyz, PROJECTOR_modelView[1].xyz, PROJECTOR_modelView[2].xyz);\n"
+		"}\n";
+}
+
+void StelProjector::setForwardTransformUniforms(QOpenGLShaderProgram& program) const
+{
+	const Mat4d m = modelViewTransform->getApproximateLinearTransfo();
+	const QMatrix4x4 qMat(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
+	program.setUniformValue("PROJECTOR_modelView", qMat);
+	program.setUniformValue("PROJECTOR_viewportCenter", viewportCenter[0], viewportCenter[1]);
+	program.setUniformValue("PROJECTOR_scale", flipHorz*pixelPerRad, flipVert*pixelPerRad);
+	program.setUniformValue("PROJECTOR_depth", zNear, oneOverZNearMinusZFar);
+	program.setUniformValue("PROJECTOR_widthStretch", widthStretch);
+}
+
 StelProjector::StelProjectorMaskType StelProjector::getMaskType(void) const
 {
 	return maskType;
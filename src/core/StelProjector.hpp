@@ -25,6 +25,10 @@
 #include "VecMath.hpp"
 #include "StelSphereGeometry.hpp"
 
+#include <QByteArray>
+
+#include <algorithm>
+
 //! @class StelProjector
 //! Provide the main interface to all operations of projecting coordinates from sky to screen.
 //! The StelProjector also defines the viewport size and position.
@@ -39,6 +43,7 @@ class StelProjector
 public:
 	friend class StelPainter;
 	friend class StelCore;
+	friend class TestStelProjector;
 
 	class ModelViewTranform;
 	//! @typedef ModelViewTranformP
@@ -56,6 +61,13 @@ public:
 		virtual void backward(Vec3d&) const =0;
 		virtual void forward(Vec3f&) const =0;
 		virtual void backward(Vec3f&) const =0;
+		//! Apply forward() in place to an array of n vectors.
+		//! Reimplement it to avoid one virtual call per vector in batch projections.
+		virtual void forwardBatch(Vec3f* v, int n) const
+		{
+			for (int i = 0; i < n; ++i)
+				forward(v[i]);
+		}
 
 		virtual void combine(const Mat4d&)=0;
 		virtual ModelViewTranformP clone() const=0;
@@ -71,6 +83,7 @@ public:
         void backward(Vec3d& v) const;
         void forward(Vec3f& v) const;
         void backward(Vec3f& v) const;
+        void forwardBatch(Vec3f* v, int n) const;
         void combine(const Mat4d& m);
         Mat4d getApproximateLinearTransfo() const;
         ModelViewTranformP clone() const;
@@ -107,7 +120,8 @@ public:
 			, flipHorz(false)
 			, flipVert(false)
 			, devicePixelsPerPixel(1.f)
-			, widthStretch(1.f) {;}
+			, widthStretch(1.f)
+			, visibleDiskRadius(0.f) {;}
 
 		Vector4<int> viewportXywh;       //! posX, posY, width, height
 		float fov;                       //! FOV in degrees
@@ -122,6 +136,7 @@ public:
 		bool flipHorz, flipVert;         //! Whether to flip in horizontal or vertical directions
 		float devicePixelsPerPixel;      //! The number of device pixel per "Device Independent Pixels" (value is usually 1, but 2 for mac retina screens)
 		float widthStretch;              //! A factor to adapt to special installation setups, e.g. multi-projector with edge blending. Allow to stretch/squeeze projected content. Larger than 1 means the image is stretched wider.
+		float visibleDiskRadius;         //! radius in pixel of a disk around the center of the viewport outside of which the sky is hidden (e.g. by the Oculars mask), or 0 if the whole viewport is visible
 	};
 
 	//! Destructor
@@ -191,9 +206,16 @@ public:
 	//! represented by a convex polygon (e.g. if aperture > 180 deg).
 	SphericalRegionP getViewportConvexPolygon(float marginX=0., float marginY=0.) const;
 
-	//! Return a SphericalCap containing the whole viewport
+	//! Return a SphericalCap containing the whole viewport, or only the visible disk if it is set and fits into the viewport
 	const SphericalCap& getBoundingCap() const;
 
+	//! Get the radius in pixel of the visible disk around the center of the viewport, or 0 if the whole viewport is visible.
+	//! Objects outside of this disk don't need to be drawn, see StelCore::setVisibleDiskRadius().
+	float getVisibleDiskRadius() const {return visibleDiskRadius;}
+	//! Check to see if a 2d position is inside the visible disk, always true if none is set.
+	//! @param margin an extra margin in pixel which extends the disk, e.g. the screen size of the object
+	bool checkInVisibleDisk(const Vec3d& pos, float margin=0.f) const;
+
 	//! Get size of a radian in pixels at the center of the viewport disk
 	float getPixelPerRadAtCenter() const;
 
@@ -233,6 +255,15 @@ public:
 
 	virtual void project(int n, const Vec3f* in, Vec3f* out);
 
+	//! Project n vectors from the current frame into the viewport at once.
+	//! This is equivalent to calling project() for each vector, but the projection
+	//! classes implement it without virtual calls per vector, in loops the compiler can vectorize.
+	//! @param in the vectors in the current frame.
+	//! @param n the number of vectors.
+	//! @param out the projected vectors in the viewport 2D frame. May be the same array as in.
+	//! @param mask for each vector, set to true if the projected coordinate is valid.
+	virtual void projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const;
+
 	//! Project the vector v from the current frame into the viewport.
 	//! @param vd the vector in the current frame.
 	//! @return true if the projected coordinate is valid.
@@ -276,6 +307,27 @@ public:
 	//! Get the current projection matrix.
 	Mat4f getProjectionMatrix() const;
 
+	//! Get GLSL source code which implements the full projection of this instance on the GPU.
+	//! It defines the function <tt>vec4 projectToViewport(vec3 v)</tt>, which returns the same values as
+	//! projectInPlace() in xyz, and 1 in w if the projected coordinate is valid, 0 otherwise.
+	//! The uniforms it uses must be set with setForwardTransformUniforms() after linking.
+	//! @return the source code, or an empty array if this projection type or its model view
+	//! transformation cannot be evaluated on the GPU.
+	QByteArray getForwardTransformShader() const;
+
+	//! Set the uniforms used by the code returned by getForwardTransformShader() or getBackwardTransformShader().
+	//! @param program a bound shader program which was linked with this code.
+	void setForwardTransformUniforms(class QOpenGLShaderProgram& program) const;
+
+	//! Get GLSL source code which implements unProject() on the GPU.
+	//! It defines the function <tt>vec3 unprojectFromViewport(vec2 win)</tt>, which returns the direction seen at a
+	//! window position. Like unProject(), it also returns a direction for positions outside of the projected area.
+	//! It declares the same uniforms as getForwardTransformShader(), so only one of them can be used in a shader.
+	//! The uniforms must be set with setForwardTransformUniforms() after linking.
+	//! @return the source code, or an empty array if this projection type or its model view
+	//! transformation cannot be evaluated on the GPU.
+	QByteArray getBackwardTransformShader() const;
+
 	///////////////////////////////////////////////////////////////////////////
 	//! Get a string description of a StelProjectorMaskType.
 	static const QString maskTypeToString(StelProjectorMaskType type);
@@ -313,6 +365,38 @@ protected:
 
 	//! Initialize the bounding cap.
 	virtual void computeBoundingCap();
+	//! Compute the cap around the center of the viewport containing the disk of the given radius in pixel.
+	//! @return false if the disk doesn't fit into the viewport or some of its points can't be unprojected
+	bool computeVisibleDiskCap(float radius, SphericalCap& cap) const;
+
+	//! Get the GLSL source of <tt>vec4 projectorForward(vec3 v)</tt>, the GPU equivalent of forward().
+	//! It returns the transformed vector in xyz, and 1 in w if the transformation is valid, 0 otherwise.
+	//! It may use the uniform PROJECTOR_widthStretch. Projection types without a GPU implementation return an empty array.
+	virtual QByteArray getForwardShaderFunction() const {return QByteArray();}
+
+	//! Get the GLSL source of <tt>vec3 projectorBackward(vec2 v)</tt>, the GPU equivalent of backward().
+	//! It may use the uniform PROJECTOR_widthStretch. Projection types without a GPU implementation return an empty array.
+	virtual QByteArray getBackwardShaderFunction() const {return QByteArray();}
+
+	//! Implementation of projectBatch() for the projection class Proj.
+	//! Proj::forward() is called non-virtually so that it can be inlined into the loop.
+	template <class Proj> void projectBatchImpl(const Vec3f* in, int n, Vec3f* out, bool* mask) const
+	{
+		if (out != in)
+			std::copy(in, in + n, out);
+		modelViewTransform->forwardBatch(out, n);
+		const Proj* prj = static_cast<const Proj*>(this);
+		for (int i = 0; i < n; ++i)
+			mask[i] = prj->Proj::forward(out[i]);
+		const float sx = flipHorz * pixelPerRad;
+		const float sy = flipVert * pixelPerRad;
+		for (int i = 0; i < n; ++i)
+		{
+			out[i][0] = viewportCenter[0] + sx * out[i][0];
+			out[i][1] = viewportCenter[1] + sy * out[i][1];
+			out[i][2] = (out[i][2] - zNear) * oneOverZNearMinusZFar;
+		}
+	}
 
 	ModelViewTranformP modelViewTransform;	// Operator to apply (if not Q_NULLPTR) before the modelview projection step
 
@@ -330,6 +414,7 @@ protected:
 	SphericalCap boundingCap;           // Bounding cap of the whole viewport
 	float devicePixelsPerPixel;         // The number of device pixel per "Device Independent Pixels" (value is usually 1, but 2 for mac retina screens)
 	float widthStretch;                 // A factor to adapt to special installation setups, e.g. multi-projector with edge blending. Allow to stretch/squeeze projected content. Larger than 1 means the image is stretched wider.
+	float visibleDiskRadius;            // radius of the visible disk in pixel, or 0 for the whole viewport
 private:
 	//! Initialise the StelProjector from a param instance.
 	void init(const StelProjectorParams& param);
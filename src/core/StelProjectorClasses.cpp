@@ -53,6 +53,36 @@ bool StelProjectorPerspective::forward(Vec3f &v) const
 	return false;
 }
 
+void StelProjectorPerspective::projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const
+{
+	projectBatchImpl<StelProjectorPerspective>(in, n, out, mask);
+}
+
+QByteArray StelProjectorPerspective::getForwardShaderFunction() const
+{
+	return QByteArray(
+		"vec4 projectorForward(vec3 v)\n"
+		"{\n"
+		"    float r = length(v);\n"
+		"    if (v.z < 0.0)\n"
+		"        return vec4(-v.x*PROJECTOR_widthStretch/v.z, -v.y/v.z, r, 1.0);\n"
+		"    if (v.z > 0.0)\n"
+		"        return vec4(v.x*PROJECTOR_widthStretch/v.z, v.y/v.z, -1.0e10, 0.0);\n"
+		"    return vec4(1.0e10, 1.0e10, -1.0e10, 0.0);\n"
+		"}\n");
+}
+
+QByteArray StelProjectorPerspective::getBackwardShaderFunction() const
+{
+	return QByteArray(
+		"vec3 projectorBackward(vec2 p)\n"
+		"{\n"
+		"    p.x /= PROJECTOR_widthStretch;\n"
+		"    float z = inversesqrt(1.0 + dot(p, p));\n"
+		"    return vec3(p*z, -z);\n"
+		"}\n");
+}
+
 bool StelProjectorPerspective::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -102,6 +132,36 @@ bool StelProjectorEqualArea::forward(Vec3f &v) const
 	return true;
 }
 
+void StelProjectorEqualArea::projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const
+{
+	projectBatchImpl<StelProjectorEqualArea>(in, n, out, mask);
+}
+
+QByteArray StelProjectorEqualArea::getForwardShaderFunction() const
+{
+	return QByteArray(
+		"vec4 projectorForward(vec3 v)\n"
+		"{\n"
+		"    float r = length(v);\n"
+		"    float f = sqrt(2.0/(r*(r - v.z)));\n"
+		"    return vec4(v.x*f*PROJECTOR_widthStretch, v.y*f, r, 1.0);\n"
+		"}\n");
+}
+
+QByteArray StelProjectorEqualArea::getBackwardShaderFunction() const
+{
+	return QByteArray(
+		"vec3 projectorBackward(vec2 p)\n"
+		"{\n"
+		"    p.x /= PROJECTOR_widthStretch;\n"
+		"    float dq = dot(p, p);\n"
+		"    float l = 1.0 - 0.25*dq;\n"
+		"    if (l < 0.0)\n"
+		"        return vec3(0.0, 0.0, 1.0);\n"
+		"    return vec3(p*sqrt(l), 0.5*dq - 1.0);\n"
+		"}\n");
+}
+
 bool StelProjectorEqualArea::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -167,6 +227,36 @@ bool StelProjectorStereographic::forward(Vec3f &v) const
 	return true;
 }
 
+void StelProjectorStereographic::projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const
+{
+	projectBatchImpl<StelProjectorStereographic>(in, n, out, mask);
+}
+
+QByteArray StelProjectorStereographic::getForwardShaderFunction() const
+{
+	return QByteArray(
+		"vec4 projectorForward(vec3 v)\n"
+		"{\n"
+		"    float r = length(v);\n"
+		"    float h = 0.5*(r - v.z);\n"
+		"    if (h <= 0.0)\n"
+		"        return vec4(1.0e10, 1.0e10, 0.0, 0.0);\n"
+		"    float f = 1.0/h;\n"
+		"    return vec4(v.x*f*PROJECTOR_widthStretch, v.y*f, r, 1.0);\n"
+		"}\n");
+}
+
+QByteArray StelProjectorStereographic::getBackwardShaderFunction() const
+{
+	return QByteArray(
+		"vec3 projectorBackward(vec2 p)\n"
+		"{\n"
+		"    p.x /= PROJECTOR_widthStretch;\n"
+		"    float lqq = 0.25*dot(p, p);\n"
+		"    return vec3(p, lqq - 1.0)/(lqq + 1.0);\n"
+		"}\n");
+}
+
 bool StelProjectorStereographic::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -228,6 +318,41 @@ bool StelProjectorFisheye::forward(Vec3f &v) const
 	return false;
 }
 
+void StelProjectorFisheye::projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const
+{
+	projectBatchImpl<StelProjectorFisheye>(in, n, out, mask);
+}
+
+QByteArray StelProjectorFisheye::getForwardShaderFunction() const
+{
+	return QByteArray(
+		"vec4 projectorForward(vec3 v)\n"
+		"{\n"
+		"    float rq1 = v.x*v.x + v.y*v.y;\n"
+		"    if (rq1 > 0.0)\n"
+		"    {\n"
+		"        float h = sqrt(rq1);\n"
+		"        float f = atan(h, -v.z) / h;\n"
+		"        return vec4(v.x*f*PROJECTOR_widthStretch, v.y*f, sqrt(rq1 + v.z*v.z), 1.0);\n"
+		"    }\n"
+		"    if (v.z < 0.0)\n"
+		"        return vec4(0.0, 0.0, 1.0, 1.0);\n"
+		"    return vec4(0.0, 0.0, 0.0, 0.0);\n"
+		"}\n");
+}
+
+QByteArray StelProjectorFisheye::getBackwardShaderFunction() const
+{
+	return QByteArray(
+		"vec3 projectorBackward(vec2 p)\n"
+		"{\n"
+		"    p.x /= PROJECTOR_widthStretch;\n"
+		"    float a = length(p);\n"
+		"    float f = (a > 0.0) ? sin(a)/a : 1.0;\n"
+		"    return vec3(p*f, -cos(a));\n"
+		"}\n");
+}
+
 bool StelProjectorFisheye::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -279,6 +404,38 @@ bool StelProjectorHammer::forward(Vec3f &v) const
 	return true;
 }
 
+void StelProjectorHammer::projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const
+{
+	projectBatchImpl<StelProjectorHammer>(in, n, out, mask);
+}
+
+QByteArray StelProjectorHammer::getForwardShaderFunction() const
+{
+	return QByteArray(
+		"vec4 projectorForward(vec3 v)\n"
+		"{\n"
+		"    float r = length(v);\n"
+		"    float alpha = atan(v.x, -v.z);\n"
+		"    float cosDelta = sqrt(1.0 - v.y*v.y/(r*r));\n"
+		"    float z = sqrt(1.0 + cosDelta*cos(0.5*alpha));\n"
+		"    return vec4(2.0*1.41421356*cosDelta*sin(0.5*alpha)/z*PROJECTOR_widthStretch, 1.41421356*v.y/r/z, r, 1.0);\n"
+		"}\n");
+}
+
+QByteArray StelProjectorHammer::getBackwardShaderFunction() const
+{
+	return QByteArray(
+		"vec3 projectorBackward(vec2 p)\n"
+		"{\n"
+		"    p.x /= PROJECTOR_widthStretch;\n"
+		"    float zsq = 1.0 - 0.0625*p.x*p.x - 0.25*p.y*p.y;\n"
+		"    float z = (zsq < 0.0) ? 0.0 : sqrt(zsq);\n"
+		"    float alpha = 2.0*atan(z*p.x, 2.0*(2.0*zsq - 1.0));\n"
+		"    float cd = cos(asin(clamp(p.y*z, -1.0, 1.0)));\n"
+		"    return vec3(cd*sin(alpha), p.y*z, -cd*cos(alpha));\n"
+		"}\n");
+}
+
 bool StelProjectorHammer::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -333,6 +490,33 @@ bool StelProjectorCylinder::forward(Vec3f &v) const
 	return rval;
 }
 
+void StelProjectorCylinder::projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const
+{
+	projectBatchImpl<StelProjectorCylinder>(in, n, out, mask);
+}
+
+QByteArray StelProjectorCylinder::getForwardShaderFunction() const
+{
+	return QByteArray(
+		"vec4 projectorForward(vec3 v)\n"
+		"{\n"
+		"    float r = length(v);\n"
+		"    float valid = (-r < v.y && v.y < r) ? 1.0 : 0.0;\n"
+		"    return vec4(atan(v.x, -v.z)*PROJECTOR_widthStretch, asin(clamp(v.y/r, -1.0, 1.0)), r, valid);\n"
+		"}\n");
+}
+
+QByteArray StelProjectorCylinder::getBackwardShaderFunction() const
+{
+	return QByteArray(
+		"vec3 projectorBackward(vec2 p)\n"
+		"{\n"
+		"    p.x /= PROJECTOR_widthStretch;\n"
+		"    float cd = cos(p.y);\n"
+		"    return vec3(cd*sin(p.x), sin(p.y), -cd*cos(p.x));\n"
+		"}\n");
+}
+
 bool StelProjectorCylinder::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -381,6 +565,37 @@ bool StelProjectorMercator::forward(Vec3f &v) const
 	return rval;
 }
 
+void StelProjectorMercator::projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const
+{
+	projectBatchImpl<StelProjectorMercator>(in, n, out, mask);
+}
+
+QByteArray StelProjectorMercator::getForwardShaderFunction() const
+{
+	return QByteArray(
+		"vec4 projectorForward(vec3 v)\n"
+		"{\n"
+		"    float r = length(v);\n"
+		"    float valid = (-r < v.y && v.y < r) ? 1.0 : 0.0;\n"
+		"    float sinDelta = v.y/r;\n"
+		"    return vec4(atan(v.x, -v.z)*PROJECTOR_widthStretch, 0.5*log((1.0 + sinDelta)/(1.0 - sinDelta)), r, valid);\n"
+		"}\n");
+}
+
+
+QByteArray StelProjectorMercator::getBackwardShaderFunction() const
+{
+	return QByteArray(
+		"vec3 projectorBackward(vec2 p)\n"
+		"{\n"
+		"    p.x /= PROJECTOR_widthStretch;\n"
+		"    float e = exp(p.y);\n"
+		"    float h = e*e;\n"
+		"    float h1 = 1.0/(1.0 + h);\n"
+		"    float cosDelta = 2.0*e*h1;\n"
+		"    return vec3(cosDelta*sin(p.x), (h - 1.0)*h1, -cosDelta*cos(p.x));\n"
+		"}\n");
+}
 
 bool StelProjectorMercator::backward(Vec3d &v) const
 {
@@ -434,6 +649,36 @@ bool StelProjectorOrthographic::forward(Vec3f &v) const
 	return rval;
 }
 
+void StelProjectorOrthographic::projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const
+{
+	projectBatchImpl<StelProjectorOrthographic>(in, n, out, mask);
+}
+
+QByteArray StelProjectorOrthographic::getForwardShaderFunction() const
+{
+	return QByteArray(
+		"vec4 projectorForward(vec3 v)\n"
+		"{\n"
+		"    float r = length(v);\n"
+		"    float h = 1.0/r;\n"
+		"    return vec4(v.x*h*PROJECTOR_widthStretch, v.y*h, r, v.z <= 0.0 ? 1.0 : 0.0);\n"
+		"}\n");
+}
+
+QByteArray StelProjectorOrthographic::getBackwardShaderFunction() const
+{
+	return QByteArray(
+		"vec3 projectorBackward(vec2 p)\n"
+		"{\n"
+		"    p.x /= PROJECTOR_widthStretch;\n"
+		"    float dq = dot(p, p);\n"
+		"    float h = 1.0 - dq;\n"
+		"    if (h < 0.0)\n"
+		"        return vec3(p*inversesqrt(dq), 0.0);\n"
+		"    return vec3(p, -sqrt(h));\n"
+		"}\n");
+}
+
 bool StelProjectorOrthographic::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -487,6 +732,37 @@ bool StelProjectorSinusoidal::forward(Vec3f &v) const
 	return rval;
 }
 
+void StelProjectorSinusoidal::projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const
+{
+	projectBatchImpl<StelProjectorSinusoidal>(in, n, out, mask);
+}
+
+QByteArray StelProjectorSinusoidal::getForwardShaderFunction() const
+{
+	return QByteArray(
+		"vec4 projectorForward(vec3 v)\n"
+		"{\n"
+		"    float r = length(v);\n"
+		"    float valid = (-r < v.y && v.y < r) ? 1.0 : 0.0;\n"
+		"    float delta = asin(clamp(v.y/r, -1.0, 1.0));\n"
+		"    return vec4(atan(v.x, -v.z)*cos(delta)*PROJECTOR_widthStretch, delta, r, valid);\n"
+		"}\n");
+}
+
+QByteArray StelProjectorSinusoidal::getBackwardShaderFunction() const
+{
+	return QByteArray(
+		"vec3 projectorBackward(vec2 p)\n"
+		"{\n"
+		"    p.x /= PROJECTOR_widthStretch;\n"
+		"    float cd = cos(p.y);\n"
+		"    if (p.x < -3.14159265*cd || p.x > 3.14159265*cd)\n"
+		"        return normalize(vec3(-cd, 1.0, 0.0));\n"
+		"    float pcd = p.x/cd;\n"
+		"    return vec3(cd*sin(pcd), sin(p.y), -cd*cos(pcd));\n"
+		"}\n");
+}
+
 bool StelProjectorSinusoidal::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -529,6 +805,38 @@ bool StelProjectorMiller::forward(Vec3f &v) const
 	return rval;
 }
 
+void StelProjectorMiller::projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const
+{
+	projectBatchImpl<StelProjectorMiller>(in, n, out, mask);
+}
+
+QByteArray StelProjectorMiller::getForwardShaderFunction() const
+{
+	return QByteArray(
+		"vec4 projectorForward(vec3 v)\n"
+		"{\n"
+		"    float r = length(v);\n"
+		"    float valid = (-r < v.y && v.y < r) ? 1.0 : 0.0;\n"
+		"    float t = tan(0.8*asin(clamp(v.y/r, -1.0, 1.0)));\n"
+		"    // GLSL ES 1.0 has no asinh()\n"
+		"    return vec4(atan(v.x, -v.z)*PROJECTOR_widthStretch, 1.25*log(t + sqrt(t*t + 1.0)), r, valid);\n"
+		"}\n");
+}
+
+QByteArray StelProjectorMiller::getBackwardShaderFunction() const
+{
+	return QByteArray(
+		"vec3 projectorBackward(vec2 p)\n"
+		"{\n"
+		"    p.x /= PROJECTOR_widthStretch;\n"
+		"    // GLSL ES 1.0 has no sinh()\n"
+		"    float s = 0.8*p.y;\n"
+		"    float lat = 1.25*atan(0.5*(exp(s) - exp(-s)));\n"
+		"    float cl = cos(lat);\n"
+		"    return vec3(cl*sin(p.x), sin(lat), -cl*cos(p.x));\n"
+		"}\n");
+}
+
 bool StelProjectorMiller::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
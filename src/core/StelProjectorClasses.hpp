@@ -30,11 +30,14 @@ public:
 	virtual QString getDescriptionI18() const;
 	virtual float getMaxFov() const {return 120.f;}
 	bool forward(Vec3f &v) const;
+	virtual void projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const;
 	bool backward(Vec3d &v) const;
 	float fovToViewScalingFactor(float fov) const;
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual QByteArray getForwardShaderFunction() const;
+	virtual QByteArray getBackwardShaderFunction() const;
 	virtual bool hasDiscontinuity() const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, const Vec3d&) const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, double) const {return false;}
@@ -48,11 +51,14 @@ public:
 	virtual QString getDescriptionI18() const;
 	virtual float getMaxFov() const {return 360.f;}
 	bool forward(Vec3f &v) const;
+	virtual void projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const;
 	bool backward(Vec3d &v) const;
 	float fovToViewScalingFactor(float fov) const;
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual QByteArray getForwardShaderFunction() const;
+	virtual QByteArray getBackwardShaderFunction() const;
 	virtual bool hasDiscontinuity() const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, const Vec3d&) const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, double) const {return false;}
@@ -81,11 +87,14 @@ public:
 	}
 
 	bool forward(Vec3f &v) const;
+	virtual void projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const;
 	bool backward(Vec3d &v) const;
 	float fovToViewScalingFactor(float fov) const;
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual QByteArray getForwardShaderFunction() const;
+	virtual QByteArray getBackwardShaderFunction() const;
 	virtual bool hasDiscontinuity() const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, const Vec3d&) const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, double) const {return false;}
@@ -99,11 +108,14 @@ public:
 	virtual QString getDescriptionI18() const;
 	virtual float getMaxFov() const {return 180.00001f;}
 	bool forward(Vec3f &v) const;
+	virtual void projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const;
 	bool backward(Vec3d &v) const;
 	float fovToViewScalingFactor(float fov) const;
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual QByteArray getForwardShaderFunction() const;
+	virtual QByteArray getBackwardShaderFunction() const;
 	virtual bool hasDiscontinuity() const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, const Vec3d&) const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, double) const {return false;}
@@ -131,11 +143,14 @@ public:
 		}
 	}
 	bool forward(Vec3f &v) const;
+	virtual void projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const;
 	bool backward(Vec3d &v) const;
 	float fovToViewScalingFactor(float fov) const;
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual QByteArray getForwardShaderFunction() const;
+	virtual QByteArray getBackwardShaderFunction() const;
 	virtual bool hasDiscontinuity() const {return true;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d& p1, const Vec3d& p2) const {return p1[0]*p2[0]<0 && !(p1[2]<0 && p2[2]<0);}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d& capN, double capD) const
@@ -156,11 +171,14 @@ public:
 	virtual QString getDescriptionI18() const;
 	virtual float getMaxFov() const {return 175.f * 4.f/3.f;} // assume aspect ration of 4/3 for getting a full 360 degree horizon
 	bool forward(Vec3f &win) const;
+	virtual void projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const;
 	bool backward(Vec3d &v) const;
 	float fovToViewScalingFactor(float fov) const;
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual QByteArray getForwardShaderFunction() const;
+	virtual QByteArray getBackwardShaderFunction() const;
 	virtual bool hasDiscontinuity() const {return true;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d& p1, const Vec3d& p2) const
 	{
@@ -184,11 +202,14 @@ public:
 	virtual QString getDescriptionI18() const;
 	virtual float getMaxFov() const {return 175.f * 4.f/3.f;} // assume aspect ration of 4/3 for getting a full 360 degree horizon
 	bool forward(Vec3f &win) const;
+	virtual void projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const;
 	bool backward(Vec3d &v) const;
 	float fovToViewScalingFactor(float fov) const;
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual QByteArray getForwardShaderFunction() const;
+	virtual QByteArray getBackwardShaderFunction() const;
 	virtual bool hasDiscontinuity() const {return true;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d& p1, const Vec3d& p2) const
 	{
@@ -212,11 +233,14 @@ public:
 	virtual QString getDescriptionI18() const;
 	virtual float getMaxFov() const {return 179.9999f;}
 	bool forward(Vec3f &win) const;
+	virtual void projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const;
 	bool backward(Vec3d &v) const;
 	float fovToViewScalingFactor(float fov) const;
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual QByteArray getForwardShaderFunction() const;
+	virtual QByteArray getBackwardShaderFunction() const;
 	virtual bool hasDiscontinuity() const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, const Vec3d&) const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, double) const {return false;}
@@ -229,7 +253,11 @@ public:
 	virtual QString getNameI18() const;
 	virtual QString getDescriptionI18() const;
 	bool forward(Vec3f &win) const;
+	virtual void projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const;
 	bool backward(Vec3d &v) const;
+protected:
+	virtual QByteArray getForwardShaderFunction() const;
+	virtual QByteArray getBackwardShaderFunction() const;
 };
 
 class StelProjectorMiller : public StelProjectorMercator
@@ -240,7 +268,11 @@ public:
 	virtual QString getDescriptionI18() const;
 	virtual float getMaxFov() const {return 175.f * 4.f/3.f;} // or 180?
 	bool forward(Vec3f &win) const;
+	virtual void projectBatch(const Vec3f* in, int n, Vec3f* out, bool* mask) const;
 	bool backward(Vec3d &v) const;
+protected:
+	virtual QByteArray getForwardShaderFunction() const;
+	virtual QByteArray getBackwardShaderFunction() const;
 };
 
 class StelProjector2d : public StelProjector
@@ -2,6 +2,8 @@
 #include "StelApp.hpp"
 #include <QtDebug>
 #include <QApplication>
+#include <QDateTime>
+#include <QSettings>
 
 StelProperty::StelProperty(const QString &id, QObject *target, const QMetaProperty& prop)
 	: id(id), target(target), prop(prop)
@@ -123,9 +125,71 @@ void StelPropertyMgr::onStelPropChanged(const QVariant &val)
 	if (qApp->property("verbose") == true)
 		qDebug()<<"StelProperty"<<prop->getId()<<"changed, value"<<val;
 #endif
+	pendingChanges.insert(prop->getId(), val);
 	emit stelPropertyChanged(prop, val);
 }
 
+void StelPropertyMgr::setRateLimit(const QString &id, double maxRate)
+{
+	if(maxRate > 0.)
+		minIntervals.insert(id, qRound64(1000. / maxRate));
+	else
+	{
+		minIntervals.remove(id);
+		lastReports.remove(id);
+	}
+}
+
+double StelPropertyMgr::getRateLimit(const QString &id) const
+{
+	const qint64 interval = minIntervals.value(id, 0);
+	return interval > 0 ? 1000. / interval : 0.;
+}
+
+void StelPropertyMgr::loadRateLimits(QSettings *conf)
+{
+	conf->beginGroup("property_rate_limits");
+	for (const auto& id : conf->childKeys())
+	{
+		bool ok;
+		const double maxRate = conf->value(id).toDouble(&ok);
+		if(ok)
+			setRateLimit(id, maxRate);
+		else
+			qWarning()<<"Invalid rate limit for StelProperty"<<id<<":"<<conf->value(id).toString();
+	}
+	conf->endGroup();
+}
+
+void StelPropertyMgr::update()
+{
+	if(pendingChanges.isEmpty())
+		return;
+
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	QVariantMap changes;
+	for (auto it = pendingChanges.begin(); it != pendingChanges.end();)
+	{
+		auto interval = minIntervals.constFind(it.key());
+		if(interval != minIntervals.constEnd())
+		{
+			auto last = lastReports.find(it.key());
+			if(last != lastReports.end() && now - last.value() < interval.value())
+			{
+				//keep the latest value until the interval has passed
+				++it;
+				continue;
+			}
+			lastReports.insert(it.key(), now);
+		}
+		changes.insert(it.key(), it.value());
+		it = pendingChanges.erase(it);
+	}
+
+	if(!changes.isEmpty())
+		emit stelPropertiesChanged(changes);
+}
+
 QStringList StelPropertyMgr::getPropertyList() const
 {
 	return propMap.keys();
@@ -20,8 +20,12 @@
 #define STELPROPERTYMGR_HPP
 
 #include <QObject>
+#include <QHash>
 #include <QSet>
 #include <QMetaProperty>
+#include <QVariantMap>
+
+class QSettings;
 
 class StelProperty;
 
@@ -305,11 +309,32 @@ public:
 	bool setStelPropertyValue(const QString& id, const QVariant &value) const;
 	//! Returns the QMetaProperty information for the given \p id.
 	QMetaProperty getMetaProperty(const QString& id) const;
+
+	//! Limits how often changes of a property are reported by stelPropertiesChanged().
+	//! Changes in between are combined, only the latest value is reported when the interval has passed.
+	//! @param id The identifier of the property, it does not have to be registered yet
+	//! @param maxRate The maximal number of notifications per second, or 0 to report the changes each frame
+	void setRateLimit(const QString& id, double maxRate);
+	//! Returns the maximal number of notifications per second set with setRateLimit(), or 0 if there is no limit
+	double getRateLimit(const QString& id) const;
+	//! Sets the rate limits from the [property_rate_limits] section of the configuration,
+	//! which has property IDs as keys and the maximal notifications per second as values.
+	void loadRateLimits(QSettings* conf);
+
+	//! Reports the changes collected since the last call with stelPropertiesChanged().
+	//! Called by StelApp::update() once per frame.
+	void update();
 signals:
 	//! Emitted when any registered StelProperty has been changed
 	//! @param prop The property that was changed
 	//! @param value The new value of the property
 	void stelPropertyChanged(StelProperty* prop, const QVariant& value);
+	//! Emitted at most once per frame with the latest values of the registered StelProperties
+	//! which have been changed since the last emission, respecting the limits set with setRateLimit().
+	//! Should be used instead of stelPropertyChanged() by receivers which forward the changes,
+	//! e.g. over the network, so that an animated property causes one message per frame instead of one per step.
+	//! @param changes The new values, with the property IDs as keys
+	void stelPropertiesChanged(const QVariantMap& changes);
 private slots:
 	void onStelPropChanged(const QVariant& val);
 private:
@@ -317,6 +342,13 @@ private:
 
 	QMap<QString,QObject*> registeredObjects;
 	StelPropertyMap propMap;
+
+	//! the latest values of the changes which have not been reported yet
+	QVariantMap pendingChanges;
+	//! minimal time in ms between two reports of a rate limited property
+	QHash<QString,qint64> minIntervals;
+	//! time in ms of the last report of a rate limited property
+	QHash<QString,qint64> lastReports;
 };
 
 #endif
@@ -0,0 +1,172 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelQualityGovernor.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelPainter.hpp"
+#include "StelSkyDrawer.hpp"
+#include "LandscapeMgr.hpp"
+#include "Landscape.hpp"
+
+#include <QDebug>
+#include <QSettings>
+
+namespace
+{
+	struct QualityLevel
+	{
+		float renderScale;		// factor of the render scale chosen by the user
+		float atmosphereScale;		// see Atmosphere::setResolutionScale()
+		float landscapeScale;		// see Landscape::setDetailScale()
+		int tessellationReduction;	// subtracted from the tessellation depth chosen by the user
+		float starMagReduction;		// see StelSkyDrawer::setStarMagnitudeLimitReduction()
+	};
+
+	// The cheapest settings are lowered first, the render scale which blurs the whole view last.
+	const QualityLevel qualityLevels[] =
+	{
+		{1.f,   1.f,   1.f,   0, 0.f},
+		{1.f,   0.75f, 0.75f, 1, 0.f},
+		{1.f,   0.5f,  0.5f,  2, 0.5f},
+		{0.85f, 0.5f,  0.5f,  3, 1.f},
+		{0.75f, 0.4f,  0.4f,  4, 1.5f},
+		{0.6f,  0.3f,  0.3f,  4, 2.f},
+		{0.5f,  0.3f,  0.3f,  4, 2.5f}
+	};
+
+	//! Time holding the target before a higher quality is tried first [s]
+	const double MIN_RAISE_DELAY = 2.;
+	//! Longest delay before a higher quality is tried again [s]
+	const double MAX_RAISE_DELAY = 120.;
+}
+
+StelQualityGovernor::StelQualityGovernor()
+	: enabled(false)
+	, targetFps(60.)
+	, level(0)
+	, memoryPressure(false)
+	, averageFrameTime(0.)
+	, fastTime(0.)
+	, raiseDelay(MIN_RAISE_DELAY)
+	, baseRenderScale(1.f)
+	, baseTessellationDepth(StelPainter::getTessellationDepth())
+{
+}
+
+int StelQualityGovernor::getMaxLevel()
+{
+	return sizeof(qualityLevels)/sizeof(qualityLevels[0])-1;
+}
+
+void StelQualityGovernor::init(QSettings* conf)
+{
+	setTargetFps(conf->value("video/target_fps", 60.).toDouble());
+	setEnabled(conf->value("video/flag_quality_governor", false).toBool());
+}
+
+void StelQualityGovernor::setEnabled(bool b)
+{
+	if (b==enabled)
+		return;
+	if (b)
+	{
+		// The full quality is the one chosen by the user when the governor starts.
+		baseRenderScale = StelApp::getInstance().getRenderScale();
+		baseTessellationDepth = StelPainter::getTessellationDepth();
+		averageFrameTime = 1./targetFps;
+		fastTime = 0.;
+		raiseDelay = MIN_RAISE_DELAY;
+	}
+	else
+		applyLevel(0);
+	enabled = b;
+}
+
+void StelQualityGovernor::setTargetFps(double fps)
+{
+	targetFps = qBound(1., fps, 1000.);
+	averageFrameTime = 1./targetFps;
+}
+
+void StelQualityGovernor::update(double frameTime, bool throttled)
+{
+	if (!enabled || throttled || frameTime<=0.)
+		return;
+	const double targetFrameTime = 1./targetFps;
+	// Long pauses (e.g. the window was hidden or a dialog was open) do not tell anything about the rendering.
+	if (frameTime > 10.*targetFrameTime)
+		return;
+	averageFrameTime += (frameTime-averageFrameTime)*0.2;
+
+	if (averageFrameTime > 1.1*targetFrameTime)
+	{
+		if (level < getMaxLevel())
+		{
+			// The last higher quality was too slow: wait longer before trying it again.
+			if (fastTime < raiseDelay)
+				raiseDelay = qMin(raiseDelay*2., MAX_RAISE_DELAY);
+			applyLevel(level+1);
+		}
+		averageFrameTime = targetFrameTime;
+		fastTime = 0.;
+	}
+	else if (averageFrameTime < 1.02*targetFrameTime)
+	{
+		fastTime += frameTime;
+		if (level > 0 && fastTime > raiseDelay && !memoryPressure)
+		{
+			applyLevel(level-1);
+			fastTime = 0.;
+		}
+		// A quality held for long is not suspect anymore.
+		if (fastTime > MAX_RAISE_DELAY)
+			raiseDelay = MIN_RAISE_DELAY;
+	}
+}
+
+void StelQualityGovernor::setMemoryPressure(bool b)
+{
+	if (b==memoryPressure)
+		return;
+	memoryPressure = b;
+	if (b && enabled && level < getMaxLevel())
+	{
+		qDebug() << "StelQualityGovernor: texture memory over budget";
+		applyLevel(level+1);
+		fastTime = 0.;
+	}
+}
+
+void StelQualityGovernor::applyLevel(int newLevel)
+{
+	level = qBound(0, newLevel, getMaxLevel());
+	const QualityLevel& q = qualityLevels[level];
+	StelApp& app = StelApp::getInstance();
+	app.setRenderScale(baseRenderScale*q.renderScale);
+	StelPainter::setTessellationDepth(baseTessellationDepth-q.tessellationReduction);
+	app.getCore()->getSkyDrawer()->setStarMagnitudeLimitReduction(q.starMagReduction);
+	Landscape::setDetailScale(q.landscapeScale);
+	LandscapeMgr* landscapeMgr = GETSTELMODULE(LandscapeMgr);
+	if (landscapeMgr)
+		landscapeMgr->setAtmosphereResolutionScale(q.atmosphereScale);
+	qDebug() << "StelQualityGovernor: quality level" << level;
+}
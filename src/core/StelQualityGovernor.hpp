@@ -0,0 +1,84 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef STELQUALITYGOVERNOR_HPP
+#define STELQUALITYGOVERNOR_HPP
+
+class QSettings;
+
+//! @class StelQualityGovernor
+//! Lowers the rendering quality when the frames take longer than the target frame time, and raises it
+//! again when the frames hold the target. Each quality level lowers the render scale (see StelApp::setRenderScale()),
+//! the resolution of the atmosphere, the detail of the landscape, the tessellation of arcs
+//! and the limiting magnitude of the stars a bit more than the previous one.
+//! The frame time is measured between consecutive calls of update(), only while the frames are not
+//! deliberately throttled (see StelMainView::getMinFps()). With vertical synchronisation the frames can
+//! not be faster than the refresh rate, so a higher quality is tried again after some time holding the target,
+//! and this delay doubles each time the higher quality turned out to be too slow.
+class StelQualityGovernor
+{
+public:
+	StelQualityGovernor();
+
+	//! Read the settings video/flag_quality_governor and video/target_fps.
+	void init(QSettings* conf);
+
+	//! Set whether the quality is adjusted. When disabled, the full quality is restored.
+	void setEnabled(bool b);
+	bool isEnabled() const {return enabled;}
+
+	//! Set the number of frames per second to hold, usually the refresh rate of the display.
+	void setTargetFps(double fps);
+	double getTargetFps() const {return targetFps;}
+
+	//! Get the current quality level, 0 for the full quality, up to getMaxLevel().
+	int getLevel() const {return level;}
+	static int getMaxLevel();
+
+	//! Report the duration of the last frame, and adjust the quality.
+	//! @param frameTime the time since the previous frame [s]
+	//! @param throttled true if the frame rate was limited on purpose, then the frame is ignored
+	void update(double frameTime, bool throttled);
+
+	//! Report whether the textures in use exceed the memory budget of StelTextureMgr.
+	//! While they do, the quality is not raised, so that the render buffers do not grow.
+	//! The quality is lowered once when the memory pressure starts.
+	void setMemoryPressure(bool b);
+
+private:
+	//! Apply the settings of a quality level.
+	void applyLevel(int newLevel);
+
+	bool enabled;
+	double targetFps;
+	int level;
+	bool memoryPressure;
+	//! Average frame time [s]
+	double averageFrameTime;
+	//! Time since the last quality change with frames holding the target [s]
+	double fastTime;
+	//! Time holding the target needed before raising the quality [s]
+	double raiseDelay;
+	//! Render scale and tessellation depth chosen by the user, for the full quality
+	float baseRenderScale;
+	int baseTessellationDepth;
+};
+
+#endif // STELQUALITYGOVERNOR_HPP
@@ -37,6 +37,14 @@ public:
 	
 	//! Return the spatial region of the object.
 	virtual Vec3d getPointInRegion() const=0;
+
+	//! Return the key by which the objects of each node of a StelSphericalIndex are sorted, in increasing order.
+	//! E.g. the magnitude, so that the processing of a node can stop at the first object which is too faint.
+	virtual float getIndexSortKey() const {return 0.f;}
+
+	//! Return bits describing the object, which a StelSphericalIndex combines for each node so that
+	//! the nodes without any wanted object can be skipped, see StelSphericalIndex::processFilteredPointInRegions().
+	virtual quint64 getIndexMask() const {return ~Q_UINT64_C(0);}
 };
 
 //! @typedef StelRegionObjectP
@@ -0,0 +1,376 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelScreenshotWriter.hpp"
+#include "StelApp.hpp"
+#include "StelOpenGL.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <QDebug>
+#include <QDir>
+#include <QOpenGLContext>
+#include <QProcess>
+#include <QThread>
+
+// Not defined in the OpenGL ES 2 headers
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_MAP_READ_BIT
+#define GL_MAP_READ_BIT 0x0001
+#endif
+
+namespace
+{
+	//! Above this, the frame which sends more data waits until the encoder has read some [bytes]
+	const qint64 MAX_PIPE_BUFFER = 256*1024*1024;
+}
+
+StelScreenshotWriter::StelScreenshotWriter()
+	: glInitialized(false)
+	, mapBufferRange(Q_NULLPTR)
+	, unmapBuffer(Q_NULLPTR)
+	, readCounter(0)
+	, frameCounter(0)
+	, maxQueuedJobs(2*qMax(1, QThread::idealThreadCount()))
+	, pipe(Q_NULLPTR)
+	, pipeWidth(0)
+	, pipeHeight(0)
+{
+}
+
+StelScreenshotWriter::~StelScreenshotWriter()
+{
+	flush();
+	stopPipe();
+	if (glInitialized && mapBufferRange)
+	{
+		for (auto& buf : buffers)
+		{
+			if (buf.id)
+				glDeleteBuffers(1, &buf.id);
+		}
+	}
+}
+
+void StelScreenshotWriter::initGL()
+{
+	initializeOpenGLFunctions();
+	glInitialized = true;
+
+	QOpenGLContext* ctx = QOpenGLContext::currentContext();
+	if (ctx->format().majorVersion() >= 3)
+	{
+		mapBufferRange = reinterpret_cast<PFNMapBufferRange>(ctx->getProcAddress("glMapBufferRange"));
+		unmapBuffer = reinterpret_cast<PFNUnmapBuffer>(ctx->getProcAddress("glUnmapBuffer"));
+	}
+	if (!mapBufferRange || !unmapBuffer)
+	{
+		mapBufferRange = Q_NULLPTR;
+		qDebug() << "StelScreenshotWriter: pixel buffer objects are not available, screenshots are read synchronously";
+		return;
+	}
+	for (auto& buf : buffers)
+		glGenBuffers(1, &buf.id);
+}
+
+void StelScreenshotWriter::readToFile(int width, int height, const QString &fileName, bool invert)
+{
+	read(width, height, fileName, false, invert);
+}
+
+void StelScreenshotWriter::readToPipe(int width, int height, bool invert)
+{
+	if (!pipe)
+		return;
+	if (width!=pipeWidth || height!=pipeHeight)
+	{
+		qWarning() << "StelScreenshotWriter: dropped a frame of" << width << "x" << height << "for a pipe of" << pipeWidth << "x" << pipeHeight;
+		return;
+	}
+	read(width, height, QString(), true, invert);
+}
+
+void StelScreenshotWriter::saveImage(const QImage &image, const QString &fileName, bool invert)
+{
+	limitQueuedJobs();
+	queueFile(image, fileName, invert, false);
+}
+
+void StelScreenshotWriter::read(int width, int height, const QString &fileName, bool toPipe, bool invert)
+{
+	if (width <= 0 || height <= 0)
+		return;
+	if (!glInitialized)
+		initGL();
+
+	if (!mapBufferRange)
+	{
+		// Blocks until the frame is drawn
+		QImage image(width, height, QImage::Format_RGBX8888);
+		GL(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, image.bits()));
+		queue(image, fileName, toPipe, invert);
+		return;
+	}
+
+	PixelBuffer* buf = Q_NULLPTR;
+	for (auto& b : buffers)
+	{
+		if (!b.pending)
+		{
+			buf = &b;
+			break;
+		}
+	}
+	if (!buf)
+	{
+		// All buffers wait for their copy: the oldest one is mapped now, which waits for the GPU
+		buf = &buffers[0];
+		for (auto& b : buffers)
+		{
+			if (b.sequence < buf->sequence)
+				buf = &b;
+		}
+		readPixelBuffer(*buf);
+	}
+
+	GL(glBindBuffer(GL_PIXEL_PACK_BUFFER, buf->id));
+	const int size = width * height * 4;
+	if (size != buf->size)
+	{
+		GL(glBufferData(GL_PIXEL_PACK_BUFFER, size, Q_NULLPTR, GL_STREAM_READ));
+		buf->size = size;
+	}
+	buf->width = width;
+	buf->height = height;
+	buf->fileName = fileName;
+	buf->toPipe = toPipe;
+	buf->invert = invert;
+	buf->sequence = readCounter++;
+	buf->frame = frameCounter;
+	// Returns immediately, the copy is done by the GPU after the draw calls
+	GL(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, Q_NULLPTR));
+	GL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+	buf->pending = true;
+}
+
+void StelScreenshotWriter::readPixelBuffer(PixelBuffer &buf)
+{
+	buf.pending = false;
+	GL(glBindBuffer(GL_PIXEL_PACK_BUFFER, buf.id));
+	const void* data = mapBufferRange(GL_PIXEL_PACK_BUFFER, 0, buf.size, GL_MAP_READ_BIT);
+	if (data)
+	{
+		// The FBOs of GLES have an alpha channel, which is not meant to be transparent
+		QImage image(buf.width, buf.height, QImage::Format_RGBX8888);
+		memcpy(image.bits(), data, static_cast<size_t>(buf.size));
+		unmapBuffer(GL_PIXEL_PACK_BUFFER);
+		GL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+		queue(image, buf.fileName, buf.toPipe, buf.invert);
+	}
+	else
+	{
+		GL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+		qWarning() << "StelScreenshotWriter: can't map the pixels of" << (buf.toPipe ? QString("a frame") : QDir::toNativeSeparators(buf.fileName));
+	}
+	buf.fileName.clear();
+}
+
+void StelScreenshotWriter::readPendingBuffers(bool all)
+{
+	if (!glInitialized || !mapBufferRange)
+		return;
+	QList<PixelBuffer*> pending;
+	for (auto& buf : buffers)
+	{
+		if (buf.pending && (all || buf.frame < frameCounter))
+			pending.append(&buf);
+	}
+	// The frames of the pipe must be queued in order
+	std::sort(pending.begin(), pending.end(), [](const PixelBuffer* a, const PixelBuffer* b) { return a->sequence < b->sequence; });
+	for (auto* buf : pending)
+		readPixelBuffer(*buf);
+}
+
+void StelScreenshotWriter::queue(const QImage &image, const QString &fileName, bool toPipe, bool invert)
+{
+	limitQueuedJobs();
+	if (!toPipe)
+	{
+		queueFile(image, fileName, invert, true);
+		return;
+	}
+
+	PipeFrame frame;
+	frame.data = QSharedPointer<QByteArray>(new QByteArray());
+	QSharedPointer<QByteArray> data = frame.data;
+	frame.job = StelApp::getInstance().getJobMgr().submit([image, invert, data]() {
+		QImage rgb = image.mirrored().convertToFormat(QImage::Format_RGB888);
+		if (invert)
+			rgb.invertPixels();
+		// The scan lines of QImage are padded to 4 bytes, the raw frames are not
+		const int rowSize = rgb.width() * 3;
+		data->resize(rowSize * rgb.height());
+		for (int y = 0; y < rgb.height(); ++y)
+			memcpy(data->data() + y * rowSize, rgb.constScanLine(y), static_cast<size_t>(rowSize));
+	});
+	pipeFrames.append(frame);
+}
+
+void StelScreenshotWriter::queueFile(const QImage &image, const QString &fileName, bool invert, bool mirror)
+{
+	FileJob file;
+	file.fileName = fileName;
+	file.job = StelApp::getInstance().getJobMgr().submit([image, fileName, invert, mirror]() {
+		QImage im = mirror ? image.mirrored() : image;
+		if (invert)
+			im.invertPixels();
+		if (!im.save(fileName))
+			qWarning() << "WARNING failed to write screenshot to: " << QDir::toNativeSeparators(fileName);
+	});
+	fileJobs.append(file);
+}
+
+void StelScreenshotWriter::limitQueuedJobs()
+{
+	removeFinishedFileJobs();
+	writePipeFrames(false);
+	while (fileJobs.size() + pipeFrames.size() >= maxQueuedJobs)
+	{
+		if (!pipeFrames.isEmpty())
+		{
+			pipeFrames.first().job->waitForFinished();
+			writePipeFrames(false);
+		}
+		else
+		{
+			fileJobs.first().job->waitForFinished();
+			removeFinishedFileJobs();
+		}
+	}
+}
+
+void StelScreenshotWriter::writePipeFrames(bool wait)
+{
+	while (!pipeFrames.isEmpty())
+	{
+		const PipeFrame& frame = pipeFrames.first();
+		if (!frame.job->isFinished())
+		{
+			if (!wait)
+				break;
+			frame.job->waitForFinished();
+		}
+		if (pipe && pipe->state()==QProcess::Running)
+		{
+			pipe->write(*frame.data);
+			// QProcess writes from the event loop, wait here when the encoder doesn't keep up
+			while (pipe->bytesToWrite() > MAX_PIPE_BUFFER && pipe->waitForBytesWritten(1000)) {}
+		}
+		pipeFrames.removeFirst();
+	}
+	if (wait && pipe)
+	{
+		while (pipe->bytesToWrite() > 0 && pipe->waitForBytesWritten(1000)) {}
+	}
+}
+
+void StelScreenshotWriter::removeFinishedFileJobs()
+{
+	for (auto it = fileJobs.begin(); it != fileJobs.end();)
+	{
+		if (it->job->isFinished())
+			it = fileJobs.erase(it);
+		else
+			++it;
+	}
+}
+
+void StelScreenshotWriter::processPending()
+{
+	readPendingBuffers(false);
+	++frameCounter;
+	writePipeFrames(false);
+	removeFinishedFileJobs();
+}
+
+void StelScreenshotWriter::flush()
+{
+	readPendingBuffers(true);
+	for (const auto& file : fileJobs)
+		file.job->waitForFinished();
+	fileJobs.clear();
+	writePipeFrames(true);
+}
+
+bool StelScreenshotWriter::isWriting(const QString &fileName)
+{
+	removeFinishedFileJobs();
+	for (const auto& buf : buffers)
+	{
+		if (buf.pending && !buf.toPipe && buf.fileName==fileName)
+			return true;
+	}
+	for (const auto& file : fileJobs)
+	{
+		if (file.fileName==fileName)
+			return true;
+	}
+	return false;
+}
+
+bool StelScreenshotWriter::startPipe(const QString &command, int width, int height)
+{
+	stopPipe();
+	pipe = new QProcess();
+	pipe->setProcessChannelMode(QProcess::ForwardedChannels);
+	pipe->start(command, QIODevice::WriteOnly);
+	if (!pipe->waitForStarted())
+	{
+		qWarning() << "ERROR: the frame encoder can't be started:" << command << pipe->errorString();
+		delete pipe;
+		pipe = Q_NULLPTR;
+		return false;
+	}
+	pipeWidth = width;
+	pipeHeight = height;
+	qDebug() << "StelScreenshotWriter: sending frames of" << width << "x" << height << "to" << command;
+	return true;
+}
+
+void StelScreenshotWriter::stopPipe()
+{
+	if (!pipe)
+		return;
+	readPendingBuffers(true);
+	writePipeFrames(true);
+	pipe->closeWriteChannel();
+	// The encoder may still have to write the end of the file
+	if (!pipe->waitForFinished(60000))
+		qWarning() << "ERROR: the frame encoder did not finish, it is killed";
+	else if (pipe->exitStatus()!=QProcess::NormalExit || pipe->exitCode()!=0)
+		qWarning() << "ERROR: the frame encoder failed with exit code" << pipe->exitCode();
+	delete pipe;
+	pipe = Q_NULLPTR;
+}
@@ -0,0 +1,149 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STELSCREENSHOTWRITER_HPP
+#define STELSCREENSHOTWRITER_HPP
+
+#include "StelJobMgr.hpp"
+
+#include <QByteArray>
+#include <QImage>
+#include <QList>
+#include <QOpenGLFunctions>
+#include <QSharedPointer>
+#include <QString>
+
+class QProcess;
+
+//! @class StelScreenshotWriter
+//! Reads drawn frames back from the GPU and saves them without blocking the draws, for the screenshots and the
+//! frame sequences of StelMainView.
+//! Where pixel buffer objects are available (OpenGL 3 or OpenGL ES 3), the pixels are read asynchronously into
+//! them and mapped by processPending() in a later frame, once the GPU has finished the copy. Otherwise glReadPixels
+//! is used directly. The images are then flipped and encoded by jobs of StelJobMgr, or converted to raw RGB frames
+//! which are sent in order to the standard input of an external encoder (see startPipe()).
+//! When the jobs fall behind, the frame which reads a new image waits for the oldest one, so that a long frame
+//! sequence does not fill the memory.
+//! All methods must be called from the main thread.
+class StelScreenshotWriter : protected QOpenGLFunctions
+{
+public:
+	StelScreenshotWriter();
+	//! Waits for the pending images and releases the buffers. Requires the GL context to be current.
+	~StelScreenshotWriter();
+
+	//! Read the currently bound framebuffer, and save it in the background.
+	//! @param width, height the size of the framebuffer in pixels
+	//! @param fileName the image file, whose extension gives the format
+	//! @param invert invert the colors of the image
+	void readToFile(int width, int height, const QString& fileName, bool invert);
+	//! Read the currently bound framebuffer, and send it to the encoder started by startPipe().
+	//! The frame is dropped if its size differs from the size of the pipe.
+	void readToPipe(int width, int height, bool invert);
+	//! Save an image which is already in main memory, in the background.
+	void saveImage(const QImage& image, const QString& fileName, bool invert);
+
+	//! Map the buffers read in earlier frames, and send the converted frames to the pipe.
+	//! Called after each draw, the GL context must be current.
+	void processPending();
+	//! Wait until all images are saved or sent. The GL context must be current.
+	void flush();
+
+	//! Get whether an image is being saved to this file, e.g. to choose the name of the next screenshot.
+	bool isWriting(const QString& fileName);
+
+	//! Start an external encoder which gets the frames of readToPipe() on its standard input, as raw RGB
+	//! (8 bits per channel) images with the top row first, e.g. ffmpeg -f rawvideo -pix_fmt rgb24 -s 1920x1080 -i - out.mp4
+	//! @param width, height the size of the frames in pixels
+	//! @return false if the command could not be started
+	bool startPipe(const QString& command, int width, int height);
+	//! Send the pending frames, close the standard input of the encoder and wait for it to finish.
+	void stopPipe();
+	bool isPipeOpen() const { return pipe!=Q_NULLPTR; }
+
+private:
+	struct PixelBuffer
+	{
+		PixelBuffer() : id(0), size(0), width(0), height(0), pending(false), toPipe(false), invert(false), sequence(0), frame(0) {}
+		GLuint id;
+		int size;
+		int width;
+		int height;
+		bool pending;
+		bool toPipe;
+		bool invert;
+		QString fileName;
+		//! The order of the reads
+		quint64 sequence;
+		//! The value of frameCounter when the pixels were read
+		quint64 frame;
+	};
+
+	//! A file being saved by a job
+	struct FileJob
+	{
+		StelJobP job;
+		QString fileName;
+	};
+
+	//! A frame being converted for the pipe by a job
+	struct PipeFrame
+	{
+		StelJobP job;
+		QSharedPointer<QByteArray> data;
+	};
+
+	void initGL();
+	void read(int width, int height, const QString& fileName, bool toPipe, bool invert);
+	//! Copies the pixels of a pending buffer and queues their job
+	void readPixelBuffer(PixelBuffer& buf);
+	//! Read the pending buffers in the order of their reads.
+	//! @param all also read the buffers of the current frame, which waits for the GPU
+	void readPendingBuffers(bool all);
+	//! Queue the job of an image read from OpenGL, with the bottom row first.
+	void queue(const QImage& image, const QString& fileName, bool toPipe, bool invert);
+	void queueFile(const QImage& image, const QString& fileName, bool invert, bool mirror);
+	//! Wait for the oldest job while too many are queued.
+	void limitQueuedJobs();
+	//! Write the converted frames to the pipe, in order.
+	//! @param wait wait for the conversions which did not finish
+	void writePipeFrames(bool wait);
+	void removeFinishedFileJobs();
+
+	typedef void* (QOPENGLF_APIENTRYP PFNMapBufferRange)(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+	typedef GLboolean (QOPENGLF_APIENTRYP PFNUnmapBuffer)(GLenum target);
+
+	bool glInitialized;
+	PFNMapBufferRange mapBufferRange;
+	PFNUnmapBuffer unmapBuffer;
+	//! At most this many frames wait for their copy, a frame which reads more waits for the oldest one
+	static const int BUFFER_COUNT = 4;
+	PixelBuffer buffers[BUFFER_COUNT];
+	quint64 readCounter;
+	quint64 frameCounter;
+	int maxQueuedJobs;
+
+	QList<FileJob> fileJobs;
+	QList<PipeFrame> pipeFrames;
+	QProcess* pipe;
+	int pipeWidth;
+	int pipeHeight;
+};
+
+#endif // STELSCREENSHOTWRITER_HPP
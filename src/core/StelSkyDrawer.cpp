@@ -26,6 +26,7 @@
 #include "StelTextureMgr.hpp"
 #include "StelApp.hpp"
 #include "StelCore.hpp"
+#include "StelFrameProfiler.hpp"
 #include "StelUtils.hpp"
 #include "StelMovementMgr.hpp"
 #include "StelPainter.hpp"
@@ -39,11 +40,16 @@
 
 #include <QOpenGLContext>
 #include <QOpenGLShaderProgram>
+#if QT_VERSION >= 0x050600
+#include <QOpenGLExtraFunctions>
+#endif
 #include <QStringList>
 #include <QSettings>
 #include <QDebug>
 #include <QtGlobal>
 
+#include <cstring>
+
 // The 0.025 corresponds to the maximum eye resolution in degree
 #define EYE_RESOLUTION (0.25f)
 #define MAX_LINEAR_RADIUS 8.f
@@ -64,15 +70,21 @@ StelSkyDrawer::StelSkyDrawer(StelCore* acore) :
 	starRelativeScale(1.f),
 	starAbsoluteScaleF(1.f),
 	starLinearScale(19.569f),
+	rcMagGeneration(0),
 	limitMagnitude(-100.f),
 	limitLuminance(0.f),
 	customStarMagLimit(0.0),
 	customNebulaMagLimit(0.0),
 	customPlanetMagLimit(0.0),
+	starMagLimitReduction(0.f),
 	bortleScaleIndex(3),
 	inScale(1.f),
 	starShaderProgram(Q_NULLPTR),
 	starShaderVars(StarShaderVars()),
+	useInstancing(false),
+	instanceArray(Q_NULLPTR),
+	starInstancedShaderProgram(Q_NULLPTR),
+	starInstancedShaderVars(StarInstancedShaderVars()),
 	nbPointSources(0),
 	maxPointSources(1000),
 	maxLum(0.f),
@@ -82,6 +94,7 @@ StelSkyDrawer::StelSkyDrawer(StelCore* acore) :
 	big3dModelHaloRadius(150.f)
 {
 	setObjectName("StelSkyDrawer");
+	memset(rcMagParameters, 0, sizeof(rcMagParameters));
 	QSettings* conf = StelApp::getInstance().getSettings();
 	initColorTableFromConfigFile(conf);
 
@@ -145,6 +158,7 @@ StelSkyDrawer::StelSkyDrawer(StelCore* acore) :
 		unsigned char* elem = &textureCoordArray[i*6*2];
 		memcpy(elem, texElems, 12);
 	}
+	instanceArray = new StarInstance[maxPointSources];
 }
 
 StelSkyDrawer::~StelSkyDrawer()
@@ -153,14 +167,28 @@ StelSkyDrawer::~StelSkyDrawer()
 	vertexArray = Q_NULLPTR;
 	delete[] textureCoordArray;
 	textureCoordArray = Q_NULLPTR;
+	delete[] instanceArray;
+	instanceArray = Q_NULLPTR;
 	
+	qDeleteAll(rcMagTables);
+	rcMagTables.clear();
+
 	delete starShaderProgram;
 	starShaderProgram = Q_NULLPTR;
+	delete starInstancedShaderProgram;
+	starInstancedShaderProgram = Q_NULLPTR;
 }
 
 // Init parameters from config file
 void StelSkyDrawer::init()
 {
+	// Without OpenGL context, only the photometric model is used
+	if (StelApp::getInstance().isHeadless())
+	{
+		update(0);
+		return;
+	}
+
 	initializeOpenGLFunctions();
 
 	// Load star texture no mipmap:
@@ -209,9 +237,76 @@ void StelSkyDrawer::init()
 	starShaderVars.color = starShaderProgram->attributeLocation("color");
 	starShaderVars.texture = starShaderProgram->uniformLocation("tex");
 
+	initInstancedPointSources();
+
 	update(0);
 }
 
+void StelSkyDrawer::initInstancedPointSources()
+{
+	useInstancing = false;
+#if QT_VERSION >= 0x050600
+	if (!StelApp::getInstance().getSettings()->value("stars/flag_instanced_point_sources", true).toBool())
+		return;
+
+	// Instanced arrays are core since OpenGL 3.3 and OpenGL ES 3.0
+	QOpenGLContext* ctx = QOpenGLContext::currentContext();
+	const QPair<int, int> version = ctx->format().version();
+	if (version < (ctx->isOpenGLES() ? qMakePair(3, 0) : qMakePair(3, 3)))
+	{
+		qDebug() << "StelSkyDrawer: instanced point sources not available, using vertex arrays";
+		return;
+	}
+
+	QOpenGLShader vshader(QOpenGLShader::Vertex);
+	const char *vsrc =
+		"attribute mediump vec2 corner;\n"
+		"attribute mediump vec2 pos;\n"
+		"attribute mediump float radius;\n"
+		"attribute mediump vec3 color;\n"
+		"uniform mediump mat4 projectionMatrix;\n"
+		"varying mediump vec2 texc;\n"
+		"varying mediump vec3 outColor;\n"
+		"void main(void)\n"
+		"{\n"
+		"    gl_Position = projectionMatrix * vec4(pos + corner*radius, 0, 1);\n"
+		"    texc = corner*0.5 + 0.5;\n"
+		"    outColor = color;\n"
+		"}\n";
+	vshader.compileSourceCode(vsrc);
+	if (!vshader.log().isEmpty()) { qWarning() << "StelSkyDrawer::initInstancedPointSources(): Warnings while compiling vshader: " << vshader.log(); }
+
+	QOpenGLShader fshader(QOpenGLShader::Fragment);
+	const char *fsrc =
+		"varying mediump vec2 texc;\n"
+		"varying mediump vec3 outColor;\n"
+		"uniform sampler2D tex;\n"
+		"void main(void)\n"
+		"{\n"
+		"    gl_FragColor = texture2D(tex, texc)*vec4(outColor, 1.);\n"
+		"}\n";
+	fshader.compileSourceCode(fsrc);
+	if (!fshader.log().isEmpty()) { qWarning() << "StelSkyDrawer::initInstancedPointSources(): Warnings while compiling fshader: " << fshader.log(); }
+
+	starInstancedShaderProgram = new QOpenGLShaderProgram(QOpenGLContext::currentContext());
+	starInstancedShaderProgram->addShader(&vshader);
+	starInstancedShaderProgram->addShader(&fshader);
+	if (!StelPainter::linkProg(starInstancedShaderProgram, "starInstancedShader"))
+	{
+		delete starInstancedShaderProgram;
+		starInstancedShaderProgram = Q_NULLPTR;
+		return;
+	}
+	starInstancedShaderVars.projectionMatrix = starInstancedShaderProgram->uniformLocation("projectionMatrix");
+	starInstancedShaderVars.corner = starInstancedShaderProgram->attributeLocation("corner");
+	starInstancedShaderVars.pos = starInstancedShaderProgram->attributeLocation("pos");
+	starInstancedShaderVars.radius = starInstancedShaderProgram->attributeLocation("radius");
+	starInstancedShaderVars.color = starInstancedShaderProgram->attributeLocation("color");
+	useInstancing = true;
+	qDebug() << "StelSkyDrawer: using instanced point sources";
+#endif
+}
+
 void StelSkyDrawer::update(double)
 {
 	float fov = core->getMovementMgr()->getCurrentFov();
@@ -384,6 +479,78 @@ bool StelSkyDrawer::computeRCMag(float mag, RCMag* rcMag) const
 	return true;
 }
 
+void StelSkyDrawer::checkRCMagParameters()
+{
+	// The radius computed by computeRCMag() is exp(a*mag+b) times a scale factor, so two
+	// samples of the tone reproducer and the scale factor describe all its parameters.
+	const float pFact = starRelativeScale*1.40f/2.f;
+	float params[5];
+	params[0] = eye->adaptLuminanceScaledLn(0.f, pFact);
+	params[1] = eye->adaptLuminanceScaledLn(1.f, pFact);
+	params[2] = pointSourceMagToLnLuminance(0.f);
+	params[3] = pFact;
+	params[4] = starLinearScale;
+#ifndef USE_OLD_QGLWIDGET
+	params[4] *= StelMainView::getInstance().getCustomScreenshotMagnification();
+#endif
+	if (memcmp(params, rcMagParameters, sizeof(params)) != 0)
+	{
+		memcpy(rcMagParameters, params, sizeof(params));
+		++rcMagGeneration;
+	}
+}
+
+const RCMag* StelSkyDrawer::getRCMagTable(float magMin, float magStep, int size, int* limitIndex)
+{
+	checkRCMagParameters();
+
+	RCMagTable* t = Q_NULLPTR;
+	for (auto* table : rcMagTables)
+	{
+		if (table->magMin==magMin && table->magStep==magStep && table->table.size()==size)
+		{
+			t = table;
+			break;
+		}
+	}
+	if (!t)
+	{
+		t = new RCMagTable;
+		t->magMin = magMin;
+		t->magStep = magStep;
+		t->generation = rcMagGeneration-1;
+		t->table.resize(size);
+		rcMagTables.append(t);
+	}
+
+	if (t->generation != rcMagGeneration)
+	{
+		RCMag* table = t->table.data();
+		t->limitIndex = size-1;
+		for (int i=0;i<size;++i)
+		{
+			if (computeRCMag(magMin+magStep*i, &table[i])==false)
+			{
+				// The last magnitude at which the source is visible
+				t->limitIndex = i-1;
+				// Sources are not visible anymore, fill the rest of the table with zero.
+				for (;i<size;++i)
+					table[i].radius = table[i].luminance = 0.f;
+				break;
+			}
+		}
+		t->generation = rcMagGeneration;
+	}
+
+	if (limitIndex)
+	{
+		*limitIndex = t->limitIndex;
+		if (starMagLimitReduction>0.f)
+			*limitIndex = qMin(*limitIndex, qMax(-1, (int)std::floor((limitMagnitude-starMagLimitReduction-magMin)/magStep)));
+	}
+	return t->table.constData();
+}
+
 void StelSkyDrawer::preDrawPointSource(StelPainter* p)
 {
 	Q_ASSERT(p);
@@ -406,6 +573,46 @@ void StelSkyDrawer::postDrawPointSource(StelPainter* sPainter)
 
 	const Mat4f& m = sPainter->getProjector()->getProjectionMatrix();
 	const QMatrix4x4 qMat(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
+
+#if QT_VERSION >= 0x050600
+	if (useInstancing)
+	{
+		// Corners of the sprite as a triangle strip, shared by all instances
+		static const GLfloat corners[] = {-1.f, -1.f, 1.f, -1.f, -1.f, 1.f, 1.f, 1.f};
+		QOpenGLExtraFunctions* gl = QOpenGLContext::currentContext()->extraFunctions();
+
+		starInstancedShaderProgram->bind();
+		starInstancedShaderProgram->setAttributeArray(starInstancedShaderVars.corner, GL_FLOAT, corners, 2, 0);
+		starInstancedShaderProgram->enableAttributeArray(starInstancedShaderVars.corner);
+		starInstancedShaderProgram->setAttributeArray(starInstancedShaderVars.pos, GL_FLOAT, (GLfloat*)instanceArray, 2, sizeof(StarInstance));
+		starInstancedShaderProgram->enableAttributeArray(starInstancedShaderVars.pos);
+		starInstancedShaderProgram->setAttributeArray(starInstancedShaderVars.radius, GL_FLOAT, &(instanceArray[0].radius), 1, sizeof(StarInstance));
+		starInstancedShaderProgram->enableAttributeArray(starInstancedShaderVars.radius);
+		starInstancedShaderProgram->setAttributeArray(starInstancedShaderVars.color, GL_UNSIGNED_BYTE, (GLubyte*)&(instanceArray[0].color), 3, sizeof(StarInstance));
+		starInstancedShaderProgram->enableAttributeArray(starInstancedShaderVars.color);
+		starInstancedShaderProgram->setUniformValue(starInstancedShaderVars.projectionMatrix, qMat);
+		gl->glVertexAttribDivisor(starInstancedShaderVars.pos, 1);
+		gl->glVertexAttribDivisor(starInstancedShaderVars.radius, 1);
+		gl->glVertexAttribDivisor(starInstancedShaderVars.color, 1);
+
+		gl->glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, nbPointSources);
+		StelFrameProfiler::count(StelFrameProfiler::DrawCalls);
+		StelFrameProfiler::count(StelFrameProfiler::Vertices, 4*nbPointSources);
+
+		// Other users of these attribute locations expect one value per vertex
+		gl->glVertexAttribDivisor(starInstancedShaderVars.pos, 0);
+		gl->glVertexAttribDivisor(starInstancedShaderVars.radius, 0);
+		gl->glVertexAttribDivisor(starInstancedShaderVars.color, 0);
+		starInstancedShaderProgram->disableAttributeArray(starInstancedShaderVars.corner);
+		starInstancedShaderProgram->disableAttributeArray(starInstancedShaderVars.pos);
+		starInstancedShaderProgram->disableAttributeArray(starInstancedShaderVars.radius);
+		starInstancedShaderProgram->disableAttributeArray(starInstancedShaderVars.color);
+		starInstancedShaderProgram->release();
+
+		nbPointSources = 0;
+		return;
+	}
+#endif
 	
 	starShaderProgram->bind();
 	starShaderProgram->setAttributeArray(starShaderVars.pos, GL_FLOAT, (GLfloat*)vertexArray, 2, sizeof(StarVertex));
@@ -417,6 +624,8 @@ void StelSkyDrawer::postDrawPointSource(StelPainter* sPainter)
 	starShaderProgram->enableAttributeArray(starShaderVars.texCoord);
 	
 	glDrawArrays(GL_TRIANGLES, 0, nbPointSources*6);
+	StelFrameProfiler::count(StelFrameProfiler::DrawCalls);
+	StelFrameProfiler::count(StelFrameProfiler::Vertices, nbPointSources*6);
 	
 	starShaderProgram->disableAttributeArray(starShaderVars.pos);
 	starShaderProgram->disableAttributeArray(starShaderVars.color);
@@ -438,6 +647,16 @@ bool StelSkyDrawer::drawPointSource(StelPainter* sPainter, const Vec3f& v, const
 	if (!(checkInScreen ? sPainter->getProjector()->projectCheck(v, win) : sPainter->getProjector()->project(v, win)))
 		return false;
 
+	return drawProjectedPointSource(sPainter, win, rcMag, color, twinkleFactor);
+}
+
+bool StelSkyDrawer::drawProjectedPointSource(StelPainter* sPainter, const Vec3f& win, const RCMag& rcMag, const Vec3f& color, float twinkleFactor)
+{
+	Q_ASSERT(sPainter);
+
+	if (rcMag.radius<=0.f)
+		return false;
+
 	const float radius = rcMag.radius;
 	// Random coef for star twinkling. twinkleFactor can introduce height-dependent twinkling.
 	const float tw = (flagStarTwinkle && (flagHasAtmosphere || flagForcedTwinkle)) ? (1.f-twinkleFactor*twinkleAmount*qrand()/RAND_MAX)*rcMag.luminance : rcMag.luminance;
@@ -461,14 +680,25 @@ bool StelSkyDrawer::drawPointSource(StelPainter* sPainter, const Vec3f& v, const
 	starColor[1] = (unsigned char)std::min((int)(color[1]*tw*255+0.5f), 255);
 	starColor[2] = (unsigned char)std::min((int)(color[2]*tw*255+0.5f), 255);
 	
-	// Store the drawing instructions in the vertex arrays
-	StarVertex* vx = &(vertexArray[nbPointSources*6]);
-	vx->pos.set(win[0]-radius,win[1]-radius); memcpy(vx->color, starColor, 3); ++vx;
-	vx->pos.set(win[0]+radius,win[1]-radius); memcpy(vx->color, starColor, 3); ++vx;
-	vx->pos.set(win[0]+radius,win[1]+radius); memcpy(vx->color, starColor, 3); ++vx;
-	vx->pos.set(win[0]-radius,win[1]-radius); memcpy(vx->color, starColor, 3); ++vx;
-	vx->pos.set(win[0]+radius,win[1]+radius); memcpy(vx->color, starColor, 3); ++vx;
-	vx->pos.set(win[0]-radius,win[1]+radius); memcpy(vx->color, starColor, 3); ++vx;
+	if (useInstancing)
+	{
+		// Store one record, the sprite corners are computed in the vertex shader
+		StarInstance* inst = &(instanceArray[nbPointSources]);
+		inst->pos.set(win[0], win[1]);
+		inst->radius = radius;
+		memcpy(inst->color, starColor, 3);
+	}
+	else
+	{
+		// Store the drawing instructions in the vertex arrays
+		StarVertex* vx = &(vertexArray[nbPointSources*6]);
+		vx->pos.set(win[0]-radius,win[1]-radius); memcpy(vx->color, starColor, 3); ++vx;
+		vx->pos.set(win[0]+radius,win[1]-radius); memcpy(vx->color, starColor, 3); ++vx;
+		vx->pos.set(win[0]+radius,win[1]+radius); memcpy(vx->color, starColor, 3); ++vx;
+		vx->pos.set(win[0]-radius,win[1]-radius); memcpy(vx->color, starColor, 3); ++vx;
+		vx->pos.set(win[0]+radius,win[1]+radius); memcpy(vx->color, starColor, 3); ++vx;
+		vx->pos.set(win[0]-radius,win[1]+radius); memcpy(vx->color, starColor, 3); ++vx;
+	}
 
 	++nbPointSources;
 	if (nbPointSources>=maxPointSources)
@@ -689,6 +919,23 @@ void StelSkyDrawer::setBortleScaleIndex(int bIndex)
 	}
 }
 
+void StelSkyDrawer::setLightPollutionMap(const LightPollutionMapP& map, float pollutionLuminance)
+{
+	lightPollutionMap = map;
+	limitMagnitudeOffsets.clear();
+	if (!map)
+		return;
+
+	// Natural brightness of the night sky, about 21.8 mag/arcsec^2 [cd/m^2]
+	static const float naturalSkyLuminance = 0.0002f;
+	// Near the threshold of dark adapted vision, the limit magnitude changes with the square root of the background
+	const float average = naturalSkyLuminance+pollutionLuminance;
+	const QVector<float>& factors = map->getFactors();
+	limitMagnitudeOffsets.resize(factors.size());
+	for (int i=0; i<factors.size(); ++i)
+		limitMagnitudeOffsets[i] = -1.25f*std::log10((naturalSkyLuminance+pollutionLuminance*factors.at(i))/average);
+}
+
 float StelSkyDrawer::getNELMFromBortleScale() const
 {
 	float nelm = 0.f;
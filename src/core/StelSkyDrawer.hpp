@@ -25,8 +25,11 @@
 #include "StelProjectorType.hpp"
 #include "VecMath.hpp"
 #include "StelOpenGL.hpp"
+#include "LightPollutionMap.hpp"
 
 #include <QObject>
+#include <QList>
+#include <QVector>
 
 class StelToneReproducer;
 class StelCore;
@@ -107,6 +110,20 @@ public:
 
 	bool drawPointSource(StelPainter* sPainter, const Vec3f& v, const RCMag &rcMag, const Vec3f& bcolor, bool checkInScreen=false, float twinkleFactor=1.0f);
 
+	//! Draw a point source halo at an already projected position, e.g. computed with StelProjector::projectBatch().
+	//! @param sPainter the StelPainter to use for drawing.
+	//! @param win the position of the source in the viewport 2D frame
+	//! @param rcMag the radius and luminance of the source as computed by computeRCMag()
+	//! @param bV the source B-V index
+	//! @param twinkleFactor allows height-dependent twinkling. Recommended value: min(1,1-0.9*sin(altitude)). Allowed values [0..1]
+	//! @return true if the source was actually drawn
+	bool drawProjectedPointSource(StelPainter* sPainter, const Vec3f& win, const RCMag &rcMag, unsigned int bV, float twinkleFactor=1.0f)
+	{
+		return drawProjectedPointSource(sPainter, win, rcMag, colorTable[bV], twinkleFactor);
+	}
+
+	bool drawProjectedPointSource(StelPainter* sPainter, const Vec3f& win, const RCMag &rcMag, const Vec3f& bcolor, float twinkleFactor=1.0f);
+
 	void drawSunCorona(StelPainter* painter, const Vec3f& v, float radius, const Vec3f& color, const float alpha);
 
 	//! Terminate drawing of a 3D model, draw the halo
@@ -123,6 +140,16 @@ public:
 	//! @return false if the object is too faint to be displayed
 	bool computeRCMag(float mag, RCMag*) const;
 
+	//! Get RMag and CMag for regularly spaced magnitudes, e.g. the magnitude steps of a star catalog.
+	//! Tables are kept between frames, and only recomputed when a parameter used by computeRCMag() changed.
+	//! @param magMin the magnitude of the first entry
+	//! @param magStep the magnitude difference between consecutive entries
+	//! @param size the number of entries
+	//! @param limitIndex if not null, set to the index of the faintest visible entry, or -1 if no entry is visible
+	//! @return a table of size entries, which are zero when fainter than the limit. It is updated in place
+	//! by the next call with the same arguments after the parameters changed.
+	const RCMag* getRCMagTable(float magMin, float magStep, int size, int* limitIndex = Q_NULLPTR);
+
 	//! Report that an object of luminance lum with an on-screen area of area pixels is currently displayed
 	//! This information is used to determine the world adaptation luminance
 	//! This method should be called during the update operations of the main loop
@@ -201,6 +228,19 @@ public slots:
 	//! It depends on the zoom level, on the eye adapation and on the point source rendering parameters
 	//! @return the limit V mag at which a point source will be displayed
 	float getLimitMagnitude() const {return limitMagnitude;}
+	//! Get the magnitude of the currently faintest visible point source in a direction of the sky.
+	//! This is getLimitMagnitude() corrected for the brighter or darker sky given by the light pollution map.
+	//! @param altAzPos direction in the AltAz frame, not necessarily normalized.
+	float getLimitMagnitude(const Vec3d& altAzPos) const
+	{
+		return lightPollutionMap ? limitMagnitude+lightPollutionMap->sample(limitMagnitudeOffsets, altAzPos) : limitMagnitude;
+	}
+
+	//! Set the directional distribution of the light pollution, and cache the change of the limit magnitude
+	//! in each direction of the map.
+	//! @param map the map of the site, or a null pointer for a uniform light pollution.
+	//! @param pollutionLuminance the average light pollution luminance in cd/m^2.
+	void setLightPollutionMap(const LightPollutionMapP& map, float pollutionLuminance);
 
 	//! Toggle the application of user-defined star magnitude limit.
 	//! If enabled, stars fainter than the magnitude set with
@@ -240,6 +280,12 @@ public slots:
 	//! In force only if flagPlanetMagnitudeLimit is set.
 	void setCustomPlanetMagnitudeLimit(double limit) {if(limit!=customPlanetMagLimit){ customPlanetMagLimit=limit; emit customPlanetMagLimitChanged(limit);}}
 
+	//! Set by how many magnitudes the faintest stars drawn from the catalogs are brighter than the limit magnitude.
+	//! This is used by StelQualityGovernor to draw less stars, independently of the user-defined star magnitude limit.
+	//! It applies to the limit index returned by getRCMagTable(). Default 0.
+	void setStarMagnitudeLimitReduction(float mag) {starMagLimitReduction = qMax(0.f, mag);}
+	float getStarMagnitudeLimitReduction() const {return starMagLimitReduction;}
+
 	//! Get the luminance of the faintest visible object (e.g. RGB<0.05)
 	//! It depends on the zoom level, on the eye adapation and on the point source rendering parameters
 	//! @return the limit V luminance at which an object will be visible
@@ -403,12 +449,33 @@ private:
 
 	float starLinearScale;	// optimization variable
 
+	//! A table of RCMag returned by getRCMagTable()
+	struct RCMagTable
+	{
+		float magMin;
+		float magStep;
+		int limitIndex;
+		quint64 generation;	// value of rcMagGeneration when the table was computed
+		QVector<RCMag> table;
+	};
+	QList<RCMagTable*> rcMagTables;
+
+	//! Increment rcMagGeneration if a parameter used by computeRCMag() changed since the last call.
+	void checkRCMagParameters();
+	float rcMagParameters[5];
+	quint64 rcMagGeneration;
+
 	//! Current magnitude limit for point sources
 	float limitMagnitude;
 
 	//! Current magnitude luminance
 	float limitLuminance;
 
+	//! Directional distribution of the light pollution, null if uniform
+	LightPollutionMapP lightPollutionMap;
+	//! Change of the limit magnitude in the cells of lightPollutionMap
+	QVector<float> limitMagnitudeOffsets;
+
 	//! User-defined magnitude limit for stars.
 	//! Interpreted as a lower limit - stars fainter than this value will not
 	//! be displayed.
@@ -426,6 +493,8 @@ private:
 	//! be displayed.
 	//! Used if flagPlanetMagnitudeLimit is true.
 	double customPlanetMagLimit;
+	//! @see setStarMagnitudeLimitReduction()
+	float starMagLimitReduction;
 
 	//! Little halo texture
 	StelTextureSP texHalo;
@@ -466,6 +535,33 @@ private:
 		int texture;
 	};
 	StarShaderVars starShaderVars;
+
+	//! Per-instance record for a point source when drawing with instancing.
+	//! The vertex shader expands it to a sprite, instead of storing 6 vertices per source.
+	struct StarInstance {
+		Vec2f pos;
+		float radius;
+		unsigned char color[4];
+	};
+	static_assert(sizeof(StarInstance) == 16, "Size of StarInstance must be 16 bytes");
+
+	//! Whether point sources are drawn with instanced rendering (needs OpenGL 3.3 or OpenGL ES 3.0)
+	bool useInstancing;
+	//! Buffer for storing the per-instance data when useInstancing is set
+	StarInstance* instanceArray;
+
+	class QOpenGLShaderProgram* starInstancedShaderProgram;
+	struct StarInstancedShaderVars {
+		int projectionMatrix;
+		int corner;
+		int pos;
+		int radius;
+		int color;
+	};
+	StarInstancedShaderVars starInstancedShaderVars;
+
+	//! Create the shader used for instanced point sources, and set useInstancing if it can be used.
+	void initInstancedPointSources();
 	
 	//! Current number of sources stored in the buffers (still to display)
 	unsigned int nbPointSources;
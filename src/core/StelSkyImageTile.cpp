@@ -33,6 +33,12 @@
 
 #include <cstdio>
 
+namespace
+{
+	//! The number of subtiles which can be created by a layer in each frame
+	const int maxNewTilesPerFrame = 32;
+}
+
 StelSkyImageTile::StelSkyImageTile()
 {
 	initCtor();
@@ -45,7 +51,9 @@ void StelSkyImageTile::initCtor()
 	alphaBlend = false;
 	noTexture = false;
 	texFader = Q_NULLPTR;
+	texPriority = 0.f;
 	birthJD = -1e10;
+	boundingCap = SphericalCap(Vec3d(1,0,0), -2);
 }
 
 // Constructor
@@ -83,7 +91,9 @@ void StelSkyImageTile::draw(StelCore* core, StelPainter& sPainter, float)
 
 	const float limitLuminance = core->getSkyDrawer()->getLimitLuminance();
 	QMultiMap<double, StelSkyImageTile*> result;
-	getTilesToDraw(result, core, prj->getViewportConvexPolygon(0, 0), limitLuminance, true);
+	const SphericalRegionP viewPortPoly = prj->getViewportConvexPolygon(0, 0);
+	int newTilesBudget = maxNewTilesPerFrame;
+	getTilesToDraw(result, core, viewPortPoly, viewPortPoly->getBoundingCap(), limitLuminance, newTilesBudget, true);
 
 	int numToBeLoaded=0;
 	for (auto* t : result)
@@ -104,7 +114,8 @@ void StelSkyImageTile::draw(StelCore* core, StelPainter& sPainter, float)
 }
 
 // Return the list of tiles which should be drawn.
-void StelSkyImageTile::getTilesToDraw(QMultiMap<double, StelSkyImageTile*>& result, StelCore* core, const SphericalRegionP& viewPortPoly, float limitLuminance, bool recheckIntersect)
+void StelSkyImageTile::getTilesToDraw(QMultiMap<double, StelSkyImageTile*>& result, StelCore* core, const SphericalRegionP& viewPortPoly,
+				      const SphericalCap& viewPortCap, float limitLuminance, int& newTilesBudget, bool recheckIntersect)
 {
 
 #ifndef NDEBUG
@@ -159,6 +170,10 @@ void StelSkyImageTile::getTilesToDraw(QMultiMap<double, StelSkyImageTile*>& resu
 			fullInScreen=false;
 			intersectScreen=true;
 		}
+		else if (!viewPortCap.intersects(boundingCap))
+		{
+			fullInScreen=false;
+		}
 		else
 		{
 			for (const auto& poly : skyConvexPolygons)
@@ -201,6 +216,9 @@ void StelSkyImageTile::getTilesToDraw(QMultiMap<double, StelSkyImageTile*>& resu
 				errorOccured = true;
 				return;
 			}
+			// The coarse tiles first, then those close to the center of the view
+			texPriority = 0.5f*(1.f+static_cast<float>(boundingCap.n*viewPortCap.n))/(1+getLevel());
+			tex->setLoadPriority(texPriority);
 		}
 
 		// The tile is in screen and has a texture: every test passed :) The tile will be displayed
@@ -211,26 +229,26 @@ void StelSkyImageTile::getTilesToDraw(QMultiMap<double, StelSkyImageTile*>& resu
 	const double degPerPixel = 1./core->getProjection(StelCore::FrameJ2000)->getPixelPerRadAtCenter()*180./M_PI;
 	if (degPerPixel < minResolution)
 	{
-		if (subTiles.isEmpty() && !subTilesUrls.isEmpty())
+		// Load the sub tiles because we reached the maximum resolution and they are not yet loaded.
+		// Large sets are created over several frames, the polygons of the tiles are built by their constructor.
+		while (subTiles.size()<subTilesUrls.size() && newTilesBudget>0)
 		{
-			// Load the sub tiles because we reached the maximum resolution and they are not yet loaded
-			for (const auto& s : subTilesUrls)
+			const QVariant& s = subTilesUrls.at(subTiles.size());
+			StelSkyImageTile* nt;
+			if (s.type()==QVariant::Map)
+				nt = new StelSkyImageTile(s.toMap(), this);
+			else
 			{
-				StelSkyImageTile* nt;
-				if (s.type()==QVariant::Map)
-					nt = new StelSkyImageTile(s.toMap(), this);
-				else
-				{
-					Q_ASSERT(s.type()==QVariant::String);
-					nt = new StelSkyImageTile(s.toString(), this);
-				}
-				subTiles.append(nt);
+				Q_ASSERT(s.type()==QVariant::String);
+				nt = new StelSkyImageTile(s.toString(), this);
 			}
+			subTiles.append(nt);
+			--newTilesBudget;
 		}
 		// Try to add the subtiles
 		for (auto* tile : subTiles)
 		{
-			qobject_cast<StelSkyImageTile*>(tile)->getTilesToDraw(result, core, viewPortPoly, limitLuminance, !fullInScreen);
+			qobject_cast<StelSkyImageTile*>(tile)->getTilesToDraw(result, core, viewPortPoly, viewPortCap, limitLuminance, newTilesBudget, !fullInScreen);
 		}
 	}
 	else
@@ -478,6 +496,26 @@ void StelSkyImageTile::loadFromQVariantMap(const QVariantMap& map)
 		}
 	}
 
+	// The cap around the caps of the polygons, centered on their mean direction
+	if (!skyConvexPolygons.isEmpty())
+	{
+		Vec3d center(0.);
+		for (const auto& poly : skyConvexPolygons)
+			center += poly->getBoundingCap().n;
+		if (center.lengthSquared()>0.)
+		{
+			center.normalize();
+			double radius = 0.;
+			for (const auto& poly : skyConvexPolygons)
+			{
+				const SphericalCap cap = poly->getBoundingCap();
+				radius = qMax(radius, std::acos(qBound(-1., center*cap.n, 1.))+std::acos(qBound(-1., cap.d, 1.)));
+			}
+			if (radius<M_PI)
+				boundingCap = SphericalCap(center, std::cos(radius));
+		}
+	}
+
 	if (map.contains("imageUrl"))
 	{
 		QString imageUrl = map.value("imageUrl").toString();
@@ -524,6 +562,13 @@ void StelSkyImageTile::loadFromQVariantMap(const QVariantMap& map)
 // 	}
 }
 
+void StelSkyImageTile::setLoadPriority(bool scheduledForDeletion)
+{
+	MultiLevelJsonBase::setLoadPriority(scheduledForDeletion);
+	if (tex)
+		tex->setLoadPriority(scheduledForDeletion ? priorityScheduledForDeletion : texPriority);
+}
+
 // Convert the image informations to a map following the JSON structure.
 QVariantMap StelSkyImageTile::toQVariantMap() const
 {
@@ -60,7 +60,10 @@ public:
 	QString infoURL;
 };
 
-//! Base class for any astro image with a fixed position
+//! Base class for any astro image with a fixed position.
+//! The tiles outside the view are rejected with the bounding cap of their polygons before the polygons are tested,
+//! the textures of the visible tiles are loaded by priority, the coarse tiles near the center of the view first,
+//! and the subtiles described in the JSON file of their parent are created a few at a time per frame.
 class StelSkyImageTile : public MultiLevelJsonBase
 {
 	Q_OBJECT
@@ -106,6 +109,9 @@ protected:
 	//! Load the tile from a valid QVariantMap.
 	virtual void loadFromQVariantMap(const QVariantMap& map);
 
+	//! Also lower the priority of the texture which is still loading.
+	virtual void setLoadPriority(bool scheduledForDeletion) Q_DECL_OVERRIDE;
+
 	//! The credits of the server where this data come from
 	ServerCredits serverCredits;
 
@@ -127,6 +133,9 @@ protected:
 	//! list of all the polygons.
 	QList<SphericalRegionP> skyConvexPolygons;
 
+	//! The cap containing all the polygons, the whole sky if there is none
+	SphericalCap boundingCap;
+
 	//! The texture of the tile
 	StelTextureSP tex;
 
@@ -142,7 +151,10 @@ private:
 
 	//! Return the list of tiles which should be drawn.
 	//! @param result a map containing resolution, pointer to the tiles
-	void getTilesToDraw(QMultiMap<double, StelSkyImageTile*>& result, StelCore* core, const SphericalRegionP& viewPortPoly, float limitLuminance, bool recheckIntersect=true);
+	//! @param viewPortCap the bounding cap of viewPortPoly
+	//! @param newTilesBudget the number of subtiles which can still be created in this frame, decremented for each one
+	void getTilesToDraw(QMultiMap<double, StelSkyImageTile*>& result, StelCore* core, const SphericalRegionP& viewPortPoly,
+			    const SphericalCap& viewPortCap, float limitLuminance, int& newTilesBudget, bool recheckIntersect=true);
 
 	//! Draw the image on the screen.
 	//! @return true if the tile was actually displayed
@@ -157,6 +169,9 @@ private:
 	// Used for smooth fade in
 	QTimeLine* texFader;
 
+	//! The load priority of the texture while the tile is visible
+	float texPriority;
+
 	QString htmlDescription;
 };
 
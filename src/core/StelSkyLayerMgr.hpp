@@ -155,7 +155,9 @@ public slots:
 	//! The image is owned by the manager and will be destroyed at the end of the program
 	//! or when removeSkyImage is called with the same URI
 	//! @param uri the local file or the URL where the JSON image description is located.
-	//! @param keyHint a hint on which key to use for later referencing the image.
+	//! The description is loaded in the background, and the image is drawn once it is loaded.
+	//! @param keyHint a hint on which key to use for later referencing the image. As the short name of the
+	//! image is not known yet, the key is this hint, or "no name" if it is empty.
 	//! @param show defined whether the image should be shown by default.
 	//! @return the reference key to use when accessing this image later on.
 	QString insertSkyImage(const QString& uri, const QString& keyHint=QString(), bool show=true);
@@ -112,6 +112,61 @@ SphericalCap SphericalRegion::getBoundingCap() const
 	return res;
 }
 
+namespace
+{
+	// Used by SphericalRegion::getFillMaxSideLength() to find the smallest cosine of the angle between two vertices of a triangle
+	struct MinSideCos
+	{
+		double minCos = 1.;
+
+		void operator()(const Vec3d* v0, const Vec3d* v1, const Vec3d* v2, const Vec2f*, const Vec2f*, const Vec2f*,
+				const Vec3f*, const Vec3f*, const Vec3f*, unsigned int, unsigned int, unsigned int)
+		{
+			minCos = qMin(minCos, qMin(*v0 * *v1, qMin(*v1 * *v2, *v2 * *v0)));
+		}
+	};
+}
+
+double SphericalRegion::getFillMaxSideLength() const
+{
+	if (fillMaxSideLength<0.)
+	{
+		const MinSideCos res = getFillVertexArray().foreachTriangle(MinSideCos());
+		fillMaxSideLength = std::acos(qBound(-1., res.minCos, 1.));
+	}
+	return fillMaxSideLength;
+}
+
+const StelVertexArray* SphericalRegion::getSubdividedFillVertexArray(int level, int maxVertices) const
+{
+	Q_ASSERT(level>=1);
+	if (level<=subdividedFillCache.size())
+		return &subdividedFillCache.at(level-1);
+
+	// Each subdivision multiplies the number of triangles by 4
+	const StelVertexArray base = subdividedFillCache.isEmpty() ? getFillVertexArray() : subdividedFillCache.last();
+	int nbTriangles;
+	if (!subdividedFillCache.isEmpty())
+		nbTriangles = base.vertex.size()/3;
+	else
+	{
+		struct TriangleCounter
+		{
+			int n = 0;
+			void operator()(const Vec3d*, const Vec3d*, const Vec3d*, const Vec2f*, const Vec2f*, const Vec2f*,
+					const Vec3f*, const Vec3f*, const Vec3f*, unsigned int, unsigned int, unsigned int) {++n;}
+		};
+		nbTriangles = base.foreachTriangle(TriangleCounter()).n;
+	}
+	const qint64 nbVertices = 3LL*nbTriangles << (2*(level-subdividedFillCache.size()));
+	if (nbVertices>maxVertices)
+		return Q_NULLPTR;
+
+	while (subdividedFillCache.size()<level)
+		subdividedFillCache.append(subdividedFillCache.isEmpty() ? base.subdivideTriangles() : subdividedFillCache.last().subdivideTriangles());
+	return &subdividedFillCache.at(level-1);
+}
+
 bool SphericalRegion::contains(const SphericalPolygon& r) const {return containsDefault(&r);}
 bool SphericalRegion::contains(const SphericalConvexPolygon& r) const {return containsDefault(&r);}
 bool SphericalRegion::contains(const SphericalCap& r) const {return containsDefault(&r);}
@@ -293,6 +348,8 @@ SphericalRegionP SphericalRegion::getUnionDefault(const SphericalRegion* r) cons
 // Return a new SphericalPolygon consisting of the subtraction of the given SphericalPolygon from this.
 SphericalRegionP SphericalRegion::getSubtractionDefault(const SphericalRegion* r) const
 {
+	if (!getBoundingCap().intersects(r->getBoundingCap()))
+		return SphericalRegionP(new SphericalPolygon(getOctahedronPolygon()));
 	OctahedronPolygon resOct(getOctahedronPolygon());
 	resOct.inPlaceSubtraction(r->getOctahedronPolygon());
 	return SphericalRegionP(new SphericalPolygon(resOct));
@@ -815,7 +872,12 @@ SphericalRegionP SphericalPolygon::multiIntersection(const QList<SphericalRegion
 		return EmptySphericalRegion::staticInstance;
 	SphericalRegionP reg = regions.at(0);
 	for (int i=1;i<regions.size();++i)
+	{
+		// The intersection with the remaining regions stays empty
+		if (reg->getType()==SphericalRegion::Empty)
+			break;
 		reg = reg->getIntersection(regions.at(i));
+	}
 	return reg;
 }
 
@@ -995,8 +1057,21 @@ bool SphericalConvexPolygon::intersects(const SphericalPolygon& poly) const
 }
 
 // This algo is wrong
+OctahedronPolygon SphericalConvexPolygon::getOctahedronPolygon() const
+{
+	if (!octahedronPolygonCached)
+	{
+		cachedOctahedronPolygon = OctahedronPolygon(contour);
+		octahedronPolygonCached = true;
+	}
+	return cachedOctahedronPolygon;
+}
+
 void SphericalConvexPolygon::updateBoundingCap()
 {
+	clearSubdividedFillCache();
+	octahedronPolygonCached = false;
+	cachedOctahedronPolygon = OctahedronPolygon();
 	Q_ASSERT(contour.size()>2);
 	// Use this crapy algorithm instead
 	cachedBoundingCap.n.set(0,0,0);
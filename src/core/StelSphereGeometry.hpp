@@ -184,6 +184,18 @@ public:
 	//! @return a list of vertex which taken 2 by 2 define the contours of the polygon.
 	virtual StelVertexArray getOutlineVertexArray() const {return getOctahedronPolygon().getOutlineVertexArray();}
 
+	//! Return the triangles of getFillVertexArray() split level times by StelVertexArray::subdivideTriangles().
+	//! This is view independent: the arrays are computed on first use and kept in the region until its contour is set again.
+	//! Only SphericalPolygon and SphericalConvexPolygon and their subclasses discard the arrays when their contour changes.
+	//! @param level number of subdivisions, at least 1.
+	//! @param maxVertices the array is not computed if it would have more vertices.
+	//! @return Q_NULLPTR if the array would have more than maxVertices vertices.
+	const StelVertexArray* getSubdividedFillVertexArray(int level, int maxVertices) const;
+
+	//! Return the largest angular length in radian of the sides of the triangles of getFillVertexArray().
+	//! The value is cached like the arrays of getSubdividedFillVertexArray().
+	double getFillMaxSideLength() const;
+
 	//! Get the contours defining the SphericalPolygon when combined using a positive winding rule.
 	//! The default implementation return a list of tesselated triangles derived from the OctahedronPolygon.
 	virtual QVector<QVector<Vec3d > > getSimplifiedContours() const;
@@ -255,7 +267,16 @@ public:
 	SphericalRegionP getSubtraction(const AllSkySphericalRegion& r) const;
 	virtual SphericalRegionP getSubtraction(const EmptySphericalRegion& r) const;
 
+protected:
+	//! Discard the arrays of getSubdividedFillVertexArray(). To be called when the contour of the region changes.
+	void clearSubdividedFillCache() {subdividedFillCache.clear(); fillMaxSideLength=-1.;}
+
 private:
+	//! Cached arrays for getSubdividedFillVertexArray(), the array at index i has been subdivided i+1 times.
+	mutable QVector<StelVertexArray> subdividedFillCache;
+	//! Cached value of getFillMaxSideLength(), negative if not computed yet.
+	mutable double fillMaxSideLength = -1.;
+
 	bool containsDefault(const SphericalRegion* r) const;
 	bool intersectsDefault(const SphericalRegion* r) const;
 	SphericalRegionP getIntersectionDefault(const SphericalRegion* r) const;
@@ -599,11 +620,11 @@ public:
 	//! Set the contours defining the SphericalPolygon.
 	//! @param contours the list of contours defining the polygon area. The contours are combined using
 	//! the positive winding rule, meaning that the polygon is the union of the positive contours minus the negative ones.
-	void setContours(const QVector<QVector<Vec3d> >& contours) {octahedronPolygon = OctahedronPolygon(contours);}
+	void setContours(const QVector<QVector<Vec3d> >& contours) {octahedronPolygon = OctahedronPolygon(contours); clearSubdividedFillCache();}
 
 	//! Set a single contour defining the SphericalPolygon.
 	//! @param contour a contour defining the polygon area.
-	void setContour(const QVector<Vec3d>& contour) {octahedronPolygon = OctahedronPolygon(contour);}
+	void setContour(const QVector<Vec3d>& contour) {octahedronPolygon = OctahedronPolygon(contour); clearSubdividedFillCache();}
 
 	//! Return the list of closed contours defining the polygon boundaries.
 	QVector<QVector<Vec3d> > getClosedOutlineContours() const {Q_ASSERT(0); return QVector<QVector<Vec3d> >();}
@@ -644,7 +665,8 @@ public:
 	SphericalConvexPolygon(const Vec3d &e0,const Vec3d &e1,const Vec3d &e2, const Vec3d &e3)  {contour << e0 << e1 << e2 << e3; updateBoundingCap();}
 
 	virtual SphericalRegionType getType() const {return SphericalRegion::ConvexPolygon;}
-	virtual OctahedronPolygon getOctahedronPolygon() const {return OctahedronPolygon(contour);}
+	//! The polygon is tesselated on the first call, and kept until the contour changes.
+	virtual OctahedronPolygon getOctahedronPolygon() const;
 	virtual StelVertexArray getFillVertexArray() const {return StelVertexArray(contour, StelVertexArray::TriangleFan);}
 	virtual StelVertexArray getOutlineVertexArray() const {return StelVertexArray(contour, StelVertexArray::LineLoop);}
 	virtual double getArea() const;
@@ -732,6 +754,11 @@ protected:
 	}
 
 	bool containsConvexContour(const Vec3d* vertice, int nbVertex) const;
+
+private:
+	//! Cached value of getOctahedronPolygon(), valid if octahedronPolygonCached is true.
+	mutable OctahedronPolygon cachedOctahedronPolygon;
+	mutable bool octahedronPolygonCached = false;
 };
 
 
@@ -870,7 +897,7 @@ public:
 	//! Set a single contour defining the SphericalPolygon.
 	//! @param acontour a contour defining the polygon area.
 	//! @param texCoord a list of texture coordinates matching the vertices of the contour.
-	virtual void setContour(const QVector<Vec3d>& acontour, const QVector<Vec2f>& texCoord) {SphericalConvexPolygon::setContour(acontour); textureCoords=texCoord;}
+	virtual void setContour(const QVector<Vec3d>& acontour, const QVector<Vec2f>& texCoord) {SphericalConvexPolygon::setContour(acontour); textureCoords=texCoord; clearSubdividedFillCache();}
 
 	//! Serialize the region into a QVariant map matching the JSON format.
 	//! The format is:
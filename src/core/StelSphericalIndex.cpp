@@ -20,20 +20,78 @@
 #include "StelSphericalIndex.hpp"
 #include <QVector>
 
-StelSphericalIndex::StelSphericalIndex(int maxObjPerNode, int maxLevel) : maxObjectsPerNode(maxObjPerNode)
+StelSphericalIndex::StelSphericalIndex(int maxObjPerNode, int maxLevel) : maxObjectsPerNode(maxObjPerNode), flatLayout(Q_NULLPTR)
 {
 	rootNode = new RootNode(maxObjectsPerNode, maxLevel);
 }
 
 StelSphericalIndex::~StelSphericalIndex()
 {
+	clearFlatLayout();
 	delete rootNode;
 }
 
 void StelSphericalIndex::insert(StelRegionObjectP regObj)
 {
+	clearFlatLayout();
 	NodeElem el(regObj);
 	rootNode->insert(el, 0);
 }
 
+void StelSphericalIndex::clearFlatLayout()
+{
+	delete flatLayout;
+	flatLayout = Q_NULLPTR;
+}
+
+void StelSphericalIndex::buildFlatLayout()
+{
+	clearFlatLayout();
+	FlatLayout* layout = new FlatLayout();
+
+	// Number the nodes in breadth-first order, the children of each node follow each other
+	QVector<const Node*> order;
+	order.append(rootNode);
+	int elementCount = 0;
+	for (int i=0;i<order.size();++i)
+	{
+		const Node* node = order.at(i);
+		elementCount += node->elements.size();
+		FlatNode flatNode;
+		flatNode.firstChild = order.size();
+		flatNode.childCount = node->children.size();
+		flatNode.firstElement = 0;
+		flatNode.elementCount = node->elements.size();
+		flatNode.subtreeEnd = 0;
+		flatNode.elementsMask = node->elementsMask;
+		flatNode.subtreeMask = node->subtreeMask;
+		layout->nodes.append(flatNode);
+		layout->triangles.append(i==0 ? SphericalConvexPolygon() : node->triangle);
+		for (const auto& child : node->children)
+			order.append(&child);
+	}
+
+	layout->points.reserve(elementCount);
+	layout->caps.reserve(elementCount);
+	layout->objects.reserve(elementCount);
+	flatLayout = layout;
+	appendFlatElements(*rootNode, 0);
+	Q_ASSERT(flatLayout->objects.size()==elementCount);
+}
+
+void StelSphericalIndex::appendFlatElements(const Node& node, int nodeIndex)
+{
+	FlatNode& flatNode = flatLayout->nodes[nodeIndex];
+	flatNode.firstElement = flatLayout->objects.size();
+	for (const auto& el : node.elements)
+	{
+		flatLayout->points.append(el.obj->getPointInRegion());
+		flatLayout->caps.append(el.cap);
+		flatLayout->objects.append(el.obj.data());
+	}
+	for (int i=0;i<node.children.size();++i)
+		appendFlatElements(node.children.at(i), flatNode.firstChild+i);
+	flatNode.subtreeEnd = flatLayout->objects.size();
+}
+
 
@@ -22,8 +22,14 @@
 
 #include "StelRegionObject.hpp"
 
+#include <QVector>
+
+#include <algorithm>
+
 //! @class StelSphericalIndex
 //! Container allowing to store and query SphericalRegion.
+//! Once all the objects are inserted, buildFlatLayout() copies the tree into contiguous arrays which the queries
+//! traverse instead of the nodes, until the next insert() or clear().
 class StelSphericalIndex
 {
 public:
@@ -31,41 +37,82 @@ public:
 	virtual ~StelSphericalIndex();
 
 	//! Insert the given object in the StelSphericalIndex.
+	//! This discards the flat layout, see buildFlatLayout().
 	void insert(StelRegionObjectP obj);
 
+	//! Copy the tree into a flat layout used by the queries: the nodes in breadth-first order in one array, so that
+	//! the children of a node are contiguous, and the elements in depth-first order in arrays of their points,
+	//! bounding caps and objects, so that the elements of a subtree are contiguous. The shapes of the nodes are
+	//! stored apart from them. The traversal of the queries reads these arrays instead of following the pointers
+	//! of the nodes and of their elements. Call it after inserting all the objects.
+	void buildFlatLayout();
+	//! Get whether the queries use the flat layout.
+	bool hasFlatLayout() const {return flatLayout!=Q_NULLPTR;}
+
 	//! Process all the objects intersecting the given region using the passed function object.
 	template<class FuncObject> void processIntersectingRegions(const SphericalRegion* region, FuncObject& func) const
 	{
-		rootNode->processIntersectingRegions(region, func);
+		if (flatLayout)
+			processFlatIntersectingRegions(0, region, func);
+		else
+			rootNode->processIntersectingRegions(region, func);
 	}
 
 	//! Process all the objects intersecting the given region using the passed function object.
 	template<class FuncObject> void processIntersectingPointInRegions(const SphericalRegion* region, FuncObject& func) const
 	{
-		rootNode->processIntersectingPointInRegions(region, func);
+		if (flatLayout)
+			processFlatIntersectingPointInRegions(0, region, func);
+		else
+			rootNode->processIntersectingPointInRegions(region, func);
+	}
+
+	//! Process the objects with their point in the given region, skipping the unwanted ones by node.
+	//! The objects of each node are processed in increasing StelRegionObject::getIndexSortKey() order.
+	//! The function object must provide:
+	//! - bool enterNode(quint64 elementsMask, quint64 subtreeMask), called before processing a node, with the
+	//!   bitwise OR of StelRegionObject::getIndexMask() of the objects of the node and of the node with its children.
+	//!   Returning false skips the node and its children.
+	//! - bool operator()(StelRegionObject*), returning false to skip the remaining objects of the node (not its children).
+	template<class FuncObject> void processFilteredPointInRegions(const SphericalRegion* region, FuncObject& func) const
+	{
+		if (flatLayout)
+			processFlatFilteredPointInRegions(0, region, func, false);
+		else
+			rootNode->processFilteredPointInRegions(region, func);
 	}
 	
 	//! Process all the objects intersecting the given region using the passed function object.
 	template<class FuncObject> void processBoundingCapIntersectingRegions(const SphericalCap& cap, FuncObject& func) const
 	{
-		rootNode->processBoundingCapIntersectingRegions(cap, func);
+		if (flatLayout)
+			processFlatBoundingCapIntersectingRegions(0, cap, func);
+		else
+			rootNode->processBoundingCapIntersectingRegions(cap, func);
 	}
 	
 	//! Process all the objects contained in the given region using the passed function object.
 	template<class FuncObject> void processContainedRegions(const SphericalRegion* region, FuncObject& func) const
 	{
-		rootNode->processContainedRegions(region, func);
+		if (flatLayout)
+			processFlatContainedRegions(0, region, func);
+		else
+			rootNode->processContainedRegions(region, func);
 	}
 
 	//! Process all the objects intersecting the given region using the passed function object.
 	template<class FuncObject> void processAll(FuncObject& func) const
 	{
-		rootNode->processAll(func);
+		if (flatLayout)
+			processFlatAll(0, func);
+		else
+			rootNode->processAll(func);
 	}
 
 	//! Remove all the elements in the container.
 	void clear()
 	{
+		clearFlatLayout();
 		rootNode->clear();
 	}
 
@@ -92,9 +139,13 @@ private:
 	struct NodeElem
 	{
 		NodeElem() {;}
-		NodeElem(StelRegionObjectP aobj) : obj(aobj), cap(obj->getRegion()->getBoundingCap()) {;}
+		NodeElem(StelRegionObjectP aobj) : obj(aobj), cap(obj->getRegion()->getBoundingCap()),
+			sortKey(obj->getIndexSortKey()), mask(obj->getIndexMask()) {;}
+		bool operator<(const NodeElem& other) const {return sortKey<other.sortKey;}
 		StelRegionObjectP obj;
 		SphericalCap cap;
+		float sortKey;
+		quint64 mask;
 	};
 
 	//! @class Node
@@ -102,8 +153,13 @@ private:
 	//! nodes link to child nodes subdivising it spatially.
 	struct Node
 	{
+		Node() : elementsMask(0), subtreeMask(0) {;}
 		virtual ~Node() {;}
+		//! Elements sorted by NodeElem::sortKey.
 		QVector<NodeElem> elements;
+		//! Bitwise OR of the masks of the elements, and of the elements of the node and its children.
+		quint64 elementsMask;
+		quint64 subtreeMask;
 		QVector<Node> children;
 		SphericalConvexPolygon triangle;
 		//! Split each triangles in to 4 subtriangles.
@@ -141,6 +197,15 @@ private:
 		{
 			elements.clear();
 			children.clear();
+			elementsMask = 0;
+			subtreeMask = 0;
+		}
+
+		//! Insert an element in elements, keeping them sorted.
+		void addElement(const NodeElem& el)
+		{
+			elements.insert(std::upper_bound(elements.begin(), elements.end(), el), el);
+			elementsMask |= el.mask;
 		}
 	};
 
@@ -207,6 +272,12 @@ private:
 				processContainedRegions(*this, region, func);
 			}
 
+			//! Process the wanted objects with point in the given region using the passed function object.
+			template<class FuncObject> void processFilteredPointInRegions(const SphericalRegion* region, FuncObject& func) const
+			{
+				processFilteredPointInRegions(*this, region, func, false);
+			}
+
 			//! Process all the objects intersecting the given region using the passed function object.
 			template<class FuncObject> void processAll(FuncObject& func) const
 			{
@@ -217,15 +288,17 @@ private:
 			//! Insert the given element in the given node.
 			void insert(Node& node, const NodeElem& el, int level)
 			{
+				node.subtreeMask |= el.mask;
 				if (node.children.isEmpty())
 				{
-					node.elements.append(el);
+					node.addElement(el);
 					// If we have too many objects in the node, we split it.
 					if (level<maxLevel && node.elements.size() > maxObjectsPerNode)
 					{
 						node.split();
 						const QVector<NodeElem> nodeElems = node.elements;
 						node.elements.clear();
+						node.elementsMask = 0;
 						// Re-insert the elements
 						for (QVector<NodeElem>::ConstIterator iter = nodeElems.constBegin();iter != nodeElems.constEnd(); ++iter)
 						{
@@ -245,7 +318,7 @@ private:
 					}
 				}
 				// Else store it here
-				node.elements.append(el);
+				node.addElement(el);
 			}
 
 			//! Process all the objects intersecting the given region using the passed function object.
@@ -315,6 +388,28 @@ private:
 				}
 			}
 
+			//! Process the wanted objects with point in the given region, or all the wanted objects if inside is true.
+			template<class FuncObject> void processFilteredPointInRegions(const Node& node, const SphericalRegion* region, FuncObject& func, bool inside) const
+			{
+				if (!func.enterNode(node.elementsMask, node.subtreeMask))
+					return;
+				for (const auto& el : node.elements)
+				{
+					if (inside || region->contains(el.obj->getPointInRegion()))
+					{
+						if (!func(&(*el.obj)))
+							break;
+					}
+				}
+				for (const auto& child : node.children)
+				{
+					if (inside || region->contains(child.triangle))
+						processFilteredPointInRegions(child, region, func, true);
+					else if (region->intersects(child.triangle))
+						processFilteredPointInRegions(child, region, func, false);
+				}
+			}
+
 			//! Process all the objects intersecting the given region using the passed function object.
 			template<class FuncObject> void processAll(const Node& node, FuncObject& func) const
 			{
@@ -330,10 +425,152 @@ private:
 			int maxLevel;
 	};
 
+	//! A node of the flat layout
+	struct FlatNode
+	{
+		//! The children are the nodes firstChild to firstChild+childCount-1
+		int firstChild;
+		int childCount;
+		//! The elements of the node are firstElement to firstElement+elementCount-1,
+		//! and the elements of the node and its children firstElement to subtreeEnd-1
+		int firstElement;
+		int elementCount;
+		int subtreeEnd;
+		quint64 elementsMask;
+		quint64 subtreeMask;
+	};
+
+	//! The arrays of buildFlatLayout(). The objects are held by the tree.
+	struct FlatLayout
+	{
+		QVector<FlatNode> nodes;
+		//! The triangle of each node, empty for the root node
+		QVector<SphericalConvexPolygon> triangles;
+		//! The point, bounding cap and object of each element
+		QVector<Vec3d> points;
+		QVector<SphericalCap> caps;
+		QVector<StelRegionObject*> objects;
+	};
+
+	//! Copy the elements of a node and its children in depth-first order.
+	void appendFlatElements(const Node& node, int nodeIndex);
+	void clearFlatLayout();
+
+	template<class FuncObject> void processFlatIntersectingRegions(int n, const SphericalRegion* region, FuncObject& func) const
+	{
+		const FlatNode& node = flatLayout->nodes.at(n);
+		for (int i=node.firstElement;i<node.firstElement+node.elementCount;++i)
+		{
+			StelRegionObject* obj = flatLayout->objects.at(i);
+			if (region->intersects(obj->getRegion().data()))
+				func(obj);
+		}
+		for (int c=node.firstChild;c<node.firstChild+node.childCount;++c)
+		{
+			const SphericalConvexPolygon& triangle = flatLayout->triangles.at(c);
+			if (region->contains(triangle))
+				processFlatAll(c, func);
+			else if (region->intersects(triangle))
+				processFlatIntersectingRegions(c, region, func);
+		}
+	}
+
+	template<class FuncObject> void processFlatIntersectingPointInRegions(int n, const SphericalRegion* region, FuncObject& func) const
+	{
+		const FlatNode& node = flatLayout->nodes.at(n);
+		const Vec3d* points = flatLayout->points.constData();
+		for (int i=node.firstElement;i<node.firstElement+node.elementCount;++i)
+		{
+			if (region->contains(points[i]))
+				func(flatLayout->objects.at(i));
+		}
+		for (int c=node.firstChild;c<node.firstChild+node.childCount;++c)
+		{
+			const SphericalConvexPolygon& triangle = flatLayout->triangles.at(c);
+			if (region->contains(triangle))
+				processFlatAll(c, func);
+			else if (region->intersects(triangle))
+				processFlatIntersectingPointInRegions(c, region, func);
+		}
+	}
+
+	template<class FuncObject> void processFlatFilteredPointInRegions(int n, const SphericalRegion* region, FuncObject& func, bool inside) const
+	{
+		const FlatNode& node = flatLayout->nodes.at(n);
+		if (!func.enterNode(node.elementsMask, node.subtreeMask))
+			return;
+		const Vec3d* points = flatLayout->points.constData();
+		for (int i=node.firstElement;i<node.firstElement+node.elementCount;++i)
+		{
+			if (inside || region->contains(points[i]))
+			{
+				if (!func(flatLayout->objects.at(i)))
+					break;
+			}
+		}
+		for (int c=node.firstChild;c<node.firstChild+node.childCount;++c)
+		{
+			const SphericalConvexPolygon& triangle = flatLayout->triangles.at(c);
+			if (inside || region->contains(triangle))
+				processFlatFilteredPointInRegions(c, region, func, true);
+			else if (region->intersects(triangle))
+				processFlatFilteredPointInRegions(c, region, func, false);
+		}
+	}
+
+	template<class FuncObject> void processFlatBoundingCapIntersectingRegions(int n, const SphericalCap& cap, FuncObject& func) const
+	{
+		const FlatNode& node = flatLayout->nodes.at(n);
+		const SphericalCap* caps = flatLayout->caps.constData();
+		for (int i=node.firstElement;i<node.firstElement+node.elementCount;++i)
+		{
+			if (cap.intersects(caps[i]))
+				func(flatLayout->objects.at(i));
+		}
+		for (int c=node.firstChild;c<node.firstChild+node.childCount;++c)
+		{
+			const SphericalConvexPolygon& triangle = flatLayout->triangles.at(c);
+			if (cap.contains(triangle))
+				processFlatAll(c, func);
+			else if (cap.intersects(triangle))
+				processFlatBoundingCapIntersectingRegions(c, cap, func);
+		}
+	}
+
+	template<class FuncObject> void processFlatContainedRegions(int n, const SphericalRegion* region, FuncObject& func) const
+	{
+		const FlatNode& node = flatLayout->nodes.at(n);
+		for (int i=node.firstElement;i<node.firstElement+node.elementCount;++i)
+		{
+			StelRegionObject* obj = flatLayout->objects.at(i);
+			if (region->contains(obj->getRegion().data()))
+				func(obj);
+		}
+		for (int c=node.firstChild;c<node.firstChild+node.childCount;++c)
+		{
+			const SphericalConvexPolygon& triangle = flatLayout->triangles.at(c);
+			if (region->contains(triangle))
+				processFlatAll(c, func);
+			else if (region->intersects(triangle))
+				processFlatContainedRegions(c, region, func);
+		}
+	}
+
+	//! The elements of a subtree are contiguous
+	template<class FuncObject> void processFlatAll(int n, FuncObject& func) const
+	{
+		const FlatNode& node = flatLayout->nodes.at(n);
+		StelRegionObject* const* objects = flatLayout->objects.constData();
+		for (int i=node.firstElement;i<node.subtreeEnd;++i)
+			func(objects[i]);
+	}
+
 	//! The maximum allowed number of object per node.
 	int maxObjectsPerNode;
 
 	RootNode* rootNode;
+	//! The flat layout used by the queries, or Q_NULLPTR to use the tree
+	FlatLayout* flatLayout;
 };
 
 #endif // STELSPHERICALINDEX_HPP
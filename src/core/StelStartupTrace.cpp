@@ -0,0 +1,243 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelStartupTrace.hpp"
+#include "StelFileMgr.hpp"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+#include <QVector>
+
+namespace
+{
+	//! The longest trace, as the background jobs may not end, e.g. while HiPS tiles are downloaded [ms]
+	const qint64 MAX_DURATION = 120000;
+
+	struct Event
+	{
+		const char* category;
+		QString name;
+		int thread;
+		qint64 start;		// [ns]
+		qint64 duration;	// [ns]
+		qint64 bytesRead;
+	};
+
+	QMutex mutex;
+	QElapsedTimer clock;
+	QString traceFile;
+	QVector<Event> events;
+	//! The index of each thread in the trace, 0 for the main thread
+	QHash<QThread*, int> threads;
+	//! The end of the first frame, -1 before [ns]
+	qint64 firstFrame = -1;
+}
+
+bool StelStartupTrace::enabled = false;
+
+void StelStartupTrace::start(const QString& fileName)
+{
+	QMutexLocker lock(&mutex);
+	traceFile = fileName;
+	events.reserve(1024);
+	threads.insert(QThread::currentThread(), 0);
+	clock.start();
+	enabled = true;
+}
+
+StelStartupTrace::Scope::Scope(const char* acategory, const char* aname)
+	: category(acategory)
+	, start(-1)
+	, bytesRead(0)
+{
+	if (enabled)
+	{
+		name = QString::fromLatin1(aname);
+		start = clock.nsecsElapsed();
+	}
+}
+
+StelStartupTrace::Scope::Scope(const char* acategory, const QString& aname)
+	: category(acategory)
+	, start(-1)
+	, bytesRead(0)
+{
+	if (enabled)
+	{
+		name = aname;
+		start = clock.nsecsElapsed();
+	}
+}
+
+StelStartupTrace::Scope::~Scope()
+{
+	end();
+}
+
+void StelStartupTrace::Scope::end()
+{
+	if (start>=0)
+		addEvent(category, name, start, bytesRead);
+	start = -1;
+}
+
+void StelStartupTrace::addEvent(const char* category, const QString& name, qint64 start, qint64 bytesRead)
+{
+	const qint64 end = clock.nsecsElapsed();
+	QMutexLocker lock(&mutex);
+	if (!enabled)
+		return;
+	QThread* thread = QThread::currentThread();
+	auto it = threads.find(thread);
+	if (it==threads.end())
+		it = threads.insert(thread, threads.size());
+	Event e;
+	e.category = category;
+	e.name = name;
+	e.thread = it.value();
+	e.start = start;
+	e.duration = end-start;
+	e.bytesRead = bytesRead;
+	events.append(e);
+}
+
+void StelStartupTrace::frameDrawn(bool idle)
+{
+	if (!enabled)
+		return;
+	const qint64 now = clock.nsecsElapsed();
+	if (firstFrame<0)
+	{
+		firstFrame = now;
+		qDebug() << "Startup trace: first frame drawn after" << now/1000000 << "ms";
+	}
+	if (idle || now/1000000>MAX_DURATION)
+		finish();
+}
+
+void StelStartupTrace::finish()
+{
+	QMutexLocker lock(&mutex);
+	enabled = false;
+	const qint64 end = clock.nsecsElapsed();
+
+	// The trace event times are in microseconds
+	QJsonArray traceEvents;
+	for (auto it = threads.constBegin(); it != threads.constEnd(); ++it)
+	{
+		QJsonObject thread;
+		thread["name"] = "thread_name";
+		thread["ph"] = "M";
+		thread["pid"] = 1;
+		thread["tid"] = it.value();
+		thread["args"] = QJsonObject{{"name", it.value()==0 ? QString("Main thread") : QString("Worker %1").arg(it.value())}};
+		traceEvents.append(thread);
+	}
+
+	struct Total
+	{
+		Total() : count(0), duration(0), bytesRead(0) {}
+		int count;
+		qint64 duration;
+		qint64 bytesRead;
+	};
+	QMap<QString, Total> totals;
+	qint64 bytesRead = 0;
+	for (const auto& e : events)
+	{
+		QJsonObject event;
+		event["name"] = e.name;
+		event["cat"] = e.category;
+		event["ph"] = "X";
+		event["pid"] = 1;
+		event["tid"] = e.thread;
+		event["ts"] = e.start/1000.;
+		event["dur"] = e.duration/1000.;
+		if (e.bytesRead>0)
+			event["args"] = QJsonObject{{"bytes_read", e.bytesRead}};
+		traceEvents.append(event);
+
+		Total& total = totals[e.category];
+		++total.count;
+		total.duration += e.duration;
+		total.bytesRead += e.bytesRead;
+		bytesRead += e.bytesRead;
+	}
+	if (firstFrame>=0)
+	{
+		QJsonObject frame;
+		frame["name"] = "First frame";
+		frame["ph"] = "i";
+		frame["s"] = "g";
+		frame["pid"] = 1;
+		frame["tid"] = 0;
+		frame["ts"] = firstFrame/1000.;
+		traceEvents.append(frame);
+	}
+
+	// The durations of the steps of a category are summed, also when they run in parallel
+	QJsonObject categories;
+	for (auto it = totals.constBegin(); it != totals.constEnd(); ++it)
+	{
+		categories[it.key()] = QJsonObject{
+			{"count", it.value().count},
+			{"total_ms", it.value().duration/1000000.},
+			{"bytes_read", it.value().bytesRead}};
+	}
+	QJsonObject summary;
+	summary["first_frame_ms"] = firstFrame/1000000.;
+	summary["end_ms"] = end/1000000.;
+	summary["bytes_read"] = bytesRead;
+	summary["categories"] = categories;
+
+	QJsonObject root;
+	root["traceEvents"] = traceEvents;
+	root["displayTimeUnit"] = "ms";
+	root["otherData"] = summary;
+	events.clear();
+	threads.clear();
+
+	const QString path = traceFile.isEmpty()
+		? StelFileMgr::getUserDir() + "/startup_trace-" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + ".json"
+		: traceFile;
+	QSaveFile file(path);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		qWarning() << "Startup trace: cannot write" << QDir::toNativeSeparators(path);
+		return;
+	}
+	file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+	if (!file.commit())
+	{
+		qWarning() << "Startup trace: cannot write" << QDir::toNativeSeparators(path);
+		return;
+	}
+	qDebug() << "Startup trace saved to" << QDir::toNativeSeparators(path);
+}
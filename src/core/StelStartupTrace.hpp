@@ -0,0 +1,73 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STELSTARTUPTRACE_HPP
+#define STELSTARTUPTRACE_HPP
+
+#include <QString>
+
+//! @class StelStartupTrace
+//! Records the timeline of the startup for the --startup-trace option of the command line: the steps of main(),
+//! StelMainView::init() and StelApp::init(), the data loading and init() of each module, the loading of the plugin
+//! libraries, the decompressions and the decoding of the textures, with the bytes read from the files.
+//! The trace ends with the first frame drawn once the background jobs are done, at most 2 minutes after the start,
+//! and is written in the JSON trace format of chrome://tracing and Perfetto, with the totals of each category.
+//! While the trace is not started, which is the default, the instrumented code only tests a static flag.
+class StelStartupTrace
+{
+public:
+	//! Start recording, at the start of main().
+	//! @param fileName the trace file, by default startup_trace-<date>.json in the user directory
+	static void start(const QString& fileName=QString());
+	//! Whether the trace is recording.
+	static bool isEnabled() { return enabled; }
+
+	//! Report a drawn frame, from the main thread. The trace is written after the first frame drawn while idle.
+	//! @param idle true if no background job or deferred data loading is pending
+	static void frameDrawn(bool idle);
+
+	//! Records a step from its construction to its destruction, in the thread which constructs it.
+	//! Categories: "startup" (main steps), "module" (data loading and init of the modules), "plugin" (libraries),
+	//! "texture" (image decoding), "decompress" (StelUtils::uncompress), "catalog" (catalog files).
+	class Scope
+	{
+	public:
+		Scope(const char* category, const char* name);
+		Scope(const char* category, const QString& name);
+		~Scope();
+		//! Set the bytes read from files during the step.
+		void setBytesRead(qint64 bytes) { bytesRead = bytes; }
+		//! Record the step now rather than at the destruction.
+		void end();
+	private:
+		const char* category;
+		QString name;
+		qint64 start;
+		qint64 bytesRead;
+	};
+
+private:
+	static void addEvent(const char* category, const QString& name, qint64 start, qint64 bytesRead);
+	//! Write the trace and stop recording.
+	static void finish();
+
+	static bool enabled;
+};
+
+#endif // STELSTARTUPTRACE_HPP
@@ -0,0 +1,395 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelTextAtlas.hpp"
+#include "StelApp.hpp"
+#include "StelPainter.hpp"
+
+#include <QFont>
+#include <QGlyphRun>
+#include <QImage>
+#include <QMatrix4x4>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QPainter>
+#include <QPainterPath>
+#include <QRawFont>
+#include <QSettings>
+#include <QTextLayout>
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#ifndef GL_RED
+#define GL_RED 0x1903
+#endif
+#ifndef GL_R8
+#define GL_R8 0x8229
+#endif
+
+// Pixel size at which the glyphs are rasterized
+static const int referencePixelSize = 32;
+// Distance in reference pixels covered by the distance field around the outline of a glyph
+static const int spreadPixels = 4;
+
+StelTextAtlas::StelTextAtlas()
+	: flagEnabled(true)
+	, flagAvailable(false)
+	, atlasSize(2048)
+	, texture(0)
+	, program(Q_NULLPTR)
+	, cornerBuffer(QOpenGLBuffer::VertexBuffer)
+	, instanceBuffer(QOpenGLBuffer::VertexBuffer)
+	, packX(0)
+	, packY(0)
+	, rowHeight(0)
+	, submitted(false)
+	, pendingViewport(0, 0, 0, 0)
+{
+}
+
+StelTextAtlas::~StelTextAtlas()
+{
+	if (texture)
+		QOpenGLContext::currentContext()->functions()->glDeleteTextures(1, &texture);
+	if (cornerBuffer.isCreated())
+		cornerBuffer.destroy();
+	if (instanceBuffer.isCreated())
+		instanceBuffer.destroy();
+	delete program;
+}
+
+void StelTextAtlas::init()
+{
+	QSettings* conf = StelApp::getInstance().getSettings();
+	flagEnabled = conf->value("video/flag_text_atlas", true).toBool();
+	atlasSize = qBound(256, conf->value("video/text_atlas_size", 2048).toInt(), 4096);
+	if (!flagEnabled || StelApp::getInstance().isHeadless())
+		return;
+
+#if QT_VERSION >= 0x050600
+	QOpenGLContext* ctx = QOpenGLContext::currentContext();
+	const QPair<int, int> version = ctx->format().version();
+	if (version < (ctx->isOpenGLES() ? qMakePair(3, 0) : qMakePair(3, 3)))
+	{
+		qDebug() << "StelTextAtlas: text atlas needs OpenGL 3.3 or OpenGL ES 3.0, labels are drawn with QPainter";
+		return;
+	}
+
+	QOpenGLShader vshader(QOpenGLShader::Vertex);
+	const char *vsrc =
+		"attribute mediump vec2 corner;\n"
+		"attribute highp vec2 origin;\n"
+		"attribute highp vec4 rect;\n"
+		"attribute mediump vec4 uv;\n"
+		"attribute mediump vec4 color;\n"
+		"attribute mediump vec3 rotation;\n"
+		"uniform mediump mat4 projectionMatrix;\n"
+		"varying mediump vec2 texc;\n"
+		"varying mediump vec4 outColor;\n"
+		"varying mediump float smoothing;\n"
+		"void main(void)\n"
+		"{\n"
+		"    vec2 p = rect.xy + corner*rect.zw;\n"
+		"    vec2 r = vec2(p.x*rotation.x - p.y*rotation.y, p.x*rotation.y + p.y*rotation.x);\n"
+		"    gl_Position = projectionMatrix*vec4(origin + r, 0., 1.);\n"
+		"    texc = mix(uv.xy, uv.zw, corner);\n"
+		"    outColor = color;\n"
+		"    smoothing = rotation.z;\n"
+		"}\n";
+	vshader.compileSourceCode(vsrc);
+	if (!vshader.log().isEmpty()) { qWarning() << "StelTextAtlas: Warnings while compiling vshader: " << vshader.log(); }
+
+	QOpenGLShader fshader(QOpenGLShader::Fragment);
+	const char *fsrc =
+		"varying mediump vec2 texc;\n"
+		"varying mediump vec4 outColor;\n"
+		"varying mediump float smoothing;\n"
+		"uniform sampler2D tex;\n"
+		"void main(void)\n"
+		"{\n"
+		"    float a = smoothstep(0.5 - smoothing, 0.5 + smoothing, texture2D(tex, texc).r);\n"
+		"    gl_FragColor = vec4(outColor.rgb, outColor.a*a);\n"
+		"}\n";
+	fshader.compileSourceCode(fsrc);
+	if (!fshader.log().isEmpty()) { qWarning() << "StelTextAtlas: Warnings while compiling fshader: " << fshader.log(); }
+
+	program = new QOpenGLShaderProgram();
+	program->addShader(&vshader);
+	program->addShader(&fshader);
+	if (!StelPainter::linkProg(program, "textAtlasShader"))
+	{
+		qWarning() << "StelTextAtlas: cannot link shader, labels are drawn with QPainter";
+		delete program;
+		program = Q_NULLPTR;
+		return;
+	}
+
+	// Corners of the glyph quad as a triangle strip, shared by all instances
+	static const GLfloat corners[] = {0.f, 0.f, 1.f, 0.f, 0.f, 1.f, 1.f, 1.f};
+	cornerBuffer.create();
+	cornerBuffer.bind();
+	cornerBuffer.allocate(corners, sizeof(corners));
+	cornerBuffer.release();
+	instanceBuffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+	instanceBuffer.create();
+
+	QOpenGLFunctions* gl = ctx->functions();
+	const QByteArray zeros(atlasSize*atlasSize, 0);
+	gl->glGenTextures(1, &texture);
+	gl->glBindTexture(GL_TEXTURE_2D, texture);
+	gl->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlasSize, atlasSize, 0, GL_RED, GL_UNSIGNED_BYTE, zeros.constData());
+	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	gl->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	gl->glBindTexture(GL_TEXTURE_2D, 0);
+	flagAvailable = true;
+#else
+	qDebug() << "StelTextAtlas: text atlas needs Qt 5.6 or later, labels are drawn with QPainter";
+#endif
+}
+
+void StelTextAtlas::clearAtlas()
+{
+	glyphs.clear();
+	emptyGlyphs.clear();
+	packX = 0;
+	packY = 0;
+	rowHeight = 0;
+}
+
+const StelTextAtlas::Glyph* StelTextAtlas::getGlyph(const QRawFont& font, quint32 glyphIndex)
+{
+	const QPair<QString, quint32> key(font.familyName() + '|' + font.styleName(), glyphIndex);
+	auto it = glyphs.constFind(key);
+	if (it!=glyphs.constEnd())
+		return &it.value();
+	if (emptyGlyphs.contains(key))
+		return Q_NULLPTR;
+
+	QRawFont referenceFont(font);
+	referenceFont.setPixelSize(referencePixelSize);
+	const QPainterPath path = referenceFont.pathForGlyph(glyphIndex);
+	if (path.isEmpty())
+	{
+		emptyGlyphs.insert(key);
+		return Q_NULLPTR;
+	}
+	// Leave one more pixel so that the field is 0 on the border of the glyph image
+	const int margin = spreadPixels + 1;
+	const QRectF bounds = path.boundingRect();
+	const int w = static_cast<int>(std::ceil(bounds.width())) + 2*margin;
+	const int h = static_cast<int>(std::ceil(bounds.height())) + 2*margin;
+	if (w>atlasSize || h>atlasSize)
+	{
+		emptyGlyphs.insert(key);
+		return Q_NULLPTR;
+	}
+
+	// Shelf packing
+	if (packX+w>atlasSize)
+	{
+		packX = 0;
+		packY += rowHeight;
+		rowHeight = 0;
+	}
+	if (packY+h>atlasSize)
+	{
+		// The queued glyphs use the current atlas
+		qDebug() << "StelTextAtlas: atlas full with" << glyphs.size() << "glyphs, clearing it";
+		submit();
+		submitted = true;
+		clearAtlas();
+	}
+
+	QImage coverage(w, h, QImage::Format_ARGB32_Premultiplied);
+	coverage.fill(Qt::transparent);
+	QPainter painter(&coverage);
+	painter.setRenderHint(QPainter::Antialiasing);
+	painter.translate(margin - bounds.left(), margin - bounds.top());
+	painter.fillPath(path, Qt::white);
+	painter.end();
+
+	// Signed distance to the outline, from the nearest pixel on the other side within spreadPixels
+	QVector<bool> inside(w*h);
+	for (int y = 0; y < h; ++y)
+	{
+		const QRgb* line = reinterpret_cast<const QRgb*>(coverage.constScanLine(y));
+		for (int x = 0; x < w; ++x)
+			inside[y*w+x] = qAlpha(line[x])>=128;
+	}
+	QByteArray field(w*h, 0);
+	for (int y = 0; y < h; ++y)
+	{
+		for (int x = 0; x < w; ++x)
+		{
+			const bool in = inside.at(y*w+x);
+			float minSqDist = spreadPixels*spreadPixels + 1;
+			for (int dy = -spreadPixels; dy <= spreadPixels; ++dy)
+			{
+				const int ny = y + dy;
+				for (int dx = -spreadPixels; dx <= spreadPixels; ++dx)
+				{
+					const int nx = x + dx;
+					// Outside the image is outside the glyph
+					const bool nIn = nx>=0 && nx<w && ny>=0 && ny<h && inside.at(ny*w+nx);
+					if (nIn!=in)
+						minSqDist = qMin(minSqDist, static_cast<float>(dx*dx + dy*dy));
+				}
+			}
+			// The outline is about half a pixel before the nearest pixel on the other side
+			const float dist = qMin(std::sqrt(minSqDist), static_cast<float>(spreadPixels)) - 0.5f;
+			const float value = 0.5f + (in ? dist : -dist)/(2.f*spreadPixels);
+			field[y*w+x] = static_cast<char>(qBound(0, static_cast<int>(value*255.f + 0.5f), 255));
+		}
+	}
+
+	QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+	gl->glBindTexture(GL_TEXTURE_2D, texture);
+	gl->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	gl->glTexSubImage2D(GL_TEXTURE_2D, 0, packX, packY, w, h, GL_RED, GL_UNSIGNED_BYTE, field.constData());
+	gl->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	gl->glBindTexture(GL_TEXTURE_2D, 0);
+
+	Glyph glyph;
+	const float s = 1.f/atlasSize;
+	// Image rows go down, from packY: the bottom of the glyph is at the row packY+h
+	glyph.uv.set(packX*s, (packY+h)*s, (packX+w)*s, packY*s);
+	glyph.rect.set(bounds.left() - margin, -(bounds.top() - margin + h), w, h);
+	packX += w;
+	rowHeight = qMax(rowHeight, h);
+	return &glyphs.insert(key, glyph).value();
+}
+
+bool StelTextAtlas::addText(const QFont& font, const QString& str, float x, float y, float angleDeg, const Vec4f& color,
+			    const Mat4f& projectionMatrix, const Vec4i& viewport)
+{
+	submitted = false;
+	if (!instances.isEmpty() && (viewport!=pendingViewport ||
+		std::memcmp(projectionMatrix.r, pendingProjectionMatrix.r, sizeof(projectionMatrix.r))!=0))
+	{
+		submit();
+		submitted = true;
+	}
+	pendingProjectionMatrix = projectionMatrix;
+	pendingViewport = viewport;
+
+	QTextLayout layout(str, font);
+	layout.beginLayout();
+	QTextLine line = layout.createLine();
+	if (!line.isValid())
+	{
+		layout.endLayout();
+		return submitted;
+	}
+	line.setLineWidth(1.e6);
+	layout.endLayout();
+	const float ascent = line.ascent();
+
+	const float angle = angleDeg*M_PI/180.;
+	const float cosr = std::cos(angle);
+	const float sinr = std::sin(angle);
+	for (const auto& run : layout.glyphRuns())
+	{
+		const QRawFont rawFont = run.rawFont();
+		const float scale = rawFont.pixelSize()/referencePixelSize;
+		// Antialiasing ramp about 0.7 pixel wide on screen, in distance field units
+		const float smoothing = 0.35f/(scale*spreadPixels);
+		const QVector<quint32> indexes = run.glyphIndexes();
+		const QVector<QPointF> positions = run.positions();
+		for (int i = 0; i < indexes.size(); ++i)
+		{
+			const Glyph* glyph = getGlyph(rawFont, indexes.at(i));
+			if (!glyph)
+				continue;
+			Instance instance;
+			instance.origin.set(x, y);
+			// Layout positions are on the baseline, y down from the top of the line
+			instance.rect.set(positions.at(i).x() + glyph->rect[0]*scale, ascent - positions.at(i).y() + glyph->rect[1]*scale,
+					  glyph->rect[2]*scale, glyph->rect[3]*scale);
+			instance.uv = glyph->uv;
+			instance.color = color;
+			instance.rotation.set(cosr, sinr, smoothing);
+			instances.append(instance);
+		}
+	}
+	return submitted;
+}
+
+void StelTextAtlas::submit()
+{
+	static_assert(sizeof(Instance)==17*sizeof(float), "StelTextAtlas::Instance must be packed for the instance buffer");
+	if (instances.isEmpty())
+		return;
+#if QT_VERSION >= 0x050600
+	QOpenGLExtraFunctions* gl = QOpenGLContext::currentContext()->extraFunctions();
+	gl->glViewport(pendingViewport[0], pendingViewport[1], pendingViewport[2], pendingViewport[3]);
+	gl->glDisable(GL_DEPTH_TEST);
+	gl->glDisable(GL_CULL_FACE);
+	gl->glEnable(GL_BLEND);
+	gl->glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	gl->glActiveTexture(GL_TEXTURE0);
+	gl->glBindTexture(GL_TEXTURE_2D, texture);
+
+	const Mat4f& m = pendingProjectionMatrix;
+	const QMatrix4x4 qMat(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
+	program->bind();
+	program->setUniformValue("projectionMatrix", qMat);
+	program->setUniformValue("tex", 0);
+
+	const int cornerLoc = program->attributeLocation("corner");
+	const int locations[] = {program->attributeLocation("origin"), program->attributeLocation("rect"), program->attributeLocation("uv"),
+				 program->attributeLocation("color"), program->attributeLocation("rotation")};
+	const int offsets[] = {offsetof(Instance, origin), offsetof(Instance, rect), offsetof(Instance, uv),
+			       offsetof(Instance, color), offsetof(Instance, rotation)};
+	const int sizes[] = {2, 4, 4, 4, 3};
+
+	cornerBuffer.bind();
+	program->setAttributeBuffer(cornerLoc, GL_FLOAT, 0, 2, 0);
+	program->enableAttributeArray(cornerLoc);
+	instanceBuffer.bind();
+	instanceBuffer.allocate(instances.constData(), instances.size()*sizeof(Instance));
+	for (int i = 0; i < 5; ++i)
+	{
+		program->setAttributeBuffer(locations[i], GL_FLOAT, offsets[i], sizes[i], sizeof(Instance));
+		program->enableAttributeArray(locations[i]);
+		gl->glVertexAttribDivisor(locations[i], 1);
+	}
+
+	gl->glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, instances.size());
+
+	for (int i = 0; i < 5; ++i)
+	{
+		gl->glVertexAttribDivisor(locations[i], 0);
+		program->disableAttributeArray(locations[i]);
+	}
+	program->disableAttributeArray(cornerLoc);
+	instanceBuffer.release();
+	program->release();
+	gl->glBindTexture(GL_TEXTURE_2D, 0);
+#endif
+	// Keep the capacity for the next frame
+	instances.resize(0);
+}
@@ -0,0 +1,123 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef STELTEXTATLAS_HPP
+#define STELTEXTATLAS_HPP
+
+#include "StelOpenGL.hpp"
+#include "VecMath.hpp"
+
+#include <QHash>
+#include <QOpenGLBuffer>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+class QFont;
+class QRawFont;
+class QOpenGLShaderProgram;
+
+//! @class StelTextAtlas
+//! Signed distance field glyph atlas used by StelPainter::drawText().
+//! Glyphs are laid out with QTextLayout, so that shaping and bidirectional text work as with QPainter.
+//! Each glyph is rasterized once at a reference size, converted to a distance field and packed in a single
+//! texture, and is then drawn at any size and angle. Labels are not drawn immediately: addText() appends
+//! one instance per glyph, and submit() draws all the queued glyphs with one instanced draw call.
+//! StelPainter submits the text after the draw() of each module, so that labels stay above the rest of the module.
+//! When the atlas is full, the queued glyphs are drawn and the atlas is cleared.
+//! This requires OpenGL 3.3 or OpenGL ES 3.0, and can be disabled with video/flag_text_atlas=false.
+class StelTextAtlas
+{
+public:
+	StelTextAtlas();
+	//! Requires a valid OpenGL context.
+	~StelTextAtlas();
+
+	//! Read the settings, check the OpenGL version and create the texture and the shader. Requires a valid context.
+	void init();
+
+	//! Return true if drawText() can use the atlas.
+	bool isAvailable() const { return flagAvailable; }
+
+	//! Queue a string for drawing.
+	//! @param font the font to use, with its pixel size already scaled to device pixels
+	//! @param x, y position of the start of the baseline, in viewport coordinates
+	//! @param angleDeg counterclockwise rotation around x, y
+	//! @param color color, modulated by the glyph coverage
+	//! @param projectionMatrix, viewport the parameters of the current projector. Glyphs queued with
+	//! different parameters are submitted first.
+	//! @return true if queued glyphs had to be submitted, in which case the caller must restore its OpenGL state.
+	bool addText(const QFont& font, const QString& str, float x, float y, float angleDeg, const Vec4f& color,
+		     const Mat4f& projectionMatrix, const Vec4i& viewport);
+
+	//! Return true if no glyph is waiting for submit().
+	bool isEmpty() const { return instances.isEmpty(); }
+
+	//! Draw the queued glyphs and clear the queue. The caller must restore its OpenGL state afterwards.
+	void submit();
+
+	//! Number of glyphs in the atlas, for profiling.
+	int getGlyphCount() const { return glyphs.size(); }
+
+private:
+	//! A glyph of the atlas.
+	struct Glyph
+	{
+		Vec4f uv;		// texture coordinates of the bottom left and top right corners
+		Vec4f rect;		// bottom left corner from the pen position and size, at the reference size, y up
+	};
+	//! Per instance attributes, one glyph on screen.
+	struct Instance
+	{
+		Vec2f origin;		// start of the baseline in viewport coordinates
+		Vec4f rect;		// bottom left corner from origin and size in pixels, before rotation
+		Vec4f uv;
+		Vec4f color;
+		Vec3f rotation;		// cosine and sine of the angle, width of the antialiasing ramp in distance units
+	};
+
+	//! Get a glyph, rasterizing it in the atlas if needed. Sets submitted if the atlas was full.
+	//! @return Q_NULLPTR for glyphs without outline (e.g. spaces)
+	const Glyph* getGlyph(const QRawFont& font, quint32 glyphIndex);
+	//! Empty the atlas.
+	void clearAtlas();
+
+	bool flagEnabled;
+	bool flagAvailable;
+	int atlasSize;
+	GLuint texture;
+	QOpenGLShaderProgram* program;
+	QOpenGLBuffer cornerBuffer;
+	QOpenGLBuffer instanceBuffer;
+
+	//! Shelf packer: position of the next glyph, and height of the current row.
+	int packX, packY, rowHeight;
+	QHash<QPair<QString, quint32>, Glyph> glyphs;
+	//! Glyphs without outline.
+	QSet<QPair<QString, quint32> > emptyGlyphs;
+
+	QVector<Instance> instances;
+	bool submitted;
+	Mat4f pendingProjectionMatrix;
+	Vec4i pendingViewport;
+};
+
+#endif // STELTEXTATLAS_HPP
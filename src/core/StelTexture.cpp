@@ -23,7 +23,13 @@
 #include "StelApp.hpp"
 #include "StelUtils.hpp"
 #include "StelPainter.hpp"
+#include "StelFrameProfiler.hpp"
+#include "StelStartupTrace.hpp"
+#include "StelKtx2.hpp"
+#include "StelTextureCache.hpp"
+#include "StelFileCache.hpp"
 
+#include <QFileInfo>
 #include <QImageReader>
 #include <QSize>
 #include <QDebug>
@@ -31,12 +37,14 @@
 #include <QImage>
 #include <QNetworkReply>
 #include <QtEndian>
-#include <QFuture>
-#include <QtConcurrent>
 
-StelTexture::StelTexture(StelTextureMgr *mgr) : textureMgr(mgr), gl(Q_NULLPTR), networkReply(Q_NULLPTR), loader(Q_NULLPTR), errorOccured(false), alphaChannel(false), id(0),
-	width(-1), height(-1), glSize(0)
+QVector<GLint> StelTexture::compressedFormats;
+
+StelTexture::StelTexture(StelTextureMgr *mgr) : textureMgr(mgr), gl(Q_NULLPTR), networkReply(Q_NULLPTR), loadPriority(0.f), cacheChecked(false), loadingFromCache(false), diskCacheEnabled(true), reloadable(false), ignoreUploadBudget(false), lastUsedFrame(0), errorOccured(false), alphaChannel(false), id(0),
+	width(-1), height(-1), glSize(0), glFormat(0), compressed(false), owner(StelTextureMgr::getCurrentOwner())
 {
+	QMutexLocker locker(&textureMgr->liveTexturesMutex);
+	textureMgr->liveTextures.insert(this);
 }
 
 StelTexture::~StelTexture()
@@ -75,10 +83,14 @@ StelTexture::~StelTexture()
 		delete networkReply;
 		networkReply = Q_NULLPTR;
 	}
-	if (loader != Q_NULLPTR) {
-		delete loader;
-		loader = Q_NULLPTR;
+	if (loader)
+	{
+		// A running job keeps its own reference to the data, so it is safe to leave it running.
+		loader->cancel();
+		loader.clear();
 	}
+	QMutexLocker locker(&textureMgr->liveTexturesMutex);
+	textureMgr->liveTextures.remove(this);
 }
 
 void StelTexture::wrapGLTexture(GLuint texId)
@@ -124,10 +136,40 @@ StelTexture::GLData StelTexture::imageToGLData(const QImage &image)
 /*************************************************************************
  Defined to be passed to QtConcurrent::run
  *************************************************************************/
+StelTexture::GLData StelTexture::loadCompressedSibling(const QString &path)
+{
+	GLData ret;
+	if (compressedFormats.isEmpty())
+		return ret;
+	const QString ktxPath = StelKtx2::getSiblingPath(path);
+	if (ktxPath.isEmpty() || !QFileInfo(ktxPath).isFile())
+		return ret;
+	StelKtx2 ktx;
+	if (!ktx.read(ktxPath, compressedFormats))
+	{
+		qWarning() << "Cannot use compressed texture, loading the image instead:" << ktx.getErrorString();
+		return ret;
+	}
+	ret.width = ktx.getWidth();
+	ret.height = ktx.getHeight();
+	ret.format = ktx.getFormat();
+	ret.compressed = true;
+	ret.alpha = ktx.hasAlphaChannel();
+	ret.mipmaps = ktx.getLevels();
+	ret.data = ret.mipmaps.takeFirst();
+	return ret;
+}
+
 StelTexture::GLData StelTexture::loadFromPath(const QString &path)
 {
+	StelStartupTrace::Scope trace("texture", path);
 	try
 	{
+		GLData ret = loadCompressedSibling(path);
+		if (StelStartupTrace::isEnabled())
+			trace.setBytesRead(QFileInfo(ret.data.isEmpty() ? path : StelKtx2::getSiblingPath(path)).size());
+		if (!ret.data.isEmpty())
+			return ret;
 		return imageToGLData(QImage(path));
 	}
 	catch(std::exception& ex) //this catches out-of-memory errors from file conversion
@@ -141,6 +183,7 @@ StelTexture::GLData StelTexture::loadFromPath(const QString &path)
 
 StelTexture::GLData StelTexture::loadFromData(const QByteArray& data)
 {
+	StelStartupTrace::Scope trace("texture", "downloaded image");
 	try
 	{
 		return imageToGLData(QImage::fromData(data));
@@ -160,6 +203,7 @@ StelTexture::GLData StelTexture::loadFromData(const QByteArray& data)
 
 bool StelTexture::bind(int slot)
 {
+	lastUsedFrame = textureMgr->frameCounter;
 	if (id != 0)
 	{
 		// The texture is already fully loaded, just bind and return true;
@@ -172,10 +216,25 @@ bool StelTexture::bind(int slot)
 
 	if(load())
 	{
+		// Textures finishing together are uploaded over several frames, so that the frames do not stutter.
+		if (!ignoreUploadBudget && !textureMgr->reserveUpload(loaderData->data.size()))
+			return false;
+		ignoreUploadBudget = false;
 		// Finally load the data in the main thread.
-		glLoad(loader->result());
-		delete loader;
-		loader = Q_NULLPTR;
+		const QSharedPointer<GLData> data = loaderData;
+		loader.clear();
+		loaderData.clear();
+		if (loadingFromCache)
+		{
+			loadingFromCache = false;
+			// The cache file was invalid, load the image again
+			if (data->data.isEmpty())
+			{
+				load();
+				return false;
+			}
+		}
+		glLoad(*data);
 		if (id != 0)
 		{
 			// The texture is already fully loaded, just bind and return true;
@@ -189,6 +248,21 @@ bool StelTexture::bind(int slot)
 	return false;
 }
 
+void StelTexture::unload()
+{
+	if (id == 0 || !reloadable)
+		return;
+	StelApp::getInstance().ensureGLContextCurrent();
+	gl->glDeleteTextures(1, &id);
+	textureMgr->glMemoryUsage -= glSize;
+	textureMgr->idMap.remove(id);
+	id = 0;
+	glSize = 0;
+	// The disk cache is looked up again when the texture is loaded the next time.
+	cacheChecked = false;
+	cacheKey.clear();
+}
+
 void StelTexture::waitForLoaded()
 {
 	if(networkReply)
@@ -198,26 +272,82 @@ void StelTexture::waitForLoaded()
 	}
 	if(loader)
 		loader->waitForFinished();
+	ignoreUploadBudget = true;
+}
+
+bool StelTexture::isLoaded() const
+{
+	return id!=0 || (!networkReply && !loader.isNull() && loader->isFinished());
+}
+
+void StelTexture::setLoadPriority(float priority)
+{
+	loadPriority = priority;
+	if (loader)
+		loader->setPriority(priority);
 }
 
-template <typename T, typename Param, typename Arg>
-void StelTexture::startAsyncLoader(T (*functionPointer)(Param), const Arg &arg)
+void StelTexture::startAsyncLoader(const std::function<GLData()>& func, bool storeInCache)
 {
-	Q_ASSERT(loader==Q_NULLPTR);
-	//own thread pool only supported with Qt 5.4+
-	loader = new QFuture<GLData>(QtConcurrent::run(textureMgr->loaderThreadPool, functionPointer, arg));
+	Q_ASSERT(loader.isNull());
+	const QSharedPointer<GLData> result(new GLData());
+	// The job keeps the cache alive if the texture manager is deleted first
+	const QSharedPointer<StelTextureCache> cache = storeInCache && !cacheKey.isEmpty() ? textureMgr->diskCache : QSharedPointer<StelTextureCache>();
+	const QString key = cacheKey;
+	loaderData = result;
+	loader = StelApp::getInstance().getJobMgr().submit([=]() {
+		*result = func();
+		if (cache)
+			cache->insert(key, *result);
+	}, loadPriority);
 }
 
 bool StelTexture::load()
 {
+	// The image is created by a function, e.g. a part of a larger image.
+	if (imageFunc)
+	{
+		if (loader.isNull())
+		{
+			const std::function<QImage()> func = imageFunc;
+			startAsyncLoader([func]() { return imageToGLData(func()); }, false);
+			return false;
+		}
+		return loader->isFinished();
+	}
+	// Textures found in the disk cache are neither downloaded nor decoded.
+	if (diskCacheEnabled && !cacheChecked && loader.isNull() && networkReply == Q_NULLPTR)
+	{
+		cacheChecked = true;
+		const QSharedPointer<StelTextureCache> cache = textureMgr->diskCache;
+		if (cache)
+		{
+			// Local images replaced by a KTX2 file are already stored in the format used by OpenGL
+			const QString ktxPath = StelKtx2::getSiblingPath(fullPath);
+			if (compressedFormats.isEmpty() || ktxPath.isEmpty() || !QFileInfo(ktxPath).isFile())
+				cacheKey = StelFileCache::getKey(fullPath);
+		}
+		if (!cacheKey.isEmpty() && cache->contains(cacheKey))
+		{
+			const QString key = cacheKey;
+			loadingFromCache = true;
+			startAsyncLoader([cache, key]() {
+				StelStartupTrace::Scope trace("texture", "disk cache");
+				return cache->load(key);
+			}, false);
+			return false;
+		}
+	}
 	// If the file is remote, start a network connection.
-	if (loader == Q_NULLPTR && networkReply == Q_NULLPTR &&
+	if (loader.isNull() && networkReply == Q_NULLPTR &&
 			(fullPath.startsWith("http", Qt::CaseInsensitive) || fullPath.startsWith("file://", Qt::CaseInsensitive)))
 	{
 		QNetworkRequest req = QNetworkRequest(QUrl(fullPath));
 		// Define that preference should be given to cached files (no etag checks)
 		req.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
 		req.setRawHeader("User-Agent", StelUtils::getUserAgentString().toLatin1());
+		if (loadPriority < 0.f)
+			req.setPriority(QNetworkRequest::LowPriority);
 		networkReply = StelApp::getInstance().getNetworkAccessManager()->get(req);
 		connect(networkReply, SIGNAL(finished()), this, SLOT(onNetworkReply()));
 		return false;
@@ -226,9 +356,10 @@ bool StelTexture::load()
 	if (networkReply != Q_NULLPTR)
 		return false;
 	// Not a remote file, start a loader from local file.
-	if (loader == Q_NULLPTR)
+	if (loader.isNull())
 	{
-		startAsyncLoader(loadFromPath,fullPath);
+		const QString path = fullPath;
+		startAsyncLoader([path]() { return loadFromPath(path); }, true);
 		return false;
 	}
 	// Wait until the loader finish.
@@ -237,14 +368,22 @@ bool StelTexture::load()
 
 void StelTexture::onNetworkReply()
 {
-	Q_ASSERT(loader == Q_NULLPTR);
+	Q_ASSERT(loader.isNull());
 	if (networkReply->error() == QNetworkReply::NoError && networkReply->bytesAvailable()>0)
 	{
 		QByteArray data = networkReply->readAll();
 		if(data.isEmpty()) //prevent starting the loader when there is nothing to load
 			reportError(QString("Empty result received for URL: %1").arg(networkReply->url().toString()));
 		else
-			startAsyncLoader(loadFromData, data);
+		{
+			const std::function<void(const QByteArray&)> handler = downloadHandler;
+			startAsyncLoader([data, handler]() {
+				GLData ret = loadFromData(data);
+				if (handler && !ret.data.isEmpty())
+					handler(data);
+				return ret;
+			}, true);
+		}
 	}
 	else
 		reportError(networkReply->errorString());
@@ -352,6 +491,8 @@ bool StelTexture::glLoad(const GLData& data)
 
 	width = data.width;
 	height = data.height;
+	glFormat = data.format;
+	compressed = data.compressed;
 
 	//make sure the correct GL context is bound!
 	StelApp::getInstance().ensureGLContextCurrent();
@@ -360,6 +501,14 @@ bool StelTexture::glLoad(const GLData& data)
 	//check minimum texture size
 	GLint maxSize;
 	gl->glGetIntegerv(GL_MAX_TEXTURE_SIZE,&maxSize);
+	// compressed textures with mipmaps can still be used at a lower resolution
+	int skippedLevels = 0;
+	while (data.compressed && (maxSize < width || maxSize < height) && skippedLevels < data.mipmaps.size())
+	{
+		width = qMax(1, width/2);
+		height = qMax(1, height/2);
+		++skippedLevels;
+	}
 	if(maxSize < width || maxSize < height)
 	{
 		reportError(QString("Texture size (%1/%2) is larger than GL_MAX_TEXTURE_SIZE (%3)!").arg(width).arg(height).arg(maxSize));
@@ -372,6 +521,15 @@ bool StelTexture::glLoad(const GLData& data)
 	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, loadParams.filtering);
 	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, loadParams.filtering);
 
+	if (data.compressed)
+	{
+		glLoadCompressed(data, skippedLevels);
+		textureMgr->glMemoryUsage += glSize;
+		textureMgr->idMap.insert(id,sharedFromThis());
+		emit(loadingProcessFinished(false));
+		return true;
+	}
+
 	//the conversion from QImage may result in tightly packed scanlines that are no longer 4-byte aligned!
 	//--> we have to set the GL_UNPACK_ALIGNMENT accordingly
 
@@ -400,6 +558,7 @@ bool StelTexture::glLoad(const GLData& data)
 	//do pixel transfer
 	gl->glTexImage2D(GL_TEXTURE_2D, 0, data.format, width, height, 0, data.format,
 			 data.type, data.data.constData());
+	StelFrameProfiler::count(StelFrameProfiler::TextureUploads);
 
 	//for now, assume full sized 8 bit GL formats used internally
 	glSize = data.data.size();
@@ -431,6 +590,51 @@ bool StelTexture::glLoad(const GLData& data)
 	return true;
 }
 
+void StelTexture::glLoadCompressed(const GLData& data, int skippedLevels)
+{
+	alphaChannel = data.alpha;
+	glSize = 0;
+
+	QList<QByteArray> levels = data.mipmaps;
+	levels.prepend(data.data);
+	levels = levels.mid(skippedLevels);
+	// The levels of the file are only used if they reach 1x1, OpenGL ES 2 cannot limit the number of levels.
+	int nbLevels = 1;
+	if (loadParams.generateMipmaps)
+	{
+		int fullLevels = 1;
+		for (int size = qMax(width, height); size > 1; size /= 2)
+			++fullLevels;
+		if (levels.size() >= fullLevels)
+			nbLevels = fullLevels;
+		else
+			qWarning() << "Compressed texture" << fullPath << "has no complete mipmap chain, mipmaps are disabled";
+	}
+
+	int levelWidth = width;
+	int levelHeight = height;
+	for (int level = 0; level < nbLevels; ++level)
+	{
+		const QByteArray& levelData = levels.at(level);
+		gl->glCompressedTexImage2D(GL_TEXTURE_2D, level, static_cast<GLenum>(data.format), levelWidth, levelHeight, 0,
+					   levelData.size(), levelData.constData());
+		glSize += static_cast<unsigned int>(levelData.size());
+		levelWidth = qMax(1, levelWidth/2);
+		levelHeight = qMax(1, levelHeight/2);
+	}
+	StelFrameProfiler::count(StelFrameProfiler::TextureUploads);
+
+	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, loadParams.wrapMode);
+	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, loadParams.wrapMode);
+	if (nbLevels > 1)
+		gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, loadParams.filterMipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR_MIPMAP_NEAREST);
+
+#ifndef NDEBUG
+	if (qApp->property("verbose") == true)
+		qDebug()<<"StelTexture"<<id<<"uploaded from"<<StelKtx2::getSiblingPath(fullPath)<<", total memory usage "<<textureMgr->glMemoryUsage / (1024.0 * 1024.0)<<"MB";
+#endif
+}
+
 // Actually load the texture to openGL memory
 bool StelTexture::glLoad(const QImage& image)
 {
@@ -22,14 +22,18 @@
 
 #include "StelTextureTypes.hpp"
 #include "StelOpenGL.hpp"
+#include "StelJobMgr.hpp"
 
 #include <QObject>
 #include <QImage>
+#include <QList>
+#include <QVector>
+
+#include <functional>
 
 class QFile;
 class StelTextureMgr;
 class QNetworkReply;
-template <class T> class QFuture;
 
 #ifndef GL_CLAMP_TO_EDGE
 #define GL_CLAMP_TO_EDGE 0x812F
@@ -80,6 +84,9 @@ public:
 	//! Return whether the texture can be binded, i.e. it is fully loaded
 	bool canBind() const {return id!=0;}
 
+	//! Return whether the data of the texture was decoded, so that bind() only has to upload it.
+	bool isLoaded() const;
+
 	//! Return the width and heigth of the texture in pixels
 	bool getDimensions(int &width, int &height);
 
@@ -99,11 +106,28 @@ public:
 	const QString& getFullPath() const {return fullPath;}
 
 	//! Return whether the image is currently being loaded
-	bool isLoading() const {return (loader || networkReply) && !canBind();}
+	bool isLoading() const {return (!loader.isNull() || networkReply) && !canBind();}
 
 	//! Return texture memory size
 	unsigned int getGlSize() const {return glSize;}
 
+	//! Set the priority of the background loading of the image, see StelJobMgr.
+	//! Has no effect once the image was loaded. Downloads started with a negative priority are
+	//! requested with QNetworkRequest::LowPriority.
+	void setLoadPriority(float priority);
+
+	//! Start loading a lazily loaded texture without binding it, e.g. to prefetch it. Requires the main thread.
+	void startLoading() { if (id == 0 && !errorOccured) load(); }
+
+	//! Set whether the decoded texture is stored in the disk cache of StelTextureMgr, true by default.
+	//! Disable it for textures whose files are already cached by the caller. Must be called before loading starts.
+	void setDiskCacheEnabled(bool b) { diskCacheEnabled = b; }
+
+	//! Set a function called by the loader job with the downloaded file of a remote texture,
+	//! once it was successfully decoded. This is used to keep the files in another cache.
+	//! Must be called before loading starts.
+	void setDownloadHandler(const std::function<void(const QByteArray&)>& handler) { downloadHandler = handler; }
+
 signals:
 	//! Emitted when the texture is ready to be bind(), i.e. when downloaded, imageLoading and	glLoading is over
 	//! or when an error occured and the texture will never be available
@@ -116,23 +140,37 @@ private slots:
 
 private:
 	friend class StelTextureMgr;
+	friend class StelTextureCache;
 
 	//! structure returned by the loader threads, containing all the
 	//! data and information to create the OpenGL texture.
 	struct GLData
 	{
-		GLData() : width(0), height(0), format(0), type(0) {}
+		GLData() : width(0), height(0), format(0), type(0), compressed(false), alpha(false) {}
 		QString loaderError; //! can contain an error message if data is null
 		QByteArray data;
 		int width;
 		int height;
 		GLint format;
 		GLint type;
+		//! true if data is in a block compression format read from a KTX2 file, format is then its internal format
+		bool compressed;
+		//! for compressed data, whether the format has an alpha channel
+		bool alpha;
+		//! for compressed data, the next mipmap levels from the file, from the largest to the smallest
+		QList<QByteArray> mipmaps;
 	};
-	//! Those static methods can be called by QtConcurrent::run
+	//! Those static methods are run by the loader jobs
 	static GLData imageToGLData(const QImage &image);
 	static GLData loadFromPath(const QString &path);
 	static GLData loadFromData(const QByteArray& data);
+	//! Load the KTX2 file replacing an image if it exists and can be used, see StelKtx2.
+	//! @return empty data if the image must be loaded instead.
+	static GLData loadCompressedSibling(const QString &path);
+
+	//! The compressed formats of the KTX2 files which can be loaded, set by StelTextureMgr.
+	//! Empty if compressed textures are disabled.
+	static QVector<GLint> compressedFormats;
 
 	//! Private constructor
 	StelTexture(StelTextureMgr* mgr);
@@ -147,19 +185,27 @@ private:
 	//! @param errorMessage the human friendly error message
 	void reportError(const QString& errorMessage);
 
+	//! Release the OpenGL texture to free memory. It is loaded again from its file or URL on the next bind().
+	//! Only used for textures created by StelTextureMgr::createTextureThread().
+	void unload();
+
 	//! Load the texture already in the RAM to the openGL memory
 	//! This function uses openGL routines and must be called in the main thread
 	//! @return false if an error occured
 	bool glLoad(const QImage& image);
 	//! Same as glLoad(QImage), but with an image already in OpenGl format
 	bool glLoad(const GLData& data);
+	//! Upload data read from a KTX2 file, called by glLoad(GLData) with the texture bound.
+	//! @param skippedLevels the number of levels of the file which are too large for the context
+	void glLoadCompressed(const GLData& data, int skippedLevels);
 
 	//! Starts the loading process if it has not already started.
 	//! Returns true if the data was loaded, false if not yet ready.
 	bool load();
 
-	template <typename T, typename Param1, typename Arg1>
-	void startAsyncLoader(T (*functionPointer)(Param1), const Arg1 &arg1);
+	//! Run a loader job producing the data of the texture.
+	//! @param storeInCache whether the data is stored in the disk cache of StelTextureMgr when the cache key is set
+	void startAsyncLoader(const std::function<GLData()>& func, bool storeInCache);
 
 	//! The parent texture manager
 	StelTextureMgr* textureMgr;
@@ -170,8 +216,29 @@ private:
 	//! Used to handle the connection for remote textures.
 	QNetworkReply *networkReply;
 
-	//! The loader object
-	QFuture<GLData>* loader;
+	//! The loader job, and the data it produces
+	StelJobP loader;
+	QSharedPointer<GLData> loaderData;
+	float loadPriority;
+
+	//! The key of the texture in the disk cache, empty if it is not cached
+	QString cacheKey;
+	//! Whether load() already looked for the texture in the disk cache
+	bool cacheChecked;
+	//! Whether the loader job reads the disk cache
+	bool loadingFromCache;
+	//! Whether the texture can be stored in the disk cache, see setDiskCacheEnabled()
+	bool diskCacheEnabled;
+	//! Called with the downloaded file, see setDownloadHandler()
+	std::function<void(const QByteArray&)> downloadHandler;
+	//! Whether the texture can be unloaded and loaded again from fullPath, see unload()
+	bool reloadable;
+	//! If set, the loader job creates the image with this function instead of reading fullPath
+	std::function<QImage()> imageFunc;
+	//! Set by waitForLoaded() so that the next bind() uploads the data even over the upload budget of the frame
+	bool ignoreUploadBudget;
+	//! StelTextureMgr::frameCounter of the last bind()
+	quint64 lastUsedFrame;
 
 	//! The URL where to download the file
 	QString fullPath;
@@ -193,6 +260,11 @@ private:
 
 	//! Size in GL memory
 	unsigned int glSize;
+	//! Format of the GL data, the internal format if compressed
+	GLint glFormat;
+	bool compressed;
+	//! The module which created the texture, see StelTextureMgr::getResidency()
+	QString owner;
 };
 
 
@@ -0,0 +1,88 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelTextureCache.hpp"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QDebug>
+
+namespace
+{
+	const quint32 cacheMagic = 0x53544558; // "STEX"
+	const quint32 cacheVersion = 1;
+	const QString cacheSuffix(".stex");
+}
+
+StelTextureCache::StelTextureCache(const QString& dir, qint64 maxSize)
+	: files(dir, cacheSuffix, maxSize, true)
+{
+}
+
+bool StelTextureCache::contains(const QString& key) const
+{
+	return files.contains(key);
+}
+
+StelTexture::GLData StelTextureCache::load(const QString& key)
+{
+	StelTexture::GLData ret;
+	QByteArray bytes = files.read(key);
+	QBuffer buffer(&bytes);
+	if (buffer.open(QIODevice::ReadOnly))
+	{
+		QDataStream in(&buffer);
+		quint32 magic, version;
+		QString storedKey;
+		qint32 width, height, format, type;
+		QByteArray data;
+		in >> magic >> version;
+		if (magic==cacheMagic && version==cacheVersion)
+		{
+			in >> storedKey >> width >> height >> format >> type >> data;
+			if (in.status()==QDataStream::Ok && storedKey==key && !data.isEmpty())
+			{
+				ret.width = width;
+				ret.height = height;
+				ret.format = format;
+				ret.type = type;
+				ret.data = data;
+			}
+		}
+	}
+
+	if (ret.data.isEmpty())
+	{
+		qWarning() << "Invalid texture cache file" << files.getFilePath(key) << "for" << key;
+		files.remove(key);
+	}
+	return ret;
+}
+
+void StelTextureCache::insert(const QString& key, const StelTexture::GLData& data)
+{
+	if (data.data.isEmpty() || data.compressed)
+		return;
+	QByteArray bytes;
+	QDataStream out(&bytes, QIODevice::WriteOnly);
+	out << cacheMagic << cacheVersion << key << static_cast<qint32>(data.width) << static_cast<qint32>(data.height)
+	    << static_cast<qint32>(data.format) << static_cast<qint32>(data.type) << data.data;
+	files.write(key, bytes);
+}
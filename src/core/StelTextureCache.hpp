@@ -0,0 +1,59 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef STELTEXTURECACHE_HPP
+#define STELTEXTURECACHE_HPP
+
+#include "StelTexture.hpp"
+
+#include "StelFileCache.hpp"
+
+#include <QString>
+
+//! @class StelTextureCache
+//! Persistent cache of decoded textures, so that images loaded by StelTextureMgr::createTextureThread()
+//! are neither downloaded nor decoded again in later sessions.
+//! The data is stored in the pixel format uploaded to OpenGL, one file per texture, and the least
+//! recently used files are removed when the total size exceeds the budget.
+//! Mipmaps are still generated by OpenGL when the texture is uploaded.
+//! All methods are thread safe, they are called by the loader jobs of StelTexture.
+class StelTextureCache
+{
+public:
+	//! Open the cache and index the files already stored in it.
+	//! @param dir the directory where files are stored, created if needed
+	//! @param maxSize the budget of the cache in bytes
+	StelTextureCache(const QString& dir, qint64 maxSize);
+
+	//! Whether data is stored for a key.
+	bool contains(const QString& key) const;
+
+	//! Read the data stored for a key.
+	//! @return empty data if the file could not be read, it is then removed from the cache
+	StelTexture::GLData load(const QString& key);
+
+	//! Store the data of a texture, evicting the least recently used ones if needed.
+	void insert(const QString& key, const StelTexture::GLData& data);
+
+private:
+	StelFileCache files;
+};
+
+#endif // STELTEXTURECACHE_HPP
@@ -19,10 +19,14 @@
 
 #include "StelApp.hpp"
 #include "StelTextureMgr.hpp"
+#include "StelModuleMgr.hpp"
 #include "StelFileMgr.hpp"
 #include "StelUtils.hpp"
 #include "StelPainter.hpp"
+#include "StelKtx2.hpp"
+#include "StelTextureCache.hpp"
 
+#include <QCoreApplication>
 #include <QFileInfo>
 #include <QFile>
 #include <QDebug>
@@ -30,25 +34,86 @@
 #include <QThread>
 #include <QSettings>
 #include <cstdlib>
+#include <algorithm>
 #include <QOpenGLContext>
-#include <QThreadPool>
 
 StelTextureMgr::StelTextureMgr(QObject *parent)
-	: QObject(parent), glMemoryUsage(0), loaderThreadPool(new QThreadPool(this))
+	: QObject(parent), glMemoryUsage(0), memoryBudget(0), overMemoryBudget(false), frameCounter(0), lastEvictionFrame(0), uploadBudget(0), uploadedBytes(0)
 {
-#ifdef Q_PROCESSOR_X86_64
-	//allow up to 4 textures to be loaded in parallel on 64 bit
-	loaderThreadPool->setMaxThreadCount(std::min(4,QThread::idealThreadCount()));
-#else
-	//on other archs, for now ensure that just 1 texture is at once in background
-	//otherwise, for large textures loaded in parallel (some scenery3d scenes), the risk of an out-of-memory error is greater on 32bit systems
-	loaderThreadPool->setMaxThreadCount(1);
-#endif
+	// Precompressed textures are used when a .ktx2 file exists beside an image, see StelKtx2
+	QOpenGLContext* context = QOpenGLContext::currentContext();
+	QSettings* conf = StelApp::getInstance().getSettings();
+	if (context && conf && conf->value("video/flag_compressed_textures", true).toBool())
+	{
+		StelTexture::compressedFormats = StelKtx2::getSupportedFormats(context);
+		qDebug() << "Number of compressed texture formats supported for KTX2 files:" << StelTexture::compressedFormats.size();
+	}
+	else
+		StelTexture::compressedFormats.clear();
+
+	// Images loaded by createTextureThread() are stored decoded in the cache directory
+	const int cacheSizeMB = conf ? conf->value("main/texture_cache_size_mb", 512).toInt() : 0;
+	if (context && cacheSizeMB > 0)
+		diskCache.reset(new StelTextureCache(StelFileMgr::getCacheDir() + "/textures", static_cast<qint64>(cacheSizeMB)*1024*1024));
+
+	if (conf)
+	{
+		memoryBudget = static_cast<qint64>(qMax(0, conf->value("video/texture_memory_budget_mb", 1024).toInt()))*1024*1024;
+		uploadBudget = static_cast<qint64>(qMax(0, conf->value("video/texture_upload_budget_kb", 4096).toInt()))*1024;
+	}
+}
+
+bool StelTextureMgr::reserveUpload(int bytes)
+{
+	if (uploadBudget > 0 && uploadedBytes > 0 && uploadedBytes + bytes > uploadBudget)
+		return false;
+	uploadedBytes += bytes;
+	return true;
+}
+
+void StelTextureMgr::update()
+{
+	++frameCounter;
+	uploadedBytes = 0;
+	if (memoryBudget==0 || glMemoryUsage <= memoryBudget)
+	{
+		overMemoryBudget = false;
+		return;
+	}
+	// Looking for textures to unload is not worth it in each frame.
+	if (frameCounter < lastEvictionFrame + EvictionInterval)
+		return;
+	lastEvictionFrame = frameCounter;
+
+	QMutexLocker locker(&mutex);
+	QVector<QPair<quint64, StelTextureSP>> candidates;
+	for (auto it = textureCache.begin(); it != textureCache.end(); ++it)
+	{
+		StelTextureSP tex = it->toStrongRef();
+		if (tex && tex->reloadable && tex->id != 0 && tex->lastUsedFrame + MinUnusedFrames < frameCounter)
+			candidates.append(qMakePair(tex->lastUsedFrame, tex));
+	}
+	std::sort(candidates.begin(), candidates.end(), [](const QPair<quint64, StelTextureSP>& a, const QPair<quint64, StelTextureSP>& b) {
+		return a.first < b.first;
+	});
+	// Unload a bit more than needed, so that this does not happen again in the next frames.
+	const qint64 target = memoryBudget - memoryBudget/10;
+	int unloaded = 0;
+	for (const auto& c : candidates)
+	{
+		if (glMemoryUsage <= target)
+			break;
+		c.second->unload();
+		++unloaded;
+	}
+	overMemoryBudget = glMemoryUsage > memoryBudget;
+	if (unloaded > 0 || overMemoryBudget)
+		qDebug() << "Unloaded" << unloaded << "textures, texture memory usage" << glMemoryUsage/(1024*1024) << "MB of" << memoryBudget/(1024*1024) << "MB";
 }
 
 StelTextureSP StelTextureMgr::createTexture(const QString& afilename, const StelTexture::StelTextureParams& params)
 {
-	if (afilename.isEmpty())
+	if (afilename.isEmpty() || StelApp::getInstance().isHeadless())
 		return StelTextureSP();
 
 	QFileInfo info(afilename);
@@ -70,12 +135,12 @@ StelTextureSP StelTextureMgr::createTexture(const QString& afilename, const Stel
 	StelTextureSP tex = StelTextureSP(new StelTexture(this));
 	tex->fullPath = canPath;
 
-	QImage image(tex->fullPath);
-	if (image.isNull())
+	const StelTexture::GLData data = StelTexture::loadFromPath(tex->fullPath);
+	if (data.data.isEmpty())
 		return StelTextureSP();
 
 	tex->loadParams = params;
-	if (tex->glLoad(image))
+	if (tex->glLoad(data))
 	{
 		textureCache.insert(canPath,tex);
 		return tex;
@@ -90,7 +155,7 @@ StelTextureSP StelTextureMgr::createTexture(const QString& afilename, const Stel
 
 StelTextureSP StelTextureMgr::createTextureThread(const QString& url, const StelTexture::StelTextureParams& params, bool lazyLoading)
 {
-	if (url.isEmpty())
+	if (url.isEmpty() || StelApp::getInstance().isHeadless())
 		return StelTextureSP();
 
 	QString canPath = url;
@@ -116,6 +181,7 @@ StelTextureSP StelTextureMgr::createTextureThread(const QString& url, const Stel
 	StelTextureSP tex = StelTextureSP(new StelTexture(this));
 	tex->loadParams = params;
 	tex->fullPath = canPath;
+	tex->reloadable = true;
 	if (!lazyLoading)
 	{
 		//use load() instead of bind() to prevent potential - if very unlikey - OpenGL errors
@@ -129,6 +195,8 @@ StelTextureSP StelTextureMgr::createTextureThread(const QString& url, const Stel
 //! Create a texture from a QImage.
 StelTextureSP StelTextureMgr::createTexture(const QImage &image, const StelTexture::StelTextureParams& params)
 {
+	if (StelApp::getInstance().isHeadless())
+		return StelTextureSP();
 	bool r;
 	StelTextureSP tex = StelTextureSP(new StelTexture(this));
 	tex->loadParams = params;
@@ -137,6 +205,16 @@ StelTextureSP StelTextureMgr::createTexture(const QImage &image, const StelTextu
 	return tex;
 }
 
+StelTextureSP StelTextureMgr::createTextureThread(const std::function<QImage()>& imageFunc, const StelTexture::StelTextureParams& params)
+{
+	if (StelApp::getInstance().isHeadless())
+		return StelTextureSP();
+	StelTextureSP tex = StelTextureSP(new StelTexture(this));
+	tex->loadParams = params;
+	tex->imageFunc = imageFunc;
+	return tex;
+}
+
 StelTextureSP StelTextureMgr::wrapperForGLTexture(GLuint texId)
 {
 	auto it = idMap.find(texId);
@@ -191,3 +269,92 @@ StelTextureSP StelTextureMgr::lookupCache(const QString &file)
 	}
 	return StelTextureSP();
 }
+
+QString StelTextureMgr::getCurrentOwner()
+{
+	if (QThread::currentThread()!=qApp->thread())
+		return QString();
+	const StelModule* module = StelApp::getInstance().getModuleMgr().getCurrentModule();
+	return module ? module->objectName() : QString();
+}
+
+void StelTextureMgr::registerGLBuffer(const void* buffer, const QString& name, qint64 bytes)
+{
+	auto it = glBuffers.find(buffer);
+	if (it!=glBuffers.end())
+	{
+		it->bytes = bytes;
+		return;
+	}
+	GLBufferInfo info;
+	info.name = name;
+	info.owner = getCurrentOwner();
+	info.bytes = bytes;
+	glBuffers.insert(buffer, info);
+}
+
+void StelTextureMgr::unregisterGLBuffer(const void* buffer)
+{
+	glBuffers.remove(buffer);
+}
+
+qint64 StelTextureMgr::getGLBufferMemoryUsage() const
+{
+	qint64 total = 0;
+	for (const auto& info : glBuffers)
+		total += info.bytes;
+	return total;
+}
+
+static QString glFormatName(GLint format, bool compressed)
+{
+	if (compressed)
+		return QString("compressed 0x%1").arg(format, 0, 16);
+	switch (format)
+	{
+		case GL_RGBA: return "GL_RGBA";
+		case GL_RGB: return "GL_RGB";
+		case GL_LUMINANCE_ALPHA: return "GL_LUMINANCE_ALPHA";
+		case GL_LUMINANCE: return "GL_LUMINANCE";
+		case GL_ALPHA: return "GL_ALPHA";
+		case 0: return QString();
+		default: return QString("0x%1").arg(format, 0, 16);
+	}
+}
+
+QVariantList StelTextureMgr::getResidency() const
+{
+	QVariantList list;
+	{
+		QMutexLocker locker(&liveTexturesMutex);
+		for (const auto* tex : liveTextures)
+		{
+			QVariantMap entry;
+			entry.insert("type", "texture");
+			entry.insert("owner", tex->owner);
+			entry.insert("size", static_cast<qint64>(tex->glSize));
+			entry.insert("name", tex->fullPath);
+			entry.insert("id", tex->id);
+			entry.insert("width", tex->width);
+			entry.insert("height", tex->height);
+			entry.insert("format", glFormatName(tex->glFormat, tex->compressed));
+			entry.insert("loaded", tex->id!=0);
+			entry.insert("lastUsedFrame", tex->lastUsedFrame);
+			entry.insert("framesUnused", tex->lastUsedFrame>0 ? frameCounter-tex->lastUsedFrame : frameCounter);
+			list.append(entry);
+		}
+	}
+	for (const auto& info : glBuffers)
+	{
+		QVariantMap entry;
+		entry.insert("type", "buffer");
+		entry.insert("owner", info.owner);
+		entry.insert("size", info.bytes);
+		entry.insert("name", info.name);
+		list.append(entry);
+	}
+	std::sort(list.begin(), list.end(), [](const QVariant& a, const QVariant& b) {
+		return a.toMap().value("size").toLongLong() > b.toMap().value("size").toLongLong();
+	});
+	return list;
+}
@@ -22,13 +22,17 @@
 
 #include "StelTexture.hpp"
 #include <QObject>
+#include <QHash>
 #include <QMap>
+#include <QSet>
+#include <QVariant>
 #include <QWeakPointer>
 #include <QMutex>
+#include <QSharedPointer>
 
 class QNetworkReply;
 class QThread;
-class QThreadPool;
+class StelTextureCache;
 
 //! @class StelTextureMgr
 //! Manage textures loading.
@@ -47,6 +51,8 @@ public:
 	StelTextureSP createTexture(const QImage &image, const StelTexture::StelTextureParams& params=StelTexture::StelTextureParams());
 
 	//! Load an image from a file and create a new texture from it in a new thread.
+	//! The decoded image is kept in a disk cache of main/texture_cache_size_mb megabytes, so that
+	//! it is not downloaded and decoded again when the texture is created later, see StelTextureCache.
 	//! @note This method is safe to be called from threads other than the main thread.
 	//! @param url the texture file name or URL, can be absolute path if starts with '/' otherwise
 	//!    the file will be looked for in Stellarium's standard textures directories.
@@ -54,14 +60,54 @@ public:
 	//! @param lazyLoading define whether the texture should be actually loaded only when needed, i.e. when bind() is called the first time.
 	StelTextureSP createTextureThread(const QString& url, const StelTexture::StelTextureParams& params=StelTexture::StelTextureParams(), bool lazyLoading=true);
 
+	//! Count the frames for the last use of each texture, and unload the textures created by createTextureThread()
+	//! which were not bound for the longest time while their memory exceeds video/texture_memory_budget_mb.
+	//! Unloaded textures are loaded again when they are bound. Called by StelApp once per frame.
+	void update();
+
+	//! Whether the textures in use need more memory than the budget, even after unloading the unused ones.
+	bool isOverMemoryBudget() const {return overMemoryBudget;}
+
+	//! Create a texture from an image created by a function in a loader job, i.e. in another thread.
+	//! The function is called when the texture is bound the first time, it must be thread safe.
+	StelTextureSP createTextureThread(const std::function<QImage()>& imageFunc, const StelTexture::StelTextureParams& params=StelTexture::StelTextureParams());
+
+	//! Count the bytes uploaded by StelTexture::bind() in the current frame.
+	//! @return false if the upload must wait for the next frame because the budget of video/texture_upload_budget_kb
+	//! is exhausted. The first upload of a frame is always allowed.
+	bool reserveUpload(int bytes);
+
 	//! Creates or finds a StelTexture wrapper for the specified OpenGL texture object.
 	//! The wrapper takes ownership of the texture and will delete it if it is destroyed.
 	//! @param texID The OpenGL texture ID which should be wrapped. If this is already a StelTexture, the existing wrapper will be returned.
 	//! @returns the existing or new wrapper for the texture with the given GL name. Returns a null pointer if the texture name is invalid.
 	StelTextureSP wrapperForGLTexture(GLuint texId);
 
-//	//! Returns the estimated memory usage of all textures currently loaded through StelTexture
-//	int getGLMemoryUsage();
+	//! Returns the estimated memory usage of all textures currently loaded through StelTexture, in bytes
+	qint64 getGLMemoryUsage() const {return glMemoryUsage;}
+
+	//! Record a GL buffer in the list of getResidency(), with the module running in the main thread as its owner.
+	//! Registering the same buffer again only updates its size. Must be called in the main thread.
+	//! @param buffer identifies the buffer, usually the address of its QOpenGLBuffer
+	//! @param name a description of the buffer, e.g. "StarZoneRenderer level 2"
+	//! @param bytes the size of the buffer in GL memory
+	void registerGLBuffer(const void* buffer, const QString& name, qint64 bytes);
+	//! Remove a buffer recorded by registerGLBuffer(), when it is destroyed.
+	void unregisterGLBuffer(const void* buffer);
+	//! Returns the estimated memory usage of the buffers recorded by registerGLBuffer(), in bytes
+	qint64 getGLBufferMemoryUsage() const;
+
+	//! Get a description of every live StelTexture and recorded GL buffer, from the largest, to find which ones use the
+	//! GL memory. Each entry is a map with the keys:
+	//! - type: "texture" or "buffer"
+	//! - owner: the module whose init, update or draw created it (see StelModuleMgr::getCurrentModule()), or an empty
+	//!   string for textures created in other threads
+	//! - size: the estimated GL memory, 0 for textures which are not loaded [bytes]
+	//! - name: the file or URL of a texture, the description of a buffer
+	//! - for textures: id (0 if not loaded), width, height, format (e.g. "GL_RGBA"), loaded, lastUsedFrame and
+	//!   framesUnused, the frames since the last bind(), counted by update()
+	//! Must be called in the main thread.
+	QVariantList getResidency() const;
 
 private:
 	friend class StelTexture;
@@ -71,17 +117,42 @@ private:
 	//! Private constructor, use StelApp::getTextureManager for the correct instance
 	StelTextureMgr(QObject* parent = Q_NULLPTR);
 
-	unsigned int glMemoryUsage;
+	//! Frames between two searches for textures to unload
+	static const quint64 EvictionInterval = 60;
+	//! Frames for which a texture must not have been bound before it is unloaded
+	static const quint64 MinUnusedFrames = 120;
 
-	//! We use our own thread pool to ensure only 1 texture is being loaded at a time
-	QThreadPool* loaderThreadPool;
+	unsigned int glMemoryUsage;
+	//! Budget of the memory used by textures in bytes, 0 if unlimited
+	qint64 memoryBudget;
+	bool overMemoryBudget;
+	quint64 frameCounter;
+	quint64 lastEvictionFrame;
+	//! Budget of the bytes uploaded per frame by bind(), 0 if unlimited
+	qint64 uploadBudget;
+	qint64 uploadedBytes;
 
 	StelTextureSP lookupCache(const QString& file);
+	//! The name of the module running in the main thread, empty in other threads
+	static QString getCurrentOwner();
 	typedef QMap<QString,QWeakPointer<StelTexture> > TexCache;
 	typedef QMap<GLuint,QWeakPointer<StelTexture> > IdMap;
 	QMutex mutex;
 	TexCache textureCache;
 	IdMap idMap;
+	//! All StelTexture instances, for getResidency()
+	QSet<StelTexture*> liveTextures;
+	//! Guards liveTextures, textures are created in other threads as well
+	mutable QMutex liveTexturesMutex;
+	struct GLBufferInfo
+	{
+		QString name;
+		QString owner;
+		qint64 bytes;
+	};
+	QHash<const void*, GLBufferInfo> glBuffers;
+	//! Null if the disk cache is disabled
+	QSharedPointer<StelTextureCache> diskCache;
 };
 
 
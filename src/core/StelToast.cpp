@@ -127,18 +127,16 @@ void ToastTile::prepareDraw(Vec3f color)
 	}
 	if (!texture->canBind())
 		return;
-	// Get the opengl arrays
+	// Get the opengl arrays. The texture and index arrays are shared with the other tiles of the grid.
 	if (vertexArray.empty())
 	{
 		int ml = qMin(qMax(3, level+1), getGrid()->getMaxLevel());
 		vertexArray = getGrid()->getVertexArray(level, x, y, ml);
 		textureArray = getGrid()->getTextureArray(level, x, y, ml);
 		indexArray = getGrid()->getTrianglesIndex(level, x, y, ml);
-		colorArray.clear();
-		for (int i=0; i<vertexArray.size(); ++i)
-			colorArray.append(color);
 	}
 	// Recreate the color array in any case. Assume we must compute extinction on every frame.
+	// Without extinction, the tile is drawn with a uniform color instead.
 	if (withExtinction)
 	{
 		StelCore *core=StelApp::getInstance().getCore();
@@ -163,7 +161,7 @@ void ToastTile::prepareDraw(Vec3f color)
 	}
 	else
 	{
-		colorArray.fill(Vec3f(1.0f));
+		colorArray.clear();
 	}
 
 
@@ -216,7 +214,13 @@ void ToastTile::drawTile(StelPainter* sPainter, Vec3f color)
 	Q_ASSERT(vertexArray.size() == textureArray.size());
 
 	sPainter->setCullFace(true);
-	sPainter->setArrays(vertexArray.constData(), textureArray.constData(), colorArray.constData());
+	if (colorArray.isEmpty())
+	{
+		sPainter->setColor(color[0], color[1], color[2]);
+		sPainter->setArrays(vertexArray.constData(), textureArray.constData());
+	}
+	else
+		sPainter->setArrays(vertexArray.constData(), textureArray.constData(), colorArray.constData());
 	sPainter->drawFromArray(StelPainter::Triangles, indexArray.size(), 0, true, indexArray.constData());
 
 //	SphericalConvexPolygon poly(getGrid()->getPolygon(level, x, y));
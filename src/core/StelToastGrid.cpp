@@ -113,15 +113,18 @@ QVector<Vec3d> ToastGrid::getVertexArray(int level, int x, int y, int resolution
 }
 
 
-QVector<Vec2f> ToastGrid::getTextureArray(int level, int x, int y, int resolution) const
+const QVector<Vec2f>& ToastGrid::getTextureArray(int level, int x, int y, int resolution) const
 {
 	Q_UNUSED(x);
 	Q_UNUSED(y);
 	Q_ASSERT(resolution >= level);
 	Q_ASSERT(resolution <= maxLevel);
+	auto it = textureArrays.constFind(resolution - level);
+	if (it != textureArrays.constEnd())
+		return *it;
 	// The size of the returned array
 	int size = pow2(resolution - level) + 1;
-	QVector<Vec2f> ret;
+	QVector<Vec2f>& ret = textureArrays[resolution - level];
 	ret.reserve(size * size);
 	for (int i = size-1; i >= 0; i--)
 	{
@@ -135,7 +138,7 @@ QVector<Vec2f> ToastGrid::getTextureArray(int level, int x, int y, int resolutio
 }
 
 
-QVector<unsigned short> ToastGrid::getTrianglesIndex(int level, int x, int y, int resolution) const
+const QVector<unsigned short>& ToastGrid::getTrianglesIndex(int level, int x, int y, int resolution) const
 {
 	Q_ASSERT(resolution >= level);
 	Q_ASSERT(resolution <= maxLevel);
@@ -144,7 +147,11 @@ QVector<unsigned short> ToastGrid::getTrianglesIndex(int level, int x, int y, in
 	// If we are in the top right or the bottom left quadrant we invert the diagonal of the triangles.
 	int middleIndex = pow2(level) / 2;
 	bool invert = (x >= middleIndex) == (y >= middleIndex);
-	QVector<unsigned short> ret;
+	const int key = (resolution - level) * 2 + (invert ? 1 : 0);
+	auto it = trianglesIndices.constFind(key);
+	if (it != trianglesIndices.constEnd())
+		return *it;
+	QVector<unsigned short>& ret = trianglesIndices[key];
 	ret.reserve(nbTiles * 6);
 	for (int i = 0; i < size - 1; ++i)
 	{
@@ -20,6 +20,7 @@
 #ifndef STELTOASTGRID_HPP
 #define STELTOASTGRID_HPP
 
+#include <QHash>
 #include <QVector>
 #include "VecMath.hpp"
 
@@ -31,6 +32,8 @@ inline int pow2(int x) {return 1 << x;}
 //! The ToastGrid class allows to compute the vertex arrays associated
 //! with TOAST tiles. Each method refers to a tile by its level and x
 //! and y coordinates.
+//! The texture and index arrays only depend on the subdivision of the tiles, they
+//! are computed once and shared by all the tiles.
 class ToastGrid
 {
 public:
@@ -48,13 +51,15 @@ public:
 	//! @param x the x coordinate of the tile.
 	//! @param y the y coordinate of the tile.
 	//! @param resolution the resolution of the returned array. TODO: UNITS?
-	QVector<Vec2f> getTextureArray(int level, int x, int y, int resolution) const;
+	//! @return an array shared by all the tiles with the same subdivision
+	const QVector<Vec2f>& getTextureArray(int level, int x, int y, int resolution) const;
 	//! Get the index of the vertex from getVertexArray sorted as a list of triangles.
 	//! @param level the TOAST level of the tile.
 	//! @param x the x coordinate of the tile.
 	//! @param y the y coordinate of the tile.
 	//! @param resolution the resolution of the returned array.  TODO: UNITS?
-	QVector<unsigned short> getTrianglesIndex(int level, int x, int y, int resolution) const;
+	//! @return an array shared by all the tiles with the same subdivision and diagonal orientation
+	const QVector<unsigned short>& getTrianglesIndex(int level, int x, int y, int resolution) const;
 	//! Returns the polygon contouring a given tile.
 	//! @param level the TOAST level of the tile.
 	//! @param x the x coordinate of the tile.
@@ -85,6 +90,10 @@ private:
 	int size;
 	//! The actual grid data
 	QVector<Vec3d> grid;
+	//! The texture arrays by number of subdivisions of the tiles
+	mutable QHash<int, QVector<Vec2f> > textureArrays;
+	//! The index arrays by number of subdivisions of the tiles, times 2 plus 1 for inverted diagonals
+	mutable QHash<int, QVector<unsigned short> > trianglesIndices;
 };
 
 #endif // STELTOASTGRID_HPP
@@ -55,11 +55,24 @@ StelTranslator::~StelTranslator()
 	translator = Q_NULLPTR;
 }
 
+QString StelTranslator::lookup(const QString& s, const QString& c) const
+{
+	// The context is separated by a control character which does not occur in the strings
+	const QString key = c.isEmpty() ? s : s + QChar(0x04) + c;
+	QMutexLocker locker(&translationsMutex);
+	auto it = translations.constFind(key);
+	if (it!=translations.constEnd())
+		return it.value();
+	const QString res = translator->translate("", s.toUtf8().constData(), c.toUtf8().constData());
+	translations.insert(key, res);
+	return res;
+}
+
 QString StelTranslator::qtranslate(const QString& s, const QString& c) const
 {
 	if (s.isEmpty())
 		return "";
-	QString res = translator->translate("", s.toUtf8().constData(), c.toUtf8().constData());
+	const QString res = lookup(s, c);
 	if (res.isEmpty())
 		return s;
 	return res;
@@ -67,7 +80,7 @@ QString StelTranslator::qtranslate(const QString& s, const QString& c) const
 
 QString StelTranslator::tryQtranslate(const QString &s, const QString &c) const
 {
-	return translator->translate("", s.toUtf8().constData(),c.toUtf8().constData());
+	return lookup(s, c);
 }
 	
 //! Initialize Translation
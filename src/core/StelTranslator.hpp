@@ -23,7 +23,9 @@
 //! @file StelTranslator.hpp
 //! Define some translation macros.
 
+#include <QHash>
 #include <QMap>
+#include <QMutex>
 #include <QString>
 
 //! @def q_(str)
@@ -44,6 +46,8 @@
 //! Class used to translate strings to any language.
 //! Implements a nice interface to gettext which is UTF-8 compliant and is somewhat multiplateform
 //! All its operations do not modify the global locale.
+//! The strings are looked up in the translation file only once, later translations of the same string come from
+//! a table of the translator, so that reusing a translator (see StelLocaleMgr) makes retranslating the objects cheap.
 //! The purpose of this class is to remove all non-OO C locale functions from stellarium.
 //! @author Fabien Chereau
 class StelTranslator
@@ -122,6 +126,15 @@ private:
 	//! QTranslator instance
 	class QTranslator* translator;
 
+	//! Look up a string in the table of translations, or in the translation file the first time.
+	//! @return the translation, or a null string if it is not translated
+	QString lookup(const QString& s, const QString& c) const;
+
+	//! The strings already looked up, with their context, and their translation or a null string.
+	mutable QHash<QString, QString> translations;
+	//! Translations may be done from several threads
+	mutable QMutex translationsMutex;
+
 	//! Try to determine system language from system configuration
 	static void initSystemLanguage(void);
 	
@@ -23,11 +23,13 @@
 
 #include "StelUtils.hpp"
 #include "VecMath.hpp"
+#include "StelStartupTrace.hpp"
 #include <QBuffer>
 #include <QString>
 #include <QStringList>
 #include <QTextStream>
 #include <QFile>
+#include <QFileDevice>
 #include <QDebug>
 #include <QLocale>
 #include <QRegExp>
@@ -235,6 +237,50 @@ QString radToHmsStrAdapt(const double angle)
 	return buf;
 }
 
+//! Write the decimal digits of a value, padded on the left to width characters.
+//! @return the number of written characters
+static int writeDigits(QChar* buffer, quint64 value, int width, QLatin1Char pad=QLatin1Char('0'))
+{
+	char digits[20];
+	int n = 0;
+	do
+	{
+		digits[n++] = static_cast<char>('0' + value%10);
+		value /= 10;
+	} while (value);
+	int len = 0;
+	while (len+n < width)
+		buffer[len++] = pad;
+	while (n)
+		buffer[len++] = QLatin1Char(digits[--n]);
+	return len;
+}
+
+//! Round a non-negative value to a number of decimals, in units of the last decimal.
+static quint64 roundToUnits(double value, int precision)
+{
+	double scale = 1.;
+	for (int i=0; i<precision; ++i)
+		scale *= 10.;
+	return static_cast<quint64>(std::floor(qMax(0., value)*scale + 0.5));
+}
+
+//! Write a value rounded by roundToUnits(), with the integer part padded with zeros to width digits.
+//! @return the number of written characters
+static int writeFixed(QChar* buffer, quint64 units, int precision, int width)
+{
+	quint64 scale = 1;
+	for (int i=0; i<precision; ++i)
+		scale *= 10;
+	int len = writeDigits(buffer, units/scale, width);
+	if (precision>0)
+	{
+		buffer[len++] = QLatin1Char('.');
+		len += writeDigits(buffer+len, units%scale, precision);
+	}
+	return len;
+}
+
 /*************************************************************************
  Convert an angle in radian to a hms formatted string
  If decimal is true,  output should be like this: "  16h29m55.3s"
@@ -242,29 +288,25 @@ QString radToHmsStrAdapt(const double angle)
  If decimal is false, output should be like this: "   0h26m5s"
 *************************************************************************/
 QString radToHmsStr(const double angle, const bool decimal)
+{
+	QChar buffer[FORMAT_BUFFER_LENGTH];
+	return QString(buffer, formatRadToHms(buffer, angle, decimal));
+}
+
+int formatRadToHms(QChar* buffer, const double angle, const bool decimal)
 {
 	unsigned int h,m;
 	double s;
 	StelUtils::radToHms(angle+0.005*M_PI/12/(60*60), h, m, s);
-	int width, precision;
-	QString carry, r;
-	if (decimal)
-	{
-		width=5;
-		precision=2;
-		carry="60.00";
-	}
-	else
-	{
-		width=4;
-		precision=1;
-		carry="60.0";
-	}
+	const int width = decimal ? 5 : 4;
+	const int precision = decimal ? 2 : 1;
+	const quint64 carry = decimal ? 6000 : 600;
+	quint64 units = roundToUnits(s, precision);
 
 	// handle carry case (when seconds are rounded up)
-	if (QString("%1").arg(s, 0, 'f', precision) == carry)
+	if (units >= carry)
 	{
-		s=0;
+		units=0;
 		m+=1;
 	}
 	if (m==60)
@@ -272,10 +314,16 @@ QString radToHmsStr(const double angle, const bool decimal)
 		m=0;
 		h+=1;
 	}
-	if (h==24 && m==0 && s==0)
+	if (h==24 && m==0 && units==0)
 		h=0;
 
-	return QString("%1h%2m%3s").arg(h, width).arg(m, 2, 10, QChar('0')).arg(s, 3+precision, 'f', precision, QChar('0'));
+	int len = writeDigits(buffer, h, width, QLatin1Char(' '));
+	buffer[len++] = QLatin1Char('h');
+	len += writeDigits(buffer+len, m, 2);
+	buffer[len++] = QLatin1Char('m');
+	len += writeFixed(buffer+len, units, precision, 2);
+	buffer[len++] = QLatin1Char('s');
+	return len;
 }
 
 /*************************************************************************
@@ -319,34 +367,27 @@ QString radToDmsStrAdapt(const double angle, const bool useD)
 *************************************************************************/
 QString radToDmsStr(const double angle, const bool decimal, const bool useD)
 {
-	QChar degsign('d');
-	if (!useD)
-	{
-		degsign = 0x00B0;
-	}
+	QChar buffer[FORMAT_BUFFER_LENGTH];
+	return QString(buffer, formatRadToDms(buffer, angle, decimal, useD));
+}
+
+int formatRadToDms(QChar* buffer, const double angle, const bool decimal, const bool useD)
+{
 	bool sign;
 	unsigned int d,m;
 	double s;
 	StelUtils::radToDms(angle+0.005*M_PI/180/(60*60)*(angle<0?-1.:1.), sign, d, m, s);
-	QString str;
-	QTextStream os(&str);
-	os << (sign?'+':'-') << d << degsign;
+	const int precision = decimal ? 1 : 0;
 
-	os << qSetFieldWidth(2) << qSetPadChar('0') << m << qSetFieldWidth(0) << '\'';
-	int width;
-	if (decimal)
-	{
-		os << qSetRealNumberPrecision(1);
-		width = 4;
-	}
-	else
-	{
-		os << qSetRealNumberPrecision(0);
-		width = 2;
-	}
-	os << fixed << qSetFieldWidth(width) << qSetPadChar('0') << s << qSetFieldWidth(0) << '\"';
-
-	return str;
+	int len = 0;
+	buffer[len++] = QLatin1Char(sign?'+':'-');
+	len += writeDigits(buffer+len, d, 0);
+	buffer[len++] = useD ? QChar('d') : QChar(0x00B0);
+	len += writeDigits(buffer+len, m, 2);
+	buffer[len++] = QLatin1Char('\'');
+	len += writeFixed(buffer+len, roundToUnits(s, precision), precision, 2);
+	buffer[len++] = QLatin1Char('"');
+	return len;
 }
 
 /*************************************************************************
@@ -623,6 +664,16 @@ double getDecAngle(const QString& str)
 	return -0.0;
 }
 
+double getDecAngleFromVariant(const QVariant& value)
+{
+	// Numbers skip the regular expressions, which dominate the bulk additions
+	bool ok = false;
+	const double deg = value.type()==QVariant::String ? 0. : value.toDouble(&ok);
+	if (ok)
+		return deg*M_PI/180.;
+	return getDecAngle(value.toString());
+}
+
 // Check if a number is a power of 2
 bool isPowerOfTwo(const int value)
 {
@@ -769,28 +820,37 @@ void getTimeFromJulianDay(const double julianDay, int *hour, int *minute, int *s
 }
 
 QString julianDayToISO8601String(const double jd, bool addMS)
+{
+	QChar buffer[FORMAT_BUFFER_LENGTH];
+	return QString(buffer, formatJulianDayToISO8601(buffer, jd, addMS));
+}
+
+int formatJulianDayToISO8601(QChar* buffer, const double jd, bool addMS)
 {
 	int year, month, day, hour, minute, second,millis;
 	getDateFromJulianDay(jd, &year, &month, &day);
 	getTimeFromJulianDay(jd, &hour, &minute, &second, addMS ? &millis : Q_NULLPTR );
 
-	QString res = QString("%1-%2-%3T%4:%5:%6")
-				 .arg((year >= 0 ? year : -1* year),4,10,QLatin1Char('0'))
-				 .arg(month,2,10,QLatin1Char('0'))
-				 .arg(day,2,10,QLatin1Char('0'))
-				 .arg(hour,2,10,QLatin1Char('0'))
-				 .arg(minute,2,10,QLatin1Char('0'))
-				 .arg(second,2,10,QLatin1Char('0'));
-
-	if(addMS)
-	{
-		res = res.append(".%1").arg(millis,3,10,QLatin1Char('0'));
-	}
+	int len = 0;
 	if (year < 0)
+		buffer[len++] = QLatin1Char('-');
+	len += writeDigits(buffer+len, static_cast<quint64>(qAbs(static_cast<qint64>(year))), 4);
+	buffer[len++] = QLatin1Char('-');
+	len += writeDigits(buffer+len, month, 2);
+	buffer[len++] = QLatin1Char('-');
+	len += writeDigits(buffer+len, day, 2);
+	buffer[len++] = QLatin1Char('T');
+	len += writeDigits(buffer+len, hour, 2);
+	buffer[len++] = QLatin1Char(':');
+	len += writeDigits(buffer+len, minute, 2);
+	buffer[len++] = QLatin1Char(':');
+	len += writeDigits(buffer+len, second, 2);
+	if(addMS)
 	{
-		res.prepend("-");
+		buffer[len++] = QLatin1Char('.');
+		len += writeDigits(buffer+len, millis, 3);
 	}
-	return res;
+	return len;
 }
 
 // Format the date per the fmt.
@@ -2452,6 +2512,7 @@ QByteArray uncompress(const QByteArray& data)
 //! with other data.
 QByteArray uncompress(QIODevice& device, qint64 maxBytes)
 {
+	StelStartupTrace::Scope trace("decompress", "StelUtils::uncompress");
 	// this is a basic zlib decompression routine, similar to:
 	// http://zlib.net/zlib_how.html
 
@@ -2535,6 +2596,10 @@ QByteArray uncompress(QIODevice& device, qint64 maxBytes)
 
 	}while(ret!=Z_STREAM_END);
 
+	// The data of buffers were read from their files by the caller
+	if (StelStartupTrace::isEnabled() && qobject_cast<QFileDevice*>(&device))
+		trace.setBytesRead(bytesRead);
+
 	// close zlib
 	inflateEnd(&strm);
 
@@ -2549,6 +2614,42 @@ QByteArray uncompress(QIODevice& device, qint64 maxBytes)
 	return out;
 }
 
+QByteArray compressGzip(const QByteArray& data, int level)
+{
+	z_stream strm;
+	strm.zalloc = Z_NULL;
+	strm.zfree = Z_NULL;
+	strm.opaque = Z_NULL;
+
+	// 15 + 16 to write a gzip header and trailer instead of the zlib ones
+	int ret = deflateInit2(&strm, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+	if (ret != Z_OK)
+	{
+		qWarning()<<"zlib init error ("<<ret<<"), can't compress";
+		if(strm.msg)
+			qWarning()<<"zlib message: "<<QString(strm.msg);
+		return QByteArray();
+	}
+
+	// the whole input is known, so a single deflate call into a buffer of the maximal size is enough
+	QByteArray out(static_cast<int>(deflateBound(&strm, static_cast<uLong>(data.size()))), 0);
+	strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+	strm.avail_in = static_cast<uInt>(data.size());
+	strm.next_out = reinterpret_cast<Bytef*>(out.data());
+	strm.avail_out = static_cast<uInt>(out.size());
+
+	ret = deflate(&strm, Z_FINISH);
+	deflateEnd(&strm);
+	if (ret != Z_STREAM_END)
+	{
+		qWarning()<<"zlib deflate error ("<<ret<<"), can't compress";
+		return QByteArray();
+	}
+
+	out.resize(out.size() - static_cast<int>(strm.avail_out));
+	return out;
+}
+
 
 } // end of the StelUtils namespace
 
@@ -104,6 +104,14 @@ namespace StelUtils
 	//! @param decimal output decimal second value
 	QString radToHmsStr(const double angle, const bool decimal=false);
 
+	//! The length of the buffers of formatRadToHms(), formatRadToDms() and formatJulianDayToISO8601().
+	const int FORMAT_BUFFER_LENGTH = 48;
+
+	//! Write the string of radToHmsStr() in a buffer, without allocating memory, e.g. for the rows of exports.
+	//! @param buffer at least FORMAT_BUFFER_LENGTH characters
+	//! @return the number of written characters
+	int formatRadToHms(QChar* buffer, const double angle, const bool decimal=false);
+
 	//! Convert an angle in radian to a dms formatted string.
 	//! If the second, minute part is == 0, it is not output
 	//! @param angle input angle in radian
@@ -116,6 +124,11 @@ namespace StelUtils
 	//! @param useD Define if letter "d" must be used instead of deg sign
 	QString radToDmsStr(const double angle, const bool decimal=false, const bool useD=false);
 
+	//! Write the string of radToDmsStr() in a buffer, without allocating memory, e.g. for the rows of exports.
+	//! @param buffer at least FORMAT_BUFFER_LENGTH characters
+	//! @return the number of written characters
+	int formatRadToDms(QChar* buffer, const double angle, const bool decimal=false, const bool useD=false);
+
 	//! Convert an angle in radian to a dms formatted string.
 	//! @param angle input angle in radian
 	//! @param precision
@@ -230,6 +243,9 @@ namespace StelUtils
 	//! Note: if there is a N, S, E or W suffix, any leading + or -
 	//! characters are ignored.
 	double getDecAngle(const QString& str);
+	//! Convert an angle of the bulk functions for scripts to radians.
+	//! @param value a number of degrees, or a string for getDecAngle()
+	double getDecAngleFromVariant(const QVariant& value);
 
 	//! Check if a number is a power of 2.
 	bool isPowerOfTwo(const int value);
@@ -263,6 +279,11 @@ namespace StelUtils
 	//! Also handles negative and distant years.
 	QString julianDayToISO8601String(const double jd, bool addMS = false);
 
+	//! Write the string of julianDayToISO8601String() in a buffer, without allocating memory, e.g. for the rows of exports.
+	//! @param buffer at least FORMAT_BUFFER_LENGTH characters
+	//! @return the number of written characters
+	int formatJulianDayToISO8601(QChar* buffer, const double jd, bool addMS = false);
+
 	//! Return the Julian Date matching the ISO8601 date string.
 	//! Also handles negative and distant years.
 	double getJulianDayFromISO8601String(const QString& iso8601Date, bool* ok);
@@ -728,6 +749,12 @@ namespace StelUtils
 	//! with other data.
 	QByteArray uncompress(QIODevice &device, qint64 maxBytes=-1);
 
+	//! Compress data in gzip format, which can be read with uncompress() or sent with HTTP Content-Encoding gzip.
+	//! @param data the data to compress
+	//! @param level the zlib compression level from 0 (none) to 9 (best), or -1 for the zlib default
+	//! @return the compressed data, or an empty array on error
+	QByteArray compressGzip(const QByteArray& data, int level = -1);
+
 	//! Greatest Common Divisor (Euclid's algorithm)
 	//! @param a first number
 	//! @param b second number
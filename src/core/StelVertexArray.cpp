@@ -110,6 +110,58 @@ StelVertexArray StelVertexArray::removeDiscontinuousTriangles(const StelProjecto
 	return ret;
 }
 
+namespace
+{
+	// Split the triangles passed by StelVertexArray::foreachTriangle() into an output array
+	struct TriangleSubdivider
+	{
+		StelVertexArray* out;
+
+		void operator()(const Vec3d* v0, const Vec3d* v1, const Vec3d* v2,
+				const Vec2f* t0, const Vec2f* t1, const Vec2f* t2,
+				const Vec3f* c0, const Vec3f* c1, const Vec3f* c2,
+				unsigned int, unsigned int, unsigned int)
+		{
+			Vec3d m01 = *v0 + *v1; m01.normalize();
+			Vec3d m12 = *v1 + *v2; m12.normalize();
+			Vec3d m20 = *v2 + *v0; m20.normalize();
+			out->vertex << *v0 << m01 << m20
+				    << m01 << *v1 << m12
+				    << m20 << m12 << *v2
+				    << m01 << m12 << m20;
+			if (t0)
+			{
+				const Vec2f tm01 = (*t0 + *t1)*0.5f;
+				const Vec2f tm12 = (*t1 + *t2)*0.5f;
+				const Vec2f tm20 = (*t2 + *t0)*0.5f;
+				out->texCoords << *t0 << tm01 << tm20
+					       << tm01 << *t1 << tm12
+					       << tm20 << tm12 << *t2
+					       << tm01 << tm12 << tm20;
+			}
+			if (c0)
+			{
+				const Vec3f cm01 = (*c0 + *c1)*0.5f;
+				const Vec3f cm12 = (*c1 + *c2)*0.5f;
+				const Vec3f cm20 = (*c2 + *c0)*0.5f;
+				out->colors << *c0 << cm01 << cm20
+					    << cm01 << *c1 << cm12
+					    << cm20 << cm12 << *c2
+					    << cm01 << cm12 << cm20;
+			}
+		}
+	};
+}
+
+StelVertexArray StelVertexArray::subdivideTriangles() const
+{
+	StelVertexArray ret(Triangles);
+	TriangleSubdivider subdivider;
+	subdivider.out = &ret;
+	foreachTriangle(subdivider);
+	return ret;
+}
+
 QDataStream& operator<<(QDataStream& out, const StelVertexArray& p)
 {
 	out << p.vertex;
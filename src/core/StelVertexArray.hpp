@@ -74,6 +74,11 @@ struct StelVertexArray
 	//! Create a copy of the array with all the triangles intersecting the projector discontinuity removed.
 	StelVertexArray removeDiscontinuousTriangles(const class StelProjector* prj) const;
 
+	//! Split each triangle in 4, with the new vertices in the middle of the sides, normalized to the unit sphere.
+	//! Texture coordinates and colors are interpolated linearly.
+	//! @return a non-indexed array of Triangles.
+	StelVertexArray subdivideTriangles() const;
+
 private:
 	// Below we define a few methods that are templated to be optimized according to different types of VertexArray :
 	// The template parameter <bool T> defines whether the array has a texture.
@@ -27,7 +27,13 @@
 	#include <QTimer>
 	#include <QApplication>
 	#include "StelApp.hpp"
+	#include "StelCore.hpp"
 	#include "StelFader.hpp"
+	#include "StelModuleMgr.hpp"
+	#include "StelPainter.hpp"
+	#include "StelUtils.hpp"
+	#include "StelVideoTexture.hpp"
+	#include <QOpenGLContext>
 #endif
 
 
@@ -79,6 +85,13 @@ void StelVideoMgr::loadVideo(const QString& filename, const QString& id, const f
 	videoObjects[id]->videoItem->setVisible(show);
 #endif
 	videoObjects[id]->lastPos=-1;
+	videoObjects[id]->texture=Q_NULLPTR;
+	videoObjects[id]->onDome=false;
+	videoObjects[id]->skyVisible=show;
+	videoObjects[id]->skyCenter=Vec3d(1., 0., 0.);
+	videoObjects[id]->skyWidth=10.;
+	videoObjects[id]->skyHeight=-1.;
+	videoObjects[id]->skyRotation=0.;
 
 	// A few connections are not really needed, they are signals we don't use. TBD: Remove or keep commented out?
 	connect(videoObjects[id]->player, SIGNAL(bufferStatusChanged(int)), this, SLOT(handleBufferStatusChanged(int)));
@@ -369,6 +382,13 @@ void StelVideoMgr::dropVideo(const QString& id)
 		StelMainView::getInstance().scene()->removeItem(videoObjects[id]->videoItem);
 		delete videoObjects[id]->player;
 		delete videoObjects[id]->videoItem;
+		if (videoObjects[id]->texture)
+		{
+			// The texture owns GL objects, which can only be deleted in their context.
+			if (!QOpenGLContext::currentContext())
+				StelMainView::getInstance().glContextMakeCurrent();
+			delete videoObjects[id]->texture;
+		}
 		delete videoObjects[id];
 		videoObjects.remove(id);
 	}
@@ -483,7 +503,11 @@ void StelVideoMgr::showVideo(const QString& id, const bool show)
 {
 	if (videoObjects.contains(id))
 	{
-		if (videoObjects[id]->videoItem!=Q_NULLPTR)
+		if (videoObjects[id]->texture!=Q_NULLPTR)
+		{
+			videoObjects[id]->skyVisible=show;
+		}
+		else if (videoObjects[id]->videoItem!=Q_NULLPTR)
 		{
 			videoObjects[id]->videoItem->setVisible(show);
 		}
@@ -491,6 +515,194 @@ void StelVideoMgr::showVideo(const QString& id, const bool show)
 	else qDebug() << "StelVideoMgr::showVideo()" << id << ": no such video";
 }
 
+void StelVideoMgr::setSkyOutput(VideoPlayer* vp)
+{
+	if (vp->texture)
+		return;
+	vp->texture = new StelVideoTexture();
+	// Backends which can decode into OpenGL textures only do so when they know the context to use.
+	vp->texture->setProperty("GLContext", QVariant::fromValue<QObject*>(StelMainView::getInstance().glContext()));
+	vp->player->setVideoOutput(vp->texture);
+	vp->skyVisible=vp->videoItem->isVisible();
+	vp->videoItem->setVisible(false);
+}
+
+void StelVideoMgr::showVideoOnSky(const QString& id, double ra, double dec, double width, double height, double rotation)
+{
+	if (videoObjects.contains(id))
+	{
+		VideoPlayer* vp=videoObjects[id];
+		setSkyOutput(vp);
+		vp->onDome=false;
+		StelUtils::spheToRect(ra*M_PI/180., dec*M_PI/180., vp->skyCenter);
+		// The gnomonic projection cannot show half of the sky or more.
+		vp->skyWidth=qBound(0., width, 170.);
+		vp->skyHeight=(height<0. ? -1. : qBound(0., height, 170.));
+		vp->skyRotation=rotation;
+	}
+	else qDebug() << "StelVideoMgr::showVideoOnSky()" << id << ": no such video";
+}
+
+void StelVideoMgr::showVideoOnDome(const QString& id, double fov, double frontAzimuth)
+{
+	if (videoObjects.contains(id))
+	{
+		VideoPlayer* vp=videoObjects[id];
+		setSkyOutput(vp);
+		vp->onDome=true;
+		vp->skyWidth=qBound(1., fov, 360.);
+		vp->skyRotation=frontAzimuth;
+	}
+	else qDebug() << "StelVideoMgr::showVideoOnDome()" << id << ": no such video";
+}
+
+void StelVideoMgr::showVideoOnScreen(const QString& id)
+{
+	if (videoObjects.contains(id))
+	{
+		VideoPlayer* vp=videoObjects[id];
+		if (vp->texture==Q_NULLPTR)
+			return;
+		vp->player->setVideoOutput(vp->videoItem);
+		vp->videoItem->setVisible(vp->skyVisible);
+		if (!QOpenGLContext::currentContext())
+			StelMainView::getInstance().glContextMakeCurrent();
+		delete vp->texture;
+		vp->texture=Q_NULLPTR;
+	}
+	else qDebug() << "StelVideoMgr::showVideoOnScreen()" << id << ": no such video";
+}
+
+double StelVideoMgr::getCallOrder(StelModuleActionName actionName) const
+{
+	if (actionName==StelModule::ActionDraw)
+		return StelApp::getInstance().getModuleMgr().getModule("LandscapeMgr")->getCallOrder(actionName)+5;
+	return 0;
+}
+
+void StelVideoMgr::draw(StelCore* core)
+{
+	for (auto* vp : videoObjects)
+	{
+		if (vp->texture==Q_NULLPTR || !vp->skyVisible || vp->player->state()==QMediaPlayer::StoppedState)
+			continue;
+		if (vp->onDome)
+			drawOnDome(core, vp);
+		else
+			drawOnSky(core, vp);
+	}
+}
+
+void StelVideoMgr::drawOnSky(StelCore* core, VideoPlayer* vp)
+{
+	const QSize frameSize=vp->texture->getFrameSize();
+	if (frameSize.isEmpty())
+		return;
+	const double width=vp->skyWidth*M_PI/180.;
+	const double height=(vp->skyHeight<0. ? vp->skyWidth*frameSize.height()/frameSize.width() : vp->skyHeight)*M_PI/180.;
+
+	// Axes of the tangent plane at the center. Seen from inside the celestial sphere, East is left of North.
+	const Vec3d& center=vp->skyCenter;
+	Vec3d east(-center[1], center[0], 0.);
+	if (east.lengthSquared()<1e-12)
+		east.set(0., 1., 0.);
+	east.normalize();
+	const Vec3d north=center^east;
+	const double pa=vp->skyRotation*M_PI/180.;
+	const Vec3d up=north*std::cos(pa)+east*std::sin(pa);
+	const Vec3d right=north*std::sin(pa)-east*std::cos(pa);
+	const double halfWidth=std::tan(qMin(width, 3.)*0.5);
+	const double halfHeight=std::tan(qMin(height, 3.)*0.5);
+
+	static const int gridSize=16;
+	QVector<Vec3d> vertices;
+	QVector<Vec2f> texCoords;
+	vertices.reserve((gridSize+1)*(gridSize+1));
+	texCoords.reserve((gridSize+1)*(gridSize+1));
+	for (int j=0; j<=gridSize; ++j)
+	{
+		const double v=2.*j/gridSize-1.;
+		for (int i=0; i<=gridSize; ++i)
+		{
+			const double u=2.*i/gridSize-1.;
+			Vec3d p=center+right*(u*halfWidth)+up*(v*halfHeight);
+			p.normalize();
+			vertices << p;
+			texCoords << Vec2f(static_cast<float>(i)/gridSize, static_cast<float>(j)/gridSize);
+		}
+	}
+	QVector<unsigned short> indices;
+	indices.reserve(gridSize*gridSize*6);
+	for (int j=0; j<gridSize; ++j)
+	{
+		for (int i=0; i<gridSize; ++i)
+		{
+			const unsigned short a=j*(gridSize+1)+i;
+			const unsigned short b=a+gridSize+1;
+			indices << a << a+1 << b << b << a+1 << b+1;
+		}
+	}
+
+	StelPainter sPainter(core->getProjection(StelCore::FrameJ2000));
+	if (!vp->texture->bind())
+		return;
+	sPainter.setBlending(true);
+	sPainter.setColor(1.f, 1.f, 1.f, vp->videoItem->opacity());
+	sPainter.setArrays(vertices.constData(), texCoords.constData());
+	sPainter.drawFromArray(StelPainter::Triangles, indices.size(), 0, true, indices.constData());
+	sPainter.setBlending(false);
+}
+
+void StelVideoMgr::drawOnDome(StelCore* core, VideoPlayer* vp)
+{
+	if (vp->texture->getFrameSize().isEmpty())
+		return;
+
+	// Equidistant fisheye: the distance to the center of the frame is proportional to the zenith distance,
+	// and the bottom of the frame is at the front of the dome.
+	static const int rings=24;
+	static const int segments=72;
+	const double maxZenithDistance=vp->skyWidth*0.5*M_PI/180.;
+	const double front=vp->skyRotation*M_PI/180.;
+	QVector<Vec3d> vertices;
+	QVector<Vec2f> texCoords;
+	vertices.reserve((rings+1)*(segments+1));
+	texCoords.reserve((rings+1)*(segments+1));
+	for (int k=0; k<=rings; ++k)
+	{
+		const double r=static_cast<double>(k)/rings;
+		for (int m=0; m<=segments; ++m)
+		{
+			const double a=2.*M_PI*m/segments;
+			Vec3d p;
+			// Stellarium counts azimuths from South in the AltAz frame.
+			StelUtils::spheToRect(M_PI-(front+a), M_PI_2-r*maxZenithDistance, p);
+			vertices << p;
+			texCoords << Vec2f(0.5f+0.5f*r*std::sin(a), 0.5f-0.5f*r*std::cos(a));
+		}
+	}
+	QVector<unsigned short> indices;
+	indices.reserve(rings*segments*6);
+	for (int k=0; k<rings; ++k)
+	{
+		for (int m=0; m<segments; ++m)
+		{
+			const unsigned short a=k*(segments+1)+m;
+			const unsigned short b=a+segments+1;
+			indices << a << b << a+1 << a+1 << b << b+1;
+		}
+	}
+
+	StelPainter sPainter(core->getProjection(StelCore::FrameAltAz, StelCore::RefractionOff));
+	if (!vp->texture->bind())
+		return;
+	sPainter.setBlending(true);
+	sPainter.setColor(1.f, 1.f, 1.f, vp->videoItem->opacity());
+	sPainter.setArrays(vertices.constData(), texCoords.constData());
+	sPainter.drawFromArray(StelPainter::Triangles, indices.size(), 0, true, indices.constData());
+	sPainter.setBlending(false);
+}
+
 qint64 StelVideoMgr::getVideoDuration(const QString& id) const
 {
 	if (videoObjects.contains(id))
@@ -801,6 +1013,9 @@ void StelVideoMgr::update(double deltaTime)
 	{
 		QMediaPlayer::MediaStatus mediaStatus = (*voIter)->player->mediaStatus();
 		QString id=voIter.key();
+		// Videos on the sky have no frame on screen, but playVideo() may have shown the item.
+		if ((*voIter)->texture && (*voIter)->videoItem->isVisible())
+			(*voIter)->videoItem->setVisible(false);
 		// Maybe we have verbose as int with levels of verbosity, and output the next line with verbose>=2?
 		if (verbose)
 			qDebug() << "StelVideoMgr::update() for" << id << ": PlayerState:" << (*voIter)->player->state() << "MediaStatus: " << mediaStatus;
@@ -966,6 +1181,11 @@ void StelVideoMgr::setVideoXY(const QString&, float, float, const bool) {;}
 void StelVideoMgr::setVideoAlpha(const QString&, float) {;}
 void StelVideoMgr::resizeVideo(const QString&, float, float) {;}
 void StelVideoMgr::showVideo(const QString&, bool) {;}
+void StelVideoMgr::showVideoOnSky(const QString&, double, double, double, double, double) {;}
+void StelVideoMgr::showVideoOnDome(const QString&, double, double) {;}
+void StelVideoMgr::showVideoOnScreen(const QString&) {;}
+void StelVideoMgr::draw(StelCore*) {;}
+double StelVideoMgr::getCallOrder(StelModuleActionName) const {return 0;}
 // New functions for 0.15
 qint64 StelVideoMgr::getVideoDuration(const QString&){return -1;}
 qint64 StelVideoMgr::getVideoPosition(const QString&){return -1;}
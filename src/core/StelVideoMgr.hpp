@@ -31,10 +31,12 @@
 #include <QMediaContent>
 #include <QMediaPlayer>
 #include "StelFader.hpp"
+#include "VecMath.hpp"
 #endif
 #include "StelModule.hpp"
 
 class QGraphicsVideoItem;
+class StelVideoTexture;
 
 //! @class StelVideoMgr
 //! A scriptable way to show videos embedded in the screen.
@@ -47,6 +49,10 @@ class QGraphicsVideoItem;
 //! However, support for multimedia content depends on the operating system, installed codecs, and completeness of the QtMultimedia system support,
 //! so some features or video formats may not work for you (test video and re-code it if necessary).
 //!
+//! Instead of the screen, videos can also be shown on the sky with showVideoOnSky() or, for fulldome shows, over the whole dome with showVideoOnDome().
+//! In these modes the frames are kept in an OpenGL texture (see StelVideoTexture) and drawn with the sky, so that the
+//! sky keeps running behind the video and the usual projections and viewport effects apply.
+//!
 //! <h2>Linux notes</h2>
 //! The listed functions have been tested and work on Ubuntu 15.04 with Qt5.4 with NVidia 9800M and Intel Core-i3/HD5500.
 //! You need to install GStreamer plugins. Most critical seems to be gstreamer0.10-ffmpeg from
@@ -110,6 +116,12 @@ public slots:
 	//! @param deltaTime the time increment in second since last call.
 	virtual void update(double deltaTime);
 
+	//! Draw the videos which are shown on the sky or on the dome.
+	virtual void draw(StelCore* core);
+
+	//! Videos on the sky are drawn after the landscape, so that fulldome videos cover the whole dome.
+	virtual double getCallOrder(StelModuleActionName actionName) const;
+
 	//! load a video from filename, assign an id for it for later reference.
 	//! If id is already in use, replace it.
 	//! Prepare replay at upper-left corner x/ y in native resolution,
@@ -173,6 +185,26 @@ public slots:
 	//! @param show true to show, false to hide
 	void showVideo(const QString& id, const bool show);
 
+	//! Draw a video on the sky instead of the screen, as a rectangle centered on a position of the sky.
+	//! Sizes are angles measured on the sky, the video is drawn in the gnomonic projection around its center.
+	//! Use showVideo() to show or hide it, and showVideoOnScreen() to move it back to the screen.
+	//! @param id name given during loadVideo()
+	//! @param ra right ascension (J2000) of the center of the video in degrees
+	//! @param dec declination (J2000) of the center of the video in degrees
+	//! @param width angular width of the video in degrees
+	//! @param height angular height of the video in degrees. If -1, scale proportional from width and the video resolution.
+	//! @param rotation position angle of the top of the video in degrees, counted from North towards East
+	void showVideoOnSky(const QString& id, double ra, double dec, double width, double height=-1., double rotation=0.);
+
+	//! Draw a fulldome video, usually a fisheye "dome master", centered on the zenith over the sky.
+	//! @param id name given during loadVideo()
+	//! @param fov field of view of the fisheye in degrees, 180 for a hemisphere
+	//! @param frontAzimuth azimuth of the bottom of the frame (the front of the dome) in degrees from North towards East
+	void showVideoOnDome(const QString& id, double fov=180., double frontAzimuth=180.);
+
+	//! Show a video on the screen again after showVideoOnSky() or showVideoOnDome().
+	void showVideoOnScreen(const QString& id);
+
 	//! returns duration (in milliseconds) of loaded video. This may return valid result only after playVideo() or pauseVideo() have been called.
 	//! Returns -1 if video has not been analyzed yet. (loaded, but not started).
 	qint64 getVideoDuration(const QString& id) const;
@@ -253,8 +285,21 @@ private:
 		QPointF popupOrigin;       //!< Screen point where video appears to come out during playVideoPopout()
 		QPointF popupTargetCenter; //!< Target frame position (center of target frame) used during playVideoPopout()
 		int lastPos;               //!< This should not be required: We must track a bug in QtMultimedia where the QMediaPlayer is in playing state but does not progress the video position. In update() we try to let it run again.
+		StelVideoTexture* texture; //!< Output of the player while the video is shown on the sky, else Q_NULLPTR.
+		bool onDome;               //!< true for showVideoOnDome(), false for showVideoOnSky().
+		bool skyVisible;           //!< showVideo() state while the video is drawn on the sky.
+		Vec3d skyCenter;           //!< J2000 direction of the center of the video on the sky.
+		double skyWidth;           //!< angular width on the sky in degrees, or fisheye field of view on the dome.
+		double skyHeight;          //!< angular height on the sky in degrees. Negative to use the aspect ratio of the video.
+		double skyRotation;        //!< position angle on the sky, or azimuth of the front of the dome, in degrees.
 	} VideoPlayer;
 	QMap<QString, VideoPlayer*> videoObjects;
+	//! Create the texture output of a video, and connect it to the player instead of the video item.
+	void setSkyOutput(VideoPlayer* vp);
+	//! Draw a video on the sky, as a grid of gnomonic quads.
+	void drawOnSky(StelCore* core, VideoPlayer* vp);
+	//! Draw a video on the dome, as rings of a fisheye around the zenith.
+	void drawOnDome(StelCore* core, VideoPlayer* vp);
 	bool verbose;                      //!< true to write many more log entries (useful for script debugging) Activate with command-line option "--verbose"
 #endif
 };
@@ -0,0 +1,411 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifdef ENABLE_MEDIA
+
+#include "StelVideoTexture.hpp"
+#include "StelApp.hpp"
+#include "StelPainter.hpp"
+
+#include <QDebug>
+#include <QMatrix4x4>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLShaderProgram>
+#include <QVideoSurfaceFormat>
+
+StelVideoTexture::StelVideoTexture(QObject* parent)
+	: QAbstractVideoSurface(parent)
+	, frameDirty(false)
+	, kind(RGBA)
+	, glHandle(false)
+	, bottomToTop(false)
+	, yuvBt709(false)
+	, fbo(Q_NULLPTR)
+	, scale0(1.f)
+	, scale1(1.f)
+{
+	planeTex[0] = planeTex[1] = planeTex[2] = 0;
+}
+
+StelVideoTexture::~StelVideoTexture()
+{
+	if (QOpenGLContext::currentContext())
+		clear();
+	else if (fbo || planeTex[0])
+		qWarning() << "[StelVideoTexture] No OpenGL context at destruction, texture memory is lost";
+}
+
+QList<QVideoFrame::PixelFormat> StelVideoTexture::supportedPixelFormats(QAbstractVideoBuffer::HandleType handleType) const
+{
+	QList<QVideoFrame::PixelFormat> formats;
+	if (handleType == QAbstractVideoBuffer::GLTextureHandle)
+	{
+		// Textures made by the backend in our context: no copy at all
+		formats << QVideoFrame::Format_RGB32 << QVideoFrame::Format_ARGB32
+			<< QVideoFrame::Format_BGR32 << QVideoFrame::Format_BGRA32;
+	}
+	else if (handleType == QAbstractVideoBuffer::NoHandle)
+	{
+		// Prefer the formats of the decoders, so that the backend does not have to convert.
+		// Access to the individual planes of a frame appeared in Qt 5.5.
+#if QT_VERSION >= 0x050500
+		formats << QVideoFrame::Format_YUV420P << QVideoFrame::Format_YV12 << QVideoFrame::Format_NV12;
+#endif
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+		formats << QVideoFrame::Format_RGB32 << QVideoFrame::Format_ARGB32;
+#endif
+	}
+	return formats;
+}
+
+bool StelVideoTexture::start(const QVideoSurfaceFormat& format)
+{
+	const QVideoFrame::PixelFormat pf = format.pixelFormat();
+	glHandle = (format.handleType() == QAbstractVideoBuffer::GLTextureHandle);
+	if (!supportedPixelFormats(format.handleType()).contains(pf) || format.frameSize().isEmpty())
+	{
+		setError(UnsupportedFormatError);
+		return false;
+	}
+
+	switch (pf)
+	{
+		case QVideoFrame::Format_YUV420P:
+			kind = YUV420P;
+			break;
+		case QVideoFrame::Format_YV12:
+			kind = YV12;
+			break;
+		case QVideoFrame::Format_NV12:
+			kind = NV12;
+			break;
+		case QVideoFrame::Format_BGR32:
+		case QVideoFrame::Format_BGRA32:
+			kind = BGRA;
+			break;
+		default:
+			// 0xAARRGGBB words are stored as B, G, R, A bytes in memory, but GL textures are already in RGBA order.
+			kind = glHandle ? RGBA : BGRA;
+			break;
+	}
+	bottomToTop = (format.scanLineDirection() == QVideoSurfaceFormat::BottomToTop);
+	// When the stream does not tell, HD material is BT.709 and SD material is BT.601.
+	yuvBt709 = format.yCbCrColorSpace() == QVideoSurfaceFormat::YCbCr_BT709
+		|| (format.yCbCrColorSpace() == QVideoSurfaceFormat::YCbCr_Undefined && format.frameHeight() >= 720);
+	frameSize = format.frameSize();
+	return QAbstractVideoSurface::start(format);
+}
+
+void StelVideoTexture::stop()
+{
+	QMutexLocker lock(&mutex);
+	currentFrame = QVideoFrame();
+	frameDirty = false;
+	QAbstractVideoSurface::stop();
+}
+
+bool StelVideoTexture::present(const QVideoFrame& frame)
+{
+	if (frame.pixelFormat() != surfaceFormat().pixelFormat() || frame.size() != frameSize)
+	{
+		setError(IncorrectFormatError);
+		return false;
+	}
+	QMutexLocker lock(&mutex);
+	currentFrame = frame;
+	frameDirty = true;
+	return true;
+}
+
+bool StelVideoTexture::bind(int slot)
+{
+	QMutexLocker lock(&mutex);
+	if (frameDirty)
+	{
+		convertFrame();
+		frameDirty = false;
+		// The data of mapped frames is in the plane textures now, give the buffer back to the decoder.
+		if (!glHandle)
+			currentFrame = QVideoFrame();
+	}
+	if (!fbo)
+		return false;
+
+	QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+	gl->glActiveTexture(GL_TEXTURE0 + slot);
+	gl->glBindTexture(GL_TEXTURE_2D, fbo->texture());
+	return true;
+}
+
+void StelVideoTexture::clear()
+{
+	QMutexLocker lock(&mutex);
+	delete fbo;
+	fbo = Q_NULLPTR;
+	qDeleteAll(programs);
+	programs.clear();
+	if (planeTex[0])
+	{
+		QOpenGLContext::currentContext()->functions()->glDeleteTextures(3, planeTex);
+		planeTex[0] = planeTex[1] = planeTex[2] = 0;
+		planeSize[0] = planeSize[1] = planeSize[2] = QSize();
+	}
+}
+
+QOpenGLShaderProgram* StelVideoTexture::getProgram(FrameKind frameKind)
+{
+	QOpenGLShaderProgram* program = programs.value(frameKind, Q_NULLPTR);
+	if (program)
+		return program;
+
+	QOpenGLShader vshader(QOpenGLShader::Vertex);
+	const char* vsrc =
+		"attribute highp vec2 pos;\n"
+		"uniform mediump float flip;\n"
+		"varying highp vec2 texc;\n"
+		"void main(void)\n"
+		"{\n"
+		"    gl_Position = vec4(pos, 0., 1.);\n"
+		"    texc = vec2(0.5 + 0.5*pos.x, mix(0.5 - 0.5*pos.y, 0.5 + 0.5*pos.y, flip));\n"
+		"}\n";
+	vshader.compileSourceCode(vsrc);
+	if (!vshader.log().isEmpty()) { qWarning() << "StelVideoTexture::getProgram(): Warnings while compiling vshader: " << vshader.log(); }
+
+	QByteArray fsrc;
+	switch (frameKind)
+	{
+		case RGBA:
+			fsrc = "#define PACKED\n";
+			break;
+		case BGRA:
+			fsrc = "#define PACKED\n#define SWIZZLE\n";
+			break;
+		case NV12:
+			fsrc = "#define SEMIPLANAR\n";
+			break;
+		default:
+			break;
+	}
+	fsrc +=
+		"#ifdef GL_ES\n"
+		"#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+		"precision highp float;\n"
+		"#else\n"
+		"precision mediump float;\n"
+		"#endif\n"
+		"#endif\n"
+		"varying vec2 texc;\n"
+		"uniform sampler2D plane0;\n"
+		"uniform sampler2D plane1;\n"
+		"uniform sampler2D plane2;\n"
+		"uniform vec2 scale0;\n"
+		"uniform vec2 scale1;\n"
+		"uniform mat4 colorMatrix;\n"
+		"void main(void)\n"
+		"{\n"
+		"#ifdef PACKED\n"
+		"    vec4 c = texture2D(plane0, texc*scale0);\n"
+		"#ifdef SWIZZLE\n"
+		"    c = c.bgra;\n"
+		"#endif\n"
+		"    gl_FragColor = c;\n"
+		"#else\n"
+		"    float y = texture2D(plane0, texc*scale0).r;\n"
+		"#ifdef SEMIPLANAR\n"
+		"    vec2 uv = texture2D(plane1, texc*scale1).ra;\n"
+		"#else\n"
+		"    vec2 uv = vec2(texture2D(plane1, texc*scale1).r, texture2D(plane2, texc*scale1).r);\n"
+		"#endif\n"
+		"    gl_FragColor = vec4((colorMatrix*vec4(y, uv, 1.)).rgb, 1.);\n"
+		"#endif\n"
+		"}\n";
+	QOpenGLShader fshader(QOpenGLShader::Fragment);
+	fshader.compileSourceCode(fsrc);
+	if (!fshader.log().isEmpty()) { qWarning() << "StelVideoTexture::getProgram(): Warnings while compiling fshader: " << fshader.log(); }
+
+	program = new QOpenGLShaderProgram();
+	program->addShader(&vshader);
+	program->addShader(&fshader);
+	if (!StelPainter::linkProg(program, "videoFrameShader"))
+	{
+		delete program;
+		return Q_NULLPTR;
+	}
+	programs.insert(frameKind, program);
+	return program;
+}
+
+bool StelVideoTexture::uploadPlanes(QVideoFrame& frame)
+{
+	if (!frame.map(QAbstractVideoBuffer::ReadOnly))
+	{
+		qWarning() << "[StelVideoTexture] Cannot map video frame";
+		return false;
+	}
+
+	QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+	if (!planeTex[0])
+	{
+		gl->glGenTextures(3, planeTex);
+		for (int i=0; i<3; ++i)
+		{
+			gl->glBindTexture(GL_TEXTURE_2D, planeTex[i]);
+			gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		}
+	}
+
+	GLint oldAlignment;
+	gl->glGetIntegerv(GL_UNPACK_ALIGNMENT, &oldAlignment);
+	gl->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	// Lines may be padded: the textures are as wide as the lines in memory, and the shaders only sample the visible part.
+	auto upload = [&](int unit, int plane, GLenum format, int bytesPerTexel, int height)
+	{
+#if QT_VERSION >= 0x050500
+		const int width = frame.bytesPerLine(plane) / bytesPerTexel;
+		const uchar* data = frame.bits(plane);
+#else
+		const int width = frame.bytesPerLine() / bytesPerTexel;
+		const uchar* data = frame.bits();
+#endif
+		gl->glActiveTexture(GL_TEXTURE0 + unit);
+		gl->glBindTexture(GL_TEXTURE_2D, planeTex[plane]);
+		if (planeSize[plane] != QSize(width, height))
+		{
+			gl->glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+			planeSize[plane] = QSize(width, height);
+		}
+		else
+			gl->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, data);
+		return width;
+	};
+
+	const int w = frame.width();
+	const int h = frame.height();
+	switch (kind)
+	{
+		case YUV420P:
+		case YV12:
+		{
+			scale0 = static_cast<float>(w) / upload(0, 0, GL_LUMINANCE, 1, h);
+			// The shader always reads U from unit 1 and V from unit 2.
+			const int uPlane = (kind == YUV420P) ? 1 : 2;
+			scale1 = static_cast<float>((w+1)/2) / upload(1, uPlane, GL_LUMINANCE, 1, (h+1)/2);
+			upload(2, 3-uPlane, GL_LUMINANCE, 1, (h+1)/2);
+			break;
+		}
+		case NV12:
+			scale0 = static_cast<float>(w) / upload(0, 0, GL_LUMINANCE, 1, h);
+			scale1 = static_cast<float>((w+1)/2) / upload(1, 1, GL_LUMINANCE_ALPHA, 2, (h+1)/2);
+			break;
+		default:
+			scale0 = static_cast<float>(w) / upload(0, 0, GL_RGBA, 4, h);
+			break;
+	}
+
+	gl->glPixelStorei(GL_UNPACK_ALIGNMENT, oldAlignment);
+	frame.unmap();
+	return true;
+}
+
+void StelVideoTexture::convertFrame()
+{
+	if (!currentFrame.isValid())
+		return;
+	QOpenGLShaderProgram* program = getProgram(kind);
+	if (!program)
+		return;
+
+	QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+	if (glHandle)
+	{
+		gl->glActiveTexture(GL_TEXTURE0);
+		gl->glBindTexture(GL_TEXTURE_2D, currentFrame.handle().toUInt());
+		scale0 = 1.f;
+	}
+	else if (!uploadPlanes(currentFrame))
+		return;
+
+	if (!fbo || fbo->size() != frameSize)
+	{
+		delete fbo;
+		fbo = new QOpenGLFramebufferObject(frameSize);
+		gl->glBindTexture(GL_TEXTURE_2D, fbo->texture());
+		gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		// Rebind the source of the pass, which may have been replaced on unit 0.
+		gl->glActiveTexture(GL_TEXTURE0);
+		gl->glBindTexture(GL_TEXTURE_2D, glHandle ? currentFrame.handle().toUInt() : planeTex[0]);
+	}
+
+	// Limited range YCbCr to RGB, written as a matrix applied to (Y, U, V, 1).
+	const float kr = yuvBt709 ? 0.2126f : 0.299f;
+	const float kb = yuvBt709 ? 0.0722f : 0.114f;
+	const float kg = 1.f - kr - kb;
+	const float ys = 255.f/219.f;
+	const float cs = 255.f/224.f;
+	const float rv = 2.f*(1.f-kr)*cs;
+	const float bu = 2.f*(1.f-kb)*cs;
+	const float gu = -bu*kb/kg;
+	const float gv = -rv*kr/kg;
+	const float y0 = 16.f/255.f;
+	const QMatrix4x4 colorMatrix(ys, 0.f, rv, -ys*y0 - 0.5f*rv,
+				     ys, gu,  gv, -ys*y0 - 0.5f*(gu+gv),
+				     ys, bu,  0.f, -ys*y0 - 0.5f*bu,
+				     0.f, 0.f, 0.f, 1.f);
+
+	GLint viewport[4];
+	gl->glGetIntegerv(GL_VIEWPORT, viewport);
+	const bool blend = gl->glIsEnabled(GL_BLEND);
+	gl->glDisable(GL_BLEND);
+	StelOpenGL::ScissorSuspender noScissor;
+	fbo->bind();
+	gl->glViewport(0, 0, frameSize.width(), frameSize.height());
+
+	static const float quad[] = {-1.f, -1.f, 1.f, -1.f, -1.f, 1.f, 1.f, 1.f};
+	program->bind();
+	program->setUniformValue("plane0", 0);
+	program->setUniformValue("plane1", 1);
+	program->setUniformValue("plane2", 2);
+	program->setUniformValue("scale0", scale0, 1.f);
+	program->setUniformValue("scale1", scale1, 1.f);
+	program->setUniformValue("colorMatrix", colorMatrix);
+	program->setUniformValue("flip", bottomToTop ? 1.f : 0.f);
+	const int posLoc = program->attributeLocation("pos");
+	program->enableAttributeArray(posLoc);
+	program->setAttributeArray(posLoc, GL_FLOAT, quad, 2);
+	gl->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	program->disableAttributeArray(posLoc);
+	program->release();
+
+	gl->glBindFramebuffer(GL_FRAMEBUFFER, StelApp::getInstance().getDefaultFBO());
+	gl->glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	if (blend)
+		gl->glEnable(GL_BLEND);
+	gl->glActiveTexture(GL_TEXTURE0);
+}
+
+#endif // ENABLE_MEDIA
@@ -0,0 +1,103 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STELVIDEOTEXTURE_HPP
+#define STELVIDEOTEXTURE_HPP
+
+#ifdef ENABLE_MEDIA
+
+#include <QAbstractVideoSurface>
+#include <QVideoFrame>
+#include <QMutex>
+#include <QHash>
+#include <QSize>
+
+class QOpenGLFramebufferObject;
+class QOpenGLShaderProgram;
+
+//! @class StelVideoTexture
+//! A video surface which keeps the frames of a QMediaPlayer in an OpenGL texture, so that videos can be drawn on the sky.
+//! Frames are never converted on the CPU. When the media backend delivers OpenGL textures they are used directly,
+//! otherwise the planes of the mapped frame are uploaded as they are, and YUV is converted to RGB by a shader.
+//! In both cases one pass into a framebuffer object normalizes the pixel format and the scan line direction:
+//! the texture returned by bind() is always RGBA, with texture coordinate t=1 on the top row of the picture like for StelTexture.
+class StelVideoTexture : public QAbstractVideoSurface
+{
+	Q_OBJECT
+
+public:
+	StelVideoTexture(QObject* parent=Q_NULLPTR);
+	~StelVideoTexture();
+
+	virtual QList<QVideoFrame::PixelFormat> supportedPixelFormats(QAbstractVideoBuffer::HandleType handleType = QAbstractVideoBuffer::NoHandle) const Q_DECL_OVERRIDE;
+	virtual bool start(const QVideoSurfaceFormat& format) Q_DECL_OVERRIDE;
+	virtual void stop() Q_DECL_OVERRIDE;
+	virtual bool present(const QVideoFrame& frame) Q_DECL_OVERRIDE;
+
+	//! Convert the last presented frame if it was not converted yet, and bind the result to a texture unit.
+	//! Must be called from the main thread with the OpenGL context current.
+	//! @return false if no frame has been presented yet.
+	bool bind(int slot=0);
+
+	//! Get the size of the video frames in pixels.
+	QSize getFrameSize() const {return frameSize;}
+
+	//! Release all OpenGL resources. Requires a valid context.
+	void clear();
+
+private:
+	//! How the pixel data of a frame must be interpreted by the conversion shader.
+	enum FrameKind
+	{
+		RGBA,		//!< packed RGB, as a GL texture or mapped memory whose bytes are in RGBA order
+		BGRA,		//!< packed RGB whose bytes are in BGRA order
+		YUV420P,	//!< 3 planes Y, U, V with half resolution chroma
+		YV12,		//!< 3 planes Y, V, U with half resolution chroma
+		NV12		//!< 1 plane Y and 1 plane of interleaved UV
+	};
+
+	//! Get the shader program converting a kind of frame, compiling it on first use.
+	QOpenGLShaderProgram* getProgram(FrameKind kind);
+	//! Upload the planes of a mapped frame into the plane textures.
+	//! @return false if the frame cannot be mapped.
+	bool uploadPlanes(QVideoFrame& frame);
+	//! Draw the current frame into the framebuffer object.
+	void convertFrame();
+
+	QMutex mutex;
+	QVideoFrame currentFrame;	// last frame given to present(), protected by mutex
+	bool frameDirty;		// true if currentFrame was not converted yet, protected by mutex
+
+	FrameKind kind;
+	bool glHandle;
+	bool bottomToTop;
+	bool yuvBt709;
+	QSize frameSize;
+
+	QOpenGLFramebufferObject* fbo;
+	unsigned int planeTex[3];
+	QSize planeSize[3];
+	float scale0;			// ratio of the frame width to the width of the first plane texture, which may be padded
+	float scale1;			// same for the chroma planes
+	QHash<int, QOpenGLShaderProgram*> programs;
+};
+
+#endif // ENABLE_MEDIA
+
+#endif // STELVIDEOTEXTURE_HPP
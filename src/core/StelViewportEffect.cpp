@@ -23,13 +23,30 @@
 #include "StelPainter.hpp"
 #include "SphericMirrorCalculator.hpp"
 #include "StelFileMgr.hpp"
+#include "StelTexture.hpp"
+#include "StelTextureMgr.hpp"
 #include "StelMovementMgr.hpp"
 #include "StelUtils.hpp"
+#include "Dithering.hpp"
 
+#include <QOpenGLContext>
 #include <QOpenGLFramebufferObject>
+#include <QOpenGLShaderProgram>
 #include <QSettings>
 #include <QFile>
 #include <QDir>
+#include <QTextStream>
+#include <QtEndian>
+
+#include <cstring>
+
+// Not defined in the OpenGL ES 2 headers
+#ifndef GL_RGB32F
+#define GL_RGB32F 0x8815
+#endif
+#ifndef GL_RGBA32F
+#define GL_RGBA32F 0x8814
+#endif
 
 void StelViewportEffect::paintViewportBuffer(const QOpenGLFramebufferObject* buf) const
 {
@@ -39,6 +56,481 @@ void StelViewportEffect::paintViewportBuffer(const QOpenGLFramebufferObject* buf
 	sPainter.drawRect2d(0, 0, buf->size().width(), buf->size().height());
 }
 
+StelViewportScaler::StelViewportScaler(float scale)
+	: scale(scale)
+	, screenDevicePixelsPerPixel(StelApp::getInstance().getCore()->getCurrentStelProjectorParams().devicePixelsPerPixel)
+{
+	// The projectors work in the pixels of the buffer.
+	StelCore* core = StelApp::getInstance().getCore();
+	StelProjector::StelProjectorParams params = core->getCurrentStelProjectorParams();
+	params.devicePixelsPerPixel = screenDevicePixelsPerPixel*scale;
+	core->setCurrentStelProjectorParams(params);
+}
+
+StelViewportScaler::~StelViewportScaler()
+{
+	StelCore* core = StelApp::getInstance().getCore();
+	StelProjector::StelProjectorParams params = core->getCurrentStelProjectorParams();
+	params.devicePixelsPerPixel = screenDevicePixelsPerPixel;
+	core->setCurrentStelProjectorParams(params);
+}
+
+void StelViewportScaler::paintViewportBuffer(const QOpenGLFramebufferObject* buf) const
+{
+	// The buffer is painted in the pixels of the screen.
+	StelCore* core = StelApp::getInstance().getCore();
+	const StelProjector::StelProjectorParams bufferParams = core->getCurrentStelProjectorParams();
+	StelProjector::StelProjectorParams params = bufferParams;
+	params.devicePixelsPerPixel = screenDevicePixelsPerPixel;
+	core->setCurrentStelProjectorParams(params);
+	const StelProjectorP prj = core->getProjection2d();
+	core->setCurrentStelProjectorParams(bufferParams);
+
+	StelPainter sPainter(prj);
+	QOpenGLFunctions* gl = sPainter.glFuncs();
+	GL(gl->glBindTexture(GL_TEXTURE_2D, buf->texture()));
+	GL(gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GL(gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	sPainter.setBlending(false);
+	sPainter.setColor(1,1,1);
+	sPainter.drawRect2d(0, 0, prj->getViewportWidth(), prj->getViewportHeight());
+}
+
+StelViewportToneMapper::StelViewportToneMapper()
+	: program(Q_NULLPTR)
+	, bayerPatternTex(0)
+	, knee(0.8f)
+{
+	QSettings* conf = StelApp::getInstance().getSettings();
+	knee = qBound(0.f, conf->value("video/hdr_tone_mapping_knee", 0.8).toFloat(), 0.99f);
+
+	QOpenGLShader vshader(QOpenGLShader::Vertex);
+	const char* vsrc =
+		"attribute mediump vec2 vertex;\n"
+		"varying mediump vec2 texc;\n"
+		"void main(void)\n"
+		"{\n"
+		"    gl_Position = vec4(vertex, 0., 1.);\n"
+		"    texc = vertex*0.5 + 0.5;\n"
+		"}\n";
+	vshader.compileSourceCode(vsrc);
+	if (!vshader.log().isEmpty()) { qWarning() << "StelViewportToneMapper: Warnings while compiling vshader: " << vshader.log(); }
+
+	QOpenGLShader fshader(QOpenGLShader::Fragment);
+	const QString fsrc =
+		makeDitheringShader()+
+		"varying mediump vec2 texc;\n"
+		"uniform sampler2D tex;\n"
+		"uniform mediump float knee;\n"
+		"void main(void)\n"
+		"{\n"
+		"    mediump vec3 c = max(texture2D(tex, texc).rgb, vec3(0.));\n"
+		"    mediump float m = max(c.r, max(c.g, c.b));\n"
+		"    if (m > knee)\n"
+		"    {\n"
+		"        // Reinhard curve above the knee, with a slope of 1 at the knee\n"
+		"        mediump float x = (m - knee)/(1. - knee);\n"
+		"        c *= (knee + (1. - knee)*x/(1. + x))/m;\n"
+		"    }\n"
+		"    gl_FragColor = dither(vec4(c, 1.));\n"
+		"}\n";
+	fshader.compileSourceCode(fsrc);
+	if (!fshader.log().isEmpty()) { qWarning() << "StelViewportToneMapper: Warnings while compiling fshader: " << fshader.log(); }
+
+	program = new QOpenGLShaderProgram();
+	program->addShader(&vshader);
+	program->addShader(&fshader);
+	if (!StelPainter::linkProg(program, "toneMapperShader"))
+	{
+		delete program;
+		program = Q_NULLPTR;
+	}
+	bayerPatternTex = makeBayerPatternTexture(*QOpenGLContext::currentContext()->functions());
+}
+
+StelViewportToneMapper::~StelViewportToneMapper()
+{
+	delete program;
+	QOpenGLContext::currentContext()->functions()->glDeleteTextures(1, &bayerPatternTex);
+}
+
+bool StelViewportToneMapper::isSupported()
+{
+	QOpenGLContext* ctx = QOpenGLContext::currentContext();
+	return ctx->format().majorVersion()>=3 && (!ctx->isOpenGLES()
+		|| ctx->hasExtension("GL_EXT_color_buffer_half_float") || ctx->hasExtension("GL_EXT_color_buffer_float"));
+}
+
+void StelViewportToneMapper::paintViewportBuffer(const QOpenGLFramebufferObject* buf) const
+{
+	if (!program)
+	{
+		// Highlights are clipped by the screen
+		StelViewportEffect::paintViewportBuffer(buf);
+		return;
+	}
+	StelPainter sPainter(StelApp::getInstance().getCore()->getProjection2d());
+	QOpenGLFunctions* gl = sPainter.glFuncs();
+	sPainter.setBlending(false);
+	const Vec3f rgbMaxValue = calcRGBMaxValue(sPainter.getDitheringMode());
+
+	static const GLfloat vertices[] = {-1.f, -1.f, 1.f, -1.f, -1.f, 1.f, 1.f, 1.f};
+	program->bind();
+	GL(gl->glActiveTexture(GL_TEXTURE1));
+	GL(gl->glBindTexture(GL_TEXTURE_2D, bayerPatternTex));
+	GL(gl->glActiveTexture(GL_TEXTURE0));
+	GL(gl->glBindTexture(GL_TEXTURE_2D, buf->texture()));
+	program->setUniformValue("tex", 0);
+	program->setUniformValue("bayerPattern", 1);
+	program->setUniformValue("rgbMaxValue", rgbMaxValue[0], rgbMaxValue[1], rgbMaxValue[2]);
+	program->setUniformValue("knee", knee);
+	const int vertexLoc = program->attributeLocation("vertex");
+	program->setAttributeArray(vertexLoc, vertices, 2);
+	program->enableAttributeArray(vertexLoc);
+	GL(gl->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
+	program->disableAttributeArray(vertexLoc);
+	program->release();
+}
+
+bool StelWarpMesh::load(const QString& fileName)
+{
+	positions.clear();
+	texCoords.clear();
+	intensities.clear();
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		qWarning() << "ERROR: the warp mesh" << QDir::toNativeSeparators(fileName) << "can't be read";
+		return false;
+	}
+	QTextStream in(&file);
+	int type = 0, nx = 0, ny = 0;
+	in >> type >> nx >> ny;
+	if (in.status()!=QTextStream::Ok || type!=2 || nx<2 || ny<2)
+	{
+		qWarning() << "ERROR:" << QDir::toNativeSeparators(fileName) << "is not a rectangular warp mesh";
+		return false;
+	}
+
+	// One node per line: x, y, u, v and the intensity
+	QVector<Vec2f> nodePositions(nx*ny);
+	QVector<Vec2f> nodeTexCoords(nx*ny);
+	QVector<float> nodeIntensities(nx*ny);
+	for (int i = 0; i < nx*ny; ++i)
+		in >> nodePositions[i][0] >> nodePositions[i][1] >> nodeTexCoords[i][0] >> nodeTexCoords[i][1] >> nodeIntensities[i];
+	if (in.status()!=QTextStream::Ok)
+	{
+		qWarning() << "ERROR: the warp mesh" << QDir::toNativeSeparators(fileName) << "is truncated";
+		return false;
+	}
+
+	for (int y = 0; y < ny-1; ++y)
+	{
+		for (int x = 0; x < nx-1; ++x)
+		{
+			const int corners[4] = {y*nx+x, y*nx+x+1, (y+1)*nx+x+1, (y+1)*nx+x};
+			if (nodeIntensities[corners[0]]<0.f || nodeIntensities[corners[1]]<0.f || nodeIntensities[corners[2]]<0.f || nodeIntensities[corners[3]]<0.f)
+				continue;
+			for (int c : {0, 1, 2, 0, 2, 3})
+			{
+				positions.append(nodePositions[corners[c]]);
+				texCoords.append(nodeTexCoords[corners[c]]);
+				intensities.append(nodeIntensities[corners[c]]);
+			}
+		}
+	}
+	qDebug() << "Loaded the warp mesh" << QDir::toNativeSeparators(fileName) << "of" << nx << "x" << ny << "nodes";
+	return true;
+}
+
+StelViewportWarpBlender::StelViewportWarpBlender()
+	: program(Q_NULLPTR)
+	, warpMap(0)
+	, warpMapFlipped(false)
+	, warpMapIntensity(false)
+	, blendExponent(1.f)
+	, bayerPatternTex(0)
+{
+	QSettings* conf = StelApp::getInstance().getSettings();
+	const QString warpFile = conf->value("video/warp_map").toString();
+	const QString blendFile = conf->value("video/blend_mask").toString();
+	blendExponent = 1.f/qBound(0.1f, conf->value("video/blend_gamma", 1.f).toFloat(), 10.f);
+
+	if (!warpFile.isEmpty())
+	{
+		const QString path = StelFileMgr::findFile(warpFile);
+		if (path.isEmpty())
+			qWarning() << "ERROR: the warp map" << QDir::toNativeSeparators(warpFile) << "is not found";
+		else if (path.endsWith(".pfm", Qt::CaseInsensitive))
+			loadWarpMap(path);
+		else
+		{
+			StelWarpMesh mesh;
+			if (mesh.load(path))
+				rasterizeWarpMesh(mesh);
+		}
+	}
+	if (!blendFile.isEmpty())
+	{
+		const QString path = StelFileMgr::findFile(blendFile);
+		if (path.isEmpty())
+			qWarning() << "ERROR: the blend mask" << QDir::toNativeSeparators(blendFile) << "is not found";
+		else
+		{
+			blendMask = StelApp::getInstance().getTextureManager().createTexture(path);
+			if (blendMask.isNull())
+				qWarning() << "ERROR: the blend mask" << QDir::toNativeSeparators(path) << "can't be loaded";
+		}
+	}
+
+	QOpenGLShader vshader(QOpenGLShader::Vertex);
+	const char* vsrc =
+		"attribute mediump vec2 vertex;\n"
+		"varying mediump vec2 texc;\n"
+		"void main(void)\n"
+		"{\n"
+		"    gl_Position = vec4(vertex, 0., 1.);\n"
+		"    texc = vertex*0.5 + 0.5;\n"
+		"}\n";
+	vshader.compileSourceCode(vsrc);
+	if (!vshader.log().isEmpty()) { qWarning() << "StelViewportWarpBlender: Warnings while compiling vshader: " << vshader.log(); }
+
+	QOpenGLShader fshader(QOpenGLShader::Fragment);
+	const QString fsrc =
+		makeDitheringShader()+
+		"varying mediump vec2 texc;\n"
+		"uniform sampler2D tex;\n"
+		"uniform sampler2D warpMap;\n"
+		"uniform sampler2D blendMask;\n"
+		"uniform bool hasWarpMap;\n"
+		"uniform bool warpMapFlipped;\n"
+		"uniform bool warpMapIntensity;\n"
+		"uniform bool hasBlendMask;\n"
+		"uniform mediump float blendExponent;\n"
+		"void main(void)\n"
+		"{\n"
+		"    highp vec2 uv = texc;\n"
+		"    mediump float intensity = 1.;\n"
+		"    if (hasWarpMap)\n"
+		"    {\n"
+		"        highp vec3 w = texture2D(warpMap, texc).xyz;\n"
+		"        uv = warpMapFlipped ? vec2(w.x, 1. - w.y) : w.xy;\n"
+		"        if (warpMapIntensity)\n"
+		"            intensity = w.z;\n"
+		"    }\n"
+		"    // Written so that NaN is outside as well\n"
+		"    if (!(uv.x >= 0. && uv.x <= 1. && uv.y >= 0. && uv.y <= 1.))\n"
+		"    {\n"
+		"        gl_FragColor = vec4(0., 0., 0., 1.);\n"
+		"        return;\n"
+		"    }\n"
+		"    mediump vec3 c = texture2D(tex, uv).rgb*intensity;\n"
+		"    if (hasBlendMask)\n"
+		"        c *= pow(texture2D(blendMask, texc).rgb, vec3(blendExponent));\n"
+		"    gl_FragColor = dither(vec4(c, 1.));\n"
+		"}\n";
+	fshader.compileSourceCode(fsrc);
+	if (!fshader.log().isEmpty()) { qWarning() << "StelViewportWarpBlender: Warnings while compiling fshader: " << fshader.log(); }
+
+	program = new QOpenGLShaderProgram();
+	program->addShader(&vshader);
+	program->addShader(&fshader);
+	if (!StelPainter::linkProg(program, "warpBlendShader"))
+	{
+		delete program;
+		program = Q_NULLPTR;
+	}
+	bayerPatternTex = makeBayerPatternTexture(*QOpenGLContext::currentContext()->functions());
+}
+
+StelViewportWarpBlender::~StelViewportWarpBlender()
+{
+	delete program;
+	QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+	gl->glDeleteTextures(1, &bayerPatternTex);
+	if (warpMap)
+		gl->glDeleteTextures(1, &warpMap);
+}
+
+bool StelViewportWarpBlender::isSupported()
+{
+	QOpenGLContext* ctx = QOpenGLContext::currentContext();
+	return ctx->format().majorVersion()>=3 && (!ctx->isOpenGLES() || ctx->hasExtension("GL_EXT_color_buffer_float"));
+}
+
+//! Set the filter of a float texture: linear where it is supported
+static void setFloatTextureFilter(QOpenGLFunctions* gl)
+{
+	QOpenGLContext* ctx = QOpenGLContext::currentContext();
+	const GLint filter = (!ctx->isOpenGLES() || ctx->hasExtension("GL_OES_texture_float_linear")) ? GL_LINEAR : GL_NEAREST;
+	GL(gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter));
+	GL(gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter));
+	GL(gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GL(gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+}
+
+bool StelViewportWarpBlender::loadWarpMap(const QString& fileName)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		qWarning() << "ERROR: the warp map" << QDir::toNativeSeparators(fileName) << "can't be read";
+		return false;
+	}
+	// The header has the type ("PF" for RGB, "Pf" for grey), the size, and a scale whose sign gives the byte order
+	const QByteArray type = file.readLine().trimmed();
+	const QList<QByteArray> size = file.readLine().simplified().split(' ');
+	const float scale = file.readLine().trimmed().toFloat();
+	const int channels = type=="PF" ? 3 : 1;
+	const int width = size.size()==2 ? size.at(0).toInt() : 0;
+	const int height = size.size()==2 ? size.at(1).toInt() : 0;
+	if ((type!="PF" && type!="Pf") || width<=0 || height<=0 || scale==0.f)
+	{
+		qWarning() << "ERROR:" << QDir::toNativeSeparators(fileName) << "is not a PFM file";
+		return false;
+	}
+	const QByteArray data = file.read(static_cast<qint64>(width)*height*channels*4);
+	if (data.size() != width*height*channels*4)
+	{
+		qWarning() << "ERROR: the warp map" << QDir::toNativeSeparators(fileName) << "is truncated";
+		return false;
+	}
+
+	// The rows are stored from the bottom like the textures
+	QVector<float> rgb(width*height*3);
+	const uchar* src = reinterpret_cast<const uchar*>(data.constData());
+	for (int i = 0; i < width*height; ++i)
+	{
+		for (int c = 0; c < 3; ++c)
+		{
+			const uchar* p = src + (i*channels + (channels==3 ? c : 0))*4;
+			const quint32 bits = scale < 0.f ? qFromLittleEndian<quint32>(p) : qFromBigEndian<quint32>(p);
+			memcpy(&rgb[i*3+c], &bits, 4);
+		}
+	}
+
+	QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+	GL(gl->glGenTextures(1, &warpMap));
+	GL(gl->glBindTexture(GL_TEXTURE_2D, warpMap));
+	setFloatTextureFilter(gl);
+	GL(gl->glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+	GL(gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, width, height, 0, GL_RGB, GL_FLOAT, rgb.constData()));
+	GL(gl->glBindTexture(GL_TEXTURE_2D, 0));
+	warpMapFlipped = true;
+	warpMapIntensity = false;
+	qDebug() << "Loaded the warp map" << QDir::toNativeSeparators(fileName) << "of" << width << "x" << height << "pixels";
+	return true;
+}
+
+bool StelViewportWarpBlender::rasterizeWarpMesh(const StelWarpMesh& mesh)
+{
+	if (mesh.isEmpty())
+		return false;
+	const StelProjector::StelProjectorParams params = StelApp::getInstance().getCore()->getCurrentStelProjectorParams();
+	const int width = qRound(params.viewportXywh[2]*params.devicePixelsPerPixel);
+	const int height = qRound(params.viewportXywh[3]*params.devicePixelsPerPixel);
+	const float aspect = static_cast<float>(width)/height;
+
+	QOpenGLShaderProgram meshProgram;
+	meshProgram.addShaderFromSourceCode(QOpenGLShader::Vertex,
+		"attribute highp vec2 vertex;\n"
+		"attribute highp vec3 uvi;\n"
+		"uniform highp float aspect;\n"
+		"varying highp vec3 v;\n"
+		"void main(void)\n"
+		"{\n"
+		"    gl_Position = vec4(vertex.x/aspect, vertex.y, 0., 1.);\n"
+		"    v = uvi;\n"
+		"}\n");
+	meshProgram.addShaderFromSourceCode(QOpenGLShader::Fragment,
+		"varying highp vec3 v;\n"
+		"void main(void)\n"
+		"{\n"
+		"    gl_FragColor = vec4(v, 1.);\n"
+		"}\n");
+	if (!StelPainter::linkProg(&meshProgram, "warpMeshShader"))
+		return false;
+
+	QVector<Vec3f> uvi(mesh.positions.size());
+	for (int i = 0; i < uvi.size(); ++i)
+		uvi[i].set(mesh.texCoords[i][0], mesh.texCoords[i][1], mesh.intensities[i]);
+
+	QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+	GLint drawFbo;
+	GL(gl->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &drawFbo));
+	QOpenGLFramebufferObject fbo(width, height, QOpenGLFramebufferObject::NoAttachment, GL_TEXTURE_2D, GL_RGBA32F);
+	fbo.bind();
+	GL(gl->glViewport(0, 0, width, height));
+	GL(gl->glDisable(GL_BLEND));
+	// Outside of the mesh, nothing is drawn
+	GL(gl->glClearColor(-1.f, -1.f, 0.f, 0.f));
+	GL(gl->glClear(GL_COLOR_BUFFER_BIT));
+	meshProgram.bind();
+	meshProgram.setUniformValue("aspect", aspect);
+	const int vertexLoc = meshProgram.attributeLocation("vertex");
+	const int uviLoc = meshProgram.attributeLocation("uvi");
+	meshProgram.setAttributeArray(vertexLoc, reinterpret_cast<const GLfloat*>(mesh.positions.constData()), 2);
+	meshProgram.setAttributeArray(uviLoc, reinterpret_cast<const GLfloat*>(uvi.constData()), 3);
+	meshProgram.enableAttributeArray(vertexLoc);
+	meshProgram.enableAttributeArray(uviLoc);
+	GL(gl->glDrawArrays(GL_TRIANGLES, 0, mesh.positions.size()));
+	meshProgram.disableAttributeArray(vertexLoc);
+	meshProgram.disableAttributeArray(uviLoc);
+	meshProgram.release();
+	warpMap = fbo.takeTexture();
+	GL(gl->glBindFramebuffer(GL_FRAMEBUFFER, drawFbo));
+
+	GL(gl->glBindTexture(GL_TEXTURE_2D, warpMap));
+	setFloatTextureFilter(gl);
+	GL(gl->glBindTexture(GL_TEXTURE_2D, 0));
+	warpMapFlipped = false;
+	warpMapIntensity = true;
+	return true;
+}
+
+void StelViewportWarpBlender::paintViewportBuffer(const QOpenGLFramebufferObject* buf) const
+{
+	if (!program)
+	{
+		StelViewportEffect::paintViewportBuffer(buf);
+		return;
+	}
+	StelPainter sPainter(StelApp::getInstance().getCore()->getProjection2d());
+	QOpenGLFunctions* gl = sPainter.glFuncs();
+	sPainter.setBlending(false);
+	const Vec3f rgbMaxValue = calcRGBMaxValue(sPainter.getDitheringMode());
+	const bool hasBlendMask = blendMask && blendMask->bind(3);
+
+	static const GLfloat vertices[] = {-1.f, -1.f, 1.f, -1.f, -1.f, 1.f, 1.f, 1.f};
+	program->bind();
+	GL(gl->glActiveTexture(GL_TEXTURE2));
+	GL(gl->glBindTexture(GL_TEXTURE_2D, warpMap));
+	GL(gl->glActiveTexture(GL_TEXTURE1));
+	GL(gl->glBindTexture(GL_TEXTURE_2D, bayerPatternTex));
+	GL(gl->glActiveTexture(GL_TEXTURE0));
+	GL(gl->glBindTexture(GL_TEXTURE_2D, buf->texture()));
+	GL(gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GL(gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	program->setUniformValue("tex", 0);
+	program->setUniformValue("bayerPattern", 1);
+	program->setUniformValue("warpMap", 2);
+	program->setUniformValue("blendMask", 3);
+	program->setUniformValue("hasWarpMap", warpMap!=0);
+	program->setUniformValue("warpMapFlipped", warpMapFlipped);
+	program->setUniformValue("warpMapIntensity", warpMapIntensity);
+	program->setUniformValue("hasBlendMask", hasBlendMask);
+	program->setUniformValue("blendExponent", blendExponent);
+	program->setUniformValue("rgbMaxValue", rgbMaxValue[0], rgbMaxValue[1], rgbMaxValue[2]);
+	const int vertexLoc = program->attributeLocation("vertex");
+	program->setAttributeArray(vertexLoc, vertices, 2);
+	program->enableAttributeArray(vertexLoc);
+	GL(gl->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
+	program->disableAttributeArray(vertexLoc);
+	program->release();
+	GL(gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+	GL(gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+}
+
 struct VertexPoint
 {
 	Vec2f ver_xy;
@@ -22,8 +22,12 @@
 
 #include "VecMath.hpp"
 #include "StelProjector.hpp"
+#include "StelTextureTypes.hpp"
+
+#include <QVector>
 
 class QOpenGLFramebufferObject;
+class QOpenGLShaderProgram;
 
 //! @class StelViewportEffect
 //! Allow to apply visual effects on the whole Stellarium viewport.
@@ -43,8 +47,102 @@ public:
 	//! Distort an x,y position according to the distortion.
 	//! The default implementation does nothing.
 	virtual void distortXY(float& x, float& y) const {Q_UNUSED(x); Q_UNUSED(y);}
+	//! Get whether the viewport must be drawn into a floating point buffer.
+	//! The default implementation returns false.
+	virtual bool needsFloatBuffer() const {return false;}
+};
+
+//! @class StelViewportScaler
+//! Render the viewport to a buffer with a lower resolution, and upsample it to the screen.
+//! This is used by StelApp::setRenderScale() to trade sharpness for speed.
+class StelViewportScaler : public StelViewportEffect
+{
+public:
+	//! @param scale the ratio between the resolution of the buffer and of the screen, in ]0, 1].
+	StelViewportScaler(float scale);
+	~StelViewportScaler();
+	virtual QString getName() const {return "renderScale";}
+	virtual void paintViewportBuffer(const QOpenGLFramebufferObject* buf) const;
+	virtual void distortXY(float& x, float& y) const {x*=scale; y*=scale;}
+private:
+	const float scale;
+	const float screenDevicePixelsPerPixel;
+};
+
+//! @class StelViewportToneMapper
+//! Render the viewport to a half float buffer, and compress its highlights in a single fullscreen pass.
+//! Additive blending of bright objects (the Sun in the atmosphere, overlapping halos...) can exceed the
+//! display range: instead of clipping each channel, the brightest channel of the color is compressed
+//! with a Reinhard curve above a knee, which keeps the hue. The result is dithered to the depth of the screen.
+//! This is used by the 'hdrToneMapping' viewport effect.
+class StelViewportToneMapper : public StelViewportEffect
+{
+public:
+	StelViewportToneMapper();
+	~StelViewportToneMapper();
+	virtual QString getName() const {return "hdrToneMapping";}
+	virtual void paintViewportBuffer(const QOpenGLFramebufferObject* buf) const;
+	virtual bool needsFloatBuffer() const {return true;}
+	//! Get whether the current OpenGL context can render into half float buffers.
+	static bool isSupported();
+private:
+	QOpenGLShaderProgram* program;
+	GLuint bayerPatternTex;
+	float knee;
+};
+
+//! @class StelWarpMesh
+//! A warp mesh in the format of Paul Bourke (type 2, see http://paulbourke.net/dome/warpingfisheye/), as triangles.
+//! The positions are x in [-aspect, aspect] and y in [-1, 1] with the bottom at -1, the texture coordinates are in [0, 1]
+//! with the bottom of the image at 0. The cells which have a node of negative intensity are not drawn.
+class StelWarpMesh
+{
+public:
+	bool load(const QString& fileName);
+	bool isEmpty() const {return positions.isEmpty();}
+
+	QVector<Vec2f> positions;
+	QVector<Vec2f> texCoords;
+	QVector<float> intensities;
 };
 
+//! @class StelViewportWarpBlender
+//! Warp the viewport and blend its edges with projector calibration data, in one fullscreen pass.
+//! This is used by the 'warpBlend' viewport effect. The calibration files are set in the configuration file:
+//! - video/warp_map: either a geometry warp map in the PFM format of MPCDI, whose first two channels are, for each
+//!   pixel of the screen, the position in the sky image in [0, 1] with the top at 0, or NaN where nothing is drawn;
+//!   or a warp mesh of Paul Bourke (see StelWarpMesh), which is rasterized into such a map once.
+//! - video/blend_mask: an image by which the warped viewport is multiplied, e.g. the blend of the overlap of
+//!   two projectors (the alpha map of MPCDI)
+//! - video/blend_gamma: the gamma of the projector, when the blend mask is linear in light (default 1, the mask is used as it is)
+//! The warp map is a float texture, filtered linearly where supported, so that a low resolution map is interpolated
+//! smoothly. The viewport is sampled linearly, and dithered like the tone mapper to hide the bands of the blend.
+//! The positions of the mouse are not warped back.
+class StelViewportWarpBlender : public StelViewportEffect
+{
+public:
+	StelViewportWarpBlender();
+	~StelViewportWarpBlender();
+	virtual QString getName() const {return "warpBlend";}
+	virtual void paintViewportBuffer(const QOpenGLFramebufferObject* buf) const;
+	//! Get whether the current OpenGL context has float textures and render targets.
+	static bool isSupported();
+private:
+	//! Read a PFM warp map into warpMap.
+	bool loadWarpMap(const QString& fileName);
+	//! Draw a warp mesh into warpMap, at the size of the viewport.
+	bool rasterizeWarpMesh(const StelWarpMesh& mesh);
+
+	QOpenGLShaderProgram* program;
+	GLuint warpMap;
+	//! The positions of the PFM maps have the top at 0, the ones of the meshes the bottom
+	bool warpMapFlipped;
+	//! Whether the third channel of warpMap is an intensity, as for the meshes
+	bool warpMapIntensity;
+	StelTextureSP blendMask;
+	float blendExponent;
+	GLuint bayerPatternTex;
+};
 
 class StelViewportDistorterFisheyeToSphericMirror : public StelViewportEffect
 {
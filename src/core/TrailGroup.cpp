@@ -21,62 +21,266 @@
 
 #include "StelApp.hpp"
 #include "StelPainter.hpp"
+#include "StelProjector.hpp"
+#include "StelTextureMgr.hpp"
 #include "StelObject.hpp"
 #include "Planet.hpp"
 
-TrailGroup::TrailGroup(float te) : timeExtent(te), opacity(1.f)
+#include <QDebug>
+#include <QMatrix4x4>
+#include <QOpenGLShaderProgram>
+
+#include <cmath>
+
+TrailGroup::TrailGroup(float te, int maxPoints)
+	: timeExtent(te)
+	, capacity(qMax(2, maxPoints))
+	, times(capacity)
+	, epoch(0.)
+	, first(0)
+	, count(0)
+	, nextSequence(0)
+	, firstDirtySequence(0)
+	, opacity(1.f)
+	, positionBuffer(QOpenGLBuffer::VertexBuffer)
+	, timeBuffer(QOpenGLBuffer::VertexBuffer)
+	, bufferTrails(0)
 {
 	j2000ToTrailNative=Mat4d::identity();
 	j2000ToTrailNativeInverted=Mat4d::identity();
 }
 
+TrailGroup::~TrailGroup()
+{
+	if (positionBuffer.isCreated())
+	{
+		positionBuffer.destroy();
+		timeBuffer.destroy();
+		StelApp::getInstance().getTextureManager().unregisterGLBuffer(this);
+	}
+	qDeleteAll(programs);
+}
+
 static QVector<Vec3d> vertexArray;
 static QVector<Vec4f> colorArray;
 void TrailGroup::draw(StelCore* core, StelPainter* sPainter)
 {
+	if (count<2)
+		return;
 	sPainter->setBlending(true);
-	float currentTime = core->getJDE();
+	const float currentTime = static_cast<float>(core->getJDE()-epoch);
 	StelProjector::ModelViewTranformP transfo = core->getJ2000ModelViewTransform();
 	transfo->combine(j2000ToTrailNativeInverted);
-	sPainter->setProjector(core->getProjection(transfo));
+	const StelProjectorP prj = core->getProjection(transfo);
+	sPainter->setProjector(prj);
+	if (drawBuffers(sPainter, prj, currentTime))
+		return;
+
+	const QString homePlanetName = core->getCurrentLocation().planetName;
+	vertexArray.resize(count);
+	colorArray.resize(count);
 	for (const auto& trail : allTrails)
 	{
 		Planet* hpl = dynamic_cast<Planet*>(trail.stelObject.data());
-		if (hpl!=Q_NULLPTR)
-		{
-			// Avoid drawing the trails if the object is the home planet
-			QString homePlanetName = hpl->getEnglishName();
-			if (homePlanetName==StelApp::getInstance().getCore()->getCurrentLocation().planetName)
-				continue;
-		}
-		const QList<Vec3d>& posHistory = trail.posHistory;
-		vertexArray.resize(posHistory.size());
-		colorArray.resize(posHistory.size());
-		for (int i=0;i<posHistory.size();++i)
+		// Avoid drawing the trails if the object is the home planet
+		if (hpl!=Q_NULLPTR && hpl->getEnglishName()==homePlanetName)
+			continue;
+		for (int i=0;i<count;++i)
 		{
-			float colorRatio = 1.f-(currentTime-times.at(i))/timeExtent;
+			const int r = ringIndex(i);
+			const float colorRatio = 1.f-std::fabs(currentTime-times.at(r))/timeExtent;
 			colorArray[i].set(trail.color[0], trail.color[1], trail.color[2], colorRatio*opacity);
-			vertexArray[i]=posHistory.at(i);
+			const Vec3f& pos = trail.positions.at(r);
+			vertexArray[i].set(pos[0], pos[1], pos[2]);
 		}
 		sPainter->drawPath(vertexArray, colorArray);
 	}
 }
 
-// Add 1 point to all the curves at current time and suppress too old points
+QOpenGLShaderProgram* TrailGroup::getProgram(const QByteArray& projectorShader)
+{
+	QOpenGLShaderProgram* program = programs.value(projectorShader, Q_NULLPTR);
+	if (program)
+		return program;
+
+	QOpenGLShader vshader(QOpenGLShader::Vertex);
+	const QByteArray vsrc =
+		"attribute highp vec3 vertex;\n"
+		"attribute highp float time;\n"
+		"uniform mediump mat4 projectionMatrix;\n"
+		"uniform highp float currentTime;\n"
+		"uniform highp float timeExtent;\n"
+		"uniform mediump vec4 color;\n"
+		"varying mediump vec4 outColor;\n"
+		+ projectorShader +
+		"void main(void)\n"
+		"{\n"
+		"    vec4 win = projectToViewport(vertex);\n"
+		"    gl_Position = projectionMatrix * vec4(win.xyz, 1.);\n"
+		"    outColor = vec4(color.rgb, color.a*(1. - abs(currentTime - time)/timeExtent)*win.w);\n"
+		"}\n";
+	vshader.compileSourceCode(vsrc);
+	if (!vshader.log().isEmpty()) { qWarning() << "TrailGroup::getProgram(): Warnings while compiling vshader: " << vshader.log(); }
+
+	QOpenGLShader fshader(QOpenGLShader::Fragment);
+	const char* fsrc =
+		"varying mediump vec4 outColor;\n"
+		"void main(void)\n"
+		"{\n"
+		"    gl_FragColor = outColor;\n"
+		"}\n";
+	fshader.compileSourceCode(fsrc);
+	if (!fshader.log().isEmpty()) { qWarning() << "TrailGroup::getProgram(): Warnings while compiling fshader: " << fshader.log(); }
+
+	program = new QOpenGLShaderProgram();
+	program->addShader(&vshader);
+	program->addShader(&fshader);
+	if (!StelPainter::linkProg(program, "trailShader"))
+	{
+		// Do not try again, StelPainter will draw the trails
+		qWarning() << "TrailGroup: cannot link shader, trail buffers disabled";
+		bufferTrails = -1;
+		delete program;
+		return Q_NULLPTR;
+	}
+	programs.insert(projectorShader, program);
+	return program;
+}
+
+void TrailGroup::uploadPoints()
+{
+	if (bufferTrails!=allTrails.size())
+	{
+		if (!positionBuffer.isCreated())
+		{
+			positionBuffer.create();
+			positionBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+			timeBuffer.create();
+			timeBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+			timeBuffer.bind();
+			timeBuffer.allocate(2*capacity*sizeof(float));
+			timeBuffer.release();
+		}
+		positionBuffer.bind();
+		positionBuffer.allocate(allTrails.size()*2*capacity*sizeof(Vec3f));
+		positionBuffer.release();
+		StelApp::getInstance().getTextureManager().registerGLBuffer(this, "TrailGroup", (allTrails.size()*3+1)*2*capacity*sizeof(float));
+		bufferTrails = allTrails.size();
+		firstDirtySequence = 0;
+	}
+
+	// The changed points are at most two runs of ring indices, each stored twice
+	const quint64 oldestSequence = nextSequence-count;
+	const int firstDirty = static_cast<int>(qMax(firstDirtySequence, oldestSequence)-oldestSequence);
+	const int start = ringIndex(firstDirty);
+	const int dirtyCount = count-firstDirty;
+	const int runs[2][2] = {{start, qMin(dirtyCount, capacity-start)}, {0, dirtyCount-qMin(dirtyCount, capacity-start)}};
+	for (const auto& run : runs)
+	{
+		if (run[1]<=0)
+			continue;
+		timeBuffer.bind();
+		for (int copy : {0, capacity})
+			timeBuffer.write((run[0]+copy)*sizeof(float), times.constData()+run[0], run[1]*sizeof(float));
+		timeBuffer.release();
+		positionBuffer.bind();
+		for (int k=0;k<allTrails.size();++k)
+		{
+			for (int copy : {0, capacity})
+				positionBuffer.write((k*2*capacity+run[0]+copy)*sizeof(Vec3f), allTrails.at(k).positions.constData()+run[0], run[1]*sizeof(Vec3f));
+		}
+		positionBuffer.release();
+	}
+	firstDirtySequence = nextSequence;
+}
+
+bool TrailGroup::drawBuffers(StelPainter* sPainter, const StelProjectorP& prj, float currentTime)
+{
+	// Segments crossing a discontinuity must be removed on the CPU
+	if (bufferTrails<0 || StelApp::getInstance().isHeadless() || prj->hasDiscontinuity())
+		return false;
+	const QByteArray projectorShader = prj->getForwardTransformShader();
+	if (projectorShader.isEmpty())
+		return false;
+	QOpenGLShaderProgram* program = getProgram(projectorShader);
+	if (!program)
+		return false;
+	uploadPoints();
+
+	const Mat4f& m = prj->getProjectionMatrix();
+	const QMatrix4x4 qMat(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
+	program->bind();
+	program->setUniformValue("projectionMatrix", qMat);
+	program->setUniformValue("currentTime", currentTime);
+	program->setUniformValue("timeExtent", timeExtent);
+	prj->setForwardTransformUniforms(*program);
+
+	const int vertexLoc = program->attributeLocation("vertex");
+	const int timeLoc = program->attributeLocation("time");
+	timeBuffer.bind();
+	program->setAttributeBuffer(timeLoc, GL_FLOAT, first*sizeof(float), 1);
+	program->enableAttributeArray(timeLoc);
+	positionBuffer.bind();
+	program->enableAttributeArray(vertexLoc);
+	const QString homePlanetName = StelApp::getInstance().getCore()->getCurrentLocation().planetName;
+	for (int k=0;k<allTrails.size();++k)
+	{
+		const Trail& trail = allTrails.at(k);
+		Planet* hpl = dynamic_cast<Planet*>(trail.stelObject.data());
+		// Avoid drawing the trails if the object is the home planet
+		if (hpl!=Q_NULLPTR && hpl->getEnglishName()==homePlanetName)
+			continue;
+		program->setUniformValue("color", trail.color[0], trail.color[1], trail.color[2], opacity);
+		program->setAttributeBuffer(vertexLoc, GL_FLOAT, (k*2*capacity+first)*sizeof(Vec3f), 3);
+		sPainter->glFuncs()->glDrawArrays(GL_LINE_STRIP, 0, count);
+	}
+	program->disableAttributeArray(vertexLoc);
+	program->disableAttributeArray(timeLoc);
+	positionBuffer.release();
+	program->release();
+	return true;
+}
+
+// Add 1 point to all the curves at current time, or move the newest one, and suppress too old points
 void TrailGroup::update()
 {
-	times.append(StelApp::getInstance().getCore()->getJDE());
-	for (auto& trail : allTrails)
+	StelCore* core = StelApp::getInstance().getCore();
+	const double jde = core->getJDE();
+	// The trails restart after a jump of the time
+	if (count>0 && std::fabs(jde-epoch-times.at(ringIndex(count-1)))>timeExtent)
+		reset();
+	if (count==0)
+		epoch = jde;
+	const float t = static_cast<float>(jde-epoch);
+
+	// Time may run backwards, the age of a point is its distance in time
+	while (count>0 && std::fabs(t-times.at(ringIndex(0)))>timeExtent)
 	{
-		trail.posHistory.append(j2000ToTrailNative * trail.stelObject->getJ2000EquatorialPos(StelApp::getInstance().getCore()));
+		first = (first+1)%capacity;
+		--count;
 	}
-	if (StelApp::getInstance().getCore()->getJDE()-times.at(0)>timeExtent)
+
+	// The newest point follows the objects until it is far enough from the previous one
+	const float minSpacing = timeExtent/(capacity-1);
+	if (count<2 || std::fabs(t-times.at(ringIndex(count-2)))>=minSpacing)
 	{
-		times.pop_front();
-		for (auto& trail : allTrails)
+		if (count==capacity)
 		{
-			trail.posHistory.pop_front();
+			first = (first+1)%capacity;
+			--count;
 		}
+		++count;
+		++nextSequence;
+	}
+	else
+		firstDirtySequence = qMin(firstDirtySequence, nextSequence-1);
+
+	const int r = ringIndex(count-1);
+	times[r] = t;
+	for (auto& trail : allTrails)
+	{
+		const Vec3d pos = j2000ToTrailNative * trail.stelObject->getJ2000EquatorialPos(core);
+		trail.positions[r].set(pos[0], pos[1], pos[2]);
 	}
 }
 
@@ -89,14 +293,13 @@ void TrailGroup::setJ2000ToTrailNative(const Mat4d& m)
 
 void TrailGroup::addObject(const StelObjectP& obj, const Vec3f* col)
 {
-	allTrails.append(TrailGroup::Trail(obj, col==Q_NULLPTR ? obj->getInfoColor() : *col));
+	allTrails.append(TrailGroup::Trail(obj, col==Q_NULLPTR ? obj->getInfoColor() : *col, capacity));
+	reset();
 }
 
 void TrailGroup::reset()
 {
-	times.clear();
-	for (auto& trail : allTrails)
-	{
-		trail.posHistory.clear();
-	}
+	first = 0;
+	count = 0;
+	firstDirtySequence = nextSequence;
 }
@@ -23,17 +23,35 @@
 #include "VecMath.hpp"
 #include "StelCore.hpp"
 #include "StelObjectType.hpp"
+#include "StelProjectorType.hpp"
 
-class StelPainter;
+#include <QByteArray>
+#include <QHash>
+#include <QOpenGLBuffer>
+#include <QVector>
 
+class StelPainter;
+class QOpenGLShaderProgram;
+
+//! @class TrailGroup
+//! The trails of a group of objects over a time extent, like the planets of SolarSystem.
+//! The points of the trails are kept in ring buffers of fixed capacity, in the native frame of the trails.
+//! A point is stored only once the simulation time moved by timeExtent/(maxPoints-1) since the previous one,
+//! the newest point follows the objects until then: the trails cover the same time at any time rate, with
+//! a bounded number of points.
+//! Where the projection can be evaluated on the GPU, the points are kept in OpenGL buffers in which only the
+//! new points are uploaded, and faded by a vertex shader. Otherwise they are drawn with StelPainter.
 class TrailGroup
 {
 public:
-	TrailGroup(float atimeExtent);
+	//! @param atimeExtent the time covered by the trails [days]
+	//! @param maxPoints the capacity of the trails
+	TrailGroup(float atimeExtent, int maxPoints=1000);
+	~TrailGroup();
 
 	void draw(StelCore* core, StelPainter*);
 
-	// Add 1 point to all the curves at current time and suppress too old points
+	// Add 1 point to all the curves at current time, or move the newest one, and suppress too old points
 	void update();
 
 	// Set the matrix to use to post process J2000 positions before storing in the trail
@@ -50,24 +68,50 @@ private:
 	class Trail
 	{
 	public:
-		Trail(const StelObjectP& obj, const Vec3f& col) : stelObject(obj), color(col) {;}
+		Trail(const StelObjectP& obj, const Vec3f& col, int capacity) : stelObject(obj), positions(capacity), color(col) {;}
 		StelObjectP stelObject;
-		// All previous positions
-		QList<Vec3d> posHistory;
+		// The previous positions in the trail native frame, at the ring indices of times
+		QVector<Vec3f> positions;
 		Vec3f color;
 	};
 
+	//! Ring index of the i-th point, from the oldest
+	int ringIndex(int i) const { return (first+i)%capacity; }
+	//! Draw the trails from the OpenGL buffers.
+	//! @return false if the buffers can not be used with this projector
+	bool drawBuffers(StelPainter* sPainter, const StelProjectorP& prj, float currentTime);
+	//! Upload the points changed since the last draw.
+	void uploadPoints();
+	//! Get the shader program for a projector shader, compiling it on first use.
+	QOpenGLShaderProgram* getProgram(const QByteArray& projectorShader);
+
 	QList<Trail> allTrails;
 
 	// Maximum time extent in days
 	float timeExtent;
+	int capacity;
 
-	QList<float> times;
+	//! The times of the points, relative to epoch, in a ring buffer shared by the trails [days]
+	QVector<float> times;
+	double epoch;
+	int first;
+	int count;
+	//! Sequence number of the next point, and of the oldest point changed since the last upload
+	quint64 nextSequence;
+	quint64 firstDirtySequence;
 
 	Mat4d j2000ToTrailNative;
 	Mat4d j2000ToTrailNativeInverted;
 
 	float opacity;
+
+	//! Each point is stored twice in the buffers, at its ring index and capacity after it, so that the
+	//! points of a trail are contiguous from the oldest.
+	QOpenGLBuffer positionBuffer;
+	QOpenGLBuffer timeBuffer;
+	//! The number of trails the buffers were allocated for, -1 if the buffers can not be used
+	int bufferTrails;
+	QHash<QByteArray, QOpenGLShaderProgram*> programs;
 };
 
 #endif // TRAILMGR_HPP
@@ -106,20 +106,22 @@ bool Asterism::read(const QString& record, StarMgr *starMgr)
 
 				istr >> RA >> DE;				
 				StelUtils::spheToRect(RA*M_PI/12., DE*M_PI/180., coords);
-				QList<StelObjectP> stars = starMgr->searchAround(coords, 0.1, core);
-				StelObjectP s = NULL;
+				StarView s;
+				bool found = false;
 				float d = 10.f;
-				for (const auto& p : stars)
+				starMgr->searchAround(coords, 0.1, core, [&](const StarView& star)
 				{
-					float a = coords.angle(p->getJ2000EquatorialPos(core));
+					float a = coords.angle(star.j2000Pos);
 					if (a<d)
 					{
 						d = a;
-						s = p;
+						s = star;
+						found = true;
 					}
-				}
+					return true;
+				});
 
-				asterism[i] = s;
+				asterism[i] = found ? starMgr->createStelObject(s) : StelObjectP();
 
 				if (!asterism[i])
 				{
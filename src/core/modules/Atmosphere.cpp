@@ -25,17 +25,48 @@
 #include "StelCore.hpp"
 #include "StelPainter.hpp"
 #include "StelFileMgr.hpp"
+#include "StelTextureMgr.hpp"
+#include "StelModuleMgr.hpp"
+#include "SolarSystem.hpp"
 #include "Dithering.hpp"
 
+#include <algorithm>
+
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QSettings>
+#include <QOpenGLContext>
 #include <QOpenGLShaderProgram>
+#if QT_VERSION >= 0x050600
+#include <QOpenGLExtraFunctions>
+#endif
+
+// OpenGL 3 / OpenGL ES 3 tokens, which may be missing from OpenGL ES 2 headers
+#ifndef GL_RGBA16F
+#define GL_RGBA16F 0x881A
+#endif
+#ifndef GL_HALF_FLOAT
+#define GL_HALF_FLOAT 0x140B
+#endif
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_MAP_READ_BIT
+#define GL_MAP_READ_BIT 0x0001
+#endif
+
+//! Size of the square buffer in which the luminance of the sky is averaged on the GPU.
+static const int LUMINANCE_BUFFER_SIZE = 128;
 
 
 Atmosphere::Atmosphere(void)
 	: viewport(0,0,0,0)
 	, skyResolutionY(44)
 	, skyResolutionX(44)
+	, resolutionScale(1.f)
 	, posGrid(Q_NULLPTR)
 	, posGridBuffer(QOpenGLBuffer::VertexBuffer)
 	, indicesBuffer(QOpenGLBuffer::IndexBuffer)
@@ -45,8 +76,33 @@ Atmosphere::Atmosphere(void)
 	, overrideAverageLuminance(false)
 	, eclipseFactor(1.f)
 	, lightPollutionLuminance(0)
+	, colorCacheValid(false)
+	, colorCacheAngle(0.)
+	, colorCacheRelative(1e-3f)
+	, colorReuseRatio(0.f)
+	, colorComputeTime(0.f)
+	, flagGpuSky(true)
+	, gpuSkyAvailable(-1)
+	, gpuSkyActive(false)
+	, moonDir(0.f, 0.f, -1.f)
+	, luminanceScale(1.f)
+	, luminanceOffset(0.f)
+	, lightPollutionMapLuminance(0.f)
+	, lightPollutionTex(0)
+	, lightPollutionTexDirty(false)
+	, luminanceTex(0)
+	, luminanceFbo(0)
+	, reductionFbo(0)
+	, luminancePboIndex(0)
 {
 	setFadeDuration(1.5f);
+	QSettings* conf = StelApp::getInstance().getSettings();
+	flagGpuSky = conf->value("landscape/atmosphere_gpu", true).toBool();
+	// Changes smaller than these do not change a pixel of the sky. 0 disables the reuse of the colors.
+	colorCacheAngle = conf->value("landscape/atmosphere_cache_tolerance", 0.5).toDouble()*M_PI/(180.*60.);
+	colorCacheRelative = conf->value("landscape/atmosphere_cache_relative_tolerance", 1e-3).toFloat();
+	luminancePbo[0] = luminancePbo[1] = 0;
+	luminancePending[0] = luminancePending[1] = false;
 
 	QOpenGLShader vShader(QOpenGLShader::Vertex);
 	if (!vShader.compileSourceFile(":/shaders/xyYToRGB.glsl"))
@@ -77,30 +133,36 @@ Atmosphere::Atmosphere(void)
 	atmoShaderProgram->addShader(&fShader);
 	StelPainter::linkProg(atmoShaderProgram, "atmosphere");
 
-	atmoShaderProgram->bind();
-	shaderAttribLocations.bayerPattern = atmoShaderProgram->uniformLocation("bayerPattern");
-	shaderAttribLocations.rgbMaxValue = atmoShaderProgram->uniformLocation("rgbMaxValue");
-	shaderAttribLocations.alphaWaOverAlphaDa = atmoShaderProgram->uniformLocation("alphaWaOverAlphaDa");
-	shaderAttribLocations.oneOverGamma = atmoShaderProgram->uniformLocation("oneOverGamma");
-	shaderAttribLocations.term2TimesOneOverMaxdLpOneOverGamma = atmoShaderProgram->uniformLocation("term2TimesOneOverMaxdLpOneOverGamma");
-	shaderAttribLocations.brightnessScale = atmoShaderProgram->uniformLocation("brightnessScale");
-	shaderAttribLocations.sunPos = atmoShaderProgram->uniformLocation("sunPos");
-	shaderAttribLocations.term_x = atmoShaderProgram->uniformLocation("term_x");
-	shaderAttribLocations.Ax = atmoShaderProgram->uniformLocation("Ax");
-	shaderAttribLocations.Bx = atmoShaderProgram->uniformLocation("Bx");
-	shaderAttribLocations.Cx = atmoShaderProgram->uniformLocation("Cx");
-	shaderAttribLocations.Dx = atmoShaderProgram->uniformLocation("Dx");
-	shaderAttribLocations.Ex = atmoShaderProgram->uniformLocation("Ex");
-	shaderAttribLocations.term_y = atmoShaderProgram->uniformLocation("term_y");
-	shaderAttribLocations.Ay = atmoShaderProgram->uniformLocation("Ay");
-	shaderAttribLocations.By = atmoShaderProgram->uniformLocation("By");
-	shaderAttribLocations.Cy = atmoShaderProgram->uniformLocation("Cy");
-	shaderAttribLocations.Dy = atmoShaderProgram->uniformLocation("Dy");
-	shaderAttribLocations.Ey = atmoShaderProgram->uniformLocation("Ey");
-	shaderAttribLocations.projectionMatrix = atmoShaderProgram->uniformLocation("projectionMatrix");
-	shaderAttribLocations.skyVertex = atmoShaderProgram->attributeLocation("skyVertex");
-	shaderAttribLocations.skyColor = atmoShaderProgram->attributeLocation("skyColor");
-	atmoShaderProgram->release();
+	getLocations(atmoShaderProgram, shaderAttribLocations);
+}
+
+void Atmosphere::getLocations(QOpenGLShaderProgram* program, ShaderLocations& locations)
+{
+	program->bind();
+	locations.bayerPattern = program->uniformLocation("bayerPattern");
+	locations.rgbMaxValue = program->uniformLocation("rgbMaxValue");
+	locations.alphaWaOverAlphaDa = program->uniformLocation("alphaWaOverAlphaDa");
+	locations.oneOverGamma = program->uniformLocation("oneOverGamma");
+	locations.term2TimesOneOverMaxdLpOneOverGamma = program->uniformLocation("term2TimesOneOverMaxdLpOneOverGamma");
+	locations.brightnessScale = program->uniformLocation("brightnessScale");
+	locations.sunPos = program->uniformLocation("sunPos");
+	locations.term_x = program->uniformLocation("term_x");
+	locations.Ax = program->uniformLocation("Ax");
+	locations.Bx = program->uniformLocation("Bx");
+	locations.Cx = program->uniformLocation("Cx");
+	locations.Dx = program->uniformLocation("Dx");
+	locations.Ex = program->uniformLocation("Ex");
+	locations.term_y = program->uniformLocation("term_y");
+	locations.Ay = program->uniformLocation("Ay");
+	locations.By = program->uniformLocation("By");
+	locations.Cy = program->uniformLocation("Cy");
+	locations.Dy = program->uniformLocation("Dy");
+	locations.Ey = program->uniformLocation("Ey");
+	locations.projectionMatrix = program->uniformLocation("projectionMatrix");
+	locations.skyVertex = program->attributeLocation("skyVertex");
+	// -1 in the GPU programs, which compute the color from skyVertex
+	locations.skyColor = program->attributeLocation("skyColor");
+	program->release();
 }
 
 Atmosphere::~Atmosphere(void)
@@ -111,20 +173,56 @@ Atmosphere::~Atmosphere(void)
 	colorGrid = Q_NULLPTR;
 	delete atmoShaderProgram;
 	atmoShaderProgram = Q_NULLPTR;
+	clearGpuSky();
+	StelApp::getInstance().getTextureManager().unregisterGLBuffer(this);
+}
+
+void Atmosphere::setLightPollutionMap(const LightPollutionMapP& map)
+{
+	if (map==lightPollutionMap)
+		return;
+	lightPollutionMap = map;
+	lightPollutionTexDirty = true;
+	colorCacheValid = false;
+}
+
+void Atmosphere::setResolutionScale(float scale)
+{
+	scale = qBound(0.1f, scale, 1.f);
+	if (scale!=resolutionScale)
+	{
+		resolutionScale = scale;
+		// Rebuild the grid in the next computeColor()
+		viewport.set(0, 0, 0, 0);
+	}
 }
 
 void Atmosphere::computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moonPhase, float moonMagnitude,
 							   StelCore* core, float latitude, float altitude, float temperature, float relativeHumidity)
 {
 	const StelProjectorP prj = core->getProjection(StelCore::FrameAltAz, StelCore::RefractionOff);
-	if (viewport != prj->getViewport())
+	const bool useGpu = isGpuSkyUsable(prj);
+	if (viewport != prj->getViewport() || useGpu != gpuSkyActive)
 	{
 		// The viewport changed: update the number of point of the grid
 		viewport = prj->getViewport();
+		gpuSkyActive = useGpu;
+		colorCacheValid = false;
 		delete[] colorGrid;
 		delete [] posGrid;
-		skyResolutionY = StelApp::getInstance().getSettings()->value("landscape/atmosphereybin", 44).toInt();
+		// The GPU evaluates the vertices for free, so it can afford a much finer grid.
+		if (useGpu)
+			skyResolutionY = StelApp::getInstance().getSettings()->value("landscape/atmosphereybin_gpu", 128).toInt();
+		else
+			skyResolutionY = StelApp::getInstance().getSettings()->value("landscape/atmosphereybin", 44).toInt();
+		skyResolutionY = qMax(qMin(skyResolutionY, 8), qRound(skyResolutionY*resolutionScale));
 		skyResolutionX = (int)floor(0.5+skyResolutionY*(0.5*std::sqrt(3.0))*prj->getViewportWidth()/prj->getViewportHeight());
+		// Indices are unsigned short
+		while ((1+skyResolutionX)*(1+skyResolutionY) > 65536 && skyResolutionY > 8)
+		{
+			--skyResolutionY;
+			skyResolutionX = (int)floor(0.5+skyResolutionY*(0.5*std::sqrt(3.0))*prj->getViewportWidth()/prj->getViewportHeight());
+		}
 		posGrid = new Vec2f[(1+skyResolutionX)*(1+skyResolutionY)];
 		colorGrid = new Vec4f[(1+skyResolutionX)*(1+skyResolutionY)];
 		float stepX = (float)prj->getViewportWidth() / (skyResolutionX-0.5);
@@ -180,6 +278,7 @@ void Atmosphere::computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moo
 		colorGridBuffer.bind();
 		colorGridBuffer.allocate(colorGrid, (1+skyResolutionX)*(1+skyResolutionY)*4*4);
 		colorGridBuffer.release();
+		StelApp::getInstance().getTextureManager().registerGLBuffer(this, "Atmosphere grid", (1+skyResolutionX)*(1+skyResolutionY)*(8+4*4) + (skyResolutionX+1)*skyResolutionY*2*2);
 	}
 
 	if (qIsNaN(_sunPos.length()))
@@ -252,8 +351,50 @@ void Atmosphere::computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moo
 	// Calculate the date from the julian day.
 	int year, month, day;
 	StelUtils::getDateFromJulianDay(JD, &year, &month, &day);
+
+	// Nothing which changes the colors moved more than the tolerances: keep the grid and the luminance of the previous frame
+	ColorInputs inputs;
+	inputs.sunPos = _sunPos;
+	inputs.moonPos = moonPos;
+	prj->unProject(viewport[0]+0.5*viewport[2], viewport[1]+0.5*viewport[3], inputs.viewDirs[0]);
+	prj->unProject(viewport[0], viewport[1], inputs.viewDirs[1]);
+	prj->unProject(viewport[0]+viewport[2], viewport[1]+viewport[3], inputs.viewDirs[2]);
+	const float values[9] = {moonPhase, moonMagnitude, latitude, altitude, temperature, relativeHumidity, eclipseFactor,
+				 lightPollutionLuminance, fader.getInterstate()};
+	std::copy(values, values+9, inputs.values);
+	inputs.year = year;
+	inputs.month = month;
+	inputs.planets = GETSTELMODULE(SolarSystem)->getFlagPlanets();
+	if (colorCacheValid && isColorReusable(inputs, 1./prj->getPixelPerRadAtCenter()))
+	{
+		// The luminance of the last GPU reduction is read back one frame late
+		if (gpuSkyActive)
+			readAverageLuminance();
+		colorReuseRatio += 0.05f*(1.f-colorReuseRatio);
+		return;
+	}
+	colorReuseRatio -= 0.05f*colorReuseRatio;
+	lastColorInputs = inputs;
+	colorCacheValid = colorCacheAngle>0.;
+	QElapsedTimer timer;
+	timer.start();
 	skyb.setDate(year, month, moonPhase, moonMagnitude);
 
+	if (gpuSkyActive)
+	{
+		// The same model is evaluated by the vertex shaders, see getGpuProgram()
+		moonDir.set(moon_pos[0], moon_pos[1], moon_pos[2]);
+		luminanceScale = GETSTELMODULE(SolarSystem)->getFlagPlanets() ? eclipseFactor : 0.f;
+		const float pollution = fader.getInterstate()*lightPollutionLuminance;
+		luminanceOffset = 0.0001f + (lightPollutionMap ? 0.f : pollution);
+		lightPollutionMapLuminance = lightPollutionMap ? pollution : 0.f;
+		updateLightPollutionTexture();
+		readAverageLuminance();
+		reduceLuminance(prj);
+		colorComputeTime += 0.1f*(timer.nsecsElapsed()*1e-6f-colorComputeTime);
+		return;
+	}
+
 	// Variables used to compute the average sky luminance
 	float sum_lum = 0.f;
 
@@ -294,7 +435,8 @@ void Atmosphere::computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moo
 
 		// Add the light pollution luminance AFTER the scaling to avoid scaling it because it is the cause
 		// of the scaling itself
-		lumi += fader.getInterstate()*lightPollutionLuminance;
+		// The map was normalized so that it does not change the average
+		lumi += fader.getInterstate()*lightPollutionLuminance*(lightPollutionMap ? lightPollutionMap->getFactor(point) : 1.f);
 
 		// Store for later statistics
 		sum_lum+=lumi;
@@ -312,6 +454,28 @@ void Atmosphere::computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moo
 	// Update average luminance
 	if (!overrideAverageLuminance)
 		averageLuminance = sum_lum/((1+skyResolutionX)*(1+skyResolutionY));
+	colorComputeTime += 0.1f*(timer.nsecsElapsed()*1e-6f-colorComputeTime);
+}
+
+bool Atmosphere::isColorReusable(const ColorInputs& current, double pixelAngle) const
+{
+	const ColorInputs& last = lastColorInputs;
+	if (current.year!=last.year || current.month!=last.month || current.planets!=last.planets)
+		return false;
+	for (int i=0; i<9; ++i)
+	{
+		if (std::fabs(current.values[i]-last.values[i]) > colorCacheRelative*qMax(std::fabs(last.values[i]), 1e-3f))
+			return false;
+	}
+	// Below one pixel for the view, so that the sky does not slide behind the landscape
+	const double cosViewTolerance = std::cos(qMin(colorCacheAngle, pixelAngle));
+	for (int i=0; i<3; ++i)
+	{
+		if (current.viewDirs[i].dot(last.viewDirs[i]) < cosViewTolerance*current.viewDirs[i].length()*last.viewDirs[i].length())
+			return false;
+	}
+	const double cosTolerance = std::cos(colorCacheAngle);
+	return current.sunPos.dot(last.sunPos) >= cosTolerance && current.moonPos.dot(last.moonPos) >= cosTolerance;
 }
 
 // override computable luminance. This is for special operations only, e.g. for scripting of brightness-balanced image export.
@@ -346,70 +510,491 @@ void Atmosphere::draw(StelCore* core)
 
 	const float atm_intensity = fader.getInterstate();
 
-	atmoShaderProgram->bind();
+	QOpenGLShaderProgram* program = atmoShaderProgram;
+	const ShaderLocations* locations = &shaderAttribLocations;
+	const StelProjectorP prjAltAz = core->getProjection(StelCore::FrameAltAz, StelCore::RefractionOff);
+	if (gpuSkyActive)
+	{
+		GpuProgram* gpuProgram = getGpuProgram(prjAltAz, false);
+		if (!gpuProgram)
+			return;
+		program = gpuProgram->program;
+		locations = &gpuProgram->locations;
+	}
+
+	program->bind();
 	float a, b, c;
 	eye->getShadersParams(a, b, c);
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.alphaWaOverAlphaDa, a);
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.oneOverGamma, b);
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.term2TimesOneOverMaxdLpOneOverGamma, c);
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.brightnessScale, atm_intensity);
+	program->setUniformValue(locations->alphaWaOverAlphaDa, a);
+	program->setUniformValue(locations->oneOverGamma, b);
+	program->setUniformValue(locations->term2TimesOneOverMaxdLpOneOverGamma, c);
+	program->setUniformValue(locations->brightnessScale, atm_intensity);
 	Vec3f sunPos;
 	float term_x, Ax, Bx, Cx, Dx, Ex, term_y, Ay, By, Cy, Dy, Ey;
 	sky.getShadersParams(sunPos, term_x, Ax, Bx, Cx, Dx, Ex, term_y, Ay, By, Cy, Dy, Ey);
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.sunPos, sunPos[0], sunPos[1], sunPos[2]);
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.term_x, term_x);
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.Ax, Ax);
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.Bx, Bx);
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.Cx, Cx);
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.Dx, Dx);
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.Ex, Ex);
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.term_y, term_y);
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.Ay, Ay);
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.By, By);
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.Cy, Cy);
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.Dy, Dy);
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.Ey, Ey);
+	program->setUniformValue(locations->sunPos, sunPos[0], sunPos[1], sunPos[2]);
+	program->setUniformValue(locations->term_x, term_x);
+	program->setUniformValue(locations->Ax, Ax);
+	program->setUniformValue(locations->Bx, Bx);
+	program->setUniformValue(locations->Cx, Cx);
+	program->setUniformValue(locations->Dx, Dx);
+	program->setUniformValue(locations->Ex, Ex);
+	program->setUniformValue(locations->term_y, term_y);
+	program->setUniformValue(locations->Ay, Ay);
+	program->setUniformValue(locations->By, By);
+	program->setUniformValue(locations->Cy, Cy);
+	program->setUniformValue(locations->Dy, Dy);
+	program->setUniformValue(locations->Ey, Ey);
 	const Mat4f& m = sPainter.getProjector()->getProjectionMatrix();
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.projectionMatrix,
+	program->setUniformValue(locations->projectionMatrix,
 		QMatrix4x4(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]));
 
 	const auto rgbMaxValue=calcRGBMaxValue(sPainter.getDitheringMode());
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.rgbMaxValue, rgbMaxValue[0], rgbMaxValue[1], rgbMaxValue[2]);
+	program->setUniformValue(locations->rgbMaxValue, rgbMaxValue[0], rgbMaxValue[1], rgbMaxValue[2]);
 	auto& gl=*sPainter.glFuncs();
 	gl.glActiveTexture(GL_TEXTURE1);
 	if(!bayerPatternTex)
 		bayerPatternTex=makeBayerPatternTexture(*sPainter.glFuncs());
 	gl.glBindTexture(GL_TEXTURE_2D, bayerPatternTex);
-	atmoShaderProgram->setUniformValue(shaderAttribLocations.bayerPattern, 1);
+	program->setUniformValue(locations->bayerPattern, 1);
 	
-	colorGridBuffer.bind();
-	atmoShaderProgram->setAttributeBuffer(shaderAttribLocations.skyColor, GL_FLOAT, 0, 4, 0);
-	colorGridBuffer.release();
-	atmoShaderProgram->enableAttributeArray(shaderAttribLocations.skyColor);
+	if (gpuSkyActive)
+		setLuminanceUniforms(program, prjAltAz);
+
+	// And draw everything at once
+	drawGrid(program, *locations, !gpuSkyActive);
+	program->release();
+	// GZ: debug output
+	//const StelProjectorP prj = core->getProjection(StelCore::FrameEquinoxEqu);
+	//StelPainter painter(prj);
+	//painter.setFont(font);
+	//sPainter.setColor(0.7, 0.7, 0.7);
+	//sPainter.drawText(83, 120, QString("Atmosphere::getAverageLuminance(): %1" ).arg(getAverageLuminance()));
+	//qDebug() << atmosphere->getAverageLuminance();
+
+}
+
+void Atmosphere::drawGrid(QOpenGLShaderProgram* program, const ShaderLocations& locations, bool withColors)
+{
+	if (withColors)
+	{
+		colorGridBuffer.bind();
+		program->setAttributeBuffer(locations.skyColor, GL_FLOAT, 0, 4, 0);
+		colorGridBuffer.release();
+		program->enableAttributeArray(locations.skyColor);
+	}
 	posGridBuffer.bind();
-	atmoShaderProgram->setAttributeBuffer(shaderAttribLocations.skyVertex, GL_FLOAT, 0, 2, 0);
+	program->setAttributeBuffer(locations.skyVertex, GL_FLOAT, 0, 2, 0);
 	posGridBuffer.release();
-	atmoShaderProgram->enableAttributeArray(shaderAttribLocations.skyVertex);
+	program->enableAttributeArray(locations.skyVertex);
 
-	// And draw everything at once
+	QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
 	indicesBuffer.bind();
 	std::size_t shift=0;
 	for (int y=0;y<skyResolutionY;++y)
 	{
-		sPainter.glFuncs()->glDrawElements(GL_TRIANGLE_STRIP, (skyResolutionX+1)*2, GL_UNSIGNED_SHORT, reinterpret_cast<void*>(shift));
+		gl->glDrawElements(GL_TRIANGLE_STRIP, (skyResolutionX+1)*2, GL_UNSIGNED_SHORT, reinterpret_cast<void*>(shift));
 		shift += (skyResolutionX+1)*2*2;
 	}
 	indicesBuffer.release();
-	
-	atmoShaderProgram->disableAttributeArray(shaderAttribLocations.skyVertex);
-	atmoShaderProgram->disableAttributeArray(shaderAttribLocations.skyColor);
-	atmoShaderProgram->release();
-	// GZ: debug output
-	//const StelProjectorP prj = core->getProjection(StelCore::FrameEquinoxEqu);
-	//StelPainter painter(prj);
-	//painter.setFont(font);
-	//sPainter.setColor(0.7, 0.7, 0.7);
-	//sPainter.drawText(83, 120, QString("Atmosphere::getAverageLuminance(): %1" ).arg(getAverageLuminance()));
-	//qDebug() << atmosphere->getAverageLuminance();
 
+	program->disableAttributeArray(locations.skyVertex);
+	if (withColors)
+		program->disableAttributeArray(locations.skyColor);
+}
+
+bool Atmosphere::isGpuSkyUsable(const StelProjectorP& prj)
+{
+#if QT_VERSION >= 0x050600
+	if (!flagGpuSky || gpuSkyAvailable==0)
+		return false;
+	if (gpuSkyAvailable<0)
+	{
+		// Rendering into a half float buffer, mipmaps of it and pixel buffers need OpenGL 3 or OpenGL ES 3
+		QOpenGLContext* ctx = QOpenGLContext::currentContext();
+		const bool floatBuffers = ctx->format().majorVersion()>=3 && (!ctx->isOpenGLES()
+			|| ctx->hasExtension("GL_EXT_color_buffer_half_float") || ctx->hasExtension("GL_EXT_color_buffer_float"));
+		gpuSkyAvailable = 0;
+		if (!floatBuffers)
+		{
+			qDebug() << "Atmosphere: no floating point render targets, the sky is computed on the CPU";
+			return false;
+		}
+
+		QOpenGLExtraFunctions* gl = ctx->extraFunctions();
+		gl->glGenTextures(1, &luminanceTex);
+		gl->glBindTexture(GL_TEXTURE_2D, luminanceTex);
+		gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, LUMINANCE_BUFFER_SIZE, LUMINANCE_BUFFER_SIZE, 0, GL_RGBA, GL_HALF_FLOAT, Q_NULLPTR);
+		gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+		gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		gl->glGenerateMipmap(GL_TEXTURE_2D);
+		gl->glBindTexture(GL_TEXTURE_2D, 0);
+
+		int levels = 0;
+		for (int size=LUMINANCE_BUFFER_SIZE; size>1; size/=2)
+			++levels;
+		gl->glGenFramebuffers(1, &luminanceFbo);
+		gl->glBindFramebuffer(GL_FRAMEBUFFER, luminanceFbo);
+		gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, luminanceTex, 0);
+		bool complete = gl->glCheckFramebufferStatus(GL_FRAMEBUFFER)==GL_FRAMEBUFFER_COMPLETE;
+		gl->glGenFramebuffers(1, &reductionFbo);
+		gl->glBindFramebuffer(GL_FRAMEBUFFER, reductionFbo);
+		gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, luminanceTex, levels);
+		complete &= gl->glCheckFramebufferStatus(GL_FRAMEBUFFER)==GL_FRAMEBUFFER_COMPLETE;
+		gl->glBindFramebuffer(GL_FRAMEBUFFER, StelApp::getInstance().getDefaultFBO());
+
+		gl->glGenBuffers(2, luminancePbo);
+		for (int i=0; i<2; ++i)
+		{
+			gl->glBindBuffer(GL_PIXEL_PACK_BUFFER, luminancePbo[i]);
+			gl->glBufferData(GL_PIXEL_PACK_BUFFER, 4*sizeof(float), Q_NULLPTR, GL_STREAM_READ);
+		}
+		gl->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		if (!complete)
+		{
+			qWarning() << "Atmosphere: cannot render into the luminance buffer, the sky is computed on the CPU";
+			clearGpuSky();
+			return false;
+		}
+		gpuSkyAvailable = 1;
+		qDebug() << "Atmosphere: the sky is computed on the GPU";
+	}
+	// Projections without GPU implementation use the CPU path
+	return getGpuProgram(prj, false) && getGpuProgram(prj, true);
+#else
+	Q_UNUSED(prj);
+	return false;
+#endif
+}
+
+Atmosphere::GpuProgram* Atmosphere::getGpuProgram(const StelProjectorP& prj, bool luminanceOnly)
+{
+	const QByteArray backwardShader = prj->getBackwardTransformShader();
+	if (backwardShader.isEmpty())
+		return Q_NULLPTR;
+	const QByteArray key = (luminanceOnly ? "L" : "C") + backwardShader;
+	auto iter = gpuPrograms.find(key);
+	if (iter!=gpuPrograms.end())
+		return iter->program ? &iter.value() : Q_NULLPTR;
+
+	// The luminance model of Skybright::getLuminance(), evaluated for the direction of each vertex.
+	QByteArray vsrc =
+		"attribute highp vec2 skyVertex;\n"
+		"uniform highp mat4 projectionMatrix;\n"
+		"uniform highp vec3 sunPos;\n"
+		"uniform highp vec3 moonPos;\n"
+		"uniform highp float skybK, skybC3, skybC4, skybNightTerm, skybMoonTerm1, skybTwilightTerm;\n"
+		"uniform highp float luminanceScale;\n"
+		"uniform highp float luminanceOffset;\n"
+		"uniform highp float lightPollutionMapLuminance;\n"
+		"uniform highp float lightPollutionMapScale;\n"
+		"uniform sampler2D lightPollutionMap;\n"
+		+ backwardShader +
+		"highp float skybrightLuminance(highp float cosDistMoon, highp float cosDistSun, highp float cosDistZenith)\n"
+		"{\n"
+		"    highp float bKX = pow(10.0, -0.4*skybK/(cosDistZenith + 0.025*exp(-11.0*cosDistZenith)));\n"
+		"    highp float distSun = acos(clamp(cosDistSun, -1.0, 1.0));\n"
+		"    highp float FSv = 18886.28/(distSun*distSun + 0.0007) + pow(10.0, 6.15 - (distSun + 0.001)*1.43239)\n"
+		"                    + 229086.77*(1.06 + cosDistSun*cosDistSun);\n"
+		"    highp float bDaylight = 9.289663e-12*(1.0 - bKX)*(FSv*skybC4 + 440000.0*(1.0 - skybC4));\n"
+		"    highp float bTwilight = pow(10.0, skybTwilightTerm + 0.063661977*acos(clamp(cosDistZenith, -1.0, 1.0))/max(skybK, 0.05))\n"
+		"                          * (1.7453293/distSun)*(1.0 - bKX);\n"
+		"    highp float bTotal = min(bTwilight, bDaylight);\n"
+		"    if (skybMoonTerm1*(1.0 - bKX)*(28860205.1341274269*skybC3 + 440000.0*(1.0 - skybC3)) > 0.01*bTotal)\n"
+		"    {\n"
+		"        highp float distMoon = acos(clamp(cosDistMoon, -1.0, 1.0));\n"
+		"        highp float FM = 18886.28/(distMoon*distMoon + 0.0005) + pow(10.0, 6.15 - distMoon*1.43239)\n"
+		"                       + 229086.77*(1.06 + cosDistMoon*cosDistMoon);\n"
+		"        bTotal += skybMoonTerm1*(1.0 - bKX)*(FM*skybC3 + 440000.0*(1.0 - skybC3));\n"
+		"    }\n"
+		"    if (skybNightTerm*bKX > 0.01*bTotal)\n"
+		"        bTotal += (0.4 + 0.6/sqrt(0.04 + 0.96*cosDistZenith*cosDistZenith))*skybNightTerm*bKX;\n"
+		"    return max(bTotal, 0.0)*(900900.9*3.14159265*1e-4*3239389.0*2.0*1.5);\n"
+		"}\n"
+		"// LightPollutionMap::getFactor(): columns from North through East, rows from the horizon\n"
+		"highp float lightPollutionFactor(highp vec3 p)\n"
+		"{\n"
+		"    highp vec2 uv = vec2(0.5 - atan(p.y, p.x)/6.28318531, asin(clamp(p.z, 0.0, 1.0))/1.57079633);\n"
+		"    return texture2DLod(lightPollutionMap, uv, 0.0).r*lightPollutionMapScale;\n"
+		"}\n"
+		"// Same content as the skyColor attribute of the CPU path: direction in xyz, luminance in w\n"
+		"highp vec4 computeSkyColor(highp vec2 win)\n"
+		"{\n"
+		"    highp vec3 p = normalize(unprojectFromViewport(win));\n"
+		"    highp vec3 moon = moonPos;\n"
+		"    // The sky below the ground is the symmetric of the one above\n"
+		"    if (p.z <= 0.0)\n"
+		"    {\n"
+		"        p.z = -p.z;\n"
+		"        moon.z = -moon.z;\n"
+		"    }\n"
+		"    highp float luminance = skybrightLuminance(dot(moon, p), dot(sunPos, p), p.z)*luminanceScale + luminanceOffset;\n"
+		"    if (lightPollutionMapLuminance > 0.0)\n"
+		"        luminance += lightPollutionMapLuminance*lightPollutionFactor(p);\n"
+		"    return vec4(p, luminance);\n"
+		"}\n";
+	QByteArray fsrc;
+	if (luminanceOnly)
+	{
+		vsrc +=
+			"varying highp float skyLuminance;\n"
+			"void main()\n"
+			"{\n"
+			"    gl_Position = projectionMatrix*vec4(skyVertex, 0.0, 1.0);\n"
+			"    // Stay in the range of half floats\n"
+			"    skyLuminance = min(computeSkyColor(skyVertex).w, 65000.0);\n"
+			"}\n";
+		fsrc =
+			"varying highp float skyLuminance;\n"
+			"void main()\n"
+			"{\n"
+			"    gl_FragColor = vec4(skyLuminance);\n"
+			"}\n";
+	}
+	else
+	{
+		// Conversion to RGB, as in the xyYToRGB shader of the CPU path
+		vsrc +=
+			"uniform mediump float term_x, Ax, Bx, Cx, Dx, Ex;\n"
+			"uniform mediump float term_y, Ay, By, Cy, Dy, Ey;\n"
+			"uniform mediump float alphaWaOverAlphaDa;\n"
+			"uniform mediump float oneOverGamma;\n"
+			"uniform mediump float term2TimesOneOverMaxdLpOneOverGamma;\n"
+			"uniform mediump float brightnessScale;\n"
+			"varying mediump vec3 resultSkyColor;\n"
+			"void main()\n"
+			"{\n"
+			"    gl_Position = projectionMatrix*vec4(skyVertex, 0.0, 1.0);\n"
+			"    highp vec4 color = computeSkyColor(skyVertex);\n"
+			"    highp float Y = color.w;\n"
+			"    highp float x = 0.25;\n"
+			"    highp float y = 0.25;\n"
+			"    if (Y > 0.01)\n"
+			"    {\n"
+			"        // Preetham model for the chromaticity\n"
+			"        highp float cosDistSun = dot(sunPos, color.xyz);\n"
+			"        highp float distSun = acos(clamp(cosDistSun, -1.0, 1.0));\n"
+			"        highp float oneOverCosZenithAngle = (color.z == 0.0) ? 1e10 : 1.0/color.z;\n"
+			"        highp float cosDistSunq = cosDistSun*cosDistSun;\n"
+			"        x = term_x*(1.0 + Ax*exp(Bx*oneOverCosZenithAngle))*(1.0 + Cx*exp(Dx*distSun) + Ex*cosDistSunq);\n"
+			"        y = term_y*(1.0 + Ay*exp(By*oneOverCosZenithAngle))*(1.0 + Cy*exp(Dy*distSun) + Ey*cosDistSunq);\n"
+			"        if (x < 0.0 || y < 0.0)\n"
+			"        {\n"
+			"            x = 0.25;\n"
+			"            y = 0.25;\n"
+			"        }\n"
+			"    }\n"
+			"    if (Y <= 0.01)\n"
+			"    {\n"
+			"        // Special case for s = 0 (x=0.25, y=0.25)\n"
+			"        Y = pow(abs(Y*0.5121445*3.14159265*0.0001), alphaWaOverAlphaDa*oneOverGamma)*term2TimesOneOverMaxdLpOneOverGamma;\n"
+			"        resultSkyColor = vec3(0.787077*Y, 0.9898434*Y, 1.9256125*Y)*brightnessScale;\n"
+			"        return;\n"
+			"    }\n"
+			"    if (Y < 3.9810717055349722)\n"
+			"    {\n"
+			"        // Mesopic vision: blue shift towards the night blue x,y=(0.25, 0.25)\n"
+			"        highp float op = (log(Y)/2.302585093 + 2.0)/2.6;\n"
+			"        highp float s = op*op*(3.0 - 2.0*op);\n"
+			"        x = (1.0 - s)*0.25 + s*x;\n"
+			"        y = (1.0 - s)*0.25 + s*y;\n"
+			"        highp float V = Y*(1.33*(1.0 + y/x + x*(1.0 - x - y)) - 1.68);\n"
+			"        Y = 0.4468*(1.0 - s)*V + s*Y;\n"
+			"    }\n"
+			"    Y = pow(abs(Y*3.14159265*0.0001), alphaWaOverAlphaDa*oneOverGamma)*term2TimesOneOverMaxdLpOneOverGamma;\n"
+			"    // xyY to XYZ, then XYZ to Adobe RGB (1998) with a D65 reference white\n"
+			"    highp vec3 XYZ = vec3(x*Y/y, Y, (1.0 - x - y)*Y/y);\n"
+			"    resultSkyColor = vec3(2.04148*XYZ.x - 0.564977*XYZ.y - 0.344713*XYZ.z,\n"
+			"                         -0.969258*XYZ.x + 1.87599*XYZ.y + 0.0415557*XYZ.z,\n"
+			"                          0.0134455*XYZ.x - 0.118373*XYZ.y + 1.01527*XYZ.z)*brightnessScale;\n"
+			"}\n";
+		fsrc = makeDitheringShader().toLatin1()+
+			"varying mediump vec3 resultSkyColor;\n"
+			"void main()\n"
+			"{\n"
+			"   gl_FragColor = vec4(dither(resultSkyColor), 1.);\n"
+			"}\n";
+	}
+
+	GpuProgram gpuProgram;
+	gpuProgram.program = Q_NULLPTR;
+	QOpenGLShader vShader(QOpenGLShader::Vertex);
+	QOpenGLShader fShader(QOpenGLShader::Fragment);
+	if (!vShader.compileSourceCode(vsrc))
+		qWarning() << "Error while compiling GPU atmosphere vertex shader: " << vShader.log();
+	else if (!fShader.compileSourceCode(fsrc))
+		qWarning() << "Error while compiling GPU atmosphere fragment shader: " << fShader.log();
+	else
+	{
+		gpuProgram.program = new QOpenGLShaderProgram();
+		gpuProgram.program->addShader(&vShader);
+		gpuProgram.program->addShader(&fShader);
+		if (StelPainter::linkProg(gpuProgram.program, "atmosphereGpu"))
+			getLocations(gpuProgram.program, gpuProgram.locations);
+		else
+		{
+			delete gpuProgram.program;
+			gpuProgram.program = Q_NULLPTR;
+		}
+	}
+	// Failures are stored too, so that we do not try again each frame
+	iter = gpuPrograms.insert(key, gpuProgram);
+	return iter->program ? &iter.value() : Q_NULLPTR;
+}
+
+void Atmosphere::setLuminanceUniforms(QOpenGLShaderProgram* program, const StelProjectorP& prj) const
+{
+	float K, C3, C4, bNightTerm, bMoonTerm1, bTwilightTerm;
+	skyb.getShadersParams(K, C3, C4, bNightTerm, bMoonTerm1, bTwilightTerm);
+	Vec3f sunPos;
+	float term_x, Ax, Bx, Cx, Dx, Ex, term_y, Ay, By, Cy, Dy, Ey;
+	sky.getShadersParams(sunPos, term_x, Ax, Bx, Cx, Dx, Ex, term_y, Ay, By, Cy, Dy, Ey);
+	program->setUniformValue("sunPos", sunPos[0], sunPos[1], sunPos[2]);
+	program->setUniformValue("moonPos", moonDir[0], moonDir[1], moonDir[2]);
+	program->setUniformValue("skybK", K);
+	program->setUniformValue("skybC3", C3);
+	program->setUniformValue("skybC4", C4);
+	program->setUniformValue("skybNightTerm", bNightTerm);
+	program->setUniformValue("skybMoonTerm1", bMoonTerm1);
+	program->setUniformValue("skybTwilightTerm", bTwilightTerm);
+	program->setUniformValue("luminanceScale", luminanceScale);
+	program->setUniformValue("luminanceOffset", luminanceOffset);
+	program->setUniformValue("lightPollutionMapLuminance", lightPollutionTex ? lightPollutionMapLuminance : 0.f);
+	program->setUniformValue("lightPollutionMapScale", lightPollutionMap ? lightPollutionMap->getMaxFactor() : 0.f);
+	program->setUniformValue("lightPollutionMap", 2);
+	if (lightPollutionTex)
+	{
+		QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+		gl->glActiveTexture(GL_TEXTURE2);
+		gl->glBindTexture(GL_TEXTURE_2D, lightPollutionTex);
+		gl->glActiveTexture(GL_TEXTURE0);
+	}
+	prj->setForwardTransformUniforms(*program);
+}
+
+void Atmosphere::updateLightPollutionTexture()
+{
+	if (!lightPollutionTexDirty)
+		return;
+	lightPollutionTexDirty = false;
+	QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+	if (lightPollutionTex)
+	{
+		gl->glDeleteTextures(1, &lightPollutionTex);
+		lightPollutionTex = 0;
+	}
+	if (!lightPollutionMap)
+		return;
+
+	const QVector<float>& factors = lightPollutionMap->getFactors();
+	const float scale = 255.f/lightPollutionMap->getMaxFactor();
+	QVector<unsigned char> texels(4*factors.size());
+	for (int i=0; i<factors.size(); ++i)
+	{
+		const unsigned char value = static_cast<unsigned char>(qRound(factors.at(i)*scale));
+		texels[4*i] = texels[4*i+1] = texels[4*i+2] = value;
+		texels[4*i+3] = 255;
+	}
+	gl->glGenTextures(1, &lightPollutionTex);
+	gl->glBindTexture(GL_TEXTURE_2D, lightPollutionTex);
+	gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, lightPollutionMap->getWidth(), lightPollutionMap->getHeight(), 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.constData());
+	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	// Azimuth wraps around, altitude stops at the horizon and the zenith
+	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	gl->glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Atmosphere::reduceLuminance(const StelProjectorP& prj)
+{
+#if QT_VERSION >= 0x050600
+	GpuProgram* gpuProgram = getGpuProgram(prj, true);
+	if (!gpuProgram)
+		return;
+	QOpenGLExtraFunctions* gl = QOpenGLContext::currentContext()->extraFunctions();
+
+	GLint oldViewport[4];
+	gl->glGetIntegerv(GL_VIEWPORT, oldViewport);
+	const bool blend = gl->glIsEnabled(GL_BLEND);
+	gl->glDisable(GL_BLEND);
+	StelOpenGL::ScissorSuspender noScissor;
+	gl->glBindFramebuffer(GL_FRAMEBUFFER, luminanceFbo);
+	gl->glViewport(0, 0, LUMINANCE_BUFFER_SIZE, LUMINANCE_BUFFER_SIZE);
+
+	// The grid covers the viewport, which is stretched over the whole buffer
+	QOpenGLShaderProgram* program = gpuProgram->program;
+	program->bind();
+	const Mat4f m = prj->getProjectionMatrix();
+	program->setUniformValue(gpuProgram->locations.projectionMatrix,
+		QMatrix4x4(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]));
+	setLuminanceUniforms(program, prj);
+	drawGrid(program, gpuProgram->locations, false);
+	program->release();
+
+	// The last level of the mipmaps is the average of the buffer
+	gl->glBindTexture(GL_TEXTURE_2D, luminanceTex);
+	gl->glGenerateMipmap(GL_TEXTURE_2D);
+	gl->glBindTexture(GL_TEXTURE_2D, 0);
+
+	// Read it into a pixel buffer, which is mapped only in the next frame so that we do not wait for the GPU
+	luminancePboIndex = 1-luminancePboIndex;
+	gl->glBindFramebuffer(GL_FRAMEBUFFER, reductionFbo);
+	gl->glBindBuffer(GL_PIXEL_PACK_BUFFER, luminancePbo[luminancePboIndex]);
+	gl->glReadPixels(0, 0, 1, 1, GL_RGBA, GL_FLOAT, Q_NULLPTR);
+	gl->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	luminancePending[luminancePboIndex] = true;
+
+	gl->glBindFramebuffer(GL_FRAMEBUFFER, StelApp::getInstance().getDefaultFBO());
+	gl->glViewport(oldViewport[0], oldViewport[1], oldViewport[2], oldViewport[3]);
+	if (blend)
+		gl->glEnable(GL_BLEND);
+#else
+	Q_UNUSED(prj);
+#endif
+}
+
+void Atmosphere::readAverageLuminance()
+{
+#if QT_VERSION >= 0x050600
+	if (!luminancePending[luminancePboIndex])
+		return;
+	QOpenGLExtraFunctions* gl = QOpenGLContext::currentContext()->extraFunctions();
+	gl->glBindBuffer(GL_PIXEL_PACK_BUFFER, luminancePbo[luminancePboIndex]);
+	const float* rgba = static_cast<const float*>(gl->glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, 4*sizeof(float), GL_MAP_READ_BIT));
+	if (rgba)
+	{
+		if (!overrideAverageLuminance)
+			averageLuminance = rgba[0];
+		gl->glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	gl->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	luminancePending[luminancePboIndex] = false;
+#endif
+}
+
+void Atmosphere::clearGpuSky()
+{
+	for (auto& gpuProgram : gpuPrograms)
+		delete gpuProgram.program;
+	gpuPrograms.clear();
+	QOpenGLContext* ctx = QOpenGLContext::currentContext();
+	if (!ctx)
+		return;
+	QOpenGLFunctions* gl = ctx->functions();
+	if (luminanceFbo)
+		gl->glDeleteFramebuffers(1, &luminanceFbo);
+	if (reductionFbo)
+		gl->glDeleteFramebuffers(1, &reductionFbo);
+	if (luminanceTex)
+		gl->glDeleteTextures(1, &luminanceTex);
+	if (luminancePbo[0])
+		gl->glDeleteBuffers(2, luminancePbo);
+	if (lightPollutionTex)
+		gl->glDeleteTextures(1, &lightPollutionTex);
+	luminanceFbo = reductionFbo = luminanceTex = lightPollutionTex = 0;
+	lightPollutionTexDirty = true;
+	luminancePbo[0] = luminancePbo[1] = 0;
+	luminancePending[0] = luminancePending[1] = false;
 }
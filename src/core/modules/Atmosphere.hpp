@@ -25,11 +25,15 @@
 #include "VecMath.hpp"
 
 #include "Skybright.hpp"
+#include "LightPollutionMap.hpp"
 #include "StelFader.hpp"
+#include "StelProjectorType.hpp"
 
+#include <QHash>
 #include <QOpenGLBuffer>
 
 class StelProjector;
+class QOpenGLShaderProgram;
 class StelToneReproducer;
 class StelCore;
 
@@ -70,6 +74,7 @@ public:
 	//! If atmosphere is off, the luminance equals the background starlight (0.001cd/m2).
 	// TODO: Find reference for this value? Why 1 mcd/m2 without atmosphere and 0.1 mcd/m2 inside? Absorption?
 	//! Otherwise it includes the (atmosphere + background starlight (0.0001cd/m2) * eclipse factor + light pollution.
+	//! When the sky is computed on the GPU, the value is read back asynchronously and lags one frame behind.
 	//! @return the last computed average luminance of the atmosphere in cd/m2.
 	float getAverageLuminance() const {return averageLuminance;}
 
@@ -80,12 +85,87 @@ public:
 	void setLightPollutionLuminance(float f) { lightPollutionLuminance = f; }
 	//! Get the light pollution luminance in cd/m^2
 	float getLightPollutionLuminance() const { return lightPollutionLuminance; }
+	//! Set the directional distribution of the light pollution luminance.
+	//! @param map the map of the site, or a null pointer for a uniform light pollution.
+	void setLightPollutionMap(const LightPollutionMapP& map);
+	//! Get the directional distribution of the light pollution luminance, or a null pointer if it is uniform.
+	LightPollutionMapP getLightPollutionMap() const { return lightPollutionMap; }
+
+	//! Set the factor applied to the resolution of the grid of the atmosphere (landscape/atmosphereybin).
+	//! @param scale value in ]0, 1], default 1. Lower values are faster, with coarser gradients.
+	void setResolutionScale(float scale);
+	float getResolutionScale() const { return resolutionScale; }
+
+	//! Get whether the last computeColor() evaluated the sky on the GPU (landscape/atmosphere_gpu).
+	bool isComputedOnGpu() const { return gpuSkyActive; }
+
+	//! Get the fraction of the recent frames for which computeColor() reused the colors of the previous frame,
+	//! because its inputs did not change by more than the tolerances.
+	float getColorReuseRatio() const { return colorReuseRatio; }
+	//! Get the average time of the computeColor() calls which computed the colors [ms].
+	//! Each reused frame saves about this time.
+	float getColorComputeTime() const { return colorComputeTime; }
 
 private:
+	//! Locations of the uniforms and attributes of a sky shader program.
+	struct ShaderLocations {
+		int bayerPattern;
+		int rgbMaxValue;
+		int alphaWaOverAlphaDa;
+		int oneOverGamma;
+		int term2TimesOneOverMaxdLpOneOverGamma;
+		int brightnessScale;
+		int sunPos;
+		int term_x, Ax, Bx, Cx, Dx, Ex;
+		int term_y, Ay, By, Cy, Dy, Ey;
+		int projectionMatrix;
+		int skyVertex;
+		int skyColor;
+	};
+	static void getLocations(QOpenGLShaderProgram* program, ShaderLocations& locations);
+
+	//! A sky shader program evaluating the luminance model of Skybright for one projection type.
+	struct GpuProgram {
+		QOpenGLShaderProgram* program;
+		ShaderLocations locations;
+	};
+
+	//! Get whether the sky can be computed on the GPU for this projector. Requires a valid context.
+	bool isGpuSkyUsable(const StelProjectorP& prj);
+	//! Get the GPU sky program for the projection type of prj, compiling it on first use.
+	//! @param luminanceOnly true for the program which writes the luminance into the reduction buffer.
+	//! @return Q_NULLPTR if the program cannot be compiled.
+	GpuProgram* getGpuProgram(const StelProjectorP& prj, bool luminanceOnly);
+	//! Set the uniforms of the luminance model and of the projector in a bound GPU sky program.
+	void setLuminanceUniforms(QOpenGLShaderProgram* program, const StelProjectorP& prj) const;
+	//! Draw the triangle strips of the grid with the bound program.
+	void drawGrid(QOpenGLShaderProgram* program, const ShaderLocations& locations, bool withColors);
+	//! Render the luminance of the grid into the reduction buffer, reduce it with mipmaps,
+	//! and start the asynchronous readback of the average.
+	void reduceLuminance(const StelProjectorP& prj);
+	//! Read the average luminance which was queued by reduceLuminance() in the previous frame.
+	void readAverageLuminance();
+	//! Upload the light pollution map into lightPollutionTex if it changed. Requires a valid context.
+	void updateLightPollutionTexture();
+	//! Release the GPU sky resources. Requires a valid context.
+	void clearGpuSky();
+
+	//! The inputs of computeColor() which change the colors of the grid.
+	struct ColorInputs {
+		Vec3d sunPos, moonPos;		// normalized
+		Vec3d viewDirs[3];		// directions seen at the center and at two corners of the viewport
+		float values[9];		// moon phase and magnitude, latitude, altitude, temperature, humidity, eclipse factor, light pollution, fader
+		int year, month;
+		bool planets;
+	};
+	//! Get whether the colors computed for previous inputs can be reused for the current inputs.
+	bool isColorReusable(const ColorInputs& current, double pixelAngle) const;
+
 	Vec4i viewport;
 	Skylight sky;
 	Skybright skyb;
 	int skyResolutionY,skyResolutionX;
+	float resolutionScale;
 
 	Vec2f* posGrid;
 	QOpenGLBuffer posGridBuffer;
@@ -99,25 +179,39 @@ private:
 	float eclipseFactor;
 	LinearFader fader;
 	float lightPollutionLuminance;
+	LightPollutionMapP lightPollutionMap;
+
+	// Reuse of the colors when nothing changed
+	ColorInputs lastColorInputs;
+	bool colorCacheValid;		// lastColorInputs describe the colors in colorGrid
+	double colorCacheAngle;		// tolerance on directions [rad], landscape/atmosphere_cache_tolerance in arc minutes
+	float colorCacheRelative;	// relative tolerance on the other inputs
+	float colorReuseRatio;
+	float colorComputeTime;
 
 	//! Vertex shader used for xyYToRGB computation
-	class QOpenGLShaderProgram* atmoShaderProgram;
-	struct {
-		int bayerPattern;
-		int rgbMaxValue;
-		int alphaWaOverAlphaDa;
-		int oneOverGamma;
-		int term2TimesOneOverMaxdLpOneOverGamma;
-		int brightnessScale;
-		int sunPos;
-		int term_x, Ax, Bx, Cx, Dx, Ex;
-		int term_y, Ay, By, Cy, Dy, Ey;
-		int projectionMatrix;
-		int skyVertex;
-		int skyColor;
-	} shaderAttribLocations;
+	QOpenGLShaderProgram* atmoShaderProgram;
+	ShaderLocations shaderAttribLocations;
 
 	GLuint bayerPatternTex=0;
+
+	// Evaluation of the sky on the GPU
+	bool flagGpuSky;		// landscape/atmosphere_gpu
+	int gpuSkyAvailable;		// -1 if not checked yet, 0 if the context cannot do it, 1 if it can
+	bool gpuSkyActive;		// the grid and the luminance of the last computeColor() are for the GPU path
+	QHash<QByteArray, GpuProgram> gpuPrograms;
+	Vec3f moonDir;			// last moon position given to computeColor()
+	float luminanceScale;		// Skybright luminance factor: eclipse factor, 0 if the planets are hidden
+	float luminanceOffset;		// luminance added to Skybright: star background and uniform light pollution
+	float lightPollutionMapLuminance;	// light pollution luminance modulated by lightPollutionTex
+	GLuint lightPollutionTex;	// factors of lightPollutionMap, divided by its largest factor
+	bool lightPollutionTexDirty;	// lightPollutionMap changed since lightPollutionTex was uploaded
+	GLuint luminanceTex;		// luminance of the grid, with its mipmaps for the reduction
+	GLuint luminanceFbo;		// framebuffer rendering into level 0 of luminanceTex
+	GLuint reductionFbo;		// framebuffer reading the 1x1 level of luminanceTex
+	GLuint luminancePbo[2];		// pixel buffers for the asynchronous readback of the average
+	bool luminancePending[2];	// true if a readback was queued into the buffer
+	int luminancePboIndex;		// buffer used by the last reduceLuminance()
 };
 
 #endif // ATMOSTPHERE_HPP
@@ -20,6 +20,7 @@
  
 #include "Comet.hpp"
 #include "Orbit.hpp"
+#include "RefractionExtinction.hpp"
 
 #include "StelApp.hpp"
 #include "StelCore.hpp"
@@ -49,6 +50,7 @@ StelTextureSP Comet::comaTexture;
 StelTextureSP Comet::tailTexture;
 QVector<float> Comet::tailTexCoordArr; // computed only once for all Comets.
 QVector<unsigned short> Comet::tailIndices; // computed only once for all Comets.
+CometTailRenderer* Comet::tailRenderer=Q_NULLPTR;
 
 Comet::Comet(const QString& englishName,
 	     double radius,
@@ -93,6 +95,7 @@ Comet::Comet(const QString& englishName,
 	  tailFactors(-1., -1.), // mark "invalid"
 	  tailActive(false),
 	  tailBright(false),
+	  tailVerticesDirty(false),
 	  deltaJDEtail(15.0*StelCore::JD_MINUTE), // update tail geometry every 15 minutes only
 	  lastJDEtail(0.0),
 	  dustTailWidthFactor(dustTailWidthFact),
@@ -336,18 +339,19 @@ double Comet::getSiderealPeriod() const
 	return period;
 }
 
-float Comet::getVMagnitude(const StelCore* core) const
+float Comet::computeVMagnitude(const Vec3d& observerHelioPos, const Vec3d& planetHelioPos, const Vec3d& parentHelioPos,
+			       double JDE, bool fromEarth, double eclipseFactor) const
 {
 	//If the two parameter system is not used,
 	//use the default radius/albedo mechanism
 	if (slopeParameter < 0)
 	{
-		return Planet::getVMagnitude(core);
+		return Planet::computeVMagnitude(observerHelioPos, planetHelioPos, parentHelioPos, JDE, fromEarth, eclipseFactor);
 	}
 
 	//Calculate distances
-	const Vec3d& observerHeliocentricPosition = core->getObserverHeliocentricEclipticPos();
-	const Vec3d& cometHeliocentricPosition = getHeliocentricEclipticPos();
+	const Vec3d& observerHeliocentricPosition = observerHelioPos;
+	const Vec3d& cometHeliocentricPosition = planetHelioPos;
 	const double cometSunDistance = cometHeliocentricPosition.length();
 	const double observerCometDistance = (observerHeliocentricPosition - cometHeliocentricPosition).length();
 
@@ -403,12 +407,18 @@ void Comet::update(int deltaTime)
 				// The dust tail is thicker and usually shorter. The factors can be configured in the elements.
 				float dustparameter=gasTailEndRadius*gasTailEndRadius*dustTailWidthFactor*dustTailWidthFactor/(2.0f*dustTailLengthFactor*tailFactors[1]);
 
-				// Find valid parameters to create paraboloid vertex arrays: dustTail, gasTail.
-				computeParabola(gasparameter, gasTailEndRadius, -0.5f*gasparameter, gastailVertexArr,  tailTexCoordArr, tailIndices);
-				//gastailColorArr.fill(Vec3f(0.3,0.3,0.3), gastailVertexArr.length());
-				// Now we make a skewed parabola. Skew factor (xOffset, last arg) is rather ad-hoc/empirical. TBD later: Find physically correct solution.
-				computeParabola(dustparameter, dustTailWidthFactor*gasTailEndRadius, -0.5f*dustparameter, dusttailVertexArr, tailTexCoordArr, tailIndices, 25.0f*orbit->getVelocity().length());
-				//dusttailColorArr.fill(Vec3f(0.3,0.3,0.3), dusttailVertexArr.length());
+				// Find valid parameters to create paraboloids: dustTail, gasTail.
+				// The vertex arrays are only computed when the tails are drawn with StelPainter, see computeTailVertices().
+				gasTailShape.radius=gasTailEndRadius;
+				gasTailShape.length=tailFactors[1];
+				gasTailShape.zShift=-0.5f*gasparameter;
+				gasTailShape.xOffset=0.0f;
+				// Now we make a skewed parabola. Skew factor (xOffset) is rather ad-hoc/empirical. TBD later: Find physically correct solution.
+				dustTailShape.radius=dustTailWidthFactor*gasTailEndRadius;
+				dustTailShape.length=dustTailLengthFactor*tailFactors[1];
+				dustTailShape.zShift=-0.5f*dustparameter;
+				dustTailShape.xOffset=25.0f*orbit->getVelocity().length();
+				tailVerticesDirty=true;
 
 
 				// 2014-08 for 0.13.1 Moved from drawTail() to save lots of computation per frame (There *are* folks downloading all 730 MPC current comet elements...)
@@ -422,23 +432,12 @@ void Comet::update(int deltaTime)
 				// The curved tail is curved towards positive X. We first rotate around the Z axis into a direction opposite of the motion vector, then again the antisolar rotation applies.
 				// In addition, we let the dust tail already start with a light tilt.
 				dustTailRot=gasTailRot * Mat4d::zrotation(atan2(velocity[1], velocity[0]) + M_PI) * Mat4d::yrotation(5.0f*velocity.length());
-
-				// Rotate vertex arrays:
-				Vec3d* gasVertices=(Vec3d*) (gastailVertexArr.data());
-				Vec3d* dustVertices=(Vec3d*) (dusttailVertexArr.data());
-				for (int i=0; i<COMET_TAIL_SLICES*COMET_TAIL_STACKS+1; ++i)
-				{
-					gasVertices[i].transfo4d(gasTailRot);
-					dustVertices[i].transfo4d(dustTailRot);
-				}
 			}
 			orbit->setUpdateTails(false); // don't update until position has been recalculated elsewhere
 		}
 	}
 
-	// And also update magnitude and tail brightness/extinction here.
-	const bool withAtmosphere=(core->getSkyDrawer()->getFlagHasAtmosphere());
-
+	// And also update magnitude and tail brightness here.
 	StelToneReproducer* eye = core->getToneReproducer();
 	float lum = core->getSkyDrawer()->surfaceBrightnessToLuminance(getVMagnitude(core)+13.0f); // How to calibrate?
 	// Get the luminance scaled between 0 and 1
@@ -464,8 +463,36 @@ void Comet::update(int deltaTime)
 	float dustMagFactor=qMin(dustTailBrightnessFactor*aLum, 0.7f);
 
 	// TODO: Maybe make gas color distance dependent? (various typical ingredients outgas at different temperatures...)
-	Vec3f gasColor(0.15f*gasMagFactor,0.35f*gasMagFactor,0.6f*gasMagFactor); // Orig color 0.15/0.15/0.6.
-	Vec3f dustColor(dustMagFactor, dustMagFactor,0.6f*dustMagFactor);
+	gasTailColor.set(0.15f*gasMagFactor,0.35f*gasMagFactor,0.6f*gasMagFactor); // Orig color 0.15/0.15/0.6.
+	dustTailColor.set(dustMagFactor, dustMagFactor,0.6f*dustMagFactor);
+	// The extinction of the tails is applied when they are drawn.
+}
+
+void Comet::computeTailVertices()
+{
+	if (!tailVerticesDirty)
+		return;
+	// parabola formula: z=r²/2p, so p=r²/2z
+	computeParabola(gasTailShape.radius*gasTailShape.radius/(2.0f*gasTailShape.length), gasTailShape.radius, gasTailShape.zShift, gastailVertexArr, tailTexCoordArr, tailIndices, gasTailShape.xOffset);
+	computeParabola(dustTailShape.radius*dustTailShape.radius/(2.0f*dustTailShape.length), dustTailShape.radius, dustTailShape.zShift, dusttailVertexArr, tailTexCoordArr, tailIndices, dustTailShape.xOffset);
+
+	// 2014-08 for 0.13.1 Moved from drawTail() to save lots of computation per frame (There *are* folks downloading all 730 MPC current comet elements...)
+	// Rotate vertex arrays:
+	Vec3d* gasVertices=(Vec3d*) (gastailVertexArr.data());
+	Vec3d* dustVertices=(Vec3d*) (dusttailVertexArr.data());
+	for (int i=0; i<COMET_TAIL_SLICES*COMET_TAIL_STACKS+1; ++i)
+	{
+		gasVertices[i].transfo4d(gasTailRot);
+		dustVertices[i].transfo4d(dustTailRot);
+	}
+	tailVerticesDirty=false;
+}
+
+void Comet::computeTailColors(StelCore* core)
+{
+	const bool withAtmosphere=(core->getSkyDrawer()->getFlagHasAtmosphere());
+	const Vec3f gasColor=gasTailColor;
+	const Vec3f dustColor=dustTailColor;
 
 	if (withAtmosphere)
 	{
@@ -584,8 +611,10 @@ void Comet::draw(StelCore* core, float maxMagLabels, const QFont& planetNameFont
 	}
 
 	// but tails should also be drawn if comet core is off-screen...
-	if (tailActive && tailBright)
+	if (tailActive && tailBright && !drawTailBuffers(core, transfo))
 	{
+		computeTailVertices();
+		computeTailColors(core);
 		drawTail(core,transfo,true);  // gas tail
 		drawTail(core,transfo,false); // dust tail
 	}
@@ -613,6 +642,60 @@ void Comet::drawTail(StelCore* core, StelProjector::ModelViewTranformP transfo,
 	sPainter.setBlending(false);
 }
 
+bool Comet::drawTailBuffers(StelCore* core, StelProjector::ModelViewTranformP transfo)
+{
+	if (!tailRenderer)
+	{
+		// The shared mesh: radius 1, and z=r² for a length of 1
+		tailRenderer = new CometTailRenderer();
+		QVector<Vec3d> unitVertexArr;
+		computeParabola(0.5f, 1.0f, 0.0f, unitVertexArr, tailTexCoordArr, tailIndices);
+		tailRenderer->init(unitVertexArr, tailTexCoordArr, tailIndices);
+	}
+	StelProjector::ModelViewTranformP gasTransfo = transfo->clone();
+	gasTransfo->combine(gasTailRot);
+	const StelProjectorP gasPrj = core->getProjection(gasTransfo);
+	if (!tailRenderer->isUsable(gasPrj))
+		return false;
+	StelProjector::ModelViewTranformP dustTransfo = transfo->clone();
+	dustTransfo->combine(dustTailRot);
+
+	const bool withAtmosphere=(core->getSkyDrawer()->getFlagHasAtmosphere());
+	const Extinction* extinction=Q_NULLPTR;
+	float fadeToEnd=0.0f;
+	Mat4d helioToAltAz=Mat4d::identity();
+	if (withAtmosphere)
+	{
+		extinction=&core->getSkyDrawer()->getExtinction();
+		// Twilight makes the tail end less visible, as in computeTailColors()
+		fadeToEnd=GETSTELMODULE(LandscapeMgr)->getAtmosphereAverageLuminance();
+		const Vec3d origin=core->heliocentricEclipticToAltAz(Vec3d(0.), StelCore::RefractionOff);
+		Vec3d axes[3] = {Vec3d(1.,0.,0.), Vec3d(0.,1.,0.), Vec3d(0.,0.,1.)};
+		for (auto& axis : axes)
+			axis=core->heliocentricEclipticToAltAz(axis, StelCore::RefractionOff)-origin;
+		helioToAltAz=Mat4d(axes[0][0], axes[0][1], axes[0][2], 0., axes[1][0], axes[1][1], axes[1][2], 0.,
+				   axes[2][0], axes[2][1], axes[2][2], 0., origin[0], origin[1], origin[2], 1.);
+	}
+	const Mat4d mat = helioToAltAz * Mat4d::translation(eclipticPos) * rotLocalToParent;
+
+	tailTexture->bind();
+	{
+		StelPainter sPainter(gasPrj);
+		sPainter.setBlending(true, GL_ONE, GL_ONE);
+		sPainter.setCullFace(false);
+		tailRenderer->draw(&sPainter, gasTailShape, gasTailColor*intensityFovScale, extinction, mat*gasTailRot, fadeToEnd);
+		sPainter.setBlending(false);
+	}
+	{
+		StelPainter sPainter(core->getProjection(dustTransfo));
+		sPainter.setBlending(true, GL_ONE, GL_ONE);
+		sPainter.setCullFace(false);
+		tailRenderer->draw(&sPainter, dustTailShape, dustTailColor*intensityFovScale, extinction, mat*dustTailRot, fadeToEnd);
+		sPainter.setBlending(false);
+	}
+	return true;
+}
+
 void Comet::drawComa(StelCore* core, StelProjector::ModelViewTranformP transfo)
 {
 	// Find rotation matrix from 0/0/1 to viewdirection! crossproduct for axis (normal vector), dotproduct for angle.
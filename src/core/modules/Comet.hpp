@@ -22,6 +22,7 @@
 #define COMET_HPP
 
 #include "Planet.hpp"
+#include "CometTailRenderer.hpp"
 
 /*! \class Comet
 	\author Bogdan Marinov, Georg Zotti (orbit computation enhancements, tails)
@@ -85,7 +86,8 @@ public:
 	//was not designed to handle different types of objects.
 	//virtual QString getType() const {return "Comet";}
 	//! \todo Find better sources for the g,k system
-	virtual float getVMagnitude(const StelCore* core) const;
+	virtual float computeVMagnitude(const Vec3d& observerHelioPos, const Vec3d& planetHelioPos, const Vec3d& parentHelioPos,
+					double JDE, bool fromEarth, double eclipseFactor=1.) const;
 	//! sets the nameI18 property with the appropriate translation.
 	//! Function overriden to handle the problem with name conflicts.
 	virtual void translateName(const StelTranslator& trans);
@@ -118,6 +120,9 @@ private:
 	//! Using the formula from Guide found by the GSoC2012 initiative at http://www.projectpluto.com/update7b.htm#comet_tail_formula
 	Vec2f getComaDiameterAndTailLengthAU() const;
 	void drawTail(StelCore* core, StelProjector::ModelViewTranformP transfo, bool gas);
+	//! Draw both tails from the mesh of tailRenderer, shaped on the GPU.
+	//! @return false if the projection can't be evaluated on the GPU, then drawTail() must be used.
+	bool drawTailBuffers(StelCore* core, StelProjector::ModelViewTranformP transfo);
 	void drawComa(StelCore* core, StelProjector::ModelViewTranformP transfo);
 
 	//! compute a coma, faked as simple disk to be tilted towards the observer.
@@ -135,6 +140,10 @@ private:
 	//! @param indices into the former arrays (zero-starting), triplets forming triangles: t0,0, t0,1, t0,2, t1,0, t1,1, t1,2, ...
 	//! @param xOffset for the dust tail, this may introduce a bend. Units are x per sqrt(z).
 	void computeParabola(const float parameter, const float topradius, const float zshift, QVector<Vec3d>& vertexArr, QVector<float>& texCoordArr, QVector<unsigned short>& indices, const float xOffset=0.0f);
+	//! compute the vertex arrays of both tails for drawTail() from their shapes, if they changed since the last call.
+	void computeTailVertices();
+	//! compute the vertex colors of both tails for drawTail(), with extinction.
+	void computeTailColors(StelCore* core);
 
 	float slopeParameter;
 	double semiMajorAxis;
@@ -145,6 +154,11 @@ private:
 	Vec2f tailFactors; // result of latest call to getComaDiameterAndTailLengthAU(); Results cached here for infostring. [0]=Coma diameter, [1] gas tail length.
 	bool tailActive;		//! true if there is a tail long enough to be worth drawing. Drawing tails is quite costly.
 	bool tailBright;		//! true if tail is bright enough to draw.
+	bool tailVerticesDirty;		//! true if the vertex arrays must be computed again from the shapes.
+	CometTailRenderer::Shape gasTailShape;	//! shape of the gas tail parabola, before rotation
+	CometTailRenderer::Shape dustTailShape;	//! shape of the dust tail parabola, before rotation
+	Vec3f gasTailColor;		//! color of the gas tail head, before extinction and FOV scaling
+	Vec3f dustTailColor;		//! color of the dust tail head, before extinction and FOV scaling
 	double deltaJDEtail;            //! like deltaJDE, but time difference between tail geometry updates.
 	double lastJDEtail;             //! like lastJDE, but time of last tail geometry update.
 	Mat4d gasTailRot;		//! rotation matrix for gas tail parabola
@@ -170,6 +184,7 @@ private:
 	QVector<Vec3f> dusttailColorArr;   // NEW computed for every 5 mins, modulates dust tail brightness for extinction
 	static QVector<float> tailTexCoordArr; // computed only once for all comets!
 	static QVector<unsigned short> tailIndices; // computed only once for all comets!
+	static CometTailRenderer* tailRenderer; // the mesh shared by the tails of all comets, deleted by SolarSystem
 	static StelTextureSP comaTexture;
 	static StelTextureSP tailTexture;      // it seems not really necessary to have different textures. gas tail is just painted blue.
 };
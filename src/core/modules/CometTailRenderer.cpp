@@ -0,0 +1,222 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "CometTailRenderer.hpp"
+#include "RefractionExtinction.hpp"
+#include "StelApp.hpp"
+#include "StelPainter.hpp"
+#include "StelProjector.hpp"
+#include "StelTextureMgr.hpp"
+
+#include <QDebug>
+#include <QMatrix4x4>
+#include <QOpenGLShaderProgram>
+#include <QSettings>
+
+#include <cmath>
+
+CometTailRenderer::CometTailRenderer()
+	: flagEnabled(false)
+	, flagAvailable(false)
+	, initialized(false)
+	, indexCount(0)
+	, vertexBuffer(QOpenGLBuffer::VertexBuffer)
+	, indexBuffer(QOpenGLBuffer::IndexBuffer)
+{
+	QSettings* conf = StelApp::getInstance().getSettings();
+	flagEnabled = conf->value("video/flag_comet_tail_buffers", true).toBool() && !StelApp::getInstance().isHeadless();
+}
+
+CometTailRenderer::~CometTailRenderer()
+{
+	if (vertexBuffer.isCreated())
+	{
+		vertexBuffer.destroy();
+		indexBuffer.destroy();
+		StelApp::getInstance().getTextureManager().unregisterGLBuffer(this);
+	}
+	qDeleteAll(programs);
+	programs.clear();
+}
+
+void CometTailRenderer::init(const QVector<Vec3d>& unitVertices, const QVector<float>& texCoords, const QVector<unsigned short>& indices)
+{
+	if (initialized || !flagEnabled)
+		return;
+	initialized = true;
+	Q_ASSERT(texCoords.size()==2*unitVertices.size());
+
+	// Interleaved unit position, texture coordinates and position of the vertex in the mesh, from 0 at the head to 1
+	const int count = unitVertices.size();
+	QVector<GLfloat> vertices;
+	vertices.reserve(count*6);
+	for (int i=0;i<count;++i)
+	{
+		const Vec3d& v = unitVertices.at(i);
+		vertices << v[0] << v[1] << v[2] << texCoords.at(2*i) << texCoords.at(2*i+1) << static_cast<float>(i)/qMax(1, count-1);
+	}
+
+	vertexBuffer.create();
+	vertexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+	vertexBuffer.bind();
+	vertexBuffer.allocate(vertices.constData(), vertices.size()*sizeof(GLfloat));
+	vertexBuffer.release();
+	indexBuffer.create();
+	indexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+	indexBuffer.bind();
+	indexBuffer.allocate(indices.constData(), indices.size()*sizeof(unsigned short));
+	indexBuffer.release();
+	StelApp::getInstance().getTextureManager().registerGLBuffer(this, "CometTailRenderer", vertices.size()*sizeof(GLfloat) + indices.size()*sizeof(unsigned short));
+	indexCount = indices.size();
+	flagAvailable = true;
+}
+
+bool CometTailRenderer::isUsable(const StelProjectorP& prj) const
+{
+	// Triangles crossing a discontinuity must be removed on the CPU
+	return flagEnabled && flagAvailable && !prj->hasDiscontinuity() && !prj->getForwardTransformShader().isEmpty();
+}
+
+QOpenGLShaderProgram* CometTailRenderer::getProgram(const QByteArray& projectorShader)
+{
+	QOpenGLShaderProgram* program = programs.value(projectorShader, Q_NULLPTR);
+	if (program)
+		return program;
+
+	// The shape is the one of Comet::computeParabola(), the extinction is computed as in StaticSphereRenderer
+	QOpenGLShader vshader(QOpenGLShader::Vertex);
+	const QByteArray vsrc =
+		"attribute highp vec3 unitVertex;\n"
+		"attribute mediump vec2 texCoord;\n"
+		"attribute mediump float meshPosition;\n"
+		"uniform mediump mat4 projectionMatrix;\n"
+		"uniform highp vec4 shape;\n"
+		"uniform highp mat4 modelToAltAz;\n"
+		"uniform mediump vec3 color;\n"
+		"uniform mediump float fadeToEnd;\n"
+		"uniform bool withExtinction;\n"
+		"uniform mediump float extinctionLog2Factor;\n"
+		"uniform mediump float undergroundMode;\n"
+		"varying mediump vec2 texc;\n"
+		"varying mediump vec3 outColor;\n"
+		+ projectorShader +
+		"float airmass(float cosZ)\n"
+		"{\n"
+		"    if (cosZ < -0.035)\n"
+		"    {\n"
+		"        if (undergroundMode < 0.5)\n"
+		"            return 0.0;\n"
+		"        if (undergroundMode < 1.5)\n"
+		"            return 42.0;\n"
+		"        cosZ = min(1.0, -0.035 - (cosZ + 0.035));\n"
+		"    }\n"
+		"    // Young 1994\n"
+		"    float nom = (1.002432*cosZ + 0.148386)*cosZ + 0.0096467;\n"
+		"    float denum = ((cosZ + 0.149864)*cosZ + 0.0102963)*cosZ + 0.000303978;\n"
+		"    return nom/denum;\n"
+		"}\n"
+		"void main(void)\n"
+		"{\n"
+		"    // shape: radius, length, z shift, x offset\n"
+		"    highp float z = shape.y*unitVertex.z + shape.z;\n"
+		"    highp vec3 vertex = vec3(shape.x*unitVertex.x + shape.w*z*z, shape.x*unitVertex.y, z);\n"
+		"    gl_Position = projectionMatrix * vec4(projectToViewport(vertex).xyz, 1.);\n"
+		"    texc = texCoord;\n"
+		"    outColor = color*(1. - fadeToEnd*meshPosition);\n"
+		"    if (withExtinction)\n"
+		"        outColor *= exp2(airmass(normalize((modelToAltAz*vec4(vertex, 1.)).xyz).z)*extinctionLog2Factor);\n"
+		"}\n";
+	vshader.compileSourceCode(vsrc);
+	if (!vshader.log().isEmpty()) { qWarning() << "CometTailRenderer::getProgram(): Warnings while compiling vshader: " << vshader.log(); }
+
+	QOpenGLShader fshader(QOpenGLShader::Fragment);
+	const char* fsrc =
+		"varying mediump vec2 texc;\n"
+		"varying mediump vec3 outColor;\n"
+		"uniform sampler2D tex;\n"
+		"void main(void)\n"
+		"{\n"
+		"    gl_FragColor = texture2D(tex, texc)*vec4(outColor, 1.);\n"
+		"}\n";
+	fshader.compileSourceCode(fsrc);
+	if (!fshader.log().isEmpty()) { qWarning() << "CometTailRenderer::getProgram(): Warnings while compiling fshader: " << fshader.log(); }
+
+	program = new QOpenGLShaderProgram();
+	program->addShader(&vshader);
+	program->addShader(&fshader);
+	if (!StelPainter::linkProg(program, "cometTailShader"))
+	{
+		// Do not try again, StelPainter will draw the tails
+		qWarning() << "CometTailRenderer: cannot link shader, comet tail buffers disabled";
+		flagAvailable = false;
+		delete program;
+		return Q_NULLPTR;
+	}
+	programs.insert(projectorShader, program);
+	return program;
+}
+
+void CometTailRenderer::draw(StelPainter* sPainter, const Shape& shape, const Vec3f& color, const Extinction* extinction,
+			     const Mat4d& modelToAltAz, float fadeToEnd)
+{
+	const StelProjectorP& prj = sPainter->getProjector();
+	QOpenGLShaderProgram* program = getProgram(prj->getForwardTransformShader());
+	if (!program)
+		return;
+
+	const Mat4f& m = prj->getProjectionMatrix();
+	const QMatrix4x4 qMat(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
+	const Mat4d& a = modelToAltAz;
+	const QMatrix4x4 qAltAz(a[0], a[4], a[8], a[12], a[1], a[5], a[9], a[13], a[2], a[6], a[10], a[14], a[3], a[7], a[11], a[15]);
+
+	program->bind();
+	program->setUniformValue("projectionMatrix", qMat);
+	program->setUniformValue("shape", shape.radius, shape.length, shape.zShift, shape.xOffset);
+	program->setUniformValue("modelToAltAz", qAltAz);
+	program->setUniformValue("color", color[0], color[1], color[2]);
+	program->setUniformValue("fadeToEnd", fadeToEnd);
+	program->setUniformValue("withExtinction", extinction!=Q_NULLPTR);
+	if (extinction)
+	{
+		// A drop of one magnitude is a factor 0.4, as in Comet::update()
+		program->setUniformValue("extinctionLog2Factor", extinction->getExtinctionCoefficient()*std::log2(0.4f));
+		program->setUniformValue("undergroundMode", (GLfloat)extinction->getUndergroundExtinctionMode());
+	}
+	program->setUniformValue("tex", 0);
+	prj->setForwardTransformUniforms(*program);
+
+	const int vertexLoc = program->attributeLocation("unitVertex");
+	const int texCoordLoc = program->attributeLocation("texCoord");
+	const int meshPositionLoc = program->attributeLocation("meshPosition");
+	vertexBuffer.bind();
+	program->setAttributeBuffer(vertexLoc, GL_FLOAT, 0, 3, 6*sizeof(GLfloat));
+	program->setAttributeBuffer(texCoordLoc, GL_FLOAT, 3*sizeof(GLfloat), 2, 6*sizeof(GLfloat));
+	program->setAttributeBuffer(meshPositionLoc, GL_FLOAT, 5*sizeof(GLfloat), 1, 6*sizeof(GLfloat));
+	program->enableAttributeArray(vertexLoc);
+	program->enableAttributeArray(texCoordLoc);
+	program->enableAttributeArray(meshPositionLoc);
+	indexBuffer.bind();
+	sPainter->glFuncs()->glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_SHORT, Q_NULLPTR);
+	indexBuffer.release();
+	program->disableAttributeArray(vertexLoc);
+	program->disableAttributeArray(texCoordLoc);
+	program->disableAttributeArray(meshPositionLoc);
+	vertexBuffer.release();
+	program->release();
+}
@@ -0,0 +1,92 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef COMETTAILRENDERER_HPP
+#define COMETTAILRENDERER_HPP
+
+#include "StelProjectorType.hpp"
+#include "VecMath.hpp"
+
+#include <QByteArray>
+#include <QHash>
+#include <QOpenGLBuffer>
+#include <QVector>
+
+class StelPainter;
+class Extinction;
+class QOpenGLShaderProgram;
+
+//! @class CometTailRenderer
+//! Draws the tails of all comets from one normalised paraboloid mesh in static OpenGL buffers.
+//! The mesh is the tail of Comet::computeParabola() with a radius of 1 and a length of 1, and the vertex shader
+//! scales, shifts and bends it for each tail from uniforms, projects it with a shader generated from
+//! StelProjector::getForwardTransformShader(), and applies the extinction at each vertex. The CPU only sets the
+//! uniforms of each tail, however many comets are drawn.
+//! Projections which cannot be evaluated on the GPU, or which have discontinuities, must be drawn with StelPainter.
+class CometTailRenderer
+{
+public:
+	//! The shape of a tail: the paraboloid z=length*(x²+y²)/radius² + zShift, bent by xOffset*z² along x.
+	struct Shape
+	{
+		Shape() : radius(0.f), length(0.f), zShift(0.f), xOffset(0.f) {}
+		float radius;	//!< radius of the end of the tail [AU]
+		float length;	//!< length from the vertex of the paraboloid to the end of the tail [AU]
+		float zShift;	//!< position of the vertex on the axis [AU]
+		float xOffset;	//!< bend of the dust tail [1/AU]
+	};
+
+	CometTailRenderer();
+	//! Release the OpenGL buffers. Requires a valid context.
+	~CometTailRenderer();
+
+	//! Upload the mesh to static buffers, if it was not done yet. Requires a valid context.
+	//! @param unitVertices the vertices of the paraboloid of radius 1 and length 1, whose z is the square of the distance to the axis
+	//! @param texCoords the texture coordinates of the vertices
+	//! @param indices the triangles, shared by all tails
+	void init(const QVector<Vec3d>& unitVertices, const QVector<float>& texCoords, const QVector<unsigned short>& indices);
+
+	//! Get whether the static buffers can be used for drawing with the given projector.
+	bool isUsable(const StelProjectorP& prj) const;
+
+	//! Draw a tail with the texture currently bound and the blending and culling set in the painter.
+	//! @param sPainter the painter, whose projector has the frame of the tail: the head at the origin, the axis along z
+	//! @param shape the shape of the tail
+	//! @param color the color of the head
+	//! @param extinction the extinction to apply, or Q_NULLPTR to draw without extinction
+	//! @param modelToAltAz the transformation from the frame of the tail to positions relative to the observer in
+	//! the horizontal frame, used for extinction
+	//! @param fadeToEnd the brightness lost from the first to the last vertex of the mesh, e.g. in twilight
+	void draw(StelPainter* sPainter, const Shape& shape, const Vec3f& color, const Extinction* extinction = Q_NULLPTR,
+		  const Mat4d& modelToAltAz = Mat4d::identity(), float fadeToEnd = 0.f);
+
+private:
+	//! Get the shader program for a projector shader, compiling it on first use.
+	QOpenGLShaderProgram* getProgram(const QByteArray& projectorShader);
+
+	bool flagEnabled;
+	bool flagAvailable;
+	bool initialized;
+	int indexCount;
+	QOpenGLBuffer vertexBuffer;
+	QOpenGLBuffer indexBuffer;
+	QHash<QByteArray, QOpenGLShaderProgram*> programs;
+};
+
+#endif // COMETTAILRENDERER_HPP
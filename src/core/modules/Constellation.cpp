@@ -35,6 +35,7 @@
 #include <QTextStream>
 #include <QDebug>
 #include <QFontMetrics>
+#include <QVarLengthArray>
 
 const QString Constellation::CONSTELLATION_TYPE = QStringLiteral("Constellation");
 
@@ -51,6 +52,7 @@ Constellation::Constellation()
 	, endSeason(0)
 	, constellation(Q_NULLPTR)
 	, artOpacity(1.f)
+	, seasonallyVisible(true)
 {
 }
 
@@ -60,30 +62,24 @@ Constellation::~Constellation()
 	constellation = Q_NULLPTR;
 }
 
-bool Constellation::read(const QString& record, StarMgr *starMgr)
+bool Constellation::read(const QString& abb, const QVector<int>& stars, StarMgr *starMgr)
 {
-	unsigned int HP;
-
 	abbreviation.clear();
 	numberOfSegments = 0;
 
-	QString buf(record);
-	QTextStream istr(&buf, QIODevice::ReadOnly);
-	QString abb;
-	istr >> abb >> numberOfSegments;
-	if (istr.status()!=QTextStream::Ok)
+	if (abb.isEmpty() || stars.isEmpty() || stars.size()%2!=0)
 		return false;
 
 	// It's better to allow mixed-case abbreviations now that they can be displayed on screen. We then need toUpper() in comparisons.
 	//abbreviation = abb.toUpper();
 	abbreviation=abb;
+	numberOfSegments = stars.size()/2;
 
 	constellation = new StelObjectP[numberOfSegments*2];
 	for (unsigned int i=0;i<numberOfSegments*2;++i)
 	{
-		HP = 0;
-		istr >> HP;
-		if(HP == 0)
+		const int HP = stars.at(i);
+		if(HP <= 0)
 		{
 			// TODO: why is this delete commented?
 			// delete[] constellation;
@@ -117,17 +113,30 @@ void Constellation::drawOptim(StelPainter& sPainter, const StelCore* core, const
 
 	if (checkVisibility())
 	{
-		sPainter.setColor(lineColor[0], lineColor[1], lineColor[2], lineFader.getInterstate());
+		// The stars move with the date, so the cap enclosing them is computed at each draw. The constellations
+		// outside of the viewport are skipped without clipping each of their segments.
+		QVarLengthArray<Vec3d, 64> stars(numberOfSegments*2);
+		Vec3d center(0.);
+		for (unsigned int i=0;i<numberOfSegments*2;++i)
+		{
+			stars[i]=constellation[i]->getJ2000EquatorialPos(core);
+			stars[i].normalize();
+			center+=stars[i];
+		}
+		if (center.lengthSquared()>1e-6)
+		{
+			center.normalize();
+			double d = 1.;
+			for (const auto& star : stars)
+				d = qMin(d, star*center);
+			if (!viewportHalfspace.intersects(SphericalCap(center, d)))
+				return;
+		}
 
-		Vec3d star1;
-		Vec3d star2;
+		sPainter.setColor(lineColor[0], lineColor[1], lineColor[2], lineFader.getInterstate());
 		for (unsigned int i=0;i<numberOfSegments;++i)
 		{
-			star1=constellation[2*i]->getJ2000EquatorialPos(core);
-			star2=constellation[2*i+1]->getJ2000EquatorialPos(core);
-			star1.normalize();
-			star2.normalize();			
-			sPainter.drawGreatCircleArc(star1, star2, &viewportHalfspace);			
+			sPainter.drawGreatCircleArc(stars[2*i], stars[2*i+1], &viewportHalfspace);
 		}
 	}
 }
@@ -226,11 +235,14 @@ void Constellation::drawBoundaryOptim(StelPainter& sPainter) const
 
 	if (singleSelected) size = isolatedBoundarySegments.size();
 	else size = sharedBoundarySegments.size();
+	const std::vector<SphericalCap>& caps = singleSelected ? isolatedBoundaryCaps : sharedBoundaryCaps;
 
 	const SphericalCap& viewportHalfspace = sPainter.getProjector()->getBoundingCap();
 
 	for (i=0;i<size;i++)
 	{
+		if (i<caps.size() && !viewportHalfspace.intersects(caps[i]))
+			continue;
 		if (singleSelected) points = isolatedBoundarySegments[i];
 		else points = sharedBoundarySegments[i];
 
@@ -241,30 +253,25 @@ void Constellation::drawBoundaryOptim(StelPainter& sPainter) const
 	}
 }
 
-bool Constellation::checkVisibility() const
+void Constellation::updateVisibility(int month)
 {
 	// Is supported seasonal rules by current starlore?
-	if (!seasonalRuleEnabled)
-		return true;
+	if (month<=0)
+	{
+		seasonallyVisible = true;
+		return;
+	}
 
-	bool visible = false;
-	int year, month, day;
-	// Get the current month
-	StelUtils::getDateFromJulianDay(StelApp::getInstance().getCore()->getJD(), &year, &month, &day);
 	if (endSeason >= beginSeason)
 	{
 		// OK, it's a "normal" season rule...
-		if ((month >= beginSeason) && (month <= endSeason))
-			visible = true;
+		seasonallyVisible = (month >= beginSeason) && (month <= endSeason);
 	}
 	else
 	{
 		// ...oops, it's a "inverted" season rule
-		if (((month>=1) && (month<=endSeason)) || ((month>=beginSeason) && (month<=12)))
-			visible = true;
-
+		seasonallyVisible = ((month>=1) && (month<=endSeason)) || ((month>=beginSeason) && (month<=12));
 	}
-	return visible;
 }
 
 QString Constellation::getInfoString(const StelCore *core, const InfoStringGroup &flags) const
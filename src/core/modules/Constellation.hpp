@@ -31,6 +31,7 @@
 
 #include <vector>
 #include <QString>
+#include <QVector>
 #include <QFont>
 
 class StarMgr;
@@ -74,14 +75,12 @@ private:
 
 	virtual double getAngularSize(const StelCore*) const {Q_ASSERT(0); return 0.;} // TODO
 
-	//! @param record string containing the following whitespace
-	//! separated fields: abbreviation - a three character abbreviation
-	//! for the constellation, a number of lines (pairs), and a list of Hipparcos
-	//! catalogue numbers which, when connected pairwise, form the lines of the
-	//! constellation.
+	//! @param abb a three character abbreviation for the constellation.
+	//! @param stars a list of Hipparcos catalogue numbers which, when connected pairwise,
+	//! form the lines of the constellation (see ConstellationData::Lines).
 	//! @param starMgr a pointer to the StarManager object.
-	//! @return false if can't parse record, else true.
-	bool read(const QString& record, StarMgr *starMgr);
+	//! @return false if the stars are not valid, else true.
+	bool read(const QString& abb, const QVector<int>& stars, StarMgr *starMgr);
 
 	//! Draw the constellation name
 	void drawName(StelPainter& sPainter, ConstellationMgr::ConstellationDisplayStyle style) const;
@@ -144,7 +143,10 @@ private:
 
 	//! Check visibility of starlore elements (using for seasonal rules)
 	//! @return true if starlore elements rendering it turned on, else false.
-	bool checkVisibility() const;
+	bool checkVisibility() const {return seasonallyVisible;}
+	//! Apply the seasonal rule for a month of the current date, done once per frame by ConstellationMgr::update().
+	//! @param month the month [1..12], or 0 if the sky culture has no seasonal rules
+	void updateVisibility(int month);
 
 	//! International name (translated using gettext)
 	QString nameI18;
@@ -181,6 +183,11 @@ private:
 	float artOpacity;
 	std::vector<std::vector<Vec3d> *> isolatedBoundarySegments;
 	std::vector<std::vector<Vec3d> *> sharedBoundarySegments;
+	//! Caps enclosing the boundary segments, in the same order, to skip the segments outside of the viewport at once
+	std::vector<SphericalCap> isolatedBoundaryCaps;
+	std::vector<SphericalCap> sharedBoundaryCaps;
+	//! Result of the seasonal rule for the current date
+	bool seasonallyVisible;
 
 	//! Currently we only need one color for all constellations, this may change at some point
 	static Vec3f lineColor;
@@ -0,0 +1,536 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "ConstellationData.hpp"
+#include "StelFileMgr.hpp"
+#include "StelUtils.hpp"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QRegExp>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <stdexcept>
+
+namespace
+{
+	const quint32 CACHE_MAGIC = 0x53434331; // "SCC1"
+	const qint32 CACHE_FORMAT = 1;
+	// lines to ignore which start with a # or are empty
+	const char* COMMENT_PATTERN = "^(\\s*#.*|\\s*)$";
+}
+
+QDataStream& operator<<(QDataStream& out, const ConstellationData::Lines& l)
+{
+	return out << l.abbreviation << l.stars << l.lineNumber;
+}
+
+QDataStream& operator>>(QDataStream& in, ConstellationData::Lines& l)
+{
+	return in >> l.abbreviation >> l.stars >> l.lineNumber;
+}
+
+QDataStream& operator<<(QDataStream& out, const ConstellationData::Name& n)
+{
+	return out << n.abbreviation << n.nativeName << n.englishName << n.context;
+}
+
+QDataStream& operator>>(QDataStream& in, ConstellationData::Name& n)
+{
+	return in >> n.abbreviation >> n.nativeName >> n.englishName >> n.context;
+}
+
+QDataStream& operator<<(QDataStream& out, const ConstellationData::SeasonalRule& r)
+{
+	return out << r.abbreviation << r.beginSeason << r.endSeason;
+}
+
+QDataStream& operator>>(QDataStream& in, ConstellationData::SeasonalRule& r)
+{
+	return in >> r.abbreviation >> r.beginSeason >> r.endSeason;
+}
+
+QDataStream& operator<<(QDataStream& out, const ConstellationData::Art& a)
+{
+	out << a.abbreviation << a.texturePath << a.textureWidth << a.textureHeight;
+	for (int i=0; i<3; ++i)
+		out << a.x[i] << a.y[i] << a.hip[i];
+	return out << a.lineNumber;
+}
+
+QDataStream& operator>>(QDataStream& in, ConstellationData::Art& a)
+{
+	in >> a.abbreviation >> a.texturePath >> a.textureWidth >> a.textureHeight;
+	for (int i=0; i<3; ++i)
+		in >> a.x[i] >> a.y[i] >> a.hip[i];
+	return in >> a.lineNumber;
+}
+
+QDataStream& operator<<(QDataStream& out, const ConstellationData::Boundary& b)
+{
+	out << static_cast<qint32>(b.points.size());
+	for (const auto& p : b.points)
+		out << p[0] << p[1] << p[2];
+	return out << b.constellations;
+}
+
+QDataStream& operator>>(QDataStream& in, ConstellationData::Boundary& b)
+{
+	qint32 count = 0;
+	in >> count;
+	if (count<0 || in.status()!=QDataStream::Ok)
+	{
+		in.setStatus(QDataStream::ReadCorruptData);
+		return in;
+	}
+	b.points.resize(count);
+	for (auto& p : b.points)
+		in >> p[0] >> p[1] >> p[2];
+	return in >> b.constellations;
+}
+
+QDataStream& operator<<(QDataStream& out, const ConstellationData::Source& s)
+{
+	return out << s.path << s.size << s.modified;
+}
+
+QDataStream& operator>>(QDataStream& in, ConstellationData::Source& s)
+{
+	return in >> s.path >> s.size >> s.modified;
+}
+
+ConstellationData::Source ConstellationData::source(const QString& path)
+{
+	Source s;
+	s.path = path;
+	s.size = -1;
+	s.modified = 0;
+	if (!path.isEmpty())
+	{
+		const QFileInfo info(path);
+		s.size = info.size();
+		s.modified = info.lastModified().toMSecsSinceEpoch();
+	}
+	return s;
+}
+
+bool ConstellationData::isUpToDate(const Source& s)
+{
+	const Source current = source(s.path);
+	return current.size==s.size && current.modified==s.modified;
+}
+
+ConstellationData ConstellationData::load(const QString& skyCultureDir, int boundariesIdx)
+{
+	ConstellationData data;
+	data.skyCultureDir = skyCultureDir;
+
+	const QString prefix = "skycultures/" + skyCultureDir;
+	const QString linesFile = StelFileMgr::findFile(prefix + "/constellationship.fab");
+	const QString namesFile = StelFileMgr::findFile(prefix + "/constellation_names.eng.fab");
+	const QString rulesFile = StelFileMgr::findFile(prefix + "/seasonal_rules.fab");
+	const QString artFile = StelFileMgr::findFile(prefix + "/constellationsart.fab");
+	QString boundariesFile;
+	if (boundariesIdx==1) // boundaries = own
+		boundariesFile = StelFileMgr::findFile(prefix + "/constellations_boundaries.dat");
+	else if (boundariesIdx>=0) // boundaries = generic
+		boundariesFile = StelFileMgr::findFile("data/constellations_boundaries.dat");
+
+	// A file which was found since the cache was written changes the paths, and so invalidates the cache.
+	QVector<Source> sources;
+	sources << source(linesFile) << source(namesFile) << source(rulesFile) << source(artFile) << source(boundariesFile);
+	const QString cacheFile = StelFileMgr::getCacheDir() + "/skycultures/" + skyCultureDir + "/constellations.cache";
+	if (data.readCache(cacheFile, sources))
+	{
+		qDebug() << "Loaded constellations of sky culture" << skyCultureDir << "from cache";
+		return data;
+	}
+
+	if (linesFile.isEmpty())
+		qWarning() << "ERROR loading constellation lines and art from file: " << linesFile;
+	else
+		data.readLines(linesFile);
+
+	if (namesFile.isEmpty())
+		qWarning() << "ERROR loading constellation names from file: " << namesFile;
+	else
+		data.readNames(namesFile);
+
+	data.readSeasonalRules(rulesFile);
+
+	// Find constellation art.  If this doesn't exist, warn, but continue (just loads lines).
+	if (artFile.isEmpty())
+		qDebug() << "No constellationsart.fab file found for sky culture dir" << QDir::toNativeSeparators(skyCultureDir);
+	else
+		data.readArt(artFile, sources);
+
+	if (boundariesIdx>=0)
+	{
+		// OK, the current sky culture has boundaries!
+		if (boundariesFile.isEmpty())
+			qWarning() << "ERROR loading constellation boundaries file: " << boundariesFile;
+		else
+			data.hasBoundaries = data.readBoundaries(boundariesFile);
+	}
+
+	if (data.linesFileFound)
+		data.writeCache(cacheFile, sources);
+	return data;
+}
+
+void ConstellationData::readLines(const QString& fileName)
+{
+	QFile in(fileName);
+	if (!in.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		qWarning() << "Can't open constellation data file" << QDir::toNativeSeparators(fileName)  << "for culture" << skyCultureDir;
+		return;
+	}
+	linesFileFound = true;
+
+	// read the file of line patterns, a record per non-comment line
+	int currentLineNumber = 0;	// line in file
+	QRegExp commentRx(COMMENT_PATTERN);
+	while (!in.atEnd())
+	{
+		const QString record = QString::fromUtf8(in.readLine());
+		currentLineNumber++;
+		if (commentRx.exactMatch(record))
+			continue;
+
+		Lines l;
+		l.lineNumber = currentLineNumber;
+		QString buf(record);
+		QTextStream istr(&buf, QIODevice::ReadOnly);
+		unsigned int numberOfSegments = 0;
+		istr >> l.abbreviation >> numberOfSegments;
+		if (istr.status()==QTextStream::Ok)
+		{
+			l.stars.reserve(numberOfSegments*2);
+			for (unsigned int i=0;i<numberOfSegments*2;++i)
+			{
+				int HP = 0;
+				istr >> HP;
+				l.stars << HP;
+			}
+		}
+		// invalid records are kept and reported when the constellations are built, with the line number
+		lines << l;
+	}
+}
+
+void ConstellationData::readNames(const QString& fileName)
+{
+	QFile commonNameFile(fileName);
+	if (!commonNameFile.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		qDebug() << "Cannot open file" << QDir::toNativeSeparators(fileName);
+		return;
+	}
+
+	// lines which look like records - we use the RE to extract the fields
+	// which will be available in recRx.capturedTexts()
+	// abbreviation is allowed to start with a dot to mark as "hidden".
+	QRegExp recRx("^\\s*(\\.?\\w+)\\s+\"(.*)\"\\s+_[(]\"(.*)\"[)]\\n");
+	QRegExp ctxRx("(.*)\",\\s*\"(.*)");
+
+	int lineNumber=0;
+	QRegExp commentRx(COMMENT_PATTERN);
+	while (!commonNameFile.atEnd())
+	{
+		const QString record = QString::fromUtf8(commonNameFile.readLine());
+		lineNumber++;
+
+		// Skip comments
+		if (commentRx.exactMatch(record))
+			continue;
+
+		if (!recRx.exactMatch(record))
+		{
+			qWarning() << "ERROR - cannot parse record at line" << lineNumber << "in constellation names file" << QDir::toNativeSeparators(fileName) << ":" << record;
+			continue;
+		}
+
+		Name n;
+		n.abbreviation = recRx.capturedTexts().at(1);
+		n.nativeName = recRx.capturedTexts().at(2);
+		const QString ctxt = recRx.capturedTexts().at(3);
+		if (ctxRx.exactMatch(ctxt))
+		{
+			n.englishName = ctxRx.capturedTexts().at(1);
+			n.context = ctxRx.capturedTexts().at(2);
+		}
+		else
+		{
+			n.englishName = ctxt;
+		}
+		// Some skycultures already have empty nativeNames. Fill those.
+		if (n.nativeName.isEmpty())
+			n.nativeName = n.englishName;
+		names << n;
+	}
+}
+
+void ConstellationData::readSeasonalRules(const QString& fileName)
+{
+	// Current starlore didn't support the seasonal rules
+	if (fileName.isEmpty())
+		return;
+	hasSeasonalRules = true;
+
+	QFile seasonalRulesFile(fileName);
+	if (!seasonalRulesFile.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		qDebug() << "Cannot open file" << QDir::toNativeSeparators(fileName);
+		return;
+	}
+
+	// lines which look like records - we use the RE to extract the fields
+	// which will be available in recRx.capturedTexts()
+	QRegExp recRx("^\\s*(\\w+)\\s+(\\w+)\\s+(\\w+)\\n");
+
+	int lineNumber=0;
+	QRegExp commentRx(COMMENT_PATTERN);
+	while (!seasonalRulesFile.atEnd())
+	{
+		const QString record = QString::fromUtf8(seasonalRulesFile.readLine());
+		lineNumber++;
+
+		// Skip comments
+		if (commentRx.exactMatch(record))
+			continue;
+
+		if (!recRx.exactMatch(record))
+		{
+			qWarning() << "ERROR - cannot parse record at line" << lineNumber << "in seasonal rules file" << QDir::toNativeSeparators(fileName);
+			continue;
+		}
+
+		SeasonalRule r;
+		r.abbreviation = recRx.capturedTexts().at(1);
+		r.beginSeason = recRx.capturedTexts().at(2).toInt();
+		r.endSeason = recRx.capturedTexts().at(3).toInt();
+		seasonalRules << r;
+	}
+}
+
+void ConstellationData::readArt(const QString& fileName, QVector<Source>& textures)
+{
+	QFile fic(fileName);
+	if (!fic.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		qWarning() << "Can't open constellation art file" << QDir::toNativeSeparators(fileName)  << "for culture" << skyCultureDir;
+		return;
+	}
+
+	// Read the constellation art file with the following format :
+	// ShortName texture_file x1 y1 hp1 x2 y2 hp2
+	// Where :
+	// shortname is the international short name (i.e "Lep" for Lepus)
+	// texture_file is the graphic file of the art texture
+	// x1 y1 are the x and y texture coordinates in pixels of the star of hipparcos number hp1
+	// x2 y2 are the x and y texture coordinates in pixels of the star of hipparcos number hp2
+	// The coordinate are taken with (0,0) at the top left corner of the image file
+	QString texfile;
+	int currentLineNumber = 0;	// line in file
+	QRegExp commentRx(COMMENT_PATTERN);
+	while (!fic.atEnd())
+	{
+		++currentLineNumber;
+		QString record = QString::fromUtf8(fic.readLine());
+		if (commentRx.exactMatch(record))
+			continue;
+
+		// prevent leaving zeros on numbers from being interpretted as octal numbers
+		record.replace(" 0", " ");
+		QTextStream rStr(&record);
+		Art a;
+		a.lineNumber = currentLineNumber;
+		rStr >> a.abbreviation >> texfile;
+		for (int i=0; i<3; ++i)
+			rStr >> a.x[i] >> a.y[i] >> a.hip[i];
+		if (rStr.status()!=QTextStream::Ok)
+		{
+			qWarning() << "ERROR parsing constellation art record at line" << currentLineNumber << "of art file for culture" << skyCultureDir;
+			continue;
+		}
+
+		a.texturePath = StelFileMgr::findFile("skycultures/"+skyCultureDir+"/"+texfile);
+		a.textureWidth = a.textureHeight = 0;
+		if (a.texturePath.isEmpty())
+		{
+			qWarning() << "ERROR: could not find texture, " << QDir::toNativeSeparators(texfile);
+		}
+		else
+		{
+			// Only reads the header of the image, the texture itself is loaded by the texture manager
+			const QSize size = QImageReader(a.texturePath).size();
+			if (size.isValid())
+			{
+				a.textureWidth = size.width();
+				a.textureHeight = size.height();
+			}
+			textures << source(a.texturePath);
+		}
+		art << a;
+	}
+}
+
+bool ConstellationData::readBoundaries(const QString& fileName)
+{
+	// Modified boundary file by Torsten Bronger with permission
+	// http://pp3.sourceforge.net
+	QFile dataFile(fileName);
+	if (!dataFile.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		qWarning() << "Boundary file " << QDir::toNativeSeparators(fileName) << " not found";
+		return false;
+	}
+
+	// Added support of comments for constellations_boundaries.dat file
+	QString data;
+	QRegExp commentRx(COMMENT_PATTERN);
+	while (!dataFile.atEnd())
+	{
+		// Read the line
+		const QString record = QString::fromUtf8(dataFile.readLine());
+
+		// Skip comments
+		if (commentRx.exactMatch(record))
+			continue;
+
+		// Append the data
+		data.append(record);
+	}
+
+	// Read and parse the data without comments
+	QTextStream istr(&data);
+	double DE, RA;
+	Vec3d XYZ;
+	QString consname;
+	while (!istr.atEnd())
+	{
+		unsigned int num = 0;
+		istr >> num;
+		if(num == 0)
+			continue; // empty line
+
+		Boundary b;
+		b.points.reserve(num);
+		for (unsigned int j=0;j<num;j++)
+		{
+			istr >> RA >> DE;
+
+			RA*=M_PI/12.;     // Convert from hours to rad
+			DE*=M_PI/180.;    // Convert from deg to rad
+
+			// Calc the Cartesian coord with RA and DE
+			StelUtils::spheToRect(RA,DE,XYZ);
+			b.points << XYZ;
+		}
+
+		// there are 2 constellations per boundary
+		unsigned int numc = 0;
+		istr >> numc;
+		for (unsigned int j=0;j<numc;j++)
+		{
+			istr >> consname;
+			// not used?
+			if (consname == "SER1" || consname == "SER2") consname = "SER";
+			b.constellations << consname;
+		}
+		boundaries << b;
+	}
+	return true;
+}
+
+bool ConstellationData::readCache(const QString& cacheFile, const QVector<Source>& sources)
+{
+	QFile file(cacheFile);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+	QDataStream in(&file);
+	in.setVersion(QDataStream::Qt_5_4);
+
+	quint32 magic = 0;
+	qint32 format = 0;
+	in >> magic >> format;
+	if (magic!=CACHE_MAGIC || format!=CACHE_FORMAT)
+		return false;
+
+	// The source files are followed by the textures of the art
+	QVector<Source> cachedSources;
+	in >> cachedSources;
+	if (in.status()!=QDataStream::Ok || cachedSources.size()<sources.size())
+		return false;
+	for (int i=0; i<cachedSources.size(); ++i)
+	{
+		if ((i<sources.size() && cachedSources.at(i).path!=sources.at(i).path) || !isUpToDate(cachedSources.at(i)))
+		{
+			qDebug() << "Constellations cache" << QDir::toNativeSeparators(cacheFile) << "is outdated";
+			return false;
+		}
+	}
+
+	in >> linesFileFound >> hasSeasonalRules >> hasBoundaries >> lines >> names >> seasonalRules >> art >> boundaries;
+	if (in.status()!=QDataStream::Ok)
+	{
+		qWarning() << "Constellations cache" << QDir::toNativeSeparators(cacheFile) << "is corrupted";
+		linesFileFound = hasSeasonalRules = hasBoundaries = false;
+		lines.clear();
+		names.clear();
+		seasonalRules.clear();
+		art.clear();
+		boundaries.clear();
+		return false;
+	}
+	return true;
+}
+
+void ConstellationData::writeCache(const QString& cacheFile, const QVector<Source>& sources) const
+{
+	try
+	{
+		StelFileMgr::makeSureDirExistsAndIsWritable(QFileInfo(cacheFile).absolutePath());
+	}
+	catch (std::runtime_error& e)
+	{
+		qWarning() << "Cannot create constellations cache directory:" << e.what();
+		return;
+	}
+
+	// Written in a temporary file, a sky culture loaded at the same time never reads a partial cache
+	QSaveFile file(cacheFile);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		qWarning() << "Cannot write constellations cache" << QDir::toNativeSeparators(cacheFile);
+		return;
+	}
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_5_4);
+	out << CACHE_MAGIC << CACHE_FORMAT << sources;
+	out << linesFileFound << hasSeasonalRules << hasBoundaries << lines << names << seasonalRules << art << boundaries;
+	if (out.status()!=QDataStream::Ok || !file.commit())
+		qWarning() << "Cannot write constellations cache" << QDir::toNativeSeparators(cacheFile);
+}
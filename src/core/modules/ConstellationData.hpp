@@ -0,0 +1,126 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef CONSTELLATIONDATA_HPP
+#define CONSTELLATIONDATA_HPP
+
+#include "VecMath.hpp"
+
+#include <QDataStream>
+#include <QString>
+#include <QVector>
+
+//! @class ConstellationData
+//! The parsed constellation files of a sky culture: lines, names, seasonal rules, art and boundaries.
+//! load() only reads files, it does not use the modules, so that a sky culture can be read in a worker thread
+//! while the current one is still displayed. ConstellationMgr then builds its constellations from it.
+//! The parsed data is kept in a binary file in the cache directory, which is used as long as the source files
+//! keep their size and modification time.
+class ConstellationData
+{
+public:
+	//! A record of constellationship.fab: the lines of a constellation, as pairs of HIP numbers.
+	struct Lines
+	{
+		QString abbreviation;
+		QVector<int> stars;
+		int lineNumber;
+	};
+
+	//! A record of constellation_names.eng.fab
+	struct Name
+	{
+		QString abbreviation;
+		QString nativeName;
+		QString englishName;
+		QString context;
+	};
+
+	//! A record of seasonal_rules.fab
+	struct SeasonalRule
+	{
+		QString abbreviation;
+		int beginSeason;
+		int endSeason;
+	};
+
+	//! A record of constellationsart.fab, with the texture coordinates of three stars.
+	//! The size of the texture is read with the record, so that the art is placed without waiting for the texture.
+	struct Art
+	{
+		QString abbreviation;
+		QString texturePath;
+		int textureWidth;
+		int textureHeight;
+		int x[3];
+		int y[3];
+		int hip[3];
+		int lineNumber;
+	};
+
+	//! A segment of constellations_boundaries.dat, and the constellations it separates.
+	struct Boundary
+	{
+		QVector<Vec3d> points;
+		QVector<QString> constellations;
+	};
+
+	ConstellationData() : linesFileFound(false), hasSeasonalRules(false), hasBoundaries(false) {}
+
+	//! Read the constellation files of a sky culture, from the cache directory when they did not change.
+	//! @param skyCultureDir the directory of the sky culture
+	//! @param boundariesIdx see StelSkyCultureMgr::getCurrentSkyCultureBoundariesIdx()
+	static ConstellationData load(const QString& skyCultureDir, int boundariesIdx);
+
+	QString skyCultureDir;
+	bool linesFileFound;
+	bool hasSeasonalRules;
+	bool hasBoundaries;
+	QVector<Lines> lines;
+	QVector<Name> names;
+	QVector<SeasonalRule> seasonalRules;
+	QVector<Art> art;
+	QVector<Boundary> boundaries;
+
+private:
+	//! A source file and its state when it was parsed
+	struct Source
+	{
+		QString path;
+		qint64 size;
+		qint64 modified;
+	};
+
+	void readLines(const QString& fileName);
+	void readNames(const QString& fileName);
+	void readSeasonalRules(const QString& fileName);
+	void readArt(const QString& fileName, QVector<Source>& textures);
+	bool readBoundaries(const QString& fileName);
+
+	bool readCache(const QString& cacheFile, const QVector<Source>& sources);
+	void writeCache(const QString& cacheFile, const QVector<Source>& sources) const;
+
+	static Source source(const QString& path);
+	static bool isUpToDate(const Source& s);
+
+	friend QDataStream& operator<<(QDataStream& out, const Source& s);
+	friend QDataStream& operator>>(QDataStream& in, Source& s);
+};
+
+#endif // CONSTELLATIONDATA_HPP
@@ -21,6 +21,7 @@
 
 #include "ConstellationMgr.hpp"
 #include "Constellation.hpp"
+#include "ConstellationData.hpp"
 #include "StarMgr.hpp"
 #include "StelUtils.hpp"
 #include "StelApp.hpp"
@@ -45,6 +46,9 @@
 #include <QString>
 #include <QStringList>
 #include <QDir>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QtConcurrent>
 
 using namespace std;
 
@@ -62,7 +66,8 @@ ConstellationMgr::ConstellationMgr(StarMgr *_hip_stars)
 	  boundariesDisplayed(0),
 	  linesDisplayed(0),
 	  namesDisplayed(0),
-	  constellationLineThickness(1)
+	  constellationLineThickness(1),
+	  skyCultureWatcher(Q_NULLPTR)
 {
 	setObjectName("ConstellationMgr");
 	Q_ASSERT(hipStarMgr);
@@ -70,6 +75,10 @@ ConstellationMgr::ConstellationMgr(StarMgr *_hip_stars)
 
 ConstellationMgr::~ConstellationMgr()
 {
+	// The files may still be read in the background
+	if (skyCultureWatcher)
+		skyCultureWatcher->waitForFinished();
+
 	for (auto* constellation : constellations)
 	{
 		delete constellation;
@@ -87,6 +96,8 @@ void ConstellationMgr::init()
 	Q_ASSERT(conf);
 
 	lastLoadedSkyCulture = "dummy";
+	skyCultureWatcher = new QFutureWatcher<ConstellationData>(this);
+	connect(skyCultureWatcher, SIGNAL(finished()), this, SLOT(skyCultureLoaded()));
 	asterFont.setPixelSize(conf->value("viewing/constellation_font_size", 14).toInt());
 	setFlagLines(conf->value("viewing/flag_constellation_drawing").toBool());
 	setFlagLabels(conf->value("viewing/flag_constellation_name").toBool());
@@ -160,6 +171,8 @@ double ConstellationMgr::getCallOrder(StelModuleActionName actionName) const
 
 void ConstellationMgr::reloadSkyCulture()
 {
+	// The files are read again if they changed, else from the cache
+	lastLoadedSkyCulture.clear();
 	updateSkyCulture(StelApp::getInstance().getSkyCultureMgr().getCurrentSkyCultureID());
 }
 
@@ -167,63 +180,267 @@ void ConstellationMgr::updateSkyCulture(const QString& skyCultureDir)
 {
 	// Check if the sky culture changed since last load, if not don't load anything
 	if (lastLoadedSkyCulture == skyCultureDir)
+	{
+		// A sky culture still being read is not wanted anymore
+		requestedSkyCulture.clear();
+		return;
+	}
+	if (requestedSkyCulture == skyCultureDir)
 		return;
 
-	// Find constellation art.  If this doesn't exist, warn, but continue using ""
-	// the loadLinesAndArt function knows how to handle this (just loads lines).
-	QString conArtFile = StelFileMgr::findFile("skycultures/"+skyCultureDir+"/constellationsart.fab");
-	if (conArtFile.isEmpty())
+	const int boundariesIdx = StelApp::getInstance().getSkyCultureMgr().getCurrentSkyCultureBoundariesIdx();
+	QFuture<ConstellationData> future = QtConcurrent::run(&ConstellationData::load, skyCultureDir, boundariesIdx);
+	if (lastLoadedSkyCulture == "dummy")
 	{
-		qDebug() << "No constellationsart.fab file found for sky culture dir" << QDir::toNativeSeparators(skyCultureDir);
+		// The first sky culture is needed before the startup script runs
+		requestedSkyCulture.clear();
+		applyConstellationData(future.result());
+		return;
 	}
 
-	// first of all, remove constellations from the list of selected objects in StelObjectMgr, since we are going to delete them
-	deselectConstellations();
+	// The current constellations are displayed until the new ones are ready, and a newer request replaces this one
+	requestedSkyCulture = skyCultureDir;
+	skyCultureWatcher->setFuture(future);
+}
 
-	QString fic = StelFileMgr::findFile("skycultures/"+skyCultureDir+"/constellationship.fab");
-	if (fic.isEmpty())
-		qWarning() << "ERROR loading constellation lines and art from file: " << fic;
-	else
-		loadLinesAndArt(fic, conArtFile, skyCultureDir);
+void ConstellationMgr::skyCultureLoaded()
+{
+	const ConstellationData data = skyCultureWatcher->result();
+	if (data.skyCultureDir != requestedSkyCulture)
+		return;
+	requestedSkyCulture.clear();
+	applyConstellationData(data);
+}
 
-	// load constellation names
-	fic = StelFileMgr::findFile("skycultures/" + skyCultureDir + "/constellation_names.eng.fab");
-	if (fic.isEmpty())
-		qWarning() << "ERROR loading constellation names from file: " << fic;
-	else
-		loadNames(fic);
+void ConstellationMgr::applyConstellationData(const ConstellationData& data)
+{
+	const QString& cultureName = data.skyCultureDir;
+	StelCore* core = StelApp::getInstance().getCore();
 
-	// load seasonal rules
-	loadSeasonalRules(StelFileMgr::findFile("skycultures/" + skyCultureDir + "/seasonal_rules.fab"));
+	// Build the new constellations aside, the current ones are replaced at once at the end
+	std::vector<Constellation*> newConstellations;
+	QHash<QString, Constellation*> byAbbreviation;
+	auto findNew = [&byAbbreviation](const QString& abbreviation) {
+		return byAbbreviation.value(abbreviation.toUpper(), Q_NULLPTR);
+	};
 
-	// Translate constellation names for the new sky culture
-	updateI18n();
+	int readOk = 0;			// count of records processed OK
+	for (const auto& lines : data.lines)
+	{
+		Constellation* cons = new Constellation;
+		if (cons->read(lines.abbreviation, lines.stars, hipStarMgr))
+		{
+			cons->artOpacity = artIntensity;
+			cons->artFader.setDuration((int) (artFadeDuration * 1000.f));
+			cons->setFlagArt(artDisplayed);
+			cons->setFlagBoundaries(boundariesDisplayed);
+			cons->setFlagLines(linesDisplayed);
+			cons->setFlagLabels(namesDisplayed);
+			newConstellations.push_back(cons);
+			// the first one wins, like in findFromAbbreviation()
+			if (!byAbbreviation.contains(cons->abbreviation.toUpper()))
+				byAbbreviation.insert(cons->abbreviation.toUpper(), cons);
+			++readOk;
+		}
+		else
+		{
+			qWarning() << "ERROR reading constellation lines record at line " << lines.lineNumber << "for culture" << cultureName;
+			delete cons;
+		}
+	}
+	if (data.linesFileFound)
+		qDebug() << "Loaded" << readOk << "/" << data.lines.size() << "constellation records successfully for culture" << cultureName;
 
-	// load constellation boundaries
-	StelApp *app = &StelApp::getInstance();
-	int idx = app->getSkyCultureMgr().getCurrentSkyCultureBoundariesIdx();
-	if (idx>=0)
+	// names
+	readOk = 0;
+	for (const auto& name : data.names)
 	{
-		// OK, the current sky culture has boundaries!
-		if (idx==1)
+		Constellation* aster = findNew(name.abbreviation);
+		// If the constellation exists, set the English name
+		if (aster != Q_NULLPTR)
 		{
-			// boundaries = own
-			fic = StelFileMgr::findFile("skycultures/" + skyCultureDir + "/constellations_boundaries.dat");
+			aster->nativeName = name.nativeName;
+			aster->englishName = name.englishName;
+			aster->context = name.context;
+			readOk++;
 		}
 		else
 		{
-			// boundaries = generic
-			fic = StelFileMgr::findFile("data/constellations_boundaries.dat");
+			qWarning() << "WARNING - constellation abbreviation" << name.abbreviation << "not found when loading constellation names";
 		}
+	}
+	if (!newConstellations.empty())
+		qDebug() << "Loaded" << readOk << "/" << data.names.size() << "constellation names";
 
-		if (fic.isEmpty())
-			qWarning() << "ERROR loading constellation boundaries file: " << fic;
+	// seasonal rules
+	for (auto* constellation : newConstellations)
+	{
+		constellation->beginSeason = 1;
+		constellation->endSeason = 12;
+	}
+	Constellation::seasonalRuleEnabled = data.hasSeasonalRules && !newConstellations.empty();
+	readOk = 0;
+	for (const auto& rule : data.seasonalRules)
+	{
+		Constellation* aster = findNew(rule.abbreviation);
+		if (aster != Q_NULLPTR)
+		{
+			aster->beginSeason = rule.beginSeason;
+			aster->endSeason = rule.endSeason;
+			readOk++;
+		}
 		else
-			loadBoundaries(fic);
+		{
+			qWarning() << "WARNING - constellation abbreviation" << rule.abbreviation << "not found when loading seasonal rules for constellations";
+		}
+	}
+	if (data.hasSeasonalRules && !newConstellations.empty())
+		qDebug() << "Loaded" << readOk << "/" << data.seasonalRules.size() << "seasonal rules";
+
+	// art
+	readOk = 0;
+	for (const auto& art : data.art)
+	{
+		Constellation* cons = findNew(art.abbreviation);
+		if (!cons)
+		{
+			qWarning() << "ERROR in constellation art file at line" << art.lineNumber << "for culture" << cultureName
+					   << "constellation" << art.abbreviation << "unknown";
+			continue;
+		}
+		StelObjectP stars[3];
+		for (int i=0; i<3; ++i)
+			stars[i] = hipStarMgr->searchHP(art.hip[i]);
+		if (!stars[0] || !stars[1] || !stars[2])
+		{
+			qWarning() << "ERROR in constellation art file at line" << art.lineNumber << "for culture" << cultureName
+					   << "star not found";
+			continue;
+		}
+
+		// The texture is loaded in the background, its size was read with the art file
+		cons->artTexture = StelApp::getInstance().getTextureManager().createTextureThread(art.texturePath);
+		const int texSizeX = art.textureWidth, texSizeY = art.textureHeight;
+		if (cons->artTexture==Q_NULLPTR || texSizeX<=0 || texSizeY<=0)
+		{
+			qWarning() << "Texture dimension not available";
+			continue;
+		}
+
+		Vec3d s1 = stars[0]->getJ2000EquatorialPos(core);
+		Vec3d s2 = stars[1]->getJ2000EquatorialPos(core);
+		Vec3d s3 = stars[2]->getJ2000EquatorialPos(core);
+		const int x1 = art.x[0], y1 = art.y[0], x2 = art.x[1], y2 = art.y[1], x3 = art.x[2], y3 = art.y[2];
+
+		// To transform from texture coordinate to 2d coordinate we need to find X with XA = B
+		// A formed of 4 points in texture coordinate, B formed with 4 points in 3d coordinate
+		// We need 3 stars and the 4th point is deduced from the other to get an normal base
+		// X = B inv(A)
+		Vec3d s4 = s1 + ((s2 - s1) ^ (s3 - s1));
+		Mat4d B(s1[0], s1[1], s1[2], 1, s2[0], s2[1], s2[2], 1, s3[0], s3[1], s3[2], 1, s4[0], s4[1], s4[2], 1);
+		Mat4d A(x1, texSizeY - y1, 0.f, 1.f, x2, texSizeY - y2, 0.f, 1.f, x3, texSizeY - y3, 0.f, 1.f, x1, texSizeY - y1, texSizeX, 1.f);
+		Mat4d X = B * A.inverse();
+
+		// Tesselate on the plan assuming a tangential projection for the image
+		static const int nbPoints=5;
+		QVector<Vec2f> texCoords;
+		texCoords.reserve(nbPoints*nbPoints*6);
+		for (int j=0;j<nbPoints;++j)
+		{
+			for (int i=0;i<nbPoints;++i)
+			{
+				texCoords << Vec2f(((float)i)/nbPoints, ((float)j)/nbPoints);
+				texCoords << Vec2f(((float)i+1.f)/nbPoints, ((float)j)/nbPoints);
+				texCoords << Vec2f(((float)i)/nbPoints, ((float)j+1.f)/nbPoints);
+				texCoords << Vec2f(((float)i+1.f)/nbPoints, ((float)j)/nbPoints);
+				texCoords << Vec2f(((float)i+1.f)/nbPoints, ((float)j+1.f)/nbPoints);
+				texCoords << Vec2f(((float)i)/nbPoints, ((float)j+1.f)/nbPoints);
+			}
+		}
+
+		QVector<Vec3d> contour;
+		contour.reserve(texCoords.size());
+		for (const auto& v : texCoords)
+			contour << X * Vec3d(v[0]*texSizeX, v[1]*texSizeY, 0.);
+
+		cons->artPolygon.vertex=contour;
+		cons->artPolygon.texCoords=texCoords;
+		cons->artPolygon.primitiveType=StelVertexArray::Triangles;
 
+		Vec3d tmp(X * Vec3d(0.5*texSizeX, 0.5*texSizeY, 0.));
+		tmp.normalize();
+		Vec3d tmp2(X * Vec3d(0., 0., 0.));
+		tmp2.normalize();
+		cons->boundingCap.n=tmp;
+		cons->boundingCap.d=tmp*tmp2;
+		++readOk;
+	}
+	if (!data.art.isEmpty())
+		qDebug() << "Loaded" << readOk << "/" << data.art.size() << "constellation art records successfully for culture" << cultureName;
+
+	// boundaries
+	std::vector<std::vector<Vec3d> *> newBoundarySegments;
+	for (const auto& boundary : data.boundaries)
+	{
+		vector<Vec3d>* points = new vector<Vec3d>(boundary.points.constBegin(), boundary.points.constEnd());
+		// this list is for the de-allocation
+		newBoundarySegments.push_back(points);
+
+		// The cap enclosing the segment lets draw skip it at once when it is outside of the viewport
+		Vec3d center(0.);
+		for (const auto& p : *points)
+			center += p;
+		SphericalCap cap(Vec3d(1., 0., 0.), -1.);
+		if (center.lengthSquared()>1e-6)
+		{
+			center.normalize();
+			cap.n = center;
+			cap.d = 1.;
+			for (const auto& p : *points)
+				cap.d = qMin(cap.d, p*center);
+		}
+
+		Constellation* cons = Q_NULLPTR;
+		for (const auto& consname : boundary.constellations)
+		{
+			cons = findNew(consname);
+			if (!cons)
+				qWarning() << "ERROR while processing boundary file - cannot find constellation: " << consname;
+			else
+			{
+				cons->isolatedBoundarySegments.push_back(points);
+				cons->isolatedBoundaryCaps.push_back(cap);
+			}
+		}
+		if (cons)
+		{
+			cons->sharedBoundarySegments.push_back(points);
+			cons->sharedBoundaryCaps.push_back(cap);
+		}
 	}
+	if (data.hasBoundaries)
+		qDebug() << "Loaded" << newBoundarySegments.size() << "constellation boundary segments";
+
+	// remove constellations from the list of selected objects in StelObjectMgr, since we are going to delete them
+	deselectConstellations();
+
+	std::swap(constellations, newConstellations);
+	std::swap(allBoundarySegments, newBoundarySegments);
+	for (auto* constellation : newConstellations)
+		delete constellation;
+	for (auto* segment : newBoundarySegments)
+		delete segment;
+
+	// Set current states
+	setFlagArt(artDisplayed);
+	setFlagLines(linesDisplayed);
+	setFlagLabels(namesDisplayed);
+	setFlagBoundaries(boundariesDisplayed);
 
-	lastLoadedSkyCulture = skyCultureDir;
+	// Translate constellation names for the new sky culture
+	updateI18n();
+
+	lastLoadedSkyCulture = cultureName;
 }
 
 void ConstellationMgr::selectedObjectChange(StelModule::StelModuleSelectAction action)
@@ -416,206 +633,12 @@ void ConstellationMgr::setConstellationLineThickness(const int thickness)
 	}
 }
 
-void ConstellationMgr::loadLinesAndArt(const QString &fileName, const QString &artfileName, const QString& cultureName)
-{
-	QFile in(fileName);
-	if (!in.open(QIODevice::ReadOnly | QIODevice::Text))
-	{
-		qWarning() << "Can't open constellation data file" << QDir::toNativeSeparators(fileName)  << "for culture" << cultureName;
-		Q_ASSERT(0);
-	}
-
-	int totalRecords=0;
-	QString record;
-	QRegExp commentRx("^(\\s*#.*|\\s*)$");
-	while (!in.atEnd())
-	{
-		record = QString::fromUtf8(in.readLine());
-		if (!commentRx.exactMatch(record))
-			totalRecords++;
-	}
-	in.seek(0);
-
-	// delete existing data, if any
-	for (auto* constellation : constellations)
-		delete constellation;
-
-	constellations.clear();
-	Constellation *cons = Q_NULLPTR;
-
-	// read the file of line patterns, adding a record per non-comment line
-	int currentLineNumber = 0;	// line in file
-	int readOk = 0;			// count of records processed OK
-	while (!in.atEnd())
-	{
-		record = QString::fromUtf8(in.readLine());
-		currentLineNumber++;
-		if (commentRx.exactMatch(record))
-			continue;
-
-		cons = new Constellation;
-		if(cons->read(record, hipStarMgr))
-		{
-			cons->artOpacity = artIntensity;
-			cons->artFader.setDuration((int) (artFadeDuration * 1000.f));
-			cons->setFlagArt(artDisplayed);
-			cons->setFlagBoundaries(boundariesDisplayed);
-			cons->setFlagLines(linesDisplayed);
-			cons->setFlagLabels(namesDisplayed);
-			constellations.push_back(cons);
-			++readOk;
-		}
-		else
-		{
-			qWarning() << "ERROR reading constellation lines record at line " << currentLineNumber << "for culture" << cultureName;
-			delete cons;
-		}
-	}
-	in.close();
-	qDebug() << "Loaded" << readOk << "/" << totalRecords << "constellation records successfully for culture" << cultureName;
-
-	// Set current states
-	setFlagArt(artDisplayed);
-	setFlagLines(linesDisplayed);
-	setFlagLabels(namesDisplayed);
-	setFlagBoundaries(boundariesDisplayed);
-
-	// It's possible to have no art - just constellations
-	if (artfileName.isNull() || artfileName.isEmpty())
-		return;
-	QFile fic(artfileName);
-	if (!fic.open(QIODevice::ReadOnly | QIODevice::Text))
-	{
-		qWarning() << "Can't open constellation art file" << QDir::toNativeSeparators(fileName)  << "for culture" << cultureName;
-		return;
-	}
-
-	totalRecords=0;
-	while (!fic.atEnd())
-	{
-		record = QString::fromUtf8(fic.readLine());
-		if (!commentRx.exactMatch(record))
-			totalRecords++;
-	}
-	fic.seek(0);
-
-	// Read the constellation art file with the following format :
-	// ShortName texture_file x1 y1 hp1 x2 y2 hp2
-	// Where :
-	// shortname is the international short name (i.e "Lep" for Lepus)
-	// texture_file is the graphic file of the art texture
-	// x1 y1 are the x and y texture coordinates in pixels of the star of hipparcos number hp1
-	// x2 y2 are the x and y texture coordinates in pixels of the star of hipparcos number hp2
-	// The coordinate are taken with (0,0) at the top left corner of the image file
-	QString shortname;
-	QString texfile;
-	unsigned int x1, y1, x2, y2, x3, y3, hp1, hp2, hp3;
-
-	currentLineNumber = 0;	// line in file
-	readOk = 0;		// count of records processed OK
-
-	while (!fic.atEnd())
-	{
-		++currentLineNumber;
-		record = QString::fromUtf8(fic.readLine());
-		if (commentRx.exactMatch(record))
-			continue;
-
-		// prevent leaving zeros on numbers from being interpretted as octal numbers
-		record.replace(" 0", " ");
-		QTextStream rStr(&record);
-		rStr >> shortname >> texfile >> x1 >> y1 >> hp1 >> x2 >> y2 >> hp2 >> x3 >> y3 >> hp3;
-		if (rStr.status()!=QTextStream::Ok)
-		{
-			qWarning() << "ERROR parsing constellation art record at line" << currentLineNumber << "of art file for culture" << cultureName;
-			continue;
-		}
-
-		// Draw loading bar
-// 		lb.SetMessage(q_("Loading Constellation Art: %1/%2").arg(currentLineNumber).arg(totalRecords));
-// 		lb.Draw((float)(currentLineNumber)/totalRecords);
-
-		cons = Q_NULLPTR;
-		cons = findFromAbbreviation(shortname);
-		if (!cons)
-		{
-			qWarning() << "ERROR in constellation art file at line" << currentLineNumber << "for culture" << cultureName
-					   << "constellation" << shortname << "unknown";
-		}
-		else
-		{
-			QString texturePath = StelFileMgr::findFile("skycultures/"+cultureName+"/"+texfile);
-			if (texturePath.isEmpty())
-			{
-				qWarning() << "ERROR: could not find texture, " << QDir::toNativeSeparators(texfile);
-			}
-
-			cons->artTexture = StelApp::getInstance().getTextureManager().createTextureThread(texturePath);
-
-			int texSizeX = 0, texSizeY = 0;
-			if (cons->artTexture==Q_NULLPTR || !cons->artTexture->getDimensions(texSizeX, texSizeY))
-			{
-				qWarning() << "Texture dimension not available";
-			}
-
-			StelCore* core = StelApp::getInstance().getCore();
-			Vec3d s1 = hipStarMgr->searchHP(hp1)->getJ2000EquatorialPos(core);
-			Vec3d s2 = hipStarMgr->searchHP(hp2)->getJ2000EquatorialPos(core);
-			Vec3d s3 = hipStarMgr->searchHP(hp3)->getJ2000EquatorialPos(core);
-
-			// To transform from texture coordinate to 2d coordinate we need to find X with XA = B
-			// A formed of 4 points in texture coordinate, B formed with 4 points in 3d coordinate
-			// We need 3 stars and the 4th point is deduced from the other to get an normal base
-			// X = B inv(A)
-			Vec3d s4 = s1 + ((s2 - s1) ^ (s3 - s1));
-			Mat4d B(s1[0], s1[1], s1[2], 1, s2[0], s2[1], s2[2], 1, s3[0], s3[1], s3[2], 1, s4[0], s4[1], s4[2], 1);
-			Mat4d A(x1, texSizeY - y1, 0.f, 1.f, x2, texSizeY - y2, 0.f, 1.f, x3, texSizeY - y3, 0.f, 1.f, x1, texSizeY - y1, texSizeX, 1.f);
-			Mat4d X = B * A.inverse();
-
-			// Tesselate on the plan assuming a tangential projection for the image
-			static const int nbPoints=5;
-			QVector<Vec2f> texCoords;
-			texCoords.reserve(nbPoints*nbPoints*6);
-			for (int j=0;j<nbPoints;++j)
-			{
-				for (int i=0;i<nbPoints;++i)
-				{
-					texCoords << Vec2f(((float)i)/nbPoints, ((float)j)/nbPoints);
-					texCoords << Vec2f(((float)i+1.f)/nbPoints, ((float)j)/nbPoints);
-					texCoords << Vec2f(((float)i)/nbPoints, ((float)j+1.f)/nbPoints);
-					texCoords << Vec2f(((float)i+1.f)/nbPoints, ((float)j)/nbPoints);
-					texCoords << Vec2f(((float)i+1.f)/nbPoints, ((float)j+1.f)/nbPoints);
-					texCoords << Vec2f(((float)i)/nbPoints, ((float)j+1.f)/nbPoints);
-				}
-			}
-
-			QVector<Vec3d> contour;
-			contour.reserve(texCoords.size());
-			for (const auto& v : texCoords)
-				contour << X * Vec3d(v[0]*texSizeX, v[1]*texSizeY, 0.);
-
-			cons->artPolygon.vertex=contour;
-			cons->artPolygon.texCoords=texCoords;
-			cons->artPolygon.primitiveType=StelVertexArray::Triangles;
-
-			Vec3d tmp(X * Vec3d(0.5*texSizeX, 0.5*texSizeY, 0.));
-			tmp.normalize();
-			Vec3d tmp2(X * Vec3d(0., 0., 0.));
-			tmp2.normalize();
-			cons->boundingCap.n=tmp;
-			cons->boundingCap.d=tmp*tmp2;
-			++readOk;
-		}
-	}
-
-	qDebug() << "Loaded" << readOk << "/" << totalRecords << "constellation art records successfully for culture" << cultureName;
-	fic.close();
-}
-
 void ConstellationMgr::draw(StelCore* core)
 {
 	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
 	StelPainter sPainter(prj);
+	// The line segments, art and boundaries of all the constellations are merged in a few draw calls.
+	sPainter.setBatching(true);
 	sPainter.setFont(asterFont);
 	drawLines(sPainter, core);
 	drawNames(sPainter);
@@ -706,173 +729,6 @@ QList<StelObjectP> ConstellationMgr::searchAround(const Vec3d&, double, const St
 	return QList<StelObjectP>();
 }
 
-void ConstellationMgr::loadNames(const QString& namesFile)
-{
-	// Constellation not loaded yet
-	if (constellations.empty()) return;
-
-	// clear previous names
-	for (auto* constellation : constellations)
-	{
-		constellation->englishName.clear();
-	}
-
-	// Open file
-	QFile commonNameFile(namesFile);
-	if (!commonNameFile.open(QIODevice::ReadOnly | QIODevice::Text))
-	{
-		qDebug() << "Cannot open file" << QDir::toNativeSeparators(namesFile);
-		return;
-	}
-
-	// Now parse the file
-	// lines to ignore which start with a # or are empty
-	QRegExp commentRx("^(\\s*#.*|\\s*)$");
-
-	// lines which look like records - we use the RE to extract the fields
-	// which will be available in recRx.capturedTexts()
-	// abbreviation is allowed to start with a dot to mark as "hidden".
-	QRegExp recRx("^\\s*(\\.?\\w+)\\s+\"(.*)\"\\s+_[(]\"(.*)\"[)]\\n");
-	QRegExp ctxRx("(.*)\",\\s*\"(.*)");
-
-	// Some more variables to use in the parsing
-	Constellation *aster;
-	QString record, shortName, ctxt;
-
-	// keep track of how many records we processed.
-	int totalRecords=0;
-	int readOk=0;
-	int lineNumber=0;
-	while (!commonNameFile.atEnd())
-	{
-		record = QString::fromUtf8(commonNameFile.readLine());
-		lineNumber++;
-
-		// Skip comments
-		if (commentRx.exactMatch(record))
-			continue;
-
-		totalRecords++;
-
-		if (!recRx.exactMatch(record))
-		{
-			qWarning() << "ERROR - cannot parse record at line" << lineNumber << "in constellation names file" << QDir::toNativeSeparators(namesFile) << ":" << record;
-		}
-		else
-		{
-			shortName = recRx.capturedTexts().at(1);
-			aster = findFromAbbreviation(shortName);
-			// If the constellation exists, set the English name
-			if (aster != Q_NULLPTR)
-			{
-				aster->nativeName = recRx.capturedTexts().at(2);
-				ctxt = recRx.capturedTexts().at(3);
-				if (ctxRx.exactMatch(ctxt))
-				{
-					aster->englishName = ctxRx.capturedTexts().at(1);
-					aster->context = ctxRx.capturedTexts().at(2);
-				}
-				else
-				{
-					aster->englishName = ctxt;
-					aster->context = "";
-				}
-				readOk++;
-				// Some skycultures already have empty nativeNames. Fill those.
-				if (aster->nativeName.isEmpty())
-					aster->nativeName=aster->englishName;
-			}
-			else
-			{
-				qWarning() << "WARNING - constellation abbreviation" << shortName << "not found when loading constellation names";
-			}
-		}
-	}
-	commonNameFile.close();
-	qDebug() << "Loaded" << readOk << "/" << totalRecords << "constellation names";
-}
-
-void ConstellationMgr::loadSeasonalRules(const QString& rulesFile)
-{
-	// Constellation not loaded yet
-	if (constellations.empty()) return;
-
-	bool flag = true;
-	if (rulesFile.isEmpty())
-		flag = false;
-
-	// clear previous names
-	for (auto* constellation : constellations)
-	{
-		constellation->beginSeason = 1;
-		constellation->endSeason = 12;
-		constellation->seasonalRuleEnabled = flag;
-	}
-
-	// Current starlore didn't support the seasonal rules
-	if (!flag)
-		return;
-
-	// Open file
-	QFile seasonalRulesFile(rulesFile);
-	if (!seasonalRulesFile.open(QIODevice::ReadOnly | QIODevice::Text))
-	{
-		qDebug() << "Cannot open file" << QDir::toNativeSeparators(rulesFile);
-		return;
-	}
-
-	// Now parse the file
-	// lines to ignore which start with a # or are empty
-	QRegExp commentRx("^(\\s*#.*|\\s*)$");
-
-	// lines which look like records - we use the RE to extract the fields
-	// which will be available in recRx.capturedTexts()
-	QRegExp recRx("^\\s*(\\w+)\\s+(\\w+)\\s+(\\w+)\\n");
-
-	// Some more variables to use in the parsing
-	Constellation *aster;
-	QString record, shortName;
-
-	// keep track of how many records we processed.
-	int totalRecords=0;
-	int readOk=0;
-	int lineNumber=0;
-	while (!seasonalRulesFile.atEnd())
-	{
-		record = QString::fromUtf8(seasonalRulesFile.readLine());
-		lineNumber++;
-
-		// Skip comments
-		if (commentRx.exactMatch(record))
-			continue;
-
-		totalRecords++;
-
-		if (!recRx.exactMatch(record))
-		{
-			qWarning() << "ERROR - cannot parse record at line" << lineNumber << "in seasonal rules file" << QDir::toNativeSeparators(rulesFile);
-		}
-		else
-		{
-			shortName = recRx.capturedTexts().at(1);
-			aster = findFromAbbreviation(shortName);
-			// If the constellation exists, set the English name
-			if (aster != Q_NULLPTR)
-			{
-				aster->beginSeason = recRx.capturedTexts().at(2).toInt();
-				aster->endSeason = recRx.capturedTexts().at(3).toInt();
-				readOk++;
-			}
-			else
-			{
-				qWarning() << "WARNING - constellation abbreviation" << shortName << "not found when loading seasonal rules for constellations";
-			}
-		}
-	}
-	seasonalRulesFile.close();
-	qDebug() << "Loaded" << readOk << "/" << totalRecords << "seasonal rules";
-}
-
 void ConstellationMgr::updateI18n()
 {
 	const StelTranslator& trans = StelApp::getInstance().getLocaleMgr().getSkyTranslator();
@@ -889,10 +745,19 @@ void ConstellationMgr::update(double deltaTime)
 	double fov = StelApp::getInstance().getCore()->getMovementMgr()->getCurrentFov();
 	Constellation::artIntensityFovScale = qBound(0.0,(fov - artIntensityMinimumFov) / (artIntensityMaximumFov - artIntensityMinimumFov),1.0);
 
+	// The seasonal rules only depend on the month, which is computed once for all constellations
+	int month = 0;
+	if (Constellation::seasonalRuleEnabled)
+	{
+		int year, day;
+		StelUtils::getDateFromJulianDay(StelApp::getInstance().getCore()->getJD(), &year, &month, &day);
+	}
+
 	const int delta = (int)(deltaTime*1000);
 	for (auto* constellation : constellations)
 	{
 		constellation->update(delta);
+		constellation->updateVisibility(month);
 	}
 }
 
@@ -1248,111 +1113,6 @@ void ConstellationMgr::unsetSelectedConst(Constellation * c)
 	}
 }
 
-bool ConstellationMgr::loadBoundaries(const QString& boundaryFile)
-{
-	Constellation *cons = Q_NULLPTR;
-	unsigned int i, j;
-
-	// delete existing boundaries if any exist
-	for (auto* segment : allBoundarySegments)
-	{
-		delete segment;
-	}
-	allBoundarySegments.clear();
-
-	qDebug() << "Loading constellation boundary data ... ";
-
-	// Modified boundary file by Torsten Bronger with permission
-	// http://pp3.sourceforge.net
-	QFile dataFile(boundaryFile);
-	if (!dataFile.open(QIODevice::ReadOnly | QIODevice::Text))
-	{
-		qWarning() << "Boundary file " << QDir::toNativeSeparators(boundaryFile) << " not found";
-		return false;
-	}
-
-	double DE, RA;
-	Vec3d XYZ;
-	unsigned num, numc;
-	vector<Vec3d> *points = Q_NULLPTR;
-	QString consname, record, data = "";
-	i = 0;
-
-	// Added support of comments for constellations_boundaries.dat file
-	QRegExp commentRx("^(\\s*#.*|\\s*)$");
-	while (!dataFile.atEnd())
-	{
-		// Read the line
-		record = QString::fromUtf8(dataFile.readLine());
-
-		// Skip comments
-		if (commentRx.exactMatch(record))
-			continue;
-
-		// Append the data
-		data.append(record);
-	}
-
-	// Read and parse the data without comments
-	QTextStream istr(&data);
-	while (!istr.atEnd())
-	{
-		num = 0;
-		istr >> num;
-		if(num == 0)
-			continue; // empty line
-
-		points = new vector<Vec3d>;
-
-		for (j=0;j<num;j++)
-		{
-			istr >> RA >> DE;
-
-			RA*=M_PI/12.;     // Convert from hours to rad
-			DE*=M_PI/180.;    // Convert from deg to rad
-
-			// Calc the Cartesian coord with RA and DE
-			StelUtils::spheToRect(RA,DE,XYZ);
-			points->push_back(XYZ);
-		}
-
-		// this list is for the de-allocation
-		allBoundarySegments.push_back(points);
-
-		istr >> numc;
-		// there are 2 constellations per boundary
-
-		for (j=0;j<numc;j++)
-		{
-			istr >> consname;
-			// not used?
-			if (consname == "SER1" || consname == "SER2") consname = "SER";
-
-			cons = findFromAbbreviation(consname);
-			if (!cons)
-				qWarning() << "ERROR while processing boundary file - cannot find constellation: " << consname;
-			else
-				cons->isolatedBoundarySegments.push_back(points);
-		}
-
-		if (cons)
-		{
-			cons->sharedBoundarySegments.push_back(points);
-			points=Q_NULLPTR; // Avoid Coverity resource leak warning. (CID48925).
-		}
-		i++;
-	}
-	dataFile.close();
-	qDebug() << "Loaded" << i << "constellation boundary segments";
-	if (points)
-	{
-		delete points; // See if Coverity complains here? (CID48925).
-		points=Q_NULLPTR;
-	}
-
-	return true;
-}
-
 void ConstellationMgr::drawBoundaries(StelPainter& sPainter) const
 {
 	sPainter.setBlending(false);
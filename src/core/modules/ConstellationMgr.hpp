@@ -33,6 +33,8 @@
 class StelToneReproducer;
 class StarMgr;
 class Constellation;
+class ConstellationData;
+template <typename T> class QFutureWatcher;
 class StelProjector;
 class StelPainter;
 
@@ -298,6 +300,9 @@ private slots:
 	void selectedObjectChange(StelModule::StelModuleSelectAction action);
 
 	//! Loads new constellation data and art if the SkyCulture has changed.
+	//! The files are read in a worker thread, or from the cache of the parsed files, while the
+	//! current constellations are still displayed. They are then replaced at once in the main thread.
+	//! Only the first sky culture is loaded before this function returns.
 	//! @param skyCultureDir the name of the directory containing the sky culture to use.
 	void updateSkyCulture(const QString& skyCultureDir);
 
@@ -309,38 +314,14 @@ private slots:
 
 	void reloadSkyCulture(void);
 
+	//! Apply a sky culture read in the background by updateSkyCulture(), if it is still the requested one.
+	void skyCultureLoaded();
+
 private:
-	//! Read constellation names from the given file.
-	//! @param namesFile Name of the file containing the constellation names
-	//!        in a format consisting of abbreviation, native name and translatable english name.
-	//! @note The abbreviation must occur in the lines file loaded first in @name loadLinesAndArt()!
-	void loadNames(const QString& namesFile);
-
-	//! Load constellation line shapes, art textures and boundaries shapes from data files.
-	//! @param fileName The name of the constellation data file
-	//! @param artFileName The name of the constellation art data file
-	//! @param cultureName A string ID of the current skyculture
-	//! @note The abbreviation used in @param filename is required for cross-identifying translatable names in @name loadNames():
-	void loadLinesAndArt(const QString& fileName, const QString& artfileName, const QString& cultureName);
-
-	//! Load the constellation boundary file.
-	//! This function deletes any currently loaded constellation boundaries
-	//! and loads a new set from the file passed as the parameter.  The boundary
-	//! data file consists of whitespace separated values (space, tab or newline).
-	//! Each boundary may span multiple lines, and consists of the following ordered
-	//! data items:
-	//!  - The number of vertices which make up in the boundary (integer).
-	//!  - For each vertex, two floating point numbers describing the ra and dec
-	//!    of the vertex.
-	//!  - The number of constellations which this boundary separates (always 2).
-	//!  - Two constellation abbreviations representing the constellations which
-	//!    the boundary separates.
-	//! @param conCatFile the path to the file which contains the constellation boundary data.
-	bool loadBoundaries(const QString& conCatFile);
-
-	//! Read seasonal rules for displaying constellations from the given file.
-	//! @param rulesFile Name of the file containing the seasonal rules
-	void loadSeasonalRules(const QString& rulesFile);
+	//! Build the constellations, their art and their boundaries from the parsed files of a sky culture,
+	//! and replace the current ones with them.
+	//! @note The abbreviation of the lines is required for cross-identifying names, rules, art and boundaries.
+	void applyConstellationData(const ConstellationData& data);
 
 	//! Draw the constellation lines at the epoch given by the StelCore.
 	void drawLines(StelPainter& sPainter, const StelCore* core) const;
@@ -381,6 +362,7 @@ private:
 	std::vector<std::vector<Vec3d> *> allBoundarySegments;
 
 	QString lastLoadedSkyCulture;	// Store the last loaded sky culture directory name
+	QString requestedSkyCulture;	// The sky culture being read in the background, if any
 
 	//! this controls how constellations (and also star names) are printed: Abbreviated/as-given/translated
 	ConstellationDisplayStyle constellationDisplayStyle;
@@ -397,6 +379,8 @@ private:
 
 	// Store the thickness of lines of the constellations
 	int constellationLineThickness;
+
+	QFutureWatcher<ConstellationData>* skyCultureWatcher;
 };
 
 #endif // CONSTELLATIONMGR_HPP
@@ -37,17 +37,14 @@ float CustomObject::selectPriority = 0.f;
 CustomObject::CustomObject(const QString& codesignation, const Vec3d& coordinates, const bool isVisible)
 	: initialized(false)
 	, XYZ(coordinates)
-	, markerTexture(Q_NULLPTR)
 	, designation(codesignation)
 	, isMarker(isVisible)
 {
-	markerTexture = StelApp::getInstance().getTextureManager().createTexture(StelFileMgr::getInstallationDir()+"/textures/cross.png");	
 	initialized = true;
 }
 
 CustomObject::~CustomObject()
 {
-	markerTexture.clear();
 }
 
 float CustomObject::getSelectPriority(const StelCore* core) const
@@ -117,28 +114,3 @@ void CustomObject::update(double deltaTime)
 	labelsFader.update((int)(deltaTime*1000));
 }
 
-void CustomObject::draw(StelCore* core, StelPainter *painter)
-{
-	Q_UNUSED(core);
-	Vec3d pos;
-	// Check visibility of custom object
-	if (!(painter->getProjector()->projectCheck(XYZ, pos)))
-		return;
-
-	painter->setBlending(true, GL_ONE, GL_ONE);
-	painter->setColor(markerColor[0], markerColor[1], markerColor[2], 1.f);
-
-	if (isMarker)
-	{
-		markerTexture->bind();
-		float size = getAngularSize(Q_NULLPTR)*M_PI/180.*painter->getProjector()->getPixelPerRadAtCenter();
-		float shift = markerSize + size/1.6f;
-
-		painter->drawSprite2dMode(pos[0], pos[1], markerSize);
-
-		if (labelsFader.getInterstate()<=0.f)
-		{
-			painter->drawText(pos[0], pos[1], getNameI18n(), 0, shift, shift, false);
-		}
-	}
-}
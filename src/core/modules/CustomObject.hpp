@@ -81,13 +81,10 @@ private:
 
 	Vec3d XYZ;                         // holds J2000 position
 
-	StelTextureSP markerTexture;
 	static Vec3f markerColor;
 	static float markerSize;
 	static float selectPriority;
 
-	void draw(StelCore* core, StelPainter *painter);
-
 	QString designation;
 	bool isMarker;	
 
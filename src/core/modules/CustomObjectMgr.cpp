@@ -33,6 +33,7 @@
 CustomObjectMgr::CustomObjectMgr()
 	: countMarkers(0)
 	, radiusLimit(15)
+	, markersDirty(true)
 {
 	setObjectName("CustomObjectMgr");
 	conf = StelApp::getInstance().getSettings();
@@ -119,8 +120,10 @@ void CustomObjectMgr::handleMouseClicks(class QMouseEvent* e)
 void CustomObjectMgr::init()
 {
 	texPointer = StelApp::getInstance().getTextureManager().createTexture(StelFileMgr::getInstallationDir()+"/textures/pointeur2.png");
+	texMarker = StelApp::getInstance().getTextureManager().createTexture(StelFileMgr::getInstallationDir()+"/textures/cross.png");
 
 	customObjects.clear();
+	markersDirty = true;
 
 	setMarkersColor(StelUtils::strToVec3f(conf->value("color/custom_marker_color", "0.1,1.0,0.1").toString()));
 	setMarkersSize(conf->value("gui/custom_marker_size", 5.f).toFloat());
@@ -134,7 +137,9 @@ void CustomObjectMgr::init()
 void CustomObjectMgr::deinit()
 {
 	customObjects.clear();	
+	markersDirty = true;
 	texPointer.clear();
+	texMarker.clear();
 }
 
 void CustomObjectMgr::setSelectPriority(float priority)
@@ -153,7 +158,11 @@ void CustomObjectMgr::addCustomObject(QString designation, Vec3d coordinates, bo
 	{
 		CustomObjectP custObj(new CustomObject(designation, coordinates, isVisible));
 		if (custObj->initialized)
+		{
 			customObjects.append(custObj);
+			invalidateNameIndex();
+			markersDirty = true;
+		}
 
 		if (isVisible)
 			countMarkers++;
@@ -194,10 +203,33 @@ void CustomObjectMgr::addCustomObjectAltAzi(QString designation, const QString &
 	addCustomObject(designation, StelApp::getInstance().getCore()->altAzToJ2000(aim, StelCore::RefractionAuto), isVisible);
 }
 
+int CustomObjectMgr::addCustomObjects(const QStringList& designations, const QVariantList& ra, const QVariantList& dec, bool isVisible)
+{
+	const int count = qMin(designations.size(), qMin(ra.size(), dec.size()));
+	int added = 0;
+	for (int i=0; i<count; ++i)
+	{
+		if (designations.at(i).isEmpty())
+			continue;
+		Vec3d J2000;
+		StelUtils::spheToRect(StelUtils::getDecAngleFromVariant(ra.at(i)), StelUtils::getDecAngleFromVariant(dec.at(i)), J2000);
+		customObjects.append(CustomObjectP(new CustomObject(designations.at(i), J2000, isVisible)));
+		++added;
+	}
+	if (isVisible)
+		countMarkers += added;
+	// The name index is rebuilt once for the whole list
+	invalidateNameIndex();
+	markersDirty = true;
+	return added;
+}
+
 void CustomObjectMgr::removeCustomObjects()
 {
 	setSelected("");
 	customObjects.clear();
+	invalidateNameIndex();
+	markersDirty = true;
 	//This marker count can be set to 0 because there will be no markers left and a duplicate will be impossible
 	countMarkers = 0;
 }
@@ -206,17 +238,39 @@ void CustomObjectMgr::removeCustomObject(CustomObjectP obj)
 {
 	setSelected("");
 	customObjects.removeOne(obj);
+	invalidateNameIndex();
+	markersDirty = true;
 }
 
 void CustomObjectMgr::removeCustomObject(QString englishName)
 {
 	setSelected("");
-	for (const auto& cObj : customObjects)
+	for (int i=customObjects.size()-1; i>=0; --i)
 	{
+		const CustomObjectP& cObj = customObjects.at(i);
 		//If we have a match for the thing we want to delete
 		if(cObj && cObj->getEnglishName()==englishName && cObj->initialized)
-			customObjects.removeOne(cObj);
+			customObjects.removeAt(i);
+	}
+	invalidateNameIndex();
+	markersDirty = true;
+}
+
+void CustomObjectMgr::updateMarkers()
+{
+	markerPositions.clear();
+	markerObjects.clear();
+	for (const auto& cObj : customObjects)
+	{
+		if (cObj && cObj->initialized && cObj->isMarker)
+		{
+			Vec3d pos = cObj->XYZ;
+			pos.normalize();
+			markerPositions.append(pos);
+			markerObjects.append(cObj.data());
+		}
 	}
+	markersDirty = false;
 }
 
 void CustomObjectMgr::draw(StelCore* core)
@@ -225,10 +279,41 @@ void CustomObjectMgr::draw(StelCore* core)
 	StelPainter painter(prj);
 	painter.setFont(font);
 
-	for (const auto& cObj : customObjects)
+	if (markersDirty)
+		updateMarkers();
+	if (!markerPositions.isEmpty() && texMarker)
 	{
-		if (cObj && cObj->initialized)
-			cObj->draw(core, &painter);
+		const SphericalCap& viewportCap = prj->getBoundingCap();
+		QVector<int> visible;
+		QVector<Vec3d> screenPositions;
+		Vec3d win;
+		for (int i=0; i<markerPositions.size(); ++i)
+		{
+			if (viewportCap.contains(markerPositions.at(i)) && prj->projectCheck(markerPositions.at(i), win))
+			{
+				visible.append(i);
+				screenPositions.append(win);
+			}
+		}
+
+		// All markers in one draw call, then their labels in the text atlas
+		painter.setBlending(true, GL_ONE, GL_ONE);
+		painter.setColor(CustomObject::markerColor[0], CustomObject::markerColor[1], CustomObject::markerColor[2], 1.f);
+		painter.setBatching(true);
+		texMarker->bind();
+		for (const auto& pos : screenPositions)
+			painter.drawSprite2dMode(pos[0], pos[1], CustomObject::markerSize);
+		const float size = markerObjects.isEmpty() ? 0.f : markerObjects.first()->getAngularSize(Q_NULLPTR)*M_PI/180.*prj->getPixelPerRadAtCenter();
+		const float shift = CustomObject::markerSize + size/1.6f;
+		for (int i=0; i<visible.size(); ++i)
+		{
+			const CustomObject* cObj = markerObjects.at(visible.at(i));
+			if (cObj->labelsFader.getInterstate()<=0.f)
+				painter.drawText(screenPositions.at(i)[0], screenPositions.at(i)[1], cObj->getNameI18n(), 0, shift, shift, false);
+		}
+		// The pointer is drawn directly, above the markers
+		StelPainter::submitBatch();
+		painter.setBatching(false);
 	}
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
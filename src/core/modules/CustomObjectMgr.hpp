@@ -26,6 +26,9 @@
 
 #include <QFont>
 #include <QList>
+#include <QStringList>
+#include <QVariantList>
+#include <QVector>
 
 class StelPainter;
 class QSettings;
@@ -127,6 +130,17 @@ public slots:
 	//! CustomObjectMgr.addCustomObjectAltAzi("Marker", "2d10m15s", "60d01m15s", true);
 	//! @endcode
 	void addCustomObjectAltAzi(QString designation, const QString& alt, const QString& azi, bool isVisible=false);
+	//! Add many custom objects at once, e.g. the fields of a survey.
+	//! @param designations - designations of the custom objects
+	//! @param ra - right ascension angles (J2000.0) of the custom objects, in degrees or as strings like "2h10m15s"
+	//! @param dec - declination angles (J2000.0) of the custom objects, in degrees or as strings like "60d01m15s"
+	//! @param isVisible - flag of visibility of the custom objects
+	//! @return the number of custom objects added, from the shortest of the lists
+	//! @code
+	//! // example of usage in scripts
+	//! CustomObjectMgr.addCustomObjects(["Field 1", "Field 2"], [10.68, "5h35m17s"], [41.27, "-5d23m28s"], true);
+	//! @endcode
+	int addCustomObjects(const QStringList& designations, const QVariantList& ra, const QVariantList& dec, bool isVisible=false);
 	//! Remove all custom objects
 	void removeCustomObjects();
 	//! Remove just one custom object by English name
@@ -175,8 +189,16 @@ private:
 	QFont font;
 	QSettings* conf;
 	StelTextureSP texPointer;
+	StelTextureSP texMarker;
 	QList<CustomObjectP> customObjects;
 
+	//! The visible markers, in contiguous arrays which are culled without touching the objects.
+	//! Rebuilt by draw() when markersDirty is set.
+	QVector<Vec3d> markerPositions;
+	QVector<CustomObject*> markerObjects;
+	bool markersDirty;
+	void updateMarkers();
+
 	Vec3f hightlightColor;
 	int countMarkers;
 	int radiusLimit;
@@ -0,0 +1,150 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "DSOOutlineStore.hpp"
+#include "StelUtils.hpp"
+
+#include <QDebug>
+
+namespace
+{
+	//! Get whether a line of outlines.dat has no data.
+	bool isComment(const QByteArray& line)
+	{
+		const QByteArray trimmed = line.trimmed();
+		return trimmed.isEmpty() || trimmed.startsWith('#');
+	}
+
+	//! Get the command of a line: bytes 19-25.
+	QByteArray getCommand(const QByteArray& line)
+	{
+		return line.mid(19, 7).trimmed().toLower();
+	}
+}
+
+DSOOutlineStore::DSOOutlineStore()
+	: cache(2*1024*1024)
+{
+}
+
+void DSOOutlineStore::close()
+{
+	cache.clear();
+	oversized.reset();
+	ranges.clear();
+	file.close();
+}
+
+int DSOOutlineStore::open(const QString& filename, const std::function<const Nebula*(const QString&)>& findDSO)
+{
+	close();
+	file.setFileName(filename);
+	if (!file.open(QIODevice::ReadOnly))
+		return -1;
+
+	int count = 0;
+	const Nebula* dso = Q_NULLPTR;
+	qint64 start = -1;
+	while (!file.atEnd())
+	{
+		const qint64 offset = file.pos();
+		const QByteArray line = file.readLine();
+		if (isComment(line))
+			continue;
+		const QByteArray command = getCommand(line);
+		if (command.contains("start"))
+		{
+			// bytes 26-, designation of DSO
+			dso = findDSO(QString::fromUtf8(line.mid(26)).trimmed());
+			start = offset;
+		}
+		if (command.contains("end") && start>=0)
+		{
+			if (dso)
+				ranges[dso].append({start, file.pos()-start});
+			dso = Q_NULLPTR;
+			start = -1;
+			count++;
+		}
+	}
+	return count;
+}
+
+void DSOOutlineStore::parseRange(const QByteArray& data, Outlines& outlines)
+{
+	QVector<Vec3d> points;
+	Vec3d XYZ;
+	for (const auto& line : data.split('\n'))
+	{
+		if (isComment(line))
+			continue;
+
+		// bytes 1 - 8, RA
+		const double RA = line.left(8).trimmed().toDouble()*M_PI/12.;
+		// bytes 9 -18, DE
+		const double DE = line.mid(9, 10).trimmed().toDouble()*M_PI/180.;
+		const QByteArray command = getCommand(line);
+		if (command.contains("start") || command.contains("vertex") || command.contains("end"))
+		{
+			StelUtils::spheToRect(RA, DE, XYZ);
+			points.append(XYZ);
+		}
+		if (command.contains("end"))
+		{
+			// Close the outline
+			points.append(points.first());
+			outlines.append(points);
+			return;
+		}
+	}
+}
+
+const DSOOutlineStore::Outlines* DSOOutlineStore::get(const Nebula* dso)
+{
+	Outlines* outlines = cache.object(dso);
+	if (outlines)
+		return outlines;
+
+	const auto it = ranges.constFind(dso);
+	if (it==ranges.constEnd())
+		return Q_NULLPTR;
+
+	outlines = new Outlines();
+	int cost = sizeof(Outlines);
+	for (const auto& range : it.value())
+	{
+		if (!file.seek(range.offset))
+		{
+			qWarning() << "Cannot read DSO outlines from" << file.fileName();
+			break;
+		}
+		parseRange(file.read(range.size), *outlines);
+	}
+	for (const auto& points : *outlines)
+		cost += sizeof(QVector<Vec3d>) + points.size()*sizeof(Vec3d);
+
+	if (cost > cache.maxCost())
+	{
+		oversized.reset(outlines);
+		return outlines;
+	}
+	cache.insert(dso, outlines, cost);
+	return outlines;
+}
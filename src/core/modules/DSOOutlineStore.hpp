@@ -0,0 +1,82 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef DSOOUTLINESTORE_HPP
+#define DSOOUTLINESTORE_HPP
+
+#include "VecMath.hpp"
+
+#include <QCache>
+#include <QFile>
+#include <QHash>
+#include <QScopedPointer>
+#include <QVector>
+
+#include <functional>
+
+class Nebula;
+
+//! @class DSOOutlineStore
+//! Loads the outlines of deep-sky objects from outlines.dat on demand.
+//! Opening the file only records where the outlines of each object are. The points of an outline are parsed
+//! when the object is drawn, and kept in a cache limited by a size budget, so that only the outlines of the
+//! objects recently in the viewport are in memory.
+class DSOOutlineStore
+{
+public:
+	//! The outlines of one object, each made of the closed list of its vertices.
+	typedef QVector<QVector<Vec3d> > Outlines;
+
+	DSOOutlineStore();
+
+	//! Index the outlines of a file. The previously opened file is closed.
+	//! @param filename the path of outlines.dat
+	//! @param findDSO returns the object with a designation found in the file, or Q_NULLPTR
+	//! @return the number of outlines found, or -1 if the file cannot be opened
+	int open(const QString& filename, const std::function<const Nebula*(const QString&)>& findDSO);
+	//! Close the file and forget all the outlines.
+	void close();
+
+	//! Set the maximum size of the outlines kept in memory.
+	void setCacheSize(int bytes) {cache.setMaxCost(bytes);}
+
+	//! Get the outlines of an object, reading them from the file if they are not in memory.
+	//! @return Q_NULLPTR if the object has no outlines. The outlines are only valid until the next call.
+	const Outlines* get(const Nebula* dso);
+
+private:
+	//! Part of the file holding the lines from "start" to "end" of one outline.
+	struct Range
+	{
+		qint64 offset;
+		qint64 size;
+	};
+
+	//! Parse the lines of a range, and append the outline they describe.
+	static void parseRange(const QByteArray& data, Outlines& outlines);
+
+	QFile file;
+	QHash<const Nebula*, QVector<Range> > ranges;
+	QCache<const Nebula*, Outlines> cache;
+	//! The last outlines read which were too large for the cache.
+	QScopedPointer<Outlines> oversized;
+};
+
+#endif // DSOOUTLINESTORE_HPP
@@ -0,0 +1,147 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "EphemerisGenerator.hpp"
+#include "ObserverEphemeris.hpp"
+#include "SolarSystem.hpp"
+#include "Planet.hpp"
+#include "StelApp.hpp"
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QScopedPointer>
+
+struct EphemerisGenerator::Data
+{
+	PlanetP target;
+	QScopedPointer<ObserverEphemeris> ephemeris;
+	QVector<double> datesJD;
+	bool horizontal;
+
+	QAtomicInt cancelled;
+	mutable QMutex mutex;
+	QVector<Row> rows;		// computed rows, not taken yet
+	int computedRows;
+
+	void run();
+	Row computeRow(int i) const;
+};
+
+void EphemerisGenerator::Data::run()
+{
+	for (int i=0; i<datesJD.size(); ++i)
+	{
+		if (cancelled.load())
+			return;
+		const Row row = computeRow(i);
+		QMutexLocker locker(&mutex);
+		rows.append(row);
+		computedRows++;
+	}
+}
+
+EphemerisGenerator::Row EphemerisGenerator::Data::computeRow(int i) const
+{
+	const ObserverEphemeris::Frame frame = ephemeris->computeFrame(datesJD.at(i));
+	PlanetState state;
+	const Vec3d j2000Pos = ephemeris->computeJ2000Pos(target, frame, &state);
+
+	Row row;
+	row.JD = frame.JD;
+	row.distance = j2000Pos.length();
+	row.magnitude = ephemeris->computeVMagnitude(target, frame, state);
+	row.pos = horizontal ? ephemeris->j2000ToAltAz(j2000Pos, frame, true) : j2000Pos;
+
+	// Same as Planet::getPhase() and Planet::getElongation()
+	const Vec3d& observerPos = frame.observerPos;
+	const Vec3d& planetPos = state.heliocentricPos;
+	const double observerRq = observerPos.lengthSquared();
+	const double planetRq = planetPos.lengthSquared();
+	const double observerPlanetRq = (observerPos - planetPos).lengthSquared();
+	const double cos_chi = (observerPlanetRq + planetRq - observerRq)/(2.0*std::sqrt(observerPlanetRq*planetRq));
+	row.phase = 0.5f * qAbs(1.f + cos_chi);
+	row.elongation = std::acos((observerPlanetRq + observerRq - planetRq)/(2.0*std::sqrt(observerPlanetRq*observerRq)));
+	return row;
+}
+
+EphemerisGenerator::EphemerisGenerator(StelCore* core, const PlanetP& target, const QVector<double>& datesJD, bool horizontal)
+	: data(new Data())
+{
+	data->target = target;
+	data->datesJD = datesJD;
+	data->horizontal = horizontal;
+	data->computedRows = 0;
+	double startJD = datesJD.isEmpty() ? 0. : datesJD.first();
+	double stopJD = startJD;
+	for (auto JD : datesJD)
+	{
+		startJD = qMin(startJD, JD);
+		stopJD = qMax(stopJD, JD);
+	}
+	data->ephemeris.reset(new ObserverEphemeris(core, startJD, stopJD));
+}
+
+EphemerisGenerator::~EphemerisGenerator()
+{
+	cancel();
+}
+
+void EphemerisGenerator::start()
+{
+	Q_ASSERT(job.isNull());
+	const QSharedPointer<Data> d = data;
+	job = StelApp::getInstance().getJobMgr().submit([d]() { d->run(); }, StelJobMgr::PrioritySelected);
+}
+
+void EphemerisGenerator::cancel()
+{
+	data->cancelled.store(1);
+	if (job)
+		job->cancel();
+}
+
+bool EphemerisGenerator::isFinished() const
+{
+	return job && job->isFinished();
+}
+
+void EphemerisGenerator::waitForFinished()
+{
+	if (job)
+		job->waitForFinished();
+}
+
+QVector<EphemerisGenerator::Row> EphemerisGenerator::takeRows()
+{
+	QMutexLocker locker(&data->mutex);
+	QVector<Row> result;
+	result.swap(data->rows);
+	return result;
+}
+
+int EphemerisGenerator::getComputedRows() const
+{
+	QMutexLocker locker(&data->mutex);
+	return data->computedRows;
+}
+
+int EphemerisGenerator::getTotalRows() const
+{
+	return data->datesJD.size();
+}
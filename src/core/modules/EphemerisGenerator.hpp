@@ -0,0 +1,85 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef EPHEMERISGENERATOR_HPP
+#define EPHEMERISGENERATOR_HPP
+
+#include "VecMath.hpp"
+#include "StelJobMgr.hpp"
+
+#include <QSharedPointer>
+#include <QVector>
+
+class StelCore;
+class Planet;
+typedef QSharedPointer<Planet> PlanetP;
+
+//! @class EphemerisGenerator
+//! Computes a table of positions of a solar system body in a background job of StelJobMgr.
+//! The time of StelCore is not changed: positions come from SolarSystem::computeStateAt(), and the
+//! orientation of the observer from the stateless methods of Planet and StelObserver.
+//! The observer and its settings are copied on construction by ObserverEphemeris, so the table stays
+//! consistent if the user changes them while it is computed.
+//! Rows are computed in chronological order and can be taken while the job is running.
+class EphemerisGenerator
+{
+public:
+	struct Row
+	{
+		double JD;		//!< date of the row (UT)
+		Vec3d pos;		//!< J2000 equatorial or horizontal position relative to the observer [AU]
+		double distance;	//!< distance from the observer [AU]
+		float magnitude;	//!< visual magnitude, with extinction when the observer has an atmosphere
+		float phase;		//!< illuminated fraction [0..1]
+		double elongation;	//!< elongation from the Sun [rad]
+	};
+
+	//! Prepare the computation. Must be called from the main thread.
+	//! @param core the core providing the current observer and settings
+	//! @param target the body to compute
+	//! @param datesJD the dates of the rows (UT)
+	//! @param horizontal true for horizontal coordinates (with refraction when the observer has an atmosphere),
+	//! false for J2000 equatorial coordinates
+	EphemerisGenerator(StelCore* core, const PlanetP& target, const QVector<double>& datesJD, bool horizontal);
+	//! Cancel the computation if it is still running.
+	~EphemerisGenerator();
+
+	//! Queue the computation in StelJobMgr.
+	void start();
+	//! Stop the computation. The rows computed so far can still be taken.
+	void cancel();
+	//! Get whether all the rows were computed, or the computation was cancelled.
+	bool isFinished() const;
+	//! Block until all the rows were computed, or the computation was cancelled.
+	void waitForFinished();
+
+	//! Get and remove the rows computed since the previous call.
+	QVector<Row> takeRows();
+	//! Get the number of rows computed so far.
+	int getComputedRows() const;
+	//! Get the total number of rows.
+	int getTotalRows() const;
+
+private:
+	struct Data;
+	QSharedPointer<Data> data;
+	StelJobP job;
+};
+
+#endif // EPHEMERISGENERATOR_HPP
@@ -34,13 +34,25 @@
 #include "StelFileMgr.hpp"
 #include "precession.h"
 
+#include <functional>
 #include <set>
 #include <QSettings>
 #include <QDebug>
 #include <QFontMetrics>
+#include <QHash>
+#include <QMatrix4x4>
+#include <QOpenGLBuffer>
+#include <QOpenGLShaderProgram>
+#include <QPair>
+
+struct ViewportEdgeIntersectCallbackData;
 
 //! @class SkyGrid
 //! Class which manages a grid to display in the sky.
+//! When the projection can be evaluated on the GPU and the steps of the grid are at least 1 degree, the meridians
+//! and parallels of the whole sphere are tessellated once per pair of steps into a static buffer in the frame of
+//! the grid, and projected by a vertex shader. The positions of the labels are then only searched again when the
+//! view changes, along the same points.
 class SkyGrid
 {
 public:
@@ -56,10 +68,57 @@ public:
 	void setDisplayed(const bool displayed){fader = displayed;}
 	bool isDisplayed(void) const {return fader;}
 private:
+	//! A meridian circle or a parallel of the static geometry
+	struct GridLine
+	{
+		int start;		// index of its first point in GridGeometry::points
+		int count;
+		bool meridian;
+		double angle;		// longitude of a meridian circle or latitude of a parallel [rad]
+	};
+	//! The meridians and parallels of the whole sphere for a pair of steps
+	struct GridGeometry
+	{
+		GridGeometry() : buffer(QOpenGLBuffer::VertexBuffer), vertexCount(0) {}
+		//! The closed loop of points of each line, in the frame of the grid
+		QVector<Vec3f> points;
+		QVector<GridLine> lines;
+		//! The segments of the lines
+		QOpenGLBuffer buffer;
+		int vertexCount;
+	};
+	//! Where a line crosses the edge of the viewport, see viewportEdgeIntersectCallback()
+	struct GridLabel
+	{
+		Vec3d screenPos;
+		Vec3d direction;
+		int line;
+	};
+
+	//! Draw the meridians and parallels from the static geometry, and their labels.
+	//! @return false if the static geometry can not be used with this projector or these steps
+	bool drawStatic(const StelProjectorP& prj, StelPainter& sPainter, ViewportEdgeIntersectCallbackData& userData,
+			double gridStepMeridianRad, double gridStepParallelRad) const;
+	//! Get the static geometry of a pair of steps, creating it on first use.
+	GridGeometry* getGeometry(double gridStepMeridianRad, double gridStepParallelRad) const;
+	//! Find where the lines of the geometry cross the edge of the viewport.
+	void updateLabels(const StelProjectorP& prj, const GridGeometry* geometry) const;
+	//! Get the shader program for a projector shader, compiling it on first use.
+	QOpenGLShaderProgram* getProgram(const QByteArray& projectorShader) const;
+
 	Vec3f color;
 	StelCore::FrameType frameType;
 	QFont font;
 	LinearFader fader;
+
+	mutable bool flagStaticBuffers;
+	mutable QHash<QPair<qint64, qint64>, GridGeometry*> geometries;
+	mutable QHash<QByteArray, QOpenGLShaderProgram*> programs;
+	//! The labels of the last view, and what they were computed for
+	mutable QVector<GridLabel> labels;
+	mutable QVector<double> labelsViewKey;
+	mutable QString labelsProjection;
+	mutable const GridGeometry* labelsGeometry;
 };
 
 //! @class SkyPoint
@@ -96,7 +155,7 @@ public:
 	//! Re-translates the label.
 	void updateLabel();
 private:
-	QSharedPointer<Planet> earth, sun;
+	SolarSystem* ssystem;
 	SKY_POINT_TYPE point_type;
 	Vec3f color;
 	StelCore::FrameType frameType;
@@ -145,7 +204,7 @@ public:
 	//! Re-translates the label.
 	void updateLabel();
 private:
-	QSharedPointer<Planet> earth, sun;
+	SolarSystem* ssystem;
 	SKY_LINE_TYPE line_type;
 	Vec3f color;
 	StelCore::FrameType frameType;
@@ -155,14 +214,23 @@ private:
 };
 
 // rms added color as parameter
-SkyGrid::SkyGrid(StelCore::FrameType frame) : color(0.2,0.2,0.2), frameType(frame)
+SkyGrid::SkyGrid(StelCore::FrameType frame) : color(0.2,0.2,0.2), frameType(frame), labelsGeometry(Q_NULLPTR)
 {
 	// Font size is 12
 	font.setPixelSize(StelApp::getInstance().getScreenFontSize()-1);
+	flagStaticBuffers = StelApp::getInstance().getSettings()->value("video/flag_static_grid_buffers", true).toBool()
+			    && !StelApp::getInstance().isHeadless();
 }
 
 SkyGrid::~SkyGrid()
 {
+	for (auto* geometry : geometries)
+	{
+		geometry->buffer.destroy();
+		StelApp::getInstance().getTextureManager().unregisterGLBuffer(geometry);
+		delete geometry;
+	}
+	qDeleteAll(programs);
 }
 
 void SkyGrid::setFontSize(int newFontSize)
@@ -407,6 +475,8 @@ void SkyGrid::draw(const StelCore* core) const
 
 	// Initialize a painter and set OpenGL state
 	StelPainter sPainter(prj);
+	// The many short arcs of the grid can be merged in a few draw calls.
+	sPainter.setBatching(true);
 	sPainter.setBlending(true);
 	sPainter.setLineSmooth(true);
 
@@ -419,6 +489,12 @@ void SkyGrid::draw(const StelCore* core) const
 	userData.textColor = textColor;
 	userData.frameType = frameType;
 
+	if (drawStatic(prj, sPainter, userData, gridStepMeridianRad, gridStepParallelRad))
+	{
+		sPainter.setLineSmooth(false);
+		return;
+	}
+
 	/////////////////////////////////////////////////
 	// Draw all the meridians (great circles)
 	SphericalCap meridianSphericalCap(Vec3d(1,0,0), 0);
@@ -609,14 +685,252 @@ void SkyGrid::draw(const StelCore* core) const
 	sPainter.setLineSmooth(false);
 }
 
+SkyGrid::GridGeometry* SkyGrid::getGeometry(double gridStepMeridianRad, double gridStepParallelRad) const
+{
+	// The steps in 1/1000 arcsec
+	const QPair<qint64, qint64> key(qRound64(gridStepMeridianRad*180./M_PI*3600000.), qRound64(gridStepParallelRad*180./M_PI*3600000.));
+	GridGeometry* geometry = geometries.value(key, Q_NULLPTR);
+	if (geometry)
+		return geometry;
+	// The zoom goes through a few steps only
+	if (geometries.size()>=4)
+	{
+		for (auto* g : geometries)
+		{
+			g->buffer.destroy();
+			StelApp::getInstance().getTextureManager().unregisterGLBuffer(g);
+			delete g;
+		}
+		geometries.clear();
+		labelsGeometry = Q_NULLPTR;
+	}
+
+	geometry = new GridGeometry();
+	// Segments of at most 0.5 degree, and at least 64 per line for the parallels near the poles
+	const double maxSegment = 0.5*M_PI/180.;
+	auto addLine = [geometry](bool meridian, double angle, int count, std::function<Vec3f(double)> point)
+	{
+		GridLine line;
+		line.start = geometry->points.size();
+		line.count = count;
+		line.meridian = meridian;
+		line.angle = angle;
+		for (int i=0; i<count; ++i)
+			geometry->points.append(point(2.*M_PI*i/count));
+		geometry->lines.append(line);
+	};
+	// Each meridian circle has the meridians of angle and angle+180 deg
+	const int meridianCount = qRound(M_PI/gridStepMeridianRad);
+	const int meridianPoints = static_cast<int>(std::ceil(2.*M_PI/maxSegment));
+	for (int i=0; i<meridianCount; ++i)
+	{
+		const double lon = i*gridStepMeridianRad;
+		const Vec3d axis(std::cos(lon), std::sin(lon), 0.);
+		addLine(true, lon, meridianPoints, [axis](double t) {
+			return Vec3f(axis[0]*std::cos(t), axis[1]*std::cos(t), std::sin(t));
+		});
+	}
+	const int parallelCount = static_cast<int>(std::ceil(M_PI_2/gridStepParallelRad))-1;
+	for (int i=-parallelCount; i<=parallelCount; ++i)
+	{
+		const double lat = i*gridStepParallelRad;
+		const double r = std::cos(lat), z = std::sin(lat);
+		addLine(false, lat, qMax(64, static_cast<int>(std::ceil(2.*M_PI*r/maxSegment))), [r, z](double t) {
+			return Vec3f(r*std::cos(t), r*std::sin(t), z);
+		});
+	}
+
+	QVector<Vec3f> segments;
+	segments.reserve(geometry->points.size()*2);
+	for (const auto& line : geometry->lines)
+	{
+		for (int i=0; i<line.count; ++i)
+		{
+			segments.append(geometry->points.at(line.start+i));
+			segments.append(geometry->points.at(line.start+(i+1)%line.count));
+		}
+	}
+	geometry->vertexCount = segments.size();
+	geometry->buffer.create();
+	geometry->buffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+	geometry->buffer.bind();
+	geometry->buffer.allocate(segments.constData(), segments.size()*sizeof(Vec3f));
+	geometry->buffer.release();
+	StelApp::getInstance().getTextureManager().registerGLBuffer(geometry, "SkyGrid", segments.size()*sizeof(Vec3f));
+	geometries.insert(key, geometry);
+	return geometry;
+}
+
+QOpenGLShaderProgram* SkyGrid::getProgram(const QByteArray& projectorShader) const
+{
+	QOpenGLShaderProgram* program = programs.value(projectorShader, Q_NULLPTR);
+	if (program)
+		return program;
+
+	// The segments with an end which can not be projected are not drawn, like with StelPainter
+	QOpenGLShader vshader(QOpenGLShader::Vertex);
+	const QByteArray vsrc =
+		"attribute highp vec3 vertex;\n"
+		"uniform mediump mat4 projectionMatrix;\n"
+		"varying mediump float valid;\n"
+		+ projectorShader +
+		"void main(void)\n"
+		"{\n"
+		"    vec4 win = projectToViewport(vertex);\n"
+		"    gl_Position = projectionMatrix * vec4(win.xyz, 1.);\n"
+		"    valid = win.w;\n"
+		"}\n";
+	vshader.compileSourceCode(vsrc);
+	if (!vshader.log().isEmpty()) { qWarning() << "SkyGrid::getProgram(): Warnings while compiling vshader: " << vshader.log(); }
+
+	QOpenGLShader fshader(QOpenGLShader::Fragment);
+	const char* fsrc =
+		"varying mediump float valid;\n"
+		"uniform mediump vec4 color;\n"
+		"void main(void)\n"
+		"{\n"
+		"    if (valid < 0.999)\n"
+		"        discard;\n"
+		"    gl_FragColor = color;\n"
+		"}\n";
+	fshader.compileSourceCode(fsrc);
+	if (!fshader.log().isEmpty()) { qWarning() << "SkyGrid::getProgram(): Warnings while compiling fshader: " << fshader.log(); }
+
+	program = new QOpenGLShaderProgram();
+	program->addShader(&vshader);
+	program->addShader(&fshader);
+	if (!StelPainter::linkProg(program, "skyGridShader"))
+	{
+		// Do not try again, StelPainter will draw the grids
+		qWarning() << "SkyGrid: cannot link shader, static grid buffers disabled";
+		flagStaticBuffers = false;
+		delete program;
+		return Q_NULLPTR;
+	}
+	programs.insert(projectorShader, program);
+	return program;
+}
+
+void SkyGrid::updateLabels(const StelProjectorP& prj, const GridGeometry* geometry) const
+{
+	labels.clear();
+	// The cap is in the frame of the grid
+	const SphericalCap& viewportCap = prj->getBoundingCap();
+	const Vec3d& capCenter = viewportCap.n;
+	// Sine of the radius of the cap, when it is smaller than a hemisphere
+	const double capSin = viewportCap.d>0. ? std::sqrt(1.-viewportCap.d*viewportCap.d) : 1.;
+	const double capRadius = viewportCap.d>0. ? std::acos(viewportCap.d) : M_PI;
+	const double capLat = std::asin(qBound(-1., capCenter[2], 1.));
+	Vec3d win1, win2;
+	for (int l=0; l<geometry->lines.size(); ++l)
+	{
+		const GridLine& line = geometry->lines.at(l);
+		// Skip the lines which miss the cap
+		if (line.meridian)
+		{
+			const Vec3d normal(-std::sin(line.angle), std::cos(line.angle), 0.);
+			if (std::fabs(normal*capCenter)>capSin)
+				continue;
+		}
+		else if (std::fabs(line.angle-capLat)>capRadius)
+			continue;
+
+		const Vec3f& last = geometry->points.at(line.start+line.count-1);
+		bool valid1 = prj->project(Vec3d(last[0], last[1], last[2]), win1);
+		bool in1 = prj->checkInViewport(win1);
+		for (int i=0; i<line.count; ++i)
+		{
+			const Vec3f& p = geometry->points.at(line.start+i);
+			const bool valid2 = prj->project(Vec3d(p[0], p[1], p[2]), win2);
+			const bool in2 = prj->checkInViewport(win2);
+			// As in StelPainter::tessellateSmallCircleArc()
+			if (((valid1 && in1) || (valid2 && in2)) && in1!=in2)
+			{
+				GridLabel label;
+				label.screenPos = in1 ? prj->viewPortIntersect(win1, win2) : prj->viewPortIntersect(win2, win1);
+				label.direction = in1 ? win2-win1 : win1-win2;
+				label.line = l;
+				labels.append(label);
+			}
+			win1 = win2;
+			valid1 = valid2;
+			in1 = in2;
+		}
+	}
+}
+
+bool SkyGrid::drawStatic(const StelProjectorP& prj, StelPainter& sPainter, ViewportEdgeIntersectCallbackData& userData,
+			 double gridStepMeridianRad, double gridStepParallelRad) const
+{
+	// Segments crossing a discontinuity must be removed on the CPU, fine steps would need too many lines
+	if (!flagStaticBuffers || prj->hasDiscontinuity() || gridStepMeridianRad<M_PI/180.*0.999 || gridStepParallelRad<M_PI/180.*0.999)
+		return false;
+	const QByteArray projectorShader = prj->getForwardTransformShader();
+	if (projectorShader.isEmpty())
+		return false;
+	QOpenGLShaderProgram* program = getProgram(projectorShader);
+	if (!program)
+		return false;
+	const GridGeometry* geometry = getGeometry(gridStepMeridianRad, gridStepParallelRad);
+
+	const Mat4f& m = prj->getProjectionMatrix();
+	const QMatrix4x4 qMat(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
+	const Vec4f& color = sPainter.getColor();
+	program->bind();
+	program->setUniformValue("projectionMatrix", qMat);
+	program->setUniformValue("color", color[0], color[1], color[2], color[3]);
+	prj->setForwardTransformUniforms(*program);
+	const int vertexLoc = program->attributeLocation("vertex");
+	geometry->buffer.bind();
+	program->setAttributeBuffer(vertexLoc, GL_FLOAT, 0, 3);
+	program->enableAttributeArray(vertexLoc);
+	sPainter.glFuncs()->glDrawArrays(GL_LINES, 0, geometry->vertexCount);
+	program->disableAttributeArray(vertexLoc);
+	geometry->buffer.release();
+	program->release();
+
+	// The labels only move with the view
+	const StelCore* core = StelApp::getInstance().getCore();
+	const StelProjector::StelProjectorParams params = core->getCurrentStelProjectorParams();
+	const Mat4d modelView = prj->getModelViewTransform()->getApproximateLinearTransfo();
+	QVector<double> viewKey;
+	for (int i=0; i<16; ++i)
+		viewKey << modelView[i];
+	viewKey << params.viewportXywh[0] << params.viewportXywh[1] << params.viewportXywh[2] << params.viewportXywh[3]
+		<< params.fov << params.viewportCenter[0] << params.viewportCenter[1] << params.flipHorz << params.flipVert
+		<< params.widthStretch << params.devicePixelsPerPixel << params.visibleDiskRadius;
+	if (geometry!=labelsGeometry || viewKey!=labelsViewKey || prj->getNameI18()!=labelsProjection)
+	{
+		updateLabels(prj, geometry);
+		labelsGeometry = geometry;
+		labelsViewKey = viewKey;
+		labelsProjection = prj->getNameI18();
+	}
+
+	const bool withDecimalDegree = StelApp::getInstance().getFlagShowDecimalDegrees();
+	for (const auto& label : labels)
+	{
+		const GridLine& line = geometry->lines.at(label.line);
+		if (line.meridian)
+		{
+			// The callback chooses between both meridians of the circle
+			userData.raAngle = line.angle;
+			userData.text.clear();
+		}
+		else
+			userData.text = withDecimalDegree ? StelUtils::radToDecDegStr(line.angle) : StelUtils::radToDmsStrAdapt(line.angle);
+		viewportEdgeIntersectCallback(label.screenPos, label.direction, &userData);
+	}
+	return true;
+}
+
 
 SkyLine::SkyLine(SKY_LINE_TYPE _line_type) : line_type(_line_type), color(0.f, 0.f, 1.f)
 {
 	// Font size is 14
 	font.setPixelSize(StelApp::getInstance().getScreenFontSize()+1);
 
-	earth = GETSTELMODULE(SolarSystem)->getEarth();
-	sun = GETSTELMODULE(SolarSystem)->getSun();
+	ssystem = GETSTELMODULE(SolarSystem);
 
 	updateLabel();
 }
@@ -710,6 +1024,7 @@ void SkyLine::draw(StelCore *core) const
 
 	// Initialize a painter and set openGL state
 	StelPainter sPainter(prj);
+	sPainter.setBatching(true);
 	sPainter.setColor(color[0], color[1], color[2], fader.getInterstate());
 	sPainter.setBlending(true);
 	sPainter.setLineSmooth(true);
@@ -808,14 +1123,8 @@ void SkyLine::draw(StelCore *core) const
 	}
 	if (line_type==LONGITUDE)
 	{
-		Vec3d coord;		
-		double eclJDE = earth->getRotObliquity(core->getJDE());
-		double ra_equ, dec_equ, lambdaJDE, betaJDE;
-
-		StelUtils::rectToSphe(&ra_equ,&dec_equ, sun->getEquinoxEquatorialPos(core));
-		StelUtils::equToEcl(ra_equ, dec_equ, eclJDE, &lambdaJDE, &betaJDE);
-		if (lambdaJDE<0) lambdaJDE+=2.0*M_PI;
-
+		Vec3d coord;
+		const double lambdaJDE = ssystem->getSunOfDate(core).eclipticLongitude;
 		StelUtils::spheToRect(lambdaJDE + M_PI/2., 0., coord);
 		meridianSphericalCap.n.set(coord[0],coord[1],coord[2]);
 		fpt.set(0,0,1);
@@ -867,8 +1176,7 @@ SkyPoint::SkyPoint(SKY_POINT_TYPE _point_type) : point_type(_point_type), color(
 	font.setPixelSize(StelApp::getInstance().getScreenFontSize()+1);
 	texCross = StelApp::getInstance().getTextureManager().createTexture(StelFileMgr::getInstallationDir()+"/textures/cross.png");
 
-	earth = GETSTELMODULE(SolarSystem)->getEarth();
-	sun = GETSTELMODULE(SolarSystem)->getSun();
+	ssystem = GETSTELMODULE(SolarSystem);
 
 	updateLabel();
 }
@@ -1060,13 +1368,7 @@ void SkyPoint::draw(StelCore *core) const
 		{
 			// Antisolar Point
 			Vec3d coord;
-			double eclJDE = earth->getRotObliquity(core->getJDE());
-			double ra_equ, dec_equ, lambdaJDE, betaJDE;
-
-			StelUtils::rectToSphe(&ra_equ,&dec_equ, sun->getEquinoxEquatorialPos(core));
-			StelUtils::equToEcl(ra_equ, dec_equ, eclJDE, &lambdaJDE, &betaJDE);
-			if (lambdaJDE<0) lambdaJDE+=2.0*M_PI;
-
+			const double lambdaJDE = ssystem->getSunOfDate(core).eclipticLongitude;
 			StelUtils::spheToRect(lambdaJDE + M_PI, 0., coord);
 
 			sPainter.drawSprite2dMode(coord, 5.f);
@@ -61,7 +61,7 @@ void HighlightMgr::init()
 
 void HighlightMgr::deinit()
 {
-	highlightList.clear();
+	cleanHighlightList();
 	texPointer.clear();
 }
 
@@ -126,12 +126,47 @@ const Vec3f& HighlightMgr::getHighlightColor(void) const
 
 void HighlightMgr::fillHighlightList(QList<Vec3d> list)
 {
-	highlightList = list;
+	cleanHighlightList();
+	highlightList.reserve(list.size());
+	for (auto& pos : list)
+	{
+		Highlight highlight;
+		highlight.pos = pos;
+		highlight.pos.normalize();
+		highlight.style = -1;
+		highlightList.append(highlight);
+	}
+}
+
+int HighlightMgr::addHighlights(const QVariantList& ra, const QVariantList& dec, const QString& color)
+{
+	int style = -1;
+	if (!color.isEmpty())
+	{
+		const Vec3f c = StelUtils::htmlColorToVec3f(color);
+		style = highlightColors.indexOf(c);
+		if (style<0)
+		{
+			style = highlightColors.size();
+			highlightColors.append(c);
+		}
+	}
+	const int count = qMin(ra.size(), dec.size());
+	highlightList.reserve(highlightList.size()+count);
+	for (int i=0; i<count; ++i)
+	{
+		Highlight highlight;
+		StelUtils::spheToRect(StelUtils::getDecAngleFromVariant(ra.at(i)), StelUtils::getDecAngleFromVariant(dec.at(i)), highlight.pos);
+		highlight.style = style;
+		highlightList.append(highlight);
+	}
+	return count;
 }
 
 void HighlightMgr::cleanHighlightList()
 {
 	highlightList.clear();
+	highlightColors.clear();
 }
 
 void HighlightMgr::setMarkersSize(const float size)
@@ -146,21 +181,27 @@ float HighlightMgr::getMarkersSize() const
 
 void HighlightMgr::drawHighlights(StelCore* core, StelPainter& painter)
 {
-	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
-
-	if (!highlightList.empty())
+	Q_UNUSED(core);
+	if (highlightList.empty())
+		return;
+
+	const StelProjectorP prj = painter.getProjector();
+	const SphericalCap& viewportCap = prj->getBoundingCap();
+	const float rotation = StelApp::getInstance().getTotalRunTime()*40.f;
+	texPointer->bind();
+	painter.setBlending(true);
+	// The sprites of all highlights are merged in one draw call, whatever their colors
+	painter.setBatching(true);
+	Vec3d screenpos;
+	for (const auto& highlight : highlightList)
 	{
-		Vec3d screenpos;
-		for (const auto& hlObj : highlightList)
-		{
-			// Compute 2D pos and return if outside screen
-			if (!painter.getProjector()->project(hlObj, screenpos))
-				continue;
-
-			painter.setColor(hightlightColor[0], hightlightColor[1], hightlightColor[2]);
-			texPointer->bind();
-			painter.setBlending(true);
-			painter.drawSprite2dMode(screenpos[0], screenpos[1], markerSize, StelApp::getInstance().getTotalRunTime()*40.f);
-		}
+		// Compute 2D pos and skip if outside screen
+		if (!viewportCap.contains(highlight.pos) || !prj->project(highlight.pos, screenpos))
+			continue;
+
+		const Vec3f& color = highlight.style<0 ? hightlightColor : highlightColors.at(highlight.style);
+		painter.setColor(color[0], color[1], color[2]);
+		painter.drawSprite2dMode(screenpos[0], screenpos[1], markerSize, rotation);
 	}
+	painter.setBatching(false);
 }
@@ -24,6 +24,8 @@
 #include "StelTextureTypes.hpp"
 
 #include <QList>
+#include <QVariantList>
+#include <QVector>
 
 class StelPainter;
 class QSettings;
@@ -103,15 +105,37 @@ public slots:
 	//! @param list - list of coordinates of the highlights
 	void fillHighlightList(QList<Vec3d> list);
 
+	//! Add many highlight markers at once, e.g. the targets of an observing list.
+	//! @param ra - right ascension angles (J2000.0) of the highlights, in degrees or as strings like "2h10m15s"
+	//! @param dec - declination angles (J2000.0) of the highlights, in degrees or as strings like "60d01m15s"
+	//! @param color - HTML-like color of these highlights, e.g. "#ff0000", or empty for the color of setHighlightColor()
+	//! @return the number of highlights added, the shortest of the lists
+	//! @code
+	//! // example of usage in scripts
+	//! HighlightMgr.addHighlights([10.68, "5h35m17s"], [41.27, "-5d23m28s"], "#ff0000");
+	//! @endcode
+	int addHighlights(const QVariantList& ra, const QVariantList& dec, const QString& color="");
+
 	//! Clean the list of highlight markers
 	void cleanHighlightList();
 
+	//! Get the number of highlight markers
+	int getHighlightCount() const { return highlightList.size(); }
 
 private:
+	struct Highlight
+	{
+		Vec3d pos;	// J2000, normalized for the culling
+		//! Index in highlightColors, -1 for hightlightColor
+		int style;
+	};
+
 	// Font used for displaying our text
 	QSettings* conf;
 	StelTextureSP texPointer;
-	QList<Vec3d> highlightList;
+	QVector<Highlight> highlightList;
+	//! The colors of the highlights added by addHighlights()
+	QVector<Vec3f> highlightColors;
 
 	Vec3f hightlightColor;
 	float markerSize;
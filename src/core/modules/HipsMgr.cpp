@@ -26,7 +26,12 @@
 #include "StelModuleMgr.hpp"
 #include "StelSkyLayerMgr.hpp"
 #include "StelUtils.hpp"
+#include "StelFileMgr.hpp"
+#include "StelFileCache.hpp"
+#include "StelHipsPack.hpp"
 
+#include <QDir>
+#include <QFileInfo>
 #include <QNetworkReply>
 #include <QSettings>
 #include <QTimer>
@@ -71,6 +76,18 @@ HipsMgr::~HipsMgr()
 		conf->endArray();
 	}
 
+	conf->remove("packs");
+	if (!packs.isEmpty())
+	{
+		conf->beginWriteArray("packs");
+		for (int i = 0; i < packs.size(); i++)
+		{
+			conf->setArrayIndex(i);
+			conf->setValue("path", packs.at(i));
+		}
+		conf->endArray();
+	}
+
 	conf->endGroup();
 	conf->sync();
 }
@@ -106,11 +123,25 @@ void HipsMgr::loadSources()
 		QNetworkReply* networkReply = StelApp::getInstance().getNetworkAccessManager()->get(req);
 		connect(networkReply, &QNetworkReply::finished, [=] {
 			QByteArray data = networkReply->readAll();
-			QList<HipsSurveyP> newSurveys = HipsSurvey::parseHipslist(data);
-			for (HipsSurveyP survey: newSurveys)
+			// When offline, use the list of the last session.
+			const QSharedPointer<StelFileCache> cache = HipsSurvey::diskCache;
+			if (cache && source.scheme() != "file")
+			{
+				if (networkReply->error() == QNetworkReply::NoError && !data.isEmpty())
+					cache->write(source.url(), data);
+				else
+					data = cache->read(source.url());
+			}
+			networkReply->deleteLater();
+			QList<HipsSurveyP> newSurveys;
+			for (HipsSurveyP survey: HipsSurvey::parseHipslist(data))
 			{
+				// The surveys of the mounted packs are already known.
+				if (getSurveyByUrl(survey->getUrl()))
+					continue;
 				connect(survey.data(), SIGNAL(propertiesChanged()), this, SIGNAL(surveysChanged()));
 				emit gotNewSurvey(survey);
+				newSurveys.append(survey);
 			}
 			surveys += newSurveys;
 			emit surveysChanged();
@@ -133,7 +164,26 @@ void HipsMgr::init()
 	int size = conf->beginReadArray("surveys");
 	conf->endArray();
 	bool hasVisibleSurvey = size>0 ? true: false;
+
+	// The downloaded tiles are kept on disk, so that the surveys can also be shown offline.
+	const int cacheSizeMB = conf->value("cache_size_mb", 1024).toInt();
+	if (cacheSizeMB > 0)
+		HipsSurvey::diskCache.reset(new StelFileCache(StelFileMgr::getCacheDir() + "/hips", ".dat", static_cast<qint64>(cacheSizeMB)*1024*1024, false));
+
+	QStringList packFiles;
+	size = conf->beginReadArray("packs");
+	for (int i = 0; i < size; i++)
+	{
+		conf->setArrayIndex(i);
+		packFiles << conf->value("path").toString();
+	}
+	conf->endArray();
 	conf->endGroup();
+	const QDir packDir(StelFileMgr::getUserDir() + "/hips");
+	for (const auto& info : packDir.entryInfoList(QStringList("*.hipspack"), QDir::Files))
+		packFiles << info.absoluteFilePath();
+	for (const auto& fileName : packFiles)
+		mountPack(fileName);
 
 	addAction("actionShow_Hips_Surveys", N_("Display Options"), N_("Toggle Hierarchical Progressive Surveys (experimental)"), "flagShow", "Ctrl+Alt+D");
 
@@ -195,6 +245,17 @@ void HipsMgr::update(double deltaTime)
 	}
 }
 
+int HipsMgr::getPendingTiles() const
+{
+	int pending = 0;
+	for (const auto& survey: surveys)
+	{
+		if (survey->isVisible())
+			pending += survey->nbVisibleTiles - survey->nbLoadedTiles;
+	}
+	return pending;
+}
+
 double HipsMgr::getCallOrder(StelModuleActionName actionName) const
 {
 	if (actionName==StelModule::ActionDraw)
@@ -202,6 +263,59 @@ double HipsMgr::getCallOrder(StelModuleActionName actionName) const
 	return 0;
 }
 
+bool HipsMgr::mountPack(const QString& fileName)
+{
+	const QString path = QFileInfo(fileName).absoluteFilePath();
+	if (packs.contains(path))
+		return true;
+	QSharedPointer<HipsPack> pack(new HipsPack());
+	if (!pack->open(path))
+		return false;
+
+	HipsSurveyP survey = getSurveyByUrl(pack->getSurveyUrl());
+	if (!survey)
+	{
+		survey = HipsSurveyP(new HipsSurvey(pack->getSurveyUrl()));
+		connect(survey.data(), SIGNAL(propertiesChanged()), this, SIGNAL(surveysChanged()));
+		surveys.append(survey);
+		emit gotNewSurvey(survey);
+	}
+	else if (survey->pack)
+		packs.removeOne(survey->pack->getFileName());
+	survey->setPack(pack);
+	packs.append(path);
+	emit surveysChanged();
+	return true;
+}
+
+bool HipsMgr::createPack(const QString& surveyUrl, double lon, double lat, double radius, int minOrder, int maxOrder, const QString& fileName)
+{
+	HipsSurveyP survey = getSurveyByUrl(surveyUrl);
+	if (!survey || survey->properties.isEmpty())
+	{
+		qWarning() << "Cannot create HiPS pack: the properties of" << surveyUrl << "are not loaded";
+		return false;
+	}
+	Vec3d center;
+	StelUtils::spheToRect(lon * M_PI / 180., lat * M_PI / 180., center);
+	if (survey->hipsFrame == "galactic")
+		center = StelApp::getInstance().getCore()->j2000ToGalactic(center);
+	const QString path = QFileInfo(fileName).absoluteFilePath();
+	HipsPackBuilder* builder = survey->createPack(path, center, radius * M_PI / 180., minOrder, maxOrder);
+	if (!builder)
+		return false;
+	connect(builder, &HipsPackBuilder::finished, this, [this](const QString& packFile, bool ok) {
+		if (ok)
+		{
+			// A pack replacing a mounted one is opened again.
+			packs.removeOne(packFile);
+			mountPack(packFile);
+		}
+		emit packCreated(packFile, ok);
+	});
+	return true;
+}
+
 HipsSurveyP HipsMgr::getSurveyByUrl(const QString &url)
 {
 	for (auto survey: surveys)
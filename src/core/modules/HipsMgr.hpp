@@ -67,23 +67,49 @@ public:
 	State getState() const {return state;}
 	bool isLoaded() const {return state == Loaded;}
 
+	//! Get the number of tiles which the visible surveys drew in the last frame but are still loading.
+	int getPendingTiles() const;
+
 signals:
 	void showChanged(bool value) const;
 	void surveysChanged() const;
 	void stateChanged(State value) const;
 	//! Emitted when a new survey has been loaded.
 	void gotNewSurvey(HipsSurveyP survey) const;
+	//! Emitted when a pack started by createPack() is written, or when it failed.
+	void packCreated(const QString& fileName, bool ok) const;
 
 public slots:
 	//! Start to load the default sources.
 	void loadSources();
 
+	//! Mount an offline pack of a survey, so that its tiles are read from the pack instead of the network.
+	//! The survey is added if it is not known yet. Mounted packs are mounted again in the next sessions,
+	//! as well as the files with the .hipspack extension in the hips directory of the user data directory.
+	//! @return false if the file is not a valid pack
+	bool mountPack(const QString& fileName);
+
+	//! Download the tiles of a region of a survey to an offline pack, which is mounted when it is complete.
+	//! The survey properties must be loaded. The download runs in the background, see packCreated().
+	//! @param surveyUrl the URL of the survey
+	//! @param lon the longitude of the center of the region in degrees: right ascension J2000 for sky surveys,
+	//! longitude for planetary surveys
+	//! @param lat the latitude of the center of the region in degrees
+	//! @param radius the radius of the region in degrees
+	//! @param minOrder the lowest order of the tiles to store, at least the lowest order of the survey
+	//! @param maxOrder the highest order of the tiles to store, at most the highest order of the survey
+	//! @param fileName the pack file to write
+	//! @return false if the pack can not be created
+	bool createPack(const QString& surveyUrl, double lon, double lat, double radius, int minOrder, int maxOrder, const QString& fileName);
+
 private slots:
 	// after loading survey list from network, restore the visible surveys from config.ini.
 	void restoreVisibleSurveys();
 
 private:
 	QList<HipsSurveyP> surveys;
+	//! The file names of the mounted packs
+	QStringList packs;
 	bool visible = true;
 	State state = Created;
 	//! Used internally to keep track of the loading state.
@@ -37,6 +37,7 @@
 #include <QString>
 #include <QDebug>
 #include <QTimer>
+#include <QVector>
 
 // Base class from which other label types inherit
 class StelLabel
@@ -162,6 +163,32 @@ private:
 	int screenY;
 };
 
+//! @class PointLabels
+//! Used to create many user labels of the same style at once, which are bound to celestial coordinates.
+//! The positions and texts are stored in contiguous arrays, the positions out of the viewport are skipped
+//! before their projection, and the texts go to the text atlas in one batch.
+class PointLabels : public StelLabel
+{
+public:
+	//! @param texts the texts for the labels
+	//! @param positions the J2000 positions of the labels, normalized
+	//! @param font the font to use
+	//! @param color the color for the labels
+	//! @param distance the distance in pixels between the position and the left of its text
+	PointLabels(const QStringList& texts, const QVector<Vec3d>& positions, const QFont& font, const Vec3f& color, double distance);
+	virtual ~PointLabels();
+
+	//! draw the labels on the sky
+	//! @param core the StelCore object
+	//! @param sPainter the StelPainter to use for drawing operations
+	virtual bool draw(StelCore* core, StelPainter& sPainter);
+
+private:
+	QStringList texts;
+	QVector<Vec3d> positions;
+	double labelDistance;
+};
+
 /////////////////////
 // StelLabel class //
 /////////////////////
@@ -381,6 +408,44 @@ bool ScreenLabel::draw(StelCore*, StelPainter& sPainter)
 	return true;
 }
 
+///////////////////////
+// PointLabels class //
+///////////////////////
+PointLabels::PointLabels(const QStringList& texts, const QVector<Vec3d>& positions, const QFont& font, const Vec3f& color, double distance)
+	: StelLabel(QString(), font, color),
+	  texts(texts),
+	  positions(positions),
+	  labelDistance(distance)
+{
+}
+
+PointLabels::~PointLabels()
+{
+}
+
+bool PointLabels::draw(StelCore*, StelPainter& sPainter)
+{
+	if (labelFader.getInterstate() <= 0.0)
+		return false;
+
+	const StelProjectorP prj = sPainter.getProjector();
+	const SphericalCap& viewportCap = prj->getBoundingCap();
+	sPainter.setFont(labelFont);
+	sPainter.setColor(labelColor[0], labelColor[1], labelColor[2], labelFader.getInterstate());
+	// Vertically centered on the right of the positions
+	const double yOffset = -sPainter.getFontMetrics().height() / 2.;
+	const bool batching = sPainter.getBatching();
+	sPainter.setBatching(true);
+	Vec3d labelXY;
+	for (int i=0; i<positions.size(); ++i)
+	{
+		if (viewportCap.contains(positions.at(i)) && prj->projectCheck(positions.at(i), labelXY))
+			sPainter.drawText(labelXY[0]+labelDistance, labelXY[1]+yOffset, texts.at(i), 0, 0, 0, false);
+	}
+	sPainter.setBatching(batching);
+	return true;
+}
+
 ///////////////////////
 // LabelMgr class //
 ///////////////////////
@@ -532,6 +597,32 @@ int LabelMgr::labelScreen(const QString& text,
 	return appendLabel(l, autoDeleteTimeoutMs);
 }
 
+int LabelMgr::labelEquatorial(const QStringList& texts,
+			      const QVariantList& ra,
+			      const QVariantList& dec,
+			      bool visible,
+			      float fontSize,
+			      const QString& fontColor,
+			      double labelDistance,
+			      bool autoDelete,
+			      int autoDeleteTimeoutMs)
+{
+	const int count = qMin(texts.size(), qMin(ra.size(), dec.size()));
+	QVector<Vec3d> positions(count);
+	for (int i=0; i<count; ++i)
+		StelUtils::spheToRect(StelUtils::getDecAngleFromVariant(ra.at(i)), StelUtils::getDecAngleFromVariant(dec.at(i)), positions[i]);
+
+	QFont font;
+	font.setPixelSize(fontSize);
+	PointLabels* l = new PointLabels(texts.mid(0, count), positions, font, StelUtils::htmlColorToVec3f(fontColor), labelDistance);
+	if (visible)
+		l->setFlagShow(true);
+
+	l->autoDelete = autoDelete;
+
+	return appendLabel(l, autoDeleteTimeoutMs);
+}
+
 bool LabelMgr::getLabelShow(int id) const
 {
 	return allLabels[id]->getFlagShow();
@@ -25,6 +25,8 @@
 
 #include <QMap>
 #include <QString>
+#include <QStringList>
+#include <QVariantList>
 
 class StelCore;
 class StelPainter;
@@ -125,6 +127,34 @@ public slots:
 					bool autoDelete = false,
 					int autoDeleteTimeoutMs = 0);
 
+	//! Create labels of the same style at many celestial coordinates at once, e.g. for the targets of an
+	//! observing list. They are shown, hidden and deleted together, with the single ID which is returned.
+	//! Labelling hundreds of positions this way is much faster than with one labelObject() per position.
+	//! @param texts the texts to display
+	//! @param ra right ascension angles (J2000.0) of the labels, in degrees or as strings like "2h10m15s"
+	//! @param dec declination angles (J2000.0) of the labels, in degrees or as strings like "60d01m15s"
+	//! @param visible if true, the labels start displayed, else they start hidden
+	//! @param fontSize size of the font to use
+	//! @param fontColor HTML-like color spec, e.g. "#ffff00" for yellow
+	//! @param labelDistance the distance in pixels between each position and the left of its text
+	//! @param autoDelete the labels will be automatically deleted after they are displayed once
+	//! @param autoDeleteTimeoutMs if not zero, the labels will be automatically deleted after
+	//! autoDeleteTimeoutMs ms
+	//! @return a unique ID which can be used to refer to the labels, setLabelText() does not change them.
+	//! @code
+	//! // example of usage in scripts
+	//! LabelMgr.labelEquatorial(["Field 1", "Field 2"], [10.68, "5h35m17s"], [41.27, "-5d23m28s"]);
+	//! @endcode
+	int labelEquatorial(const QStringList& texts,
+			    const QVariantList& ra,
+			    const QVariantList& dec,
+			    bool visible=true,
+			    float fontSize=14,
+			    const QString& fontColor="#999999",
+			    double labelDistance=5.0,
+			    bool autoDelete = false,
+			    int autoDeleteTimeoutMs = 0);
+
 	//! find out if a label identified by id is presently shown
 	bool getLabelShow(int id) const;
 	//! set a label identified by id to be shown or not
@@ -31,12 +31,19 @@
 #include "StelLocaleMgr.hpp"
 
 #include <QDebug>
+#include <QHash>
+#include <QMatrix4x4>
+#include <QOpenGLContext>
+#include <QOpenGLShaderProgram>
 #include <QSettings>
 #include <QVarLengthArray>
 #include <QFile>
 #include <QDir>
+#include <QUrl>
 #include <QtAlgorithms>
 
+float Landscape::detailScale = 1.f;
+
 Landscape::Landscape(float _radius)
 	: radius(_radius)
 	, id("uninitialized")
@@ -122,6 +129,14 @@ void Landscape::loadCommon(const QSettings& landscapeIni, const QString& landsca
 		defaultExtinctionCoefficient = landscapeIni.value("location/atmospheric_extinction_coefficient", -1.0).toDouble();
 		defaultTemperature = landscapeIni.value("location/atmospheric_temperature", -1000.0).toDouble();
 		defaultPressure = landscapeIni.value("location/atmospheric_pressure", -2.0).toDouble(); // -2=no change! [-1=computeFromAltitude]
+
+		if (landscapeIni.contains("location/light_pollution_map"))
+		{
+			lightPollutionMap = LightPollutionMapP(new LightPollutionMap(
+				StelFileMgr::findFile("landscapes/" + landscapeId + "/" + landscapeIni.value("location/light_pollution_map").toString())));
+			if (!lightPollutionMap->isValid())
+				lightPollutionMap.clear();
+		}
 	}
 
 	// Set minimal brightness for landscape
@@ -243,6 +258,211 @@ void Landscape::createPolygonalHorizon(const QString& lineFileName, const float
 		horizonPolygon = allskyRegion2.getSubtraction(horizonPolygon);
 		//horizonPolygon=&aboveHorizonPolygon;
 	}
+	buildHorizonTable(horiPoints);
+}
+
+StelTextureSP Landscape::createLandscapeTexture(const QString& path, const StelTexture::StelTextureParams& params)
+{
+	// Decoded by a loader job, so that load() can run in a loader thread too
+	StelTextureSP tex = StelApp::getInstance().getTextureManager().createTextureThread(path, params, false);
+	if (tex)
+		textures.append(tex);
+	return tex;
+}
+
+bool Landscape::prepareResources()
+{
+	bool ready = true;
+	for (const auto& tex : textures)
+	{
+		if (tex->isLoaded() || tex->hasError())
+			continue;
+		// Textures unloaded by StelTextureMgr while the landscape was in the cache are loaded again.
+		if (!tex->isLoading())
+			tex->startLoading();
+		ready = false;
+	}
+	return ready;
+}
+
+void Landscape::uploadTextures()
+{
+	for (const auto& tex : textures)
+	{
+		if (tex->canBind() || tex->hasError())
+			continue;
+		tex->waitForLoaded();
+		tex->bind();
+	}
+}
+
+float Landscape::getOpacity(Vec3d azalt) const
+{
+	if(!validLandscape) return (azalt[2]>0.0 ? 0.0f : 1.0f);
+
+	if (angleRotateZOffset!=0.0f)
+		azalt.transfo4d(Mat4d::zrotation(angleRotateZOffset));
+
+	float opacity;
+	if (lookupHorizonTable(azalt, opacity))
+		return opacity;
+	return computeOpacity(azalt);
+}
+
+// One bin of the horizon table per arc minute of azimuth
+static const int horizonTableSize = 360*60;
+static const float horizonBinWidth = 2.*M_PI/horizonTableSize;
+
+static int getHorizonBin(const Vec3d& v)
+{
+	const int bin = static_cast<int>((std::atan2(v[1], v[0])+M_PI)/horizonBinWidth);
+	return qBound(0, bin, horizonTableSize-1);
+}
+
+bool Landscape::lookupHorizonTable(const Vec3d& azalt, float& opacity) const
+{
+	if (horizonTable.isEmpty())
+		return false;
+	const double length = azalt.length();
+	if (length==0.)
+		return false;
+	const HorizonBin& bin = horizonTable.at(getHorizonBin(azalt));
+	const double sinAlt = azalt[2]/length;
+	if (sinAlt < bin.sinLow)
+	{
+		opacity = bin.opacityBelow;
+		return true;
+	}
+	if (sinAlt > bin.sinHigh)
+	{
+		opacity = bin.opacityAbove;
+		return true;
+	}
+	return false;
+}
+
+// Widen the altitude ranges [low, high] of the bins crossed by the horizon over their neighbours, which also covers
+// the parts of the horizon between samples in adjacent bins, and fill the table. The opacities are found by calling
+// opacityAt(azimuth, altitude) below and above each range. Bins with an empty range have a constant opacity.
+template<typename OpacityFunction>
+static void fillHorizonTable(QVector<Landscape::HorizonBin>& table, const QVector<float>& low, const QVector<float>& high,
+			     OpacityFunction opacityAt)
+{
+	table.resize(horizonTableSize);
+	for (int i=0; i<horizonTableSize; ++i)
+	{
+		const int prev = (i+horizonTableSize-1)%horizonTableSize, next = (i+1)%horizonTableSize;
+		const float binLow = qMin(low.at(i), qMin(low.at(prev), low.at(next))) - horizonBinWidth;
+		const float binHigh = qMax(high.at(i), qMax(high.at(prev), high.at(next))) + horizonBinWidth;
+		const float az = -M_PI + (i+0.5f)*horizonBinWidth;
+		Landscape::HorizonBin& bin = table[i];
+		if (binLow > binHigh)
+		{
+			bin.sinLow = bin.sinHigh = 0.f;
+			bin.opacityBelow = bin.opacityAbove = opacityAt(az, 0.f);
+			continue;
+		}
+		bin.sinLow = binLow > -M_PI/2 ? std::sin(binLow) : -2.f;
+		bin.sinHigh = binHigh < M_PI/2 ? std::sin(binHigh) : 2.f;
+		bin.opacityBelow = binLow > -M_PI/2 ? opacityAt(az, binLow) : 0.f;
+		bin.opacityAbove = binHigh < M_PI/2 ? opacityAt(az, binHigh) : 0.f;
+	}
+}
+
+// Add the altitudes of the great circle arc from a to b to the bins it crosses, splitting it until the bins of
+// consecutive samples are adjacent. Returns false if the arc passes too close to the zenith or nadir.
+static void addHorizonSample(const Vec3d& v, int bin, QVector<float>& low, QVector<float>& high)
+{
+	const float alt = std::asin(qBound(-1., v[2], 1.));
+	low[bin] = qMin(low.at(bin), alt);
+	high[bin] = qMax(high.at(bin), alt);
+}
+
+static bool addHorizonArc(const Vec3d& a, const Vec3d& b, QVector<float>& low, QVector<float>& high, int depth=0)
+{
+	const int binA = getHorizonBin(a), binB = getHorizonBin(b);
+	const int distance = qMin(qAbs(binA-binB), horizonTableSize-qAbs(binA-binB));
+	if (distance<=1)
+	{
+		addHorizonSample(a, binA, low, high);
+		addHorizonSample(b, binB, low, high);
+		return true;
+	}
+	if (depth>=24)
+		return false;
+	Vec3d middle = a+b;
+	if (middle.normSquared()==0.)
+		return false;
+	middle.normalize();
+	return addHorizonArc(a, middle, low, high, depth+1) && addHorizonArc(middle, b, low, high, depth+1);
+}
+
+void Landscape::buildHorizonTable(const QVector<Vec3d>& horizonPoints)
+{
+	horizonTable.clear();
+	if (horizonPoints.size()<3 || horizonPolygon.isNull())
+		return;
+	QVector<float> low(horizonTableSize, M_PI), high(horizonTableSize, -M_PI);
+	for (int i=0; i<horizonPoints.size(); ++i)
+	{
+		Vec3d a = horizonPoints.at(i), b = horizonPoints.at((i+1)%horizonPoints.size());
+		a.normalize();
+		b.normalize();
+		if (!addHorizonArc(a, b, low, high))
+		{
+			// Azimuth does not describe a horizon which reaches the zenith: keep the polygon test only.
+			qDebug() << "Landscape" << id << ": horizon line too close to the zenith or nadir for an azimuth table.";
+			return;
+		}
+	}
+	const SphericalRegionP polygon = horizonPolygon;
+	fillHorizonTable(horizonTable, low, high, [polygon](float az, float alt) {
+		Vec3d v;
+		StelUtils::spheToRect(az, alt, v);
+		return polygon->contains(v) ? 1.0f : 0.0f;
+	});
+}
+
+void Landscape::buildHorizonTable()
+{
+	horizonTable.clear();
+	float minAlt, maxAlt;
+	getOpacityAltitudeRange(minAlt, maxAlt);
+	minAlt = qMax(minAlt-horizonBinWidth, static_cast<float>(-M_PI/2));
+	maxAlt = qMin(maxAlt+horizonBinWidth, static_cast<float>(M_PI/2));
+	if (maxAlt<=minAlt)
+		return;
+	// Sample the altitudes every 3 arc minutes, from both ends towards the horizon
+	const int nbSteps = qMax(1, static_cast<int>(std::ceil((maxAlt-minAlt)/(3.f*horizonBinWidth))));
+	const float step = (maxAlt-minAlt)/nbSteps;
+	auto opacityAt = [this](float az, float alt) {
+		Vec3d v;
+		StelUtils::spheToRect(az, alt, v);
+		return computeOpacity(v);
+	};
+	QVector<float> low(horizonTableSize), high(horizonTableSize);
+	for (int i=0; i<horizonTableSize; ++i)
+	{
+		const float az = -M_PI + (i+0.5f)*horizonBinWidth;
+		const float above = opacityAt(az, maxAlt);
+		int top = nbSteps;
+		while (top>0 && opacityAt(az, minAlt+(top-1)*step)==above)
+			--top;
+		if (top==0)
+		{
+			// Same opacity at all altitudes
+			low[i] = M_PI;
+			high[i] = -M_PI;
+			continue;
+		}
+		const float below = opacityAt(az, minAlt);
+		int bottom = 0;
+		while (bottom<top && opacityAt(az, minAlt+(bottom+1)*step)==below)
+			++bottom;
+		low[i] = minAlt+bottom*step;
+		high[i] = minAlt+top*step;
+	}
+	fillHorizonTable(horizonTable, low, high, opacityAt);
 }
 
 #include <iostream>
@@ -369,6 +589,9 @@ LandscapeOldStyle::LandscapeOldStyle(float _radius)
 	, drawGroundFirst(0)
 	, tanMode(false)
 	, calibrated(false)
+	, staticVertexBuffer(QOpenGLBuffer::VertexBuffer)
+	, staticIndexBuffer(QOpenGLBuffer::IndexBuffer)
+	, staticLayersState(-1)
 	, memorySize(sizeof(LandscapeOldStyle)) // start with just the known entries.
 {}
 
@@ -387,6 +610,13 @@ LandscapeOldStyle::~LandscapeOldStyle()
 		sidesImages.clear();
 	}
 	landscapeLabels.clear();
+	// Landscapes which were never drawn have no buffers, and may be deleted without context.
+	if (staticVertexBuffer.isCreated() && QOpenGLContext::currentContext())
+	{
+		staticVertexBuffer.destroy();
+		staticIndexBuffer.destroy();
+	}
+	StelApp::getInstance().getTextureManager().unregisterGLBuffer(this);
 }
 
 void LandscapeOldStyle::load(const QSettings& landscapeIni, const QString& landscapeId)
@@ -426,7 +656,7 @@ void LandscapeOldStyle::load(const QSettings& landscapeIni, const QString& lands
 		QString textureKey = QString("landscape/tex%1").arg(i);
 		QString textureName = landscapeIni.value(textureKey).toString();
 		const QString texturePath = getTexturePath(textureName, landscapeId);
-		sideTexs[i] = StelApp::getInstance().getTextureManager().createTexture(texturePath);
+		sideTexs[i] = createLandscapeTexture(texturePath);
 		// GZ: To query the textures, also keep an array of QImage*, but only
 		// if that query is not going to be prevented by the polygon that already has been loaded at that point...
 		if ( (!horizonPolygon) && calibrated ) { // for uncalibrated landscapes the texture is currently never queried, so no need to store.
@@ -440,7 +670,7 @@ void LandscapeOldStyle::load(const QSettings& landscapeIni, const QString& lands
 		if (textureName.length())
 		{
 			const QString lightTexturePath = getTexturePath(textureName, landscapeId);
-			sideTexs[nbSideTexs+i] = StelApp::getInstance().getTextureManager().createTexture(lightTexturePath);
+			sideTexs[nbSideTexs+i] = createLandscapeTexture(lightTexturePath);
 			if(sideTexs[nbSideTexs+i])
 				memorySize+=sideTexs[nbSideTexs+i]->getGlSize();
 		}
@@ -484,13 +714,13 @@ void LandscapeOldStyle::load(const QSettings& landscapeIni, const QString& lands
 	}
 	QString groundTexName = landscapeIni.value("landscape/groundtex").toString();
 	QString groundTexPath = getTexturePath(groundTexName, landscapeId);
-	groundTex = StelApp::getInstance().getTextureManager().createTexture(groundTexPath, StelTexture::StelTextureParams(true));
+	groundTex = createLandscapeTexture(groundTexPath, StelTexture::StelTextureParams(true));
 	if (groundTex)
 		memorySize+=groundTex->getGlSize();
 
 	QString fogTexName = landscapeIni.value("landscape/fogtex").toString();
 	QString fogTexPath = getTexturePath(fogTexName, landscapeId);
-	fogTex = StelApp::getInstance().getTextureManager().createTexture(fogTexPath, StelTexture::StelTextureParams(true, GL_LINEAR, GL_REPEAT));
+	fogTex = createLandscapeTexture(fogTexPath, StelTexture::StelTextureParams(true, GL_LINEAR, GL_REPEAT));
 	if (fogTex)
 		memorySize+=fogTex->getGlSize();
 
@@ -619,9 +849,245 @@ void LandscapeOldStyle::load(const QSettings& landscapeIni, const QString& lands
 			}
 		}
 	}
+	// The side images are only kept for calibrated landscapes without horizon polygon, see above.
+	bool imagesValid = !sidesImages.isEmpty();
+	for (auto* image : sidesImages)
+		imagesValid = imagesValid && !image->isNull();
+	if (imagesValid)
+	{
+		buildHorizonTable();
+		memorySize+=horizonTable.size()*sizeof(HorizonBin);
+	}
+	prepareStaticLayers();
 	//qDebug() << "OldStyleLandscape" << landscapeId << "loaded, mem size:" << memorySize;
 }
 
+void LandscapeOldStyle::prepareStaticLayers()
+{
+	staticVertices.clear();
+	staticIndices.clear();
+	staticDraws.clear();
+	auto addLayer = [this](StaticLayerType type, const StelTextureSP& tex, const QVector<Vec3d>& vertex, const QVector<Vec2f>& texCoords, const QVector<unsigned short>& indices)
+	{
+		if (vertex.size()>65536)
+			return;
+		StaticLayerDraw draw;
+		draw.type=type;
+		draw.vertexOffset=staticVertices.size()/5;
+		draw.indexOffset=staticIndices.size();
+		draw.indexCount=indices.size();
+		draw.tex=tex;
+		for (int i=0; i<vertex.size(); ++i)
+			staticVertices << vertex.at(i)[0] << vertex.at(i)[1] << vertex.at(i)[2] << texCoords.at(i)[0] << texCoords.at(i)[1];
+		staticIndices << indices;
+		staticDraws << draw;
+	};
+
+	QVector<Vec3d> vertex;
+	QVector<Vec2f> texCoords;
+	QVector<unsigned short> indices;
+	for (int i=0; i<groundVertexArr.size()/3; ++i)
+	{
+		vertex << Vec3d(groundVertexArr.at(3*i), groundVertexArr.at(3*i+1), groundVertexArr.at(3*i+2));
+		texCoords << Vec2f(groundTexCoordArr.at(2*i), groundTexCoordArr.at(2*i+1));
+		indices << i;
+	}
+	if (drawGroundFirst)
+		addLayer(StaticLayerGround, groundTex, vertex, texCoords, indices);
+
+	for (const auto& side : precomputedSides)
+	{
+		// The illumination panels follow the sides they are overlaid on, with the same geometry
+		if (side.light)
+		{
+			if (!staticDraws.isEmpty() && staticDraws.last().type==StaticLayerSide)
+				staticDraws.last().illumTex=side.tex;
+		}
+		else
+			addLayer(StaticLayerSide, side.tex, side.arr.vertex, side.arr.texCoords, side.arr.indices);
+	}
+
+	if (!drawGroundFirst)
+		addLayer(StaticLayerGround, groundTex, vertex, texCoords, indices);
+
+	// Same cylinder as StelPainter::sCylinder(radius, height, 64, 1), wound to be seen from inside with back face culling
+	static const int fogSlices=64;
+	const float height=getFogHeight();
+	vertex.clear();
+	texCoords.clear();
+	indices.clear();
+	for (int i=0; i<=fogSlices; ++i)
+	{
+		const float x=std::sin(2.f*M_PI*i/fogSlices);
+		const float y=std::cos(2.f*M_PI*i/fogSlices);
+		vertex << Vec3d(x*radius, y*radius, 0.) << Vec3d(x*radius, y*radius, height);
+		texCoords << Vec2f(static_cast<float>(i)/fogSlices, 0.f) << Vec2f(static_cast<float>(i)/fogSlices, 1.f);
+	}
+	for (int i=0; i<2*fogSlices; i+=2)
+		indices << i+1 << i << i+2 << i+1 << i+2 << i+3;
+	addLayer(StaticLayerFog, fogTex, vertex, texCoords, indices);
+
+	memorySize+=staticVertices.size()*sizeof(GLfloat)+staticIndices.size()*sizeof(unsigned short);
+}
+
+static QHash<QByteArray, QOpenGLShaderProgram*> staticLayerPrograms;
+
+QOpenGLShaderProgram* LandscapeOldStyle::getStaticLayerProgram(const QByteArray& projectorShader)
+{
+	auto it = staticLayerPrograms.constFind(projectorShader);
+	if (it!=staticLayerPrograms.constEnd())
+		return it.value();
+
+	QOpenGLShader vshader(QOpenGLShader::Vertex);
+	const QByteArray vsrc =
+		"attribute highp vec3 vertex;\n"
+		"attribute mediump vec2 texCoord;\n"
+		"uniform mediump mat4 projectionMatrix;\n"
+		"varying mediump vec2 texc;\n"
+		+ projectorShader +
+		"void main(void)\n"
+		"{\n"
+		"    gl_Position = projectionMatrix * vec4(projectToViewport(vertex).xyz, 1.);\n"
+		"    texc = texCoord;\n"
+		"}\n";
+	vshader.compileSourceCode(vsrc);
+	if (!vshader.log().isEmpty()) { qWarning() << "LandscapeOldStyle: Warnings while compiling vshader: " << vshader.log(); }
+
+	// Colors are premultiplied by alpha. The fog has no alpha, so it is added to the sky like with GL_ONE, GL_ONE.
+	QOpenGLShader fshader(QOpenGLShader::Fragment);
+	const char* fsrc =
+		"varying mediump vec2 texc;\n"
+		"uniform sampler2D tex;\n"
+		"uniform sampler2D illumTex;\n"
+		"uniform mediump vec4 color;\n"
+		"uniform mediump vec4 illumColor;\n"
+		"uniform bool withIllum;\n"
+		"uniform bool additive;\n"
+		"void main(void)\n"
+		"{\n"
+		"    mediump vec4 c = texture2D(tex, texc)*color;\n"
+		"    if (additive)\n"
+		"        c = vec4(c.rgb, 0.);\n"
+		"    else\n"
+		"        c.rgb *= c.a;\n"
+		"    if (withIllum)\n"
+		"    {\n"
+		"        mediump vec4 l = texture2D(illumTex, texc)*illumColor;\n"
+		"        c.rgb += l.rgb*l.a;\n"
+		"    }\n"
+		"    gl_FragColor = c;\n"
+		"}\n";
+	fshader.compileSourceCode(fsrc);
+	if (!fshader.log().isEmpty()) { qWarning() << "LandscapeOldStyle: Warnings while compiling fshader: " << fshader.log(); }
+
+	QOpenGLShaderProgram* program = new QOpenGLShaderProgram();
+	program->addShader(&vshader);
+	program->addShader(&fshader);
+	if (!StelPainter::linkProg(program, "landscapeLayersShader"))
+	{
+		// Do not try again with this projection, the painter will draw the layers
+		qWarning() << "LandscapeOldStyle: cannot link shader, drawing the layers with the painter";
+		delete program;
+		program = Q_NULLPTR;
+	}
+	staticLayerPrograms.insert(projectorShader, program);
+	return program;
+}
+
+bool LandscapeOldStyle::drawStaticLayers(StelCore* core, StelPainter& painter)
+{
+	if (staticLayersState<0)
+	{
+		// Read here and not in load(), which may run in a worker thread
+		staticLayersState = StelApp::getInstance().getSettings()->value("landscape/flag_static_layers", true).toBool() ? 1 : 0;
+	}
+	if (staticLayersState==0 || staticDraws.isEmpty())
+		return false;
+
+	const StelProjectorP decorPrj = core->getProjection(getDecorTransform(core));
+	if (decorPrj->hasDiscontinuity())
+		return false;
+	const QByteArray projectorShader = decorPrj->getForwardTransformShader();
+	if (projectorShader.isEmpty())
+		return false;
+	QOpenGLShaderProgram* program = getStaticLayerProgram(projectorShader);
+	if (!program)
+		return false;
+
+	if (!staticVertexBuffer.isCreated())
+	{
+		staticVertexBuffer.create();
+		staticVertexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+		staticVertexBuffer.bind();
+		staticVertexBuffer.allocate(staticVertices.constData(), staticVertices.size()*sizeof(GLfloat));
+		staticIndexBuffer.create();
+		staticIndexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+		staticIndexBuffer.bind();
+		staticIndexBuffer.allocate(staticIndices.constData(), staticIndices.size()*sizeof(unsigned short));
+		staticIndexBuffer.release();
+		staticVertexBuffer.release();
+		StelApp::getInstance().getTextureManager().registerGLBuffer(this, QString("Landscape %1").arg(id), staticVertices.size()*sizeof(GLfloat) + staticIndices.size()*sizeof(unsigned short));
+	}
+
+	const StelProjectorP groundPrj = core->getProjection(getGroundTransform(core));
+	const StelProjectorP fogPrj = core->getProjection(getFogTransform(core));
+	const float landFade = landFader.getInterstate();
+	const bool withFog = fogFader.getInterstate() && core->getSkyDrawer()->getFlagHasAtmosphere();
+	const float fog = landFade*fogFader.getInterstate()*(0.1f+0.1f*landscapeBrightness);
+	const bool withIllum = lightScapeBrightness>0.0f && illumFader.getInterstate();
+	const float illum = illumFader.getInterstate()*lightScapeBrightness;
+
+	const Mat4f& m = decorPrj->getProjectionMatrix();
+	const QMatrix4x4 qMat(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
+
+	painter.setBlending(true, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	program->bind();
+	program->setUniformValue("projectionMatrix", qMat);
+	program->setUniformValue("tex", 0);
+	program->setUniformValue("illumTex", 1);
+	program->setUniformValue("illumColor", illum, illum, illum, landFade);
+	const int vertexLoc = program->attributeLocation("vertex");
+	const int texCoordLoc = program->attributeLocation("texCoord");
+	staticVertexBuffer.bind();
+	staticIndexBuffer.bind();
+	program->enableAttributeArray(vertexLoc);
+	program->enableAttributeArray(texCoordLoc);
+
+	QOpenGLFunctions* gl = painter.glFuncs();
+	int currentType = -1;
+	for (const auto& draw : staticDraws)
+	{
+		if (draw.type==StaticLayerFog && !withFog)
+			continue;
+		if (draw.tex.isNull() || !draw.tex->bind(0))
+			continue;
+		if (draw.type!=currentType)
+		{
+			currentType = draw.type;
+			const StelProjectorP& prj = (draw.type==StaticLayerGround ? groundPrj : (draw.type==StaticLayerFog ? fogPrj : decorPrj));
+			prj->setForwardTransformUniforms(*program);
+			if (draw.type==StaticLayerFog)
+				program->setUniformValue("color", fog, fog, fog, landFade);
+			else
+				program->setUniformValue("color", landscapeBrightness, landscapeBrightness, landscapeBrightness, landFade);
+			program->setUniformValue("additive", draw.type==StaticLayerFog);
+		}
+		program->setUniformValue("withIllum", withIllum && !draw.illumTex.isNull() && draw.illumTex->bind(1));
+		program->setAttributeBuffer(vertexLoc, GL_FLOAT, draw.vertexOffset*5*sizeof(GLfloat), 3, 5*sizeof(GLfloat));
+		program->setAttributeBuffer(texCoordLoc, GL_FLOAT, (draw.vertexOffset*5+3)*sizeof(GLfloat), 2, 5*sizeof(GLfloat));
+		gl->glDrawElements(GL_TRIANGLES, draw.indexCount, GL_UNSIGNED_SHORT, reinterpret_cast<const GLvoid*>(draw.indexOffset*sizeof(unsigned short)));
+	}
+
+	program->disableAttributeArray(vertexLoc);
+	program->disableAttributeArray(texCoordLoc);
+	staticIndexBuffer.release();
+	staticVertexBuffer.release();
+	program->release();
+	gl->glActiveTexture(GL_TEXTURE0);
+	painter.setBlending(true);
+	return true;
+}
+
 void LandscapeOldStyle::draw(StelCore* core)
 {
 	if (!validLandscape)
@@ -631,18 +1097,21 @@ void LandscapeOldStyle::draw(StelCore* core)
 	painter.setBlending(true);
 	painter.setCullFace(true);
 
-	if (drawGroundFirst)
-		drawGround(core, painter);
-	drawDecor(core, painter, false);
-	if (!drawGroundFirst)
-		drawGround(core, painter);
-	drawFog(core, painter);
-
-	// Self-luminous layer (Light pollution etc). This looks striking!
-	if (lightScapeBrightness>0.0f && illumFader.getInterstate())
+	if (!landFader.getInterstate() || !drawStaticLayers(core, painter))
 	{
-		painter.setBlending(true, GL_SRC_ALPHA, GL_ONE);
-		drawDecor(core, painter, true);
+		if (drawGroundFirst)
+			drawGround(core, painter);
+		drawDecor(core, painter, false);
+		if (!drawGroundFirst)
+			drawGround(core, painter);
+		drawFog(core, painter);
+
+		// Self-luminous layer (Light pollution etc). This looks striking!
+		if (lightScapeBrightness>0.0f && illumFader.getInterstate())
+		{
+			painter.setBlending(true, GL_SRC_ALPHA, GL_ONE);
+			drawDecor(core, painter, true);
+		}
 	}
 
 	// If a horizon line also has been defined, draw it.
@@ -673,6 +1142,18 @@ void LandscapeOldStyle::drawFog(StelCore* core, StelPainter& sPainter) const
 	if (!(core->getSkyDrawer()->getFlagHasAtmosphere()))
 		return;
 
+	sPainter.setProjector(core->getProjection(getFogTransform(core)));
+	sPainter.setBlending(true, GL_ONE, GL_ONE);
+	sPainter.setColor(landFader.getInterstate()*fogFader.getInterstate()*(0.1f+0.1f*landscapeBrightness),
+			  landFader.getInterstate()*fogFader.getInterstate()*(0.1f+0.1f*landscapeBrightness),
+			  landFader.getInterstate()*fogFader.getInterstate()*(0.1f+0.1f*landscapeBrightness), landFader.getInterstate());
+	fogTex->bind();
+	sPainter.sCylinder(radius, getFogHeight(), 64, 1);
+	sPainter.setBlending(true);
+}
+
+StelProjector::ModelViewTranformP LandscapeOldStyle::getFogTransform(StelCore* core) const
+{
 	const float vpos = (tanMode||calibrated) ? radius*std::tan(fogAngleShift*M_PI/180.) : radius*std::sin(fogAngleShift*M_PI/180.);
 	StelProjector::ModelViewTranformP transfo = core->getAltAzModelViewTransform(StelCore::RefractionOff);
 
@@ -680,25 +1161,20 @@ void LandscapeOldStyle::drawFog(StelCore* core, StelPainter& sPainter) const
 		transfo->combine(Mat4d::zrotation(-(angleRotateZ+angleRotateZOffset)));
 
 	transfo->combine(Mat4d::translation(Vec3d(0.,0.,vpos)));
-	sPainter.setProjector(core->getProjection(transfo));
-	sPainter.setBlending(true, GL_ONE, GL_ONE);
-	sPainter.setColor(landFader.getInterstate()*fogFader.getInterstate()*(0.1f+0.1f*landscapeBrightness),
-			  landFader.getInterstate()*fogFader.getInterstate()*(0.1f+0.1f*landscapeBrightness),
-			  landFader.getInterstate()*fogFader.getInterstate()*(0.1f+0.1f*landscapeBrightness), landFader.getInterstate());
-	fogTex->bind();
-	const float height = (calibrated?
-				radius*(std::tan((fogAltAngle+fogAngleShift)*M_PI/180.)  - std::tan(fogAngleShift*M_PI/180.))
-				: ((tanMode) ? radius*std::tan(fogAltAngle*M_PI/180.) : radius*std::sin(fogAltAngle*M_PI/180.)));
-	sPainter.sCylinder(radius, height, 64, 1);
-	sPainter.setBlending(true);
+	return transfo;
+}
+
+float LandscapeOldStyle::getFogHeight() const
+{
+	return (calibrated?
+		radius*(std::tan((fogAltAngle+fogAngleShift)*M_PI/180.)  - std::tan(fogAngleShift*M_PI/180.))
+		: ((tanMode) ? radius*std::tan(fogAltAngle*M_PI/180.) : radius*std::sin(fogAltAngle*M_PI/180.)));
 }
 
 // Draw the side textures
 void LandscapeOldStyle::drawDecor(StelCore* core, StelPainter& sPainter, const bool drawLight) const
 {
-	StelProjector::ModelViewTranformP transfo = core->getAltAzModelViewTransform(StelCore::RefractionOff);
-	transfo->combine(Mat4d::zrotation(-(angleRotateZ+angleRotateZOffset)));
-	sPainter.setProjector(core->getProjection(transfo));
+	sPainter.setProjector(core->getProjection(getDecorTransform(core)));
 
 	if (!landFader.getInterstate())
 		return;
@@ -717,16 +1193,19 @@ void LandscapeOldStyle::drawDecor(StelCore* core, StelPainter& sPainter, const b
 	}
 }
 
+StelProjector::ModelViewTranformP LandscapeOldStyle::getDecorTransform(StelCore* core) const
+{
+	StelProjector::ModelViewTranformP transfo = core->getAltAzModelViewTransform(StelCore::RefractionOff);
+	transfo->combine(Mat4d::zrotation(-(angleRotateZ+angleRotateZOffset)));
+	return transfo;
+}
+
 // Draw the ground
 void LandscapeOldStyle::drawGround(StelCore* core, StelPainter& sPainter) const
 {
 	if (!landFader.getInterstate())
 		return;
-	const float vshift = radius * ((tanMode || calibrated) ? std::tan(groundAngleShift) : std::sin(groundAngleShift));
-	StelProjector::ModelViewTranformP transfo = core->getAltAzModelViewTransform(StelCore::RefractionOff);
-	transfo->combine(Mat4d::zrotation(groundAngleRotateZ-angleRotateZOffset) * Mat4d::translation(Vec3d(0,0,vshift)));
-
-	sPainter.setProjector(core->getProjection(transfo));
+	sPainter.setProjector(core->getProjection(getGroundTransform(core)));
 	sPainter.setColor(landscapeBrightness, landscapeBrightness, landscapeBrightness, landFader.getInterstate());
 
 	if(groundTex.isNull())
@@ -741,13 +1220,22 @@ void LandscapeOldStyle::drawGround(StelCore* core, StelPainter& sPainter) const
 	sPainter.drawFromArray(StelPainter::Triangles, groundVertexArr.size()/3);
 }
 
-float LandscapeOldStyle::getOpacity(Vec3d azalt) const
+StelProjector::ModelViewTranformP LandscapeOldStyle::getGroundTransform(StelCore* core) const
 {
-	if(!validLandscape) return (azalt[2]>0.0 ? 0.0f : 1.0f);
+	const float vshift = radius * ((tanMode || calibrated) ? std::tan(groundAngleShift) : std::sin(groundAngleShift));
+	StelProjector::ModelViewTranformP transfo = core->getAltAzModelViewTransform(StelCore::RefractionOff);
+	transfo->combine(Mat4d::zrotation(groundAngleRotateZ-angleRotateZOffset) * Mat4d::translation(Vec3d(0,0,vshift)));
+	return transfo;
+}
 
-	if (angleRotateZOffset!=0.0f)
-		azalt.transfo4d(Mat4d::zrotation(angleRotateZOffset));
+void LandscapeOldStyle::getOpacityAltitudeRange(float& minAlt, float& maxAlt) const
+{
+	minAlt = decorAngleShift*M_PI/180.0f;
+	maxAlt = (decorAltAngle+decorAngleShift)*M_PI/180.0f;
+}
 
+float LandscapeOldStyle::computeOpacity(const Vec3d& azalt) const
+{
 	// in case we also have a horizon polygon defined, this is trivial and fast.
 	if (horizonPolygon)
 	{
@@ -885,12 +1373,8 @@ void LandscapePolygonal::draw(StelCore* core)
 	drawLabels(core, &sPainter);
 }
 
-float LandscapePolygonal::getOpacity(Vec3d azalt) const
+float LandscapePolygonal::computeOpacity(const Vec3d& azalt) const
 {
-	if(!validLandscape) return (azalt[2]>0.0 ? 0.0f : 1.0f);
-	if (angleRotateZOffset!=0.0f)
-		azalt.transfo4d(Mat4d::zrotation(angleRotateZOffset));
-
 	if (horizonPolygon->contains(azalt)) return 1.0f; else return 0.0f;
 }
 
@@ -947,19 +1431,22 @@ void LandscapeFisheye::create(const QString _name, float _texturefov, const QStr
 	{
 		mapImage = new QImage(_maptex);
 		memorySize+=mapImage->byteCount();
+		if (!mapImage->isNull())
+			buildHorizonTable();
+		memorySize+=horizonTable.size()*sizeof(HorizonBin);
 	}
-	mapTex = StelApp::getInstance().getTextureManager().createTexture(_maptex, StelTexture::StelTextureParams(true));
+	mapTex = createLandscapeTexture(_maptex, StelTexture::StelTextureParams(true));
 	memorySize+=mapTex->getGlSize();
 
 	if (_maptexIllum.length() && (!_maptexIllum.endsWith("/")))
 	{
-		mapTexIllum = StelApp::getInstance().getTextureManager().createTexture(_maptexIllum, StelTexture::StelTextureParams(true));
+		mapTexIllum = createLandscapeTexture(_maptexIllum, StelTexture::StelTextureParams(true));
 		if (mapTexIllum)
 			memorySize+=mapTexIllum->getGlSize();
 	}
 	if (_maptexFog.length() && (!_maptexFog.endsWith("/")))
 	{
-		mapTexFog = StelApp::getInstance().getTextureManager().createTexture(_maptexFog, StelTexture::StelTextureParams(true));
+		mapTexFog = createLandscapeTexture(_maptexFog, StelTexture::StelTextureParams(true));
 		if (mapTexFog)
 			memorySize+=mapTexFog->getGlSize();
 	}
@@ -981,7 +1468,7 @@ void LandscapeFisheye::draw(StelCore* core)
 	sPainter.setCullFace(true);
 	sPainter.setColor(landscapeBrightness, landscapeBrightness, landscapeBrightness, landFader.getInterstate());
 	mapTex->bind();
-	sPainter.sSphereMap(radius,cols,rows,texFov,1);
+	sPainter.sSphereMap(radius,scaleTesselation(cols),scaleTesselation(rows),texFov,1);
 	// NEW since 0.13: Fog also for fisheye...
 	if ((mapTexFog) && (core->getSkyDrawer()->getFlagHasAtmosphere()))
 	{
@@ -991,7 +1478,7 @@ void LandscapeFisheye::draw(StelCore* core)
 				  landFader.getInterstate()*fogFader.getInterstate()*(0.1f+0.1f*landscapeBrightness),
 				  landFader.getInterstate()*fogFader.getInterstate()*(0.1f+0.1f*landscapeBrightness), landFader.getInterstate());
 		mapTexFog->bind();
-		sPainter.sSphereMap(radius,cols,rows,texFov,1);
+		sPainter.sSphereMap(radius,scaleTesselation(cols),scaleTesselation(rows),texFov,1);
 	}
 
 	if (mapTexIllum && lightScapeBrightness>0.0f && illumFader.getInterstate())
@@ -1001,20 +1488,21 @@ void LandscapeFisheye::draw(StelCore* core)
 				  illumFader.getInterstate()*lightScapeBrightness,
 				  illumFader.getInterstate()*lightScapeBrightness, landFader.getInterstate());
 		mapTexIllum->bind();
-		sPainter.sSphereMap(radius, cols, rows, texFov, 1);
+		sPainter.sSphereMap(radius, scaleTesselation(cols), scaleTesselation(rows), texFov, 1);
 	}
 
 	sPainter.setCullFace(false);
 	drawLabels(core, &sPainter);
 }
 
-float LandscapeFisheye::getOpacity(Vec3d azalt) const
+void LandscapeFisheye::getOpacityAltitudeRange(float& minAlt, float& maxAlt) const
 {
-	if(!validLandscape) return (azalt[2]>0.0 ? 0.0f : 1.0f);
-
-	if (angleRotateZOffset!=0.0f)
-		azalt.transfo4d(Mat4d::zrotation(angleRotateZOffset));
+	minAlt = M_PI/2-texFov/2.0f;
+	maxAlt = M_PI/2;
+}
 
+float LandscapeFisheye::computeOpacity(const Vec3d& azalt) const
+{
 	// in case we also have a horizon polygon defined, this is trivial and fast.
 	if (horizonPolygon)
 	{
@@ -1130,19 +1618,22 @@ void LandscapeSpherical::create(const QString _name, const QString& _maptex, con
 	{
 		mapImage = new QImage(_maptex);
 		memorySize+=mapImage->byteCount();
+		if (!mapImage->isNull())
+			buildHorizonTable();
+		memorySize+=horizonTable.size()*sizeof(HorizonBin);
 	}
-	mapTex = StelApp::getInstance().getTextureManager().createTexture(_maptex, StelTexture::StelTextureParams(true));
+	mapTex = createLandscapeTexture(_maptex, StelTexture::StelTextureParams(true));
 	memorySize+=mapTex->getGlSize();
 
 	if (_maptexIllum.length() && (!_maptexIllum.endsWith("/")))
 	{
-		mapTexIllum = StelApp::getInstance().getTextureManager().createTexture(_maptexIllum, StelTexture::StelTextureParams(true));
+		mapTexIllum = createLandscapeTexture(_maptexIllum, StelTexture::StelTextureParams(true));
 		if (mapTexIllum)
 			memorySize+=mapTexIllum->getGlSize();
 	}
 	if (_maptexFog.length() && (!_maptexFog.endsWith("/")))
 	{
-		mapTexFog = StelApp::getInstance().getTextureManager().createTexture(_maptexFog, StelTexture::StelTextureParams(true));
+		mapTexFog = createLandscapeTexture(_maptexFog, StelTexture::StelTextureParams(true));
 		if (mapTexFog)
 			memorySize+=mapTexFog->getGlSize();
 	}	
@@ -1180,7 +1671,7 @@ void LandscapeSpherical::draw(StelCore* core)
 
 	// TODO: verify that this works correctly for custom projections [comment not by GZ]
 	// seam is at East, except if angleRotateZ has been given.
-	sPainter.sSphere(radius, 1.0, cols, rows, 1, true, mapTexTop, mapTexBottom);
+	sPainter.sSphere(radius, 1.0, scaleTesselation(cols), scaleTesselation(rows), 1, true, mapTexTop, mapTexBottom);
 	// Since 0.13: Fog also for sphericals...
 	if ((mapTexFog) && (core->getSkyDrawer()->getFlagHasAtmosphere()))
 	{
@@ -1189,7 +1680,7 @@ void LandscapeSpherical::draw(StelCore* core)
 				  landFader.getInterstate()*fogFader.getInterstate()*(0.1f+0.1f*landscapeBrightness),
 				  landFader.getInterstate()*fogFader.getInterstate()*(0.1f+0.1f*landscapeBrightness), landFader.getInterstate());
 		mapTexFog->bind();
-		sPainter.sSphere(radius, 1.0, cols, (int) ceil(rows*(fogTexTop-fogTexBottom)/(mapTexTop-mapTexBottom)), 1, true, fogTexTop, fogTexBottom);
+		sPainter.sSphere(radius, 1.0, scaleTesselation(cols), (int) ceil(scaleTesselation(rows)*(fogTexTop-fogTexBottom)/(mapTexTop-mapTexBottom)), 1, true, fogTexTop, fogTexBottom);
 	}
 
 	// Self-luminous layer (Light pollution etc). This looks striking!
@@ -1200,7 +1691,7 @@ void LandscapeSpherical::draw(StelCore* core)
 				  lightScapeBrightness*illumFader.getInterstate(),
 				  lightScapeBrightness*illumFader.getInterstate(), landFader.getInterstate());
 		mapTexIllum->bind();
-		sPainter.sSphere(radius, 1.0, cols, (int) ceil(rows*(illumTexTop-illumTexBottom)/(mapTexTop-mapTexBottom)), 1, true, illumTexTop, illumTexBottom);
+		sPainter.sSphere(radius, 1.0, scaleTesselation(cols), (int) ceil(scaleTesselation(rows)*(illumTexTop-illumTexBottom)/(mapTexTop-mapTexBottom)), 1, true, illumTexTop, illumTexBottom);
 	}	
 	//qDebug() << "before drawing line";
 
@@ -1224,13 +1715,14 @@ void LandscapeSpherical::draw(StelCore* core)
 //! Sample landscape texture for transparency. May be used for advanced visibility computation like sunrise on the visible horizon etc.
 //! @param azalt: normalized direction in alt-az frame
 //! @retval alpha (0..1), where 0=fully transparent.
-float LandscapeSpherical::getOpacity(Vec3d azalt) const
+void LandscapeSpherical::getOpacityAltitudeRange(float& minAlt, float& maxAlt) const
 {
-	if(!validLandscape) return (azalt[2]>0.0 ? 0.0f : 1.0f);
-
-	if (angleRotateZOffset!=0.0f)
-		azalt.transfo4d(Mat4d::zrotation(angleRotateZOffset));
+	minAlt = M_PI/2-mapTexBottom;
+	maxAlt = M_PI/2-mapTexTop;
+}
 
+float LandscapeSpherical::computeOpacity(const Vec3d& azalt) const
+{
 	// in case we also have a horizon polygon defined, this is trivial and fast.
 	if (horizonPolygon)
 	{
@@ -1277,3 +1769,128 @@ float LandscapeSpherical::getOpacity(Vec3d azalt) const
 	return qAlpha(pixVal)/255.0f;
 
 }
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// panoramas cut into HiPS tiles
+
+LandscapeHips::LandscapeHips(float _radius)
+	: Landscape(_radius)
+{}
+
+LandscapeHips::~LandscapeHips()
+{
+	landscapeLabels.clear();
+}
+
+QString LandscapeHips::getHipsUrl(const QString& path, const QString& landscapeId)
+{
+	if (path.isEmpty() || path.contains("://"))
+		return path;
+	const QString dir = StelFileMgr::findFile("landscapes/" + landscapeId + "/" + path, StelFileMgr::Directory);
+	if (dir.isEmpty())
+		return path;
+	return QUrl::fromLocalFile(dir).toString();
+}
+
+void LandscapeHips::load(const QSettings& landscapeIni, const QString& landscapeId)
+{
+	loadCommon(landscapeIni, landscapeId);
+	QString type = landscapeIni.value("landscape/type").toString();
+	if (type != "hips")
+	{
+		qWarning() << "Landscape type mismatch for landscape "<< landscapeId << ", expected hips, found " << type << ".  No landscape in use.\n";
+		validLandscape = false;
+		return;
+	}
+	hipsUrl = getHipsUrl(landscapeIni.value("landscape/hips_url").toString(), landscapeId);
+	if (hipsUrl.isEmpty())
+	{
+		qWarning() << "Landscape " << landscapeId << " does not declare a hips_url.  No landscape in use.\n";
+		validLandscape = false;
+		return;
+	}
+	angleRotateZ = landscapeIni.value("landscape/angle_rotatez", 0.f).toFloat()*M_PI/180.f;
+
+	hipsIllumUrl = getHipsUrl(landscapeIni.value("landscape/hips_illum_url").toString(), landscapeId);
+	//qDebug() << "HipsLandscape" << landscapeId << "loaded from" << hipsUrl;
+}
+
+bool LandscapeHips::prepareResources()
+{
+	// The tiles are requested by HipsSurvey::draw() for the visible part of the panorama only.
+	if (!survey && !hipsUrl.isEmpty())
+	{
+		survey = HipsSurveyP(new HipsSurvey(hipsUrl));
+		survey->setDrawnInPainterFrame(true);
+		survey->setVisible(true);
+	}
+	if (!surveyIllum && !hipsIllumUrl.isEmpty())
+	{
+		surveyIllum = HipsSurveyP(new HipsSurvey(hipsIllumUrl));
+		surveyIllum->setDrawnInPainterFrame(true);
+		surveyIllum->setVisible(true);
+	}
+	return Landscape::prepareResources();
+}
+
+void LandscapeHips::update(double deltaTime)
+{
+	Landscape::update(deltaTime);
+	if (survey)
+		survey->update(deltaTime);
+	if (surveyIllum)
+		surveyIllum->update(deltaTime);
+}
+
+void LandscapeHips::drawSurvey(const HipsSurveyP& hips, StelPainter& sPainter, const Vec4f& color, bool additive) const
+{
+	hips->draw(&sPainter, 2.0*M_PI, [&](const QVector<Vec3d>& verts, const QVector<Vec2f>& tex, const QVector<uint16_t>& indices) {
+		if (additive)
+			sPainter.setBlending(true, GL_SRC_ALPHA, GL_ONE);
+		else
+			sPainter.setBlending(true);
+		sPainter.setColor(color[0], color[1], color[2], color[3]);
+		sPainter.setArrays(verts.constData(), tex.constData());
+		sPainter.drawFromArray(StelPainter::Triangles, indices.size(), 0, true, indices.constData());
+	});
+}
+
+void LandscapeHips::draw(StelCore* core)
+{
+	if(!validLandscape || !survey) return;
+	if(!landFader.getInterstate()) return;
+
+	StelProjector::ModelViewTranformP transfo = core->getAltAzModelViewTransform(StelCore::RefractionOff);
+	transfo->combine(Mat4d::zrotation(-(angleRotateZ+angleRotateZOffset)));
+	const StelProjectorP prj = core->getProjection(transfo);
+	StelPainter sPainter(prj);
+
+	drawSurvey(survey, sPainter, Vec4f(landscapeBrightness, landscapeBrightness, landscapeBrightness, landFader.getInterstate()), false);
+
+	// Self-luminous layer (Light pollution etc).
+	if (surveyIllum && (lightScapeBrightness>0.0f) && illumFader.getInterstate())
+	{
+		const float illum = lightScapeBrightness*illumFader.getInterstate();
+		drawSurvey(surveyIllum, sPainter, Vec4f(illum, illum, illum, landFader.getInterstate()), true);
+	}
+
+	// If a horizon line also has been defined, draw it.
+	if (horizonPolygon && (horizonPolygonLineColor[0] >= 0))
+	{
+		transfo = core->getAltAzModelViewTransform(StelCore::RefractionOff);
+		transfo->combine(Mat4d::zrotation(-angleRotateZOffset));
+		sPainter.setProjector(core->getProjection(transfo));
+		sPainter.setBlending(true);
+		sPainter.setColor(horizonPolygonLineColor[0], horizonPolygonLineColor[1], horizonPolygonLineColor[2], landFader.getInterstate());
+		sPainter.drawSphericalRegion(horizonPolygon.data(), StelPainter::SphericalPolygonDrawModeBoundary);
+	}
+	sPainter.setCullFace(false);
+	drawLabels(core, &sPainter);
+}
+
+float LandscapeHips::computeOpacity(const Vec3d& azalt) const
+{
+	if (horizonPolygon)
+		return horizonPolygon->contains(azalt) ? 1.0f : 0.0f;
+	return Landscape::computeOpacity(azalt);
+}
@@ -27,18 +27,23 @@
 #include "StelFader.hpp"
 #include "StelUtils.hpp"
 #include "StelTextureTypes.hpp"
+#include "StelTexture.hpp"
 #include "StelLocation.hpp"
 #include "StelSphereGeometry.hpp"
+#include "StelHips.hpp"
+#include "LightPollutionMap.hpp"
 
 #include <QMap>
 #include <QImage>
 #include <QList>
 #include <QFont>
+#include <QOpenGLBuffer>
 
 class QSettings;
 class StelLocation;
 class StelCore;
 class StelPainter;
+class QOpenGLShaderProgram;
 
 //! @class Landscape
 //! Store and manages the displaying of the Landscape.
@@ -72,6 +77,11 @@ public:
 
 	Landscape(float _radius = 2.f);
 	virtual ~Landscape();
+
+	//! Set the factor applied to the tesselation rows and columns of all landscapes, to draw them faster with less detail.
+	//! @param scale value in ]0, 1], default 1.
+	static void setDetailScale(float scale) {detailScale = qBound(0.1f, scale, 1.f);}
+	static float getDetailScale() {return detailScale;}
 	//! Load landscape.
 	//! @param landscapeIni A reference to an existing QSettings object which describes the landscape
 	//! @param landscapeId The name of the directory for the landscape files (e.g. "ocean")
@@ -84,7 +94,14 @@ public:
 	virtual unsigned int getMemorySize() const {return sizeof(Landscape);}
 
 	virtual void draw(StelCore* core) = 0;
-	void update(double deltaTime)
+
+	//! Start loading the resources of the landscape which are not in memory yet. Must be called from the main thread.
+	//! load() can run in a loader thread: its textures are decoded by loader jobs.
+	//! @return true if all resources are in memory, after which uploadTextures() does not need to wait.
+	virtual bool prepareResources();
+	//! Upload the textures to OpenGL, waiting for the ones which are still decoded. Must be called from the main thread.
+	void uploadTextures();
+	virtual void update(double deltaTime)
 	{
 		landFader.update((int)(deltaTime*1000));
 		fogFader.update((int)(deltaTime*1000));
@@ -153,6 +170,8 @@ public:
 	//! Return minimal brightness for landscape
 	//! returns -1 to signal "standard conditions" (use default value from config.ini)
 	float getLandscapeMinimalBrightness() const {return minBrightness;}
+	//! Return the directional light pollution map of the site, or a null pointer if the landscape has none.
+	LightPollutionMapP getLightPollutionMap() const {return lightPollutionMap;}
 
 	//! Set an additional z-axis (azimuth) rotation after landscape has been loaded.
 	//! This is intended for special uses such as when the landscape consists of
@@ -167,11 +186,18 @@ public:
 	//! Get the sine of the limiting altitude (can be used to short-cut drawing below horizon, like star fields). There is no set here, value is only from landscape.ini
 	float getSinMinAltitudeLimit() const {return sinMinAltitudeLimit;}
 
+	//! One bin of the horizon table: below sinLow the opacity is opacityBelow, above sinHigh it is opacityAbove.
+	struct HorizonBin
+	{
+		float sinLow, sinHigh;
+		float opacityBelow, opacityAbove;
+	};
+
 	//! Find opacity in a certain direction. (New in V0.13 series)
 	//! can be used to find sunrise or visibility questions on the real-world landscape horizon.
-	//! Default implementation indicates the horizon equals math horizon.
-	// TBD: Maybe change this to azalt[2]<sinMinAltitudeLimit ? (But never called in practice, reimplemented by the subclasses...)
-	virtual float getOpacity(Vec3d azalt) const { Q_ASSERT(0); return (azalt[2]<0 ? 1.0f : 0.0f); }
+	//! Directions clearly above or below the horizon are answered from the azimuth table built at load time,
+	//! the others from computeOpacity().
+	float getOpacity(Vec3d azalt) const;
 	//! The list of azimuths (counted from True North towards East) and altitudes can come in various formats. We read the first two elements, which can be of formats:
 	enum horizonListMode {
 		azDeg_altDeg   = 0, //! azimuth[degrees] altitude[degrees]
@@ -203,6 +229,25 @@ protected:
 	//! @param polygonInverted Must be true to use horizons which are on average below mathematical horizon (Solution for bug LP:1554639)
 	void createPolygonalHorizon(const QString& lineFileName, const float polyAngleRotateZ=0.0f, const QString &listMode="azDeg_altDeg", const bool polygonInverted=false);
 
+	//! Find opacity in a direction given in the frame of the landscape, i.e. with angleRotateZOffset already applied,
+	//! without using the horizon table.
+	//! Default implementation indicates the horizon equals math horizon.
+	virtual float computeOpacity(const Vec3d& azalt) const { return (azalt[2]<0 ? 1.0f : 0.0f); }
+	//! Get the altitudes [radians] below and above which computeOpacity() does not depend on altitude anymore.
+	virtual void getOpacityAltitudeRange(float& minAlt, float& maxAlt) const { minAlt=-M_PI/2; maxAlt=M_PI/2; }
+
+	//! Build the horizon table by sampling computeOpacity() in every azimuth bin. Used for landscapes described by images.
+	void buildHorizonTable();
+	//! Build the horizon table from the points of a horizon line, connected by great circles as in horizonPolygon.
+	void buildHorizonTable(const QVector<Vec3d>& horizonPoints);
+	//! Get the opacity in a direction from the horizon table.
+	//! @return false if the table does not settle the opacity, i.e. the direction is close to the horizon.
+	bool lookupHorizonTable(const Vec3d& azalt, float& opacity) const;
+
+	//! Create a texture decoded by a loader job, which is reported by prepareResources().
+	//! @param path the full path to the image file
+	StelTextureSP createLandscapeTexture(const QString& path, const StelTexture::StelTextureParams& params=StelTexture::StelTextureParams());
+
 	//! search for a texture in landscape directory, else global textures directory
 	//! @param basename The name of a texture file, e.g. "fog.png"
 	//! @param landscapeId The landscape ID (directory name) to which the texture belongs
@@ -224,6 +269,10 @@ protected:
 	LinearFader labelFader;//! Used to slowly fade in/out landscape feature labels.
 	int rows; //! horizontal rows.  May be given in landscape.ini:[landscape]tesselate_rows. More indicates higher accuracy, but is slower.
 	int cols; //! vertical columns. May be given in landscape.ini:[landscape]tesselate_cols. More indicates higher accuracy, but is slower.
+	//! Factor applied to rows and cols when drawing, see setDetailScale().
+	static float detailScale;
+	//! Return a number of rows or columns of the tesselation scaled by detailScale.
+	static int scaleTesselation(int n) {return qMax(qMin(n, 4), qRound(n*detailScale));}
 	float angleRotateZ;    //! [radians] if pano does not have its left border in the east, rotate in azimuth. Configured in landscape.ini[landscape]angle_rotatez (or decor_angle_rotatez for old_style landscapes)
 	float angleRotateZOffset; //! [radians] This is a rotation changeable at runtime via setZRotation (called by LandscapeMgr::setZRotation).
 				  //! Not in landscape.ini: Used in special cases where the horizon may rotate, e.g. on a ship.
@@ -236,6 +285,7 @@ protected:
 	float defaultExtinctionCoefficient; //! May be given in landscape.ini:[location]atmospheric_extinction_coefficient. Default -1 (no change).
 	float defaultTemperature; //! [Celsius] May be given in landscape.ini:[location]atmospheric_temperature. default: -1000.0 (no change)
 	float defaultPressure;    //! [mbar]    May be given in landscape.ini:[location]atmospheric_pressure. Default -1.0 (compute from [location]/altitude), use -2 to indicate "no change".
+	LightPollutionMapP lightPollutionMap; //! May be given in landscape.ini:[location]light_pollution_map as an image file. Default: none (uniform light pollution).
 
 	// Optional elements which, if present, describe a horizon polygon. They can be used to render a line or a filled region, esp. in LandscapePolygonal
 	SphericalRegionP horizonPolygon;   //! Optional element describing the horizon line.
@@ -243,6 +293,11 @@ protected:
 					   //! For LandscapePolygonal, this is the only horizon data item.
 	Vec3f horizonPolygonLineColor;     //! for all horizon types, the horizonPolygon line, if specified, will be drawn in this color
 					   //! specified in landscape.ini[landscape]horizon_line_color. Negative red (default) indicated "don't draw".
+	//! Horizon table, one bin per arc minute of azimuth in the frame of the landscape, counted like
+	//! StelUtils::rectToSphe() from -pi. Empty if the landscape has none.
+	QVector<HorizonBin> horizonTable;
+	//! The textures created by createLandscapeTexture().
+	QList<StelTextureSP> textures;
 	// Optional element: labels for landscape features.
 	QList<LandscapeLabel> landscapeLabels;
 	int fontSize;     //! Used for landscape labels (optionally indicating landscape features)
@@ -273,7 +328,8 @@ public:
 	virtual unsigned int getMemorySize() const {return memorySize;}
 	virtual void draw(StelCore* core);
 	//void create(bool _fullpath, QMap<QString, QString> param); // still not implemented
-	virtual float getOpacity(Vec3d azalt) const;
+	virtual float computeOpacity(const Vec3d& azalt) const;
+	virtual void getOpacityAltitudeRange(float& minAlt, float& maxAlt) const;
 protected:
 	typedef struct
 	{
@@ -287,6 +343,39 @@ private:
 	// drawLight==true for illumination layer, it then selects only the self-illuminating panels.
 	void drawDecor(StelCore* core, StelPainter&, const bool drawLight=false) const;
 	void drawGround(StelCore* core, StelPainter&) const;
+	//! Get the model view transforms of the layers, shared by the painter and the static buffers.
+	StelProjector::ModelViewTranformP getFogTransform(StelCore* core) const;
+	StelProjector::ModelViewTranformP getDecorTransform(StelCore* core) const;
+	StelProjector::ModelViewTranformP getGroundTransform(StelCore* core) const;
+	//! Height of the fog cylinder.
+	float getFogHeight() const;
+
+	//! Fill the vertex and index data of the static buffers from the precomputed arrays. Called at the end of load().
+	void prepareStaticLayers();
+	//! Draw the ground, the sides with their illumination layer, and the fog from static buffers with a single shader.
+	//! All layers are blended with premultiplied colors, so that they share the same blending and culling state.
+	//! @return false if the static buffers cannot be used with the current projection, in which case nothing was drawn.
+	bool drawStaticLayers(StelCore* core, StelPainter& painter);
+	//! Get the shader program of the static buffers for a projector shader, compiling it on first use.
+	static QOpenGLShaderProgram* getStaticLayerProgram(const QByteArray& projectorShader);
+
+	enum StaticLayerType { StaticLayerGround, StaticLayerSide, StaticLayerFog };
+	struct StaticLayerDraw
+	{
+		StaticLayerType type;
+		int vertexOffset;	// first vertex of the layer in staticVertices
+		int indexOffset;	// first index of the layer in staticIndices
+		int indexCount;
+		StelTextureSP tex;
+		StelTextureSP illumTex;	// optional self-luminous texture drawn with the same geometry
+	};
+	QVector<GLfloat> staticVertices;	// interleaved positions and texture coordinates
+	QVector<unsigned short> staticIndices;	// indices relative to the first vertex of each layer
+	QVector<StaticLayerDraw> staticDraws;
+	QOpenGLBuffer staticVertexBuffer;
+	QOpenGLBuffer staticIndexBuffer;
+	int staticLayersState;		// -1 before the first draw, 0 if disabled, 1 if the buffers are uploaded
+
 	QVector<double> groundVertexArr;
 	QVector<float> groundTexCoordArr;
 	StelTextureSP* sideTexs;
@@ -332,9 +421,9 @@ public:
 	LandscapePolygonal(float radius = 1.f);
 	virtual ~LandscapePolygonal();
 	virtual void load(const QSettings& landscapeIni, const QString& landscapeId);
-	virtual unsigned int getMemorySize() const {return sizeof(LandscapePolygonal);}
+	virtual unsigned int getMemorySize() const {return sizeof(LandscapePolygonal)+horizonTable.size()*sizeof(HorizonBin);}
 	virtual void draw(StelCore* core);
-	virtual float getOpacity(Vec3d azalt) const;
+	virtual float computeOpacity(const Vec3d& azalt) const;
 private:
 	// we have inherited: horizonFileName, horizonPolygon, horizonPolygonLineColor
 	Vec3f groundColor; //! specified in landscape.ini[landscape]ground_color.
@@ -356,7 +445,8 @@ public:
 	virtual void draw(StelCore* core);
 	//! Sample landscape texture for transparency/opacity. May be used for visibility, sunrise etc.
 	//! @param azalt normalized direction in alt-az frame
-	virtual float getOpacity(Vec3d azalt) const;
+	virtual float computeOpacity(const Vec3d& azalt) const;
+	virtual void getOpacityAltitudeRange(float& minAlt, float& maxAlt) const;
 	//! create a fisheye landscape from basic parameters (no ini file needed).
 	//! @param name Landscape name
 	//! @param maptex the fisheye texture
@@ -399,7 +489,8 @@ public:
 	//! Sample landscape texture for transparency/opacity. May be used for visibility, sunrise etc.
 	//! @param azalt normalized direction in alt-az frame
 	//! @retval alpha (0=fully transparent, 1=fully opaque. Trees, leaves, glass etc may have intermediate values.)
-	virtual float getOpacity(Vec3d azalt) const;
+	virtual float computeOpacity(const Vec3d& azalt) const;
+	virtual void getOpacityAltitudeRange(float& minAlt, float& maxAlt) const;
 	//! create a spherical landscape from basic parameters (no ini file needed).
 	//! @param name Landscape name
 	//! @param maptex the equirectangular texture
@@ -437,4 +528,42 @@ private:
 	unsigned int memorySize;   //!< holds an approximate value of memory consumption (for cache cost estimate)
 };
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class LandscapeHips
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @class LandscapeHips
+//! This uses a panorama cut into HiPS tiles, so that very large panoramas can be used.
+//! Only the tiles in view are loaded, at the order which matches the field of view, like sky surveys.
+//! The HiPS uses the alt-azimuthal frame: longitude 0 is due south, 90 due east, and latitude is altitude.
+//! Its hips_frame property is ignored, so that panoramas can be cut with the usual HiPS tools.
+//! Config via landscape.ini:
+//! - [landscape]type=hips
+//! - [landscape]hips_url: directory of the HiPS, relative to the landscape directory, or URL
+//! - [landscape]hips_illum_url: optional HiPS overlaid in the night (streetlights, skyglow, ...)
+//! - [landscape]angle_rotatez: azimuth rotation angle, degrees [0]
+//! The tiles are not available to the CPU: add a polygonal_horizon_list for opacity queries, else the mathematical horizon is used.
+class LandscapeHips : public Landscape
+{
+public:
+	LandscapeHips(float radius = 1.f);
+	virtual ~LandscapeHips();
+	virtual void load(const QSettings& landscapeIni, const QString& landscapeId);
+	virtual unsigned int getMemorySize() const {return sizeof(LandscapeHips)+horizonTable.size()*sizeof(HorizonBin);}
+	virtual void draw(StelCore* core);
+	virtual void update(double deltaTime);
+	//! Create the surveys, which must be done in the main thread. Their tiles are loaded while they are drawn.
+	virtual bool prepareResources();
+	virtual float computeOpacity(const Vec3d& azalt) const;
+private:
+	//! Get the URL of a HiPS given as a directory in the landscape directory, or as an URL.
+	static QString getHipsUrl(const QString& path, const QString& landscapeId);
+	//! Draw the loaded tiles of a survey with the given color, blending them normally or additively.
+	void drawSurvey(const HipsSurveyP& hips, StelPainter& sPainter, const Vec4f& color, bool additive) const;
+
+	QString hipsUrl;
+	QString hipsIllumUrl;
+	HipsSurveyP survey;        //!< The panorama
+	HipsSurveyP surveyIllum;   //!< Optional panorama to simulate light pollution (skyglow), street lights, light in windows, ... at night
+};
+
 #endif // LANDSCAPE_HPP
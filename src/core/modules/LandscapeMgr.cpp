@@ -46,6 +46,7 @@
 #include <QMouseEvent>
 #include <QPainter>
 #include <QOpenGLPaintDevice>
+#include <QPointer>
 
 #include <stdexcept>
 
@@ -194,6 +195,9 @@ LandscapeMgr::LandscapeMgr()
 	, cardinalsPoints(Q_NULLPTR)
 	, landscape(Q_NULLPTR)
 	, oldLandscape(Q_NULLPTR)
+	, pendingLandscape(Q_NULLPTR)
+	, pendingLocationDuration(1.0)
+	, flagAsyncLoading(true)
 	, flagLandscapeSetsLocation(false)
 	, flagLandscapeAutoSelection(false)
 	, flagLightPollutionFromDatabase(false)
@@ -218,8 +222,12 @@ LandscapeMgr::LandscapeMgr()
 
 LandscapeMgr::~LandscapeMgr()
 {
+	// The jobs only use their own landscape, which is deleted by their main thread callback.
+	for (const auto& load : landscapeLoads)
+		load.job->waitForFinished();
 	delete atmosphere;
 	delete cardinalsPoints;
+	delete pendingLandscape;
 	if (oldLandscape)
 	{
 		delete oldLandscape;
@@ -231,6 +239,11 @@ LandscapeMgr::~LandscapeMgr()
 	landscapeCache.clear(); // deletes all objects within.
 }
 
+void LandscapeMgr::setAtmosphereResolutionScale(float scale)
+{
+	atmosphere->setResolutionScale(scale);
+}
+
 /*************************************************************************
  Reimplementation of the getCallOrder method
 *************************************************************************/
@@ -250,6 +263,33 @@ void LandscapeMgr::update(double deltaTime)
 {
 	atmosphere->update(deltaTime);
 
+	// Switch to a landscape loaded in the background once all its textures are in memory.
+	if (pendingLandscape && pendingLandscape->prepareResources())
+	{
+		Landscape* newLandscape = pendingLandscape;
+		pendingLandscape = Q_NULLPTR;
+		newLandscape->uploadTextures();
+		activateLandscape(newLandscape, newLandscape->getId(), pendingLocationDuration);
+	}
+	for (int i=preparingLandscapes.size()-1; i>=0; --i)
+	{
+		const QString id = preparingLandscapes.at(i);
+		if (landscapeLoads.contains(id))
+			continue;
+		Landscape* cached = landscapeCache.object(id);
+		if (!cached)
+		{
+			// Evicted from the cache, or taken by setCurrentLandscapeID() which emits landscapeReady() itself.
+			preparingLandscapes.removeAt(i);
+		}
+		else if (cached->prepareResources())
+		{
+			cached->uploadTextures();
+			preparingLandscapes.removeAt(i);
+			emit landscapeReady(id);
+		}
+	}
+
 	if (oldLandscape)
 	{
 		// This is only when transitioning to newly loaded landscape. We must draw the old one until the new one is faded in completely.
@@ -443,6 +483,7 @@ void LandscapeMgr::init()
 	qDebug() << "LandscapeMgr: initialized Cache for" << landscapeCache.maxCost() << "MB.";
 
 	atmosphere = new Atmosphere();
+	flagAsyncLoading = conf->value("landscape/flag_async_loading", true).toBool();
 	defaultLandscapeID = conf->value("init_location/landscape_name").toString();
 	setCurrentLandscapeID(defaultLandscapeID);
 	setFlagLandscape(conf->value("landscape/flag_landscape", conf->value("landscape/flag_ground", true).toBool()).toBool());
@@ -497,6 +538,14 @@ bool LandscapeMgr::setCurrentLandscapeID(const QString& id, const double changeL
 	if (id.isEmpty())
 		return false;
 
+	// A switch requested earlier and still loading is superseded.
+	if (pendingLandscape && pendingLandscape->getId()!=id)
+	{
+		landscapeCache.insert(pendingLandscape->getId(), pendingLandscape, pendingLandscape->getMemorySize()/(1024*1024)+1);
+		pendingLandscape=Q_NULLPTR;
+	}
+	pendingLandscapeID.clear();
+
 	//prevent unnecessary changes/file access
 	if(id==currentLandscapeID)
 		return false;
@@ -507,35 +556,57 @@ bool LandscapeMgr::setCurrentLandscapeID(const QString& id, const double changeL
 	// in this case it is not yet stored in cache, but obviously available. So we just swap places.
 	if (oldLandscape && oldLandscape->getId()==id)
 	{
-		newLandscape=oldLandscape;
+		activateLandscape(oldLandscape, id, changeLocationDuration);
+		return true;
 	}
-	else
-	{
-		// We want to lookup the landscape ID (dir) from the name.
-		newLandscape= landscapeCache.take(id);
 
-		if (newLandscape)
-		{
+	// We want to lookup the landscape ID (dir) from the name.
+	newLandscape = pendingLandscape ? pendingLandscape : landscapeCache.take(id);
+	pendingLandscape = Q_NULLPTR;
+	if (newLandscape)
+	{
 #ifndef NDEBUG
-			qDebug() << "LandscapeMgr::setCurrentLandscapeID():: taken " << id << "from cache...";
-			qDebug() << ".-->LandscapeMgr::setCurrentLandscapeID(): cache contains " << landscapeCache.size() << "landscapes totalling about " << landscapeCache.totalCost() << "MB.";
+		qDebug() << "LandscapeMgr::setCurrentLandscapeID():: taken " << id << "from cache...";
+		qDebug() << ".-->LandscapeMgr::setCurrentLandscapeID(): cache contains " << landscapeCache.size() << "landscapes totalling about " << landscapeCache.totalCost() << "MB.";
 #endif
-		}
-		else
-		{
+	}
+	else if (flagAsyncLoading && landscape)
+	{
+		// Loaded by a job, then switched to by update() once its textures are in memory.
+		startLandscapeLoad(id);
+	}
+	else
+	{
 #ifndef NDEBUG
-			qDebug() << "LandscapeMgr::setCurrentLandscapeID: Loading from file:" << id ;
+		qDebug() << "LandscapeMgr::setCurrentLandscapeID: Loading from file:" << id ;
 #endif
-			newLandscape = createFromFile(StelFileMgr::findFile("landscapes/" + id + "/landscape.ini"), id);
-		}
-
+		newLandscape = createFromFile(StelFileMgr::findFile("landscapes/" + id + "/landscape.ini"), id);
 		if (!newLandscape)
 		{
 			qWarning() << "ERROR while loading landscape " << "landscapes/" + id + "/landscape.ini";
 			return false;
 		}
+		newLandscape->prepareResources();
+		newLandscape->uploadTextures();
+	}
+
+	pendingLandscapeID = id;
+	pendingLocationDuration = changeLocationDuration;
+	if (newLandscape)
+	{
+		if (!landscape || newLandscape->prepareResources())
+		{
+			newLandscape->uploadTextures();
+			activateLandscape(newLandscape, id, changeLocationDuration);
+		}
+		else
+			pendingLandscape = newLandscape;
 	}
+	return true;
+}
 
+void LandscapeMgr::activateLandscape(Landscape* newLandscape, const QString& id, const double changeLocationDuration)
+{
 	// Keep current landscape for a while, while new landscape fades in!
 	// This prevents subhorizon sun or grid becoming briefly visible.
 	if (landscape)
@@ -561,6 +632,8 @@ bool LandscapeMgr::setCurrentLandscapeID(const QString& id, const double changeL
 	}
 	landscape=newLandscape;
 	currentLandscapeID = id;
+	pendingLandscapeID.clear();
+	updateLightPollutionMap();
 
 	if (getFlagLandscapeSetsLocation() && landscape->hasLocation())
 	{
@@ -602,6 +675,58 @@ bool LandscapeMgr::setCurrentLandscapeID(const QString& id, const double changeL
 	emit currentLandscapeChanged(currentLandscapeID,getCurrentLandscapeName());
 
 	// else qDebug() << "Will not set new location; Landscape location: planet: " << landscape->getLocation().planetName << "name: " << landscape->getLocation().name;
+	emit landscapeReady(id);
+}
+
+void LandscapeMgr::startLandscapeLoad(const QString& id)
+{
+	if (landscapeLoads.contains(id))
+		return;
+	// The landscape is created and loaded in a loader thread, which decodes its images and reads its horizon.
+	const QString landscapeFile = StelFileMgr::findFile("landscapes/" + id + "/landscape.ini");
+	const QSharedPointer<Landscape*> result(new Landscape*(Q_NULLPTR));
+	const QPointer<LandscapeMgr> mgr(this);
+	landscapeLoads.insert(id, LandscapeLoad{StelApp::getInstance().getJobMgr().submit([landscapeFile, id, result]() {
+		*result = createFromFile(landscapeFile, id);
+	}, 0.5f, QList<StelJobP>(), [mgr, id, result]() {
+		if (mgr)
+			mgr->onLandscapeLoaded(id, *result);
+		else
+			delete *result;
+	}), result});
+}
+
+void LandscapeMgr::onLandscapeLoaded(const QString& id, Landscape* loadedLandscape)
+{
+	landscapeLoads.remove(id);
+	if (!loadedLandscape)
+	{
+		qWarning() << "ERROR while loading landscape " << "landscapes/" + id + "/landscape.ini";
+		if (id==pendingLandscapeID)
+			pendingLandscapeID.clear();
+		preparingLandscapes.removeAll(id);
+		return;
+	}
+	if (id==pendingLandscapeID && !pendingLandscape)
+		pendingLandscape = loadedLandscape;
+	else if (id==currentLandscapeID || landscapeCache.contains(id) || (oldLandscape && oldLandscape->getId()==id))
+		delete loadedLandscape;
+	else
+		landscapeCache.insert(id, loadedLandscape, loadedLandscape->getMemorySize()/(1024*1024)+1);
+}
+
+bool LandscapeMgr::preloadLandscape(const QString& id)
+{
+	if (id.isEmpty() || id==currentLandscapeID || landscapeCache.contains(id) || landscapeLoads.contains(id))
+		return false;
+	if (StelFileMgr::findFile("landscapes/" + id + "/landscape.ini").isEmpty())
+	{
+		qWarning() << "LandscapeMgr::preloadLandscape(): no landscape with ID" << id;
+		return false;
+	}
+	if (!preparingLandscapes.contains(id))
+		preparingLandscapes.append(id);
+	startLandscapeLoad(id);
 	return true;
 }
 
@@ -1021,6 +1146,14 @@ float LandscapeMgr::getAtmosphereFadeDuration() const
 void LandscapeMgr::setAtmosphereLightPollutionLuminance(const float f)
 {
 	atmosphere->setLightPollutionLuminance(f);
+	updateLightPollutionMap();
+}
+
+void LandscapeMgr::updateLightPollutionMap()
+{
+	const LightPollutionMapP map = landscape ? landscape->getLightPollutionMap() : LightPollutionMapP();
+	atmosphere->setLightPollutionMap(map);
+	StelApp::getInstance().getCore()->getSkyDrawer()->setLightPollutionMap(map, atmosphere->getLightPollutionLuminance());
 }
 
 //! Get light pollution luminance level
@@ -1052,6 +1185,16 @@ float LandscapeMgr::getAtmosphereAverageLuminance() const
 	return atmosphere->getAverageLuminance();
 }
 
+float LandscapeMgr::getAtmosphereReuseRatio() const
+{
+	return atmosphere->getColorReuseRatio();
+}
+
+float LandscapeMgr::getAtmosphereComputeTime() const
+{
+	return atmosphere->getColorComputeTime();
+}
+
 // Override auto-computed luminance. Only use when you know what you are doing, and don't forget to unfreeze the average by calling this function with a negative value.
 void LandscapeMgr::setAtmosphereAverageLuminance(const float overrideLum)
 {
@@ -1079,6 +1222,8 @@ Landscape* LandscapeMgr::createFromFile(const QString& landscapeFile, const QStr
 		landscape = new LandscapeFisheye();
 	else if (s=="polygonal")
 		landscape = new LandscapePolygonal();
+	else if (s=="hips")
+		landscape = new LandscapeHips();
 	else
 	{
 		qDebug() << "Unknown landscape type: \"" << s << "\"";
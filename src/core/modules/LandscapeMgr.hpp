@@ -25,10 +25,12 @@
 #include "StelModule.hpp"
 #include "StelUtils.hpp"
 #include "Landscape.hpp"
+#include "StelJobMgr.hpp"
 
 #include <QMap>
 #include <QStringList>
 #include <QCache>
+#include <QHash>
 
 class Atmosphere;
 class Cardinals;
@@ -169,7 +171,11 @@ public:
 	//! @param landscapeId This is the landscape ID, which is also the name of the
 	//! directory in which the files (textures and so on) for the landscape reside.
 	//! @return A pointer to the newly created landscape object.
-	Landscape* createFromFile(const QString& landscapeFile, const QString& landscapeId);
+	//! @note This can be called from a loader thread. Landscape::prepareResources() must then be called from the main thread.
+	static Landscape* createFromFile(const QString& landscapeFile, const QString& landscapeId);
+
+	//! Set the factor applied to the resolution of the atmosphere grid, see Atmosphere::setResolutionScale().
+	void setAtmosphereResolutionScale(float scale);
 
 	// GZ: implement StelModule's method. For test purposes only, we implement a manual transparency sampler.
 	// TODO: comment this away for final builds. Please leave it in until this feature is finished.
@@ -184,6 +190,10 @@ public slots:
 	float getLuminance() const;
 	//! return average luminance [cd/m^2] of atmosphere. Expect 10 at sunset, 6400 in daylight, >0 in dark night.
 	float getAtmosphereAverageLuminance() const;
+	//! Return the fraction of the recent frames which reused the atmosphere colors of the previous frame [0..1].
+	float getAtmosphereReuseRatio() const;
+	//! Return the average time spent computing the atmosphere colors when they are not reused [ms].
+	float getAtmosphereComputeTime() const;
 
 	//! Override autocomputed value and set average luminance [cd/m^2] of atmosphere.  This is around 10 at sunset, 6400 in daylight, >0 in dark night.
 	//! Usually there is no need to call this, the luminance is properly computed. This is a function which can be
@@ -214,7 +224,9 @@ public slots:
 	//! Get the current landscape ID.
 	const QString getCurrentLandscapeID() const {return currentLandscapeID;}
 	//! Change the current landscape to the landscape with the ID specified.
-	//! Emits currentLandscapeChanged() if the landscape changed (true returned)
+	//! A landscape which is not in the cache is loaded in the background (landscape/flag_async_loading), and the
+	//! current landscape stays until the textures of the new one are in memory. The fade then starts, and
+	//! currentLandscapeChanged() and landscapeReady() are emitted.
 	//! @param id the ID of the new landscape
 	//! @param changeLocationDuration the duration of the transition animation
 	//! @return false if the new landscape could not be set (e.g. no landscape of that ID was found).
@@ -237,6 +249,11 @@ public slots:
 	//! @param replace true if existing landscape entry should be replaced (useful during development to reload after edit)
 	//! @return false if landscape could not be found, or if it already existed in cache and replace was false.
 	bool precacheLandscape(const QString& id, const bool replace=true);
+	//! Load a landscape into the cache in the background, e.g. in a script some time before switching to it
+	//! with setCurrentLandscapeID(), which then does not wait. landscapeReady() is emitted once its textures are in memory.
+	//! @param id the ID of a landscape
+	//! @return false if landscape could not be found, or if it is already current, cached or loading.
+	bool preloadLandscape(const QString& id);
 	//! Remove a landscape from the cache of landscapes.
 	//! @param id the ID of a landscape
 	//! @return false if landscape could not be found
@@ -513,6 +530,11 @@ signals:
 	//! \param currentLandscapeName the name of the new landscape
 	void currentLandscapeChanged(QString currentLandscapeID,QString currentLandscapeName);
 
+	//! Emitted when the resources of a landscape are in memory: when a landscape set by setCurrentLandscapeID()
+	//! starts to fade in, or when a landscape loaded by preloadLandscape() can be shown without waiting.
+	//! \param id the ID of the landscape
+	void landscapeReady(const QString& id);
+
 private slots:
 	//! Set the light pollution following the Bortle Scale.
 	//! This should not be called from script code, use StelMainScriptAPI::setBortleScaleIndex if you want to change the light pollution.
@@ -534,7 +556,8 @@ private:
 	float getAtmosphereLightPollutionLuminance() const;
 	//! Set light pollution luminance level.
 	void setAtmosphereLightPollutionLuminance(const float f);
-
+	//! Give the light pollution map of the current landscape to the atmosphere and to the sky drawer.
+	void updateLightPollutionMap();
 
 	//! For a given landscape name, return the landscape ID.
 	//! This takes a name of the landscape, as described in the landscape:name item in the
@@ -547,10 +570,31 @@ private:
 	//! @returns an empty string, if no such landscape was found.
 	static QString getLandscapePath(const QString landscapeID);
 
+	//! Make a landscape whose resources are in memory the current one, fading out the previous one.
+	void activateLandscape(Landscape* newLandscape, const QString& id, const double changeLocationDuration);
+	//! Start to load a landscape in a loader job, unless it is already being loaded. See onLandscapeLoaded().
+	void startLandscapeLoad(const QString& id);
+	//! Called in the main thread when the job started by startLandscapeLoad() finished.
+	void onLandscapeLoaded(const QString& id, Landscape* loadedLandscape);
+
 	Atmosphere* atmosphere;			// Atmosphere
 	Cardinals* cardinalsPoints;		// Cardinals points
 	Landscape* landscape;			// The landscape i.e. the fog, the ground and "decor"
 	Landscape* oldLandscape;		// Used only during transitions to newly loaded landscape.
+	Landscape* pendingLandscape;		// Set by setCurrentLandscapeID(), shown when its resources are in memory.
+	QString pendingLandscapeID;		// ID of the landscape set by setCurrentLandscapeID() which is not shown yet
+	double pendingLocationDuration;
+	bool flagAsyncLoading;			// landscape/flag_async_loading
+
+	struct LandscapeLoad
+	{
+		StelJobP job;
+		QSharedPointer<Landscape*> result;
+	};
+	//! The landscapes being loaded by jobs, by ID.
+	QHash<QString, LandscapeLoad> landscapeLoads;
+	//! The IDs of the landscapes given to preloadLandscape() for which landscapeReady() was not emitted yet.
+	QStringList preparingLandscapes;
 
 	// Define whether the observer location is to be updated when the landscape is updated.
 	bool flagLandscapeSetsLocation;
@@ -0,0 +1,95 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "LightPollutionMap.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QImage>
+
+#include <cmath>
+
+LightPollutionMap::LightPollutionMap(const QString& fileName)
+	: width(0)
+	, height(0)
+	, maxFactor(0.f)
+{
+	const QImage image(fileName);
+	if (image.isNull())
+	{
+		qWarning() << "Light pollution map" << QDir::toNativeSeparators(fileName) << "cannot be read.";
+		return;
+	}
+	width = image.width();
+	height = image.height();
+
+	// Weight each row by the solid angle of its band of altitude
+	QVector<float> grid(width*height);
+	double sum = 0., weights = 0.;
+	for (int j=0; j<height; ++j)
+	{
+		const double weight = std::cos((j+0.5)*M_PI_2/height);
+		const int y = height-1-j;
+		for (int i=0; i<width; ++i)
+		{
+			const float value = qGray(image.pixel(i, y));
+			grid[j*width+i] = value;
+			sum += weight*value;
+			weights += weight;
+		}
+	}
+	if (sum<=0.)
+	{
+		qWarning() << "Light pollution map" << QDir::toNativeSeparators(fileName) << "is black, it is ignored.";
+		return;
+	}
+
+	const float scale = weights/sum;
+	for (auto& value : grid)
+	{
+		value *= scale;
+		maxFactor = qMax(maxFactor, value);
+	}
+	factors = grid;
+}
+
+float LightPollutionMap::sample(const QVector<float>& grid, const Vec3d& altAzPos) const
+{
+	if (grid.size()!=width*height || grid.isEmpty())
+		return 1.f;
+
+	// Stellarium azimuth is counted from South, the columns of the map from North through East
+	const double az = M_PI - std::atan2(altAzPos[1], altAzPos[0]);
+	const double alt = std::asin(qBound(0., altAzPos[2]/altAzPos.length(), 1.));
+	const float x = az/(2.*M_PI)*width - 0.5f;
+	const float y = qBound(0.f, static_cast<float>(alt/M_PI_2*height - 0.5), height-1.f);
+
+	const int x0 = static_cast<int>(std::floor(x));
+	const float fx = x-x0;
+	const int i0 = (x0%width+width)%width;
+	const int i1 = (i0+1)%width;
+	const int j0 = qMin(static_cast<int>(y), height-1);
+	const int j1 = qMin(j0+1, height-1);
+	const float fy = y-j0;
+
+	const float bottom = grid.at(j0*width+i0)*(1.f-fx) + grid.at(j0*width+i1)*fx;
+	const float top = grid.at(j1*width+i0)*(1.f-fx) + grid.at(j1*width+i1)*fx;
+	return bottom*(1.f-fy) + top*fy;
+}
@@ -0,0 +1,76 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef LIGHTPOLLUTIONMAP_HPP
+#define LIGHTPOLLUTIONMAP_HPP
+
+#include "VecMath.hpp"
+
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+//! @class LightPollutionMap
+//! Directional distribution of the light pollution around an observing site.
+//! The map is a low resolution grid of azimuth and altitude, loaded from a grayscale image in which
+//! the columns go from North through East over 360 degrees of azimuth, and the rows from the zenith
+//! (top) to the horizon (bottom). Such an image can be derived from a VIIRS radiance map of the
+//! surroundings of the site, by accumulating the upward radiance of the sources in each direction.
+//! The values are normalized so that their average over the sky, weighted by solid angle, is 1:
+//! the map only distributes the light pollution given by the Bortle index of the site.
+class LightPollutionMap
+{
+public:
+	//! Load the map from an image file. Use isValid() to check for success.
+	//! This does not require an OpenGL context and can run in a loader thread.
+	LightPollutionMap(const QString& fileName);
+
+	//! Get whether the map contains data.
+	bool isValid() const {return !factors.isEmpty();}
+
+	//! Get the number of columns of the grid, along azimuth.
+	int getWidth() const {return width;}
+	//! Get the number of rows of the grid, along altitude. Row 0 is at the horizon.
+	int getHeight() const {return height;}
+	//! Get the normalized factors of the grid, by rows from the horizon.
+	const QVector<float>& getFactors() const {return factors;}
+	//! Get the largest factor of the grid.
+	float getMaxFactor() const {return maxFactor;}
+
+	//! Get the factor applied to the light pollution luminance in a direction.
+	//! @param altAzPos direction in the AltAz frame, not necessarily normalized.
+	//! Directions below the horizon get the factor of the horizon.
+	float getFactor(const Vec3d& altAzPos) const {return sample(factors, altAzPos);}
+
+	//! Interpolate a grid with the layout of the factors of this map in a direction.
+	//! @param grid values of the grid, by rows from the horizon, of size getWidth()*getHeight()
+	//! @param altAzPos direction in the AltAz frame, not necessarily normalized.
+	float sample(const QVector<float>& grid, const Vec3d& altAzPos) const;
+
+private:
+	int width;
+	int height;
+	QVector<float> factors;
+	float maxFactor;
+};
+
+typedef QSharedPointer<LightPollutionMap> LightPollutionMapP;
+
+#endif // LIGHTPOLLUTIONMAP_HPP
@@ -0,0 +1,546 @@
+/*
+ * Stellarium
+ * Copyright (C) 2014-2015 Marcos Cardinot
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "MeteorPool.hpp"
+#include "StelCore.hpp"
+#include "StelMovementMgr.hpp"
+#include "StelPainter.hpp"
+#include "StelSkyDrawer.hpp"
+#include "StelTexture.hpp"
+#include "StelUtils.hpp"
+
+#include <QtMath>
+
+namespace
+{
+	// Vertices per meteor in the arrays of MeteorPool::draw()
+	const int TRAIN_VERTICES = 3 * 6;   // three sides of the prism, two triangles each, per segment
+	const int LINE_VERTICES = 2;        // per segment
+	const int BOLIDE_VERTICES = 6;      // two triangles
+}
+
+MeteorPool::MeteorPool(int capacity)
+	: m_capacity(capacity)
+	, m_count(0)
+	, m_matAltAzToRadiant(capacity)
+	, m_spawnJD(capacity)
+	, m_age(capacity)
+	, m_fade(capacity)
+	, m_position(capacity)
+	, m_posTrain(capacity)
+	, m_speed(capacity)
+	, m_initialZ(capacity)
+	, m_finalZ(capacity)
+	, m_minDist(capacity)
+	, m_absMag(capacity)
+	, m_aptMag(capacity)
+	, m_segmentColors(capacity * SEGMENTS)
+{
+}
+
+bool MeteorPool::spawn(const StelCore* core, double jd, MeteorSchedule::Random& rnd, float radiantAlpha, float radiantDelta,
+		       float speed, const QList<ColorPair>& colors, float pidx)
+{
+	if (m_count >= m_capacity)
+	{
+		return false;
+	}
+
+	// find the radiant in horizontal coordinates
+	Vec3d radiantAltAz;
+	StelUtils::spheToRect(radiantAlpha, radiantDelta, radiantAltAz);
+	radiantAltAz = core->j2000ToAltAz(radiantAltAz);
+	float radiantAlt, radiantAz;
+	// S is zero, E is 90 degrees (SDSS)
+	StelUtils::rectToSphe(&radiantAz, &radiantAlt, radiantAltAz);
+
+	// meteors won't be visible if radiant is below 0degrees
+	if (radiantAlt < 0.f)
+	{
+		return false;
+	}
+
+	// the new meteor is only counted once it is known to be visible
+	const int idx = m_count;
+
+	// define the radiant coordinate system
+	// rotation matrix to align z axis with radiant
+	m_matAltAzToRadiant[idx] = Mat4d::zrotation(radiantAz) * Mat4d::yrotation(M_PI_2 - radiantAlt);
+
+	// select a random initial meteor altitude in the horizontal system [MIN_ALTITUDE, MAX_ALTITUDE]
+	float initialAlt = MIN_ALTITUDE + (MAX_ALTITUDE - MIN_ALTITUDE) * rnd.uniform();
+
+	// calculates the max z-coordinate for the currrent radiant
+	float maxZ = meteorZ(M_PI_2 - radiantAlt, initialAlt);
+
+	// meteor trajectory
+	// select a random xy position in polar coordinates (radiant system)
+
+	float xyDist = maxZ * rnd.uniform(); // [0, maxZ]
+	float theta = 2 * M_PI * rnd.uniform(); // [0, 2pi]
+
+	// initial meteor coordinates (radiant system)
+	Vec3d position(xyDist * qCos(theta), xyDist * qSin(theta), maxZ);
+
+	// find the initial meteor coordinates in the horizontal system
+	Vec3d positionAltAz = position;
+	positionAltAz.transfo4d(m_matAltAzToRadiant[idx]);
+
+	// find the angle from horizon to meteor
+	float meteorAlt = qAsin(positionAltAz[2] / positionAltAz.length());
+
+	// this meteor should not be visible if it is above the maximum altitude
+	// or if it's below the horizon!
+	if (positionAltAz[2] > MAX_ALTITUDE || meteorAlt <= 0.f)
+	{
+		return false;
+	}
+
+	// determine the final z-component and the min distance between meteor and observer
+	float finalZ, minDist;
+	if (radiantAlt < 0.0262f) // (<1.5 degrees) earth grazing meteor ?
+	{
+		// earth-grazers are rare!
+		// introduce a probabilistic factor just to make them a bit harder to occur
+		float prob = rnd.uniform();
+		if (prob > 0.3f) {
+			return false;
+		}
+
+		// limit lifetime to 12sec
+		finalZ = -position[2];
+		finalZ = qMax(position[2] - speed * 12.f, (double) finalZ);
+
+		minDist = xyDist;
+	}
+	else
+	{
+		// limit lifetime to 12sec
+		finalZ = meteorZ(M_PI_2 - meteorAlt, MIN_ALTITUDE);
+		finalZ = qMax(position[2] - speed * 12.f, (double) finalZ);
+
+		minDist = qSqrt(finalZ * finalZ + xyDist * xyDist);
+	}
+
+	// a meteor cannot hit the observer!
+	if (minDist < MIN_ALTITUDE) {
+		return false;
+	}
+
+	// select random magnitude [-3; 4.5]
+	float Mag = rnd.uniform() * 7.5f - 3.f;
+
+	// compute RMag and CMag
+	RCMag rcMag;
+	core->getSkyDrawer()->computeRCMag(Mag, &rcMag);
+	float absMag = rcMag.radius <= 1.2f ? 0.f : rcMag.luminance;
+	if (absMag == 0.f) {
+		return false;
+	}
+
+	// most visible meteors are under about 184km distant
+	// scale max mag down if outside this range
+	float scale = qPow(184.0 / minDist, 2);
+	absMag *= qMin(scale, 1.0f);
+
+	// implements the population index (pidx) - usually a decimal between 2 and 4
+	if (pidx > 1.f)
+	{
+		// higher pidx implies a larger fraction of faint meteors than average
+		float prob = rnd.uniform();
+		if (prob > 1.f / pidx)
+		{
+			// Increase the absolute magnitude ([-3; 4.5]) in 1.5!
+			// As we are working on a 0-1 scale (where 1 is brighter),
+			// more 1.5 means less 0.2!
+			absMag -= 0.2f;
+		}
+	}
+
+	m_spawnJD[idx] = jd;
+	m_age[idx] = 0.;
+	m_fade[idx] = 0.f;
+	m_position[idx] = position;
+	m_posTrain[idx] = position;
+	m_speed[idx] = speed;
+	m_initialZ[idx] = position[2];
+	m_finalZ[idx] = finalZ;
+	m_minDist[idx] = minDist;
+	m_absMag[idx] = absMag;
+	m_aptMag[idx] = .5f;
+	buildColorVector(idx, colors, rnd);
+	++m_count;
+	return true;
+}
+
+void MeteorPool::remove(int idx)
+{
+	const int last = --m_count;
+	if (idx == last)
+	{
+		return;
+	}
+	m_matAltAzToRadiant[idx] = m_matAltAzToRadiant[last];
+	m_spawnJD[idx] = m_spawnJD[last];
+	m_age[idx] = m_age[last];
+	m_fade[idx] = m_fade[last];
+	m_position[idx] = m_position[last];
+	m_posTrain[idx] = m_posTrain[last];
+	m_speed[idx] = m_speed[last];
+	m_initialZ[idx] = m_initialZ[last];
+	m_finalZ[idx] = m_finalZ[last];
+	m_minDist[idx] = m_minDist[last];
+	m_absMag[idx] = m_absMag[last];
+	m_aptMag[idx] = m_aptMag[last];
+	for (int s = 0; s < SEGMENTS; ++s)
+	{
+		m_segmentColors[idx*SEGMENTS + s] = m_segmentColors[last*SEGMENTS + s];
+	}
+}
+
+void MeteorPool::update(const StelCore* core, double deltaTime)
+{
+	const bool realTime = core->getRealTimeSpeed();
+	const double jd = core->getJD();
+	int i = 0;
+	while (i < m_count)
+	{
+		if (realTime)
+		{
+			// the same on all instances showing this time
+			m_age[i] = (jd - m_spawnJD[i]) * 86400.;
+		}
+		else
+		{
+			// paused | forward | backward: the meteor fades out in real time
+			m_age[i] += deltaTime;
+			m_fade[i] += deltaTime * 2.f;
+		}
+		const double age = m_age[i];
+		const float speed = m_speed[i];
+
+		// burning has stopped so magnitude fades out
+		// assume linear fade out
+		const double burnTime = (m_initialZ[i] - m_finalZ[i]) / speed;
+		const float absMag = m_absMag[i] - m_fade[i] - 2.f * qMax(0., age - burnTime);
+
+		// no longer visible, or the time went backwards
+		if (absMag <= 0.f || age < 0.)
+		{
+			// the last meteor takes this slot and is updated next
+			remove(i);
+			continue;
+		}
+
+		Vec3d& position = m_position[i];
+		position[2] = m_initialZ[i] - speed * age;
+
+		// the train is 0.5s long, and doesn't extend beyond start of burn
+		m_posTrain[i][2] = qMin(static_cast<double>(m_initialZ[i]), position[2] + speed * 0.5);
+
+		// update apparent magnitude based on distance to observer
+		float scale = qPow(m_minDist[i] / position.length(), 2);
+		m_aptMag[i] = qMax(absMag * qMin(scale, 1.f), 0.f);
+		++i;
+	}
+}
+
+void MeteorPool::draw(const StelCore* core, StelPainter& sPainter)
+{
+	if (m_count == 0)
+	{
+		return;
+	}
+
+	float thickness;
+	float bolideSize;
+	calculateThickness(core, thickness, bolideSize);
+	const bool drawBolides = bolideSize && m_bolideTexture;
+
+	const int trainVertices = thickness ? TRAIN_VERTICES * (SEGMENTS-1) : 0;
+	const int lineVertices = LINE_VERTICES * (SEGMENTS-1);
+	m_trainVertices.resize(m_count * trainVertices);
+	m_trainColors.resize(m_trainVertices.size());
+	m_lineVertices.resize(m_count * lineVertices);
+	m_lineColors.resize(m_lineVertices.size());
+	m_bolideVertices.resize(drawBolides ? m_count * BOLIDE_VERTICES : 0);
+	m_bolideColors.resize(m_bolideVertices.size());
+	m_bolideTexCoords.resize(m_bolideVertices.size());
+
+	Vec3d* trainVertex = m_trainVertices.data();
+	Vec4f* trainColor = m_trainColors.data();
+	Vec3d* lineVertex = m_lineVertices.data();
+	Vec4f* lineColor = m_lineColors.data();
+	Vec3d* bolideVertex = m_bolideVertices.data();
+	Vec4f* bolideColor = m_bolideColors.data();
+	Vec2f* bolideTexCoord = m_bolideTexCoords.data();
+
+	Vec3d line[SEGMENTS];
+	Vec3d prism[3][SEGMENTS];
+	Vec4f color[SEGMENTS];
+	// the sides of the prism, as pairs of its edges
+	static const int sides[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+	static const Vec2f bolideTexCoords[4] = {Vec2f(1.f, 0.f), Vec2f(0.f, 0.f), Vec2f(0.f, 1.f), Vec2f(1.f, 1.f)};
+
+	for (int i = 0; i < m_count; ++i)
+	{
+		// train (triangular prism)
+		//
+		const Vec3d& position = m_position[i];
+		const Vec3d& posTrain = m_posTrain[i];
+		Vec3d posTrainB = posTrain;
+		posTrainB[0] += thickness*0.7;
+		posTrainB[1] += thickness*0.7;
+		Vec3d posTrainL = posTrain;
+		posTrainL[1] -= thickness;
+		Vec3d posTrainR = posTrain;
+		posTrainR[0] -= thickness;
+
+		const Vec3f* segmentColor = &m_segmentColors[i*SEGMENTS];
+		for (int s = 0; s < SEGMENTS; ++s)
+		{
+			double height = posTrain[2] + s*(position[2] - posTrain[2])/(SEGMENTS-1);
+			Vec3d posi;
+
+			posi = posTrain;
+			posi[2] = height;
+			line[s] = radiantToAltAz(i, posi);
+
+			if (thickness)
+			{
+				posi = posTrainB;
+				posi[2] = height;
+				prism[0][s] = radiantToAltAz(i, posi);
+
+				posi = posTrainL;
+				posi[2] = height;
+				prism[1][s] = radiantToAltAz(i, posi);
+
+				posi = posTrainR;
+				posi[2] = height;
+				prism[2][s] = radiantToAltAz(i, posi);
+			}
+
+			const Vec3f& rgb = segmentColor[s];
+			color[s].set(rgb[0], rgb[1], rgb[2], m_aptMag[i] * ((float) s / (float) (SEGMENTS-1)));
+		}
+
+		for (int s = 0; s < SEGMENTS-1; ++s)
+		{
+			*lineVertex++ = line[s];
+			*lineVertex++ = line[s+1];
+			*lineColor++ = color[s];
+			*lineColor++ = color[s+1];
+
+			if (!thickness)
+			{
+				continue;
+			}
+			for (const auto& side : sides)
+			{
+				const Vec3d* a = prism[side[0]];
+				const Vec3d* b = prism[side[1]];
+				*trainVertex++ = a[s];
+				*trainVertex++ = b[s];
+				*trainVertex++ = a[s+1];
+				*trainVertex++ = b[s];
+				*trainVertex++ = a[s+1];
+				*trainVertex++ = b[s+1];
+				*trainColor++ = color[s];
+				*trainColor++ = color[s];
+				*trainColor++ = color[s+1];
+				*trainColor++ = color[s];
+				*trainColor++ = color[s+1];
+				*trainColor++ = color[s+1];
+			}
+		}
+
+		// bolide
+		//
+		if (drawBolides)
+		{
+			Vec3d corners[4] = {position, position, position, position};
+			corners[0][1] -= bolideSize; // top left
+			corners[1][0] -= bolideSize; // top right
+			corners[2][1] += bolideSize; // bottom right
+			corners[3][0] += bolideSize; // bottom left
+			static const int fan[BOLIDE_VERTICES] = {0, 1, 2, 0, 2, 3};
+			for (int v : fan)
+			{
+				*bolideVertex++ = radiantToAltAz(i, corners[v]);
+				*bolideTexCoord++ = bolideTexCoords[v];
+				*bolideColor++ = Vec4f(1, 1, 1, m_aptMag[i]);
+			}
+		}
+	}
+
+	sPainter.setBlending(true);
+	sPainter.enableClientStates(true, false, true);
+	if (thickness)
+	{
+		sPainter.setColorPointer(4, GL_FLOAT, m_trainColors.constData());
+		sPainter.setVertexPointer(3, GL_DOUBLE, m_trainVertices.constData());
+		sPainter.drawFromArray(StelPainter::Triangles, m_trainVertices.size(), 0, true);
+	}
+	sPainter.setColorPointer(4, GL_FLOAT, m_lineColors.constData());
+	sPainter.setVertexPointer(3, GL_DOUBLE, m_lineVertices.constData());
+	sPainter.drawFromArray(StelPainter::Lines, m_lineVertices.size(), 0, true);
+
+	if (drawBolides)
+	{
+		sPainter.setBlending(true, GL_ONE, GL_ONE);
+		sPainter.enableClientStates(true, true, true);
+		m_bolideTexture->bind();
+		sPainter.setTexCoordPointer(2, GL_FLOAT, m_bolideTexCoords.constData());
+		sPainter.setColorPointer(4, GL_FLOAT, m_bolideColors.constData());
+		sPainter.setVertexPointer(3, GL_DOUBLE, m_bolideVertices.constData());
+		sPainter.drawFromArray(StelPainter::Triangles, m_bolideVertices.size(), 0, true);
+	}
+
+	sPainter.setBlending(false);
+	sPainter.enableClientStates(false);
+}
+
+Vec3f MeteorPool::getColorFromName(const QString& colorName)
+{
+	int R, G, B; // 0-255
+	if (colorName == "violet")
+	{ // Calcium
+		R = 176;
+		G = 67;
+		B = 172;
+	}
+	else if (colorName == "blueGreen")
+	{ // Magnesium
+		R = 0;
+		G = 255;
+		B = 152;
+	}
+	else if (colorName == "yellow")
+	{ // Iron
+		R = 255;
+		G = 255;
+		B = 0;
+	}
+	else if (colorName == "orangeYellow")
+	{ // Sodium
+		R = 255;
+		G = 160;
+		B = 0;
+	}
+	else if (colorName == "red")
+	{ // atmospheric nitrogen and oxygen
+		R = 255;
+		G = 30;
+		B = 0;
+	}
+	else
+	{ // white
+		R = 255;
+		G = 255;
+		B = 255;
+	}
+
+	return Vec3f(R/255.f, G/255.f, B/255.f);
+}
+
+void MeteorPool::buildColorVector(int idx, const QList<ColorPair>& colors, MeteorSchedule::Random& rnd)
+{
+	// building the color array of the segments
+	QVector<Vec3f> segColors;
+	segColors.reserve(SEGMENTS);
+	for (const auto& color : colors)
+	{
+		// segments to be painted with the current color
+		int segs = qRound(SEGMENTS * (color.second / 100.f)); // rounds to nearest integer
+		const Vec3f rgb = getColorFromName(color.first);
+		for (int s = 0; s < segs && segColors.size() < SEGMENTS; ++s)
+		{
+			segColors.append(rgb);
+		}
+	}
+
+	// make sure that all segments have been painted!
+	// use the last color to paint the last segments
+	const int segs = segColors.size();
+	const Vec3f last = colors.isEmpty() ? getColorFromName("white") : getColorFromName(colors.last().first);
+	while (segColors.size() < SEGMENTS)
+	{
+		segColors.append(last);
+	}
+
+	// multi-color ?
+	// select a random segment to be the first (to alternate colors)
+	int firstSegment = 0;
+	if (colors.size() > 1) {
+		firstSegment = (segs - 1) * rnd.uniform(); // [0, segments-1]
+	}
+
+	Vec3f* dest = &m_segmentColors[idx*SEGMENTS];
+	for (int s = 0; s < SEGMENTS; ++s)
+	{
+		dest[s] = segColors.at((firstSegment + s) % SEGMENTS);
+	}
+}
+
+float MeteorPool::meteorZ(float zenithAngle, float altitude)
+{
+	float distance;
+
+	if (zenithAngle > 1.13446401f) // > 65 degrees?
+	{
+		float zcos = qCos(zenithAngle);
+		distance = qSqrt(EARTH_RADIUS2 * qPow(zcos, 2)
+				 + 2 * EARTH_RADIUS * altitude
+				 + qPow(altitude, 2));
+		distance -= EARTH_RADIUS * zcos;
+	}
+	else
+	{
+		// (first order approximation)
+		distance = altitude / qCos(zenithAngle);
+	}
+
+	return distance;
+}
+
+Vec3d MeteorPool::radiantToAltAz(int idx, Vec3d position) const
+{
+	position /= 1242.0; // 1242 to scale down under 1
+	position.transfo4d(m_matAltAzToRadiant[idx]);
+	return position;
+}
+
+void MeteorPool::calculateThickness(const StelCore* core, float& thickness, float& bolideSize)
+{
+	float maxFOV = core->getMovementMgr()->getMaxFov();
+	float FOV = core->getMovementMgr()->getCurrentFov();
+	thickness = 2*log(FOV + 0.25)/(1.2*maxFOV - (FOV + 0.25)) + 0.01;
+	if (FOV <= 0.5)
+	{
+		thickness = 0.013 * FOV; // decreasing faster
+	}
+	else if (FOV > 100.0)
+	{
+		thickness = 0; // remove prism
+	}
+
+	bolideSize = thickness*3;
+}
@@ -0,0 +1,141 @@
+/*
+ * Stellarium
+ * Copyright (C) 2014-2015 Marcos Cardinot
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef METEORPOOL_HPP
+#define METEORPOOL_HPP
+
+#include "MeteorSchedule.hpp"
+#include "StelTextureTypes.hpp"
+#include "VecMath.hpp"
+
+#include <QList>
+#include <QPair>
+#include <QVector>
+
+class StelCore;
+class StelPainter;
+
+#define EARTH_RADIUS 6378.f          //! earth_radius in km
+#define EARTH_RADIUS2 40678884.f     //! earth_radius^2 in km
+#define MAX_ALTITUDE 120.f           //! max meteor altitude in km
+#define MIN_ALTITUDE 80.f            //! min meteor altitude in km
+
+//! @class MeteorPool
+//! Models the meteors of a meteor shower or of the sporadic background.
+//! A meteor only lasts for some amount of time, and then "dies". While the time runs at real-time speed, the state
+//! of a meteor only depends on the time since its appearance, so that it does not depend on the frame rate.
+//! The state of the living meteors is stored
+//! in fixed-capacity arrays (structure of arrays) which are allocated once, so spawning and expiring meteors
+//! does not allocate, and the trains and bolides of all meteors are drawn with one draw call each.
+//! @author Marcos Cardinot <mcardinot@gmail.com>
+class MeteorPool
+{
+public:
+	//! <colorName, intensity>
+	typedef QPair<QString, int> ColorPair;
+
+	//! @param capacity the maximum number of meteors alive at the same time
+	MeteorPool(int capacity = 1024);
+
+	//! Set the texture of the meteor heads. Without texture, only the trains are drawn.
+	void setBolideTexture(const StelTextureSP& texture) { m_bolideTexture = texture; }
+
+	//! Try to create a meteor with a random trajectory from a radiant.
+	//! No meteor is created if it would not be visible, or if the pool is full.
+	//! @param jd the time of appearance of the meteor (UT), see MeteorSchedule::Event
+	//! @param rnd the generator of the random parameters of the meteor
+	//! @param radiantAlpha, radiantDelta the J2000 radiant in rad
+	//! @param speed the meteor speed in km/s
+	//! @param colors the colors of the train, in percent
+	//! @param pidx the population index, values above 1 make faint meteors more frequent
+	//! @return true if a meteor was created
+	bool spawn(const StelCore* core, double jd, MeteorSchedule::Random& rnd, float radiantAlpha, float radiantDelta,
+		   float speed, const QList<ColorPair>& colors, float pidx = 0.f);
+
+	//! Updates the positions of the meteors, and expires the ones which are not visible anymore.
+	//! @param deltaTime the time increment in seconds since the last call.
+	void update(const StelCore* core, double deltaTime);
+
+	//! Draws all meteors. The painter must use the alt-azimuthal frame.
+	void draw(const StelCore* core, StelPainter& sPainter);
+
+	//! Expire all meteors
+	void clear() { m_count = 0; }
+	//! Number of meteors alive
+	int count() const { return m_count; }
+	int capacity() const { return m_capacity; }
+
+private:
+	//! Number of segments along the train (useful to curve along projection distortions)
+	static const int SEGMENTS = 10;
+
+	//! Fill the colors of the train segments of a meteor
+	void buildColorVector(int idx, const QList<ColorPair>& colors, MeteorSchedule::Random& rnd);
+
+	//! get RGB from color name
+	static Vec3f getColorFromName(const QString& colorName);
+
+	//! Calculates the train thickness and bolide size.
+	static void calculateThickness(const StelCore* core, float &thickness, float &bolideSize);
+
+	//! Calculates the z-component of a meteor as a function of meteor zenith angle
+	static float meteorZ(float zenithAngle, float altitude);
+
+	//! find meteor position in horizontal coordinate system
+	Vec3d radiantToAltAz(int idx, Vec3d position) const;
+
+	//! Move the last meteor into the slot idx
+	void remove(int idx);
+
+	const int m_capacity;
+	//! The meteors [0, m_count) are alive
+	int m_count;
+	StelTextureSP m_bolideTexture;
+
+	//! @name Meteor state, one element per meteor
+	//! @{
+	QVector<Mat4d> m_matAltAzToRadiant; //! Rotation matrix to convert from horizontal to radiant coordinate system.
+	QVector<double> m_spawnJD;          //! Time of appearance (UT)
+	QVector<double> m_age;              //! Time since appearance in seconds
+	QVector<float> m_fade;              //! Magnitude lost while the time did not run at real-time speed
+	QVector<Vec3d> m_position;          //! Meteor position in radiant coordinate system.
+	QVector<Vec3d> m_posTrain;          //! End of train in radiant coordinate system.
+	QVector<float> m_speed;             //! Velocity of meteor in km/s.
+	QVector<float> m_initialZ;          //! Initial z-component of the meteor in radiant coordinates.
+	QVector<float> m_finalZ;            //! Final z-compoenent of the meteor in radiant coordinates.
+	QVector<float> m_minDist;           //! Shortest distance between meteor and observer.
+	QVector<float> m_absMag;            //! Initial absolute magnitude [0, 1]
+	QVector<float> m_aptMag;            //! Apparent magnitude [0, 1]
+	QVector<Vec3f> m_segmentColors;     //! SEGMENTS colors per meteor, from the end of the train to the bolide
+	//! @}
+
+	//! @name Vertex arrays of draw(), kept to avoid reallocations
+	//! @{
+	QVector<Vec3d> m_trainVertices;
+	QVector<Vec4f> m_trainColors;
+	QVector<Vec3d> m_lineVertices;
+	QVector<Vec4f> m_lineColors;
+	QVector<Vec3d> m_bolideVertices;
+	QVector<Vec4f> m_bolideColors;
+	QVector<Vec2f> m_bolideTexCoords;
+	//! @}
+};
+
+#endif // METEORPOOL_HPP
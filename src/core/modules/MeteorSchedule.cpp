@@ -0,0 +1,119 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "MeteorSchedule.hpp"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	qint64 hourOf(double jd)
+	{
+		return static_cast<qint64>(std::floor(jd * 24.));
+	}
+}
+
+MeteorSchedule::MeteorSchedule(quint64 seed)
+	: seed(seed)
+	, lastJD(0.)
+{
+}
+
+quint64 MeteorSchedule::seedFromName(const QString& name)
+{
+	// FNV-1a, unlike qHash() it is the same in all Qt versions
+	quint64 hash = Q_UINT64_C(0xcbf29ce484222325);
+	for (const char c : name.toUtf8())
+	{
+		hash ^= static_cast<unsigned char>(c);
+		hash *= Q_UINT64_C(0x100000001b3);
+	}
+	return hash;
+}
+
+void MeteorSchedule::request(qint64 hour, const RateFunc& rate)
+{
+	if (!hours.contains(hour))
+	{
+		const double zhr = rate((hour + 0.5) / 24.);
+		hours.insert(hour, QtConcurrent::run(&MeteorSchedule::generate, seed, hour, zhr));
+	}
+}
+
+void MeteorSchedule::advance(double jd, const RateFunc& rate, QVector<Event>& events)
+{
+	events.clear();
+	const qint64 currentHour = hourOf(jd);
+	if (lastJD > 0. && jd > lastJD && (jd - lastJD) * 86400. <= MAX_CATCH_UP)
+	{
+		for (qint64 hour = hourOf(lastJD); hour <= currentHour; ++hour)
+		{
+			request(hour, rate);
+			// Only waits after a time jump, the hour is usually prepared during the previous one
+			const QVector<Event> hourEvents = hours[hour].result();
+			auto it = std::upper_bound(hourEvents.constBegin(), hourEvents.constEnd(), lastJD,
+						   [](double t, const Event& e) { return t < e.jd; });
+			for (; it != hourEvents.constEnd() && it->jd <= jd; ++it)
+			{
+				events.append(*it);
+			}
+		}
+	}
+	lastJD = jd;
+
+	// Drop the past hours and prepare the next one
+	for (auto it = hours.begin(); it != hours.end();)
+	{
+		if (it.key() < currentHour - 1 || it.key() > currentHour + 1)
+			it = hours.erase(it);
+		else
+			++it;
+	}
+	request(currentHour + 1, rate);
+}
+
+QVector<MeteorSchedule::Event> MeteorSchedule::generate(quint64 seed, qint64 hour, double zhr)
+{
+	QVector<Event> events;
+	if (zhr <= 0.)
+	{
+		return events;
+	}
+
+	Random rnd(seed ^ (static_cast<quint64>(hour) * Q_UINT64_C(0xD1B54A32D192ED03)));
+	events.reserve(static_cast<int>(zhr * 1.1) + 4);
+	// exponentially distributed intervals, in fractions of the hour
+	double t = 0.;
+	for (;;)
+	{
+		t -= std::log(1. - rnd.uniform()) / zhr;
+		if (t >= 1.)
+		{
+			break;
+		}
+		Event e;
+		e.jd = (hour + t) / 24.;
+		e.seed = rnd.next();
+		events.append(e);
+	}
+	return events;
+}
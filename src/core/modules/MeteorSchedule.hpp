@@ -0,0 +1,102 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef METEORSCHEDULE_HPP
+#define METEORSCHEDULE_HPP
+
+#include <QFuture>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+//! @class MeteorSchedule
+//! Deterministic times of the meteors of one source, e.g. a meteor shower or the sporadic background.
+//! The meteors of each hour of simulation time are a Poisson process with the ZHR of this hour as rate,
+//! drawn from a generator seeded by the source and the hour. Every instance of the program thus creates the
+//! same meteors at the same times, independently of the frame rate, e.g. on all nodes of a RemoteSync cluster.
+//! The random parameters of each meteor are drawn from its own seed.
+//! The events of the next hour are generated in the background while the current hour is running.
+class MeteorSchedule
+{
+public:
+	//! Small and fast pseudo-random generator (SplitMix64), which gives the same sequence on all platforms.
+	class Random
+	{
+	public:
+		explicit Random(quint64 seed) : state(seed) {}
+		quint64 next()
+		{
+			quint64 z = (state += Q_UINT64_C(0x9E3779B97F4A7C15));
+			z = (z ^ (z >> 30)) * Q_UINT64_C(0xBF58476D1CE4E5B9);
+			z = (z ^ (z >> 27)) * Q_UINT64_C(0x94D049BB133111EB);
+			return z ^ (z >> 31);
+		}
+		//! Uniform random number in [0, 1)
+		double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+	private:
+		quint64 state;
+	};
+
+	//! One meteor
+	struct Event
+	{
+		double jd;      //!< the time of appearance (UT)
+		quint64 seed;   //!< the seed for the parameters of the meteor
+	};
+
+	//! Returns the ZHR at a JD. It is called in the main thread, once for each hour.
+	typedef std::function<double(double jd)> RateFunc;
+
+	//! @param seed identifies the source, see seedFromName()
+	explicit MeteorSchedule(quint64 seed);
+
+	//! A seed which only depends on the name, e.g. the ID of a meteor shower
+	static quint64 seedFromName(const QString& name);
+
+	//! Get the meteors which appeared since the last call.
+	//! Nothing is returned on the first call, or if the time went backwards or jumped forward by more than
+	//! MAX_CATCH_UP seconds since the last call.
+	//! @param jd the current JD (UT)
+	//! @param rate the ZHR, evaluated once at the middle of each hour
+	//! @param events receives the new meteors, in time order
+	void advance(double jd, const RateFunc& rate, QVector<Event>& events);
+
+	//! Forget the time of the last call, e.g. while the time does not run at real-time speed
+	void reset() { lastJD = 0.; }
+	//! Drop the generated hours, e.g. when the ZHR was changed
+	void clear() { hours.clear(); }
+
+	//! Time in seconds which advance() catches up, e.g. after a slow frame
+	static const int MAX_CATCH_UP = 2;
+
+private:
+	//! Start the generation of an hour in the background, if it is not yet generated
+	void request(qint64 hour, const RateFunc& rate);
+	//! Generate the events of an hour
+	static QVector<Event> generate(quint64 seed, qint64 hour, double zhr);
+
+	const quint64 seed;
+	double lastJD;
+	//! The events of each hour, by the index of the hour since JD 0
+	QHash<qint64, QFuture<QVector<Event>>> hours;
+};
+
+#endif // METEORSCHEDULE_HPP
@@ -35,6 +35,7 @@
 #include "StelModuleMgr.hpp"
 #include "LandscapeMgr.hpp"
 #include "StelMovementMgr.hpp"
+#include "StaticSphereRenderer.hpp"
 
 #include <QDebug>
 #include <QSettings>
@@ -47,6 +48,7 @@ MilkyWay::MilkyWay()
 	, intensityMinFov(0.25f) // when zooming in further, MilkyWay is no longer visible.
 	, intensityMaxFov(2.5f) // when zooming out further, MilkyWay is fully visible (when enabled).
 	, vertexArray()
+	, sphereRenderer(Q_NULLPTR)
 {
 	setObjectName("MilkyWay");
 	fader = new LinearFader();
@@ -59,6 +61,9 @@ MilkyWay::~MilkyWay()
 	
 	delete vertexArray;
 	vertexArray = Q_NULLPTR;
+
+	delete sphereRenderer;
+	sphereRenderer = Q_NULLPTR;
 }
 
 void MilkyWay::init()
@@ -75,6 +80,8 @@ void MilkyWay::init()
 	vertexArray = new StelVertexArray(StelPainter::computeSphereNoLight(1.f,1.f,45,15,1, true)); // GZ orig: slices=stacks=20.
 	vertexArray->colors.resize(vertexArray->vertex.length());
 	vertexArray->colors.fill(Vec3f(1.0, 0.3, 0.9));
+	sphereRenderer = new StaticSphereRenderer();
+	sphereRenderer->init(*vertexArray);
 
 	QString displayGroup = N_("Display Options");
 	addAction("actionShow_MilkyWay", displayGroup, N_("Milky Way"), "flagMilkyWayDisplayed", "M");
@@ -99,6 +106,12 @@ double MilkyWay::getCallOrder(StelModuleActionName actionName) const
 	return 0;
 }
 
+bool MilkyWay::isActive(StelModuleActionName actionName) const
+{
+	Q_UNUSED(actionName);
+	return *fader || fader->getInterstate()>0.f;
+}
+
 void MilkyWay::setFlagShow(bool b)
 {
 	if (*fader != b)
@@ -169,6 +182,25 @@ void MilkyWay::draw(StelCore* core)
 
 	const bool withExtinction=(drawer->getFlagHasAtmosphere() && drawer->getExtinction().getExtinctionCoefficient()>=0.01f);
 
+	StelPainter sPainter(prj);
+	sPainter.setCullFace(true);
+	sPainter.setBlending(true, GL_ONE, GL_ONE); // allow colored sky background
+	tex->bind();
+
+	if (sphereRenderer->isUsable(prj))
+	{
+		// The sphere stays in static buffers, extinction is computed in the shader from the J2000 to AltAz rotation.
+		Vec3d axes[3] = {Vec3d(1.,0.,0.), Vec3d(0.,1.,0.), Vec3d(0.,0.,1.)};
+		for (auto& axis : axes)
+			core->j2000ToAltAzInPlaceNoRefraction(&axis);
+		const Mat4d j2000ToAltAz(axes[0][0], axes[0][1], axes[0][2], 0., axes[1][0], axes[1][1], axes[1][2], 0.,
+					 axes[2][0], axes[2][1], axes[2][2], 0., 0., 0., 0., 1.);
+		sphereRenderer->draw(&sPainter, c, saturation, withExtinction ? &drawer->getExtinction() : Q_NULLPTR,
+				     j2000ToAltAz, 0.3f, 1.1f-bortleIntensity*0.1f);
+		sPainter.setCullFace(false);
+		return;
+	}
+
 	if (withExtinction)
 	{
 		// We must process the vertices to find geometric altitudes in order to compute vertex colors.
@@ -191,10 +223,6 @@ void MilkyWay::draw(StelCore* core)
 	else
 		vertexArray->colors.fill(Vec3f(c[0], c[1], c[2]));
 
-	StelPainter sPainter(prj);
-	sPainter.setCullFace(true);
-	sPainter.setBlending(true, GL_ONE, GL_ONE); // allow colored sky background
-	tex->bind();
 	sPainter.setSaturation(saturation);
 	sPainter.drawStelVertexArray(*vertexArray);
 	sPainter.setCullFace(false);
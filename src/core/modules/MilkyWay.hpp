@@ -65,6 +65,9 @@ public:
 	//! actionDraw returns 1 (because this is background, very early drawing).
 	//! Other actions return 0 for no action.
 	virtual double getCallOrder(StelModuleActionName actionName) const;
+
+	//! The Milky Way is inactive while it is hidden and faded out.
+	virtual bool isActive(StelModuleActionName actionName) const;
 	
 	///////////////////////////////////////////////////////////////////////////////////////
 	// Setter and getters
@@ -106,6 +109,7 @@ private:
 	double saturation = 1.0;
 
 	struct StelVertexArray* vertexArray;
+	class StaticSphereRenderer* sphereRenderer;
 };
 
 #endif // MILKYWAY_HPP
@@ -21,6 +21,7 @@
 
 #include "Nebula.hpp"
 #include "NebulaMgr.hpp"
+#include "DSOOutlineStore.hpp"
 #include "StelTexture.hpp"
 
 #include "StelUtils.hpp"
@@ -58,6 +59,7 @@ StelTextureSP Nebula::texDarkNebula;
 StelTextureSP Nebula::texDarkNebulaLarge;
 StelTextureSP Nebula::texOpenClusterWithNebulosity;
 StelTextureSP Nebula::texOpenClusterWithNebulosityLarge;
+DSOOutlineStore* Nebula::outlineStore = Q_NULLPTR;
 bool  Nebula::drawHintProportional = false;
 bool  Nebula::surfaceBrightnessUsage = false;
 bool  Nebula::designationUsage = false;
@@ -150,8 +152,8 @@ Nebula::Nebula()
 	, parallax(0.)
 	, parallaxErr(0.)
 	, nType()
+	, hasOutlines(false)
 {
-	outlineSegments.clear();
 }
 
 Nebula::~Nebula()
@@ -193,86 +195,93 @@ QString Nebula::getInfoString(const StelCore *core, const InfoStringGroup& flags
 	StelUtils::rectToSphe(&az_app,&alt_app,getAltAzPosApparent(core));
 	Q_UNUSED(az_app);
 
-	if ((flags&Name) || (flags&CatalogNumber))
-		oss << "<h2>";
-
-	if (!nameI18.isEmpty() && flags&Name)
+	// Names, catalog numbers and type do not change with time
+	oss << getStaticInfoString(0, flags, flagShowAdditionalNames, [&]()
 	{
-		oss << getNameI18n();
-		QString aliases = getI18nAliases();
-		if (!aliases.isEmpty() && flagShowAdditionalNames)
-			oss << " (" << aliases << ")";
-	}
+		QString text;
+		QTextStream oss(&text);
+		if ((flags&Name) || (flags&CatalogNumber))
+			oss << "<h2>";
 
-	if (flags&CatalogNumber)
-	{
-		QStringList catIds;
-		if (M_nb > 0)
-			catIds << QString("M %1").arg(M_nb);
-		if (C_nb > 0)
-			catIds << QString("C %1").arg(C_nb);
-		if (NGC_nb > 0)
-			catIds << QString("NGC %1").arg(NGC_nb);
-		if (IC_nb > 0)
-			catIds << QString("IC %1").arg(IC_nb);		
-		if (B_nb > 0)
-			catIds << QString("B %1").arg(B_nb);
-		if (Sh2_nb > 0)
-			catIds << QString("SH 2-%1").arg(Sh2_nb);
-		if (VdB_nb > 0)
-			catIds << QString("VdB %1").arg(VdB_nb);
-		if (RCW_nb > 0)
-			catIds << QString("RCW %1").arg(RCW_nb);
-		if (LDN_nb > 0)
-			catIds << QString("LDN %1").arg(LDN_nb);
-		if (LBN_nb > 0)
-			catIds << QString("LBN %1").arg(LBN_nb);
-		if (Cr_nb > 0)
-			catIds << QString("Cr %1").arg(Cr_nb);
-		if (Mel_nb > 0)
-			catIds << QString("Mel %1").arg(Mel_nb);
-		if (PGC_nb > 0)
-			catIds << QString("PGC %1").arg(PGC_nb);
-		if (UGC_nb > 0)
-			catIds << QString("UGC %1").arg(UGC_nb);
-		if (!Ced_nb.isEmpty())
-			catIds << QString("Ced %1").arg(Ced_nb);
-		if (Arp_nb > 0)
-			catIds << QString("Arp %1").arg(Arp_nb);
-		if (VV_nb > 0)
-			catIds << QString("VV %1").arg(VV_nb);
-		if (!PK_nb.isEmpty())
-			catIds << QString("PK %1").arg(PK_nb);
-		if (!PNG_nb.isEmpty())
-			catIds << QString("PN G%1").arg(PNG_nb);
-		if (!SNRG_nb.isEmpty())
-			catIds << QString("SNR G%1").arg(SNRG_nb);
-		if (!ACO_nb.isEmpty())
-			catIds << QString("ACO %1").arg(ACO_nb);
-		if (!HCG_nb.isEmpty())
-			catIds << QString("HCG %1").arg(HCG_nb);
-		if (Abell_nb > 0)
-			catIds << QString("Abell %1").arg(Abell_nb);
-		if (!ESO_nb.isEmpty())
-			catIds << QString("ESO %1").arg(ESO_nb);
-
-		if (!nameI18.isEmpty() && !catIds.isEmpty() && flags&Name)
-			oss << "<br>";
-
-		oss << catIds.join(" - ");
-	}
+		if (!nameI18.isEmpty() && flags&Name)
+		{
+			oss << getNameI18n();
+			QString aliases = getI18nAliases();
+			if (!aliases.isEmpty() && flagShowAdditionalNames)
+				oss << " (" << aliases << ")";
+		}
 
-	if ((flags&Name) || (flags&CatalogNumber))
-		oss << "</h2>";
+		if (flags&CatalogNumber)
+		{
+			QStringList catIds;
+			if (M_nb > 0)
+				catIds << QString("M %1").arg(M_nb);
+			if (C_nb > 0)
+				catIds << QString("C %1").arg(C_nb);
+			if (NGC_nb > 0)
+				catIds << QString("NGC %1").arg(NGC_nb);
+			if (IC_nb > 0)
+				catIds << QString("IC %1").arg(IC_nb);		
+			if (B_nb > 0)
+				catIds << QString("B %1").arg(B_nb);
+			if (Sh2_nb > 0)
+				catIds << QString("SH 2-%1").arg(Sh2_nb);
+			if (VdB_nb > 0)
+				catIds << QString("VdB %1").arg(VdB_nb);
+			if (RCW_nb > 0)
+				catIds << QString("RCW %1").arg(RCW_nb);
+			if (LDN_nb > 0)
+				catIds << QString("LDN %1").arg(LDN_nb);
+			if (LBN_nb > 0)
+				catIds << QString("LBN %1").arg(LBN_nb);
+			if (Cr_nb > 0)
+				catIds << QString("Cr %1").arg(Cr_nb);
+			if (Mel_nb > 0)
+				catIds << QString("Mel %1").arg(Mel_nb);
+			if (PGC_nb > 0)
+				catIds << QString("PGC %1").arg(PGC_nb);
+			if (UGC_nb > 0)
+				catIds << QString("UGC %1").arg(UGC_nb);
+			if (!Ced_nb.isEmpty())
+				catIds << QString("Ced %1").arg(Ced_nb);
+			if (Arp_nb > 0)
+				catIds << QString("Arp %1").arg(Arp_nb);
+			if (VV_nb > 0)
+				catIds << QString("VV %1").arg(VV_nb);
+			if (!PK_nb.isEmpty())
+				catIds << QString("PK %1").arg(PK_nb);
+			if (!PNG_nb.isEmpty())
+				catIds << QString("PN G%1").arg(PNG_nb);
+			if (!SNRG_nb.isEmpty())
+				catIds << QString("SNR G%1").arg(SNRG_nb);
+			if (!ACO_nb.isEmpty())
+				catIds << QString("ACO %1").arg(ACO_nb);
+			if (!HCG_nb.isEmpty())
+				catIds << QString("HCG %1").arg(HCG_nb);
+			if (Abell_nb > 0)
+				catIds << QString("Abell %1").arg(Abell_nb);
+			if (!ESO_nb.isEmpty())
+				catIds << QString("ESO %1").arg(ESO_nb);
+
+			if (!nameI18.isEmpty() && !catIds.isEmpty() && flags&Name)
+				oss << "<br>";
+
+			oss << catIds.join(" - ");
+		}
 
-	if (flags&ObjectType)
-	{
-		QString mt = getMorphologicalTypeString();
-		if (mt.isEmpty())
-			oss << QString("%1: <b>%2</b>").arg(q_("Type"), getTypeString()) << "<br>";
-		else
-			oss << QString("%1: <b>%2</b> (%3)").arg(q_("Type"), getTypeString(), mt) << "<br>";
-	}
+		if ((flags&Name) || (flags&CatalogNumber))
+			oss << "</h2>";
+
+		if (flags&ObjectType)
+		{
+			QString mt = getMorphologicalTypeString();
+			if (mt.isEmpty())
+				oss << QString("%1: <b>%2</b>").arg(q_("Type"), getTypeString()) << "<br>";
+			else
+				oss << QString("%1: <b>%2</b> (%3)").arg(q_("Type"), getTypeString(), mt) << "<br>";
+		}
+		return text;
+	});
 
 	oss << getMagnitudeInfoString(core, flags, alt_app, 2);
 
@@ -318,118 +327,125 @@ QString Nebula::getInfoString(const StelCore *core, const InfoStringGroup& flags
 
 	oss << getCommonInfoString(core, flags);
 
-	if (flags&Size && majorAxisSize>0.f)
+	// Catalog data
+	oss << getStaticInfoString(1, flags, withDecimalDegree, [&]()
 	{
-		QString majorAxS, minorAxS, sizeAx = q_("Size");
-		if (withDecimalDegree)
-		{
-			majorAxS = StelUtils::radToDecDegStr(majorAxisSize*M_PI/180., 5, false, true);
-			minorAxS = StelUtils::radToDecDegStr(minorAxisSize*M_PI/180., 5, false, true);
-		}
-		else
-		{
-			majorAxS = StelUtils::radToDmsPStr(majorAxisSize*M_PI/180., 2);
-			minorAxS = StelUtils::radToDmsPStr(minorAxisSize*M_PI/180., 2);
-		}
-
-		if (majorAxisSize==minorAxisSize || minorAxisSize==0.f)
-			oss << QString("%1: %2").arg(sizeAx, majorAxS) << "<br />";
-		else
+		QString text;
+		QTextStream oss(&text);
+		if (flags&Size && majorAxisSize>0.f)
 		{
-			oss << QString("%1: %2 x %3").arg(sizeAx, majorAxS, minorAxS) << "<br />";
-			if (orientationAngle>0)
-				oss << QString("%1: %2%3").arg(q_("Orientation angle")).arg(orientationAngle).arg(QChar(0x00B0)) << "<br />";
-		}
-	}
-
-	if (flags&Distance)
-	{
-		if (parallax!=0.f)
-		{
-			QString dx;
-			// distance in light years from parallax
-			float distance = 3.162e-5/(qAbs(parallax)*4.848e-9);
-			float distanceErr = 0.f;
-
-			if (parallaxErr>0.f)
-				distanceErr = 3.162e-5/(qAbs(parallaxErr)*4.848e-9);
-
-			if (distanceErr>0.f)
-				dx = QString("%1%2%3").arg(QString::number(distance, 'f', 3)).arg(QChar(0x00B1)).arg(QString::number(distanceErr, 'f', 3));
+			QString majorAxS, minorAxS, sizeAx = q_("Size");
+			if (withDecimalDegree)
+			{
+				majorAxS = StelUtils::radToDecDegStr(majorAxisSize*M_PI/180., 5, false, true);
+				minorAxS = StelUtils::radToDecDegStr(minorAxisSize*M_PI/180., 5, false, true);
+			}
 			else
-				dx = QString("%1").arg(QString::number(distance, 'f', 3));
+			{
+				majorAxS = StelUtils::radToDmsPStr(majorAxisSize*M_PI/180., 2);
+				minorAxS = StelUtils::radToDmsPStr(minorAxisSize*M_PI/180., 2);
+			}
 
-			if (oDistance==0.f)
+			if (majorAxisSize==minorAxisSize || minorAxisSize==0.f)
+				oss << QString("%1: %2").arg(sizeAx, majorAxS) << "<br />";
+			else
 			{
-				// TRANSLATORS: Unit of measure for distance - Light Years
-				QString ly = qc_("ly", "distance");
-				oss << QString("%1: %2 %3").arg(q_("Distance"), dx, ly) << "<br />";
+				oss << QString("%1: %2 x %3").arg(sizeAx, majorAxS, minorAxS) << "<br />";
+				if (orientationAngle>0)
+					oss << QString("%1: %2%3").arg(q_("Orientation angle")).arg(orientationAngle).arg(QChar(0x00B0)) << "<br />";
 			}
 		}
 
-		if (oDistance>0.f)
+		if (flags&Distance)
 		{
-			QString dx, dy;
-			float dc = 3262.f;
-			int ms = 1;
-			//TRANSLATORS: Unit of measure for distance - kiloparsecs
-			QString dupc = qc_("kpc", "distance");
-			//TRANSLATORS: Unit of measure for distance - Light Years
-			QString duly = qc_("ly", "distance");
-
-			if (nType==NebAGx || nType==NebGx || nType==NebRGx || nType==NebIGx || nType==NebQSO || nType==NebPossQSO)
+			if (parallax!=0.f)
 			{
-				dc = 3.262f;
-				ms = 3;
-				//TRANSLATORS: Unit of measure for distance - Megaparsecs
-				dupc = qc_("Mpc", "distance");
-				//TRANSLATORS: Unit of measure for distance - Millions of Light Years
-				duly = qc_("M ly", "distance");
+				QString dx;
+				// distance in light years from parallax
+				float distance = 3.162e-5/(qAbs(parallax)*4.848e-9);
+				float distanceErr = 0.f;
+
+				if (parallaxErr>0.f)
+					distanceErr = 3.162e-5/(qAbs(parallaxErr)*4.848e-9);
+
+				if (distanceErr>0.f)
+					dx = QString("%1%2%3").arg(QString::number(distance, 'f', 3)).arg(QChar(0x00B1)).arg(QString::number(distanceErr, 'f', 3));
+				else
+					dx = QString("%1").arg(QString::number(distance, 'f', 3));
+
+				if (oDistance==0.f)
+				{
+					// TRANSLATORS: Unit of measure for distance - Light Years
+					QString ly = qc_("ly", "distance");
+					oss << QString("%1: %2 %3").arg(q_("Distance"), dx, ly) << "<br />";
+				}
 			}
 
-			if (oDistanceErr>0.f)
+			if (oDistance>0.f)
 			{
-				dx = QString("%1%2%3").arg(QString::number(oDistance, 'f', 3)).arg(QChar(0x00B1)).arg(QString::number(oDistanceErr, 'f', 3));
-				dy = QString("%1%2%3").arg(QString::number(oDistance*dc, 'f', ms)).arg(QChar(0x00B1)).arg(QString::number(oDistanceErr*dc, 'f', ms));
+				QString dx, dy;
+				float dc = 3262.f;
+				int ms = 1;
+				//TRANSLATORS: Unit of measure for distance - kiloparsecs
+				QString dupc = qc_("kpc", "distance");
+				//TRANSLATORS: Unit of measure for distance - Light Years
+				QString duly = qc_("ly", "distance");
+
+				if (nType==NebAGx || nType==NebGx || nType==NebRGx || nType==NebIGx || nType==NebQSO || nType==NebPossQSO)
+				{
+					dc = 3.262f;
+					ms = 3;
+					//TRANSLATORS: Unit of measure for distance - Megaparsecs
+					dupc = qc_("Mpc", "distance");
+					//TRANSLATORS: Unit of measure for distance - Millions of Light Years
+					duly = qc_("M ly", "distance");
+				}
+
+				if (oDistanceErr>0.f)
+				{
+					dx = QString("%1%2%3").arg(QString::number(oDistance, 'f', 3)).arg(QChar(0x00B1)).arg(QString::number(oDistanceErr, 'f', 3));
+					dy = QString("%1%2%3").arg(QString::number(oDistance*dc, 'f', ms)).arg(QChar(0x00B1)).arg(QString::number(oDistanceErr*dc, 'f', ms));
+				}
+				else
+				{
+					dx = QString("%1").arg(QString::number(oDistance, 'f', 3));
+					dy = QString("%1").arg(QString::number(oDistance*dc, 'f', ms));
+				}
+
+				oss << QString("%1: %2 %3 (%4 %5)").arg(q_("Distance"), dx, dupc, dy, duly) << "<br />";
 			}
-			else
-			{
-				dx = QString("%1").arg(QString::number(oDistance, 'f', 3));
-				dy = QString("%1").arg(QString::number(oDistance*dc, 'f', ms));
-			}
-
-			oss << QString("%1: %2 %3 (%4 %5)").arg(q_("Distance"), dx, dupc, dy, duly) << "<br />";
 		}
-	}
 
-	if (flags&Extra)
-	{
-		if (redshift<99.f)
+		if (flags&Extra)
 		{
-			QString z;
-			if (redshiftErr>0.f)
-				z = QString("%1%2%3").arg(QString::number(redshift, 'f', 6)).arg(QChar(0x00B1)).arg(QString::number(redshiftErr, 'f', 6));
-			else
-				z = QString("%1").arg(QString::number(redshift, 'f', 6));
+			if (redshift<99.f)
+			{
+				QString z;
+				if (redshiftErr>0.f)
+					z = QString("%1%2%3").arg(QString::number(redshift, 'f', 6)).arg(QChar(0x00B1)).arg(QString::number(redshiftErr, 'f', 6));
+				else
+					z = QString("%1").arg(QString::number(redshift, 'f', 6));
 
-			oss << QString("%1: %2").arg(q_("Redshift"), z) << "<br />";
-		}
-		if (parallax!=0.f)
-		{
-			QString px;
+				oss << QString("%1: %2").arg(q_("Redshift"), z) << "<br />";
+			}
+			if (parallax!=0.f)
+			{
+				QString px;
 
-			if (parallaxErr>0.f)
-				px = QString("%1%2%3").arg(QString::number(qAbs(parallax)*0.001, 'f', 5)).arg(QChar(0x00B1)).arg(QString::number(parallaxErr*0.001, 'f', 5));
-			else
-				px = QString("%1").arg(QString::number(qAbs(parallax)*0.001, 'f', 5));
+				if (parallaxErr>0.f)
+					px = QString("%1%2%3").arg(QString::number(qAbs(parallax)*0.001, 'f', 5)).arg(QChar(0x00B1)).arg(QString::number(parallaxErr*0.001, 'f', 5));
+				else
+					px = QString("%1").arg(QString::number(qAbs(parallax)*0.001, 'f', 5));
 
-			oss << QString("%1: %2\"").arg(q_("Parallax"), px) << "<br />";
-		}
+				oss << QString("%1: %2\"").arg(q_("Parallax"), px) << "<br />";
+			}
 
-		if (!getMorphologicalTypeDescription().isEmpty())
-			oss << QString("%1: %2.").arg(q_("Morphological description"), getMorphologicalTypeDescription()) << "<br />";
+			if (!getMorphologicalTypeDescription().isEmpty())
+				oss << QString("%1: %2.").arg(q_("Morphological description"), getMorphologicalTypeDescription()) << "<br />";
 
-	}
+		}
+		return text;
+	});
 
 	postProcessInfoString(str, flags);
 
@@ -548,7 +564,7 @@ float Nebula::getSelectPriority(const StelCore* core) const
 	else if (nType==NebHII) // Sharpless and LBN
 		lim=10.0f - 2.0f*qMin(1.5f, majorAxisSize); // Unfortunately, in Sh catalog, we always have mag=99=unknown!
 
-	if (std::min(mLim, lim)<=maxMagHint || outlineSegments.size()>0) // High priority for big DSO (with outlines)
+	if (std::min(mLim, lim)<=maxMagHint || hasOutlines) // High priority for big DSO (with outlines)
 		selectPriority = -10.f;
 	else
 		selectPriority -= 5.f;
@@ -766,7 +782,6 @@ float Nebula::getVisibilityLevelByMagnitude(void) const
 
 void Nebula::drawOutlines(StelPainter &sPainter, float maxMagHints) const
 {
-	size_t segments = outlineSegments.size();
 	Vec3f color = getHintColor();
 
 	// tune limits for outlines
@@ -779,22 +794,22 @@ void Nebula::drawOutlines(StelPainter &sPainter, float maxMagHints) const
 	sPainter.setColor(col[0], col[1], col[2], 1);
 
 	// Show outlines
-	if (segments>0 && flagUseOutlines && oLim<=maxMagHints)
+	if (hasOutlines && flagUseOutlines && oLim<=maxMagHints && outlineStore)
 	{
-		unsigned int i, j;
-		std::vector<Vec3d> *points;
+		// The outlines are read from the file the first time they are drawn
+		const DSOOutlineStore::Outlines* outlines = outlineStore->get(this);
+		if (!outlines)
+			return;
 
 		sPainter.setBlending(true);
 		sPainter.setLineSmooth(true);
 		const SphericalCap& viewportHalfspace = sPainter.getProjector()->getBoundingCap();
 
-		for (i=0;i<segments;i++)
+		for (const auto& points : *outlines)
 		{
-			points = outlineSegments[i];
-
-			for (j=0;j<points->size()-1;j++)
+			for (int j=0;j<points.size()-1;j++)
 			{
-				sPainter.drawGreatCircleArc(points->at(j), points->at(j+1), &viewportHalfspace);
+				sPainter.drawGreatCircleArc(points.at(j), points.at(j+1), &viewportHalfspace);
 			}
 		}
 		sPainter.setLineSmooth(false);
@@ -804,8 +819,7 @@ void Nebula::drawOutlines(StelPainter &sPainter, float maxMagHints) const
 
 void Nebula::drawHints(StelPainter& sPainter, float maxMagHints) const
 {
-	size_t segments = outlineSegments.size();
-	if (segments>0 && flagUseOutlines)
+	if (hasOutlines && flagUseOutlines)
 		return;
 	Vec3d win;
 	// Check visibility of DSO hints
@@ -1024,6 +1038,11 @@ void Nebula::readDSO(QDataStream &in)
 		>> Mel_nb >> PGC_nb >> UGC_nb >> Ced_nb >> Arp_nb >> VV_nb >> PK_nb >> PNG_nb >> SNRG_nb >> ACO_nb
 		>> HCG_nb >> Abell_nb >> ESO_nb;
 
+	setupCatalogData(ra, dec, oType);
+}
+
+void Nebula::setupCatalogData(float ra, float dec, unsigned int oType)
+{
 	int f = NGC_nb + IC_nb + M_nb + C_nb + B_nb + Sh2_nb + VdB_nb + RCW_nb + LDN_nb + LBN_nb + Cr_nb + Mel_nb + PGC_nb + UGC_nb + Arp_nb + VV_nb + Abell_nb;
 	if (f==0 && Ced_nb.isEmpty() && PK_nb.isEmpty() && PNG_nb.isEmpty() && SNRG_nb.isEmpty() && ACO_nb.isEmpty() && HCG_nb.isEmpty() && ESO_nb.isEmpty())
 		withoutID = true;
@@ -1038,8 +1057,11 @@ bool Nebula::objectInDisplayedType() const
 {
 	if (!flagUseTypeFilters)
 		return true;
+	return typeGroupIndexDisplayed(getTypeGroupIndex());
+}
 
-	bool r = false;
+int Nebula::getTypeGroupIndex() const
+{
 	int cntype = -1;
 	switch (nType)
 	{
@@ -1099,6 +1121,12 @@ bool Nebula::objectInDisplayedType() const
 			cntype = 11;
 			break;
 	}
+	return cntype;
+}
+
+bool Nebula::typeGroupIndexDisplayed(int cntype)
+{
+	bool r = false;
 	if (typeFilters&TypeGalaxies && cntype==0)
 		r = true;
 	else if (typeFilters&TypeActiveGalaxies && cntype==1)
@@ -1186,6 +1214,71 @@ bool Nebula::objectInDisplayedCatalog() const
 	return r;
 }
 
+namespace
+{
+	// Bits of Nebula::getIndexMask()
+	const int INDEX_WITHOUT_ID_BIT = 24;	// after the CatalogGroupFlags
+	const int INDEX_TYPE_BIT = 32;		// 12 groups of types, see Nebula::getTypeGroupIndex()
+	const int INDEX_NO_SIZE_BIT = 48;
+	const int INDEX_SIZE_BIT = 49;		// 15 classes of sizes, see indexSizeClass()
+	const int INDEX_SIZE_CLASSES = 15;
+
+	// Class of an angular size in degrees, increasing with the size: 0 below 1/32', 1 below 1/16', ... 14 above 256'.
+	int indexSizeClass(float size)
+	{
+		return qBound(0, static_cast<int>(std::floor(std::log2(size*60.f)))+6, INDEX_SIZE_CLASSES-1);
+	}
+}
+
+float Nebula::getIndexSortKey() const
+{
+	// As in DrawNebulaFuncObject
+	return vMag>90.f ? bMag : vMag;
+}
+
+quint64 Nebula::getIndexMask() const
+{
+	quint64 mask = 0;
+	const CatalogGroupFlags catalogs[] = {CatNGC, CatIC, CatM, CatC, CatB, CatSh2, CatLBN, CatLDN, CatRCW, CatVdB, CatCr, CatMel,
+					      CatPGC, CatUGC, CatArp, CatVV, CatAbell, CatCed, CatPK, CatPNG, CatSNRG, CatACO, CatHCG, CatESO};
+	const bool inCatalog[] = {NGC_nb>0, IC_nb>0, M_nb>0, C_nb>0, B_nb>0, Sh2_nb>0, LBN_nb>0, LDN_nb>0, RCW_nb>0, VdB_nb>0, Cr_nb>0, Mel_nb>0,
+				  PGC_nb>0, UGC_nb>0, Arp_nb>0, VV_nb>0, Abell_nb>0, !Ced_nb.isEmpty(), !PK_nb.isEmpty(), !PNG_nb.isEmpty(),
+				  !SNRG_nb.isEmpty(), !ACO_nb.isEmpty(), !HCG_nb.isEmpty(), !ESO_nb.isEmpty()};
+	for (unsigned int i=0; i<sizeof(catalogs)/sizeof(catalogs[0]); ++i)
+		if (inCatalog[i])
+			mask |= catalogs[i];
+	if (withoutID)
+		mask |= Q_UINT64_C(1) << INDEX_WITHOUT_ID_BIT;
+	mask |= Q_UINT64_C(1) << (INDEX_TYPE_BIT + getTypeGroupIndex());
+	if (majorAxisSize==0.f)
+		mask |= Q_UINT64_C(1) << INDEX_NO_SIZE_BIT;
+	else
+		mask |= Q_UINT64_C(1) << (INDEX_SIZE_BIT + indexSizeClass(majorAxisSize));
+	return mask;
+}
+
+quint64 Nebula::getDisplayedCatalogsIndexMask()
+{
+	return static_cast<quint64>(static_cast<int>(catalogFilters)) | (Q_UINT64_C(1) << INDEX_WITHOUT_ID_BIT);
+}
+
+quint64 Nebula::getDisplayedTypesIndexMask()
+{
+	quint64 mask = 0;
+	for (int i=0; i<12; ++i)
+		if (!flagUseTypeFilters || typeGroupIndexDisplayed(i))
+			mask |= Q_UINT64_C(1) << (INDEX_TYPE_BIT + i);
+	return mask;
+}
+
+quint64 Nebula::getLargerThanIndexMask(float minSize)
+{
+	quint64 mask = Q_UINT64_C(1) << INDEX_NO_SIZE_BIT;
+	for (int i=minSize>0.f ? indexSizeClass(minSize) : 0; i<INDEX_SIZE_CLASSES; ++i)
+		mask |= Q_UINT64_C(1) << (INDEX_SIZE_BIT + i);
+	return mask;
+}
+
 bool Nebula::objectInAllowedSizeRangeLimits(void) const
 {
 	bool r = true;
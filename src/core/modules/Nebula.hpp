@@ -171,6 +171,19 @@ public:
 	QString getI18nAliases() const;
 	virtual double getAngularSize(const StelCore*) const;
 	virtual SphericalRegionP getRegion() const {return pointRegion;}
+	//! The DSO are sorted by magnitude in NebulaMgr's grid.
+	virtual float getIndexSortKey() const;
+	//! Bits of the catalogs of the DSO (as CatalogGroupFlags), of its type group and of its size, so that
+	//! NebulaMgr can skip the parts of the sky without any DSO to draw.
+	virtual quint64 getIndexMask() const;
+
+	//! Get the bits of getIndexMask() of the DSO shown with the current catalog filters.
+	static quint64 getDisplayedCatalogsIndexMask();
+	//! Get the bits of getIndexMask() of the DSO shown with the current type filters.
+	static quint64 getDisplayedTypesIndexMask();
+	//! Get the bits of getIndexMask() of the DSO which may be larger than minSize, or have no size.
+	//! @param minSize angular size [degrees]
+	static quint64 getLargerThanIndexMask(float minSize);
 
 	// Methods specific to Nebula
 	void setLabelColor(const Vec3f& v) {labelColor = v;}
@@ -224,12 +237,20 @@ private:
 	}
 
 	void readDSO(QDataStream& in);
+	//! Set the data derived from the catalog record once the catalog numbers were read.
+	//! @param ra, dec J2000 equatorial coordinates [rad]
+	//! @param oType the NebulaType
+	void setupCatalogData(float ra, float dec, unsigned int oType);
 
 	void drawLabel(StelPainter& sPainter, float maxMagLabel) const;
 	void drawHints(StelPainter& sPainter, float maxMagHints) const;
 	void drawOutlines(StelPainter& sPainter, float maxMagHints) const;
 
 	bool objectInDisplayedType() const;
+	//! Get the group of types used by the type filters, from 0 (galaxies) to 11 (other types), see objectInDisplayedType().
+	int getTypeGroupIndex() const;
+	//! Get whether the DSO of a group of types are shown with the current type filters.
+	static bool typeGroupIndexDisplayed(int typeGroupIndex);
 
 	Vec3f getHintColor() const;
 	float getVisibilityLevelByMagnitude() const;
@@ -359,7 +380,9 @@ private:
 	static double minSizeLimit;
 	static double maxSizeLimit;
 
-	std::vector<std::vector<Vec3d> *> outlineSegments;
+	//! Whether outlines.dat has outlines for this object. They are read by outlineStore when they are drawn.
+	bool hasOutlines;
+	static class DSOOutlineStore* outlineStore;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Nebula::CatalogGroup)
@@ -22,6 +22,7 @@
 // class used to manage groups of Nebulas
 
 #include "StelApp.hpp"
+#include "StelFrameProfiler.hpp"
 #include "NebulaMgr.hpp"
 #include "Nebula.hpp"
 #include "StelTexture.hpp"
@@ -39,9 +40,12 @@
 #include "StelPainter.hpp"
 #include "RefractionExtinction.hpp"
 #include "StelActionMgr.hpp"
+#include "StelStartupTrace.hpp"
 
 #include <algorithm>
 #include <vector>
+#include <cstring>
+#include <limits>
 #include <QDebug>
 #include <QFile>
 #include <QSettings>
@@ -49,6 +53,8 @@
 #include <QStringList>
 #include <QRegExp>
 #include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
 
 static const unsigned int DWARF_GALAXIES[] =
 {
@@ -105,6 +111,14 @@ static const unsigned int H400_LIST[] =
 // This number must be incremented each time the content or file format of the stars catalogs change
 static const QString StellariumDSOCatalogVersion = "3.6";
 
+// Key of a designation in NebulaMgr::designationIndex: upper case, without white spaces.
+static QString normalizeDesignation(const QString& designation)
+{
+	QString key = designation.toUpper();
+	key.remove(QRegExp("\\s"));
+	return key;
+}
+
 void NebulaMgr::setLabelsColor(const Vec3f& c) {Nebula::labelColor = c; emit labelsColorChanged(c);}
 const Vec3f NebulaMgr::getLabelsColor(void) const {return Nebula::labelColor;}
 void NebulaMgr::setCirclesColor(const Vec3f& c) {Nebula::circleColor = c; emit circlesColorChanged(c); }
@@ -193,6 +207,7 @@ NebulaMgr::NebulaMgr(void)
 	, hintsAmount(0)
 	, labelsAmount(0)
 	, flagConverter(false)
+	, flagCatalogCache(true)
 	, flagDecimalCoordinates(true)
 {
 	setObjectName("NebulaMgr");
@@ -200,6 +215,7 @@ NebulaMgr::NebulaMgr(void)
 
 NebulaMgr::~NebulaMgr()
 {
+	Nebula::outlineStore = Q_NULLPTR;
 	Nebula::texCircle = StelTextureSP();
 	Nebula::texCircleLarge = StelTextureSP();
 	Nebula::texGalaxy = StelTextureSP();
@@ -280,6 +296,8 @@ void NebulaMgr::init()
 	setLabelsAmount(conf->value("astro/nebula_labels_amount", 3.0).toDouble());
 	setHintsProportional(conf->value("astro/flag_nebula_hints_proportional", false).toBool());
 	setFlagOutlines(conf->value("astro/flag_dso_outlines_usage", false).toBool());
+	outlineStore.setCacheSize(qMax(64, conf->value("astro/dso_outlines_cache_size_kb", 2048).toInt())*1024);
+	Nebula::outlineStore = &outlineStore;
 	setFlagAdditionalNames(conf->value("astro/flag_dso_additional_names",true).toBool());
 	setDesignationUsage(conf->value("astro/flag_dso_designation_usage", false).toBool());
 	setFlagSurfaceBrightnessUsage(conf->value("astro/flag_surface_brightness_usage", false).toBool());
@@ -397,6 +415,7 @@ void NebulaMgr::init()
 	// for DSO convertor (for developers!)
 	flagConverter = conf->value("devel/convert_dso_catalog", false).toBool();
 	flagDecimalCoordinates = conf->value("devel/convert_dso_decimal_coord", true).toBool();
+	flagCatalogCache = conf->value("astro/flag_dso_catalog_cache", true).toBool();
 
 	setFlagUseTypeFilters(conf->value("astro/flag_use_type_filter", false).toBool());
 
@@ -507,35 +526,45 @@ void NebulaMgr::init()
 
 struct DrawNebulaFuncObject
 {
-	DrawNebulaFuncObject(float amaxMagHints, float amaxMagLabels, StelPainter* p, StelCore* aCore, bool acheckMaxMagHints)
+	DrawNebulaFuncObject(float amaxMagHints, float amaxMagLabels, StelPainter* p, StelCore* aCore)
 		: maxMagHints(amaxMagHints)
 		, maxMagLabels(amaxMagLabels)
 		, sPainter(p)
 		, core(aCore)
-		, checkMaxMagHints(acheckMaxMagHints)
+		, stopAtMaxMagHints(false)
 	{
 		angularSizeLimit = 5.f/sPainter->getProjector()->getPixelPerRadAtCenter()*180.f/M_PI;
+		StelSkyDrawer *drawer = core->getSkyDrawer();
+		magLimit = drawer->getFlagNebulaMagnitudeLimit() ? drawer->getCustomNebulaMagnitudeLimit() : std::numeric_limits<float>::max();
+		displayedCatalogsMask = Nebula::getDisplayedCatalogsIndexMask();
+		displayedTypesMask = Nebula::getDisplayedTypesIndexMask();
+		largeMask = Nebula::getLargerThanIndexMask(angularSizeLimit);
 	}
-	void operator()(StelRegionObject* obj)
+	bool enterNode(quint64 elementsMask, quint64 subtreeMask)
+	{
+		// The DSO of each node are sorted by magnitude: the faint ones are only drawn for their size,
+		// so the node can be left at the first one fainter than maxMagHints if none is large.
+		stopAtMaxMagHints = (elementsMask & largeMask)==0;
+		return (subtreeMask & displayedCatalogsMask) && (subtreeMask & displayedTypesMask);
+	}
+	bool operator()(StelRegionObject* obj)
 	{
-		if (checkMaxMagHints)
-			return;
-
 		Nebula* n = static_cast<Nebula*>(obj);
 		float mag = n->vMag;
 		if (mag>90.f)
 			mag = n->bMag;
 
-		StelSkyDrawer *drawer = core->getSkyDrawer();
-		// filter out DSOs which are too dim to be seen (e.g. for bino observers)		
-		if ((drawer->getFlagNebulaMagnitudeLimit()) && (mag > drawer->getCustomNebulaMagnitudeLimit()))
-			return;
+		// filter out DSOs which are too dim to be seen (e.g. for bino observers)
+		if (mag > magLimit)
+			return false;
+		if (stopAtMaxMagHints && mag > maxMagHints)
+			return false;
 
-		if (!n->objectInDisplayedCatalog())
-			return;
+		if (!n->objectInDisplayedCatalog() || !n->objectInDisplayedType())
+			return true;
 
 		if (!n->objectInAllowedSizeRangeLimits())
-			return;
+			return true;
 
 		if (n->majorAxisSize>angularSizeLimit || n->majorAxisSize==0.f || mag <= maxMagHints)
 		{
@@ -543,14 +572,20 @@ struct DrawNebulaFuncObject
 			n->drawLabel(*sPainter, maxMagLabels);
 			n->drawHints(*sPainter, maxMagHints);
 			n->drawOutlines(*sPainter, maxMagHints);
+			StelFrameProfiler::count(StelFrameProfiler::DSOsDrawn);
 		}
+		return true;
 	}
 	float maxMagHints;
 	float maxMagLabels;
 	StelPainter* sPainter;
 	StelCore* core;
 	float angularSizeLimit;
-	bool checkMaxMagHints;
+	float magLimit;
+	quint64 displayedCatalogsMask;
+	quint64 displayedTypesMask;
+	quint64 largeMask;
+	bool stopAtMaxMagHints;
 };
 
 void NebulaMgr::setCatalogFilters(Nebula::CatalogGroup cflags)
@@ -722,8 +757,11 @@ void NebulaMgr::draw(StelCore* core)
 	float maxMagHints  = computeMaxMagHint(skyDrawer);
 	float maxMagLabels = skyDrawer->getLimitMagnitude()-2.f+(labelsAmount*1.2f)-2.f;
 	sPainter.setFont(nebulaFont);
-	DrawNebulaFuncObject func(maxMagHints, maxMagLabels, &sPainter, core, hintsFader.getInterstate()<=0.f);
-	nebGrid.processIntersectingPointInRegions(p.data(), func);
+	if (hintsFader.getInterstate()>0.f)
+	{
+		DrawNebulaFuncObject func(maxMagHints, maxMagLabels, &sPainter, core);
+		nebGrid.processFilteredPointInRegions(p.data(), func);
+	}
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
 		drawPointer(core, sPainter);
@@ -837,8 +875,11 @@ void NebulaMgr::loadNebulaSet(const QString& setName)
 	QString dsoCatalogPath		= StelFileMgr::findFile("nebulae/" + setName + "/catalog.dat");
 	QString dsoOutlinesPath		= StelFileMgr::findFile("nebulae/" + setName + "/outlines.dat");
 
+	outlineStore.close();
 	dsoArray.clear();
 	dsoIndex.clear();
+	catalogIndex.clear();
+	designationIndex.clear();
 	nebGrid.clear();
 
 	if (flagConverter)
@@ -856,10 +897,22 @@ void NebulaMgr::loadNebulaSet(const QString& setName)
 		return;
 	}
 
-	loadDSOCatalog(dsoCatalogPath);
+	// The catalog is shipped compressed. Its uncompressed copy in the cache directory is mapped in memory, which
+	// avoids decompressing and parsing the whole catalog at each start.
+	const QFileInfo dsoCatalogInfo(dsoCatalogPath);
+	const QString dsoCachePath = StelFileMgr::getCacheDir() + "/nebulae/" + setName + "/catalog.cache";
+	if (!flagCatalogCache || !loadDSOCatalogCache(dsoCachePath, dsoCatalogInfo))
+	{
+		loadDSOCatalog(dsoCatalogPath);
+		if (flagCatalogCache && !dsoArray.isEmpty())
+			writeDSOCatalogCache(dsoCachePath, dsoCatalogInfo);
+	}
 
 	if (!dsoOutlinesPath.isEmpty())
 		loadDSOOutlines(dsoOutlinesPath);
+
+	// The catalog does not change until the next set is loaded
+	nebGrid.buildFlatLayout();
 }
 
 // Look for a nebulae by XYZ coords
@@ -917,194 +970,180 @@ NebulaP NebulaMgr::searchDSO(unsigned int DSO) const
 
 NebulaP NebulaMgr::searchM(unsigned int M) const
 {
-	for (const auto& n : dsoArray)
-		if (n->M_nb == M)
-			return n;
-	return NebulaP();
+	return searchCatalogNumber(Nebula::CatM, M);
 }
 
 NebulaP NebulaMgr::searchNGC(unsigned int NGC) const
 {
-	for (const auto& n : dsoArray)
-		if (n->NGC_nb == NGC)
-			return n;
-	return NebulaP();
+	return searchCatalogNumber(Nebula::CatNGC, NGC);
 }
 
 NebulaP NebulaMgr::searchIC(unsigned int IC) const
 {
-	for (const auto& n : dsoArray)
-		if (n->IC_nb == IC)
-			return n;
-	return NebulaP();
+	return searchCatalogNumber(Nebula::CatIC, IC);
 }
 
 NebulaP NebulaMgr::searchC(unsigned int C) const
 {
-	for (const auto& n : dsoArray)
-		if (n->C_nb == C)
-			return n;
-	return NebulaP();
+	return searchCatalogNumber(Nebula::CatC, C);
 }
 
 NebulaP NebulaMgr::searchB(unsigned int B) const
 {
-	for (const auto& n : dsoArray)
-		if (n->B_nb == B)
-			return n;
-	return NebulaP();
+	return searchCatalogNumber(Nebula::CatB, B);
 }
 
 NebulaP NebulaMgr::searchSh2(unsigned int Sh2) const
 {
-	for (const auto& n : dsoArray)
-		if (n->Sh2_nb == Sh2)
-			return n;
-	return NebulaP();
+	return searchCatalogNumber(Nebula::CatSh2, Sh2);
 }
 
 NebulaP NebulaMgr::searchVdB(unsigned int VdB) const
 {
-	for (const auto& n : dsoArray)
-		if (n->VdB_nb == VdB)
-			return n;
-	return NebulaP();
+	return searchCatalogNumber(Nebula::CatVdB, VdB);
 }
 
 NebulaP NebulaMgr::searchRCW(unsigned int RCW) const
 {
-	for (const auto& n : dsoArray)
-		if (n->RCW_nb == RCW)
-			return n;
-	return NebulaP();
+	return searchCatalogNumber(Nebula::CatRCW, RCW);
 }
 
 NebulaP NebulaMgr::searchLDN(unsigned int LDN) const
 {
-	for (const auto& n : dsoArray)
-		if (n->LDN_nb == LDN)
-			return n;
-	return NebulaP();
+	return searchCatalogNumber(Nebula::CatLDN, LDN);
 }
 
 NebulaP NebulaMgr::searchLBN(unsigned int LBN) const
 {
-	for (const auto& n : dsoArray)
-		if (n->LBN_nb == LBN)
-			return n;
-	return NebulaP();
+	return searchCatalogNumber(Nebula::CatLBN, LBN);
 }
 
 NebulaP NebulaMgr::searchCr(unsigned int Cr) const
 {
-	for (const auto& n : dsoArray)
-		if (n->Cr_nb == Cr)
-			return n;
-	return NebulaP();
+	return searchCatalogNumber(Nebula::CatCr, Cr);
 }
 
 NebulaP NebulaMgr::searchMel(unsigned int Mel) const
 {
-	for (const auto& n : dsoArray)
-		if (n->Mel_nb == Mel)
-			return n;
-	return NebulaP();
+	return searchCatalogNumber(Nebula::CatMel, Mel);
 }
 
 NebulaP NebulaMgr::searchPGC(unsigned int PGC) const
 {
-	for (const auto& n : dsoArray)
-		if (n->PGC_nb == PGC)
-			return n;
-	return NebulaP();
+	return searchCatalogNumber(Nebula::CatPGC, PGC);
 }
 
 NebulaP NebulaMgr::searchUGC(unsigned int UGC) const
 {
-	for (const auto& n : dsoArray)
-		if (n->UGC_nb == UGC)
-			return n;
-	return NebulaP();
+	return searchCatalogNumber(Nebula::CatUGC, UGC);
 }
 
 NebulaP NebulaMgr::searchCed(QString Ced) const
 {
-	for (const auto& n : dsoArray)
-		if (n->Ced_nb.trimmed().toUpper() == Ced.trimmed().toUpper())
-			return n;
-	return NebulaP();
+	return searchDesignation("CED" + Ced);
 }
 
 NebulaP NebulaMgr::searchArp(unsigned int Arp) const
 {
-	for (const auto& n : dsoArray)
-		if (n->Arp_nb == Arp)
-			return n;
-	return NebulaP();
+	return searchCatalogNumber(Nebula::CatArp, Arp);
 }
 
 NebulaP NebulaMgr::searchVV(unsigned int VV) const
 {
-	for (const auto& n : dsoArray)
-		if (n->VV_nb == VV)
-			return n;
-	return NebulaP();
+	return searchCatalogNumber(Nebula::CatVV, VV);
 }
 
 NebulaP NebulaMgr::searchPK(QString PK) const
 {
-	for (const auto& n : dsoArray)
-		if (n->PK_nb.trimmed().toUpper() == PK.trimmed().toUpper())
-			return n;
-	return NebulaP();
+	return searchDesignation("PK" + PK);
 }
 
 NebulaP NebulaMgr::searchPNG(QString PNG) const
 {
-	for (const auto& n : dsoArray)
-		if (n->PNG_nb.trimmed().toUpper() == PNG.trimmed().toUpper())
-			return n;
-	return NebulaP();
+	return searchDesignation("PNG" + PNG);
 }
 
 NebulaP NebulaMgr::searchSNRG(QString SNRG) const
 {
-	for (const auto& n : dsoArray)
-		if (n->SNRG_nb.trimmed().toUpper() == SNRG.trimmed().toUpper())
-			return n;
-	return NebulaP();
+	return searchDesignation("SNRG" + SNRG);
 }
 
 NebulaP NebulaMgr::searchACO(QString ACO) const
 {
-	for (const auto& n : dsoArray)
-		if (n->ACO_nb.trimmed().toUpper() == ACO.trimmed().toUpper())
-			return n;
-	return NebulaP();
+	return searchDesignation("ACO" + ACO);
 }
 
 NebulaP NebulaMgr::searchHCG(QString HCG) const
 {
-	for (const auto& n : dsoArray)
-		if (n->HCG_nb.trimmed().toUpper() == HCG.trimmed().toUpper())
-			return n;
-	return NebulaP();
+	return searchDesignation("HCG" + HCG);
 }
 
 NebulaP NebulaMgr::searchAbell(unsigned int Abell) const
 {
-	for (const auto& n : dsoArray)
-		if (n->Abell_nb == Abell)
-			return n;
-	return NebulaP();
+	return searchCatalogNumber(Nebula::CatAbell, Abell);
 }
 
 NebulaP NebulaMgr::searchESO(QString ESO) const
 {
-	for (const auto& n : dsoArray)
-		if (n->ESO_nb.trimmed().toUpper() == ESO.trimmed().toUpper())
-			return n;
-	return NebulaP();
+	return searchDesignation("ESO" + ESO);
+}
+
+NebulaP NebulaMgr::searchCatalogNumber(Nebula::CatalogGroupFlags catalog, unsigned int number) const
+{
+	if (number==0)
+		return NebulaP();
+	return catalogIndex.value((static_cast<quint64>(catalog) << 32) | number);
+}
+
+NebulaP NebulaMgr::searchDesignation(const QString& designation) const
+{
+	return designationIndex.value(normalizeDesignation(designation));
+}
+
+void NebulaMgr::indexDesignations(const NebulaP& n)
+{
+	struct NumberedCatalog
+	{
+		Nebula::CatalogGroupFlags catalog;
+		unsigned int number;
+		const char* prefix;
+	};
+	const NumberedCatalog numbers[] =
+	{
+		{Nebula::CatNGC, n->NGC_nb, "NGC"}, {Nebula::CatIC, n->IC_nb, "IC"}, {Nebula::CatM, n->M_nb, "M"},
+		{Nebula::CatC, n->C_nb, "C"}, {Nebula::CatB, n->B_nb, "B"}, {Nebula::CatSh2, n->Sh2_nb, "SH2-"},
+		{Nebula::CatVdB, n->VdB_nb, "VDB"}, {Nebula::CatRCW, n->RCW_nb, "RCW"}, {Nebula::CatLDN, n->LDN_nb, "LDN"},
+		{Nebula::CatLBN, n->LBN_nb, "LBN"}, {Nebula::CatCr, n->Cr_nb, "CR"}, {Nebula::CatMel, n->Mel_nb, "MEL"},
+		{Nebula::CatPGC, n->PGC_nb, "PGC"}, {Nebula::CatUGC, n->UGC_nb, "UGC"}, {Nebula::CatArp, n->Arp_nb, "ARP"},
+		{Nebula::CatVV, n->VV_nb, "VV"}, {Nebula::CatAbell, n->Abell_nb, "ABELL"}
+	};
+	// The first object of the catalog with a designation is kept, as the linear searches did.
+	for (const auto& cat : numbers)
+	{
+		if (cat.number==0)
+			continue;
+		const quint64 key = (static_cast<quint64>(cat.catalog) << 32) | cat.number;
+		if (!catalogIndex.contains(key))
+			catalogIndex.insert(key, n);
+		const QString designation = QString("%1%2").arg(cat.prefix).arg(cat.number);
+		if (!designationIndex.contains(designation))
+			designationIndex.insert(designation, n);
+	}
+
+	const QPair<const char*, const QString*> designations[] =
+	{
+		qMakePair("CED", &n->Ced_nb), qMakePair("PK", &n->PK_nb), qMakePair("PNG", &n->PNG_nb),
+		qMakePair("SNRG", &n->SNRG_nb), qMakePair("ACO", &n->ACO_nb), qMakePair("HCG", &n->HCG_nb),
+		qMakePair("ESO", &n->ESO_nb)
+	};
+	for (const auto& des : designations)
+	{
+		if (des.second->trimmed().isEmpty())
+			continue;
+		const QString designation = normalizeDesignation(des.first + *des.second);
+		if (!designationIndex.contains(designation))
+			designationIndex.insert(designation, n);
+	}
 }
 
 QString NebulaMgr::getLatestSelectedDSODesignation() const
@@ -1447,9 +1486,11 @@ void NebulaMgr::convertDSOCatalog(const QString &in, const QString &out, bool de
 
 bool NebulaMgr::loadDSOCatalog(const QString &filename)
 {
+	StelStartupTrace::Scope trace("catalog", filename);
 	QFile in(filename);
 	if (!in.open(QIODevice::ReadOnly))
 		return false;
+	trace.setBytesRead(in.size());
 
 	qDebug() << "Loading DSO data ...";
 
@@ -1481,11 +1522,7 @@ bool NebulaMgr::loadDSOCatalog(const QString &filename)
 			// Create a new Nebula record
 			NebulaP e = NebulaP(new Nebula);
 			e->readDSO(ins);
-
-			dsoArray.append(e);
-			nebGrid.insert(qSharedPointerCast<StelRegionObject>(e));
-			if (e->DSO_nb!=0)
-				dsoIndex.insert(e->DSO_nb, e);
+			addDSO(e);
 		}
 		++totalRecords;
 	}
@@ -1494,6 +1531,238 @@ bool NebulaMgr::loadDSOCatalog(const QString &filename)
 	return true;
 }
 
+void NebulaMgr::addDSO(const NebulaP& e)
+{
+	dsoArray.append(e);
+	nebGrid.insert(qSharedPointerCast<StelRegionObject>(e));
+	if (e->DSO_nb!=0)
+		dsoIndex.insert(e->DSO_nb, e);
+	indexDesignations(e);
+}
+
+namespace
+{
+	// Layout of the DSO catalog cache: a DSOCacheHeader, one column of each of the frequently used values
+	// (in the order of DSOCacheColumn), one DSOCacheDetails per DSO, then the UTF-8 text of the strings.
+	// The DSO are sorted by declination band and right ascension, so that neighbours on the sky are
+	// neighbours in the file, and sourceIndex gives their rank in the source catalog.
+	const char DSO_CACHE_MAGIC[8] = {'S','T','E','L','D','S','O','C'};
+	const quint32 DSO_CACHE_FORMAT = 1;
+	const quint32 DSO_CACHE_BYTE_ORDER = 0x01020304;
+
+	struct DSOCacheHeader
+	{
+		char magic[8];
+		quint32 byteOrder;
+		quint32 format;
+		char catalogVersion[16];
+		qint64 sourceSize;
+		qint64 sourceModified;		// msecs since epoch
+		quint32 recordCount;
+		quint32 stringsSize;
+	};
+
+	enum DSOCacheColumn
+	{
+		ColumnRA, ColumnDec, ColumnBMag, ColumnVMag, ColumnMajorAxis, ColumnMinorAxis, ColumnOrientation, ColumnType,
+		ColumnCount
+	};
+
+	// Offset and length in bytes of a string in the text at the end of the cache
+	struct DSOCacheString
+	{
+		quint32 offset;
+		quint32 length;
+	};
+
+	struct DSOCacheDetails
+	{
+		quint32 sourceIndex;
+		quint32 DSO_nb, NGC_nb, IC_nb, M_nb, C_nb, B_nb, Sh2_nb, VdB_nb, RCW_nb, LDN_nb, LBN_nb, Cr_nb, Mel_nb,
+			PGC_nb, UGC_nb, Arp_nb, VV_nb, Abell_nb;
+		float redshift, redshiftErr, parallax, parallaxErr, oDistance, oDistanceErr;
+		DSOCacheString mTypeString, Ced_nb, PK_nb, PNG_nb, SNRG_nb, ACO_nb, HCG_nb, ESO_nb;
+	};
+
+	qint64 dsoCacheSize(quint32 recordCount, quint32 stringsSize)
+	{
+		return sizeof(DSOCacheHeader) + static_cast<qint64>(recordCount)*(ColumnCount*4 + sizeof(DSOCacheDetails)) + stringsSize;
+	}
+}
+
+bool NebulaMgr::loadDSOCatalogCache(const QString& filename, const QFileInfo& source)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::ReadOnly) || file.size() < static_cast<qint64>(sizeof(DSOCacheHeader)))
+		return false;
+	const uchar* data = file.map(0, file.size());
+	if (!data)
+		return false;
+
+	DSOCacheHeader header;
+	memcpy(&header, data, sizeof(header));
+	const QByteArray version(header.catalogVersion, strnlen(header.catalogVersion, sizeof(header.catalogVersion)));
+	if (memcmp(header.magic, DSO_CACHE_MAGIC, sizeof(header.magic))!=0 || header.byteOrder!=DSO_CACHE_BYTE_ORDER
+	    || header.format!=DSO_CACHE_FORMAT || version!=StellariumDSOCatalogVersion.toLatin1()
+	    || header.sourceSize!=source.size() || header.sourceModified!=source.lastModified().toMSecsSinceEpoch()
+	    || dsoCacheSize(header.recordCount, header.stringsSize)!=file.size())
+	{
+		qDebug() << "DSO catalog cache" << QDir::toNativeSeparators(filename) << "is outdated";
+		file.unmap(const_cast<uchar*>(data));
+		return false;
+	}
+
+	const quint32 n = header.recordCount;
+	const uchar* p = data + sizeof(DSOCacheHeader);
+	const float* columns[ColumnCount];
+	for (int i=0; i<ColumnCount; ++i, p+=n*4)
+		columns[i] = reinterpret_cast<const float*>(p);
+	const qint32* orientation = reinterpret_cast<const qint32*>(columns[ColumnOrientation]);
+	const quint32* type = reinterpret_cast<const quint32*>(columns[ColumnType]);
+	const DSOCacheDetails* details = reinterpret_cast<const DSOCacheDetails*>(p);
+	const char* strings = reinterpret_cast<const char*>(p + n*sizeof(DSOCacheDetails));
+	auto text = [&](const DSOCacheString& s) {
+		return s.offset+s.length<=header.stringsSize ? QString::fromUtf8(strings+s.offset, s.length) : QString();
+	};
+
+	QVector<NebulaP> loaded(n);
+	for (quint32 i=0; i<n; ++i)
+	{
+		const DSOCacheDetails& d = details[i];
+		if (d.sourceIndex>=n || loaded[d.sourceIndex])
+		{
+			qWarning() << "DSO catalog cache" << QDir::toNativeSeparators(filename) << "is corrupted";
+			file.unmap(const_cast<uchar*>(data));
+			return false;
+		}
+		NebulaP e = NebulaP(new Nebula);
+		e->DSO_nb = d.DSO_nb; e->NGC_nb = d.NGC_nb; e->IC_nb = d.IC_nb; e->M_nb = d.M_nb; e->C_nb = d.C_nb;
+		e->B_nb = d.B_nb; e->Sh2_nb = d.Sh2_nb; e->VdB_nb = d.VdB_nb; e->RCW_nb = d.RCW_nb; e->LDN_nb = d.LDN_nb;
+		e->LBN_nb = d.LBN_nb; e->Cr_nb = d.Cr_nb; e->Mel_nb = d.Mel_nb; e->PGC_nb = d.PGC_nb; e->UGC_nb = d.UGC_nb;
+		e->Arp_nb = d.Arp_nb; e->VV_nb = d.VV_nb; e->Abell_nb = d.Abell_nb;
+		e->Ced_nb = text(d.Ced_nb); e->PK_nb = text(d.PK_nb); e->PNG_nb = text(d.PNG_nb); e->SNRG_nb = text(d.SNRG_nb);
+		e->ACO_nb = text(d.ACO_nb); e->HCG_nb = text(d.HCG_nb); e->ESO_nb = text(d.ESO_nb);
+		e->mTypeString = text(d.mTypeString);
+		e->bMag = columns[ColumnBMag][i];
+		e->vMag = columns[ColumnVMag][i];
+		e->majorAxisSize = columns[ColumnMajorAxis][i];
+		e->minorAxisSize = columns[ColumnMinorAxis][i];
+		e->orientationAngle = orientation[i];
+		e->redshift = d.redshift; e->redshiftErr = d.redshiftErr;
+		e->parallax = d.parallax; e->parallaxErr = d.parallaxErr;
+		e->oDistance = d.oDistance; e->oDistanceErr = d.oDistanceErr;
+		e->setupCatalogData(columns[ColumnRA][i], columns[ColumnDec][i], type[i]);
+		loaded[d.sourceIndex] = e;
+	}
+	file.unmap(const_cast<uchar*>(data));
+
+	// Keep the order of the source catalog, which decides which DSO is found for duplicated designations.
+	dsoArray.reserve(n);
+	for (const auto& e : loaded)
+		addDSO(e);
+	qDebug() << "Loaded" << n << "DSO records from cache";
+	return true;
+}
+
+void NebulaMgr::writeDSOCatalogCache(const QString& filename, const QFileInfo& source) const
+{
+	const quint32 n = dsoArray.size();
+	QVector<float> ra(n), dec(n);
+	QVector<quint32> order(n);
+	for (quint32 i=0; i<n; ++i)
+	{
+		double lng, lat;
+		StelUtils::rectToSphe(&lng, &lat, dsoArray.at(i)->XYZ);
+		if (lng<0.)
+			lng += 2.*M_PI;
+		ra[i] = static_cast<float>(lng);
+		dec[i] = static_cast<float>(lat);
+		order[i] = i;
+	}
+	// Sort by bands of 1 degree of declination, then by right ascension.
+	std::sort(order.begin(), order.end(), [&](quint32 a, quint32 b) {
+		const int bandA = static_cast<int>(std::floor(dec[a]*180./M_PI));
+		const int bandB = static_cast<int>(std::floor(dec[b]*180./M_PI));
+		return bandA!=bandB ? bandA<bandB : ra[a]<ra[b];
+	});
+
+	QByteArray strings;
+	auto addText = [&](const QString& s) {
+		const QByteArray utf8 = s.toUtf8();
+		DSOCacheString r = {static_cast<quint32>(strings.size()), static_cast<quint32>(utf8.size())};
+		strings.append(utf8);
+		return r;
+	};
+	QVector<float> columns[ColumnCount];
+	for (auto& column : columns)
+		column.reserve(n);
+	QVector<DSOCacheDetails> details;
+	details.reserve(n);
+	for (quint32 i : order)
+	{
+		const Nebula& e = *dsoArray.at(i);
+		columns[ColumnRA].append(ra[i]);
+		columns[ColumnDec].append(dec[i]);
+		columns[ColumnBMag].append(e.bMag);
+		columns[ColumnVMag].append(e.vMag);
+		columns[ColumnMajorAxis].append(e.majorAxisSize);
+		columns[ColumnMinorAxis].append(e.minorAxisSize);
+		const qint32 orientation = e.orientationAngle;
+		const quint32 type = e.nType;
+		float value;
+		memcpy(&value, &orientation, 4);
+		columns[ColumnOrientation].append(value);
+		memcpy(&value, &type, 4);
+		columns[ColumnType].append(value);
+
+		DSOCacheDetails d;
+		d.sourceIndex = i;
+		d.DSO_nb = e.DSO_nb; d.NGC_nb = e.NGC_nb; d.IC_nb = e.IC_nb; d.M_nb = e.M_nb; d.C_nb = e.C_nb;
+		d.B_nb = e.B_nb; d.Sh2_nb = e.Sh2_nb; d.VdB_nb = e.VdB_nb; d.RCW_nb = e.RCW_nb; d.LDN_nb = e.LDN_nb;
+		d.LBN_nb = e.LBN_nb; d.Cr_nb = e.Cr_nb; d.Mel_nb = e.Mel_nb; d.PGC_nb = e.PGC_nb; d.UGC_nb = e.UGC_nb;
+		d.Arp_nb = e.Arp_nb; d.VV_nb = e.VV_nb; d.Abell_nb = e.Abell_nb;
+		d.redshift = e.redshift; d.redshiftErr = e.redshiftErr;
+		d.parallax = e.parallax; d.parallaxErr = e.parallaxErr;
+		d.oDistance = e.oDistance; d.oDistanceErr = e.oDistanceErr;
+		d.mTypeString = addText(e.mTypeString);
+		d.Ced_nb = addText(e.Ced_nb); d.PK_nb = addText(e.PK_nb); d.PNG_nb = addText(e.PNG_nb);
+		d.SNRG_nb = addText(e.SNRG_nb); d.ACO_nb = addText(e.ACO_nb); d.HCG_nb = addText(e.HCG_nb);
+		d.ESO_nb = addText(e.ESO_nb);
+		details.append(d);
+	}
+
+	DSOCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, DSO_CACHE_MAGIC, sizeof(header.magic));
+	header.byteOrder = DSO_CACHE_BYTE_ORDER;
+	header.format = DSO_CACHE_FORMAT;
+	const QByteArray version = StellariumDSOCatalogVersion.toLatin1().left(sizeof(header.catalogVersion)-1);
+	memcpy(header.catalogVersion, version.constData(), version.size());
+	header.sourceSize = source.size();
+	header.sourceModified = source.lastModified().toMSecsSinceEpoch();
+	header.recordCount = n;
+	header.stringsSize = strings.size();
+
+	StelFileMgr::mkDir(QFileInfo(filename).absolutePath());
+	QFile file(filename);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		qWarning() << "Cannot write DSO catalog cache" << QDir::toNativeSeparators(filename);
+		return;
+	}
+	bool ok = file.write(reinterpret_cast<const char*>(&header), sizeof(header))==sizeof(header);
+	for (const auto& column : columns)
+		ok = ok && file.write(reinterpret_cast<const char*>(column.constData()), n*4)==n*4;
+	ok = ok && file.write(reinterpret_cast<const char*>(details.constData()), n*sizeof(DSOCacheDetails))==static_cast<qint64>(n*sizeof(DSOCacheDetails));
+	ok = ok && file.write(strings)==strings.size();
+	file.close();
+	if (!ok)
+	{
+		qWarning() << "Cannot write DSO catalog cache" << QDir::toNativeSeparators(filename);
+		file.remove();
+	}
+}
+
 bool NebulaMgr::loadDSONames(const QString &filename)
 {
 	qDebug() << "Loading DSO name data ...";
@@ -1645,87 +1914,24 @@ bool NebulaMgr::loadDSONames(const QString &filename)
 
 bool NebulaMgr::loadDSOOutlines(const QString &filename)
 {
-	qDebug() << "Loading DSO outline data ...";
-	QFile dsoOutlineFile(filename);
-	if (!dsoOutlineFile.open(QIODevice::ReadOnly | QIODevice::Text))
+	qDebug() << "Indexing DSO outline data ...";
+	// Only the positions of the outlines in the file are loaded, their points are read when they are drawn
+	const int readOk = outlineStore.open(filename, [this](const QString& dso) -> const Nebula*
+	{
+		NebulaP e = searchDesignation(dso);
+		if (e.isNull())
+			e = search(dso);
+		if (e.isNull())
+			return Q_NULLPTR;
+		e->hasOutlines = true;
+		return e.data();
+	});
+	if (readOk<0)
 	{
 		qWarning() << "DSO outline data file" << QDir::toNativeSeparators(filename) << "not found.";
 		return false;
 	}
-
-	double RA, DE;
-	int i, readOk = 0;
-	Vec3d XYZ;
-	std::vector<Vec3d> *points = Q_NULLPTR;
-	typedef QPair<double, double> coords;
-	coords point, fpoint;
-	QList<coords> outline;
-	QString record, command, dso;
-	NebulaP e;
-	// Read the outlines data of the DSO
-	QRegExp commentRx("^(\\s*#.*|\\s*)$");
-	while (!dsoOutlineFile.atEnd())
-	{
-		record = QString::fromUtf8(dsoOutlineFile.readLine());
-		if (commentRx.exactMatch(record))
-			continue;
-
-		// bytes 1 - 8, RA
-		RA = record.left(8).toDouble();
-		// bytes 9 -18, DE
-		DE = record.mid(9, 10).toDouble();
-		// bytes 19-25, command
-		command = record.mid(19, 7).trimmed();
-		// bytes 26, designation of DSO
-		dso = record.mid(26).trimmed();
-
-		RA*=M_PI/12.;     // Convert from hours to rad
-		DE*=M_PI/180.;    // Convert from deg to rad
-
-		if (command.contains("start", Qt::CaseInsensitive))
-		{
-			outline.clear();
-			e = search(dso);
-
-			point.first  = RA;
-			point.second = DE;
-			outline.append(point);
-			fpoint = point;
-		}
-
-		if (command.contains("vertex", Qt::CaseInsensitive))
-		{
-			point.first  = RA;
-			point.second = DE;
-			outline.append(point);
-		}
-
-		if (command.contains("end", Qt::CaseInsensitive))
-		{
-			point.first  = RA;
-			point.second = DE;
-			outline.append(point);
-			outline.append(fpoint);
-
-			if (!e.isNull())
-			{
-				points = new std::vector<Vec3d>;
-				for (i = 0; i < outline.size(); i++)
-				{
-					// Calc the Cartesian coord with RA and DE
-					point = outline.at(i);
-					StelUtils::spheToRect(point.first, point.second, XYZ);
-					points->push_back(XYZ);
-				}
-
-				e->outlineSegments.push_back(points);
-			}
-			readOk++;
-		}
-
-	}
-	dsoOutlineFile.close();
-	qDebug() << "Loaded" << readOk << "DSO outline records successfully";	
+	qDebug() << "Indexed" << readOk << "DSO outline records successfully";
 	return true;
 }
 
@@ -1818,13 +2024,11 @@ StelObjectP NebulaMgr::searchByNameI18n(const QString& nameI18n) const
 	QString objw = nameI18n.toUpper();
 
 	// Search by NGC numbers (possible formats are "NGC31" or "NGC 31")
-	if (objw.left(3) == "NGC")
+	if (objw.startsWith("NGC"))
 	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("NGC%1").arg(n->NGC_nb) == objw || QString("NGC %1").arg(n->NGC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
+		NebulaP n = searchDesignation(objw);
+		if (n)
+			return qSharedPointerCast<StelObject>(n);
 	}
 
 	// Search by common names
@@ -1845,237 +2049,10 @@ StelObjectP NebulaMgr::searchByNameI18n(const QString& nameI18n) const
 		}
 	}
 
-	// Search by IC numbers (possible formats are "IC466" or "IC 466")
-	if (objw.left(2) == "IC")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("IC%1").arg(n->IC_nb) == objw || QString("IC %1").arg(n->IC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-
-	// Search by Messier numbers (possible formats are "M31" or "M 31")
-	if (objw.left(1) == "M" && objw.left(3) != "MEL")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("M%1").arg(n->M_nb) == objw || QString("M %1").arg(n->M_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Caldwell numbers (possible formats are "C31" or "C 31")
-	if (objw.left(1) == "C" && objw.left(2) != "CR" && objw.left(3) != "CED")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("C%1").arg(n->C_nb) == objw || QString("C %1").arg(n->C_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Barnard numbers (possible formats are "B31" or "B 31")
-	if (objw.left(1) == "B")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("B%1").arg(n->B_nb) == objw || QString("B %1").arg(n->B_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Sharpless numbers (possible formats are "Sh2-31" or "Sh 2-31")
-	if (objw.left(2) == "SH")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("SH2-%1").arg(n->Sh2_nb) == objw || QString("SH 2-%1").arg(n->Sh2_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Van den Bergh numbers (possible formats are "VdB31" or "VdB 31")
-	if (objw.left(3) == "VDB")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("VDB%1").arg(n->VdB_nb) == objw || QString("VDB %1").arg(n->VdB_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by RCW numbers (possible formats are "RCW31" or "RCW 31")
-	if (objw.left(3) == "RCW")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("RCW%1").arg(n->RCW_nb) == objw || QString("RCW %1").arg(n->RCW_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by LDN numbers (possible formats are "LDN31" or "LDN 31")
-	if (objw.left(3) == "LDN")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("LDN%1").arg(n->LDN_nb) == objw || QString("LDN %1").arg(n->LDN_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by LBN numbers (possible formats are "LBN31" or "LBN 31")
-	if (objw.left(3) == "LBN")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("LBN%1").arg(n->LBN_nb) == objw || QString("LBN %1").arg(n->LBN_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Collinder numbers (possible formats are "Cr31" or "Cr 31")
-	if (objw.left(2) == "CR")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("CR%1").arg(n->Cr_nb) == objw || QString("CR %1").arg(n->Cr_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Melotte numbers (possible formats are "Mel31" or "Mel 31")
-	if (objw.left(3) == "MEL")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("MEL%1").arg(n->Mel_nb) == objw || QString("MEL %1").arg(n->Mel_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by PGC numbers (possible formats are "PGC31" or "PGC 31")
-	if (objw.left(3) == "PGC")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("PGC%1").arg(n->PGC_nb) == objw || QString("PGC %1").arg(n->PGC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by UGC numbers (possible formats are "UGC31" or "UGC 31")
-	if (objw.left(3) == "UGC")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("UGC%1").arg(n->UGC_nb) == objw || QString("UGC %1").arg(n->UGC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Arp numbers (possible formats are "ARP31" or "ARP 31")
-	if (objw.left(3) == "ARP")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("ARP%1").arg(n->Arp_nb) == objw || QString("ARP %1").arg(n->Arp_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by VV numbers (possible formats are "VV31" or "VV 31")
-	if (objw.left(2) == "VV")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("VV%1").arg(n->VV_nb) == objw || QString("VV %1").arg(n->VV_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Cederblad numbers (possible formats are "Ced31" or "Ced 31")
-	if (objw.left(3) == "CED")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("CED%1").arg(n->Ced_nb.trimmed().toUpper()) == objw.trimmed() || QString("CED %1").arg(n->Ced_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by PK numbers
-	if (objw.left(2) == "PK")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("PK%1").arg(n->PK_nb.trimmed().toUpper()) == objw.trimmed() || QString("PK %1").arg(n->PK_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by PN G numbers
-	if (objw.left(2) == "PN")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("PNG%1").arg(n->PNG_nb.trimmed().toUpper()) == objw.trimmed() || QString("PN G%1").arg(n->PNG_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by SNR G numbers
-	if (objw.left(3) == "SNR")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("SNRG%1").arg(n->SNRG_nb.trimmed().toUpper()) == objw.trimmed() || QString("SNR G%1").arg(n->SNRG_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by ACO numbers (possible formats are "ACO31" or "ACO 31")
-	if (objw.left(3) == "ACO")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("ACO%1").arg(n->ACO_nb.trimmed().toUpper()) == objw.trimmed()
-			|| QString("ACO %1").arg(n->ACO_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by ACO numbers (possible formats are "Abell31" or "Abell 31")
-	if (objw.left(5) == "ABELL")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("ABELL%1").arg(n->Abell_nb) == objw || QString("ABELL %1").arg(n->Abell_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by HCG numbers (possible formats are "HCG31" or "HCG 31")
-	if (objw.left(3) == "HCG")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("HCG%1").arg(n->HCG_nb.trimmed().toUpper()) == objw.trimmed() || QString("HCG %1").arg(n->HCG_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by ESO numbers (possible formats are "ESO53-1" or "ESO 53-1")
-	if (objw.left(3) == "ESO")
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("ESO%1").arg(n->ESO_nb.trimmed().toUpper()) == objw.trimmed() || QString("ESO %1").arg(n->ESO_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
+	// Search by the other designations (possible formats are e.g. "IC466", "IC 466", "Sh2-31" or "PN G001.0+02.3")
+	NebulaP n = searchDesignation(objw);
+	if (n)
+		return qSharedPointerCast<StelObject>(n);
 
 	return StelObjectP();
 }
@@ -2091,11 +2068,9 @@ StelObjectP NebulaMgr::searchByName(const QString& name) const
 	// Search by NGC numbers (possible formats are "NGC31" or "NGC 31")
 	if (objw.startsWith("NGC"))
 	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("NGC%1").arg(n->NGC_nb) == objw || QString("NGC %1").arg(n->NGC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
+		NebulaP n = searchDesignation(objw);
+		if (n)
+			return qSharedPointerCast<StelObject>(n);
 	}
 
 	// Search by common names
@@ -2119,238 +2094,36 @@ StelObjectP NebulaMgr::searchByName(const QString& name) const
 		}
 	}
 
-	// Search by IC numbers (possible formats are "IC466" or "IC 466")
-	if (objw.startsWith("IC"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("IC%1").arg(n->IC_nb) == objw || QString("IC %1").arg(n->IC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
+	// Search by the other designations (possible formats are e.g. "IC466", "IC 466", "Sh2-31" or "PN G001.0+02.3")
+	NebulaP n = searchDesignation(objw);
+	if (n)
+		return qSharedPointerCast<StelObject>(n);
 
-	// Search by Messier numbers (possible formats are "M31" or "M 31")
-	if (objw.startsWith("M") && !objw.startsWith("ME"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("M%1").arg(n->M_nb) == objw || QString("M %1").arg(n->M_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Caldwell numbers (possible formats are "C31" or "C 31")
-	if (objw.startsWith("C") && !objw.startsWith("CR") && !objw.startsWith("CE"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("C%1").arg(n->C_nb) == objw || QString("C %1").arg(n->C_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Barnard numbers (possible formats are "B31" or "B 31")
-	if (objw.startsWith("B"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("B%1").arg(n->B_nb) == objw || QString("B %1").arg(n->B_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Sharpless numbers (possible formats are "Sh2-31" or "Sh 2-31")
-	if (objw.startsWith("SH"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("SH2-%1").arg(n->Sh2_nb) == objw || QString("SH 2-%1").arg(n->Sh2_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Van den Bergh numbers (possible formats are "VdB31" or "VdB 31")
-	if (objw.startsWith("VDB"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("VDB%1").arg(n->VdB_nb) == objw || QString("VDB %1").arg(n->VdB_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by RCW numbers (possible formats are "RCW31" or "RCW 31")
-	if (objw.startsWith("RCW"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("RCW%1").arg(n->RCW_nb) == objw || QString("RCW %1").arg(n->RCW_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by LDN numbers (possible formats are "LDN31" or "LDN 31")
-	if (objw.startsWith("LDN"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("LDN%1").arg(n->LDN_nb) == objw || QString("LDN %1").arg(n->LDN_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by LBN numbers (possible formats are "LBN31" or "LBN 31")
-	if (objw.startsWith("LBN"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("LBN%1").arg(n->LBN_nb) == objw || QString("LBN %1").arg(n->LBN_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Collinder numbers (possible formats are "Cr31" or "Cr 31")
-	if (objw.startsWith("CR") || objw.startsWith("COL"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("CR%1").arg(n->Cr_nb) == objw || QString("CR %1").arg(n->Cr_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Melotte numbers (possible formats are "Mel31" or "Mel 31")
-	if (objw.startsWith("MEL"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("MEL%1").arg(n->Mel_nb) == objw || QString("MEL %1").arg(n->Mel_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by PGC numbers (possible formats are "PGC31" or "PGC 31")
-	if (objw.startsWith("PGC"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("PGC%1").arg(n->PGC_nb) == objw || QString("PGC %1").arg(n->PGC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by UGC numbers (possible formats are "UGC31" or "UGC 31")
-	if (objw.startsWith("UGC"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("UGC%1").arg(n->UGC_nb) == objw || QString("UGC %1").arg(n->UGC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Arp numbers (possible formats are "Arp31" or "Arp 31")
-	if (objw.startsWith("ARP"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("ARP%1").arg(n->Arp_nb) == objw || QString("ARP %1").arg(n->Arp_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by VV numbers (possible formats are "VV31" or "VV 31")
-	if (objw.startsWith("VV"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("VV%1").arg(n->VV_nb) == objw || QString("VV %1").arg(n->VV_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Cederblad numbers (possible formats are "Ced31" or "Ced 31")
-	if (objw.startsWith("CED"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("CED%1").arg(n->Ced_nb.trimmed().toUpper()) == objw.trimmed() || QString("CED %1").arg(n->Ced_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by PK numbers
-	if (objw.startsWith("PK"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("PK%1").arg(n->PK_nb.trimmed().toUpper()) == objw.trimmed() || QString("PK %1").arg(n->PK_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by PN G numbers
-	if (objw.startsWith("PN"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("PNG%1").arg(n->PNG_nb.trimmed().toUpper()) == objw.trimmed() || QString("PN G%1").arg(n->PNG_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by SNR G numbers
-	if (objw.startsWith("SNR"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("SNRG%1").arg(n->SNRG_nb.trimmed().toUpper()) == objw.trimmed() || QString("SNR G%1").arg(n->SNRG_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by ACO numbers
-	if (objw.startsWith("ACO"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("ACO%1").arg(n->ACO_nb.trimmed().toUpper()) == objw.trimmed()
-			|| QString("ACO %1").arg(n->ACO_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
-	// Search by Abell numbers
-	if (objw.startsWith("ABELL"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("ABELL%1").arg(n->Abell_nb) == objw || QString("ABELL %1").arg(n->Abell_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
+	return Q_NULLPTR;
+}
 
-	// Search by HCG numbers
-	if (objw.startsWith("HCG"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("HCG%1").arg(n->HCG_nb.trimmed().toUpper()) == objw.trimmed() || QString("HCG %1").arg(n->HCG_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
+StelObjectP NebulaMgr::searchByID(const QString &id) const
+{
+	// Identifiers are designations most of the time.
+	NebulaP n = searchDesignation(id);
+	if (n)
+		return qSharedPointerCast<StelObject>(n);
+	return searchByName(id);
+}
 
-	// Search by ESO numbers
-	if (objw.startsWith("ESO"))
-	{
-		for (const auto& n : dsoArray)
-		{
-			if (QString("ESO%1").arg(n->ESO_nb.trimmed().toUpper()) == objw.trimmed() || QString("ESO %1").arg(n->ESO_nb.trimmed().toUpper()) == objw.trimmed())
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
+quint64 NebulaMgr::getObjectIndex(const StelObject* obj) const
+{
+	const Nebula* n = dynamic_cast<const Nebula*>(obj);
+	if (n==Q_NULLPTR || n->DSO_nb==0)
+		return InvalidObjectIndex;
+	return n->DSO_nb;
+}
 
-	return Q_NULLPTR;
+StelObjectP NebulaMgr::searchByObjectIndex(quint64 index) const
+{
+	if (index>std::numeric_limits<unsigned int>::max())
+		return StelObjectP();
+	return qSharedPointerCast<StelObject>(searchDSO(static_cast<unsigned int>(index)));
 }
 
 //! Find and return the list of at most maxNbItem objects auto-completing the passed object name
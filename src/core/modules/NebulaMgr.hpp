@@ -28,6 +28,7 @@
 #include "StelObjectModule.hpp"
 #include "StelTextureTypes.hpp"
 #include "Nebula.hpp"
+#include "DSOOutlineStore.hpp"
 
 #include <QString>
 #include <QStringList>
@@ -36,6 +37,7 @@
 class StelTranslator;
 class StelToneReproducer;
 class QSettings;
+class QFileInfo;
 class StelPainter;
 
 typedef QSharedPointer<Nebula> NebulaP;
@@ -352,7 +354,12 @@ public:
 	//! @param name The case in-sensistive standard program name
 	virtual StelObjectP searchByName(const QString& name) const;
 
-	virtual StelObjectP searchByID(const QString &id) const { return searchByName(id); }
+	virtual StelObjectP searchByID(const QString &id) const;
+
+	//! The index of a DSO in object handles is its number in the DSO catalog.
+	//! DSO without number, e.g. added from outline files, have no handle.
+	virtual quint64 getObjectIndex(const StelObject* obj) const Q_DECL_OVERRIDE;
+	virtual StelObjectP searchByObjectIndex(quint64 index) const Q_DECL_OVERRIDE;
 
 	//! Find and return the list of at most maxNbItem objects auto-completing the passed object English name.
 	//! @param objPrefix the case insensitive first letters of the searched object
@@ -968,8 +975,25 @@ private:
 	NebulaP searchAbell(unsigned int Abell) const;
 	NebulaP searchESO(QString ESO) const;
 
+	//! Find a DSO by its number in a catalog with numeric designations, using catalogIndex.
+	NebulaP searchCatalogNumber(Nebula::CatalogGroupFlags catalog, unsigned int number) const;
+	//! Find a DSO by a designation like "NGC 224" or "PN G001.0+02.3", using designationIndex.
+	//! Case and white spaces are ignored.
+	NebulaP searchDesignation(const QString& designation) const;
+	//! Add the catalog numbers and designations of a DSO to catalogIndex and designationIndex.
+	void indexDesignations(const NebulaP& n);
+
 	// Load catalog of DSO
 	bool loadDSOCatalog(const QString& filename);
+	//! Load the DSO from the uncompressed cache of a catalog, mapped in memory.
+	//! @param filename the cache file
+	//! @param source the compressed catalog from which the cache was written
+	//! @return false if the cache is missing or does not match the catalog, then nothing is loaded.
+	bool loadDSOCatalogCache(const QString& filename, const QFileInfo& source);
+	//! Write the loaded DSO to an uncompressed cache which loadDSOCatalogCache() can map in memory.
+	void writeDSOCatalogCache(const QString& filename, const QFileInfo& source) const;
+	//! Add a loaded DSO to dsoArray and the indices.
+	void addDSO(const NebulaP& e);
 	void convertDSOCatalog(const QString& in, const QString& out, bool decimal);
 	// Load proper names for DSO
 	bool loadDSONames(const QString& filename);
@@ -978,6 +1002,12 @@ private:
 
 	QVector<NebulaP> dsoArray;		// The DSO list
 	QHash<unsigned int, NebulaP> dsoIndex;
+	//! DSO by catalog and number, with keys (catalog flag << 32 | number), for catalogs with numeric designations.
+	QHash<quint64, NebulaP> catalogIndex;
+	//! DSO by any of their designations, upper case without white spaces (e.g. "NGC224", "SH2-155", "PNG001.0+02.3").
+	QHash<QString, NebulaP> designationIndex;
+	//! Outlines of the DSOs, read on demand from outlines.dat
+	DSOOutlineStore outlineStore;
 
 	LinearFader hintsFader;
 	LinearFader flagShow;
@@ -997,6 +1027,8 @@ private:
 
 	// For DSO convertor
 	bool flagConverter;
+	// Load the DSO catalog from an uncompressed cache
+	bool flagCatalogCache;
 	bool flagDecimalCoordinates;
 };
 
@@ -155,6 +155,10 @@ public:
 	PlanetP getPlanet(void) const { return planet;}
 	float getLatitude(void) const {return latitude;}
 	float getLongitude(void) const {return longitude;}
+	//! Get the diameter of the feature in kilometers
+	float getSize(void) const {return size;}
+	//! Get the direction of the feature in the planetocentric frame
+	const Vec3d& getPlanetocentricPosition(void) const {return XYZpc;}
 
 private:
 	Vec3d XYZpc;                         // holds planetocentric position (from longitude/latitude)
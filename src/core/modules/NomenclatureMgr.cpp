@@ -34,6 +34,8 @@
 #include <QFile>
 #include <QDir>
 
+#include <algorithm>
+
 NomenclatureMgr::NomenclatureMgr()
 {
 	setObjectName("NomenclatureMgr");
@@ -59,9 +61,6 @@ void NomenclatureMgr::init()
 {
 	texPointer = StelApp::getInstance().getTextureManager().createTexture(StelFileMgr::getInstallationDir()+"/textures/pointeur2.png");
 
-	// Load the nomenclature
-	loadNomenclature();
-
 	setColor(StelUtils::strToVec3f(conf->value("color/planet_nomenclature_color", "0.1,1.0,0.1").toString()));
 	setFlagLabels(conf->value("astro/flag_planets_nomenclature", false).toBool());
 	setFlagHideLocalNomenclature(conf->value("astro/flag_hide_local_nomenclature", true).toBool());
@@ -76,6 +75,12 @@ void NomenclatureMgr::init()
 	addAction("actionShow_Planets_Nomenclature", displayGroup, N_("Nomenclature labels"), "nomenclatureDisplayed", "Alt+N");
 }
 
+void NomenclatureMgr::loadData()
+{
+	// Only reads the file and the planets of the solar system
+	loadNomenclature();
+}
+
 void NomenclatureMgr::updateNomenclatureData()
 {
 	bool flag = getFlagLabels();
@@ -89,6 +94,8 @@ void NomenclatureMgr::loadNomenclature()
 	qDebug() << "Loading nomenclature for Solar system bodies ...";
 
 	nomenclatureItems.clear();	
+	featureIndex.clear();
+	invalidateNameIndex();
 
 	// regular expression to find the comments and empty lines
 	QRegExp commentRx("^(\\s*#.*|\\s*)$");
@@ -377,6 +384,8 @@ void NomenclatureMgr::loadNomenclature()
 
 		planetSurfNamesFile.close();
 		qDebug() << "Loaded" << readOk << "/" << totalRecords << "items of planetary surface nomenclature";
+		invalidateNameIndex();
+		buildFeatureIndex();
 
 		faultPlanets.removeDuplicates();
 		int err = faultPlanets.size();
@@ -386,9 +395,56 @@ void NomenclatureMgr::loadNomenclature()
 	}
 }
 
+void NomenclatureMgr::buildFeatureIndex()
+{
+	featureIndex.clear();
+	const int lonTiles = 360/FEATURE_TILE_SIZE;
+	const int latTiles = 180/FEATURE_TILE_SIZE;
+	for (const auto& p : nomenclatureItems.uniqueKeys())
+	{
+		QHash<int, FeatureTile> tiles;
+		PlanetFeatures& features = featureIndex[p];
+		for (auto i = nomenclatureItems.find(p); i != nomenclatureItems.end() && i.key() == p; ++i)
+		{
+			const NomenclatureItemP& nItem = i.value();
+			if (!nItem)
+				continue;
+			double lon = std::fmod(static_cast<double>(nItem->getLongitude()), 360.);
+			if (lon < 0.)
+				lon += 360.;
+			const int lonTile = qBound(0, static_cast<int>(lon/FEATURE_TILE_SIZE), lonTiles-1);
+			const int latTile = qBound(0, static_cast<int>((nItem->getLatitude()+90.)/FEATURE_TILE_SIZE), latTiles-1);
+			tiles[latTile*lonTiles+lonTile].items.append(nItem);
+			features.maxSize = qMax(features.maxSize, nItem->getSize());
+		}
+
+		for (auto& tile : tiles)
+		{
+			std::sort(tile.items.begin(), tile.items.end(), [](const NomenclatureItemP& a, const NomenclatureItemP& b) {
+				return a->getSize() > b->getSize();
+			});
+			Vec3d center(0.);
+			for (const auto& nItem : tile.items)
+				center += nItem->getPlanetocentricPosition();
+			// A tile around a pole may have opposite features
+			if (center.lengthSquared() < 1e-12)
+				center = tile.items.first()->getPlanetocentricPosition();
+			center.normalize();
+			double minCos = 1.;
+			for (const auto& nItem : tile.items)
+				minCos = qMin(minCos, center.dot(nItem->getPlanetocentricPosition()));
+			tile.center = center;
+			// A tile whose features are not within 90 degrees of its center is never culled
+			tile.sinRadius = minCos <= 0. ? 2. : std::sqrt(1.-minCos*minCos);
+			features.tiles.append(tile);
+		}
+	}
+}
+
 void NomenclatureMgr::deinit()
 {
 	nomenclatureItems.clear();
+	featureIndex.clear();
 	texPointer.clear();
 }
 
@@ -416,12 +472,31 @@ void NomenclatureMgr::draw(StelCore* core)
 		if (p->getVMagnitude(core) >= 20.)
 			continue;
 
-		// Render all the items of this planet.
-		for (auto i = nomenclatureItems.find(p); i != nomenclatureItems.end() && i.key() == p; ++i)
+		// The features are at least this far, and are drawn when larger than 50 pixels (see NomenclatureItem::draw())
+		const auto index = featureIndex.constFind(p);
+		if (index == featureIndex.constEnd())
+			continue;
+		const double minDistance = equPos.length() - r;
+		const double pixelPerRad = painter.getProjector()->getPixelPerRadAtCenter();
+		const double sizeScale = p->getSphereScale()/AU;
+		if (minDistance > 0. && std::atan2(index->maxSize*sizeScale, minDistance)*pixelPerRad <= 50.)
+			continue;
+
+		// The direction of the observer in the planetocentric frame of the features, see NomenclatureItem::getJ2000EquatorialPos()
+		const Mat4d rot = (core->matVsop87ToJ2000 * p->getRotEquatorialToVsop87()) * Mat4d::zrotation(p->getAxisRotation()* M_PI/180.0);
+		const Vec3d observerDir = rot.transpose().multiplyWithoutTranslation(-n);
+
+		// Render the items of the tiles of this planet which face the observer, while they may be large enough.
+		for (const auto& tile : index->tiles)
 		{
-			const NomenclatureItemP& nItem = i.value();
-			if (nItem)
+			if (tile.center.dot(observerDir) < -tile.sinRadius)
+				continue;
+			for (const auto& nItem : tile.items)
+			{
+				if (minDistance > 0. && std::atan2(nItem->getSize()*sizeScale, minDistance)*pixelPerRad <= 50.)
+					break;
 				nItem->draw(core, &painter);
+			}
 		}
 	}
 
@@ -613,6 +688,8 @@ void NomenclatureMgr::setFlagLabels(bool b)
 	{
 		for (const auto& i : nomenclatureItems)
 			i->setFlagLabels(b);
+		// Only the names of displayed items are listed
+		invalidateNameIndex();
 		emit nomenclatureDisplayedChanged(b);
 	}
 }
@@ -26,7 +26,9 @@
 #include "NomenclatureItem.hpp"
 
 #include <QFont>
+#include <QHash>
 #include <QMultiHash>
+#include <QVector>
 
 class StelPainter;
 class QSettings;
@@ -56,6 +58,8 @@ public:
 	///////////////////////////////////////////////////////////////////////////
 	// Methods defined in the StelModule class
 	virtual void init();
+	virtual void loadData() Q_DECL_OVERRIDE;
+	virtual QStringList getInitDependencies() const Q_DECL_OVERRIDE {return QStringList("SolarSystem");}
 	virtual void deinit();
 	virtual void update(double) {;}
 	virtual void draw(StelCore* core);
@@ -140,11 +144,36 @@ private:
 	//! Load nomenclature for solar system bodies
 	void loadNomenclature();
 
+	//! The features of a planet in a tile of planetocentric longitude and latitude
+	struct FeatureTile
+	{
+		//! The planetocentric direction of the center of the features
+		Vec3d center;
+		//! The sine of the largest angle between the center and a feature
+		double sinRadius;
+		//! The features, the largest first
+		QVector<NomenclatureItemP> items;
+	};
+	//! The tiles of the features of a planet, see buildFeatureIndex()
+	struct PlanetFeatures
+	{
+		PlanetFeatures() : maxSize(0.f) {}
+		QVector<FeatureTile> tiles;
+		//! The diameter of the largest feature [km]
+		float maxSize;
+	};
+	//! The size of the tiles of the feature index, in degrees of longitude and latitude
+	static const int FEATURE_TILE_SIZE = 10;
+	//! Sort the features of each planet in tiles, so that draw() only handles the tiles of the hemisphere which
+	//! faces the observer, and the features which can be large enough on the screen.
+	void buildFeatureIndex();
+
 	// Font used for displaying our text
 	QFont font;
 	QSettings* conf;
 	StelTextureSP texPointer;	
 	QMultiHash<PlanetP, NomenclatureItemP> nomenclatureItems;
+	QHash<PlanetP, PlanetFeatures> featureIndex;
 };
 
 #endif /* NOMENCLATUREMGR_HPP */
@@ -0,0 +1,119 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "ObserverEphemeris.hpp"
+#include "SolarSystem.hpp"
+#include "Planet.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelObserver.hpp"
+#include "StelSkyDrawer.hpp"
+
+#include <cmath>
+
+ObserverEphemeris::ObserverEphemeris(StelCore* core, double startJD, double stopJD)
+	: ssystem(GETSTELMODULE(SolarSystem))
+	, observer(new StelObserver(core->getCurrentLocation()))
+	, topocentric(core->getUseTopocentricCoordinates())
+	, lightTime(ssystem->getFlagLightTravelTime())
+	, withAtmosphere(core->getSkyDrawer()->getFlagHasAtmosphere())
+	, fromEarth(core->getCurrentLocation().planetName=="Earth")
+	, refraction(core->getSkyDrawer()->getRefraction())
+	, extinction(core->getSkyDrawer()->getExtinction())
+{
+	home = observer->getHomePlanet();
+
+	// See StelCore::updateTransformMatrices()
+	const Vec3d offset = observer->getTopographicOffsetFromCenter(); // [rho cosPhi', rho sinPhi', phi'_rad]
+	const double sigma = core->getCurrentLocation().latitude*M_PI/180.0 - offset.v[2];
+	const double rho = observer->getDistanceFromCenter();
+	topocentricOffset = Vec3d(rho*sin(sigma), 0., rho*cos(sigma));
+
+	// Delta T changes by a fraction of a second per year: a table of at most 10000 entries
+	// is accurate enough, and StelCore::computeDeltaT() is only called from the main thread.
+	if (stopJD<startJD)
+		std::swap(startJD, stopJD);
+	deltaTStep = qMax(1., (stopJD-startJD)/10000.);
+	deltaTStartJD = startJD - deltaTStep;
+	const int count = static_cast<int>(std::ceil((stopJD-startJD)/deltaTStep)) + 3;
+	deltaT.reserve(count);
+	for (int i=0; i<count; ++i)
+		deltaT.append(core->computeDeltaT(deltaTStartJD + i*deltaTStep));
+}
+
+ObserverEphemeris::~ObserverEphemeris()
+{
+}
+
+double ObserverEphemeris::getJDE(double JD) const
+{
+	const double x = (JD-deltaTStartJD)/deltaTStep;
+	const int i = qBound(0, static_cast<int>(std::floor(x)), deltaT.size()-2);
+	const double t = x - i;
+	return JD + (deltaT.at(i) + t*(deltaT.at(i+1)-deltaT.at(i)))/86400.;
+}
+
+ObserverEphemeris::Frame ObserverEphemeris::computeFrame(double JD) const
+{
+	Frame frame;
+	frame.JD = JD;
+	frame.JDE = getJDE(JD);
+
+	// Same frames as StelCore::updateTransformMatrices(), for the given date.
+	const Mat4d matAltAzToEquinoxEqu = observer->getRotAltAzToEquatorial(JD, frame.JDE);
+	const Mat4d matEquinoxEquToJ2000 = StelCore::matVsop87ToJ2000 * home->computeRotEquatorialToVsop87(frame.JDE);
+	frame.matAltAzToJ2000 = matEquinoxEquToJ2000 * matAltAzToEquinoxEqu;
+	frame.observerPos = ssystem->computeStateAt(home, frame.JDE).heliocentricPos;
+	if (topocentric)
+		frame.observerPos += (StelCore::matJ2000ToVsop87 * frame.matAltAzToJ2000).multiplyWithoutTranslation(topocentricOffset);
+	return frame;
+}
+
+Vec3d ObserverEphemeris::computeJ2000Pos(const PlanetP& planet, const Frame& frame, PlanetState* state) const
+{
+	const PlanetState s = ssystem->computeStateAt(planet, frame.JDE, home, lightTime);
+	if (state)
+		*state = s;
+	return StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(s.heliocentricPos - frame.observerPos);
+}
+
+Vec3d ObserverEphemeris::j2000ToAltAz(const Vec3d& j2000Pos, const Frame& frame, bool withRefraction) const
+{
+	Vec3d altAzPos = frame.matAltAzToJ2000.transpose().multiplyWithoutTranslation(j2000Pos);
+	if (withRefraction && withAtmosphere)
+		refraction.forward(altAzPos);
+	return altAzPos;
+}
+
+float ObserverEphemeris::computeVMagnitude(const PlanetP& planet, const Frame& frame, const PlanetState& state, bool withExtinction) const
+{
+	Vec3d parentPos(0.);
+	const PlanetP parent = planet->getParent();
+	if (parent && parent->getParent())
+		parentPos = ssystem->computeStateAt(parent, frame.JDE-state.lightTime, PlanetP(), false).heliocentricPos;
+	float mag = planet->computeVMagnitude(frame.observerPos, state.heliocentricPos, parentPos, frame.JDE, fromEarth);
+	if (withAtmosphere && withExtinction)
+	{
+		Vec3d dir = j2000ToAltAz(StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(state.heliocentricPos - frame.observerPos), frame, false);
+		dir.normalize();
+		extinction.forward(dir, &mag);
+	}
+	return mag;
+}
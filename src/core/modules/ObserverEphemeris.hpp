@@ -0,0 +1,100 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef OBSERVEREPHEMERIS_HPP
+#define OBSERVEREPHEMERIS_HPP
+
+#include "VecMath.hpp"
+#include "RefractionExtinction.hpp"
+
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QVector>
+
+class StelCore;
+class StelObserver;
+class SolarSystem;
+class Planet;
+struct PlanetState;
+typedef QSharedPointer<Planet> PlanetP;
+
+//! @class ObserverEphemeris
+//! Positions of solar system bodies as seen by the current observer, for arbitrary dates.
+//! The location of the observer and the relevant settings of StelCore are copied on construction,
+//! which must be done in the main thread. Afterwards, all methods are const and can be called
+//! from any thread in parallel: neither StelCore nor the planets are changed.
+//! Delta T is tabulated on construction for the range of dates which will be queried.
+class ObserverEphemeris
+{
+public:
+	//! Position and orientation of the observer at a date
+	struct Frame
+	{
+		double JD;		//!< date (UT)
+		double JDE;		//!< date (TT)
+		Vec3d observerPos;	//!< heliocentric ecliptical J2000 position of the observer, with the topocentric offset when enabled [AU]
+		Mat4d matAltAzToJ2000;	//!< rotation from the horizontal frame to equatorial J2000
+	};
+
+	//! @param core the core providing the current observer and settings
+	//! @param startJD, stopJD range of the dates (UT) which will be queried. Delta T is extrapolated outside.
+	ObserverEphemeris(StelCore* core, double startJD, double stopJD);
+	~ObserverEphemeris();
+
+	//! Get the JDE (TT) for a JD (UT), interpolated from the Delta T table.
+	double getJDE(double JD) const;
+	//! Compute the position and orientation of the observer for a date (UT).
+	Frame computeFrame(double JD) const;
+
+	//! Compute the J2000 equatorial position of a body relative to the observer [AU],
+	//! with light time correction when it is enabled in SolarSystem.
+	//! @param state if not null, receives the heliocentric state of the body at the retarded time
+	Vec3d computeJ2000Pos(const PlanetP& planet, const Frame& frame, PlanetState* state=Q_NULLPTR) const;
+	//! Convert an equatorial J2000 position to the horizontal frame.
+	//! @param withRefraction apply refraction when the observer has an atmosphere
+	Vec3d j2000ToAltAz(const Vec3d& j2000Pos, const Frame& frame, bool withRefraction) const;
+	//! Compute the visual magnitude of a body, with extinction when the observer has an atmosphere.
+	//! The Sun is assumed not to be eclipsed.
+	//! @param state the heliocentric state of the body as returned by computeJ2000Pos()
+	//! @param withExtinction false to get the magnitude outside the atmosphere, like Planet::getVMagnitude()
+	float computeVMagnitude(const PlanetP& planet, const Frame& frame, const PlanetState& state, bool withExtinction=true) const;
+
+	//! Get the planet of the observer.
+	const PlanetP& getHomePlanet() const {return home;}
+	//! Get whether the observer has an atmosphere.
+	bool hasAtmosphere() const {return withAtmosphere;}
+
+private:
+	const SolarSystem* ssystem;
+	QScopedPointer<StelObserver> observer;
+	PlanetP home;
+	bool topocentric;
+	bool lightTime;
+	bool withAtmosphere;
+	bool fromEarth;
+	Vec3d topocentricOffset;	// offset of the observer from the center of the planet in the horizontal frame
+	Refraction refraction;
+	Extinction extinction;
+
+	double deltaTStartJD;		// JD of the first entry of deltaT
+	double deltaTStep;		// interval between the entries of deltaT [days]
+	QVector<double> deltaT;		// Delta T [s]
+};
+
+#endif // OBSERVEREPHEMERIS_HPP
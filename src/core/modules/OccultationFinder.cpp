@@ -0,0 +1,528 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "OccultationFinder.hpp"
+#include "PhenomenaFinder.hpp"
+#include "SolarSystem.hpp"
+#include "Planet.hpp"
+#include "StarMgr.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelObject.hpp"
+#include "StelSphereGeometry.hpp"
+#include "StelUtils.hpp"
+
+#include <QtConcurrent>
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	// Length of the segments of the track of the Moon searched for stars [days]
+	const double SEGMENT_LENGTH = 0.25;
+	// Number of samples of the separation in a segment
+	const int SEGMENT_SAMPLES = 8;
+	// Largest angular radius of the Moon seen from the surface of the Earth [rad]
+	const double MAX_MOON_RADIUS = 0.0050;
+	// Margin of the caps for the curvature of the track and the changing parallax [rad]
+	const double TRACK_MARGIN = 0.01;
+	// Largest angular velocity of the Moon relative to the stars seen from the surface of the Earth [rad/day]
+	const double MAX_MOON_RATE = 0.35;
+	// Largest separation of the closest approaches refined for eclipses [rad]
+	const double MAX_ECLIPSE_SEPARATION = 0.05;
+	// Longest duration from the greatest phase to a contact [days]
+	const double MAX_OCCULTATION_HALF_DURATION = 0.15;
+	const double MAX_ECLIPSE_HALF_DURATION = 0.25;
+	// Step of the search for a bracket of the contacts [days]
+	const double CONTACT_STEP = 0.01;
+	// Tolerance on the dates [days]
+	const double TOLERANCE = 1e-6;
+
+	bool earlier(const OccultationFinder::Event& a, const OccultationFinder::Event& b)
+	{
+		return a.JD < b.JD;
+	}
+
+	double altitude(const Vec3d& altAzPos)
+	{
+		return std::asin(qBound(-1., altAzPos[2]/altAzPos.length(), 1.));
+	}
+}
+
+OccultationFinder::OccultationFinder(StelCore* core, double startJD, double stopJD)
+	: core(core)
+	, startJD(qMin(startJD, stopJD))
+	, stopJD(qMax(startJD, stopJD))
+	, ephemeris(core, startJD, stopJD)
+	, ssystem(GETSTELMODULE(SolarSystem))
+{
+	sun = ssystem->getSun();
+	moon = ssystem->getMoon();
+	earth = ssystem->getEarth();
+}
+
+bool OccultationFinder::canSearch() const
+{
+	return ephemeris.getHomePlanet() == earth && moon && sun;
+}
+
+Vec3d OccultationFinder::computeDirection(const PlanetP& planet, const ObserverEphemeris::Frame& frame, double* distance) const
+{
+	Vec3d pos = ephemeris.computeJ2000Pos(planet, frame);
+	const double length = pos.length();
+	if (distance)
+		*distance = length;
+	return pos/length;
+}
+
+double OccultationFinder::moonRadius(double distance) const
+{
+	return std::asin(qMin(moon->getRadius()/distance, 1.));
+}
+
+bool OccultationFinder::findContacts(const std::function<double(double)>& g, double JD, double maxDuration, double* start, double* stop)
+{
+	// Bracket, then bisect each crossing
+	auto crossing = [&](double direction, double* date) -> bool
+	{
+		double inside = JD;
+		double outside = JD;
+		do
+		{
+			inside = outside;
+			outside += direction*CONTACT_STEP;
+			if (qAbs(outside-JD) > maxDuration)
+				return false;
+		} while (g(outside) < 0.);
+		while (qAbs(outside-inside) > TOLERANCE)
+		{
+			const double middle = 0.5*(inside+outside);
+			if (g(middle) < 0.)
+				inside = middle;
+			else
+				outside = middle;
+		}
+		*date = 0.5*(inside+outside);
+		return true;
+	};
+	return crossing(-1., start) && crossing(1., stop);
+}
+
+OccultationFinder::Event OccultationFinder::makeEvent(EventType type, Coverage coverage, double JD, double separation) const
+{
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	Event event;
+	event.type = type;
+	event.coverage = coverage;
+	event.objectMagnitude = std::numeric_limits<float>::quiet_NaN();
+	event.JD = JD;
+	event.separation = separation;
+	event.magnitude = nan;
+	event.startJD = event.stopJD = nan;
+	event.partialStartJD = event.partialStopJD = nan;
+	event.totalStartJD = event.totalStopJD = nan;
+
+	const ObserverEphemeris::Frame frame = ephemeris.computeFrame(JD);
+	event.moonAltitude = altitude(ephemeris.j2000ToAltAz(ephemeris.computeJ2000Pos(moon, frame), frame, true));
+	event.sunAltitude = altitude(ephemeris.j2000ToAltAz(ephemeris.computeJ2000Pos(sun, frame), frame, true));
+	return event;
+}
+
+bool OccultationFinder::refineOccultation(const std::function<Vec3d(const ObserverEphemeris::Frame&)>& direction, double JD,
+					  double separation, Event* event) const
+{
+	double distance;
+	const ObserverEphemeris::Frame frame = ephemeris.computeFrame(JD);
+	computeDirection(moon, frame, &distance);
+	if (separation >= moonRadius(distance))
+		return false;
+
+	// Separation of the object from the limb of the Moon
+	const std::function<double(double)> g = [&](double date)
+	{
+		const ObserverEphemeris::Frame f = ephemeris.computeFrame(date);
+		double d;
+		const Vec3d u = computeDirection(moon, f, &d);
+		return u.angleNormalized(direction(f)) - moonRadius(d);
+	};
+	double start, stop;
+	if (!findContacts(g, JD, MAX_OCCULTATION_HALF_DURATION, &start, &stop))
+		return false;
+
+	*event = makeEvent(LunarOccultation, Total, JD, separation);
+	event->startJD = start;
+	event->stopJD = stop;
+	return true;
+}
+
+QVector<OccultationFinder::Event> OccultationFinder::findStarOccultations(float maxMagnitude) const
+{
+	QVector<Event> result;
+	const StarMgr* smgr = GETSTELMODULE(StarMgr);
+	if (!canSearch() || !smgr)
+		return result;
+
+	// Track of the Moon at the boundaries of the segments
+	const int count = qMax(1, static_cast<int>(std::ceil((stopJD-startJD)/SEGMENT_LENGTH)));
+	const double step = (stopJD-startJD)/count;
+	QVector<int> indices(count+1);
+	for (int i=0; i<=count; ++i)
+		indices[i] = i;
+	QVector<Vec3d> track(count+1);
+	Vec3d* trackData = track.data();
+	QtConcurrent::blockingMap(indices, [&](int& i)
+	{
+		trackData[i] = computeDirection(moon, ephemeris.computeFrame(startJD + i*step));
+	});
+
+	// Stars inside a cap around each segment
+	struct Candidate
+	{
+		StelObjectP star;
+		Vec3d pos;
+		float magnitude;
+		double start;
+		bool found;
+		Event event;
+	};
+	QVector<Candidate> candidates;
+	for (int i=0; i<count; ++i)
+	{
+		const Vec3d& u0 = track.at(i);
+		const Vec3d& u1 = track.at(i+1);
+		Vec3d center = u0+u1;
+		center.normalize();
+		const double radius = 0.5*u0.angleNormalized(u1) + MAX_MOON_RADIUS + TRACK_MARGIN;
+		const double segmentStart = startJD + i*step;
+		QVector<Vec3d> positions;
+		const QList<StelObjectP> stars = smgr->searchBrighterThan(SphericalCap(center, std::cos(radius)), maxMagnitude,
+									  ephemeris.getJDE(segmentStart + 0.5*step), &positions);
+		for (int k=0; k<stars.size(); ++k)
+			candidates.append({stars.at(k), positions.at(k), stars.at(k)->getVMagnitude(core), segmentStart, false, Event()});
+	}
+
+	const double sampleStep = step/SEGMENT_SAMPLES;
+	QtConcurrent::blockingMap(candidates, [&](Candidate& candidate)
+	{
+		const Vec3d pos = candidate.pos;
+		const std::function<double(double)> f = [&](double JD)
+		{
+			return computeDirection(moon, ephemeris.computeFrame(JD)).angleNormalized(pos);
+		};
+		// Sample the segment with one more sample on each side to bracket the closest approach
+		int best = -1;
+		double fBest = std::numeric_limits<double>::max();
+		for (int j=-1; j<=SEGMENT_SAMPLES+1; ++j)
+		{
+			const double fj = f(candidate.start + j*sampleStep);
+			if (fj < fBest)
+			{
+				fBest = fj;
+				best = j;
+			}
+		}
+		if (best < 0 || best > SEGMENT_SAMPLES || fBest - MAX_MOON_RATE*sampleStep > MAX_MOON_RADIUS)
+			return;
+		const double x = candidate.start + best*sampleStep;
+		double fmin;
+		const double JD = PhenomenaFinder::minimize(f, x-sampleStep, x+sampleStep, x, fBest, TOLERANCE, &fmin);
+		// A star found in two segments is only reported by the one containing the closest approach.
+		if (JD < candidate.start || JD >= candidate.start + step || JD < startJD || JD > stopJD)
+			return;
+		candidate.found = refineOccultation([&](const ObserverEphemeris::Frame&) { return pos; }, JD, fmin, &candidate.event);
+	});
+
+	for (auto& candidate : candidates)
+	{
+		if (!candidate.found)
+			continue;
+		Event& event = candidate.event;
+		event.object = candidate.star->getEnglishName();
+		event.objectI18n = candidate.star->getNameI18n();
+		if (event.object.isEmpty())
+		{
+			// Stars without a designation are identified by their J2000 coordinates
+			double ra, dec;
+			StelUtils::rectToSphe(&ra, &dec, candidate.pos);
+			event.object = QString("%1 %2").arg(StelUtils::radToHmsStrAdapt(ra), StelUtils::radToDmsStrAdapt(dec));
+		}
+		if (event.objectI18n.isEmpty())
+			event.objectI18n = event.object;
+		event.objectMagnitude = candidate.magnitude;
+		result.append(event);
+	}
+	std::sort(result.begin(), result.end(), earlier);
+	return result;
+}
+
+QVector<OccultationFinder::Event> OccultationFinder::findPlanetOccultations(const QList<PlanetP>& planets) const
+{
+	QVector<Event> result;
+	if (!canSearch())
+		return result;
+
+	QList<PlanetP> bodies;
+	for (const auto& planet : planets)
+	{
+		if (planet != moon && planet != earth && planet != sun)
+			bodies.append(planet);
+	}
+	const PhenomenaFinder finder(core, startJD, stopJD);
+	QVector<PhenomenaFinder::Phenomenon> phenomena = finder.find(moon, bodies, MAX_MOON_RADIUS, false);
+	QVector<Event> events(phenomena.size());
+	QVector<bool> found(phenomena.size(), false);
+	Event* eventData = events.data();
+	bool* foundData = found.data();
+	QVector<int> indices(phenomena.size());
+	for (int i=0; i<indices.size(); ++i)
+		indices[i] = i;
+	QtConcurrent::blockingMap(indices, [&](int& i)
+	{
+		const PhenomenaFinder::Phenomenon& phenomenon = phenomena.at(i);
+		const PlanetP& planet = bodies.at(phenomenon.object2);
+		foundData[i] = refineOccultation([&](const ObserverEphemeris::Frame& frame) { return computeDirection(planet, frame); },
+						 phenomenon.JD, phenomenon.separation, &eventData[i]);
+		if (foundData[i])
+		{
+			const ObserverEphemeris::Frame frame = ephemeris.computeFrame(phenomenon.JD);
+			PlanetState state;
+			ephemeris.computeJ2000Pos(planet, frame, &state);
+			eventData[i].objectMagnitude = ephemeris.computeVMagnitude(planet, frame, state, false);
+		}
+	});
+	for (int i=0; i<events.size(); ++i)
+	{
+		if (!found.at(i))
+			continue;
+		const PlanetP& planet = bodies.at(phenomena.at(i).object2);
+		events[i].object = planet->getEnglishName();
+		events[i].objectI18n = planet->getNameI18n();
+		result.append(events.at(i));
+	}
+	return result;
+}
+
+QVector<OccultationFinder::Event> OccultationFinder::findSolarEclipses() const
+{
+	QVector<Event> result;
+	if (!canSearch())
+		return result;
+
+	struct Disks
+	{
+		double separation, moonRadius, sunRadius;
+	};
+	auto disks = [&](double JD) -> Disks
+	{
+		const ObserverEphemeris::Frame frame = ephemeris.computeFrame(JD);
+		double moonDistance, sunDistance;
+		const Vec3d moonDir = computeDirection(moon, frame, &moonDistance);
+		const Vec3d sunDir = computeDirection(sun, frame, &sunDistance);
+		return {moonDir.angleNormalized(sunDir), moonRadius(moonDistance), std::asin(qMin(sun->getRadius()/sunDistance, 1.))};
+	};
+
+	const PhenomenaFinder finder(core, startJD, stopJD);
+	for (const auto& phenomenon : finder.find(moon, QList<PlanetP>() << sun, MAX_ECLIPSE_SEPARATION, false))
+	{
+		const Disks greatest = disks(phenomenon.JD);
+		if (greatest.separation >= greatest.moonRadius + greatest.sunRadius)
+			continue;
+
+		Coverage coverage = Partial;
+		if (greatest.separation <= greatest.moonRadius - greatest.sunRadius)
+			coverage = Total;
+		else if (greatest.separation <= greatest.sunRadius - greatest.moonRadius)
+			coverage = Annular;
+		Event event = makeEvent(SolarEclipse, coverage, phenomenon.JD, greatest.separation);
+		event.object = sun->getEnglishName();
+		event.objectI18n = sun->getNameI18n();
+		event.magnitude = (greatest.moonRadius + greatest.sunRadius - greatest.separation)/(2.*greatest.sunRadius);
+		findContacts([&](double JD) { const Disks d = disks(JD); return d.separation - d.moonRadius - d.sunRadius; },
+			     phenomenon.JD, MAX_ECLIPSE_HALF_DURATION, &event.startJD, &event.stopJD);
+		if (coverage != Partial)
+			findContacts([&](double JD) { const Disks d = disks(JD); return d.separation - qAbs(d.moonRadius - d.sunRadius); },
+				     phenomenon.JD, MAX_ECLIPSE_HALF_DURATION, &event.totalStartJD, &event.totalStopJD);
+		result.append(event);
+	}
+	return result;
+}
+
+QVector<OccultationFinder::Event> OccultationFinder::findLunarEclipses() const
+{
+	QVector<Event> result;
+	if (!canSearch())
+		return result;
+
+	// Geocentric radii of the shadow of the Earth at the distance of the Moon, following Meeus,
+	// Astronomical Algorithms, ch. 54, with the enlargement of the shadow by the atmosphere.
+	struct Shadow
+	{
+		double separation, moonRadius, umbra, penumbra;
+	};
+	auto shadow = [&](double JD) -> Shadow
+	{
+		const double JDE = ephemeris.getJDE(JD);
+		const Vec3d moonPos = ssystem->computeStateAt(moon, JDE, earth).observerPos;
+		const Vec3d sunPos = ssystem->computeStateAt(sun, JDE, earth).observerPos;
+		const double moonDistance = moonPos.length();
+		const double sunDistance = sunPos.length();
+		const double moonParallax = std::asin(earth->getRadius()/moonDistance);
+		const double sunParallax = std::asin(earth->getRadius()/sunDistance);
+		const double sunRadius = std::asin(sun->getRadius()/sunDistance);
+		return {moonPos.angle(-sunPos), std::asin(moon->getRadius()/moonDistance),
+			1.02*(0.998340*moonParallax - sunRadius + sunParallax),
+			1.02*(0.998340*moonParallax + sunRadius + sunParallax)};
+	};
+	const std::function<double(double)> separation = [&](double JD) { return shadow(JD).separation; };
+
+	// The topocentric oppositions are close to the geocentric ones, which are refined.
+	const PhenomenaFinder finder(core, startJD, stopJD);
+	for (const auto& phenomenon : finder.find(moon, QList<PlanetP>() << sun, MAX_ECLIPSE_SEPARATION, true))
+	{
+		if (!phenomenon.opposition)
+			continue;
+		const double x = phenomenon.JD;
+		const double fx = separation(x);
+		double fmin = fx;
+		double JD = x;
+		if (fx < separation(x-0.2) && fx < separation(x+0.2))
+			JD = PhenomenaFinder::minimize(separation, x-0.2, x+0.2, x, fx, TOLERANCE, &fmin);
+		if (JD < startJD || JD > stopJD)
+			continue;
+		const Shadow greatest = shadow(JD);
+		if (greatest.separation >= greatest.penumbra + greatest.moonRadius)
+			continue;
+
+		Coverage coverage = Penumbral;
+		if (greatest.separation <= greatest.umbra - greatest.moonRadius)
+			coverage = Total;
+		else if (greatest.separation < greatest.umbra + greatest.moonRadius)
+			coverage = Partial;
+		Event event = makeEvent(LunarEclipse, coverage, JD, greatest.separation);
+		event.object = moon->getEnglishName();
+		event.objectI18n = moon->getNameI18n();
+		const double limit = coverage == Penumbral ? greatest.penumbra : greatest.umbra;
+		event.magnitude = (limit + greatest.moonRadius - greatest.separation)/(2.*greatest.moonRadius);
+		findContacts([&](double date) { const Shadow s = shadow(date); return s.separation - s.penumbra - s.moonRadius; },
+			     JD, MAX_ECLIPSE_HALF_DURATION, &event.startJD, &event.stopJD);
+		if (coverage != Penumbral)
+			findContacts([&](double date) { const Shadow s = shadow(date); return s.separation - s.umbra - s.moonRadius; },
+				     JD, MAX_ECLIPSE_HALF_DURATION, &event.partialStartJD, &event.partialStopJD);
+		if (coverage == Total)
+			findContacts([&](double date) { const Shadow s = shadow(date); return s.separation - s.umbra + s.moonRadius; },
+				     JD, MAX_ECLIPSE_HALF_DURATION, &event.totalStartJD, &event.totalStopJD);
+		result.append(event);
+	}
+	return result;
+}
+
+QString OccultationFinder::typeToString(EventType type)
+{
+	switch (type)
+	{
+		case SolarEclipse:
+			return "solar-eclipse";
+		case LunarEclipse:
+			return "lunar-eclipse";
+		default:
+			return "occultation";
+	}
+}
+
+QString OccultationFinder::coverageToString(Coverage coverage)
+{
+	switch (coverage)
+	{
+		case Partial:
+			return "partial";
+		case Annular:
+			return "annular";
+		case Penumbral:
+			return "penumbral";
+		default:
+			return "total";
+	}
+}
+
+QVariantList OccultationFinder::findEvents(double startJD, double stopJD, float maxMagnitude, bool withPlanets, bool withEclipses)
+{
+	StelCore* core = StelApp::getInstance().getCore();
+	const OccultationFinder finder(core, startJD, stopJD);
+	if (!finder.canSearch())
+	{
+		qWarning() << "OccultationFinder: occultations and eclipses can only be searched from the Earth";
+		return QVariantList();
+	}
+
+	QVector<Event> events;
+	// Sirius is brighter than all the other stars
+	if (maxMagnitude >= -2.f)
+		events += finder.findStarOccultations(maxMagnitude);
+	if (withPlanets)
+	{
+		QList<PlanetP> planets;
+		for (const auto& planet : finder.ssystem->getAllPlanets())
+		{
+			if (planet->getPlanetType() == Planet::isPlanet)
+				planets.append(planet);
+		}
+		events += finder.findPlanetOccultations(planets);
+	}
+	if (withEclipses)
+	{
+		events += finder.findSolarEclipses();
+		events += finder.findLunarEclipses();
+	}
+	std::sort(events.begin(), events.end(), earlier);
+
+	QVariantList result;
+	for (const auto& event : events)
+	{
+		QVariantMap map;
+		map.insert("type", typeToString(event.type));
+		map.insert("coverage", coverageToString(event.coverage));
+		map.insert("object", event.object);
+		if (!std::isnan(event.objectMagnitude))
+			map.insert("object-magnitude", event.objectMagnitude);
+		map.insert("jd", event.JD);
+		map.insert("separation", event.separation*180./M_PI);
+		if (!std::isnan(event.magnitude))
+			map.insert("magnitude", event.magnitude);
+		map.insert("altitude-moon", event.moonAltitude*180./M_PI);
+		map.insert("altitude-sun", event.sunAltitude*180./M_PI);
+		auto insertDate = [&](const QString& key, double JD)
+		{
+			if (!std::isnan(JD))
+				map.insert(key, JD);
+		};
+		insertDate("start", event.startJD);
+		insertDate("stop", event.stopJD);
+		insertDate("partial-start", event.partialStartJD);
+		insertDate("partial-stop", event.partialStopJD);
+		insertDate("total-start", event.totalStartJD);
+		insertDate("total-stop", event.totalStopJD);
+		result.append(map);
+	}
+	return result;
+}
@@ -0,0 +1,155 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef OCCULTATIONFINDER_HPP
+#define OCCULTATIONFINDER_HPP
+
+#include "VecMath.hpp"
+#include "ObserverEphemeris.hpp"
+
+#include <QSharedPointer>
+#include <QString>
+#include <QVariantList>
+#include <QVector>
+
+#include <functional>
+
+class StelCore;
+class SolarSystem;
+class Planet;
+typedef QSharedPointer<Planet> PlanetP;
+
+//! @class OccultationFinder
+//! Finds the lunar occultations of stars and planets, and the solar and lunar eclipses, over long ranges of dates.
+//! For occultations of stars, the track of the Moon is cut into short segments. The stars brighter than
+//! the magnitude limit inside a cap covering each segment are taken from StarMgr with a geodesic search,
+//! and the closest approach and the contact times are refined for each candidate in parallel.
+//! Occultations of planets and eclipses start from the closest approaches found by PhenomenaFinder.
+//! Occultations and solar eclipses are computed for the current observer, lunar eclipses are geocentric.
+//! The time of StelCore is never changed: positions come from ObserverEphemeris.
+class OccultationFinder
+{
+public:
+	enum EventType
+	{
+		LunarOccultation,	//!< the Moon covers a star or a planet
+		SolarEclipse,
+		LunarEclipse
+	};
+
+	enum Coverage
+	{
+		Partial,
+		Total,			//!< total eclipse, or occultation
+		Annular,		//!< annular solar eclipse
+		Penumbral		//!< lunar eclipse by the penumbra only
+	};
+
+	//! Circumstances of an occultation or an eclipse.
+	//! Dates of contacts which do not happen are NaN.
+	struct Event
+	{
+		EventType type;
+		Coverage coverage;
+		QString object;		//!< English name of the occulted object, the Sun for solar and the Moon for lunar eclipses
+		QString objectI18n;	//!< translated name of the occulted object
+		float objectMagnitude;	//!< visual magnitude of the occulted object outside the atmosphere, NaN for eclipses
+		double JD;		//!< greatest occultation or eclipse (UT)
+		double separation;	//!< smallest separation of the centers [rad], from the axis of the shadow for lunar eclipses
+		double magnitude;	//!< eclipse magnitude: covered fraction of the diameter of the Sun, or of the Moon in the umbra (in the penumbra for penumbral eclipses). NaN for occultations
+		double startJD;		//!< disappearance, first contact of a solar eclipse, or beginning of the penumbral phase (P1)
+		double stopJD;		//!< reappearance, last contact of a solar eclipse, or end of the penumbral phase (P4)
+		double partialStartJD;	//!< beginning of the umbral phase of a lunar eclipse (U1)
+		double partialStopJD;	//!< end of the umbral phase of a lunar eclipse (U4)
+		double totalStartJD;	//!< second contact of a total or annular solar eclipse, or beginning of totality of a lunar eclipse (U2)
+		double totalStopJD;	//!< third contact of a total or annular solar eclipse, or end of totality of a lunar eclipse (U3)
+		double moonAltitude;	//!< altitude of the Moon at JD for the observer [rad]
+		double sunAltitude;	//!< altitude of the Sun at JD for the observer [rad]
+	};
+
+	//! Prepare the search. Must be called from the main thread.
+	//! @param core the core providing the current observer and settings
+	//! @param startJD, stopJD range of dates to search (UT)
+	OccultationFinder(StelCore* core, double startJD, double stopJD);
+
+	//! Get whether the observer is on the Earth, which is required for all the searches.
+	bool canSearch() const;
+
+	//! Find the occultations of stars by the Moon. Must be called from the main thread, because of the geodesic search.
+	//! @param maxMagnitude the magnitude of the faintest stars
+	//! @return the occultations, sorted by date
+	QVector<Event> findStarOccultations(float maxMagnitude) const;
+	//! Find the occultations of bodies of the solar system by the Moon.
+	//! @param planets the occulted bodies
+	//! @return the occultations, sorted by date
+	QVector<Event> findPlanetOccultations(const QList<PlanetP>& planets) const;
+	//! Find the solar eclipses visible from the location of the observer.
+	//! @return the eclipses, sorted by date
+	QVector<Event> findSolarEclipses() const;
+	//! Find the lunar eclipses.
+	//! @return the eclipses, sorted by date
+	QVector<Event> findLunarEclipses() const;
+
+	//! Find occultations and eclipses at the current location. Must be called from the main thread.
+	//! @param startJD, stopJD range of dates to search (UT)
+	//! @param maxMagnitude the magnitude of the faintest occulted stars, no stars are searched if negative infinity
+	//! @param withPlanets find the occultations of the major planets
+	//! @param withEclipses find the solar and lunar eclipses
+	//! @return a list of maps sorted by date, with the keys type (occultation, solar-eclipse, lunar-eclipse),
+	//! coverage (partial, total, annular, penumbral), object, object-magnitude, jd, separation [degrees],
+	//! magnitude, altitude-moon, altitude-sun [degrees] and the contact dates start, stop, partial-start,
+	//! partial-stop, total-start, total-stop which happen.
+	static QVariantList findEvents(double startJD, double stopJD, float maxMagnitude, bool withPlanets, bool withEclipses);
+
+	//! Get the English name of a type of event, as used by findEvents().
+	static QString typeToString(EventType type);
+	//! Get the English name of a coverage, as used by findEvents().
+	static QString coverageToString(Coverage coverage);
+
+private:
+	//! Get the J2000 unit vector from the observer to a body, and optionally its distance [AU].
+	Vec3d computeDirection(const PlanetP& planet, const ObserverEphemeris::Frame& frame, double* distance=Q_NULLPTR) const;
+	//! Get the angular radius of the Moon seen by the observer.
+	double moonRadius(double distance) const;
+	//! Find the dates where a function crosses zero on both sides of a negative minimum.
+	//! @return false if no crossing was found within the maximum duration
+	static bool findContacts(const std::function<double(double)>& g, double JD, double maxDuration, double* start, double* stop);
+	//! Initialize an event at the date of the greatest occultation or eclipse.
+	Event makeEvent(EventType type, Coverage coverage, double JD, double separation) const;
+
+	//! Refine an occultation by the Moon around a closest approach.
+	//! @param direction the J2000 unit vector from the observer to the occulted object
+	//! @param JD, separation the closest approach
+	//! @param event receives the occultation
+	//! @return false if the Moon does not cover the object
+	bool refineOccultation(const std::function<Vec3d(const ObserverEphemeris::Frame&)>& direction, double JD, double separation,
+			       Event* event) const;
+
+	StelCore* core;
+	const double startJD;
+	const double stopJD;
+	ObserverEphemeris ephemeris;
+	const SolarSystem* ssystem;
+	PlanetP sun;
+	PlanetP moon;
+	PlanetP earth;
+};
+
+#endif // OCCULTATIONFINDER_HPP
@@ -252,6 +252,17 @@ CometOrbit::CometOrbit(double pericenterDistance,
 void CometOrbit::positionAtTimevInVSOP87Coordinates(double JDE, double *v, bool updateVelocityVector)
 {
 	Q_UNUSED(updateVelocityVector);
+	double vel[3];
+	stateAtTimeInVSOP87Coordinates(JDE, v, vel);
+	//if (updateVelocityVector)
+	//{
+		rdot.set(vel[0], vel[1], vel[2]);
+		updateTails=true;
+	//}
+}
+
+void CometOrbit::stateAtTimeInVSOP87Coordinates(double JDE, double *v, double *vel) const
+{
 	JDE -= t0;
 	double rCosNu,rSinNu;
 	if (e < 1.0) InitEll(q,n,e,JDE,rCosNu,rSinNu); // Laguerre-Conway seems stable enough to go for <1.0.
@@ -267,12 +278,9 @@ void CometOrbit::positionAtTimevInVSOP87Coordinates(double JDE, double *v, bool
 	v[0] = rotateToVsop87[0]*p0 + rotateToVsop87[1]*p1 + rotateToVsop87[2]*p2;
 	v[1] = rotateToVsop87[3]*p0 + rotateToVsop87[4]*p1 + rotateToVsop87[5]*p2;
 	v[2] = rotateToVsop87[6]*p0 + rotateToVsop87[7]*p1 + rotateToVsop87[8]*p2;
-
-	//if (updateVelocityVector)
-	//{
-		rdot.set(s0, s1, s2);
-		updateTails=true;
-	//}
+	vel[0] = s0;
+	vel[1] = s1;
+	vel[2] = s2;
 }
 
 
@@ -499,6 +507,28 @@ void EllipticalOrbit::positionAtTimevInVSOP87Coordinates(const double JDE, doubl
 	v[2] = rotateToVsop87[6]*pos[0] + rotateToVsop87[7]*pos[1] + rotateToVsop87[8]*pos[2];
 }
 
+void EllipticalOrbit::positionAtTimevInVSOP87Coordinates(const double JDE, double* v, double* vel) const
+{
+	positionAtTimevInVSOP87Coordinates(JDE, v);
+	if (eccentricity >= 1.0)
+	{
+		vel[0]=vel[1]=vel[2]=0.0;
+		return;
+	}
+	// Derivative of positionAtE(), with dE/dt = n/(1 - e cos E).
+	const double meanMotion = 2.0 * M_PI / period;
+	const double E = eccentricAnomaly(meanAnomalyAtEpoch + (JDE-epoch) * meanMotion);
+	const double a = pericenterDistance / (1.0 - eccentricity);
+	const double dE = meanMotion / (1.0 - eccentricity * cos(E));
+	const Mat4d R = (Mat4d::zrotation(ascendingNode) *
+			 Mat4d::xrotation(inclination) *
+			 Mat4d::zrotation(argOfPeriapsis));
+	const Vec3d dPos = R.multiplyWithoutTranslation(Vec3d(-a * sin(E) * dE, a * std::sqrt(1 - eccentricity * eccentricity) * cos(E) * dE, 0));
+	vel[0] = rotateToVsop87[0]*dPos[0] + rotateToVsop87[1]*dPos[1] + rotateToVsop87[2]*dPos[2];
+	vel[1] = rotateToVsop87[3]*dPos[0] + rotateToVsop87[4]*dPos[1] + rotateToVsop87[5]*dPos[2];
+	vel[2] = rotateToVsop87[6]*dPos[0] + rotateToVsop87[7]*dPos[1] + rotateToVsop87[8]*dPos[2];
+}
+
 double EllipticalOrbit::getPeriod() const
 {
 	return period;
@@ -541,3 +571,153 @@ void CachingOrbit::sample(double start, double t, int nSamples, OrbitSampleProc&
 		proc.sample(positionAtTime(start + dt * i));
 }
 */
+
+namespace
+{
+	//! Number of orbits solved together by KeplerOrbitBatch::computePositions().
+	static const int KEPLER_BATCH_BLOCK = 64;
+	//! Fixed number of Laguerre-Conway iterations. It usually converges in 2-3 iterations, occasionally up to 6 (see InitEll).
+	static const int KEPLER_BATCH_ITERATIONS = 8;
+
+	//! Apply the rotation to VSOP87 of an orbit to a vector.
+	Vec3d rotateVector(const double* rotateToVsop87, const Vec3d& v)
+	{
+		return Vec3d(rotateToVsop87[0]*v[0] + rotateToVsop87[1]*v[1] + rotateToVsop87[2]*v[2],
+			     rotateToVsop87[3]*v[0] + rotateToVsop87[4]*v[1] + rotateToVsop87[5]*v[2],
+			     rotateToVsop87[6]*v[0] + rotateToVsop87[7]*v[1] + rotateToVsop87[8]*v[2]);
+	}
+}
+
+void KeplerOrbitBatch::clear()
+{
+	q.clear();
+	e.clear();
+	a.clear();
+	b.clear();
+	M0.clear();
+	n.clear();
+	epoch.clear();
+	sqrtMuP.clear();
+	Px.clear(); Py.clear(); Pz.clear();
+	Qx.clear(); Qy.clear(); Qz.clear();
+	comets.clear();
+}
+
+int KeplerOrbitBatch::add(const EllipticalOrbit* orbit)
+{
+	if (orbit->eccentricity<0.0 || orbit->eccentricity>=1.0)
+		return -1;
+	// Same rotations as EllipticalOrbit::positionAtE()
+	const Mat4d R = (Mat4d::zrotation(orbit->ascendingNode) *
+			 Mat4d::xrotation(orbit->inclination) *
+			 Mat4d::zrotation(orbit->argOfPeriapsis));
+	const Vec3d P = rotateVector(orbit->rotateToVsop87, R*Vec3d(1., 0., 0.));
+	const Vec3d Q = rotateVector(orbit->rotateToVsop87, R*Vec3d(0., 1., 0.));
+	return add(orbit->pericenterDistance, orbit->eccentricity, orbit->meanAnomalyAtEpoch, 2.0*M_PI/orbit->period,
+		   orbit->epoch, P, Q, Q_NULLPTR);
+}
+
+int KeplerOrbitBatch::add(CometOrbit* orbit)
+{
+	if (orbit->e<0.0 || orbit->e>=1.0)
+		return -1;
+	// Same vectors as Init3D. CometOrbit does not rotate velocities to VSOP87, but the rotation
+	// of comet orbits is always the identity, so P and Q can be used for both.
+	double Px, Py, Pz, Qx, Qy, Qz, unused0, unused1, unused2;
+	Init3D(orbit->i, orbit->Om, orbit->w, 1.0, 0.0, Px, Py, Pz, unused0, unused1, unused2);
+	Init3D(orbit->i, orbit->Om, orbit->w, 0.0, 1.0, Qx, Qy, Qz, unused0, unused1, unused2);
+	const Vec3d P = rotateVector(orbit->rotateToVsop87, Vec3d(Px, Py, Pz));
+	const Vec3d Q = rotateVector(orbit->rotateToVsop87, Vec3d(Qx, Qy, Qz));
+	return add(orbit->q, orbit->e, 0.0, orbit->n, orbit->t0, P, Q, orbit);
+}
+
+int KeplerOrbitBatch::add(double pericenterDistance, double eccentricity, double meanAnomalyAtEpoch, double meanMotion,
+			  double epochJDE, const Vec3d& P, const Vec3d& Q, CometOrbit* comet)
+{
+	const double semimajorAxis = pericenterDistance/(1.0-eccentricity);
+	q.append(pericenterDistance);
+	e.append(eccentricity);
+	a.append(semimajorAxis);
+	b.append(semimajorAxis*std::sqrt(1.0-eccentricity*eccentricity));
+	M0.append(meanAnomalyAtEpoch);
+	n.append(meanMotion);
+	epoch.append(epochJDE);
+	// Comets use the gravitational constant of the Sun, other orbits mu = n^2 a^3 from their period, like
+	// EllipticalOrbit does. Then sqrt(mu/p) = n a^2/b.
+	sqrtMuP.append(comet ? std::sqrt(GAUSS_GRAV_CONST_SQ/(pericenterDistance*(1.0+eccentricity)))
+			     : meanMotion*semimajorAxis*semimajorAxis/b.last());
+	Px.append(P[0]); Py.append(P[1]); Pz.append(P[2]);
+	Qx.append(Q[0]); Qy.append(Q[1]); Qz.append(Q[2]);
+	comets.append(comet);
+	return q.size()-1;
+}
+
+void KeplerOrbitBatch::computePositions(const int* indices, const double* jde, int count, Vec3d* positions, Vec3d* velocities, bool updateComets) const
+{
+	double ecc[KEPLER_BATCH_BLOCK];
+	double M[KEPLER_BATCH_BLOCK];
+	double E[KEPLER_BATCH_BLOCK];
+	for (int start=0; start<count; start+=KEPLER_BATCH_BLOCK)
+	{
+		const int blockSize = qMin(KEPLER_BATCH_BLOCK, count-start);
+		const int* idx = indices+start;
+
+		// Gather the elements and reduce the mean anomaly to [0, 2pi[.
+		for (int k=0; k<blockSize; ++k)
+		{
+			const int j = idx[k];
+			const double m = M0[j] + n[j]*(jde[start+k]-epoch[j]);
+			ecc[k] = e[j];
+			M[k] = m - 2.0*M_PI*std::floor(m/(2.0*M_PI));
+			E[k] = M[k] + 0.85*ecc[k]*(M[k]<M_PI ? 1.0 : -1.0); // sign(sin(M))
+		}
+
+		// Laguerre-Conway, see InitEll. For e<1, f1>0, so the sign of the root is always positive.
+		// The loop count is fixed and the loop body free of branches, so that it can be vectorised.
+		for (int iter=0; iter<KEPLER_BATCH_ITERATIONS; ++iter)
+		{
+			for (int k=0; k<blockSize; ++k)
+			{
+				const double f2 = ecc[k]*std::sin(E[k]);
+				const double f = E[k]-f2-M[k];
+				const double f1 = 1.0-ecc[k]*std::cos(E[k]);
+				E[k] += (-5.0*f)/(f1+std::sqrt(std::fabs(16.0*f1*f1-20.0*f*f2)));
+			}
+		}
+
+		for (int k=0; k<blockSize; ++k)
+		{
+			const int j = idx[k];
+			const double rCosNu = a[j]*(std::cos(E[k])-ecc[k]);
+			const double rSinNu = b[j]*std::sin(E[k]);
+			positions[start+k].set(Px[j]*rCosNu+Qx[j]*rSinNu,
+					       Py[j]*rCosNu+Qy[j]*rSinNu,
+					       Pz[j]*rCosNu+Qz[j]*rSinNu);
+			// Heafner, 5.3.19
+			const double r = std::sqrt(rCosNu*rCosNu+rSinNu*rSinNu);
+			const double sinNu = rSinNu/r;
+			const double cosNu = rCosNu/r;
+			const double vP = -sqrtMuP[j]*sinNu;
+			const double vQ = sqrtMuP[j]*(ecc[k]+cosNu);
+			velocities[start+k].set(Px[j]*vP+Qx[j]*vQ,
+						Py[j]*vP+Qy[j]*vQ,
+						Pz[j]*vP+Qz[j]*vQ);
+		}
+
+		if (updateComets)
+			updateCometVelocities(idx, blockSize, velocities+start);
+	}
+}
+
+void KeplerOrbitBatch::updateCometVelocities(const int* indices, int count, const Vec3d* velocities) const
+{
+	for (int k=0; k<count; ++k)
+	{
+		CometOrbit* comet = comets.at(indices[k]);
+		if (comet)
+		{
+			comet->rdot = velocities[k];
+			comet->updateTails = true;
+		}
+	}
+}
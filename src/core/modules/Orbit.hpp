@@ -15,6 +15,8 @@
 
 #include "VecMath.hpp"
 
+#include <QVector>
+
 class OrbitSampleProc;
 
 //! @internal
@@ -52,6 +54,8 @@ public:
 	// In order to rotate to VSOP87
 	// parentRotObliquity and parentRotAscendingnode must be supplied.
 	void positionAtTimevInVSOP87Coordinates(const double JDE, double* v) const;
+	//! Same as above, also computing the velocity [AU/d] in VSOP87 coordinates.
+	void positionAtTimevInVSOP87Coordinates(const double JDE, double* v, double* vel) const;
 
 	// Original one
 	Vec3d positionAtTime(const double JDE) const;
@@ -73,6 +77,8 @@ private:
 	double period;
 	double epoch;
 	double rotateToVsop87[9];
+
+	friend class KeplerOrbitBatch;
 };
 
 
@@ -93,6 +99,9 @@ public:
 	// Compute the orbit for a specified Julian day and return a "stellarium compliant" function
 	// GZ: new optional variable: updateVelocityVector, true required for dust tail orientation!
 	void positionAtTimevInVSOP87Coordinates(double JDE, double* v, bool updateVelocityVector=true);
+	//! Compute the position and the speed (in the same convention as getVelocity()) for a specified JDE,
+	//! without changing the state of the orbit. This can be called from any thread.
+	void stateAtTimeInVSOP87Coordinates(double JDE, double* v, double* vel) const;
 	// updating the tails is a bit expensive. try not to overdo it.
 	bool getUpdateTails() const { return updateTails; }
 	void setUpdateTails(const bool update){ updateTails=update; }
@@ -114,6 +123,63 @@ private:
 	double rotateToVsop87[9]; //! Rotation matrix
 	bool updateTails; //! flag to signal that tails must be recomputed.
 	const double orbitGood; //! orb. elements are only valid for this time from perihel [days]. Don't draw the object outside.
+
+	friend class KeplerOrbitBatch;
+};
+
+//! @internal
+//! Propagator for many elliptical orbits around the Sun at once.
+//! The orbital elements of all orbits are stored in contiguous arrays (structure of arrays),
+//! so that Kepler's equation can be solved for all of them by a tight loop with a fixed number
+//! of Laguerre-Conway iterations, which the compiler can vectorise.
+//! Only elliptical orbits (e<1) are supported, hyperbolic and parabolic orbits must be computed
+//! one by one with their Orbit object.
+class KeplerOrbitBatch
+{
+public:
+	//! Remove all orbits.
+	void clear();
+	//! Add an orbit to the batch.
+	//! @return the index of the orbit in the batch, or -1 if the orbit is not elliptical.
+	int add(const EllipticalOrbit* orbit);
+	//! Add a comet orbit to the batch. Its velocity will be updated by computePositions().
+	//! @return the index of the orbit in the batch, or -1 if the orbit is not elliptical.
+	int add(CometOrbit* orbit);
+	//! Get the number of orbits in the batch.
+	int size() const { return q.size(); }
+
+	//! Compute the positions of some orbits of the batch, in VSOP87 coordinates.
+	//! This gives the same results as EllipticalOrbit::positionAtTimevInVSOP87Coordinates()
+	//! and CometOrbit::positionAtTimevInVSOP87Coordinates(), including the velocities.
+	//! Different orbits can be computed concurrently from several threads.
+	//! @param indices indices of the orbits in the batch
+	//! @param jde the JDE for which each orbit is computed
+	//! @param count number of orbits to compute
+	//! @param positions receives the position of each orbit [AU]
+	//! @param velocities receives the velocity of each orbit [AU/d]
+	//! @param updateComets whether to update the velocities of comet orbits, see updateCometVelocities().
+	//! Without it, nothing but positions and velocities is written.
+	void computePositions(const int* indices, const double* jde, int count, Vec3d* positions, Vec3d* velocities, bool updateComets=true) const;
+	//! Set the velocities computed by computePositions() to the comet orbits of the batch, which also updates their tails.
+	void updateCometVelocities(const int* indices, int count, const Vec3d* velocities) const;
+
+private:
+	//! Add the elements of an elliptical orbit, with P and Q the unit vectors towards the pericenter
+	//! and towards true anomaly 90 degrees, in VSOP87 coordinates.
+	int add(double pericenterDistance, double eccentricity, double meanAnomalyAtEpoch, double meanMotion,
+		double epoch, const Vec3d& P, const Vec3d& Q, CometOrbit* comet);
+
+	QVector<double> q;		// pericenter distance [AU]
+	QVector<double> e;		// eccentricity
+	QVector<double> a;		// semimajor axis [AU]
+	QVector<double> b;		// semiminor axis [AU]
+	QVector<double> M0;		// mean anomaly at epoch [rad]
+	QVector<double> n;		// mean motion [rad/d]
+	QVector<double> epoch;		// epoch of M0, JDE
+	QVector<double> sqrtMuP;	// velocity scale sqrt(mu/p) [AU/d]
+	QVector<double> Px, Py, Pz;	// direction of the pericenter (the orientation elements i, Omega, omega)
+	QVector<double> Qx, Qy, Qz;	// direction of true anomaly 90 degrees
+	QVector<CometOrbit*> comets;	// comet orbits whose velocity is updated, Q_NULLPTR for other orbits
 };
 
 
@@ -0,0 +1,103 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "OrbitPath.hpp"
+
+#include <cmath>
+
+OrbitPath::OrbitPath(int segments)
+	: sampleInterval(0.)
+	, gridOrigin(0.)
+	, centerIndex(0)
+	, osculating(false)
+	, valid(false)
+	, samples(segments)
+{
+}
+
+void OrbitPath::setSampleInterval(double interval)
+{
+	sampleInterval = interval;
+	clear();
+}
+
+bool OrbitPath::isOutdated(double dateJDE) const
+{
+	return sampleInterval>0. && (!valid || std::fabs(dateJDE-getSampleJDE(samples.size()/2))>sampleInterval);
+}
+
+void OrbitPath::update(double dateJDE, const SampleFunc& func)
+{
+	const int n = samples.size();
+	const double centerJDE = getSampleJDE(n/2);
+	const double shiftSamples = (dateJDE-centerJDE)/sampleInterval;
+	const int shift = (valid && !osculating && std::fabs(shiftSamples)<n) ? static_cast<int>(std::floor(shiftSamples+0.5)) : n;
+
+	if (shift>0 && shift<n)
+	{
+		for (int i=0; i<n-shift; ++i)
+			samples[i] = samples.at(i+shift);
+		centerIndex += shift;
+		for (int i=n-shift; i<n; ++i)
+			samples[i] = func(dateJDE, getSampleJDE(i));
+	}
+	else if (shift<0)
+	{
+		for (int i=n-1; i>=-shift; --i)
+			samples[i] = samples.at(i+shift);
+		centerIndex += shift;
+		for (int i=0; i<-shift; ++i)
+			samples[i] = func(dateJDE, getSampleJDE(i));
+	}
+	else if (shift!=0)
+	{
+		// Update all points, the new grid has no sample in common with the old one.
+		gridOrigin = dateJDE;
+		centerIndex = 0;
+		refined.clear();
+		for (int i=0; i<n; ++i)
+			samples[i] = func(dateJDE, getSampleJDE(i));
+	}
+	valid = true;
+
+	// Forget the intermediate points which are out of the grid.
+	if (refined.size()>4*n)
+	{
+		const qint64 first = (centerIndex-n/2)*SUBDIVISIONS;
+		const qint64 last = (centerIndex-n/2+n)*SUBDIVISIONS;
+		for (auto it=refined.begin(); it!=refined.end();)
+		{
+			if (it.key()<first || it.key()>=last)
+				it = refined.erase(it);
+			else
+				++it;
+		}
+	}
+}
+
+Vec3d OrbitPath::getIntermediateSample(int i, int k, const SampleFunc& func)
+{
+	const qint64 key = (centerIndex+i-samples.size()/2)*SUBDIVISIONS+k;
+	auto it = refined.constFind(key);
+	if (it!=refined.constEnd())
+		return it.value();
+	const Vec3d pos = func(getSampleJDE(samples.size()/2), getSampleJDE(i)+k*sampleInterval/SUBDIVISIONS);
+	refined.insert(key, pos);
+	return pos;
+}
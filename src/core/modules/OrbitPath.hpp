@@ -0,0 +1,87 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef ORBITPATH_HPP
+#define ORBITPATH_HPP
+
+#include "VecMath.hpp"
+
+#include <functional>
+#include <QHash>
+#include <QVector>
+
+//! @class OrbitPath
+//! Cache of the points of the orbit line of a Planet, in the coordinate system of its parent.
+//! The orbit is sampled on a regular grid of dates centred on the date of the last update.
+//! When the date moves, the grid is shifted and only the samples entering the grid are computed.
+//! Points between two samples can be requested to refine the line where it is strongly curved
+//! on screen, they are computed on first use and kept until the grid moves past them.
+//! Planet only updates the cache when its orbit is drawn.
+class OrbitPath
+{
+public:
+	//! Computes the position of the body at jde in the coordinate system of its parent.
+	//! jde0 is the date of the osculating elements, for bodies with osculating orbits.
+	typedef std::function<Vec3d(double jde0, double jde)> SampleFunc;
+
+	//! Number of points which can be inserted between two samples, including the first sample.
+	static const int SUBDIVISIONS = 8;
+
+	//! @param segments number of samples of the grid
+	explicit OrbitPath(int segments);
+
+	//! Set the time between two samples [days], e.g. the sidereal period divided by the number of segments.
+	//! A value of 0 disables the orbit line.
+	void setSampleInterval(double interval);
+	double getSampleInterval() const {return sampleInterval;}
+
+	//! Set whether the positions depend on the date of the update, i.e. the orbit uses osculating elements.
+	//! Such orbits are resampled entirely instead of being shifted.
+	void setOsculating(bool b) {osculating=b; valid=false;}
+
+	//! Get whether update(dateJDE) would compute new samples.
+	bool isOutdated(double dateJDE) const;
+
+	//! Centre the grid on dateJDE, computing the samples which are not known yet.
+	void update(double dateJDE, const SampleFunc& func);
+
+	//! Forget all samples.
+	void clear() {valid=false; refined.clear();}
+
+	//! Get the samples of the grid. The middle one is the closest one to the date of the last update.
+	const QVector<Vec3d>& getSamples() const {return samples;}
+
+	//! Get the JDE of a sample of the grid.
+	double getSampleJDE(int i) const {return gridOrigin+(centerIndex+i-samples.size()/2)*sampleInterval;}
+
+	//! Get a point between sample i and sample i+1.
+	//! @param k position of the point, in SUBDIVISIONS-th of the sample interval, in 1..SUBDIVISIONS-1
+	Vec3d getIntermediateSample(int i, int k, const SampleFunc& func);
+
+private:
+	double sampleInterval;
+	double gridOrigin;	// JDE of the sample of absolute index 0
+	qint64 centerIndex;	// absolute index of the middle sample
+	bool osculating;
+	bool valid;
+	QVector<Vec3d> samples;
+	QHash<qint64, Vec3d> refined;	// intermediate points, by absolute index*SUBDIVISIONS+k
+};
+
+#endif // ORBITPATH_HPP
@@ -0,0 +1,435 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "PhenomenaFinder.hpp"
+#include "SolarSystem.hpp"
+#include "Planet.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelObjectMgr.hpp"
+
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	// Limits of the sampling step [days]
+	const double MIN_STEP = 1./1440.;
+	const double MAX_STEP = 10.;
+	// Tolerance on the date of a minimum [days]
+	const double TOLERANCE = 1e-5;
+	// Angle travelled between the samples of the track shared by fixed objects [rad]
+	const double TRACK_ANGLE = 0.02;
+	// Number of fixed objects processed in one job
+	const int FIXED_CHUNK_SIZE = 64;
+
+	bool earlier(const PhenomenaFinder::Phenomenon& a, const PhenomenaFinder::Phenomenon& b)
+	{
+		return a.JD < b.JD;
+	}
+}
+
+PhenomenaFinder::PhenomenaFinder(StelCore* core, double startJD, double stopJD)
+	: startJD(qMin(startJD, stopJD))
+	, stopJD(qMax(startJD, stopJD))
+	, ephemeris(core, startJD, stopJD)
+{
+	const SolarSystem* ssystem = GETSTELMODULE(SolarSystem);
+	sun = ssystem->getSun();
+	moon = ssystem->getMoon();
+}
+
+Vec3d PhenomenaFinder::computeDirection(const PlanetP& planet, const ObserverEphemeris::Frame& frame) const
+{
+	Vec3d pos = ephemeris.computeJ2000Pos(planet, frame);
+	pos.normalize();
+	return pos;
+}
+
+void PhenomenaFinder::findPair(const PlanetP& object1, const PlanetP& object2, int index2, double maxSeparation, bool opposition,
+			       QVector<Phenomenon>& result) const
+{
+	// For an opposition, the separation from the antipode of object2 is minimized.
+	const double sign = opposition ? -1. : 1.;
+	auto separation = [&](double JD, Vec3d* delta) -> double
+	{
+		const ObserverEphemeris::Frame frame = ephemeris.computeFrame(JD);
+		const Vec3d u1 = computeDirection(object1, frame);
+		const Vec3d u2 = computeDirection(object2, frame)*sign;
+		if (delta)
+			*delta = u1 - u2;
+		return u1.angleNormalized(u2);
+	};
+	const std::function<double(double)> f = [&](double JD) { return separation(JD, Q_NULLPTR); };
+
+	Vec3d d0, d1;
+	double t0 = startJD;
+	double f0 = separation(t0, &d0);
+	separation(t0+MIN_STEP, &d1);
+	double rate = (d1-d0).length()/MIN_STEP;
+
+	bool hasPrevious = false;
+	double tm = t0, fm = f0, rateM = rate;
+	while (t0 < stopJD)
+	{
+		// The separation changes at most by rate*step: far from object2 the step can be large, while
+		// below maxSeparation it is small enough to sample the minimum.
+		const double reach = 0.5*qMax(f0-maxSeparation, 0.25*f0);
+		const double t1 = qMin(t0 + qBound(MIN_STEP, reach/qMax(rate, 1e-9), MAX_STEP), stopJD);
+		const double f1 = separation(t1, &d1);
+		const double rate1 = (d1-d0).length()/(t1-t0);
+
+		if (hasPrevious && fm > f0 && f0 <= f1 && f0 - qMax(rateM, rate1)*(t1-tm) <= maxSeparation)
+		{
+			double fmin;
+			const double JD = minimize(f, tm, t1, t0, f0, TOLERANCE, &fmin);
+			if (fmin <= maxSeparation)
+				result.append({JD, fmin, index2, opposition});
+		}
+
+		hasPrevious = true;
+		tm = t0; fm = f0; rateM = rate1;
+		t0 = t1; f0 = f1; d0 = d1; rate = rate1;
+	}
+}
+
+QVector<PhenomenaFinder::Phenomenon> PhenomenaFinder::find(const PlanetP& object1, const QList<PlanetP>& objects2,
+							  double maxSeparation, bool opposition) const
+{
+	struct Task
+	{
+		int index2;
+		bool opposition;
+		QVector<Phenomenon> result;
+	};
+	QVector<Task> tasks;
+	for (int i=0; i<objects2.size(); ++i)
+	{
+		if (objects2.at(i)==object1)
+			continue;
+		tasks.append({i, false, QVector<Phenomenon>()});
+		if (opposition)
+			tasks.append({i, true, QVector<Phenomenon>()});
+	}
+
+	QtConcurrent::blockingMap(tasks, [&](Task& task)
+	{
+		findPair(object1, objects2.at(task.index2), task.index2, maxSeparation, task.opposition, task.result);
+	});
+
+	QVector<Phenomenon> result;
+	for (const auto& task : tasks)
+		result += task.result;
+	std::sort(result.begin(), result.end(), earlier);
+	return result;
+}
+
+QVector<PhenomenaFinder::Phenomenon> PhenomenaFinder::find(const PlanetP& object1, const QVector<Vec3d>& positions2,
+							  double maxSeparation) const
+{
+	// Track of object1, sampled so that it moves by about TRACK_ANGLE between samples.
+	// It is computed in parallel in segments of the range of dates.
+	struct Segment
+	{
+		double start, stop;
+		QVector<double> dates;
+		QVector<Vec3d> directions;
+		QVector<double> rates;		// angular velocity from each sample to the next [rad/day]
+	};
+	const int segmentCount = qMax(1, qMin(QThreadPool::globalInstance()->maxThreadCount()*4, static_cast<int>((stopJD-startJD)/MAX_STEP)));
+	QVector<Segment> segments(segmentCount);
+	for (int i=0; i<segmentCount; ++i)
+	{
+		segments[i].start = startJD + (stopJD-startJD)*i/segmentCount;
+		segments[i].stop = startJD + (stopJD-startJD)*(i+1)/segmentCount;
+	}
+	QtConcurrent::blockingMap(segments, [&](Segment& segment)
+	{
+		double t = segment.start;
+		Vec3d u = computeDirection(object1, ephemeris.computeFrame(t));
+		double rate = (computeDirection(object1, ephemeris.computeFrame(t+MIN_STEP))-u).length()/MIN_STEP;
+		segment.dates.append(t);
+		segment.directions.append(u);
+		while (t < segment.stop)
+		{
+			const double t1 = qMin(t + qBound(MIN_STEP, TRACK_ANGLE/qMax(rate, 1e-9), MAX_STEP), segment.stop);
+			const Vec3d u1 = computeDirection(object1, ephemeris.computeFrame(t1));
+			rate = (u1-u).length()/(t1-t);
+			segment.rates.append(rate);
+			segment.dates.append(t1);
+			segment.directions.append(u1);
+			t = t1;
+			u = u1;
+		}
+	});
+	QVector<double> dates;
+	QVector<Vec3d> directions;
+	QVector<double> rates;
+	for (const auto& segment : segments)
+	{
+		// The first sample of a segment is the last one of the previous segment.
+		const int first = dates.isEmpty() ? 0 : 1;
+		dates += segment.dates.mid(first);
+		directions += segment.directions.mid(first);
+		rates += segment.rates;
+	}
+	if (dates.size() < 3)
+		return QVector<Phenomenon>();
+
+	struct Task
+	{
+		int begin, end;
+		QVector<Phenomenon> result;
+	};
+	QVector<Task> tasks;
+	for (int i=0; i<positions2.size(); i+=FIXED_CHUNK_SIZE)
+		tasks.append({i, qMin(i+FIXED_CHUNK_SIZE, positions2.size()), QVector<Phenomenon>()});
+
+	QtConcurrent::blockingMap(tasks, [&](Task& task)
+	{
+		for (int k=task.begin; k<task.end; ++k)
+		{
+			const Vec3d& pos2 = positions2.at(k);
+			const std::function<double(double)> f = [&](double JD)
+			{
+				return computeDirection(object1, ephemeris.computeFrame(JD)).angleNormalized(pos2);
+			};
+			// Local maxima of the cosine of the separation along the track
+			double cm = directions.at(0).dot(pos2);
+			double c0 = directions.at(1).dot(pos2);
+			for (int i=1; i+1<dates.size(); ++i)
+			{
+				const double c1 = directions.at(i+1).dot(pos2);
+				if (cm < c0 && c0 >= c1)
+				{
+					const double f0 = std::acos(qBound(-1., c0, 1.));
+					if (f0 - qMax(rates.at(i-1), rates.at(i))*(dates.at(i+1)-dates.at(i-1)) <= maxSeparation)
+					{
+						double fmin;
+						const double JD = minimize(f, dates.at(i-1), dates.at(i+1), dates.at(i), f0, TOLERANCE, &fmin);
+						if (fmin <= maxSeparation)
+							task.result.append({JD, fmin, k, false});
+					}
+				}
+				cm = c0;
+				c0 = c1;
+			}
+		}
+	});
+
+	QVector<Phenomenon> result;
+	for (const auto& task : tasks)
+		result += task.result;
+	std::sort(result.begin(), result.end(), earlier);
+	return result;
+}
+
+PhenomenaFinder::PhenomenonType PhenomenaFinder::classify(const PlanetP& object1, const PlanetP& object2, double radius2,
+							  const Phenomenon& phenomenon) const
+{
+	const bool lunarOrSolar = (object1==moon && object2==sun) || (object1==sun && object2==moon);
+	if (phenomenon.opposition)
+		return (lunarOrSolar && phenomenon.separation <= 0.02) ? Eclipse : Opposition;
+
+	const ObserverEphemeris::Frame frame = ephemeris.computeFrame(phenomenon.JD);
+	const double d1 = ephemeris.computeJ2000Pos(object1, frame).length();
+	const double s1 = std::atan2(object1->getRadius()*object1->getSphereScale(), d1);
+	if (!object2)
+		return (phenomenon.separation < radius2 || phenomenon.separation < s1) ? Occultation : Conjunction;
+
+	const double d2 = ephemeris.computeJ2000Pos(object2, frame).length();
+	const double s2 = std::atan2(object2->getRadius()*object2->getSphereScale(), d2);
+	if (phenomenon.separation < s1 || phenomenon.separation < s2)
+	{
+		// Sizes equal within 0.05 degrees: the Moon covers the Sun.
+		if (qAbs(s1 - s2) <= 0.05*M_PI/180. && (object1==sun || object2==sun))
+			return Eclipse;
+		// The passage of the celestial body in front of another of greater apparent diameter
+		if ((d1 < d2 && s1 <= s2) || (d1 > d2 && s1 > s2))
+			return Transit;
+		return Occultation;
+	}
+	// Partial solar eclipse
+	if (lunarOrSolar && phenomenon.separation <= 0.0087)
+		return Eclipse;
+	return Conjunction;
+}
+
+QString PhenomenaFinder::typeToString(PhenomenonType type)
+{
+	switch (type)
+	{
+		case Opposition:
+			return "opposition";
+		case Occultation:
+			return "occultation";
+		case Transit:
+			return "transit";
+		case Eclipse:
+			return "eclipse";
+		default:
+			return "conjunction";
+	}
+}
+
+QVariantList PhenomenaFinder::findPhenomena(const QString& object1, const QStringList& objects2, double startJD, double stopJD,
+					    double maxSeparation, bool opposition)
+{
+	StelCore* core = StelApp::getInstance().getCore();
+	const SolarSystem* ssystem = GETSTELMODULE(SolarSystem);
+	const PlanetP planet = ssystem->searchByEnglishName(object1);
+	if (!planet)
+	{
+		qWarning() << "PhenomenaFinder: unknown solar system body" << object1;
+		return QVariantList();
+	}
+
+	QList<PlanetP> bodies;
+	QVector<Vec3d> fixedPositions;
+	QVector<double> fixedRadii;
+	QStringList fixedNames;
+	for (const auto& name : objects2)
+	{
+		const PlanetP body = ssystem->searchByEnglishName(name);
+		if (body)
+		{
+			bodies.append(body);
+			continue;
+		}
+		const StelObjectP obj = GETSTELMODULE(StelObjectMgr)->searchByName(name);
+		if (!obj)
+		{
+			qWarning() << "PhenomenaFinder: unknown object" << name;
+			continue;
+		}
+		Vec3d pos = obj->getJ2000EquatorialPos(core);
+		pos.normalize();
+		fixedPositions.append(pos);
+		fixedRadii.append(obj->getAngularSize(core)*M_PI/180.);
+		fixedNames.append(obj->getEnglishName().isEmpty() ? name : obj->getEnglishName());
+	}
+
+	const PhenomenaFinder finder(core, startJD, stopJD);
+	const double maxSeparationRad = maxSeparation*M_PI/180.;
+	QVariantList result;
+	auto append = [&](const Phenomenon& phenomenon, const QString& name2, PhenomenonType type)
+	{
+		QVariantMap map;
+		map.insert("object1", planet->getEnglishName());
+		map.insert("object2", name2);
+		map.insert("jd", phenomenon.JD);
+		map.insert("separation", (phenomenon.opposition ? M_PI - phenomenon.separation : phenomenon.separation)*180./M_PI);
+		map.insert("type", typeToString(type));
+		result.append(map);
+	};
+	for (const auto& phenomenon : finder.find(planet, bodies, maxSeparationRad, opposition))
+	{
+		const PlanetP& body = bodies.at(phenomenon.object2);
+		append(phenomenon, body->getEnglishName(), finder.classify(planet, body, 0., phenomenon));
+	}
+	for (const auto& phenomenon : finder.find(planet, fixedPositions, maxSeparationRad))
+		append(phenomenon, fixedNames.at(phenomenon.object2),
+		       finder.classify(planet, PlanetP(), fixedRadii.at(phenomenon.object2), phenomenon));
+
+	std::sort(result.begin(), result.end(), [](const QVariant& a, const QVariant& b)
+	{
+		return a.toMap().value("jd").toDouble() < b.toMap().value("jd").toDouble();
+	});
+	return result;
+}
+
+double PhenomenaFinder::minimize(const std::function<double(double)>& f, double a, double b, double x, double fx, double tol, double* fmin)
+{
+	// Brent's method: parabolic interpolation through the three best points, with a fallback to golden sections.
+	static const double CGOLD = 0.3819660;
+	if (a > b)
+		std::swap(a, b);
+	double w = x, v = x;
+	double fw = fx, fv = fx;
+	double d = 0., e = 0.;
+	for (int iter=0; iter<100; ++iter)
+	{
+		const double xm = 0.5*(a+b);
+		const double tol2 = 2.*tol;
+		if (std::fabs(x-xm) <= tol2-0.5*(b-a))
+			break;
+		bool golden = true;
+		if (std::fabs(e) > tol)
+		{
+			const double r = (x-w)*(fx-fv);
+			double q = (x-v)*(fx-fw);
+			double p = (x-v)*q - (x-w)*r;
+			q = 2.*(q-r);
+			if (q > 0.)
+				p = -p;
+			q = std::fabs(q);
+			const double etemp = e;
+			e = d;
+			if (std::fabs(p) < std::fabs(0.5*q*etemp) && p > q*(a-x) && p < q*(b-x))
+			{
+				d = p/q;
+				const double u = x+d;
+				if (u-a < tol2 || b-u < tol2)
+					d = xm >= x ? tol : -tol;
+				golden = false;
+			}
+		}
+		if (golden)
+		{
+			e = x >= xm ? a-x : b-x;
+			d = CGOLD*e;
+		}
+		const double u = std::fabs(d) >= tol ? x+d : x+(d >= 0. ? tol : -tol);
+		const double fu = f(u);
+		if (fu <= fx)
+		{
+			if (u >= x)
+				a = x;
+			else
+				b = x;
+			v = w; fv = fw;
+			w = x; fw = fx;
+			x = u; fx = fu;
+		}
+		else
+		{
+			if (u < x)
+				a = u;
+			else
+				b = u;
+			if (fu <= fw || w == x)
+			{
+				v = w; fv = fw;
+				w = u; fw = fu;
+			}
+			else if (fu <= fv || v == x || v == w)
+			{
+				v = u; fv = fu;
+			}
+		}
+	}
+	*fmin = fx;
+	return x;
+}
@@ -0,0 +1,132 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef PHENOMENAFINDER_HPP
+#define PHENOMENAFINDER_HPP
+
+#include "VecMath.hpp"
+#include "ObserverEphemeris.hpp"
+
+#include <QList>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVariantList>
+#include <QVector>
+
+#include <functional>
+
+class StelCore;
+class Planet;
+typedef QSharedPointer<Planet> PlanetP;
+
+//! @class PhenomenaFinder
+//! Finds the conjunctions and oppositions of a solar system body with other bodies or with fixed objects.
+//! The angular separation is sampled with a step derived from the relative angular velocity of the
+//! objects, so that no minimum below the maximum separation can be stepped over, and each minimum
+//! is refined with Brent's method. The time of StelCore is never changed: positions come from
+//! ObserverEphemeris. Independent pairs of objects are processed in parallel on the global thread pool.
+class PhenomenaFinder
+{
+public:
+	//! A closest approach of two objects
+	struct Phenomenon
+	{
+		double JD;		//!< date of the closest approach (UT)
+		double separation;	//!< angular separation [rad], for an opposition the deviation from 180 degrees
+		int object2;		//!< index of the second object in the list given to find()
+		bool opposition;	//!< true for an opposition
+	};
+
+	//! Classification of a phenomenon
+	enum PhenomenonType
+	{
+		Conjunction,
+		Opposition,
+		Occultation,		//!< the nearer object covers the farther
+		Transit,		//!< the nearer object passes in front of a larger farther object
+		Eclipse			//!< solar or lunar eclipse
+	};
+
+	//! Prepare the search. Must be called from the main thread.
+	//! @param core the core providing the current observer and settings
+	//! @param startJD, stopJD range of dates to search (UT)
+	PhenomenaFinder(StelCore* core, double startJD, double stopJD);
+
+	//! Find the closest approaches of a body to other bodies.
+	//! @param object1 the first body
+	//! @param objects2 the other bodies
+	//! @param maxSeparation the maximum separation of the reported phenomena [rad]
+	//! @param opposition true to also find oppositions
+	//! @return the phenomena, sorted by date
+	QVector<Phenomenon> find(const PlanetP& object1, const QList<PlanetP>& objects2, double maxSeparation, bool opposition) const;
+	//! Find the closest approaches of a body to fixed objects like stars and deep-sky objects.
+	//! The track of object1 is computed once and shared by all the objects.
+	//! @param object1 the body
+	//! @param positions2 the J2000 equatorial directions of the fixed objects
+	//! @param maxSeparation the maximum separation of the reported phenomena [rad]
+	//! @return the phenomena, sorted by date
+	QVector<Phenomenon> find(const PlanetP& object1, const QVector<Vec3d>& positions2, double maxSeparation) const;
+
+	//! Classify a phenomenon found by find().
+	//! @param object2 the second body, or Q_NULLPTR for a fixed object
+	//! @param radius2 the angular radius of the fixed object [rad], ignored for a body
+	PhenomenonType classify(const PlanetP& object1, const PlanetP& object2, double radius2, const Phenomenon& phenomenon) const;
+
+	//! Get the ephemeris used for the search, e.g. to compute details of the phenomena.
+	const ObserverEphemeris& getEphemeris() const {return ephemeris;}
+
+	//! Find the phenomena of a solar system body with other objects, at the current location.
+	//! Must be called from the main thread.
+	//! @param object1 the English name of the solar system body
+	//! @param objects2 the names of the other objects. Objects which are not solar system bodies are considered fixed.
+	//! @param startJD, stopJD range of dates to search (UT)
+	//! @param maxSeparation the maximum separation [degrees]
+	//! @param opposition true to also find oppositions with solar system bodies
+	//! @return a list of maps sorted by date, with keys object1, object2, jd, separation [degrees] and
+	//! type (one of conjunction, opposition, occultation, transit, eclipse)
+	static QVariantList findPhenomena(const QString& object1, const QStringList& objects2, double startJD, double stopJD,
+					  double maxSeparation, bool opposition);
+
+	//! Get the English name of a type of phenomenon, as used by findPhenomena().
+	static QString typeToString(PhenomenonType type);
+
+	//! Find a minimum of a function with Brent's method.
+	//! @param f the function
+	//! @param a, b the bracketing interval
+	//! @param x a point of the interval with f(x) less than f(a) and f(b)
+	//! @param fx the value of f(x)
+	//! @param tol the absolute tolerance on the abscissa of the minimum
+	//! @param fmin receives the value of the minimum
+	//! @return the abscissa of the minimum
+	static double minimize(const std::function<double(double)>& f, double a, double b, double x, double fx, double tol, double* fmin);
+
+private:
+	void findPair(const PlanetP& object1, const PlanetP& object2, int index2, double maxSeparation, bool opposition,
+		      QVector<Phenomenon>& result) const;
+	//! Get the J2000 unit vector from the observer to a body
+	Vec3d computeDirection(const PlanetP& planet, const ObserverEphemeris::Frame& frame) const;
+
+	const double startJD;
+	const double stopJD;
+	ObserverEphemeris ephemeris;
+	PlanetP sun;
+	PlanetP moon;
+};
+
+#endif // PHENOMENAFINDER_HPP
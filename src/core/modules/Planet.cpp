@@ -43,6 +43,7 @@
 #include "StelOBJ.hpp"
 #include "StelOpenGLArray.hpp"
 #include "StelHips.hpp"
+#include "PlanetMeshCache.hpp"
 #include "RefractionExtinction.hpp"
 
 #include <limits>
@@ -57,7 +58,6 @@
 #include <QOpenGLFramebufferObject>
 #endif
 #include <QOpenGLShader>
-#include <QtConcurrent>
 
 const QString Planet::PLANET_TYPE = QStringLiteral("Planet");
 
@@ -127,37 +127,25 @@ Planet::ApparentMagnitudeAlgorithm Planet::vMagAlgorithm;
 #define STRINGIFY(a) STRINGIFY2(a)
 #define SM_SIZE 1024
 
-Planet::PlanetOBJModel::PlanetOBJModel()
-	: needsRescale(true), projPosBuffer(new QOpenGLBuffer(QOpenGLBuffer::VertexBuffer)), obj(new StelOBJ()), arr(new StelOpenGLArray())
+Planet::PlanetOBJModel::PlanetOBJModel(const PlanetModelP &model)
+	: model(model), needsRescale(true), projPosBuffer(new QOpenGLBuffer(QOpenGLBuffer::VertexBuffer)), texture(model->texture)
 {
 	//The buffer is refreshed completely before each draw, so StreamDraw should be ok
 	projPosBuffer->setUsagePattern(QOpenGLBuffer::StreamDraw);
+	//create the GL buffer for the projection
+	projPosBuffer->create();
+	//make sure the vector has enough space to hold the projected data
+	projectedPosArray.resize(model->posArray.size());
 }
 
 Planet::PlanetOBJModel::~PlanetOBJModel()
 {
 	delete projPosBuffer;
-	delete obj;
-	delete arr;
-}
-
-bool Planet::PlanetOBJModel::loadGL()
-{
-	if(arr->load(obj,false))
-	{
-		//delete StelOBJ because the data is no longer needed
-		delete obj;
-		obj = Q_NULLPTR;
-		//make sure the vector has enough space to hold the projected data
-		projectedPosArray.resize(posArray.size());
-		//create the GL buffer for the projection
-		return projPosBuffer->create();
-	}
-	return false;
 }
 
 void Planet::PlanetOBJModel::performScaling(double scale)
 {
+	const QVector<Vec3f>& posArray = model->posArray;
 	scaledArray = posArray;
 
 	//pre-scale the cpu-side array
@@ -188,10 +176,9 @@ Planet::Planet(const QString& englishName,
 	       const QString& pTypeStr)
 	: flagNativeName(true),
 	  flagTranslatedName(true),
-	  lastOrbitJDE(0.0),
+	  orbitPath(ORBIT_SEGMENTS),
 	  deltaJDE(StelCore::JD_SECOND),
-	  deltaOrbitJDE(0.0),
-	  orbitCached(false),
+	  positionThrottleJDE(0.),
 	  closeOrbit(acloseOrbit),
 	  englishName(englishName),
 	  nameI18(englishName),
@@ -211,7 +198,7 @@ Planet::Planet(const QString& englishName,
 	  rotLocalToParent(Mat4d::identity()),
 	  axisRotation(0.),
 	  objModel(Q_NULLPTR),
-	  objModelLoader(Q_NULLPTR),
+	  objModelLastDraw(0.),
 	  survey(Q_NULLPTR),
 	  rings(Q_NULLPTR),
 	  distance(0.0),
@@ -228,6 +215,12 @@ Planet::Planet(const QString& englishName,
 	  gl(Q_NULLPTR),
 	  iauMoonNumber("")
 {
+	// Orbits from osculating elements change with the date and are resampled entirely.
+	orbitPath.setOsculating(osculatingFunc!=Q_NULLPTR);
+	// No valid angles yet: the first computeTransMatrix() has to compute the matrix.
+	rotLocalToParentOrientation.eps_A = rotLocalToParentOrientation.chi_A = rotLocalToParentOrientation.omega_A
+		= rotLocalToParentOrientation.psi_A = rotLocalToParentOrientation.deltaPsi = rotLocalToParentOrientation.deltaEps = std::numeric_limits<double>::quiet_NaN();
+
 	// Initialize pType with the key found in pTypeMap, or mark planet type as undefined.
 	// The latter condition should obviously never happen.
 	pType = pTypeMap.key(pTypeStr, Planet::isUNDEFINED);
@@ -411,20 +404,27 @@ QString Planet::getInfoString(const StelCore* core, const InfoStringGroup& flags
 	double distanceAu = getJ2000EquatorialPos(core).length();
 	Q_UNUSED(az_app);
 
-	if (flags&Name)
+	// Name and type do not change with time
+	oss << getStaticInfoString(0, flags, static_cast<quint64>(qRound(sphereScale*10.f)), [&]()
 	{
-		oss << "<h2>" << getNameI18n();  // UI translation can differ from sky translation		
-		oss.setRealNumberNotation(QTextStream::FixedNotation);
-		oss.setRealNumberPrecision(1);
-		if (sphereScale != 1.f)
-			oss << QString::fromUtf8(" (\xC3\x97") << sphereScale << ")";
-		oss << "</h2>";
-	}
+		QString text;
+		QTextStream oss(&text);
+		if (flags&Name)
+		{
+			oss << "<h2>" << getNameI18n();  // UI translation can differ from sky translation
+			oss.setRealNumberNotation(QTextStream::FixedNotation);
+			oss.setRealNumberPrecision(1);
+			if (sphereScale != 1.f)
+				oss << QString::fromUtf8(" (\xC3\x97") << sphereScale << ")";
+			oss << "</h2>";
+		}
 
-	if (flags&ObjectType && getPlanetType()!=isUNDEFINED)
-	{
-		oss << QString("%1: <b>%2</b>").arg(q_("Type"), q_(getPlanetTypeString())) << "<br />";
-	}
+		if (flags&ObjectType && getPlanetType()!=isUNDEFINED)
+		{
+			oss << QString("%1: <b>%2</b>").arg(q_("Type"), q_(getPlanetTypeString())) << "<br />";
+		}
+		return text;
+	});
 
 	if (flags&Magnitude && getVMagnitude(core)!=std::numeric_limits<float>::infinity())
 	{
@@ -808,7 +808,7 @@ void Planet::setRotationElements(float _period, float _offset, double _epoch, fl
 	re.precessionRate = _precessionRate;
 	re.siderealPeriod = _siderealPeriod;  // used for drawing orbit lines
 
-	deltaOrbitJDE = re.siderealPeriod/ORBIT_SEGMENTS;
+	orbitPath.setSampleInterval(re.siderealPeriod/ORBIT_SEGMENTS);
 }
 
 Vec3d Planet::getJ2000EquatorialPos(const StelCore *core) const
@@ -903,133 +903,20 @@ void Planet::computePosition(const double dateJDE)
 {
 	// Make sure the parent position is computed for the dateJDE, otherwise
 	// getHeliocentricPos() would return incorrect values.
-	if (parent)
+	// The Sun is the origin of heliocentric coordinates and never moves. Not updating it
+	// also allows SolarSystem to compute bodies orbiting the Sun in parallel.
+	if (parent && parent->parent)
 		parent->computePositionWithoutOrbits(dateJDE);
 
-	if (orbitFader.getInterstate()>0.000001 && deltaOrbitJDE > 0 && (fabs(lastOrbitJDE-dateJDE)>deltaOrbitJDE || !orbitCached))
-	{
-		StelCore *core=StelApp::getInstance().getCore();
-
-		double calc_date;
-		// int delta_points = (int)(0.5 + (date - lastOrbitJD)/date_increment);
-		int delta_points;
-
-		if( dateJDE > lastOrbitJDE )
-		{
-			delta_points = (int)(0.5 + (dateJDE - lastOrbitJDE)/deltaOrbitJDE);
-		}
-		else
-		{
-			delta_points = (int)(-0.5 + (dateJDE - lastOrbitJDE)/deltaOrbitJDE);
-		}
-		double new_date = lastOrbitJDE + delta_points*deltaOrbitJDE;
-
-		// qDebug( "Updating orbit coordinates for %s (delta %f) (%d points)\n", getEnglishName().toUtf8().data(), deltaOrbitJDE, delta_points);
-
-		if( delta_points > 0 && delta_points < ORBIT_SEGMENTS && orbitCached)
-		{
-
-			for( int d=0; d<ORBIT_SEGMENTS; d++ )
-			{
-				if(d + delta_points >= ORBIT_SEGMENTS-1 )
-				{
-					// calculate new points
-					calc_date = new_date + (d-ORBIT_SEGMENTS/2)*deltaOrbitJDE;
-
-					// date increments between points will not be completely constant though
-					computeTransMatrix(calc_date-core->computeDeltaT(calc_date)/86400.0, calc_date);
-					if (osculatingFunc)
-					{
-						(*osculatingFunc)(dateJDE,calc_date,eclipticPos, eclipticVelocity);
-					}
-					else
-					{
-						coordFunc(calc_date, eclipticPos, eclipticVelocity, orbitPtr);
-					}
-					orbitP[d] = eclipticPos;
-					orbit[d] = getHeliocentricEclipticPos();
-				}
-				else
-				{
-					orbitP[d] = orbitP[d+delta_points];
-					orbit[d] = getHeliocentricPos(orbitP[d]);
-				}
-			}
-
-			lastOrbitJDE = new_date;
-		}
-		else if( delta_points < 0 && abs(delta_points) < ORBIT_SEGMENTS  && orbitCached)
-		{
-
-			for( int d=ORBIT_SEGMENTS-1; d>=0; d-- )
-			{
-				if(d + delta_points < 0 )
-				{
-					// calculate new points
-					calc_date = new_date + (d-ORBIT_SEGMENTS/2)*deltaOrbitJDE;
-
-					computeTransMatrix(calc_date-core->computeDeltaT(calc_date)/86400.0, calc_date);
-					if (osculatingFunc) {
-						(*osculatingFunc)(dateJDE,calc_date,eclipticPos, eclipticVelocity);
-					}
-					else
-					{
-						coordFunc(calc_date, eclipticPos, eclipticVelocity, orbitPtr);
-					}
-					orbitP[d] = eclipticPos;
-					orbit[d] = getHeliocentricEclipticPos();
-				}
-				else
-				{
-					orbitP[d] = orbitP[d+delta_points];
-					orbit[d] = getHeliocentricPos(orbitP[d]);
-				}
-			}
-
-			lastOrbitJDE = new_date;
-
-		}
-		else if( delta_points || !orbitCached)
-		{
-
-			// update all points (less efficient)
-			for( int d=0; d<ORBIT_SEGMENTS; d++ )
-			{
-				calc_date = dateJDE + (d-ORBIT_SEGMENTS/2)*deltaOrbitJDE;
-				computeTransMatrix(calc_date-core->computeDeltaT(calc_date)/86400.0, calc_date);
-				if (osculatingFunc)
-				{
-					(*osculatingFunc)(dateJDE,calc_date,eclipticPos, eclipticVelocity);
-				}
-				else
-				{
-					coordFunc(calc_date, eclipticPos, eclipticVelocity, orbitPtr);
-				}
-				orbitP[d] = eclipticPos;
-				orbit[d] = getHeliocentricEclipticPos();
-			}
-
-			lastOrbitJDE = dateJDE;
-			if (!osculatingFunc) orbitCached = 1;
-		}
-
-
-		// calculate actual Planet position
-		coordFunc(dateJDE, eclipticPos, eclipticVelocity, orbitPtr);
-
-		lastJDE = dateJDE;
-
-	}
-	else if (fabs(lastJDE-dateJDE)>deltaJDE)
-	{
-		// calculate actual Planet position
-		coordFunc(dateJDE, eclipticPos, eclipticVelocity, orbitPtr);
-		if (orbitFader.getInterstate()>0.000001)
-			for( int d=0; d<ORBIT_SEGMENTS; d++ )
-				orbit[d]=getHeliocentricPos(orbitP[d]);
-		lastJDE = dateJDE;
-	}
+	// The orbit line is sampled by drawOrbit(), only when it is displayed.
+	computePositionWithoutOrbits(dateJDE);
+}
 
+void Planet::setComputedPosition(const double dateJDE, const Vec3d& pos, const Vec3d& vel)
+{
+	eclipticPos = pos;
+	eclipticVelocity = vel;
+	lastJDE = dateJDE;
 }
 
 // Compute the transformation matrix from the local Planet coordinate system to the parent Planet coordinate system.
@@ -1043,36 +930,71 @@ void Planet::computeTransMatrix(double JD, double JDE)
 	// Special case - heliocentric coordinates are relative to eclipticJ2000 (VSOP87A XY plane),
 	// not solar equator...
 
-	if (parent)
+	if (!parent)
+		return;
+	if (englishName=="Earth")
 	{
-		// We can inject a proper precession plus even nutation matrix in this stage, if available.
-		if (englishName=="Earth")
+		// The angles only change once per hour (nutation) or day (precession),
+		// so in small time steps the matrix is kept until they change.
+		const EarthOrientation orientation = getEarthOrientation(JDE);
+		if (!(orientation==rotLocalToParentOrientation))
 		{
-			// rotLocalToParent = Mat4d::zrotation(re.ascendingNode - re.precessionRate*(jd-re.epoch)) * Mat4d::xrotation(-getRotObliquity(jd));
-			// We follow Capitaine's (2003) formulation P=Rz(Chi_A)*Rx(-omega_A)*Rz(-psi_A)*Rx(eps_o).
-			// ADS: 2011A&A...534A..22V = A&A 534, A22 (2011): Vondrak, Capitane, Wallace: New Precession Expressions, valid for long time intervals:
-			// See also Hilton et al., Report on Precession and the Ecliptic. Cel.Mech.Dyn.Astr. 94:351-367 (2006), eqn (6) and (21).
-			double eps_A, chi_A, omega_A, psi_A;
-			getPrecessionAnglesVondrak(JDE, &eps_A, &chi_A, &omega_A, &psi_A);
-			// Canonical precession rotations: Nodal rotation psi_A,
-			// then rotation by omega_A, the angle between EclPoleJ2000 and EarthPoleOfDate.
-			// The final rotation by chi_A rotates the equinox (zero degree).
-			// To achieve ecliptical coords of date, you just have now to add a rotX by epsilon_A (obliquity of date).
-
-			rotLocalToParent= Mat4d::zrotation(-psi_A) * Mat4d::xrotation(-omega_A) * Mat4d::zrotation(chi_A);
-			// Plus nutation IAU-2000B:
-			if (StelApp::getInstance().getCore()->getUseNutation())
-			{
-				double deltaEps, deltaPsi;
-				getNutationAngles(JDE, &deltaPsi, &deltaEps);
-				//qDebug() << "deltaEps, arcsec" << deltaEps*180./M_PI*3600. << "deltaPsi" << deltaPsi*180./M_PI*3600.;
-				Mat4d nut2000B=Mat4d::xrotation(eps_A) * Mat4d::zrotation(deltaPsi)* Mat4d::xrotation(-eps_A-deltaEps);
-				rotLocalToParent=rotLocalToParent*nut2000B;
-			}
+			rotLocalToParentOrientation = orientation;
+			rotLocalToParent = computeEarthRotLocalToParent(orientation);
 		}
-		else
-			rotLocalToParent = Mat4d::zrotation(re.ascendingNode - re.precessionRate*(JDE-re.epoch)) * Mat4d::xrotation(re.obliquity);
 	}
+	else
+		rotLocalToParent = computeRotLocalToParent(JDE);
+}
+
+Mat4d Planet::computeRotLocalToParent(double JDE) const
+{
+	// We can inject a proper precession plus even nutation matrix in this stage, if available.
+	if (englishName=="Earth")
+		return computeEarthRotLocalToParent(getEarthOrientation(JDE));
+	return Mat4d::zrotation(re.ascendingNode - re.precessionRate*(JDE-re.epoch)) * Mat4d::xrotation(re.obliquity);
+}
+
+Planet::EarthOrientation Planet::getEarthOrientation(double JDE)
+{
+	EarthOrientation orientation;
+	getPrecessionAnglesVondrak(JDE, &orientation.eps_A, &orientation.chi_A, &orientation.omega_A, &orientation.psi_A);
+	orientation.deltaPsi = 0.;
+	orientation.deltaEps = 0.;
+	if (StelApp::getInstance().getCore()->getUseNutation())
+		getNutationAngles(JDE, &orientation.deltaPsi, &orientation.deltaEps);
+	return orientation;
+}
+
+Mat4d Planet::computeEarthRotLocalToParent(const EarthOrientation& orientation)
+{
+	// rotLocalToParent = Mat4d::zrotation(re.ascendingNode - re.precessionRate*(jd-re.epoch)) * Mat4d::xrotation(-getRotObliquity(jd));
+	// We follow Capitaine's (2003) formulation P=Rz(Chi_A)*Rx(-omega_A)*Rz(-psi_A)*Rx(eps_o).
+	// ADS: 2011A&A...534A..22V = A&A 534, A22 (2011): Vondrak, Capitane, Wallace: New Precession Expressions, valid for long time intervals:
+	// See also Hilton et al., Report on Precession and the Ecliptic. Cel.Mech.Dyn.Astr. 94:351-367 (2006), eqn (6) and (21).
+	// Canonical precession rotations: Nodal rotation psi_A,
+	// then rotation by omega_A, the angle between EclPoleJ2000 and EarthPoleOfDate.
+	// The final rotation by chi_A rotates the equinox (zero degree).
+	// To achieve ecliptical coords of date, you just have now to add a rotX by epsilon_A (obliquity of date).
+	Mat4d rot = Mat4d::zrotation(-orientation.psi_A) * Mat4d::xrotation(-orientation.omega_A) * Mat4d::zrotation(orientation.chi_A);
+	// Plus nutation IAU-2000B:
+	if (orientation.deltaPsi!=0. || orientation.deltaEps!=0.)
+	{
+		//qDebug() << "deltaEps, arcsec" << deltaEps*180./M_PI*3600. << "deltaPsi" << deltaPsi*180./M_PI*3600.;
+		Mat4d nut2000B=Mat4d::xrotation(orientation.eps_A) * Mat4d::zrotation(orientation.deltaPsi)* Mat4d::xrotation(-orientation.eps_A-orientation.deltaEps);
+		rot=rot*nut2000B;
+	}
+	return rot;
+}
+
+Mat4d Planet::computeRotEquatorialToVsop87(double JDE) const
+{
+	if (!parent)
+		return rotLocalToParent;
+	Mat4d rval = computeRotLocalToParent(JDE);
+	for (PlanetP p=parent;p->parent;p=p->parent)
+		rval = p->computeRotLocalToParent(JDE) * rval;
+	return rval;
 }
 
 Mat4d Planet::getRotEquatorialToVsop87(void) const
@@ -1349,16 +1271,29 @@ float Planet::getMeanOppositionMagnitude() const
 
 // Computation of the visual magnitude (V band) of the planet.
 float Planet::getVMagnitude(const StelCore* core) const
+{
+	const bool fromEarth = core->getCurrentLocation().planetName=="Earth";
+	if (parent == 0)
+	{
+		// check how much of it is visible
+		const SolarSystem* ssm = GETSTELMODULE(SolarSystem);
+		return computeVMagnitude(core->getObserverHeliocentricEclipticPos(), getHeliocentricEclipticPos(), Vec3d(0.),
+					 core->getJDE(), fromEarth, ssm->getEclipseFactor(core));
+	}
+	return computeVMagnitude(core->getObserverHeliocentricEclipticPos(), getHeliocentricEclipticPos(),
+				 parent->getHeliocentricEclipticPos(), core->getJDE(), fromEarth);
+}
+
+float Planet::computeVMagnitude(const Vec3d& observerHelioPos, const Vec3d& planetHelioPos, const Vec3d& parentHeliopos,
+				double JDE, bool fromEarth, double eclipseFactor) const
 {
 	if (parent == 0)
 	{
 		// Sun, compute the apparent magnitude for the absolute mag (V: 4.83) and observer's distance
 		// Hint: Absolute Magnitude of the Sun in Several Bands: http://mips.as.arizona.edu/~cnaw/sun.html
-		const double distParsec = std::sqrt(core->getObserverHeliocentricEclipticPos().lengthSquared())*AU/PARSEC;
+		const double distParsec = std::sqrt(observerHelioPos.lengthSquared())*AU/PARSEC;
 
-		// check how much of it is visible
-		const SolarSystem* ssm = GETSTELMODULE(SolarSystem);
-		double shadowFactor = ssm->getEclipseFactor(core);
+		double shadowFactor = eclipseFactor;
 		// See: Hughes, D. W., Brightness during a solar eclipse // Journal of the British Astronomical Association, vol.110, no.4, p.203-205
 		// URL: http://adsabs.harvard.edu/abs/2000JBAA..110..203H
 		if(shadowFactor < 0.000128)
@@ -1368,9 +1303,7 @@ float Planet::getVMagnitude(const StelCore* core) const
 	}
 
 	// Compute the phase angle i. We need the intermediate results also below, therefore we don't just call getPhaseAngle.
-	const Vec3d& observerHelioPos = core->getObserverHeliocentricEclipticPos();
 	const double observerRq = observerHelioPos.lengthSquared();
-	const Vec3d& planetHelioPos = getHeliocentricEclipticPos();
 	const double planetRq = planetHelioPos.lengthSquared();
 	const double observerPlanetRq = (observerHelioPos - planetHelioPos).lengthSquared();
 	const double cos_chi = (observerPlanetRq + planetRq - observerRq)/(2.0*std::sqrt(observerPlanetRq*planetRq));
@@ -1380,7 +1313,6 @@ float Planet::getVMagnitude(const StelCore* core) const
 	// Check if the satellite is inside the inner shadow of the parent planet:
 	if (parent->parent != 0)
 	{
-		const Vec3d& parentHeliopos = parent->getHeliocentricEclipticPos();
 		const double parent_Rq = parentHeliopos.lengthSquared();
 		const double pos_times_parent_pos = planetHelioPos * parentHeliopos;
 		if (pos_times_parent_pos > parent_Rq)
@@ -1417,7 +1349,7 @@ float Planet::getVMagnitude(const StelCore* core) const
 	}
 
 	// Use empirical formulae for main planets when seen from earth
-	if (core->getCurrentLocation().planetName=="Earth")
+	if (fromEarth)
 	{
 		const double phaseDeg=phaseAngle*180./M_PI;
 		const double d = 5. * log10(std::sqrt(observerPlanetRq*planetRq));
@@ -1463,12 +1395,10 @@ float Planet::getVMagnitude(const StelCore* core) const
 				{
 					// add rings computation
 					// implemented from Meeus, Astr.Alg.1992
-					const double jde=core->getJDE();
-					const double T=(jde-2451545.0)/36525.0;
+					const double T=(JDE-2451545.0)/36525.0;
 					const double i=((0.000004*T-0.012998)*T+28.075216)*M_PI/180.0;
 					const double Omega=((0.000412*T+1.394681)*T+169.508470)*M_PI/180.0;
-					static SolarSystem *ssystem=GETSTELMODULE(SolarSystem);
-					const Vec3d saturnEarth=getHeliocentricEclipticPos() - ssystem->getEarth()->getHeliocentricEclipticPos();
+					const Vec3d saturnEarth=planetHelioPos - observerHelioPos;
 					double lambda=atan2(saturnEarth[1], saturnEarth[0]);
 					double beta=atan2(saturnEarth[2], std::sqrt(saturnEarth[0]*saturnEarth[0]+saturnEarth[1]*saturnEarth[1]));
 					const double sinx=sin(i)*cos(beta)*sin(lambda-Omega)-cos(i)*sin(beta);
@@ -1522,12 +1452,10 @@ float Planet::getVMagnitude(const StelCore* core) const
 				{
 					// add rings computation
 					// implemented from Meeus, Astr.Alg.1992
-					const double jde=core->getJDE();
-					const double T=(jde-2451545.0)/36525.0;
+					const double T=(JDE-2451545.0)/36525.0;
 					const double i=((0.000004*T-0.012998)*T+28.075216)*M_PI/180.0;
 					const double Omega=((0.000412*T+1.394681)*T+169.508470)*M_PI/180.0;
-					static SolarSystem *ssystem=GETSTELMODULE(SolarSystem);
-					const Vec3d saturnEarth=getHeliocentricEclipticPos() - ssystem->getEarth()->getHeliocentricEclipticPos();
+					const Vec3d saturnEarth=planetHelioPos - observerHelioPos;
 					double lambda=atan2(saturnEarth[1], saturnEarth[0]);
 					double beta=atan2(saturnEarth[2], std::sqrt(saturnEarth[0]*saturnEarth[0]+saturnEarth[1]*saturnEarth[1]));
 					const double sinx=sin(i)*cos(beta)*sin(lambda-Omega)-cos(i)*sin(beta);
@@ -1563,12 +1491,10 @@ float Planet::getVMagnitude(const StelCore* core) const
 				{
 					// add rings computation
 					// implemented from Meeus, Astr.Alg.1992
-					const double jde=core->getJDE();
-					const double T=(jde-2451545.0)/36525.0;
+					const double T=(JDE-2451545.0)/36525.0;
 					const double i=((0.000004*T-0.012998)*T+28.075216)*M_PI/180.0;
 					const double Omega=((0.000412*T+1.394681)*T+169.508470)*M_PI/180.0;
-					SolarSystem *ssystem=GETSTELMODULE(SolarSystem);
-					const Vec3d saturnEarth=getHeliocentricEclipticPos() - ssystem->getEarth()->getHeliocentricEclipticPos();
+					const Vec3d saturnEarth=planetHelioPos - observerHelioPos;
 					double lambda=atan2(saturnEarth[1], saturnEarth[0]);
 					double beta=atan2(saturnEarth[2], std::sqrt(saturnEarth[0]*saturnEarth[0]+saturnEarth[1]*saturnEarth[1]));
 					const double sinB=sin(i)*cos(beta)*sin(lambda-Omega)-cos(i)*sin(beta);
@@ -1600,12 +1526,10 @@ float Planet::getVMagnitude(const StelCore* core) const
 				{
 					// add rings computation
 					// implemented from Meeus, Astr.Alg.1992
-					const double jde=core->getJDE();
-					const double T=(jde-2451545.0)/36525.0;
+					const double T=(JDE-2451545.0)/36525.0;
 					const double i=((0.000004*T-0.012998)*T+28.075216)*M_PI/180.0;
 					const double Omega=((0.000412*T+1.394681)*T+169.508470)*M_PI/180.0;
-					static SolarSystem *ssystem=GETSTELMODULE(SolarSystem);
-					const Vec3d saturnEarth=getHeliocentricEclipticPos() - ssystem->getEarth()->getHeliocentricEclipticPos();
+					const Vec3d saturnEarth=planetHelioPos - observerHelioPos;
 					double lambda=atan2(saturnEarth[1], saturnEarth[0]);
 					double beta=atan2(saturnEarth[2], std::sqrt(saturnEarth[0]*saturnEarth[0]+saturnEarth[1]*saturnEarth[1]));
 					const double sinB=sin(i)*cos(beta)*sin(lambda-Omega)-cos(i)*sin(beta);
@@ -1636,11 +1560,16 @@ float Planet::getVMagnitude(const StelCore* core) const
 }
 
 double Planet::getAngularSize(const StelCore* core) const
+{
+	return getAngularSizeAtDistance(getJ2000EquatorialPos(core).length());
+}
+
+double Planet::getAngularSizeAtDistance(double distance) const
 {
 	double rad = radius;
 	if (rings)
 		rad = rings->getSize();
-	return std::atan2(rad*sphereScale,getJ2000EquatorialPos(core).length()) * 180./M_PI;
+	return std::atan2(rad*sphereScale,distance) * 180./M_PI;
 }
 
 
@@ -1720,7 +1649,8 @@ void Planet::draw(StelCore* core, float maxMagLabels, const QFont& planetNameFon
 
 	if ((prj->project(Vec3d(0.), screenPos)
 	     && screenPos[1]>viewport_bottom - viewportBufferSz && screenPos[1] < viewport_bottom + prj->getViewportHeight()+viewportBufferSz
-	     && screenPos[0]>viewport_left - viewportBufferSz && screenPos[0] < viewport_left + prj->getViewportWidth() + viewportBufferSz))
+	     && screenPos[0]>viewport_left - viewportBufferSz && screenPos[0] < viewport_left + prj->getViewportWidth() + viewportBufferSz
+	     && prj->checkInVisibleDisk(screenPos, viewportBufferSz)))
 	{
 		// Draw the name, and the circle if it's not too close from the body it's turning around
 		// this prevents name overlapping (e.g. for Jupiter's satellites)
@@ -2359,109 +2289,6 @@ void Planet::draw3dModel(StelCore* core, StelProjector::ModelViewTranformP trans
 	}
 }
 
-struct Planet3DModel
-{
-	QVector<float> vertexArr;
-	QVector<float> texCoordArr;
-	QVector<unsigned short> indiceArr;
-};
-
-
-void sSphere(Planet3DModel* model, const float radius, const float oneMinusOblateness, const int slices, const int stacks)
-{
-	model->indiceArr.resize(0);
-	model->vertexArr.resize(0);
-	model->texCoordArr.resize(0);
-	
-	GLfloat x, y, z;
-	GLfloat s=0.f, t=1.f;
-	GLint i, j;
-
-	const float* cos_sin_rho = StelUtils::ComputeCosSinRho(stacks);
-	const float* cos_sin_theta =  StelUtils::ComputeCosSinTheta(slices);
-	
-	const float* cos_sin_rho_p;
-	const float *cos_sin_theta_p;
-
-	// texturing: s goes from 0.0/0.25/0.5/0.75/1.0 at +y/+x/-y/-x/+y axis
-	// t goes from -1.0/+1.0 at z = -radius/+radius (linear along longitudes)
-	// cannot use triangle fan on texturing (s coord. at top/bottom tip varies)
-	// If the texture is flipped, we iterate the coordinates backward.
-	const GLfloat ds = 1.f / slices;
-	const GLfloat dt = 1.f / stacks; // from inside texture is reversed
-
-	// draw intermediate  as quad strips
-	for (i = 0,cos_sin_rho_p = cos_sin_rho; i < stacks; ++i,cos_sin_rho_p+=2)
-	{
-		s = 0.f;
-		for (j = 0,cos_sin_theta_p = cos_sin_theta; j<=slices;++j,cos_sin_theta_p+=2)
-		{
-			x = -cos_sin_theta_p[1] * cos_sin_rho_p[1];
-			y = cos_sin_theta_p[0] * cos_sin_rho_p[1];
-			z = cos_sin_rho_p[0];
-			model->texCoordArr << s << t;
-			model->vertexArr << x * radius << y * radius << z * oneMinusOblateness * radius;
-			x = -cos_sin_theta_p[1] * cos_sin_rho_p[3];
-			y = cos_sin_theta_p[0] * cos_sin_rho_p[3];
-			z = cos_sin_rho_p[2];
-			model->texCoordArr << s << t - dt;
-			model->vertexArr << x * radius << y * radius << z * oneMinusOblateness * radius;
-			s += ds;
-		}
-		unsigned int offset = i*(slices+1)*2;
-		for (j = 2;j<slices*2+2;j+=2)
-		{
-			model->indiceArr << offset+j-2 << offset+j-1 << offset+j;
-			model->indiceArr << offset+j << offset+j-1 << offset+j+1;
-		}
-		t -= dt;
-	}
-}
-
-struct Ring3DModel
-{
-	QVector<float> vertexArr;
-	QVector<float> texCoordArr;
-	QVector<unsigned short> indiceArr;
-};
-
-
-void sRing(Ring3DModel* model, const float rMin, const float rMax, int slices, const int stacks)
-{
-	float x,y;
-	
-	const float dr = (rMax-rMin) / stacks;
-	const float* cos_sin_theta = StelUtils::ComputeCosSinTheta(slices);
-	const float* cos_sin_theta_p;
-
-	model->vertexArr.resize(0);
-	model->texCoordArr.resize(0);
-	model->indiceArr.resize(0);
-
-	float r = rMin;
-	for (int i=0; i<=stacks; ++i)
-	{
-		const float tex_r0 = (r-rMin)/(rMax-rMin);
-		int j;
-		for (j=0,cos_sin_theta_p=cos_sin_theta; j<=slices; ++j,cos_sin_theta_p+=2)
-		{
-			x = r*cos_sin_theta_p[0];
-			y = r*cos_sin_theta_p[1];
-			model->texCoordArr << tex_r0 << 0.5f;
-			model->vertexArr << x << y << 0.f;
-		}
-		r+=dr;
-	}
-	for (int i=0; i<stacks; ++i)
-	{
-		for (int j=0; j<slices; ++j)
-		{
-			model->indiceArr << i*slices+j << (i+1)*slices+j << i*slices+j+1;
-			model->indiceArr << i*slices+j+1 << (i+1)*slices+j << (i+1)*slices+j+1;
-		}
-	}
-}
-
 void Planet::computeModelMatrix(Mat4d &result) const
 {
 	result = Mat4d::translation(eclipticPos) * rotLocalToParent;
@@ -2567,16 +2394,15 @@ void Planet::drawSphere(StelPainter* painter, float screenSz, bool drawOnlyRing)
 
 	// Draw the spheroid itself
 	// Adapt the number of facets according with the size of the sphere for optimization
-	int nb_facet = qBound(10, (int)(screenSz * 40.f/50.f), 100);	// 40 facets for 1024 pixels diameter on screen
+	const int nb_facet = PlanetMeshCache::getSphereFacets(screenSz);
 
-	// Generates the vertice
-	Planet3DModel model;
-	sSphere(&model, radius, oneMinusOblateness, nb_facet, nb_facet);
+	// Get the vertices, generated when this level of detail is first drawn
+	const PlanetMesh* model = PlanetMeshCache::getSphere(radius, oneMinusOblateness, nb_facet, nb_facet);
 	
-	QVector<float> projectedVertexArr(model.vertexArr.size());
-	for (int i=0;i<model.vertexArr.size()/3;++i)
+	QVector<float> projectedVertexArr(model->vertexArr.size());
+	for (int i=0;i<model->vertexArr.size()/3;++i)
 	{
-		Vec3f p = *((Vec3f*)(model.vertexArr.constData()+i*3));
+		Vec3f p = *((Vec3f*)(model->vertexArr.constData()+i*3));
 		p *= sphereScale;
 		painter->getProjector()->project(p, *((Vec3f*)(projectedVertexArr.data()+i*3)));
 	}
@@ -2587,8 +2413,8 @@ void Planet::drawSphere(StelPainter* painter, float screenSz, bool drawOnlyRing)
 	{
 		texMap->bind();
 		//painter->setColor(2, 2, 0.2); // This is now in draw3dModel() to apply extinction
-		painter->setArrays((Vec3f*)projectedVertexArr.constData(), (Vec2f*)model.texCoordArr.constData());
-		painter->drawFromArray(StelPainter::Triangles, model.indiceArr.size(), 0, false, model.indiceArr.constData());
+		painter->setArrays((Vec3f*)projectedVertexArr.constData(), (Vec2f*)model->texCoordArr.constData());
+		painter->drawFromArray(StelPainter::Triangles, model->indiceArr.size(), 0, false, model->indiceArr.constData());
 		return;
 	}
 
@@ -2669,10 +2495,7 @@ void Planet::drawSphere(StelPainter* painter, float screenSz, bool drawOnlyRing)
 
 	GL(shader->setAttributeArray(shaderVars->vertex, (const GLfloat*)projectedVertexArr.constData(), 3));
 	GL(shader->enableAttributeArray(shaderVars->vertex));
-	GL(shader->setAttributeArray(shaderVars->unprojectedVertex, (const GLfloat*)model.vertexArr.constData(), 3));
-	GL(shader->enableAttributeArray(shaderVars->unprojectedVertex));
-	GL(shader->setAttributeArray(shaderVars->texCoord, (const GLfloat*)model.texCoordArr.constData(), 2));
-	GL(shader->enableAttributeArray(shaderVars->texCoord));
+	GL(model->bind(shader, shaderVars->unprojectedVertex, shaderVars->texCoord));
 
 	if (rings && !drawOnlyRing)
 	{
@@ -2682,7 +2505,8 @@ void Planet::drawSphere(StelPainter* painter, float screenSz, bool drawOnlyRing)
 	}
 	
 	if (!drawOnlyRing)
-		GL(gl->glDrawElements(GL_TRIANGLES, model.indiceArr.size(), GL_UNSIGNED_SHORT, model.indiceArr.constData()));
+		GL(model->draw());
+	model->release();
 
 	if (rings)
 	{
@@ -2692,8 +2516,7 @@ void Planet::drawSphere(StelPainter* painter, float screenSz, bool drawOnlyRing)
 		// Normal transparency mode
 		painter->setBlending(true);
 
-		Ring3DModel ringModel;
-		sRing(&ringModel, rings->radiusMin, rings->radiusMax, 128, 32);
+		const PlanetMesh* ringModel = PlanetMeshCache::getRing(rings->radiusMin, rings->radiusMax, 128, 32);
 		
 		GL(ringPlanetShaderProgram->setUniformValue(ringPlanetShaderVars.isRing, true));
 		GL(ringPlanetShaderProgram->setUniformValue(ringPlanetShaderVars.tex, 2));
@@ -2708,21 +2531,19 @@ void Planet::drawSphere(StelPainter* painter, float screenSz, bool drawOnlyRing)
 		GL(ringPlanetShaderProgram->setUniformValue(ringPlanetShaderVars.shadowCount, 1));
 		GL(ringPlanetShaderProgram->setUniformValue(ringPlanetShaderVars.shadowData, shadowCandidatesData));
 		
-		projectedVertexArr.resize(ringModel.vertexArr.size());
-		for (int i=0;i<ringModel.vertexArr.size()/3;++i)
-			painter->getProjector()->project(*((Vec3f*)(ringModel.vertexArr.constData()+i*3)), *((Vec3f*)(projectedVertexArr.data()+i*3)));
+		projectedVertexArr.resize(ringModel->vertexArr.size());
+		for (int i=0;i<ringModel->vertexArr.size()/3;++i)
+			painter->getProjector()->project(*((Vec3f*)(ringModel->vertexArr.constData()+i*3)), *((Vec3f*)(projectedVertexArr.data()+i*3)));
 		
 		GL(ringPlanetShaderProgram->setAttributeArray(ringPlanetShaderVars.vertex, (const GLfloat*)projectedVertexArr.constData(), 3));
 		GL(ringPlanetShaderProgram->enableAttributeArray(ringPlanetShaderVars.vertex));
-		GL(ringPlanetShaderProgram->setAttributeArray(ringPlanetShaderVars.unprojectedVertex, (const GLfloat*)ringModel.vertexArr.constData(), 3));
-		GL(ringPlanetShaderProgram->enableAttributeArray(ringPlanetShaderVars.unprojectedVertex));
-		GL(ringPlanetShaderProgram->setAttributeArray(ringPlanetShaderVars.texCoord, (const GLfloat*)ringModel.texCoordArr.constData(), 2));
-		GL(ringPlanetShaderProgram->enableAttributeArray(ringPlanetShaderVars.texCoord));
+		GL(ringModel->bind(ringPlanetShaderProgram, ringPlanetShaderVars.unprojectedVertex, ringPlanetShaderVars.texCoord));
 		
 		if (rData.eyePos[2]<0)
 			gl->glCullFace(GL_FRONT);
 
-		GL(gl->glDrawElements(GL_TRIANGLES, ringModel.indiceArr.size(), GL_UNSIGNED_SHORT, ringModel.indiceArr.constData()));
+		GL(ringModel->draw());
+		ringModel->release();
 		
 		if (rData.eyePos[2]<0)
 			gl->glCullFace(GL_BACK);
@@ -2824,99 +2645,63 @@ void Planet::drawSurvey(StelCore* core, StelPainter* painter)
 	painter->setColor(color[0], color[1], color[2], color[3]);
 }
 
-Planet::PlanetOBJModel* Planet::loadObjModel() const
+bool Planet::hasPendingLoads() const
 {
-	PlanetOBJModel* mdl = new PlanetOBJModel();
-	if(!mdl->obj->load(objModelPath))
-	{
-		//object loading failed
-		qCritical()<<"Could not load planet OBJ model for"<<englishName;
-		delete mdl;
-		return Q_NULLPTR;
-	}
-
-	//ideally, all planet OBJs should only have a single object with a single material
-	if(mdl->obj->getObjectList().size()>1)
-		qWarning()<<"Planet OBJ model has more than one object defined, this may cause problems ...";
-	if(mdl->obj->getMaterialList().size()>1)
-		qWarning()<<"Planet OBJ model has more than one material defined, this may cause problems ...";
-
-	//start texture loading
-	const StelOBJ::Material& mat = mdl->obj->getMaterialList().at(mdl->obj->getObjectList().first().groups.first().materialIndex);
-	if(mat.map_Kd.isEmpty())
-	{
-		//we use a custom 1x1 pixel texture in this case
-		qWarning()<<"Planet OBJ model for"<<englishName<<"has no diffuse texture";
-	}
-	else
-	{
-		//this call starts loading the tex in background
-		mdl->texture = StelApp::getInstance().getTextureManager().createTextureThread(mat.map_Kd,StelTexture::StelTextureParams(true,GL_LINEAR,GL_REPEAT,true),false);
-	}
-
-	//extract the pos array into separate vector, it is the only one we need on CPU side for drawing
-	mdl->obj->splitVertexData(&mdl->posArray);
-	mdl->bbox = mdl->obj->getAABBox();
+	return !objModelPending.isNull()
+		|| (texMap && texMap->isLoading())
+		|| (normalMap && normalMap->isLoading())
+		|| (rings && rings->tex && rings->tex->isLoading());
+}
 
-	return mdl;
+void Planet::setLoadPriority(float priority)
+{
+	if (objModelPending)
+		objModelPending->setLoadPriority(priority);
+	if (texMap)
+		texMap->setLoadPriority(priority);
+	if (normalMap)
+		normalMap->setLoadPriority(priority);
+	if (rings && rings->tex)
+		rings->tex->setLoadPriority(priority);
 }
 
-bool Planet::ensureObjLoaded()
+bool Planet::ensureObjLoaded(float screenSz)
 {
-	if(!objModel && !objModelLoader)
-	{
-		qDebug()<<"Queueing aysnc load of OBJ model for"<<englishName;
-		//create the async OBJ model loader
-		objModelLoader = new QFuture<PlanetOBJModel*>(QtConcurrent::run(this,&Planet::loadObjModel));
-	}
+	//use the reduced model when small on screen, with some hysteresis to avoid switching back and forth
+	const bool reduced = objModel && !objModel->model->isReduced()
+				? screenSz < 0.75f * PlanetModelPool::REDUCED_SCREEN_SIZE
+				: screenSz < PlanetModelPool::REDUCED_SCREEN_SIZE;
+	if((!objModel || objModel->model->isReduced()!=reduced) && (!objModelPending || objModelPending->isReduced()!=reduced))
+		objModelPending = PlanetModelPool::getModel(objModelPath, reduced);
 
-	if(objModelLoader)
+	if(objModelPending && objModelPending->finishLoading())
 	{
-		if(objModelLoader->isFinished())
-		{
-			//the model loading has just finished, save the result
-			objModel = objModelLoader->result();
-			delete objModelLoader; //we dont need the result anymore
-			objModelLoader = Q_NULLPTR;
-
-			if(!objModel)
-			{
-				//model load failed, fall back to sphere mode
-				objModelPath.clear();
-				qWarning()<<"Cannot load OBJ model for solar system object"<<getEnglishName();
-				return false;
-			}
-			else
-			{
-				//load model data into GL
-				if(!objModel->loadGL())
-				{
-					delete objModel;
-					objModel = Q_NULLPTR;
-					objModelPath.clear();
-					qWarning()<<"Cannot load OBJ model into OpenGL for solar system object"<<getEnglishName();
-					return false;
-				}
-				GL(;);
-			}
-		}
-		else
+		PlanetModelP model = objModelPending;
+		objModelPending.clear();
+		if(!model->isValid())
 		{
-			//we are still loading, use the sphere method for drawing
+			//model load failed, fall back to sphere mode
+			delete objModel;
+			objModel = Q_NULLPTR;
+			objModelPath.clear();
+			qWarning()<<"Cannot load OBJ model for solar system object"<<getEnglishName();
 			return false;
 		}
+		//the previous model is released, and unloaded if no other body uses it
+		delete objModel;
+		objModel = new PlanetOBJModel(model);
+		GL(;);
 	}
 
-	//OBJ model is valid!
-	return true;
+	objModelLastDraw = StelApp::getTotalRunTime();
+	//while the other version is loading, the current one is drawn
+	return objModel != Q_NULLPTR;
 }
 
 bool Planet::drawObjModel(StelPainter *painter, float screenSz)
 {
-	Q_UNUSED(screenSz); //screen size unused for now, use it for LOD or something?
-
 	//make sure the OBJ is loaded, or start loading it
-	if(!ensureObjLoaded())
+	if(!ensureObjLoaded(screenSz))
 		return false;
 
 	if(shaderError)
@@ -2980,7 +2765,7 @@ bool Planet::drawObjModel(StelPainter *painter, float screenSz)
 	gl->glClear(GL_DEPTH_BUFFER_BIT);
 
 	// Bind the array
-	GL(objModel->arr->bind());
+	GL(objModel->model->arr->bind());
 
 	//set up shader
 	QOpenGLShaderProgram* shd = objShaderProgram;
@@ -3001,7 +2786,7 @@ bool Planet::drawObjModel(StelPainter *painter, float screenSz)
 	//project the data
 	//because the StelOpenGLArray might use a VAO, we have to use a OGL buffer here in all cases
 	objModel->projPosBuffer->bind();
-	const int vtxCount = objModel->posArray.size();
+	const int vtxCount = objModel->model->posArray.size();
 
 	const StelProjectorP& projector = painter->getProjector();
 
@@ -3009,7 +2794,7 @@ bool Planet::drawObjModel(StelPainter *painter, float screenSz)
 	// but it seems there is not really much of a effect here (probably because we are already pretty CPU-bound).
 	// Also, map()-ing the buffer directly, like:
 	//	Vec3f* bufPtr = static_cast<Vec3f*>(objModel->projPosBuffer->map(QOpenGLBuffer::WriteOnly));
-	//	projector->project(vtxCount,objModel->posArray.constData(),bufPtr);
+	//	projector->project(vtxCount,objModel->model->posArray.constData(),bufPtr);
 	//	objModel->projPosBuffer->unmap();
 	// caused a 40% FPS drop for some reason!
 	// (in theory, this should be faster because it should avoid copying the array)
@@ -3026,11 +2811,11 @@ bool Planet::drawObjModel(StelPainter *painter, float screenSz)
 	setCommonShaderUniforms(*painter,shd,*shdVars);
 
 	//draw that model using the array wrapper
-	objModel->arr->draw();
+	objModel->model->arr->draw();
 
 	shd->disableAttributeArray("vertex");
 	shd->release();
-	objModel->arr->release();
+	objModel->model->arr->release();
 
 	painter->setCullFace(false);
 	painter->setDepthTest(false);
@@ -3086,7 +2871,7 @@ bool Planet::drawObjShadowMap(StelPainter *painter, QMatrix4x4& shadowMatrix)
 
 	for(unsigned int i=0; i<AABBox::CORNERCOUNT; i++)
 	{
-		Vec3d v = objModel->bbox.getCorner(static_cast<AABBox::Corner>(i)).toVec3d();
+		Vec3d v = objModel->model->bbox.getCorner(static_cast<AABBox::Corner>(i)).toVec3d();
 		Vec3d fromCam = v - lightPosScaled; //vector from cam to vertex
 
 		//project the fromCam vector onto the 3 vectors of the orthonormal system
@@ -3127,9 +2912,11 @@ bool Planet::drawObjShadowMap(StelPainter *painter, QMatrix4x4& shadowMatrix)
 		gl->glPolygonOffset(shadowPolyOffset[0], shadowPolyOffset[1]);
 	}
 
+	// the shadow map is not restricted to the sky rectangle
+	StelOpenGL::ScissorSuspender noScissor;
 	gl->glViewport(0,0,SM_SIZE,SM_SIZE);
 
-	GL(objModel->arr->bind());
+	GL(objModel->model->arr->bind());
 	GL(transformShaderProgram->bind());
 	GL(transformShaderProgram->setUniformValue(transformShaderVars.projectionMatrix, mvp));
 
@@ -3143,10 +2930,10 @@ bool Planet::drawObjShadowMap(StelPainter *painter, QMatrix4x4& shadowMatrix)
 	gl->glClear(GL_DEPTH_BUFFER_BIT);
 #endif
 
-	GL(objModel->arr->draw());
+	GL(objModel->model->arr->draw());
 
 	transformShaderProgram->release();
-	objModel->arr->release();
+	objModel->model->arr->release();
 
 #ifdef DEBUG_SHADOWMAP
 	//copy depth buffer into shadowTex
@@ -3296,6 +3083,19 @@ void Planet::drawOrbit(const StelCore* core)
 	if (!re.siderealPeriod)
 		return;
 
+	const OrbitPath::SampleFunc sampleFunc = [this](double jde0, double jde)
+	{
+		Vec3d pos, vel;
+		if (osculatingFunc)
+			(*osculatingFunc)(jde0, jde, pos, vel);
+		else
+			coordFunc(jde, pos, vel, orbitPtr);
+		return pos;
+	};
+	bool sampled = orbitPath.isOutdated(lastJDE);
+	if (sampled)
+		orbitPath.update(lastJDE, sampleFunc);
+
 	const StelProjectorP prj = core->getProjection(StelCore::FrameHeliocentricEclipticJ2000);
 
 	StelPainter sPainter(prj);
@@ -3306,38 +3106,112 @@ void Planet::drawOrbit(const StelCore* core)
 	Vec3f orbColor = getCurrentOrbitColor();
 
 	sPainter.setColor(orbColor[0], orbColor[1], orbColor[2], orbitFader.getInterstate());
-	Vec3d onscreen;
+
+	const QVector<Vec3d>& samples = orbitPath.getSamples();
+	const int segments = samples.size();
+	const Vec3d parentPos = getHeliocentricPos(Vec3d(0.));
+	const Vec3d currentPos = getHeliocentricEclipticPos();
+
+	// Orbits which are small on screen are drawn with fewer segments.
+	double orbitSize = 0.;
+	for (const auto& p : samples)
+		orbitSize = qMax(orbitSize, p.lengthSquared());
+	orbitSize = std::sqrt(orbitSize);
+	const double observerDistance = (currentPos-core->getObserverHeliocentricEclipticPos()).length();
+	const double orbitPixels = observerDistance>orbitSize ? prj->getPixelPerRadAtCenter()*orbitSize/observerDistance : std::numeric_limits<double>::max();
+	const int stride = orbitPixels<20. ? 12 : (orbitPixels<80. ? 3 : 1);
+
 	// special case - use current Planet position as center vertex so that draws
 	// on its orbit all the time (since segmented rather than smooth curve)
-	Vec3d savePos = orbit[ORBIT_SEGMENTS/2];
-	orbit[ORBIT_SEGMENTS/2]=getHeliocentricEclipticPos();
-	orbit[ORBIT_SEGMENTS]=orbit[0];
-	int nbIter = closeOrbit ? ORBIT_SEGMENTS : ORBIT_SEGMENTS-1;
-	QVarLengthArray<float, 1024> vertexArray;
+	QVarLengthArray<int, ORBIT_SEGMENTS+1> indices;
+	const int last = closeOrbit ? segments : segments-1;
+	for (int i=0; i<last; i+=stride)
+		indices.append(i);
+	indices.append(last);
+	QVarLengthArray<Vec3d, ORBIT_SEGMENTS+1> points(indices.size());
+	QVarLengthArray<Vec3d, ORBIT_SEGMENTS+1> onscreen(indices.size());
+	QVarLengthArray<bool, ORBIT_SEGMENTS+1> projected(indices.size());
+	for (int j=0; j<indices.size(); ++j)
+	{
+		const int i = indices.at(j);
+		points[j] = i==segments/2 ? currentPos : parentPos+samples.at(i%segments);
+		projected[j] = prj->project(points.at(j), onscreen[j]);
+	}
+
+	// Where the line is strongly curved on screen, e.g. close to the perihelion of comets, insert points
+	// between two samples. The distance of a sample to the chord of its neighbours estimates the curvature.
+	QVarLengthArray<int, ORBIT_SEGMENTS+1> subdivisions(indices.size());
+	for (int j=0; j<indices.size(); ++j)
+		subdivisions[j] = 1;
+	if (stride==1)
+	{
+		static const double maxSagitta = 0.5; // pixels
+		for (int j=1; j<indices.size()-1; ++j)
+		{
+			if (!projected.at(j-1) || !projected.at(j) || !projected.at(j+1))
+				continue;
+			const double cx = onscreen.at(j+1)[0]-onscreen.at(j-1)[0], cy = onscreen.at(j+1)[1]-onscreen.at(j-1)[1];
+			const double px = onscreen.at(j)[0]-onscreen.at(j-1)[0], py = onscreen.at(j)[1]-onscreen.at(j-1)[1];
+			const double chord = std::sqrt(cx*cx+cy*cy);
+			if (chord<1.)
+				continue;
+			// The sagitta of each half is about a quarter of the distance to the chord, and shrinks with the square of the subdivisions.
+			const double sagitta = 0.25*std::fabs(cx*py-cy*px)/chord;
+			int m = 1;
+			while (m<OrbitPath::SUBDIVISIONS && sagitta>maxSagitta*m*m)
+				m *= 2;
+			subdivisions[j-1] = qMax(subdivisions.at(j-1), m);
+			subdivisions[j] = qMax(subdivisions.at(j), m);
+		}
+	}
 
+	QVarLengthArray<float, 1024> vertexArray;
 	sPainter.enableClientStates(true, false, false);
-
-	for (int n=0; n<=nbIter; ++n)
+	auto flush = [&]()
 	{
-		if (prj->project(orbit[n],onscreen) && (vertexArray.size()==0 || !prj->intersectViewportDiscontinuity(orbit[n-1], orbit[n])))
-		{
-			vertexArray.append(onscreen[0]);
-			vertexArray.append(onscreen[1]);
-		}
-		else if (!vertexArray.isEmpty())
+		if (!vertexArray.isEmpty())
 		{
 			sPainter.setVertexPointer(2, GL_FLOAT, vertexArray.constData());
 			sPainter.drawFromArray(StelPainter::LineStrip, vertexArray.size()/2, 0, false);
 			vertexArray.clear();
 		}
-	}
-	orbit[ORBIT_SEGMENTS/2]=savePos;
-	if (!vertexArray.isEmpty())
+	};
+	Vec3d previous;
+	auto addPoint = [&](const Vec3d& point, bool isProjected, const Vec3d& screenPos)
 	{
-		sPainter.setVertexPointer(2, GL_FLOAT, vertexArray.constData());
-		sPainter.drawFromArray(StelPainter::LineStrip, vertexArray.size()/2, 0, false);
+		if (isProjected && (vertexArray.size()==0 || !prj->intersectViewportDiscontinuity(previous, point)))
+		{
+			vertexArray.append(screenPos[0]);
+			vertexArray.append(screenPos[1]);
+		}
+		else
+			flush();
+		previous = point;
+	};
+
+	for (int j=0; j<indices.size(); ++j)
+	{
+		addPoint(points.at(j), projected.at(j), onscreen.at(j));
+		const int i = indices.at(j);
+		// The current position is not a sample, and the closing segment joins the last sample to the first one.
+		if (subdivisions.at(j)<=1 || i==segments/2 || i+1==segments/2 || i+1>=segments)
+			continue;
+		const int step = OrbitPath::SUBDIVISIONS/subdivisions.at(j);
+		sampled = true;
+		for (int k=step; k<OrbitPath::SUBDIVISIONS; k+=step)
+		{
+			const Vec3d point = parentPos+orbitPath.getIntermediateSample(i, k, sampleFunc);
+			Vec3d screenPos;
+			const bool isProjected = prj->project(point, screenPos);
+			addPoint(point, isProjected, screenPos);
+		}
 	}
+	flush();
 	sPainter.enableClientStates(false);
+
+	// Some coordinate functions keep the state of their last call, e.g. the velocity and tails of comets.
+	if (sampled)
+		coordFunc(lastJDE, eclipticPos, eclipticVelocity, orbitPtr);
 }
 
 void Planet::update(int deltaTime)
@@ -3345,6 +3219,14 @@ void Planet::update(int deltaTime)
 	hintFader.update(deltaTime);
 	labelsFader.update(deltaTime);
 	orbitFader.update(deltaTime);
+
+	//release the shape model if it was not drawn for a while, it is unloaded when no other body uses it
+	if((objModel || objModelPending) && StelApp::getTotalRunTime() - objModelLastDraw > PlanetModelPool::RELEASE_TIME)
+	{
+		delete objModel;
+		objModel = Q_NULLPTR;
+		objModelPending.clear();
+	}
 }
 
 void Planet::setApparentMagnitudeAlgorithm(QString algorithm)
@@ -26,7 +26,10 @@
 #include "GeomMath.hpp"
 #include "StelFader.hpp"
 #include "StelTextureTypes.hpp"
+#include "StelJobMgr.hpp"
+#include "PlanetModelPool.hpp"
 #include "StelProjectorType.hpp"
+#include "OrbitPath.hpp"
 
 #include <QString>
 
@@ -47,7 +50,6 @@ class StelTranslator;
 class StelOBJ;
 class StelOpenGLArray;
 class HipsSurvey;
-template <class T> class QFuture;
 class QOpenGLBuffer;
 class QOpenGLFunctions;
 class QOpenGLShaderProgram;
@@ -194,6 +196,16 @@ public:
 	virtual double getSatellitesFov(const StelCore* core) const;
 	virtual double getParentSatellitesFov(const StelCore* core) const;
 	virtual float getVMagnitude(const StelCore* core) const;
+	//! Compute the visual magnitude (without extinction) from explicit positions instead of the current state.
+	//! This does not access StelCore, so it can be called from threads other than the main thread.
+	//! @param observerHelioPos heliocentric ecliptical J2000 position of the observer [AU]
+	//! @param planetHelioPos heliocentric ecliptical J2000 position of this body [AU]
+	//! @param parentHelioPos heliocentric position of the parent body, used for moons in the shadow of their planet
+	//! @param JDE the date
+	//! @param fromEarth true when the observer is on Earth, to use the empirical formulae of the main planets
+	//! @param eclipseFactor for the Sun only, the visible fraction of the solar disk
+	virtual float computeVMagnitude(const Vec3d& observerHelioPos, const Vec3d& planetHelioPos, const Vec3d& parentHelioPos,
+					double JDE, bool fromEarth, double eclipseFactor=1.) const;
 	virtual float getSelectPriority(const StelCore* core) const;
 	virtual Vec3f getInfoColor(void) const;
 	virtual QString getType(void) const {return PLANET_TYPE;}
@@ -205,6 +217,8 @@ public:
 	QString getCommonNameI18n(void) const {return nameI18;}
 	//! Get angular semidiameter, degrees. If planet display is artificially enlarged (e.g. Moon upscale), value will also be increased.
 	virtual double getAngularSize(const StelCore* core) const;
+	//! Get the angular semidiameter of getAngularSize() for a distance from the observer [AU], degrees.
+	double getAngularSizeAtDistance(double distance) const;
 	virtual bool hasAtmosphere(void) {return atmosphere;}
 	virtual bool hasHalo(void) {return halo;}
 	float getAxisRotation(void) { return axisRotation;} //! return axisRotation last computed in computeTransMatrix().
@@ -218,6 +232,11 @@ public:
 	// GZ Made that virtual to allow comets having their own draw().
 	virtual void draw(StelCore* core, float maxMagLabels, const QFont& planetNameFont);
 
+	//! Get whether the textures or the OBJ model of the planet are still being loaded.
+	bool hasPendingLoads() const;
+	//! Set the priority of the background loading of the textures and the OBJ model, see StelJobMgr.
+	void setLoadPriority(float priority);
+
 	///////////////////////////////////////////////////////////////////////////
 	// Methods specific to Planet
 	//! Get the equator radius of the planet in AU.
@@ -260,6 +279,9 @@ public:
 	//! @param JDE is used for other locations
 	double getSiderealTime(double JD, double JDE) const;
 	Mat4d getRotEquatorialToVsop87(void) const;
+	//! Compute the same rotation as getRotEquatorialToVsop87() for an arbitrary date, without changing the state of the planet.
+	//! This can be called from threads other than the main thread.
+	Mat4d computeRotEquatorialToVsop87(double JDE) const;
 	void setRotEquatorialToVsop87(const Mat4d &m);
 
 	const RotationElements &getRotationElements(void) const {return re;}
@@ -278,9 +300,43 @@ public:
 	void computePositionWithoutOrbits(const double dateJDE);
 	virtual void computePosition(const double dateJDE);
 
+	//! Get whether the position for dateJDE differs from the last computed one by more than the update interval of this planet.
+	bool isPositionOutdated(const double dateJDE) const {return fabs(lastJDE-dateJDE)>deltaJDE;}
+	//! Get whether SolarSystem may skip the position update for dateJDE, because the planet is not visible
+	//! and the position was computed less than the throttling interval from dateJDE.
+	bool isPositionThrottled(const double dateJDE) const {return positionThrottleJDE>0. && fabs(lastJDE-dateJDE)<=positionThrottleJDE;}
+	//! Set the interval [days] by which SolarSystem may delay position updates of this planet, 0 for full-rate updates.
+	void setPositionThrottle(const double interval) {positionThrottleJDE=interval;}
+	double getPositionThrottle() const {return positionThrottleJDE;}
+	//! Set a position computed outside of this class, e.g. by a KeplerOrbitBatch.
+	//! This does the same as computePosition(dateJDE).
+	//! @param dateJDE the JDE for which the position was computed
+	//! @param pos position in the parent Planet coordinate system [AU]
+	//! @param vel velocity in the parent Planet coordinate system [AU/d]
+	void setComputedPosition(const double dateJDE, const Vec3d& pos, const Vec3d& vel);
+
 	//! Compute the transformation matrix from the local Planet coordinate to the parent Planet coordinate.
 	//! This requires both flavours of JD in cases involving Earth.
 	void computeTransMatrix(double JD, double JDE);
+	//! Compute the rotation from the equatorial frame of this planet to the frame of its parent, for a date.
+	Mat4d computeRotLocalToParent(double JDE) const;
+
+	//! Precession and nutation angles of the Earth's axis [radians].
+	struct EarthOrientation
+	{
+		double eps_A, chi_A, omega_A, psi_A;
+		double deltaPsi, deltaEps;
+		bool operator==(const EarthOrientation& other) const
+		{
+			return eps_A==other.eps_A && chi_A==other.chi_A && omega_A==other.omega_A && psi_A==other.psi_A
+				&& deltaPsi==other.deltaPsi && deltaEps==other.deltaEps;
+		}
+	};
+	//! Get the precession angles, and the nutation angles if nutation is used, for a date.
+	//! These are step functions of time, see PRECESSION_EPOCH_THRESHOLD and NUTATION_EPOCH_THRESHOLD in precession.c.
+	static EarthOrientation getEarthOrientation(double JDE);
+	//! Compute the rotation from the equator of date of the Earth to the VSOP87 frame.
+	static Mat4d computeEarthRotLocalToParent(const EarthOrientation& orientation);
 
 	//! Get the phase angle (rad) for an observer at pos obsPos in heliocentric coordinates (in AU)
 	double getPhaseAngle(const Vec3d& obsPos) const;
@@ -318,6 +374,9 @@ public:
 
 	const QSharedPointer<Planet> getParent(void) const {return parent;}
 
+	//! Get the callback which computes the position of the planet relative to its parent.
+	posFuncType getCoordFunc(void) const {return coordFunc;}
+
 	static void setLabelColor(const Vec3f& lc) {labelColor = lc;}
 	static const Vec3f& getLabelColor(void) {return labelColor;}
 
@@ -345,14 +404,11 @@ public:
 	void setFlagOrbits(bool b){orbitFader = b;}
 	bool getFlagOrbits(void) const {return orbitFader;}
 	LinearFader orbitFader;
-	// draw orbital path of Planet
+	// draw orbital path of Planet. The orbit is sampled here, only for bodies whose orbit is displayed.
 	void drawOrbit(const StelCore*);
-	Vec3d orbit[ORBIT_SEGMENTS+1];  // store heliocentric coordinates for drawing the orbit
-	Vec3d orbitP[ORBIT_SEGMENTS+1]; // store local coordinate for orbit
-	double lastOrbitJDE;
+	OrbitPath orbitPath;            // samples of the orbit line, in the parent Planet coordinate system
 	double deltaJDE;                // time difference between positional updates.
-	double deltaOrbitJDE;
-	bool orbitCached;               // whether orbit calculations are cached for drawing orbit yet
+	double positionThrottleJDE;     // additional delay of positional updates while the planet is not visible, see SolarSystem::updatePositionThrottling()
 	bool closeOrbit;                // whether to connect the beginning of the orbit line to
 					// the end: good for elliptical orbits, bad for parabolic
 					// and hyperbolic orbits
@@ -444,20 +500,16 @@ public:
 	QVector<const Planet*> getCandidatesForShadow() const;
 	
 protected:
+	//! The state of this body for drawing a (shared) shape model
 	struct PlanetOBJModel
 	{
-		PlanetOBJModel();
+		PlanetOBJModel(const PlanetModelP& model);
 		~PlanetOBJModel();
 
-		//! Loads the data from the StelOBJ into the StelOpenGLArray
-		bool loadGL();
-
 		void performScaling(double scale);
 
-		//! The BBox of the original model before any transformations
-		AABBox bbox;
-		//! Contains the original positions in model space in km, they need scaling and projection
-		QVector<Vec3f> posArray;
+		//! The shared geometry, which must be valid
+		PlanetModelP model;
 		//! True when the positions need to be rescaled before drawing
 		bool needsRescale;
 		//! Contains the scaled positions (sphere scale in AU), need StelProjector transformation for display
@@ -466,12 +518,8 @@ protected:
 		QVector<Vec3f> projectedPosArray;
 		//! An OpenGL buffer for the projected positions
 		QOpenGLBuffer* projPosBuffer;
-		//! The single texture to use
+		//! The single texture to use, the one of the model or a 1x1 texture of the body's color
 		StelTextureSP texture;
-		//! The original StelOBJ data, deleted after loading to GL
-		StelOBJ* obj;
-		//! The opengl array, created by loadObjModel() but filled later in main thread
-		StelOpenGLArray* arr;
 	};
 
 	static StelTextureSP texEarthShadow;     // for lunar eclipses
@@ -492,9 +540,9 @@ protected:
 
 	bool drawObjShadowMap(StelPainter* painter, QMatrix4x4 &shadowMatrix);
 
-	//! Starts the OBJ loading process, if it has not been done yet.
-	//! Returns true when the OBJ is ready to draw
-	bool ensureObjLoaded();
+	//! Starts loading the OBJ model (or its version of the right resolution for the screen size), if it has not been done yet.
+	//! Returns true when an OBJ is ready to draw
+	bool ensureObjLoaded(float screenSz);
 
 	// Draw the 3D sphere
 	void drawSphere(StelPainter* painter, float screenSz, bool drawOnlyRing=false);
@@ -504,8 +552,7 @@ protected:
 
 	// Draw the circle and name of the Planet
 	void drawHints(const StelCore* core, const QFont& planetNameFont);
-    
-	PlanetOBJModel* loadObjModel() const;
+
 
 	QString englishName;             // english planet name
 	QString nameI18;                 // International translated name
@@ -535,13 +582,15 @@ protected:
 					 // Non-null only for Comets, but we use one shader for all Planets and derivatives, so we need a placeholder here.
 	Mat4d rotLocalToParent;          // GZ2015: was undocumented.
 	// Apparently this is the axis orientation with respect to the parent body. For planets, this is axis orientation w.r.t. VSOP87A/J2000 ecliptical system.
+	EarthOrientation rotLocalToParentOrientation; // For Earth, the angles from which rotLocalToParent was computed.
 	float axisRotation;              // Rotation angle of the Planet on its axis.
 	// For Earth, this should be Greenwich Mean Sidereal Time GMST.
 	StelTextureSP texMap;            // Planet map texture
 	StelTextureSP normalMap;         // Planet normal map texture
 
 	PlanetOBJModel* objModel;               // Planet model (when it has been loaded)
-	QFuture<PlanetOBJModel*>* objModelLoader;// For async loading of the OBJ file
+	PlanetModelP objModelPending;           // The model from PlanetModelPool which is still loading, replaces objModel when ready
+	double objModelLastDraw;                // Run time at which objModel was last drawn, to release it when unused
 
 	QString objModelPath;
 
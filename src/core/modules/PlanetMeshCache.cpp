@@ -0,0 +1,255 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "PlanetMeshCache.hpp"
+#include "StelApp.hpp"
+#include "StelTextureMgr.hpp"
+#include "StelUtils.hpp"
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QSettings>
+
+QHash<PlanetMeshCache::Key, PlanetMesh*> PlanetMeshCache::meshes;
+quint64 PlanetMeshCache::useCounter = 0;
+
+uint qHash(const PlanetMeshCache::Key& key, uint seed)
+{
+	return qHash(key.a, seed) ^ qHash(key.b, seed) ^ qHash((key.slices << 12) ^ (key.stacks << 2) ^ key.shape, seed);
+}
+
+PlanetMesh::PlanetMesh()
+	: vertexBuffer(QOpenGLBuffer::VertexBuffer)
+	, indexBuffer(QOpenGLBuffer::IndexBuffer)
+	, buffered(false)
+	, lastUse(0)
+{
+}
+
+PlanetMesh::~PlanetMesh()
+{
+	if (buffered)
+	{
+		vertexBuffer.destroy();
+		indexBuffer.destroy();
+		StelApp::getInstance().getTextureManager().unregisterGLBuffer(this);
+	}
+}
+
+void PlanetMesh::upload()
+{
+	const int vertexBytes = vertexArr.size()*sizeof(GLfloat);
+	const int texCoordBytes = texCoordArr.size()*sizeof(GLfloat);
+	if (!vertexBuffer.create() || !indexBuffer.create())
+	{
+		vertexBuffer.destroy();
+		indexBuffer.destroy();
+		return;
+	}
+	vertexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+	vertexBuffer.bind();
+	vertexBuffer.allocate(vertexBytes + texCoordBytes);
+	vertexBuffer.write(0, vertexArr.constData(), vertexBytes);
+	vertexBuffer.write(vertexBytes, texCoordArr.constData(), texCoordBytes);
+	vertexBuffer.release();
+	indexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+	indexBuffer.bind();
+	indexBuffer.allocate(indiceArr.constData(), indiceArr.size()*sizeof(unsigned short));
+	indexBuffer.release();
+	StelApp::getInstance().getTextureManager().registerGLBuffer(this, "PlanetMeshCache", vertexBytes + texCoordBytes + indiceArr.size()*sizeof(unsigned short));
+	buffered = true;
+}
+
+void PlanetMesh::bind(QOpenGLShaderProgram* shader, int unprojectedVertexLocation, int texCoordLocation) const
+{
+	if (buffered)
+	{
+		vertexBuffer.bind();
+		shader->setAttributeBuffer(unprojectedVertexLocation, GL_FLOAT, 0, 3);
+		shader->setAttributeBuffer(texCoordLocation, GL_FLOAT, vertexArr.size()*sizeof(GLfloat), 2);
+		// The projected vertices are set from the main memory
+		vertexBuffer.release();
+		indexBuffer.bind();
+	}
+	else
+	{
+		shader->setAttributeArray(unprojectedVertexLocation, vertexArr.constData(), 3);
+		shader->setAttributeArray(texCoordLocation, texCoordArr.constData(), 2);
+	}
+	shader->enableAttributeArray(unprojectedVertexLocation);
+	shader->enableAttributeArray(texCoordLocation);
+}
+
+void PlanetMesh::draw() const
+{
+	QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+	gl->glDrawElements(GL_TRIANGLES, indiceArr.size(), GL_UNSIGNED_SHORT, buffered ? Q_NULLPTR : indiceArr.constData());
+}
+
+void PlanetMesh::release() const
+{
+	if (buffered)
+		indexBuffer.release();
+}
+
+PlanetMesh* PlanetMeshCache::getMesh(const Key& key, bool* created)
+{
+	++useCounter;
+	PlanetMesh* mesh = meshes.value(key, Q_NULLPTR);
+	*created = (mesh==Q_NULLPTR);
+	if (!mesh)
+	{
+		while (meshes.size() >= MAX_MESHES)
+		{
+			auto oldest = meshes.begin();
+			for (auto i = meshes.begin(); i != meshes.end(); ++i)
+			{
+				if (i.value()->lastUse < oldest.value()->lastUse)
+					oldest = i;
+			}
+			delete oldest.value();
+			meshes.erase(oldest);
+		}
+		mesh = new PlanetMesh();
+		meshes.insert(key, mesh);
+	}
+	mesh->lastUse = useCounter;
+	return mesh;
+}
+
+void PlanetMeshCache::finish(PlanetMesh* mesh)
+{
+	static const bool flagBuffers = StelApp::getInstance().getSettings()->value("video/flag_planet_mesh_buffers", true).toBool()
+					&& !StelApp::getInstance().isHeadless();
+	if (flagBuffers)
+		mesh->upload();
+}
+
+const PlanetMesh* PlanetMeshCache::getSphere(float radius, float oneMinusOblateness, int slices, int stacks)
+{
+	const Key key = {Sphere, slices, stacks, radius, oneMinusOblateness};
+	bool created;
+	PlanetMesh* model = getMesh(key, &created);
+	if (!created)
+		return model;
+
+	GLfloat x, y, z;
+	GLfloat s=0.f, t=1.f;
+	GLint i, j;
+
+	const float* cos_sin_rho = StelUtils::ComputeCosSinRho(stacks);
+	const float* cos_sin_theta =  StelUtils::ComputeCosSinTheta(slices);
+	
+	const float* cos_sin_rho_p;
+	const float *cos_sin_theta_p;
+
+	// texturing: s goes from 0.0/0.25/0.5/0.75/1.0 at +y/+x/-y/-x/+y axis
+	// t goes from -1.0/+1.0 at z = -radius/+radius (linear along longitudes)
+	// cannot use triangle fan on texturing (s coord. at top/bottom tip varies)
+	// If the texture is flipped, we iterate the coordinates backward.
+	const GLfloat ds = 1.f / slices;
+	const GLfloat dt = 1.f / stacks; // from inside texture is reversed
+
+	model->vertexArr.reserve(stacks*(slices+1)*6);
+	model->texCoordArr.reserve(stacks*(slices+1)*4);
+	model->indiceArr.reserve(stacks*slices*6);
+	// draw intermediate  as quad strips
+	for (i = 0,cos_sin_rho_p = cos_sin_rho; i < stacks; ++i,cos_sin_rho_p+=2)
+	{
+		s = 0.f;
+		for (j = 0,cos_sin_theta_p = cos_sin_theta; j<=slices;++j,cos_sin_theta_p+=2)
+		{
+			x = -cos_sin_theta_p[1] * cos_sin_rho_p[1];
+			y = cos_sin_theta_p[0] * cos_sin_rho_p[1];
+			z = cos_sin_rho_p[0];
+			model->texCoordArr << s << t;
+			model->vertexArr << x * radius << y * radius << z * oneMinusOblateness * radius;
+			x = -cos_sin_theta_p[1] * cos_sin_rho_p[3];
+			y = cos_sin_theta_p[0] * cos_sin_rho_p[3];
+			z = cos_sin_rho_p[2];
+			model->texCoordArr << s << t - dt;
+			model->vertexArr << x * radius << y * radius << z * oneMinusOblateness * radius;
+			s += ds;
+		}
+		unsigned int offset = i*(slices+1)*2;
+		for (j = 2;j<slices*2+2;j+=2)
+		{
+			model->indiceArr << offset+j-2 << offset+j-1 << offset+j;
+			model->indiceArr << offset+j << offset+j-1 << offset+j+1;
+		}
+		t -= dt;
+	}
+	finish(model);
+	return model;
+}
+
+const PlanetMesh* PlanetMeshCache::getRing(float rMin, float rMax, int slices, int stacks)
+{
+	const Key key = {Ring, slices, stacks, rMin, rMax};
+	bool created;
+	PlanetMesh* model = getMesh(key, &created);
+	if (!created)
+		return model;
+
+	float x,y;
+	
+	const float dr = (rMax-rMin) / stacks;
+	const float* cos_sin_theta = StelUtils::ComputeCosSinTheta(slices);
+	const float* cos_sin_theta_p;
+
+	float r = rMin;
+	for (int i=0; i<=stacks; ++i)
+	{
+		const float tex_r0 = (r-rMin)/(rMax-rMin);
+		int j;
+		for (j=0,cos_sin_theta_p=cos_sin_theta; j<=slices; ++j,cos_sin_theta_p+=2)
+		{
+			x = r*cos_sin_theta_p[0];
+			y = r*cos_sin_theta_p[1];
+			model->texCoordArr << tex_r0 << 0.5f;
+			model->vertexArr << x << y << 0.f;
+		}
+		r+=dr;
+	}
+	for (int i=0; i<stacks; ++i)
+	{
+		for (int j=0; j<slices; ++j)
+		{
+			model->indiceArr << i*slices+j << (i+1)*slices+j << i*slices+j+1;
+			model->indiceArr << i*slices+j+1 << (i+1)*slices+j << (i+1)*slices+j+1;
+		}
+	}
+	finish(model);
+	return model;
+}
+
+int PlanetMeshCache::getSphereFacets(float screenSz)
+{
+	// Rounded up to a multiple of 10, so that a body which is zoomed in or out uses at most 10 meshes
+	const int facets = qBound(10, static_cast<int>(screenSz * 40.f/50.f), 100);
+	return (facets+9)/10*10;
+}
+
+void PlanetMeshCache::clear()
+{
+	qDeleteAll(meshes);
+	meshes.clear();
+}
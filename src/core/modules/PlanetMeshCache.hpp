@@ -0,0 +1,120 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef PLANETMESHCACHE_HPP
+#define PLANETMESHCACHE_HPP
+
+#include <QHash>
+#include <QOpenGLBuffer>
+#include <QVector>
+
+class QOpenGLShaderProgram;
+
+//! @class PlanetMesh
+//! A spheroid or a ring drawn by Planet::drawSphere(), generated once for its level of detail by PlanetMeshCache.
+//! The unprojected vertices stay in main memory, as the planet shaders get the vertices projected on the CPU.
+//! The unprojected vertices, the texture coordinates and the indices are also uploaded to static OpenGL buffers,
+//! so that only the projected vertices are sent in each frame.
+class PlanetMesh
+{
+public:
+	//! The unprojected vertices (x, y, z) in the frame of the body [AU]
+	QVector<float> vertexArr;
+	//! The texture coordinates (s, t) of the vertices
+	QVector<float> texCoordArr;
+	//! The vertices of the triangles
+	QVector<unsigned short> indiceArr;
+
+	//! Set the unprojected vertices and the texture coordinates of a bound shader, and bind the indices.
+	//! They are taken from the main memory when the mesh has no buffers.
+	void bind(QOpenGLShaderProgram* shader, int unprojectedVertexLocation, int texCoordLocation) const;
+	//! Draw the triangles of the mesh bound by bind().
+	void draw() const;
+	//! Release the indices bound by bind().
+	void release() const;
+
+private:
+	friend class PlanetMeshCache;
+	PlanetMesh();
+	~PlanetMesh();
+	//! Copy the arrays to the buffers. Requires a valid context.
+	void upload();
+
+	//! The unprojected vertices, followed by the texture coordinates
+	mutable QOpenGLBuffer vertexBuffer;
+	mutable QOpenGLBuffer indexBuffer;
+	bool buffered;
+	//! The value of PlanetMeshCache::useCounter when the mesh was last requested
+	quint64 lastUse;
+};
+
+//! @class PlanetMeshCache
+//! Keeps the spheroids and the rings of the bodies drawn by Planet::drawSphere(), so that their geometry is not
+//! generated again in each frame. The meshes are identified by their dimensions and their number of slices and
+//! stacks, which Planet rounds to a few levels of detail (see getSphereFacets()). When more than MAX_MESHES meshes
+//! are kept, the one which was requested the longest time ago is deleted.
+//! The OpenGL buffers can be disabled with video/flag_planet_mesh_buffers in the configuration.
+//! All methods must be called from the main thread, with the GL context current.
+class PlanetMeshCache
+{
+public:
+	//! Get a spheroid of the given (equatorial) radius. It stays valid until the next call of a get method.
+	static const PlanetMesh* getSphere(float radius, float oneMinusOblateness, int slices, int stacks);
+	//! Get a flat ring between two radii. It stays valid until the next call of a get method.
+	static const PlanetMesh* getRing(float rMin, float rMax, int slices, int stacks);
+	//! Get the number of slices and stacks of a spheroid of the given diameter on the screen [pixels].
+	static int getSphereFacets(float screenSz);
+	//! Delete all meshes and their buffers.
+	static void clear();
+
+	//! The number of meshes kept at most
+	static const int MAX_MESHES = 48;
+
+private:
+	enum Shape
+	{
+		Sphere,
+		Ring
+	};
+
+	struct Key
+	{
+		Shape shape;
+		int slices;
+		int stacks;
+		//! Sphere: radius and one minus oblateness, Ring: inner and outer radii
+		float a;
+		float b;
+		bool operator==(const Key& other) const
+		{
+			return shape==other.shape && slices==other.slices && stacks==other.stacks && a==other.a && b==other.b;
+		}
+	};
+	friend uint qHash(const Key& key, uint seed);
+
+	//! Get the mesh of a key, or create an empty one, and delete the oldest meshes.
+	static PlanetMesh* getMesh(const Key& key, bool* created);
+	static void finish(PlanetMesh* mesh);
+
+	static QHash<Key, PlanetMesh*> meshes;
+	static quint64 useCounter;
+};
+
+#endif // PLANETMESHCACHE_HPP
@@ -0,0 +1,153 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "PlanetModelPool.hpp"
+#include "StelApp.hpp"
+#include "StelOBJ.hpp"
+#include "StelOpenGLArray.hpp"
+#include "StelTexture.hpp"
+#include "StelTextureMgr.hpp"
+
+#include <QDebug>
+
+const float PlanetModelPool::REDUCED_SCREEN_SIZE = 128.f;
+const double PlanetModelPool::RELEASE_TIME = 60.;
+QHash<QString, QWeakPointer<PlanetModel> > PlanetModelPool::models;
+
+namespace
+{
+	//! The reduced models are clustered in a grid with this number of cells along the diagonal of their bounding box,
+	//! so a cell is about 4 pixels wide at PlanetModelPool::REDUCED_SCREEN_SIZE.
+	const float REDUCED_MODEL_CELLS = 32.f;
+}
+
+PlanetModel::PlanetModel(const QString &path, bool reduced)
+	: arr(Q_NULLPTR), path(path), reduced(reduced), valid(false), obj(Q_NULLPTR)
+{
+}
+
+PlanetModel::~PlanetModel()
+{
+	if (loader)
+	{
+		// The job uses this object, make sure it is not running anymore.
+		loader->cancel();
+		loader->waitForFinished();
+	}
+	delete obj;
+	delete arr;
+}
+
+void PlanetModel::load()
+{
+	StelOBJ* data = new StelOBJ();
+	if(!data->load(path))
+	{
+		qCritical()<<"Could not load planet OBJ model"<<path;
+		delete data;
+		return;
+	}
+
+	//ideally, all planet OBJs should only have a single object with a single material
+	if(data->getObjectList().size()>1)
+		qWarning()<<"Planet OBJ model has more than one object defined, this may cause problems ...";
+	if(data->getMaterialList().size()>1)
+		qWarning()<<"Planet OBJ model has more than one material defined, this may cause problems ...";
+
+	if(reduced)
+	{
+		const float size = (data->getAABBox().max - data->getAABBox().min).length();
+		if(size>0.f)
+		{
+			data->buildLevelsOfDetail(QVector<float>()<<size/REDUCED_MODEL_CELLS);
+			data->replaceByLevelOfDetail(0);
+		}
+	}
+
+	//start texture loading
+	const StelOBJ::Material& mat = data->getMaterialList().at(data->getObjectList().first().groups.first().materialIndex);
+	if(mat.map_Kd.isEmpty())
+	{
+		//the body uses a custom 1x1 pixel texture in this case
+		qWarning()<<"Planet OBJ model"<<path<<"has no diffuse texture";
+	}
+	else
+	{
+		//this call starts loading the tex in background
+		texture = StelApp::getInstance().getTextureManager().createTextureThread(mat.map_Kd,StelTexture::StelTextureParams(true,GL_LINEAR,GL_REPEAT,true),false);
+	}
+
+	//extract the pos array into separate vector, it is the only one we need on CPU side for drawing
+	data->splitVertexData(&posArray);
+	bbox = data->getAABBox();
+	obj = data;
+}
+
+bool PlanetModel::finishLoading()
+{
+	if(loader)
+	{
+		if(!loader->isFinished())
+			return false;
+		loader.clear(); //we dont need the job anymore
+
+		if(obj)
+		{
+			arr = new StelOpenGLArray();
+			valid = arr->load(obj,false);
+			//delete StelOBJ because the data is no longer needed
+			delete obj;
+			obj = Q_NULLPTR;
+			if(!valid)
+				qWarning()<<"Cannot load OBJ model into OpenGL:"<<path;
+		}
+	}
+	return true;
+}
+
+void PlanetModel::setLoadPriority(float priority)
+{
+	if (loader)
+		loader->setPriority(priority);
+}
+
+PlanetModelP PlanetModelPool::getModel(const QString &path, bool reduced)
+{
+	const QString key = path + (reduced ? "#reduced" : "");
+	PlanetModelP model = models.value(key).toStrongRef();
+	if(model)
+		return model;
+
+	qDebug()<<"Queueing async load of"<<(reduced ? "reduced" : "full")<<"OBJ model"<<path;
+	model = PlanetModelP(new PlanetModel(path, reduced));
+	PlanetModel* m = model.data();
+	m->loader = StelApp::getInstance().getJobMgr().submit([m]() { m->load(); });
+	models.insert(key, model);
+
+	//forget the models which were unloaded in the meantime
+	for(auto it = models.begin(); it != models.end();)
+	{
+		if(it.value().isNull())
+			it = models.erase(it);
+		else
+			++it;
+	}
+	return model;
+}
@@ -0,0 +1,102 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef PLANETMODELPOOL_HPP
+#define PLANETMODELPOOL_HPP
+
+#include "GeomMath.hpp"
+#include "StelJobMgr.hpp"
+#include "StelTextureTypes.hpp"
+#include "VecMath.hpp"
+
+#include <QHash>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+class StelOBJ;
+class StelOpenGLArray;
+
+//! @class PlanetModel
+//! The geometry of an OBJ shape model of a solar system body, shared by all bodies using the same file.
+//! It is loaded in the background by PlanetModelPool::getModel(), and uploaded to OpenGL by finishLoading().
+class PlanetModel
+{
+public:
+	~PlanetModel();
+
+	//! Uploads the model to OpenGL once the background load has finished. Requires a valid context.
+	//! @return true if the model is not loading anymore, i.e. it is either valid or has failed
+	bool finishLoading();
+	//! True if the model was loaded and uploaded successfully
+	bool isValid() const { return valid; }
+	//! True if this is a version of the model with reduced resolution
+	bool isReduced() const { return reduced; }
+	const QString& getPath() const { return path; }
+	//! Change the priority of the background load, if it is still pending
+	void setLoadPriority(float priority);
+
+	//! The BBox of the original model before any transformations
+	AABBox bbox;
+	//! Contains the original positions in model space in km, they need scaling and projection
+	QVector<Vec3f> posArray;
+	//! The diffuse texture of the model, null if the model does not define one
+	StelTextureSP texture;
+	//! The OpenGL array, filled by finishLoading()
+	StelOpenGLArray* arr;
+
+private:
+	friend class PlanetModelPool;
+	PlanetModel(const QString& path, bool reduced);
+	//! Loads the OBJ file, runs on a worker thread
+	void load();
+
+	QString path;
+	bool reduced;
+	bool valid;
+	//! The OBJ data, deleted after uploading it to OpenGL
+	StelOBJ* obj;
+	StelJobP loader;
+};
+
+typedef QSharedPointer<PlanetModel> PlanetModelP;
+
+//! @class PlanetModelPool
+//! Shares the OBJ shape models of solar system bodies. Bodies using the same file get the same PlanetModel,
+//! which is unloaded as soon as no body holds it anymore. Bodies which are small on screen use a version with
+//! reduced resolution, which is simplified on loading and keeps only the vertices it needs.
+//! All methods must be called from the main thread.
+class PlanetModelPool
+{
+public:
+	//! Get the model of a file. If no body holds it yet, it starts loading in the background.
+	//! @param reduced true to get the version with reduced resolution
+	static PlanetModelP getModel(const QString& path, bool reduced);
+
+	//! Screen diameter in pixels below which the reduced version of a model is used
+	static const float REDUCED_SCREEN_SIZE;
+	//! Seconds after which a body which was not drawn releases its model
+	static const double RELEASE_TIME;
+
+private:
+	static QHash<QString, QWeakPointer<PlanetModel> > models;
+};
+
+#endif // PLANETMODELPOOL_HPP
@@ -0,0 +1,99 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "PositionsQuery.hpp"
+#include "StelCore.hpp"
+#include "StelApp.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelObject.hpp"
+#include "StelSkyDrawer.hpp"
+#include "RefractionExtinction.hpp"
+#include "LandscapeMgr.hpp"
+
+PositionsQuery::PositionsQuery(const StelCore* core)
+	: core(core)
+{
+}
+
+void PositionsQuery::reserve(int size)
+{
+	objects.reserve(size);
+	j2000Pos.reserve(size);
+	magnitudes.reserve(size);
+	extinction.reserve(size);
+}
+
+int PositionsQuery::add(const StelObjectP& object, float vMag, bool withExtinction)
+{
+	objects.append(object);
+	j2000Pos.append(object->getJ2000EquatorialPos(core));
+	magnitudes.append(vMag);
+	extinction.append(withExtinction);
+	return objects.size()-1;
+}
+
+int PositionsQuery::run(float maxMag, bool aboveRealHorizon)
+{
+	const int count = objects.size();
+	const StelSkyDrawer* skyDrawer = core->getSkyDrawer();
+	const bool withAtmosphere = skyDrawer && skyDrawer->getFlagHasAtmosphere();
+
+	// Geometric horizontal coordinates, and extinction which is computed from them
+	altAzPos = j2000Pos;
+	Vec3d* altAz = altAzPos.data();
+	float* mag = magnitudes.data();
+	for (int i=0; i<count; ++i)
+		core->j2000ToAltAzInPlaceNoRefraction(&altAz[i]);
+	if (withAtmosphere)
+	{
+		const Extinction& ext = skyDrawer->getExtinction();
+		for (int i=0; i<count; ++i)
+		{
+			if (!extinction.at(i))
+				continue;
+			Vec3d dir = altAz[i];
+			dir.normalize();
+			ext.forward(dir, &mag[i]);
+		}
+
+		// Apparent horizontal coordinates
+		const Refraction& refraction = skyDrawer->getRefraction();
+		for (int i=0; i<count; ++i)
+			refraction.forward(altAz[i]);
+	}
+
+	const LandscapeMgr* lmgr = aboveRealHorizon ? GETSTELMODULE(LandscapeMgr) : Q_NULLPTR;
+	const bool withLandscape = lmgr && lmgr->getFlagLandscape();
+	results.clear();
+	for (int i=0; i<count; ++i)
+	{
+		if (mag[i] > maxMag)
+			continue;
+		if (withLandscape)
+		{
+			if (lmgr->getLandscapeOpacity(altAz[i]) > 0.85f)
+				continue;
+		}
+		else if (aboveRealHorizon && altAz[i][2] < 0.)
+			continue;
+		results.append(i);
+	}
+	return results.size();
+}
@@ -0,0 +1,83 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef POSITIONSQUERY_HPP
+#define POSITIONSQUERY_HPP
+
+#include "VecMath.hpp"
+#include "StelObjectType.hpp"
+
+#include <QVector>
+
+class StelCore;
+
+//! @class PositionsQuery
+//! Computes the horizontal coordinates and the magnitudes with extinction of many objects at the current
+//! time of the core, and keeps those which are visible.
+//! Objects are added with their J2000 positions into contiguous arrays, which are then transformed in
+//! one pass: J2000 to horizontal coordinates, refraction, extinction, and the test against the
+//! horizon or the landscape. This replaces one call of StelObject::getAltAzPosAuto(),
+//! StelObject::getVMagnitudeWithExtinction() and StelObject::isAboveRealHorizon() per object,
+//! which transform the same position three times.
+//! Must be used from the main thread.
+class PositionsQuery
+{
+public:
+	PositionsQuery(const StelCore* core);
+
+	//! Reserve space for a number of objects.
+	void reserve(int size);
+	//! Add an object with the position returned by StelObject::getJ2000EquatorialPos().
+	//! @param vMag the magnitude without extinction
+	//! @param extinction false if atmospheric extinction does not apply to vMag (e.g. opacity of dark nebulae)
+	//! @return the index of the object
+	int add(const StelObjectP& object, float vMag, bool extinction=true);
+	//! Get the number of objects added.
+	int size() const {return objects.size();}
+
+	//! Compute the positions of all the objects, and find those brighter than a magnitude limit.
+	//! @param maxMag the magnitude limit, applied to the magnitudes with extinction
+	//! @param aboveRealHorizon true to keep only the objects above the landscape, or above the
+	//! mathematical horizon if the landscape is not displayed
+	//! @return the number of objects found
+	int run(float maxMag, bool aboveRealHorizon=true);
+
+	//! Get the indices of the objects found by run(), in the order they were added.
+	const QVector<int>& getResults() const {return results;}
+
+	const StelObjectP& getObject(int index) const {return objects.at(index);}
+	//! Get the J2000 equatorial position of an object, as returned by StelObject::getJ2000EquatorialPos().
+	const Vec3d& getJ2000Pos(int index) const {return j2000Pos.at(index);}
+	//! Get the horizontal position of an object, as returned by StelObject::getAltAzPosAuto().
+	const Vec3d& getAltAzPos(int index) const {return altAzPos.at(index);}
+	//! Get the magnitude of an object, with extinction if it applies to this object.
+	float getMagnitude(int index) const {return magnitudes.at(index);}
+
+private:
+	const StelCore* core;
+	QVector<StelObjectP> objects;
+	QVector<Vec3d> j2000Pos;
+	QVector<Vec3d> altAzPos;
+	QVector<float> magnitudes;
+	QVector<bool> extinction;
+	QVector<int> results;
+};
+
+#endif // POSITIONSQUERY_HPP
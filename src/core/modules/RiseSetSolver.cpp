@@ -0,0 +1,368 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "RiseSetSolver.hpp"
+#include "SolarSystem.hpp"
+#include "Planet.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelObject.hpp"
+#include "StelObserver.hpp"
+#include "StelSkyDrawer.hpp"
+#include "StelUtils.hpp"
+#include "RefractionExtinction.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	// Number of intervals of the grid of a day
+	const int GRID_INTERVALS = 48;
+	// Tolerance on the date of an event [days]
+	const double TOLERANCE = 1e-5;
+	// Days from the center of the table of Delta T after which the ephemeris is created again
+	const double EPHEMERIS_RANGE = 366.;
+	// Maximum number of cached days of objects
+	const int MAX_CACHE_SIZE = 20000;
+
+	//! Find a root of f between a and b with the Illinois variant of regula falsi.
+	template<class F> double findRoot(F f, double a, double fa, double b, double fb)
+	{
+		double c = a, prev = b;
+		int side = 0;
+		for (int i=0; i<60 && qAbs(c-prev)>TOLERANCE; ++i)
+		{
+			prev = c;
+			c = (fa*b - fb*a)/(fa - fb);
+			const double fc = f(c);
+			if (fc*fb > 0.)
+			{
+				b = c; fb = fc;
+				if (side==-1)
+					fa *= 0.5;
+				side = -1;
+			}
+			else if (fa*fc > 0.)
+			{
+				a = c; fa = fc;
+				if (side==1)
+					fb *= 0.5;
+				side = 1;
+			}
+			else
+				break;
+		}
+		return c;
+	}
+}
+
+bool RiseSetSolver::Settings::operator==(const Settings& other) const
+{
+	return planetName==other.planetName && latitude==other.latitude && longitude==other.longitude && altitude==other.altitude
+		&& topocentric==other.topocentric && atmosphere==other.atmosphere && lightTime==other.lightTime
+		&& pressure==other.pressure && temperature==other.temperature && deltaTAlgorithm==other.deltaTAlgorithm;
+}
+
+RiseSetSolver::RiseSetSolver(StelCore* core)
+	: QObject(core)
+	, core(core)
+	, settings()
+	, ephemerisCenterJD(0.)
+{
+	setObjectName("RiseSetSolver");
+	connect(core, SIGNAL(locationChanged(StelLocation)), this, SLOT(clear()));
+}
+
+RiseSetSolver::~RiseSetSolver()
+{
+}
+
+void RiseSetSolver::clear()
+{
+	cache.clear();
+	grids.clear();
+	ephemeris.reset();
+}
+
+RiseSetSolver::Settings RiseSetSolver::currentSettings() const
+{
+	const StelLocation& location = core->getCurrentLocation();
+	const Refraction& refraction = core->getSkyDrawer()->getRefraction();
+	Settings s;
+	s.planetName = location.planetName;
+	s.latitude = location.latitude;
+	s.longitude = location.longitude;
+	s.altitude = location.altitude;
+	s.topocentric = core->getUseTopocentricCoordinates();
+	s.atmosphere = core->getSkyDrawer()->getFlagHasAtmosphere();
+	s.lightTime = GETSTELMODULE(SolarSystem)->getFlagLightTravelTime();
+	s.pressure = refraction.getPressure();
+	s.temperature = refraction.getTemperature();
+	s.deltaTAlgorithm = core->getCurrentDeltaTAlgorithm();
+	return s;
+}
+
+void RiseSetSolver::prepare(double JD)
+{
+	const Settings s = currentSettings();
+	if (!(s==settings))
+	{
+		clear();
+		settings = s;
+	}
+	if (ephemeris && qAbs(JD-ephemerisCenterJD)<EPHEMERIS_RANGE)
+		return;
+
+	// Entries of the caches stay valid: only the range of the table of Delta T changes.
+	ephemerisCenterJD = JD;
+	ephemeris.reset(new ObserverEphemeris(core, JD-EPHEMERIS_RANGE-1., JD+EPHEMERIS_RANGE+1.));
+}
+
+bool RiseSetSolver::canSolve(const StelObject* object) const
+{
+	if (!object || object->getType()=="Satellite")
+		return false;
+	if (core->getCurrentObserver()->isTraveling())
+		return false;
+	return object->getEnglishName()!=core->getCurrentLocation().planetName;
+}
+
+RiseSetSolver::Target RiseSetSolver::getTarget(const StelObject* object) const
+{
+	Target target;
+	target.isSun = false;
+	target.isMoon = false;
+	if (dynamic_cast<const Planet*>(object))
+	{
+		target.planet = GETSTELMODULE(SolarSystem)->searchByEnglishName(object->getEnglishName());
+		if (target.planet.data()!=object)
+			target.planet.clear();
+	}
+	if (target.planet)
+	{
+		target.isSun = target.planet->getPlanetType()==Planet::isStar;
+		target.isMoon = target.planet->getParent()==ephemeris->getHomePlanet() && target.planet->getEnglishName()=="Moon";
+	}
+	else
+	{
+		// Proper motion is negligible during a day.
+		target.fixedPos = object->getJ2000EquatorialPos(core);
+		target.fixedPos.normalize();
+	}
+	return target;
+}
+
+QString RiseSetSolver::getKey(const StelObject* object) const
+{
+	return object->getType() + QLatin1Char('/') + object->getID() + QLatin1Char('/') + object->getEnglishName();
+}
+
+double RiseSetSolver::getDayStart(double JD) const
+{
+	const double offset = core->getUTCOffset(JD)/24.;
+	return std::floor(JD + offset + 0.5) - 0.5 - offset;
+}
+
+const QVector<ObserverEphemeris::Frame>& RiseSetSolver::getGrid(double startJD)
+{
+	auto it = grids.find(startJD);
+	if (it==grids.end())
+	{
+		QVector<ObserverEphemeris::Frame> frames;
+		frames.reserve(GRID_INTERVALS+1);
+		for (int i=0; i<=GRID_INTERVALS; ++i)
+			frames.append(ephemeris->computeFrame(startJD + static_cast<double>(i)/GRID_INTERVALS));
+		it = grids.insert(startJD, frames);
+	}
+	return it.value();
+}
+
+Vec3d RiseSetSolver::computeAltAz(const Target& target, const ObserverEphemeris::Frame& frame) const
+{
+	const Vec3d j2000Pos = target.planet ? ephemeris->computeJ2000Pos(target.planet, frame) : target.fixedPos;
+	return ephemeris->j2000ToAltAz(j2000Pos, frame, false);
+}
+
+double RiseSetSolver::computeAltitude(const Target& target, const ObserverEphemeris::Frame& frame, double threshold) const
+{
+	const Vec3d altAz = computeAltAz(target, frame);
+	const double distance = altAz.length();
+	double horizon = threshold;
+	if (target.isSun || target.isMoon)
+	{
+		// The upper limb touches the horizon.
+		horizon -= std::atan2(target.planet->getRadius()*target.planet->getSphereScale(), distance);
+		// Same approximation as StelObject::computeRTSTime() without topocentric coordinates
+		if (target.isMoon && !settings.topocentric)
+			horizon += 0.7275*std::asin(qMin(1., ephemeris->getHomePlanet()->getRadius()/distance));
+	}
+	return std::asin(altAz[2]/distance) - horizon;
+}
+
+double RiseSetSolver::computeHourSide(const Target& target, const ObserverEphemeris::Frame& frame) const
+{
+	const Vec3d altAz = computeAltAz(target, frame);
+	return altAz[1]/altAz.length();
+}
+
+RiseSetSolver::DayEvents RiseSetSolver::computeDayEvents(const Target& target, double startJD, double horizon)
+{
+	// Geometric altitude which appears at the horizon; the canonical value at 0 degrees is -34'
+	double threshold = horizon;
+	if (ephemeris->hasAtmosphere())
+	{
+		Vec3d horizonPos(std::cos(horizon), 0.0, std::sin(horizon));
+		core->getSkyDrawer()->getRefraction().backward(horizonPos);
+		threshold = std::asin(horizonPos[2]/horizonPos.length());
+	}
+
+	const QVector<ObserverEphemeris::Frame>& grid = getGrid(startJD);
+	QVector<double> altitudes, sides;
+	altitudes.reserve(grid.size());
+	sides.reserve(grid.size());
+	for (const auto& frame : grid)
+	{
+		altitudes.append(computeAltitude(target, frame, threshold));
+		sides.append(computeHourSide(target, frame));
+	}
+
+	auto altitude = [&](double JD) { return computeAltitude(target, ephemeris->computeFrame(JD), threshold); };
+	auto side = [&](double JD) { return computeHourSide(target, ephemeris->computeFrame(JD)); };
+	// The day is half-open: an event at its end belongs to the next day.
+	auto inDay = [&](double JD) { return JD>=startJD && JD<startJD+1.; };
+
+	DayEvents events;
+	events.startJD = startJD;
+	events.aboveHorizon = altitudes.first()>0.;
+	for (int i=0; i<GRID_INTERVALS; ++i)
+	{
+		const double t0 = grid.at(i).JD, t1 = grid.at(i+1).JD;
+		const double a0 = altitudes.at(i), a1 = altitudes.at(i+1);
+		if ((a0<=0.) != (a1<=0.))
+		{
+			const double JD = findRoot(altitude, t0, a0, t1, a1);
+			if (inDay(JD))
+				(a0<=0. ? events.rises : events.sets).append(JD);
+		}
+		// Upper transit: the object moves from the east to the west side of the meridian.
+		const double s0 = sides.at(i), s1 = sides.at(i+1);
+		if (s0>0. && s1<=0.)
+		{
+			const double JD = findRoot(side, t0, s0, t1, s1);
+			if (inDay(JD))
+			{
+				const Vec3d altAz = computeAltAz(target, ephemeris->computeFrame(JD));
+				events.transits.append(JD);
+				events.transitAltitudes.append(std::asin(altAz[2]/altAz.length()));
+			}
+		}
+	}
+	return events;
+}
+
+RiseSetSolver::DayEvents RiseSetSolver::getDayEvents(const StelObject* object, double JD, double horizon)
+{
+	const double startJD = getDayStart(JD);
+	if (!canSolve(object))
+	{
+		DayEvents events;
+		events.startJD = startJD;
+		events.aboveHorizon = false;
+		return events;
+	}
+
+	prepare(JD);
+	const QString key = getKey(object) + QLatin1Char('/') + QString::number(startJD, 'f', 6) + QLatin1Char('/') + QString::number(horizon);
+	auto it = cache.constFind(key);
+	if (it!=cache.constEnd())
+		return it.value();
+
+	if (cache.size()>MAX_CACHE_SIZE)
+	{
+		cache.clear();
+		grids.clear();
+	}
+	const DayEvents events = computeDayEvents(getTarget(object), startJD, horizon);
+	cache.insert(key, events);
+	return events;
+}
+
+Vec3f RiseSetSolver::getRTSTime(const StelObject* object, double JD)
+{
+	const DayEvents events = getDayEvents(object, JD);
+	auto toHours = [&](double eventJD) { return static_cast<float>((eventJD - events.startJD)*24.); };
+
+	Vec3f rts(-100.f, -1.f, -100.f);
+	if (!events.transits.isEmpty())
+		rts[1] = toHours(events.transits.first());
+	if (events.rises.isEmpty() && events.sets.isEmpty())
+	{
+		// circumpolar or never rises
+		rts[0] = rts[2] = events.aboveHorizon ? 100.f : -100.f;
+		return rts;
+	}
+	if (!events.rises.isEmpty())
+		rts[0] = toHours(events.rises.first());
+	if (!events.sets.isEmpty())
+		rts[2] = toHours(events.sets.first());
+	return rts;
+}
+
+double RiseSetSolver::findNext(const StelObject* object, Event event, double JD, int maxDays, double horizon)
+{
+	for (int day=0; day<=maxDays; ++day)
+	{
+		const DayEvents events = getDayEvents(object, JD + day, horizon);
+		const QVector<double>& dates = event==Rise ? events.rises : (event==Transit ? events.transits : events.sets);
+		for (auto eventJD : dates)
+		{
+			if (eventJD>JD)
+				return eventJD;
+		}
+	}
+	return std::numeric_limits<double>::quiet_NaN();
+}
+
+double RiseSetSolver::findPrevious(const StelObject* object, Event event, double JD, int maxDays, double horizon)
+{
+	for (int day=0; day<=maxDays; ++day)
+	{
+		const DayEvents events = getDayEvents(object, JD - day, horizon);
+		const QVector<double>& dates = event==Rise ? events.rises : (event==Transit ? events.transits : events.sets);
+		for (int i=dates.size()-1; i>=0; --i)
+		{
+			if (dates.at(i)<=JD)
+				return dates.at(i);
+		}
+	}
+	return std::numeric_limits<double>::quiet_NaN();
+}
+
+Vec3d RiseSetSolver::getAltAzPos(const StelObject* object, double JD)
+{
+	if (!canSolve(object))
+		return Vec3d(0.);
+	prepare(JD);
+	const ObserverEphemeris::Frame frame = ephemeris->computeFrame(JD);
+	const Target target = getTarget(object);
+	const Vec3d j2000Pos = target.planet ? ephemeris->computeJ2000Pos(target.planet, frame) : target.fixedPos;
+	return ephemeris->j2000ToAltAz(j2000Pos, frame, true);
+}
@@ -0,0 +1,152 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef RISESETSOLVER_HPP
+#define RISESETSOLVER_HPP
+
+#include "VecMath.hpp"
+#include "ObserverEphemeris.hpp"
+
+#include <QHash>
+#include <QObject>
+#include <QScopedPointer>
+#include <QString>
+#include <QVector>
+
+class StelCore;
+class StelObject;
+
+//! @class RiseSetSolver
+//! Times of rise, transit and set of objects for the current location, shared by the info strings,
+//! AstroCalc and the plugins. The crossings of the horizon and of the meridian are bracketed on a
+//! grid of 30 minutes and refined by a root finder, with positions from ObserverEphemeris: the time
+//! of StelCore is not changed.
+//! Results are cached per object and local day (midnight to midnight in the current time zone), and
+//! the grid of observer frames of a day is shared by all objects. The cache is cleared when the
+//! location or a setting which changes the computed altitudes changes.
+//! All methods must be called from the main thread.
+class RiseSetSolver : public QObject
+{
+	Q_OBJECT
+public:
+	//! Events of an object during one local day
+	struct DayEvents
+	{
+		double startJD;				//!< start of the local day (UT)
+		QVector<double> rises;			//!< rise times (UT)
+		QVector<double> transits;		//!< upper transit times (UT)
+		QVector<double> sets;			//!< set times (UT)
+		QVector<double> transitAltitudes;	//!< geometric altitude of the center at each transit [rad]
+		bool aboveHorizon;			//!< true if the object is above the horizon at the start of the day
+	};
+
+	enum Event
+	{
+		Rise,
+		Transit,
+		Set
+	};
+
+	RiseSetSolver(StelCore* core);
+	~RiseSetSolver();
+
+	//! Get whether events can be computed for an object: not for artificial satellites, not for the
+	//! planet of the observer, and not while the observer travels between planets.
+	bool canSolve(const StelObject* object) const;
+
+	//! Get the events of an object during the local day containing a date.
+	//! @param JD the date (UT)
+	//! @param horizon the geometric altitude of the horizon [rad]. Refraction is applied when the observer has an atmosphere.
+	//! The Sun and the Moon rise and set when their upper limb crosses the horizon.
+	//! @return the events, all empty if canSolve() is false
+	DayEvents getDayEvents(const StelObject* object, double JD, double horizon=0.);
+
+	//! Get the times of rise, transit and set of the local day containing a date as decimal hours,
+	//! in the format of StelObject::getRTSTime(): rise and set are 100 for a circumpolar object,
+	//! -100 for an object which does not rise, or -100 if the event does not happen on that day.
+	//! Transit is -1 if it does not happen on that day.
+	Vec3f getRTSTime(const StelObject* object, double JD);
+
+	//! Find the first event of a type after a date.
+	//! @param maxDays the number of days to search
+	//! @param horizon the altitude of the horizon, see getDayEvents()
+	//! @return the date of the event (UT), or NaN if not found
+	double findNext(const StelObject* object, Event event, double JD, int maxDays=2, double horizon=0.);
+	//! Find the last event of a type before a date.
+	//! @param maxDays the number of days to search
+	//! @param horizon the altitude of the horizon, see getDayEvents()
+	//! @return the date of the event (UT), or NaN if not found
+	double findPrevious(const StelObject* object, Event event, double JD, int maxDays=2, double horizon=0.);
+
+	//! Get the position of an object in the horizontal frame at a date, like StelObject::getAltAzPosAuto()
+	//! at that date: refraction is applied when the observer has an atmosphere.
+	//! @return the position, or a null vector if canSolve() is false
+	Vec3d getAltAzPos(const StelObject* object, double JD);
+
+	//! Get the start (UT) of the local day containing a date.
+	double getDayStart(double JD) const;
+
+public slots:
+	//! Remove all the cached results.
+	void clear();
+
+private:
+	//! The object, as a body of the solar system or a fixed J2000 direction
+	struct Target
+	{
+		PlanetP planet;
+		Vec3d fixedPos;
+		bool isSun;
+		bool isMoon;
+	};
+	//! The settings the cached results depend on
+	struct Settings
+	{
+		QString planetName;
+		float latitude, longitude;
+		int altitude;
+		bool topocentric, atmosphere, lightTime;
+		float pressure, temperature;
+		int deltaTAlgorithm;
+		bool operator==(const Settings& other) const;
+	};
+
+	//! Clear the cache if the settings changed, and create the ephemeris for a date.
+	void prepare(double JD);
+	Settings currentSettings() const;
+	Target getTarget(const StelObject* object) const;
+	QString getKey(const StelObject* object) const;
+	const QVector<ObserverEphemeris::Frame>& getGrid(double startJD);
+	DayEvents computeDayEvents(const Target& target, double startJD, double horizon);
+	//! Altitude of the target above the altitude of rise and set [rad]
+	//! @param threshold the geometric altitude of the horizon, including refraction [rad]
+	double computeAltitude(const Target& target, const ObserverEphemeris::Frame& frame, double threshold) const;
+	//! East-west component of the direction of the target, positive to the east
+	double computeHourSide(const Target& target, const ObserverEphemeris::Frame& frame) const;
+	Vec3d computeAltAz(const Target& target, const ObserverEphemeris::Frame& frame) const;
+
+	StelCore* core;
+	Settings settings;
+	QScopedPointer<ObserverEphemeris> ephemeris;
+	double ephemerisCenterJD;
+	QHash<double, QVector<ObserverEphemeris::Frame> > grids;
+	QHash<QString, DayEvents> cache;
+};
+
+#endif // RISESETSOLVER_HPP
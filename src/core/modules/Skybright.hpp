@@ -69,6 +69,13 @@ public:
 	//! @param cosDistZenith cos(angular distance between zenith and the position)
 	float getLuminance(float cosDistMoon, const float cosDistSun, const float cosDistZenith) const;
 
+	//! Get the precomputed terms of getLuminance(), for the evaluation of the same model in a shader.
+	void getShadersParams(float& aK, float& aC3, float& aC4, float& abNightTerm, float& abMoonTerm1, float& abTwilightTerm) const
+	{
+		aK=K; aC3=C3; aC4=C4;
+		abNightTerm=bNightTerm; abMoonTerm1=bMoonTerm1; abTwilightTerm=bTwilightTerm;
+	}
+
 private:
 	float airMassMoon;  // Air mass for the Moon
 	float airMassSun;   // Air mass for the Sun
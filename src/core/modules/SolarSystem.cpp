@@ -34,10 +34,14 @@
 #include "StelFileMgr.hpp"
 #include "StelModuleMgr.hpp"
 #include "StelIniParser.hpp"
+#include "StelIniCache.hpp"
 #include "Planet.hpp"
 #include "MinorPlanet.hpp"
 #include "Comet.hpp"
+#include "PlanetMeshCache.hpp"
 #include "StelMainView.hpp"
+#include "StelMovementMgr.hpp"
+#include "StelJobMgr.hpp"
 
 #include "StelSkyDrawer.hpp"
 #include "StelUtils.hpp"
@@ -61,6 +65,9 @@
 #include <QDebug>
 #include <QDir>
 #include <QHash>
+#include <QPair>
+#include <QThreadPool>
+#include <QtConcurrent>
 
 SolarSystem::SolarSystem()
 	: shadowPlanetCount(0)
@@ -69,8 +76,14 @@ SolarSystem::SolarSystem()
 	, flagMinorBodyScale(false)
 	, minorBodyScale(1.0)
 	, labelsAmount(false)
+	, keplerOrbitsDirty(true)
+	, preparedJDE(qQNaN())
 	, flagOrbits(false)
 	, flagLightTravelTime(true)
+	, flagParallelPositions(true)
+	, flagBatchedOrbits(true)
+	, flagPositionThrottling(true)
+	, positionThrottleInterval(1./24.)
 	, flagUseObjModels(false)
 	, flagShowObjSelfShadows(true)
 	, flagShow(false)
@@ -127,6 +140,9 @@ SolarSystem::~SolarSystem()
 	//delete comet textures created in loadPlanets
 	Comet::comaTexture.clear();
 	Comet::tailTexture.clear();
+	delete Comet::tailRenderer;
+	Comet::tailRenderer = Q_NULLPTR;
+	PlanetMeshCache::clear();
 
 	//deinit of SolarSystem is NOT called at app end automatically
 	deinit();
@@ -158,6 +174,10 @@ void SolarSystem::init()
 	setFlagMoonScale(conf->value("viewing/flag_moon_scaled", conf->value("viewing/flag_init_moon_scaled", "false").toBool()).toBool());  // name change
 	setMinorBodyScale(conf->value("viewing/minorbodies_scale", 10.0).toFloat());
 	setFlagMinorBodyScale(conf->value("viewing/flag_minorbodies_scaled", false).toBool());
+	flagParallelPositions = conf->value("astro/flag_parallel_positions", true).toBool();
+	flagBatchedOrbits = conf->value("astro/flag_batched_orbits", true).toBool();
+	flagPositionThrottling = conf->value("astro/flag_minor_bodies_throttling", true).toBool();
+	positionThrottleInterval = conf->value("astro/minor_bodies_throttling_interval", 60.).toDouble()/(24.*60.); // minutes
 	setMoonScale(conf->value("viewing/moon_scale", 4.0).toFloat());
 	setFlagPlanets(conf->value("astro/flag_planets").toBool());
 	setFlagHints(conf->value("astro/flag_planets_hints").toBool());
@@ -232,7 +252,8 @@ void SolarSystem::init()
 	StelApp *app = &StelApp::getInstance();
 	connect(app, SIGNAL(languageChanged()), this, SLOT(updateI18n()));
 	connect(&app->getSkyCultureMgr(), SIGNAL(currentSkyCultureChanged(QString)), this, SLOT(updateSkyCulture(QString)));
-	connect(&StelMainView::getInstance(), SIGNAL(reloadShadersRequested()), this, SLOT(reloadShaders()));
+	if (!app->isHeadless())
+		connect(&StelMainView::getInstance(), SIGNAL(reloadShadersRequested()), this, SLOT(reloadShaders()));
 
 	QString displayGroup = N_("Display Options");
 	addAction("actionShow_Planets", displayGroup, N_("Planets"), "planetsDisplayed", "P");
@@ -246,7 +267,8 @@ void SolarSystem::init()
 	addAction("actionShow_Planets_EnlargeMinor", displayGroup, N_("Enlarge minor bodies"), "flagMinorBodyScale");
 	addAction("actionShow_Skyculture_NativePlanetNames", displayGroup, N_("Native planet names (from starlore)"), "flagNativePlanetNames", "Ctrl+Shift+N");
 
-	connect(StelApp::getInstance().getModule("HipsMgr"), SIGNAL(gotNewSurvey(HipsSurveyP)),
+	if (!app->isHeadless())
+		connect(app->getModule("HipsMgr"), SIGNAL(gotNewSurvey(HipsSurveyP)),
 			this, SLOT(onNewSurvey(HipsSurveyP)));
 }
 
@@ -261,7 +283,7 @@ void SolarSystem::recreateTrails()
 	// Create a trail group containing all the planets orbiting the sun (not including satellites)
 	if (allTrails!=Q_NULLPTR)
 		delete allTrails;
-	allTrails = new TrailGroup(365.f);
+	allTrails = new TrailGroup(365.f, StelApp::getInstance().getSettings()->value("astro/object_trails_max_points", 1000).toInt());
 
 	PlanetP p = getSelected();
 	if (p!=Q_NULLPTR && getFlagIsolatedTrails())
@@ -402,9 +424,7 @@ void SolarSystem::drawPointer(const StelCore* core)
 
 void ellipticalOrbitPosFunc(double jd,double xyz[3], double xyzdot[3], void* orbitPtr)
 {
-	static_cast<EllipticalOrbit*>(orbitPtr)->positionAtTimevInVSOP87Coordinates(jd, xyz);
-	// TODO: Implement a way to retrieve velocities.
-	xyzdot[0]=xyzdot[1]=xyzdot[2]=0.0;
+	static_cast<EllipticalOrbit*>(orbitPtr)->positionAtTimevInVSOP87Coordinates(jd, xyz, xyzdot);
 }
 void cometOrbitPosFunc(double jd,double xyz[3], double xyzdot[3], void* orbitPtr)
 {
@@ -463,6 +483,8 @@ void SolarSystem::loadPlanets()
 				}
 			}			
 			systemPlanets.clear();			
+			keplerOrbitsDirty = true;
+			invalidateNameIndex();
 			//Memory leak? What's the proper way of cleaning shared pointers?
 
 			// TODO: 0.16pre what about the orbits list?
@@ -505,9 +527,13 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 {
 	StelSkyDrawer* skyDrawer = StelApp::getInstance().getCore()->getSkyDrawer();
 	qDebug() << "Loading from :"  << filePath;
+	keplerOrbitsDirty = true;
+	invalidateNameIndex();
 	int readOk = 0;
-	QSettings pd(filePath, StelIniFormat);
-	if (pd.status() != QSettings::NoError)
+	// Large files like the ones created by the Solar System Editor take long to parse,
+	// so their content is kept in a binary cache.
+	const StelIniCache pd(filePath);
+	if (!pd.isValid())
 	{
 		qWarning() << "ERROR while parsing" << QDir::toNativeSeparators(filePath);
 		return false;
@@ -1193,14 +1219,182 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 
 // Compute the position for every elements of the solar system.
 // The order is not important since the position is computed relatively to the mother body
-void SolarSystem::computePositions(double dateJDE, PlanetP observerPlanet)
+namespace
+{
+	//! Below this number of independent bodies, the overhead of the thread pool is not worth it.
+	static const int MIN_PARALLEL_BODIES = 256;
+	//! Number of bodies computed by a task of the thread pool.
+	static const int PARALLEL_CHUNK_SIZE = 64;
+	//! Largest deviation [rad] accepted for light time corrections by extrapolation, see SolarSystem::computePositions().
+	//! 1E-8 is 2 mas, far below the accuracy of the theories.
+	static const double LIGHT_TIME_EXTRAPOLATION_TOLERANCE = 1E-8;
+	//! Gaussian gravitational constant squared [AU^3/d^2].
+	static const double GAUSS_GRAV_CONST_SQ = 0.01720209895*0.01720209895;
+
+	//! Call func(begin, end) for consecutive ranges of at most PARALLEL_CHUNK_SIZE items of [0, count[.
+	//! The ranges are processed on the global thread pool if parallel is true and there are at least
+	//! MIN_PARALLEL_BODIES items, else on this thread.
+	template<class Func>
+	void forEachChunk(int count, bool parallel, Func func)
+	{
+		if (!parallel || count<MIN_PARALLEL_BODIES)
+		{
+			for (int i=0;i<count;i+=PARALLEL_CHUNK_SIZE)
+				func(i, qMin(i+PARALLEL_CHUNK_SIZE, count));
+			return;
+		}
+		QVector<QPair<int, int> > chunks;
+		for (int i=0;i<count;i+=PARALLEL_CHUNK_SIZE)
+			chunks.append(qMakePair(i, qMin(i+PARALLEL_CHUNK_SIZE, count)));
+		QtConcurrent::blockingMap(chunks, [&](const QPair<int, int>& chunk) { func(chunk.first, chunk.second); });
+	}
+
+	//! Call func for all bodies on the global thread pool, in chunks of PARALLEL_CHUNK_SIZE bodies.
+	template<class Func>
+	void forEachBodyInParallel(const QVector<Planet*>& bodies, Func func)
+	{
+		if (bodies.isEmpty())
+			return;
+		forEachChunk(bodies.size(), true, [&](int begin, int end)
+		{
+			for (int i=begin;i<end;++i)
+				func(bodies.at(i));
+		});
+	}
+}
+
+void SolarSystem::updateKeplerOrbits()
+{
+	keplerOrbits.clear();
+	keplerOrbitBodies.clear();
+	otherBodies.clear();
+	for (const auto& p : systemPlanets)
+	{
+		int index = -1;
+		if (flagBatchedOrbits && p->getParent()==sun && p->satellites.isEmpty())
+		{
+			const posFuncType func = p->getCoordFunc();
+			if (func==&ellipticalOrbitPosFunc)
+				index = keplerOrbits.add(static_cast<const EllipticalOrbit*>(p->orbitPtr));
+			else if (func==&cometOrbitPosFunc)
+				index = keplerOrbits.add(static_cast<CometOrbit*>(p->orbitPtr));
+		}
+		if (index>=0)
+			keplerOrbitBodies.append(p.data());
+		else
+			otherBodies.append(p.data());
+	}
+	keplerOrbitsDirty = false;
+	preparedJDE = qQNaN();
+}
+
+void SolarSystem::prepareNextFrame(double nextJDE)
 {
+	preparedJDE = qQNaN();
+	// Rebuilding the orbits has to wait for computePositions() on the main thread.
+	if (keplerOrbitsDirty || keplerOrbits.size()==0)
+		return;
+	const int count = keplerOrbits.size();
+	QVector<int> indices(count);
+	for (int i=0;i<count;++i)
+		indices[i] = i;
+	const QVector<double> jde(count, nextJDE);
+	preparedPositions.resize(count);
+	preparedVelocities.resize(count);
+	keplerOrbits.computePositions(indices.constData(), jde.constData(), count, preparedPositions.data(), preparedVelocities.data(), false);
+	preparedJDE = nextJDE;
+}
+
+void SolarSystem::computeKeplerOrbitPositions(const QVector<double>& dates, bool allowThrottling)
+{
+	QVector<int> indices;
+	QVector<double> jde;
+	QVector<int> preparedIndices;
+	QVector<Vec3d> preparedIndexVelocities;
+	indices.reserve(keplerOrbitBodies.size());
+	jde.reserve(keplerOrbitBodies.size());
+	const bool prepared = preparedPositions.size()==keplerOrbitBodies.size();
+	for (int i=0;i<keplerOrbitBodies.size();++i)
+	{
+		Planet* p = keplerOrbitBodies.at(i);
+		if (allowThrottling && p->isPositionThrottled(dates.at(i)))
+			continue;
+		if (p->isPositionOutdated(dates.at(i)))
+		{
+			// Take over the positions computed by prepareNextFrame() during the last frame.
+			if (prepared && dates.at(i)==preparedJDE)
+			{
+				p->setComputedPosition(preparedJDE, preparedPositions.at(i), preparedVelocities.at(i));
+				preparedIndices.append(i);
+				preparedIndexVelocities.append(preparedVelocities.at(i));
+				continue;
+			}
+			indices.append(i);
+			jde.append(dates.at(i));
+		}
+	}
+	keplerOrbits.updateCometVelocities(preparedIndices.constData(), preparedIndices.size(), preparedIndexVelocities.constData());
+
+	const bool parallel = flagParallelPositions && QThreadPool::globalInstance()->maxThreadCount()>1;
+	QVector<Vec3d> positions(indices.size());
+	QVector<Vec3d> velocities(indices.size());
+	Vec3d* pos = positions.data();
+	Vec3d* vel = velocities.data();
+	forEachChunk(indices.size(), parallel, [&](int begin, int end)
+	{
+		keplerOrbits.computePositions(indices.constData()+begin, jde.constData()+begin, end-begin, pos+begin, vel+begin);
+		for (int k=begin;k<end;++k)
+			keplerOrbitBodies.at(indices.at(k))->setComputedPosition(jde.at(k), pos[k], vel[k]);
+	});
+}
+
+void SolarSystem::computePositions(double dateJDE, PlanetP observerPlanet, bool allowThrottling)
+{
+	if (keplerOrbitsDirty)
+		updateKeplerOrbits();
+	// The position of the observer is always needed.
+	if (allowThrottling)
+		observerPlanet->setPositionThrottle(0.);
+
+	// Bodies on an elliptical orbit around the Sun are propagated together by keplerOrbits.
+	// Other bodies on a Keplerian or comet orbit around the Sun only depend on their own orbit,
+	// so their positions can be computed in parallel. All others, in particular moons
+	// and the bodies they orbit, are computed in order on this thread.
+	QVector<Planet*> serialBodies;
+	QVector<Planet*> parallelBodies;
+	if (flagParallelPositions && QThreadPool::globalInstance()->maxThreadCount()>1)
+	{
+		for (auto* p : otherBodies)
+		{
+			if (allowThrottling && p->isPositionThrottled(dateJDE))
+				continue;
+			const posFuncType func = p->getCoordFunc();
+			if (p->getParent()==sun && p->satellites.isEmpty() && (func==&ellipticalOrbitPosFunc || func==&cometOrbitPosFunc))
+				parallelBodies.append(p);
+			else
+				serialBodies.append(p);
+		}
+	}
+	if (parallelBodies.size()<MIN_PARALLEL_BODIES)
+	{
+		serialBodies.clear();
+		parallelBodies.clear();
+		for (auto* p : otherBodies)
+		{
+			if (!allowThrottling || !p->isPositionThrottled(dateJDE))
+				serialBodies.append(p);
+		}
+	}
+
+	QVector<double> keplerOrbitDates(keplerOrbitBodies.size(), dateJDE);
 	if (flagLightTravelTime)
 	{
-		for (const auto& p : systemPlanets)
+		for (auto* p : serialBodies)
 		{
 			p->computePositionWithoutOrbits(dateJDE);
 		}
+		forEachBodyInParallel(parallelBodies, [dateJDE](Planet* p) { p->computePositionWithoutOrbits(dateJDE); });
+		computeKeplerOrbitPositions(keplerOrbitDates, allowThrottling);
 		// BEGIN HACK: 0.16.0post for solar aberration/light time correction
 		// This fixes eclipse bug LP:#1275092) and outer planet rendering bug (LP:#1699648) introduced by the first fix in 0.16.0.
 		// We compute a "light time corrected position" for the sun and apply it only for rendering, not for other computations.
@@ -1208,30 +1402,129 @@ void SolarSystem::computePositions(double dateJDE, PlanetP observerPlanet)
 		const Vec3d obsPosJDE=observerPlanet->getHeliocentricEclipticPos();
 		const double obsDist=obsPosJDE.length();
 
+		// computePosition() also moves the parent of the observer. Their geometric positions are restored afterwards.
+		Planet* const obsParent = (observerPlanet->parent && observerPlanet->parent->parent) ? observerPlanet->parent.data() : Q_NULLPTR;
+		const Vec3d obsPos=observerPlanet->eclipticPos, obsVel=observerPlanet->eclipticVelocity;
+		const double obsLastJDE=observerPlanet->lastJDE;
+		const Vec3d obsParentPos=obsParent ? obsParent->eclipticPos : Vec3d(0.);
+		const Vec3d obsParentVel=obsParent ? obsParent->eclipticVelocity : Vec3d(0.);
+		const double obsParentLastJDE=obsParent ? obsParent->lastJDE : 0.;
+
 		observerPlanet->computePosition(dateJDE-obsDist * (AU / (SPEED_OF_LIGHT * 86400.)));
 		const Vec3d obsPosJDEbefore=observerPlanet->getHeliocentricEclipticPos();
 		lightTimeSunPosition=obsPosJDE-obsPosJDEbefore;
 
 		// We must reset observerPlanet for the next step!
-		observerPlanet->computePosition(dateJDE);
+		observerPlanet->setComputedPosition(obsLastJDE, obsPos, obsVel);
+		if (obsParent)
+			obsParent->setComputedPosition(obsParentLastJDE, obsParentPos, obsParentVel);
 		// END HACK FOR SOLAR LIGHT TIME/ABERRATION
-		for (const auto& p : systemPlanets)
+		auto lightTimeCorrectedDate = [dateJDE, &obsPosJDE](const Planet* p)
 		{
 			const double light_speed_correction = (p->getHeliocentricEclipticPos()-obsPosJDE).length() * (AU / (SPEED_OF_LIGHT * 86400.));
-			p->computePosition(dateJDE-light_speed_correction);
+			return dateJDE-light_speed_correction;
+		};
+		// Bodies around the Sun move almost on a straight line during the light time, so their corrected position
+		// is extrapolated from the geometric one with their velocity. The deviation from the recomputed position is
+		// about a*lt^2/2 with the acceleration a by the Sun, so bodies which would deviate by more than
+		// LIGHT_TIME_EXTRAPOLATION_TOLERANCE as seen from the observer, as well as planets with moons
+		// and bodies whose theory gives no velocity, are recomputed for the corrected date.
+		const Planet* const sunPlanet = sun.data();
+		const Planet* const observer = observerPlanet.data();
+		auto extrapolateLightTime = [dateJDE, allowThrottling, &obsPosJDE, sunPlanet, observer](Planet* p)
+		{
+			if (p==observer || p->parent.data()!=sunPlanet || !p->satellites.isEmpty())
+				return false;
+			// Like computeKeplerOrbitPositions(), throttled bodies are not corrected.
+			if (allowThrottling && p->getPositionThrottle()>0.)
+				return true;
+			const Vec3d vel=p->eclipticVelocity;
+			const double r2=p->eclipticPos.lengthSquared();
+			if (vel.lengthSquared()==0. || r2==0.)
+				return false;
+			const double distance=(p->eclipticPos-obsPosJDE).length();
+			const double lightTime=distance * (AU / (SPEED_OF_LIGHT * 86400.));
+			if (0.5*GAUSS_GRAV_CONST_SQ/r2*lightTime*lightTime > LIGHT_TIME_EXTRAPOLATION_TOLERANCE*distance)
+				return false;
+			p->setComputedPosition(dateJDE-lightTime, p->eclipticPos-vel*lightTime, vel);
+			return true;
+		};
+		for (auto* p : serialBodies)
+		{
+			if (!extrapolateLightTime(p))
+				p->computePosition(lightTimeCorrectedDate(p));
 		}
+		forEachBodyInParallel(parallelBodies, [&lightTimeCorrectedDate, &extrapolateLightTime](Planet* p)
+		{
+			if (!extrapolateLightTime(p))
+				p->computePosition(lightTimeCorrectedDate(p));
+		});
+		// Extrapolated bodies are up to date for their corrected date, computeKeplerOrbitPositions() skips them.
+		for (int i=0;i<keplerOrbitBodies.size();++i)
+		{
+			Planet* p = keplerOrbitBodies.at(i);
+			keplerOrbitDates[i] = extrapolateLightTime(p) ? p->lastJDE : lightTimeCorrectedDate(p);
+		}
+		computeKeplerOrbitPositions(keplerOrbitDates, allowThrottling);
 	}
 	else
 	{
-		for (const auto& p : systemPlanets)
+		for (auto* p : serialBodies)
 		{
 			p->computePosition(dateJDE);
 		}
+		forEachBodyInParallel(parallelBodies, [dateJDE](Planet* p) { p->computePosition(dateJDE); });
+		computeKeplerOrbitPositions(keplerOrbitDates, allowThrottling);
 		lightTimeSunPosition.set(0.,0.,0.);
 	}
 	computeTransMatrices(dateJDE, observerPlanet->getHeliocentricEclipticPos());
 }
 
+void SolarSystem::computeHeliocentricStateAt(const Planet* p, double dateJDE, Vec3d& pos, Vec3d& vel)
+{
+	pos.set(0.,0.,0.);
+	vel.set(0.,0.,0.);
+	// The Sun is the origin and has no parent.
+	for (const Planet* body=p; body && body->parent; body=body->parent.data())
+	{
+		if (!body->coordFunc)
+		{
+			pos += body->getHeliocentricEclipticPos();
+			return;
+		}
+		Vec3d bodyPos, bodyVel;
+		if (body->coordFunc==&cometOrbitPosFunc)
+			static_cast<const CometOrbit*>(body->orbitPtr)->stateAtTimeInVSOP87Coordinates(dateJDE, bodyPos, bodyVel);
+		else
+			body->coordFunc(dateJDE, bodyPos, bodyVel, body->orbitPtr);
+		pos += bodyPos;
+		vel += bodyVel;
+	}
+}
+
+PlanetState SolarSystem::computeStateAt(const PlanetP& planet, double dateJDE, const PlanetP& observerPlanet, bool withLightTime) const
+{
+	PlanetState state;
+	state.lightTime = 0.;
+	computeHeliocentricStateAt(planet.data(), dateJDE, state.heliocentricPos, state.heliocentricVelocity);
+	if (!observerPlanet)
+	{
+		state.observerPos = state.heliocentricPos;
+		return state;
+	}
+
+	Vec3d obsPos, obsVel;
+	computeHeliocentricStateAt(observerPlanet.data(), dateJDE, obsPos, obsVel);
+	if (withLightTime && planet!=observerPlanet)
+	{
+		// Same single correction as computePositions().
+		state.lightTime = (state.heliocentricPos-obsPos).length() * (AU / (SPEED_OF_LIGHT * 86400.));
+		computeHeliocentricStateAt(planet.data(), dateJDE-state.lightTime, state.heliocentricPos, state.heliocentricVelocity);
+	}
+	state.observerPos = state.heliocentricPos-obsPos;
+	return state;
+}
+
 // Compute the transformation matrix for every elements of the solar system.
 // The elements have to be ordered hierarchically, eg. it's important to compute earth before moon.
 void SolarSystem::computeTransMatrices(double dateJDE, const Vec3d& observerPos)
@@ -1294,9 +1587,23 @@ void SolarSystem::draw(StelCore* core)
 			5.f+(core->getSkyDrawer()->getLimitMagnitude()-5.f)*1.2f) +(labelsAmount-3.f)*1.2f;
 
 	// Draw the elements
+	const Vec3d viewDirection = core->getMovementMgr()->getViewDirectionJ2000();
 	for (const auto& p : systemPlanets)
 	{
 		p->draw(core, maxMagLabel, planetNameFont);
+
+		// Load the textures and models of the selected planet first, then those close to the view direction.
+		if (p->hasPendingLoads())
+		{
+			float priority = StelJobMgr::PrioritySelected;
+			if (p!=selected)
+			{
+				Vec3d dir = p->getJ2000EquatorialPos(core);
+				dir.normalize();
+				priority = 0.5f*(1.f+static_cast<float>(dir*viewDirection));
+			}
+			p->setLoadPriority(priority);
+		}
 	}
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer() && getFlagPointer())
@@ -1400,6 +1707,23 @@ StelObjectP SolarSystem::searchByName(const QString& name) const
 	return StelObjectP();
 }
 
+quint64 SolarSystem::getObjectIndex(const StelObject* obj) const
+{
+	for (int i=0; i<systemPlanets.size(); ++i)
+	{
+		if (systemPlanets.at(i).data()==obj)
+			return static_cast<quint64>(i);
+	}
+	return InvalidObjectIndex;
+}
+
+StelObjectP SolarSystem::searchByObjectIndex(quint64 index) const
+{
+	if (index>=static_cast<quint64>(systemPlanets.size()))
+		return StelObjectP();
+	return qSharedPointerCast<StelObject>(systemPlanets.at(static_cast<int>(index)));
+}
+
 float SolarSystem::getPlanetVMagnitude(QString planetName, bool withExtinction) const
 {
 	PlanetP p = searchByEnglishName(planetName);
@@ -1706,6 +2030,41 @@ void SolarSystem::update(double deltaTime)
 	{
 		p->update((int)(deltaTime*1000));
 	}
+
+	updatePositionThrottling(StelApp::getInstance().getCore());
+}
+
+void SolarSystem::updatePositionThrottling(StelCore* core)
+{
+	const SphericalCap& viewport = core->getProjection(StelCore::FrameJ2000)->getBoundingCap();
+	const float limitMag = core->getSkyDrawer()->getLimitMagnitude();
+	const Vec3d obsPos = core->getObserverHeliocentricEclipticPos();
+	const double dateJDE = core->getJDE();
+	for (const auto& p : systemMinorBodies)
+	{
+		if (p->getParent()!=sun)
+			continue;
+		bool fullRate = !flagPositionThrottling || p==selected || p->orbitFader.getInterstate()>0.f;
+		if (!fullRate)
+		{
+			Vec3d pos = p->getJ2000EquatorialPos(core);
+			pos.normalize();
+			// Same limit as in Planet::draw().
+			fullRate = viewport.contains(pos) && p->getVMagnitude(core)-5.0f <= limitMag;
+		}
+		if (fullRate && p->getPositionThrottle()>0.)
+		{
+			// Don't wait for the next frame to show a body which becomes visible.
+			p->setPositionThrottle(0.);
+			double jde = dateJDE;
+			if (flagLightTravelTime)
+				jde -= (p->getHeliocentricEclipticPos()-obsPos).length() * (AU / (SPEED_OF_LIGHT * 86400.));
+			if (p->isPositionOutdated(jde))
+				p->computePosition(jde);
+		}
+		else if (!fullRate)
+			p->setPositionThrottle(positionThrottleInterval);
+	}
 }
 
 // is a lunar eclipse close at hand?
@@ -2392,6 +2751,8 @@ void SolarSystem::reloadPlanets()
 	}
 	systemPlanets.clear();
 	systemMinorBodies.clear();
+	keplerOrbitsDirty = true;
+	invalidateNameIndex();
 	// Memory leak? What's the proper way of cleaning shared pointers?
 
 	// Also delete Comet textures (loaded in loadPlanets()
@@ -2530,6 +2891,24 @@ QString SolarSystem::getOrbitColorStyle() const
 	return r;
 }
 
+const SolarSystem::SunOfDate& SolarSystem::getSunOfDate(const StelCore* core) const
+{
+	const double JDE = core->getJDE();
+	const Vec3d observerPos = core->getObserverHeliocentricEclipticPos();
+	if (JDE==sunOfDate.JDE && observerPos==sunOfDateObserverPos)
+		return sunOfDate;
+
+	sunOfDate.JDE = JDE;
+	sunOfDateObserverPos = observerPos;
+	sunOfDate.eclipticObliquity = earth->getRotObliquity(JDE);
+	StelUtils::rectToSphe(&sunOfDate.rightAscension, &sunOfDate.declination, sun->getEquinoxEquatorialPos(core));
+	double beta;
+	StelUtils::equToEcl(sunOfDate.rightAscension, sunOfDate.declination, sunOfDate.eclipticObliquity, &sunOfDate.eclipticLongitude, &beta);
+	if (sunOfDate.eclipticLongitude<0)
+		sunOfDate.eclipticLongitude += 2.0*M_PI;
+	return sunOfDate;
+}
+
 double SolarSystem::getEclipseFactor(const StelCore* core) const
 {
 	Vec3d Lp = getLightTimeSunPosition();  //sun->getEclipticPos();
@@ -2613,6 +2992,8 @@ bool SolarSystem::removeMinorPlanet(QString name)
 		orbits.removeOne(orbPtr);
 	systemPlanets.removeOne(candidate);
 	systemMinorBodies.removeOne(candidate);
+	keplerOrbitsDirty = true;
+	invalidateNameIndex();
 	candidate.clear();
 	return true;
 }
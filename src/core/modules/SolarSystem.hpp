@@ -28,10 +28,12 @@
 #include "StelObjectModule.hpp"
 #include "StelTextureTypes.hpp"
 #include "Planet.hpp"
+#include "Orbit.hpp"
 #include "StelGui.hpp"
 #include "StelHips.hpp"
 
 #include <QFont>
+#include <QtNumeric>
 
 class Orbit;
 class StelTranslator;
@@ -42,6 +44,16 @@ class QSettings;
 
 typedef QSharedPointer<Planet> PlanetP;
 
+//! @struct PlanetState
+//! Position and velocity of a solar system body computed by SolarSystem::computeStateAt().
+struct PlanetState
+{
+	Vec3d heliocentricPos;		//!< heliocentric ecliptical J2000 (VSOP87A) position [AU]
+	Vec3d heliocentricVelocity;	//!< heliocentric velocity [AU/d], as far as the theory of the body provides it
+	Vec3d observerPos;		//!< position relative to the observer [AU]
+	double lightTime;		//!< light time from the body to the observer [days], 0 when not corrected
+};
+
 //! @class SolarSystem
 //! This StelObjectModule derivative is used to model SolarSystem bodies.
 //! This includes the Major Planets, Minor Planets and Comets.
@@ -327,6 +339,10 @@ public:
 	//! This includes planet motion trails.
 	virtual void update(double deltaTime);
 
+	//! Compute the positions of the orbits of keplerOrbits for the next frame, which the next
+	//! computePositions() uses if it is called for nextJDE.
+	virtual void prepareNextFrame(double nextJDE);
+
 	//! Used to determine what order to draw the various StelModules.
 	virtual double getCallOrder(StelModuleActionName actionName) const;
 
@@ -357,6 +373,11 @@ public:
 		return searchByName(id);
 	}
 
+	//! The index of a body in object handles is its position in getAllPlanets(),
+	//! so handles become invalid when minor bodies are reloaded.
+	virtual quint64 getObjectIndex(const StelObject* obj) const Q_DECL_OVERRIDE;
+	virtual StelObjectP searchByObjectIndex(quint64 index) const Q_DECL_OVERRIDE;
+
 	virtual QStringList listAllObjects(bool inEnglish) const;
 	virtual QStringList listAllObjectsByType(const QString& objType, bool inEnglish) const;
 	virtual QString getName() const { return "Solar System"; }
@@ -911,10 +932,38 @@ public:
 	//! Determines relative amount of sun visible from the observer's position.
 	double getEclipseFactor(const StelCore *core) const;
 
+	//! The apparent coordinates of the Sun of date for the current observer, see getSunOfDate().
+	struct SunOfDate
+	{
+		SunOfDate() : JDE(qQNaN()), eclipticObliquity(0.), eclipticLongitude(0.), rightAscension(0.), declination(0.) {}
+		double JDE;
+		double eclipticObliquity;	// [rad]
+		double eclipticLongitude;	// [rad], in [0, 2pi[
+		double rightAscension;		// [rad]
+		double declination;		// [rad]
+	};
+	//! Get the apparent coordinates of the Sun of date for the current observer.
+	//! They are computed once per date and observer position, and shared by the solar lines and points of
+	//! GridLinesMgr and by plugins like ArchaeoLines, which would otherwise each compute them in every frame.
+	const SunOfDate& getSunOfDate(const StelCore* core) const;
+
 	//! Compute the position and transform matrix for every element of the solar system.
 	//! @param dateJDE the Julian Day in JDE (Ephemeris Time or equivalent)	
 	//! @param observerPlanet planet of the observer (Required for light travel time or aberration computation).
-	void computePositions(double dateJDE, PlanetP observerPlanet);
+	//! @param allowThrottling skip the update of minor bodies which are not visible, see updatePositionThrottling().
+	//! This must be false for all computations which need exact positions, e.g. ephemerides.
+	void computePositions(double dateJDE, PlanetP observerPlanet, bool allowThrottling=false);
+
+	//! Compute the position and velocity of a body without changing any Planet object.
+	//! Unlike computePositions(), this does not touch the positions or matrices used for drawing,
+	//! and can be called from any thread, e.g. for ephemerides computed in the background.
+	//! @param planet the body
+	//! @param dateJDE the Julian Day in JDE (Ephemeris Time or equivalent)
+	//! @param observerPlanet planet of the observer, or Q_NULLPTR for heliocentric coordinates.
+	//! An observer without theory, like the spaceship used for transitions, is taken at its current position.
+	//! @param withLightTime correct the position of the body for light time, like computePositions() does
+	//! when light travel time is enabled. The observer is taken at dateJDE.
+	PlanetState computeStateAt(const PlanetP& planet, double dateJDE, const PlanetP& observerPlanet=PlanetP(), bool withLightTime=true) const;
 
 	//! Get the list of all the bodies of the solar system.	
 	const QList<PlanetP>& getAllPlanets() const {return systemPlanets;}
@@ -954,6 +1003,21 @@ private slots:
 	void onNewSurvey(HipsSurveyP survey);
 
 private:
+	//! Rebuild keplerOrbits, keplerOrbitBodies and otherBodies from systemPlanets.
+	void updateKeplerOrbits();
+	//! Sum the positions and velocities of p and its parents at dateJDE, without changing any Planet object.
+	static void computeHeliocentricStateAt(const Planet* p, double dateJDE, Vec3d& pos, Vec3d& vel);
+	//! Compute the positions of the bodies of keplerOrbitBodies with keplerOrbits.
+	//! Bodies whose position is up to date (see Planet::isPositionOutdated()) are skipped.
+	//! @param dates the JDE for which the position of each body is computed
+	//! @param allowThrottling also skip bodies for which Planet::isPositionThrottled() is true
+	void computeKeplerOrbitPositions(const QVector<double>& dates, bool allowThrottling);
+	//! Decide which minor bodies get full-rate position updates.
+	//! Minor bodies around the Sun which are outside of the viewport or too faint to be drawn are
+	//! updated at most once per positionThrottleInterval, as long as they are not selected and their
+	//! orbit is not displayed. A body which needs full-rate updates again is recomputed at once.
+	void updatePositionThrottling(StelCore* core);
+
 	//! Search for SolarSystem objects which are close to the position given
 	//! in earth equatorial position.
 	//! @param v A position in earth equatorial position.
@@ -1020,9 +1084,30 @@ private:
 	//! List of all the minor bodies of the solar system.
 	QList<PlanetP> systemMinorBodies;
 
+	//! Elliptical orbits around the Sun, propagated together by computePositions().
+	KeplerOrbitBatch keplerOrbits;
+	//! The body of each orbit of keplerOrbits.
+	QVector<Planet*> keplerOrbitBodies;
+	//! The bodies of systemPlanets which are not in keplerOrbitBodies, in the same order.
+	QVector<Planet*> otherBodies;
+	//! Whether systemPlanets changed since the last call to updateKeplerOrbits().
+	bool keplerOrbitsDirty;
+	//! JDE of preparedPositions, computed by prepareNextFrame() for keplerOrbits. NaN if there are none.
+	double preparedJDE;
+	QVector<Vec3d> preparedPositions;
+	QVector<Vec3d> preparedVelocities;
+
 	// Master settings
 	bool flagOrbits;
 	bool flagLightTravelTime;
+	//! Compute the positions of minor bodies orbiting the Sun on the global thread pool
+	bool flagParallelPositions;
+	//! Propagate the elliptical orbits of minor bodies around the Sun together with keplerOrbits
+	bool flagBatchedOrbits;
+	//! Update the positions of minor bodies which are not visible at a lower rate
+	bool flagPositionThrottling;
+	//! Minimal interval between the position updates of minor bodies which are not visible [days]
+	double positionThrottleInterval;
 	bool flagUseObjModels;
 	bool flagShowObjSelfShadows;
 
@@ -1051,6 +1136,10 @@ private:
 	QHash<QString, QString> planetNativeNamesMap;
 	QStringList minorBodies;
 
+	//! The cache of getSunOfDate(), and the observer position for which it was computed
+	mutable SunOfDate sunOfDate;
+	mutable Vec3d sunOfDateObserverPos;
+
 	Vec3d lightTimeSunPosition;			// when observing a solar eclipse, we need solar position 8 minutes ago.
 							// Direct shift caused problems (LP:#1699648), circumvented with this construction.
 	// 0.16pre observation GZ: this list contains pointers to all orbit objects,
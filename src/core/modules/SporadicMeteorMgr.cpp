@@ -26,11 +26,13 @@
 #include "StelModuleMgr.hpp"
 #include "StelPainter.hpp"
 #include "StelTextureMgr.hpp"
+#include "StelUtils.hpp"
 
 #include <QSettings>
 
 SporadicMeteorMgr::SporadicMeteorMgr(int zhr, int maxv)
-	: m_zhr(zhr)
+	: m_schedule(MeteorSchedule::seedFromName("SporadicMeteorMgr"))
+	, m_zhr(zhr)
 	, m_maxVelocity(maxv)
 	, m_flagShow(true)
 	, m_flagForcedShow(false)
@@ -40,8 +42,6 @@ SporadicMeteorMgr::SporadicMeteorMgr(int zhr, int maxv)
 
 SporadicMeteorMgr::~SporadicMeteorMgr()
 {
-	qDeleteAll(activeMeteors);
-	activeMeteors.clear();
 	m_bolideTexture.clear();
 }
 
@@ -50,6 +50,7 @@ void SporadicMeteorMgr::init()
 	m_bolideTexture = StelApp::getInstance().getTextureManager().createTextureThread(
 				StelFileMgr::getInstallationDir() + "/textures/cometComa.png",
 				StelTexture::StelTextureParams(true, GL_LINEAR, GL_CLAMP_TO_EDGE));
+	m_meteors.setBolideTexture(m_bolideTexture);
 
 	QSettings* conf = StelApp::getInstance().getSettings();
 	setZHR(conf->value("astro/meteor_zhr", 10).toInt());
@@ -72,50 +73,26 @@ void SporadicMeteorMgr::update(double deltaTime)
 		return;
 	}
 
-	// step through and update all active meteors
-	foreach (SporadicMeteor* m, activeMeteors)
-	{
-		if (!m->update(deltaTime))
-		{
-			//important to delete when no longer active
-			activeMeteors.removeOne(m);
-			delete m;
-		}
-	}
-
 	StelCore* core = StelApp::getInstance().getCore();
 
-	// going forward/backward OR current ZHR is zero ?
+	// going forward/backward ?
 	// don't create new meteors
-	if(!core->getRealTimeSpeed() || m_zhr < 1)
-	{
-		return;
-	}
-
-	// average meteors per frame
-	float mpf = m_zhr * deltaTime / 3600.f;
-
-	// maximum amount of meteors for the current frame
-	int maxMpf = qRound(mpf);
-	maxMpf = maxMpf < 1 ? 1 : maxMpf;
-
-	float rate = mpf / (float) maxMpf;
-	for (int i = 0; i < maxMpf; ++i)
+	if (core->getRealTimeSpeed())
 	{
-		float prob = (float) qrand() / (float) RAND_MAX;
-		if (prob < rate)
+		const int zhr = m_zhr;
+		m_schedule.advance(core->getJD(), [zhr](double) { return zhr; }, m_newEvents);
+		for (const auto& event : m_newEvents)
 		{
-			SporadicMeteor* m = new SporadicMeteor(core, m_maxVelocity, m_bolideTexture);
-			if (m->isAlive())
-			{
-				activeMeteors.append(m);
-			}
-			else
-			{
-				delete m;
-			}
+			spawnMeteor(core, event);
 		}
 	}
+	else
+	{
+		m_schedule.reset();
+	}
+
+	// update all active meteors
+	m_meteors.update(core, deltaTime);
 }
 
 void SporadicMeteorMgr::draw(StelCore* core)
@@ -131,12 +108,60 @@ void SporadicMeteorMgr::draw(StelCore* core)
 		return;
 	}
 
-	// step through and draw all active meteors
+	// draw all active meteors
 	StelPainter sPainter(core->getProjection(StelCore::FrameAltAz));
-	for (auto* m: activeMeteors)
+	m_meteors.draw(core, sPainter);
+}
+
+void SporadicMeteorMgr::spawnMeteor(const StelCore* core, const MeteorSchedule::Event& event)
+{
+	MeteorSchedule::Random rnd(event.seed);
+
+	// meteor velocity
+	// (see line 460 in StelApp.cpp)
+	float speed = 11 + (m_maxVelocity - 11) * rnd.uniform(); // [11, maxVel]
+
+	// select a random radiant in a visible area
+	float rAlt = M_PI_2 * rnd.uniform();  // [0, pi/2]
+	float rAz = 2 * M_PI * rnd.uniform();  // [0, 2pi]
+	Vec3d pos;
+	StelUtils::spheToRect(rAz, rAlt, pos);
+
+	// convert to J2000
+	float rAlpha, rDelta;
+	pos = core->altAzToJ2000(pos);
+	StelUtils::rectToSphe(&rAlpha, &rDelta, pos);
+
+	m_meteors.spawn(core, event.jd, rnd, rAlpha, rDelta, speed, getRandColor(rnd));
+}
+
+QList<MeteorPool::ColorPair> SporadicMeteorMgr::getRandColor(MeteorSchedule::Random& rnd)
+{
+	QList<MeteorPool::ColorPair> colors;
+	float prob = rnd.uniform();
+	if (prob > 0.9f)
 	{
-		m->draw(core, sPainter);
+		colors.push_back(MeteorPool::ColorPair("white", 70));
+		colors.push_back(MeteorPool::ColorPair("orangeYellow", 10));
+		colors.push_back(MeteorPool::ColorPair("yellow", 10));
+		colors.push_back(MeteorPool::ColorPair("blueGreen", 10));
 	}
+	else if (prob > 0.85f)
+	{
+		colors.push_back(MeteorPool::ColorPair("white", 80));
+		colors.push_back(MeteorPool::ColorPair("violet", 20));
+	}
+	else if (prob > 0.80f)
+	{
+		colors.push_back(MeteorPool::ColorPair("white", 80));
+		colors.push_back(MeteorPool::ColorPair("orangeYellow", 20));
+	}
+	else
+	{
+		colors.push_back(MeteorPool::ColorPair("white", 100));
+	}
+
+	return colors;
 }
 
 void SporadicMeteorMgr::setZHR(int zhr)
@@ -144,6 +169,7 @@ void SporadicMeteorMgr::setZHR(int zhr)
 	if(zhr!=m_zhr)
 	{
 		m_zhr = zhr;
+		m_schedule.clear();
 		emit zhrChanged(zhr);
 	}
 }
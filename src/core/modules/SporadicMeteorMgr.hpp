@@ -20,7 +20,7 @@
 #ifndef SPORADICMETEORMGR_HPP
 #define SPORADICMETEORMGR_HPP
 
-#include "SporadicMeteor.hpp"
+#include "MeteorPool.hpp"
 #include "StelModule.hpp"
 
 //! @class SporadicMeteorMgr
@@ -69,7 +69,13 @@ signals:
 	void zhrChanged(int);
 
 private:
-	QList<SporadicMeteor*> activeMeteors;
+	//! Create a meteor with a random radiant in the visible sky and a random color
+	void spawnMeteor(const StelCore* core, const MeteorSchedule::Event& event);
+	static QList<MeteorPool::ColorPair> getRandColor(MeteorSchedule::Random& rnd);
+
+	MeteorSchedule m_schedule;
+	QVector<MeteorSchedule::Event> m_newEvents;
+	MeteorPool m_meteors;
 	StelTextureSP m_bolideTexture;
 	int m_zhr;
 	int m_maxVelocity;
@@ -0,0 +1,249 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StarCatalogStream.hpp"
+#include "ZoneArray.hpp"
+#include "StelApp.hpp"
+#include "StelGeodesicGrid.hpp"
+#include "StelUtils.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSettings>
+#include <QtEndian>
+
+#include <cstring>
+
+// magic, type, major, minor, level, mag_min, mag_range, mag_steps
+static const int CATALOG_HEADER_SIZE = 8*sizeof(quint32);
+
+//! Get the level of a catalog from its header, or -1 if it cannot be streamed.
+static int getCatalogLevel(const QByteArray& header)
+{
+	if (header.size() < CATALOG_HEADER_SIZE)
+		return -1;
+	quint32 magic, type, level;
+	memcpy(&magic, header.constData(), sizeof(quint32));
+	memcpy(&type, header.constData() + sizeof(quint32), sizeof(quint32));
+	memcpy(&level, header.constData() + 4*sizeof(quint32), sizeof(quint32));
+	if (magic == FILE_MAGIC_OTHER_ENDIAN)
+	{
+		type = qbswap(type);
+		level = qbswap(level);
+	}
+	else if (magic != FILE_MAGIC && magic != FILE_MAGIC_NATIVE)
+		return -1;
+	// Only faint star catalogs are loaded lazily
+	if ((type != 1 && type != 2) || level > 12)
+		return -1;
+	return level;
+}
+
+StarCatalogStream::StarCatalogStream(const QUrl& url, const QString& cacheFilePath, QObject* parent)
+	: QObject(parent)
+	, url(url)
+	, cacheFile(cacheFilePath)
+	, zonesFile(cacheFilePath + ".zones")
+	, level(-1)
+	, headerReply(Q_NULLPTR)
+{
+	QSettings* conf = StelApp::getInstance().getSettings();
+	maxRequests = qMax(1, conf->value("stars/remote_catalog_max_requests", 6).toInt());
+	maxQueueSize = qMax(1, conf->value("stars/remote_catalog_max_queue", 256).toInt());
+}
+
+StarCatalogStream::~StarCatalogStream()
+{
+	for (auto* reply : replies)
+	{
+		reply->abort();
+		reply->deleteLater();
+	}
+	replies.clear();
+	if (headerReply)
+	{
+		headerReply->abort();
+		headerReply->deleteLater();
+		headerReply = Q_NULLPTR;
+	}
+}
+
+bool StarCatalogStream::open()
+{
+	if (isReady())
+		return true;
+	if (!cacheFile.exists() || !zonesFile.open(QIODevice::ReadWrite | QIODevice::Unbuffered))
+		return false;
+	zonePresent = zonesFile.readAll();
+	if (!cacheFile.open(QIODevice::ReadWrite | QIODevice::Unbuffered))
+	{
+		zonesFile.close();
+		return false;
+	}
+	level = getCatalogLevel(cacheFile.read(CATALOG_HEADER_SIZE));
+	if (level < 0 || zonePresent.size() != StelGeodesicGrid::nrOfZones(level))
+	{
+		qWarning() << "Invalid star catalog cache" << QDir::toNativeSeparators(cacheFile.fileName());
+		cacheFile.close();
+		zonesFile.close();
+		zonePresent.clear();
+		level = -1;
+		return false;
+	}
+	return true;
+}
+
+QNetworkReply* StarCatalogStream::get(qint64 offset, qint64 bytes)
+{
+	QNetworkRequest req(url);
+	req.setRawHeader("Range", QString("bytes=%1-%2").arg(offset).arg(offset+bytes-1).toLatin1());
+	req.setRawHeader("User-Agent", StelUtils::getUserAgentString().toLatin1());
+	// Zones are cached in the local copy of the catalog, not in the network cache
+	req.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+	req.setAttribute(QNetworkRequest::CacheSaveControlAttribute, false);
+	return StelApp::getInstance().getNetworkAccessManager()->get(req);
+}
+
+void StarCatalogStream::fetchHeader()
+{
+	if (headerReply || isReady())
+		return;
+	qDebug() << "Downloading star catalog header from" << url.toString();
+	headerReply = get(0, CATALOG_HEADER_SIZE);
+	connect(headerReply, &QNetworkReply::finished, this, &StarCatalogStream::headerFinished);
+}
+
+void StarCatalogStream::headerFinished()
+{
+	QNetworkReply* reply = headerReply;
+	headerReply = Q_NULLPTR;
+	reply->deleteLater();
+	if (reply->error() != QNetworkReply::NoError)
+	{
+		qWarning() << "Cannot download star catalog header from" << url.toString() << ":" << reply->errorString();
+		return;
+	}
+	header = reply->read(CATALOG_HEADER_SIZE);
+	const int lev = getCatalogLevel(header);
+	if (lev < 0)
+	{
+		qWarning() << "Not a faint star catalog:" << url.toString();
+		return;
+	}
+	headerReply = get(CATALOG_HEADER_SIZE, sizeof(quint32)*StelGeodesicGrid::nrOfZones(lev));
+	connect(headerReply, &QNetworkReply::finished, this, &StarCatalogStream::zoneSizesFinished);
+}
+
+void StarCatalogStream::zoneSizesFinished()
+{
+	QNetworkReply* reply = headerReply;
+	headerReply = Q_NULLPTR;
+	reply->deleteLater();
+	const int nrOfZones = StelGeodesicGrid::nrOfZones(getCatalogLevel(header));
+	const QByteArray zoneSizes = reply->readAll();
+	if (reply->error() != QNetworkReply::NoError || zoneSizes.size() != (int)sizeof(quint32)*nrOfZones)
+	{
+		qWarning() << "Cannot download star catalog zones from" << url.toString() << ":" << reply->errorString();
+		return;
+	}
+
+	QFile file(cacheFile.fileName());
+	QFile zones(zonesFile.fileName());
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(header) != header.size()
+	    || file.write(zoneSizes) != zoneSizes.size()
+	    || !zones.open(QIODevice::WriteOnly | QIODevice::Truncate) || zones.write(QByteArray(nrOfZones, 0)) != nrOfZones)
+	{
+		qWarning() << "Cannot write star catalog cache" << QDir::toNativeSeparators(file.fileName());
+		file.close();
+		zones.close();
+		file.remove();
+		zones.remove();
+		return;
+	}
+	file.close();
+	zones.close();
+	if (open())
+		emit headerReady();
+}
+
+void StarCatalogStream::requestZone(int index, qint64 offset, qint64 bytes)
+{
+	if (!isReady() || hasZone(index) || requested.contains(index) || failed.contains(index))
+		return;
+	if (queue.size() >= maxQueueSize)
+	{
+		// The oldest requests are probably not in view anymore
+		requested.remove(queue.takeFirst().index);
+	}
+	ZoneRequest request;
+	request.index = index;
+	request.offset = offset;
+	request.bytes = bytes;
+	queue.append(request);
+	requested.insert(index);
+	startRequests();
+}
+
+void StarCatalogStream::startRequests()
+{
+	while (replies.size() < maxRequests && !queue.isEmpty())
+	{
+		const ZoneRequest request = queue.takeLast();
+		QNetworkReply* reply = get(request.offset, request.bytes);
+		replies.insert(reply);
+		connect(reply, &QNetworkReply::finished, this, [this, reply, request] {
+			zoneFinished(reply, request);
+		});
+	}
+}
+
+void StarCatalogStream::zoneFinished(QNetworkReply* reply, const ZoneRequest& request)
+{
+	replies.remove(reply);
+	reply->deleteLater();
+	requested.remove(request.index);
+	const QByteArray data = reply->readAll();
+	if (reply->error() != QNetworkReply::NoError || data.size() != request.bytes)
+	{
+		// A server which ignores the range returns the whole file
+		qWarning() << "Cannot download zone" << request.index << "of" << url.toString() << ":"
+			   << (reply->error() != QNetworkReply::NoError ? reply->errorString() : QString("unexpected size %1").arg(data.size()));
+		failed.insert(request.index);
+	}
+	else if (!cacheFile.seek(request.offset) || cacheFile.write(data) != data.size()
+		 || !zonesFile.seek(request.index) || zonesFile.write("\1", 1) != 1)
+	{
+		qWarning() << "Cannot write zone" << request.index << "to" << QDir::toNativeSeparators(cacheFile.fileName())
+			   << ":" << cacheFile.errorString();
+		failed.insert(request.index);
+	}
+	else
+		zonePresent[request.index] = 1;
+	startRequests();
+}
+
+bool StarCatalogStream::readZone(int index, qint64 offset, char* data, qint64 bytes)
+{
+	if (!hasZone(index) || !cacheFile.seek(offset))
+		return false;
+	return cacheFile.read(data, bytes) == bytes;
+}
@@ -0,0 +1,114 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STARCATALOGSTREAM_HPP
+#define STARCATALOGSTREAM_HPP
+
+#include <QObject>
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QSet>
+#include <QUrl>
+
+class QNetworkReply;
+
+//! @class StarCatalogStream
+//! Downloads the zones of a star catalog from a HTTP server on demand.
+//! The server only has to provide the catalog file as it is distributed, zones are
+//! fetched with range requests. They are stored in a sparse local copy of the catalog
+//! with the same layout, so that ZoneArray can read them back in lazy mode, and
+//! a companion file records which zones were downloaded.
+class StarCatalogStream : public QObject
+{
+	Q_OBJECT
+public:
+	//! @param url URL of the catalog file on the server
+	//! @param cacheFilePath path of the local copy of the catalog
+	StarCatalogStream(const QUrl& url, const QString& cacheFilePath, QObject* parent=Q_NULLPTR);
+	~StarCatalogStream();
+
+	//! Open the local copy of the catalog.
+	//! @return false if its header was not downloaded yet
+	bool open();
+
+	//! Download the header and the table of zone sizes of the catalog.
+	//! headerReady() is emitted once the local copy can be opened.
+	void fetchHeader();
+
+	//! Get whether the header is available, i.e. open() succeeded.
+	bool isReady() const {return cacheFile.isOpen();}
+
+	//! Get the level of the catalog in StelGeodesicGrid, or -1 if the header is not available yet.
+	int getLevel() const {return level;}
+
+	QString getCacheFilePath() const {return cacheFile.fileName();}
+
+	//! Get whether the stars of a zone are available in the local copy.
+	bool hasZone(int index) const {return index>=0 && index<zonePresent.size() && zonePresent.at(index);}
+
+	//! Queue the download of the stars of a zone, unless it is already queued.
+	//! Zones requested last are downloaded first, as they are the ones the user looks at.
+	//! @param index zone index
+	//! @param offset position of its stars in the catalog file
+	//! @param bytes size of its stars
+	void requestZone(int index, qint64 offset, qint64 bytes);
+
+	//! Read the stars of a zone from the local copy.
+	//! @return false if the zone is not available or cannot be read
+	bool readZone(int index, qint64 offset, char* data, qint64 bytes);
+
+signals:
+	void headerReady();
+
+private:
+	struct ZoneRequest
+	{
+		int index;
+		qint64 offset;
+		qint64 bytes;
+	};
+
+	//! Send a range request for the given bytes of the catalog file.
+	QNetworkReply* get(qint64 offset, qint64 bytes);
+	//! Process the reply with the first bytes of the catalog, then fetch the table of zone sizes.
+	void headerFinished();
+	//! Write the header and the table of zone sizes into a new local copy.
+	void zoneSizesFinished();
+	void zoneFinished(QNetworkReply* reply, const ZoneRequest& request);
+	//! Start queued downloads as long as fewer than maxRequests are running.
+	void startRequests();
+
+	QUrl url;
+	QFile cacheFile;
+	QFile zonesFile;		// one byte per zone, non zero if the zone was downloaded
+	QByteArray zonePresent;
+	QByteArray header;
+	int level;
+
+	QNetworkReply* headerReply;
+	QList<ZoneRequest> queue;
+	QSet<int> requested;		// queued or downloading
+	QSet<int> failed;
+	QSet<QNetworkReply*> replies;
+	int maxRequests;
+	int maxQueueSize;
+};
+
+#endif // STARCATALOGSTREAM_HPP
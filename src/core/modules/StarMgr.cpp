@@ -42,6 +42,9 @@
 #include "StelPainter.hpp"
 #include "StelJsonParser.hpp"
 #include "ZoneArray.hpp"
+#include "StarWrapper.hpp"
+#include "StarZoneRenderer.hpp"
+#include "StarCatalogStream.hpp"
 #include "StelSkyDrawer.hpp"
 #include "RefractionExtinction.hpp"
 #include "StelModuleMgr.hpp"
@@ -56,7 +59,13 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QCryptographicHash>
+#include <QThreadPool>
+#include <QMutexLocker>
+#include <QtConcurrent>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <errno.h>
 
 static QStringList spectral_array;
@@ -78,6 +87,10 @@ QMap<QString,int> StarMgr::commonNamesIndexI18n;
 QMap<QString,int> StarMgr::commonNamesIndex;
 QMap<QString,int> StarMgr::additionalNamesIndex;
 QMap<QString,int> StarMgr::additionalNamesIndexI18n;
+StelObjectNameIndex StarMgr::commonNamesSearchIndex[2];
+StelObjectNameIndex StarMgr::additionalNamesSearchIndex[2];
+QMutex StarMgr::namesSearchIndexMutex;
+QHash<QString, StarMgr::NamesI18n> StarMgr::namesI18nCache;
 QHash<int,QString> StarMgr::sciNamesMapI18n;
 QMap<QString,int> StarMgr::sciNamesIndexI18n;
 QHash<int,QString> StarMgr::sciAdditionalNamesMapI18n;
@@ -86,10 +99,10 @@ QHash<int, varstar> StarMgr::varStarsMapI18n;
 QMap<QString, int> StarMgr::varStarsIndexI18n;
 QHash<int, wds> StarMgr::wdsStarsMapI18n;
 QMap<QString, int> StarMgr::wdsStarsIndexI18n;
-QMap<QString, crossid> StarMgr::crossIdMap;
-QMap<int, int> StarMgr::saoStarsIndex;
-QMap<int, int> StarMgr::hdStarsIndex;
-QMap<int, int> StarMgr::hrStarsIndex;
+QVector<crossid> StarMgr::crossIdData;
+QVector<catalognumber> StarMgr::saoStarsIndex;
+QVector<catalognumber> StarMgr::hdStarsIndex;
+QVector<catalognumber> StarMgr::hrStarsIndex;
 QHash<int, QString> StarMgr::referenceMap;
 
 QStringList initStringListFromFile(const QString& file_name)
@@ -140,6 +153,10 @@ StarMgr::StarMgr(void)
 	: flagStarName(false)	
 	, labelsAmount(0.)
 	, gravityLabel(false)
+	, zoneRenderer(Q_NULLPTR)
+	, flagParallelZones(true)
+	, trianglesInitialized(false)
+	, deferredLazyBudget(0)
 	, hipIndex(new HipIndexStruct[NR_OF_HIP+1])
 {
 	setObjectName("StarMgr");
@@ -162,6 +179,10 @@ double StarMgr::getCallOrder(StelModuleActionName actionName) const
 
 StarMgr::~StarMgr(void)
 {
+	delete zoneRenderer;
+	zoneRenderer = Q_NULLPTR;
+	qDeleteAll(remoteCatalogs);
+	remoteCatalogs.clear();
 	for (auto* z : gridLevels)
 		delete z;
 	gridLevels.clear();
@@ -172,8 +193,9 @@ StarMgr::~StarMgr(void)
 // Allow untranslated name here if set in constellationMgr!
 QString StarMgr::getCommonName(int hip)
 {
+	// ConstellationMgr is not loaded in batch mode
 	ConstellationMgr* cmgr=GETSTELMODULE(ConstellationMgr);
-	if (cmgr->getConstellationDisplayStyle() == ConstellationMgr::constellationsNative)
+	if (cmgr && cmgr->getConstellationDisplayStyle() == ConstellationMgr::constellationsNative)
 		return getCommonEnglishName(hip);
 
 	auto it = commonNamesMapI18n.find(hip);
@@ -226,30 +248,41 @@ QString StarMgr::getSciAdditionalName(int hip)
 QString StarMgr::getCrossIdentificationDesignations(QString hip)
 {
 	QString designations;
-	auto cr = crossIdMap.find(hip);
-	if (cr==crossIdMap.end() && hip.right(1).toUInt()==0)
-		cr = crossIdMap.find(hip.left(hip.size()-1));
+	int digits = 0;
+	while (digits<hip.size() && hip.at(digits).isDigit())
+		++digits;
+	crossid key;
+	key.hip = hip.left(digits).toUInt();
+	key.component = packComponentIds(hip.mid(digits));
+	auto lessThan = [](const crossid& a, const crossid& b) { return a.hip<b.hip || (a.hip==b.hip && a.component<b.component); };
+	auto cr = std::lower_bound(crossIdData.constBegin(), crossIdData.constEnd(), key, lessThan);
+	if ((cr==crossIdData.constEnd() || cr->hip!=key.hip || cr->component!=key.component) && key.component!=0)
+	{
+		// Fall back to the data of the primary component
+		key.component = 0;
+		cr = std::lower_bound(crossIdData.constBegin(), crossIdData.constEnd(), key, lessThan);
+	}
 
-	if (cr!=crossIdMap.end())
+	if (cr!=crossIdData.constEnd() && cr->hip==key.hip && cr->component==key.component)
 	{
-		crossid crossIdData = cr.value();
-		if (crossIdData.sao>0)
-			designations = QString("SAO %1").arg(crossIdData.sao);
+		const crossid& crossIdRecord = *cr;
+		if (crossIdRecord.sao>0)
+			designations = QString("SAO %1").arg(crossIdRecord.sao);
 
-		if (crossIdData.hd>0)
+		if (crossIdRecord.hd>0)
 		{
 			if (designations.isEmpty())
-				designations = QString("HD %1").arg(crossIdData.hd);
+				designations = QString("HD %1").arg(crossIdRecord.hd);
 			else
-				designations += QString(" - HD %1").arg(crossIdData.hd);
+				designations += QString(" - HD %1").arg(crossIdRecord.hd);
 		}
 
-		if (crossIdData.hr>0)
+		if (crossIdRecord.hr>0)
 		{
 			if (designations.isEmpty())
-				designations = QString("HR %1").arg(crossIdData.hr);
+				designations = QString("HR %1").arg(crossIdRecord.hr);
 			else
-				designations += QString(" - HR %1").arg(crossIdData.hr);
+				designations += QString(" - HR %1").arg(crossIdRecord.hr);
 		}
 	}
 
@@ -420,6 +453,14 @@ void StarMgr::init()
 		}
 	}
 
+	// Positions of stars with proper motion applied are reused while the simulation time
+	// stays within this number of days of their epoch. Negative values disable the cache.
+	ZoneArray::setPositionCacheParams(conf->value("stars/position_cache_epoch_tolerance", 1.0).toDouble(),
+					  conf->value("stars/position_cache_max_stars", 2000000).toInt());
+
+	// Zones are independent, so with several cores they are projected and searched in parallel
+	flagParallelZones = conf->value("stars/flag_parallel_zone_iteration", true).toBool();
+
 	loadData(starSettings);
 
 	populateStarsDesignations();
@@ -443,6 +484,11 @@ void StarMgr::init()
 	StelApp::getInstance().getCore()->getGeodesicGrid(maxGeodesicGridLevel)->visitTriangles(maxGeodesicGridLevel,initTriangleFunc,this);
 	for (auto* z : gridLevels)
 		z->scaleAxis();
+	trianglesInitialized = true;
+
+	zoneRenderer = new StarZoneRenderer();
+	zoneRenderer->init();
+
 	StelApp *app = &StelApp::getInstance();
 	connect(app, SIGNAL(languageChanged()), this, SLOT(updateI18n()));
 	connect(&app->getSkyCultureMgr(), SIGNAL(currentSkyCultureChanged(QString)), this, SLOT(updateSkyCulture(const QString&)));
@@ -478,30 +524,39 @@ void StarMgr::drawPointer(StelPainter& sPainter, const StelCore* core)
 }
 
 bool StarMgr::checkAndLoadCatalog(const QVariantMap& catDesc)
+{
+	// Levels are added in order, after the ones which are still loading
+	StelApp::getInstance().getModuleMgr().waitUntilReady(this);
+
+	QString catalogFileName;
+	bool installed;
+	const QString catalogFilePath = findCatalogFile(catDesc, catalogFileName, installed);
+	if (!installed)
+		return loadMissingCatalog(catDesc, catalogFileName);
+	if (catalogFilePath.isEmpty())
+		return false;
+	addCatalog(openCatalog(catalogFilePath, getLazyLoadingBudget()), catalogFileName);
+	return true;
+}
+
+QString StarMgr::findCatalogFile(const QVariantMap& catDesc, QString& catalogFileName, bool& installed)
 {
 	const bool checked = catDesc.value("checked").toBool();
-	QString catalogFileName = catDesc.value("fileName").toString();
+	catalogFileName = catDesc.value("fileName").toString();
 
 	// See if it is an absolute path, else prepend default path
 	if (!(StelFileMgr::isAbsolute(catalogFileName)))
 		catalogFileName = "stars/default/"+catalogFileName;
 
 	QString catalogFilePath = StelFileMgr::findFile(catalogFileName);
-	if (catalogFilePath.isEmpty())
-	{
-		// The file is supposed to be checked, but we can't find it
-		if (checked)
-		{
-			qWarning() << QString("Warning: could not find star catalog %1").arg(QDir::toNativeSeparators(catalogFileName));
-			setCheckFlag(catDesc.value("id").toString(), false);
-		}
-		return false;
-	}
+	installed = !catalogFilePath.isEmpty();
+	if (!installed)
+		return QString();
 	// Possibly fixes crash on Vista
 	if (!StelFileMgr::isReadable(catalogFilePath))
 	{
 		qWarning() << QString("Warning: User does not have permissions to read catalog %1").arg(QDir::toNativeSeparators(catalogFilePath));
-		return false;
+		return QString();
 	}
 
 	if (!checked)
@@ -539,28 +594,206 @@ bool StarMgr::checkAndLoadCatalog(const QVariantMap& catDesc)
 			{
 				qWarning() << "Error: File " << QDir::toNativeSeparators(catalogFileName) << " is corrupt, MD5 mismatch! Found " << md5Hash.result().toHex() << " expected " << catDesc.value("checksum").toByteArray();
 				file.remove();
-				return false;
+				return QString();
 			}
 			qWarning() << "MD5 sum correct!";
 			setCheckFlag(catDesc.value("id").toString(), true);
 		}
 	}
 
-	ZoneArray* z = ZoneArray::create(catalogFilePath, true);
-	if (z)
+	return catalogFilePath;
+}
+
+bool StarMgr::loadMissingCatalog(const QVariantMap& catDesc, const QString& catalogFileName)
+{
+	if (loadRemoteCatalog(QFileInfo(catalogFileName).fileName()))
+		return true;
+	// The file is supposed to be checked, but we can't find it
+	if (catDesc.value("checked").toBool())
+	{
+		qWarning() << QString("Warning: could not find star catalog %1").arg(QDir::toNativeSeparators(catalogFileName));
+		setCheckFlag(catDesc.value("id").toString(), false);
+	}
+	return false;
+}
+
+qint64 StarMgr::getLazyLoadingBudget() const
+{
+	// With a positive budget (in MB), the zones of faint star catalogs are read
+	// on demand and released again when the budget is exceeded.
+	return StelApp::getInstance().getSettings()->value("stars/lazy_loading_budget_mb", 0).toLongLong()*1024*1024;
+}
+
+ZoneArray* StarMgr::openCatalog(const QString& catalogFilePath, qint64 lazyBudget) const
+{
+	// Prefer the native cache, which can always be memory-mapped.
+	ZoneArray* z = Q_NULLPTR;
+	const QString cacheFilePath = getNativeCatalogCache(catalogFilePath);
+	if (!cacheFilePath.isEmpty())
+		z = ZoneArray::create(cacheFilePath, true, lazyBudget);
+	if (!z)
+		z = ZoneArray::create(catalogFilePath, true, lazyBudget);
+	return z;
+}
+
+void StarMgr::addCatalog(ZoneArray* z, const QString& catalogFileName)
+{
+	if (!z)
+		return;
+	if (z->level<gridLevels.size())
 	{
-		if (z->level<gridLevels.size())
+		qWarning() << QDir::toNativeSeparators(catalogFileName) << ", " << z->level << ": duplicate level";
+		delete z;
+		return;
+	}
+	if (z->level>gridLevels.size())
+	{
+		// A level before it is missing or still streamed
+		qWarning() << QDir::toNativeSeparators(catalogFileName) << ", " << z->level << ": missing level" << gridLevels.size();
+		delete z;
+		return;
+	}
+	Q_ASSERT(z->level==maxGeodesicGridLevel+1);
+	Q_ASSERT(z->level==gridLevels.size());
+	++maxGeodesicGridLevel;
+	gridLevels.append(z);
+	z->updateHipIndex(hipIndex);
+	if (trianglesInitialized)
+	{
+		StelApp::getInstance().getCore()->getGeodesicGrid(maxGeodesicGridLevel)->visitTriangles(maxGeodesicGridLevel,initLastLevelTriangleFunc,this);
+		z->scaleAxis();
+		lastMaxSearchLevel = maxGeodesicGridLevel;
+	}
+}
+
+void StarMgr::loadDeferredData()
+{
+	for (auto& cat : deferredCatalogs)
+	{
+		if (!cat.filePath.isEmpty())
+			cat.zones = openCatalog(cat.filePath, deferredLazyBudget);
+	}
+}
+
+void StarMgr::finishDeferredData()
+{
+	if (deferredCatalogs.isEmpty())
+		return;
+	const int firstLevel = gridLevels.size();
+	for (const auto& cat : deferredCatalogs)
+		addCatalog(cat.zones, cat.fileName);
+	// Streamed catalogs come after all installed ones
+	for (const auto& cat : deferredCatalogs)
+	{
+		if (!cat.installed)
+			loadMissingCatalog(cat.desc, cat.fileName);
+	}
+	deferredCatalogs.clear();
+	if (gridLevels.size() > firstLevel)
+		populateHipparcosLists();
+	qDebug() << "Finished loading deferred star catalogue data, max_geodesic_level: " << maxGeodesicGridLevel;
+}
+
+bool StarMgr::loadRemoteCatalog(const QString& fileName)
+{
+	QString url = StelApp::getInstance().getSettings()->value("stars/remote_catalog_url").toString();
+	// Only the faint catalogs are streamed, stars_0..3 must be installed
+	if (url.isEmpty() || gridLevels.size() < 4)
+		return false;
+	if (!url.endsWith('/'))
+		url += '/';
+
+	const QString cacheDir = StelFileMgr::getUserDir()+"/stars/cache";
+	try
+	{
+		StelFileMgr::makeSureDirExistsAndIsWritable(cacheDir);
+	}
+	catch (std::runtime_error& e)
+	{
+		qWarning() << "Cannot create star catalog cache directory:" << e.what();
+		return false;
+	}
+
+	StarCatalogStream* stream = new StarCatalogStream(QUrl(url).resolved(QUrl(fileName)), cacheDir + "/" + fileName + ".remote");
+	remoteCatalogs.append(stream);
+	connect(stream, SIGNAL(headerReady()), this, SLOT(addRemoteCatalogs()));
+	if (!stream->open())
+		stream->fetchHeader();
+	addRemoteCatalogs();
+	return true;
+}
+
+void StarMgr::addRemoteCatalogs()
+{
+	// Zones are read on demand for streamed catalogs
+	qint64 lazyBudget = StelApp::getInstance().getSettings()->value("stars/lazy_loading_budget_mb", 0).toLongLong()*1024*1024;
+	if (lazyBudget <= 0)
+		lazyBudget = 256*1024*1024;
+
+	while (!remoteCatalogs.isEmpty() && remoteCatalogs.first()->isReady())
+	{
+		StarCatalogStream* stream = remoteCatalogs.takeFirst();
+		disconnect(stream, SIGNAL(headerReady()), this, SLOT(addRemoteCatalogs()));
+		const int level = stream->getLevel();
+		if (level != gridLevels.size())
 		{
-			qWarning() << QDir::toNativeSeparators(catalogFileName) << ", " << z->level << ": duplicate level";
-			delete z;
-			return true;
+			qWarning() << "Streamed star catalog" << QDir::toNativeSeparators(stream->getCacheFilePath()) << "has level" << level
+				   << "instead of" << gridLevels.size();
+			delete stream;
+			continue;
 		}
-		Q_ASSERT(z->level==maxGeodesicGridLevel+1);
-		Q_ASSERT(z->level==gridLevels.size());
+		ZoneArray* z = ZoneArray::create(stream->getCacheFilePath(), false, lazyBudget, stream);
+		if (!z)
+			continue;
 		++maxGeodesicGridLevel;
 		gridLevels.append(z);
+		if (trianglesInitialized)
+		{
+			StelApp::getInstance().getCore()->getGeodesicGrid(maxGeodesicGridLevel)->visitTriangles(maxGeodesicGridLevel,initLastLevelTriangleFunc,this);
+			z->scaleAxis();
+			lastMaxSearchLevel = maxGeodesicGridLevel;
+		}
 	}
-	return true;
+}
+
+QString StarMgr::getNativeCatalogCache(const QString& catalogFilePath) const
+{
+	// Catalogs which are already in native byte order are mapped directly,
+	// there is no need to keep a second copy of them.
+	QFile catalogFile(catalogFilePath);
+	unsigned int magic = 0;
+	if (catalogFile.open(QIODevice::ReadOnly) && catalogFile.read((char*)&magic, 4) == 4)
+	{
+#if (defined(__GNUC__) || defined(_MSC_BUILD))
+		if (magic == FILE_MAGIC)
+			return catalogFilePath;
+#endif
+		if (magic == FILE_MAGIC_NATIVE || magic == FILE_MAGIC_NATIVE_CACHE)
+			return catalogFilePath;
+	}
+	catalogFile.close();
+
+	const QFileInfo catalogInfo(catalogFilePath);
+	const QString cacheDir = StelFileMgr::getUserDir()+"/stars/cache";
+	const QString cacheFilePath = cacheDir + "/" + catalogInfo.fileName() + ".native";
+	const QFileInfo cacheInfo(cacheFilePath);
+	if (cacheInfo.exists() && cacheInfo.lastModified() >= catalogInfo.lastModified())
+		return cacheFilePath;
+
+	try
+	{
+		StelFileMgr::makeSureDirExistsAndIsWritable(cacheDir);
+	}
+	catch (std::runtime_error& e)
+	{
+		qWarning() << "Cannot create star catalog cache directory:" << e.what();
+		return QString();
+	}
+
+	qDebug() << "Creating native star catalog cache" << QDir::toNativeSeparators(cacheFilePath);
+	if (!ZoneArray::createNativeCache(catalogFilePath, cacheFilePath))
+		return QString();
+	return cacheFilePath;
 }
 
 void StarMgr::setCheckFlag(const QString& catId, bool b)
@@ -595,21 +828,32 @@ void StarMgr::loadData(QVariantMap starsConfig)
 
 	qDebug() << "Loading star data ...";
 
-	catalogsDescription = starsConfig.value("catalogs").toList();
-	for (const auto& catV : catalogsDescription)
-	{
-		QVariantMap m = catV.toMap();
-		checkAndLoadCatalog(m);
-	}
-
 	for (int i=0; i<=NR_OF_HIP; i++)
 	{
 		hipIndex[i].a = 0;
 		hipIndex[i].z = 0;
 		hipIndex[i].s = 0;
 	}
-	for (auto* z : gridLevels)
-		z->updateHipIndex(hipIndex);
+
+	// With progressive initialization, only the first catalog (the bright stars) is loaded before
+	// the first frame, the others are opened by loadDeferredData()
+	const bool progressive = StelApp::getInstance().getModuleMgr().getFlagProgressiveInit();
+	deferredLazyBudget = getLazyLoadingBudget();
+	catalogsDescription = starsConfig.value("catalogs").toList();
+	for (const auto& catV : catalogsDescription)
+	{
+		QVariantMap m = catV.toMap();
+		if (progressive && !gridLevels.isEmpty())
+		{
+			DeferredCatalog cat;
+			cat.desc = m;
+			cat.filePath = findCatalogFile(m, cat.fileName, cat.installed);
+			cat.zones = Q_NULLPTR;
+			deferredCatalogs.append(cat);
+		}
+		else
+			checkAndLoadCatalog(m);
+	}
 
 	const QString cat_hip_sp_file_name = starsConfig.value("hipSpectralFile").toString();
 	if (cat_hip_sp_file_name.isEmpty())
@@ -688,6 +932,7 @@ void StarMgr::populateHipparcosLists()
 // Load common names from file
 int StarMgr::loadCommonNames(const QString& commonNameFile)
 {
+	namesI18nCache.clear();
 	commonNamesMap.clear();
 	commonNamesMapI18n.clear();
 	additionalNamesMap.clear();
@@ -696,6 +941,8 @@ int StarMgr::loadCommonNames(const QString& commonNameFile)
 	commonNamesIndex.clear();
 	additionalNamesIndex.clear();
 	additionalNamesIndexI18n.clear();
+	updateNamesSearchIndex(true);
+	updateNamesSearchIndex(false);
 
 	qDebug() << "Loading star names from" << QDir::toNativeSeparators(commonNameFile);
 	QFile cnFile(commonNameFile);
@@ -794,9 +1041,26 @@ int StarMgr::loadCommonNames(const QString& commonNameFile)
 	cnFile.close();
 
 	qDebug() << "Loaded" << readOk << "/" << totalRecords << "common star names";
+	updateNamesSearchIndex(true);
+	updateNamesSearchIndex(false);
 	return 1;
 }
 
+void StarMgr::updateNamesSearchIndex(bool inEnglish)
+{
+	StelObjectNameIndex commonIndex, additionalIndex;
+	commonIndex.insert((inEnglish ? commonNamesMap : commonNamesMapI18n).values());
+	for (const auto& names : (inEnglish ? additionalNamesMap : additionalNamesMapI18n))
+		additionalIndex.insert(names.split(" - "));
+	commonIndex.build();
+	additionalIndex.build();
+
+	const int i = inEnglish ? 1 : 0;
+	QMutexLocker locker(&namesSearchIndexMutex);
+	commonNamesSearchIndex[i] = commonIndex;
+	additionalNamesSearchIndex[i] = additionalIndex;
+}
+
 
 // Load scientific names from file
 void StarMgr::loadSciNames(const QString& sciNameFile)
@@ -1010,14 +1274,143 @@ void StarMgr::loadWds(const QString& WdsFile)
 	qDebug() << "Loaded" << readOk << "/" << totalRecords << "double stars";
 }
 
+namespace
+{
+	// Header of the binary cache of cross-identification data, followed by the tables.
+	// It is written in native byte order, as it is only read on the computer which wrote it.
+	struct CrossIdCacheHeader
+	{
+		quint32 magic;
+		quint32 nrOfCrossIds;
+		quint32 nrOfSao;
+		quint32 nrOfHd;
+		quint32 nrOfHr;
+	};
+	static const quint32 CROSS_ID_CACHE_MAGIC = 0x58494431; // "XID1"
+
+	bool readTable(QFile& file, QVector<catalognumber>& table, quint32 size)
+	{
+		table.resize(size);
+		const qint64 bytes = sizeof(catalognumber)*size;
+		return file.read(reinterpret_cast<char*>(table.data()), bytes)==bytes;
+	}
+
+	bool writeTable(QFile& file, const QVector<catalognumber>& table)
+	{
+		const qint64 bytes = sizeof(catalognumber)*table.size();
+		return file.write(reinterpret_cast<const char*>(table.constData()), bytes)==bytes;
+	}
+
+	// Sort an index by catalog number. Like for QMap::operator[], the last hip given
+	// for a number wins.
+	void sortCatalogNumberIndex(QVector<catalognumber>& index)
+	{
+		std::stable_sort(index.begin(), index.end(), [](const catalognumber& a, const catalognumber& b) { return a.number<b.number; });
+		int n = 0;
+		for (int i=0;i<index.size();++i)
+		{
+			if (n>0 && index[n-1].number==index[i].number)
+				index[n-1] = index[i];
+			else
+				index[n++] = index[i];
+		}
+		index.resize(n);
+		index.squeeze();
+	}
+}
+
+unsigned int StarMgr::packComponentIds(const QString& ids)
+{
+	unsigned int packed = 0;
+	const QByteArray latin1 = ids.trimmed().toLatin1();
+	for (int i=0;i<latin1.size() && i<4;++i)
+		packed |= static_cast<unsigned int>(static_cast<unsigned char>(latin1.at(i))) << (24-8*i);
+	return packed;
+}
+
+int StarMgr::getHipFromCatalogNumber(const QVector<catalognumber>& index, int number)
+{
+	if (number<=0)
+		return 0;
+	auto it = std::lower_bound(index.constBegin(), index.constEnd(), static_cast<unsigned int>(number),
+				   [](const catalognumber& c, unsigned int n) { return c.number<n; });
+	if (it==index.constEnd() || it->number!=static_cast<unsigned int>(number))
+		return 0;
+	return it->hip;
+}
+
+bool StarMgr::readCrossIdentificationCache(const QString& cacheFile)
+{
+	QFile file(cacheFile);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+	CrossIdCacheHeader header;
+	if (file.read(reinterpret_cast<char*>(&header), sizeof(header))!=sizeof(header) || header.magic!=CROSS_ID_CACHE_MAGIC
+	    || file.size()!=(qint64)(sizeof(header)+sizeof(crossid)*header.nrOfCrossIds
+				     +sizeof(catalognumber)*(header.nrOfSao+header.nrOfHd+header.nrOfHr)))
+		return false;
+	crossIdData.resize(header.nrOfCrossIds);
+	const qint64 bytes = sizeof(crossid)*header.nrOfCrossIds;
+	if (file.read(reinterpret_cast<char*>(crossIdData.data()), bytes)!=bytes
+	    || !readTable(file, saoStarsIndex, header.nrOfSao)
+	    || !readTable(file, hdStarsIndex, header.nrOfHd)
+	    || !readTable(file, hrStarsIndex, header.nrOfHr))
+	{
+		crossIdData.clear();
+		saoStarsIndex.clear();
+		hdStarsIndex.clear();
+		hrStarsIndex.clear();
+		return false;
+	}
+	return true;
+}
+
+bool StarMgr::writeCrossIdentificationCache(const QString& cacheFile)
+{
+	QFile file(cacheFile + ".tmp");
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+	CrossIdCacheHeader header;
+	header.magic = CROSS_ID_CACHE_MAGIC;
+	header.nrOfCrossIds = crossIdData.size();
+	header.nrOfSao = saoStarsIndex.size();
+	header.nrOfHd = hdStarsIndex.size();
+	header.nrOfHr = hrStarsIndex.size();
+	const qint64 bytes = sizeof(crossid)*crossIdData.size();
+	bool ok = file.write(reinterpret_cast<const char*>(&header), sizeof(header))==sizeof(header)
+		  && file.write(reinterpret_cast<const char*>(crossIdData.constData()), bytes)==bytes
+		  && writeTable(file, saoStarsIndex)
+		  && writeTable(file, hdStarsIndex)
+		  && writeTable(file, hrStarsIndex);
+	file.close();
+	if (ok)
+	{
+		QFile::remove(cacheFile);
+		ok = file.rename(cacheFile);
+	}
+	if (!ok)
+		file.remove();
+	return ok;
+}
+
 // Load cross-identification data from file
 void StarMgr::loadCrossIdentificationData(const QString& crossIdFile)
 {
-	crossIdMap.clear();
+	crossIdData.clear();
 	saoStarsIndex.clear();	
 	hdStarsIndex.clear();	
 	hrStarsIndex.clear();
 
+	const QString cacheDir = StelFileMgr::getUserDir()+"/stars/cache";
+	const QString cacheFile = cacheDir + "/" + QFileInfo(crossIdFile).fileName() + ".bin";
+	const QFileInfo cacheInfo(cacheFile);
+	if (cacheInfo.exists() && cacheInfo.lastModified() >= QFileInfo(crossIdFile).lastModified()
+	    && readCrossIdentificationCache(cacheFile))
+	{
+		qDebug() << "Loaded" << crossIdData.size() << "cross-identification data records for stars from" << QDir::toNativeSeparators(cacheFile);
+		return;
+	}
+
 	qDebug() << "Loading cross-identification data from" << QDir::toNativeSeparators(crossIdFile);
 	QFile ciFile(crossIdFile);
 	if (!ciFile.open(QIODevice::ReadOnly | QIODevice::Text))
@@ -1028,7 +1421,8 @@ void StarMgr::loadCrossIdentificationData(const QString& crossIdFile)
 	const QStringList& allRecords = QString::fromUtf8(ciFile.readAll()).split('\n');
 	ciFile.close();
 
-	crossid crossIdData;
+	crossid crossIdRecord;
+	catalognumber number;
 
 	int readOk=0;
 	int totalRecords=0;
@@ -1063,24 +1457,62 @@ void StarMgr::loadCrossIdentificationData(const QString& crossIdFile)
 				continue;
 			}
 
-			QString hipstar = QString("%1%2").arg(hip).arg(fields.at(1).trimmed());
-			crossIdData.sao = fields.at(2).toUInt(&ok);
-			crossIdData.hd = fields.at(3).toUInt(&ok);
-			crossIdData.hr = fields.at(4).toUInt(&ok);
+			crossIdRecord.hip = hip;
+			crossIdRecord.component = packComponentIds(fields.at(1));
+			crossIdRecord.sao = fields.at(2).toUInt(&ok);
+			crossIdRecord.hd = fields.at(3).toUInt(&ok);
+			crossIdRecord.hr = fields.at(4).toUInt(&ok);
 
-			crossIdMap[hipstar] = crossIdData;
-			if (crossIdData.sao>0)
-				saoStarsIndex[crossIdData.sao] = hip;
-			if (crossIdData.hd>0)
-				hdStarsIndex[crossIdData.hd] = hip;
-			if (crossIdData.hr>0)
-				hrStarsIndex[crossIdData.hr] = hip;
+			crossIdData.append(crossIdRecord);
+			number.hip = hip;
+			if (crossIdRecord.sao>0)
+			{
+				number.number = crossIdRecord.sao;
+				saoStarsIndex.append(number);
+			}
+			if (crossIdRecord.hd>0)
+			{
+				number.number = crossIdRecord.hd;
+				hdStarsIndex.append(number);
+			}
+			if (crossIdRecord.hr>0)
+			{
+				number.number = crossIdRecord.hr;
+				hrStarsIndex.append(number);
+			}
 
 			++readOk;
 		}
 	}
 
+	// Sort the tables for binary search. The last record of a star wins, as it did when they were maps.
+	std::stable_sort(crossIdData.begin(), crossIdData.end(), [](const crossid& a, const crossid& b) { return a.hip<b.hip || (a.hip==b.hip && a.component<b.component); });
+	int n = 0;
+	for (int i=0;i<crossIdData.size();++i)
+	{
+		if (n>0 && crossIdData[n-1].hip==crossIdData[i].hip && crossIdData[n-1].component==crossIdData[i].component)
+			crossIdData[n-1] = crossIdData[i];
+		else
+			crossIdData[n++] = crossIdData[i];
+	}
+	crossIdData.resize(n);
+	crossIdData.squeeze();
+	sortCatalogNumberIndex(saoStarsIndex);
+	sortCatalogNumberIndex(hdStarsIndex);
+	sortCatalogNumberIndex(hrStarsIndex);
+
 	qDebug() << "Loaded" << readOk << "/" << totalRecords << "cross-identification data records for stars";
+
+	try
+	{
+		StelFileMgr::makeSureDirExistsAndIsWritable(cacheDir);
+		if (!writeCrossIdentificationCache(cacheFile))
+			qWarning() << "Cannot write cross-identification cache" << QDir::toNativeSeparators(cacheFile);
+	}
+	catch (std::runtime_error& e)
+	{
+		qWarning() << "Cannot create cross-identification cache directory:" << e.what();
+	}
 }
 
 int StarMgr::getMaxSearchLevel() const
@@ -1099,19 +1531,53 @@ int StarMgr::getMaxSearchLevel() const
 
 
 // Draw all the stars
+namespace
+{
+	//! The stars of one zone projected by a worker thread in StarMgr::draw()
+	struct ZoneProjection
+	{
+		int zone;
+		bool isInsideViewport;
+		QVector<ProjectedStar> stars;
+	};
+
+	//! The stars of one zone found by a worker thread in StarMgr::searchAround()
+	struct ZoneSearch
+	{
+		int zone;
+		QList<StelObjectP> result;
+	};
+
+	//! Get whether it is worth to distribute the given number of zones to the global thread pool.
+	bool useThreadPool(bool flag, const ZoneArray* z, int nrOfZones)
+	{
+		return flag && nrOfZones > 1 && z->supportsParallelProjection() && QThreadPool::globalInstance()->maxThreadCount() > 1;
+	}
+}
+
 void StarMgr::draw(StelCore* core)
 {
 	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
 	StelSkyDrawer* skyDrawer = core->getSkyDrawer();
+	// The drawn stars are recorded for selecting them by clicking, without calling searchAround()
+	StelPickBuffer& pickBuffer = objectMgr->getPickBuffer();
+	StelPickBuffer::Layer* pickLayer = pickBuffer.beginLayer(this, prj);
+	if (!getFlagStars())
+	{
+		// Fading out stars cannot be selected
+		pickBuffer.setLayerComplete(this);
+		pickLayer = Q_NULLPTR;
+	}
 	// If stars are turned off don't waste time below
 	// projecting all stars just to draw disembodied labels
 	if (!starsFader.getInterstate())
 		return;
+	// Stars drawn from static buffers are not projected on the CPU, these levels need searchAround()
+	bool pickLayerComplete = true;
 
 	int maxSearchLevel = getMaxSearchLevel();
-	QVector<SphericalCap> viewportCaps = prj->getViewportConvexPolygon()->getBoundingSphericalCaps();
-	viewportCaps.append(core->getVisibleSkyArea());
-	const GeodesicSearchResult* geodesic_search_result = core->getGeodesicGrid(maxSearchLevel)->search(viewportCaps,maxSearchLevel);
+	const QVector<SphericalCap>& viewportCaps = core->getVisibleSkyCaps();
+	const GeodesicSearchResult* geodesic_search_result = core->getVisibleGeodesicZones(maxSearchLevel);
 
 	// Set temporary static variable for optimization
 	const float names_brightness = labelsFader.getInterstate() * starsFader.getInterstate();
@@ -1121,36 +1587,35 @@ void StarMgr::draw(StelCore* core)
 	sPainter.setFont(starFont);
 	skyDrawer->preDrawPointSource(&sPainter);
 
-	// Prepare a table for storing precomputed RCMag for all ZoneArrays
-	RCMag rcmag_table[RCMAG_TABLE_SIZE];
+	// The sky drawer keeps the RCMag tables of all ZoneArrays between frames. They must
+	// only be copied to apply the fader of the stars.
+	RCMag fadedRcmagTable[RCMAG_TABLE_SIZE];
+	const float fade = starsFader.getInterstate();
+
+	// Faint catalogs can be drawn from static buffers, which do not support extinction
+	const Extinction& extinction = skyDrawer->getExtinction();
+	const bool withExtinction = skyDrawer->getFlagHasAtmosphere() && extinction.getExtinctionCoefficient()>=0.01f;
+	const bool useStaticBuffers = !withExtinction && zoneRenderer->isUsable(prj);
 	
 	// Draw all the stars of all the selected zones
 	for (const auto* z : gridLevels)
 	{
-		int limitMagIndex=RCMAG_TABLE_SIZE;
+		int limitMagIndex;
 		const float mag_min = 0.001f*z->mag_min;
 		const float k = (0.001f*z->mag_range)/z->mag_steps; // MagStepIncrement
-		for (int i=0;i<RCMAG_TABLE_SIZE;++i)
+		const RCMag* rcmag_table = skyDrawer->getRCMagTable(mag_min, k, RCMAG_TABLE_SIZE, &limitMagIndex);
+		// We reached the point where stars are not visible anymore
+		if (limitMagIndex < 0)
+			break;
+		if (fade < 1.f)
 		{
-			const float mag = mag_min+k*i;
-			if (skyDrawer->computeRCMag(mag, &rcmag_table[i])==false)
+			for (int i=0;i<=limitMagIndex;++i)
 			{
-				if (i==0)
-					goto exit_loop;
-				
-				// The last magnitude at which the star is visible
-				limitMagIndex = i-1;
-				
-				// We reached the point where stars are not visible anymore
-				// Fill the rest of the table with zero and leave.
-				for (;i<RCMAG_TABLE_SIZE;++i)
-				{
-					rcmag_table[i].luminance=0;
-					rcmag_table[i].radius=0;
-				}
-				break;
+				fadedRcmagTable[i].radius = rcmag_table[i].radius*fade;
+				fadedRcmagTable[i].luminance = rcmag_table[i].luminance;
 			}
-			rcmag_table[i].radius *= starsFader.getInterstate();
+			memset(fadedRcmagTable+limitMagIndex+1, 0, (RCMAG_TABLE_SIZE-limitMagIndex-1)*sizeof(RCMag));
+			rcmag_table = fadedRcmagTable;
 		}
 		lastMaxSearchLevel = z->level;
 
@@ -1163,34 +1628,71 @@ void StarMgr::draw(StelCore* core)
 			if (x > 0)
 				maxMagStarName = x;
 		}
+		if (useStaticBuffers && z->supportsStaticBuffers() &&
+		    zoneRenderer->drawZones(&sPainter, z, *geodesic_search_result, rcmag_table, limitMagIndex, core))
+		{
+			pickLayerComplete = false;
+			continue;
+		}
+
 		int zone;
-		
+		QVector<ZoneProjection> projections;
 		for (GeodesicSearchInsideIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
-			z->draw(&sPainter, zone, true, rcmag_table, limitMagIndex, core, maxMagStarName, names_brightness, viewportCaps);
+			projections.append({zone, true, QVector<ProjectedStar>()});
 		for (GeodesicSearchBorderIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
-			z->draw(&sPainter, zone, false, rcmag_table, limitMagIndex, core, maxMagStarName,names_brightness, viewportCaps);
+			projections.append({zone, false, QVector<ProjectedStar>()});
+
+		if (useThreadPool(flagParallelZones, z, projections.size()))
+		{
+			// Project the zones in parallel. Only the point sources are submitted to OpenGL
+			// on this thread, in the same order as the serial path to keep drawing deterministic.
+			for (const auto& p : projections)
+				z->prepareZone(p.zone, core, limitMagIndex);
+			QtConcurrent::blockingMap(projections, [&](ZoneProjection& p)
+			{
+				z->projectZone(p.zone, p.isInsideViewport, rcmag_table, limitMagIndex, core, prj, viewportCaps, p.stars);
+			});
+			for (const auto& p : projections)
+				z->drawProjectedZone(&sPainter, p.zone, p.stars, core, maxMagStarName, names_brightness, pickLayer);
+		}
+		else
+		{
+			for (const auto& p : projections)
+				z->draw(&sPainter, p.zone, p.isInsideViewport, rcmag_table, limitMagIndex, core, maxMagStarName, names_brightness, viewportCaps, pickLayer);
+		}
 	}
-	exit_loop:
 
 	// Finish drawing many stars
 	skyDrawer->postDrawPointSource(&sPainter);
+	if (pickLayerComplete)
+		pickBuffer.setLayerComplete(this);
 
 	if (objectMgr->getFlagSelectedObjectPointer())
 		drawPointer(sPainter, core);
 }
 
 
-// Return a QList containing the stars located
-// inside the limFov circle around position v
-QList<StelObjectP > StarMgr::searchAround(const Vec3d& vv, double limFov, const StelCore* core) const
+StelObjectP StarMgr::getPickedObject(quint64 id) const
 {
-	QList<StelObjectP > result;
-	if (!getFlagStars())
-		return result;
+	const int level = static_cast<int>(id >> 44);
+	const int zone = static_cast<int>((id >> 24) & 0xfffff);
+	const int star = static_cast<int>(id & 0xffffff);
+	for (const auto* z : gridLevels)
+	{
+		if (z->level == level)
+			return z->createStelObject(zone, star);
+	}
+	return StelObjectP();
+}
 
-	Vec3d v(vv);
-	v.normalize();
+quint64 StarMgr::getObjectIndex(const StelObject* obj) const
+{
+	const StarWrapperBase* star = dynamic_cast<const StarWrapperBase*>(obj);
+	return star ? star->getCatalogId() : InvalidObjectIndex;
+}
 
+const GeodesicSearchResult* StarMgr::searchAroundZones(const Vec3d& v, double limFov, const StelCore* core) const
+{
 	// find any vectors h0 and h1 (length 1), so that h0*v=h1*v=h0*h1=0
 	int i;
 	{
@@ -1231,25 +1733,122 @@ QList<StelObjectP > StarMgr::searchAround(const Vec3d& vv, double limFov, const
 	// Search the triangles
 	SphericalConvexPolygon c(e3, e2, e2, e0);
 	const GeodesicSearchResult* geodesic_search_result = core->getGeodesicGrid(lastMaxSearchLevel)->search(c.getBoundingSphericalCaps(),lastMaxSearchLevel);
+	return geodesic_search_result;
+}
+
+void StarMgr::searchAround(const Vec3d& vv, double limFov, const StelCore* core, const StarViewFunc& func) const
+{
+	if (!getFlagStars())
+		return;
+
+	Vec3d v(vv);
+	v.normalize();
+	const GeodesicSearchResult* geodesic_search_result = searchAroundZones(v, limFov, core);
+
+	const double f = cos(limFov * M_PI/180.);
+	for (const auto* z : gridLevels)
+	{
+		int zone;
+		for (GeodesicSearchInsideIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
+		{
+			if (!z->searchAround(core, zone, v, f, func))
+				return;
+		}
+		for (GeodesicSearchBorderIterator it1(*geodesic_search_result,z->level); (zone = it1.next()) >= 0;)
+		{
+			if (!z->searchAround(core, zone, v, f, func))
+				return;
+		}
+	}
+}
+
+// Return a QList containing the stars located
+// inside the limFov circle around position v
+QList<StelObjectP > StarMgr::searchAround(const Vec3d& vv, double limFov, const StelCore* core) const
+{
+	QList<StelObjectP > result;
+	if (!getFlagStars())
+		return result;
+
+	Vec3d v(vv);
+	v.normalize();
+	const GeodesicSearchResult* geodesic_search_result = searchAroundZones(v, limFov, core);
 
 	// Iterate over the stars inside the triangles
-	f = cos(limFov * M_PI/180.);
+	const double f = cos(limFov * M_PI/180.);
 	for (auto* z : gridLevels)
 	{
-		//qDebug() << "search inside(" << it->first << "):";
 		int zone;
+		QVector<ZoneSearch> searches;
 		for (GeodesicSearchInsideIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
+			searches.append({zone, QList<StelObjectP>()});
+		for (GeodesicSearchBorderIterator it1(*geodesic_search_result,z->level); (zone = it1.next()) >= 0;)
+			searches.append({zone, QList<StelObjectP>()});
+
+		if (useThreadPool(flagParallelZones, z, searches.size()))
+		{
+			QtConcurrent::blockingMap(searches, [&](ZoneSearch& search)
+			{
+				z->searchAround(core, search.zone, v, f, search.result);
+			});
+			for (const auto& search : searches)
+				result.append(search.result);
+		}
+		else
 		{
-			z->searchAround(core, zone,v,f,result);
-			//qDebug() << " " << zone;
+			for (const auto& search : searches)
+				z->searchAround(core, search.zone, v, f, result);
 		}
-		//qDebug() << endl << "search border(" << it->first << "):";
+	}
+	return result;
+}
+
+QList<StelObjectP> StarMgr::searchBrighterThan(const SphericalCap& cap, float maxMag, double jde, QVector<Vec3d>* positions) const
+{
+	struct BrightSearch
+	{
+		int zone;
+		QList<StelObjectP> result;
+		QVector<Vec3d> positions;
+	};
+
+	QList<StelObjectP> result;
+	QVector<Vec3d> resultPositions;
+	const StelCore* core = StelApp::getInstance().getCore();
+	const GeodesicSearchResult* geodesic_search_result = core->getGeodesicGrid(lastMaxSearchLevel)->search(QVector<SphericalCap>() << cap, lastMaxSearchLevel);
+	for (auto* z : gridLevels)
+	{
+		// Catalogs are sorted by magnitude
+		const int magStep = static_cast<int>(std::floor((maxMag*1000.f - z->mag_min)*z->mag_steps/z->mag_range));
+		if (magStep < 0)
+			break;
+		int zone;
+		QVector<BrightSearch> searches;
+		for (GeodesicSearchInsideIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
+			searches.append({zone, QList<StelObjectP>(), QVector<Vec3d>()});
 		for (GeodesicSearchBorderIterator it1(*geodesic_search_result,z->level); (zone = it1.next()) >= 0;)
+			searches.append({zone, QList<StelObjectP>(), QVector<Vec3d>()});
+
+		if (useThreadPool(flagParallelZones, z, searches.size()))
+		{
+			QtConcurrent::blockingMap(searches, [&](BrightSearch& search)
+			{
+				z->searchBrighterThan(jde, search.zone, cap, magStep, search.result, search.positions);
+			});
+			for (const auto& search : searches)
+			{
+				result.append(search.result);
+				resultPositions += search.positions;
+			}
+		}
+		else
 		{
-			z->searchAround(core, zone,v,f,result);
-			//qDebug() << " " << zone;
+			for (const auto& search : searches)
+				z->searchBrighterThan(jde, search.zone, cap, magStep, result, resultPositions);
 		}
 	}
+	if (positions)
+		*positions = resultPositions;
 	return result;
 }
 
@@ -1259,6 +1858,20 @@ QList<StelObjectP > StarMgr::searchAround(const Vec3d& vv, double limFov, const
 void StarMgr::updateI18n()
 {
 	const StelTranslator& trans = StelApp::getInstance().getLocaleMgr().getSkyTranslator();
+	const QString language = trans.getTrueLocaleName();
+	auto cached = namesI18nCache.constFind(language);
+	if (cached!=namesI18nCache.constEnd())
+	{
+		commonNamesMapI18n = cached->commonNamesMap;
+		commonNamesIndexI18n = cached->commonNamesIndex;
+		additionalNamesMapI18n = cached->additionalNamesMap;
+		additionalNamesIndexI18n = cached->additionalNamesIndex;
+		QMutexLocker locker(&namesSearchIndexMutex);
+		commonNamesSearchIndex[0] = cached->commonNamesSearchIndex;
+		additionalNamesSearchIndex[0] = cached->additionalNamesSearchIndex;
+		return;
+	}
+
 	commonNamesMapI18n.clear();
 	commonNamesIndexI18n.clear();
 	additionalNamesMapI18n.clear();
@@ -1284,6 +1897,19 @@ void StarMgr::updateI18n()
 		const QString r = tn.join(" - ");
 		additionalNamesMapI18n[i] = r;
 	}
+	updateNamesSearchIndex(false);
+
+	NamesI18n names;
+	names.commonNamesMap = commonNamesMapI18n;
+	names.commonNamesIndex = commonNamesIndexI18n;
+	names.additionalNamesMap = additionalNamesMapI18n;
+	names.additionalNamesIndex = additionalNamesIndexI18n;
+	{
+		QMutexLocker locker(&namesSearchIndexMutex);
+		names.commonNamesSearchIndex = commonNamesSearchIndex[0];
+		names.additionalNamesSearchIndex = additionalNamesSearchIndex[0];
+	}
+	namesI18nCache.insert(language, names);
 }
 
 // Search the star by HP number
@@ -1317,27 +1943,27 @@ StelObjectP StarMgr::searchByNameI18n(const QString& nameI18n) const
 	QRegExp rx2("^\\s*(SAO)\\s*(\\d+)\\s*$", Qt::CaseInsensitive);
 	if (rx2.exactMatch(objw))
 	{
-		auto sao = saoStarsIndex.find(rx2.capturedTexts().at(2).toInt());
-		if (sao!=saoStarsIndex.end())
-			return searchHP(sao.value());
+		const int sao = getHipFromCatalogNumber(saoStarsIndex, rx2.capturedTexts().at(2).toInt());
+		if (sao>0)
+			return searchHP(sao);
 	}
 
 	// Search by HD number if it's an HD formated number
 	QRegExp rx3("^\\s*(HD)\\s*(\\d+)\\s*$", Qt::CaseInsensitive);
 	if (rx3.exactMatch(objw))
 	{
-		auto hd = hdStarsIndex.find(rx3.capturedTexts().at(2).toInt());
-		if (hd!=hdStarsIndex.end())
-			return searchHP(hd.value());
+		const int hd = getHipFromCatalogNumber(hdStarsIndex, rx3.capturedTexts().at(2).toInt());
+		if (hd>0)
+			return searchHP(hd);
 	}
 
 	// Search by HR number if it's an HR formated number
 	QRegExp rx4("^\\s*(HR)\\s*(\\d+)\\s*$", Qt::CaseInsensitive);
 	if (rx4.exactMatch(objw))
 	{
-		auto hr = hrStarsIndex.find(rx4.capturedTexts().at(2).toInt());
-		if (hr!=hrStarsIndex.end())
-			return searchHP(hr.value());
+		const int hr = getHipFromCatalogNumber(hrStarsIndex, rx4.capturedTexts().at(2).toInt());
+		if (hr>0)
+			return searchHP(hr);
 	}
 
 	// Search by I18n common name
@@ -1406,27 +2032,27 @@ StelObjectP StarMgr::searchByName(const QString& name) const
 	QRegExp rx2("^\\s*(SAO)\\s*(\\d+)\\s*$", Qt::CaseInsensitive);
 	if (rx2.exactMatch(objw))
 	{
-		auto sao = saoStarsIndex.find(rx2.capturedTexts().at(2).toInt());
-		if (sao!=saoStarsIndex.end())
-			return searchHP(sao.value());
+		const int sao = getHipFromCatalogNumber(saoStarsIndex, rx2.capturedTexts().at(2).toInt());
+		if (sao>0)
+			return searchHP(sao);
 	}
 
 	// Search by HD number if it's an HD formated number
 	QRegExp rx3("^\\s*(HD)\\s*(\\d+)\\s*$", Qt::CaseInsensitive);
 	if (rx3.exactMatch(objw))
 	{
-		auto hd = hdStarsIndex.find(rx3.capturedTexts().at(2).toInt());
-		if (hd!=hdStarsIndex.end())
-			return searchHP(hd.value());
+		const int hd = getHipFromCatalogNumber(hdStarsIndex, rx3.capturedTexts().at(2).toInt());
+		if (hd>0)
+			return searchHP(hd);
 	}
 
 	// Search by HR number if it's an HR formated number
 	QRegExp rx4("^\\s*(HR)\\s*(\\d+)\\s*$", Qt::CaseInsensitive);
 	if (rx4.exactMatch(objw))
 	{
-		auto hr = hrStarsIndex.find(rx4.capturedTexts().at(2).toInt());
-		if (hr!=hrStarsIndex.end())
-			return searchHP(hr.value());
+		const int hr = getHipFromCatalogNumber(hrStarsIndex, rx4.capturedTexts().at(2).toInt());
+		if (hr>0)
+			return searchHP(hr);
 	}
 
 	// Search by English common name
@@ -1522,36 +2148,22 @@ QStringList StarMgr::listMatchingObjects(const QString& objPrefix, int maxNbItem
 	}
 	else
 	{
-		QMapIterator<QString, int> i(cNamesIdx);
-		while (i.hasNext())
+		const int i = inEnglish ? 1 : 0;
+		StelObjectNameIndex commonIndex, additionalIndex;
 		{
-			i.next();
-			if (i.key().contains(objw))
-			{
-				if (maxNbItem<=0)
-					break;
-				result.append(inEnglish ? getCommonEnglishName(i.value()) : getCommonName(i.value()));
-				--maxNbItem;
-			}
+			// The search dialog runs the queries in a worker thread
+			QMutexLocker locker(&namesSearchIndexMutex);
+			commonIndex = commonNamesSearchIndex[i];
+			additionalIndex = additionalNamesSearchIndex[i];
 		}
-		QMapIterator<QString, int> j(aNamesIdx);
-		while (j.hasNext())
+		const QStringList names = commonIndex.listMatching(objw, maxNbItem, false);
+		result.append(names);
+		maxNbItem -= names.size();
+		if (getFlagAdditionalNames())
 		{
-			j.next();
-			if (j.key().contains(objw))
-			{
-				if (maxNbItem<=0)
-					break;
-				QStringList names = (inEnglish ? getAdditionalEnglishNames(j.value()) : getAdditionalNames(j.value())).split(" - ");
-				for (auto name : names)
-				{
-					if (name.contains(objw, Qt::CaseInsensitive))
-					{
-						result.append(name);
-						--maxNbItem;
-					}
-				}
-			}
+			const QStringList additionalNames = additionalIndex.listMatching(objw, maxNbItem, false);
+			result.append(additionalNames);
+			maxNbItem -= additionalNames.size();
 		}
 	}
 
@@ -1629,10 +2241,10 @@ QStringList StarMgr::listMatchingObjects(const QString& objPrefix, int maxNbItem
 	{
 		bool ok;
 		int saoNum = saoRx.capturedTexts().at(2).toInt(&ok);
-		auto sao = saoStarsIndex.find(saoNum);
-		if (sao!=saoStarsIndex.end())
+		const int sao = getHipFromCatalogNumber(saoStarsIndex, saoNum);
+		if (sao>0)
 		{
-			StelObjectP s = searchHP(sao.value());
+			StelObjectP s = searchHP(sao);
 			if (s && maxNbItem>0)
 			{
 				result << QString("SAO%1").arg(saoNum);
@@ -1648,10 +2260,10 @@ QStringList StarMgr::listMatchingObjects(const QString& objPrefix, int maxNbItem
 	{
 		bool ok;
 		int hdNum = hdRx.capturedTexts().at(2).toInt(&ok);
-		auto hd = hdStarsIndex.find(hdNum);
-		if (hd!=hdStarsIndex.end())
+		const int hd = getHipFromCatalogNumber(hdStarsIndex, hdNum);
+		if (hd>0)
 		{
-			StelObjectP s = searchHP(hd.value());
+			StelObjectP s = searchHP(hd);
 			if (s && maxNbItem>0)
 			{
 				result << QString("HD%1").arg(hdNum);
@@ -1667,10 +2279,10 @@ QStringList StarMgr::listMatchingObjects(const QString& objPrefix, int maxNbItem
 	{
 		bool ok;
 		int hrNum = hrRx.capturedTexts().at(2).toInt(&ok);
-		auto hr = hrStarsIndex.find(hrNum);
-		if (hr!=hrStarsIndex.end())
+		const int hr = getHipFromCatalogNumber(hrStarsIndex, hrNum);
+		if (hr>0)
 		{
-			StelObjectP s = searchHP(hr.value());
+			StelObjectP s = searchHP(hr);
 			if (s && maxNbItem>0)
 			{
 				result << QString("HR%1").arg(hrNum);
@@ -21,24 +21,45 @@
 #define STARMGR_HPP
 
 #include <QFont>
+#include <QMutex>
 #include <QVariantMap>
 #include <QVector>
+#include <functional>
 #include "StelFader.hpp"
 #include "StelObjectModule.hpp"
 #include "StelTextureTypes.hpp"
 #include "StelProjectorType.hpp"
 
 class StelObject;
+class StarCatalogStream;
+class StarZoneRenderer;
 class StelToneReproducer;
 class StelProjector;
 class StelPainter;
 class QSettings;
+class SphericalCap;
+class GeodesicSearchResult;
 
 class ZoneArray;
 struct HipIndexStruct;
 
 static const int RCMAG_TABLE_SIZE = 4096;
 
+//! @struct StarView
+//! Description of a star found by StarMgr::searchAround() with a callback, which does not create a StelObject.
+//! StarMgr::createStelObject() creates the StelObject of the star when it is needed, e.g. for selecting it.
+struct StarView
+{
+	Vec3d j2000Pos;	//! J2000 unit vector at the current epoch, with proper motion applied
+	float vMag;	//! Visual magnitude, without extinction
+	float bV;	//! B-V color index
+	int hip;	//! Hipparcos number, 0 for stars of the faint catalogs
+	quint64 id;	//! Identifies the star for StarMgr::createStelObject()
+};
+
+//! Called for each star found by StarMgr::searchAround(). Return false to stop the search.
+typedef std::function<bool(const StarView&)> StarViewFunc;
+
 typedef struct
 {
 	QString designation;	//! GCVS designation
@@ -64,12 +85,20 @@ typedef struct
 
 typedef struct
 {
+	unsigned int hip;	//! Hipparcos number
+	unsigned int component;	//! Latin-1 component identifier of a multiple star, packed by StarMgr::packComponentIds(); 0 for none
 	unsigned int sao;
 	unsigned int hd;
 	unsigned int hr;
-
 } crossid;
 
+//! Maps a number of another catalog (SAO, HD, HR) to a Hipparcos number.
+typedef struct
+{
+	unsigned int number;
+	unsigned int hip;
+} catalognumber;
+
 typedef QMap<StelObjectP, float> StelACStarData;
 
 //! @class StarMgr
@@ -131,6 +160,11 @@ public:
 	//! - Sets various display flags from the ini parser object
 	virtual void init();
 
+	//! With progressive initialization, loads the catalogs after the first one in the background.
+	virtual void loadDeferredData() Q_DECL_OVERRIDE;
+	//! Adds the catalogs loaded by loadDeferredData() to the grid levels.
+	virtual void finishDeferredData() Q_DECL_OVERRIDE;
+
 	//! Draw the stars and the star selection indicator if necessary.
 	virtual void draw(StelCore* core);
 
@@ -146,6 +180,30 @@ public:
 	//! Return a list containing the stars located inside the limFov circle around position v
 	virtual QList<StelObjectP > searchAround(const Vec3d& v, double limitFov, const StelCore* core) const;
 
+	//! Create the star drawn in the last frame with the given id in the pick buffer of StelObjectMgr.
+	virtual StelObjectP getPickedObject(quint64 id) const Q_DECL_OVERRIDE;
+
+	//! The index of a star in object handles is its id in the pick buffer, see ZoneArray::getPickId().
+	virtual quint64 getObjectIndex(const StelObject* obj) const Q_DECL_OVERRIDE;
+	virtual StelObjectP searchByObjectIndex(quint64 index) const Q_DECL_OVERRIDE {return getPickedObject(index);}
+
+	//! Call a function for each star inside the limFov circle around position v, without allocating a StelObject
+	//! per star like the other searchAround(). Unlike it, this is never distributed to the thread pool.
+	//! @param func called with each star found; the search stops when it returns false
+	void searchAround(const Vec3d& v, double limitFov, const StelCore* core, const StarViewFunc& func) const;
+
+	//! Create the StelObject of a star found by searchAround().
+	StelObjectP createStelObject(const StarView& star) const {return getPickedObject(star.id);}
+
+	//! Return the stars inside a region which are not fainter than a magnitude, whether they are
+	//! displayed or not, e.g. the candidates for occultations along the path of the Moon.
+	//! Must be called from the main thread.
+	//! @param cap the region to search
+	//! @param maxMag the faintest magnitude to return
+	//! @param jde the epoch for which proper motion is applied
+	//! @param positions if not null, receives the J2000 unit vectors of the stars at epoch jde
+	QList<StelObjectP> searchBrighterThan(const SphericalCap& cap, float maxMag, double jde, QVector<Vec3d>* positions=Q_NULLPTR) const;
+
 	//! Return the matching Stars object's pointer if exists or Q_NULLPTR
 	//! @param nameI18n The case in-sensistive star common name or HP
 	//! catalog name (format can be HP1234 or HP 1234 or HIP 1234) or sci name
@@ -369,6 +427,9 @@ private slots:
 	void increaseStarsMagnitudeLimit();
 	void reduceStarsMagnitudeLimit();
 
+	//! Add the streamed catalogs whose header is available to gridLevels, in the order of their levels.
+	void addRemoteCatalogs();
+
 signals:
 	void starLabelsDisplayedChanged(const bool displayed);
 	void starsDisplayedChanged(const bool displayed);
@@ -380,6 +441,32 @@ private:
 
 	void copyDefaultConfigFile();
 
+	//! Stream a star catalog which is not available locally from the server given by
+	//! stars/remote_catalog_url, once the Hipparcos levels are loaded.
+	//! @param fileName file name of the catalog on the server
+	//! @return false if no server is configured
+	bool loadRemoteCatalog(const QString& fileName);
+
+	//! Find the file of a catalog, and verify its checksum if the catalog is not marked as checked.
+	//! @param catalogFileName receives the name of the file, relative to the data directories unless absolute
+	//! @param installed receives false if the file was not found
+	//! @return the path of the file, or an empty string if it is not installed or not valid
+	QString findCatalogFile(const QVariantMap& catDesc, QString& catalogFileName, bool& installed);
+	//! Stream a catalog which is not installed, or warn about it if it is marked as checked.
+	//! @return true if the catalog is streamed
+	bool loadMissingCatalog(const QVariantMap& catDesc, const QString& catalogFileName);
+	//! Open a catalog file, preferring its native cache. Does not change the grid levels, so it can run in a worker thread.
+	ZoneArray* openCatalog(const QString& catalogFilePath, qint64 lazyBudget) const;
+	//! Append an opened catalog as the next grid level.
+	void addCatalog(ZoneArray* z, const QString& catalogFileName);
+	//! The memory budget of the catalogs which are read on demand, from stars/lazy_loading_budget_mb
+	qint64 getLazyLoadingBudget() const;
+
+	//! Get the path of the native-endian, page-aligned copy of a star catalog
+	//! in the user directory, creating or refreshing it when needed.
+	//! @return the path of the cache, or an empty string if it could not be written.
+	QString getNativeCatalogCache(const QString& catalogFilePath) const;
+
 	//! Loads common names for stars from a file.
 	//! Called when the SkyCulture is updated.
 	//! @param the path to a file containing the common names for bright stars.
@@ -400,9 +487,25 @@ private:
 	void loadWds(const QString& WdsFile);
 
 	//! Loads cross-identification data from a file.
+	//! The parsed tables are kept in a binary cache in the user directory, which is read
+	//! instead of the text file as long as it is not older than the text file.
 	//! @param the path to a file containing the cross-identification data.
 	void loadCrossIdentificationData(const QString& crossIdFile);
 
+	//! Read the cross-identification tables from a binary cache written by writeCrossIdentificationCache().
+	//! @return false if the cache is missing or invalid
+	static bool readCrossIdentificationCache(const QString& cacheFile);
+	//! Write the cross-identification tables to a binary cache.
+	static bool writeCrossIdentificationCache(const QString& cacheFile);
+
+	//! Pack up to 4 Latin-1 characters of a component identifier (e.g. "A" or "AB") into an integer.
+	static unsigned int packComponentIds(const QString& ids);
+
+	//! Get the Hipparcos number for a number of another catalog.
+	//! @param index saoStarsIndex, hdStarsIndex or hrStarsIndex
+	//! @return the Hipparcos number, or 0 if the number is not in the index
+	static int getHipFromCatalogNumber(const QVector<catalognumber>& index, int number);
+
 	//! Gets the maximum search level.
 	// TODO: add a non-lame description - what is the purpose of the max search level?
 	int getMaxSearchLevel() const;
@@ -432,6 +535,30 @@ private:
 	
 	// A ZoneArray per grid level
 	QVector<ZoneArray*> gridLevels;
+
+	//! Draws faint catalogs from static OpenGL buffers when enabled
+	StarZoneRenderer* zoneRenderer;
+
+	//! Whether the zones of a catalog are projected and searched on the global thread pool
+	bool flagParallelZones;
+
+	//! Streamed catalogs which are not in gridLevels yet, ordered by level
+	QList<StarCatalogStream*> remoteCatalogs;
+	//! Whether the zones of gridLevels were initialized by init()
+	bool trianglesInitialized;
+
+	//! A catalog loaded by loadDeferredData()
+	struct DeferredCatalog
+	{
+		QVariantMap desc;
+		QString fileName;
+		QString filePath;
+		bool installed;
+		ZoneArray* zones;
+	};
+	//! The catalogs after the first one, with progressive initialization
+	QVector<DeferredCatalog> deferredCatalogs;
+	qint64 deferredLazyBudget;
 	static void initTriangleFunc(int lev, int index,
 								 const Vec3f &c0,
 								 const Vec3f &c1,
@@ -440,6 +567,17 @@ private:
 	{
 		reinterpret_cast<StarMgr*>(context)->initTriangle(lev, index, c0, c1, c2);
 	}
+	//! Like initTriangleFunc, but only for the last level, for catalogs added after init().
+	static void initLastLevelTriangleFunc(int lev, int index,
+					      const Vec3f &c0,
+					      const Vec3f &c1,
+					      const Vec3f &c2,
+					      void *context)
+	{
+		StarMgr* mgr = reinterpret_cast<StarMgr*>(context);
+		if (lev == mgr->maxGeodesicGridLevel)
+			mgr->initTriangle(lev, index, c0, c1, c2);
+	}
 
 	void initTriangle(int lev, int index,
 					  const Vec3f &c0,
@@ -458,6 +596,32 @@ private:
 	static QMap<QString, int> additionalNamesIndex;
 	static QMap<QString, int> additionalNamesIndexI18n;
 
+	//! Indices of the translated (0) and English (1) common and additional names,
+	//! for the searches of names containing a text in listMatchingObjects().
+	static StelObjectNameIndex commonNamesSearchIndex[2];
+	static StelObjectNameIndex additionalNamesSearchIndex[2];
+	//! Protects the search indices, which are used by listMatchingObjects() from the worker thread of the search dialog.
+	static QMutex namesSearchIndexMutex;
+
+	//! The translated names and their indices for a sky language.
+	struct NamesI18n
+	{
+		QHash<int, QString> commonNamesMap;
+		QMap<QString, int> commonNamesIndex;
+		QHash<int, QString> additionalNamesMap;
+		QMap<QString, int> additionalNamesIndex;
+		StelObjectNameIndex commonNamesSearchIndex;
+		StelObjectNameIndex additionalNamesSearchIndex;
+	};
+	//! The names of the languages used since the names of the sky culture were loaded. The containers are
+	//! implicitly shared, so updateI18n() switches back to a language without translating or indexing again.
+	static QHash<QString, NamesI18n> namesI18nCache;
+	//! Find the zones of the grid intersecting the limFov circle around position v.
+	const GeodesicSearchResult* searchAroundZones(const Vec3d& v, double limitFov, const StelCore* core) const;
+
+	//! Fill commonNamesSearchIndex and additionalNamesSearchIndex from the names maps.
+	static void updateNamesSearchIndex(bool inEnglish);
+
 	static QHash<int, QString> sciNamesMapI18n;	
 	static QMap<QString, int> sciNamesIndexI18n;
 
@@ -470,10 +634,11 @@ private:
 	static QHash<int, wds> wdsStarsMapI18n;
 	static QMap<QString, int> wdsStarsIndexI18n;
 
-	static QMap<QString, crossid> crossIdMap;
-	static QMap<int, int> saoStarsIndex;
-	static QMap<int, int> hdStarsIndex;
-	static QMap<int, int> hrStarsIndex;
+	// Flat tables sorted by hip and component, and by catalog number.
+	static QVector<crossid> crossIdData;
+	static QVector<catalognumber> saoStarsIndex;
+	static QVector<catalognumber> hdStarsIndex;
+	static QVector<catalognumber> hrStarsIndex;
 
 	static QHash<int, QString> referenceMap;
 
@@ -93,107 +93,115 @@ QString StarWrapper1::getInfoString(const StelCore *core, const InfoStringGroup&
 	const double vEpoch = StarMgr::getGcvsEpoch(s->getHip());
 	const double vPeriod = StarMgr::getGcvsPeriod(s->getHip());
 	const int vMm = StarMgr::getGcvsMM(s->getHip());
-	if (s->getHip())
+	// The eclipsing binary systems give times of minimum instead of maximum light
+	bool ebsFlag = false;
+	QString varstartype = "";
+	if(!varType.isEmpty())
 	{
-		if ((flags&Name) || (flags&CatalogNumber))
-			oss << "<h2>";
-
-		const QString commonNameI18 = StarMgr::getCommonName(s->getHip());
-		const QString additionalNameI18 = StarMgr::getAdditionalNames(s->getHip());
-		const QString sciName = StarMgr::getSciName(s->getHip());
-		const QString addSciName = StarMgr::getSciAdditionalName(s->getHip());
-		const QString varSciName = StarMgr::getGcvsName(s->getHip());
-		const QString wdsSciName = StarMgr::getWdsName(s->getHip());
-		QStringList designations;
-		if (!sciName.isEmpty())
-			designations.append(sciName);
-		if (!addSciName.isEmpty())
-			designations.append(addSciName);
-		if (!varSciName.isEmpty() && varSciName!=addSciName && varSciName!=sciName)
-			designations.append(varSciName);
-
-		QString hip, hipq;
-		if (s->hasComponentID())
+		if (QString("FU GCAS I IA IB IN INA INB INT IT IN(YY) IS ISA ISB RCB RS SDOR UV UVN WR").contains(varType))
+			varstartype = q_("eruptive variable star");
+		else if (QString("ACYG BCEP BCEPS CEP CEP(B) CW CWA CWB DCEP DCEPS DSCT DSCTC GDOR L LB LC M PVTEL RPHS RR RR(B) RRAB RRC RV RVA RVB SR SRA SRB SRC SRD SXPHE ZZ ZZA ZZB").contains(varType))
+			varstartype = q_("pulsating variable star");
+		else if (QString("ACV, ACVO, BY, ELL, FKCOM, PSR, SXARI").contains(varType))
+			varstartype = q_("rotating variable star");
+		else if (QString("N NA NB NC NL NR SN SNI SNII UG UGSS UGSU UGZ ZAND").contains(varType))
+			varstartype = q_("cataclysmic variable star");
+		else if (QString("E EA EB EW GS PN RS WD WR AR D DM DS DW K KE KW SD E: E:/WR E/D E+LPB: EA/D EA/D+BY EA/RS EA/SD EA/SD: EA/GS EA/GS+SRC EA/DM EA/WR EA+LPB EA+LPB: EA+DSCT EA+BCEP: EA+ZAND EA+ACYG EA+SRD EB/GS EB/DM EB/KE EB/KE: EW/KE EA/AR/RS EA/GS/D EA/D/WR").contains(varType))
 		{
-			hip = QString("HIP %1 %2").arg(s->getHip()).arg(StarMgr::convertToComponentIds(s->getComponentIds()));
-			hipq = QString("%1%2").arg(s->getHip()).arg(StarMgr::convertToComponentIds(s->getComponentIds()));
+			varstartype = q_("eclipsing binary system");
+			ebsFlag = true;
 		}
 		else
+			varstartype = q_("variable star");
+	}
+
+	// Names, designations and type do not change with time
+	oss << getStaticInfoString(0, flags, StarMgr::getFlagAdditionalNames(), [&]()
+	{
+		QString text;
+		QTextStream oss(&text);
+		if (s->getHip())
 		{
-			hip = QString("HIP %1").arg(s->getHip());
-			hipq = QString("%1").arg(s->getHip());
-		}
+			if ((flags&Name) || (flags&CatalogNumber))
+				oss << "<h2>";
+
+			const QString commonNameI18 = StarMgr::getCommonName(s->getHip());
+			const QString additionalNameI18 = StarMgr::getAdditionalNames(s->getHip());
+			const QString sciName = StarMgr::getSciName(s->getHip());
+			const QString addSciName = StarMgr::getSciAdditionalName(s->getHip());
+			const QString varSciName = StarMgr::getGcvsName(s->getHip());
+			const QString wdsSciName = StarMgr::getWdsName(s->getHip());
+			QStringList designations;
+			if (!sciName.isEmpty())
+				designations.append(sciName);
+			if (!addSciName.isEmpty())
+				designations.append(addSciName);
+			if (!varSciName.isEmpty() && varSciName!=addSciName && varSciName!=sciName)
+				designations.append(varSciName);
+
+			QString hip, hipq;
+			if (s->hasComponentID())
+			{
+				hip = QString("HIP %1 %2").arg(s->getHip()).arg(StarMgr::convertToComponentIds(s->getComponentIds()));
+				hipq = QString("%1%2").arg(s->getHip()).arg(StarMgr::convertToComponentIds(s->getComponentIds()));
+			}
+			else
+			{
+				hip = QString("HIP %1").arg(s->getHip());
+				hipq = QString("%1").arg(s->getHip());
+			}
 
-		designations.append(hip);
+			designations.append(hip);
 
-		const QString crossIndexData = StarMgr::getCrossIdentificationDesignations(hipq);
-		if (!crossIndexData.isEmpty())
-			designations.append(crossIndexData);
+			const QString crossIndexData = StarMgr::getCrossIdentificationDesignations(hipq);
+			if (!crossIndexData.isEmpty())
+				designations.append(crossIndexData);
 
-		if (!wdsSciName.isEmpty() && wdsSciName!=addSciName && wdsSciName!=sciName)
-			designations.append(wdsSciName);
+			if (!wdsSciName.isEmpty() && wdsSciName!=addSciName && wdsSciName!=sciName)
+				designations.append(wdsSciName);
 
-		const QString designationsList = designations.join(" - ");
+			const QString designationsList = designations.join(" - ");
 
-		if (flags&Name)
-		{
-			if (!commonNameI18.isEmpty())
-				oss << commonNameI18;
+			if (flags&Name)
+			{
+				if (!commonNameI18.isEmpty())
+					oss << commonNameI18;
 
-			if (!additionalNameI18.isEmpty() && StarMgr::getFlagAdditionalNames())
-				oss << " (" << additionalNameI18 << ")";
+				if (!additionalNameI18.isEmpty() && StarMgr::getFlagAdditionalNames())
+					oss << " (" << additionalNameI18 << ")";
 
-			if (!commonNameI18.isEmpty() && !designationsList.isEmpty() && flags&CatalogNumber)
-				oss << "<br />";
-		}
+				if (!commonNameI18.isEmpty() && !designationsList.isEmpty() && flags&CatalogNumber)
+					oss << "<br />";
+			}
 
-		if (flags&CatalogNumber)
-			oss << designationsList;
+			if (flags&CatalogNumber)
+				oss << designationsList;
 
-		if ((flags&Name) || (flags&CatalogNumber))
-			oss << "</h2>";
-	}
+			if ((flags&Name) || (flags&CatalogNumber))
+				oss << "</h2>";
+		}
 
-	bool ebsFlag = false;
-	if (flags&ObjectType)
-	{
-		QString varstartype = "";
-		QString startype = "";
-		if(!varType.isEmpty())
+		if (flags&ObjectType)
 		{
-			if (QString("FU GCAS I IA IB IN INA INB INT IT IN(YY) IS ISA ISB RCB RS SDOR UV UVN WR").contains(varType))
-				varstartype = q_("eruptive variable star");
-			else if (QString("ACYG BCEP BCEPS CEP CEP(B) CW CWA CWB DCEP DCEPS DSCT DSCTC GDOR L LB LC M PVTEL RPHS RR RR(B) RRAB RRC RV RVA RVB SR SRA SRB SRC SRD SXPHE ZZ ZZA ZZB").contains(varType))
-				varstartype = q_("pulsating variable star");
-			else if (QString("ACV, ACVO, BY, ELL, FKCOM, PSR, SXARI").contains(varType))
-				varstartype = q_("rotating variable star");
-			else if (QString("N NA NB NC NL NR SN SNI SNII UG UGSS UGSU UGZ ZAND").contains(varType))
-				varstartype = q_("cataclysmic variable star");
-			else if (QString("E EA EB EW GS PN RS WD WR AR D DM DS DW K KE KW SD E: E:/WR E/D E+LPB: EA/D EA/D+BY EA/RS EA/SD EA/SD: EA/GS EA/GS+SRC EA/DM EA/WR EA+LPB EA+LPB: EA+DSCT EA+BCEP: EA+ZAND EA+ACYG EA+SRD EB/GS EB/DM EB/KE EB/KE: EW/KE EA/AR/RS EA/GS/D EA/D/WR").contains(varType))
+			QString startype = "";
+			if (s->getComponentIds() || wdsObs>0)
+				startype = q_("double star");
+			else
+				startype = q_("star");
+
+			if (!varType.isEmpty())
 			{
-				varstartype = q_("eclipsing binary system");
-				ebsFlag = true;
+				QString vtt = varstartype;
+				if (s->getComponentIds() || wdsObs>0)
+					vtt = QString("%1, %2").arg(varstartype, startype);
+				oss << QString("%1: <b>%2</b> (%3)").arg(q_("Type"), vtt, varType) << "<br />";
 			}
 			else
-				varstartype = q_("variable star");
-		}
-
-		if (s->getComponentIds() || wdsObs>0)
-			startype = q_("double star");
-		else
-			startype = q_("star");
+				oss << QString("%1: <b>%2</b>").arg(q_("Type"), startype) << "<br />";
 
-		if (!varType.isEmpty())
-		{
-			QString vtt = varstartype;
-			if (s->getComponentIds() || wdsObs>0)
-				vtt = QString("%1, %2").arg(varstartype, startype);
-			oss << QString("%1: <b>%2</b> (%3)").arg(q_("Type"), vtt, varType) << "<br />";
 		}
-		else
-			oss << QString("%1: <b>%2</b>").arg(q_("Type"), startype) << "<br />";
-
-	}
+		return text;
+	});
 
 	oss << getMagnitudeInfoString(core, flags, alt_app, 2);
 
@@ -228,24 +236,34 @@ QString StarWrapper1::getInfoString(const StelCore *core, const InfoStringGroup&
 
 	oss << getCommonInfoString(core, flags);
 
-	if ((flags&Distance) && s->getPlx ()&& !isNan(s->getPlx()) && !isInf(s->getPlx()))
+	// Catalog data
+	oss << getStaticInfoString(1, flags, 0, [&]()
 	{
-		//TRANSLATORS: Unit of measure for distance - Light Years
-		QString ly = qc_("ly", "distance");
-		oss << QString("%1: %2 %3").arg(q_("Distance"), QString::number((AU/(SPEED_OF_LIGHT*86400*365.25))/(s->getPlx()*((0.00001/3600)*(M_PI/180))), 'f', 2), ly) << "<br />";
-	}
+		QString text;
+		QTextStream oss(&text);
+		if ((flags&Distance) && s->getPlx ()&& !isNan(s->getPlx()) && !isInf(s->getPlx()))
+		{
+			//TRANSLATORS: Unit of measure for distance - Light Years
+			QString ly = qc_("ly", "distance");
+			oss << QString("%1: %2 %3").arg(q_("Distance"), QString::number((AU/(SPEED_OF_LIGHT*86400*365.25))/(s->getPlx()*((0.00001/3600)*(M_PI/180))), 'f', 2), ly) << "<br />";
+		}
 
-	if (flags&Extra)
-	{
-		if (s->getSpInt())
-			oss << QString("%1: %2").arg(q_("Spectral Type"), StarMgr::convertToSpectralType(s->getSpInt())) << "<br />";
+		if (flags&Extra)
+		{
+			if (s->getSpInt())
+				oss << QString("%1: %2").arg(q_("Spectral Type"), StarMgr::convertToSpectralType(s->getSpInt())) << "<br />";
 
-		if (s->getPlx())
-			oss << QString("%1: %2\"").arg(q_("Parallax"), QString::number(0.00001*s->getPlx(), 'f', 5)) << "<br />";
+			if (s->getPlx())
+				oss << QString("%1: %2\"").arg(q_("Parallax"), QString::number(0.00001*s->getPlx(), 'f', 5)) << "<br />";
 
-		if (vPeriod>0)
-			oss << QString("%1: %2 %3").arg(q_("Period")).arg(vPeriod).arg(qc_("days", "duration")) << "<br />";
+			if (vPeriod>0)
+				oss << QString("%1: %2 %3").arg(q_("Period")).arg(vPeriod).arg(qc_("days", "duration")) << "<br />";
+		}
+		return text;
+	});
 
+	if (flags&Extra)
+	{
 		if (vEpoch>0 && vPeriod>0)
 		{
 			// Calculate next minimum or maximum light
@@ -258,38 +276,47 @@ QString StarWrapper1::getInfoString(const StelCore *core, const InfoStringGroup&
 
 			oss << QString("%1: %2 UTC").arg(dateStr, nextDate) << "<br />";
 		}
+	}
 
-		if (vMm>0)
+	oss << getStaticInfoString(2, flags, 0, [&]()
+	{
+		QString text;
+		QTextStream oss(&text);
+		if (flags&Extra)
 		{
-			QString mmStr = q_("Rising time");
-			if (ebsFlag)
-				mmStr = q_("Duration of eclipse");
+			if (vMm>0)
+			{
+				QString mmStr = q_("Rising time");
+				if (ebsFlag)
+					mmStr = q_("Duration of eclipse");
 
-			oss << QString("%1: %2%").arg(mmStr).arg(vMm) << "<br />";
-		}
+				oss << QString("%1: %2%").arg(mmStr).arg(vMm) << "<br />";
+			}
 
-		if (wdsObs>0)
-		{
-			oss << QString("%1 (%4): %2%3").arg(q_("Position angle")).arg(QString::number(wdsPA, 'f', 2)).arg(QChar(0x00B0)).arg(wdsObs) << "<br />";
-			if (wdsSep>0.f) // A spectroscopic binary or not?
+			if (wdsObs>0)
 			{
-				if (wdsSep>60.f) // A wide binary star?
-					oss << QString("%1 (%4): %2\" (%3)").arg(q_("Separation")).arg(QString::number(wdsSep, 'f', 3)).arg(StelUtils::decDegToDmsStr(wdsSep/3600.f)).arg(wdsObs) << "<br />";
-				else
-					oss << QString("%1 (%3): %2\"").arg(q_("Separation")).arg(QString::number(wdsSep, 'f', 3)).arg(wdsObs) << "<br />";
+				oss << QString("%1 (%4): %2%3").arg(q_("Position angle")).arg(QString::number(wdsPA, 'f', 2)).arg(QChar(0x00B0)).arg(wdsObs) << "<br />";
+				if (wdsSep>0.f) // A spectroscopic binary or not?
+				{
+					if (wdsSep>60.f) // A wide binary star?
+						oss << QString("%1 (%4): %2\" (%3)").arg(q_("Separation")).arg(QString::number(wdsSep, 'f', 3)).arg(StelUtils::decDegToDmsStr(wdsSep/3600.f)).arg(wdsObs) << "<br />";
+					else
+						oss << QString("%1 (%3): %2\"").arg(q_("Separation")).arg(QString::number(wdsSep, 'f', 3)).arg(wdsObs) << "<br />";
+				}
 			}
-		}
 
-		float dx = 0.1*s->getDx0();
-		float dy = 0.1*s->getDx1();
-		float pa = 90.f - std::atan2(dy, dx)*180.f/M_PI;
-		if (pa<0)
-			pa += 360.f;
+			float dx = 0.1*s->getDx0();
+			float dy = 0.1*s->getDx1();
+			float pa = 90.f - std::atan2(dy, dx)*180.f/M_PI;
+			if (pa<0)
+				pa += 360.f;
 
-		oss << QString("%1: %2 %3 (%4)").arg(q_("Proper motions by axes")).arg(QString::number(dx, 'f', 1)).arg(QString::number(dy, 'f', 1)).arg(qc_("mas/yr", "milliarc second per year")) << "<br />";
-		oss << QString("%1: %2%3").arg(q_("Position angle of the proper motion")).arg(QString::number(pa,'f', 1)).arg(QChar(0x00B0)) << "<br />";
-		oss << QString("%1: %2 (%3)").arg(q_("Angular speed of the proper motion")).arg(QString::number(std::sqrt(dx*dx + dy*dy), 'f', 1)).arg(qc_("mas/yr", "milliarc second per year")) << "<br />";
-	}
+			oss << QString("%1: %2 %3 (%4)").arg(q_("Proper motions by axes")).arg(QString::number(dx, 'f', 1)).arg(QString::number(dy, 'f', 1)).arg(qc_("mas/yr", "milliarc second per year")) << "<br />";
+			oss << QString("%1: %2%3").arg(q_("Position angle of the proper motion")).arg(QString::number(pa,'f', 1)).arg(QChar(0x00B0)) << "<br />";
+			oss << QString("%1: %2 (%3)").arg(q_("Angular speed of the proper motion")).arg(QString::number(std::sqrt(dx*dx + dy*dy), 'f', 1)).arg(qc_("mas/yr", "milliarc second per year")) << "<br />";
+		}
+		return text;
+	});
 
 	StelObject::postProcessInfoString(str, flags);
 
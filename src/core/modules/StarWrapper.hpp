@@ -64,6 +64,10 @@ protected:
 	QString getInfoString(const StelCore *core, const InfoStringGroup& flags) const;
 	virtual float getBV(void) const = 0;
 
+public:
+	//! Get the id of the star in its catalog, see ZoneArray::getPickId().
+	virtual quint64 getCatalogId(void) const = 0;
+
 private:
 	int ref_count;
 };
@@ -73,7 +77,7 @@ template <class Star> class StarWrapper : public StarWrapperBase
 protected:
 	StarWrapper(const SpecialZoneArray<Star> *a,
 		const SpecialZoneData<Star> *z,
-		const Star *s) : a(a), z(z), s(s) {;}
+		const Star *s) : a(a), z(z), star(*s), s(&star), starIndex(static_cast<int>(s - z->getStars())) {;}
 	Vec3d getJ2000EquatorialPos(const StelCore* core) const
 	{
 		static const double d2000 = 2451545.0;
@@ -94,10 +98,15 @@ protected:
 	QString getEnglishName(void) const {return QString();}
 	QString getNameI18n(void) const {return s->getNameI18n();}
 	virtual double getAngularSize(const StelCore*) const {return 0.;}	
+	quint64 getCatalogId(void) const {return a->getPickId(a->getZoneIndex(z), starIndex);}
 protected:
 	const SpecialZoneArray<Star> *const a;
 	const SpecialZoneData<Star> *const z;
+	// Keep a copy of the star: with lazy loading its zone may be released while the wrapper is alive.
+	const Star star;
 	const Star *const s;
+	// Index of the star in its zone, for getCatalogId().
+	const int starIndex;
 };
 
 
@@ -0,0 +1,288 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StarZoneRenderer.hpp"
+#include "ZoneArray.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelFileMgr.hpp"
+#include "StelGeodesicGrid.hpp"
+#include "StelPainter.hpp"
+#include "StelProjector.hpp"
+#include "StelSkyDrawer.hpp"
+#include "StelTexture.hpp"
+#include "StelTextureMgr.hpp"
+
+#include <QDebug>
+#include <QMatrix4x4>
+#include <QOpenGLContext>
+#include <QOpenGLShaderProgram>
+#include <QSettings>
+#if QT_VERSION >= 0x050600
+#include <QOpenGLExtraFunctions>
+#endif
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+static_assert(sizeof(StarZoneRecord) == 20, "Size of StarZoneRecord must be 20 bytes");
+
+// Only the first 256 entries of a RCMag table are used: magnitude steps of stars are stored in one byte.
+static const int STATIC_RCMAG_TABLE_SIZE = 256;
+
+StarZoneRenderer::StarZoneRenderer()
+	: flagEnabled(false)
+	, flagAvailable(false)
+	, epochTolerance(365.25)
+	, maxStarsPerLevel(10000000)
+	, cornerBuffer(QOpenGLBuffer::VertexBuffer)
+{
+}
+
+StarZoneRenderer::~StarZoneRenderer()
+{
+	clear();
+	qDeleteAll(programs);
+	programs.clear();
+}
+
+void StarZoneRenderer::init()
+{
+	QSettings* conf = StelApp::getInstance().getSettings();
+	flagEnabled = conf->value("stars/flag_static_zone_buffers", false).toBool();
+	epochTolerance = conf->value("stars/static_zone_buffers_epoch_tolerance", 365.25).toDouble();
+	maxStarsPerLevel = conf->value("stars/static_zone_buffers_max_stars", 10000000).toInt();
+	if (!flagEnabled || StelApp::getInstance().isHeadless())
+		return;
+
+#if QT_VERSION >= 0x050600
+	QOpenGLContext* ctx = QOpenGLContext::currentContext();
+	const QPair<int, int> version = ctx->format().version();
+	if (version < (ctx->isOpenGLES() ? qMakePair(3, 0) : qMakePair(3, 3)))
+	{
+		qWarning() << "StarZoneRenderer: static zone buffers need OpenGL 3.3 or OpenGL ES 3.0, disabled";
+		return;
+	}
+
+	// Corners of the sprite as a triangle strip, shared by all instances
+	static const GLfloat corners[] = {-1.f, -1.f, 1.f, -1.f, -1.f, 1.f, 1.f, 1.f};
+	cornerBuffer.create();
+	cornerBuffer.bind();
+	cornerBuffer.allocate(corners, sizeof(corners));
+	cornerBuffer.release();
+
+	texHalo = StelApp::getInstance().getTextureManager().createTexture(StelFileMgr::getInstallationDir()+"/textures/star16x16.png");
+	flagAvailable = true;
+#else
+	qWarning() << "StarZoneRenderer: static zone buffers need Qt 5.6 or later, disabled";
+#endif
+}
+
+bool StarZoneRenderer::isUsable(const StelProjectorP& prj) const
+{
+	return flagEnabled && flagAvailable && !prj->getForwardTransformShader().isEmpty();
+}
+
+void StarZoneRenderer::clear()
+{
+	for (auto* lb : levelBuffers)
+	{
+		StelApp::getInstance().getTextureManager().unregisterGLBuffer(&lb->buffer);
+		lb->buffer.destroy();
+		delete lb;
+	}
+	levelBuffers.clear();
+	cornerBuffer.destroy();
+}
+
+StarZoneRenderer::LevelBuffers* StarZoneRenderer::getLevelBuffers(const ZoneArray* z)
+{
+	LevelBuffers* lb = levelBuffers.value(z, Q_NULLPTR);
+	if (lb)
+		return lb;
+	if (z->getNrOfStars() > (unsigned int)maxStarsPerLevel)
+		return Q_NULLPTR;
+
+	lb = new LevelBuffers();
+	lb->zoneStart.resize(z->getNrOfZones());
+	lb->zoneEpoch.fill(std::numeric_limits<double>::quiet_NaN(), z->getNrOfZones());
+	int start = 0;
+	for (unsigned int i=0;i<z->getNrOfZones();++i)
+	{
+		lb->zoneStart[i] = start;
+		start += z->getZoneSize(i);
+	}
+	lb->buffer.create();
+	lb->buffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+	lb->buffer.bind();
+	// Zones are uploaded the first time they are drawn
+	lb->buffer.allocate(start*sizeof(StarZoneRecord));
+	lb->buffer.release();
+	StelApp::getInstance().getTextureManager().registerGLBuffer(&lb->buffer, QString("StarZoneRenderer level %1").arg(z->level), static_cast<qint64>(start)*sizeof(StarZoneRecord));
+	levelBuffers.insert(z, lb);
+	qDebug() << "StarZoneRenderer: created static buffer for level" << z->level << "with" << start << "stars";
+	return lb;
+}
+
+QOpenGLShaderProgram* StarZoneRenderer::getProgram(const QByteArray& projectorShader)
+{
+	QOpenGLShaderProgram* program = programs.value(projectorShader, Q_NULLPTR);
+	if (program)
+		return program;
+
+	QOpenGLShader vshader(QOpenGLShader::Vertex);
+	const QByteArray vsrc =
+		"attribute mediump vec2 corner;\n"
+		"attribute highp vec3 pos;\n"
+		"attribute mediump float mag;\n"
+		"attribute mediump vec3 color;\n"
+		"uniform mediump mat4 projectionMatrix;\n"
+		"uniform mediump vec4 rcmag[128];\n"
+		"varying mediump vec2 texc;\n"
+		"varying mediump vec3 outColor;\n"
+		+ projectorShader +
+		"void main(void)\n"
+		"{\n"
+		"    vec4 win = projectToViewport(pos);\n"
+		"    float i = floor(mag + 0.5);\n"
+		"    vec4 entry = rcmag[int(floor(i*0.5))];\n"
+		"    vec2 rl = (mod(i, 2.0) < 0.5) ? entry.xy : entry.zw;\n"
+		"    float radius = (win.w > 0.5) ? rl.x : 0.0;\n"
+		"    gl_Position = projectionMatrix * vec4(win.xy + corner*radius, 0, 1);\n"
+		"    texc = corner*0.5 + 0.5;\n"
+		"    outColor = min(color*rl.y, vec3(1.0));\n"
+		"}\n";
+	vshader.compileSourceCode(vsrc);
+	if (!vshader.log().isEmpty()) { qWarning() << "StarZoneRenderer::getProgram(): Warnings while compiling vshader: " << vshader.log(); }
+
+	QOpenGLShader fshader(QOpenGLShader::Fragment);
+	const char *fsrc =
+		"varying mediump vec2 texc;\n"
+		"varying mediump vec3 outColor;\n"
+		"uniform sampler2D tex;\n"
+		"void main(void)\n"
+		"{\n"
+		"    gl_FragColor = texture2D(tex, texc)*vec4(outColor, 1.);\n"
+		"}\n";
+	fshader.compileSourceCode(fsrc);
+	if (!fshader.log().isEmpty()) { qWarning() << "StarZoneRenderer::getProgram(): Warnings while compiling fshader: " << fshader.log(); }
+
+	program = new QOpenGLShaderProgram();
+	program->addShader(&vshader);
+	program->addShader(&fshader);
+	if (!StelPainter::linkProg(program, "starZoneShader"))
+	{
+		// Do not try again with this projection
+		qWarning() << "StarZoneRenderer: cannot link shader, static zone buffers disabled";
+		flagAvailable = false;
+		delete program;
+		return Q_NULLPTR;
+	}
+	programs.insert(projectorShader, program);
+	return program;
+}
+
+bool StarZoneRenderer::drawZones(StelPainter* sPainter, const ZoneArray* z, const GeodesicSearchResult& result,
+				  const RCMag* rcmag_table, int limitMagIndex, StelCore* core)
+{
+#if QT_VERSION >= 0x050600
+	const StelProjectorP& prj = sPainter->getProjector();
+	LevelBuffers* lb = getLevelBuffers(z);
+	if (!lb)
+		return false;
+	QOpenGLShaderProgram* program = getProgram(prj->getForwardTransformShader());
+	if (!program)
+		return false;
+
+	QOpenGLExtraFunctions* gl = QOpenGLContext::currentContext()->extraFunctions();
+	const int cutoffMagStep = z->getCutoffMagStep(core->getSkyDrawer(), limitMagIndex);
+	const double jde = core->getJDE();
+
+	texHalo->bind();
+	sPainter->setBlending(true, GL_ONE, GL_ONE);
+
+	const Mat4f& m = prj->getProjectionMatrix();
+	const QMatrix4x4 qMat(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
+
+	program->bind();
+	program->setUniformValue("projectionMatrix", qMat);
+	program->setUniformValueArray("rcmag", reinterpret_cast<const GLfloat*>(rcmag_table), STATIC_RCMAG_TABLE_SIZE/2, 4);
+	prj->setForwardTransformUniforms(*program);
+
+	const int cornerLoc = program->attributeLocation("corner");
+	const int posLoc = program->attributeLocation("pos");
+	const int magLoc = program->attributeLocation("mag");
+	const int colorLoc = program->attributeLocation("color");
+
+	cornerBuffer.bind();
+	program->setAttributeBuffer(cornerLoc, GL_FLOAT, 0, 2, 0);
+	program->enableAttributeArray(cornerLoc);
+	lb->buffer.bind();
+	program->enableAttributeArray(posLoc);
+	program->enableAttributeArray(magLoc);
+	program->enableAttributeArray(colorLoc);
+	gl->glVertexAttribDivisor(posLoc, 1);
+	gl->glVertexAttribDivisor(magLoc, 1);
+	gl->glVertexAttribDivisor(colorLoc, 1);
+
+	QVector<StarZoneRecord> records;
+	auto drawZone = [&](int zone)
+	{
+		const int count = z->getNrOfStarsUpToMagStep(zone, cutoffMagStep);
+		if (count == 0)
+			return;
+		const int start = lb->zoneStart[zone];
+		double& epoch = lb->zoneEpoch[zone];
+		// NaN compares false, so never uploaded zones are caught by the first test
+		if (!(std::fabs(jde - epoch) <= epochTolerance))
+		{
+			records.resize(z->getZoneSize(zone));
+			z->fillStaticBuffer(zone, jde, records.data());
+			lb->buffer.write(start*sizeof(StarZoneRecord), records.constData(), records.size()*sizeof(StarZoneRecord));
+			epoch = jde;
+		}
+		const int offset = start*sizeof(StarZoneRecord);
+		program->setAttributeBuffer(posLoc, GL_FLOAT, offset, 3, sizeof(StarZoneRecord));
+		program->setAttributeBuffer(magLoc, GL_FLOAT, offset + offsetof(StarZoneRecord, mag), 1, sizeof(StarZoneRecord));
+		program->setAttributeBuffer(colorLoc, GL_UNSIGNED_BYTE, offset + offsetof(StarZoneRecord, color), 3, sizeof(StarZoneRecord));
+		gl->glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+	};
+
+	int zone;
+	for (GeodesicSearchInsideIterator it1(result,z->level);(zone = it1.next()) >= 0;)
+		drawZone(zone);
+	for (GeodesicSearchBorderIterator it1(result,z->level);(zone = it1.next()) >= 0;)
+		drawZone(zone);
+
+	gl->glVertexAttribDivisor(posLoc, 0);
+	gl->glVertexAttribDivisor(magLoc, 0);
+	gl->glVertexAttribDivisor(colorLoc, 0);
+	program->disableAttributeArray(cornerLoc);
+	program->disableAttributeArray(posLoc);
+	program->disableAttributeArray(magLoc);
+	program->disableAttributeArray(colorLoc);
+	lb->buffer.release();
+	program->release();
+	return true;
+#else
+	Q_UNUSED(sPainter); Q_UNUSED(z); Q_UNUSED(result); Q_UNUSED(rcmag_table); Q_UNUSED(limitMagIndex); Q_UNUSED(core);
+	return false;
+#endif
+}
@@ -0,0 +1,109 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STARZONERENDERER_HPP
+#define STARZONERENDERER_HPP
+
+#include "VecMath.hpp"
+#include "StelProjectorType.hpp"
+#include "StelTextureTypes.hpp"
+
+#include <QByteArray>
+#include <QHash>
+#include <QOpenGLBuffer>
+#include <QVector>
+
+class ZoneArray;
+class StelCore;
+class StelPainter;
+class GeodesicSearchResult;
+class QOpenGLShaderProgram;
+struct RCMag;
+
+//! @struct StarZoneRecord
+//! Vertex data of one star in the static buffers of StarZoneRenderer.
+struct StarZoneRecord
+{
+	Vec3f pos;		// J2000 unit vector, with proper motion applied for the epoch of the buffer
+	float mag;		// magnitude step of the star in its catalog
+	unsigned char color[4];	// color matching the B-V index of the star
+};
+
+//! @class StarZoneRenderer
+//! Draws the faint stars of a ZoneArray from static OpenGL buffers.
+//! The positions of the stars of each zone are uploaded once, and projected by a vertex shader
+//! generated from StelProjector::getForwardTransformShader(). The CPU only uploads the table of
+//! RCMag of the catalog level, and issues one instanced draw call per visible zone.
+//! Buffers are refreshed when the simulation time drifts more than a configurable tolerance
+//! from the epoch for which proper motion was applied.
+//! This is used only for catalogs without named stars, without extinction and for projections
+//! which can be evaluated on the GPU. Stars do not twinkle in this mode.
+class StarZoneRenderer
+{
+public:
+	StarZoneRenderer();
+	~StarZoneRenderer();
+
+	//! Read the settings and check that the OpenGL context supports instancing. Requires a valid context.
+	void init();
+
+	//! Get whether the static buffers can be used for drawing with the given projector.
+	bool isUsable(const StelProjectorP& prj) const;
+
+	//! Draw all the stars of the zones of a catalog found by a geodesic search.
+	//! @param sPainter the painter to use
+	//! @param z the catalog to draw. z->supportsStaticBuffers() must return true.
+	//! @param result the result of the geodesic search for visible zones
+	//! @param rcmag_table table of magnitudes for this catalog
+	//! @param limitMagIndex index from rcmag_table at which stars are not visible anymore
+	//! @param core core to use for drawing
+	//! @return false if this catalog is too large for static buffers, in which case nothing was drawn
+	bool drawZones(StelPainter* sPainter, const ZoneArray* z, const GeodesicSearchResult& result,
+		       const RCMag* rcmag_table, int limitMagIndex, StelCore* core);
+
+	//! Release all OpenGL buffers. Requires a valid context.
+	void clear();
+
+private:
+	struct LevelBuffers
+	{
+		QOpenGLBuffer buffer;
+		QVector<int> zoneStart;		// index of the first star of each zone in buffer
+		QVector<double> zoneEpoch;	// JDE for which the zone data was uploaded, NaN if not uploaded yet
+	};
+
+	//! Get the buffers of a catalog, creating them on first use.
+	//! @return Q_NULLPTR if the catalog is too large.
+	LevelBuffers* getLevelBuffers(const ZoneArray* z);
+
+	//! Get the shader program for a projector shader, compiling it on first use.
+	QOpenGLShaderProgram* getProgram(const QByteArray& projectorShader);
+
+	bool flagEnabled;
+	bool flagAvailable;
+	double epochTolerance;
+	int maxStarsPerLevel;
+
+	QOpenGLBuffer cornerBuffer;
+	QHash<const ZoneArray*, LevelBuffers*> levelBuffers;
+	QHash<QByteArray, QOpenGLShaderProgram*> programs;
+	StelTextureSP texHalo;
+};
+
+#endif // STARZONERENDERER_HPP
@@ -0,0 +1,232 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StaticSphereRenderer.hpp"
+#include "RefractionExtinction.hpp"
+#include "StelApp.hpp"
+#include "StelPainter.hpp"
+#include "StelProjector.hpp"
+#include "StelTextureMgr.hpp"
+#include "StelVertexArray.hpp"
+#include "SaturationShader.hpp"
+
+#include <QDebug>
+#include <QGenericMatrix>
+#include <QMatrix4x4>
+#include <QOpenGLContext>
+#include <QOpenGLShaderProgram>
+#include <QSettings>
+#include <QVector>
+
+#include <cmath>
+
+StaticSphereRenderer::StaticSphereRenderer()
+	: flagEnabled(false)
+	, flagAvailable(false)
+	, indexCount(0)
+	, vertexBuffer(QOpenGLBuffer::VertexBuffer)
+	, indexBuffer(QOpenGLBuffer::IndexBuffer)
+{
+}
+
+StaticSphereRenderer::~StaticSphereRenderer()
+{
+	clear();
+	qDeleteAll(programs);
+	programs.clear();
+}
+
+void StaticSphereRenderer::init(const StelVertexArray& sphere)
+{
+	QSettings* conf = StelApp::getInstance().getSettings();
+	flagEnabled = conf->value("video/flag_static_sphere_buffers", true).toBool();
+	if (!flagEnabled || StelApp::getInstance().isHeadless())
+		return;
+	Q_ASSERT(sphere.isTextured());
+	Q_ASSERT(sphere.primitiveType==StelVertexArray::Triangles);
+
+	// Interleaved position and texture coordinates
+	QVector<GLfloat> vertices;
+	vertices.reserve(sphere.vertex.size()*5);
+	for (int i=0;i<sphere.vertex.size();++i)
+	{
+		const Vec3d& v = sphere.vertex.at(i);
+		const Vec2f& t = sphere.texCoords.at(i);
+		vertices << v[0] << v[1] << v[2] << t[0] << t[1];
+	}
+	QVector<unsigned short> indices = sphere.indices;
+	if (indices.isEmpty())
+	{
+		for (int i=0;i<sphere.vertex.size();++i)
+			indices << i;
+	}
+
+	vertexBuffer.create();
+	vertexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+	vertexBuffer.bind();
+	vertexBuffer.allocate(vertices.constData(), vertices.size()*sizeof(GLfloat));
+	vertexBuffer.release();
+	indexBuffer.create();
+	indexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+	indexBuffer.bind();
+	indexBuffer.allocate(indices.constData(), indices.size()*sizeof(unsigned short));
+	indexBuffer.release();
+	StelApp::getInstance().getTextureManager().registerGLBuffer(this, "StaticSphereRenderer", vertices.size()*sizeof(GLfloat) + indices.size()*sizeof(unsigned short));
+	indexCount = indices.size();
+	flagAvailable = true;
+}
+
+bool StaticSphereRenderer::isUsable(const StelProjectorP& prj) const
+{
+	// Triangles crossing a discontinuity must be removed on the CPU
+	return flagEnabled && flagAvailable && !prj->hasDiscontinuity() && !prj->getForwardTransformShader().isEmpty();
+}
+
+void StaticSphereRenderer::clear()
+{
+	vertexBuffer.destroy();
+	indexBuffer.destroy();
+	StelApp::getInstance().getTextureManager().unregisterGLBuffer(this);
+	indexCount = 0;
+	flagAvailable = false;
+}
+
+QOpenGLShaderProgram* StaticSphereRenderer::getProgram(const QByteArray& projectorShader)
+{
+	QOpenGLShaderProgram* program = programs.value(projectorShader, Q_NULLPTR);
+	if (program)
+		return program;
+
+	// The extinction is computed as in Extinction::forward(), from the geometric altitude of the vertex
+	QOpenGLShader vshader(QOpenGLShader::Vertex);
+	const QByteArray vsrc =
+		"attribute highp vec3 vertex;\n"
+		"attribute mediump vec2 texCoord;\n"
+		"uniform mediump mat4 projectionMatrix;\n"
+		"uniform highp mat3 modelToAltAz;\n"
+		"uniform mediump vec3 color;\n"
+		"uniform bool withExtinction;\n"
+		"uniform mediump float extinctionLog2Factor;\n"
+		"uniform mediump float extinctionScale;\n"
+		"uniform mediump float undergroundMode;\n"
+		"varying mediump vec2 texc;\n"
+		"varying mediump vec3 outColor;\n"
+		+ projectorShader +
+		"float airmass(float cosZ)\n"
+		"{\n"
+		"    if (cosZ < -0.035)\n"
+		"    {\n"
+		"        if (undergroundMode < 0.5)\n"
+		"            return 0.0;\n"
+		"        if (undergroundMode < 1.5)\n"
+		"            return 42.0;\n"
+		"        cosZ = min(1.0, -0.035 - (cosZ + 0.035));\n"
+		"    }\n"
+		"    // Young 1994\n"
+		"    float nom = (1.002432*cosZ + 0.148386)*cosZ + 0.0096467;\n"
+		"    float denum = ((cosZ + 0.149864)*cosZ + 0.0102963)*cosZ + 0.000303978;\n"
+		"    return nom/denum;\n"
+		"}\n"
+		"void main(void)\n"
+		"{\n"
+		"    gl_Position = projectionMatrix * vec4(projectToViewport(vertex).xyz, 1.);\n"
+		"    texc = texCoord;\n"
+		"    outColor = color;\n"
+		"    if (withExtinction)\n"
+		"        outColor *= extinctionScale*exp2(airmass((modelToAltAz*vertex).z)*extinctionLog2Factor);\n"
+		"}\n";
+	vshader.compileSourceCode(vsrc);
+	if (!vshader.log().isEmpty()) { qWarning() << "StaticSphereRenderer::getProgram(): Warnings while compiling vshader: " << vshader.log(); }
+
+	QOpenGLShader fshader(QOpenGLShader::Fragment);
+	const QString fsrc =
+		makeSaturationShader()+
+		"varying mediump vec2 texc;\n"
+		"varying mediump vec3 outColor;\n"
+		"uniform sampler2D tex;\n"
+		"uniform lowp float saturation;\n"
+		"void main(void)\n"
+		"{\n"
+		"    gl_FragColor = texture2D(tex, texc)*vec4(outColor, 1.);\n"
+		"    if (saturation != 1.0)\n"
+		"        gl_FragColor.rgb = saturate(gl_FragColor.rgb, saturation);\n"
+		"}\n";
+	fshader.compileSourceCode(fsrc);
+	if (!fshader.log().isEmpty()) { qWarning() << "StaticSphereRenderer::getProgram(): Warnings while compiling fshader: " << fshader.log(); }
+
+	program = new QOpenGLShaderProgram();
+	program->addShader(&vshader);
+	program->addShader(&fshader);
+	if (!StelPainter::linkProg(program, "staticSphereShader"))
+	{
+		// Do not try again, StelPainter will draw the sphere
+		qWarning() << "StaticSphereRenderer: cannot link shader, static sphere buffers disabled";
+		flagAvailable = false;
+		delete program;
+		return Q_NULLPTR;
+	}
+	programs.insert(projectorShader, program);
+	return program;
+}
+
+void StaticSphereRenderer::draw(StelPainter* sPainter, const Vec3f& color, float saturation, const Extinction* extinction,
+				const Mat4d& modelToAltAz, float extinctionBase, float extinctionScale)
+{
+	const StelProjectorP& prj = sPainter->getProjector();
+	QOpenGLShaderProgram* program = getProgram(prj->getForwardTransformShader());
+	if (!program)
+		return;
+
+	const Mat4f& m = prj->getProjectionMatrix();
+	const QMatrix4x4 qMat(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
+	const float rot[9] = {(float)modelToAltAz[0], (float)modelToAltAz[4], (float)modelToAltAz[8],
+			      (float)modelToAltAz[1], (float)modelToAltAz[5], (float)modelToAltAz[9],
+			      (float)modelToAltAz[2], (float)modelToAltAz[6], (float)modelToAltAz[10]};
+
+	program->bind();
+	program->setUniformValue("projectionMatrix", qMat);
+	program->setUniformValue("modelToAltAz", QMatrix3x3(rot));
+	program->setUniformValue("color", color[0], color[1], color[2]);
+	program->setUniformValue("withExtinction", extinction!=Q_NULLPTR);
+	if (extinction)
+	{
+		program->setUniformValue("extinctionLog2Factor", extinction->getExtinctionCoefficient()*std::log2(extinctionBase));
+		program->setUniformValue("extinctionScale", extinctionScale);
+		program->setUniformValue("undergroundMode", (GLfloat)extinction->getUndergroundExtinctionMode());
+	}
+	program->setUniformValue("saturation", saturation);
+	program->setUniformValue("tex", 0);
+	prj->setForwardTransformUniforms(*program);
+
+	const int vertexLoc = program->attributeLocation("vertex");
+	const int texCoordLoc = program->attributeLocation("texCoord");
+	vertexBuffer.bind();
+	program->setAttributeBuffer(vertexLoc, GL_FLOAT, 0, 3, 5*sizeof(GLfloat));
+	program->setAttributeBuffer(texCoordLoc, GL_FLOAT, 3*sizeof(GLfloat), 2, 5*sizeof(GLfloat));
+	program->enableAttributeArray(vertexLoc);
+	program->enableAttributeArray(texCoordLoc);
+	indexBuffer.bind();
+	sPainter->glFuncs()->glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_SHORT, Q_NULLPTR);
+	indexBuffer.release();
+	program->disableAttributeArray(vertexLoc);
+	program->disableAttributeArray(texCoordLoc);
+	vertexBuffer.release();
+	program->release();
+}
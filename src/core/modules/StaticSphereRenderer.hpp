@@ -0,0 +1,80 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STATICSPHERERENDERER_HPP
+#define STATICSPHERERENDERER_HPP
+
+#include "VecMath.hpp"
+#include "StelProjectorType.hpp"
+
+#include <QByteArray>
+#include <QHash>
+#include <QOpenGLBuffer>
+
+class StelPainter;
+class Extinction;
+class QOpenGLShaderProgram;
+struct StelVertexArray;
+
+//! @class StaticSphereRenderer
+//! Draws a textured sky sphere like the Milky Way or the Zodiacal Light from static OpenGL buffers.
+//! The vertices and texture coordinates of the sphere are uploaded once, and projected by a vertex shader
+//! generated from StelProjector::getForwardTransformShader(). The brightness, the extinction and the
+//! saturation are applied in the shaders from uniforms, so the CPU does not touch the vertices in each frame.
+//! Projections which cannot be evaluated on the GPU, or which have discontinuities, must be drawn with StelPainter.
+class StaticSphereRenderer
+{
+public:
+	StaticSphereRenderer();
+	~StaticSphereRenderer();
+
+	//! Upload the sphere to static buffers. Requires a valid context.
+	//! @param sphere textured triangles, usually from StelPainter::computeSphereNoLight().
+	void init(const StelVertexArray& sphere);
+
+	//! Get whether the static buffers can be used for drawing with the given projector.
+	bool isUsable(const StelProjectorP& prj) const;
+
+	//! Draw the sphere with the texture currently bound and the blending and culling set in the painter.
+	//! @param sPainter the painter to use
+	//! @param color color of the sphere before extinction
+	//! @param saturation saturation of the texture colors, 1 to keep them unchanged
+	//! @param extinction extinction to apply, or Q_NULLPTR to draw without extinction
+	//! @param modelToAltAz matrix from the frame of the sphere to the horizontal frame, used for extinction
+	//! @param extinctionBase brightness factor for an extinction of one magnitude
+	//! @param extinctionScale factor applied to the color where extinction is applied
+	void draw(StelPainter* sPainter, const Vec3f& color, float saturation, const Extinction* extinction = Q_NULLPTR,
+		  const Mat4d& modelToAltAz = Mat4d::identity(), float extinctionBase = 0.4f, float extinctionScale = 1.f);
+
+	//! Release the OpenGL buffers. Requires a valid context.
+	void clear();
+
+private:
+	//! Get the shader program for a projector shader, compiling it on first use.
+	QOpenGLShaderProgram* getProgram(const QByteArray& projectorShader);
+
+	bool flagEnabled;
+	bool flagAvailable;
+	int indexCount;
+	QOpenGLBuffer vertexBuffer;
+	QOpenGLBuffer indexBuffer;
+	QHash<QByteArray, QOpenGLShaderProgram*> programs;
+};
+
+#endif // STATICSPHERERENDERER_HPP
@@ -36,6 +36,7 @@
 #include "StelSkyDrawer.hpp"
 #include "StelPainter.hpp"
 #include "StelTranslator.hpp"
+#include "StaticSphereRenderer.hpp"
 #include "precession.h"
 
 #include <QDebug>
@@ -49,7 +50,9 @@ ZodiacalLight::ZodiacalLight()
 	, intensityMinFov(0.25f) // when zooming in further, Z.L. is no longer visible.
 	, intensityMaxFov(2.5f) // when zooming out further, Z.L. is fully visible (when enabled).
 	, lastJD(-1.0E6)
+	, eclipticRotation(Mat4d::identity())
 	, vertexArray()
+	, sphereRenderer(Q_NULLPTR)
 {
 	setObjectName("ZodiacalLight");
 	fader = new LinearFader();
@@ -62,6 +65,9 @@ ZodiacalLight::~ZodiacalLight()
 	
 	delete vertexArray;
 	vertexArray = Q_NULLPTR;
+
+	delete sphereRenderer;
+	sphereRenderer = Q_NULLPTR;
 }
 
 void ZodiacalLight::init()
@@ -81,6 +87,9 @@ void ZodiacalLight::init()
 
 	eclipticalVertices=vertexArray->vertex;
 	// This vector is used to keep original vertices, these will be modified in update().
+	// The static buffers keep the original vertices, and are rotated by the model view matrix.
+	sphereRenderer = new StaticSphereRenderer();
+	sphereRenderer->init(*vertexArray);
 
 	QString displayGroup = N_("Display Options");
 	addAction("actionShow_ZodiacalLight", displayGroup, N_("Zodiacal Light"), "flagZodiacalLightDisplayed", "Ctrl+Shift+Z");
@@ -134,11 +143,11 @@ void ZodiacalLight::update(double deltaTime)
 			lambdaSun=atan2(obsPos[1], obsPos[0])  -M_PI*0.5;
 		}
 
-		Mat4d rotMat=Mat4d::zrotation(lambdaSun);
+		eclipticRotation=Mat4d::zrotation(lambdaSun);
 		for (int i=0; i<eclipticalVertices.size(); ++i)
 		{
 			Vec3d tmp=eclipticalVertices.at(i);
-			vertexArray->vertex.replace(i, rotMat * tmp);
+			vertexArray->vertex.replace(i, eclipticRotation * tmp);
 		}
 		lastJD=currentJD;
 	}
@@ -154,6 +163,12 @@ double ZodiacalLight::getCallOrder(StelModuleActionName actionName) const
 	return 0;
 }
 
+bool ZodiacalLight::isActive(StelModuleActionName actionName) const
+{
+	Q_UNUSED(actionName);
+	return *fader || fader->getInterstate()>0.f;
+}
+
 void ZodiacalLight::setFlagShow(bool b)
 {
 	if (*fader != b)
@@ -227,6 +242,38 @@ void ZodiacalLight::draw(StelCore* core)
 
 	const bool withExtinction=(drawer->getFlagHasAtmosphere() && drawer->getExtinction().getExtinctionCoefficient()>=0.01f);
 
+	if (sphereRenderer->isUsable(prj))
+	{
+		StelProjector::ModelViewTranformP rotatedTransfo = transfo->clone();
+		rotatedTransfo->combine(eclipticRotation);
+		StelPainter sPainter(core->getProjection(rotatedTransfo));
+		sPainter.setCullFace(true);
+		sPainter.setBlending(true, GL_ONE, GL_ONE);
+		tex->bind();
+		if ((withExtinction) && (core->getCurrentLocation().planetName=="Earth"))
+		{
+			// Extinction is computed in the shader from the rotation of the original vertices to AltAz.
+			const double epsDate=getPrecessionAngleVondrakCurrentEpsilonA();
+			Vec3d axes[3] = {Vec3d(1.,0.,0.), Vec3d(0.,1.,0.), Vec3d(0.,0.,1.)};
+			for (auto& axis : axes)
+			{
+				double ecLon, ecLat, ra, dec;
+				StelUtils::rectToSphe(&ecLon, &ecLat, eclipticRotation*axis);
+				StelUtils::eclToEqu(ecLon, ecLat, epsDate, &ra, &dec);
+				Vec3d eqPos;
+				StelUtils::spheToRect(ra, dec, eqPos);
+				axis=core->equinoxEquToAltAz(eqPos, StelCore::RefractionOff);
+			}
+			const Mat4d eclToAltAz(axes[0][0], axes[0][1], axes[0][2], 0., axes[1][0], axes[1][1], axes[1][2], 0.,
+					       axes[2][0], axes[2][1], axes[2][2], 0., 0., 0., 0., 1.);
+			sphereRenderer->draw(&sPainter, c, 1.f, &drawer->getExtinction(), eclToAltAz, 0.4f, 1.f/bortleIntensity);
+		}
+		else
+			sphereRenderer->draw(&sPainter, c, 1.f);
+		sPainter.setCullFace(false);
+		return;
+	}
+
 	if ((withExtinction) && (core->getCurrentLocation().planetName=="Earth")) // If anybody switches on atmosphere on the moon, there will be no extinction.
 	{
 		// We must process the vertices to find geometric altitudes in order to compute vertex colors.
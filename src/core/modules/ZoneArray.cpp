@@ -23,10 +23,19 @@
 #include "StelGeodesicGrid.hpp"
 #include "StelObject.hpp"
 #include "StelPainter.hpp"
+#include "StelFrameProfiler.hpp"
+#include "StelStartupTrace.hpp"
+#include "StarZoneRenderer.hpp"
+#include "StarCatalogStream.hpp"
 
 #include <QDebug>
 #include <QFile>
+#include <QFileInfo>
 #include <QDir>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
 #ifdef Q_OS_WIN
 #include <io.h>
 #include <windows.h>
@@ -41,6 +50,9 @@ static unsigned int stel_bswap_32(unsigned int val)
 
 static const Vec3f north(0,0,1);
 
+double ZoneArray::positionCacheTolerance = 1.0;
+int ZoneArray::positionCacheMaxStars = 2000000;
+
 void ZoneArray::initTriangle(int index, const Vec3f &c0, const Vec3f &c1, const Vec3f &c2)
 {
 	// initialize center,axis0,axis1:
@@ -84,19 +96,29 @@ static inline int ReadInt(QFile& file, unsigned int &x)
 	return rval;
 }
 
+// Number of padding bytes between the header and the zone sizes of a native
+// cache, chosen so that the star data begins at a multiple of NATIVE_CACHE_ALIGNMENT.
+static qint64 nativeCachePadding(unsigned int level)
+{
+	const qint64 dataStart = 8*sizeof(unsigned int) + StelGeodesicGrid::nrOfZones(level)*sizeof(unsigned int);
+	return (NATIVE_CACHE_ALIGNMENT - dataStart % NATIVE_CACHE_ALIGNMENT) % NATIVE_CACHE_ALIGNMENT;
+}
+
 #if (!defined(__GNUC__))
 #ifndef _MSC_BUILD
 #warning Star catalogue loading has only been tested with gcc
 #endif
 #endif
 
-ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
+ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap, qint64 lazy_budget, StarCatalogStream* stream)
 {
+	StelStartupTrace::Scope trace("catalog", catalogFilePath);
 	QString dbStr; // for debugging output.
 	QFile* file = new QFile(catalogFilePath);
-	if (!file->open(QIODevice::ReadOnly))
+	if (!file->open(QIODevice::ReadOnly) || (stream && lazy_budget<=0))
 	{
 		qWarning() << "Error while loading " << QDir::toNativeSeparators(catalogFilePath) << ": failed to open file.";
+		delete stream;
 		return 0;
 	}
 	dbStr = "Loading " + QDir::toNativeSeparators(catalogFilePath) + ": ";
@@ -112,6 +134,7 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 	{
 		dbStr += "error - file format is bad.";
 		qDebug() << dbStr;
+		delete stream;
 		return 0;
 	}
 	const bool byte_swap = (magic == FILE_MAGIC_OTHER_ENDIAN);
@@ -148,7 +171,7 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 			// mmap only with gcc:
 			dbStr += "warning - you must convert catalogue to native format before mmap loading";
 			qDebug(qPrintable(dbStr));
-
+			delete stream;
 			return 0;
 		}
 #endif
@@ -157,10 +180,22 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 	{
 		// ok, will work for any architecture and any compiler
 	}
+	else if (magic == FILE_MAGIC_NATIVE_CACHE)
+	{
+		// native cache written by createNativeCache(): skip the padding
+		// in front of the zone sizes so that star data is page-aligned
+		if (!file->seek(file->pos() + nativeCachePadding(level)))
+		{
+			dbStr += "error - truncated catalogue cache.";
+			qDebug() << dbStr;
+			return 0;
+		}
+	}
 	else
 	{
 		dbStr += "error - not a catalogue file.";
 		qDebug() << dbStr;
+		delete stream;
 		return 0;
 	}
 	ZoneArray *rval = Q_NULLPTR;
@@ -169,7 +204,12 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 	switch (type)
 	{
 		case 0:
-			if (major > MAX_MAJOR_FILE_VERSION)
+			if (stream)
+			{
+				dbStr += "error - Hipparcos catalogs cannot be streamed ";
+				delete stream;
+			}
+			else if (major > MAX_MAJOR_FILE_VERSION)
 			{
 				dbStr += "warning - unsupported version ";
 			}
@@ -185,7 +225,7 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 			}
 			else
 			{
-				rval = new SpecialZoneArray<Star2>(file, byte_swap, use_mmap, level, mag_min, mag_range, mag_steps);
+				rval = new SpecialZoneArray<Star2>(file, byte_swap, use_mmap && lazy_budget<=0, level, mag_min, mag_range, mag_steps, lazy_budget, stream);
 			}
 			break;
 		case 2:
@@ -195,7 +235,7 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 			}
 			else
 			{
-				rval = new SpecialZoneArray<Star3>(file, byte_swap, use_mmap, level, mag_min, mag_range, mag_steps);
+				rval = new SpecialZoneArray<Star3>(file, byte_swap, use_mmap && lazy_budget<=0, level, mag_min, mag_range, mag_steps, lazy_budget, stream);
 			}
 			break;
 		default:
@@ -206,6 +246,9 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 	{
 		dbStr += QString("%1").arg(rval->getNrOfStars());
 		qDebug() << dbStr;
+		// Mapped and streamed catalogs are read on demand
+		if (!use_mmap && !stream)
+			trace.setBytesRead(QFileInfo(catalogFilePath).size());
 	}
 	else
 	{
@@ -220,6 +263,96 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 	return rval;
 }
 
+bool ZoneArray::createNativeCache(const QString& catalogFilePath, const QString& cacheFilePath)
+{
+	QFile in(catalogFilePath);
+	if (!in.open(QIODevice::ReadOnly))
+	{
+		qWarning() << "Error while creating catalogue cache: failed to open" << QDir::toNativeSeparators(catalogFilePath);
+		return false;
+	}
+	unsigned int header[8];
+	if ((qint64)sizeof(header) != in.read((char*)header, sizeof(header)))
+	{
+		qWarning() << "Error while creating catalogue cache: file format is bad:" << QDir::toNativeSeparators(catalogFilePath);
+		return false;
+	}
+	const bool byte_swap = (header[0] == FILE_MAGIC_OTHER_ENDIAN);
+	if (!byte_swap && header[0] != FILE_MAGIC && header[0] != FILE_MAGIC_NATIVE)
+	{
+		qWarning() << "Error while creating catalogue cache: not a catalogue file:" << QDir::toNativeSeparators(catalogFilePath);
+		return false;
+	}
+	if (byte_swap)
+	{
+		for (int i=1; i<8; i++)
+			header[i] = stel_bswap_32(header[i]);
+	}
+	header[0] = FILE_MAGIC_NATIVE_CACHE;
+
+	qint64 starSize;
+	switch (header[1])
+	{
+		case 0: starSize = sizeof(Star1); break;
+		case 1: starSize = sizeof(Star2); break;
+		case 2: starSize = sizeof(Star3); break;
+		default:
+			qWarning() << "Error while creating catalogue cache: bad file type" << header[1];
+			return false;
+	}
+
+	const unsigned int level = header[4];
+	const int nrOfZones = StelGeodesicGrid::nrOfZones(level);
+	QVector<unsigned int> zoneSize(nrOfZones);
+	if ((qint64)(sizeof(unsigned int)*nrOfZones) != in.read((char*)zoneSize.data(), sizeof(unsigned int)*nrOfZones))
+	{
+		qWarning() << "Error while creating catalogue cache: cannot read zones from" << QDir::toNativeSeparators(catalogFilePath);
+		return false;
+	}
+	qint64 nrOfStars = 0;
+	for (auto& size : zoneSize)
+	{
+		if (byte_swap)
+			size = stel_bswap_32(size);
+		nrOfStars += size;
+	}
+
+	// Write to a temporary file first, so that an interrupted conversion never leaves a truncated cache behind
+	QFile out(cacheFilePath + ".tmp");
+	if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		qWarning() << "Error while creating catalogue cache: cannot write" << QDir::toNativeSeparators(out.fileName());
+		return false;
+	}
+	bool ok = (out.write((const char*)header, sizeof(header)) == (qint64)sizeof(header));
+	ok = ok && (out.write(QByteArray(nativeCachePadding(level), '\0')) == nativeCachePadding(level));
+	ok = ok && (out.write((const char*)zoneSize.constData(), sizeof(unsigned int)*nrOfZones) == (qint64)(sizeof(unsigned int)*nrOfZones));
+
+	// The star records are stored little endian and decoded on access, so they are copied unchanged.
+	qint64 remaining = starSize*nrOfStars;
+	static const qint64 chunkSize = 8*1024*1024;
+	while (ok && remaining > 0)
+	{
+		const QByteArray chunk = in.read(qMin(chunkSize, remaining));
+		ok = !chunk.isEmpty() && out.write(chunk) == chunk.size();
+		remaining -= chunk.size();
+	}
+	out.close();
+	in.close();
+
+	if (ok)
+	{
+		QFile::remove(cacheFilePath);
+		ok = out.rename(cacheFilePath);
+	}
+	if (!ok)
+	{
+		qWarning() << "Error while creating catalogue cache" << QDir::toNativeSeparators(cacheFilePath);
+		out.remove();
+	}
+	return ok;
+}
+
 ZoneArray::ZoneArray(const QString& fname, QFile* file, int level, int mag_min,
 			 int mag_range, int mag_steps)
 			: fname(fname), level(level), mag_min(mag_min),
@@ -229,6 +362,18 @@ ZoneArray::ZoneArray(const QString& fname, QFile* file, int level, int mag_min,
 	nr_of_zones = StelGeodesicGrid::nrOfZones(level);	
 }
 
+int ZoneArray::getCutoffMagStep(const StelSkyDrawer* drawer, int limitMagIndex) const
+{
+	int cutoffMagStep=limitMagIndex;
+	if (drawer->getFlagStarMagnitudeLimit())
+	{
+		cutoffMagStep = ((int)(drawer->getCustomStarMagnitudeLimit()*1000.f) - mag_min)*mag_steps/mag_range;
+		if (cutoffMagStep>limitMagIndex)
+			cutoffMagStep = limitMagIndex;
+	}
+	return cutoffMagStep;
+}
+
 bool ZoneArray::readFile(QFile& file, void *data, qint64 size)
 {
 	int parts = 256;
@@ -286,10 +431,14 @@ void SpecialZoneArray<Star>::scaleAxis()
 
 template<class Star>
 SpecialZoneArray<Star>::SpecialZoneArray(QFile* file, bool byte_swap,bool use_mmap,
-					 int level, int mag_min, int mag_range, int mag_steps)
+					 int level, int mag_min, int mag_range, int mag_steps, qint64 lazy_budget,
+					 StarCatalogStream* stream)
 		: ZoneArray(file->fileName(), file, level, mag_min, mag_range, mag_steps),
-		  stars(0), mmap_start(0)
+		  stars(0), position_cache_size(0), mmap_start(0), lazy_budget(lazy_budget), resident_bytes(0), use_counter(0),
+		  stream(stream)
 {
+	pending_zone.size = 0;
+	pending_zone.stars = Q_NULLPTR;
 	if (nr_of_zones > 0)
 	{
 		zones = new SpecialZoneData<Star>[nr_of_zones];
@@ -355,6 +504,20 @@ SpecialZoneArray<Star>::SpecialZoneArray(QFile* file, bool byte_swap,bool use_mm
 				}
 				file->close();
 			}
+			else if (lazy_budget > 0)
+			{
+				// Only remember where the stars of each zone are, they are read by getZone().
+				// The file is kept open for that purpose.
+				zone_offsets.resize(nr_of_zones);
+				zone_last_use.fill(0, nr_of_zones);
+				qint64 offset = file->pos();
+				for (unsigned int z=0;z<nr_of_zones;z++)
+				{
+					getZones()[z].stars = Q_NULLPTR;
+					zone_offsets[z] = offset;
+					offset += sizeof(Star)*getZones()[z].size;
+				}
+			}
 			else
 			{
 				stars = new Star[nr_of_stars];
@@ -387,6 +550,21 @@ SpecialZoneArray<Star>::SpecialZoneArray(QFile* file, bool byte_swap,bool use_mm
 template<class Star>
 SpecialZoneArray<Star>::~SpecialZoneArray(void)
 {
+	if (lazy_budget > 0 && zones)
+	{
+		for (auto index : resident_zones)
+		{
+			delete[] getZones()[index].getStars();
+			getZones()[index].stars = Q_NULLPTR;
+		}
+		resident_zones.clear();
+		delete file;
+		file = Q_NULLPTR;
+	}
+	delete stream;
+	stream = Q_NULLPTR;
+	qDeleteAll(position_cache);
+	position_cache.clear();
 	if (stars)
 	{
 		if (mmap_start != Q_NULLPTR)
@@ -409,10 +587,139 @@ SpecialZoneArray<Star>::~SpecialZoneArray(void)
 	nr_of_stars = 0;
 }
 
+template<class Star>
+const SpecialZoneData<Star>* SpecialZoneArray<Star>::getZone(int index) const
+{
+	SpecialZoneData<Star>* z = getZones() + index;
+	if (lazy_budget <= 0)
+		return z;
+
+	zone_last_use[index] = ++use_counter;
+	if (z->stars != Q_NULLPTR || z->size == 0)
+		return z;
+
+	const qint64 bytes = sizeof(Star)*z->size;
+	if (stream && !stream->hasZone(index))
+	{
+		// Draw nothing until the zone was downloaded
+		stream->requestZone(index, zone_offsets[index], bytes);
+		return &pending_zone;
+	}
+	evictZones(bytes);
+	Star* s = new Star[z->size];
+	if (stream ? !stream->readZone(index, zone_offsets[index], reinterpret_cast<char*>(s), bytes)
+		   : (!file->seek(zone_offsets[index]) || !readFile(*file, s, bytes)))
+	{
+		qWarning() << "ERROR: SpecialZoneArray(" << level << "): cannot read zone" << index
+			   << "from" << QDir::toNativeSeparators(fname) << ":" << file->errorString();
+		delete[] s;
+		// Do not try again, the zone is treated as empty from now on.
+		z->size = 0;
+		return z;
+	}
+	z->stars = s;
+	resident_zones.append(index);
+	resident_bytes += bytes;
+	return z;
+}
+
+template<class Star>
+void SpecialZoneArray<Star>::evictZones(qint64 needed) const
+{
+	if (resident_bytes + needed <= lazy_budget)
+		return;
+
+	// Evicting is rare compared to zone accesses, so rather sort here than maintain an ordered list.
+	// Release down to 3/4 of the budget to avoid evicting again with the next loaded zone.
+	std::sort(resident_zones.begin(), resident_zones.end(), [this](int a, int b) { return zone_last_use[a] < zone_last_use[b]; });
+	int evicted = 0;
+	while (evicted < resident_zones.size() && resident_bytes + needed > lazy_budget*3/4)
+	{
+		SpecialZoneData<Star>* z = getZones() + resident_zones.at(evicted);
+		delete[] z->getStars();
+		z->stars = Q_NULLPTR;
+		resident_bytes -= sizeof(Star)*z->size;
+		++evicted;
+	}
+	resident_zones.remove(0, evicted);
+}
+
+template<class Star>
+void SpecialZoneArray<Star>::prepareZone(int index, StelCore* core, int limitMagIndex) const
+{
+	// In lazy mode this reads the stars of the zone
+	getZone(index);
+	if (positionCacheTolerance < 0.)
+		return;
+
+	// Only the stars brighter than the cutoff are needed
+	const int count = getNrOfStarsUpToMagStep(index, getCutoffMagStep(core->getSkyDrawer(), limitMagIndex));
+	PositionCache* c = position_cache.value(index, Q_NULLPTR);
+	const int growth = c ? count - c->positions.size() : count;
+	if (growth <= 0)
+		return;
+	if (position_cache_size + growth > positionCacheMaxStars)
+	{
+		// The visible sky changed a lot, start over
+		qDeleteAll(position_cache);
+		position_cache.clear();
+		position_cache_size = 0;
+		c = Q_NULLPTR;
+	}
+	if (!c)
+	{
+		c = new PositionCache;
+		c->jde = core->getJDE();
+		c->valid = 0;
+		position_cache.insert(index, c);
+	}
+	position_cache_size += count - c->positions.size();
+	c->positions.resize(count);
+}
+
+template<class Star>
+const Vec3f* SpecialZoneArray<Star>::getJ2000Positions(const SpecialZoneData<Star>* z, int index, double jde, int count) const
+{
+	static const double d2000 = 2451545.0;
+	PositionCache* c = position_cache.value(index, Q_NULLPTR);
+	if (!c || c->positions.size() < count)
+		return Q_NULLPTR;
+	if (std::fabs(jde - c->jde) > positionCacheTolerance)
+	{
+		// Recompute all positions for the new epoch
+		c->jde = jde;
+		c->valid = 0;
+	}
+	if (c->valid < count)
+	{
+		const float movementFactor = (M_PI/180.)*(0.0001/3600.) * ((c->jde-d2000)/365.25) / star_position_scale;
+		Vec3f* pos = c->positions.data();
+		const Star* s = z->getStars();
+		for (int i=c->valid;i<count;++i)
+		{
+			s[i].getJ2000Pos(z, movementFactor, pos[i]);
+			pos[i].normalize();
+		}
+		c->valid = count;
+	}
+	return c->positions.constData();
+}
+
 template<class Star>
 void SpecialZoneArray<Star>::draw(StelPainter* sPainter, int index, bool isInsideViewport, const RCMag* rcmag_table,
 				  int limitMagIndex, StelCore* core, int maxMagStarName, float names_brightness,
-				  const QVector<SphericalCap> &boundingCaps) const
+				  const QVector<SphericalCap> &boundingCaps, StelPickBuffer::Layer* pickLayer) const
+{
+	prepareZone(index, core, limitMagIndex);
+	draw_buffer.resize(0);
+	projectZone(index, isInsideViewport, rcmag_table, limitMagIndex, core, sPainter->getProjector(), boundingCaps, draw_buffer);
+	drawProjectedZone(sPainter, index, draw_buffer, core, maxMagStarName, names_brightness, pickLayer);
+}
+
+template<class Star>
+void SpecialZoneArray<Star>::projectZone(int index, bool isInsideViewport, const RCMag* rcmag_table, int limitMagIndex,
+					 StelCore* core, const StelProjectorP& prj, const QVector<SphericalCap>& boundingCaps,
+					 QVector<ProjectedStar>& result) const
 {
 	StelSkyDrawer* drawer = core->getSkyDrawer();
 	Vec3f vf;
@@ -426,18 +733,43 @@ void SpecialZoneArray<Star>::draw(StelPainter* sPainter, int index, bool isInsid
 	
 	// Allow artificial cutoff:
 	// find the (integer) mag at which is just bright enough to be drawn.
-	int cutoffMagStep=limitMagIndex;
-	if (drawer->getFlagStarMagnitudeLimit())
-	{
-		cutoffMagStep = ((int)(drawer->getCustomStarMagnitudeLimit()*1000.f) - mag_min)*mag_steps/mag_range;
-		if (cutoffMagStep>limitMagIndex)
-			cutoffMagStep = limitMagIndex;
-	}
+	const int cutoffMagStep = getCutoffMagStep(drawer, limitMagIndex);
 	Q_ASSERT(cutoffMagStep<RCMAG_TABLE_SIZE);
     
+	// Stars which pass the culling tests are collected into batches and projected together
+	// with StelProjector::projectBatch(), which is much faster than projecting them one by one.
+	static const int batchSize = 256;
+	ProjectedStar batch[batchSize];
+	Vec3f batchPos[batchSize];
+	Vec3f batchWin[batchSize];
+	bool batchMask[batchSize];
+	int batchCount = 0;
+
+	auto flushBatch = [&]()
+	{
+		prj->projectBatch(batchPos, batchCount, batchWin, batchMask);
+		for (int i=0;i<batchCount;++i)
+		{
+			if (!batchMask[i] || (!isInsideViewport && !prj->checkInViewport(batchWin[i])))
+				continue;
+			batch[i].pos = batchPos[i];
+			batch[i].win = batchWin[i];
+			result.append(batch[i]);
+		}
+		batchCount = 0;
+	};
+
 	// Go through all stars, which are sorted by magnitude (bright stars first)
-	const SpecialZoneData<Star>* zoneToDraw = getZones() + index;
+	const SpecialZoneData<Star>* zoneToDraw = getZone(index);
 	const Star* lastStar = zoneToDraw->getStars() + zoneToDraw->size;
+	const Vec3f* cachedPos = Q_NULLPTR;
+	if (positionCacheTolerance >= 0.)
+	{
+		// Only the stars brighter than the cutoff are needed
+		const int count = getNrOfStarsUpToMagStep(index, cutoffMagStep);
+		cachedPos = getJ2000Positions(zoneToDraw, index, core->getJDE(), count);
+		lastStar = zoneToDraw->getStars() + count;
+	}
 	for (const Star* s=zoneToDraw->getStars();s<lastStar;++s)
 	{
 		// Artifical cutoff per magnitude
@@ -449,14 +781,19 @@ void SpecialZoneArray<Star>::draw(StelPainter* sPainter, int index, bool isInsid
 		// Array of 2 numbers containing radius and magnitude
 		const RCMag* tmpRcmag = &rcmag_table[s->getMag()];
 		
-		// Get the star position from the array
-		s->getJ2000Pos(zoneToDraw, movementFactor, vf);
+		// Get the star position from the cache or from the array
+		if (cachedPos)
+			vf = cachedPos[s - zoneToDraw->getStars()];
+		else
+		{
+			s->getJ2000Pos(zoneToDraw, movementFactor, vf);
+			vf.normalize();
+		}
 		
 		// If the star zone is not strictly contained inside the viewport, eliminate from the 
 		// beginning the stars actually outside viewport.
 		if (!isInsideViewport)
 		{
-			vf.normalize();
 			bool isVisible = true;
 			for (const auto& cap : boundingCaps)
 			{
@@ -486,14 +823,90 @@ void SpecialZoneArray<Star>::draw(StelPainter* sPainter, int index, bool isInsid
 			twinkleFactor=qMin(1.0f, 1.0f-0.9f*altAz[2]); // suppress twinkling in higher altitudes. Keep 0.1 twinkle amount in zenith.
 		}
 
-		if (drawer->drawPointSource(sPainter, vf, *tmpRcmag, s->getBVIndex(), !isInsideViewport, twinkleFactor) && s->hasName() && extinctedMagIndex < maxMagStarName && s->hasComponentID()<=1)
+		if (tmpRcmag->radius<=0.f)
+			continue;
+
+		ProjectedStar& p = batch[batchCount];
+		p.rcmag = tmpRcmag;
+		p.twinkleFactor = twinkleFactor;
+		p.magIndex = extinctedMagIndex;
+		p.star = s - zoneToDraw->getStars();
+		batchPos[batchCount] = vf;
+		if (++batchCount == batchSize)
+			flushBatch();
+	}
+	if (batchCount > 0)
+		flushBatch();
+}
+
+template<class Star>
+void SpecialZoneArray<Star>::drawProjectedZone(StelPainter* sPainter, int index, const QVector<ProjectedStar>& stars,
+					       StelCore* core, int maxMagStarName, float names_brightness, StelPickBuffer::Layer* pickLayer) const
+{
+	StelSkyDrawer* drawer = core->getSkyDrawer();
+	const SpecialZoneData<Star>* z = getZone(index);
+	// Same as StelObject::getSelectPriority() for the extincted magnitude
+	const float magMin = 0.001f*mag_min;
+	const float k = 0.001f*mag_range/mag_steps;
+	int drawn = 0;
+	for (const auto& p : stars)
+	{
+		const Star* s = z->getStars() + p.star;
+		if (!drawer->drawProjectedPointSource(sPainter, p.win, *p.rcmag, s->getBVIndex(), p.twinkleFactor))
+			continue;
+		++drawn;
+		if (pickLayer)
+			pickLayer->add(p.win[0], p.win[1], qMin(magMin + p.magIndex*k, 15.f), getPickId(index, p.star));
+		if (s->hasName() && p.magIndex < maxMagStarName && s->hasComponentID()<=1)
 		{
-			const float offset = tmpRcmag->radius*0.7f;
+			const float offset = p.rcmag->radius*0.7f;
 			const Vec3f colorr = StelSkyDrawer::indexToColor(s->getBVIndex())*0.75f;
 			sPainter->setColor(colorr[0], colorr[1], colorr[2],names_brightness);
-			sPainter->drawText(Vec3d(vf[0], vf[1], vf[2]), s->getNameI18n(), 0, offset, offset, false);
+			sPainter->drawText(Vec3d(p.pos[0], p.pos[1], p.pos[2]), s->getNameI18n(), 0, offset, offset, false);
 		}
 	}
+	StelFrameProfiler::count(StelFrameProfiler::StarsDrawn, drawn);
+}
+
+template<class Star>
+StelObjectP SpecialZoneArray<Star>::createStelObject(int index, int star) const
+{
+	if (index < 0 || index >= static_cast<int>(nr_of_zones))
+		return StelObjectP();
+	const SpecialZoneData<Star>* z = getZone(index);
+	if (star < 0 || star >= z->size)
+		return StelObjectP();
+	return z->getStars()[star].createStelObject(this, z);
+}
+
+template<class Star>
+void SpecialZoneArray<Star>::fillStaticBuffer(int index, double jde, StarZoneRecord* records) const
+{
+	static const double d2000 = 2451545.0;
+	const float movementFactor = (M_PI/180.)*(0.0001/3600.) * ((jde-d2000)/365.25) / star_position_scale;
+	const SpecialZoneData<Star>* z = getZone(index);
+	Vec3f vf;
+	for (const Star* s=z->getStars();s<z->getStars()+z->size;++s,++records)
+	{
+		s->getJ2000Pos(z, movementFactor, vf);
+		vf.normalize();
+		records->pos = vf;
+		records->mag = s->getMag();
+		const Vec3f& color = StelSkyDrawer::indexToColor(s->getBVIndex());
+		records->color[0] = (unsigned char)std::min((int)(color[0]*255+0.5f), 255);
+		records->color[1] = (unsigned char)std::min((int)(color[1]*255+0.5f), 255);
+		records->color[2] = (unsigned char)std::min((int)(color[2]*255+0.5f), 255);
+		records->color[3] = 255;
+	}
+}
+
+template<class Star>
+int SpecialZoneArray<Star>::getNrOfStarsUpToMagStep(int index, int magStep) const
+{
+	const SpecialZoneData<Star>* z = getZone(index);
+	const Star* first = z->getStars();
+	const Star* last = first + z->size;
+	return std::upper_bound(first, last, magStep, [](int mag, const Star& s) { return mag < s.getMag(); }) - first;
 }
 
 template<class Star>
@@ -502,7 +915,7 @@ void SpecialZoneArray<Star>::searchAround(const StelCore* core, int index, const
 {
 	static const double d2000 = 2451545.0;
 	const double movementFactor = (M_PI/180.)*(0.0001/3600.) * ((core->getJDE()-d2000)/365.25)/ star_position_scale;
-	const SpecialZoneData<Star> *const z = getZones()+index;
+	const SpecialZoneData<Star> *const z = getZone(index);
 	Vec3f tmp;
 	Vec3f vf(v[0], v[1], v[2]);
 	for (const Star* s=z->getStars();s<z->getStars()+z->size;++s)
@@ -517,3 +930,62 @@ void SpecialZoneArray<Star>::searchAround(const StelCore* core, int index, const
 	}
 }
 
+namespace
+{
+	int getStarHip(const Star1* s) {return s->getHip();}
+	template<class Star> int getStarHip(const Star*) {return 0;}
+}
+
+template<class Star>
+bool SpecialZoneArray<Star>::searchAround(const StelCore* core, int index, const Vec3d &v, double cosLimFov,
+					  const StarViewFunc& func) const
+{
+	static const double d2000 = 2451545.0;
+	const double movementFactor = (M_PI/180.)*(0.0001/3600.) * ((core->getJDE()-d2000)/365.25)/ star_position_scale;
+	const SpecialZoneData<Star> *const z = getZone(index);
+	const float magMin = 0.001f*mag_min;
+	const float k = (0.001f*mag_range)/mag_steps;
+	Vec3f tmp;
+	Vec3f vf(v[0], v[1], v[2]);
+	StarView view;
+	for (const Star* s=z->getStars();s<z->getStars()+z->size;++s)
+	{
+		s->getJ2000Pos(z,movementFactor, tmp);
+		tmp.normalize();
+		if (tmp*vf >= cosLimFov)
+		{
+			view.j2000Pos.set(tmp[0], tmp[1], tmp[2]);
+			view.vMag = magMin + s->getMag()*k;
+			view.bV = s->getBV();
+			view.hip = getStarHip(s);
+			view.id = getPickId(index, s - z->getStars());
+			if (!func(view))
+				return false;
+		}
+	}
+	return true;
+}
+
+template<class Star>
+void SpecialZoneArray<Star>::searchBrighterThan(double jde, int index, const SphericalCap& cap, int magStep,
+						QList<StelObjectP>& result, QVector<Vec3d>& positions)
+{
+	static const double d2000 = 2451545.0;
+	const double movementFactor = (M_PI/180.)*(0.0001/3600.) * ((jde-d2000)/365.25)/ star_position_scale;
+	const SpecialZoneData<Star> *const z = getZone(index);
+	// Stars are sorted by magnitude: only the first ones are bright enough
+	const Star* last = z->getStars() + getNrOfStarsUpToMagStep(index, magStep);
+	Vec3f tmp;
+	for (const Star* s=z->getStars();s<last;++s)
+	{
+		s->getJ2000Pos(z,movementFactor, tmp);
+		tmp.normalize();
+		const Vec3d pos(tmp[0], tmp[1], tmp[2]);
+		if (cap.contains(pos))
+		{
+			result.push_back(s->createStelObject(this,z));
+			positions.append(pos);
+		}
+	}
+}
+
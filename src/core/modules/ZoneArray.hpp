@@ -29,16 +29,21 @@
 #include "StelCore.hpp"
 #include "StelSkyDrawer.hpp"
 #include "StarMgr.hpp"
+#include "StelPickBuffer.hpp"
 
 #include <QString>
 #include <QFile>
 #include <QDebug>
+#include <QVector>
+#include <QHash>
 
 #ifdef __OpenBSD__
 #include <unistd.h>
 #endif
 
 class StelPainter;
+class StarCatalogStream;
+struct StarZoneRecord;
 
 // Patch by Rainer Canavan for compilation on irix with mipspro compiler part 1
 #ifndef MAP_NORESERVE
@@ -56,7 +61,22 @@ class StelPainter;
 #define FILE_MAGIC 0x835f040a
 #define FILE_MAGIC_OTHER_ENDIAN 0x0a045f83
 #define FILE_MAGIC_NATIVE 0x835f040b
+#define FILE_MAGIC_NATIVE_CACHE 0x835f040c
 #define MAX_MAJOR_FILE_VERSION 0
+// Star data in native caches starts on a multiple of this offset so that it can be mapped page by page.
+#define NATIVE_CACHE_ALIGNMENT 4096
+
+//! @struct ProjectedStar
+//! A star of a zone which passed the culling tests, with its position on the viewport.
+struct ProjectedStar
+{
+	Vec3f pos;		// normalized J2000 position
+	Vec3f win;		// position on the viewport
+	const RCMag* rcmag;	// radius and luminance, taking extinction into account
+	float twinkleFactor;
+	int magIndex;		// magnitude step, taking extinction into account
+	int star;		// index of the star in its zone
+};
 
 //! @struct HipIndexStruct
 //! Container for Hipparcos information. Stores a pointer to a Hipparcos star,
@@ -81,8 +101,25 @@ public:
 	//! loading.
 	//! @param extended_file_name path of the star catalog to load from
 	//! @param use_mmap whether or not to mmap the star catalog
+	//! @param lazy_budget if positive, zones of the faint star levels (Star2, Star3)
+	//! are read from the catalog the first time they are needed, and the least
+	//! recently used zones are released when more than lazy_budget bytes are resident.
+	//! @param stream if not null, extended_file_name is the local copy of a streamed catalog
+	//! and zones are read through stream, which downloads them on first use. Requires a
+	//! positive lazy_budget. The returned array takes ownership of the stream, which is
+	//! deleted if the catalog cannot be loaded.
 	//! @return an instance of SpecialZoneArray or HipZoneArray
-	static ZoneArray *create(const QString &extended_file_name, bool use_mmap);
+	static ZoneArray *create(const QString &extended_file_name, bool use_mmap, qint64 lazy_budget=0,
+				 StarCatalogStream* stream=Q_NULLPTR);
+
+	//! Write a copy of a star catalog with a native-endian header and page-aligned
+	//! star data, so that it can always be loaded with mmap.
+	//! The header is followed by padding, the zone sizes and the star records,
+	//! which are copied unchanged because they are stored little endian anyway.
+	//! @param catalogFilePath path of the original star catalog
+	//! @param cacheFilePath path of the cache file to create
+	//! @return @c true if the cache file was written successfully
+	static bool createNativeCache(const QString &catalogFilePath, const QString &cacheFilePath);
 	virtual ~ZoneArray()
 	{
 		nr_of_zones = 0;
@@ -98,11 +135,64 @@ public:
 	virtual void searchAround(const StelCore* core, int index,const Vec3d &v,double cosLimFov,
 							  QList<StelObjectP > &result) = 0;
 
+	//! Pure virtual method. See subclass implementation.
+	virtual bool searchAround(const StelCore* core, int index, const Vec3d &v, double cosLimFov,
+				  const StarViewFunc& func) const = 0;
+
+	//! Pure virtual method. See subclass implementation.
+	virtual void searchBrighterThan(double jde, int index, const SphericalCap& cap, int magStep,
+					QList<StelObjectP>& result, QVector<Vec3d>& positions) = 0;
+
 	//! Pure virtual method. See subclass implementation.
 	virtual void draw(StelPainter* sPainter, int index,bool is_inside,
 					  const RCMag* rcmag_table, int limitMagIndex, StelCore* core,
 					  int maxMagStarName, float names_brightness,
-					  const QVector<SphericalCap>& boundingCaps) const = 0;
+					  const QVector<SphericalCap>& boundingCaps, StelPickBuffer::Layer* pickLayer) const = 0;
+
+	//! Whether prepareZone() may be skipped and projectZone() may be called for several zones
+	//! of this catalog from different threads at the same time.
+	virtual bool supportsParallelProjection() const {return false;}
+
+	//! Pure virtual method. See subclass implementation.
+	virtual void prepareZone(int index, StelCore* core, int limitMagIndex) const = 0;
+
+	//! Pure virtual method. See subclass implementation.
+	virtual void projectZone(int index, bool isInsideViewport, const RCMag* rcmag_table, int limitMagIndex,
+				 StelCore* core, const StelProjectorP& prj, const QVector<SphericalCap>& boundingCaps,
+				 QVector<ProjectedStar>& result) const = 0;
+
+	//! Pure virtual method. See subclass implementation.
+	virtual void drawProjectedZone(StelPainter* sPainter, int index, const QVector<ProjectedStar>& stars,
+				       StelCore* core, int maxMagStarName, float names_brightness, StelPickBuffer::Layer* pickLayer) const = 0;
+
+	//! Pure virtual method. See subclass implementation.
+	virtual StelObjectP createStelObject(int index, int star) const = 0;
+
+	//! Get the id of a star in the pick buffer of StarMgr.
+	//! The id uses 48 bits, so that it is also the index of the star in object handles, see StarMgr::getObjectIndex().
+	quint64 getPickId(int index, int star) const
+	{
+		return (static_cast<quint64>(level) << 44) | (static_cast<quint64>(index) << 24) | static_cast<quint64>(star);
+	}
+
+	//! Get the number of zones of this catalog.
+	unsigned int getNrOfZones() const { return nr_of_zones; }
+
+	//! Get the number of stars in the zone at the given index.
+	int getZoneSize(int index) const { return zones[index].size; }
+
+	//! Get the index of the faintest magnitude step to be drawn, taking into account
+	//! the custom magnitude limit of the sky drawer.
+	int getCutoffMagStep(const StelSkyDrawer* drawer, int limitMagIndex) const;
+
+	//! Whether the stars of this catalog may be drawn by StarZoneRenderer, i.e. they have no names or halos to draw on the CPU.
+	virtual bool supportsStaticBuffers() const {return false;}
+
+	//! Pure virtual method. See subclass implementation.
+	virtual void fillStaticBuffer(int index, double jde, StarZoneRecord* records) const = 0;
+
+	//! Pure virtual method. See subclass implementation.
+	virtual int getNrOfStarsUpToMagStep(int index, int magStep) const = 0;
 
 	//! Get whether or not the catalog was successfully loaded.
 	//! @return @c true if at least one zone was loaded, otherwise @c false
@@ -130,6 +220,16 @@ public:
 
 	float star_position_scale;
 
+	//! Set how long the J2000 positions of stars with proper motion applied are reused while drawing.
+	//! @param days maximum difference in JDE between the frame and the epoch of the cached positions.
+	//! A negative value disables the cache.
+	//! @param maxStars maximum number of cached positions per catalog
+	static void setPositionCacheParams(double days, int maxStars)
+	{
+		positionCacheTolerance = days;
+		positionCacheMaxStars = maxStars;
+	}
+
 protected:
 	//! Load a catalog and display its progress on the splash screen.
 	//! @return @c true if successful, or @c false if an error occurred
@@ -141,6 +241,9 @@ protected:
 	unsigned int nr_of_stars;
 	ZoneData *zones;
 	QFile* file;
+
+	static double positionCacheTolerance;
+	static int positionCacheMaxStars;
 };
 
 //! @class SpecialZoneArray
@@ -160,16 +263,26 @@ public:
 	//! @param mag_min lower bound of magnitudes
 	//! @param mag_range range of magnitudes
 	//! @param mag_steps number of steps used to describe values in range
+	//! @param lazy_budget if positive, load zones on demand and keep at most this many bytes of stars resident
+	//! @param stream if not null, read zones through it in lazy mode, see ZoneArray::create()
 	SpecialZoneArray(QFile* file,bool byte_swap,bool use_mmap,int level,int mag_min,
-			 int mag_range,int mag_steps);
+			 int mag_range,int mag_steps,qint64 lazy_budget=0,StarCatalogStream* stream=Q_NULLPTR);
 	~SpecialZoneArray(void);
+
+	//! Get the index of a zone of this catalog.
+	int getZoneIndex(const SpecialZoneData<Star>* z) const { return static_cast<int>(z - getZones()); }
 protected:
 	//! Get an array of all SpecialZoneData objects in this catalog.
+	//! @note in lazy mode the stars of a zone may not be loaded, use getZone() to access them.
 	SpecialZoneData<Star> *getZones(void) const
 	{
 		return static_cast<SpecialZoneData<Star>*>(zones);
 	}
 
+	//! Get the zone at the given index, reading its stars from the catalog first if
+	//! they are not resident yet in lazy mode.
+	const SpecialZoneData<Star> *getZone(int index) const;
+
 	//! Draw stars and their names onto the viewport.
 	//! @param sPainter the painter to use 
 	//! @param index zone index to draw
@@ -179,18 +292,122 @@ protected:
 	//! @param core core to use for drawing
 	//! @param maxMagStarName magnitude limit of stars that display labels
 	//! @param names_brightness brightness of labels
+	//! @param pickLayer if not Q_NULLPTR, the drawn stars are added to it
 	virtual void draw(StelPainter* sPainter, int index, bool isInsideViewport,
 			  const RCMag *rcmag_table, int limitMagIndex, StelCore* core,
 			  int maxMagStarName, float names_brightness,
-			  const QVector<SphericalCap>& boundingCaps) const;
+			  const QVector<SphericalCap>& boundingCaps, StelPickBuffer::Layer* pickLayer) const;
+
+	//! Zones are only loaded on demand in lazy mode, which must happen on a single thread.
+	virtual bool supportsParallelProjection() const {return lazy_budget <= 0;}
+
+	//! Do everything which needs exclusive access to this catalog before projectZone() is called for a zone:
+	//! load its stars in lazy mode and reserve room for its positions in the cache.
+	//! @param index zone index
+	//! @param core core to use for drawing
+	//! @param limitMagIndex index from rcmag_table at which stars are not visible anymore
+	virtual void prepareZone(int index, StelCore* core, int limitMagIndex) const;
+
+	//! Collect the visible stars of a zone and project them onto the viewport. This does not
+	//! draw anything, and for different zones it can run in parallel once prepareZone() was called.
+	//! @param index zone index
+	//! @param isInsideViewport whether the zone is inside the current viewport
+	//! @param rcmag_table table of magnitudes
+	//! @param limitMagIndex index from rcmag_table at which stars are not visible anymore
+	//! @param core core to use for drawing
+	//! @param prj the projector to use
+	//! @param boundingCaps bounding caps of the viewport, used to cull stars of zones on its border
+	//! @param result stars which passed the culling tests are appended to it
+	virtual void projectZone(int index, bool isInsideViewport, const RCMag* rcmag_table, int limitMagIndex,
+				 StelCore* core, const StelProjectorP& prj, const QVector<SphericalCap>& boundingCaps,
+				 QVector<ProjectedStar>& result) const;
+
+	//! Draw the stars of a zone returned by projectZone() and their names. Must be called from the render thread.
+	//! @param sPainter the painter to use
+	//! @param index zone index
+	//! @param stars the result of projectZone()
+	//! @param core core to use for drawing
+	//! @param maxMagStarName magnitude limit of stars that display labels
+	//! @param names_brightness brightness of labels
+	//! @param pickLayer if not Q_NULLPTR, the drawn stars are added to it
+	virtual void drawProjectedZone(StelPainter* sPainter, int index, const QVector<ProjectedStar>& stars,
+				       StelCore* core, int maxMagStarName, float names_brightness, StelPickBuffer::Layer* pickLayer) const;
+
+	//! Create the StelObject of a star.
+	//! @param index zone index
+	//! @param star index of the star in the zone
+	virtual StelObjectP createStelObject(int index, int star) const;
 
 	virtual void scaleAxis();
 	virtual void searchAround(const StelCore* core, int index,const Vec3d &v,double cosLimFov,
 					  QList<StelObjectP > &result);
+	//! Call a function for each star of a zone inside a cone, without creating StelObjects.
+	//! @param index zone index
+	//! @param v the direction of the axis of the cone
+	//! @param cosLimFov the cosine of the half aperture of the cone
+	//! @param func called for each star found
+	//! @return false if func stopped the search
+	virtual bool searchAround(const StelCore* core, int index, const Vec3d &v, double cosLimFov,
+				  const StarViewFunc& func) const;
+	//! Find the stars of a zone which are inside a cap and not fainter than a magnitude step.
+	//! @param jde the epoch for which proper motion is applied
+	//! @param index zone index
+	//! @param cap the region to search
+	//! @param magStep the faintest magnitude step to return
+	//! @param result receives the stars found
+	//! @param positions receives the J2000 unit vectors of the stars found at epoch jde
+	virtual void searchBrighterThan(double jde, int index, const SphericalCap& cap, int magStep,
+					QList<StelObjectP>& result, QVector<Vec3d>& positions);
+
+	//! Zones of streamed catalogs are empty until they were downloaded.
+	virtual bool supportsStaticBuffers() const {return stream == Q_NULLPTR;}
+
+	//! Write the position at epoch jde, magnitude and color of all stars of a zone.
+	//! @param index zone index
+	//! @param jde the epoch for which proper motion is applied
+	//! @param records array of at least getZoneSize(index) records
+	virtual void fillStaticBuffer(int index, double jde, StarZoneRecord* records) const;
+
+	//! Get the number of stars of a zone which are not fainter than the given magnitude step.
+	//! Stars in a zone are sorted by magnitude, so these are the first ones.
+	virtual int getNrOfStarsUpToMagStep(int index, int magStep) const;
 
 	Star *stars;
 private:
+	//! Release the least recently used zones until the resident stars fit into the lazy loading budget.
+	void evictZones(qint64 needed) const;
+
+	//! Get the normalized J2000 positions at epoch jde of the first count stars of a zone.
+	//! They are computed once and reused while jde stays within positionCacheTolerance of the epoch they were computed for.
+	//! @return Q_NULLPTR if prepareZone() did not reserve room for them
+	const Vec3f* getJ2000Positions(const SpecialZoneData<Star>* z, int index, double jde, int count) const;
+
+	struct PositionCache
+	{
+		double jde;
+		int valid;			// number of positions computed for jde
+		QVector<Vec3f> positions;
+	};
+	// The hash is only modified by prepareZone(), entries are updated by projectZone().
+	mutable QHash<int, PositionCache*> position_cache;
+	mutable int position_cache_size;	// total number of positions in position_cache
+
+	// Reused by draw() to avoid allocations for each zone.
+	mutable QVector<ProjectedStar> draw_buffer;
+
 	uchar *mmap_start;
+
+	// Lazy loading state, only used when lazy_budget is positive.
+	qint64 lazy_budget;
+	QVector<qint64> zone_offsets;		// file offset of the stars of each zone
+	mutable QVector<quint64> zone_last_use;	// value of use_counter when the zone was last accessed
+	mutable QVector<int> resident_zones;
+	mutable qint64 resident_bytes;
+	mutable quint64 use_counter;
+
+	// Streaming state, getZone() returns pending_zone for zones which were not downloaded yet.
+	StarCatalogStream* stream;
+	SpecialZoneData<Star> pending_zone;
 };
 
 //! @class HipZoneArray
@@ -207,6 +424,9 @@ public:
 	//! Add Hipparcos information for all stars in this catalog into @em hipIndex.
 	//! @param hipIndex array of Hipparcos info structs
 	void updateHipIndex(HipIndexStruct hipIndex[]) const;
+
+	//! Hipparcos stars have names and halos
+	bool supportsStaticBuffers() const {return false;}
 };
 
 #endif // ZONEARRAY_HPP
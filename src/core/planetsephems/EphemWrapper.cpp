@@ -31,6 +31,12 @@ Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
 #include "de430.hpp"
 #include "pluto.h"
 
+#include <QHash>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QVarLengthArray>
+#include <cmath>
+
 #define EPHEM_MERCURY_ID  0
 #define EPHEM_VENUS_ID    1
 #define EPHEM_EMB_ID      2
@@ -58,6 +64,190 @@ Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
 **            7 = uranus 
 **/
 
+// Bodies of the Chebyshev cache beyond the VSOP87 ids 0..8.
+#define EPHEM_CHEBYSHEV_EARTH_ID 9
+#define EPHEM_CHEBYSHEV_MOON_ID  10
+#define EPHEM_CHEBYSHEV_BODIES   11
+
+namespace
+{
+	// Segment lengths (days) and polynomial degrees, similar to those used in the DE4xx files.
+	struct ChebyshevBody
+	{
+		double segmentDays;
+		int degree;
+	};
+	const ChebyshevBody chebyshevBodies[EPHEM_CHEBYSHEV_BODIES] =
+	{
+		{  8., 13 },	// Mercury
+		{ 16., 10 },	// Venus
+		{ 16., 12 },	// EMB
+		{ 32., 10 },	// Mars
+		{ 64.,  7 },	// Jupiter
+		{ 64.,  7 },	// Saturn
+		{ 64.,  6 },	// Uranus
+		{ 64.,  6 },	// Neptune
+		{ 64.,  6 },	// Pluto (not used, Pluto has no VSOP87 series)
+		{  4., 12 },	// Earth, which includes the monthly motion around the EMB
+		{  4., 12 }	// Moon
+	};
+	// A segment is fitted once it has been queried this many times, so that sparse sweeps don't pay for fits.
+	const int CHEBYSHEV_FIT_QUERIES = 8;
+	// Largest accepted deviation of the fit from the theory, relative to the distance of the body.
+	// 1E-9 is 0.2 mas, far below the accuracy of VSOP87 and ELP82B.
+	const double CHEBYSHEV_TOLERANCE = 1E-9;
+	// Number of segments kept per body before its cache is cleared.
+	const int CHEBYSHEV_MAX_SEGMENTS = 1024;
+
+	struct ChebyshevSegment
+	{
+		ChebyshevSegment() : queries(0), fitted(false), rejected(false) {}
+		int queries;
+		bool fitted;
+		bool rejected;		// the fit was not accurate enough, always use the theory
+		QVector<double> coeffs;	// degree+1 coefficients for each of the 6 components, the first one halved
+	};
+
+	// The series of VSOP87, ELP82B and of the theories of the moons keep interpolated elements in static variables.
+	// All their evaluations are serialised, so that positions can be computed from any thread.
+	QMutex theoryMutex;
+
+	bool chebyshevEnabled = true;
+	QReadWriteLock chebyshevLock;
+	QHash<qint64, ChebyshevSegment> chebyshevSegments[EPHEM_CHEBYSHEV_BODIES];
+
+	// Evaluates the series of the theory for one of the bodies of the Chebyshev cache.
+	void get_theory_coor(const double jd, const int body, double xyz6[6])
+	{
+		QMutexLocker locker(&theoryMutex);
+		if (body==EPHEM_CHEBYSHEV_MOON_ID)
+		{
+			GetElp82bCoor(jd, xyz6);
+			xyz6[3]=xyz6[4]=xyz6[5]=0.0; // TODO: Some meaningful way to get speed?
+		}
+		else if (body==EPHEM_CHEBYSHEV_EARTH_ID)
+		{
+			double moon[3];
+			GetVsop87Coor(jd,EPHEM_EMB_ID,xyz6);
+			GetElp82bCoor(jd,moon);
+			/* Earth != EMB:
+		0.0121505677733761 = mu_m/(1+mu_m),
+		mu_m = mass(moon)/mass(earth) = 0.01230002 */
+			xyz6[0] -= 0.0121505677733761 * moon[0];
+			xyz6[1] -= 0.0121505677733761 * moon[1];
+			xyz6[2] -= 0.0121505677733761 * moon[2];
+			// TODO: HOW TO FIX EARTH SPEED?
+		}
+		else
+			GetVsop87Coor(jd, body, xyz6);
+	}
+
+	// Clenshaw evaluation of a Chebyshev series whose first coefficient is halved.
+	inline double chebyshev_value(const double* c, const int n, const double x)
+	{
+		double b1=0., b2=0.;
+		for (int j=n-1; j>0; --j)
+		{
+			const double b=2.*x*b1-b2+c[j];
+			b2=b1;
+			b1=b;
+		}
+		return x*b1-b2+c[0];
+	}
+
+	void chebyshev_evaluate(const QVector<double>& coeffs, const int n, const double x, double xyz6[6])
+	{
+		for (int c=0; c<6; ++c)
+			xyz6[c]=chebyshev_value(coeffs.constData()+c*n, n, x);
+	}
+
+	// Fits the segment [start, start+length] of body by interpolation at the Chebyshev nodes,
+	// and checks the fit against the theory at a few other points.
+	// @return false if the fit is not accurate enough.
+	bool chebyshev_fit(const int body, const double start, const double length, QVector<double>& coeffs)
+	{
+		const int n=chebyshevBodies[body].degree+1;
+		QVarLengthArray<double, 6*16> values(6*n);
+		for (int k=0; k<n; ++k)
+		{
+			const double x=std::cos(M_PI*(k+0.5)/n);
+			get_theory_coor(start+0.5*length*(x+1.), body, &values[6*k]);
+		}
+		coeffs.resize(6*n);
+		for (int c=0; c<6; ++c)
+		{
+			for (int j=0; j<n; ++j)
+			{
+				double sum=0.;
+				for (int k=0; k<n; ++k)
+					sum+=values[6*k+c]*std::cos(M_PI*j*(k+0.5)/n);
+				coeffs[c*n+j]=(j==0 ? 1. : 2.)*sum/n;
+			}
+		}
+
+		// The ends of the segment and points between the nodes.
+		static const double checks[] = { -1., -0.61, 0.13, 0.77, 1. };
+		for (double x : checks)
+		{
+			double exact[6], fitted[6];
+			get_theory_coor(start+0.5*length*(x+1.), body, exact);
+			chebyshev_evaluate(coeffs, n, x, fitted);
+			const double dx=fitted[0]-exact[0], dy=fitted[1]-exact[1], dz=fitted[2]-exact[2];
+			const double r2=exact[0]*exact[0]+exact[1]*exact[1]+exact[2]*exact[2];
+			if (dx*dx+dy*dy+dz*dz > CHEBYSHEV_TOLERANCE*CHEBYSHEV_TOLERANCE*r2)
+				return false;
+		}
+		return true;
+	}
+
+	// Gets the coordinates of body from its theory, through the Chebyshev cache if enabled.
+	void get_cached_theory_coor(const double jd, const int body, double xyz6[6])
+	{
+		if (!chebyshevEnabled)
+		{
+			get_theory_coor(jd, body, xyz6);
+			return;
+		}
+
+		const double length=chebyshevBodies[body].segmentDays;
+		const int n=chebyshevBodies[body].degree+1;
+		const qint64 index=static_cast<qint64>(std::floor((jd-2451545.0)/length));
+		const double start=2451545.0+index*length;
+		const double x=qBound(-1., 2.*(jd-start)/length-1., 1.);
+
+		{
+			QReadLocker locker(&chebyshevLock);
+			QHash<qint64, ChebyshevSegment>::const_iterator it=chebyshevSegments[body].constFind(index);
+			if (it!=chebyshevSegments[body].constEnd() && it->fitted)
+			{
+				chebyshev_evaluate(it->coeffs, n, x, xyz6);
+				return;
+			}
+		}
+
+		{
+			QWriteLocker locker(&chebyshevLock);
+			QHash<qint64, ChebyshevSegment>& segments=chebyshevSegments[body];
+			if (!segments.contains(index) && segments.size()>=CHEBYSHEV_MAX_SEGMENTS)
+				segments.clear();
+			ChebyshevSegment& segment=segments[index];
+			if (!segment.fitted && !segment.rejected && ++segment.queries>=CHEBYSHEV_FIT_QUERIES)
+			{
+				segment.fitted=chebyshev_fit(body, start, length, segment.coeffs);
+				segment.rejected=!segment.fitted;
+				if (segment.rejected)
+					segment.coeffs.clear();
+			}
+			if (segment.fitted)
+			{
+				chebyshev_evaluate(segment.coeffs, n, x, xyz6);
+				return;
+			}
+		}
+		get_theory_coor(jd, body, xyz6);
+	}
+}
+
 void EphemWrapper::init_de430(const char* filepath)
 {
 	InitDE430(filepath);
@@ -92,6 +282,29 @@ bool EphemWrapper::use_de431(const double jd)
 	return StelApp::getInstance().getCore()->de431IsActive() && EphemWrapper::jd_fits_de431(jd);
 }
 
+void EphemWrapper::set_chebyshev_cache_enabled(const bool enabled)
+{
+	QWriteLocker locker(&chebyshevLock);
+	chebyshevEnabled=enabled;
+	if (!enabled)
+	{
+		for (int i=0; i<EPHEM_CHEBYSHEV_BODIES; ++i)
+			chebyshevSegments[i].clear();
+	}
+}
+
+bool EphemWrapper::chebyshev_cache_enabled()
+{
+	return chebyshevEnabled;
+}
+
+void EphemWrapper::clear_chebyshev_cache()
+{
+	QWriteLocker locker(&chebyshevLock);
+	for (int i=0; i<EPHEM_CHEBYSHEV_BODIES; ++i)
+		chebyshevSegments[i].clear();
+}
+
 // planet_id is ONLY one of the #defined values 0..8 above.
 void get_planet_helio_coordsv(const double jd, double xyz[3], double xyzdot[3], const int planet_id)
 {
@@ -113,7 +326,7 @@ void get_planet_helio_coordsv(const double jd, double xyz[3], double xyzdot[3],
 	}
 	if (!deOk) //VSOP87 as fallback
 	{
-		GetVsop87Coor(jd, planet_id, xyz6);
+		get_cached_theory_coor(jd, planet_id, xyz6);
 	}
 	xyz[0]   =xyz6[0]; xyz[1]   =xyz6[1]; xyz[2]   =xyz6[2];
 	xyzdot[0]=xyz6[3]; xyzdot[1]=xyz6[4]; xyzdot[2]=xyz6[5];
@@ -142,6 +355,7 @@ void get_planet_helio_osculating_coordsv(double jd0, double jd, double xyz[3], d
 	}
 	if (!deOk) //VSOP87 as fallback
 	{
+		QMutexLocker locker(&theoryMutex);
 		GetVsop87OsculatingCoor(jd0, jd, planet_id, xyz6);
 	}
 	xyz[0]   =xyz6[0]; xyz[1]   =xyz6[1]; xyz[2]   =xyz6[2];
@@ -224,18 +438,9 @@ void get_earth_helio_coordsv(const double jd,double xyz[3], double xyzdot[3], vo
 	{
 		deOk=GetDe431Coor(jd, EPHEM_JPL_EARTH_ID, xyz6);
 	}
-	if (!deOk) //VSOP87 as fallback
+	if (!deOk) //VSOP87 as fallback, with Earth != EMB
 	{
-		double moon[3];
-		GetVsop87Coor(jd,EPHEM_EMB_ID,xyz6);
-		GetElp82bCoor(jd,moon);
-		/* Earth != EMB:
-	0.0121505677733761 = mu_m/(1+mu_m),
-	mu_m = mass(moon)/mass(earth) = 0.01230002 */
-		xyz6[0] -= 0.0121505677733761 * moon[0];
-		xyz6[1] -= 0.0121505677733761 * moon[1];
-		xyz6[2] -= 0.0121505677733761 * moon[2];
-		// TODO: HOW TO FIX EARTH SPEED?
+		get_cached_theory_coor(jd, EPHEM_CHEBYSHEV_EARTH_ID, xyz6);
 	}
 	xyz[0]   =xyz6[0]; xyz[1]   =xyz6[1]; xyz[2]   =xyz6[2];
 	xyzdot[0]=xyz6[3]; xyzdot[1]=xyz6[4]; xyzdot[2]=xyz6[5];
@@ -335,122 +540,142 @@ void get_lunar_parent_coordsv(double jde, double xyz[3], double xyzdot[3], void*
 	}
 	else
 	{  // fallback to DE-less solution.
-		GetElp82bCoor(jde,xyz);
-		xyzdot[0]=xyzdot[1]=xyzdot[2]=0.0; // TODO: Some meaningful way to get speed?
+		get_cached_theory_coor(jde, EPHEM_CHEBYSHEV_MOON_ID, xyz6);
+		xyz[0]   =xyz6[0]; xyz[1]   =xyz6[1]; xyz[2]   =xyz6[2];
+		xyzdot[0]=xyz6[3]; xyzdot[1]=xyz6[4]; xyzdot[2]=xyz6[5];
 	}
 }
 
 void get_phobos_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 {
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetMarsSatCoor(jd, MARS_SAT_PHOBOS, xyz, xyzdot);
 }
 
 void get_deimos_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 {
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetMarsSatCoor(jd, MARS_SAT_DEIMOS, xyz, xyzdot);
 }
 
 void get_io_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 {
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetL12Coor(jd, L12_IO, xyz, xyzdot);
 }
 
 void get_europa_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 {
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetL12Coor(jd, L12_EUROPA, xyz, xyzdot);
 }
 
 void get_ganymede_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 {
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetL12Coor(jd, L12_GANYMEDE, xyz, xyzdot);
 }
 
 void get_callisto_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 {
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetL12Coor(jd, L12_CALLISTO, xyz, xyzdot);
 }
 
 void get_mimas_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 { 
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetTass17Coor(jd, TASS17_MIMAS, xyz, xyzdot);
 }
 
 void get_enceladus_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 {
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetTass17Coor(jd, TASS17_ENCELADUS, xyz, xyzdot);
 }
 
 void get_tethys_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 { 
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetTass17Coor(jd, TASS17_TETHYS, xyz, xyzdot);
 }
 
 void get_dione_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 { 
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetTass17Coor(jd, TASS17_DIONE, xyz, xyzdot);
 }
 
 void get_rhea_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 { 
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetTass17Coor(jd, TASS17_RHEA, xyz, xyzdot);
 }
 
 void get_titan_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 { 
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetTass17Coor(jd, TASS17_TITAN, xyz, xyzdot);
 }
 
 void get_hyperion_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 { 
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetTass17Coor(jd, TASS17_HYPERION, xyz, xyzdot);
 }
 
 void get_iapetus_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 { 
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetTass17Coor(jd, TASS17_IAPETUS, xyz, xyzdot);
 }
 
 void get_miranda_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 {
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetGust86Coor(jd, GUST86_MIRANDA, xyz, xyzdot);
 }
 
 void get_ariel_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 {
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetGust86Coor(jd, GUST86_ARIEL, xyz, xyzdot);
 }
 
 void get_umbriel_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 {
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetGust86Coor(jd, GUST86_UMBRIEL, xyz, xyzdot);
 }
 
 void get_titania_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 {
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetGust86Coor(jd, GUST86_TITANIA, xyz, xyzdot);
 }
 
 void get_oberon_parent_coordsv(double jd, double xyz[3], double xyzdot[3], void* unused)
 {
 	Q_UNUSED(unused);
+	QMutexLocker locker(&theoryMutex);
 	GetGust86Coor(jd, GUST86_OBERON, xyz, xyzdot);
 }
 
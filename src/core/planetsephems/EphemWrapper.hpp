@@ -43,6 +43,16 @@ public:
     static bool jd_fits_de431(const double jd);
     static bool use_de430(const double jd);
     static bool use_de431(const double jd);
+
+    //! Enable or disable the Chebyshev approximation of the VSOP87 and ELP82B theories.
+    //! When enabled, a segment of a few days of the series of one body is fitted by Chebyshev polynomials
+    //! after it has been queried a few times, and later queries in this segment are evaluated from the fit.
+    //! Segments whose fit deviates from the theory by more than a fraction of its accuracy are never approximated.
+    //! The cache is not used while DE430 or DE431 provide the positions.
+    static void set_chebyshev_cache_enabled(const bool enabled);
+    static bool chebyshev_cache_enabled();
+    //! Forget all fitted segments.
+    static void clear_chebyshev_cache();
 };
 
 // These functions have an unused void pointer to be compatible to PosFuncType in SolarSystem and Planet classes.
@@ -52,6 +52,12 @@ struct jpl_eph_data {
    double *cache;
    struct interpolation_info iinfo;
    FILE *ifile;
+               /* Added for Stellarium: records are read from a memory   */
+               /* mapping of the file if possible,  see jpl_get_record() */
+   const unsigned char *map;
+   uint64_t map_size;
+   void *map_file;            /* the QFile which owns the mapping      */
+   void *block_cache;         /* LRU of decoded records (jpl_block_cache) */
    };
 #pragma pack()
 
@@ -63,6 +63,11 @@ details of the implementation encapsulated.
 #include <stdint.h>
 
 #include "StelUtils.hpp"
+
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVarLengthArray>
 /**** include variable and type definitions, specific for this C version */
 
 #include "jpleph.h"
@@ -80,6 +85,93 @@ details of the implementation encapsulated.
 #endif
 
 
+/* Stellarium: thread-safe access to the Chebyshev records.
+
+Records are read from a memory mapping of the whole file.  If the file is in
+native byte order,  jpl_state_internal() uses the coefficients directly from
+the mapping,  which needs neither locking nor a file handle per thread.  Else
+(byte-swapped files,  or files which cannot be mapped,  e.g. DE431 in a 32-bit
+build),  decoded records are kept in a small LRU cache shared by all threads
+and protected by a mutex.  The interpolation state and the barycentric Sun are
+kept on the stack of each call instead of in jpl_eph_data.               */
+
+#define JPL_BLOCK_CACHE_SIZE 8
+
+struct jpl_block_cache
+{
+   QMutex mutex;
+   uint32_t nr[JPL_BLOCK_CACHE_SIZE];
+   uint64_t last_use[JPL_BLOCK_CACHE_SIZE];
+   uint64_t use_count;
+   double *blocks;      /* JPL_BLOCK_CACHE_SIZE records of ncoeff doubles */
+};
+
+static void swap_64_bit_val(void *ptr, long count);
+
+static int jpl_state_internal(const struct jpl_eph_data *eph, const double et, const int list[14],
+                          double pv[][6], double nut[4], const int bary,
+                          const int calc_pvsun, double pvsun[9]);
+
+/* Get the coefficients of record 'nr'.  'buf' must hold ncoeff doubles;  it
+is used unless the coefficients can be used directly from the mapping.
+Returns NULL and sets 'err' on errors.                                     */
+static const double *jpl_get_record(const struct jpl_eph_data *eph, const uint32_t nr,
+                          double *buf, int *err)
+{
+   const uint64_t offset = (uint64_t)(nr + 2) * eph->recsize; /* two blocks of header */
+   const size_t bytes = (size_t)eph->ncoeff * sizeof(double);
+
+   if(eph->map && offset + bytes > eph->map_size)
+   {
+      *err = JPL_EPH_READ_ERROR;
+      return(NULL);
+   }
+   if(eph->map && !eph->swap_bytes)
+      return((const double *)(eph->map + offset));
+
+   struct jpl_block_cache *cache = (struct jpl_block_cache *)eph->block_cache;
+   QMutexLocker lock(&cache->mutex);
+   unsigned i, lru = 0;
+
+   cache->use_count++;
+   for(i = 0; i < JPL_BLOCK_CACHE_SIZE; i++)
+   {
+      if(cache->nr[i] == nr)
+      {
+         cache->last_use[i] = cache->use_count;
+         memcpy(buf, cache->blocks + i * eph->ncoeff, bytes);
+         return(buf);
+      }
+      if(cache->last_use[i] < cache->last_use[lru])
+         lru = i;
+   }
+
+   double *block = cache->blocks + lru * eph->ncoeff;
+   cache->nr[lru] = (uint32_t)-1;
+   if(eph->map)
+      memcpy(block, eph->map + offset, bytes);
+   else
+   {
+      if(FSeek(eph->ifile, offset, SEEK_SET))
+      {
+         *err = JPL_EPH_FSEEK_ERROR;
+         return(NULL);
+      }
+      if(fread(block, sizeof(double), (size_t)eph->ncoeff, eph->ifile)
+                  != (size_t)eph->ncoeff)
+      {
+         *err = JPL_EPH_READ_ERROR;
+         return(NULL);
+      }
+   }
+   if(eph->swap_bytes)
+      swap_64_bit_val(block, eph->ncoeff);
+   cache->nr[lru] = nr;
+   cache->last_use[lru] = cache->use_count;
+   memcpy(buf, block, bytes);
+   return(buf);
+}
+
 double DLL_FUNC jpl_get_double(const void *ephem, const int value)
 {
    return(*(double *)((char *)ephem + value));
@@ -213,11 +305,12 @@ int DLL_FUNC jpl_pleph(void *ephem, const double et, const int ntarg,
     }
 
   /*   make call to state   */
-   rval = jpl_state(eph, et, list, pv, rrd, 1);
+   double pvsun[9];
+   rval = jpl_state_internal(eph, et, list, pv, rrd, 1, (ntarg == 11 || ncent == 11), pvsun);
    /* Solar System barycentric Sun state goes to pv[10][] */
    if(ntarg == 11 || ncent == 11)
       for(i = 0; i < 6; i++)
-         pv[10][i] = eph->pvsun[i];
+         pv[10][i] = pvsun[i];
 
    /* Solar System Barycenter coordinates & velocities equal to zero */
    if(ntarg == 12 || ncent == 12)
@@ -581,13 +674,32 @@ int DLL_FUNC jpl_state(void *ephem, const double et, const int list[14],
                           double pv[][6], double nut[4], const int bary)
 {
 	struct jpl_eph_data *eph = (struct jpl_eph_data *)ephem;
+	double pvsun[9];
+	const int rval = jpl_state_internal(eph, et, list, pv, nut, bary, 1, pvsun);
+
+	/* Kept for jpl_get_pvsun().  Note that this is not thread-safe. */
+	if(!rval)
+	{
+		memcpy(eph->pvsun, pvsun, sizeof(pvsun));
+		eph->pvsun_t = et;
+	}
+	return(rval);
+}
+
+/* Same as jpl_state(),  but thread-safe:  the interpolation state and the
+solar system barycentric Sun (computed if calc_pvsun or !bary) are local.  */
+static int jpl_state_internal(const struct jpl_eph_data *eph, const double et, const int list[14],
+                          double pv[][6], double nut[4], const int bary,
+                          const int calc_pvsun, double pvsun[9])
+{
 	unsigned i, j, n_intervals;
 	uint32_t nr;
-	double *buf = eph->cache;
 	double t[2];
 	const double block_loc = (et - eph->ephem_start) / eph->ephem_step;
-	bool recompute_pvsun;
+	const bool need_pvsun = (calc_pvsun || !bary);
 	const double aufac = 1.0 / eph->au;
+	struct interpolation_info iinfo;
+	int err = 0;
 
 	/*   error return for epoch out of range  */
 	if(et < eph->ephem_start || et > eph->ephem_end)
@@ -603,33 +715,19 @@ int DLL_FUNC jpl_state(void *ephem, const double et, const int list[14],
 		nr--;
 	}
 
-	/*   read correct record if not in core (static vector buf[])   */
-	if(nr != eph->curr_cache_loc)
-	{
-		eph->curr_cache_loc = nr;
-		/* Read two blocks ahead to account for header: */
-		if(FSeek(eph->ifile, (nr + 2) * eph->recsize, SEEK_SET))
-		{
-			// GZ: Make sure we will try again on next call...
-			eph->curr_cache_loc=0;
-			return(JPL_EPH_FSEEK_ERROR);
-		}
-		if(fread(buf, sizeof(double), (size_t)eph->ncoeff, eph->ifile)
-				!= (size_t)eph->ncoeff)
-			return(JPL_EPH_READ_ERROR);
-
-		if(eph->swap_bytes)
-			swap_64_bit_val(buf, eph->ncoeff);
-	}
+	/*   get the record,  from the mapping or from the block cache   */
+	QVarLengthArray<double, 1024> record(eph->ncoeff);
+	const double *buf = jpl_get_record(eph, nr, record.data(), &err);
+	if(!buf)
+		return(err);
 	t[1] = eph->ephem_step;
 
-	if(eph->pvsun_t != et)   /* If several calls are made for the same et, */
-	{                      /* don't recompute pvsun each time... only on */
-		recompute_pvsun = true;   /* the first run through.                     */
-		eph->pvsun_t = et;
-	}
-	else
-		recompute_pvsun = false;
+	iinfo.posn_coeff[0] = 1.0;
+	/* Bogus value, corrected by the first call to 'interp'.  */
+	iinfo.posn_coeff[1] = -2.0;
+	iinfo.vel_coeff[0] = 0.0;
+	iinfo.vel_coeff[1] = 1.0;
+	iinfo.n_posn_avail = iinfo.n_vel_avail = 2;
 
 	/* Here, i loops through the "traditional" 14 listed items -- 10
 	  solar system objects,  nutations,  librations,  lunar mantle angles,
@@ -642,11 +740,11 @@ int DLL_FUNC jpl_state(void *ephem, const double et, const int list[14],
 		for(i = 0; i < 15; i++)
 		{
 			unsigned quantities;
-			uint32_t *iptr = &eph->ipt[i + 1][0];
+			const uint32_t *iptr;
 
 			if(i == 14)
 			{
-				quantities = (recompute_pvsun ? 3 : 0);
+				quantities = (need_pvsun ? 3 : 0);
 				iptr = &eph->ipt[10][0];
 			}
 			else
@@ -656,15 +754,15 @@ int DLL_FUNC jpl_state(void *ephem, const double et, const int list[14],
 			}
 			if(n_intervals == iptr[2] && quantities)
 			{
-				double *dest = ((i == 10) ? eph->pvsun : pv[i]);
+				double *dest;
 
 				if(i < 10)
 					dest = pv[i];
 				else if(i == 14)
-					dest = eph->pvsun;
+					dest = pvsun;
 				else
 					dest = nut;
-				interp(&eph->iinfo, &buf[iptr[0]-1], t, (int)iptr[1],
+				interp(&iinfo, &buf[iptr[0]-1], t, (int)iptr[1],
 						dimension(i + 1),
 						n_intervals, quantities, dest);
 
@@ -676,7 +774,7 @@ int DLL_FUNC jpl_state(void *ephem, const double et, const int list[14],
 	if(!bary)                             /* gotta correct everybody for */
 		for(i = 0; i < 9; i++)            /* the solar system barycenter */
 			for(j = 0; j < (unsigned)list[i] * 3; j++)
-				pv[i][j] -= eph->pvsun[j];
+				pv[i][j] -= pvsun[j];
 	return(0);
 }
 
@@ -902,6 +1000,42 @@ void * DLL_FUNC jpl_init_ephemeris(const char *ephemeris_filename,
     
               /* The 'cache' data is right after the 'jpl_eph_data' struct: */
     rval->cache = (double *)(rval + 1);
+
+               /* Map the whole file for jpl_get_record().  If this fails,  */
+               /* records are read with fread() into the block cache.       */
+    rval->map = NULL;
+    rval->map_size = 0;
+    rval->map_file = NULL;
+    rval->block_cache = NULL;
+    {
+      QFile *map_file = new QFile(QString::fromLocal8Bit(ephemeris_filename));
+      const uchar *map = NULL;
+      if(map_file->open(QIODevice::ReadOnly))
+        map = map_file->map(0, map_file->size());
+      if(map)
+      {
+        rval->map = map;
+        rval->map_size = (uint64_t)map_file->size();
+        rval->map_file = map_file;
+      }
+      else
+      {
+        qWarning() << "Cannot map" << ephemeris_filename << "into memory, reading it from file";
+        delete map_file;
+      }
+    }
+    if(!rval->map || rval->swap_bytes)
+    {
+      struct jpl_block_cache *cache = new struct jpl_block_cache;
+      for(i = 0; i < JPL_BLOCK_CACHE_SIZE; i++)
+      {
+        cache->nr[i] = (uint32_t)-1;
+        cache->last_use[i] = 0;
+      }
+      cache->use_count = 0;
+      cache->blocks = new double[JPL_BLOCK_CACHE_SIZE * rval->ncoeff];
+      rval->block_cache = cache;
+    }
                /* If there are more than 400 constants,  the names of       */
                /* the extra constants are stored in what would normally     */
                /* be zero-padding after the header record.  However,        */
@@ -958,6 +1092,13 @@ void DLL_FUNC jpl_close_ephemeris(void *ephem)
 {
    struct jpl_eph_data *eph = (struct jpl_eph_data *)ephem;
 
+   delete (QFile *)eph->map_file;  /* also removes the mapping */
+   if(eph->block_cache)
+   {
+      struct jpl_block_cache *cache = (struct jpl_block_cache *)eph->block_cache;
+      delete[] cache->blocks;
+      delete cache;
+   }
    fclose(eph->ifile);
    free(ephem);
 }
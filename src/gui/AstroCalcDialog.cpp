@@ -26,10 +26,14 @@
 #include "StelTranslator.hpp"
 #include "StelLocaleMgr.hpp"
 #include "StelFileMgr.hpp"
+#include "StelProgressController.hpp"
 #include "AngleSpinBox.hpp"
 
 #include "SolarSystem.hpp"
 #include "Planet.hpp"
+#include "RiseSetSolver.hpp"
+#include "OccultationFinder.hpp"
+#include "PositionsQuery.hpp"
 #include "NebulaMgr.hpp"
 #include "Nebula.hpp"
 
@@ -38,6 +42,10 @@
 #endif
 
 #include "AstroCalcDialog.hpp"
+#include "AstroCalcPositionsModel.hpp"
+#include "AstroCalcTimeline.hpp"
+#include "AstroCalcEphemerisModel.hpp"
+#include "AstroCalcPhenomenaModel.hpp"
 #include "ui_astroCalcDialog.h"
 #include "external/qcustomplot/qcustomplot.h"
 
@@ -76,8 +84,16 @@ QString AstroCalcDialog::yAxis2Legend = "";
 AstroCalcDialog::AstroCalcDialog(QObject* parent)
 	: StelDialog("AstroCalc", parent)
 	, wutModel(Q_NULLPTR)
+	, positionsModel(Q_NULLPTR)
+	, ephemerisModel(Q_NULLPTR)
+	, phenomenaModel(Q_NULLPTR)
+	, timeline(Q_NULLPTR)
 	, proxyModel(Q_NULLPTR)
 	, currentTimeLine(Q_NULLPTR)
+	, ephemerisGenerator(Q_NULLPTR)
+	, ephemerisProgress(Q_NULLPTR)
+	, ephemerisTimer(Q_NULLPTR)
+	, ephemerisWithTime(false)
 	, plotAltVsTime(false)	
 	, plotAltVsTimeSun(false)
 	, plotAltVsTimeMoon(false)
@@ -98,6 +114,7 @@ AstroCalcDialog::AstroCalcDialog(QObject* parent)
 	mvMgr = GETSTELMODULE(StelMovementMgr);
 	localeMgr = &StelApp::getInstance().getLocaleMgr();
 	conf = StelApp::getInstance().getSettings();
+	timeline = new AstroCalcTimeline(core);
 	ephemerisHeader.clear();
 	phenomenaHeader.clear();
 	positionsHeader.clear();
@@ -105,12 +122,18 @@ AstroCalcDialog::AstroCalcDialog(QObject* parent)
 
 AstroCalcDialog::~AstroCalcDialog()
 {
+	if (ephemerisGenerator)
+	{
+		delete ephemerisGenerator;
+		StelApp::getInstance().removeProgressBar(ephemerisProgress);
+	}
 	if (currentTimeLine)
 	{
 		currentTimeLine->stop();
 		delete currentTimeLine;
 		currentTimeLine = Q_NULLPTR;
 	}
+	delete timeline;
 	delete ui;
 }
 
@@ -153,7 +176,7 @@ void AstroCalcDialog::createDialogContent()
 	ui->setupUi(dialog);
 
 	// Kinetic scrolling
-	kineticScrollingList << ui->celestialPositionsTreeWidget << ui->ephemerisTreeWidget << ui->phenomenaTreeWidget
+	kineticScrollingList << ui->celestialPositionsTreeView << ui->ephemerisTreeView << ui->phenomenaTreeView
 			     << ui->wutCategoryListWidget << ui->wutMatchingObjectsListView;
 	StelGui* gui= dynamic_cast<StelGui*>(StelApp::getInstance().getGui());
 	if (gui)
@@ -175,6 +198,12 @@ void AstroCalcDialog::createDialogContent()
 	connect(ui->closeStelWindow, SIGNAL(clicked()), this, SLOT(close()));
 	connect(ui->TitleBar, SIGNAL(movedTo(QPoint)), this, SLOT(handleMovedTo(QPoint)));
 
+	positionsModel = new AstroCalcPositionsModel(core, this);
+	ui->celestialPositionsTreeView->setModel(positionsModel);
+	ephemerisModel = new AstroCalcEphemerisModel(this);
+	ui->ephemerisTreeView->setModel(ephemerisModel);
+	phenomenaModel = new AstroCalcPhenomenaModel(this);
+	ui->phenomenaTreeView->setModel(phenomenaModel);
 	initListCelestialPositions();
 	initListPhenomena();
 	populateCelestialBodyList();
@@ -213,7 +242,7 @@ void AstroCalcDialog::createDialogContent()
 	ui->phenomenToDateEdit->setMinimumDate(min);
 
 	// bug #1350669 (https://bugs.launchpad.net/stellarium/+bug/1350669)
-	connect(ui->celestialPositionsTreeWidget, SIGNAL(currentItemChanged(QTreeWidgetItem*, QTreeWidgetItem*)), ui->celestialPositionsTreeWidget, SLOT(repaint()));
+	connect(ui->celestialPositionsTreeView->selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)), ui->celestialPositionsTreeView, SLOT(repaint()));
 
 	ui->celestialMagnitudeDoubleSpinBox->setValue(conf->value("astrocalc/celestial_magnitude_limit", 6.0).toDouble());
 	connect(ui->celestialMagnitudeDoubleSpinBox, SIGNAL(valueChanged(double)), this,  SLOT(saveCelestialPositionsMagnitudeLimit(double)));
@@ -221,7 +250,7 @@ void AstroCalcDialog::createDialogContent()
 	ui->horizontalCoordinatesCheckBox->setChecked(conf->value("astrocalc/flag_horizontal_coordinates", false).toBool());
 	connect(ui->horizontalCoordinatesCheckBox, SIGNAL(toggled(bool)), this, SLOT(saveCelestialPositionsHorizontalCoordinatesFlag(bool)));
 
-	connect(ui->celestialPositionsTreeWidget, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(selectCurrentCelestialPosition(QModelIndex)));
+	connect(ui->celestialPositionsTreeView, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(selectCurrentCelestialPosition(QModelIndex)));
 	connect(ui->celestialPositionsUpdateButton, SIGNAL(clicked()), this, SLOT(currentCelestialPositions()));
 	connect(ui->celestialPositionsSaveButton, SIGNAL(clicked()), this, SLOT(saveCelestialPositions()));
 	connect(ui->celestialCategoryComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(saveCelestialPositionsCategory(int)));
@@ -237,11 +266,15 @@ void AstroCalcDialog::createDialogContent()
 	connectBoolProperty(ui->ephemerisHorizontalCoordinatesCheckBox, "SolarSystem.ephemerisHorizontalCoordinates");
 	initListEphemeris();
 	connect(ui->ephemerisHorizontalCoordinatesCheckBox, SIGNAL(toggled(bool)), this, SLOT(reGenerateEphemeris()));
-	connect(ui->ephemerisPushButton, SIGNAL(clicked()), this, SLOT(generateEphemeris()));
+	ephemerisButtonText = ui->ephemerisPushButton->text();
+	ephemerisTimer = new QTimer(this);
+	ephemerisTimer->setInterval(100);
+	connect(ephemerisTimer, SIGNAL(timeout()), this, SLOT(updateEphemeris()));
+	connect(ui->ephemerisPushButton, SIGNAL(clicked()), this, SLOT(toggleEphemeris()));
 	connect(ui->ephemerisCleanupButton, SIGNAL(clicked()), this, SLOT(cleanupEphemeris()));
 	connect(ui->ephemerisSaveButton, SIGNAL(clicked()), this, SLOT(saveEphemeris()));
-	connect(ui->ephemerisTreeWidget, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(selectCurrentEphemeride(QModelIndex)));
-	connect(ui->ephemerisTreeWidget, SIGNAL(clicked(QModelIndex)), this, SLOT(onChangedEphemerisPosition(QModelIndex)));
+	connect(ui->ephemerisTreeView, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(selectCurrentEphemeride(QModelIndex)));
+	connect(ui->ephemerisTreeView, SIGNAL(clicked(QModelIndex)), this, SLOT(onChangedEphemerisPosition(QModelIndex)));
 	connect(ui->ephemerisStepComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(saveEphemerisTimeStep(int)));
 	connect(ui->celestialBodyComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(saveEphemerisCelestialBody(int)));
 
@@ -259,7 +292,7 @@ void AstroCalcDialog::createDialogContent()
 
 	connect(ui->phenomenaPushButton, SIGNAL(clicked()), this, SLOT(calculatePhenomena()));
 	connect(ui->phenomenaCleanupButton, SIGNAL(clicked()), this, SLOT(cleanupPhenomena()));
-	connect(ui->phenomenaTreeWidget, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(selectCurrentPhenomen(QModelIndex)));
+	connect(ui->phenomenaTreeView, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(selectCurrentPhenomen(QModelIndex)));
 	connect(ui->phenomenaSaveButton, SIGNAL(clicked()), this, SLOT(savePhenomena()));
 	connect(ui->object1ComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(savePhenomenaCelestialBody(int)));
 	connect(ui->object2ComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(savePhenomenaCelestialGroup(int)));
@@ -441,11 +474,10 @@ void AstroCalcDialog::saveAltVsTimePositiveFlag(bool state)
 
 void AstroCalcDialog::initListCelestialPositions()
 {
-	ui->celestialPositionsTreeWidget->clear();
-	ui->celestialPositionsTreeWidget->setColumnCount(CColumnCount);
+	positionsModel->setRows(QVector<AstroCalcPositionsModel::Row>(), AstroCalcPositionsModel::Format(), core->getJD());
 	setCelestialPositionsHeaderNames();
-	ui->celestialPositionsTreeWidget->header()->setSectionsMovable(false);
-	ui->celestialPositionsTreeWidget->header()->setDefaultAlignment(Qt::AlignHCenter);
+	ui->celestialPositionsTreeView->header()->setSectionsMovable(false);
+	ui->celestialPositionsTreeView->header()->setDefaultAlignment(Qt::AlignHCenter);
 }
 
 void AstroCalcDialog::setCelestialPositionsHeaderNames()
@@ -515,17 +547,18 @@ void AstroCalcDialog::setCelestialPositionsHeaderNames()
 	// TRANSLATORS: type of object
 	positionsHeader << q_("Type");
 
-	ui->celestialPositionsTreeWidget->setHeaderLabels(positionsHeader);
+	positionsModel->setHeaderLabels(positionsHeader);
 	// adjust the column width
 	for (int i = 0; i < CColumnCount; ++i)
 	{
-		ui->celestialPositionsTreeWidget->resizeColumnToContents(i);
+		ui->celestialPositionsTreeView->resizeColumnToContents(i);
 	}
 }
 
 void AstroCalcDialog::onChangedEphemerisPosition(const QModelIndex& modelIndex)
 {
-	DisplayedPositionIndex = modelIndex.row();
+	// Rows may have been sorted by another column than the date
+	DisplayedPositionIndex = ephemerisModel->getSequenceIndex(modelIndex.row());
 }
 
 void AstroCalcDialog::populateCelestialCategoryList()
@@ -670,17 +703,12 @@ void AstroCalcDialog::saveCelestialPositionsCategory(int index)
 
 void AstroCalcDialog::currentCelestialPositions()
 {
-	float ra, dec;
-	QString raStr, decStr, extra, angularSize, sTransit, celObjName = "", celObjId = "";
-
 	initListCelestialPositions();
 
-	double mag = ui->celestialMagnitudeDoubleSpinBox->value();
+	float mag = ui->celestialMagnitudeDoubleSpinBox->value();
 	bool horizon = ui->horizontalCoordinatesCheckBox->isChecked();
 	bool useSouthAzimuth = StelApp::getInstance().getFlagSouthAzimuthUsage();
-	bool withDecimalDegree = StelApp::getInstance().getFlagShowDecimalDegrees();
 
-	StelCore* core = StelApp::getInstance().getCore();
 	double JD = core->getJD();
 	ui->celestialPositionsTimeLabel->setText(q_("Positions on %1").arg(QString("%1 %2").arg(localeMgr->getPrintableDateLocal(JD), localeMgr->getPrintableTimeLocal(JD))));
 
@@ -689,8 +717,17 @@ void AstroCalcDialog::currentCelestialPositions()
 	QString celType = category->itemData(category->currentIndex()).toString();
 	int celTypeId = celType.toInt();
 
+	AstroCalcPositionsModel::Format format;
+	format.horizontal = horizon;
+	format.decimalDegrees = StelApp::getInstance().getFlagShowDecimalDegrees();
+
+	// The positions of all the candidates are computed in one pass, and rows are made only for the objects found.
+	PositionsQuery query(core);
+	QVector<float> starValues;
+	QString sType;
 	if (celTypeId < 170)
 	{
+		// Deep-sky objects
 		QString mu;
 		if (dsoMgr->getFlagSurfaceBrightnessShortNotationUsage())
 		{
@@ -704,538 +741,163 @@ void AstroCalcDialog::currentCelestialPositions()
 			if (dsoMgr->getFlagSurfaceBrightnessArcsecUsage())
 				mu = QString("%1/%2<sup>2</sup>").arg(qc_("mag", "magnitude"), q_("arcsec"));
 		}
-		float magOp;
-		QString dsoName;
-		QString asToolTip = QString("%1, %2").arg(q_("Average angular size"), q_("arcmin"));
-		// Deep-sky objects
+		format.extraToolTip = mu;
+		format.angularSizeToolTip = QString("%1, %2").arg(q_("Average angular size"), q_("arcmin"));
+
+		bool darkNebulae = (celTypeId == 12 || celTypeId == 102 || celTypeId == 111);
 		QList<NebulaP> celestialObjects = dsoMgr->getDeepSkyObjectsByType(celType);
+		query.reserve(celestialObjects.size());
 		for (const auto& obj : celestialObjects)
 		{
-			if (celTypeId == 12 || celTypeId == 102 || celTypeId == 111) // opacity cannot be extincted
-				magOp = obj->getVMagnitude(core);
-			else
-				magOp = obj->getVMagnitudeWithExtinction(core);
-
-			if (obj->objectInDisplayedCatalog() && obj->objectInAllowedSizeRangeLimits() && magOp <= mag && obj->isAboveRealHorizon(core))
-			{
-				if (horizon)
-				{
-					StelUtils::rectToSphe(&ra, &dec, obj->getAltAzPosAuto(core));
-					float direction = 3.; // N is zero, E is 90 degrees
-					if (useSouthAzimuth)
-						direction = 2.;
-					ra = direction * M_PI - ra;
-					if (ra > M_PI * 2)
-						ra -= M_PI * 2;
-					if (withDecimalDegree)
-					{
-						raStr = StelUtils::radToDecDegStr(ra, 5, false, true);
-						decStr = StelUtils::radToDecDegStr(dec, 5, false, true);
-					}
-					else
-					{
-						raStr = StelUtils::radToDmsStr(ra, true);
-						decStr = StelUtils::radToDmsStr(dec, true);
-					}
-				}
-				else
-				{
-					StelUtils::rectToSphe(&ra, &dec, obj->getJ2000EquatorialPos(core));
-					if (withDecimalDegree)
-					{
-						raStr = StelUtils::radToDecDegStr(ra, 5, false, true);
-						decStr = StelUtils::radToDecDegStr(dec, 5, false, true);
-					}
-					else
-					{
-						raStr = StelUtils::radToHmsStr(ra);
-						decStr = StelUtils::radToDmsStr(dec, true);
-					}
-				}
-
-				ACCelPosTreeWidgetItem* treeItem =
-				  new ACCelPosTreeWidgetItem(ui->celestialPositionsTreeWidget);
-
-				celObjName = obj->getNameI18n();
-				celObjId = obj->getDSODesignation();
-				if (celObjId.isEmpty())
-					dsoName = celObjName;
-				else if (celObjName.isEmpty())
-					dsoName = celObjId;
-				else
-					dsoName = QString("%1 (%2)").arg(celObjId, celObjName);
-
-				extra = QString::number(obj->getSurfaceBrightnessWithExtinction(core), 'f', 2);
-				if (extra.toFloat() > 90.f)
-					extra = QChar(0x2014);
-
-				// Convert to arcminutes the average angular size of deep-sky object
-				angularSize = QString::number(obj->getAngularSize(core) * 120.f, 'f', 3);
-				if (angularSize.toFloat() < 0.01f)
-					angularSize = QChar(0x2014);
-
-				sTransit = QChar(0x2014);
-				Vec3f rts = obj->getRTSTime(core);
-				if (rts[1]>=0.f)
-					sTransit = StelUtils::hoursToHmsStr(rts[1], true);
-
-				treeItem->setText(CColumnName, dsoName);
-				treeItem->setText(CColumnRA, raStr);
-				treeItem->setTextAlignment(CColumnRA, Qt::AlignRight);
-				treeItem->setText(CColumnDec, decStr);
-				treeItem->setTextAlignment(CColumnDec, Qt::AlignRight);
-				treeItem->setText(CColumnMagnitude, QString::number(magOp, 'f', 2));
-				treeItem->setTextAlignment(CColumnMagnitude, Qt::AlignRight);
-				treeItem->setText(CColumnAngularSize, angularSize);
-				treeItem->setTextAlignment(CColumnAngularSize, Qt::AlignRight);
-				treeItem->setToolTip(CColumnAngularSize, asToolTip);
-				treeItem->setText(CColumnExtra, extra);
-				treeItem->setTextAlignment(CColumnExtra, Qt::AlignRight);
-				treeItem->setToolTip(CColumnExtra, mu);
-				treeItem->setText(CColumnTransit, sTransit);
-				treeItem->setTextAlignment(CColumnTransit, Qt::AlignRight);
-				treeItem->setText(CColumnType, q_(obj->getTypeString()));
-			}
-		}
-	}
-	else if (celTypeId == 200)
-	{
-		QList<PlanetP> allPlanets = solarSystem->getAllPlanets();
-		QString distanceInfo = q_("Planetocentric distance");
-		if (core->getUseTopocentricCoordinates()) distanceInfo = q_("Topocentric distance");
-		QString distanceUM = qc_("AU", "distance, astronomical unit");
-		QString sToolTip = QString("%1, %2").arg(distanceInfo, distanceUM);
-		QString asToolTip = QString("%1, %2").arg(q_("Angular size (with rings, if any)"), q_("arcmin"));
-		Vec3d pos;
-		for (const auto& planet : allPlanets)
-		{
-			if ((planet->getPlanetType() != Planet::isUNDEFINED && planet != core->getCurrentPlanet()) && planet->getVMagnitudeWithExtinction(core) <= mag && planet->isAboveRealHorizon(core))
-			{
-				pos = planet->getJ2000EquatorialPos(core);
-				if (horizon)
-				{
-					StelUtils::rectToSphe(&ra, &dec, planet->getAltAzPosAuto(core));
-					float direction = 3.; // N is zero, E is 90 degrees
-					if (useSouthAzimuth)
-						direction = 2.;
-					ra = direction * M_PI - ra;
-					if (ra > M_PI * 2)
-						ra -= M_PI * 2;
-					if (withDecimalDegree)
-					{
-						raStr = StelUtils::radToDecDegStr(ra, 5, false, true);
-						decStr = StelUtils::radToDecDegStr(dec, 5, false, true);
-					}
-					else
-					{
-						raStr = StelUtils::radToDmsStr(ra, true);
-						decStr = StelUtils::radToDmsStr(dec, true);
-					}
-				}
-				else
-				{
-					StelUtils::rectToSphe(&ra, &dec, pos);
-					if (withDecimalDegree)
-					{
-						raStr = StelUtils::radToDecDegStr(ra, 5, false, true);
-						decStr = StelUtils::radToDecDegStr(dec, 5, false, true);
-					}
-					else
-					{
-						raStr = StelUtils::radToHmsStr(ra);
-						decStr = StelUtils::radToDmsStr(dec, true);
-					}
-				}
-
-				extra = QString::number(pos.length(), 'f', 5); // A.U.
-
-				// Convert to arcseconds the angular size of Solar system object (with rings, if any)
-				angularSize = QString::number(planet->getAngularSize(core) * 120.f, 'f', 4);
-				if (angularSize.toFloat() < 1e-4 || planet->getPlanetType() == Planet::isComet)
-					angularSize = QChar(0x2014);
-
-				sTransit = QChar(0x2014);
-				Vec3f rts = planet->getRTSTime(core);
-				if (rts[1]>=0.f)
-					sTransit = StelUtils::hoursToHmsStr(rts[1], true);
-
-				ACCelPosTreeWidgetItem* treeItem = new ACCelPosTreeWidgetItem(ui->celestialPositionsTreeWidget);
-				treeItem->setText(CColumnName, planet->getNameI18n());
-				treeItem->setText(CColumnRA, raStr);
-				treeItem->setTextAlignment(CColumnRA, Qt::AlignRight);
-				treeItem->setText(CColumnDec, decStr);
-				treeItem->setTextAlignment(CColumnDec, Qt::AlignRight);
-				treeItem->setText(CColumnMagnitude, QString::number(planet->getVMagnitudeWithExtinction(core), 'f', 2));
-				treeItem->setTextAlignment(CColumnMagnitude, Qt::AlignRight);
-				treeItem->setText(CColumnAngularSize, angularSize);
-				treeItem->setTextAlignment(CColumnAngularSize, Qt::AlignRight);
-				treeItem->setToolTip(CColumnAngularSize, asToolTip);
-				treeItem->setText(CColumnExtra, extra);
-				treeItem->setTextAlignment(CColumnExtra, Qt::AlignRight);
-				treeItem->setToolTip(CColumnExtra, sToolTip);
-				treeItem->setText(CColumnTransit, sTransit);
-				treeItem->setTextAlignment(CColumnTransit, Qt::AlignRight);
-				treeItem->setText(CColumnType, q_(planet->getPlanetTypeString()));
-			}
-		}
-	}
-	else if (celTypeId == 201)
-	{
-		QList<PlanetP> allMinorBodies = solarSystem->getAllMinorBodies();
-		QString distanceInfo = q_("Planetocentric distance");
-		if (core->getUseTopocentricCoordinates()) distanceInfo = q_("Topocentric distance");
-		QString distanceUM = qc_("AU", "distance, astronomical unit");
-		QString sToolTip = QString("%1, %2").arg(distanceInfo, distanceUM);
-		QString asToolTip = QString("%1, %2").arg(q_("Angular size (with rings, if any)"), q_("arcmin"));
-		Vec3d pos;
-		for (const auto& planet : allMinorBodies)
-		{
-			if ((planet->getPlanetType() == Planet::isComet && planet != core->getCurrentPlanet()) && planet->getVMagnitudeWithExtinction(core) <= mag && planet->isAboveRealHorizon(core))
-			{
-				pos = planet->getJ2000EquatorialPos(core);
-				if (horizon)
-				{
-					StelUtils::rectToSphe(&ra, &dec, planet->getAltAzPosAuto(core));
-					float direction = 3.; // N is zero, E is 90 degrees
-					if (useSouthAzimuth)
-						direction = 2.;
-					ra = direction * M_PI - ra;
-					if (ra > M_PI * 2)
-						ra -= M_PI * 2;
-					if (withDecimalDegree)
-					{
-						raStr = StelUtils::radToDecDegStr(ra, 5, false, true);
-						decStr = StelUtils::radToDecDegStr(dec, 5, false, true);
-					}
-					else
-					{
-						raStr = StelUtils::radToDmsStr(ra, true);
-						decStr = StelUtils::radToDmsStr(dec, true);
-					}
-				}
-				else
-				{
-					StelUtils::rectToSphe(&ra, &dec, pos);
-					if (withDecimalDegree)
-					{
-						raStr = StelUtils::radToDecDegStr(ra, 5, false, true);
-						decStr = StelUtils::radToDecDegStr(dec, 5, false, true);
-					}
-					else
-					{
-						raStr = StelUtils::radToHmsStr(ra);
-						decStr = StelUtils::radToDmsStr(dec, true);
-					}
-				}
-
-				extra = QString::number(pos.length(), 'f', 5); // A.U.
-
-				sTransit = QChar(0x2014);
-				Vec3f rts = planet->getRTSTime(core);
-				if (rts[1]>=0.f)
-					sTransit = StelUtils::hoursToHmsStr(rts[1], true);
-
-				ACCelPosTreeWidgetItem* treeItem = new ACCelPosTreeWidgetItem(ui->celestialPositionsTreeWidget);
-				treeItem->setText(CColumnName, planet->getNameI18n());
-				treeItem->setText(CColumnRA, raStr);
-				treeItem->setTextAlignment(CColumnRA, Qt::AlignRight);
-				treeItem->setText(CColumnDec, decStr);
-				treeItem->setTextAlignment(CColumnDec, Qt::AlignRight);
-				treeItem->setText(CColumnMagnitude, QString::number(planet->getVMagnitudeWithExtinction(core), 'f', 2));
-				treeItem->setTextAlignment(CColumnMagnitude, Qt::AlignRight);
-				treeItem->setText(CColumnAngularSize, QChar(0x2014));
-				treeItem->setTextAlignment(CColumnAngularSize, Qt::AlignRight);
-				treeItem->setToolTip(CColumnAngularSize, asToolTip);
-				treeItem->setText(CColumnExtra, extra);
-				treeItem->setTextAlignment(CColumnExtra, Qt::AlignRight);
-				treeItem->setToolTip(CColumnExtra, sToolTip);
-				treeItem->setText(CColumnTransit, sTransit);
-				treeItem->setTextAlignment(CColumnTransit, Qt::AlignRight);
-				treeItem->setText(CColumnType, q_(planet->getPlanetTypeString()));
-			}
-		}
-	}
-	else if (celTypeId == 202)
-	{
-		QList<PlanetP> allMinorBodies = solarSystem->getAllMinorBodies();
-		QString distanceInfo = q_("Planetocentric distance");
-		if (core->getUseTopocentricCoordinates()) distanceInfo = q_("Topocentric distance");
-		QString distanceUM = qc_("AU", "distance, astronomical unit");
-		QString sToolTip = QString("%1, %2").arg(distanceInfo, distanceUM);
-		QString asToolTip = QString("%1, %2").arg(q_("Angular size (with rings, if any)"), q_("arcmin"));
-		Vec3d pos;
-		for (const auto& planet : allMinorBodies)
-		{
-			Planet::PlanetType ptype = planet->getPlanetType();
-			if (((ptype == Planet::isAsteroid || ptype == Planet::isCubewano || ptype == Planet::isDwarfPlanet || ptype == Planet::isOCO || ptype == Planet::isPlutino || ptype == Planet::isSDO || ptype == Planet::isSednoid) && planet != core->getCurrentPlanet())
-			      && planet->getVMagnitudeWithExtinction(core) <= mag && planet->isAboveRealHorizon(core))
-			{
-				pos = planet->getJ2000EquatorialPos(core);
-				if (horizon)
-				{
-					StelUtils::rectToSphe(&ra, &dec, planet->getAltAzPosAuto(core));
-					float direction = 3.; // N is zero, E is 90 degrees
-					if (useSouthAzimuth)
-						direction = 2.;
-					ra = direction * M_PI - ra;
-					if (ra > M_PI * 2)
-						ra -= M_PI * 2;
-					if (withDecimalDegree)
-					{
-						raStr = StelUtils::radToDecDegStr(ra, 5, false, true);
-						decStr = StelUtils::radToDecDegStr(dec, 5, false, true);
-					}
-					else
-					{
-						raStr = StelUtils::radToDmsStr(ra, true);
-						decStr = StelUtils::radToDmsStr(dec, true);
-					}
-				}
-				else
-				{
-					StelUtils::rectToSphe(&ra, &dec, pos);
-					if (withDecimalDegree)
-					{
-						raStr = StelUtils::radToDecDegStr(ra, 5, false, true);
-						decStr = StelUtils::radToDecDegStr(dec, 5, false, true);
-					}
-					else
-					{
-						raStr = StelUtils::radToHmsStr(ra);
-						decStr = StelUtils::radToDmsStr(dec, true);
-					}
-				}
-
-				extra = QString::number(pos.length(), 'f', 5); // A.U.
-
-				// Convert to arcseconds the angular size of Solar system object (with rings, if any)
-				angularSize = QString::number(planet->getAngularSize(core) * 120.f, 'f', 4);
-				if (angularSize.toFloat() < 1e-4)
-					angularSize = QChar(0x2014);
-
-				sTransit = QChar(0x2014);
-				Vec3f rts = planet->getRTSTime(core);
-				if (rts[1]>=0.f)
-					sTransit = StelUtils::hoursToHmsStr(rts[1], true);
-
-				ACCelPosTreeWidgetItem* treeItem = new ACCelPosTreeWidgetItem(ui->celestialPositionsTreeWidget);
-				treeItem->setText(CColumnName, planet->getNameI18n());
-				treeItem->setText(CColumnRA, raStr);
-				treeItem->setTextAlignment(CColumnRA, Qt::AlignRight);
-				treeItem->setText(CColumnDec, decStr);
-				treeItem->setTextAlignment(CColumnDec, Qt::AlignRight);
-				treeItem->setText(CColumnMagnitude, QString::number(planet->getVMagnitudeWithExtinction(core), 'f', 2));
-				treeItem->setTextAlignment(CColumnMagnitude, Qt::AlignRight);
-				treeItem->setText(CColumnAngularSize, angularSize);
-				treeItem->setTextAlignment(CColumnAngularSize, Qt::AlignRight);
-				treeItem->setToolTip(CColumnAngularSize, asToolTip);
-				treeItem->setText(CColumnExtra, extra);
-				treeItem->setTextAlignment(CColumnExtra, Qt::AlignRight);
-				treeItem->setToolTip(CColumnExtra, sToolTip);
-				treeItem->setText(CColumnTransit, sTransit);
-				treeItem->setTextAlignment(CColumnTransit, Qt::AlignRight);
-				treeItem->setText(CColumnType, q_(planet->getPlanetTypeString()));
-			}
+			// opacity cannot be extincted
+			if (obj->objectInDisplayedCatalog() && obj->objectInAllowedSizeRangeLimits())
+				query.add(obj, obj->getVMagnitude(core), !darkNebulae);
 		}
 	}
-	else if (celTypeId == 203)
+	else if (celTypeId >= 200)
 	{
-		QList<PlanetP> allPlanets = solarSystem->getAllPlanets();
+		// Solar system objects
 		QString distanceInfo = q_("Planetocentric distance");
 		if (core->getUseTopocentricCoordinates())
 			distanceInfo = q_("Topocentric distance");
-		QString distanceUM = qc_("AU", "distance, astronomical unit");
-		QString sToolTip = QString("%1, %2").arg(distanceInfo, distanceUM);
-		QString asToolTip = QString("%1, %2").arg(q_("Angular size (with rings, if any)"), q_("arcmin"));
-		Vec3d pos;
-		for (const auto& planet : allPlanets)
+		format.extraToolTip = QString("%1, %2").arg(distanceInfo, qc_("AU", "distance, astronomical unit"));
+		format.angularSizeToolTip = QString("%1, %2").arg(q_("Angular size (with rings, if any)"), q_("arcmin"));
+		format.angularSizePrecision = 4;
+		format.extraPrecision = 5;
+
+		QList<PlanetP> bodies = (celTypeId == 201 || celTypeId == 202) ? solarSystem->getAllMinorBodies() : solarSystem->getAllPlanets();
+		for (const auto& planet : bodies)
 		{
-			if ((planet->getPlanetType() == Planet::isPlanet && planet != core->getCurrentPlanet()) && planet->getVMagnitudeWithExtinction(core) <= mag && planet->isAboveRealHorizon(core))
-			{
-				pos = planet->getJ2000EquatorialPos(core);
-				if (horizon)
-				{
-					StelUtils::rectToSphe(&ra, &dec, planet->getAltAzPosAuto(core));
-					float direction = 3.; // N is zero, E is 90 degrees
-					if (useSouthAzimuth)
-						direction = 2.;
-					ra = direction * M_PI - ra;
-					if (ra > M_PI * 2)
-						ra -= M_PI * 2;
-					if (withDecimalDegree)
-					{
-						raStr = StelUtils::radToDecDegStr(ra, 5, false, true);
-						decStr = StelUtils::radToDecDegStr(dec, 5, false, true);
-					}
-					else
-					{
-						raStr = StelUtils::radToDmsStr(ra, true);
-						decStr = StelUtils::radToDmsStr(dec, true);
-					}
-				}
-				else
-				{
-					StelUtils::rectToSphe(&ra, &dec, pos);
-					if (withDecimalDegree)
-					{
-						raStr = StelUtils::radToDecDegStr(ra, 5, false, true);
-						decStr = StelUtils::radToDecDegStr(dec, 5, false, true);
-					}
-					else
-					{
-						raStr = StelUtils::radToHmsStr(ra);
-						decStr = StelUtils::radToDmsStr(dec, true);
-					}
-				}
+			if (planet == core->getCurrentPlanet())
+				continue;
 
-				extra = QString::number(pos.length(), 'f', 5); // A.U.
-
-				// Convert to arcseconds the angular size of Solar system object (with rings, if any)
-				angularSize = QString::number(planet->getAngularSize(core) * 120.f, 'f', 4);
-				if (angularSize.toFloat() < 1e-4)
-					angularSize = QChar(0x2014);
-
-				sTransit = QChar(0x2014);
-				Vec3f rts = planet->getRTSTime(core);
-				if (rts[1]>=0.f)
-					sTransit = StelUtils::hoursToHmsStr(rts[1], true);
-
-				ACCelPosTreeWidgetItem* treeItem = new ACCelPosTreeWidgetItem(ui->celestialPositionsTreeWidget);
-				treeItem->setText(CColumnName, planet->getNameI18n());
-				treeItem->setText(CColumnRA, raStr);
-				treeItem->setTextAlignment(CColumnRA, Qt::AlignRight);
-				treeItem->setText(CColumnDec, decStr);
-				treeItem->setTextAlignment(CColumnDec, Qt::AlignRight);
-				treeItem->setText(CColumnMagnitude, QString::number(planet->getVMagnitudeWithExtinction(core), 'f', 2));
-				treeItem->setTextAlignment(CColumnMagnitude, Qt::AlignRight);
-				treeItem->setText(CColumnAngularSize, angularSize);
-				treeItem->setTextAlignment(CColumnAngularSize, Qt::AlignRight);
-				treeItem->setToolTip(CColumnAngularSize, asToolTip);
-				treeItem->setText(CColumnExtra, extra);
-				treeItem->setTextAlignment(CColumnExtra, Qt::AlignRight);
-				treeItem->setToolTip(CColumnExtra, sToolTip);
-				treeItem->setText(CColumnTransit, sTransit);
-				treeItem->setTextAlignment(CColumnTransit, Qt::AlignRight);
-				treeItem->setText(CColumnType, q_(planet->getPlanetTypeString()));
-			}
+			Planet::PlanetType ptype = planet->getPlanetType();
+			bool match;
+			if (celTypeId == 201)
+				match = (ptype == Planet::isComet);
+			else if (celTypeId == 202)
+				match = (ptype == Planet::isAsteroid || ptype == Planet::isCubewano || ptype == Planet::isDwarfPlanet || ptype == Planet::isOCO || ptype == Planet::isPlutino || ptype == Planet::isSDO || ptype == Planet::isSednoid);
+			else if (celTypeId == 203)
+				match = (ptype == Planet::isPlanet);
+			else
+				match = (ptype != Planet::isUNDEFINED);
+			if (match)
+				query.add(planet, planet->getVMagnitude(core));
 		}
 	}
 	else
 	{
 		// stars
-		QString sType = q_("star");
-		QString sToolTip = "";
-		float wdsSep;
 		QList<StelACStarData> celestialObjects;
 		if (celTypeId == 170)
 		{
 			// double stars
 			celestialObjects = starMgr->getHipparcosDoubleStars();
 			sType = q_("double star");
+			format.extraPrecision = 3; // arcseconds
+			format.extraSeparation = true;
 		}
 		else if (celTypeId == 171)
 		{
 			// variable stars
 			celestialObjects = starMgr->getHipparcosVariableStars();
 			sType = q_("variable star");
+			format.extraPrecision = 5; // days
 		}
 		else
 		{
 			// stars with high proper motion
 			celestialObjects = starMgr->getHipparcosHighPMStars();
 			sType = q_("star with high proper motion");
+			format.extraPrecision = 5; // "/yr
 		}
 
+		query.reserve(celestialObjects.size());
+		starValues.reserve(celestialObjects.size());
 		for (const auto& star : celestialObjects)
 		{
 			StelObjectP obj = star.firstKey();
-			if (obj->getVMagnitudeWithExtinction(core) <= mag && obj->isAboveRealHorizon(core))
-			{
-				if (horizon)
-				{
-					StelUtils::rectToSphe(&ra, &dec, obj->getAltAzPosAuto(core));
-					float direction = 3.; // N is zero, E is 90 degrees
-					if (useSouthAzimuth)
-						direction = 2.;
-					ra = direction * M_PI - ra;
-					if (ra > M_PI * 2)
-						ra -= M_PI * 2;
-					if (withDecimalDegree)
-					{
-						raStr = StelUtils::radToDecDegStr(ra, 5, false, true);
-						decStr = StelUtils::radToDecDegStr(dec, 5, false, true);
-					}
-					else
-					{
-						raStr = StelUtils::radToDmsStr(ra, true);
-						decStr = StelUtils::radToDmsStr(dec, true);
-					}
-				}
-				else
-				{
-					StelUtils::rectToSphe(&ra, &dec, obj->getJ2000EquatorialPos(core));
-					if (withDecimalDegree)
-					{
-						raStr = StelUtils::radToDecDegStr(ra, 5, false, true);
-						decStr = StelUtils::radToDecDegStr(dec, 5, false, true);
-					}
-					else
-					{
-						raStr = StelUtils::radToHmsStr(ra);
-						decStr = StelUtils::radToDmsStr(dec, true);
-					}
-				}
+			query.add(obj, obj->getVMagnitude(core));
+			starValues.append(star.first());
+		}
+	}
 
-				if (celTypeId == 170) // double stars
-				{
-					wdsSep = star.value(obj);
-					extra = QString::number(wdsSep, 'f', 3); // arcseconds
-					sToolTip = StelUtils::decDegToDmsStr(wdsSep / 3600.f);
-				}
-				else if (celTypeId == 171) // variable stars
-				{
-					if (star.value(obj) > 0.f)
-						extra = QString::number(star.value(obj), 'f', 5); // days
-					else
-						extra = QChar(0x2014); // dash
-				}
-				else												  // stars with high proper motion
-					extra = QString::number(star.value(obj), 'f', 5); // "/yr
-
-				sTransit = QChar(0x2014);
-				Vec3f rts = obj->getRTSTime(core);
-				if (rts[1]>=0.f)
-					sTransit = StelUtils::hoursToHmsStr(rts[1], true);
-
-				ACCelPosTreeWidgetItem* treeItem = new ACCelPosTreeWidgetItem(ui->celestialPositionsTreeWidget);
-				treeItem->setText(CColumnName, obj->getNameI18n());
-				treeItem->setText(CColumnRA, raStr);
-				treeItem->setTextAlignment(CColumnRA, Qt::AlignRight);
-				treeItem->setText(CColumnDec, decStr);
-				treeItem->setTextAlignment(CColumnDec, Qt::AlignRight);
-				treeItem->setText(CColumnMagnitude, QString::number(obj->getVMagnitudeWithExtinction(core), 'f', 2));
-				treeItem->setTextAlignment(CColumnMagnitude, Qt::AlignRight);
-				treeItem->setText(CColumnAngularSize, QChar(0x2014)); // No angular size of stars!
-				treeItem->setToolTip(CColumnAngularSize, "");
-				treeItem->setTextAlignment(CColumnAngularSize, Qt::AlignRight);
-				treeItem->setText(CColumnExtra, extra);
-				treeItem->setTextAlignment(CColumnExtra, Qt::AlignRight);
-				treeItem->setToolTip(CColumnExtra, sToolTip);
-				treeItem->setText(CColumnTransit, sTransit);
-				treeItem->setTextAlignment(CColumnTransit, Qt::AlignRight);
-				treeItem->setText(CColumnType, sType);
-			}
+	query.run(mag);
+
+	const double direction = useSouthAzimuth ? 2. : 3.; // N is zero, E is 90 degrees
+	QVector<AstroCalcPositionsModel::Row> rows;
+	rows.reserve(query.getResults().size());
+	for (int i : query.getResults())
+	{
+		AstroCalcPositionsModel::Row row;
+		row.object = query.getObject(i);
+		if (horizon)
+		{
+			StelUtils::rectToSphe(&row.longitude, &row.latitude, query.getAltAzPos(i));
+			row.longitude = direction * M_PI - row.longitude;
+			if (row.longitude > M_PI * 2)
+				row.longitude -= M_PI * 2;
+		}
+		else
+			StelUtils::rectToSphe(&row.longitude, &row.latitude, query.getJ2000Pos(i));
+		row.magnitude = query.getMagnitude(i);
+		row.angularSize = NAN;
+		row.extra = NAN;
+
+		if (celTypeId < 170)
+		{
+			const Nebula* obj = static_cast<const Nebula*>(row.object.data());
+			QString celObjName = obj->getNameI18n();
+			QString celObjId = obj->getDSODesignation();
+			if (celObjId.isEmpty())
+				row.name = celObjName;
+			else if (celObjName.isEmpty())
+				row.name = celObjId;
+			else
+				row.name = QString("%1 (%2)").arg(celObjId, celObjName);
+
+			float sb = obj->getSurfaceBrightnessWithExtinction(core);
+			if (sb <= 90.f)
+				row.extra = sb;
+
+			// Convert to arcminutes the average angular size of deep-sky object
+			float angularSize = obj->getAngularSize(core) * 120.f;
+			if (angularSize >= 0.01f)
+				row.angularSize = angularSize;
+			row.type = q_(obj->getTypeString());
+		}
+		else if (celTypeId >= 200)
+		{
+			const Planet* planet = static_cast<const Planet*>(row.object.data());
+			row.name = planet->getNameI18n();
+			row.extra = query.getJ2000Pos(i).length(); // A.U.
+
+			// Convert to arcminutes the angular size of Solar system object (with rings, if any)
+			float angularSize = planet->getAngularSize(core) * 120.f;
+			if (angularSize >= 1e-4 && planet->getPlanetType() != Planet::isComet)
+				row.angularSize = angularSize;
+			row.type = q_(planet->getPlanetTypeString());
+		}
+		else
+		{
+			row.name = row.object->getNameI18n();
+			float value = starValues.at(i);
+			if (celTypeId != 171 || value > 0.f)
+				row.extra = value;
+			row.type = sType;
 		}
+		rows.append(row);
 	}
+	positionsModel->setRows(rows, format, JD);
 
 	// adjust the column width
 	for (int i = 0; i < CColumnCount; ++i)
 	{
-		ui->celestialPositionsTreeWidget->resizeColumnToContents(i);
+		ui->celestialPositionsTreeView->resizeColumnToContents(i);
 	}
 
 	// sort-by-name
-	ui->celestialPositionsTreeWidget->sortItems(CColumnName, Qt::AscendingOrder);
+	ui->celestialPositionsTreeView->sortByColumn(CColumnName, Qt::AscendingOrder);
 }
 
 void AstroCalcDialog::saveCelestialPositions()
@@ -1256,58 +918,15 @@ void AstroCalcDialog::saveCelestialPositions()
 	QTextStream celPosList(&celPos);
 	celPosList.setCodec("UTF-8");
 
-	int count = ui->celestialPositionsTreeWidget->topLevelItemCount();
-	int columns = positionsHeader.size();
-
-	for (int i = 0; i < columns; i++)
-	{
-		QString h = positionsHeader.at(i).trimmed();
-		if (h.contains(","))
-			celPosList << QString("\"%1\"").arg(h);
-		else
-			celPosList << h;
-
-		if (i < columns - 1)
-			celPosList << delimiter;
-		else
-			celPosList << acEndl;
-	}
-
-	for (int i = 0; i < count; i++)
-	{
-		for (int j = 0; j < columns; j++)
-		{
-			celPosList << ui->celestialPositionsTreeWidget->topLevelItem(i)->text(j);
-			if (j < columns - 1)
-				celPosList << delimiter;
-			else
-				celPosList << acEndl;
-		}
-	}
+	positionsModel->writeCsv(celPosList, delimiter, acEndl);
 
 	celPos.close();
 }
 
 void AstroCalcDialog::selectCurrentCelestialPosition(const QModelIndex& modelIndex)
 {
-	// Find the object
-	QString nameI18n = modelIndex.sibling(modelIndex.row(), CColumnName).data().toString();
-
-	bool founded = false;
-
-	if (objectMgr->findAndSelectI18n(nameI18n) || objectMgr->findAndSelect(nameI18n))
-		founded = true;
-	else
-	{
-		QStringList list = nameI18n.split("(");
-		if (list.count() > 0 && nameI18n.lastIndexOf("(") != 0 && nameI18n.lastIndexOf("/") < 0)
-			nameI18n = list.at(0).trimmed();
-
-		if (objectMgr->findAndSelectI18n(nameI18n) || objectMgr->findAndSelect(nameI18n))
-			founded = true;
-	}
-
-	if (founded)
+	StelObjectP obj = positionsModel->getObject(modelIndex.row());
+	if (obj && objectMgr->setSelectedObject(obj))
 	{
 		const QList<StelObjectP> newSelected = objectMgr->getSelectedObject();
 		if (!newSelected.empty())
@@ -1315,14 +934,14 @@ void AstroCalcDialog::selectCurrentCelestialPosition(const QModelIndex& modelInd
 			mvMgr->moveToObject(newSelected[0], mvMgr->getAutoMoveDuration());
 			mvMgr->setFlagTracking(true);
 		}
-	}	
+	}
 }
 
 void AstroCalcDialog::selectCurrentEphemeride(const QModelIndex& modelIndex)
 {
 	// Find the object
 	QString name = ui->celestialBodyComboBox->currentData().toString();
-	double JD = modelIndex.sibling(modelIndex.row(), EphemerisJD).data().toDouble();
+	double JD = ephemerisModel->getJD(modelIndex.row());
 
 	if (objectMgr->findAndSelectI18n(name) || objectMgr->findAndSelect(name))
 	{
@@ -1373,22 +992,21 @@ void AstroCalcDialog::setEphemerisHeaderNames()
 	ephemerisHeader << QString("%1, %2").arg(q_("dist."), qc_("AU", "distance, astronomical unit"));
 	// TRANSLATORS: elongation
 	ephemerisHeader << q_("elong.");
-	ui->ephemerisTreeWidget->setHeaderLabels(ephemerisHeader);
+	ephemerisModel->setHeaderLabels(ephemerisHeader);
 
 	// adjust the column width
 	for (int i = 0; i < EphemerisCount; ++i)
 	{
-		ui->ephemerisTreeWidget->resizeColumnToContents(i);
+		ui->ephemerisTreeView->resizeColumnToContents(i);
 	}	
 }
 
 void AstroCalcDialog::initListEphemeris()
 {
-	ui->ephemerisTreeWidget->clear();
-	ui->ephemerisTreeWidget->setColumnCount(EphemerisCount);
+	ephemerisModel->clear();
 	setEphemerisHeaderNames();
-	ui->ephemerisTreeWidget->header()->setSectionsMovable(false);
-	ui->ephemerisTreeWidget->header()->setDefaultAlignment(Qt::AlignHCenter);
+	ui->ephemerisTreeView->header()->setSectionsMovable(false);
+	ui->ephemerisTreeView->header()->setDefaultAlignment(Qt::AlignHCenter);
 }
 
 void AstroCalcDialog::reGenerateEphemeris()
@@ -1401,15 +1019,16 @@ void AstroCalcDialog::reGenerateEphemeris()
 
 void AstroCalcDialog::generateEphemeris()
 {
-	float currentStep, ra, dec;
-	Vec3d observerHelioPos;
+	// Restart with the current settings
+	stopEphemeris();
+
+	float currentStep;
 	QString currentPlanet = ui->celestialBodyComboBox->currentData().toString();
 	QString distanceInfo = q_("Planetocentric distance");
 	if (core->getUseTopocentricCoordinates())
 		distanceInfo = q_("Topocentric distance");
 	QString distanceUM = qc_("AU", "distance, astronomical unit");
 
-	QString elongStr = "", phaseStr = "";
 	bool horizon = ui->ephemerisHorizontalCoordinatesCheckBox->isChecked();
 	bool useSouthAzimuth = StelApp::getInstance().getFlagSouthAzimuthUsage();
 	bool withDecimalDegree = StelApp::getInstance().getFlagShowDecimalDegrees();
@@ -1542,7 +1161,6 @@ void AstroCalcDialog::generateEphemeris()
 	PlanetP obj = solarSystem->searchByEnglishName(currentPlanet);
 	if (obj)
 	{
-		double currentJD = core->getJD(); // save current JD
 		double firstJD = StelUtils::qDateTimeToJd(ui->dateFromDateTimeEdit->dateTime());
 		firstJD = firstJD - core->getUTCOffset(firstJD) / 24;
 		int elements = (int)((StelUtils::qDateTimeToJd(ui->dateToDateTimeEdit->dateTime()) - firstJD) / currentStep);
@@ -1552,114 +1170,100 @@ void AstroCalcDialog::generateEphemeris()
 		EphemerisListDates.reserve(elements);
 		EphemerisListMagnitudes.clear();
 		EphemerisListMagnitudes.reserve(elements);
-		bool withTime = false;
-		QString dash = QChar(0x2014); // dash
-		if (currentStep < StelCore::JD_DAY)
-			withTime = true;
-
-		if (obj == solarSystem->getSun())
-		{
-			phaseStr = dash;
-			elongStr = dash;
-		}
-
-		Vec3d pos;
-		QString raStr = "", decStr = "";
 
+		AstroCalcEphemerisModel::Format format;
+		format.horizontal = horizon;
+		format.useSouthAzimuth = useSouthAzimuth;
+		format.decimalDegrees = withDecimalDegree;
+		format.withPhase = (obj != solarSystem->getSun());
+		format.distanceToolTip = QString("%1, %2").arg(distanceInfo, distanceUM);
+		ephemerisModel->clear(format);
+		ephemerisWithTime = (currentStep < StelCore::JD_DAY);
+
+		QVector<double> dates;
+		dates.reserve(elements);
 		for (int i = 0; i < elements; i++)
-		{
-			double JD = firstJD + i * currentStep;
-			core->setJD(JD);
-			core->update(0); // force update to get new coordinates
+			dates.append(firstJD + i * currentStep);
+
+		// The positions are computed in background, without changing the time of the core.
+		ephemerisGenerator = new EphemerisGenerator(core, obj, dates, horizon);
+		ephemerisGenerator->start();
+		ephemerisProgress = StelApp::getInstance().addProgressBar();
+		ephemerisProgress->setFormat(q_("Ephemeris: %p%"));
+		ephemerisProgress->setRange(0, elements);
+		ephemerisProgress->setValue(0);
+		ui->ephemerisPushButton->setText(q_("Cancel"));
+		ephemerisTimer->start();
+	}
+}
 
-			if (horizon)
-			{
-				pos = obj->getAltAzPosAuto(core);
-				StelUtils::rectToSphe(&ra, &dec, pos);
-				float direction = 3.; // N is zero, E is 90 degrees
-				if (useSouthAzimuth)
-					direction = 2.;
-				ra = direction * M_PI - ra;
-				if (ra > M_PI * 2)
-					ra -= M_PI * 2;
-				if (withDecimalDegree)
-				{
-					raStr = StelUtils::radToDecDegStr(ra, 5, false, true);
-					decStr = StelUtils::radToDecDegStr(dec, 5, false, true);
-				}
-				else
-				{
-					raStr = StelUtils::radToDmsStr(ra, true);
-					decStr = StelUtils::radToDmsStr(dec, true);
-				}
-			}
-			else
-			{
-				pos = obj->getJ2000EquatorialPos(core);
-				StelUtils::rectToSphe(&ra, &dec, pos);
-				if (withDecimalDegree)
-				{
-					raStr = StelUtils::radToDecDegStr(ra, 5, false, true);
-					decStr = StelUtils::radToDecDegStr(dec, 5, false, true);
-				}
-				else
-				{
-					raStr = StelUtils::radToHmsStr(ra);
-					decStr = StelUtils::radToDmsStr(dec, true);
-				}
-			}
+void AstroCalcDialog::toggleEphemeris()
+{
+	if (ephemerisGenerator)
+		cancelEphemeris();
+	else
+		generateEphemeris();
+}
 
-			EphemerisListCoords.append(pos);
-			if (withTime)
-				EphemerisListDates.append(QString("%1 %2").arg(localeMgr->getPrintableDateLocal(JD), localeMgr->getPrintableTimeLocal(JD)));
-			else
-				EphemerisListDates.append(localeMgr->getPrintableDateLocal(JD));
-			EphemerisListMagnitudes.append(obj->getVMagnitudeWithExtinction(core));
-			StelUtils::rectToSphe(&ra, &dec, pos);
+void AstroCalcDialog::cancelEphemeris()
+{
+	if (!ephemerisGenerator)
+		return;
+	ephemerisGenerator->cancel();
+	addEphemerisRows(); // keep the rows computed so far
+	stopEphemeris();
+}
 
-			observerHelioPos = core->getObserverHeliocentricEclipticPos();
+void AstroCalcDialog::updateEphemeris()
+{
+	if (!ephemerisGenerator)
+		return;
 
-			if (phaseStr != dash)
-				phaseStr = QString("%1%").arg(QString::number(obj->getPhase(observerHelioPos) * 100, 'f', 2));
+	// Check before taking the rows, so that no row is lost when the job finishes in between.
+	const bool finished = ephemerisGenerator->isFinished();
+	addEphemerisRows();
+	if (finished)
+		stopEphemeris();
+	else
+		ephemerisProgress->setValue(ephemerisGenerator->getComputedRows());
+}
 
-			if (elongStr != dash)
-			{
-				if (withDecimalDegree)
-					elongStr = StelUtils::radToDecDegStr(obj->getElongation(observerHelioPos), 5, false, true);
-				else
-					elongStr = StelUtils::radToDmsStr(obj->getElongation(observerHelioPos), true);
-			}
+void AstroCalcDialog::stopEphemeris()
+{
+	if (!ephemerisGenerator)
+		return;
 
-			ACEphemTreeWidgetItem* treeItem = new ACEphemTreeWidgetItem(ui->ephemerisTreeWidget);
-			// local date and time
-			treeItem->setText(EphemerisDate,
-			  QString("%1 %2").arg(localeMgr->getPrintableDateLocal(JD), localeMgr->getPrintableTimeLocal(JD)));
-			treeItem->setText(EphemerisJD, QString::number(JD, 'f', 5));
-			treeItem->setText(EphemerisRA, raStr);
-			treeItem->setTextAlignment(EphemerisRA, Qt::AlignRight);
-			treeItem->setText(EphemerisDec, decStr);
-			treeItem->setTextAlignment(EphemerisDec, Qt::AlignRight);
-			treeItem->setText(EphemerisMagnitude, QString::number(obj->getVMagnitudeWithExtinction(core), 'f', 2));
-			treeItem->setTextAlignment(EphemerisMagnitude, Qt::AlignRight);
-			treeItem->setText(EphemerisPhase, phaseStr);
-			treeItem->setTextAlignment(EphemerisPhase, Qt::AlignRight);
-			treeItem->setText(EphemerisDistance, QString::number(obj->getJ2000EquatorialPos(core).length(), 'f', 6));
-			treeItem->setTextAlignment(EphemerisDistance, Qt::AlignRight);
-			treeItem->setToolTip(EphemerisDistance, QString("%1, %2").arg(distanceInfo, distanceUM));
-			treeItem->setText(EphemerisElongation, elongStr);
-			treeItem->setTextAlignment(EphemerisElongation, Qt::AlignRight);
-		}
-		core->setJD(currentJD); // restore time
-	}
+	ephemerisTimer->stop();
+	delete ephemerisGenerator;
+	ephemerisGenerator = Q_NULLPTR;
+	StelApp::getInstance().removeProgressBar(ephemerisProgress);
+	ephemerisProgress = Q_NULLPTR;
+	ui->ephemerisPushButton->setText(ephemerisButtonText);
 
 	// adjust the column width
 	for (int i = 0; i < EphemerisCount; ++i)
 	{
-		ui->ephemerisTreeWidget->resizeColumnToContents(i);
+		ui->ephemerisTreeView->resizeColumnToContents(i);
 	}
 
 	// sort-by-date
-	ui->ephemerisTreeWidget->sortItems(EphemerisDate, Qt::AscendingOrder);
+	ui->ephemerisTreeView->sortByColumn(EphemerisDate, Qt::AscendingOrder);
+}
+
+void AstroCalcDialog::addEphemerisRows()
+{
+	const QVector<EphemerisGenerator::Row> rows = ephemerisGenerator->takeRows();
+	for (const auto& row : rows)
+	{
+		const double JD = row.JD;
+		EphemerisListCoords.append(row.pos);
+		if (ephemerisWithTime)
+			EphemerisListDates.append(QString("%1 %2").arg(localeMgr->getPrintableDateLocal(JD), localeMgr->getPrintableTimeLocal(JD)));
+		else
+			EphemerisListDates.append(localeMgr->getPrintableDateLocal(JD));
+		EphemerisListMagnitudes.append(row.magnitude);
+	}
+	ephemerisModel->appendRows(rows);
 }
 
 void AstroCalcDialog::saveEphemeris()
@@ -1680,42 +1284,16 @@ void AstroCalcDialog::saveEphemeris()
 	QTextStream ephemList(&ephem);
 	ephemList.setCodec("UTF-8");
 
-	int count = ui->ephemerisTreeWidget->topLevelItemCount();
-	int columns = ephemerisHeader.size();
-
-	for (int i = 0; i < columns; i++)
-	{
-		QString h = ephemerisHeader.at(i).trimmed();
-		if (h.contains(","))
-			ephemList << QString("\"%1\"").arg(h);
-		else
-			ephemList << h;
-
-		if (i < columns - 1)
-			ephemList << delimiter;
-		else
-			ephemList << acEndl;
-	}
-
-	for (int i = 0; i < count; i++)
-	{
-		for (int j = 0; j < columns; j++)
-		{
-			ephemList << ui->ephemerisTreeWidget->topLevelItem(i)->text(j);
-			if (j < columns - 1)
-				ephemList << delimiter;
-			else
-				ephemList << acEndl;
-		}
-	}
+	ephemerisModel->writeCsv(ephemList, delimiter, acEndl);
 
 	ephem.close();
 }
 
 void AstroCalcDialog::cleanupEphemeris()
 {
+	stopEphemeris();
 	EphemerisListCoords.clear();
-	ui->ephemerisTreeWidget->clear();
+	ephemerisModel->clear();
 }
 
 void AstroCalcDialog::populateCelestialBodyList()
@@ -1961,6 +1539,7 @@ void AstroCalcDialog::populateGroupCelestialBodyList()
 	groups->addItem(q_("Symbiotic stars"), "18");
 	groups->addItem(q_("Emission-line stars"), "19");
 	groups->addItem(q_("Interstellar objects"), "20");
+	groups->addItem(q_("Lunar occultations of bright stars (<%1 mag) and eclipses").arg(QString::number(brightLimit - 5.0f, 'f', 1)), "21");
 
 	index = groups->findData(selectedGroupId, Qt::UserRole, Qt::MatchCaseSensitive);
 	if (index < 0)
@@ -1979,7 +1558,7 @@ void AstroCalcDialog::savePhenomenaCelestialGroup(int index)
 
 void AstroCalcDialog::cleanupPhenomena()
 {
-	ui->phenomenaTreeWidget->clear();
+	phenomenaModel->setRows(QVector<AstroCalcPhenomenaModel::Row>(), false);
 }
 
 void AstroCalcDialog::savePhenomenaOppositionFlag(bool b)
@@ -2015,7 +1594,7 @@ void AstroCalcDialog::drawAltVsTimeDiagram()
 
 		double currentJD = core->getJD();
 		double noon = (int)currentJD;
-		double az, alt, deg, ltime, JD;
+		double az, alt, deg, ltime;
 		bool sign;
 
 		double shift = core->getUTCOffset(currentJD) / 24.0;
@@ -2029,26 +1608,40 @@ void AstroCalcDialog::drawAltVsTimeDiagram()
 			step = 720;
 			isSatellite = true;
 		}
-		for (int i = -5; i <= limit; i++) // 24 hours + 15 minutes in both directions
+		// A new point on the graph every 3 minutes with shift to right 12 hours
+		// to get midnight at the center of diagram (i.e. accuracy is 3 minutes),
+		// 24 hours + 15 minutes in both directions
+		const int first = -5;
+		const double startJD = noon + (first * step + 43200) / 86400. - shift - 0.5;
+		QVector<double> altitudes;
+		if (timeline->canSample(selectedObject.data()))
+			altitudes = timeline->getValues(selectedObject, AstroCalcTimeline::Altitude, startJD, step / 86400., limit - first + 1);
+		else
 		{
-			// A new point on the graph every 3 minutes with shift to right 12 hours
-			// to get midnight at the center of diagram (i.e. accuracy is 3 minutes)
-			ltime = i * step + 43200;
-			aX.append(ltime);
-			JD = noon + ltime / 86400 - shift - 0.5;
-			core->setJD(JD);
-			if (isSatellite)
+			for (int i = first; i <= limit; i++)
 			{
+				core->setJD(startJD + (i - first) * step / 86400.);
+				if (isSatellite)
+				{
 #ifdef USE_STATIC_PLUGIN_SATELLITES
-				GETSTELMODULE(Satellites)->update(0.0); // force update to avoid caching! WTF???
+					GETSTELMODULE(Satellites)->update(0.0); // force update to avoid caching! WTF???
 #endif
+				}
+				else
+					core->update(0.0);
+				StelUtils::rectToSphe(&az, &alt, selectedObject->getAltAzPosAuto(core));
+				StelUtils::radToDecDeg(alt, sign, deg);
+				if (!sign) deg *= -1;
+				altitudes.append(deg);
 			}
-			else
-				core->update(0.0);
+			core->setJD(currentJD);
+		}
 
-			StelUtils::rectToSphe(&az, &alt, selectedObject->getAltAzPosAuto(core));
-			StelUtils::radToDecDeg(alt, sign, deg);
-			if (!sign) deg *= -1;
+		for (int i = first; i <= limit; i++)
+		{
+			ltime = i * step + 43200;
+			aX.append(ltime);
+			deg = altitudes.at(i - first);
 			aY.append(deg);
 			if (deg > xMaxY)
 			{
@@ -2056,20 +1649,25 @@ void AstroCalcDialog::drawAltVsTimeDiagram()
 				transitX = ltime;
 			}
 		}
+		RiseSetSolver* solver = core->getRiseSetSolver();
+		if (solver->canSolve(selectedObject.data()))
+		{
+			// accurate time of transit instead of the highest point of the graph
+			const double transitJD = solver->findNext(selectedObject.data(), RiseSetSolver::Transit, startJD, 1);
+			if (!std::isnan(transitJD) && transitJD <= noon + aX.last() / 86400 - shift - 0.5)
+				transitX = (transitJD - noon + shift + 0.5) * 86400;
+		}
 
+		// The Sun and the Moon every hour, one hour beyond both ends of the graph
+		const double hourlyStartJD = noon + (43200 - 3600) / 86400. - shift - 0.5;
 		if (plotAltVsTimeSun)
 		{
-			PlanetP sun = solarSystem->getSun();			
+			const QVector<double> sunAltitudes = timeline->getValues(solarSystem->getSun(), AstroCalcTimeline::Altitude, hourlyStartJD, 1. / 24., 27);
 			for (int i = -1; i <= 25; i++)
 			{
 				ltime = i * 3600 + 43200;
 				sX.append(ltime);
-				JD = noon + ltime / 86400 - shift - 0.5;
-				core->setJD(JD);				 
-				core->update(0.0);
-				StelUtils::rectToSphe(&az, &alt, sun->getAltAzPosAuto(core));
-				StelUtils::radToDecDeg(alt, sign, deg);
-				if (!sign) deg *= -1;
+				deg = sunAltitudes.at(i + 1);
 				sY.append(deg);
 				sYc.append(deg + 6);
 				sYn.append(deg + 12);
@@ -2079,23 +1677,14 @@ void AstroCalcDialog::drawAltVsTimeDiagram()
 
 		if (plotAltVsTimeMoon && onEarth)
 		{
-			PlanetP moon = solarSystem->getMoon();			
+			const QVector<double> moonAltitudes = timeline->getValues(solarSystem->getMoon(), AstroCalcTimeline::Altitude, hourlyStartJD, 1. / 24., 27);
 			for (int i = -1; i <= 25; i++)
 			{
-				ltime = i * 3600 + 43200;
-				mX.append(ltime);
-				JD = noon + ltime / 86400 - shift - 0.5;
-				core->setJD(JD);
-				core->update(0.0);
-				StelUtils::rectToSphe(&az, &alt, moon->getAltAzPosAuto(core));
-				StelUtils::radToDecDeg(alt, sign, deg);
-				if (!sign) deg *= -1;
-				mY.append(deg);
+				mX.append(i * 3600 + 43200);
+				mY.append(moonAltitudes.at(i + 1));
 			}
 		}
 
-		core->setJD(currentJD);
-
 		QVector<double> x = aX.toVector(), y = aY.toVector();
 		double minYa = aY.first();
 		double maxYa = aY.first();
@@ -2318,102 +1907,25 @@ void AstroCalcDialog::drawXVsTimeGraphs()
 	if (!ssObj.isNull())
 	{
 		// X axis - time; Y axis - altitude
-		QList<double> aX, aY, bY;
-
 		double currentJD = core->getJD();
 		int year, month, day;
-		double startJD, JD, ltime, distance, angularSize;
+		double startJD;
 		StelUtils::getDateFromJulianDay(currentJD, &year, &month, &day);
 		StelUtils::getJDFromDate(&startJD, year, 1, 1, 0, 0, 0);
 
 		double width = 1.0;
 		int dYear = (int)core->getCurrentPlanet()->getSiderealPeriod() + 3;
 
+		QVector<double> x;
 		for (int i = -2; i <= dYear; i++)
-		{
-			JD = startJD + i;
-			ltime = (JD - startJD) * StelCore::ONE_OVER_JD_SECOND;
-			aX.append(ltime);
+			x.append(i * StelCore::ONE_OVER_JD_SECOND);
+		const QVector<double> ya = getGraphValues(ssObj, ui->graphsFirstComboBox->currentData().toInt(), startJD - 2, dYear + 3);
+		const QVector<double> yb = getGraphValues(ssObj, ui->graphsSecondComboBox->currentData().toInt(), startJD - 2, dYear + 3);
 
-			core->setJD(JD);
+		double minYa = ya.first();
+		double maxYa = ya.first();
 
-			switch (ui->graphsFirstComboBox->currentData().toInt())
-			{
-				case GraphMagnitudeVsTime:
-					aY.append(ssObj->getVMagnitude(core));
-					break;
-				case GraphPhaseVsTime:
-					aY.append(ssObj->getPhase(core->getObserverHeliocentricEclipticPos()) * 100.f);
-					break;
-				case GraphDistanceVsTime:
-					distance = ssObj->getJ2000EquatorialPos(core).length();
-					if (distance < 0.1)
-						distance *= AU / 1000.;
-					aY.append(distance);
-					break;
-				case GraphElongationVsTime:
-					aY.append(ssObj->getElongation(core->getObserverHeliocentricEclipticPos()) * 180. / M_PI);
-					break;
-				case GraphAngularSizeVsTime:
-					angularSize = ssObj->getAngularSize(core) * 360. / M_PI;
-					if (angularSize < 1.)
-						angularSize *= 60.;
-					aY.append(angularSize);
-					break;
-				case GraphPhaseAngleVsTime:
-					aY.append(ssObj->getPhaseAngle(core->getObserverHeliocentricEclipticPos()) * 180. / M_PI);
-					break;
-				case GraphHDistanceVsTime:
-					distance = ssObj->getHeliocentricEclipticPos().length();
-					if (distance < 0.1)
-						distance *= AU / 1000.;
-					aY.append(distance);
-					break;
-			}
-
-			switch (ui->graphsSecondComboBox->currentData().toInt())
-			{
-				case GraphMagnitudeVsTime:
-					bY.append(ssObj->getVMagnitude(core));
-					break;
-				case GraphPhaseVsTime:
-					bY.append(ssObj->getPhase(core->getObserverHeliocentricEclipticPos()) * 100.f);
-					break;
-				case GraphDistanceVsTime:
-					distance = ssObj->getJ2000EquatorialPos(core).length();
-					if (distance < 0.1)
-						distance *= AU / 1000.;
-					bY.append(distance);
-					break;
-				case GraphElongationVsTime:
-					bY.append(ssObj->getElongation(core->getObserverHeliocentricEclipticPos()) * 180. / M_PI);
-					break;
-				case GraphAngularSizeVsTime:
-					angularSize = ssObj->getAngularSize(core) * 360. / M_PI;
-					if (angularSize < 1.)
-						angularSize *= 60.;
-					bY.append(angularSize);
-					break;
-				case GraphPhaseAngleVsTime:
-					bY.append(ssObj->getPhaseAngle(core->getObserverHeliocentricEclipticPos()) * 180. / M_PI);
-					break;
-				case GraphHDistanceVsTime:
-					distance = ssObj->getHeliocentricEclipticPos().length();
-					if (distance < 0.1)
-						distance *= AU / 1000.;
-					bY.append(distance);
-			}
-
-			core->update(0.0);
-		}
-		core->setJD(currentJD);
-
-		QVector<double> x = aX.toVector(), ya = aY.toVector(), yb = bY.toVector();
-
-		double minYa = aY.first();
-		double maxYa = aY.first();
-
-		for (auto temp : aY)
+		for (auto temp : ya)
 		{
 			if (maxYa < temp) maxYa = temp;
 			if (minYa > temp) minYa = temp;
@@ -2423,10 +1935,10 @@ void AstroCalcDialog::drawXVsTimeGraphs()
 		minY1 = minYa - width;
 		maxY1 = maxYa + width;
 
-		minYa = bY.first();
-		maxYa = bY.first();
+		minYa = yb.first();
+		maxYa = yb.first();
 
-		for (auto temp : bY)
+		for (auto temp : yb)
 		{
 			if (maxYa < temp) maxYa = temp;
 			if (minYa > temp) minYa = temp;
@@ -2445,7 +1957,11 @@ void AstroCalcDialog::drawXVsTimeGraphs()
 		ui->graphsPlot->graph(0)->setPen(QPen(Qt::red, 1));
 		ui->graphsPlot->graph(0)->setLineStyle(QCPGraph::lsLine);
 		ui->graphsPlot->graph(0)->rescaleAxes(true);
-		ui->graphsPlot->graph(0)->setData(x, ya);
+		// The sidereal period of the outer planets gives tens of thousands of daily samples
+		const int plotWidth = ui->graphsPlot->width() * ui->graphsPlot->devicePixelRatio();
+		QVector<double> xd, yd;
+		AstroCalcTimeline::decimate(x, ya, plotWidth, xd, yd);
+		ui->graphsPlot->graph(0)->setData(xd, yd);
 		ui->graphsPlot->graph(0)->setName("[0]");
 
 		ui->graphsPlot->addGraph(ui->graphsPlot->xAxis, ui->graphsPlot->yAxis2);
@@ -2453,13 +1969,62 @@ void AstroCalcDialog::drawXVsTimeGraphs()
 		ui->graphsPlot->graph(1)->setPen(QPen(Qt::yellow, 1));
 		ui->graphsPlot->graph(1)->setLineStyle(QCPGraph::lsLine);
 		ui->graphsPlot->graph(1)->rescaleAxes(true);
-		ui->graphsPlot->graph(1)->setData(x, yb);
+		AstroCalcTimeline::decimate(x, yb, plotWidth, xd, yd);
+		ui->graphsPlot->graph(1)->setData(xd, yd);
 		ui->graphsPlot->graph(1)->setName("[1]");
 
 		ui->graphsPlot->replot();
 	}
 }
 
+QVector<double> AstroCalcDialog::getGraphValues(const PlanetP& ssObj, int graphType, double startJD, int count)
+{
+	AstroCalcTimeline::Quantity quantity = AstroCalcTimeline::Magnitude;
+	switch (graphType)
+	{
+		case GraphPhaseVsTime:
+			quantity = AstroCalcTimeline::Phase;
+			break;
+		case GraphDistanceVsTime:
+			quantity = AstroCalcTimeline::Distance;
+			break;
+		case GraphElongationVsTime:
+			quantity = AstroCalcTimeline::Elongation;
+			break;
+		case GraphAngularSizeVsTime:
+			quantity = AstroCalcTimeline::AngularSize;
+			break;
+		case GraphPhaseAngleVsTime:
+			quantity = AstroCalcTimeline::PhaseAngle;
+			break;
+		case GraphHDistanceVsTime:
+			quantity = AstroCalcTimeline::HeliocentricDistance;
+			break;
+	}
+
+	QVector<double> values = timeline->getValues(ssObj, quantity, startJD, 1., count);
+	for (auto& value : values)
+	{
+		switch (graphType)
+		{
+			case GraphPhaseVsTime:
+				value *= 100.;
+				break;
+			case GraphDistanceVsTime:
+			case GraphHDistanceVsTime:
+				if (value < 0.1)
+					value *= AU / 1000.;
+				break;
+			case GraphAngularSizeVsTime:
+				value *= 360. / M_PI;
+				if (value < 1.)
+					value *= 60.;
+				break;
+		}
+	}
+	return values;
+}
+
 void AstroCalcDialog::populateFunctionsList()
 {
 	Q_ASSERT(ui->graphsFirstComboBox);
@@ -2773,7 +2338,7 @@ void AstroCalcDialog::drawMonthlyElevationGraph()
 
 		StelObjectP selectedObject = selectedObjects[0];
 
-		if (selectedObject->getType() == "Satellite")
+		if (!timeline->canSample(selectedObject.data()))
 		{
 			ui->monthlyElevationGraph->graph(0)->data()->clear();
 			ui->monthlyElevationGraph->replot();
@@ -2783,31 +2348,20 @@ void AstroCalcDialog::drawMonthlyElevationGraph()
 		double currentJD = core->getJD();
 		int hour = ui->monthlyElevationTime->value();
 
-		double az, alt, deg;
-		bool sign;
 		int year, month, day;
-		double startJD, JD, ltime;
+		double startJD;
 		StelUtils::getDateFromJulianDay(currentJD, &year, &month, &day);
 		StelUtils::getJDFromDate(&startJD, year, 1, 1, hour, 0, 0);
 		startJD -= core->getUTCOffset(startJD)/24; // Time zone correction
 
 		int dYear = (int)core->getCurrentPlanet()->getSiderealPeriod() + 3;
 
+		const QVector<double> altitudes = timeline->getValues(selectedObject, AstroCalcTimeline::Altitude, startJD - 2, 1., dYear + 3);
 		for (int i = -2; i <= dYear; i++)
 		{
-			JD = startJD + i;
-			ltime = (JD - startJD) * StelCore::ONE_OVER_JD_SECOND;
-			aX.append(ltime);
-
-			core->setJD(JD);
-			StelUtils::rectToSphe(&az, &alt, selectedObject->getAltAzPosAuto(core));
-			StelUtils::radToDecDeg(alt, sign, deg);
-			if (!sign) deg *= -1;
-			aY.append(deg);
-
-			core->update(0.0);
+			aX.append(i * StelCore::ONE_OVER_JD_SECOND);
+			aY.append(altitudes.at(i + 2));
 		}
-		core->setJD(currentJD);
 
 		QVector<double> x = aX.toVector(), y = aY.toVector();
 
@@ -2832,7 +2386,9 @@ void AstroCalcDialog::drawMonthlyElevationGraph()
 		if (name.isEmpty() && selectedObject->getType() == "Nebula")
 			name = GETSTELMODULE(NebulaMgr)->getLatestSelectedDSODesignation();
 
-		ui->monthlyElevationGraph->graph(0)->setData(x, y);
+		QVector<double> xd, yd;
+		AstroCalcTimeline::decimate(x, y, ui->monthlyElevationGraph->width() * ui->monthlyElevationGraph->devicePixelRatio(), xd, yd);
+		ui->monthlyElevationGraph->graph(0)->setData(xd, yd);
 		ui->monthlyElevationGraph->graph(0)->setName(name);
 		ui->monthlyElevationGraph->replot();
 
@@ -2916,29 +2472,28 @@ void AstroCalcDialog::setPhenomenaHeaderNames()
 	phenomenaHeader << q_("Separation");	
 	phenomenaHeader << q_("Solar Elongation");
 	phenomenaHeader << q_("Lunar Elongation");
-	ui->phenomenaTreeWidget->setHeaderLabels(phenomenaHeader);
+	phenomenaModel->setHeaderLabels(phenomenaHeader);
 
 	// adjust the column width
 	for (int i = 0; i < PhenomenaCount; ++i)
 	{
-		ui->phenomenaTreeWidget->resizeColumnToContents(i);
+		ui->phenomenaTreeView->resizeColumnToContents(i);
 	}	
 }
 
 void AstroCalcDialog::initListPhenomena()
 {
-	ui->phenomenaTreeWidget->clear();
-	ui->phenomenaTreeWidget->setColumnCount(PhenomenaCount);
+	cleanupPhenomena();
 	setPhenomenaHeaderNames();
-	ui->phenomenaTreeWidget->header()->setSectionsMovable(false);
-	ui->phenomenaTreeWidget->header()->setDefaultAlignment(Qt::AlignHCenter);
+	ui->phenomenaTreeView->header()->setSectionsMovable(false);
+	ui->phenomenaTreeView->header()->setDefaultAlignment(Qt::AlignHCenter);
 }
 
 void AstroCalcDialog::selectCurrentPhenomen(const QModelIndex& modelIndex)
 {
 	// Find the object
 	QString name = ui->object1ComboBox->currentData().toString();
-	double JD = modelIndex.sibling(modelIndex.row(), PhenomenaDate).data(Qt::UserRole).toDouble();
+	double JD = phenomenaModel->getJD(modelIndex.row());
 
 	if (objectMgr->findAndSelectI18n(name) || objectMgr->findAndSelect(name))
 	{
@@ -3128,74 +2683,67 @@ void AstroCalcDialog::calculatePhenomena()
 			break;
 	}
 
+	QVector<AstroCalcPhenomenaModel::Row> rows;
 	PlanetP planet = solarSystem->searchByEnglishName(currentPlanet);
 	if (planet)
 	{
-		double currentJD = core->getJD();   // save current JD
-		double currentJDE = core->getJDE(); // save current JDE
 		double startJD = StelUtils::qDateTimeToJd(QDateTime(ui->phenomenFromDateEdit->date()));
 		double stopJD = StelUtils::qDateTimeToJd(QDateTime(ui->phenomenToDateEdit->date().addDays(1)));
 		startJD = startJD - core->getUTCOffset(startJD) / 24.;
 		stopJD = stopJD - core->getUTCOffset(stopJD) / 24.;
 
-		// Calculate the limits on coordinates for speed-up of calculations
-		double coordsLimit = std::abs(core->getCurrentPlanet()->getRotObliquity(currentJDE)) + std::abs(planet->getRotObliquity(currentJDE)) + 0.026;
-		coordsLimit += separation * M_PI / 180.;
-		double ra, dec;
-
-		if (obj2Type < 10 || obj2Type == 20)
+		const PhenomenaFinder finder(core, startJD, stopJD);
+		const double maxSeparation = separation * M_PI / 180.;
+		if (obj2Type == 21)
 		{
-			// Solar system objects
-			for (auto& obj : objects)
-			{
-				// conjunction
-				fillPhenomenaTable(findClosestApproach(planet, obj, startJD, stopJD, separation, false), planet, obj, false);
-				// opposition
-				if (opposition)
-					fillPhenomenaTable(findClosestApproach(planet, obj, startJD, stopJD, separation, true), planet, obj, true);
-			}
+			// The first object and the separation are not used
+			rows = computeOccultationRows(startJD, stopJD);
 		}
-		else if (obj2Type == 10 || obj2Type == 11 || obj2Type == 12)
+		else if (obj2Type < 10 || obj2Type == 20)
 		{
-			// Stars
-			for (auto& obj : star)
+			// Solar system objects
+			for (const auto& phenomenon : finder.find(planet, objects, maxSeparation, opposition))
 			{
-				StelUtils::rectToSphe(&ra, &dec, obj->getEquinoxEquatorialPos(core));
-				// Add limits on coordinates for speed-up calculations
-				if (dec <= coordsLimit && dec >= -coordsLimit)
-				{
-					// conjunction
-					fillPhenomenaTable(findClosestApproach(planet, obj, startJD, stopJD, separation), planet, obj);
-				}
+				const PlanetP& obj = objects.at(phenomenon.object2);
+				rows.append(computePhenomenaRow(finder, phenomenon, planet, obj, obj->getNameI18n(), 0.));
 			}
 		}
 		else
 		{
-			// Deep-sky objects
-			for (auto& obj : dso)
+			// Stars and deep-sky objects
+			QVector<Vec3d> positions;
+			QStringList names;
+			QVector<double> radii;
+			for (const auto& obj : star)
 			{
-				StelUtils::rectToSphe(&ra, &dec, obj->getEquinoxEquatorialPos(core));
-				// Add limits on coordinates for speed-up calculations
-				if (dec <= coordsLimit && dec >= -coordsLimit)
-				{
-					// conjunction
-					fillPhenomenaTable(findClosestApproach(planet, obj, startJD, stopJD, separation), planet, obj);
-				}
+				positions.append(obj->getJ2000EquatorialPos(core));
+				names.append(obj->getNameI18n());
+				radii.append(obj->getAngularSize(core) * M_PI / 180.);
 			}
-		}
+			for (const auto& obj : dso)
+			{
+				positions.append(obj->getJ2000EquatorialPos(core));
+				names.append(obj->getNameI18n().isEmpty() ? obj->getDSODesignation() : obj->getNameI18n());
+				radii.append(obj->getAngularSize(core) * M_PI / 180.);
+			}
+			for (auto& pos : positions)
+				pos.normalize();
 
-		core->setJD(currentJD); // restore time
-		core->update(0);
+			for (const auto& phenomenon : finder.find(planet, positions, maxSeparation))
+				rows.append(computePhenomenaRow(finder, phenomenon, planet, PlanetP(), names.at(phenomenon.object2), radii.at(phenomenon.object2)));
+		}
 	}
 
+	phenomenaModel->setRows(rows, StelApp::getInstance().getFlagShowDecimalDegrees());
+
 	// adjust the column width
 	for (int i = 0; i < PhenomenaCount; ++i)
 	{
-		ui->phenomenaTreeWidget->resizeColumnToContents(i);
+		ui->phenomenaTreeView->resizeColumnToContents(i);
 	}
 
 	// sort-by-date
-	ui->phenomenaTreeWidget->sortItems(PhenomenaDate, Qt::AscendingOrder);	
+	ui->phenomenaTreeView->sortByColumn(PhenomenaDate, Qt::AscendingOrder);
 }
 
 void AstroCalcDialog::savePhenomena()
@@ -3216,708 +2764,104 @@ void AstroCalcDialog::savePhenomena()
 	QTextStream phenomenaList(&phenomena);
 	phenomenaList.setCodec("UTF-8");
 
-	int count = ui->phenomenaTreeWidget->topLevelItemCount();
-	int columns = phenomenaHeader.size();
-
-	for (int i = 0; i < columns; i++)
-	{
-		QString h = phenomenaHeader.at(i).trimmed();
-		if (h.contains(","))
-			phenomenaList << QString("\"%1\"").arg(h);
-		else
-			phenomenaList << h;
-
-		if (i < columns - 1)
-			phenomenaList << delimiter;
-		else
-			phenomenaList << acEndl;
-	}
-
-	for (int i = 0; i < count; i++)
-	{
-
-		for (int j = 0; j < columns; j++)
-		{
-			phenomenaList << ui->phenomenaTreeWidget->topLevelItem(i)->text(j);
-			if (j < columns - 1)
-				phenomenaList << delimiter;
-			else
-				phenomenaList << acEndl;
-		}
-	}
+	phenomenaModel->writeCsv(phenomenaList, delimiter, acEndl);
 
 	phenomena.close();
 }
 
-void AstroCalcDialog::fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const PlanetP object2, bool opposition)
-{
-	QMap<double, double>::ConstIterator it;
-	QString dash = QChar(0x2014); // dash
-	PlanetP sun = solarSystem->getSun();
-	PlanetP moon = solarSystem->getMoon();
-	PlanetP earth = solarSystem->getEarth();
-	PlanetP planet = core->getCurrentPlanet();
-	bool withDecimalDegree = StelApp::getInstance().getFlagShowDecimalDegrees();
-	for (it = list.constBegin(); it != list.constEnd(); ++it)
-	{
-		core->setJD(it.key());
-		core->update(0);
-
-		QString phenomenType = q_("Conjunction");
-		double separation = it.value();
-		bool occultation = false;
-		double s1 = object1->getSpheroidAngularSize(core);
-		double s2 = object2->getSpheroidAngularSize(core);
-		if (opposition)
-		{
-			phenomenType = q_("Opposition");
-			// Added a special case - lunar eclipse
-			if (qAbs(separation) <= 0.02 && ((object1 == moon  && object2 == sun) || (object1 == sun  && object2 == moon)))
-				phenomenType = q_("Eclipse");
-
-			separation += M_PI;
-		}
-		else if (separation < (s2 * M_PI / 180.) || separation < (s1 * M_PI / 180.))
-		{
-			double d1 = object1->getJ2000EquatorialPos(core).length();
-			double d2 = object2->getJ2000EquatorialPos(core).length();
-			if ((d1 < d2 && s1 <= s2) || (d1 > d2 && s1 > s2))
-			{
-				// The passage of the celestial body in front of another of greater apparent diameter
-				phenomenType = qc_("Transit", "passage of the celestial body");
-			}
-			else
-				phenomenType = q_("Occultation");
-
-			// Added a special case - solar eclipse
-			if (qAbs(s1 - s2) <= 0.05 && (object1 == sun || object2 == sun)) // 5% error of difference of sizes
-				phenomenType = q_("Eclipse");
-
-			occultation = true;
-		}
-		else if (qAbs(separation) <= 0.0087 && ((object1 == moon  && object2 == sun) || (object1 == sun  && object2 == moon))) // Added a special case - partial solar eclipse
-		{
-			phenomenType = q_("Eclipse");
-		}
-
-		QString elongStr = "";
-		if ((object1 == sun || object2 == sun) && !opposition)
-			elongStr = dash;
-		else
-		{
-			double elongation = object1->getElongation(core->getObserverHeliocentricEclipticPos());
-			if (opposition)
-				elongation = M_PI - (separation - M_PI); // calculate elongation from second object!
-
-			if (withDecimalDegree)
-				elongStr = StelUtils::radToDecDegStr(elongation, 5, false, true);
-			else
-				elongStr = StelUtils::radToDmsStr(elongation, true);
-		}
-
-		QString angDistStr = "";
-		if (planet != earth)
-			angDistStr = dash;
-		else
-		{
-			if (object1 == moon || object2 == moon)
-				angDistStr = dash;
-			else
-			{
-				double angularDistance = object1->getJ2000EquatorialPos(core).angle(moon->getJ2000EquatorialPos(core));
-				if (withDecimalDegree)
-					angDistStr = StelUtils::radToDecDegStr(angularDistance, 5, false, true);
-				else
-					angDistStr = StelUtils::radToDmsStr(angularDistance, true);
-			}
-		}
-
-		ACPhenTreeWidgetItem* treeItem = new ACPhenTreeWidgetItem(ui->phenomenaTreeWidget);
-		treeItem->setText(PhenomenaType, phenomenType);
-		// local date and time
-		treeItem->setText(PhenomenaDate, QString("%1 %2").arg(localeMgr->getPrintableDateLocal(it.key()), localeMgr->getPrintableTimeLocal(it.key())));
-		treeItem->setData(PhenomenaDate, Qt::UserRole, it.key());
-		treeItem->setText(PhenomenaObject1, object1->getNameI18n());
-		treeItem->setText(PhenomenaObject2, object2->getNameI18n());
-		if (occultation)
-			treeItem->setText(PhenomenaSeparation, dash);
-		else
-		{
-			if (withDecimalDegree)
-				treeItem->setText(PhenomenaSeparation, StelUtils::radToDecDegStr(separation, 5, false, true));
-			else
-				treeItem->setText(PhenomenaSeparation, StelUtils::radToDmsStr(separation, true));
-		}
-		treeItem->setTextAlignment(PhenomenaSeparation, Qt::AlignRight);
-		treeItem->setText(PhenomenaElongation, elongStr);
-		treeItem->setToolTip(PhenomenaElongation, q_("Angular distance from the Sun"));
-		treeItem->setTextAlignment(PhenomenaElongation, Qt::AlignRight);
-		treeItem->setText(PhenomenaAngularDistance, angDistStr);
-		treeItem->setToolTip(PhenomenaAngularDistance, q_("Angular distance from the Moon"));
-		treeItem->setTextAlignment(PhenomenaAngularDistance, Qt::AlignRight);
-	}
-}
-
-QMap<double, double> AstroCalcDialog::findClosestApproach(PlanetP& object1, PlanetP& object2, double startJD, double stopJD, double maxSeparation, bool opposition)
-{
-	double dist, prevDist, step, step0;
-	int sgn, prevSgn = 0;
-	QMap<double, double> separations;
-	QPair<double, double> extremum;
-
-	step0 = (stopJD - startJD) / 12.0;
-	if (step0 > 24.8 * 365.25) step0 = 24.8 * 365.25;
-
-	if (object1->getEnglishName() == "Neptune" || object2->getEnglishName() == "Neptune" || object1->getEnglishName() == "Uranus" || object2->getEnglishName() == "Uranus")
-	{
-		if (step0 > 3652.5)
-			step0 = 3652.5;
-	}
-	if (object1->getEnglishName() == "Jupiter" || object2->getEnglishName() == "Jupiter" || object1->getEnglishName() == "Saturn" || object2->getEnglishName() == "Saturn")
-	{
-		if (step0 > 365.25)
-			step0 = 365.;
-	}
-	if (object1->getEnglishName() == "Mars" || object2->getEnglishName() == "Mars")
-	{
-		if (step0 > 10.)
-			step0 = 10.;
-	}
-	if (object1->getEnglishName() == "Venus" || object2->getEnglishName() == "Venus" || object1->getEnglishName() == "Mercury" || object2->getEnglishName() == "Mercury")
-	{
-		if (step0 > 5.)
-			step0 = 5.;
-	}
-	if (object1->getEnglishName() == "Moon" || object2->getEnglishName() == "Moon")
-	{
-		if (step0 > 0.25)
-			step0 = 0.25;
-	}
-
-	step = step0;
-	double jd = startJD;
-	prevDist = findDistance(jd, object1, object2, opposition);
-	jd += step;
-	while (jd <= stopJD)
-	{
-		dist = findDistance(jd, object1, object2, opposition);
-		sgn = StelUtils::sign(dist - prevDist);
-
-		double factor = qAbs((dist - prevDist) / dist);
-		if (factor > 10.)
-			step = step0 * factor / 10.;
-		else
-			step = step0;
-
-		if (sgn != prevSgn && prevSgn == -1)
-		{
-			if (step > step0)
-			{
-				jd -= step;
-				step = step0;
-				sgn = prevSgn;
-				while (jd <= stopJD)
-				{
-					dist = findDistance(jd, object1, object2, opposition);
-					sgn = StelUtils::sign(dist - prevDist);
-					if (sgn != prevSgn)
-						break;
-
-					prevDist = dist;
-					prevSgn = sgn;
-					jd += step;
-				}
-			}
-
-			if (findPrecise(&extremum, object1, object2, jd, step, sgn, opposition))
-			{
-				double sep = extremum.second * 180. / M_PI;
-				if (sep < maxSeparation)
-					separations.insert(extremum.first, extremum.second);
-			}
-		}
-
-		prevDist = dist;
-		prevSgn = sgn;
-		jd += step;
-	}
-
-	return separations;
-}
-
-bool AstroCalcDialog::findPrecise(QPair<double, double>* out, PlanetP object1, PlanetP object2, double JD,
-  double step, int prevSign, bool opposition)
-{
-	int sgn;
-	double dist, prevDist;
-
-	if (out == Q_NULLPTR)
-		return false;
-
-	prevDist = findDistance(JD, object1, object2, opposition);
-	step = -step / 2.;
-	prevSign = -prevSign;
-
-	while (true)
-	{
-		JD += step;
-		dist = findDistance(JD, object1, object2, opposition);
-
-		if (qAbs(step) < 1. / 1440.)
-		{
-			out->first = JD - step / 2.0;
-			out->second = findDistance(JD - step / 2.0, object1, object2, opposition);
-			if (out->second < findDistance(JD - 5.0, object1, object2, opposition))
-				return true;
-			else
-				return false;
-		}
-		sgn = StelUtils::sign(dist - prevDist);
-		if (sgn != prevSign)
-		{
-			step = -step / 2.0;
-			sgn = -sgn;
-		}
-		prevDist = dist;
-		prevSign = sgn;
-	}
-}
-
-double AstroCalcDialog::findDistance(double JD, PlanetP object1, PlanetP object2, bool opposition)
+AstroCalcPhenomenaModel::Row AstroCalcDialog::computePhenomenaRow(const PhenomenaFinder& finder, const PhenomenaFinder::Phenomenon& phenomenon,
+								   const PlanetP& object1, const PlanetP& object2, const QString& name2, double radius2)
 {
-	core->setJD(JD);
-	core->update(0);
-	Vec3d obj1 = object1->getJ2000EquatorialPos(core);
-	Vec3d obj2 = object2->getJ2000EquatorialPos(core);
-	double angle = obj1.angle(obj2);
-	if (opposition)
-		angle = M_PI - angle;
-	return angle;
-}
-
-void AstroCalcDialog::fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const NebulaP object2)
-{
-	QMap<double, double>::ConstIterator it;
-	QString dash = QChar(0x2014); // dash
 	PlanetP sun = solarSystem->getSun();
 	PlanetP moon = solarSystem->getMoon();
 	PlanetP earth = solarSystem->getEarth();
 	PlanetP planet = core->getCurrentPlanet();
-	bool withDecimalDegree = StelApp::getInstance().getFlagShowDecimalDegrees();
-	for (it = list.constBegin(); it != list.constEnd(); ++it)
-	{
-		core->setJD(it.key());
-		core->update(0);
-
-		QString phenomenType = q_("Conjunction");
-		double separation = it.value();
-		bool occultation = false;
-		if (separation < (object2->getAngularSize(core) * M_PI / 180.) || separation < (object1->getSpheroidAngularSize(core) * M_PI / 180.))
-		{
-			phenomenType = q_("Occultation");
-			occultation = true;
-		}
-
-		QString elongStr = "";
-		if (object1 == sun)
-			elongStr = dash;
-		else
-		{
-			if (withDecimalDegree)
-				elongStr = StelUtils::radToDecDegStr(object1->getElongation(core->getObserverHeliocentricEclipticPos()), 5, false, true);
-			else
-				elongStr = StelUtils::radToDmsStr(object1->getElongation(core->getObserverHeliocentricEclipticPos()), true);
-		}
-
-		QString angDistStr = "";
-		if (planet != earth)
-			angDistStr = dash;
-		else
-		{
-			if (object1 == moon)
-				angDistStr = dash;
-			else
-			{
-				double angularDistance = object1->getJ2000EquatorialPos(core).angle(moon->getJ2000EquatorialPos(core));
-				if (withDecimalDegree)
-					angDistStr = StelUtils::radToDecDegStr(angularDistance, 5, false, true);
-				else
-					angDistStr = StelUtils::radToDmsStr(angularDistance, true);
-			}
-		}
 
-		ACPhenTreeWidgetItem* treeItem = new ACPhenTreeWidgetItem(ui->phenomenaTreeWidget);
-		treeItem->setText(PhenomenaType, phenomenType);
-		// local date and time
-		treeItem->setText(PhenomenaDate,
-		  QString("%1 %2").arg(localeMgr->getPrintableDateLocal(it.key()), localeMgr->getPrintableTimeLocal(it.key())));
-		treeItem->setData(PhenomenaDate, Qt::UserRole, it.key());
-		treeItem->setText(PhenomenaObject1, object1->getNameI18n());
-		if (!object2->getNameI18n().isEmpty())
-			treeItem->setText(PhenomenaObject2, object2->getNameI18n());
-		else
-			treeItem->setText(PhenomenaObject2, object2->getDSODesignation());
-		if (occultation)
-			treeItem->setText(PhenomenaSeparation, dash);
-		else
-		{
-			if (withDecimalDegree)
-				treeItem->setText(PhenomenaSeparation, StelUtils::radToDecDegStr(separation, 5, false, true));
-			else
-				treeItem->setText(PhenomenaSeparation, StelUtils::radToDmsStr(separation, true));
-		}
-		treeItem->setTextAlignment(PhenomenaSeparation, Qt::AlignRight);
-		treeItem->setText(PhenomenaElongation, elongStr);
-		treeItem->setToolTip(PhenomenaElongation, q_("Angular distance from the Sun"));
-		treeItem->setTextAlignment(PhenomenaElongation, Qt::AlignRight);
-		treeItem->setText(PhenomenaAngularDistance, angDistStr);
-		treeItem->setToolTip(PhenomenaAngularDistance, q_("Angular distance from the Moon"));
-		treeItem->setTextAlignment(PhenomenaAngularDistance, Qt::AlignRight);
-	}
-}
-
-QMap<double, double> AstroCalcDialog::findClosestApproach(PlanetP& object1, NebulaP& object2, double startJD, double stopJD, double maxSeparation)
-{
-	double dist, prevDist, step, step0;
-	int sgn, prevSgn = 0;
-	QMap<double, double> separations;
-	QPair<double, double> extremum;
-
-	step0 = (stopJD - startJD) / 8.0;
-	if (step0 > 24.8 * 365.25)
-		step0 = 24.8 * 365.25;
-
-	if (object1->getEnglishName() == "Neptune" || object1->getEnglishName() == "Uranus")
-	{
-		if (step0 > 3652.5)
-			step0 = 3652.5;
-	}
-	if (object1->getEnglishName() == "Jupiter" || object1->getEnglishName() == "Saturn")
+	// Positions at the date of the phenomenon; the time of the core is not changed.
+	const ObserverEphemeris& ephemeris = finder.getEphemeris();
+	const ObserverEphemeris::Frame frame = ephemeris.computeFrame(phenomenon.JD);
+	PlanetState state1;
+	const Vec3d pos1 = ephemeris.computeJ2000Pos(object1, frame, &state1);
+
+	AstroCalcPhenomenaModel::Row row;
+	row.JD = phenomenon.JD;
+	row.object1 = object1->getNameI18n();
+	row.object2 = name2;
+	// For oppositions, the finder returns the deviation from 180 degrees.
+	row.separation = phenomenon.opposition ? M_PI - phenomenon.separation : phenomenon.separation;
+	row.type = finder.classify(object1, object2, radius2, phenomenon);
+	switch (row.type)
 	{
-		if (step0 > 365.25)
-			step0 = 365.;
-	}
-	if (object1->getEnglishName() == "Mars")
-	{
-		if (step0 > 10.)
-			step0 = 10.;
-	}
-	if (object1->getEnglishName() == "Venus" || object1->getEnglishName() == "Mercury")
-	{
-		if (step0 > 5.)
-			step0 = 5.;
-	}
-	if (object1->getEnglishName() == "Moon")
-	{
-		if (step0 > 0.25)
-			step0 = 0.25;
-	}
-
-	step = step0;
-	double jd = startJD;
-	prevDist = findDistance(jd, object1, object2);
-	jd += step;
-	while (jd <= stopJD)
-	{
-		dist = findDistance(jd, object1, object2);
-		sgn = StelUtils::sign(dist - prevDist);
-
-		double factor = qAbs((dist - prevDist) / dist);
-		if (factor > 10.)
-			step = step0 * factor / 10.;
-		else
-			step = step0;
-
-		if (sgn != prevSgn && prevSgn == -1)
-		{
-			if (step > step0)
-			{
-				jd -= step;
-				step = step0;
-				sgn = prevSgn;
-				while (jd <= stopJD)
-				{
-					dist = findDistance(jd, object1, object2);
-					sgn = StelUtils::sign(dist - prevDist);
-					if (sgn != prevSgn)
-						break;
-
-					prevDist = dist;
-					prevSgn = sgn;
-					jd += step;
-				}
-			}
-
-			if (findPrecise(&extremum, object1, object2, jd, step, sgn))
+		case PhenomenaFinder::Transit:
+		case PhenomenaFinder::Occultation:
+			row.separation = NAN;
+			break;
+		case PhenomenaFinder::Eclipse:
+			// Total and annular solar eclipses have no meaningful separation
+			if (!phenomenon.opposition && object2)
 			{
-				double sep = extremum.second * 180. / M_PI;
-				if (sep < maxSeparation) separations.insert(extremum.first, extremum.second);
+				const double s1 = std::atan2(object1->getRadius()*object1->getSphereScale(), pos1.length());
+				const double s2 = std::atan2(object2->getRadius()*object2->getSphereScale(), ephemeris.computeJ2000Pos(object2, frame).length());
+				if (row.separation < s1 || row.separation < s2)
+					row.separation = NAN;
 			}
-		}
-
-		prevDist = dist;
-		prevSgn = sgn;
-		jd += step;
+			break;
+		default:
+			break;
 	}
 
-	return separations;
-}
-
-bool AstroCalcDialog::findPrecise(QPair<double, double>* out, PlanetP object1, NebulaP object2, double JD, double step, int prevSign)
-{
-	int sgn;
-	double dist, prevDist;
-
-	if (out == Q_NULLPTR)
-		return false;
-
-	prevDist = findDistance(JD, object1, object2);
-	step = -step / 2.;
-	prevSign = -prevSign;
-
-	while (true)
+	row.elongation = NAN;
+	if ((object1 != sun && object2 != sun) || phenomenon.opposition)
 	{
-		JD += step;
-		dist = findDistance(JD, object1, object2);
-
-		if (qAbs(step) < 1. / 1440.)
-		{
-			out->first = JD - step / 2.0;
-			out->second = findDistance(JD - step / 2.0, object1, object2);
-			if (out->second < findDistance(JD - 5.0, object1, object2))
-				return true;
-			else
-				return false;
-		}
-		sgn = StelUtils::sign(dist - prevDist);
-		if (sgn != prevSign)
-		{
-			step = -step / 2.0;
-			sgn = -sgn;
-		}
-		prevDist = dist;
-		prevSign = sgn;
+		if (phenomenon.opposition)
+			row.elongation = M_PI - phenomenon.separation; // calculate elongation from second object!
+		else // Same as Planet::getElongation()
+			row.elongation = (-frame.observerPos).angle(state1.heliocentricPos - frame.observerPos);
 	}
-}
-
-double AstroCalcDialog::findDistance(double JD, PlanetP object1, NebulaP object2)
-{
-	core->setJD(JD);
-	core->update(0);
-	Vec3d obj1 = object1->getJ2000EquatorialPos(core);
-	Vec3d obj2 = object2->getJ2000EquatorialPos(core);
-	return obj1.angle(obj2);
-}
-
-void AstroCalcDialog::fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const StelObjectP object2)
-{
-	QMap<double, double>::ConstIterator it;
-	QString dash = QChar(0x2014); // dash
-	PlanetP sun = solarSystem->getSun();
-	PlanetP moon = solarSystem->getMoon();
-	PlanetP earth = solarSystem->getEarth();
-	PlanetP planet = core->getCurrentPlanet();
-	bool withDecimalDegree = StelApp::getInstance().getFlagShowDecimalDegrees();
-	for (it = list.constBegin(); it != list.constEnd(); ++it)
-	{
-		core->setJD(it.key());
-		core->update(0);
-
-		QString phenomenType = q_("Conjunction");
-		double separation = it.value();
-		bool occultation = false;
-		if (separation < (object2->getAngularSize(core) * M_PI / 180.) || separation < (object1->getSpheroidAngularSize(core) * M_PI / 180.))
-		{
-			phenomenType = q_("Occultation");
-			occultation = true;
-		}
-
-		QString elongStr = "";
-		if (object1 == sun)
-			elongStr = dash;
-		else
-		{
-			if (withDecimalDegree)
-				elongStr = StelUtils::radToDecDegStr(object1->getElongation(core->getObserverHeliocentricEclipticPos()), 5, false, true);
-			else
-				elongStr = StelUtils::radToDmsStr(object1->getElongation(core->getObserverHeliocentricEclipticPos()), true);
-		}
 
-		QString angDistStr = "";
-		if (planet != earth)
-			angDistStr = dash;
-		else
-		{
-			if (object1 == moon)
-				angDistStr = dash;
-			else
-			{
-				double angularDistance = object1->getJ2000EquatorialPos(core).angle(moon->getJ2000EquatorialPos(core));
-				if (withDecimalDegree)
-					angDistStr = StelUtils::radToDecDegStr(angularDistance, 5, false, true);
-				else
-					angDistStr = StelUtils::radToDmsStr(angularDistance, true);
-			}
-		}
+	row.angularDistance = NAN;
+	if (planet == earth && object1 != moon && object2 != moon)
+		row.angularDistance = pos1.angle(ephemeris.computeJ2000Pos(moon, frame));
 
-		ACPhenTreeWidgetItem* treeItem = new ACPhenTreeWidgetItem(ui->phenomenaTreeWidget);
-		treeItem->setText(PhenomenaType, phenomenType);
-		// local date and time
-		treeItem->setText(PhenomenaDate, QString("%1 %2").arg(localeMgr->getPrintableDateLocal(it.key()), localeMgr->getPrintableTimeLocal(it.key())));
-		treeItem->setData(PhenomenaDate, Qt::UserRole, it.key());
-		treeItem->setText(PhenomenaObject1, object1->getNameI18n());
-		treeItem->setText(PhenomenaObject2, object2->getNameI18n());
-		if (occultation)
-			treeItem->setText(PhenomenaSeparation, dash);
-		else
-		{
-			if (withDecimalDegree)
-				treeItem->setText(PhenomenaSeparation, StelUtils::radToDecDegStr(separation, 5, false, true));
-			else
-				treeItem->setText(PhenomenaSeparation, StelUtils::radToDmsStr(separation, true));
-		}
-		treeItem->setTextAlignment(PhenomenaSeparation, Qt::AlignRight);
-		treeItem->setText(PhenomenaElongation, elongStr);
-		treeItem->setToolTip(PhenomenaElongation, q_("Angular distance from the Sun"));
-		treeItem->setTextAlignment(PhenomenaElongation, Qt::AlignRight);
-		treeItem->setText(PhenomenaAngularDistance, angDistStr);
-		treeItem->setToolTip(PhenomenaAngularDistance, q_("Angular distance from the Moon"));
-		treeItem->setTextAlignment(PhenomenaAngularDistance, Qt::AlignRight);
-	}
+	row.startJD = NAN;
+	row.stopJD = NAN;
+	return row;
 }
 
-QMap<double, double> AstroCalcDialog::findClosestApproach(PlanetP& object1, StelObjectP& object2, double startJD, double stopJD, double maxSeparation)
+QVector<AstroCalcPhenomenaModel::Row> AstroCalcDialog::computeOccultationRows(double startJD, double stopJD)
 {
-	double dist, prevDist, step, step0;
-	int sgn, prevSgn = 0;
-	QMap<double, double> separations;
-	QPair<double, double> extremum;
-
-	step0 = (stopJD - startJD) / 8.0;
-	if (step0 > 24.8 * 365.25)
-		step0 = 24.8 * 365.25;
+	QVector<AstroCalcPhenomenaModel::Row> rows;
+	const OccultationFinder finder(core, startJD, stopJD);
+	if (!finder.canSearch())
+		return rows;
 
-	if (object1->getEnglishName() == "Neptune" || object1->getEnglishName() == "Uranus")
+	QList<PlanetP> planets;
+	for (const auto& object : solarSystem->getAllPlanets())
 	{
-		if (step0 > 1811.25)
-			step0 = 1811.25;
-	}
-	if (object1->getEnglishName() == "Jupiter" || object1->getEnglishName() == "Saturn")
-	{
-		if (step0 > 181.125)
-			step0 = 181.125;
-	}
-	if (object1->getEnglishName() == "Mars")
-	{
-		if (step0 > 5.)
-			step0 = 5.0;
-	}
-	if (object1->getEnglishName() == "Venus" || object1->getEnglishName() == "Mercury")
-	{
-		if (step0 > 2.5)
-			step0 = 2.5;
-	}
-	if (object1->getEnglishName() == "Moon")
-	{
-		if (step0 > 0.25)
-			step0 = 0.25;
+		if (object->getPlanetType() == Planet::isPlanet)
+			planets.append(object);
 	}
+	QVector<OccultationFinder::Event> events = finder.findStarOccultations(brightLimit - 5.0f);
+	events += finder.findPlanetOccultations(planets);
+	events += finder.findSolarEclipses();
+	events += finder.findLunarEclipses();
 
-	step = step0;
-	double jd = startJD;
-	prevDist = findDistance(jd, object1, object2);
-	jd += step;
-	while (jd <= stopJD)
+	for (const auto& event : events)
 	{
-		dist = findDistance(jd, object1, object2);
-		sgn = StelUtils::sign(dist - prevDist);
-
-		double factor = qAbs((dist - prevDist) / dist);
-		if (factor > 10.)
-			step = step0 * factor / 10.;
-		else
-			step = step0;
-
-		if (sgn != prevSgn && prevSgn == -1)
-		{
-			if (step > step0)
-			{
-				jd -= step;
-				step = step0;
-				sgn = prevSgn;
-				while (jd <= stopJD)
-				{
-					dist = findDistance(jd, object1, object2);
-					sgn = StelUtils::sign(dist - prevDist);
-					if (sgn != prevSgn)
-						break;
-
-					prevDist = dist;
-					prevSgn = sgn;
-					jd += step;
-				}
-			}
-
-			if (findPrecise(&extremum, object1, object2, jd, step, sgn))
-			{
-				double sep = extremum.second * 180. / M_PI;
-				if (sep < maxSeparation)
-					separations.insert(extremum.first, extremum.second);
-			}
-		}
-
-		prevDist = dist;
-		prevSgn = sgn;
-		jd += step;
+		AstroCalcPhenomenaModel::Row row;
+		row.JD = event.JD;
+		row.type = event.type == OccultationFinder::LunarOccultation ? PhenomenaFinder::Occultation : PhenomenaFinder::Eclipse;
+		// The shadow of the Earth covers the Moon in a lunar eclipse
+		row.object1 = event.type == OccultationFinder::LunarEclipse ? solarSystem->getEarth()->getNameI18n() : solarSystem->getMoon()->getNameI18n();
+		row.object2 = event.objectI18n;
+		row.separation = event.type == OccultationFinder::LunarOccultation ? NAN : event.separation;
+		row.elongation = NAN;
+		row.angularDistance = NAN;
+		row.startJD = event.startJD;
+		row.stopJD = event.stopJD;
+		rows.append(row);
 	}
-
-	return separations;
-}
-
-bool AstroCalcDialog::findPrecise(QPair<double, double>* out, PlanetP object1, StelObjectP object2, double JD, double step, int prevSign)
-{
-	int sgn;
-	double dist, prevDist;
-
-	if (out == Q_NULLPTR)
-		return false;
-
-	prevDist = findDistance(JD, object1, object2);
-	step = -step / 2.;
-	prevSign = -prevSign;
-
-	while (true)
-	{
-		JD += step;
-		dist = findDistance(JD, object1, object2);
-
-		if (qAbs(step) < 1. / 1440.)
-		{
-			out->first = JD - step / 2.0;
-			out->second = findDistance(JD - step / 2.0, object1, object2);
-			if (out->second < findDistance(JD - 5.0, object1, object2))
-				return true;
-			else
-				return false;
-		}
-		sgn = StelUtils::sign(dist - prevDist);
-		if (sgn != prevSign)
-		{
-			step = -step / 2.0;
-			sgn = -sgn;
-		}
-		prevDist = dist;
-		prevSign = sgn;
-	}
-}
-
-double AstroCalcDialog::findDistance(double JD, PlanetP object1, StelObjectP object2)
-{
-	core->setJD(JD);
-	core->update(0);
-	Vec3d obj1 = object1->getJ2000EquatorialPos(core);
-	Vec3d obj2 = object2->getJ2000EquatorialPos(core);
-	return obj1.angle(obj2);
+	return rows;
 }
 
 void AstroCalcDialog::changePage(QListWidgetItem* current, QListWidgetItem* previous)
@@ -22,8 +22,6 @@
 #define ASTROCALCDIALOG_HPP
 
 #include <QObject>
-#include <QTreeWidget>
-#include <QTreeWidgetItem>
 #include <QMap>
 #include <QVector>
 #include <QTimer>
@@ -32,6 +30,9 @@
 #include "StelCore.hpp"
 #include "Planet.hpp"
 #include "SolarSystem.hpp"
+#include "EphemerisGenerator.hpp"
+#include "PhenomenaFinder.hpp"
+#include "AstroCalcPhenomenaModel.hpp"
 #include "Nebula.hpp"
 #include "NebulaMgr.hpp"
 #include "StarMgr.hpp"
@@ -41,6 +42,10 @@ class Ui_astroCalcDialogForm;
 class QListWidgetItem;
 class QSortFilterProxyModel;
 class QStringListModel;
+class StelProgressController;
+class AstroCalcPositionsModel;
+class AstroCalcEphemerisModel;
+class AstroCalcTimeline;
 
 class AstroCalcDialog : public StelDialog
 {
@@ -130,7 +135,14 @@ private slots:
 	void saveCelestialPositionsCategory(int index);
 
 	//! Calculate ephemeris for selected celestial body and fill the list.
+	//! The computation runs in background, and the rows are added by updateEphemeris().
 	void generateEphemeris();
+	//! Start the calculation of ephemeris, or cancel it when it is running.
+	void toggleEphemeris();
+	//! Stop the calculation of ephemeris, keeping the rows computed so far.
+	void cancelEphemeris();
+	//! Add the rows computed in background to the list, and update the progress bar.
+	void updateEphemeris();
 	void cleanupEphemeris();
 	void selectCurrentEphemeride(const QModelIndex &modelIndex);
 	void saveEphemeris();
@@ -213,8 +225,20 @@ private:
 	class StelMovementMgr* mvMgr;
 	QStringListModel* wutModel;
 	QSortFilterProxyModel *proxyModel;
+	AstroCalcPositionsModel* positionsModel;
+	AstroCalcEphemerisModel* ephemerisModel;
+	AstroCalcPhenomenaModel* phenomenaModel;
+	//! Memoised samples of the graphs
+	AstroCalcTimeline* timeline;
 	QSettings* conf;
 	QTimer *currentTimeLine;
+
+	EphemerisGenerator* ephemerisGenerator;
+	StelProgressController* ephemerisProgress;
+	QTimer* ephemerisTimer;
+	//! Whether the dates of the ephemeris markers being computed show the time
+	bool ephemerisWithTime;
+	QString ephemerisButtonText;
 	QHash<QString,QString> wutObjects;
 	QHash<QString,int> wutCategories;
 
@@ -229,6 +253,10 @@ private:
 	void initListCelestialPositions();
 	//! Init header and list of ephemeris
 	void initListEphemeris();
+	//! Add the rows computed by ephemerisGenerator since the previous call to the list of ephemeris.
+	void addEphemerisRows();
+	//! Delete ephemerisGenerator and its progress bar, and sort the list of ephemeris.
+	void stopEphemeris();
 	//! Init header and list of phenomena
 	void initListPhenomena();
 
@@ -246,6 +274,9 @@ private:
 	//! Prepare graph settings
 	void prepareAxesAndGraph();
 	void prepareXVsTimeAxesAndGraph();
+	//! Get the values of a graph of the graphs tab, in the units of its axis.
+	//! @param graphType one of GraphsTypes
+	QVector<double> getGraphValues(const PlanetP& ssObj, int graphType, double startJD, int count);
 	void prepareMonthlyEleveationAxesAndGraph();
 	void prepareDistanceAxesAndGraph();
 	void prepareAngularDistanceAxesAndGraph();
@@ -256,24 +287,14 @@ private:
 
 	void populateFunctionsList();
 
-	//! Calculation conjunctions and oppositions.
-	//! @note Ported from KStars, should be improved, because this feature calculate
-	//! angular separation ("conjunction" defined as equality of right ascension
-	//! of two body) and current solution is not accurate and slow.
-	QMap<double, double> findClosestApproach(PlanetP& object1, PlanetP& object2, double startJD, double stopJD, double maxSeparation, bool opposition);
-	double findDistance(double JD, PlanetP object1, PlanetP object2, bool opposition);
-	bool findPrecise(QPair<double, double>* out, PlanetP object1, PlanetP object2, double JD, double step, int prevSign, bool opposition);
-	void fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const PlanetP object2, bool opposition);
-
-	QMap<double, double> findClosestApproach(PlanetP& object1, NebulaP& object2, double startJD, double stopJD, double maxSeparation);
-	double findDistance(double JD, PlanetP object1, NebulaP object2);
-	bool findPrecise(QPair<double, double>* out, PlanetP object1, NebulaP object2, double JD, double step, int prevSign);
-	void fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const NebulaP object2);
-
-	QMap<double, double> findClosestApproach(PlanetP& object1, StelObjectP& object2, double startJD, double stopJD, double maxSeparation);
-	double findDistance(double JD, PlanetP object1, StelObjectP object2);
-	bool findPrecise(QPair<double, double>* out, PlanetP object1, StelObjectP object2, double JD, double step, int prevSign);
-	void fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const StelObjectP object2);
+	//! Compute the row of the table of phenomena for a conjunction or opposition found by PhenomenaFinder.
+	//! @param object2 the second body, or Q_NULLPTR for a star or deep-sky object
+	//! @param name2 the name of the second object
+	//! @param radius2 the angular radius of a star or deep-sky object [rad]
+	AstroCalcPhenomenaModel::Row computePhenomenaRow(const PhenomenaFinder& finder, const PhenomenaFinder::Phenomenon& phenomenon, const PlanetP& object1,
+							 const PlanetP& object2, const QString& name2, double radius2);
+	//! Compute the rows of the table of phenomena for the occultations of bright stars and planets by the Moon, and the eclipses.
+	QVector<AstroCalcPhenomenaModel::Row> computeOccultationRows(double startJD, double stopJD);
 
 	bool plotAltVsTime, plotAltVsTimeSun, plotAltVsTimeMoon, plotAltVsTimePositive, plotMonthlyElevation, plotMonthlyElevationPositive, plotDistanceGraph, plotAngularDistanceGraph;
 	QString delimiter, acEndl;
@@ -289,109 +310,4 @@ private:
 	void enableVisibilityAngularLimits(bool visible);
 };
 
-// Reimplements the QTreeWidgetItem class to fix the sorting bug
-class ACCelPosTreeWidgetItem : public QTreeWidgetItem
-{
-public:
-	ACCelPosTreeWidgetItem(QTreeWidget* parent)
-		: QTreeWidgetItem(parent)
-	{
-	}
-
-private:
-	bool operator < (const QTreeWidgetItem &other) const
-	{
-		int column = treeWidget()->sortColumn();
-
-		if (column == AstroCalcDialog::CColumnName)
-		{
-			QRegExp dso("^(\\w+)\\s*(\\d+)\\s*(.*)$");
-			QRegExp mp("^[(](\\d+)[)]\\s(.+)$");
-			int a = 0, b = 0;			
-			if (dso.exactMatch(text(column)))
-				a = dso.capturedTexts().at(2).toInt();
-			if (a==0 && mp.exactMatch(text(column)))
-				a = mp.capturedTexts().at(1).toInt();			
-			if (dso.exactMatch(other.text(column)))
-				b = dso.capturedTexts().at(2).toInt();
-			if (b==0 && mp.exactMatch(other.text(column)))
-				b = mp.capturedTexts().at(1).toInt();
-			if (a>0 && b>0)
-				return a < b;
-			else
-				return text(column).toLower() < other.text(column).toLower();
-		}
-		else if (column == AstroCalcDialog::CColumnRA || column == AstroCalcDialog::CColumnDec)
-		{
-			return StelUtils::getDecAngle(text(column)) < StelUtils::getDecAngle(other.text(column));
-		}
-		else if (column == AstroCalcDialog::CColumnMagnitude || column == AstroCalcDialog::CColumnAngularSize || column == AstroCalcDialog::CColumnExtra)
-		{
-			return text(column).toFloat() < other.text(column).toFloat();
-		}
-		else if (column == AstroCalcDialog::CColumnTransit)
-		{
-			return StelUtils::hmsStrToHours(text(column).append("00s")) < StelUtils::hmsStrToHours(other.text(column).append("00s"));
-		}
-		else
-		{
-			return text(column).toLower() < other.text(column).toLower();
-		}
-	}
-};
-
-// Reimplements the QTreeWidgetItem class to fix the sorting bug
-class ACEphemTreeWidgetItem : public QTreeWidgetItem
-{
-public:
-	ACEphemTreeWidgetItem(QTreeWidget* parent)
-		: QTreeWidgetItem(parent)
-	{
-	}
-
-private:
-	bool operator < (const QTreeWidgetItem &other) const
-	{
-		int column = treeWidget()->sortColumn();
-
-		if (column == AstroCalcDialog::EphemerisRA || column == AstroCalcDialog::EphemerisDec)
-		{
-			return StelUtils::getDecAngle(text(column)) < StelUtils::getDecAngle(other.text(column));
-		}
-		else if (column == AstroCalcDialog::EphemerisMagnitude || column == AstroCalcDialog::EphemerisJD)
-		{
-			return text(column).toFloat() < other.text(column).toFloat();
-		}
-		else
-		{
-			return text(column).toLower() < other.text(column).toLower();
-		}
-	}
-};
-
-// Reimplements the QTreeWidgetItem class to fix the sorting bug
-class ACPhenTreeWidgetItem : public QTreeWidgetItem
-{
-public:
-	ACPhenTreeWidgetItem(QTreeWidget* parent)
-		: QTreeWidgetItem(parent)
-	{
-	}
-
-private:
-	bool operator < (const QTreeWidgetItem &other) const
-	{
-		int column = treeWidget()->sortColumn();
-
-		if (column == AstroCalcDialog::PhenomenaSeparation || column == AstroCalcDialog::PhenomenaElongation || column == AstroCalcDialog::PhenomenaAngularDistance)
-		{
-			return StelUtils::getDecAngle(text(column)) < StelUtils::getDecAngle(other.text(column));
-		}
-		else
-		{
-			return text(column).toLower() < other.text(column).toLower();
-		}
-	}
-};
-
 #endif // ASTROCALCDIALOG_HPP
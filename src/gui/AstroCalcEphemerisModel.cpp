@@ -0,0 +1,204 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "AstroCalcEphemerisModel.hpp"
+#include "AstroCalcDialog.hpp"
+#include "StelApp.hpp"
+#include "StelLocaleMgr.hpp"
+#include "StelUtils.hpp"
+
+#include <QTextStream>
+
+#include <cfloat>
+
+AstroCalcEphemerisModel::AstroCalcEphemerisModel(QObject* parent)
+	: AstroCalcTableModel(AstroCalcDialog::EphemerisCount, parent)
+{
+}
+
+void AstroCalcEphemerisModel::clear(const Format& newFormat)
+{
+	beginResetModel();
+	rows.clear();
+	sequence.clear();
+	format = newFormat;
+	endResetModel();
+}
+
+void AstroCalcEphemerisModel::appendRows(const QVector<EphemerisGenerator::Row>& newRows)
+{
+	if (newRows.isEmpty())
+		return;
+
+	const int first = rows.size();
+	beginInsertRows(QModelIndex(), first, first + newRows.size() - 1);
+	rows += newRows;
+	sequence.reserve(rows.size());
+	for (int i = first; i < rows.size(); ++i)
+		sequence.append(i);
+	endInsertRows();
+}
+
+double AstroCalcEphemerisModel::getJD(int row) const
+{
+	return rows.at(row).JD;
+}
+
+int AstroCalcEphemerisModel::getSequenceIndex(int row) const
+{
+	return sequence.at(row);
+}
+
+int AstroCalcEphemerisModel::rowCount(const QModelIndex& parent) const
+{
+	return parent.isValid() ? 0 : rows.size();
+}
+
+void AstroCalcEphemerisModel::getCoordinates(int row, double* longitude, double* latitude) const
+{
+	StelUtils::rectToSphe(longitude, latitude, rows.at(row).pos);
+	if (format.horizontal)
+	{
+		const double direction = format.useSouthAzimuth ? 2. : 3.; // N is zero, E is 90 degrees
+		*longitude = direction * M_PI - *longitude;
+		if (*longitude > M_PI * 2)
+			*longitude -= M_PI * 2;
+	}
+}
+
+QString AstroCalcEphemerisModel::getText(int row, int column) const
+{
+	const EphemerisGenerator::Row& r = rows.at(row);
+	const QString dash = QChar(0x2014);
+	switch (column)
+	{
+		case AstroCalcDialog::EphemerisDate:
+		{
+			// local date and time
+			const StelLocaleMgr& localeMgr = StelApp::getInstance().getLocaleMgr();
+			return QString("%1 %2").arg(localeMgr.getPrintableDateLocal(r.JD), localeMgr.getPrintableTimeLocal(r.JD));
+		}
+		case AstroCalcDialog::EphemerisJD:
+			return QString::number(r.JD, 'f', 5);
+		case AstroCalcDialog::EphemerisRA:
+		case AstroCalcDialog::EphemerisDec:
+		{
+			double ra, dec;
+			getCoordinates(row, &ra, &dec);
+			const double angle = (column == AstroCalcDialog::EphemerisRA) ? ra : dec;
+			if (format.decimalDegrees)
+				return StelUtils::radToDecDegStr(angle, 5, false, true);
+			if (column == AstroCalcDialog::EphemerisRA && !format.horizontal)
+				return StelUtils::radToHmsStr(angle);
+			return StelUtils::radToDmsStr(angle, true);
+		}
+		case AstroCalcDialog::EphemerisMagnitude:
+			return QString::number(r.magnitude, 'f', 2);
+		case AstroCalcDialog::EphemerisPhase:
+			if (!format.withPhase)
+				return dash;
+			return QString("%1%").arg(QString::number(r.phase * 100, 'f', 2));
+		case AstroCalcDialog::EphemerisDistance:
+			return QString::number(r.distance, 'f', 6);
+		case AstroCalcDialog::EphemerisElongation:
+			if (!format.withPhase)
+				return dash;
+			if (format.decimalDegrees)
+				return StelUtils::radToDecDegStr(r.elongation, 5, false, true);
+			return StelUtils::radToDmsStr(r.elongation, true);
+	}
+	return QString();
+}
+
+void AstroCalcEphemerisModel::writeText(QTextStream& stream, int row, int column) const
+{
+	QChar buffer[StelUtils::FORMAT_BUFFER_LENGTH];
+	int length = -1;
+	if (!format.decimalDegrees)
+	{
+		if (column == AstroCalcDialog::EphemerisRA || column == AstroCalcDialog::EphemerisDec)
+		{
+			double ra, dec;
+			getCoordinates(row, &ra, &dec);
+			if (column == AstroCalcDialog::EphemerisRA && !format.horizontal)
+				length = StelUtils::formatRadToHms(buffer, ra);
+			else
+				length = StelUtils::formatRadToDms(buffer, column == AstroCalcDialog::EphemerisRA ? ra : dec, true);
+		}
+		else if (column == AstroCalcDialog::EphemerisElongation && format.withPhase)
+			length = StelUtils::formatRadToDms(buffer, rows.at(row).elongation, true);
+	}
+	if (length < 0)
+		AstroCalcTableModel::writeText(stream, row, column);
+	else
+		stream << QString::fromRawData(buffer, length);
+}
+
+QString AstroCalcEphemerisModel::getToolTip(int row, int column) const
+{
+	Q_UNUSED(row)
+	if (column == AstroCalcDialog::EphemerisDistance)
+		return format.distanceToolTip;
+	return QString();
+}
+
+Qt::Alignment AstroCalcEphemerisModel::getAlignment(int column) const
+{
+	if (column == AstroCalcDialog::EphemerisDate || column == AstroCalcDialog::EphemerisJD)
+		return Qt::AlignLeft | Qt::AlignVCenter;
+	return Qt::AlignRight | Qt::AlignVCenter;
+}
+
+bool AstroCalcEphemerisModel::isTextColumn(int column) const
+{
+	Q_UNUSED(column)
+	return false;
+}
+
+double AstroCalcEphemerisModel::getSortKey(int row, int column) const
+{
+	const EphemerisGenerator::Row& r = rows.at(row);
+	switch (column)
+	{
+		case AstroCalcDialog::EphemerisRA:
+		case AstroCalcDialog::EphemerisDec:
+		{
+			double ra, dec;
+			getCoordinates(row, &ra, &dec);
+			return (column == AstroCalcDialog::EphemerisRA) ? ra : dec;
+		}
+		case AstroCalcDialog::EphemerisMagnitude:
+			return r.magnitude;
+		case AstroCalcDialog::EphemerisPhase:
+			return format.withPhase ? r.phase : -DBL_MAX;
+		case AstroCalcDialog::EphemerisDistance:
+			return r.distance;
+		case AstroCalcDialog::EphemerisElongation:
+			return format.withPhase ? r.elongation : -DBL_MAX;
+	}
+	// Date and Julian day
+	return r.JD;
+}
+
+void AstroCalcEphemerisModel::permute(const QVector<int>& permutation)
+{
+	permuteVector(rows, permutation);
+	permuteVector(sequence, permutation);
+}
@@ -0,0 +1,80 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef ASTROCALCEPHEMERISMODEL_HPP
+#define ASTROCALCEPHEMERISMODEL_HPP
+
+#include "AstroCalcTableModel.hpp"
+#include "EphemerisGenerator.hpp"
+
+//! @class AstroCalcEphemerisModel
+//! Table of the ephemeris tab of the AstroCalc dialog, with the columns of AstroCalcDialog::EphemerisColumns.
+//! Rows are the rows of EphemerisGenerator, appended while they are computed.
+class AstroCalcEphemerisModel : public AstroCalcTableModel
+{
+	Q_OBJECT
+
+public:
+	//! How to format a table.
+	struct Format
+	{
+		Format() : horizontal(false), useSouthAzimuth(false), decimalDegrees(false), withPhase(true) {}
+
+		bool horizontal;	//!< positions are horizontal coordinates
+		bool useSouthAzimuth;	//!< azimuth is counted from the south
+		bool decimalDegrees;	//!< show angles in decimal degrees
+		bool withPhase;		//!< show phase and elongation (not for the Sun)
+		QString distanceToolTip;
+	};
+
+	AstroCalcEphemerisModel(QObject* parent = Q_NULLPTR);
+
+	//! Remove all the rows, and set the format of the next ones.
+	void clear(const Format& format = Format());
+	//! Append rows.
+	void appendRows(const QVector<EphemerisGenerator::Row>& rows);
+	//! Get the date of a row (UT).
+	double getJD(int row) const;
+	//! Get the position of a row in the order the rows were appended, which is also its index
+	//! in AstroCalcDialog::EphemerisListCoords.
+	int getSequenceIndex(int row) const;
+
+	int rowCount(const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE;
+
+protected:
+	QString getText(int row, int column) const Q_DECL_OVERRIDE;
+	//! Writes the sexagesimal angles without temporary strings, an export has one row per step of the ephemeris.
+	void writeText(QTextStream& stream, int row, int column) const Q_DECL_OVERRIDE;
+	QString getToolTip(int row, int column) const Q_DECL_OVERRIDE;
+	Qt::Alignment getAlignment(int column) const Q_DECL_OVERRIDE;
+	bool isTextColumn(int column) const Q_DECL_OVERRIDE;
+	double getSortKey(int row, int column) const Q_DECL_OVERRIDE;
+	void permute(const QVector<int>& permutation) Q_DECL_OVERRIDE;
+
+private:
+	//! Get the displayed coordinates of a row [rad].
+	void getCoordinates(int row, double* longitude, double* latitude) const;
+
+	Format format;
+	QVector<EphemerisGenerator::Row> rows;
+	QVector<int> sequence;
+};
+
+#endif // ASTROCALCEPHEMERISMODEL_HPP
@@ -0,0 +1,149 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "AstroCalcPhenomenaModel.hpp"
+#include "AstroCalcDialog.hpp"
+#include "StelApp.hpp"
+#include "StelLocaleMgr.hpp"
+#include "StelTranslator.hpp"
+#include "StelUtils.hpp"
+
+#include <cfloat>
+#include <cmath>
+
+AstroCalcPhenomenaModel::AstroCalcPhenomenaModel(QObject* parent)
+	: AstroCalcTableModel(AstroCalcDialog::PhenomenaCount, parent)
+	, decimalDegrees(false)
+{
+}
+
+void AstroCalcPhenomenaModel::setRows(const QVector<Row>& newRows, bool withDecimalDegrees)
+{
+	beginResetModel();
+	rows = newRows;
+	decimalDegrees = withDecimalDegrees;
+	endResetModel();
+}
+
+double AstroCalcPhenomenaModel::getJD(int row) const
+{
+	return rows.at(row).JD;
+}
+
+int AstroCalcPhenomenaModel::rowCount(const QModelIndex& parent) const
+{
+	return parent.isValid() ? 0 : rows.size();
+}
+
+QString AstroCalcPhenomenaModel::angleToString(double angle) const
+{
+	if (std::isnan(angle))
+		return QChar(0x2014); // dash
+	if (decimalDegrees)
+		return StelUtils::radToDecDegStr(angle, 5, false, true);
+	return StelUtils::radToDmsStr(angle, true);
+}
+
+QString AstroCalcPhenomenaModel::getText(int row, int column) const
+{
+	const Row& r = rows.at(row);
+	switch (column)
+	{
+		case AstroCalcDialog::PhenomenaType:
+			switch (r.type)
+			{
+				case PhenomenaFinder::Opposition:
+					return q_("Opposition");
+				case PhenomenaFinder::Transit:
+					// The passage of the celestial body in front of another of greater apparent diameter
+					return qc_("Transit", "passage of the celestial body");
+				case PhenomenaFinder::Occultation:
+					return q_("Occultation");
+				case PhenomenaFinder::Eclipse:
+					return q_("Eclipse");
+				default:
+					return q_("Conjunction");
+			}
+		case AstroCalcDialog::PhenomenaDate:
+		{
+			// local date and time
+			const StelLocaleMgr& localeMgr = StelApp::getInstance().getLocaleMgr();
+			return QString("%1 %2").arg(localeMgr.getPrintableDateLocal(r.JD), localeMgr.getPrintableTimeLocal(r.JD));
+		}
+		case AstroCalcDialog::PhenomenaObject1:
+			return r.object1;
+		case AstroCalcDialog::PhenomenaObject2:
+			return r.object2;
+		case AstroCalcDialog::PhenomenaSeparation:
+			return angleToString(r.separation);
+		case AstroCalcDialog::PhenomenaElongation:
+			return angleToString(r.elongation);
+		case AstroCalcDialog::PhenomenaAngularDistance:
+			return angleToString(r.angularDistance);
+	}
+	return QString();
+}
+
+QString AstroCalcPhenomenaModel::getToolTip(int row, int column) const
+{
+	if (column == AstroCalcDialog::PhenomenaDate)
+	{
+		const Row& r = rows.at(row);
+		if (std::isnan(r.startJD) || std::isnan(r.stopJD))
+			return QString();
+		const StelLocaleMgr& localeMgr = StelApp::getInstance().getLocaleMgr();
+		return q_("From %1 to %2").arg(localeMgr.getPrintableTimeLocal(r.startJD), localeMgr.getPrintableTimeLocal(r.stopJD));
+	}
+	if (column == AstroCalcDialog::PhenomenaElongation)
+		return q_("Angular distance from the Sun");
+	if (column == AstroCalcDialog::PhenomenaAngularDistance)
+		return q_("Angular distance from the Moon");
+	return QString();
+}
+
+Qt::Alignment AstroCalcPhenomenaModel::getAlignment(int column) const
+{
+	if (column == AstroCalcDialog::PhenomenaSeparation || column == AstroCalcDialog::PhenomenaElongation || column == AstroCalcDialog::PhenomenaAngularDistance)
+		return Qt::AlignRight | Qt::AlignVCenter;
+	return Qt::AlignLeft | Qt::AlignVCenter;
+}
+
+bool AstroCalcPhenomenaModel::isTextColumn(int column) const
+{
+	return column == AstroCalcDialog::PhenomenaType || column == AstroCalcDialog::PhenomenaObject1 || column == AstroCalcDialog::PhenomenaObject2;
+}
+
+double AstroCalcPhenomenaModel::getSortKey(int row, int column) const
+{
+	const Row& r = rows.at(row);
+	double key = r.JD;
+	if (column == AstroCalcDialog::PhenomenaSeparation)
+		key = r.separation;
+	else if (column == AstroCalcDialog::PhenomenaElongation)
+		key = r.elongation;
+	else if (column == AstroCalcDialog::PhenomenaAngularDistance)
+		key = r.angularDistance;
+	return std::isnan(key) ? -DBL_MAX : key;
+}
+
+void AstroCalcPhenomenaModel::permute(const QVector<int>& permutation)
+{
+	permuteVector(rows, permutation);
+}
@@ -0,0 +1,72 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef ASTROCALCPHENOMENAMODEL_HPP
+#define ASTROCALCPHENOMENAMODEL_HPP
+
+#include "AstroCalcTableModel.hpp"
+#include "PhenomenaFinder.hpp"
+
+//! @class AstroCalcPhenomenaModel
+//! Table of the phenomena tab of the AstroCalc dialog, with the columns of AstroCalcDialog::PhenomenaColumns.
+class AstroCalcPhenomenaModel : public AstroCalcTableModel
+{
+	Q_OBJECT
+
+public:
+	struct Row
+	{
+		double JD;				//!< date of the phenomenon (UT)
+		PhenomenaFinder::PhenomenonType type;
+		QString object1;			//!< displayed name of the first object
+		QString object2;			//!< displayed name of the second object
+		double separation;			//!< angular separation [rad], NaN for occultations
+		double elongation;			//!< angular distance from the Sun [rad], NaN if not applicable
+		double angularDistance;			//!< angular distance from the Moon [rad], NaN if not applicable
+		double startJD;				//!< first contact of an occultation or eclipse (UT), NaN if not computed
+		double stopJD;				//!< last contact of an occultation or eclipse (UT), NaN if not computed
+	};
+
+	AstroCalcPhenomenaModel(QObject* parent = Q_NULLPTR);
+
+	//! Replace all the rows.
+	//! @param decimalDegrees show angles in decimal degrees
+	void setRows(const QVector<Row>& rows, bool decimalDegrees);
+	//! Get the date of a row (UT).
+	double getJD(int row) const;
+
+	int rowCount(const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE;
+
+protected:
+	QString getText(int row, int column) const Q_DECL_OVERRIDE;
+	QString getToolTip(int row, int column) const Q_DECL_OVERRIDE;
+	Qt::Alignment getAlignment(int column) const Q_DECL_OVERRIDE;
+	bool isTextColumn(int column) const Q_DECL_OVERRIDE;
+	double getSortKey(int row, int column) const Q_DECL_OVERRIDE;
+	void permute(const QVector<int>& permutation) Q_DECL_OVERRIDE;
+
+private:
+	QString angleToString(double angle) const;
+
+	bool decimalDegrees;
+	QVector<Row> rows;
+};
+
+#endif // ASTROCALCPHENOMENAMODEL_HPP
@@ -0,0 +1,193 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "AstroCalcPositionsModel.hpp"
+#include "AstroCalcDialog.hpp"
+#include "StelCore.hpp"
+#include "StelObject.hpp"
+#include "StelUtils.hpp"
+#include "RiseSetSolver.hpp"
+
+#include <QRegExp>
+
+#include <cfloat>
+#include <cmath>
+
+AstroCalcPositionsModel::AstroCalcPositionsModel(StelCore* core, QObject* parent)
+	: AstroCalcTableModel(AstroCalcDialog::CColumnCount, parent)
+	, core(core)
+	, JD(0.)
+{
+}
+
+void AstroCalcPositionsModel::setRows(const QVector<Row>& newRows, const Format& newFormat, double newJD)
+{
+	beginResetModel();
+	rows = newRows;
+	format = newFormat;
+	JD = newJD;
+	transits.fill(NAN, rows.size());
+	nameNumbers.fill(-1, rows.size());
+	endResetModel();
+}
+
+StelObjectP AstroCalcPositionsModel::getObject(int row) const
+{
+	if (row < 0 || row >= rows.size())
+		return StelObjectP();
+	return rows.at(row).object;
+}
+
+int AstroCalcPositionsModel::rowCount(const QModelIndex& parent) const
+{
+	return parent.isValid() ? 0 : rows.size();
+}
+
+float AstroCalcPositionsModel::getTransit(int row) const
+{
+	float transit = transits.at(row);
+	if (std::isnan(transit))
+	{
+		const StelObject* object = rows.at(row).object.data();
+		RiseSetSolver* solver = core->getRiseSetSolver();
+		Vec3f rts = (solver && solver->canSolve(object)) ? solver->getRTSTime(object, JD) : object->getRTSTime(core);
+		transit = rts[1] >= 0.f ? rts[1] : -1.f;
+		transits[row] = transit;
+	}
+	return transit;
+}
+
+int AstroCalcPositionsModel::getNameNumber(int row) const
+{
+	int number = nameNumbers.at(row);
+	if (number < 0)
+	{
+		static const QRegExp dso("^(\\w+)\\s*(\\d+)\\s*(.*)$");
+		static const QRegExp mp("^[(](\\d+)[)]\\s(.+)$");
+		QRegExp re(dso);
+		const QString& name = rows.at(row).name;
+		number = 0;
+		if (re.exactMatch(name))
+			number = re.capturedTexts().at(2).toInt();
+		re = mp;
+		if (number == 0 && re.exactMatch(name))
+			number = re.capturedTexts().at(1).toInt();
+		nameNumbers[row] = number;
+	}
+	return number;
+}
+
+QString AstroCalcPositionsModel::getText(int row, int column) const
+{
+	const Row& r = rows.at(row);
+	switch (column)
+	{
+		case AstroCalcDialog::CColumnName:
+			return r.name;
+		case AstroCalcDialog::CColumnRA:
+			if (format.decimalDegrees)
+				return StelUtils::radToDecDegStr(r.longitude, 5, false, true);
+			return format.horizontal ? StelUtils::radToDmsStr(r.longitude, true) : StelUtils::radToHmsStr(r.longitude);
+		case AstroCalcDialog::CColumnDec:
+			if (format.decimalDegrees)
+				return StelUtils::radToDecDegStr(r.latitude, 5, false, true);
+			return StelUtils::radToDmsStr(r.latitude, true);
+		case AstroCalcDialog::CColumnMagnitude:
+			return QString::number(r.magnitude, 'f', 2);
+		case AstroCalcDialog::CColumnAngularSize:
+			return std::isnan(r.angularSize) ? QString(QChar(0x2014)) : QString::number(r.angularSize, 'f', format.angularSizePrecision);
+		case AstroCalcDialog::CColumnExtra:
+			return std::isnan(r.extra) ? QString(QChar(0x2014)) : QString::number(r.extra, 'f', format.extraPrecision);
+		case AstroCalcDialog::CColumnTransit:
+		{
+			float transit = getTransit(row);
+			return transit < 0.f ? QString(QChar(0x2014)) : StelUtils::hoursToHmsStr(transit, true);
+		}
+		case AstroCalcDialog::CColumnType:
+			return r.type;
+	}
+	return QString();
+}
+
+QString AstroCalcPositionsModel::getToolTip(int row, int column) const
+{
+	if (column == AstroCalcDialog::CColumnAngularSize)
+		return format.angularSizeToolTip;
+	if (column == AstroCalcDialog::CColumnExtra)
+	{
+		const float extra = rows.at(row).extra;
+		if (format.extraSeparation && !std::isnan(extra))
+			return StelUtils::decDegToDmsStr(extra / 3600.f);
+		return format.extraToolTip;
+	}
+	return QString();
+}
+
+Qt::Alignment AstroCalcPositionsModel::getAlignment(int column) const
+{
+	if (column == AstroCalcDialog::CColumnName || column == AstroCalcDialog::CColumnType)
+		return Qt::AlignLeft | Qt::AlignVCenter;
+	return Qt::AlignRight | Qt::AlignVCenter;
+}
+
+bool AstroCalcPositionsModel::isTextColumn(int column) const
+{
+	return column == AstroCalcDialog::CColumnName || column == AstroCalcDialog::CColumnType;
+}
+
+double AstroCalcPositionsModel::getSortKey(int row, int column) const
+{
+	const Row& r = rows.at(row);
+	switch (column)
+	{
+		case AstroCalcDialog::CColumnRA:
+			return r.longitude;
+		case AstroCalcDialog::CColumnDec:
+			return r.latitude;
+		case AstroCalcDialog::CColumnMagnitude:
+			return r.magnitude;
+		case AstroCalcDialog::CColumnAngularSize:
+			return std::isnan(r.angularSize) ? -DBL_MAX : r.angularSize;
+		case AstroCalcDialog::CColumnExtra:
+			return std::isnan(r.extra) ? -DBL_MAX : r.extra;
+		case AstroCalcDialog::CColumnTransit:
+			return getTransit(row);
+	}
+	return 0.;
+}
+
+bool AstroCalcPositionsModel::lessThan(int column, int a, int b) const
+{
+	if (column == AstroCalcDialog::CColumnName)
+	{
+		const int na = getNameNumber(a);
+		const int nb = getNameNumber(b);
+		if (na > 0 && nb > 0 && na != nb)
+			return na < nb;
+	}
+	return AstroCalcTableModel::lessThan(column, a, b);
+}
+
+void AstroCalcPositionsModel::permute(const QVector<int>& permutation)
+{
+	permuteVector(rows, permutation);
+	permuteVector(transits, permutation);
+	permuteVector(nameNumbers, permutation);
+}
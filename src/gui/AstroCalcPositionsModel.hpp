@@ -0,0 +1,99 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef ASTROCALCPOSITIONSMODEL_HPP
+#define ASTROCALCPOSITIONSMODEL_HPP
+
+#include "AstroCalcTableModel.hpp"
+#include "StelObjectType.hpp"
+
+class StelCore;
+
+//! @class AstroCalcPositionsModel
+//! Table of the celestial positions tab of the AstroCalc dialog.
+//! Rows store the numeric values of the columns of AstroCalcDialog::CPositionsColumns.
+//! The time of transit is computed on first request, and cached.
+class AstroCalcPositionsModel : public AstroCalcTableModel
+{
+	Q_OBJECT
+
+public:
+	struct Row
+	{
+		StelObjectP object;
+		QString name;		//!< displayed name
+		QString type;		//!< displayed type
+		double longitude;	//!< RA (J2000) or azimuth [rad]
+		double latitude;	//!< Dec (J2000) or altitude [rad]
+		float magnitude;	//!< magnitude, or opacity of dark nebulae
+		float angularSize;	//!< angular size [arcmin], NaN if not applicable
+		float extra;		//!< value of the extra column, NaN if not applicable
+	};
+
+	//! How to format a table.
+	struct Format
+	{
+		Format() : horizontal(false), decimalDegrees(false), angularSizePrecision(3), extraPrecision(2), extraSeparation(false) {}
+
+		bool horizontal;		//!< coordinates are azimuth and altitude
+		bool decimalDegrees;		//!< show coordinates in decimal degrees
+		int angularSizePrecision;	//!< number of decimals of angular sizes
+		int extraPrecision;		//!< number of decimals of the extra column
+		bool extraSeparation;		//!< the extra column is a separation in arcseconds, also shown in DMS in the tooltip
+		QString angularSizeToolTip;
+		QString extraToolTip;
+	};
+
+	AstroCalcPositionsModel(StelCore* core, QObject* parent = Q_NULLPTR);
+
+	//! Replace all the rows.
+	//! @param JD the date of the positions, for which times of transit are computed (UT)
+	void setRows(const QVector<Row>& rows, const Format& format, double JD);
+	//! Get the object of a row.
+	StelObjectP getObject(int row) const;
+
+	int rowCount(const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE;
+
+protected:
+	QString getText(int row, int column) const Q_DECL_OVERRIDE;
+	QString getToolTip(int row, int column) const Q_DECL_OVERRIDE;
+	Qt::Alignment getAlignment(int column) const Q_DECL_OVERRIDE;
+	bool isTextColumn(int column) const Q_DECL_OVERRIDE;
+	double getSortKey(int row, int column) const Q_DECL_OVERRIDE;
+	//! Designations are sorted by the number of the object in its catalog, other names alphabetically.
+	bool lessThan(int column, int a, int b) const Q_DECL_OVERRIDE;
+	void permute(const QVector<int>& permutation) Q_DECL_OVERRIDE;
+
+private:
+	//! Get the time of transit of a row [hours], computing it on first use.
+	//! @return a negative value if the object has no transit on this day
+	float getTransit(int row) const;
+	//! Get the number of the object of a row in its catalog, 0 if its name is not a designation.
+	int getNameNumber(int row) const;
+
+	StelCore* core;
+	double JD;
+	Format format;
+	QVector<Row> rows;
+	mutable QVector<float> transits;	// NaN until computed
+	mutable QVector<int> nameNumbers;	// -1 until computed
+};
+
+#endif // ASTROCALCPOSITIONSMODEL_HPP
@@ -0,0 +1,173 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "AstroCalcTableModel.hpp"
+
+#include <QTextStream>
+
+#include <algorithm>
+
+AstroCalcTableModel::AstroCalcTableModel(int columns, QObject* parent)
+	: QAbstractTableModel(parent)
+	, columns(columns)
+{
+}
+
+void AstroCalcTableModel::setHeaderLabels(const QStringList& labels)
+{
+	header = labels;
+	emit headerDataChanged(Qt::Horizontal, 0, columns-1);
+}
+
+void AstroCalcTableModel::writeCsv(QTextStream& stream, const QString& delimiter, const QString& endOfLine) const
+{
+	const int count = header.size();
+	for (int i = 0; i < count; i++)
+	{
+		QString h = header.at(i).trimmed();
+		if (h.contains(","))
+			stream << QString("\"%1\"").arg(h);
+		else
+			stream << h;
+
+		if (i < count - 1)
+			stream << delimiter;
+		else
+			stream << endOfLine;
+	}
+
+	const int rows = rowCount();
+	for (int i = 0; i < rows; i++)
+	{
+		for (int j = 0; j < count; j++)
+		{
+			writeText(stream, i, j);
+			if (j < count - 1)
+				stream << delimiter;
+			else
+				stream << endOfLine;
+		}
+	}
+}
+
+void AstroCalcTableModel::writeText(QTextStream& stream, int row, int column) const
+{
+	stream << getText(row, column);
+}
+
+int AstroCalcTableModel::columnCount(const QModelIndex& parent) const
+{
+	return parent.isValid() ? 0 : columns;
+}
+
+QString AstroCalcTableModel::getToolTip(int row, int column) const
+{
+	Q_UNUSED(row)
+	Q_UNUSED(column)
+	return QString();
+}
+
+Qt::Alignment AstroCalcTableModel::getAlignment(int column) const
+{
+	Q_UNUSED(column)
+	return Qt::AlignRight | Qt::AlignVCenter;
+}
+
+QVariant AstroCalcTableModel::data(const QModelIndex& index, int role) const
+{
+	if (!index.isValid() || index.row() >= rowCount() || index.column() >= columns)
+		return QVariant();
+
+	switch (role)
+	{
+		case Qt::DisplayRole:
+			return getText(index.row(), index.column());
+		case Qt::TextAlignmentRole:
+			return QVariant(getAlignment(index.column()));
+		case Qt::ToolTipRole:
+		{
+			QString toolTip = getToolTip(index.row(), index.column());
+			if (!toolTip.isEmpty())
+				return toolTip;
+			break;
+		}
+	}
+	return QVariant();
+}
+
+QVariant AstroCalcTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+	if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < header.size())
+		return header.at(section);
+	return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+bool AstroCalcTableModel::lessThan(int column, int a, int b) const
+{
+	if (isTextColumn(column))
+		return sortTexts.at(a).compare(sortTexts.at(b), Qt::CaseInsensitive) < 0;
+	return sortKeys.at(a) < sortKeys.at(b);
+}
+
+void AstroCalcTableModel::sort(int column, Qt::SortOrder order)
+{
+	const int count = rowCount();
+	if (column < 0 || column >= columns || count == 0)
+		return;
+
+	// Keys are computed once per row, not in each comparison
+	if (isTextColumn(column))
+	{
+		sortTexts.resize(count);
+		for (int i = 0; i < count; ++i)
+			sortTexts[i] = getText(i, column);
+	}
+	else
+	{
+		sortKeys.resize(count);
+		for (int i = 0; i < count; ++i)
+			sortKeys[i] = getSortKey(i, column);
+	}
+
+	QVector<int> permutation(count);
+	for (int i = 0; i < count; ++i)
+		permutation[i] = i;
+	if (order == Qt::AscendingOrder)
+		std::stable_sort(permutation.begin(), permutation.end(), [&](int a, int b) {return lessThan(column, a, b);});
+	else
+		std::stable_sort(permutation.begin(), permutation.end(), [&](int a, int b) {return lessThan(column, b, a);});
+	sortKeys.clear();
+	sortTexts.clear();
+
+	emit layoutAboutToBeChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+	permute(permutation);
+
+	QVector<int> newPosition(count);
+	for (int i = 0; i < count; ++i)
+		newPosition[permutation.at(i)] = i;
+	const QModelIndexList oldIndexes = persistentIndexList();
+	QModelIndexList newIndexes;
+	newIndexes.reserve(oldIndexes.size());
+	for (const auto& idx : oldIndexes)
+		newIndexes.append(index(newPosition.at(idx.row()), idx.column()));
+	changePersistentIndexList(oldIndexes, newIndexes);
+
+	emit layoutChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+}
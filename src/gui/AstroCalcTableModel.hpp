@@ -0,0 +1,95 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef ASTROCALCTABLEMODEL_HPP
+#define ASTROCALCTABLEMODEL_HPP
+
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <QVector>
+
+class QTextStream;
+
+//! @class AstroCalcTableModel
+//! Base of the result tables of the AstroCalc dialog.
+//! Subclasses store the raw numeric values of their rows, and format a cell only when it is
+//! requested by a view, i.e. for the rows visible in its viewport, or when the table is exported.
+//! Sorting permutes the rows, using numeric keys for all the columns but those of text.
+class AstroCalcTableModel : public QAbstractTableModel
+{
+	Q_OBJECT
+
+public:
+	//! @param columns the number of columns
+	AstroCalcTableModel(int columns, QObject* parent = Q_NULLPTR);
+
+	//! Set the labels of the columns.
+	void setHeaderLabels(const QStringList& labels);
+
+	//! Write the labels of the columns and all the rows, in their current order, as delimited text.
+	//! Labels which contain a comma are quoted.
+	void writeCsv(QTextStream& stream, const QString& delimiter, const QString& endOfLine) const;
+
+	//! @name Reimplemented model handling methods.
+	//@{
+	int columnCount(const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE;
+	QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+	void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) Q_DECL_OVERRIDE;
+	//@}
+
+protected:
+	//! Get the text of a cell.
+	virtual QString getText(int row, int column) const = 0;
+	//! Write the text of a cell for writeCsv(). By default writes getText().
+	virtual void writeText(QTextStream& stream, int row, int column) const;
+	//! Get the tooltip of a cell. None by default.
+	virtual QString getToolTip(int row, int column) const;
+	//! Get the alignment of the cells of a column. Right aligned by default.
+	virtual Qt::Alignment getAlignment(int column) const;
+	//! Get whether a column is sorted by its text, case insensitively, instead of getSortKey().
+	virtual bool isTextColumn(int column) const = 0;
+	//! Get the key of a cell of a numeric column. Cells without a value should return -DBL_MAX.
+	virtual double getSortKey(int row, int column) const = 0;
+	//! Compare two rows for sorting. By default compares the keys or the texts prepared by sort().
+	virtual bool lessThan(int column, int a, int b) const;
+	//! Reorder the rows: the new row i is the old row permutation[i].
+	virtual void permute(const QVector<int>& permutation) = 0;
+
+	//! Reorder a vector of values of the rows.
+	template<class T> static void permuteVector(QVector<T>& values, const QVector<int>& permutation)
+	{
+		QVector<T> sorted;
+		sorted.reserve(values.size());
+		for (int old : permutation)
+			sorted.append(values.at(old));
+		values.swap(sorted);
+	}
+
+	//! Numeric keys or texts of the column being sorted, only valid during sort().
+	QVector<double> sortKeys;
+	QVector<QString> sortTexts;
+
+private:
+	int columns;
+	QStringList header;
+};
+
+#endif // ASTROCALCTABLEMODEL_HPP
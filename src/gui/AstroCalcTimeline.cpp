@@ -0,0 +1,214 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "AstroCalcTimeline.hpp"
+#include "ObserverEphemeris.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelObserver.hpp"
+#include "StelSkyDrawer.hpp"
+#include "SolarSystem.hpp"
+#include "Planet.hpp"
+#include "RiseSetSolver.hpp"
+
+#include <QtConcurrent>
+
+#include <cmath>
+
+namespace
+{
+	// Enough for the graphs of a few objects with their Sun and Moon overlays
+	const int MAX_CACHED_TIMELINES = 24;
+	// Number of samples computed by each task of the thread pool
+	const int SAMPLES_PER_TASK = 32;
+	// Columns kept by decimate() when the graph is not shown yet
+	const int MIN_DECIMATION_WIDTH = 1024;
+}
+
+AstroCalcTimeline::AstroCalcTimeline(StelCore* core)
+	: core(core)
+{
+}
+
+bool AstroCalcTimeline::canSample(const StelObject* object) const
+{
+	return core->getRiseSetSolver()->canSolve(object);
+}
+
+QVector<double> AstroCalcTimeline::getValues(const StelObjectP& object, Quantity quantity, double startJD, double step, int count)
+{
+	if (!canSample(object.data()))
+		return QVector<double>(count, NAN);
+
+	const QString key = getKey(object.data(), startJD, step, count);
+	QSharedPointer<Samples> samples = cache.value(key);
+	if (samples)
+		recentKeys.removeOne(key);
+	else
+	{
+		samples.reset(new Samples());
+		compute(object, startJD, step, count, *samples);
+		cache.insert(key, samples);
+		if (recentKeys.size() >= MAX_CACHED_TIMELINES)
+			cache.remove(recentKeys.takeFirst());
+	}
+	recentKeys.append(key);
+	return samples->values[quantity];
+}
+
+void AstroCalcTimeline::clear()
+{
+	cache.clear();
+	recentKeys.clear();
+}
+
+void AstroCalcTimeline::decimate(const QVector<double>& x, const QVector<double>& y, int width, QVector<double>& xOut, QVector<double>& yOut)
+{
+	const int count = qMin(x.size(), y.size());
+	const int columns = qMax(width, MIN_DECIMATION_WIDTH);
+	if (count <= 2*columns)
+	{
+		xOut = x;
+		yOut = y;
+		return;
+	}
+
+	xOut.clear();
+	yOut.clear();
+	xOut.reserve(3*columns);
+	yOut.reserve(3*columns);
+	for (int c=0; c<columns; ++c)
+	{
+		const int first = static_cast<int>(static_cast<qint64>(count)*c/columns);
+		const int last = static_cast<int>(static_cast<qint64>(count)*(c+1)/columns);
+		int minIndex = -1, maxIndex = -1;
+		bool gap = false;
+		for (int i=first; i<last; ++i)
+		{
+			const double value = y.at(i);
+			if (std::isnan(value))
+			{
+				gap = true;
+				continue;
+			}
+			if (minIndex<0 || value<y.at(minIndex))
+				minIndex = i;
+			if (maxIndex<0 || value>y.at(maxIndex))
+				maxIndex = i;
+		}
+		if (minIndex>=0)
+		{
+			const int a = qMin(minIndex, maxIndex), b = qMax(minIndex, maxIndex);
+			xOut.append(x.at(a));
+			yOut.append(y.at(a));
+			if (b!=a)
+			{
+				xOut.append(x.at(b));
+				yOut.append(y.at(b));
+			}
+		}
+		if (gap)
+		{
+			xOut.append(x.at(last-1));
+			yOut.append(NAN);
+		}
+	}
+}
+
+QString AstroCalcTimeline::getKey(const StelObject* object, double startJD, double step, int count) const
+{
+	// Same settings as the cache of RiseSetSolver, the light time changes the physical quantities too
+	const StelLocation& location = core->getCurrentLocation();
+	const Refraction& refraction = core->getSkyDrawer()->getRefraction();
+	QStringList key;
+	key << object->getType() << object->getID() << object->getEnglishName()
+	    << location.planetName << QString::number(location.latitude) << QString::number(location.longitude)
+	    << QString::number(location.altitude)
+	    << QString::number(core->getUseTopocentricCoordinates()) << QString::number(core->getSkyDrawer()->getFlagHasAtmosphere())
+	    << QString::number(GETSTELMODULE(SolarSystem)->getFlagLightTravelTime())
+	    << QString::number(refraction.getPressure()) << QString::number(refraction.getTemperature())
+	    << QString::number(core->getCurrentDeltaTAlgorithm())
+	    << QString::number(startJD, 'f', 8) << QString::number(step, 'f', 8) << QString::number(count);
+	return key.join(QLatin1Char('/'));
+}
+
+void AstroCalcTimeline::compute(const StelObjectP& object, double startJD, double step, int count, Samples& samples) const
+{
+	// Raw pointers, so that the tasks don't call QVector::detach() concurrently
+	double* values[QuantityCount];
+	for (int q=0; q<QuantityCount; ++q)
+	{
+		samples.values[q].fill(NAN, count);
+		values[q] = samples.values[q].data();
+	}
+
+	PlanetP planet;
+	if (dynamic_cast<const Planet*>(object.data()))
+	{
+		planet = GETSTELMODULE(SolarSystem)->searchByEnglishName(object->getEnglishName());
+		if (planet.data()!=object.data())
+			planet.clear();
+	}
+	// Proper motion is negligible over the ranges of the graphs
+	Vec3d fixedPos = object->getJ2000EquatorialPos(core);
+	fixedPos.normalize();
+
+	const ObserverEphemeris ephemeris(core, startJD, startJD + step*(count-1));
+	auto computeRange = [&](int first, int last)
+	{
+		for (int i=first; i<last; ++i)
+		{
+			const ObserverEphemeris::Frame frame = ephemeris.computeFrame(startJD + i*step);
+			if (!planet)
+			{
+				const Vec3d altAz = ephemeris.j2000ToAltAz(fixedPos, frame, true);
+				values[Altitude][i] = std::asin(altAz[2]/altAz.length()) * 180./M_PI;
+				continue;
+			}
+
+			PlanetState state;
+			const Vec3d j2000Pos = ephemeris.computeJ2000Pos(planet, frame, &state);
+			const Vec3d altAz = ephemeris.j2000ToAltAz(j2000Pos, frame, true);
+			const double distance = j2000Pos.length();
+			values[Altitude][i] = std::asin(altAz[2]/altAz.length()) * 180./M_PI;
+			values[Magnitude][i] = ephemeris.computeVMagnitude(planet, frame, state, false);
+			values[Distance][i] = distance;
+			values[AngularSize][i] = planet->getAngularSizeAtDistance(distance);
+			values[HeliocentricDistance][i] = state.heliocentricPos.length();
+
+			// Same as Planet::getPhase(), Planet::getPhaseAngle() and Planet::getElongation()
+			const Vec3d& observerPos = frame.observerPos;
+			const Vec3d& planetPos = state.heliocentricPos;
+			const double observerRq = observerPos.lengthSquared();
+			const double planetRq = planetPos.lengthSquared();
+			const double observerPlanetRq = (observerPos - planetPos).lengthSquared();
+			const double cos_chi = (observerPlanetRq + planetRq - observerRq)/(2.0*std::sqrt(observerPlanetRq*planetRq));
+			values[Phase][i] = 0.5 * qAbs(1. + cos_chi);
+			values[PhaseAngle][i] = std::acos(cos_chi) * 180./M_PI;
+			values[Elongation][i] = std::acos((observerPlanetRq + observerRq - planetRq)/(2.0*std::sqrt(observerPlanetRq*observerRq))) * 180./M_PI;
+		}
+	};
+
+	QVector<QPair<int, int> > chunks;
+	for (int first=0; first<count; first+=SAMPLES_PER_TASK)
+		chunks.append(qMakePair(first, qMin(first+SAMPLES_PER_TASK, count)));
+	QtConcurrent::blockingMap(chunks, [&](const QPair<int, int>& chunk) { computeRange(chunk.first, chunk.second); });
+}
@@ -0,0 +1,92 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef ASTROCALCTIMELINE_HPP
+#define ASTROCALCTIMELINE_HPP
+
+#include "StelObject.hpp"
+
+#include <QHash>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVector>
+
+class StelCore;
+
+//! @class AstroCalcTimeline
+//! Quantities of objects sampled at regular dates, shared by the graphs of the AstroCalc dialog.
+//! All the quantities of an object are computed at once, in parallel on the global thread pool with
+//! ObserverEphemeris: the time of StelCore is not changed. The samples are memoised per object,
+//! location, settings of the observer and range of dates, so that redrawing a graph with other
+//! options, or another graph of the same object over the same dates, costs nothing.
+//! All methods must be called from the main thread.
+class AstroCalcTimeline
+{
+public:
+	enum Quantity
+	{
+		Altitude,		//!< apparent altitude, with refraction when the observer has an atmosphere [degrees]
+		Magnitude,		//!< visual magnitude without extinction
+		Phase,			//!< illuminated fraction [0..1]
+		Distance,		//!< distance from the observer [AU]
+		Elongation,		//!< elongation from the Sun [degrees]
+		AngularSize,		//!< angular semidiameter, see Planet::getAngularSize() [degrees]
+		PhaseAngle,		//!< phase angle [degrees]
+		HeliocentricDistance,	//!< distance from the Sun [AU]
+		QuantityCount
+	};
+
+	AstroCalcTimeline(StelCore* core);
+
+	//! Get whether an object can be sampled: not artificial satellites, nor the planet of the observer.
+	//! @see RiseSetSolver::canSolve()
+	bool canSample(const StelObject* object) const;
+
+	//! Get the values of a quantity of an object at the dates startJD + i*step (UT), for i in [0, count).
+	//! The quantities other than Altitude are NaN for objects outside the solar system, and all of them
+	//! are NaN if canSample() is false.
+	QVector<double> getValues(const StelObjectP& object, Quantity quantity, double startJD, double step, int count);
+
+	//! Remove all the memoised samples.
+	void clear();
+
+	//! Reduce a series to the minimum and maximum values of each pixel column of its graph, in the order of
+	//! the samples, so that the graph looks the same with at most two points per column. The NaN values of a
+	//! column are kept as one NaN point, for the gaps of the graph.
+	//! @param x, y the series, with x increasing
+	//! @param width the width of the graph in device pixels, at least 1024 columns are kept
+	//! @param xOut, yOut the decimated series, the input series when they are short enough
+	static void decimate(const QVector<double>& x, const QVector<double>& y, int width, QVector<double>& xOut, QVector<double>& yOut);
+
+private:
+	struct Samples
+	{
+		QVector<double> values[QuantityCount];
+	};
+
+	QString getKey(const StelObject* object, double startJD, double step, int count) const;
+	void compute(const StelObjectP& object, double startJD, double step, int count, Samples& samples) const;
+
+	StelCore* core;
+	QHash<QString, QSharedPointer<Samples> > cache;
+	QStringList recentKeys;		// keys of the cache, the most recently used last
+};
+
+#endif // ASTROCALCTIMELINE_HPP
@@ -1095,6 +1095,7 @@ void ConfigurationDialog::pluginConfigureCurrentSelection()
 			StelModule* pmod = moduleMgr.getModule(desc.info.id, QObject::sender()->objectName()=="pluginsListWidget");
 			if (pmod != Q_NULLPTR)
 			{
+				moduleMgr.activatePlugin(desc.info.id);
 				pmod->configureGui(true);
 			}
 			return;
@@ -199,7 +199,7 @@ void LocationDialog::handleDialogSizeChanged(QSizeF size)
 
 void LocationDialog::reloadLocations()
 {
-	allModel->setStringList(StelApp::getInstance().getLocationMgr().getAllMap().keys());
+	allModel->setStringList(StelApp::getInstance().getLocationMgr().getAllIDs());
 }
 
 void LocationDialog::populateTooltips()
@@ -515,8 +515,7 @@ void LocationDialog::setPositionFromMap(double longitude, double latitude)
 	if (customTimeZone.isEmpty())
 		ui->timeZoneNameComboBox->setCurrentIndex(ui->timeZoneNameComboBox->findData("LMST", Qt::UserRole, Qt::MatchCaseSensitive));
 	// Filter location list for nearby sites. I assume Earth locations are better known. With only few locations on other planets in the list, 30 degrees seem OK.
-	LocationMap results = StelApp::getInstance().getLocationMgr().pickLocationsNearby(loc.planetName, longitude, latitude, loc.planetName=="Earth" ? 5.0f: 30.0f);
-	pickedModel->setStringList(results.keys());
+	pickedModel->setStringList(StelApp::getInstance().getLocationMgr().pickLocationIDsNearby(loc.planetName, longitude, latitude, loc.planetName=="Earth" ? 5.0f: 30.0f));
 	proxyModel->setSourceModel(pickedModel);
 	proxyModel->sort(0, Qt::AscendingOrder);
 	ui->citySearchLineEdit->clear();	
@@ -550,8 +549,7 @@ void LocationDialog::moveToAnotherPlanet(const QString&)
 		}
 		else
 		{
-			LocationMap results = locMgr.pickLocationsNearby(loc.planetName, 0.0f, 0.0f, 180.0f);
-			pickedModel->setStringList(results.keys());
+			pickedModel->setStringList(locMgr.pickLocationIDsNearby(loc.planetName, 0.0f, 0.0f, 180.0f));
 			proxyModel->setSourceModel(pickedModel);
 			ui->countryNameComboBox->setCurrentIndex(ui->countryNameComboBox->findData("", Qt::UserRole, Qt::MatchCaseSensitive));
 			if (customTimeZone.isEmpty())
@@ -841,8 +839,7 @@ void LocationDialog::filterSitesByCountry()
 	QString country=ui->countryNameComboBox->currentData().toString();
 	StelLocationMgr &locMgr=StelApp::getInstance().getLocationMgr();
 
-	LocationMap results = locMgr.pickLocationsInCountry(country);
-	pickedModel->setStringList(results.keys());
+	pickedModel->setStringList(locMgr.pickLocationIDsInCountry(country));
 	proxyModel->setSourceModel(pickedModel);
 	proxyModel->sort(0, Qt::AscendingOrder);
 	ui->citySearchLineEdit->clear();
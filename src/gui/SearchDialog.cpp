@@ -49,6 +49,8 @@
 #include <QClipboard>
 #include <QSortFilterProxyModel>
 #include <QStringListModel>
+#include <QTimer>
+#include <QtConcurrent>
 
 #include "SimbadSearcher.hpp"
 
@@ -138,6 +140,7 @@ SearchDialog::SearchDialog(QObject* parent)
 	, listModel(Q_NULLPTR)
 	, proxyModel(Q_NULLPTR)
 	, flagHasSelectedText(false)
+	, searchGeneration(0)
 {
 	ui = new Ui_searchDialogForm;
 	simbadSearcher = new SimbadSearcher(this);
@@ -150,10 +153,19 @@ SearchDialog::SearchDialog(QObject* parent)
 	useLockPosition = conf->value("search/flag_lock_position", true).toBool();
 	simbadServerUrl = conf->value("search/simbad_server_url", DEF_SIMBAD_URL).toString();
 	setCurrentCoordinateSystemKey(conf->value("search/coordinate_system", "equatorialJ2000").toString());	
+
+	searchTimer = new QTimer(this);
+	searchTimer->setSingleShot(true);
+	searchTimer->setInterval(qBound(0, conf->value("search/typing_delay", 150).toInt(), 1000));
+	connect(searchTimer, SIGNAL(timeout()), this, SLOT(startSearch()));
+	localSearchWatcher = new QFutureWatcher<QStringList>(this);
+	connect(localSearchWatcher, SIGNAL(finished()), this, SLOT(onLocalSearchFinished()));
 }
 
 SearchDialog::~SearchDialog()
 {
+	// The worker thread uses the object manager, which is destroyed after the dialogs
+	localSearchWatcher->waitForFinished();
 	delete ui;
 	if (simbadReply)
 	{
@@ -565,6 +577,34 @@ void SearchDialog::manualPositionChanged()
 	mvmgr->setFlagLockEquPos(useLockPosition);
 }
 
+QStringList SearchDialog::listLocalMatches(const StelObjectMgr* objectMgr, const QString& trimmedText, bool useStartOfWords)
+{
+	QString greekText = substituteGreek(trimmedText);
+	QStringList matches;
+	if(greekText != trimmedText)
+	{
+		matches  = objectMgr->listMatchingObjects(trimmedText, 8, useStartOfWords, false);
+		matches += objectMgr->listMatchingObjects(trimmedText, 8, useStartOfWords, true);
+		matches += objectMgr->listMatchingObjects(greekText, (18 - matches.size()), useStartOfWords, false);
+		matches += objectMgr->listMatchingObjects(greekText, (18 - matches.size()), useStartOfWords, true);
+	}
+	else
+	{
+		matches  = objectMgr->listMatchingObjects(trimmedText, 13, useStartOfWords, false);
+		matches += objectMgr->listMatchingObjects(trimmedText, 13, useStartOfWords, true);
+	}
+
+	// remove possible duplicates from completion list
+	matches.removeDuplicates();
+
+	matches.sort(Qt::CaseInsensitive);
+	// objects with short names should be searched first
+	// examples: Moon, Hydra (moon); Jupiter, Ghost of Jupiter
+	stringLengthCompare comparator;
+	qSort(matches.begin(), matches.end(), comparator);
+	return matches;
+}
+
 void SearchDialog::onSearchTextChanged(const QString& text)
 {
 	// This block needs to go before the trimmedText.isEmpty() or the SIMBAD result does not
@@ -581,49 +621,71 @@ void SearchDialog::onSearchTextChanged(const QString& text)
 		simbadResults.clear();
 	}
 
-	QString trimmedText = text.trimmed().toLower();
-	if (trimmedText.isEmpty()) {
+	// A new text makes the running search stale: its result is dropped when it comes back.
+	++searchGeneration;
+	pendingSearchText = text.trimmed().toLower();
+	if (pendingSearchText.isEmpty()) {
+		searchTimer->stop();
 		ui->completionLabel->clearValues();
 		ui->completionLabel->selectFirst();
 		ui->simbadStatusLabel->setText("");
 		ui->pushButtonGotoSearchSkyObject->setEnabled(false);
 	} else {
-		if (useSimbad)
-		{
-			simbadReply = simbadSearcher->lookup(simbadServerUrl, trimmedText, 4);
-			onSimbadStatusChanged();
-			connect(simbadReply, SIGNAL(statusChanged()), this, SLOT(onSimbadStatusChanged()));
-		}
+		// Wait for the user to stop typing before searching
+		searchTimer->start();
+	}
+}
 
-		QString greekText = substituteGreek(trimmedText);
-		QStringList matches;
-		if(greekText != trimmedText)
-		{
-			matches  = objectMgr->listMatchingObjects(trimmedText, 8, useStartOfWords, false);
-			matches += objectMgr->listMatchingObjects(trimmedText, 8, useStartOfWords, true);
-			matches += objectMgr->listMatchingObjects(greekText, (18 - matches.size()), useStartOfWords, false);
-			matches += objectMgr->listMatchingObjects(greekText, (18 - matches.size()), useStartOfWords, true);
-		}
-		else
-		{
-			matches  = objectMgr->listMatchingObjects(trimmedText, 13, useStartOfWords, false);
-			matches += objectMgr->listMatchingObjects(trimmedText, 13, useStartOfWords, true);
-		}
+void SearchDialog::startSearch()
+{
+	if (pendingSearchText.isEmpty())
+		return;
 
-		// remove possible duplicates from completion list
-		matches.removeDuplicates();
+	const QString trimmedText = pendingSearchText;
+	const StelObjectMgr* mgr = objectMgr;
+	const bool startOfWords = useStartOfWords;
+	const quint64 generation = searchGeneration;
+	QFuture<QStringList> future = QtConcurrent::run([mgr, trimmedText, startOfWords]() {
+		return listLocalMatches(mgr, trimmedText, startOfWords);
+	});
+	localSearchWatcher->setProperty("generation", generation);
+	localSearchWatcher->setFuture(future);
+
+	// The SIMBAD lookup goes through the network access manager and never blocks the interface.
+	// Its results are appended to the local ones, whichever arrive first.
+	if (useSimbad)
+	{
+		simbadReply = simbadSearcher->lookup(simbadServerUrl, trimmedText, 4, qMax(0, 500-searchTimer->interval()));
+		onSimbadStatusChanged();
+		connect(simbadReply, SIGNAL(statusChanged()), this, SLOT(onSimbadStatusChanged()));
+	}
+}
 
-		matches.sort(Qt::CaseInsensitive);
-		// objects with short names should be searched first
-		// examples: Moon, Hydra (moon); Jupiter, Ghost of Jupiter
-		stringLengthCompare comparator;
-		qSort(matches.begin(), matches.end(), comparator);
+void SearchDialog::onLocalSearchFinished()
+{
+	if (localSearchWatcher->property("generation").toULongLong()!=searchGeneration)
+		return;
 
-		ui->completionLabel->setValues(matches);
-		ui->completionLabel->selectFirst();
+	ui->completionLabel->setValues(localSearchWatcher->result());
+	if (!simbadResults.isEmpty())
+		ui->completionLabel->appendValues(simbadResults.keys());
+	ui->completionLabel->selectFirst();
 
-		// Update push button enabled state
-		ui->pushButtonGotoSearchSkyObject->setEnabled(true);
+	// Update push button enabled state
+	ui->pushButtonGotoSearchSkyObject->setEnabled(true);
+}
+
+void SearchDialog::finishPendingSearch()
+{
+	if (searchTimer->isActive())
+	{
+		searchTimer->stop();
+		startSearch();
+	}
+	if (localSearchWatcher->isRunning())
+	{
+		localSearchWatcher->waitForFinished();
+		onLocalSearchFinished();
 	}
 }
 
@@ -686,6 +748,8 @@ void SearchDialog::greekLetterClicked()
 
 void SearchDialog::gotoObject()
 {
+	// The user may validate the text before the completion of the last keystrokes arrived
+	finishPendingSearch();
 	gotoObject(ui->completionLabel->getSelected());
 }
 
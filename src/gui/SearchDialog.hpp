@@ -24,6 +24,7 @@
 #include <QLabel>
 #include <QMap>
 #include <QHash>
+#include <QFutureWatcher>
 #include "StelDialog.hpp"
 #include "VecMath.hpp"
 
@@ -31,6 +32,8 @@
 class Ui_searchDialogForm;
 class QSortFilterProxyModel;
 class QStringListModel;
+class QTimer;
+class StelObjectMgr;
 
 struct stringLengthCompare
 {
@@ -139,6 +142,11 @@ private slots:
 	void onSimbadStatusChanged();
 	//! Called when the user changed the input text
 	void onSearchTextChanged(const QString& text);
+	//! Start the search of the objects matching pendingSearchText, once the user paused typing.
+	//! The local modules are searched in a worker thread, SIMBAD in parallel.
+	void startSearch();
+	//! Called when the search of the local modules is over. Shows its results if the text did not change meanwhile.
+	void onLocalSearchFinished();
 	
 	void gotoObject();
 	void gotoObject(const QString& nameI18n);
@@ -221,6 +229,18 @@ private:
 	class SimbadSearcher* simbadSearcher;
 	class SimbadLookupReply* simbadReply;
 	QMap<QString, Vec3d> simbadResults;
+
+	//! List the names of the objects of the local modules matching a text, shortest names first.
+	//! This is run in a worker thread, so it must not use the dialog.
+	static QStringList listLocalMatches(const StelObjectMgr* objectMgr, const QString& trimmedText, bool useStartOfWords);
+	//! Complete the search started by the last keystrokes now, e.g. when the user validates the text.
+	void finishPendingSearch();
+	//! Debounces the keystrokes before searching.
+	QTimer* searchTimer;
+	QFutureWatcher<QStringList>* localSearchWatcher;
+	//! Incremented when the text changes, so that the results of stale searches are dropped.
+	quint64 searchGeneration;
+	QString pendingSearchText;
 	class StelObjectMgr* objectMgr;
 	class QSettings* conf;
 	QStringListModel* listModel;
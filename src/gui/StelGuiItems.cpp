@@ -23,6 +23,7 @@
 
 #include "StelUtils.hpp"
 #include "SolarSystem.hpp"
+#include "LandscapeMgr.hpp"
 #include "StelGuiItems.hpp"
 #include "StelGui.hpp"
 #include "StelLocaleMgr.hpp"
@@ -842,7 +843,12 @@ void BottomStelBar::updateText(bool updatePos)
 		if (getFlagShowFps())
 		{
 			fps->setText(str);
-			fps->setToolTip(q_("Frames per second"));
+			// Each frame which reuses the atmosphere colors saves the time of their computation
+			const LandscapeMgr* lmgr = GETSTELMODULE(LandscapeMgr);
+			fps->setToolTip(QString("%1\n%2").arg(q_("Frames per second"),
+				q_("Atmosphere: %1% of the frames reused, %2 ms saved per reused frame")
+					.arg(qRound(100.f*lmgr->getAtmosphereReuseRatio()))
+					.arg(QString::number(lmgr->getAtmosphereComputeTime(), 'f', 2))));
 			if (qApp->property("text_texture")==true) // CLI option -t given?
 			{
 				fpsPixmap->setPixmap(getTextPixmap(str, fps->font()));
@@ -23,6 +23,12 @@
 #include "StelLogger.hpp"
 #include "StelFileMgr.hpp"
 #include "CLIProcessor.hpp"
+#include "StelBatchProcessor.hpp"
+#include "StelBenchmark.hpp"
+#include "StelSessionRecorder.hpp"
+#include "StelStartupTrace.hpp"
+#include "StelApp.hpp"
+#include "StelModuleMgr.hpp"
 #include "StelIniParser.hpp"
 #include "StelUtils.hpp"
 #ifndef DISABLE_SCRIPTING
@@ -134,6 +140,16 @@ public:
 // Main stellarium procedure
 int main(int argc, char **argv)
 {
+	// The startup trace covers the creation of the QApplication, the option is checked before.
+	for (int i=1; i<argc; ++i)
+	{
+		const QByteArray arg(argv[i]);
+		if (arg=="--")
+			break;
+		if (arg=="--startup-trace" || arg.startsWith("--startup-trace="))
+			StelStartupTrace::start(QString::fromLocal8Bit(arg.mid(16)));
+	}
+
     Q_INIT_RESOURCE(mainRes);
     Q_INIT_RESOURCE(guiRes);
 
@@ -170,6 +186,21 @@ int main(int argc, char **argv)
 
 	QGuiApplication::setDesktopSettingsAware(false);
 
+	// The batch mode must run on machines without display: the option is checked before the
+	// QApplication is created, so that the platform plugin doesn't need a window system.
+	bool batchMode = false;
+	for (int i=1; i<argc; ++i)
+	{
+		const QByteArray arg(argv[i]);
+		if (arg=="--")
+			break;
+		if (arg=="--batch" || arg.startsWith("--batch="))
+			batchMode = true;
+	}
+	if (batchMode && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+
+	StelStartupTrace::Scope appStep("startup", "QApplication");
 #ifndef USE_QUICKVIEW
 	QApplication::setStyle(QStyleFactory::create("Fusion"));
 	// The QApplication MUST be created before the StelFileMgr is initialized.
@@ -178,6 +209,7 @@ int main(int argc, char **argv)
 	QGuiApplication::setDesktopSettingsAware(false);
 	QGuiApplication app(argc, argv);
 #endif
+	appStep.end();
 
 	// QApplication sets current locale, but
 	// we need scanf()/printf() and friends to always work in the C locale,
@@ -188,13 +220,18 @@ int main(int argc, char **argv)
 	qputenv("QT_HARFBUZZ", "old");
 
 	// Init the file manager
+	StelStartupTrace::Scope fileMgrStep("startup", "StelFileMgr::init");
 	StelFileMgr::init();
+	fileMgrStep.end();
 
 	QPixmap pixmap(StelFileMgr::findFile("data/splash.png"));
 	SplashScreen splash(pixmap);
-	splash.show();
-	splash.showMessage(StelUtils::getApplicationVersion() , Qt::AlignLeft, Qt::white);
-	splash.ensureFirstPaint();
+	if (!batchMode)
+	{
+		splash.show();
+		splash.showMessage(StelUtils::getApplicationVersion() , Qt::AlignLeft, Qt::white);
+		splash.ensureFirstPaint();
+	}
 
 	// Log command line arguments.
 	QString argStr;
@@ -252,6 +289,7 @@ int main(int argc, char **argv)
 	}
 
 	// Now manage the loading of the proper config file
+	StelStartupTrace::Scope configStep("startup", "Configuration");
 	QString configName;
 	try
 	{
@@ -347,6 +385,7 @@ int main(int argc, char **argv)
 
 	// Override config file values from CLI.
 	CLIProcessor::parseCLIArgsPostConfig(argList, confSettings);
+	configStep.end();
 
 	// Support hi-dpi pixmaps
 	app.setAttribute(Qt::AA_UseHighDpiPixmaps, true);	
@@ -388,10 +427,62 @@ int main(int argc, char **argv)
 	CustomQTranslator trans;
 	app.installTranslator(&trans);
 
+	if (batchMode)
+	{
+		StelBatchProcessor batch(qApp->property("batch_file").toString(), qApp->property("batch_output").toString());
+		const int status = batch.exec(confSettings);
+		delete confSettings;
+		StelLogger::deinit();
+		#ifdef Q_OS_WIN
+		if(timerGrain)
+			timeEndPeriod(timerGrain);
+		#endif //Q_OS_WIN
+		return status;
+	}
+
+	const QString benchmarkFile = qApp->property("benchmark_file").toString();
+	if (!benchmarkFile.isEmpty() && !StelBenchmark::configure(benchmarkFile, confSettings))
+	{
+		delete confSettings;
+		StelLogger::deinit();
+		return 1;
+	}
+	const QString recordFile = qApp->property("record_session_file").toString();
+	const QString replayFile = qApp->property("replay_session_file").toString();
+	if (!replayFile.isEmpty() && !StelSessionRecorder::configureReplay(replayFile, confSettings))
+	{
+		delete confSettings;
+		StelLogger::deinit();
+		return 1;
+	}
+
+	StelStartupTrace::Scope mainViewStep("startup", "StelMainView");
 	StelMainView mainWin(confSettings);
+	mainViewStep.end();
+	if (!benchmarkFile.isEmpty())
+	{
+		// The scenes start once the plugins are loaded, StelModuleMgr deletes the module.
+		QObject::connect(&mainWin, &StelMainView::initialized, [benchmarkFile]()
+		{
+			StelBenchmark* benchmark = new StelBenchmark(benchmarkFile, qApp->property("benchmark_output").toString());
+			StelApp::getInstance().getModuleMgr().registerModule(benchmark, true);
+			benchmark->init();
+		});
+	}
+	if (!recordFile.isEmpty() || !replayFile.isEmpty())
+	{
+		QObject::connect(&mainWin, &StelMainView::initialized, [recordFile, replayFile]()
+		{
+			StelSessionRecorder* recorder = replayFile.isEmpty()
+					? new StelSessionRecorder(StelSessionRecorder::Record, recordFile)
+					: new StelSessionRecorder(StelSessionRecorder::Replay, replayFile, qApp->property("replay_output").toString());
+			StelApp::getInstance().getModuleMgr().registerModule(recorder, true);
+			recorder->init();
+		});
+	}
 	mainWin.show();
 	splash.finish(&mainWin);
-	app.exec();
+	const int status = app.exec();
 	mainWin.deinit();
 
 	delete confSettings;
@@ -402,6 +493,6 @@ int main(int argc, char **argv)
 		timeEndPeriod(timerGrain);
 	#endif //Q_OS_WIN
 
-	return 0;
+	return status;
 }
 
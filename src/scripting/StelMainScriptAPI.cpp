@@ -29,6 +29,8 @@
 #include "LandscapeMgr.hpp"
 #include "SporadicMeteorMgr.hpp"
 #include "NebulaMgr.hpp"
+#include "OccultationFinder.hpp"
+#include "PhenomenaFinder.hpp"
 #include "Planet.hpp"
 #include "SolarSystem.hpp"
 #include "StarMgr.hpp"
@@ -50,6 +52,7 @@
 #include "StelSkyCultureMgr.hpp"
 #include "StelSkyDrawer.hpp"
 #include "StelSkyLayerMgr.hpp"
+#include "StelTextureMgr.hpp"
 #include "StelUtils.hpp"
 #include "StelGuiBase.hpp"
 #include "MilkyWay.hpp"
@@ -100,6 +103,9 @@ StelMainScriptAPI::StelMainScriptAPI(QObject *parent) : QObject(parent)
 	connect(this, SIGNAL(requestSetVideoAlpha(const QString&, float)), StelApp::getInstance().getStelVideoMgr(), SLOT(setVideoAlpha(const QString&, float)));
 	connect(this, SIGNAL(requestResizeVideo(const QString&, float, float)), StelApp::getInstance().getStelVideoMgr(), SLOT(resizeVideo(const QString&, float, float)));
 	connect(this, SIGNAL(requestShowVideo(const QString&, bool)), StelApp::getInstance().getStelVideoMgr(), SLOT(showVideo(const QString&, bool)));
+	connect(this, SIGNAL(requestShowVideoOnSky(QString,double,double,double,double,double)), StelApp::getInstance().getStelVideoMgr(), SLOT(showVideoOnSky(QString,double,double,double,double,double)));
+	connect(this, SIGNAL(requestShowVideoOnDome(QString,double,double)), StelApp::getInstance().getStelVideoMgr(), SLOT(showVideoOnDome(QString,double,double)));
+	connect(this, SIGNAL(requestShowVideoOnScreen(QString)), StelApp::getInstance().getStelVideoMgr(), SLOT(showVideoOnScreen(QString)));
 
 	connect(this, SIGNAL(requestExit()), this->parent(), SLOT(stopScript()));
 	connect(this, SIGNAL(requestSetNightMode(bool)), &StelApp::getInstance(), SLOT(setVisionModeNight(bool)));
@@ -317,6 +323,21 @@ void StelMainScriptAPI::screenshot(const QString& prefix, bool invert, const QSt
 	StelMainView::getInstance().setFlagInvertScreenShotColors(oldInvertSetting);
 }
 
+void StelMainScriptAPI::startFrameSequence(const QString& prefix, const QString& dir, int width, int height, double fps)
+{
+	StelMainView::getInstance().startFrameSequence(dir, prefix, width, height, fps);
+}
+
+void StelMainScriptAPI::startFrameSequencePipe(const QString& command, int width, int height, double fps)
+{
+	StelMainView::getInstance().startFrameSequencePipe(command, width, height, fps);
+}
+
+void StelMainScriptAPI::stopFrameSequence()
+{
+	StelMainView::getInstance().stopFrameSequence();
+}
+
 void StelMainScriptAPI::setGuiVisible(bool b)
 {
 	StelApp::getInstance().getGui()->setVisible(b);
@@ -713,6 +734,21 @@ void StelMainScriptAPI::showVideo(const QString& id, bool show)
 	emit(requestShowVideo(id, show));
 }
 
+void StelMainScriptAPI::showVideoOnSky(const QString& id, double ra, double dec, double width, double height, double rotation)
+{
+	emit(requestShowVideoOnSky(id, ra, dec, width, height, rotation));
+}
+
+void StelMainScriptAPI::showVideoOnDome(const QString& id, double fov, double frontAzimuth)
+{
+	emit(requestShowVideoOnDome(id, fov, frontAzimuth));
+}
+
+void StelMainScriptAPI::showVideoOnScreen(const QString& id)
+{
+	emit(requestShowVideoOnScreen(id));
+}
+
 qint64 StelMainScriptAPI::getVideoDuration(const QString& id) const
 {
 	return StelApp::getInstance().getStelVideoMgr()->getVideoDuration(id);
@@ -775,6 +811,21 @@ QStringList StelMainScriptAPI::getPropertyList() const
 	return StelApp::getInstance().getStelPropertyManager()->getPropertyList();
 }
 
+QVariant StelMainScriptAPI::getPropertyValue(const QString& id) const
+{
+	return StelApp::getInstance().getStelPropertyManager()->getStelPropertyValue(id);
+}
+
+bool StelMainScriptAPI::setPropertyValue(const QString& id, const QVariant& value) const
+{
+	return StelApp::getInstance().getStelPropertyManager()->setStelPropertyValue(id, value);
+}
+
+QVariantList StelMainScriptAPI::getGLResidency() const
+{
+	return StelApp::getInstance().getTextureManager().getResidency();
+}
+
 void StelMainScriptAPI::debug(const QString& s)
 {
 	qDebug() << "script: " << s;
@@ -970,6 +1021,20 @@ QVariantMap StelMainScriptAPI::getSelectedObjectInfo() const
 	return StelObjectMgr::getObjectInfo(obj);
 }
 
+QVariantList StelMainScriptAPI::findPhenomena(const QString& object1, const QStringList& objects2, const QString& startDate, const QString& stopDate,
+					      double maxSeparation, bool opposition, const QString& spec) const
+{
+	return PhenomenaFinder::findPhenomena(object1, objects2, jdFromDateString(startDate, spec), jdFromDateString(stopDate, spec),
+					      maxSeparation, opposition);
+}
+
+QVariantList StelMainScriptAPI::findOccultations(const QString& startDate, const QString& stopDate, float maxMagnitude,
+						 bool withPlanets, bool withEclipses, const QString& spec) const
+{
+	return OccultationFinder::findEvents(jdFromDateString(startDate, spec), jdFromDateString(stopDate, spec),
+					     maxMagnitude, withPlanets, withEclipses);
+}
+
 void StelMainScriptAPI::clear(const QString& state)
 {
 	LandscapeMgr* lmgr = GETSTELMODULE(LandscapeMgr);
@@ -1300,6 +1365,11 @@ double StelMainScriptAPI::getViewDecJ2000Angle() const
 }
 
 void StelMainScriptAPI::moveToAltAzi(const QString& alt, const QString& azi, float duration)
+{
+	moveToAltAziRadians(StelUtils::getDecAngle(alt), StelUtils::getDecAngle(azi), duration);
+}
+
+void StelMainScriptAPI::moveToAltAziRadians(double alt, double azi, float duration)
 {
 	StelMovementMgr* mvmgr = GETSTELMODULE(StelMovementMgr);
 	Q_ASSERT(mvmgr);
@@ -1307,8 +1377,8 @@ void StelMainScriptAPI::moveToAltAzi(const QString& alt, const QString& azi, flo
 	GETSTELMODULE(StelObjectMgr)->unSelect();
 
 	Vec3d aim;
-	double dAlt = StelUtils::getDecAngle(alt);	
-	double dAzi = M_PI - StelUtils::getDecAngle(azi);
+	double dAlt = alt;
+	double dAzi = M_PI - azi;
 
 	if (StelApp::getInstance().getFlagSouthAzimuthUsage())
 		dAzi -= M_PI;
@@ -44,6 +44,9 @@ public:
 	StelMainScriptAPI(QObject *parent = Q_NULLPTR);
 	~StelMainScriptAPI();
 
+	//! Same as moveToAltAzi(), with the angles in radians.
+	void moveToAltAziRadians(double alt, double azi, float duration=1.);
+
 // These functions will be available in scripts
 public slots:
 	//! Set the current date as Julian Day number
@@ -64,6 +67,7 @@ public slots:
 	//! @param dateStr the date string to use.  Formats:
 	//! - ISO, e.g. "2008-03-24T13:21:01"
 	//! - "now" (set sim time to real time)
+	//! - a number, which is used as Julian Day
 	//! - relative, e.g. "+ 4 days", "-2 weeks".  can use these
 	//!   units: seconds, minutes, hours, days, weeks, months, years.
 	//!   You may also append " sidereal" to use sidereal days and so on.
@@ -210,6 +214,50 @@ public slots:
 	//! @return a map of object data.  See description for getObjectInfo(const QString& name);
 	QVariantMap getSelectedObjectInfo() const;
 
+	//! Find the conjunctions and oppositions of a solar system body with other objects, as seen from the current location.
+	//! The date of the simulation is not changed.
+	//! @param object1 the English name of the solar system body
+	//! @param objects2 the English names of the other objects. Stars and deep-sky objects are also accepted.
+	//! @param startDate, stopDate range of the search, in a format accepted by setDate()
+	//! @param maxSeparation the maximum angular separation in decimal degrees
+	//! @param opposition if true, also find oppositions with solar system bodies
+	//! @param spec "local" or "utc", see setDate()
+	//! @return a list of maps sorted by date.  Keys:
+	//! - object1, object2 : names of the objects
+	//! - jd : date of the closest approach (Julian Day, UT)
+	//! - separation : angular separation in decimal degrees
+	//! - type : conjunction, opposition, occultation, transit or eclipse
+	//! @code
+	//! list=core.findPhenomena("Moon", ["Venus", "Mars", "Regulus"], "2026-01-01T00:00:00", "2036-01-01T00:00:00", 1.0);
+	//! @endcode
+	QVariantList findPhenomena(const QString& object1, const QStringList& objects2, const QString& startDate, const QString& stopDate,
+				   double maxSeparation, bool opposition=false, const QString& spec="utc") const;
+
+	//! Find the lunar occultations of stars and planets, and the eclipses, at the current location.
+	//! This can take a while for ranges of several years.
+	//! @param startDate, stopDate range of the search, in a format accepted by setDate()
+	//! @param maxMagnitude the magnitude of the faintest occulted stars. No stars are searched if below -2.
+	//! @param withPlanets if true, also find the occultations of the major planets
+	//! @param withEclipses if true, also find the solar eclipses visible from the location and the lunar eclipses
+	//! @param spec "local" or "utc", see setDate()
+	//! @return a list of maps sorted by date.  Keys:
+	//! - type : occultation, solar-eclipse or lunar-eclipse
+	//! - coverage : partial, total, annular or penumbral
+	//! - object : name of the occulted object, Sun or Moon for eclipses
+	//! - object-magnitude : visual magnitude of the occulted star or planet
+	//! - jd : date of the greatest occultation or eclipse (Julian Day, UT)
+	//! - separation : smallest separation of the centers in decimal degrees, from the center of the shadow for lunar eclipses
+	//! - magnitude : magnitude of eclipses
+	//! - altitude-moon, altitude-sun : altitudes at the greatest phase in decimal degrees
+	//! - start, stop : disappearance and reappearance, first and last contacts, or penumbral phase (Julian Days, UT)
+	//! - partial-start, partial-stop : umbral phase of lunar eclipses
+	//! - total-start, total-stop : total or annular phase
+	//! @code
+	//! list=core.findOccultations("2026-01-01T00:00:00", "2046-01-01T00:00:00", 4.5);
+	//! @endcode
+	QVariantList findOccultations(const QString& startDate, const QString& stopDate, float maxMagnitude=6.0,
+				      bool withPlanets=true, bool withEclipses=true, const QString& spec="utc") const;
+
 	//! Clear the display options, setting a "standard" view.
 	//! Preset states:
 	//! - natural : azimuthal mount, atmosphere, landscape,
@@ -251,7 +299,7 @@ public slots:
 
 	//! move the current viewing direction to some specified altitude and azimuth.
 	//! The move will run in AltAz coordinates. This will look different from moveToRaDec() when timelapse is fast.
-	//! angles may be specified in a format recognised by StelUtils::getDecAngle()
+	//! angles may be specified in a format recognised by StelUtils::getDecAngle(), or as numbers of degrees
 	//! @param alt the altitude angle
 	//! @param azi the azimuth angle
 	//! @param duration the duration of the movement in seconds
@@ -335,6 +383,24 @@ public slots:
 	//! @param overwrite true to use exactly the prefix as filename (plus .png), and overwrite any existing file.
 	void screenshot(const QString& prefix, bool invert=false, const QString& dir="", const bool overwrite=false);
 
+	//! Save each drawn frame from now on in a numbered image file, until stopFrameSequence() is called,
+	//! e.g. for a video of a show. See StelMainView::startFrameSequence().
+	//! @param prefix the files are named prefix000000.png, prefix000001.png etc. Existing files are overwritten.
+	//! @param dir the path of the directory to save the frames in. If none is specified, the default screenshot
+	//! directory will be used.
+	//! @param width, height the size of the frames in pixels, by default the size of the window
+	//! @param fps if positive, the simulation advances by 1/fps seconds per frame, else in real time
+	void startFrameSequence(const QString& prefix="frame-", const QString& dir="", int width=0, int height=0, double fps=0.);
+	//! Send each drawn frame from now on to an external encoder, until stopFrameSequence() is called.
+	//! See StelMainView::startFrameSequencePipe().
+	//! @param command the encoder, which reads raw RGB frames on its standard input. {width}, {height} and {fps} are replaced
+	//! by the values of the frames, e.g. "ffmpeg -f rawvideo -pix_fmt rgb24 -s {width}x{height} -r {fps} -i - show.mp4"
+	//! @param width, height the size of the frames in pixels, by default the size of the window
+	//! @param fps the simulation advances by 1/fps seconds per frame
+	void startFrameSequencePipe(const QString& command, int width=0, int height=0, double fps=30.);
+	//! Stop the frame sequence, and wait until its frames are written.
+	void stopFrameSequence();
+
 	//! Show or hide the GUI (toolbars).  Note this only applies to GUI plugins which
 	//! provide the public slot "setGuiVisible(bool)".
 	//! @param b if true, show the GUI, if false, hide the GUI.
@@ -694,6 +760,25 @@ public slots:
 	//! @note You must call this if you called loadVideo() with its @param show=false, else video will be played hidden.
 	void showVideo(const QString& id, bool show=true);
 
+	//! Draw a video on the sky instead of the screen, centered on a J2000 position.
+	//! @param id the identifier used when loadVideo() was called
+	//! @param ra right ascension of the center of the video in degrees
+	//! @param dec declination of the center of the video in degrees
+	//! @param width angular width of the video in degrees
+	//! @param height angular height in degrees, or -1 to keep the aspect ratio of the video
+	//! @param rotation position angle of the top of the video in degrees
+	void showVideoOnSky(const QString& id, double ra, double dec, double width, double height=-1., double rotation=0.);
+
+	//! Draw a fulldome (fisheye) video over the sky, centered on the zenith.
+	//! @param id the identifier used when loadVideo() was called
+	//! @param fov field of view of the fisheye in degrees
+	//! @param frontAzimuth azimuth of the bottom of the frame in degrees
+	void showVideoOnDome(const QString& id, double fov=180., double frontAzimuth=180.);
+
+	//! Show a video on the screen again after showVideoOnSky() or showVideoOnDome().
+	//! @param id the identifier used when loadVideo() was called
+	void showVideoOnScreen(const QString& id);
+
 	//! Get the duration of a loaded video, or -1
 	//! @param id the identifier used when loadVideo() was called
 	qint64 getVideoDuration(const QString& id) const;
@@ -735,6 +820,26 @@ public slots:
 	//! Return a QStringlist of all available properties. Useful for script development...
 	QStringList getPropertyList() const;
 
+	//! Get the value of a property, e.g. core.getPropertyValue("LandscapeMgr.flagLandscapeDisplayed")
+	//! @param id the property ID, see getPropertyList()
+	//! @return the value, or undefined if there is no property with this ID
+	QVariant getPropertyValue(const QString& id) const;
+
+	//! Set the value of a property, e.g. core.setPropertyValue("LandscapeMgr.flagLandscapeDisplayed", false)
+	//! @param id the property ID, see getPropertyList()
+	//! @param value the new value, which is converted to the type of the property
+	//! @return false if there is no such property, or if it can not be set
+	bool setPropertyValue(const QString& id, const QVariant& value) const;
+
+	//! Get the textures and GL buffers in GPU memory, from the largest, to find which landscape, survey or planet
+	//! uses the most. See StelTextureMgr::getResidency() for the keys of the maps.
+	//! @code
+	//! list=core.getGLResidency();
+	//! for (i=0; i<10 && i<list.length; i++)
+	//!	core.debug(list[i].owner + " " + list[i].size + " " + list[i].name);
+	//! @endcode
+	QVariantList getGLResidency() const;
+
 	//! print a debugging message to the console
 	//! @param s the message to be displayed on the console.
 	static void debug(const QString& s);
@@ -881,6 +986,9 @@ signals:
 	void requestSetVideoAlpha(const QString& id, float alpha);
 	void requestResizeVideo(const QString& id, float w, float h);
 	void requestShowVideo(const QString& id, bool show);
+	void requestShowVideoOnSky(const QString& id, double ra, double dec, double width, double height, double rotation);
+	void requestShowVideoOnDome(const QString& id, double fov, double frontAzimuth);
+	void requestShowVideoOnScreen(const QString& id);
 	
 	void requestSetNightMode(bool b);
 	void requestSetProjectionMode(QString id);
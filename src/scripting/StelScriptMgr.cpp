@@ -21,6 +21,7 @@
 
 #include "StelScriptOutput.hpp"
 #include "StelScriptMgr.hpp"
+#include "StelScriptTimeline.hpp"
 #include "StelMainScriptAPI.hpp"
 #include "StelModuleMgr.hpp"
 #include "LabelMgr.hpp"
@@ -33,10 +34,13 @@
 #include "StelFileMgr.hpp"
 #include "StelModuleMgr.hpp"
 #include "StelMovementMgr.hpp"
+#include "StelPropertyMgr.hpp"
+#include "StelUtils.hpp"
 
 #include "StelSkyDrawer.hpp"
 #include "StelSkyLayerMgr.hpp"
 
+#include <QCryptographicHash>
 #include <QDateTime>
 #include <QDebug>
 #include <QDir>
@@ -76,6 +80,38 @@ QScriptValue createVec3f(QScriptContext* context, QScriptEngine *engine)
 	return vec3fToScriptValue(engine, c);
 }
 
+namespace
+{
+	//! Beyond that, the caches are emptied before adding an entry
+	const int MAX_CACHED_SCRIPTS = 64;
+	const int MAX_CACHED_DATES = 1024;
+
+	QByteArray hashFile(const QString& path)
+	{
+		QFile file(path);
+		if (!file.open(QIODevice::ReadOnly))
+			return QByteArray();
+		return QCryptographicHash::hash(file.readAll(), QCryptographicHash::Sha1);
+	}
+}
+
+struct StelScriptMgr::CachedScript
+{
+	//! The SHA-1 of the script file and of its includes, the entry is used while they are unchanged.
+	QList<QPair<QString, QByteArray> > fileHashes;
+	QScriptProgram program;
+
+	bool isUpToDate() const
+	{
+		for (const auto& file : fileHashes)
+		{
+			if (hashFile(file.first)!=file.second)
+				return false;
+		}
+		return true;
+	}
+};
+
 class StelScriptEngineAgent : public QScriptEngineAgent
 {
 public:
@@ -109,7 +145,13 @@ StelScriptMgr::StelScriptMgr(QObject *parent): QObject(parent)
 
 	// Add the core object to access methods related to core
 	mainAPI = new StelMainScriptAPI(this);
+	// The functions which are called most often in loops replace the slots of the same name by native functions
 	QScriptValue objectValue = engine->newQObject(mainAPI);
+	objectValue.setProperty("wait", engine->newFunction(coreWait, this));
+	objectValue.setProperty("setDate", engine->newFunction(coreSetDate, this));
+	objectValue.setProperty("moveToAltAzi", engine->newFunction(coreMoveToAltAzi, this));
+	objectValue.setProperty("getPropertyValue", engine->newFunction(coreGetPropertyValue, this));
+	objectValue.setProperty("setPropertyValue", engine->newFunction(coreSetPropertyValue, this));
 	engine->globalObject().setProperty("core", objectValue);
 
 	// Add other classes which we want to be directly accessible from scripts
@@ -119,6 +161,12 @@ StelScriptMgr::StelScriptMgr(QObject *parent): QObject(parent)
 	// For accessing star scale, twinkle etc.
 	objectValue = engine->newQObject(StelApp::getInstance().getCore()->getSkyDrawer());
 	engine->globalObject().setProperty("StelSkyDrawer", objectValue);
+
+	// Cues of scripted shows
+	timeline = new StelScriptTimeline(engine, this);
+	connect(timeline, SIGNAL(scriptDebug(QString)), this, SIGNAL(scriptDebug(QString)));
+	connect(timeline, SIGNAL(finished()), this, SLOT(scriptEnded()));
+	engine->globalObject().setProperty("Timeline", engine->newQObject(timeline));
 	
 	setScriptRate(1.0);
 	
@@ -178,7 +226,7 @@ QStringList StelScriptMgr::getScriptList() const
 
 bool StelScriptMgr::scriptIsRunning() const
 {
-	return engine->isEvaluating();
+	return engine->isEvaluating() || timeline->isActive();
 }
 
 QString StelScriptMgr::runningScriptId() const
@@ -334,7 +382,12 @@ QString StelScriptMgr::getDescription(const QString& s) const
 
 bool StelScriptMgr::runPreprocessedScript(const QString &preprocessedScript, const QString& scriptId)
 {
-	if (engine->isEvaluating())
+	return runProgram(QScriptProgram(preprocessedScript), scriptId);
+}
+
+bool StelScriptMgr::runProgram(const QScriptProgram& program, const QString& scriptId)
+{
+	if (scriptIsRunning())
 	{
 		QString msg = QString("ERROR: there is already a script running, please wait until it's over.");
 		emit(scriptDebug(msg));
@@ -353,18 +406,45 @@ bool StelScriptMgr::runPreprocessedScript(const QString &preprocessedScript, con
 	emit(scriptRunning());
 	emit runningScriptIdChanged(scriptId);
 
+	// Initialize the plugins used by the script, if they are loaded on demand
+	StelApp::getInstance().getModuleMgr().activatePluginsUsedBy(program.sourceCode());
+
 	// run that script
-	engine->evaluate(preprocessedScript);
-	scriptEnded();
+	timeline->clear();
+	engine->evaluate(program);
+	// A script which queued cues runs until the timeline is finished
+	if (engine->hasUncaughtException())
+		timeline->clear();
+	if (!timeline->isActive())
+		scriptEnded();
 	return true;
 }
 
 // Run the script located at the given location
 bool StelScriptMgr::runScript(const QString& fileName, const QString& includePath)
 {
-	QString preprocessedScript;
-	prepareScript(preprocessedScript,fileName,includePath);
-	return runPreprocessedScript(preprocessedScript,fileName);
+	// The preprocessed and compiled script is reused while neither the script nor its includes change.
+	const QString key = findScriptFile(fileName) + '\n' + includePath;
+	QSharedPointer<CachedScript> script = scriptCache.value(key);
+	if (!script || !script->isUpToDate())
+	{
+		QString preprocessedScript;
+		QStringList files;
+		if (!prepareScript(preprocessedScript,fileName,includePath,&files))
+		{
+			scriptCache.remove(key);
+			return runPreprocessedScript(preprocessedScript,fileName);
+		}
+
+		script = QSharedPointer<CachedScript>::create();
+		for (const auto& file : files)
+			script->fileHashes.append(qMakePair(file, hashFile(file)));
+		script->program = QScriptProgram(preprocessedScript, fileName);
+		if (scriptCache.size()>=MAX_CACHED_SCRIPTS)
+			scriptCache.clear();
+		scriptCache.insert(key, script);
+	}
+	return runProgram(script->program,fileName);
 }
 
 bool StelScriptMgr::runScriptDirect(const QString &scriptCode, const QString& includePath)
@@ -385,14 +465,16 @@ bool StelScriptMgr::runScriptDirect(const QString &scriptCode, const QString& in
 	}
 }
 
-bool StelScriptMgr::prepareScript(QString &script, const QString &fileName, const QString &includePath)
+QString StelScriptMgr::findScriptFile(const QString& fileName) const
 {
-	QString absPath;
-
 	if (QFileInfo(fileName).isAbsolute())
-		absPath = fileName;
-	else
-		absPath = StelFileMgr::findFile("scripts/" + fileName);
+		return fileName;
+	return StelFileMgr::findFile("scripts/" + fileName);
+}
+
+bool StelScriptMgr::prepareScript(QString &script, const QString &fileName, const QString &includePath, QStringList* files)
+{
+	QString absPath = findScriptFile(fileName);
 
 	if (absPath.isEmpty())
 	{
@@ -416,9 +498,12 @@ bool StelScriptMgr::prepareScript(QString &script, const QString &fileName, cons
 	if (!includePath.isEmpty())
 		scriptDir = includePath;
 
+	if (files)
+		files->append(absPath);
+
 	bool ok = false;
 	if (fileName.endsWith(".ssc"))
-		ok = preprocessScript(fic, script, scriptDir);
+		ok = preprocessScript(fic, script, scriptDir, files);
 	if (!ok)
 	{
 		return false;
@@ -429,7 +514,7 @@ bool StelScriptMgr::prepareScript(QString &script, const QString &fileName, cons
 
 void StelScriptMgr::stopScript()
 {
-	if (engine->isEvaluating())
+	if (scriptIsRunning())
 	{
 		GETSTELMODULE(LabelMgr)->deleteAllLabels();
 		GETSTELMODULE(ScreenImageMgr)->deleteAllImages();
@@ -439,7 +524,9 @@ void StelScriptMgr::stopScript()
 		QString msg = QString("INFO: asking running script to exit");
 		emit(scriptDebug(msg));
 		//qDebug() << msg;
-		engine->abortEvaluation();
+		timeline->clear();
+		if (engine->isEvaluating())
+			engine->abortEvaluation();
 	}
 	scriptEnded();
 }
@@ -469,10 +556,17 @@ void StelScriptMgr::setScriptRate(float r)
 
 void StelScriptMgr::pauseScript() {
 	agent->setPauseScript(true);
+	timeline->setPaused(true);
 }
 
 void StelScriptMgr::resumeScript() {
 	agent->setPauseScript(false);
+	timeline->setPaused(false);
+}
+
+void StelScriptMgr::update(double deltaTime)
+{
+	timeline->update(deltaTime, getScriptRate());
 }
 
 double StelScriptMgr::getScriptRate() const
@@ -537,7 +631,7 @@ bool StelScriptMgr::strToBool(const QString& str)
 	return QVariant(str).toBool();
 }
 
-bool StelScriptMgr::preprocessScript(const QString &input, QString &output, const QString &scriptDir)
+bool StelScriptMgr::preprocessScript(const QString &input, QString &output, const QString &scriptDir, QStringList* includes)
 {
 	QStringList lines = input.split("\n", QString::SkipEmptyParts);
 	QRegExp includeRe("^include\\s*\\(\\s*\"([^\"]+)\"\\s*\\)\\s*;\\s*(//.*)?$");
@@ -577,7 +671,9 @@ bool StelScriptMgr::preprocessScript(const QString &input, QString &output, cons
 			if (ok)
 			{
 				qDebug() << "script include: " << QDir::toNativeSeparators(path);
-				preprocessScript(fic, output, scriptDir);
+				if (includes)
+					includes->append(path);
+				preprocessScript(fic, output, scriptDir, includes);
 			}
 			else
 			{
@@ -608,10 +704,105 @@ bool StelScriptMgr::preprocessScript(const QString &input, QString &output, cons
 }
 
 
-bool StelScriptMgr::preprocessScript(QFile &input, QString& output, const QString& scriptDir)
+bool StelScriptMgr::preprocessScript(QFile &input, QString& output, const QString& scriptDir, QStringList* includes)
 {
 	QString s = QString::fromUtf8(input.readAll());
-	return preprocessScript(s, output, scriptDir);
+	return preprocessScript(s, output, scriptDir, includes);
+}
+
+QScriptValue StelScriptMgr::coreWait(QScriptContext* context, QScriptEngine* engine, void* mgr)
+{
+	static_cast<StelScriptMgr*>(mgr)->mainAPI->wait(context->argument(0).toNumber());
+	return engine->undefinedValue();
+}
+
+QScriptValue StelScriptMgr::coreSetDate(QScriptContext* context, QScriptEngine* engine, void* mgr)
+{
+	StelScriptMgr* scriptMgr = static_cast<StelScriptMgr*>(mgr);
+	const QScriptValue date = context->argument(0);
+	const QString spec = context->argumentCount()>1 ? context->argument(1).toString() : QStringLiteral("utc");
+	const bool dateIsDT = context->argumentCount()>2 && context->argument(2).toBool();
+
+	double jd = 0.;
+	if (date.isNumber())
+		jd = date.toNumber();
+	else
+	{
+		const QString dateStr = date.toString();
+		// Only the absolute UTC dates always give the same JD, the other ones are handled by setDate().
+		auto it = scriptMgr->dateCache.constFind(dateStr);
+		if (spec!="local" && it!=scriptMgr->dateCache.constEnd())
+			jd = it.value();
+		else
+		{
+			bool ok = false;
+			if (spec!="local")
+				jd = StelUtils::getJulianDayFromISO8601String(dateStr, &ok);
+			if (!ok)
+			{
+				scriptMgr->mainAPI->setDate(dateStr, spec, dateIsDT);
+				return engine->undefinedValue();
+			}
+			if (scriptMgr->dateCache.size()>=MAX_CACHED_DATES)
+				scriptMgr->dateCache.clear();
+			scriptMgr->dateCache.insert(dateStr, jd);
+		}
+	}
+
+	StelCore* core = StelApp::getInstance().getCore();
+	if (dateIsDT)
+		core->setJDE(jd);
+	else
+		core->setJD(jd);
+	return engine->undefinedValue();
+}
+
+QScriptValue StelScriptMgr::coreMoveToAltAzi(QScriptContext* context, QScriptEngine* engine, void* mgr)
+{
+	StelMainScriptAPI* api = static_cast<StelScriptMgr*>(mgr)->mainAPI;
+	const QScriptValue alt = context->argument(0);
+	const QScriptValue azi = context->argument(1);
+	const float duration = context->argumentCount()>2 ? context->argument(2).toNumber() : 1.f;
+	if (alt.isNumber() && azi.isNumber())
+		api->moveToAltAziRadians(alt.toNumber()*M_PI/180., azi.toNumber()*M_PI/180., duration);
+	else
+		api->moveToAltAzi(alt.toString(), azi.toString(), duration);
+	return engine->undefinedValue();
+}
+
+QScriptValue StelScriptMgr::coreGetPropertyValue(QScriptContext* context, QScriptEngine* engine, void*)
+{
+	const StelProperty* prop = StelApp::getInstance().getStelPropertyManager()->getProperty(context->argument(0).toString());
+	if (!prop)
+		return engine->undefinedValue();
+
+	const QVariant value = prop->getValue();
+	switch (static_cast<QMetaType::Type>(value.type()))
+	{
+		case QMetaType::Bool:
+			return QScriptValue(value.toBool());
+		case QMetaType::Int:
+			return QScriptValue(value.toInt());
+		case QMetaType::Float:
+		case QMetaType::Double:
+			return QScriptValue(value.toDouble());
+		default:
+			return engine->toScriptValue(value);
+	}
+}
+
+QScriptValue StelScriptMgr::coreSetPropertyValue(QScriptContext* context, QScriptEngine*, void*)
+{
+	const StelProperty* prop = StelApp::getInstance().getStelPropertyManager()->getProperty(context->argument(0).toString());
+	if (!prop)
+		return QScriptValue(false);
+
+	const QScriptValue value = context->argument(1);
+	if (value.isBool())
+		return QScriptValue(prop->setValue(value.toBool()));
+	if (value.isNumber())
+		return QScriptValue(prop->setValue(value.toNumber()));
+	return QScriptValue(prop->setValue(value.toVariant()));
 }
 
 StelScriptEngineAgent::StelScriptEngineAgent(QScriptEngine *engine) 
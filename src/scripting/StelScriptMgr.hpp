@@ -21,6 +21,8 @@
 #define STELSCRIPTMGR_HPP
 
 #include <QObject>
+#include <QHash>
+#include <QSharedPointer>
 #include <QStringList>
 #include <QFile>
 #include <QTime>
@@ -28,7 +30,11 @@
 
 class StelMainScriptAPI;
 class StelScriptEngineAgent;
+class StelScriptTimeline;
+class QScriptContext;
 class QScriptEngine;
+class QScriptProgram;
+class QScriptValue;
 
 #ifdef ENABLE_SCRIPT_CONSOLE
 class ScriptConsole;
@@ -52,7 +58,7 @@ public:
 	QStringList getScriptList() const;
 
 	//! Find out if a script is running
-	//! @return true if a script is running, else false
+	//! @return true if a script is running or has cues in its timeline, else false
 	bool scriptIsRunning() const;
 	//! Get the ID (usually filename) of the currently running script
 	//! @return Empty string if no script is running, else the 
@@ -64,8 +70,9 @@ public:
 	//! if the command line option --verbose has been given,
 	//! this dumps the preprocessed script with line numbers attached to log.
 	//! This helps to understand the line number given by the usual error message.
-	bool preprocessScript(const QString& input, QString& output, const QString& scriptDir);
-	bool preprocessScript(QFile &input, QString& output, const QString& scriptDir);
+	//! @param includes if not null, the paths of the included files are appended to it
+	bool preprocessScript(const QString& input, QString& output, const QString& scriptDir, QStringList* includes=Q_NULLPTR);
+	bool preprocessScript(QFile &input, QString& output, const QString& scriptDir, QStringList* includes=Q_NULLPTR);
 	
 	//! Add all the StelModules into the script engine
 	void addModules();
@@ -163,8 +170,9 @@ public slots:
 	//! script file itself, but if you're running a generated script from
 	//! a temp directory, but want to include a file from elsewhere, it
 	//! can be usetul to set it to something else (e.g. in ScriptConsole).
+	//! @param files if not null, returns the paths of the script file and of the files it includes
 	//! @return false if the named script could not be prepared, true otherwise
-	bool prepareScript(QString& script, const QString& fileName, const QString& includePath="");
+	bool prepareScript(QString& script, const QString& fileName, const QString& includePath="", QStringList* files=Q_NULLPTR);
 
 	//! Stops any running script.
 	//! @return false if no script was running, true otherwise.
@@ -204,6 +212,13 @@ public slots:
 	//! Resume a paused script.
 	void resumeScript();
 
+	//! Run the cues of the script timeline whose time is reached, called by StelApp::update().
+	//! @param deltaTime the time increment in seconds since the last call
+	void update(double deltaTime);
+
+	//! Get the timeline of the scripts, e.g. to read the run time of its cues.
+	const StelScriptTimeline* getTimeline() const {return timeline;}
+
 private slots:
 	//! Called at the end of the running threa
 	void scriptEnded();
@@ -235,6 +250,31 @@ private:
 	//! @return the text following the id and : on a comment line near the top of 
 	//! the script file (i.e. before there is a non-comment line).
 	QString getHeaderSingleLineCommentText(const QString& s, const QString& id, const QString& notFoundText="") const;
+
+	//! Get the absolute path of a script file, or an empty string if it does not exist.
+	QString findScriptFile(const QString& fileName) const;
+
+	//! Run a compiled script, see runPreprocessedScript().
+	bool runProgram(const QScriptProgram& program, const QString& scriptId);
+
+	//! @name Native implementations of the most frequently called functions of the core object.
+	//! They call StelMainScriptAPI directly, without the conversion of the arguments to QVariant,
+	//! and skip the parsing of dates and angles given as numbers. The argument is the StelScriptMgr.
+	//! @{
+	static QScriptValue coreWait(QScriptContext* context, QScriptEngine* engine, void* mgr);
+	static QScriptValue coreSetDate(QScriptContext* context, QScriptEngine* engine, void* mgr);
+	static QScriptValue coreMoveToAltAzi(QScriptContext* context, QScriptEngine* engine, void* mgr);
+	static QScriptValue coreGetPropertyValue(QScriptContext* context, QScriptEngine* engine, void* mgr);
+	static QScriptValue coreSetPropertyValue(QScriptContext* context, QScriptEngine* engine, void* mgr);
+	//! @}
+
+	//! A script file which was preprocessed and compiled by runScript().
+	struct CachedScript;
+	//! Cached scripts, by absolute path and include path
+	QHash<QString, QSharedPointer<CachedScript> > scriptCache;
+	//! Julian Days of the absolute UTC dates given to core.setDate(), by date string
+	QHash<QString, double> dateCache;
+
 	QScriptEngine* engine;
 	
 	//! The thread in which scripts are run
@@ -244,6 +284,9 @@ private:
 	
 	//Script engine agent
 	StelScriptEngineAgent *agent;
+
+	//! The cues queued by the running script, available as Timeline in scripts
+	StelScriptTimeline *timeline;
 };
 
 #endif // STELSCRIPTMGR_HPP
@@ -0,0 +1,111 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelScriptTimeline.hpp"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QScriptEngine>
+
+StelScriptTimeline::StelScriptTimeline(QScriptEngine* engine, QObject* parent)
+	: QObject(parent)
+	, engine(engine)
+	, nextCueIndex(0)
+	, time(0.)
+	, paused(false)
+	, updating(false)
+	, clearCount(0)
+	, frames(0)
+	, lastFrameCpuTime(0.)
+	, maxFrameCpuTime(0.)
+	, totalCpuTime(0.)
+{
+}
+
+void StelScriptTimeline::at(double cueTime, const QScriptValue& action)
+{
+	if (!action.isFunction())
+	{
+		emit scriptDebug(QString("WARNING: Timeline.at(%1): the cue is not a function").arg(cueTime));
+		return;
+	}
+	cues.insert(qMakePair(cueTime, nextCueIndex++), action);
+}
+
+void StelScriptTimeline::after(double delay, const QScriptValue& action)
+{
+	at(time + delay, action);
+}
+
+void StelScriptTimeline::clear()
+{
+	cues.clear();
+	nextCueIndex = 0;
+	time = 0.;
+	paused = false;
+	frames = 0;
+	lastFrameCpuTime = 0.;
+	maxFrameCpuTime = 0.;
+	totalCpuTime = 0.;
+	++clearCount;
+}
+
+void StelScriptTimeline::update(double deltaTime, double rate)
+{
+	if (cues.isEmpty() || paused || updating)
+		return;
+
+	updating = true;
+	const int clearCountBefore = clearCount;
+	time += deltaTime * rate;
+	QElapsedTimer timer;
+	timer.start();
+	// The cues may queue other cues, which run in this frame if their time is reached too.
+	while (!cues.isEmpty() && cues.firstKey().first <= time)
+	{
+		QScriptValue action = cues.take(cues.firstKey());
+		action.call();
+		if (engine->hasUncaughtException())
+		{
+			QString msg = QString("script error in timeline cue: \"%1\" @ line %2")
+					.arg(engine->uncaughtException().toString()).arg(engine->uncaughtExceptionLineNumber());
+			emit scriptDebug(msg);
+			qWarning() << msg;
+			engine->clearExceptions();
+		}
+		// The cue may have stopped the script
+		if (clearCount!=clearCountBefore)
+		{
+			updating = false;
+			return;
+		}
+	}
+	lastFrameCpuTime = timer.nsecsElapsed() / 1.e6;
+	maxFrameCpuTime = qMax(maxFrameCpuTime, lastFrameCpuTime);
+	totalCpuTime += lastFrameCpuTime;
+	++frames;
+	updating = false;
+
+	if (cues.isEmpty())
+	{
+		qDebug() << "Script timeline finished after" << time << "s, cue time per frame:"
+			 << getAverageFrameCpuTime() << "ms average," << maxFrameCpuTime << "ms max";
+		emit finished();
+	}
+}
@@ -0,0 +1,112 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STELSCRIPTTIMELINE_HPP
+#define STELSCRIPTTIMELINE_HPP
+
+#include <QMap>
+#include <QObject>
+#include <QPair>
+#include <QScriptValue>
+
+class QScriptEngine;
+
+//! @class StelScriptTimeline
+//! Cues of a scripted show, which are run by StelApp::update() on the frame where their time is reached.
+//! Contrary to core.wait(), the timing does not depend on the polling of the script engine, and no script
+//! code runs between the frames: the script only queues the cues, and each cue runs once, within a frame.
+//! A script which queued cues is running until the last cue ran, or until it is stopped.
+//! The timeline is available in scripts as the Timeline object, e.g.
+//! @code
+//! Timeline.at(0, function() { core.setDate("2026-08-12T22:00:00"); });
+//! Timeline.at(2.5, function() { LandscapeMgr.setFlagAtmosphere(false); });
+//! Timeline.at(10, function() { core.moveToAltAzi(45, 90, 3); });
+//! @endcode
+//! The cues should not call core.wait(), which would block the rendering.
+class StelScriptTimeline : public QObject
+{
+	Q_OBJECT
+	Q_PROPERTY(double time READ getTime)
+	Q_PROPERTY(int cueCount READ getCueCount)
+
+public:
+	StelScriptTimeline(QScriptEngine* engine, QObject* parent=Q_NULLPTR);
+
+	//! Advance the timeline and run the cues whose time is reached.
+	//! @param deltaTime the real time since the last call, in seconds
+	//! @param rate the script rate, at which the timeline runs
+	void update(double deltaTime, double rate);
+
+	//! True while there are queued cues.
+	bool isActive() const {return !cues.isEmpty();}
+	void setPaused(bool b) {paused=b;}
+
+	//! @name Run time of the cues, in milliseconds
+	//! @{
+	//! Time spent in the cues during the last frame
+	double getLastFrameCpuTime() const {return lastFrameCpuTime;}
+	//! Longest time spent in the cues during one frame, since the first cue was queued
+	double getMaxFrameCpuTime() const {return maxFrameCpuTime;}
+	//! Average time spent in the cues per frame, since the first cue was queued
+	double getAverageFrameCpuTime() const {return frames>0 ? totalCpuTime/frames : 0.;}
+	//! @}
+
+public slots:
+	//! Queue a cue.
+	//! @param time the time of the cue in seconds since the end of the script, scaled by the script rate.
+	//! Cues with the same time run in the order in which they were queued.
+	//! @param action the function to call
+	void at(double time, const QScriptValue& action);
+
+	//! Queue a cue relative to the current time of the timeline, e.g. from another cue.
+	void after(double delay, const QScriptValue& action);
+
+	//! Remove all cues, and reset the time and the run time statistics.
+	void clear();
+
+	//! Time since the end of the script, in seconds
+	double getTime() const {return time;}
+	//! Number of queued cues
+	int getCueCount() const {return cues.size();}
+
+signals:
+	//! Emitted after the last cue ran.
+	void finished();
+	//! Notification of errors in the cues.
+	void scriptDebug(const QString&) const;
+
+private:
+	QScriptEngine* engine;
+	//! The cues by time and by order of queuing
+	QMap<QPair<double, quint64>, QScriptValue> cues;
+	quint64 nextCueIndex;
+	double time;
+	bool paused;
+	//! Prevents running the cues from a nested event loop, e.g. when the engine processes events
+	bool updating;
+	//! Number of calls to clear()
+	int clearCount;
+
+	qint64 frames;
+	double lastFrameCpuTime;
+	double maxFrameCpuTime;
+	double totalCpuTime;
+};
+
+#endif // STELSCRIPTTIMELINE_HPP
@@ -119,6 +119,51 @@ void TestConversions::testRadToHMS()
 	}
 }
 
+void TestConversions::testRadToHMSStr()
+{
+	QVariantList data;
+
+	data << 0. << false << "   0h00m00.0s";
+	data << M_PI/36 << false << "   0h20m00.0s";
+	data << 7*M_PI/8 << false << "  10h30m00.0s";
+	data << 2*M_PI/5 << true << "    4h48m00.00s";
+	data << 2*M_PI-M_PI/1296000 << false << "   0h00m00.0s";
+
+	while (data.count()>=3)
+	{
+		const double rad = data.takeFirst().toDouble();
+		const bool decimal = data.takeFirst().toBool();
+		const QString expected = data.takeFirst().toString();
+		QCOMPARE(StelUtils::radToHmsStr(rad, decimal), expected);
+		QChar buffer[StelUtils::FORMAT_BUFFER_LENGTH];
+		QCOMPARE(QString(buffer, StelUtils::formatRadToHms(buffer, rad, decimal)), expected);
+	}
+}
+
+void TestConversions::testRadToDMSStr()
+{
+	QVariantList data;
+	const QString deg = QChar(0x00B0);
+
+	data << M_PI/6 << false << false << QString("+30" + deg + "00'00\"");
+	data << M_PI/6 << true << false << QString("+30" + deg + "00'00.0\"");
+	data << M_PI/4 << false << true << QString("+45d00'00\"");
+	data << 1213*M_PI/2400 << false << false << QString("+90" + deg + "58'30\"");
+	data << -7*M_PI/8 << false << false << QString("-157" + deg + "30'00\"");
+	data << -10*M_PI/648 << true << true << QString("-2d46'40.0\"");
+
+	while (data.count()>=4)
+	{
+		const double rad = data.takeFirst().toDouble();
+		const bool decimal = data.takeFirst().toBool();
+		const bool useD = data.takeFirst().toBool();
+		const QString expected = data.takeFirst().toString();
+		QCOMPARE(StelUtils::radToDmsStr(rad, decimal, useD), expected);
+		QChar buffer[StelUtils::FORMAT_BUFFER_LENGTH];
+		QCOMPARE(QString(buffer, StelUtils::formatRadToDms(buffer, rad, decimal, useD)), expected);
+	}
+}
+
 void TestConversions::testRadToDMS()
 {
 	QVariantList data;
@@ -211,3 +256,22 @@ void TestConversions::testDDToDMS()
 		QVERIFY2(qAbs(angle1-angle2)<=ERROR_LIMIT, qPrintable(QString("%1degrees=%2%3d%4m%5s").arg(angle).arg(s).arg(dego).arg(mino).arg(seco)));
 	}
 }
+
+void TestConversions::testDecAngleFromVariant()
+{
+	// Numbers are degrees, strings are parsed like getDecAngle()
+	QVariantList data;
+	data << 10.5 << 10.5;
+	data << -41 << -41.;
+	data << QString("-41") << -41.;
+	data << QString("2h10m15s") << 32.5625;
+	data << QString("+60d01m15s") << 60.020833333;
+
+	while (data.count()>=2)
+	{
+		const QVariant value = data.takeFirst();
+		const double expected = data.takeFirst().toDouble()*M_PI/180.;
+		const double angle = StelUtils::getDecAngleFromVariant(value);
+		QVERIFY2(qAbs(angle-expected)<=1e-8, qPrintable(QString("%1 -> %2 radians, expected %3").arg(value.toString()).arg(angle).arg(expected)));
+	}
+}
@@ -31,7 +31,10 @@ private slots:
 	void testDMSToRad();
 	void testRadToHMS();
 	void testRadToDMS();
+	void testRadToHMSStr();
+	void testRadToDMSStr();
 	void testDDToDMS();
+	void testDecAngleFromVariant();
 };
 
 #endif // _TESTCONVERSIONS_HPP
@@ -26,6 +26,7 @@
 #include <QtGlobal>
 
 #include "StelUtils.hpp"
+#include "StelDeltaTCache.hpp"
 
 QTEST_GUILESS_MAIN(TestDeltaT)
 
@@ -337,3 +338,28 @@ void TestDeltaT::testDeltaTByStephensonMorrison1984WideDates()
 							.toUtf8());
 	}
 }
+
+void TestDeltaT::testDeltaTCache()
+{
+	// Sweep through the changes of polynomials of the Espenak & Meeus model in 1900, 1920 and 1941.
+	StelDeltaTCache cache;
+	double startJD, endJD;
+	StelUtils::getJDFromDate(&startJD, 1899, 6, 1, 0, 0, 0);
+	StelUtils::getJDFromDate(&endJD, 1942, 6, 1, 0, 0, 0);
+	for (double JD=startJD; JD<endJD; JD+=0.37)
+	{
+		double expectedResult = StelUtils::getDeltaTByEspenakMeeus(JD);
+		double result = cache.getDeltaT(JD, StelUtils::getDeltaTByEspenakMeeus);
+		QVERIFY2(qAbs(result-expectedResult)<=1e-3, QString("JD=%1 result=%2 expected=%3")
+							.arg(JD, 0, 'f', 5)
+							.arg(result, 0, 'f', 6)
+							.arg(expectedResult, 0, 'f', 6)
+							.toUtf8());
+	}
+
+	// A step function is not interpolated across the step.
+	cache.clear();
+	auto step = [](double JD) { return JD<2451545.3 ? 10. : 20.; };
+	for (double JD=2451540.; JD<2451550.; JD+=0.1)
+		QCOMPARE(cache.getDeltaT(JD, step), step(JD));
+}
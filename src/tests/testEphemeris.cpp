@@ -27,8 +27,10 @@
 #include "StelFileMgr.hpp"
 #include "EphemWrapper.hpp"
 #include "vsop87.h"
+#include "elp82b.h"
 #include "de430.hpp"
 #include "de431.hpp"
+#include "Orbit.hpp"
 
 QTEST_GUILESS_MAIN(TestEphemeris)
 
@@ -1771,3 +1773,78 @@ void TestEphemeris::testNeptuneHeliocentricEphemerisDe431()
 	}
 }
 
+void TestEphemeris::testKeplerOrbitBatch()
+{
+	// Elements of Ceres, of a high eccentricity asteroid and of comet 1P/Halley
+	EllipticalOrbit ceres(2.5577, 0.0758, 10.594*M_PI/180., 80.305*M_PI/180., 73.597*M_PI/180., 95.989*M_PI/180., 1681.63, 2458600.5, 0., 0., 0.);
+	EllipticalOrbit eccentric(0.2, 0.95, 30.*M_PI/180., 150.*M_PI/180., 250.*M_PI/180., 10.*M_PI/180., 1604., 2451545.0, 0., 0., 0.);
+	CometOrbit halley(0.586, 0.967, 162.26*M_PI/180., 58.42*M_PI/180., 111.33*M_PI/180., 2446467.4, 1e6, 0.01720209895*std::sqrt(1./(17.834*17.834*17.834)), 0., 0., 0.);
+
+	KeplerOrbitBatch batch;
+	QVERIFY(batch.add(&ceres)==0);
+	QVERIFY(batch.add(&eccentric)==1);
+	QVERIFY(batch.add(&halley)==2);
+	QCOMPARE(batch.size(), 3);
+
+	// EllipticalOrbit stops after 5 iterations for low eccentricities
+	const double acceptableError = 1E-06;
+	for (double jde=2440000.5; jde<2470000.5; jde+=333.3)
+	{
+		const int indices[3] = { 0, 1, 2 };
+		const double dates[3] = { jde, jde, jde };
+		Vec3d positions[3], velocities[3];
+		batch.computePositions(indices, dates, 3, positions, velocities);
+
+		double xyz[3][3], xyzdot[3][3];
+		ceres.positionAtTimevInVSOP87Coordinates(jde, xyz[0], xyzdot[0]);
+		eccentric.positionAtTimevInVSOP87Coordinates(jde, xyz[1], xyzdot[1]);
+		halley.positionAtTimevInVSOP87Coordinates(jde, xyz[2], true);
+		halley.getVelocity(xyzdot[2]);
+		for (int i=0; i<3; ++i)
+		{
+			const double actualError = (positions[i]-Vec3d(xyz[i][0], xyz[i][1], xyz[i][2])).length();
+			QVERIFY2(actualError <= acceptableError, QString("orbit=%1 jde=%2 error=%3").arg(i).arg(QString::number(jde, 'f', 2)).arg(actualError).toUtf8());
+			const double velocityError = (velocities[i]-Vec3d(xyzdot[i][0], xyzdot[i][1], xyzdot[i][2])).length();
+			QVERIFY2(velocityError <= acceptableError, QString("orbit=%1 jde=%2 velocity error=%3").arg(i).arg(QString::number(jde, 'f', 2)).arg(velocityError).toUtf8());
+		}
+	}
+}
+
+void TestEphemeris::benchmarkVsop87()
+{
+	double jd = 2451545.0;
+	double xyz[6];
+	QBENCHMARK {
+		jd += 1.1;
+		GetVsop87Coor(jd, 2, xyz); // Earth-Moon barycenter
+	}
+	QVERIFY(qAbs(Vec3d(xyz[0], xyz[1], xyz[2]).length()-1.) < 0.02);
+}
+
+void TestEphemeris::benchmarkElp82b()
+{
+	double jd = 2451545.0;
+	double xyz[3];
+	QBENCHMARK {
+		jd += 0.1;
+		GetElp82bCoor(jd, xyz);
+	}
+	// The distance of the Moon, in AU
+	const double distance = Vec3d(xyz[0], xyz[1], xyz[2]).length();
+	QVERIFY(distance > 0.0023 && distance < 0.0028);
+}
+
+void TestEphemeris::benchmarkDe431()
+{
+	if (de431FilePath.isEmpty())
+		QSKIP("DE431 ephemeris file is not found");
+
+	InitDE431(de431FilePath.toLocal8Bit().constData());
+	double jd = 2451545.0;
+	double xyz[6];
+	QBENCHMARK {
+		jd += 1.1;
+		GetDe431Coor(jd, 2, xyz, CENTRAL_BODY_ID); // Earth-Moon barycenter
+	}
+	QVERIFY(qAbs(Vec3d(xyz[0], xyz[1], xyz[2]).length()-1.) < 0.02);
+}
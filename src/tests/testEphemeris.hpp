@@ -57,6 +57,14 @@ private slots:
 	void testUranusHeliocentricEphemerisDe431();
 	void testNeptuneHeliocentricEphemerisDe431();
 
+	// Keplerian orbits
+	void testKeplerOrbitBatch();
+
+	// Benchmarks of the evaluation, at a new date on each iteration so that no cached result is used
+	void benchmarkVsop87();
+	void benchmarkElp82b();
+	void benchmarkDe431();
+
 private:
 	QString de430FilePath, de431FilePath;
 	QVariantList mercury, venus, mars, jupiter, saturn, uranus, neptune;
@@ -0,0 +1,394 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testEphemerisRegression.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QPair>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QtGlobal>
+
+#include <cmath>
+
+#include "StelFileMgr.hpp"
+#include "vsop87.h"
+#include "elp82b.h"
+#include "pluto.h"
+#include "l12.h"
+#include "tass17.h"
+#include "gust86.h"
+#include "marssat.h"
+#include "de430.hpp"
+#include "de431.hpp"
+
+QTEST_GUILESS_MAIN(TestEphemerisRegression)
+
+#define CENTRAL_BODY_ID 11  //ID of sun in JPL enumeration
+#define JPL_EARTH_ID 3
+#define JPL_MOON_ID 10
+
+namespace
+{
+	//! A theory and the dates of its reference file
+	struct Theory
+	{
+		const char* name;
+		const char* description;
+		int bodies;
+		double start, end, step;	// JDE
+		//! Largest error of a position, relative to the distance to the central body
+		double acceptableError;
+	};
+
+	const Theory theories[] =
+	{
+		{ "vsop87", "VSOP87 heliocentric positions of Mercury to Neptune (body 2 is the Earth-Moon barycenter), ecliptic J2000",
+		  8, 625673.5, 2816787.5, 18262.5, 1E-11 },
+		{ "elp82b", "ELP82B geocentric positions of the Moon, ecliptic J2000",
+		  1, 625673.5, 2816787.5, 18262.5, 1E-11 },
+		{ "pluto", "Heliocentric positions of Pluto of the Meeus theory (1885-2099), ecliptic J2000",
+		  1, 2409000.5, 2487000.5, 730.5, 1E-11 },
+		{ "l12", "L1.2 jovicentric positions of Io, Europa, Ganymede and Callisto",
+		  4, 2268923.5, 2634166.5, 7305.37, 1E-11 },
+		{ "tass17", "TASS1.7 saturnicentric positions of Mimas, Enceladus, Tethys, Dione, Rhea, Titan, Iapetus (6) and Hyperion (7)",
+		  8, 2268923.5, 2634166.5, 7305.37, 1E-11 },
+		{ "gust86", "GUST86 uranocentric positions of Miranda, Ariel, Umbriel, Titania and Oberon",
+		  5, 2268923.5, 2634166.5, 7305.37, 1E-11 },
+		{ "marssat", "Areocentric positions of Phobos and Deimos",
+		  2, 2268923.5, 2634166.5, 7305.37, 1E-11 },
+		{ "de430", "DE430 heliocentric positions of Mercury to Pluto (body 2 is the Earth) and geocentric positions of the Moon (9), as given by GetDe430Coor()",
+		  10, 2287200.5, 2688900.5, 3652.5, 1E-11 },
+		{ "de431", "DE431 heliocentric positions of Mercury to Pluto (body 2 is the Earth) and geocentric positions of the Moon (9), as given by GetDe431Coor()",
+		  10, 625673.5, 2816787.5, 18262.5, 1E-11 },
+		{ "kepler", "Heliocentric positions of the Keplerian orbits of TestEphemerisRegression, ecliptic J2000",
+		  8, 2440000.5, 2470000.5, 250., 1E-10 }
+	};
+
+	const Theory* findTheory(const QString& name)
+	{
+		for (const auto& theory : theories)
+		{
+			if (name==theory.name)
+				return &theory;
+		}
+		return Q_NULLPTR;
+	}
+
+	//! Elements of the Keplerian orbits, angles in degrees
+	struct KeplerElements
+	{
+		const char* name;
+		double q, e, i, Om, w, t0;
+	};
+
+	const KeplerElements keplerElements[] =
+	{
+		{ "Ceres", 2.5577, 0.0758, 10.594, 80.305, 73.597, 2458238.5 },
+		{ "Pallas", 2.1334, 0.2302, 34.836, 173.080, 310.048, 2458320.5 },
+		{ "Vesta", 2.1520, 0.0887, 7.142, 103.851, 151.199, 2458255.5 },
+		{ "1P/Halley", 0.586, 0.967, 162.26, 58.42, 111.33, 2446467.4 },
+		{ "2P/Encke", 0.3360, 0.8483, 11.78, 334.57, 186.55, 2456618.5 },
+		{ "C/1995 O1 (Hale-Bopp)", 0.9141, 0.9951, 89.43, 282.47, 130.59, 2450539.6 },
+		{ "1I/'Oumuamua", 0.2556, 1.2011, 122.74, 24.60, 241.70, 2458006.0 },
+		{ "parabolic", 1.0, 1.0, 45.0, 100.0, 50.0, 2451545.0 }
+	};
+
+	//! Same mean motion as SolarSystem::loadPlanets(); for a parabolic orbit, this is Heafner's W/dt
+	double meanMotion(double q, double e)
+	{
+		if (e==1.)
+			return 0.01720209895 * (1.5/q) * std::sqrt(0.5/q);
+		const double a = std::fabs(q/(1.-e));
+		return 0.01720209895 / (a*std::sqrt(a));
+	}
+}
+
+void TestEphemerisRegression::initTestCase()
+{
+	#ifndef Q_OS_WIN
+	// Same as TestEphemeris: without an installation, no DE file can be found on Windows.
+	StelFileMgr::init();
+	#endif
+
+	de430FilePath = StelFileMgr::findFile("ephem/" + QString(DE430_FILENAME), StelFileMgr::File);
+	de431FilePath = StelFileMgr::findFile("ephem/" + QString(DE431_FILENAME), StelFileMgr::File);
+	if (!de430FilePath.isEmpty())
+		InitDE430(QDir::toNativeSeparators(de430FilePath).toLocal8Bit().constData());
+	if (!de431FilePath.isEmpty())
+		InitDE431(QDir::toNativeSeparators(de431FilePath).toLocal8Bit().constData());
+
+	for (const auto& el : keplerElements)
+	{
+		CometOrbit* orbit = new CometOrbit(el.q, el.e, el.i*M_PI/180., el.Om*M_PI/180., el.w*M_PI/180., el.t0, 1e6,
+						   meanMotion(el.q, el.e), 0., 0., 0.);
+		keplerOrbits.append(orbit);
+		keplerBatchIndices.append(keplerBatch.add(orbit));
+	}
+}
+
+void TestEphemerisRegression::cleanupTestCase()
+{
+	keplerBatch.clear();
+	keplerBatchIndices.clear();
+	qDeleteAll(keplerOrbits);
+	keplerOrbits.clear();
+}
+
+bool TestEphemerisRegression::computePosition(const QString& theory, int body, double jde, double* xyz) const
+{
+	double xyz6[6], xyzdot[3];
+	if (theory=="vsop87")
+		GetVsop87Coor(jde, body, xyz6);
+	else if (theory=="elp82b")
+		GetElp82bCoor(jde, xyz6);
+	else if (theory=="pluto")
+		get_pluto_helio_coords(jde, &xyz6[0], &xyz6[1], &xyz6[2]);
+	else if (theory=="l12")
+		GetL12Coor(jde, body, xyz6, xyzdot);
+	else if (theory=="tass17")
+		GetTass17Coor(jde, body, xyz6, xyzdot);
+	else if (theory=="gust86")
+		GetGust86Coor(jde, body, xyz6, xyzdot);
+	else if (theory=="marssat")
+		GetMarsSatCoor(jde, body, xyz6, xyzdot);
+	else if (theory=="de430" || theory=="de431")
+	{
+		const int target = body<9 ? body+1 : JPL_MOON_ID;
+		const int center = body<9 ? CENTRAL_BODY_ID : JPL_EARTH_ID;
+		const bool ok = theory=="de430" ? GetDe430Coor(jde, target, xyz6, center) : GetDe431Coor(jde, target, xyz6, center);
+		if (!ok)
+			return false;
+	}
+	else if (theory=="kepler")
+		keplerOrbits.at(body)->stateAtTimeInVSOP87Coordinates(jde, xyz6, xyzdot);
+	else if (theory=="kepler batch")
+	{
+		const int index = keplerBatchIndices.at(body);
+		if (index<0)
+			return false;
+		Vec3d position, velocity;
+		keplerBatch.computePositions(&index, &jde, 1, &position, &velocity, false);
+		xyz6[0] = position[0];
+		xyz6[1] = position[1];
+		xyz6[2] = position[2];
+	}
+	else
+		return false;
+	xyz[0] = xyz6[0];
+	xyz[1] = xyz6[1];
+	xyz[2] = xyz6[2];
+	return true;
+}
+
+void TestEphemerisRegression::writeReference(const QString& theory, const QString& directory) const
+{
+	const Theory* t = findTheory(theory);
+	QVERIFY(t!=Q_NULLPTR);
+	QFile file(QDir(directory).filePath(theory + ".csv"));
+	QVERIFY2(file.open(QIODevice::WriteOnly | QIODevice::Text), qPrintable(file.fileName()));
+	QTextStream out(&file);
+	out << "# " << t->description << "\n# body,jde,x,y,z [AU]\n";
+	double xyz[3];
+	for (double jde=t->start; jde<=t->end; jde+=t->step)
+	{
+		for (int body=0; body<t->bodies; ++body)
+		{
+			QVERIFY2(computePosition(theory, body, jde, xyz), qPrintable(QString("jde=%1 body=%2").arg(jde, 0, 'f', 6).arg(body)));
+			out << body << ',' << QString::number(jde, 'f', 6) << ','
+			    << QString::number(xyz[0], 'g', 17) << ',' << QString::number(xyz[1], 'g', 17) << ','
+			    << QString::number(xyz[2], 'g', 17) << '\n';
+		}
+	}
+	out.flush();
+	QVERIFY(file.error()==QFileDevice::NoError);
+	qDebug() << "Written" << QDir::toNativeSeparators(file.fileName());
+}
+
+void TestEphemerisRegression::testReference_data()
+{
+	QTest::addColumn<QString>("theory");
+	QTest::addColumn<QString>("reference");
+
+	for (const auto& theory : theories)
+		QTest::newRow(theory.name) << QString(theory.name) << QString(theory.name);
+	// Same reference, through the path used by SolarSystem for the elliptical orbits
+	QTest::newRow("kepler batch") << QString("kepler batch") << QString("kepler");
+}
+
+void TestEphemerisRegression::testReference()
+{
+	QFETCH(QString, theory);
+	QFETCH(QString, reference);
+
+	if ((theory=="de430" && de430FilePath.isEmpty()) || (theory=="de431" && de431FilePath.isEmpty()))
+		QSKIP("The DE ephemeris file is not found");
+
+	const QString outputDirectory = QString::fromLocal8Bit(qgetenv("STEL_EPHEMERIS_REFERENCE_OUTPUT"));
+	if (!outputDirectory.isEmpty())
+	{
+		if (theory!=reference)
+			QSKIP("Same reference as another theory");
+		writeReference(theory, outputDirectory);
+		return;
+	}
+
+	const QString fileName = QFINDTESTDATA("ephemeris/" + reference + ".csv");
+	if (fileName.isEmpty())
+		QSKIP("No reference file, see STEL_EPHEMERIS_REFERENCE_OUTPUT");
+	QFile file(fileName);
+	QVERIFY2(file.open(QIODevice::ReadOnly | QIODevice::Text), qPrintable(fileName));
+
+	const double acceptableError = findTheory(reference)->acceptableError;
+	double maxError = 0.;
+	int count = 0;
+	QTextStream in(&file);
+	while (!in.atEnd())
+	{
+		const QString line = in.readLine();
+		if (line.isEmpty() || line.startsWith('#'))
+			continue;
+		const QStringList fields = line.split(',');
+		QVERIFY2(fields.size()==5, qPrintable(line));
+		const int body = fields.at(0).toInt();
+		const double jde = fields.at(1).toDouble();
+		const Vec3d expected(fields.at(2).toDouble(), fields.at(3).toDouble(), fields.at(4).toDouble());
+		double xyz[3];
+		if (!computePosition(theory, body, jde, xyz))
+		{
+			// Hyperbolic and parabolic orbits are not in the batch
+			QVERIFY2(theory=="kepler batch", qPrintable(line));
+			continue;
+		}
+		const double actualError = (Vec3d(xyz[0], xyz[1], xyz[2])-expected).length()/expected.length();
+		maxError = qMax(maxError, actualError);
+		QVERIFY2(actualError <= acceptableError,
+			 QString("body=%1 jde=%2 x=%3 (%6) y=%4 (%7) z=%5 (%8) relative error=%9")
+			 .arg(body)
+			 .arg(QString::number(jde, 'f', 6))
+			 .arg(QString::number(xyz[0], 'g', 17))
+			 .arg(QString::number(xyz[1], 'g', 17))
+			 .arg(QString::number(xyz[2], 'g', 17))
+			 .arg(QString::number(expected[0], 'g', 17))
+			 .arg(QString::number(expected[1], 'g', 17))
+			 .arg(QString::number(expected[2], 'g', 17))
+			 .arg(actualError)
+			 .toUtf8());
+		++count;
+	}
+	QVERIFY(count>0);
+	qDebug() << theory << ":" << count << "positions, largest relative error" << maxError;
+}
+
+void TestEphemerisRegression::benchmarkThroughput_data()
+{
+	QTest::addColumn<QString>("theory");
+	QTest::addColumn<int>("threads");
+
+	for (const auto& theory : theories)
+		QTest::newRow(theory.name) << QString(theory.name) << 1;
+	QList<int> threadCounts;
+	threadCounts << 1 << 2 << 4;
+	if (!threadCounts.contains(QThread::idealThreadCount()))
+		threadCounts << QThread::idealThreadCount();
+	for (int threads : threadCounts)
+		QTest::newRow(qPrintable(QString("kepler batch, %1 threads").arg(threads))) << QString("kepler batch") << threads;
+}
+
+void TestEphemerisRegression::benchmarkThroughput()
+{
+	QFETCH(QString, theory);
+	QFETCH(int, threads);
+
+	if ((theory=="de430" && de430FilePath.isEmpty()) || (theory=="de431" && de431FilePath.isEmpty()))
+		QSKIP("The DE ephemeris file is not found");
+
+	// Measured for at least this time, at new dates so that no cached result is used
+	const qint64 duration = 200; // [ms]
+	qint64 count = 0;
+	QElapsedTimer timer;
+	if (theory!="kepler batch")
+	{
+		const Theory* t = findTheory(theory);
+		double xyz[3];
+		double jde = t->start;
+		timer.start();
+		do
+		{
+			for (int k=0; k<1000; ++k)
+			{
+				jde += 1.1;
+				if (jde>t->end)
+					jde = t->start;
+				for (int body=0; body<t->bodies; ++body)
+					QVERIFY(computePosition(theory, body, jde, xyz));
+				count += t->bodies;
+			}
+		} while (timer.elapsed()<duration);
+	}
+	else
+	{
+		// A batch of the size of a large minor body catalogue, each orbit computed at its own date, split into
+		// one chunk per thread as in SolarSystem::computePositions()
+		KeplerOrbitBatch batch;
+		QVector<int> indices;
+		QVector<double> dates;
+		for (int copy=0; copy<2000; ++copy)
+		{
+			for (int body=0; body<keplerOrbits.size(); ++body)
+			{
+				const int index = batch.add(keplerOrbits.at(body));
+				if (index<0)
+					continue;
+				indices.append(index);
+				dates.append(2451545.0 + copy*1.1);
+			}
+		}
+		QVector<Vec3d> positions(indices.size()), velocities(indices.size());
+		QList<QPair<int, int> > chunks;
+		const int chunkSize = (indices.size()+threads-1)/threads;
+		for (int start=0; start<indices.size(); start+=chunkSize)
+			chunks.append(qMakePair(start, qMin(chunkSize, indices.size()-start)));
+
+		QThreadPool* pool = QThreadPool::globalInstance();
+		const int maxThreads = pool->maxThreadCount();
+		pool->setMaxThreadCount(threads);
+		timer.start();
+		do
+		{
+			QtConcurrent::blockingMap(chunks, [&](const QPair<int, int>& chunk) {
+				batch.computePositions(indices.constData()+chunk.first, dates.constData()+chunk.first, chunk.second,
+						       positions.data()+chunk.first, velocities.data()+chunk.first, false);
+			});
+			for (auto& jde : dates)
+				jde += 1.1;
+			count += indices.size();
+		} while (timer.elapsed()<duration);
+		pool->setMaxThreadCount(maxThreads);
+		QVERIFY(positions.last().length()>0.);
+	}
+	const double rate = count*1000./qMax(Q_INT64_C(1), timer.elapsed());
+	qDebug() << theory << "with" << threads << "threads:" << qRound64(rate) << "positions/s";
+}
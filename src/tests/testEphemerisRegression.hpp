@@ -0,0 +1,69 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef TESTEPHEMERISREGRESSION_HPP
+#define TESTEPHEMERISREGRESSION_HPP
+
+#include "Orbit.hpp"
+
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTest>
+#include <QVector>
+
+//! Compares the positions of each ephemeris theory over long time spans with the reference files of
+//! tests/ephemeris, and measures the number of positions per second of each theory.
+//! The reference files have one line "body,jde,x,y,z" per position, in AU. They are written again by the tests
+//! when the environment variable STEL_EPHEMERIS_REFERENCE_OUTPUT is the directory where to write them, e.g. after
+//! an intended change of a theory, or to create the references of DE430 and DE431 where their files are installed.
+//! The reference of the Keplerian orbits was computed independently of Stellarium, by solving Kepler's and
+//! Barker's equations to machine precision.
+class TestEphemerisRegression : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void initTestCase();
+	void cleanupTestCase();
+
+	void testReference_data();
+	void testReference();
+
+	//! Positions per second of each theory, from one thread, and of the Keplerian batch from several threads.
+	//! The other theories use static caches and can not be computed concurrently.
+	void benchmarkThroughput_data();
+	void benchmarkThroughput();
+
+private:
+	//! Compute a position of a theory, see theories in the .cpp file.
+	//! @param theory including "kepler batch", which computes the elliptical Keplerian orbits with KeplerOrbitBatch
+	//! @return false if the theory has no such body, or the ephemeris file is out of its range
+	bool computePosition(const QString& theory, int body, double jde, double* xyz) const;
+	//! Write the reference file of a theory to the directory of STEL_EPHEMERIS_REFERENCE_OUTPUT.
+	void writeReference(const QString& theory, const QString& directory) const;
+
+	QString de430FilePath, de431FilePath;
+	QList<CometOrbit*> keplerOrbits;
+	//! The elliptical orbits of keplerOrbits, and the index of each orbit in the batch, or -1
+	KeplerOrbitBatch keplerBatch;
+	QVector<int> keplerBatchIndices;
+};
+
+#endif // TESTEPHEMERISREGRESSION_HPP
@@ -43,3 +43,28 @@ void TestExtinction::testBase()
 	extCls.forward(vert, &mag);
 	QVERIFY(mag==2.25);
 }
+
+void TestExtinction::testTableAirmass()
+{
+	Extinction extCls;
+	for (float cosZ=-0.035f; cosZ<=1.f; cosZ+=0.001f)
+	{
+		const float exact = extCls.airmass(cosZ, false);
+		const float table = extCls.geometricAirmass(cosZ);
+		QVERIFY2(qAbs(exact-table) <= 1e-3f*exact, QString("cosZ=%1 exact=%2 table=%3").arg(cosZ).arg(exact).arg(table).toUtf8());
+	}
+
+	QVector<Vec3f> pos;
+	pos << Vec3f(0.f, 0.f, 1.f) << Vec3f(1.f, 0.f, 0.f) << Vec3f(0.f, 0.f, -1.f);
+	QVector<float> mags(pos.size(), 1.f);
+	extCls.setExtinctionCoefficient(0.2f);
+	extCls.setUndergroundExtinctionMode(Extinction::UndergroundExtinctionMax);
+	extCls.forward(pos.constData(), mags.data(), pos.size());
+	for (int i=0; i<pos.size(); ++i)
+	{
+		float mag = 1.f;
+		extCls.forward(pos.at(i), &mag);
+		QCOMPARE(mags.at(i), mag);
+	}
+	QCOMPARE(mags.at(2), 1.f+42.f*0.2f);
+}
@@ -30,6 +30,7 @@ class TestExtinction : public QObject
 private slots:
 	void initTestCase();
 	void testBase();	
+	void testTableAirmass();
 };
 
 #endif // _TESTEXTINCTION_HPP
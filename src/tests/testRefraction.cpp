@@ -196,3 +196,55 @@ void TestRefraction::testComplexRefraction()
 							.toUtf8());
 	}
 }
+
+void TestRefraction::testTableRefraction()
+{
+	Refraction refCls;
+	refCls.setPressure(1010);
+	refCls.setTemperature(10);
+	// arcseconds
+	double acceptableError = 0.5;
+
+	// The single precision versions interpolate in tables, which must stay close to the exact computations
+	for (double height=-6.; height<=90.; height+=0.25)
+	{
+		const double h = height * M_PI/180.;
+		double lng, latD, latF;
+		Vec3d vd;
+		StelUtils::spheToRect(0.0, h, vd);
+		Vec3f vf(vd[0], vd[1], vd[2]);
+		refCls.forward(vd);
+		refCls.forward(vf);
+		StelUtils::rectToSphe(&lng, &latD, vd);
+		StelUtils::rectToSphe(&lng, &latF, Vec3d(vf[0], vf[1], vf[2]));
+		double error = qAbs(latD-latF)*180./M_PI*3600.;
+		QVERIFY2(error <= acceptableError, QString("forward height=%1deg error=%2\" acceptable=%3")
+							.arg(height).arg(error).arg(acceptableError).toUtf8());
+
+		StelUtils::spheToRect(0.0, h, vd);
+		vf.set(vd[0], vd[1], vd[2]);
+		refCls.backward(vd);
+		refCls.backward(vf);
+		StelUtils::rectToSphe(&lng, &latD, vd);
+		StelUtils::rectToSphe(&lng, &latF, Vec3d(vf[0], vf[1], vf[2]));
+		error = qAbs(latD-latF)*180./M_PI*3600.;
+		QVERIFY2(error <= acceptableError, QString("backward height=%1deg error=%2\" acceptable=%3")
+							.arg(height).arg(error).arg(acceptableError).toUtf8());
+	}
+
+	// The batch version must give the same results as forward()
+	QVector<Vec3f> batch;
+	for (int i=0; i<100; ++i)
+	{
+		Vec3d v;
+		StelUtils::spheToRect(i*0.1, (i-10)*M_PI/180., v);
+		batch << Vec3f(v[0], v[1], v[2]);
+	}
+	QVector<Vec3f> single = batch;
+	refCls.forwardBatch(batch.data(), batch.size());
+	for (int i=0; i<single.size(); ++i)
+	{
+		refCls.forward(single[i]);
+		QVERIFY((single.at(i)-batch.at(i)).length() < 1e-6f);
+	}
+}
@@ -32,6 +32,7 @@ private slots:
 	void testSaemundssonEquation();
 	void testBennettEquation();
 	void testComplexRefraction();
+	void testTableRefraction();
 };
 
 #endif // _TESTREFRACTION_HPP
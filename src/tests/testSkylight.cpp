@@ -0,0 +1,68 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "tests/testSkylight.hpp"
+
+#include <QDebug>
+#include <QTest>
+
+#include "StelUtils.hpp"
+
+QTEST_GUILESS_MAIN(TestSkylight)
+
+void TestSkylight::initTestCase()
+{
+	for (int i=0; i<64; ++i)
+	{
+		for (int j=0; j<16; ++j)
+		{
+			Vec3d v;
+			StelUtils::spheToRect(2.*M_PI*i/64., 0.5*M_PI*(j+0.5)/16., v);
+			skylightStruct2 p;
+			p.pos[0] = v[0];
+			p.pos[1] = v[1];
+			p.pos[2] = v[2];
+			points << p;
+		}
+	}
+	// The Sun 30 degrees above the horizon, in a clear sky
+	Vec3d sunPos;
+	StelUtils::spheToRect(0.3, 30.*M_PI/180., sunPos);
+	const float sun[3] = { static_cast<float>(sunPos[0]), static_cast<float>(sunPos[1]), static_cast<float>(sunPos[2]) };
+	sky.setParamsv(sun, 5.f);
+}
+
+void TestSkylight::testChromaticity()
+{
+	for (auto p : points)
+	{
+		sky.getxyYValuev(p);
+		QVERIFY2(p.color[0]>0.f && p.color[1]>0.f && p.color[0]+p.color[1]<1.f,
+			 qPrintable(QString("pos=[%1, %2, %3] x=%4 y=%5").arg(p.pos[0]).arg(p.pos[1]).arg(p.pos[2]).arg(p.color[0]).arg(p.color[1])));
+	}
+}
+
+void TestSkylight::benchmarkGetxyYValuev()
+{
+	QBENCHMARK {
+		for (auto& p : points)
+			sky.getxyYValuev(p);
+	}
+}
@@ -286,3 +286,27 @@ void TestStelFileMgr::testListContentsDirAbs()
 	QVERIFY(resultSetQuery==resultSetQueryExpected);
 }
 
+
+void TestStelFileMgr::testIndexInvalidation()
+{
+	QVERIFY(StelFileMgr::findFile("landscapes/added.txt").isEmpty());
+	QVERIFY(StelFileMgr::findFile("landscapes/added", StelFileMgr::Directory).isEmpty());
+
+	// The search directories are listed once, a file added directly is found after the index is invalidated
+	QFile f(partialPath2+"/landscapes/added.txt");
+	QVERIFY(f.open(QIODevice::WriteOnly));
+	f.close();
+	QVERIFY(StelFileMgr::findFile("landscapes/added.txt").isEmpty());
+	StelFileMgr::invalidateIndex();
+	QVERIFY(!StelFileMgr::findFile("landscapes/added.txt", StelFileMgr::File).isEmpty());
+	QVERIFY(StelFileMgr::listContents("landscapes", StelFileMgr::File).contains("added.txt"));
+
+	// The directories made through StelFileMgr are found at once
+	QVERIFY(StelFileMgr::mkDir(workingDir + "/" + partialPath2 + "/landscapes/added"));
+	QVERIFY(!StelFileMgr::findFile("landscapes/added", StelFileMgr::Directory).isEmpty());
+
+	QVERIFY(QFile::remove(partialPath2+"/landscapes/added.txt"));
+	QVERIFY(QDir().rmdir(partialPath2+"/landscapes/added"));
+	StelFileMgr::invalidateIndex();
+	QVERIFY(StelFileMgr::findFile("landscapes/added.txt").isEmpty());
+}
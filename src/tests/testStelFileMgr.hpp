@@ -48,6 +48,7 @@ private slots:
 	void testListContentsFileAbs();
 	void testListContentsDir();
 	void testListContentsDirAbs();
+	void testIndexInvalidation();
 
 private:
 	QTemporaryDir tempDir;
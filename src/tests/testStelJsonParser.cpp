@@ -26,6 +26,7 @@
 #include <stdexcept>
 
 #include "StelJsonParser.hpp"
+#include "StelJsonCatalog.hpp"
 
 
 QTEST_GUILESS_MAIN(TestStelJsonParser);
@@ -45,6 +46,18 @@ void TestStelJsonParser::initTestCase()
  \"test11\": {\"worldCoords\": [[[-0.5,0.5],[0.5,0.5],[0.5,-0.5],[-0.5,-0.5]], [[-0.2,-0.2],[0.2,-0.2],[0.2,0.2],[-0.2,0.2]]]}, \
  \"test12\": {\"worldCoords\": [[[-0.5,0.5],[0.5,0.5],[0.5,-0.5],[-0.5,-0.5]], [[-0.2,-0.2],[0.2,-0.2],[0.2,0.2],[-0.2,0.2]]]}}";
 
+	catalogJsonBuff = "{\"version\": 1, \"shortName\": \"generated catalog\", \"stars\": {";
+	for (int i=0; i<5000; ++i)
+	{
+		if (i>0)
+			catalogJsonBuff += ",\n";
+		catalogJsonBuff += QString("\"HD %1\": {\"RA\": \"%2\", \"DE\": \"%3\", \"distance\": %4, \"stype\": \"G2V\", \"smetal\": -0.12, "
+					   "\"exoplanets\": [{\"planetName\": \"b\", \"mass\": %5, \"period\": %6, \"semiAxis\": 0.05, \"eccentricity\": 0.01, \"detectionMethod\": \"Radial Velocity\"}, "
+					   "{\"planetName\": \"c\", \"mass\": 0.5, \"period\": 210.3, \"semiAxis\": 1.2, \"eccentricity\": 0.3, \"detectionMethod\": \"Transit\"}]}")
+				.arg(i).arg(i*0.072, 0, 'f', 6).arg(i*0.02-50., 0, 'f', 6).arg(10.+i*0.01).arg(1.+i*0.001).arg(3.5+i*0.01).toUtf8();
+	}
+	catalogJsonBuff += "}}";
+
 	listJsonBuff = "[{\"project\":\"GOODS\",\"license\":\"ESO Data License : http://www.myLicenseToBeDefinedAtSomePoint.html\",\"copyright\":\"(c) GOODS Sep 10 2007 12:00AM\",\"creator\":\"C. Cesarsky\",\"dataType\":\"image\",\"characterization\":{\"spatialAxis\":{\"footprint\":{\"worldCoords\":[[[53.111991,-27.725812],[53.164780,-27.725812],[53.164780,-27.772234],[53.111991,-27.772234]]]},\"boundingBox\":[[53.111991,-27.725812],[53.164780,-27.725812],[53.164780,-27.772234],[53.111991,-27.772234]],\"centralPos\":[53.138382,-27.749026]},\"temporalAxis\":{\"boundingBox\":[52220.243068,52263.181794],\"integratedCoverage\":0.208333,\"centralPos\":52241.712431,\"coverage\":[52220.243068,52263.181794]}},\"publisher\":\"ESO SAF\",\"collection\":\"168.A-0485(A\",\"targetSource\":{\"names\":[\"GOODS_09\"]},\"ESO\":{\"NGASFileId\":\"GOODS_ISAAC_09_H_V2.0\",\"metadataType\":\"DataProduct\",\"processingType\":\"HighlyProcessed\"},\"acquisitionSetup\":{\"filter\":\"H\",\"instrument\":\"ISAAC\",\"facility\":\"ESO-Paranal\",\"telescope\":\"ESO-VLT-U1\",\"mode\":\"Short Wavelength\"},\"title\":\"GOODS_ISAAC_09_H_v2.0\",\"id\":\"GOODS_ISAAC_09_H_V2.0\"},{\"project\":\"GOODS\",\"license\":\"ESO Data License : http://www.myLicenseToBeDefinedAtSomePoint.html\",\"copyright\":\"(c) GOODS Sep 10 2007 12:00AM\",\"creator\":\"C. Cesarsky\",\"dataType\":\"image\",\"characterization\":{\"spatialAxis\":{\"footprint\":{\"worldCoords\":[[[53.121222,-27.641601],[53.174252,-27.641601],[53.174252,-27.687943],[53.121222,-27.687943]]]},\"boundingBox\":[[53.121222,-27.641601],[53.174252,-27.641601],[53.174252,-27.687943],[53.121222,-27.687943]],\"centralPos\":[53.147732,-27.664775]},\"temporalAxis\":{\"boundingBox\":[53729.079417,53747.174968],\"integratedCoverage\":0.122222,\"centralPos\":53738.127193,\"coverage\":[53729.079417,53747.174968]}},\"publisher\":\"ESO SAF\",\"collection\":\"168.A-0485(G)\",\"targetSource\":{\"names\":[\"GOODS_01\"]},\"ESO\":{\"NGASFileId\":\"GOODS_ISAAC_01_J_V2.0\",\"metadataType\":\"DataProduct\",\"processingType\":\"HighlyProcessed\"},\"acquisitionSetup\":{\"filter\":\"J\",\"instrument\":\"ISAAC\",\"facility\":\"ESO-Paranal\",\"telescope\":\"ESO-VLT-U1\",\"mode\":\"Short Wavelength\"},\"title\":\"GOODS_ISAAC_01_J_v2.0\",\"id\":\"GOODS_ISAAC_01_J_V2.0\"},{\"project\":\"GOODS\",\"license\":\"ESO Data License : http://www.myLicenseToBeDefinedAtSomePoint.html\",\"copyright\":\"(c) GOODS Sep 10 2007 12:00AM\",\"creator\":\"C. Cesarsky\",\"dataType\":\"image\",\"characterization\":{\"spatialAxis\":{\"footprint\":{\"worldCoords\":[[[53.121081,-27.641392],[53.174488,-27.641392],[53.174488,-27.688027],[53.121081,-27.688027]]]},\"boundingBox\":[[53.121081,-27.641392],[53.174488,-27.641392],[53.174488,-27.688027],[53.121081,-27.688027]],\"centralPos\":[53.147779,-27.664712]},\"temporalAxis\":{\"boundingBox\":[53729.179656,53749.175133],\"integratedCoverage\":0.207292,\"centralPos\":53739.177395,\"coverage\":[53729.179656,53749.175133]}},\"publisher\":\"ESO SAF\",\"collection\":\"168.A-0485(G)\",\"targetSource\":{\"names\":[\"GOODS_01\"]},\"ESO\":{\"NGASFileId\":\"GOODS_ISAAC_01_KS_V2.0\",\"metadataType\":\"DataProduct\",\"processingType\":\"HighlyProcessed\"},\"acquisitionSetup\":{\"filter\":\"Ks\",\"instrument\":\"ISAAC\",\"facility\":\"ESO-Paranal\",\"telescope\":\"ESO-VLT-U1\",\"mode\":\"Short Wavelength\"},\"title\":\"GOODS_ISAAC_01_Ks_v2.0\",\"id\":\"GOODS_ISAAC_01_KS_V2.0\"}]";
 }
 
@@ -105,6 +118,135 @@ void TestStelJsonParser::testErrors()
 	QVERIFY(result.isNull());
 }
 
+void TestStelJsonParser::testCatalog()
+{
+	const QByteArray json = "{\"version\": 2, \"items\": {\"b\": {\"x\": -1.5e3}, \"a\\\"\\u00e9\": {\"list\": [1, \"]\"], \"s\": \"}\\\"\"}},\n \"shortName\": \"test\"}";
+	QStringList keys;
+	QList<QVariantMap> items;
+	const QVariantMap header = StelJsonCatalog::parse(json, "items", [&](const QString& key, QVariantMap& item) {
+		keys << key;
+		items << item;
+	});
+	QCOMPARE(header.value("version").toInt(), 2);
+	QCOMPARE(header.value("shortName").toString(), QString("test"));
+	QVERIFY(!header.contains("items"));
+
+	// Same keys and values in the same order as with the full parse
+	const QVariantMap expected = StelJsonParser::parse(json).toMap().value("items").toMap();
+	QCOMPARE(keys, expected.keys());
+	QCOMPARE(keys.first(), QString::fromUtf8("a\"\u00e9"));
+	for (int i=0; i<keys.size(); ++i)
+		QCOMPARE(QVariant(items.at(i)), expected.value(keys.at(i)));
+
+	// Only the header
+	QCOMPARE(StelJsonCatalog::parse(json, "items", StelJsonCatalog::ItemHandler()), header);
+
+	bool wasCatched = false;
+	try
+	{
+		StelJsonCatalog::parse("{\"version\": 2, \"items\": {\"a\": {\"x\": [1, 2}}}", "items", [](const QString&, QVariantMap&) {});
+	}
+	catch (std::runtime_error&)
+	{
+		wasCatched = true;
+	}
+	QVERIFY(wasCatched);
+}
+
+void TestStelJsonParser::testStreamReader()
+{
+	// Same values as the tree parser
+	StelJsonStreamReader reader(largeJsonBuff);
+	QCOMPARE(reader.readNext(), StelJsonStreamReader::StartObject);
+	QCOMPARE(reader.readCurrentValue(), StelJsonParser::parse(largeJsonBuff));
+	QCOMPARE(reader.readNext(), StelJsonStreamReader::EndDocument);
+
+	StelJsonStreamReader listReader(listJsonBuff);
+	listReader.readNext();
+	QCOMPARE(listReader.readCurrentValue(), StelJsonParser::parse(listJsonBuff));
+
+	StelJsonStreamReader tokens(" {\"a\": [1.5, true, null, \"x\\ny\"], \"b\": {}} ");
+	QCOMPARE(tokens.readNext(), StelJsonStreamReader::StartObject);
+	QCOMPARE(tokens.readNext(), StelJsonStreamReader::Name);
+	QCOMPARE(tokens.name(), QString("a"));
+	QCOMPARE(tokens.readNext(), StelJsonStreamReader::StartArray);
+	QCOMPARE(tokens.depth(), 2);
+	QCOMPARE(tokens.readNext(), StelJsonStreamReader::Number);
+	QCOMPARE(tokens.numberValue(), 1.5);
+	QCOMPARE(tokens.readNext(), StelJsonStreamReader::Bool);
+	QVERIFY(tokens.boolValue());
+	QCOMPARE(tokens.readNext(), StelJsonStreamReader::Null);
+	QCOMPARE(tokens.readNext(), StelJsonStreamReader::String);
+	QCOMPARE(tokens.stringValue(), QString("x\ny"));
+	QCOMPARE(tokens.readNext(), StelJsonStreamReader::EndArray);
+	QCOMPARE(tokens.readNext(), StelJsonStreamReader::Name);
+	tokens.skipCurrentValue();
+	QCOMPARE(tokens.readNext(), StelJsonStreamReader::EndObject);
+	QCOMPARE(tokens.readNext(), StelJsonStreamReader::EndDocument);
+
+	const QList<QByteArray> invalid = QList<QByteArray>() << "{val: -12356}" << "[1, 2" << "[1,]" << "{\"a\" 1}" << "[1] 2" << "[tru]";
+	for (const auto& json : invalid)
+	{
+		bool wasCatched = false;
+		try
+		{
+			StelJsonStreamReader r(json);
+			while (r.readNext()!=StelJsonStreamReader::EndDocument) {}
+		}
+		catch (std::runtime_error&)
+		{
+			wasCatched = true;
+		}
+		QVERIFY2(wasCatched, json.constData());
+	}
+}
+
+void TestStelJsonParser::benchmarkCatalogTree()
+{
+	double sum = 0.;
+	QBENCHMARK {
+		sum = 0.;
+		const QVariantMap stars = StelJsonParser::parse(catalogJsonBuff).toMap().value("stars").toMap();
+		for (auto it = stars.constBegin(); it != stars.constEnd(); ++it)
+			sum += it.value().toMap().value("distance").toDouble();
+	}
+	QVERIFY(sum>0.);
+}
+
+void TestStelJsonParser::benchmarkCatalogStream()
+{
+	double sum = 0.;
+	QBENCHMARK {
+		sum = 0.;
+		StelJsonStreamReader reader(catalogJsonBuff);
+		reader.readNext();
+		while (reader.readNext()==StelJsonStreamReader::Name)
+		{
+			if (reader.name()!="stars")
+			{
+				reader.skipCurrentValue();
+				continue;
+			}
+			reader.readNext();
+			while (reader.readNext()==StelJsonStreamReader::Name)
+			{
+				reader.readNext();
+				while (reader.readNext()==StelJsonStreamReader::Name)
+				{
+					if (reader.name()=="distance")
+					{
+						reader.readNext();
+						sum += reader.numberValue();
+					}
+					else
+						reader.skipCurrentValue();
+				}
+			}
+		}
+	}
+	QVERIFY(sum>0.);
+}
+
 void TestStelJsonParser::benchmarkParse()
 {
 	QBuffer buf;
@@ -31,9 +31,15 @@ private slots:
 	void testBase();
 	void benchmarkParse();
 	void testErrors();
+	void testCatalog();
+	void testStreamReader();
+	void benchmarkCatalogTree();
+	void benchmarkCatalogStream();
 private:
 	QByteArray largeJsonBuff;
 	QByteArray listJsonBuff;
+	//! a generated catalog with the structure of exoplanets.json
+	QByteArray catalogJsonBuff;
 };
 
 #endif // _TESTSTELJSONPARSER_HPP
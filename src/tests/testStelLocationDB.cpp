@@ -0,0 +1,147 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "tests/testStelLocationDB.hpp"
+#include "StelLocationDB.hpp"
+
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <cstdlib>
+
+QTEST_GUILESS_MAIN(TestStelLocationDB)
+
+namespace
+{
+	// The file from which the database is supposedly created
+	QFileInfo createSource(const QString& path, const QByteArray& content)
+	{
+		QFile file(path);
+		file.open(QIODevice::WriteOnly);
+		file.write(content);
+		file.close();
+		return QFileInfo(path);
+	}
+}
+
+void TestStelLocationDB::initTestCase()
+{
+	std::srand(42);
+	const QStringList countries = QStringList() << "France" << "Chile" << "Norway" << "" << "New Zealand";
+	for (int i=0; i<3000; ++i)
+	{
+		StelLocation loc;
+		loc.name = QString("Place %1").arg(i);
+		loc.country = countries.at(i%countries.size());
+		loc.planetName = (i%50==0) ? "Mars" : "Earth";
+		loc.longitude = std::rand()*360.f/RAND_MAX - 180.f;
+		// Many locations near the poles and the date line
+		loc.latitude = (i%10==0) ? 85.f + std::rand()*5.f/RAND_MAX : std::rand()*180.f/RAND_MAX - 90.f;
+		loc.altitude = i;
+		loc.population = i*10;
+		loc.role = 'N';
+		loc.ianaTimeZone = (i%3==0) ? "Europe/Paris" : "America/Santiago";
+		loc.isUserLocation = false;
+		locations.insert(loc.getID(), loc);
+	}
+}
+
+void TestStelLocationDB::testFind()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	const QString path = dir.path() + "/locations.db";
+	const QFileInfo source = createSource(dir.path() + "/locations.txt", "locations");
+	QVERIFY(StelLocationDB::write(path, locations, source));
+
+	StelLocationDB db;
+	QVERIFY(db.open(path, source));
+	QCOMPARE(db.count(), locations.size());
+	QCOMPARE(db.getAllIDs(), QStringList(locations.keys()));
+	QCOMPARE(db.getTimeZoneNames().size(), 2);
+
+	const StelLocation& expected = locations.value("Place 1234, Chile");
+	const int index = db.find("Place 1234, Chile");
+	QVERIFY(index>=0);
+	const StelLocation loc = db.getLocation(index);
+	QCOMPARE(loc.name, expected.name);
+	QCOMPARE(loc.country, expected.country);
+	QCOMPARE(loc.planetName, expected.planetName);
+	QCOMPARE(loc.longitude, expected.longitude);
+	QCOMPARE(loc.latitude, expected.latitude);
+	QCOMPARE(loc.altitude, expected.altitude);
+	QCOMPARE(loc.population, expected.population);
+	QCOMPARE(loc.role, expected.role);
+	QCOMPARE(loc.ianaTimeZone, expected.ianaTimeZone);
+	QCOMPARE(db.find("Nowhere"), -1);
+
+	// A database of another source is refused
+	db.close();
+	QVERIFY(!db.open(path, createSource(dir.path() + "/other.txt", "other locations")));
+}
+
+void TestStelLocationDB::testNearby()
+{
+	QTemporaryDir dir;
+	const QString path = dir.path() + "/locations.db";
+	const QFileInfo source = createSource(dir.path() + "/locations.txt", "locations");
+	QVERIFY(StelLocationDB::write(path, locations, source));
+	StelLocationDB db;
+	QVERIFY(db.open(path, source));
+
+	// Same result as comparing the distance to each location
+	const float queries[][3] = {{0.f, 0.f, 5.f}, {179.5f, 10.f, 5.f}, {-179.5f, -40.f, 12.f}, {20.f, 87.f, 5.f},
+				    {-60.f, -80.f, 15.f}, {100.f, 60.f, 45.f}, {0.f, 0.f, 180.f}, {30.f, 30.f, 0.5f}};
+	for (const auto& q : queries)
+	{
+		for (const QString planet : QStringList() << "Earth" << "Mars")
+		{
+			QStringList expected;
+			for (auto it=locations.constBegin(); it!=locations.constEnd(); ++it)
+			{
+				if (it.value().planetName==planet && StelLocation::distanceDegrees(q[0], q[1], it.value().longitude, it.value().latitude) <= q[2])
+					expected.append(it.key());
+			}
+			QCOMPARE(db.getIDs(db.findNearby(planet, q[0], q[1], q[2])), expected);
+		}
+	}
+}
+
+void TestStelLocationDB::testCountry()
+{
+	QTemporaryDir dir;
+	const QString path = dir.path() + "/locations.db";
+	const QFileInfo source = createSource(dir.path() + "/locations.txt", "locations");
+	QVERIFY(StelLocationDB::write(path, locations, source));
+	StelLocationDB db;
+	QVERIFY(db.open(path, source));
+
+	for (const QString country : QStringList() << "France" << "" << "New Zealand" << "Atlantis")
+	{
+		QStringList expected;
+		for (auto it=locations.constBegin(); it!=locations.constEnd(); ++it)
+		{
+			if (it.value().country==country)
+				expected.append(it.key());
+		}
+		QCOMPARE(db.getIDs(db.findInCountry(country)), expected);
+	}
+}
@@ -0,0 +1,55 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "tests/testStelObjectNameIndex.hpp"
+#include "StelObjectNameIndex.hpp"
+
+#include <QTest>
+
+QTEST_GUILESS_MAIN(TestStelObjectNameIndex)
+
+void TestStelObjectNameIndex::testStartOfWords()
+{
+	StelObjectNameIndex index;
+	index.insert(QStringList() << "Mars" << "Mercury" << "Moon" << "Jupiter" << "Makemake");
+	QCOMPARE(index.listMatching("m", 10, true), QStringList() << "Makemake" << "Mars" << "Mercury" << "Moon");
+	QCOMPARE(index.listMatching("MA", 10, true), QStringList() << "Makemake" << "Mars");
+	QCOMPARE(index.listMatching("m", 2, true), QStringList() << "Makemake" << "Mars");
+	QVERIFY(index.listMatching("x", 10, true).isEmpty());
+
+	// Names inserted later are found too
+	index.insert("Mimas");
+	QCOMPARE(index.listMatching("mi", 10, true), QStringList() << "Mimas");
+	index.clear();
+	QVERIFY(index.listMatching("m", 10, true).isEmpty());
+}
+
+void TestStelObjectNameIndex::testContains()
+{
+	StelObjectNameIndex index;
+	index.insert(QStringList() << "Andromeda Galaxy" << "Triangulum Galaxy" << "Orion Nebula" << "Crab Nebula" << "Ring Nebula");
+	QCOMPARE(index.listMatching("galaxy", 10, false), QStringList() << "Andromeda Galaxy" << "Triangulum Galaxy");
+	QCOMPARE(index.listMatching("b NEB", 10, false), QStringList() << "Crab Nebula");
+	QCOMPARE(index.listMatching("Nebula", 2, false), QStringList() << "Crab Nebula" << "Orion Nebula");
+	QCOMPARE(index.listMatching("in", 10, false), QStringList() << "Ring Nebula");
+	QVERIFY(index.listMatching("quasar", 10, false).isEmpty());
+	// A text longer than the names
+	QVERIFY(index.listMatching("Andromeda Galaxy and more", 10, false).isEmpty());
+}
@@ -0,0 +1,157 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testStelProjector.hpp"
+
+#include <QDebug>
+#include <QTest>
+#include <QVector>
+
+#include "StelProjectorClasses.hpp"
+#include "StelUtils.hpp"
+
+QTEST_GUILESS_MAIN(TestStelProjector)
+
+void TestStelProjector::addProjectionTypes()
+{
+	QTest::addColumn<QString>("type");
+	QTest::newRow("perspective") << "perspective";
+	QTest::newRow("equalArea") << "equalArea";
+	QTest::newRow("stereographic") << "stereographic";
+	QTest::newRow("fisheye") << "fisheye";
+	QTest::newRow("hammer") << "hammer";
+	QTest::newRow("cylinder") << "cylinder";
+	QTest::newRow("mercator") << "mercator";
+	QTest::newRow("orthographic") << "orthographic";
+	QTest::newRow("sinusoidal") << "sinusoidal";
+	QTest::newRow("miller") << "miller";
+}
+
+StelProjectorP TestStelProjector::createProjector(const QString& type)
+{
+	const StelProjector::ModelViewTranformP transform(new StelProjector::Mat4dTransform(Mat4d::identity()));
+	StelProjector* prj = Q_NULLPTR;
+	if (type=="perspective")
+		prj = new StelProjectorPerspective(transform);
+	else if (type=="equalArea")
+		prj = new StelProjectorEqualArea(transform);
+	else if (type=="stereographic")
+		prj = new StelProjectorStereographic(transform);
+	else if (type=="fisheye")
+		prj = new StelProjectorFisheye(transform);
+	else if (type=="hammer")
+		prj = new StelProjectorHammer(transform);
+	else if (type=="cylinder")
+		prj = new StelProjectorCylinder(transform);
+	else if (type=="mercator")
+		prj = new StelProjectorMercator(transform);
+	else if (type=="orthographic")
+		prj = new StelProjectorOrthographic(transform);
+	else if (type=="sinusoidal")
+		prj = new StelProjectorSinusoidal(transform);
+	else if (type=="miller")
+		prj = new StelProjectorMiller(transform);
+	Q_ASSERT(prj);
+
+	// As StelCore sets them
+	StelProjector::StelProjectorParams params;
+	params.viewportXywh.set(0, 0, 1024, 1024);
+	params.viewportCenter.set(512.f, 512.f);
+	params.viewportFovDiameter = 1024.f;
+	params.fov = 60.f;
+	params.zNear = 0.000001f;
+	params.zFar = 500.f;
+	prj->init(params);
+	return StelProjectorP(prj);
+}
+
+QVector<Vec3d> TestStelProjector::directionsInView() const
+{
+	QVector<Vec3d> directions;
+	for (int i=0; i<32; ++i)
+	{
+		for (int j=0; j<32; ++j)
+		{
+			// Up to 20 degrees from the view direction
+			Vec3d v;
+			StelUtils::spheToRect((i-15.5)*(40./31.)*M_PI/180., (j-15.5)*(40./31.)*M_PI/180., v);
+			// Rotate the x axis to -z
+			directions << Vec3d(v[1], v[2], -v[0]);
+		}
+	}
+	return directions;
+}
+
+void TestStelProjector::testProjectUnProject_data()
+{
+	addProjectionTypes();
+}
+
+void TestStelProjector::testProjectUnProject()
+{
+	QFETCH(QString, type);
+	const StelProjectorP prj = createProjector(type);
+	for (const auto& v : directionsInView())
+	{
+		Vec3d win, back;
+		QVERIFY2(prj->project(v, win), qPrintable(QString("v=%1").arg(v.toString())));
+		QVERIFY(prj->unProject(win, back));
+		back.normalize();
+		QVERIFY2(v.angle(back) < 1e-5, qPrintable(QString("v=%1 back=%2").arg(v.toString()).arg(back.toString())));
+	}
+}
+
+void TestStelProjector::benchmarkProject_data()
+{
+	addProjectionTypes();
+}
+
+void TestStelProjector::benchmarkProject()
+{
+	QFETCH(QString, type);
+	const StelProjectorP prj = createProjector(type);
+	const QVector<Vec3d> directions = directionsInView();
+	Vec3d win;
+	int visible = 0;
+	QBENCHMARK {
+		for (const auto& v : directions)
+			visible += prj->project(v, win);
+	}
+	QVERIFY(visible>0);
+}
+
+void TestStelProjector::benchmarkProjectBatch_data()
+{
+	addProjectionTypes();
+}
+
+void TestStelProjector::benchmarkProjectBatch()
+{
+	QFETCH(QString, type);
+	const StelProjectorP prj = createProjector(type);
+	QVector<Vec3f> directions;
+	for (const auto& v : directionsInView())
+		directions << v.toVec3f();
+	QVector<Vec3f> win(directions.size());
+	QVector<char> mask(directions.size());
+	QBENCHMARK {
+		prj->projectBatch(directions.constData(), directions.size(), win.data(), reinterpret_cast<bool*>(mask.data()));
+	}
+	QVERIFY(mask.contains(1));
+}
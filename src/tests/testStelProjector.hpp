@@ -0,0 +1,45 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef TESTSTELPROJECTOR_HPP
+#define TESTSTELPROJECTOR_HPP
+
+#include <QObject>
+#include <QTest>
+#include "StelProjector.hpp"
+
+class TestStelProjector : public QObject
+{
+Q_OBJECT
+private slots:
+	void testProjectUnProject_data();
+	void testProjectUnProject();
+	void benchmarkProject_data();
+	void benchmarkProject();
+	void benchmarkProjectBatch_data();
+	void benchmarkProjectBatch();
+private:
+	void addProjectionTypes();
+	//! Create an initialized projector of the given type, on a 1024x1024 viewport with a field of view of 60 degrees.
+	StelProjectorP createProjector(const QString& type);
+	//! Directions in the field of view, around the view direction -z.
+	QVector<Vec3d> directionsInView() const;
+};
+
+#endif // TESTSTELPROJECTOR_HPP
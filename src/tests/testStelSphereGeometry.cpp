@@ -165,6 +165,36 @@ void TestStelSphericalGeometry::benchmarkSphericalCap()
 	}
 }
 
+void TestStelSphericalGeometry::benchmarkIntersects_data()
+{
+	QTest::addColumn<int>("first");
+	QTest::addColumn<int>("second");
+	// Indices in the regions of benchmarkIntersects()
+	QTest::newRow("cap-convex") << 0 << 3;
+	QTest::newRow("convex-convex") << 1 << 3;
+	QTest::newRow("cap-polygon") << 0 << 4;
+	QTest::newRow("convex-polygon") << 1 << 4;
+	QTest::newRow("polygon-polygon") << 2 << 4;
+	QTest::newRow("polygon-holyPolygon") << 2 << 5;
+}
+
+void TestStelSphericalGeometry::benchmarkIntersects()
+{
+	QFETCH(int, first);
+	QFETCH(int, second);
+	Vec3d p(1,0.1,0.1);
+	p.normalize();
+	const SphericalCap cap(p, 0.99);
+	const SphericalRegion* regions[] = {&cap, &bigSquareConvex, &bigSquare, &smallSquareConvex, &smallSquare, &holySquare};
+	const SphericalRegion* a = regions[first];
+	const SphericalRegion* b = regions[second];
+	bool res = false;
+	QBENCHMARK {
+		res = a->intersects(b);
+	}
+	QVERIFY(res);
+}
+
 void TestStelSphericalGeometry::testConsistency()
 {
 	QCOMPARE(bigSquare.getArea(), bigSquareConvex.getArea());
@@ -354,6 +384,40 @@ void TestStelSphericalGeometry::testSphericalPolygon()
 
 }
 
+void TestStelSphericalGeometry::testMultiUnion()
+{
+	// A row of overlapping squares, and a square far from them
+	QList<SphericalRegionP> regions;
+	for (int i=0;i<13;++i)
+	{
+		const double ra = i<12 ? 0.1*i : 3.;
+		Vec3d c[4];
+		StelUtils::spheToRect(ra-0.1, 0.1, c[0]);
+		StelUtils::spheToRect(ra+0.1, 0.1, c[1]);
+		StelUtils::spheToRect(ra+0.1, -0.1, c[2]);
+		StelUtils::spheToRect(ra-0.1, -0.1, c[3]);
+		regions.append(SphericalRegionP(new SphericalConvexPolygon(c[0], c[1], c[2], c[3])));
+	}
+
+	SphericalRegionP sequentialUnion = regions.first();
+	for (int i=1;i<regions.size();++i)
+		sequentialUnion = sequentialUnion->getUnion(regions.at(i));
+	const SphericalRegionP multiUnion = SphericalPolygon::multiUnion(regions);
+	QVERIFY(std::fabs(multiUnion->getArea()-sequentialUnion->getArea())<1e-10);
+	QVERIFY(multiUnion->getArea()<regions.first()->getArea()*13.);
+	for (const auto& r : regions)
+		QVERIFY(multiUnion->contains(r->getPointInside()));
+	Vec3d outside;
+	StelUtils::spheToRect(0.6, 0.5, outside);
+	QVERIFY(!multiUnion->contains(outside));
+
+	// Disjoint polygons have an empty intersection
+	OctahedronPolygon first = regions.first()->getOctahedronPolygon();
+	first.inPlaceIntersection(regions.last()->getOctahedronPolygon());
+	QVERIFY(first.isEmpty());
+	QVERIFY(SphericalPolygon::multiIntersection(regions)->isEmpty());
+}
+
 void TestStelSphericalGeometry::testLoading()
 {
 	QByteArray ar = "{\"worldCoords\": [[[-0.5,0.5],[0.5,0.5],[0.5,-0.5],[-0.5,-0.5]], [[-0.2,-0.2],[0.2,-0.2],[0.2,0.2],[-0.2,0.2]]]}";
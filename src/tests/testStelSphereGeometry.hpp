@@ -35,12 +35,15 @@ private slots:
 	void testPlaneIntersect2();
 	void testGreatCircleIntersection();
 	void testSphericalPolygon();
+	void testMultiUnion();
 	void testConsistency();
 	void testLoading();
 	void testEnlarge();
 	void benchmarkContains();
 	void benchmarkCheckValid();
 	void benchmarkSphericalCap();
+	void benchmarkIntersects_data();
+	void benchmarkIntersects();
 	void benchmarkGetIntersection();
 	void testSerialize();
 	void benchmarkCreatePolygon();
@@ -24,8 +24,10 @@
 #include <QTest>
 
 #include <stdexcept>
+#include <limits>
 
 #include "StelSphereGeometry.hpp"
+#include "StelGeodesicGrid.hpp"
 #include "StelUtils.hpp"
 
 
@@ -40,6 +42,20 @@ class TestRegionObject : public StelRegionObject
 		SphericalRegionP region;
 };
 
+class TestKeyedObject : public StelRegionObject
+{
+	public:
+		TestKeyedObject(const Vec3d& apos, float akey, quint64 amask) : pos(apos), region(new SphericalPoint(apos)), key(akey), mask(amask) {;}
+		virtual SphericalRegionP getRegion() const { return region; }
+		virtual Vec3d getPointInRegion() const { return pos; }
+		virtual float getIndexSortKey() const { return key; }
+		virtual quint64 getIndexMask() const { return mask; }
+		Vec3d pos;
+		SphericalRegionP region;
+		float key;
+		quint64 mask;
+};
+
 void TestStelSphericalIndex::initTestCase()
 {
 }
@@ -102,3 +118,161 @@ void TestStelSphericalIndex::testBase()
 	QVERIFY(countFunc.count==30000);
 }
 
+
+struct FilteredFuncObject
+{
+	FilteredFuncObject(float amaxKey, quint64 awantedMask) : maxKey(amaxKey), wantedMask(awantedMask), count(0), sorted(true), lastKey(0.f) {;}
+	bool enterNode(quint64, quint64 subtreeMask)
+	{
+		lastKey = -std::numeric_limits<float>::max();
+		return subtreeMask & wantedMask;
+	}
+	bool operator()(const StelRegionObject* obj)
+	{
+		const float key = obj->getIndexSortKey();
+		sorted = sorted && key>=lastKey;
+		lastKey = key;
+		if (key>maxKey)
+			return false;
+		if (obj->getIndexMask() & wantedMask)
+			++count;
+		return true;
+	}
+	float maxKey;
+	quint64 wantedMask;
+	int count;
+	bool sorted;
+	float lastKey;
+};
+
+void TestStelSphericalIndex::testFiltered()
+{
+	StelSphericalIndex grid(10);
+	// Keys from 0 to 9, half of the objects with a mask of 1, the others of 2, around (1,0,0).
+	for (int i=0;i<1000;++i)
+	{
+		Vec3d pos(1., 0.001*(i%37), 0.001*(i%41));
+		pos.normalize();
+		grid.insert(StelRegionObjectP(new TestKeyedObject(pos, (i*7)%10, i%2 ? 1 : 2)));
+	}
+	// Objects far away with a mask of 4
+	for (int i=0;i<100;++i)
+		grid.insert(StelRegionObjectP(new TestKeyedObject(Vec3d(-1,0,0), i%10, 4)));
+
+	const SphericalRegionP region(new SphericalCap(Vec3d(1,0,0), 0.9));
+	FilteredFuncObject all(100.f, ~Q_UINT64_C(0));
+	grid.processFilteredPointInRegions(region.data(), all);
+	QVERIFY(all.sorted);
+	QCOMPARE(all.count, 1000);
+
+	FilteredFuncObject bright(4.5f, 1);
+	grid.processFilteredPointInRegions(region.data(), bright);
+	QVERIFY(bright.sorted);
+	QCOMPARE(bright.count, 200);
+
+	FilteredFuncObject none(100.f, 4);
+	grid.processFilteredPointInRegions(region.data(), none);
+	QCOMPARE(none.count, 0);
+}
+
+struct CollectFuncObject
+{
+	void operator()(const StelRegionObject* obj)
+	{
+		objects.append(obj);
+	}
+	QList<const StelRegionObject*> objects;
+};
+
+void TestStelSphericalIndex::testFlatLayout()
+{
+	StelSphericalIndex grid(10);
+	for (int i=0;i<2000;++i)
+	{
+		Vec3d pos;
+		StelUtils::spheToRect(2.*M_PI*(i%97)/97., std::asin(2.*(i%101)/101.-1.), pos);
+		grid.insert(StelRegionObjectP(new TestKeyedObject(pos, (i*7)%10, i%2 ? 1 : 2)));
+	}
+	QVERIFY(!grid.hasFlatLayout());
+
+	const SphericalRegionP region(new SphericalCap(Vec3d(1,0.3,0.2), 0.8));
+	const SphericalCap cap(Vec3d(0,0,1), 0.9);
+	CollectFuncObject intersecting, points, capIntersecting, contained, all;
+	grid.processIntersectingRegions(region.data(), intersecting);
+	grid.processIntersectingPointInRegions(region.data(), points);
+	grid.processBoundingCapIntersectingRegions(cap, capIntersecting);
+	grid.processContainedRegions(region.data(), contained);
+	grid.processAll(all);
+	FilteredFuncObject filtered(4.5f, 1);
+	grid.processFilteredPointInRegions(region.data(), filtered);
+	QVERIFY(intersecting.objects.size()>0);
+	QCOMPARE(all.objects.size(), 2000);
+
+	// The flat layout visits the same objects, in the same order
+	grid.buildFlatLayout();
+	QVERIFY(grid.hasFlatLayout());
+	CollectFuncObject flatIntersecting, flatPoints, flatCapIntersecting, flatContained, flatAll;
+	grid.processIntersectingRegions(region.data(), flatIntersecting);
+	grid.processIntersectingPointInRegions(region.data(), flatPoints);
+	grid.processBoundingCapIntersectingRegions(cap, flatCapIntersecting);
+	grid.processContainedRegions(region.data(), flatContained);
+	grid.processAll(flatAll);
+	FilteredFuncObject flatFiltered(4.5f, 1);
+	grid.processFilteredPointInRegions(region.data(), flatFiltered);
+	QCOMPARE(flatIntersecting.objects, intersecting.objects);
+	QCOMPARE(flatPoints.objects, points.objects);
+	QCOMPARE(flatCapIntersecting.objects, capIntersecting.objects);
+	QCOMPARE(flatContained.objects, contained.objects);
+	QCOMPARE(flatAll.objects, all.objects);
+	QVERIFY(flatFiltered.sorted);
+	QCOMPARE(flatFiltered.count, filtered.count);
+
+	// Inserting returns to the tree
+	grid.insert(StelRegionObjectP(new TestKeyedObject(Vec3d(1,0,0), 0.f, 1)));
+	QVERIFY(!grid.hasFlatLayout());
+	CountFuncObject countFunc;
+	grid.processAll(countFunc);
+	QCOMPARE(countFunc.count, 2001);
+}
+
+void TestStelSphericalIndex::benchmarkProcessIntersectingRegions()
+{
+	// Small caps spread over the sphere, like the DSOs of the catalogue
+	StelSphericalIndex grid(10);
+	for (int i=0;i<10000;++i)
+	{
+		Vec3d pos;
+		StelUtils::spheToRect(2.*M_PI*(i%97)/97., std::asin(2.*(i%101)/101.-1.), pos);
+		grid.insert(StelRegionObjectP(new TestRegionObject(SphericalRegionP(new SphericalCap(pos, 0.99999)))));
+	}
+	// A field of view of about 60 degrees
+	const SphericalCap fov(Vec3d(1,0,0), std::cos(30.*M_PI/180.));
+	CountFuncObject countFunc;
+	QBENCHMARK {
+		countFunc.count=0;
+		grid.processIntersectingRegions(&fov, countFunc);
+	}
+	QVERIFY(countFunc.count>0);
+}
+
+void TestStelSphericalIndex::benchmarkGeodesicGridSearch()
+{
+	// The grid of the star catalogues, and the 4 half spaces of the sides of a viewport
+	const StelGeodesicGrid grid(7);
+	QVector<SphericalCap> convex;
+	convex << SphericalCap(Vec3d(1,1,0), 0.) << SphericalCap(Vec3d(1,-1,0), 0.)
+	       << SphericalCap(Vec3d(1,0,1), 0.) << SphericalCap(Vec3d(1,0,-1), 0.);
+	for (auto& cap : convex)
+		cap.n.normalize();
+	int zones = 0;
+	int iteration = 0;
+	QBENCHMARK {
+		// Change the region so that the cache of the results is not used
+		convex[0].d = 1e-9*(++iteration);
+		const GeodesicSearchResult* result = grid.search(convex, 7);
+		GeodesicSearchInsideIterator it(*result, 7);
+		while (it.next()>=0)
+			++zones;
+	}
+	QVERIFY(zones>0);
+}
@@ -31,6 +31,10 @@ Q_OBJECT
 private slots:
 	void initTestCase();
 	void testBase();
+	void testFiltered();
+	void testFlatLayout();
+	void benchmarkProcessIntersectingRegions();
+	void benchmarkGeodesicGridSearch();
 private:
 };
 
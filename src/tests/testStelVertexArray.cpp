@@ -106,4 +106,29 @@ void TestStelVertexArray::benchmarkForeachTriangleDirect()
 	qDebug() << sum.toString();
 }
 
-
+void TestStelVertexArray::testSubdivideTriangles()
+{
+	QVector<Vec3d> vertices;
+	vertices << Vec3d(1, 0, 0) << Vec3d(0, 1, 0) << Vec3d(0, 0, 1) << Vec3d(0, -1, 0);
+	QVector<Vec2f> textureCoords;
+	textureCoords << Vec2f(0, 0) << Vec2f(1, 0) << Vec2f(0, 1) << Vec2f(1, 1);
+	const StelVertexArray fan(vertices, StelVertexArray::TriangleFan, textureCoords);
+
+	const StelVertexArray res = fan.subdivideTriangles();
+	QVERIFY(res.primitiveType==StelVertexArray::Triangles);
+	QVERIFY(!res.isIndexed());
+	QCOMPARE(res.vertex.size(), 2*4*3);
+	QCOMPARE(res.texCoords.size(), res.vertex.size());
+	QVERIFY(!res.isColored());
+	for (const auto& v : res.vertex)
+		QVERIFY(qAbs(v.length()-1.)<1e-12);
+
+	// Corner sub-triangle of the first triangle, with the middle of its sides
+	QVERIFY(res.vertex.at(0)==Vec3d(1, 0, 0));
+	QVERIFY((res.vertex.at(1)-Vec3d(M_SQRT1_2, M_SQRT1_2, 0)).length()<1e-12);
+	QVERIFY(res.texCoords.at(1)==Vec2f(0.5f, 0.f));
+
+	// Orientation is kept for culling
+	for (int i = 0; i < res.vertex.size(); i += 3)
+		QVERIFY(((res.vertex.at(i+1)-res.vertex.at(i))^(res.vertex.at(i+2)-res.vertex.at(i)))*res.vertex.at(i)>0.);
+}
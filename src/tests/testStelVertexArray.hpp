@@ -33,6 +33,7 @@ private slots:
 	void benchmarkForeachTriangleNoOp();
 	void benchmarkForeachTriangle();
 	void benchmarkForeachTriangleDirect();
+	void testSubdivideTriangles();
 private:
 	StelVertexArray array;
 };
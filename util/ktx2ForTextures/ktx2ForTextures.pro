@@ -0,0 +1,16 @@
+#-------------------------------------------------
+#
+# Converts the images of Stellarium data directories to
+# BC1/BC3 compressed KTX2 files, see main.cpp
+#
+#-------------------------------------------------
+
+QT       += core gui
+
+TARGET = ktx2ForTextures
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+SOURCES += main.cpp
@@ -0,0 +1,348 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+// Creates a .ktx2 file beside each image of the given files or directories, which Stellarium
+// loads instead of the image, see StelKtx2 in src/core. Images with an alpha channel are
+// compressed with BC3, the other ones with BC1, and a full mipmap chain is stored.
+// Rows are stored bottom first ("ru" KTXorientation), as expected by Stellarium.
+//
+// Usage: ktx2ForTextures [--force] [--min-size N] <file or directory>...
+// e.g. ktx2ForTextures textures landscapes nebulae
+//
+// Files in other formats (BC7, ETC2, ASTC) written by other tools, e.g. toktx from KTX-Software
+// without --encode basis-lz or uastc, are also loaded if they use the "ru" orientation.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageReader>
+#include <QtEndian>
+
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	const quint32 VK_FORMAT_BC1_RGB_SRGB_BLOCK = 132;
+	const quint32 VK_FORMAT_BC3_SRGB_BLOCK = 138;
+
+	void appendU16(QByteArray& out, quint16 v) { uchar b[2]; qToLittleEndian(v, b); out.append(reinterpret_cast<const char*>(b), 2); }
+	void appendU32(QByteArray& out, quint32 v) { uchar b[4]; qToLittleEndian(v, b); out.append(reinterpret_cast<const char*>(b), 4); }
+	void appendU64(QByteArray& out, quint64 v) { uchar b[8]; qToLittleEndian(v, b); out.append(reinterpret_cast<const char*>(b), 8); }
+
+	quint16 to565(const int c[3])
+	{
+		return static_cast<quint16>(((c[0]*31+127)/255)<<11 | ((c[1]*63+127)/255)<<5 | ((c[2]*31+127)/255));
+	}
+
+	void from565(quint16 v, int c[3])
+	{
+		const int r = (v>>11)&31, g = (v>>5)&63, b = v&31;
+		c[0] = (r<<3)|(r>>2);
+		c[1] = (g<<2)|(g>>4);
+		c[2] = (b<<3)|(b>>2);
+	}
+
+	// Encode the colors of a block of 16 RGBA pixels with a bounding box fit.
+	void encodeColorBlock(const uchar px[16][4], QByteArray& out)
+	{
+		int minC[3] = {255, 255, 255}, maxC[3] = {0, 0, 0};
+		for (int i=0; i<16; ++i)
+		{
+			for (int c=0; c<3; ++c)
+			{
+				minC[c] = qMin(minC[c], int(px[i][c]));
+				maxC[c] = qMax(maxC[c], int(px[i][c]));
+			}
+		}
+		// Move the end points inside the box to reduce the mean error
+		for (int c=0; c<3; ++c)
+		{
+			const int inset = (maxC[c]-minC[c])/16;
+			minC[c] += inset;
+			maxC[c] -= inset;
+		}
+		quint16 c0 = to565(maxC), c1 = to565(minC);
+		if (c0<c1)
+			qSwap(c0, c1);
+		quint32 indices = 0;
+		if (c0!=c1)
+		{
+			int palette[4][3];
+			from565(c0, palette[0]);
+			from565(c1, palette[1]);
+			for (int c=0; c<3; ++c)
+			{
+				palette[2][c] = (2*palette[0][c]+palette[1][c])/3;
+				palette[3][c] = (palette[0][c]+2*palette[1][c])/3;
+			}
+			for (int i=0; i<16; ++i)
+			{
+				int best = 0, bestDist = INT_MAX;
+				for (int p=0; p<4; ++p)
+				{
+					int dist = 0;
+					for (int c=0; c<3; ++c)
+						dist += (px[i][c]-palette[p][c])*(px[i][c]-palette[p][c]);
+					if (dist<bestDist)
+					{
+						bestDist = dist;
+						best = p;
+					}
+				}
+				indices |= static_cast<quint32>(best) << (2*i);
+			}
+		}
+		appendU16(out, c0);
+		appendU16(out, c1);
+		appendU32(out, indices);
+	}
+
+	// Encode the alpha of a block of 16 RGBA pixels in the 8 values mode of BC3.
+	void encodeAlphaBlock(const uchar px[16][4], QByteArray& out)
+	{
+		int a0 = 0, a1 = 255;
+		for (int i=0; i<16; ++i)
+		{
+			a0 = qMax(a0, int(px[i][3]));
+			a1 = qMin(a1, int(px[i][3]));
+		}
+		quint64 indices = 0;
+		if (a0!=a1)
+		{
+			int palette[8] = {a0, a1};
+			for (int p=1; p<7; ++p)
+				palette[p+1] = ((7-p)*a0 + p*a1)/7;
+			for (int i=0; i<16; ++i)
+			{
+				int best = 0, bestDist = INT_MAX;
+				for (int p=0; p<8; ++p)
+				{
+					const int dist = qAbs(px[i][3]-palette[p]);
+					if (dist<bestDist)
+					{
+						bestDist = dist;
+						best = p;
+					}
+				}
+				indices |= static_cast<quint64>(best) << (3*i);
+			}
+		}
+		out.append(static_cast<char>(a0));
+		out.append(static_cast<char>(a1));
+		for (int i=0; i<6; ++i)
+			out.append(static_cast<char>((indices>>(8*i)) & 0xff));
+	}
+
+	QByteArray encodeLevel(const QImage& image, bool alpha)
+	{
+		QByteArray out;
+		const int w = image.width(), h = image.height();
+		for (int by=0; by<h; by+=4)
+		{
+			for (int bx=0; bx<w; bx+=4)
+			{
+				uchar px[16][4];
+				for (int y=0; y<4; ++y)
+				{
+					const uchar* line = image.constScanLine(qMin(by+y, h-1));
+					for (int x=0; x<4; ++x)
+						memcpy(px[y*4+x], line + 4*qMin(bx+x, w-1), 4);
+				}
+				if (alpha)
+					encodeAlphaBlock(px, out);
+				encodeColorBlock(px, out);
+			}
+		}
+		return out;
+	}
+
+	QByteArray dataFormatDescriptor(bool alpha)
+	{
+		QByteArray block;
+		const int nbSamples = alpha ? 2 : 1;
+		appendU32(block, 0);					// vendorId, descriptorType
+		appendU32(block, 2 | (24+16*nbSamples)<<16);		// versionNumber, descriptorBlockSize
+		block.append(static_cast<char>(alpha ? 130 : 128));	// colorModel: BC3 or BC1A
+		block.append(static_cast<char>(1));			// colorPrimaries: BT709
+		block.append(static_cast<char>(2));			// transferFunction: sRGB
+		block.append(static_cast<char>(0));			// flags: straight alpha
+		block.append("\x03\x03\x00\x00", 4);			// texelBlockDimension: 4x4
+		block.append(static_cast<char>(alpha ? 16 : 8));	// bytesPlane0
+		block.append(QByteArray(7, '\0'));
+		if (alpha)
+		{
+			appendU16(block, 0); block.append(static_cast<char>(63)); block.append(static_cast<char>(15));
+			appendU32(block, 0); appendU32(block, 0); appendU32(block, 0xffffffff);
+		}
+		appendU16(block, alpha ? 64 : 0); block.append(static_cast<char>(63)); block.append(static_cast<char>(0));
+		appendU32(block, 0); appendU32(block, 0); appendU32(block, 0xffffffff);
+		QByteArray dfd;
+		appendU32(dfd, static_cast<quint32>(4+block.size()));
+		return dfd + block;
+	}
+
+	QByteArray keyValue(const QByteArray& key, const QByteArray& value)
+	{
+		QByteArray entry = key + '\0' + value + '\0';
+		QByteArray out;
+		appendU32(out, static_cast<quint32>(entry.size()));
+		out += entry;
+		while (out.size()%4)
+			out.append('\0');
+		return out;
+	}
+
+	bool convert(const QString& imagePath, const QString& ktxPath)
+	{
+		QImage image(imagePath);
+		if (image.isNull())
+		{
+			fprintf(stderr, "Cannot read %s\n", qPrintable(imagePath));
+			return false;
+		}
+		image = image.convertToFormat(QImage::Format_RGBA8888).mirrored(false, true);
+		bool alpha = false;
+		for (int y=0; y<image.height() && !alpha; ++y)
+		{
+			const uchar* line = image.constScanLine(y);
+			for (int x=0; x<image.width() && !alpha; ++x)
+				alpha = line[4*x+3]!=255;
+		}
+
+		QList<QByteArray> levels;
+		for (QImage level = image;; )
+		{
+			levels.append(encodeLevel(level, alpha));
+			if (level.width()==1 && level.height()==1)
+				break;
+			level = level.scaled(qMax(1, level.width()/2), qMax(1, level.height()/2), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+		}
+
+		const QByteArray dfd = dataFormatDescriptor(alpha);
+		const QByteArray kvd = keyValue("KTXorientation", "ru") + keyValue("KTXwriter", "Stellarium ktx2ForTextures");
+		const int levelIndexSize = 24*levels.size();
+		const quint32 dfdOffset = static_cast<quint32>(80+levelIndexSize);
+		const quint32 kvdOffset = dfdOffset + static_cast<quint32>(dfd.size());
+
+		// The smallest level is stored first, each level is aligned to 16 bytes
+		QVector<quint64> offsets(levels.size());
+		quint64 offset = kvdOffset + static_cast<quint64>(kvd.size());
+		for (int i=levels.size()-1; i>=0; --i)
+		{
+			offset = (offset+15) & ~Q_UINT64_C(15);
+			offsets[i] = offset;
+			offset += static_cast<quint64>(levels.at(i).size());
+		}
+
+		QByteArray out("\xABKTX 20\xBB\r\n\x1A\n", 12);
+		appendU32(out, alpha ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC1_RGB_SRGB_BLOCK);
+		appendU32(out, 1);					// typeSize
+		appendU32(out, static_cast<quint32>(image.width()));
+		appendU32(out, static_cast<quint32>(image.height()));
+		appendU32(out, 0);					// pixelDepth
+		appendU32(out, 0);					// layerCount
+		appendU32(out, 1);					// faceCount
+		appendU32(out, static_cast<quint32>(levels.size()));
+		appendU32(out, 0);					// supercompressionScheme
+		appendU32(out, dfdOffset);
+		appendU32(out, static_cast<quint32>(dfd.size()));
+		appendU32(out, kvdOffset);
+		appendU32(out, static_cast<quint32>(kvd.size()));
+		appendU64(out, 0);					// sgdByteOffset
+		appendU64(out, 0);					// sgdByteLength
+		for (int i=0; i<levels.size(); ++i)
+		{
+			appendU64(out, offsets.at(i));
+			appendU64(out, static_cast<quint64>(levels.at(i).size()));
+			appendU64(out, static_cast<quint64>(levels.at(i).size()));
+		}
+		out += dfd;
+		out += kvd;
+		for (int i=levels.size()-1; i>=0; --i)
+		{
+			out.append(QByteArray(static_cast<int>(offsets.at(i))-out.size(), '\0'));
+			out += levels.at(i);
+		}
+
+		QFile file(ktxPath);
+		if (!file.open(QIODevice::WriteOnly) || file.write(out)!=out.size())
+		{
+			fprintf(stderr, "Cannot write %s: %s\n", qPrintable(ktxPath), qPrintable(file.errorString()));
+			return false;
+		}
+		printf("%s: %dx%d %s, %d levels, %d kB\n", qPrintable(ktxPath), image.width(), image.height(),
+		       alpha ? "BC3" : "BC1", levels.size(), out.size()/1024);
+		return true;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Create compressed KTX2 textures beside the images used by Stellarium.");
+	parser.addHelpOption();
+	QCommandLineOption forceOption("force", "Convert images even if their KTX2 file is up to date.");
+	QCommandLineOption minSizeOption("min-size", "Skip images whose width and height are smaller than <pixels>.", "pixels", "256");
+	parser.addOption(forceOption);
+	parser.addOption(minSizeOption);
+	parser.addPositionalArgument("paths", "Images or directories to convert recursively.");
+	parser.process(app);
+
+	const bool force = parser.isSet(forceOption);
+	const int minSize = parser.value(minSizeOption).toInt();
+	const QStringList filters = {"*.png", "*.jpg", "*.jpeg"};
+
+	QStringList images;
+	for (const auto& path : parser.positionalArguments())
+	{
+		if (QFileInfo(path).isDir())
+		{
+			QDirIterator it(path, filters, QDir::Files, QDirIterator::Subdirectories);
+			while (it.hasNext())
+				images << it.next();
+		}
+		else
+			images << path;
+	}
+	if (images.isEmpty())
+		parser.showHelp(1);
+
+	int errors = 0;
+	for (const auto& imagePath : images)
+	{
+		const QFileInfo info(imagePath);
+		const QString ktxPath = imagePath.left(imagePath.size()-info.suffix().size()) + "ktx2";
+		const QFileInfo ktxInfo(ktxPath);
+		if (!force && ktxInfo.exists() && ktxInfo.lastModified()>=info.lastModified())
+			continue;
+		const QSize size = QImageReader(imagePath).size();
+		if (size.width()<minSize && size.height()<minSize)
+			continue;
+		if (!convert(imagePath, ktxPath))
+			++errors;
+	}
+	return errors>0 ? 1 : 0;
+}
@@ -0,0 +1,575 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+// Simulates the clients of a planetarium node against a running Stellarium, to find how many tablets
+// and RemoteSync clients a node can serve:
+// - web clients of the RemoteControl plugin polling main/status like the web interface,
+// - web clients receiving the changes over the WebSocket push channel (/api/main/push),
+// - RemoteSync clients, which measure the round trip of a clock request each second.
+// The frame times of the server are read from /api/perf during a baseline without clients and
+// during the load. Its percentiles cover the last 600 frames, so both phases should last more
+// than 10 seconds at 60 fps; the report uses the samples of the second half of each phase.
+//
+// Usage: remoteLoadTest [--host H] [--http-port P] [--sync-port P] [--password PW]
+//                       [--poll-clients N] [--poll-interval MS] [--push-clients N] [--sync-clients M]
+//                       [--baseline S] [--duration S]
+// e.g. remoteLoadTest --host dome-node1 --poll-clients 40 --sync-clients 4
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+#include <QUuid>
+#include <QVector>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+	// RemoteSync, see plugins/RemoteSync/src/SyncProtocol.hpp
+	const quint8 SYNC_PROTOCOL_VERSION = 6;
+	const QByteArray SYNC_MAGIC_VALUE = "StellariumSyncPluginProtocol";
+	enum SyncMessageType
+	{
+		SYNC_ERROR,
+		SERVER_CHALLENGE,
+		CLIENT_CHALLENGE_RESPONSE,
+		SERVER_CHALLENGERESPONSEVALID,
+		ALIVE,
+		TIME,
+		LOCATION,
+		SELECTION,
+		STELPROPERTY,
+		VIEW,
+		FOV,
+		FRAME,
+		MULTICAST
+	};
+
+	//! A distribution of measures
+	struct Samples
+	{
+		Samples() : errors(0) {}
+		QVector<double> values;
+		int errors;
+
+		void add(double v) { values.append(v); }
+		void add(const Samples& other) { values += other.values; errors += other.errors; }
+		double percentile(double p) const
+		{
+			if (values.isEmpty())
+				return 0.;
+			QVector<double> sorted = values;
+			std::sort(sorted.begin(), sorted.end());
+			return sorted.at(qMin(sorted.size()-1, static_cast<int>(p*sorted.size())));
+		}
+		void print(const char* name, const char* unit) const
+		{
+			double sum = 0.;
+			for (double v : values)
+				sum += v;
+			printf("  %-28s %7d samples %5d errors", name, values.size(), errors);
+			if (!values.isEmpty())
+				printf("  min %.1f  p50 %.1f  p90 %.1f  p99 %.1f  max %.1f  mean %.1f %s",
+				       percentile(0.), percentile(0.5), percentile(0.9), percentile(0.99), percentile(1.),
+				       sum/values.size(), unit);
+			printf("\n");
+		}
+	};
+
+	//! Basic authentication of RemoteControl, empty without password
+	QByteArray authorization(const QString& password)
+	{
+		if (password.isEmpty())
+			return QByteArray();
+		return "Basic " + (":" + password.toUtf8()).toBase64();
+	}
+
+	//! A web client polling main/status, with the ids of the last changes it received
+	class PollClient
+	{
+	public:
+		PollClient(const QUrl& base, const QByteArray& auth, int interval)
+			: base(base), auth(auth), actionId(-2), propId(-2), reply(Q_NULLPTR)
+		{
+			timer.setInterval(interval);
+			QObject::connect(&timer, &QTimer::timeout, [this]() { poll(); });
+		}
+		void start() { timer.start(); }
+		void stop() { timer.stop(); }
+		Samples latency;	// [ms]
+
+	private:
+		void poll()
+		{
+			// Like a browser, a slow reply delays the next poll
+			if (reply)
+				return;
+			QUrl url(base);
+			url.setPath("/api/main/status");
+			url.setQuery(QString("actionId=%1&propId=%2").arg(actionId).arg(propId));
+			QNetworkRequest request(url);
+			if (!auth.isEmpty())
+				request.setRawHeader("Authorization", auth);
+			clock.start();
+			reply = network.get(request);
+			QObject::connect(reply, &QNetworkReply::finished, [this]() { finished(); });
+		}
+		void finished()
+		{
+			if (reply->error()==QNetworkReply::NoError)
+			{
+				latency.add(clock.nsecsElapsed()*1e-6);
+				const QJsonObject obj = QJsonDocument::fromJson(reply->readAll()).object();
+				if (obj.contains("actionChanges"))
+					actionId = obj.value("actionChanges").toObject().value("id").toInt(actionId);
+				if (obj.contains("propertyChanges"))
+					propId = obj.value("propertyChanges").toObject().value("id").toInt(propId);
+			}
+			else
+				++latency.errors;
+			reply->deleteLater();
+			reply = Q_NULLPTR;
+		}
+
+		QUrl base;
+		QByteArray auth;
+		QNetworkAccessManager network;
+		QTimer timer;
+		QElapsedTimer clock;
+		int actionId, propId;
+		QNetworkReply* reply;
+	};
+
+	//! A web client of the WebSocket push channel, which measures the intervals between the messages
+	class PushClient
+	{
+	public:
+		PushClient(const QString& host, quint16 port, const QByteArray& auth)
+			: host(host), port(port), auth(auth), upgraded(false), messages(0), bytes(0)
+		{
+			QObject::connect(&socket, &QTcpSocket::connected, [this]() { connected(); });
+			QObject::connect(&socket, &QTcpSocket::readyRead, [this]() { readData(); });
+		}
+		void start() { socket.connectToHost(host, port); }
+		void stop() { socket.abort(); }
+		bool isUpgraded() const { return upgraded; }
+		Samples intervals;	// [ms]
+		int messages;
+		qint64 bytes;
+
+	private:
+		void connected()
+		{
+			QByteArray key(16, '\0');
+			for (auto& c : key)
+				c = static_cast<char>(qrand());
+			QByteArray request = "GET /api/main/push HTTP/1.1\r\nHost: " + host.toUtf8() + ":" + QByteArray::number(port)
+					+ "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Version: 13\r\nSec-WebSocket-Key: "
+					+ key.toBase64() + "\r\n";
+			if (!auth.isEmpty())
+				request += "Authorization: " + auth + "\r\n";
+			socket.write(request + "\r\n");
+		}
+		void readData()
+		{
+			buffer += socket.readAll();
+			if (!upgraded)
+			{
+				const int end = buffer.indexOf("\r\n\r\n");
+				if (end<0)
+					return;
+				if (!buffer.startsWith("HTTP/1.1 101"))
+				{
+					fprintf(stderr, "Push channel refused: %s\n", buffer.left(buffer.indexOf("\r\n")).constData());
+					++intervals.errors;
+					socket.abort();
+					return;
+				}
+				buffer.remove(0, end+4);
+				upgraded = true;
+			}
+			// The frames of the server are not masked
+			while (buffer.size()>=2)
+			{
+				const int opcode = buffer.at(0) & 0x0F;
+				qint64 length = buffer.at(1) & 0x7F;
+				int headerSize = 2;
+				if (length==126)
+				{
+					if (buffer.size()<4)
+						return;
+					length = (static_cast<uchar>(buffer.at(2))<<8) | static_cast<uchar>(buffer.at(3));
+					headerSize = 4;
+				}
+				else if (length==127)
+				{
+					if (buffer.size()<10)
+						return;
+					length = 0;
+					for (int i=2; i<10; ++i)
+						length = (length<<8) | static_cast<uchar>(buffer.at(i));
+					headerSize = 10;
+				}
+				if (buffer.size()<headerSize+length)
+					return;
+				buffer.remove(0, headerSize+static_cast<int>(length));
+				if (opcode==0x8)
+				{
+					++intervals.errors;
+					socket.abort();
+					return;
+				}
+				if (opcode==0x1)
+				{
+					if (clock.isValid())
+						intervals.add(clock.nsecsElapsed()*1e-6);
+					clock.start();
+					++messages;
+					bytes += length;
+				}
+			}
+		}
+
+		QString host;
+		quint16 port;
+		QByteArray auth;
+		QTcpSocket socket;
+		QByteArray buffer;
+		QElapsedTimer clock;
+		bool upgraded;
+	};
+
+	//! A RemoteSync client, which sends a clock request each second and counts the messages of the server
+	class SyncClient
+	{
+	public:
+		SyncClient(const QString& host, quint16 port)
+			: host(host), port(port), authenticated(false), messages(0), bytes(0)
+		{
+			QObject::connect(&socket, &QTcpSocket::readyRead, [this]() { readData(); });
+			QObject::connect(&aliveTimer, &QTimer::timeout, [this]() { sendClockRequest(); });
+			aliveTimer.setInterval(1000);
+		}
+		void start() { socket.connectToHost(host, port); }
+		void stop() { aliveTimer.stop(); socket.abort(); }
+		bool isAuthenticated() const { return authenticated; }
+		Samples roundTrip;	// [ms]
+		int messages;
+		qint64 bytes;
+
+	private:
+		void write(quint8 type, const QByteArray& payload)
+		{
+			QByteArray message;
+			QDataStream out(&message, QIODevice::WriteOnly);
+			out.setVersion(QDataStream::Qt_5_0);
+			out << type << static_cast<quint16>(payload.size());
+			message += payload;
+			socket.write(message);
+		}
+		void sendClockRequest()
+		{
+			QByteArray payload;
+			QDataStream out(&payload, QIODevice::WriteOnly);
+			out.setVersion(QDataStream::Qt_5_0);
+			out << QDateTime::currentMSecsSinceEpoch() << qint64(0) << qint64(0);
+			write(ALIVE, payload);
+		}
+		void readData()
+		{
+			buffer += socket.readAll();
+			while (buffer.size()>=3)
+			{
+				const quint8 type = static_cast<quint8>(buffer.at(0));
+				const int size = (static_cast<uchar>(buffer.at(1))<<8) | static_cast<uchar>(buffer.at(2));
+				if (buffer.size()<3+size)
+					return;
+				const QByteArray payload = buffer.mid(3, size);
+				buffer.remove(0, 3+size);
+				handleMessage(type, payload);
+			}
+		}
+		void handleMessage(quint8 type, const QByteArray& payload)
+		{
+			QDataStream in(payload);
+			in.setVersion(QDataStream::Qt_5_0);
+			QByteArray reply;
+			QDataStream out(&reply, QIODevice::WriteOnly);
+			out.setVersion(QDataStream::Qt_5_0);
+			switch (type)
+			{
+				case SYNC_ERROR:
+				{
+					QByteArray message;
+					in >> message;
+					fprintf(stderr, "RemoteSync error: %s\n", message.constData());
+					++roundTrip.errors;
+					stop();
+					break;
+				}
+				case SERVER_CHALLENGE:
+				{
+					if (!payload.startsWith(SYNC_MAGIC_VALUE))
+					{
+						fprintf(stderr, "Not a RemoteSync server\n");
+						++roundTrip.errors;
+						stop();
+						return;
+					}
+					in.skipRawData(SYNC_MAGIC_VALUE.size());
+					quint8 protocolVersion;
+					quint32 remoteSyncVersion, stellariumVersion;
+					QUuid id;
+					in >> protocolVersion >> remoteSyncVersion >> stellariumVersion >> id;
+					if (protocolVersion!=SYNC_PROTOCOL_VERSION)
+						fprintf(stderr, "RemoteSync protocol %d, expected %d\n", protocolVersion, SYNC_PROTOCOL_VERSION);
+					// Answer with the versions of the server, so that it accepts the client
+					out << remoteSyncVersion << stellariumVersion << id;
+					write(CLIENT_CHALLENGE_RESPONSE, reply);
+					break;
+				}
+				case SERVER_CHALLENGERESPONSEVALID:
+					authenticated = true;
+					aliveTimer.start();
+					break;
+				case ALIVE:
+				{
+					qint64 originTime, receiveTime, transmitTime;
+					in >> originTime >> receiveTime >> transmitTime;
+					if (originTime && receiveTime)
+						roundTrip.add(QDateTime::currentMSecsSinceEpoch()-originTime);
+					break;
+				}
+				case MULTICAST:
+				{
+					// Receive everything over TCP: the load of the server is the same, and it can be measured here
+					QByteArray group;
+					quint16 groupPort;
+					in >> group >> groupPort;
+					out << group << groupPort << false;
+					write(MULTICAST, reply);
+					break;
+				}
+				default:
+					++messages;
+					bytes += 3+payload.size();
+					break;
+			}
+		}
+
+		QString host;
+		quint16 port;
+		QTcpSocket socket;
+		QTimer aliveTimer;
+		QByteArray buffer;
+		bool authenticated;
+	};
+
+	//! Reads the frame times of the server from the PerfService each second
+	class PerfMonitor
+	{
+	public:
+		PerfMonitor(const QUrl& base, const QByteArray& auth)
+			: base(base), auth(auth), loaded(false), errors(0)
+		{
+			timer.setInterval(1000);
+			QObject::connect(&timer, &QTimer::timeout, [this]() { sample(); });
+		}
+		void start() { timer.start(); }
+		void setLoaded(bool b) { loaded = b; }
+		//! Samples of fps, frameTimeP50 and frameTimeP99 without and with load
+		QList<QJsonObject> baseline, load;
+		int errors;
+
+	private:
+		void sample()
+		{
+			QUrl url(base);
+			url.setPath("/api/perf");
+			QNetworkRequest request(url);
+			if (!auth.isEmpty())
+				request.setRawHeader("Authorization", auth);
+			QNetworkReply* reply = network.get(request);
+			const bool duringLoad = loaded;
+			QObject::connect(reply, &QNetworkReply::finished, [this, reply, duringLoad]() {
+				if (reply->error()==QNetworkReply::NoError)
+					(duringLoad ? load : baseline).append(QJsonDocument::fromJson(reply->readAll()).object());
+				else
+					++errors;
+				reply->deleteLater();
+			});
+		}
+
+		QUrl base;
+		QByteArray auth;
+		QNetworkAccessManager network;
+		QTimer timer;
+		bool loaded;
+	};
+
+	//! Print the median of a metric over the second half of the samples of a phase
+	void printFrameTimes(const char* phase, const QList<QJsonObject>& samples)
+	{
+		Samples fps, p50, p99;
+		for (int i=samples.size()/2; i<samples.size(); ++i)
+		{
+			fps.add(samples.at(i).value("fps").toDouble());
+			p50.add(samples.at(i).value("frameTimeP50").toDouble());
+			p99.add(samples.at(i).value("frameTimeP99").toDouble());
+		}
+		if (fps.values.isEmpty())
+			printf("  %-10s no sample, is the RemoteControl plugin of the server up to date?\n", phase);
+		else
+			printf("  %-10s %6.1f fps  frame time p50 %.2f ms  p99 %.2f ms\n", phase,
+			       fps.percentile(0.5), p50.percentile(0.5), p99.percentile(0.5));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("remoteLoadTest");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Simulate RemoteControl and RemoteSync clients against a running Stellarium.");
+	parser.addHelpOption();
+	QCommandLineOption hostOption("host", "The Stellarium server.", "host", "localhost");
+	QCommandLineOption httpPortOption("http-port", "The port of the RemoteControl plugin.", "port", "8090");
+	QCommandLineOption syncPortOption("sync-port", "The port of the RemoteSync server.", "port", "20180");
+	QCommandLineOption passwordOption("password", "The password of the RemoteControl plugin.", "password");
+	QCommandLineOption pollOption("poll-clients", "Web clients polling main/status.", "N", "10");
+	QCommandLineOption pollIntervalOption("poll-interval", "Interval of the polls of each client.", "ms", "500");
+	QCommandLineOption pushOption("push-clients", "Web clients of the WebSocket push channel.", "N", "0");
+	QCommandLineOption syncOption("sync-clients", "RemoteSync clients.", "M", "0");
+	QCommandLineOption baselineOption("baseline", "Duration of the measure of the server without clients.", "s", "15");
+	QCommandLineOption durationOption("duration", "Duration of the load.", "s", "60");
+	parser.addOptions({ hostOption, httpPortOption, syncPortOption, passwordOption, pollOption, pollIntervalOption,
+			    pushOption, syncOption, baselineOption, durationOption });
+	parser.process(app);
+
+	const QString host = parser.value(hostOption);
+	const quint16 httpPort = static_cast<quint16>(parser.value(httpPortOption).toUInt());
+	const quint16 syncPort = static_cast<quint16>(parser.value(syncPortOption).toUInt());
+	const QByteArray auth = authorization(parser.value(passwordOption));
+	const int pollCount = parser.value(pollOption).toInt();
+	const int pushCount = parser.value(pushOption).toInt();
+	const int syncCount = parser.value(syncOption).toInt();
+	const int baseline = parser.value(baselineOption).toInt();
+	const int duration = parser.value(durationOption).toInt();
+	if (duration<=0 || baseline<0 || pollCount<0 || pushCount<0 || syncCount<0)
+		parser.showHelp(1);
+
+	QUrl base;
+	base.setScheme("http");
+	base.setHost(host);
+	base.setPort(httpPort);
+
+	qsrand(static_cast<uint>(QDateTime::currentMSecsSinceEpoch()));
+	PerfMonitor monitor(base, auth);
+	QList<PollClient*> pollClients;
+	QList<PushClient*> pushClients;
+	QList<SyncClient*> syncClients;
+	for (int i=0; i<pollCount; ++i)
+		pollClients.append(new PollClient(base, auth, parser.value(pollIntervalOption).toInt()));
+	for (int i=0; i<pushCount; ++i)
+		pushClients.append(new PushClient(host, httpPort, auth));
+	for (int i=0; i<syncCount; ++i)
+		syncClients.append(new SyncClient(host, syncPort));
+
+	printf("Measuring %s without clients for %d s\n", qPrintable(host), baseline);
+	monitor.start();
+	QTimer::singleShot(baseline*1000, [&]() {
+		printf("Starting %d polling, %d push and %d RemoteSync clients for %d s\n", pollCount, pushCount, syncCount, duration);
+		monitor.setLoaded(true);
+		// Spread the polls of the clients over the interval
+		for (int i=0; i<pollClients.size(); ++i)
+		{
+			PollClient* client = pollClients.at(i);
+			QTimer::singleShot(i*parser.value(pollIntervalOption).toInt()/qMax(1, pollClients.size()), [client]() { client->start(); });
+		}
+		for (auto* client : pushClients)
+			client->start();
+		for (auto* client : syncClients)
+			client->start();
+		QTimer::singleShot(duration*1000, &app, SLOT(quit()));
+	});
+	app.exec();
+
+	Samples pollLatency, pushIntervals, syncRoundTrip;
+	int pushMessages = 0, pushUpgraded = 0, syncMessages = 0, syncAuthenticated = 0;
+	qint64 pushBytes = 0, syncBytes = 0;
+	for (auto* client : pollClients)
+	{
+		client->stop();
+		pollLatency.add(client->latency);
+	}
+	for (auto* client : pushClients)
+	{
+		client->stop();
+		pushIntervals.add(client->intervals);
+		pushMessages += client->messages;
+		pushBytes += client->bytes;
+		pushUpgraded += client->isUpgraded();
+	}
+	for (auto* client : syncClients)
+	{
+		client->stop();
+		syncRoundTrip.add(client->roundTrip);
+		syncMessages += client->messages;
+		syncBytes += client->bytes;
+		syncAuthenticated += client->isAuthenticated();
+	}
+
+	printf("\nRemoteControl\n");
+	pollLatency.print("main/status latency", "ms");
+	if (pushCount>0)
+	{
+		pushIntervals.print("push message interval", "ms");
+		printf("  %d of %d push clients connected, %.1f messages/s and %.1f kB/s per client\n", pushUpgraded, pushCount,
+		       pushMessages/double(duration*pushCount), pushBytes/1024./(duration*pushCount));
+	}
+	if (syncCount>0)
+	{
+		printf("RemoteSync\n");
+		syncRoundTrip.print("clock request round trip", "ms");
+		printf("  %d of %d clients authenticated, %.1f messages/s and %.1f kB/s per client\n", syncAuthenticated, syncCount,
+		       syncMessages/double(duration*syncCount), syncBytes/1024./(duration*syncCount));
+	}
+	printf("Server frames (%d errors)\n", monitor.errors);
+	printFrameTimes("baseline", monitor.baseline);
+	printFrameTimes("load", monitor.load);
+
+	qDeleteAll(pollClients);
+	qDeleteAll(pushClients);
+	qDeleteAll(syncClients);
+	return 0;
+}
@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# Simulates RemoteControl web clients and RemoteSync
+# clients against a running Stellarium, see main.cpp
+#
+#-------------------------------------------------
+
+QT       += core network
+QT       -= gui
+
+TARGET = remoteLoadTest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+SOURCES += main.cpp